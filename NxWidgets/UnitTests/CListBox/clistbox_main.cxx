@@ -44,6 +44,7 @@
 #include <cstdlib>
 #include <cstring>
 #include <unistd.h>
+#include <time.h>
 #include <debug.h>
 
 #include <nuttx/nx/nx.h>
@@ -54,6 +55,10 @@
 // Definitions
 /////////////////////////////////////////////////////////////////////////////
 
+// Pixels scrolled per step when timing the listbox scroll
+
+#define SCROLL_STEP 4
+
 /////////////////////////////////////////////////////////////////////////////
 // Private Classes
 /////////////////////////////////////////////////////////////////////////////
@@ -166,6 +171,53 @@ static void initMemoryUsage(void)
   g_mmPeak     = mmcurrent.uordblks;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// Name: timeScroll
+//
+// Scroll the list from the top to the bottom and back, SCROLL_STEP pixels
+// at a time, and report the time per step and the steps per second.  In the
+// multi-user configuration this is the time to render and send the drawing
+// to the server.
+/////////////////////////////////////////////////////////////////////////////
+
+static void timeScroll(CListBox *listbox, FAR const char *msg)
+{
+  int32_t range = listbox->getCanvasHeight() - listbox->getHeight();
+  if (range < SCROLL_STEP)
+    {
+      message("clistbox_main: %s: Nothing to scroll\n", msg);
+      return;
+    }
+
+  listbox->jump(0, 0);
+
+  struct timespec start;
+  struct timespec end;
+  clock_gettime(CLOCK_REALTIME, &start);
+
+  int steps = 0;
+  for (int32_t y = 0; y + SCROLL_STEP <= range; y += SCROLL_STEP)
+    {
+      listbox->scroll(0, -SCROLL_STEP);
+      steps++;
+    }
+
+  for (int i = steps; i > 0; i--)
+    {
+      listbox->scroll(0, SCROLL_STEP);
+    }
+
+  clock_gettime(CLOCK_REALTIME, &end);
+
+  steps *= 2;
+  unsigned long usec = (end.tv_sec - start.tv_sec) * 1000000 +
+                       (end.tv_nsec - start.tv_nsec) / 1000;
+
+  message("clistbox_main: %s: %d steps, %lu us/step, %lu steps/s\n",
+          msg, steps, usec / steps,
+          usec > 0 ? (unsigned long)(((uint64_t)steps * 1000000) / usec) : 0);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 // Public Functions
 /////////////////////////////////////////////////////////////////////////////
@@ -247,6 +299,20 @@ int clistbox_main(int argc, char *argv[])
   updateMemoryUsage(g_mmPrevious, "clistbox_main: After sorting the listbox");
   sleep(1);
 
+  // Time scrolling the full list, drawing directly and through the
+  // retained surface
+
+  timeScroll(listbox, "Scroll");
+  if (listbox->setRetained(true))
+    {
+      timeScroll(listbox, "Retained scroll");
+      listbox->setRetained(false);
+    }
+
+  listbox->jump(0, 0);
+  updateMemoryUsage(g_mmPrevious, "clistbox_main: After timing the scroll");
+  sleep(1);
+
   // Select and remove items from the listbox
 
   srand(1978);
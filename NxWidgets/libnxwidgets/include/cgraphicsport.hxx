@@ -79,6 +79,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#include <nuttx/nx/nxfonts.h>
+
 #include "nxconfig.hxx"
 #include "inxwindow.hxx"
 
@@ -128,6 +130,22 @@ namespace NXWidgets
                    const CNxString &string, int startIndex, int length,
                    nxgl_mxpixel_t background, bool transparent);
 
+    /**
+     * Put a pre-rendered glyph on the display and fill the rows below it
+     * (down to the font height) with the background color.
+     * @param pos The window-relative x/y coordinate of the glyph.
+     * @param dest The full character cell to draw.
+     * @param boundingBox The window-relative clipping region.
+     * @param glyph The cached glyph to draw.
+     * @param background The background color of the glyph.
+     */
+
+    void drawGlyph(FAR const struct nxgl_point_s *pos,
+                   FAR const struct nxgl_rect_s *dest,
+                   FAR const struct nxgl_rect_s *boundingBox,
+                   FAR const struct nxfonts_glyph_s *glyph,
+                   nxgl_mxpixel_t background);
+
   public:
     /**
      * Constructor.
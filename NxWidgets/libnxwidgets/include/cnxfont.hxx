@@ -48,6 +48,8 @@
 #include <nuttx/nx/nxglib.h>
 #include <nuttx/nx/nxfonts.h>
 
+#include "nxconfig.hxx"
+
 /****************************************************************************
  * Pre-Processor Definitions
  ****************************************************************************/
@@ -75,6 +77,21 @@ namespace NXWidgets
     FAR const struct nx_font_s *m_pFontSet; /** < The font set metrics */
     nxgl_mxpixel_t m_fontColor;             /**< Color to draw the font with when rendering. */
     nxgl_mxpixel_t m_transparentColor;      /**< Background color that should not be rendered. */
+#if CONFIG_NXWIDGETS_FONTCACHE_SIZE > 0
+
+    /**
+     * One connection to a shared glyph cache.
+     */
+
+    struct SFontCache
+    {
+      FCACHE handle;                        /**< Cache handle, NULL if unused. */
+      nxgl_mxpixel_t color;                 /**< Text color of the cache. */
+      nxgl_mxpixel_t background;            /**< Background color of the cache. */
+    };
+
+    struct SFontCache m_cache[CONFIG_NXWIDGETS_FONTCACHE_NCOLORS]; /**< Most recently used first. */
+#endif
 
   public:
 
@@ -94,7 +111,7 @@ namespace NXWidgets
      * CNxFont Destructor.
      */
 
-    ~CNxFont() { }
+    ~CNxFont();
 
     /**
      * Checks if supplied character is blank in the current font.
@@ -158,6 +175,20 @@ namespace NXWidgets
 
     void drawChar(FAR SBitmap *bitmap, nxwidget_char_t letter);
 
+    /**
+     * Get a glyph pre-rendered in the current font color over a solid
+     * background color.  The glyph comes from a glyph cache shared with
+     * other fonts and NxTerm windows using the same font and colors.
+     *
+     * @param letter The character to get.
+     * @param background The background color of the glyph.
+     * @return The cached glyph, or NULL if the character has no glyph or
+     *   caching is unavailable.  The caller should then use drawChar().
+     */
+
+    FAR const struct nxfonts_glyph_s *getGlyph(nxwidget_char_t letter,
+                                               nxgl_mxpixel_t background);
+
     /**
      * Get the width of a string in pixels when drawn with this font.
      *
@@ -110,6 +110,7 @@ namespace NXWidgets
 
   class CWidgetControl;
   class CGraphicsPort;
+  class CSurface;
   class CNxFont;
   class CWidgetEventHandlerList;
 
@@ -153,6 +154,8 @@ namespace NXWidgets
       uint8_t erased          : 1;    /**< True if the widget is currently erased from the frame buffer. */
       uint8_t hidden          : 1;    /**< True if the widget is hidden. */
       uint8_t doubleClickable : 1;    /**< True if the widget can be double-clicked. */
+      uint8_t retained        : 1;    /**< True if the widget renders into an off-screen surface. */
+      uint8_t surfaceValid    : 1;    /**< True if the off-screen surface holds current contents. */
     } Flags;
 
     /**
@@ -207,6 +210,11 @@ namespace NXWidgets
 
     WidgetBorderSize m_borderSize;    /**< Size of the widget borders. */
 
+    // Retained rendering
+
+    CSurface *m_surface;              /**< Off-screen image of a retained widget. */
+    CGraphicsPort *m_surfacePort;     /**< Graphics port that draws into m_surface. */
+
     /**
      * Use the provided widget style
      */
@@ -239,6 +247,30 @@ namespace NXWidgets
 
     void drawChildren(void);
 
+    /**
+     * Render the border and contents of a retained widget into its
+     * off-screen surface.  The children are not rendered; they draw
+     * themselves over the widget.
+     */
+
+    void renderSurface(void);
+
+    /**
+     * Copy part of the off-screen surface of a retained widget to the
+     * window.  The surface must be valid.
+     *
+     * @param rect The region to copy in widget space.
+     */
+
+    void blitSurface(const CRect &rect);
+
+    /**
+     * Refresh the children of this widget without re-rendering any
+     * that hold a valid off-screen surface.
+     */
+
+    void refreshChildren(void);
+
     /**
      * Erase and remove the supplied child widget from this widget and
      * send it to the deletion queue.
@@ -1023,6 +1055,51 @@ namespace NXWidgets
 
     void redraw(void);
 
+    /**
+     * Redraws the visible regions of the widget and its children after
+     * they were exposed, e.g. by showing or moving the widget.  A
+     * retained widget with a valid surface is copied to the display
+     * without calling drawContents().  For other widgets this is the
+     * same as redraw().
+     */
+
+    void refresh(void);
+
+    /**
+     * Enable or disable retained rendering.  A retained widget draws its
+     * border and contents once into an off-screen surface and afterward
+     * blits that surface to the window until invalidate() or redraw() is
+     * called.
+     *
+     * @param retained True to enable retained rendering.
+     * @return True if the requested mode is now in effect.  False if the
+     *   surface could not be created; the widget then draws directly.
+     */
+
+    bool setRetained(bool retained);
+
+    /**
+     * Is the widget using retained rendering?
+     *
+     * @return True if the widget renders into an off-screen surface.
+     */
+
+    inline bool isRetained(void) const
+    {
+      return m_flags.retained;
+    }
+
+    /**
+     * Mark the off-screen surface of a retained widget as stale.  The
+     * contents are rendered again on the next refresh().  Widgets should
+     * call this (or redraw()) whenever their contents change.
+     */
+
+    inline void invalidate(void)
+    {
+      m_flags.surfaceValid = false;
+    }
+
     /**
      * Enables the widget.
      *
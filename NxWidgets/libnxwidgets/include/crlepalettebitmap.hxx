@@ -115,6 +115,10 @@ namespace NXWidgets
     uint8_t          m_remaining; /**< Number of bytes remaining in current entry */
     FAR const void  *m_lut;       /**< The selected LUT */
     FAR const struct SRlePaletteBitmapEntry *m_rle; /**< RLE entry being processed */
+#ifdef CONFIG_NXWIDGETS_RLECACHE
+    FAR nxwidget_pixel_t *m_cache[2]; /**< Decoded image for each LUT (or NULL) */
+    uint8_t          m_select;    /**< Index of the selected LUT */
+#endif
 
     /**
      * Reset to the beginning of the image
@@ -181,6 +185,17 @@ namespace NXWidgets
 
     bool copyPixels(nxgl_coord_t npixels, FAR void *data);
 
+#ifdef CONFIG_NXWIDGETS_RLECACHE
+    /**
+     * Decode the whole image with the selected LUT into the cache.  The
+     * RLE entries are walked once, in order, so no seeking is needed.
+     *
+     * @return The decoded image or NULL if it could not be allocated.
+     */
+
+    FAR const nxwidget_pixel_t *decodeImage(void);
+#endif
+
   public:
 
     /**
@@ -195,7 +210,11 @@ namespace NXWidgets
      * Destructor.
      */
 
+#ifdef CONFIG_NXWIDGETS_RLECACHE
+    ~CRlePaletteBitmap(void);
+#else
     inline ~CRlePaletteBitmap(void) {}
+#endif
 
     /**
      * Get the bitmap's color format.
@@ -0,0 +1,337 @@
+/****************************************************************************
+ * NxWidgets/libnxwidgets/include/csurface.hxx
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_CSURFACE_HXX
+#define __INCLUDE_CSURFACE_HXX
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <nuttx/nx/nxglib.h>
+#include <nuttx/nx/nx.h>
+
+#include "nxconfig.hxx"
+#include "inxwindow.hxx"
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Implementation Classes
+ ****************************************************************************/
+
+#if defined(__cplusplus)
+
+namespace NXWidgets
+{
+  struct SBitmap;
+
+  /**
+   * This class implements INxWindow on an off-screen image in memory.  A
+   * CGraphicsPort created on a CSurface renders exactly as it would into a
+   * window, but nothing is sent to the NX server; the finished image can
+   * then be copied to the real window with a single bitmap operation.
+   *
+   * The surface covers a rectangle of the real window:  All drawing
+   * coordinates are window coordinates and are clipped to that rectangle.
+   * Only whole-byte pixel depths (8, 16 and 32 bpp) are supported.
+   */
+
+  class CSurface : public INxWindow
+  {
+  private:
+    FAR nxwidget_pixel_t *m_buffer;  /**< The off-screen image */
+    struct nxgl_point_s   m_origin;  /**< Window position of the image */
+    struct nxgl_size_s    m_size;    /**< Size of the image in pixels */
+    unsigned int          m_stride;  /**< Width of an image row in bytes */
+
+    /**
+     * Clip a window rectangle to the surface.
+     *
+     * @param pRect The rectangle in window coordinates.
+     * @param pClipped The part of pRect on the surface, in window
+     *   coordinates.
+     * @return True if the clipped rectangle is not empty.
+     */
+
+    bool clip(FAR const struct nxgl_rect_s *pRect,
+              FAR struct nxgl_rect_s *pClipped) const;
+
+    /**
+     * Return the address of a pixel.  The position must be on the surface.
+     *
+     * @param x The window x coordinate of the pixel.
+     * @param y The window y coordinate of the pixel.
+     */
+
+    inline FAR nxwidget_pixel_t *pixelAddress(nxgl_coord_t x,
+                                              nxgl_coord_t y) const
+    {
+      return (FAR nxwidget_pixel_t *)((FAR uint8_t *)m_buffer +
+               (y - m_origin.y) * m_stride) + (x - m_origin.x);
+    }
+
+  public:
+
+    /**
+     * Constructor.  The image memory is not allocated until open() is
+     * called.
+     *
+     * @param pPos The window position of the upper left corner of the
+     *   surface.
+     * @param pSize The size of the surface.
+     */
+
+    CSurface(FAR const struct nxgl_point_s *pPos,
+             FAR const struct nxgl_size_s *pSize);
+
+    /**
+     * Destructor.
+     */
+
+    ~CSurface(void);
+
+    /**
+     * Allocate the off-screen image.
+     *
+     * @return True if the image was allocated.
+     */
+
+    bool open(void);
+
+    /**
+     * A surface has no widget control.
+     *
+     * @return NULL always.
+     */
+
+    CWidgetControl *getWidgetControl(void) const;
+
+    /**
+     * Get the off-screen image as a bitmap.
+     *
+     * @param bitmap The bitmap structure to describe the image.
+     */
+
+    void getBitmap(struct SBitmap &bitmap) const;
+
+    /**
+     * There is no server to ask; the position is always known.
+     *
+     * @return True always.
+     */
+
+    bool requestPosition(void);
+
+    /**
+     * Get the window position of the surface.
+     *
+     * @param pPos The location to return the position.
+     * @return True on success; false on failure.
+     */
+
+    bool getPosition(FAR struct nxgl_point_s *pPos);
+
+    /**
+     * Get the size of the surface.
+     *
+     * @param pSize The location to return the size.
+     * @return True on success; false on failure.
+     */
+
+    bool getSize(FAR struct nxgl_size_s *pSize);
+
+    /**
+     * Set the window position of the surface.  The image is unchanged; it
+     * now describes a different part of the window.
+     *
+     * @param pPos The new position.
+     * @return True on success; false on failure.
+     */
+
+    bool setPosition(FAR const struct nxgl_point_s *pPos);
+
+    /**
+     * Set the size of the surface.  The image contents are lost.
+     *
+     * @param pSize The new size.
+     * @return True if the image was reallocated.
+     */
+
+    bool setSize(FAR const struct nxgl_size_s *pSize);
+
+    /**
+     * Surfaces are not stacked; this does nothing.
+     *
+     * @return True always.
+     */
+
+    bool raise(void);
+
+    /**
+     * Surfaces are not stacked; this does nothing.
+     *
+     * @return True always.
+     */
+
+    bool lower(void);
+
+#ifdef CONFIG_NXTERM_NXKBDIN
+    /**
+     * Surfaces receive no keyboard input; this does nothing.
+     *
+     * @param handle The NxTerm handle.
+     */
+
+    void redirectNxTerm(NXTERM handle);
+#endif
+
+    /**
+     * Set an individual pixel on the surface with the specified color.
+     *
+     * @param pPos The location of the pixel to be filled.
+     * @param color The color to use in the fill.
+     *
+     * @return True on success; false on failure.
+     */
+
+    bool setPixel(FAR const struct nxgl_point_s *pPos,
+                  nxgl_mxpixel_t color);
+
+    /**
+     * Fill the specified rectangle on the surface with the specified color.
+     *
+     * @param pRect The location to be filled.
+     * @param color The color to use in the fill.
+     *
+     * @return True on success; false on failure.
+     */
+
+    bool fill(FAR const struct nxgl_rect_s *pRect, nxgl_mxpixel_t color);
+
+    /**
+     * Get the raw contents of a rectangle of the surface.
+     *
+     * @param rect The location to be copied.
+     * @param dest - The describes the destination bitmap.
+     */
+
+    void getRectangle(FAR const struct nxgl_rect_s *rect,
+                      struct SBitmap *dest);
+
+    /**
+     * Fill the specified trapezoidal region on the surface with the
+     * specified color.
+     *
+     * @param pClip Clipping rectangle relative to window (may be null).
+     * @param pTrap The trapezoidal region to be filled.
+     * @param color The color to use in the fill.
+     *
+     * @return True on success; false on failure.
+     */
+
+    bool fillTrapezoid(FAR const struct nxgl_rect_s *pClip,
+                       FAR const struct nxgl_trapezoid_s *pTrap,
+                       nxgl_mxpixel_t color);
+
+    /**
+     * Fill the specified line on the surface with the specified color.
+     *
+     * @param vector - Describes the line to be drawn
+     * @param width  - The width of the line
+     * @param color  - The color to use to fill the line
+     *
+     * @return True on success; false on failure.
+     */
+
+    bool drawLine(FAR struct nxgl_vector_s *vector,
+                  nxgl_coord_t width, nxgl_mxpixel_t color);
+
+    /**
+     * Draw a filled circle at the specified position, size, and color.
+     *
+     * @param center The window coordinates of the center of the circle.
+     * @param radius The radius of the circle in pixels.
+     * @param color The color to use to fill the circle
+     *
+     * @return True on success; false on failure.
+     */
+
+    bool drawFilledCircle(struct nxgl_point_s *center, nxgl_coord_t radius,
+                          nxgl_mxpixel_t color);
+
+    /**
+     * Move a rectangular region within the surface.
+     *
+     * @param pRect Describes the rectangular region to move.
+     * @param pOffset The offset to move the region.
+     *
+     * @return True on success; false on failure.
+     */
+
+    bool move(FAR const struct nxgl_rect_s *pRect,
+              FAR const struct nxgl_point_s *pOffset);
+
+    /**
+     * Copy a rectangular region of a larger image into the rectangle in
+     * the surface.
+     *
+     * @param pDest Describes the rectangular region on the surface that
+     *   will receive the bit map.
+     * @param pSrc The start of the source image.
+     * @param pOrigin The origin of the upper, left-most corner of the full
+     *   bitmap.  Both dest and origin are in window coordinates, however,
+     *   origin may lie outside of the surface.
+     * @param stride The width of the full source image in bytes.
+     *
+     * @return True on success; false on failure.
+     */
+
+    bool bitmap(FAR const struct nxgl_rect_s *pDest,
+                FAR const void *pSrc,
+                FAR const struct nxgl_point_s *pOrigin,
+                unsigned int stride);
+  };
+}
+
+#endif // __cplusplus
+
+#endif // __INCLUDE_CSURFACE_HXX
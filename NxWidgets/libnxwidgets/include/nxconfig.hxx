@@ -102,6 +102,12 @@
  * CONFIG_NXWIDGETS_DEFAULT_FONTID - Default font ID.  Default: NXFONT_DEFAULT
  * CONFIG_NXWIDGETS_TNXARRAY_INITIALSIZE, CONFIG_NXWIDGETS_TNXARRAY_SIZEINCREMENT -
  *   Default dynamic array parameters.  Default: 16, 8
+ * CONFIG_NXWIDGETS_FONTCACHE_SIZE - Pre-rendered glyphs retained per font and
+ *   color pair; zero disables glyph caching.  Default: 32
+ * CONFIG_NXWIDGETS_FONTCACHE_NCOLORS - Color pairs cached per CNxFont.
+ *   Default: 4
+ * CONFIG_NXWIDGETS_RLECACHE - Keep RLE bitmaps decoded in the native pixel
+ *   format after they are first drawn.  Default: Not defined
  *
  * CONFIG_NXWIDGETS_DEFAULT_BACKGROUNDCOLOR - Normal background color.  Default:
  *   MKRGB(148,189,215)
@@ -357,6 +363,16 @@
 #  define CONFIG_NXWIDGETS_TNXARRAY_SIZEINCREMENT 8
 #endif
 
+/* Glyph caching */
+
+#ifndef CONFIG_NXWIDGETS_FONTCACHE_SIZE
+#  define CONFIG_NXWIDGETS_FONTCACHE_SIZE 32
+#endif
+
+#ifndef CONFIG_NXWIDGETS_FONTCACHE_NCOLORS
+#  define CONFIG_NXWIDGETS_FONTCACHE_NCOLORS 4
+#endif
+
 /**
  * Normal background color
  */
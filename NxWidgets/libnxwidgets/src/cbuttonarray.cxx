@@ -519,25 +519,11 @@ void CButtonArray::drawButton(CGraphicsPort *port, int column, int row, bool use
   pos.x = x + alignX;
   pos.y = y + alignY;
 
-  // Set the CGraphicsControl background to match the selected background color.
-  // This is only necessary if we cannot read from the LCD.  If we cannot read
-  // from then the font background is set to this background color.
-  // REVISIT:  This begs for a more generalized solution.
+  // And draw the button text over the solid background just drawn.  This
+  // does not need to read back from the display and can use cached glyphs.
 
-#ifdef CONFIG_NX_WRITEONLY
-  nxgl_mxpixel_t saveColor = port->getBackColor();
-  port->setBackColor(backColor);
-#endif
-
-  // And draw the button text.
-
-  port->drawText(&pos, &rect, getFont(), *text, 0, text->getLength(), textColor);
-
-  // Restore the default background color
-
-#ifdef CONFIG_NX_WRITEONLY
-  port->setBackColor(saveColor);
-#endif
+  port->drawText(&pos, &rect, getFont(), *text, 0, text->getLength(),
+                 textColor, backColor);
 }
 
 /**
@@ -794,7 +794,22 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
           // Skip to the next character if this one is completely outside
           // the bounding box.
 
-          if (!nxgl_nullrect(&intersection))
+          // Text drawn over a solid background can use the shared glyph
+          // cache and skip rendering altogether
+
+          FAR const struct nxfonts_glyph_s *cached =
+            (FAR const struct nxfonts_glyph_s *)NULL;
+
+          if (!transparent && !nxgl_nullrect(&intersection))
+            {
+              cached = font->getGlyph(letter, background);
+            }
+
+          if (cached)
+            {
+              drawGlyph(pos, &dest, &boundingBox, cached, background);
+            }
+          else if (!nxgl_nullrect(&intersection))
             {
               // If we have been given a background color, use it to fill the array.
               // Otherwise initialize the bitmap memory by reading from the display.
@@ -840,6 +855,55 @@ void CGraphicsPort::_drawText(struct nxgl_point_s *pos, CRect *bound,
   delete glyph;
 }
 
+/**
+ * Put a pre-rendered glyph on the display and fill the rows below it
+ * (down to the font height) with the background color.
+ * @param pos The window-relative x/y coordinate of the glyph.
+ * @param dest The full character cell to draw.
+ * @param boundingBox The window-relative clipping region.
+ * @param glyph The cached glyph to draw.
+ * @param background The background color of the glyph.
+ */
+
+void CGraphicsPort::drawGlyph(FAR const struct nxgl_point_s *pos,
+                              FAR const struct nxgl_rect_s *dest,
+                              FAR const struct nxgl_rect_s *boundingBox,
+                              FAR const struct nxfonts_glyph_s *glyph,
+                              nxgl_mxpixel_t background)
+{
+  // The glyph covers the top of the character cell
+
+  struct nxgl_rect_s rect;
+  struct nxgl_rect_s intersection;
+
+  nxgl_rectcopy(&rect, dest);
+  rect.pt2.y = pos->y + glyph->height - 1;
+
+  nxgl_rectintersect(&intersection, &rect, boundingBox);
+  if (!nxgl_nullrect(&intersection))
+    {
+      if (!m_pNxWnd->bitmap(&intersection, (FAR const void *)glyph->bitmap,
+                            pos, glyph->stride))
+        {
+          gvdbg("nx_bitmapwindow failed: %d\n", errno);
+        }
+    }
+
+  // Fill whatever is left of the cell below the glyph
+
+  if (rect.pt2.y < dest->pt2.y)
+    {
+      rect.pt1.y = rect.pt2.y + 1;
+      rect.pt2.y = dest->pt2.y;
+
+      nxgl_rectintersect(&intersection, &rect, boundingBox);
+      if (!nxgl_nullrect(&intersection))
+        {
+          (void)m_pNxWnd->fill(&intersection, background);
+        }
+    }
+}
+
 /**
  * Copy a rectangular region from the source coordinates to the
  * destination coordinates.
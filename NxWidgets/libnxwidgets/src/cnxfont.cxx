@@ -80,6 +80,29 @@ CNxFont::CNxFont(enum nx_fontid_e fontid, nxgl_mxpixel_t fontColor,
   m_pFontSet         = nxf_getfontset(m_fontHandle);
   m_fontColor        = fontColor;
   m_transparentColor = transparentColor;
+
+#if CONFIG_NXWIDGETS_FONTCACHE_SIZE > 0
+  memset(m_cache, 0, sizeof(m_cache));
+#endif
+}
+
+/**
+ * CNxFont Destructor.
+ */
+
+CNxFont::~CNxFont()
+{
+#if CONFIG_NXWIDGETS_FONTCACHE_SIZE > 0
+  // Release our references to the shared glyph caches
+
+  for (int i = 0; i < CONFIG_NXWIDGETS_FONTCACHE_NCOLORS; i++)
+    {
+      if (m_cache[i].handle)
+        {
+          nxf_cache_disconnect(m_cache[i].handle);
+        }
+    }
+#endif
 }
 
 /**
@@ -132,6 +155,70 @@ void CNxFont::drawChar(FAR SBitmap *bitmap, nxwidget_char_t letter)
     }
 }
 
+/**
+ * Get a glyph pre-rendered in the current font color over a solid
+ * background color.
+ *
+ * @param letter The character to get.
+ * @param background The background color of the glyph.
+ * @return The cached glyph, or NULL if the character has no glyph or
+ *   caching is unavailable.
+ */
+
+FAR const struct nxfonts_glyph_s *CNxFont::getGlyph(nxwidget_char_t letter,
+                                                    nxgl_mxpixel_t background)
+{
+#if CONFIG_NXWIDGETS_FONTCACHE_SIZE > 0
+  // Look for a cache already connected for this color pair
+
+  int i;
+  for (i = 0; i < CONFIG_NXWIDGETS_FONTCACHE_NCOLORS; i++)
+    {
+      if (m_cache[i].handle && m_cache[i].color == m_fontColor &&
+          m_cache[i].background == background)
+        {
+          break;
+        }
+    }
+
+  if (i >= CONFIG_NXWIDGETS_FONTCACHE_NCOLORS)
+    {
+      // Not found.. replace the least recently used connection
+
+      i = CONFIG_NXWIDGETS_FONTCACHE_NCOLORS - 1;
+      if (m_cache[i].handle)
+        {
+          nxf_cache_disconnect(m_cache[i].handle);
+        }
+
+      m_cache[i].handle     = nxf_cache_connect(m_fontId, m_fontColor,
+                                                background,
+                                                CONFIG_NXWIDGETS_BPP,
+                                                CONFIG_NXWIDGETS_FONTCACHE_SIZE);
+      m_cache[i].color      = m_fontColor;
+      m_cache[i].background = background;
+
+      if (!m_cache[i].handle)
+        {
+          return (FAR const struct nxfonts_glyph_s *)NULL;
+        }
+    }
+
+  // Move the connection to the front of the list
+
+  if (i > 0)
+    {
+      struct SFontCache cache = m_cache[i];
+      memmove(&m_cache[1], &m_cache[0], i * sizeof(struct SFontCache));
+      m_cache[0] = cache;
+    }
+
+  return nxf_cache_getglyph(m_cache[0].handle, (uint16_t)letter);
+#else
+  return (FAR const struct nxfonts_glyph_s *)NULL;
+#endif
+}
+
 /**
  * Get the width of a string in pixels when drawn with this font.
  *
@@ -78,6 +78,8 @@
 
 #include "cnxwidget.hxx"
 #include "cgraphicsport.hxx"
+#include "csurface.hxx"
+#include "cbitmap.hxx"
 #include "cwidgeteventhandler.hxx"
 #include "cnxfont.hxx"
 #include "cwidgetstyle.hxx"
@@ -173,6 +175,13 @@ CNxWidget::CNxWidget(CWidgetControl *pWidgetControl,
   m_flags.enabled         = true;
   m_flags.erased          = true;
   m_flags.hidden          = false;
+  m_flags.retained        = false;
+  m_flags.surfaceValid    = false;
+
+  // Widgets draw directly to the window until setRetained() is called
+
+  m_surface               = (CSurface *)NULL;
+  m_surfacePort           = (CGraphicsPort *)NULL;
 
   // Set hierarchy pointers
 
@@ -234,6 +243,10 @@ CNxWidget::~CNxWidget(void)
   // widget.  It persists until the window is closed.
 
   delete m_widgetEventHandlers;
+
+  // Release any retained off-screen surface
+
+  (void)setRetained(false);
 }
 
 /**
@@ -484,14 +497,25 @@ void CNxWidget::redraw(void)
 {
   if (isDrawingEnabled())
     {
-      // Get the graphics port needed to draw on this window
+      if (m_flags.retained)
+        {
+          // The contents may have changed:  Render them again into the
+          // off-screen surface, then copy the whole widget to the window
 
-      CGraphicsPort *port = m_widgetControl->getGraphicsPort();
+          renderSurface();
+          blitSurface(CRect(getX(), getY(), getWidth(), getHeight()));
+        }
+      else
+        {
+          // Get the graphics port needed to draw on this window
+
+          CGraphicsPort *port = m_widgetControl->getGraphicsPort();
 
-      // Draw the Widget
+          // Draw the Widget
 
-      drawBorder(port);
-      drawContents(port);
+          drawBorder(port);
+          drawContents(port);
+        }
 
       // Remember that the widget is no longer erased
 
@@ -503,6 +527,101 @@ void CNxWidget::redraw(void)
     }
 }
 
+/**
+ * Redraws the visible regions of the widget and its children after
+ * they were exposed, e.g. by showing or moving the widget.  A retained
+ * widget with a valid surface is copied to the display without calling
+ * drawContents().  For other widgets this is the same as redraw().
+ */
+
+void CNxWidget::refresh(void)
+{
+  if (!m_flags.retained)
+    {
+      redraw();
+    }
+  else if (isDrawingEnabled())
+    {
+      // Render only if the contents changed since the last render
+
+      if (!m_flags.surfaceValid)
+        {
+          renderSurface();
+        }
+
+      blitSurface(CRect(getX(), getY(), getWidth(), getHeight()));
+      m_flags.erased = false;
+
+      refreshChildren();
+    }
+}
+
+/**
+ * Enable or disable retained rendering.  A retained widget draws its
+ * border and contents once into an off-screen surface and afterward
+ * blits that surface to the window until invalidate() or redraw() is
+ * called.
+ *
+ * @param retained True to enable retained rendering.
+ * @return True if the requested mode is now in effect.  False if the
+ *   surface could not be created; the widget then draws directly.
+ */
+
+bool CNxWidget::setRetained(bool retained)
+{
+  if (!retained)
+    {
+      if (m_surfacePort != (CGraphicsPort *)NULL)
+        {
+          delete m_surfacePort;
+          m_surfacePort = (CGraphicsPort *)NULL;
+        }
+
+      if (m_surface != (CSurface *)NULL)
+        {
+          delete m_surface;
+          m_surface = (CSurface *)NULL;
+        }
+
+      m_flags.retained     = false;
+      m_flags.surfaceValid = false;
+      return true;
+    }
+
+  if (m_flags.retained)
+    {
+      return true;
+    }
+
+  // Create a surface covering the widget at its current position
+
+  struct nxgl_point_s pos;
+  pos.x = getX();
+  pos.y = getY();
+
+  struct nxgl_size_s size;
+  size.w = getWidth();
+  size.h = getHeight();
+
+  m_surface = new CSurface(&pos, &size);
+  if (!m_surface->open())
+    {
+      delete m_surface;
+      m_surface = (CSurface *)NULL;
+      return false;
+    }
+
+#ifdef CONFIG_NX_WRITEONLY
+  m_surfacePort = new CGraphicsPort(m_surface, getBackgroundColor());
+#else
+  m_surfacePort = new CGraphicsPort(m_surface);
+#endif
+
+  m_flags.retained     = true;
+  m_flags.surfaceValid = false;
+  return true;
+}
+
 /**
  * Enables the widget.
  *
@@ -589,7 +708,7 @@ bool CNxWidget::show(void)
       m_flags.hidden = false;
 
       m_widgetEventHandlers->raiseShowEvent();
-      redraw();
+      refresh();
       return true;
     }
 
@@ -1060,7 +1179,7 @@ bool CNxWidget::moveTo(nxgl_coord_t x, nxgl_coord_t y)
       m_rect.setX(x);
       m_rect.setY(y);
 
-      redraw();
+      refresh();
       m_widgetEventHandlers->raiseMoveEvent(x, y, x - oldX, y - oldY);
       return true;
     }
@@ -1119,6 +1238,23 @@ bool CNxWidget::resize(nxgl_coord_t width, nxgl_coord_t height)
       m_rect.setWidth(width);
       m_rect.setHeight(height);
 
+      // Resize the off-screen surface.  Fall back to drawing directly if
+      // the larger image cannot be allocated.
+
+      if (m_flags.retained)
+        {
+          struct nxgl_size_s size;
+          size.w = width;
+          size.h = height;
+
+          if (!m_surface->setSize(&size))
+            {
+              (void)setRetained(false);
+            }
+
+          m_flags.surfaceValid = false;
+        }
+
       onResize(width, height);
 
       // Reset the permeable value
@@ -1473,6 +1609,69 @@ void CNxWidget::drawChildren(void)
     }
 }
 
+/**
+ * Render the border and contents of a retained widget into its
+ * off-screen surface.  The children are not rendered; they draw
+ * themselves over the widget.
+ */
+
+void CNxWidget::renderSurface(void)
+{
+  // The surface uses the same window coordinates as the widget so that
+  // drawBorder() and drawContents() need not know where they draw
+
+  struct nxgl_point_s pos;
+  pos.x = getX();
+  pos.y = getY();
+  (void)m_surface->setPosition(&pos);
+
+  drawBorder(m_surfacePort);
+  drawContents(m_surfacePort);
+
+  m_flags.surfaceValid = true;
+}
+
+/**
+ * Copy part of the off-screen surface of a retained widget to the
+ * window.  The surface must be valid.
+ *
+ * @param rect The region to copy in widget space.
+ */
+
+void CNxWidget::blitSurface(const CRect &rect)
+{
+  CRect widgetRect(getX(), getY(), getWidth(), getHeight());
+  CRect blitRect;
+  rect.getIntersect(widgetRect, blitRect);
+
+  if (blitRect.hasDimensions())
+    {
+      // The surface may have been rendered at a different position if
+      // the widget moved since; only its size is relevant
+
+      struct SBitmap bitmap;
+      m_surface->getBitmap(bitmap);
+
+      CGraphicsPort *port = m_widgetControl->getGraphicsPort();
+      port->drawBitmap(blitRect.getX(), blitRect.getY(),
+                       blitRect.getWidth(), blitRect.getHeight(), &bitmap,
+                       blitRect.getX() - getX(), blitRect.getY() - getY());
+    }
+}
+
+/**
+ * Refresh the children of this widget without re-rendering any
+ * that hold a valid off-screen surface.
+ */
+
+void CNxWidget::refreshChildren(void)
+{
+  for (int i = 0; i < m_children.size(); i++)
+    {
+      m_children[i]->refresh();
+    }
+}
+
 /**
  * Remove the supplied child widget from this widget and send it to
  * the deletion queue.
@@ -87,11 +87,62 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Method Implementations
+ * Private Functions
  ****************************************************************************/
 
 using namespace NXWidgets;
 
+/**
+ * Fill a run of pixels with one color.  Runs in RLE images are typically
+ * long, so write whole 32-bit words once the destination is word aligned.
+ *
+ * @param dest The first pixel of the run.
+ * @param color The color to fill with.
+ * @param npixels The number of pixels in the run.
+ */
+
+static void fillRun(FAR nxwidget_pixel_t *dest, nxwidget_pixel_t color,
+                    nxgl_coord_t npixels)
+{
+#if CONFIG_NXWIDGETS_BPP == 8
+  memset(dest, color, npixels);
+#elif CONFIG_NXWIDGETS_BPP == 16
+  // Align the destination to a 32-bit boundary
+
+  if (npixels > 0 && ((uintptr_t)dest & 3) != 0)
+    {
+      *dest++ = color;
+      npixels--;
+    }
+
+  // Then write two pixels per word
+
+  FAR uint32_t *wptr = (FAR uint32_t *)dest;
+  uint32_t wcolor    = ((uint32_t)color << 16) | (uint32_t)color;
+
+  for (; npixels >= 2; npixels -= 2)
+    {
+      *wptr++ = wcolor;
+    }
+
+  // And the odd pixel at the end of the run
+
+  if (npixels > 0)
+    {
+      *(FAR nxwidget_pixel_t *)wptr = color;
+    }
+#else
+  for (; npixels > 0; npixels--)
+    {
+      *dest++ = color;
+    }
+#endif
+}
+
+/****************************************************************************
+ * Method Implementations
+ ****************************************************************************/
+
 /**
  * Constructor.
  *
@@ -102,9 +153,33 @@ CRlePaletteBitmap::CRlePaletteBitmap(const struct SRlePaletteBitmap *bitmap)
 {
   m_bitmap      = bitmap;
   m_lut         = bitmap->lut[0];
+#ifdef CONFIG_NXWIDGETS_RLECACHE
+  m_cache[0]    = (FAR nxwidget_pixel_t *)NULL;
+  m_cache[1]    = (FAR nxwidget_pixel_t *)NULL;
+  m_select      = 0;
+#endif
   startOfImage();
 }
 
+#ifdef CONFIG_NXWIDGETS_RLECACHE
+/**
+ * Destructor.
+ */
+
+CRlePaletteBitmap::~CRlePaletteBitmap(void)
+{
+  if (m_cache[0])
+    {
+      delete [] m_cache[0];
+    }
+
+  if (m_cache[1])
+    {
+      delete [] m_cache[1];
+    }
+}
+#endif
+
 /**
  * Get the bitmap's color format.
  *
@@ -172,6 +247,9 @@ const size_t CRlePaletteBitmap::getStride(void) const
 void CRlePaletteBitmap::setSelected(bool selected)
 {
   m_lut = m_bitmap->lut[selected ? 1 : 0];
+#ifdef CONFIG_NXWIDGETS_RLECACHE
+  m_select = selected ? 1 : 0;
+#endif
 }
 
 /**
@@ -195,6 +273,24 @@ bool CRlePaletteBitmap::getRun(nxgl_coord_t x, nxgl_coord_t y, nxgl_coord_t widt
   if (((unsigned int)x           <  (unsigned int)m_bitmap->width) &&
       ((unsigned int)(x + width) <= (unsigned int)m_bitmap->width))
     {
+#ifdef CONFIG_NXWIDGETS_RLECACHE
+      // Copy the row from the decoded image, decoding it on first use.  If
+      // there is no memory for the image, fall back to walking the RLE data
+
+      if ((unsigned int)y >= (unsigned int)m_bitmap->height)
+        {
+          return false;
+        }
+
+      FAR const nxwidget_pixel_t *image = decodeImage();
+      if (image)
+        {
+          memcpy(data, &image[y * m_bitmap->width + x],
+                 width * sizeof(nxwidget_pixel_t));
+          return true;
+        }
+
+#endif
       // Seek to the requested row
 
       if (!seekRow(y))
@@ -365,11 +461,7 @@ void CRlePaletteBitmap::copyColor(nxgl_coord_t npixels, FAR void *data)
 
   // Copy the requested pixels
 
-  FAR nxwidget_pixel_t *dest = (FAR nxwidget_pixel_t *)data;
-  for (int i = 0; i < npixels; i++)
-    {
-      *dest++ = color;
-    }
+  fillRun((FAR nxwidget_pixel_t *)data, color, npixels);
 
   // Adjust the number of pixels remaining in the RLE entry
 
@@ -435,3 +527,51 @@ bool CRlePaletteBitmap::copyPixels(nxgl_coord_t npixels, FAR void *data)
 
   return true;
 }
+
+#ifdef CONFIG_NXWIDGETS_RLECACHE
+/**
+ * Decode the whole image with the selected LUT into the cache.  The RLE
+ * entries are walked once, in order, so no seeking is needed.
+ *
+ * @return The decoded image or NULL if it could not be allocated.
+ */
+
+FAR const nxwidget_pixel_t *CRlePaletteBitmap::decodeImage(void)
+{
+  if (m_cache[m_select])
+    {
+      return m_cache[m_select];
+    }
+
+  unsigned int npixels = (unsigned int)m_bitmap->width * m_bitmap->height;
+  FAR nxwidget_pixel_t *image = new nxwidget_pixel_t[npixels];
+  if (!image)
+    {
+      return (FAR const nxwidget_pixel_t *)NULL;
+    }
+
+  // Expand each run through the LUT straight into the image
+
+  FAR const nxwidget_pixel_t *nxlut = (FAR const nxwidget_pixel_t *)m_lut;
+  FAR const struct SRlePaletteBitmapEntry *rle = &m_bitmap->data[0];
+  FAR nxwidget_pixel_t *dest = image;
+
+  while (npixels > 0)
+    {
+      nxgl_coord_t nrun = rle->npixels;
+      if ((unsigned int)nrun > npixels)
+        {
+          nrun = npixels;
+        }
+
+      fillRun(dest, nxlut[rle->lookup], nrun);
+
+      dest    += nrun;
+      npixels -= nrun;
+      rle++;
+    }
+
+  m_cache[m_select] = image;
+  return image;
+}
+#endif
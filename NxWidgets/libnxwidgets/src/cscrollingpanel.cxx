@@ -219,9 +219,19 @@ void CScrollingPanel::scroll(int32_t dx, int32_t dy)
 
           scrollChildren(dx, dy, false);
 
+          // A retained panel renders the scrolled contents off-screen
+          // once; only the revealed sections are then copied to the
+          // window
+
+          if (isRetained() && revealedRects.size() > 0)
+            {
+              renderSurface();
+            }
+
           if (revealedRects.size() > 0)
             {
-              // Draw background to revealed sections
+              // Draw background (or the retained contents) to revealed
+              // sections
 
               for (int i = 0; i < revealedRects.size(); ++i)
                 {
@@ -231,19 +241,27 @@ void CScrollingPanel::scroll(int32_t dx, int32_t dy)
                         rrect.getX(), rrect.getY(),
                         rrect.getWidth(), rrect.getHeight());
 
-                  port->drawFilledRect(rrect.getX(), rrect.getY(),
-                                       rrect.getWidth(), rrect.getHeight(),
-                                       getBackgroundColor());
+                  if (isRetained())
+                    {
+                      blitSurface(rrect);
+                    }
+                  else
+                    {
+                      port->drawFilledRect(rrect.getX(), rrect.getY(),
+                                           rrect.getWidth(), rrect.getHeight(),
+                                           getBackgroundColor());
+                    }
 
-                  // Check if any children intersect this region.
-                  // If it does, it should be redrawn.
+                  // Check if any children intersect this region.  If it
+                  // does, it should be refreshed.  Only the children's
+                  // positions changed, not their contents.
 
                   for (int j = 0; j < m_children.size(); ++j)
                     {
                       CRect crect = m_children[j]->getBoundingBox();
                       if (crect.intersects(rrect))
                         {
-                          m_children[j]->redraw();
+                          m_children[j]->refresh();
                         }
                     }
                 }
@@ -0,0 +1,595 @@
+/****************************************************************************
+ * NxWidgets/libnxwidgets/src/csurface.cxx
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fixedmath.h>
+
+#include "csurface.hxx"
+#include "cbitmap.hxx"
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+// Number of trapezoids produced by nxgl_circletraps()
+
+#define SURFACE_CIRCLE_TRAPS 8
+
+/****************************************************************************
+ * Method Implementations
+ ****************************************************************************/
+
+using namespace NXWidgets;
+
+/**
+ * Constructor.
+ *
+ * @param pPos The window position of the upper left corner of the surface.
+ * @param pSize The size of the surface.
+ */
+
+CSurface::CSurface(FAR const struct nxgl_point_s *pPos,
+                   FAR const struct nxgl_size_s *pSize)
+{
+  m_buffer   = (FAR nxwidget_pixel_t *)NULL;
+  m_origin.x = pPos->x;
+  m_origin.y = pPos->y;
+  m_size.w   = pSize->w;
+  m_size.h   = pSize->h;
+  m_stride   = (unsigned int)pSize->w * sizeof(nxwidget_pixel_t);
+}
+
+/**
+ * Destructor.
+ */
+
+CSurface::~CSurface(void)
+{
+  if (m_buffer)
+    {
+      delete [] m_buffer;
+    }
+}
+
+/**
+ * Allocate the off-screen image.
+ *
+ * @return True if the image was allocated.
+ */
+
+bool CSurface::open(void)
+{
+#if CONFIG_NXWIDGETS_BPP == 24
+  // nxwidget_pixel_t is wider than a packed 24-bit pixel, so the image
+  // could not be blitted as-is
+
+  return false;
+#else
+  if (m_buffer)
+    {
+      delete [] m_buffer;
+      m_buffer = (FAR nxwidget_pixel_t *)NULL;
+    }
+
+  if (m_size.w <= 0 || m_size.h <= 0)
+    {
+      return false;
+    }
+
+  m_buffer = new nxwidget_pixel_t[(unsigned int)m_size.w * m_size.h];
+  return m_buffer != (FAR nxwidget_pixel_t *)NULL;
+#endif
+}
+
+/**
+ * A surface has no widget control.
+ *
+ * @return NULL always.
+ */
+
+CWidgetControl *CSurface::getWidgetControl(void) const
+{
+  return (CWidgetControl *)NULL;
+}
+
+/**
+ * Get the off-screen image as a bitmap.
+ *
+ * @param bitmap The bitmap structure to describe the image.
+ */
+
+void CSurface::getBitmap(struct SBitmap &bitmap) const
+{
+  bitmap.bpp    = CONFIG_NXWIDGETS_BPP;
+  bitmap.fmt    = CONFIG_NXWIDGETS_FMT;
+  bitmap.width  = m_size.w;
+  bitmap.height = m_size.h;
+  bitmap.stride = m_stride;
+  bitmap.data   = (FAR const void *)m_buffer;
+}
+
+/**
+ * There is no server to ask; the position is always known.
+ *
+ * @return True always.
+ */
+
+bool CSurface::requestPosition(void)
+{
+  return true;
+}
+
+/**
+ * Get the window position of the surface.
+ *
+ * @param pPos The location to return the position.
+ * @return True on success; false on failure.
+ */
+
+bool CSurface::getPosition(FAR struct nxgl_point_s *pPos)
+{
+  pPos->x = m_origin.x;
+  pPos->y = m_origin.y;
+  return true;
+}
+
+/**
+ * Get the size of the surface.
+ *
+ * @param pSize The location to return the size.
+ * @return True on success; false on failure.
+ */
+
+bool CSurface::getSize(FAR struct nxgl_size_s *pSize)
+{
+  pSize->w = m_size.w;
+  pSize->h = m_size.h;
+  return true;
+}
+
+/**
+ * Set the window position of the surface.
+ *
+ * @param pPos The new position.
+ * @return True on success; false on failure.
+ */
+
+bool CSurface::setPosition(FAR const struct nxgl_point_s *pPos)
+{
+  m_origin.x = pPos->x;
+  m_origin.y = pPos->y;
+  return true;
+}
+
+/**
+ * Set the size of the surface.  The image contents are lost.
+ *
+ * @param pSize The new size.
+ * @return True if the image was reallocated.
+ */
+
+bool CSurface::setSize(FAR const struct nxgl_size_s *pSize)
+{
+  m_size.w = pSize->w;
+  m_size.h = pSize->h;
+  m_stride = (unsigned int)pSize->w * sizeof(nxwidget_pixel_t);
+  return open();
+}
+
+/**
+ * Surfaces are not stacked; this does nothing.
+ *
+ * @return True always.
+ */
+
+bool CSurface::raise(void)
+{
+  return true;
+}
+
+/**
+ * Surfaces are not stacked; this does nothing.
+ *
+ * @return True always.
+ */
+
+bool CSurface::lower(void)
+{
+  return true;
+}
+
+/**
+ * Surfaces receive no keyboard input; this does nothing.
+ *
+ * @param handle The NxTerm handle.
+ */
+
+#ifdef CONFIG_NXTERM_NXKBDIN
+void CSurface::redirectNxTerm(NXTERM handle)
+{
+}
+#endif
+
+/**
+ * Set an individual pixel on the surface with the specified color.
+ *
+ * @param pPos The location of the pixel to be filled.
+ * @param color The color to use in the fill.
+ *
+ * @return True on success; false on failure.
+ */
+
+bool CSurface::setPixel(FAR const struct nxgl_point_s *pPos,
+                        nxgl_mxpixel_t color)
+{
+  struct nxgl_rect_s rect;
+
+  rect.pt1.x = pPos->x;
+  rect.pt1.y = pPos->y;
+  rect.pt2.x = pPos->x;
+  rect.pt2.y = pPos->y;
+
+  return fill(&rect, color);
+}
+
+/**
+ * Fill the specified rectangle on the surface with the specified color.
+ *
+ * @param pRect The location to be filled.
+ * @param color The color to use in the fill.
+ *
+ * @return True on success; false on failure.
+ */
+
+bool CSurface::fill(FAR const struct nxgl_rect_s *pRect,
+                    nxgl_mxpixel_t color)
+{
+  struct nxgl_rect_s rect;
+
+  if (!clip(pRect, &rect))
+    {
+      return m_buffer != (FAR nxwidget_pixel_t *)NULL;
+    }
+
+  nxgl_coord_t width = rect.pt2.x - rect.pt1.x + 1;
+  for (nxgl_coord_t y = rect.pt1.y; y <= rect.pt2.y; y++)
+    {
+      FAR nxwidget_pixel_t *dest = pixelAddress(rect.pt1.x, y);
+      for (nxgl_coord_t i = 0; i < width; i++)
+        {
+          *dest++ = (nxwidget_pixel_t)color;
+        }
+    }
+
+  return true;
+}
+
+/**
+ * Get the raw contents of a rectangle of the surface.
+ *
+ * @param rect The location to be copied.
+ * @param dest - The describes the destination bitmap.
+ */
+
+void CSurface::getRectangle(FAR const struct nxgl_rect_s *rect,
+                            struct SBitmap *dest)
+{
+  struct nxgl_rect_s clipped;
+
+  // Rows and columns outside of the surface are left untouched in dest
+
+  if (!clip(rect, &clipped))
+    {
+      return;
+    }
+
+  size_t nbytes = (clipped.pt2.x - clipped.pt1.x + 1) *
+                  sizeof(nxwidget_pixel_t);
+  FAR uint8_t *dline = (FAR uint8_t *)dest->data +
+                       (clipped.pt1.y - rect->pt1.y) * dest->stride +
+                       (clipped.pt1.x - rect->pt1.x) * sizeof(nxwidget_pixel_t);
+
+  for (nxgl_coord_t y = clipped.pt1.y; y <= clipped.pt2.y; y++)
+    {
+      memcpy(dline, pixelAddress(clipped.pt1.x, y), nbytes);
+      dline += dest->stride;
+    }
+}
+
+/**
+ * Fill the specified trapezoidal region on the surface with the specified
+ * color.
+ *
+ * @param pClip Clipping rectangle relative to window (may be null).
+ * @param pTrap The trapezoidal region to be filled.
+ * @param color The color to use in the fill.
+ *
+ * @return True on success; false on failure.
+ */
+
+bool CSurface::fillTrapezoid(FAR const struct nxgl_rect_s *pClip,
+                             FAR const struct nxgl_trapezoid_s *pTrap,
+                             nxgl_mxpixel_t color)
+{
+  if (!m_buffer)
+    {
+      return false;
+    }
+
+  // Rasterize one row at a time, stepping both edges in b16 fixed point
+
+  nxgl_coord_t nrows = pTrap->bot.y - pTrap->top.y + 1;
+  if (nrows <= 0)
+    {
+      return true;
+    }
+
+  b16_t x1 = pTrap->top.x1;
+  b16_t x2 = pTrap->top.x2;
+  b16_t dx1dy = 0;
+  b16_t dx2dy = 0;
+
+  if (nrows > 1)
+    {
+      dx1dy = b16divi(pTrap->bot.x1 - x1, nrows - 1);
+      dx2dy = b16divi(pTrap->bot.x2 - x2, nrows - 1);
+    }
+
+  for (nxgl_coord_t y = pTrap->top.y; y <= pTrap->bot.y; y++)
+    {
+      struct nxgl_rect_s row;
+      nxgl_coord_t ix1 = b16toi(x1 + b16HALF);
+      nxgl_coord_t ix2 = b16toi(x2 + b16HALF);
+
+      row.pt1.x = ix1 < ix2 ? ix1 : ix2;
+      row.pt2.x = ix1 < ix2 ? ix2 : ix1;
+      row.pt1.y = y;
+      row.pt2.y = y;
+
+      if (pClip)
+        {
+          nxgl_rectintersect(&row, &row, pClip);
+        }
+
+      if (!nxgl_nullrect(&row))
+        {
+          (void)fill(&row, color);
+        }
+
+      x1 += dx1dy;
+      x2 += dx2dy;
+    }
+
+  return true;
+}
+
+/**
+ * Fill the specified line on the surface with the specified color.
+ *
+ * @param vector - Describes the line to be drawn
+ * @param width  - The width of the line
+ * @param color  - The color to use to fill the line
+ *
+ * @return True on success; false on failure.
+ */
+
+bool CSurface::drawLine(FAR struct nxgl_vector_s *vector,
+                        nxgl_coord_t width, nxgl_mxpixel_t color)
+{
+  struct nxgl_trapezoid_s trap[3];
+  struct nxgl_rect_s rect;
+
+  // Split the line into trapezoids, the same way that nx_drawline() does
+
+  switch (nxgl_splitline(vector, trap, &rect, width))
+    {
+      case 0:
+        return fillTrapezoid((FAR const struct nxgl_rect_s *)NULL, &trap[0], color) &&
+               fillTrapezoid((FAR const struct nxgl_rect_s *)NULL, &trap[1], color) &&
+               fillTrapezoid((FAR const struct nxgl_rect_s *)NULL, &trap[2], color);
+
+      case 1:
+        return fillTrapezoid((FAR const struct nxgl_rect_s *)NULL, &trap[1], color);
+
+      case 2:
+        return fill(&rect, color);
+
+      default:
+        return false;
+    }
+}
+
+/**
+ * Draw a filled circle at the specified position, size, and color.
+ *
+ * @param center The window coordinates of the center of the circle.
+ * @param radius The radius of the circle in pixels.
+ * @param color The color to use to fill the circle
+ *
+ * @return True on success; false on failure.
+ */
+
+bool CSurface::drawFilledCircle(struct nxgl_point_s *center,
+                                nxgl_coord_t radius, nxgl_mxpixel_t color)
+{
+  struct nxgl_trapezoid_s traps[SURFACE_CIRCLE_TRAPS];
+
+  nxgl_circletraps(center, radius, traps);
+
+  for (int i = 0; i < SURFACE_CIRCLE_TRAPS; i++)
+    {
+      if (!fillTrapezoid((FAR const struct nxgl_rect_s *)NULL, &traps[i], color))
+        {
+          return false;
+        }
+    }
+
+  return true;
+}
+
+/**
+ * Move a rectangular region within the surface.
+ *
+ * @param pRect Describes the rectangular region to move.
+ * @param pOffset The offset to move the region.
+ *
+ * @return True on success; false on failure.
+ */
+
+bool CSurface::move(FAR const struct nxgl_rect_s *pRect,
+                    FAR const struct nxgl_point_s *pOffset)
+{
+  struct nxgl_rect_s src;
+  struct nxgl_rect_s dest;
+
+  if (!m_buffer)
+    {
+      return false;
+    }
+
+  // Clip the destination to the surface, then the source to what remains
+
+  nxgl_rectoffset(&dest, pRect, pOffset->x, pOffset->y);
+  if (!clip(&dest, &dest))
+    {
+      return true;
+    }
+
+  nxgl_rectoffset(&src, &dest, -pOffset->x, -pOffset->y);
+  if (!clip(&src, &src))
+    {
+      return true;
+    }
+
+  nxgl_rectoffset(&dest, &src, pOffset->x, pOffset->y);
+
+  // Copy rows in the order that does not overwrite unread source rows
+
+  size_t nbytes = (src.pt2.x - src.pt1.x + 1) * sizeof(nxwidget_pixel_t);
+  nxgl_coord_t nrows = src.pt2.y - src.pt1.y + 1;
+
+  if (pOffset->y > 0)
+    {
+      for (nxgl_coord_t i = nrows - 1; i >= 0; i--)
+        {
+          memmove(pixelAddress(dest.pt1.x, dest.pt1.y + i),
+                  pixelAddress(src.pt1.x, src.pt1.y + i), nbytes);
+        }
+    }
+  else
+    {
+      for (nxgl_coord_t i = 0; i < nrows; i++)
+        {
+          memmove(pixelAddress(dest.pt1.x, dest.pt1.y + i),
+                  pixelAddress(src.pt1.x, src.pt1.y + i), nbytes);
+        }
+    }
+
+  return true;
+}
+
+/**
+ * Copy a rectangular region of a larger image into the rectangle in the
+ * surface.
+ *
+ * @param pDest Describes the rectangular region on the surface that will
+ *   receive the bit map.
+ * @param pSrc The start of the source image.
+ * @param pOrigin The origin of the upper, left-most corner of the full
+ *   bitmap.
+ * @param stride The width of the full source image in bytes.
+ *
+ * @return True on success; false on failure.
+ */
+
+bool CSurface::bitmap(FAR const struct nxgl_rect_s *pDest,
+                      FAR const void *pSrc,
+                      FAR const struct nxgl_point_s *pOrigin,
+                      unsigned int stride)
+{
+  struct nxgl_rect_s rect;
+
+  if (!clip(pDest, &rect))
+    {
+      return m_buffer != (FAR nxwidget_pixel_t *)NULL;
+    }
+
+  size_t nbytes = (rect.pt2.x - rect.pt1.x + 1) * sizeof(nxwidget_pixel_t);
+  FAR const uint8_t *sline = (FAR const uint8_t *)pSrc +
+                             (rect.pt1.y - pOrigin->y) * stride +
+                             (rect.pt1.x - pOrigin->x) * sizeof(nxwidget_pixel_t);
+
+  for (nxgl_coord_t y = rect.pt1.y; y <= rect.pt2.y; y++)
+    {
+      memcpy(pixelAddress(rect.pt1.x, y), sline, nbytes);
+      sline += stride;
+    }
+
+  return true;
+}
+
+/**
+ * Clip a window rectangle to the surface.
+ *
+ * @param pRect The rectangle in window coordinates.
+ * @param pClipped The part of pRect on the surface, in window coordinates.
+ * @return True if the clipped rectangle is not empty.
+ */
+
+bool CSurface::clip(FAR const struct nxgl_rect_s *pRect,
+                    FAR struct nxgl_rect_s *pClipped) const
+{
+  struct nxgl_rect_s extent;
+
+  if (!m_buffer)
+    {
+      return false;
+    }
+
+  extent.pt1.x = m_origin.x;
+  extent.pt1.y = m_origin.y;
+  extent.pt2.x = m_origin.x + m_size.w - 1;
+  extent.pt2.y = m_origin.y + m_size.h - 1;
+
+  nxgl_rectintersect(pClipped, pRect, &extent);
+  return !nxgl_nullrect(pClipped);
+}
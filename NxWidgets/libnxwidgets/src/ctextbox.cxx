@@ -373,10 +373,11 @@ void CTextBox::drawContents(CGraphicsPort *port)
   pos.x = rect.getX() + m_align.x;
   pos.y = rect.getY() + m_align.y;
 
-  // And draw the text
+  // And draw the text over the background just filled
 
   CNxFont *font = getFont();
-  port->drawText(&pos, &rect, font, m_text, 0, m_text.getLength(), textColor);
+  port->drawText(&pos, &rect, font, m_text, 0, m_text.getLength(),
+                 textColor, backColor);
 
   // Draw cursor
 
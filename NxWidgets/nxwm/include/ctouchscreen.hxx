@@ -98,6 +98,8 @@ namespace NxWM
     struct SCalibrationData      m_calibData;  /**< Calibration data */
     struct touch_sample_s        m_sample;     /**< In normal mode, touch data is collected here */
     struct touch_sample_s       *m_touch;      /**< Points to the current touch data buffer */
+    struct nxgl_point_s          m_lastPos;    /**< Last position injected into NX */
+    uint8_t                      m_lastButtons; /**< Last button state injected into NX */
 
     /**
      * The touchscreen listener thread.  This is the entry point of a thread that
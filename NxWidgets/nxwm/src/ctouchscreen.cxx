@@ -100,6 +100,9 @@ CTouchscreen::CTouchscreen(NXWidgets::CNxServer *server, struct nxgl_size_s *win
   m_enabled     = false;               // Normal forwarding is not enabled
   m_capture     = false;               // There is no thread waiting for touchscreen data
   m_calibrated  = false;               // We have no calibration data
+  m_lastPos.x   = -1;                  // Nothing has been injected yet
+  m_lastPos.y   = -1;
+  m_lastButtons = NX_MOUSE_NOBUTTONS;
 
   // Save the window size
 
@@ -587,6 +590,18 @@ void CTouchscreen::handleMouseInput(struct touch_sample_s *sample)
 #endif
     }
 
+  // Don't bother the server with a report that changes nothing (the
+  // driver repeats the last position while the pen is held still)
+
+  if (x == m_lastPos.x && y == m_lastPos.y && buttons == m_lastButtons)
+    {
+      return;
+    }
+
+  m_lastPos.x   = x;
+  m_lastPos.y   = y;
+  m_lastButtons = buttons;
+
   // Get the server handle and "inject the mouse data
 
   NXHANDLE handle = m_server->getServer();
@@ -40,6 +40,8 @@
 #include <signal.h>
 #include <string.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
 
 #define DEFAULT_CONVERSION_TIME     ina230_ct_1_1ms /* 1.1ms */
 #define DEFAULT_AVG_SAMPLE_COUNT    ina230_avg_count_64 /* 64 samples average */
@@ -72,6 +74,7 @@ static uint32_t current_lsb;
 static ina230_conversion_time conversion_time;
 static ina230_avg_count avg_count;
 static uint32_t timestamp = 0;
+static uint16_t window = 0;
 static char separator[512];
 static char header[512];
 
@@ -114,6 +117,10 @@ static void usage(void)
             printf("         -l: select number of power measurements (default: 1).\n");
             printf("         -c: select continuous power measurements mode (default: disabled).\n");
             printf("         -x: export power measurements as .csv trace instead of table.\n");
+#ifdef CONFIG_ARA_SVC_PWRMON_DEV
+            printf("         -w: sample the rail selected with -r at the conversion rate,\n");
+            printf("             and print min/max/avg per window of the given sample count.\n");
+#endif
             printf("         -h: print help.\n\n");
 }
 
@@ -273,10 +280,11 @@ static int arapm_main_get_user_options(int argc, char **argv)
     conversion_time = DEFAULT_CONVERSION_TIME;
     avg_count = DEFAULT_AVG_SAMPLE_COUNT;
     csv_export = false;
+    window = 0;
 
     dbg_verbose("%s(): retrieving user options...\n", __func__);
     optind = -1;
-    while ((c = getopt(argc, argv, "xhcd:r:l:u:i:t:n:")) != 255) {
+    while ((c = getopt(argc, argv, "xhcd:r:l:u:i:t:n:w:")) != 255) {
         switch (c) {
         case 'd':
             ret = pwrmon_device_id(optarg, &user_dev_id);
@@ -374,6 +382,17 @@ static int arapm_main_get_user_options(int argc, char **argv)
             printf("Using .csv format to display power measurements.\n");
             break;
 
+#ifdef CONFIG_ARA_SVC_PWRMON_DEV
+        case 'w':
+            ret = sscanf(optarg, "%hu", &window);
+            if (ret != 1 || !window) {
+                fprintf(stderr, "Invalid window (%s)!\n", optarg);
+                return -EINVAL;
+            }
+            printf("Using %u samples windows.\n", window);
+            break;
+#endif
+
         case 'h':
         default:
             return -EINVAL;
@@ -683,6 +702,63 @@ static void arapm_main_deinit(void)
 }
 
 
+#ifdef CONFIG_ARA_SVC_PWRMON_DEV
+/**
+ * @brief           Sample a single rail with the power monitor sampler
+ *                  device and print the statistics of each window.
+ * @return          0 on success, standard error codes otherwise
+ */
+static int arapm_main_sample_windows(void)
+{
+    struct pwrmon_sampler_cfg cfg;
+    struct pwrmon_window w;
+    int fd, ret = 0;
+
+    if (user_rail_id == INA230_MAX_DEVS) {
+        fprintf(stderr, "A rail must be selected with -r!\n");
+        return -EINVAL;
+    }
+
+    fd = open(PWRMON_DEV_PATH, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Failed to open %s! (%d)\n", PWRMON_DEV_PATH, errno);
+        return -errno;
+    }
+
+    cfg.dev = user_dev_id;
+    cfg.rail = user_rail_id;
+    cfg.ct = conversion_time;
+    cfg.avg_count = avg_count;
+    cfg.current_lsb_uA = current_lsb;
+    cfg.window = window;
+    if (ioctl(fd, PWRMON_IOC_START, (unsigned long) &cfg)) {
+        fprintf(stderr, "Failed to start sampling! (%d)\n", errno);
+        close(fd);
+        return -errno;
+    }
+
+    printf("Time (ms),Samples,Lost,Voltage avg (uV),"
+           "Current min (uA),Current max (uA),Current avg (uA),"
+           "Power min (uW),Power max (uW),Power avg (uW)\n");
+    while (continuous || loopcount--) {
+        if (read(fd, &w, sizeof(w)) != sizeof(w)) {
+            fprintf(stderr, "Sampling stopped!\n");
+            ret = -EIO;
+            break;
+        }
+        printf("%u,%u,%u,%d,%d,%d,%d,%d,%d,%d\n",
+               w.timestamp, w.count, w.lost, w.uV_avg,
+               w.uA_min, w.uA_max, w.uA_avg,
+               w.uW_min, w.uW_max, w.uW_avg);
+    }
+
+    ioctl(fd, PWRMON_IOC_STOP, 0);
+    close(fd);
+
+    return ret;
+}
+#endif
+
 /**
  * @brief           Application main entry point.
  * @return          0 on success, standard error codes otherwise
@@ -703,6 +779,12 @@ int arapm_main(int argc, char *argv[])
         exit(-EINVAL);
     }
 
+#ifdef CONFIG_ARA_SVC_PWRMON_DEV
+    if (window) {
+        return arapm_main_sample_windows();
+    }
+#endif
+
     ret = arapm_main_init();
     if (ret) {
         arapm_main_deinit();
@@ -27,11 +27,13 @@
  */
 
 #include <errno.h>
+#include <limits.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
 #include <pthread.h>
+#include <semaphore.h>
 #include <sys/time.h>
 
 #include <nuttx/greybus/loopback.h>
@@ -336,6 +338,233 @@ static void print_status_csv(void)
     loopback_ctx_list_unlock();
 }
 
+/*
+ * Benchmark mode: drive several cports in parallel, each from its own thread
+ * and with up to 'depth' requests outstanding, then report the aggregate
+ * throughput and the latency distribution.
+ *
+ * Latencies are kept in a log-linear histogram: each power of 2 is split in
+ * BENCH_SUB_BUCKETS buckets, so percentiles are within 12.5%.
+ */
+#define BENCH_SUB_BITS          3
+#define BENCH_SUB_BUCKETS       (1 << BENCH_SUB_BITS)
+#define BENCH_BUCKETS           ((32 - BENCH_SUB_BITS + 1) * BENCH_SUB_BUCKETS)
+#define BENCH_DEFAULT_COUNT     1000
+
+struct bench_run {
+    pthread_mutex_t lock;
+    int type;
+    size_t size;
+    unsigned depth;
+    unsigned count;
+    unsigned completed;
+    unsigned errors;
+    uint32_t buckets[BENCH_BUCKETS];
+};
+
+struct bench_cport {
+    struct gb_loopback_async async; /* must be first, see bench_done() */
+    struct bench_run *run;
+    pthread_t thread;
+    sem_t window;
+    int cport;
+};
+
+static unsigned bench_bucket(uint32_t us)
+{
+    unsigned msb;
+
+    if (us < BENCH_SUB_BUCKETS)
+        return us;
+
+    msb = 31 - __builtin_clz(us);
+    return (msb - BENCH_SUB_BITS + 1) * BENCH_SUB_BUCKETS +
+           ((us >> (msb - BENCH_SUB_BITS)) & (BENCH_SUB_BUCKETS - 1));
+}
+
+/* Lower bound, in microseconds, of a histogram bucket */
+static uint32_t bench_bucket_us(unsigned bucket)
+{
+    unsigned exp = bucket / BENCH_SUB_BUCKETS;
+    unsigned mantissa = bucket % BENCH_SUB_BUCKETS;
+
+    if (!exp)
+        return bucket;
+
+    return (BENCH_SUB_BUCKETS + mantissa) << (exp - 1);
+}
+
+/* Latency below which 'permille' of the requests completed */
+static uint32_t bench_percentile(struct bench_run *run, unsigned permille)
+{
+    uint64_t target, total = 0;
+    unsigned i;
+
+    target = ((uint64_t) run->completed * permille + 999) / 1000;
+    for (i = 0; i < BENCH_BUCKETS; i++) {
+        total += run->buckets[i];
+        if (total && total >= target)
+            return bench_bucket_us(i);
+    }
+
+    return 0;
+}
+
+static void bench_done(struct gb_loopback_async *async, int status,
+                       uint32_t latency_us)
+{
+    struct bench_cport *bc = (struct bench_cport *) async;
+    struct bench_run *run = bc->run;
+
+    pthread_mutex_lock(&run->lock);
+    if (status) {
+        run->errors++;
+    } else {
+        run->completed++;
+        run->buckets[bench_bucket(latency_us)]++;
+    }
+    pthread_mutex_unlock(&run->lock);
+
+    sem_post(&bc->window);
+}
+
+static void *bench_thread(void *data)
+{
+    struct bench_cport *bc = data;
+    struct bench_run *run = bc->run;
+    size_t size = run->type == GB_LOOPBACK_TYPE_PING ? 1 : run->size;
+    unsigned i;
+
+    for (i = 0; i < run->count; i++) {
+        while (sem_wait(&bc->window) < 0 && errno == EINTR);
+
+        if (gb_loopback_send_req_async(bc->cport, size, run->type,
+                                       &bc->async) != OK) {
+            pthread_mutex_lock(&run->lock);
+            run->errors++;
+            pthread_mutex_unlock(&run->lock);
+            sem_post(&bc->window);
+        }
+    }
+
+    /* wait for the outstanding requests */
+    for (i = 0; i < run->depth; i++)
+        while (sem_wait(&bc->window) < 0 && errno == EINTR);
+
+    return NULL;
+}
+
+static int bench_run_size(struct bench_cport *bcs, unsigned nports,
+                          struct bench_run *run)
+{
+    struct timeval tv_start, tv_end, tv_total;
+    unsigned long long bytes;
+    useconds_t elapsed;
+    unsigned i, started;
+    int status = 0;
+
+    run->completed = 0;
+    run->errors = 0;
+    memset(run->buckets, 0, sizeof(run->buckets));
+
+    gettimeofday(&tv_start, NULL);
+
+    for (started = 0; started < nports; started++) {
+        sem_init(&bcs[started].window, 0, run->depth);
+        status = pthread_create(&bcs[started].thread, NULL, bench_thread,
+                                &bcs[started]);
+        if (status) {
+            sem_destroy(&bcs[started].window);
+            break;
+        }
+    }
+
+    for (i = 0; i < started; i++) {
+        pthread_join(bcs[i].thread, NULL);
+        sem_destroy(&bcs[i].window);
+    }
+
+    gettimeofday(&tv_end, NULL);
+    timersub(&tv_end, &tv_start, &tv_total);
+    elapsed = timeval_to_usec(&tv_total);
+    if (!elapsed)
+        elapsed = 1;
+
+    if (status) {
+        fprintf(stderr, "cannot start benchmark thread: %d\n", status);
+        return -status;
+    }
+
+    bytes = (unsigned long long) run->completed * run->size *
+            (run->type == GB_LOOPBACK_TYPE_TRANSFER ? 2 : 1);
+
+    /* bytes per microsecond are MB/s */
+    printf("%7u %6u %4u.%03u %9llu %7u %7u %7u %7u\n",
+           run->size, nports,
+           (unsigned) (bytes / elapsed),
+           (unsigned) ((bytes % elapsed) * 1000 / elapsed),
+           (unsigned long long) run->completed * USEC_PER_SEC / elapsed,
+           bench_percentile(run, 500),
+           bench_percentile(run, 990),
+           bench_percentile(run, 999),
+           run->errors);
+
+    return 0;
+}
+
+static int bench(int cport, unsigned nports, int type, size_t size_min,
+                 size_t size_max, unsigned depth, int count)
+{
+    struct loopback_context *ctx;
+    struct bench_cport *bcs;
+    struct bench_run run;
+    struct list_head *iter;
+    unsigned i, n = 0;
+    size_t size;
+    int status = 0;
+
+    bcs = zalloc(nports * sizeof(*bcs));
+    if (!bcs)
+        return -ENOMEM;
+
+    loopback_ctx_list_lock();
+    list_foreach(&loopback_ctx_list, iter) {
+        ctx = list_entry(iter, struct loopback_context, list);
+        if (n < nports && (cport < 0 || cport == ctx->cport))
+            bcs[n++].cport = ctx->cport;
+    }
+    loopback_ctx_list_unlock();
+
+    if (!n) {
+        fprintf(stderr, "no cport to run the benchmark on\n");
+        free(bcs);
+        return -ENODEV;
+    }
+
+    memset(&run, 0, sizeof(run));
+    pthread_mutex_init(&run.lock, NULL);
+    run.type = type;
+    run.depth = depth;
+    run.count = count > 0 ? count : BENCH_DEFAULT_COUNT;
+
+    for (i = 0; i < n; i++) {
+        bcs[i].async.done = bench_done;
+        bcs[i].run = &run;
+    }
+
+    printf("   SIZE  CPORTS     MB/s     OPS/s     P50     P99    P999  ERRORS\n");
+    for (size = size_min; size <= size_max && !status; size *= 2) {
+        run.size = size;
+        status = bench_run_size(bcs, n, &run);
+        if (!size)
+            break;
+    }
+
+    pthread_mutex_destroy(&run.lock);
+    free(bcs);
+    return status;
+}
+
 #ifdef CONFIG_BUILD_KERNEL
 int main(int argc, FAR char *argv[])
 #else
@@ -347,12 +576,13 @@ int gbl_main(int argc, char *argv[])
     const char *cmd, *fmt = NULL;
     struct list_head *iter;
     unsigned wait = 1000;
-    size_t size = 1;
+    unsigned nports = UINT_MAX, depth = 1;
+    size_t size = 1, size_max = 0;
 
     pthread_once(&loopback_init_once, loopback_init);
 
     optind = -1;
-    while ((opt = getopt (argc, argv, "c:s:t:w:n:f:")) != -1) {
+    while ((opt = getopt (argc, argv, "c:s:S:t:w:n:f:k:q:")) != -1) {
         switch (opt) {
         case 'c':
             st = sscanf(optarg, "%d", &cport);
@@ -379,9 +609,24 @@ int gbl_main(int argc, char *argv[])
             if (st != 1)
                 goto help;
             break;
+        case 'S':
+            st = sscanf(optarg, "%u:%u", &size, &size_max);
+            if (st != 2 || size > size_max)
+                goto help;
+            break;
         case 'f':
             fmt = optarg;
             break;
+        case 'k':
+            st = sscanf(optarg, "%u", &nports);
+            if (st != 1 || nports == 0)
+                goto help;
+            break;
+        case 'q':
+            st = sscanf(optarg, "%u", &depth);
+            if (st != 1 || depth == 0)
+                goto help;
+            break;
         default:
             goto help;
         }
@@ -446,6 +691,18 @@ int gbl_main(int argc, char *argv[])
 
         loopback_ctx_list_unlock();
         loopback_wakeup();
+    } else if (strcmp(cmd, "bench") == 0) {
+        if (type == GB_LOOPBACK_TYPE_NONE) {
+            fprintf(stderr, "operation type must be specified for 'bench'\n");
+            rv = EXIT_FAILURE;
+            goto out;
+        }
+
+        if (size_max < size)
+            size_max = size;
+
+        if (bench(cport, nports, type, size, size_max, depth, count))
+            rv = EXIT_FAILURE;
     } else if (strcmp(cmd, "status") == 0) {
         if (strcmp(fmt, "csv") == 0)
             print_status_csv();
@@ -463,18 +720,26 @@ help:
         "Greybus loopback tool\n\n"
         "Usage:\n"
         "\tgbl [-c CPORT] [-s SIZE] [-t ping|xfer|sink] "
-                        "[-w MS] [-n COUNT] [-f csv] start|stop|status\n\n"
+                        "[-w MS] [-n COUNT] [-f csv] start|stop|status\n"
+        "\tgbl [-c CPORT] [-k CPORTS] [-q DEPTH] [-s SIZE | -S MIN:MAX] "
+                        "[-n COUNT] -t ping|xfer|sink bench\n\n"
         "\tCommands:\n"
         "\t\tstart:\t\tstart a loopback command on a cport\n"
         "\t\tstop:\t\tstop the command on given cport\n"
-        "\t\tstatus:\t\tshow current status\n\n"
+        "\t\tstatus:\t\tshow current status\n"
+        "\t\tbench:\t\tmeasure throughput and latency\n\n"
         "\tOptions:\n"
         "\t\t-c CPORT:\tcport number (all cports if not given)\n"
         "\t\t-s SIZE:\tdata size in bytes\n"
         "\t\t-t TYPE:\tloopback operation type\n"
         "\t\t-w MS:\t\ttime to wait before sending next request (in ms)\n"
         "\t\t-n COUNT:\tnumber of requests to send before stopping\n"
+        "\t\t\t\t(per cport and size for bench, default 1000)\n"
         "\t\t-f FORMAT:\tspecify a different output format\n"
+        "\t\t-k CPORTS:\tbench: number of cports driven in parallel\n"
+        "\t\t-q DEPTH:\tbench: outstanding requests per cport\n"
+        "\t\t-S MIN:MAX:\tbench: sweep sizes from MIN to MAX, doubling\n"
+
     );
 
     return EXIT_FAILURE;
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include <nuttx/greybus/stats.h>
+
+static void show_usage(const char *appname)
+{
+    printf("%s [-r]\n", appname);
+    printf("\tprint the Greybus operation latency histograms\n");
+    printf("\t-r: reset the histograms\n");
+}
+
+static void print_stats(void)
+{
+    struct gb_stats_entry entry;
+    char buf[GB_STATS_KIND_COUNT * 160];
+    unsigned int i;
+
+    printf("%3s %4s %-7s %7s %7s | %s\n", "cp", "type", "kind", "count",
+           "max_us", "us:count");
+
+    for (i = 0; !gb_stats_get(i, &entry); i++) {
+        gb_stats_format(&entry, buf, sizeof(buf));
+        printf("%s", buf);
+    }
+}
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int gb_stats_main(int argc, char *argv[])
+#endif
+{
+    int c;
+
+    optind = -1;
+
+    while ((c = getopt(argc, argv, "rh")) != -1) {
+        switch (c) {
+        case 'r':
+            gb_stats_reset();
+            return 0;
+
+        case 'h':
+            show_usage(argv[0]);
+            return 0;
+
+        case '?':
+        default:
+            fprintf(stderr, "invalid parameter\n");
+            show_usage(argv[0]);
+            return -1;
+        }
+    }
+
+    print_stats();
+    return 0;
+}
@@ -73,8 +73,10 @@ int bridge_main(int argc, char *argv[])
     unipro_set_event_handler(xpb_unipro_evt_handler);
     gb_unipro_init();
     srvmgr_start(services);
+    gb_bringup_begin();
     enable_cports();
     sem_wait(&linkup_sem);
+    gb_bringup_wait();
     tsb_unipro_set_init_status(INIT_STATUS_OPERATING);
     tsb_unipro_mbox_send(TSB_MAIL_READY_OTHER);
     sem_destroy(&linkup_sem);
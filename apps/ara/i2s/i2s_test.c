@@ -341,13 +341,13 @@ int i2s_test_start_transmitter(struct i2s_test_info *info,
     struct ring_buf *rb;
     int ret;
 
-    /* 16-bit stereo */
-    rb = ring_buf_alloc_ring(info->rb_entries, 0,
-                             info->samples_per_rb_entry *
-                             sizeof(struct i2s_test_sample),
-                             0, i2s_test_rb_fill_and_pass, NULL, info);
+    /* 16-bit stereo, kept in the ring pool across test runs */
+    rb = ring_buf_pool_get("i2s_test_tx", info->rb_entries, 0,
+                           info->samples_per_rb_entry *
+                           sizeof(struct i2s_test_sample),
+                           0, 0, i2s_test_rb_fill_and_pass, info);
     if (!rb) {
-        fprintf(stderr, "ring_buf_alloc_ring failed\n");
+        fprintf(stderr, "ring_buf_pool_get failed\n");
         return -EIO;
     }
 
@@ -363,17 +363,20 @@ int i2s_test_start_transmitter(struct i2s_test_info *info,
         goto err_shutdown_transmitter;
     }
 
+    info->rb = rb;
+
     return 0;
 
 err_shutdown_transmitter:
     device_i2s_shutdown_transmitter(dev);
 err_free_ring:
-    ring_buf_free_ring(rb, NULL, NULL);
+    ring_buf_pool_put(rb);
 
     return ret;
 }
 
-void i2s_test_stop_transmitter(struct device *dev)
+void i2s_test_stop_transmitter(struct i2s_test_info *info,
+                               struct device *dev)
 {
     int ret;
 
@@ -384,6 +387,9 @@ void i2s_test_stop_transmitter(struct device *dev)
     ret = device_i2s_shutdown_transmitter(dev);
     if (ret)
         fprintf(stderr, "shutdown_tx failed: %d\n", ret);
+
+    ring_buf_pool_put(info->rb);
+    info->rb = NULL;
 }
 
 static void i2s_test_rx_check_data(struct i2s_test_info *info,
@@ -471,13 +477,13 @@ static int i2s_test_start_receiver(struct i2s_test_info *info,
     struct ring_buf *rb;
     int ret;
 
-    /* 16-bit stereo */
-    rb = ring_buf_alloc_ring(info->rb_entries, 0,
-                             info->samples_per_rb_entry *
-                                 sizeof(struct i2s_test_sample),
-                             0, NULL, NULL, NULL);
+    /* 16-bit stereo, kept in the ring pool across test runs */
+    rb = ring_buf_pool_get("i2s_test_rx", info->rb_entries, 0,
+                           info->samples_per_rb_entry *
+                               sizeof(struct i2s_test_sample),
+                           0, 0, NULL, NULL);
     if (!rb) {
-        fprintf(stderr, "ring_buf_alloc_ring failed\n");
+        fprintf(stderr, "ring_buf_pool_get failed\n");
         return -EIO;
     }
 
@@ -493,17 +499,20 @@ static int i2s_test_start_receiver(struct i2s_test_info *info,
         goto err_shutdown_receiver;
     }
 
+    info->rb = rb;
+
     return 0;
 
 err_shutdown_receiver:
     device_i2s_shutdown_receiver(dev);
 err_free_ring:
-    ring_buf_free_ring(rb, NULL, NULL);
+    ring_buf_pool_put(rb);
 
     return ret;
 }
 
-static void i2s_test_stop_receiver(struct device *dev)
+static void i2s_test_stop_receiver(struct i2s_test_info *info,
+                                   struct device *dev)
 {
     int ret;
 
@@ -514,6 +523,9 @@ static void i2s_test_stop_receiver(struct device *dev)
     ret = device_i2s_shutdown_receiver(dev);
     if (ret)
         fprintf(stderr, "shutdown_rx failed: %d\n", ret);
+
+    ring_buf_pool_put(info->rb);
+    info->rb = NULL;
 }
 
 static int i2s_test_start_streaming_transmitter(struct i2s_test_info *info)
@@ -599,7 +611,7 @@ static int i2s_test_start_streaming_transmitter(struct i2s_test_info *info)
      */
     while (sem_wait(&i2s_test_done_sem) && (errno == EINTR));
 
-    i2s_test_stop_transmitter(dev);
+    i2s_test_stop_transmitter(info, dev);
 
 err_dev_close:
     device_close(dev);
@@ -683,7 +695,7 @@ static int i2s_test_start_streaming_receiver(struct i2s_test_info *info)
      */
     while (sem_wait(&i2s_test_done_sem) && (errno == EINTR));
 
-    i2s_test_stop_receiver(dev);
+    i2s_test_stop_receiver(info, dev);
 
 err_dev_close:
     device_close(dev);
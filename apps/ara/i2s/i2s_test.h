@@ -50,6 +50,7 @@ struct i2s_test_info {
     uint16_t                left;
     uint16_t                right;
     struct i2s_test_stats   stats;
+    struct ring_buf         *rb;
 };
 
 extern sem_t i2s_test_done_sem;
@@ -57,6 +58,7 @@ extern struct device_i2s_pcm i2s_test_pcm;
 
 int i2s_test_start_transmitter(struct i2s_test_info *info,
                                struct device *dev);
-void i2s_test_stop_transmitter(struct device *dev);
+void i2s_test_stop_transmitter(struct i2s_test_info *info,
+                               struct device *dev);
 
 #endif /* __I2S_TEST_H__ */
@@ -87,20 +87,21 @@
  ****************************************************************************/
 
 /****************************************************************************
- * Name: exec_builtin
+ * Name: exec_builtin_actions
  *
  * Description:
- *   Executes builtin applications registered during 'make context' time.
- *   New application is run in a separate task context (and thread).
+ *   Executes builtin applications registered during 'make context' time,
+ *   applying a caller-provided set of file actions in the new task.  This
+ *   is the more general form of exec_builtin():  It allows the caller to
+ *   wire up both standard input and standard output (for example, to the
+ *   ends of a pipe) before the application starts.
  *
  * Input Parameter:
- *   filename  - Name of the linked-in binary to be started.
- *   argv      - Argument list
- *   redirfile - If output if redirected, this parameter will be non-NULL
- *               and will provide the full path to the file.
- *   oflags    - If output is redirected, this parameter will provide the
- *               open flags to use.  This will support file replacement
- *               of appending to an existing file.
+ *   filename     - Name of the linked-in binary to be started.
+ *   argv         - Argument list
+ *   file_actions - The file actions to perform in the new task.  May be
+ *                  NULL if the new task should simply inherit the file
+ *                  descriptors of the caller.
  *
  * Returned Value:
  *   This is an end-user function, so it follows the normal convention:
@@ -109,12 +110,11 @@
  *
  ****************************************************************************/
 
-int exec_builtin(FAR const char *appname, FAR char * const *argv,
-                 FAR const char *redirfile, int oflags)
+int exec_builtin_actions(FAR const char *appname, FAR char * const *argv,
+                         FAR const posix_spawn_file_actions_t *file_actions)
 {
   FAR const struct builtin_s *builtin;
   posix_spawnattr_t attr;
-  posix_spawn_file_actions_t file_actions;
   struct sched_param param;
   pid_t pid;
   int index;
@@ -146,25 +146,19 @@ int exec_builtin(FAR const char *appname, FAR char * const *argv,
       goto errout_with_errno;
     }
 
-  ret = posix_spawn_file_actions_init(&file_actions);
-  if (ret != 0)
-    {
-      goto errout_with_attrs;
-    }
-
   /* Set the correct task size and priority */
 
   param.sched_priority = builtin->priority;
   ret = posix_spawnattr_setschedparam(&attr, &param);
   if (ret != 0)
     {
-      goto errout_with_actions;
+      goto errout_with_attrs;
     }
 
   ret = task_spawnattr_setstacksize(&attr, builtin->stacksize);
   if (ret != 0)
     {
-      goto errout_with_actions;
+      goto errout_with_attrs;
     }
 
    /* If robin robin scheduling is enabled, then set the scheduling policy
@@ -175,7 +169,7 @@ int exec_builtin(FAR const char *appname, FAR char * const *argv,
   ret = posix_spawnattr_setschedpolicy(&attr, SCHED_RR);
   if (ret != 0)
     {
-      goto errout_with_actions;
+      goto errout_with_attrs;
     }
 
   ret = posix_spawnattr_setflags(&attr,
@@ -183,16 +177,81 @@ int exec_builtin(FAR const char *appname, FAR char * const *argv,
                                  POSIX_SPAWN_SETSCHEDULER);
   if (ret != 0)
     {
-      goto errout_with_actions;
+      goto errout_with_attrs;
     }
 #else
   ret = posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSCHEDPARAM);
   if (ret != 0)
     {
-      goto errout_with_actions;
+      goto errout_with_attrs;
     }
 #endif
 
+  /* Start the built-in */
+
+  ret = task_spawn(&pid, builtin->name, builtin->main, file_actions,
+                   &attr, (argv) ? &argv[1] : (FAR char * const *)NULL,
+                   (FAR char * const *)NULL);
+  if (ret != 0)
+    {
+      sdbg("ERROR: task_spawn failed: %d\n", ret);
+      goto errout_with_attrs;
+    }
+
+  /* Free attibutes.  Ignoring return values in the case of an error. */
+
+  /* Return the task ID of the new task if the task was sucessfully
+   * started.  Otherwise, ret will be ERROR (and the errno value will
+   * be set appropriately).
+   */
+
+  (void)posix_spawnattr_destroy(&attr);
+  return pid;
+
+errout_with_attrs:
+  (void)posix_spawnattr_destroy(&attr);
+
+errout_with_errno:
+  set_errno(ret);
+  return ERROR;
+}
+
+/****************************************************************************
+ * Name: exec_builtin
+ *
+ * Description:
+ *   Executes builtin applications registered during 'make context' time.
+ *   New application is run in a separate task context (and thread).
+ *
+ * Input Parameter:
+ *   filename  - Name of the linked-in binary to be started.
+ *   argv      - Argument list
+ *   redirfile - If output if redirected, this parameter will be non-NULL
+ *               and will provide the full path to the file.
+ *   oflags    - If output is redirected, this parameter will provide the
+ *               open flags to use.  This will support file replacement
+ *               of appending to an existing file.
+ *
+ * Returned Value:
+ *   This is an end-user function, so it follows the normal convention:
+ *   Returns the PID of the exec'ed module.  On failure, it.returns
+ *   -1 (ERROR) and sets errno appropriately.
+ *
+ ****************************************************************************/
+
+int exec_builtin(FAR const char *appname, FAR char * const *argv,
+                 FAR const char *redirfile, int oflags)
+{
+  posix_spawn_file_actions_t file_actions;
+  pid_t pid;
+  int ret;
+
+  ret = posix_spawn_file_actions_init(&file_actions);
+  if (ret != 0)
+    {
+      goto errout_with_errno;
+    }
+
   /* Is output being redirected? */
 
   if (redirfile)
@@ -208,36 +267,15 @@ int exec_builtin(FAR const char *appname, FAR char * const *argv,
         }
     }
 
-  /* Start the built-in */
-
-  ret = task_spawn(&pid, builtin->name, builtin->main, &file_actions,
-                   &attr, (argv) ? &argv[1] : (FAR char * const *)NULL,
-                   (FAR char * const *)NULL);
-  if (ret != 0)
-    {
-      sdbg("ERROR: task_spawn failed: %d\n", ret);
-      goto errout_with_actions;
-    }
-
-  /* Free attibutes and file actions.  Ignoring return values in the case
-   * of an error.
-   */
-
-  /* Return the task ID of the new task if the task was sucessfully
-   * started.  Otherwise, ret will be ERROR (and the errno value will
-   * be set appropriately).
-   */
+  /* Start the built-in.  exec_builtin_actions() sets errno on failure. */
 
+  pid = exec_builtin_actions(appname, argv, &file_actions);
   (void)posix_spawn_file_actions_destroy(&file_actions);
-  (void)posix_spawnattr_destroy(&attr);
   return pid;
 
 errout_with_actions:
   (void)posix_spawn_file_actions_destroy(&file_actions);
 
-errout_with_attrs:
-  (void)posix_spawnattr_destroy(&attr);
-
 errout_with_errno:
   set_errno(ret);
   return ERROR;
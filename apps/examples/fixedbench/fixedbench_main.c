@@ -0,0 +1,525 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <math.h>
+#include <fixedmath.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_FIXEDBENCH_SAMPLES
+#  define CONFIG_EXAMPLES_FIXEDBENCH_SAMPLES 256
+#endif
+
+#ifndef CONFIG_EXAMPLES_FIXEDBENCH_ITERATIONS
+#  define CONFIG_EXAMPLES_FIXEDBENCH_ITERATIONS 100
+#endif
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define FIXEDBENCH_CLOCK CLOCK_MONOTONIC
+#else
+#  define FIXEDBENCH_CLOCK CLOCK_REALTIME
+#endif
+
+#define NSAMPLES          CONFIG_EXAMPLES_FIXEDBENCH_SAMPLES
+#define NTAPS             16
+#define NSTAGES           2
+
+#define Q15_SCALE         32768.0f
+#define Q31_SCALE         2147483648.0f
+#define Q30_SCALE         1073741824.0f
+
+#define M_PI_F            3.14159265f
+
+/* Allowed difference with the float result, in units of the full scale.
+ * The Q15 kernels are held to a few LSBs; the Q31 ones are closer to the
+ * float result than float itself is to the exact one.  The filters add up
+ * rounding errors and the square root amplifies the quantization of small
+ * inputs, so they get the loose limits.
+ */
+
+#define Q15_LIMIT         (4.0f / Q15_SCALE)
+#define Q15_LOOSE_LIMIT   (32.0f / Q15_SCALE)
+#define Q31_LIMIT         1e-5f
+#define Q31_LOOSE_LIMIT   1e-4f
+#define DOT_LIMIT         1e-3f
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One benchmark: 'fixed' runs the library kernel on the fixed-point copies
+ * of the inputs and 'ref' the same computation in float.  'error' returns
+ * the largest difference between the two results, which must stay below
+ * 'limit'.
+ */
+
+struct fixedbench_s
+{
+  FAR const char *name;
+  CODE void (*fixed)(void);
+  CODE void (*ref)(void);
+  CODE float (*error)(void);
+  float limit;
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static float g_fa[NSAMPLES];
+static float g_fb[NSAMPLES];
+static float g_fout[NSAMPLES];
+static float g_fdot;
+
+static q15_t g_q15a[NSAMPLES];
+static q15_t g_q15b[NSAMPLES];
+static q15_t g_q15out[NSAMPLES];
+
+static q31_t g_q31a[NSAMPLES];
+static q31_t g_q31b[NSAMPLES];
+static q31_t g_q31out[NSAMPLES];
+
+static int64_t g_qdot;
+
+/* A 16-tap moving average and a two-stage low-pass biquad (Butterworth,
+ * cut-off at an eighth of the sample rate), with a1 and a2 negated.
+ */
+
+static const float g_ffir[NTAPS] =
+{
+  0.0625f, 0.0625f, 0.0625f, 0.0625f, 0.0625f, 0.0625f, 0.0625f, 0.0625f,
+  0.0625f, 0.0625f, 0.0625f, 0.0625f, 0.0625f, 0.0625f, 0.0625f, 0.0625f
+};
+
+static const float g_fbiquad[5] =
+{
+  0.0976f, 0.1953f, 0.0976f, 0.9428f, -0.3333f
+};
+
+static q15_t g_q15fir[NTAPS];
+static q15_t g_q15firstate[NTAPS + NSAMPLES - 1];
+static q15_t g_q15biquad[5];
+static struct q15_fir_s g_q15firinst;
+static struct q15_biquad_s g_q15stages[NSTAGES];
+
+static q31_t g_q31fir[NTAPS];
+static q31_t g_q31firstate[NTAPS + NSAMPLES - 1];
+static q31_t g_q31biquad[5];
+static struct q31_fir_s g_q31firinst;
+static struct q31_biquad_s g_q31stages[NSTAGES];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* Float references */
+
+static void ref_dot(void)
+{
+  float acc = 0.0f;
+  int i;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      acc += g_fa[i] * g_fb[i];
+    }
+
+  g_fdot = acc;
+}
+
+static void ref_scale(void)
+{
+  int i;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      g_fout[i] = g_fa[i] * 0.75f;
+    }
+}
+
+static void ref_add(void)
+{
+  int i;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      g_fout[i] = g_fa[i] + g_fb[i];
+    }
+}
+
+static void ref_sqrt(void)
+{
+  int i;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      g_fout[i] = g_fa[i] > 0.0f ? sqrtf(g_fa[i]) : 0.0f;
+    }
+}
+
+static void ref_atan2(void)
+{
+  int i;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      g_fout[i] = atan2f(g_fa[i], g_fb[i]) / M_PI_F;
+    }
+}
+
+static void ref_fir(void)
+{
+  float acc;
+  int i;
+  int k;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      acc = 0.0f;
+      for (k = 0; k < NTAPS && k <= i; k++)
+        {
+          acc += g_ffir[k] * g_fa[i - k];
+        }
+
+      g_fout[i] = acc;
+    }
+}
+
+static void ref_biquad(void)
+{
+  FAR const float *c = g_fbiquad;
+  FAR const float *src = g_fa;
+  float x1;
+  float x2;
+  float y1;
+  float y2;
+  float y;
+  int i;
+  int s;
+
+  for (s = 0; s < NSTAGES; s++, src = g_fout)
+    {
+      x1 = x2 = y1 = y2 = 0.0f;
+
+      for (i = 0; i < NSAMPLES; i++)
+        {
+          y  = c[0] * src[i] + c[1] * x1 + c[2] * x2 + c[3] * y1 + c[4] * y2;
+          x2 = x1;
+          x1 = src[i];
+          y2 = y1;
+          y1 = y;
+
+          g_fout[i] = y;
+        }
+    }
+}
+
+/* Q15 kernels */
+
+static void q15_bench_dot(void)
+{
+  g_qdot = q15_dot(g_q15a, g_q15b, NSAMPLES);
+}
+
+static void q15_bench_scale(void)
+{
+  q15_scale(g_q15a, (q15_t)(0.75f * Q15_SCALE), g_q15out, NSAMPLES);
+}
+
+static void q15_bench_add(void)
+{
+  q15_add(g_q15a, g_q15b, g_q15out, NSAMPLES);
+}
+
+static void q15_bench_sqrt(void)
+{
+  q15_sqrt(g_q15a, g_q15out, NSAMPLES);
+}
+
+static void q15_bench_atan2(void)
+{
+  q15_atan2(g_q15a, g_q15b, g_q15out, NSAMPLES);
+}
+
+static void q15_bench_fir(void)
+{
+  q15_fir_init(&g_q15firinst, g_q15fir, NTAPS, g_q15firstate, NSAMPLES);
+  (void)q15_fir(&g_q15firinst, g_q15a, g_q15out, NSAMPLES);
+}
+
+static void q15_bench_biquad(void)
+{
+  int s;
+
+  for (s = 0; s < NSTAGES; s++)
+    {
+      q15_biquad_init(&g_q15stages[s], g_q15biquad, 0);
+    }
+
+  q15_biquad(g_q15stages, NSTAGES, g_q15a, g_q15out, NSAMPLES);
+}
+
+/* Q31 kernels */
+
+static void q31_bench_dot(void)
+{
+  g_qdot = q31_dot(g_q31a, g_q31b, NSAMPLES);
+}
+
+static void q31_bench_scale(void)
+{
+  q31_scale(g_q31a, (q31_t)(0.75f * Q31_SCALE), g_q31out, NSAMPLES);
+}
+
+static void q31_bench_add(void)
+{
+  q31_add(g_q31a, g_q31b, g_q31out, NSAMPLES);
+}
+
+static void q31_bench_sqrt(void)
+{
+  q31_sqrt(g_q31a, g_q31out, NSAMPLES);
+}
+
+static void q31_bench_fir(void)
+{
+  q31_fir_init(&g_q31firinst, g_q31fir, NTAPS, g_q31firstate, NSAMPLES);
+  (void)q31_fir(&g_q31firinst, g_q31a, g_q31out, NSAMPLES);
+}
+
+static void q31_bench_biquad(void)
+{
+  int s;
+
+  for (s = 0; s < NSTAGES; s++)
+    {
+      q31_biquad_init(&g_q31stages[s], g_q31biquad, 0);
+    }
+
+  q31_biquad(g_q31stages, NSTAGES, g_q31a, g_q31out, NSAMPLES);
+}
+
+/* Result checks */
+
+static float dot_error(void)
+{
+  return fabsf((float)g_qdot / Q30_SCALE - g_fdot);
+}
+
+static float q15_error(void)
+{
+  float maxerr = 0.0f;
+  float err;
+  int i;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      err = fabsf((float)g_q15out[i] / Q15_SCALE - g_fout[i]);
+      if (err > maxerr)
+        {
+          maxerr = err;
+        }
+    }
+
+  return maxerr;
+}
+
+static float q31_error(void)
+{
+  float maxerr = 0.0f;
+  float err;
+  int i;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      err = fabsf((float)g_q31out[i] / Q31_SCALE - g_fout[i]);
+      if (err > maxerr)
+        {
+          maxerr = err;
+        }
+    }
+
+  return maxerr;
+}
+
+static const struct fixedbench_s g_fixedbench[] =
+{
+  { "q15dot",    q15_bench_dot,    ref_dot,    dot_error, DOT_LIMIT        },
+  { "q15scale",  q15_bench_scale,  ref_scale,  q15_error, Q15_LIMIT        },
+  { "q15add",    q15_bench_add,    ref_add,    q15_error, Q15_LIMIT        },
+  { "q15sqrt",   q15_bench_sqrt,   ref_sqrt,   q15_error, Q15_LOOSE_LIMIT  },
+  { "q15atan2",  q15_bench_atan2,  ref_atan2,  q15_error, Q15_LOOSE_LIMIT  },
+  { "q15fir",    q15_bench_fir,    ref_fir,    q15_error, Q15_LOOSE_LIMIT  },
+  { "q15biquad", q15_bench_biquad, ref_biquad, q15_error, Q15_LOOSE_LIMIT  },
+  { "q31dot",    q31_bench_dot,    ref_dot,    dot_error, DOT_LIMIT        },
+  { "q31scale",  q31_bench_scale,  ref_scale,  q31_error, Q31_LIMIT        },
+  { "q31add",    q31_bench_add,    ref_add,    q31_error, Q31_LIMIT        },
+  { "q31sqrt",   q31_bench_sqrt,   ref_sqrt,   q31_error, Q31_LIMIT        },
+  { "q31fir",    q31_bench_fir,    ref_fir,    q31_error, Q31_LOOSE_LIMIT  },
+  { "q31biquad", q31_bench_biquad, ref_biquad, q31_error, Q31_LOOSE_LIMIT  },
+};
+
+#define FIXEDBENCH_NTESTS (sizeof(g_fixedbench) / sizeof(g_fixedbench[0]))
+
+/****************************************************************************
+ * Name: fixedbench_fill
+ *
+ * Description:
+ *   Fill the float inputs with pseudo-random values in [-0.5, 0.5) and
+ *   make the Q15 and Q31 copies of them and of the filter coefficients.
+ *
+ ****************************************************************************/
+
+static void fixedbench_fill(void)
+{
+  uint32_t seed = 0x12345678;
+  int i;
+
+  for (i = 0; i < NSAMPLES; i++)
+    {
+      seed     = seed * 1103515245 + 12345;
+      g_fa[i]  = (float)(int16_t)(seed >> 16) / (2.0f * Q15_SCALE);
+      seed     = seed * 1103515245 + 12345;
+      g_fb[i]  = (float)(int16_t)(seed >> 16) / (2.0f * Q15_SCALE);
+
+      g_q15a[i] = (q15_t)(g_fa[i] * Q15_SCALE);
+      g_q15b[i] = (q15_t)(g_fb[i] * Q15_SCALE);
+      g_q31a[i] = (q31_t)(g_fa[i] * Q31_SCALE);
+      g_q31b[i] = (q31_t)(g_fb[i] * Q31_SCALE);
+    }
+
+  /* The library wants the FIR coefficients in time-reversed order */
+
+  for (i = 0; i < NTAPS; i++)
+    {
+      g_q15fir[i] = (q15_t)(g_ffir[NTAPS - 1 - i] * Q15_SCALE);
+      g_q31fir[i] = (q31_t)(g_ffir[NTAPS - 1 - i] * Q31_SCALE);
+    }
+
+  for (i = 0; i < 5; i++)
+    {
+      g_q15biquad[i] = (q15_t)(g_fbiquad[i] * Q15_SCALE);
+      g_q31biquad[i] = (q31_t)(g_fbiquad[i] * Q31_SCALE);
+    }
+}
+
+/****************************************************************************
+ * Name: fixedbench_time
+ *
+ * Description:
+ *   Return the time in microseconds for
+ *   CONFIG_EXAMPLES_FIXEDBENCH_ITERATIONS calls of 'func'.
+ *
+ ****************************************************************************/
+
+static unsigned long fixedbench_time(CODE void (*func)(void))
+{
+  struct timespec start;
+  struct timespec end;
+  int i;
+
+  clock_gettime(FIXEDBENCH_CLOCK, &start);
+
+  for (i = 0; i < CONFIG_EXAMPLES_FIXEDBENCH_ITERATIONS; i++)
+    {
+      func();
+    }
+
+  clock_gettime(FIXEDBENCH_CLOCK, &end);
+
+  return (end.tv_sec - start.tv_sec) * 1000000 +
+         (end.tv_nsec - start.tv_nsec) / 1000;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * fixedbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int fixedbench_main(int argc, char *argv[])
+#endif
+{
+  unsigned long fixedus;
+  unsigned long floatus;
+  unsigned long errppm;
+  float err;
+  int errors = 0;
+  int i;
+
+  fixedbench_fill();
+
+  printf("%d samples, %d iterations, times in microseconds\n",
+         NSAMPLES, CONFIG_EXAMPLES_FIXEDBENCH_ITERATIONS);
+#ifdef __ARM_FEATURE_DSP
+  printf("Kernels use the DSP instructions\n");
+#endif
+  printf("%-10s %10s %10s %10s\n", "kernel", "fixed", "float", "err(ppm)");
+
+  for (i = 0; i < FIXEDBENCH_NTESTS; i++)
+    {
+      /* Check the result first */
+
+      g_fixedbench[i].fixed();
+      g_fixedbench[i].ref();
+      err    = g_fixedbench[i].error();
+      errppm = (unsigned long)(err * 1000000.0f);
+
+      fixedus = fixedbench_time(g_fixedbench[i].fixed);
+      floatus = fixedbench_time(g_fixedbench[i].ref);
+
+      printf("%-10s %10lu %10lu %10lu%s\n", g_fixedbench[i].name,
+             fixedus, floatus, errppm,
+             err > g_fixedbench[i].limit ? " ERROR" : "");
+
+      if (err > g_fixedbench[i].limit)
+        {
+          errors++;
+        }
+    }
+
+  return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,751 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <nuttx/greybus/greybus.h>
+#include <nuttx/greybus/loopback.h>
+#include <nuttx/greybus/stats.h>
+#include <nuttx/greybus/tape.h>
+
+#include <arch/byteorder.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_GBBENCH_OPS
+#  define CONFIG_EXAMPLES_GBBENCH_OPS 10000
+#endif
+
+#ifndef CONFIG_EXAMPLES_GBBENCH_CPORT
+#  define CONFIG_EXAMPLES_GBBENCH_CPORT 0
+#endif
+
+#ifndef CONFIG_EXAMPLES_GBBENCH_WINDOW
+#  define CONFIG_EXAMPLES_GBBENCH_WINDOW 8
+#endif
+
+#define GBBENCH_MAXCPORTS  256
+#define GBBENCH_MAXMSG     2048 /* CPORT_BUF_SIZE */
+#define GBBENCH_TIMEOUT    2    /* Seconds to wait for a response */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum gbbench_mix_e
+{
+  GBBENCH_MIX_PING,
+  GBBENCH_MIX_SINK,
+  GBBENCH_MIX_TRANSFER,
+  GBBENCH_MIX_MIXED,
+};
+
+struct gbbench_s
+{
+  sem_t window;                 /* One count per request that may be sent */
+  volatile uint32_t responses;  /* Responses sent by the Greybus core */
+  uint32_t expected;            /* Requests that must get a response */
+  uint32_t ops;                 /* Messages fed to greybus_rx_handler() */
+  uint32_t errors;              /* Messages refused by greybus_rx_handler() */
+  uint16_t id;                  /* Operation id of the last request */
+  uint8_t attached[GBBENCH_MAXCPORTS / 8];
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void gbbench_tp_init(void);
+static void gbbench_tp_exit(void);
+static int gbbench_tp_listen(unsigned int cport);
+static int gbbench_tp_stop_listening(unsigned int cport);
+static int gbbench_tp_send(unsigned int cport, const void *buf, size_t len);
+static void *gbbench_tp_alloc_buf(size_t size);
+static void gbbench_tp_free_buf(void *ptr);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The null transport: nothing is ever received, and what the Greybus core
+ * sends is only counted.
+ */
+
+static struct gb_transport_backend g_gbbench_transport =
+{
+  .headroom       = 0,
+  .init           = gbbench_tp_init,
+  .exit           = gbbench_tp_exit,
+  .listen         = gbbench_tp_listen,
+  .stop_listening = gbbench_tp_stop_listening,
+  .send           = gbbench_tp_send,
+  .alloc_buf      = gbbench_tp_alloc_buf,
+  .free_buf       = gbbench_tp_free_buf,
+};
+
+static struct gbbench_s g_gbbench;
+static bool g_gbbench_initialized;
+
+static const char * const g_gbbench_mixes[] =
+{
+  [GBBENCH_MIX_PING]     = "ping",
+  [GBBENCH_MIX_SINK]     = "sink",
+  [GBBENCH_MIX_TRANSFER] = "transfer",
+  [GBBENCH_MIX_MIXED]    = "mixed",
+};
+
+#define GBBENCH_NMIXES (sizeof(g_gbbench_mixes) / sizeof(g_gbbench_mixes[0]))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void gbbench_tp_init(void)
+{
+}
+
+static void gbbench_tp_exit(void)
+{
+}
+
+static int gbbench_tp_listen(unsigned int cport)
+{
+  return 0;
+}
+
+static int gbbench_tp_stop_listening(unsigned int cport)
+{
+  return 0;
+}
+
+static int gbbench_tp_send(unsigned int cport, const void *buf, size_t len)
+{
+  FAR const struct gb_operation_hdr *hdr = buf;
+
+  if (len >= sizeof(*hdr) && (hdr->type & GB_TYPE_RESPONSE_FLAG) != 0)
+    {
+      g_gbbench.responses++;
+      sem_post(&g_gbbench.window);
+    }
+
+  return 0;
+}
+
+static void *gbbench_tp_alloc_buf(size_t size)
+{
+  return malloc(size);
+}
+
+static void gbbench_tp_free_buf(void *ptr)
+{
+  free(ptr);
+}
+
+/****************************************************************************
+ * Name: gbbench_attach
+ *
+ * Description:
+ *   Make sure that the loopback driver listens on 'cport'.  The drivers stay
+ *   registered from one run to the next.
+ *
+ ****************************************************************************/
+
+static int gbbench_attach(unsigned int cport)
+{
+  int ret;
+
+  if (cport >= GBBENCH_MAXCPORTS || !gb_is_valid_cport(cport))
+    {
+      return -EINVAL;
+    }
+
+  if (g_gbbench.attached[cport / 8] & (1 << (cport % 8)))
+    {
+      return OK;
+    }
+
+  gb_loopback_register(cport);
+  ret = gb_listen(cport);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  g_gbbench.attached[cport / 8] |= 1 << (cport % 8);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: gbbench_wait
+ *
+ * Description:
+ *   Take one count of the window, waiting for a response if needed.
+ *
+ ****************************************************************************/
+
+static int gbbench_wait(void)
+{
+  struct timespec abstime;
+
+  clock_gettime(CLOCK_REALTIME, &abstime);
+  abstime.tv_sec += GBBENCH_TIMEOUT;
+
+  while (sem_timedwait(&g_gbbench.window, &abstime) < 0)
+    {
+      if (errno != EINTR)
+        {
+          return -errno;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: gbbench_feed
+ *
+ * Description:
+ *   Hand one message to the Greybus core, as if the transport had just
+ *   received it.  Requests that expect a response first wait for a free
+ *   slot in the window.
+ *
+ ****************************************************************************/
+
+static int gbbench_feed(unsigned int cport, FAR void *msg, size_t size)
+{
+  FAR struct gb_operation_hdr *hdr = msg;
+  bool reply;
+  int ret;
+
+  reply = size >= sizeof(*hdr) && hdr->id != 0 &&
+          (hdr->type & GB_TYPE_RESPONSE_FLAG) == 0;
+  if (reply)
+    {
+      ret = gbbench_wait();
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  g_gbbench.ops++;
+  ret = greybus_rx_handler(cport, msg, size);
+  if (ret < 0)
+    {
+      g_gbbench.errors++;
+      if (reply)
+        {
+          sem_post(&g_gbbench.window);
+        }
+
+      return OK;
+    }
+
+  if (reply)
+    {
+      g_gbbench.expected++;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: gbbench_drain
+ *
+ * Description:
+ *   Wait for the responses to all the requests fed so far.
+ *
+ ****************************************************************************/
+
+static int gbbench_drain(int window)
+{
+  int ret;
+  int i;
+
+  for (i = 0; i < window; i++)
+    {
+      ret = gbbench_wait();
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: gbbench_request
+ *
+ * Description:
+ *   Build a loopback request with 'size' bytes of payload in 'buf'.  Return
+ *   the size of the message.
+ *
+ ****************************************************************************/
+
+static size_t gbbench_request(FAR uint8_t *buf, uint8_t type, size_t size)
+{
+  FAR struct gb_operation_hdr *hdr = (FAR struct gb_operation_hdr *)buf;
+  FAR struct gb_loopback_transfer_request *req;
+  size_t len = sizeof(*hdr);
+
+  if (type != GB_LOOPBACK_TYPE_PING)
+    {
+      req = (FAR struct gb_loopback_transfer_request *)(hdr + 1);
+      req->len = cpu_to_le32(size);
+      memset(req->data, 0x5a, size);
+      len += sizeof(*req) + size;
+    }
+
+  /* Operation ids wrap around without ever being 0, which is used by the
+   * requests that do not expect a response.
+   */
+
+  if (++g_gbbench.id == 0)
+    {
+      g_gbbench.id = 1;
+    }
+
+  memset(hdr, 0, sizeof(*hdr));
+  hdr->size = cpu_to_le16(len);
+  hdr->id   = cpu_to_le16(g_gbbench.id);
+  hdr->type = type;
+  return len;
+}
+
+/****************************************************************************
+ * Name: gbbench_synthetic
+ *
+ * Description:
+ *   Feed 'nops' loopback requests to 'cport'.
+ *
+ ****************************************************************************/
+
+static int gbbench_synthetic(unsigned int cport, enum gbbench_mix_e mix,
+                             uint32_t nops, size_t size)
+{
+  static const uint8_t types[] =
+  {
+    [GBBENCH_MIX_PING]     = GB_LOOPBACK_TYPE_PING,
+    [GBBENCH_MIX_SINK]     = GB_LOOPBACK_TYPE_SINK,
+    [GBBENCH_MIX_TRANSFER] = GB_LOOPBACK_TYPE_TRANSFER,
+  };
+
+  FAR uint8_t *buf;
+  uint32_t i;
+  size_t len;
+  int ret;
+
+  ret = gbbench_attach(cport);
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR: Can not listen on CPort %u: %d\n", cport, ret);
+      return ret;
+    }
+
+  buf = (FAR uint8_t *)malloc(GBBENCH_MAXMSG);
+  if (!buf)
+    {
+      return -ENOMEM;
+    }
+
+  for (i = 0; i < nops; i++)
+    {
+      len = gbbench_request(buf, mix == GBBENCH_MIX_MIXED ?
+                            types[i % GBBENCH_MIX_MIXED] : types[mix],
+                            size);
+      ret = gbbench_feed(cport, buf, len);
+      if (ret < 0)
+        {
+          break;
+        }
+    }
+
+  free(buf);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: gbbench_load
+ *
+ * Description:
+ *   Load a whole tape file in memory, so that the file system is not timed.
+ *
+ ****************************************************************************/
+
+static FAR uint8_t *gbbench_load(FAR const char *path, FAR size_t *size)
+{
+  FAR uint8_t *tape;
+  struct stat st;
+  size_t nread;
+  ssize_t ret;
+  int fd;
+
+  fd = open(path, O_RDONLY);
+  if (fd < 0)
+    {
+      return NULL;
+    }
+
+  if (fstat(fd, &st) < 0 || (tape = malloc(st.st_size)) == NULL)
+    {
+      close(fd);
+      return NULL;
+    }
+
+  for (nread = 0; nread < (size_t)st.st_size; nread += ret)
+    {
+      ret = read(fd, tape + nread, st.st_size - nread);
+      if (ret <= 0)
+        {
+          free(tape);
+          close(fd);
+          return NULL;
+        }
+    }
+
+  close(fd);
+  *size = st.st_size;
+  return tape;
+}
+
+/****************************************************************************
+ * Name: gbbench_tape
+ *
+ * Description:
+ *   Feed the records of a tape recorded with gb_tape_communication().  Only
+ *   the loopback driver is available here: the requests of the other
+ *   protocols are refused by the Greybus core, which still answers them.
+ *
+ ****************************************************************************/
+
+static int gbbench_tape(FAR const uint8_t *tape, size_t size)
+{
+  struct gb_tape_record_header rec;
+  FAR uint8_t *buf;
+  size_t pos;
+  int ret = OK;
+
+  /* Records are not aligned in the file, copy them first */
+
+  buf = (FAR uint8_t *)malloc(GBBENCH_MAXMSG);
+  if (!buf)
+    {
+      return -ENOMEM;
+    }
+
+  for (pos = 0; pos + sizeof(rec) <= size; pos += sizeof(rec) + rec.size)
+    {
+      memcpy(&rec, tape + pos, sizeof(rec));
+      if (rec.size > GBBENCH_MAXMSG || pos + sizeof(rec) + rec.size > size)
+        {
+          fprintf(stderr, "ERROR: Truncated record at offset %lu\n",
+                  (unsigned long)pos);
+          ret = -EIO;
+          break;
+        }
+
+      if (gbbench_attach(rec.cport) < 0)
+        {
+          g_gbbench.errors++;
+          continue;
+        }
+
+      memcpy(buf, tape + pos + sizeof(rec), rec.size);
+      ret = gbbench_feed(rec.cport, buf, rec.size);
+      if (ret < 0)
+        {
+          break;
+        }
+    }
+
+  free(buf);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: gbbench_percentile
+ *
+ * Description:
+ *   Return the upper bound, in microseconds, of the log2 bucket holding the
+ *   'pct' percentile of the histogram.
+ *
+ ****************************************************************************/
+
+static uint32_t gbbench_percentile(FAR const struct gb_stats_histogram *hist,
+                                   unsigned int pct)
+{
+  uint32_t threshold = ((uint64_t)hist->count * pct + 99) / 100;
+  uint32_t count = 0;
+  int i;
+
+  for (i = 0; i < GB_STATS_BUCKETS - 1; i++)
+    {
+      count += hist->buckets[i];
+      if (count >= threshold)
+        {
+          return 1u << (i + 1);
+        }
+    }
+
+  return hist->max_us;
+}
+
+/****************************************************************************
+ * Name: gbbench_report
+ ****************************************************************************/
+
+static void gbbench_report(uint32_t elapsed_us, uint32_t allocs)
+{
+  struct gb_stats_histogram handler;
+  struct gb_stats_entry entry;
+  uint32_t ops = g_gbbench.ops;
+  int i;
+
+  printf("%lu operations, %lu responses, %lu refused, in %lu us\n",
+         (unsigned long)ops, (unsigned long)g_gbbench.responses,
+         (unsigned long)g_gbbench.errors, (unsigned long)elapsed_us);
+
+  if (elapsed_us > 0)
+    {
+      printf("%lu ops/s\n",
+             (unsigned long)((uint64_t)ops * 1000000 / elapsed_us));
+    }
+
+  if (ops > 0)
+    {
+      printf("%lu heap allocations, %lu.%02lu per op\n",
+             (unsigned long)allocs, (unsigned long)(allocs / ops),
+             (unsigned long)((uint64_t)(allocs % ops) * 100 / ops));
+    }
+
+  /* Merge the handler histograms of all CPorts and operation types */
+
+  memset(&handler, 0, sizeof(handler));
+  for (i = 0; !gb_stats_get(i, &entry); i++)
+    {
+      FAR const struct gb_stats_histogram *hist =
+        &entry.hist[GB_STATS_HANDLER];
+      int j;
+
+      handler.count += hist->count;
+      if (hist->max_us > handler.max_us)
+        {
+          handler.max_us = hist->max_us;
+        }
+
+      for (j = 0; j < GB_STATS_BUCKETS; j++)
+        {
+          handler.buckets[j] += hist->buckets[j];
+        }
+    }
+
+  if (handler.count > 0)
+    {
+      printf("handler latency: p50 < %lu us, p99 < %lu us, max %lu us\n",
+             (unsigned long)gbbench_percentile(&handler, 50),
+             (unsigned long)gbbench_percentile(&handler, 99),
+             (unsigned long)handler.max_us);
+    }
+}
+
+static void gbbench_usage(FAR const char *progname)
+{
+  fprintf(stderr,
+          "USAGE: %s [-n <ops>] [-s <size>] [-m <mix>] [-c <cport>] "
+          "[-w <window>]\n"
+          "       %s -t <tape> [-w <window>]\n"
+          "  mix: ping, sink, transfer or mixed\n",
+          progname, progname);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * gbbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int gbbench_main(int argc, char *argv[])
+#endif
+{
+  FAR const char *tapepath = NULL;
+  FAR uint8_t *tape = NULL;
+  enum gbbench_mix_e mix = GBBENCH_MIX_PING;
+  unsigned int cport = CONFIG_EXAMPLES_GBBENCH_CPORT;
+  uint32_t nops = CONFIG_EXAMPLES_GBBENCH_OPS;
+  int window = CONFIG_EXAMPLES_GBBENCH_WINDOW;
+  struct timespec start;
+  struct timespec end;
+  size_t tapesize = 0;
+  size_t size = 64;
+  uint32_t allocs;
+  int ret;
+  int opt;
+  int i;
+
+  while ((opt = getopt(argc, argv, "n:s:m:c:w:t:")) != ERROR)
+    {
+      switch (opt)
+        {
+          case 'n':
+            nops = strtoul(optarg, NULL, 0);
+            break;
+
+          case 's':
+            size = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'm':
+            for (i = 0; i < GBBENCH_NMIXES; i++)
+              {
+                if (!strcmp(optarg, g_gbbench_mixes[i]))
+                  {
+                    mix = i;
+                    break;
+                  }
+              }
+
+            if (i == GBBENCH_NMIXES)
+              {
+                gbbench_usage(argv[0]);
+                return EXIT_FAILURE;
+              }
+            break;
+
+          case 'c':
+            cport = strtoul(optarg, NULL, 0);
+            break;
+
+          case 'w':
+            window = atoi(optarg);
+            break;
+
+          case 't':
+            tapepath = optarg;
+            break;
+
+          default:
+            gbbench_usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+  if (window < 1 || size > GBBENCH_MAXMSG -
+      sizeof(struct gb_operation_hdr) -
+      sizeof(struct gb_loopback_transfer_request))
+    {
+      gbbench_usage(argv[0]);
+      return EXIT_FAILURE;
+    }
+
+  if (tapepath)
+    {
+      tape = gbbench_load(tapepath, &tapesize);
+      if (!tape)
+        {
+          fprintf(stderr, "ERROR: Can not load %s: %d\n", tapepath, errno);
+          return EXIT_FAILURE;
+        }
+    }
+
+  if (!g_gbbench_initialized)
+    {
+      ret = gb_init(&g_gbbench_transport);
+      if (ret < 0)
+        {
+          fprintf(stderr, "ERROR: gb_init failed: %d\n", ret);
+          free(tape);
+          return EXIT_FAILURE;
+        }
+
+      g_gbbench_initialized = true;
+    }
+
+  g_gbbench.responses = 0;
+  g_gbbench.expected  = 0;
+  g_gbbench.ops       = 0;
+  g_gbbench.errors    = 0;
+  sem_init(&g_gbbench.window, 0, window);
+
+  gb_stats_reset();
+  allocs = gb_stats_allocations();
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  if (tape)
+    {
+      ret = gbbench_tape(tape, tapesize);
+    }
+  else
+    {
+      ret = gbbench_synthetic(cport, mix, nops, size);
+    }
+
+  if (ret == OK)
+    {
+      ret = gbbench_drain(window);
+    }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  allocs = gb_stats_allocations() - allocs;
+
+  if (ret == -ETIMEDOUT)
+    {
+      fprintf(stderr, "ERROR: %lu responses missing\n",
+              (unsigned long)(g_gbbench.expected - g_gbbench.responses));
+    }
+
+  gbbench_report((end.tv_sec - start.tv_sec) * 1000000 +
+                 (end.tv_nsec - start.tv_nsec) / 1000, allocs);
+
+  sem_destroy(&g_gbbench.window);
+  free(tape);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,416 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef CONFIG_DMA_MEMCPY
+#  include <nuttx/dma_memcpy.h>
+#endif
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MEMBENCH_BUFSIZE
+#  define CONFIG_EXAMPLES_MEMBENCH_BUFSIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_MEMBENCH_ITERATIONS
+#  define CONFIG_EXAMPLES_MEMBENCH_ITERATIONS 1000
+#endif
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define MEMBENCH_CLOCK CLOCK_MONOTONIC
+#else
+#  define MEMBENCH_CLOCK CLOCK_REALTIME
+#endif
+
+#define MEMBENCH_MINSIZE   16
+#define MEMBENCH_SLACK     8    /* Room for misalignment past BUFSIZE */
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One benchmark: Run the function under test ('lib') or the reference byte
+ * loop ('ref') on 'size' bytes at 'dst' and 'src'.  The returned value is
+ * compared between the two to check the result.
+ */
+
+struct membench_s
+{
+  FAR const char *name;
+  CODE uintptr_t (*lib)(FAR uint8_t *dst, FAR uint8_t *src, size_t size);
+  CODE uintptr_t (*ref)(FAR uint8_t *dst, FAR uint8_t *src, size_t size);
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/* The library functions */
+
+static uintptr_t lib_memcpy(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  return (uintptr_t)memcpy(dst, src, size);
+}
+
+static uintptr_t lib_memset(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  return (uintptr_t)memset(dst, 0x5a, size);
+}
+
+static uintptr_t lib_memmove(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  /* Overlapping, the destination after the source */
+
+  return (uintptr_t)memmove(src + 4, src, size - 4);
+}
+
+static uintptr_t lib_memcmp(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  return memcmp(dst, src, size) > 0;
+}
+
+static uintptr_t lib_memchr(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  return (uintptr_t)memchr(src, 0xff, size);
+}
+
+static uintptr_t lib_strlen(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  return strlen((FAR const char *)src);
+}
+
+#ifdef CONFIG_DMA_MEMCPY
+/* The DMA copy, compared with memcpy() to find the size from which the
+ * DMA is faster.  The threshold is set to 0, so all the sizes use the DMA.
+ */
+
+static uintptr_t lib_dmacpy(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  return dma_memcpy(dst, src, size) < 0 ? 0 : (uintptr_t)dst;
+}
+#endif
+
+/* Reference byte loops, the way the C library does it when optimized for
+ * size.
+ */
+
+static uintptr_t ref_memcpy(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  FAR uint8_t *d = dst;
+
+  while (size-- > 0)
+    {
+      *d++ = *src++;
+    }
+
+  return (uintptr_t)dst;
+}
+
+static uintptr_t ref_memset(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  FAR uint8_t *d = dst;
+
+  while (size-- > 0)
+    {
+      *d++ = 0x5a;
+    }
+
+  return (uintptr_t)dst;
+}
+
+static uintptr_t ref_memmove(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  FAR uint8_t *d = src + size;
+  FAR uint8_t *s = src + size - 4;
+
+  size -= 4;
+  while (size-- > 0)
+    {
+      *--d = *--s;
+    }
+
+  return (uintptr_t)(src + 4);
+}
+
+static uintptr_t ref_memcmp(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  while (size-- > 0)
+    {
+      if (*dst != *src)
+        {
+          return *dst > *src;
+        }
+
+      dst++;
+      src++;
+    }
+
+  return 0;
+}
+
+static uintptr_t ref_memchr(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  while (size-- > 0)
+    {
+      if (*src == 0xff)
+        {
+          return (uintptr_t)src;
+        }
+
+      src++;
+    }
+
+  return 0;
+}
+
+static uintptr_t ref_strlen(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  FAR const uint8_t *s = src;
+
+  while (*s != '\0')
+    {
+      s++;
+    }
+
+  return s - src;
+}
+
+static const struct membench_s g_membench[] =
+{
+  { "memcpy",  lib_memcpy,  ref_memcpy  },
+  { "memset",  lib_memset,  ref_memset  },
+  { "memmove", lib_memmove, ref_memmove },
+  { "memcmp",  lib_memcmp,  ref_memcmp  },
+  { "memchr",  lib_memchr,  ref_memchr  },
+  { "strlen",  lib_strlen,  ref_strlen  },
+#ifdef CONFIG_DMA_MEMCPY
+  { "dmacpy",  lib_dmacpy,  lib_memcpy  },
+#endif
+};
+
+#define MEMBENCH_NTESTS (sizeof(g_membench) / sizeof(g_membench[0]))
+
+/****************************************************************************
+ * Name: membench_fill
+ *
+ * Description:
+ *   Make both buffers hold the same non-zero pattern, with a NUL at the
+ *   end of the 'size' bytes of 'src' for strlen().  No byte is 0xff, so
+ *   memchr() scans the whole buffer.
+ *
+ ****************************************************************************/
+
+static void membench_fill(FAR uint8_t *dst, FAR uint8_t *src, size_t size)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      src[i] = dst[i] = (i % 254) + 1;
+    }
+
+  src[size - 1] = '\0';
+  dst[size - 1] = '\0';
+}
+
+/****************************************************************************
+ * Name: membench_sum
+ *
+ * Description:
+ *   Checksum both buffers so that the results of the functions that write
+ *   memory can be compared.
+ *
+ ****************************************************************************/
+
+static uint32_t membench_sum(FAR const uint8_t *dst, FAR const uint8_t *src,
+                             size_t size)
+{
+  uint32_t sum = 0;
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      sum = (sum << 1 | sum >> 31) ^ dst[i] ^ ((uint32_t)src[i] << 8);
+    }
+
+  return sum;
+}
+
+/****************************************************************************
+ * Name: membench_time
+ *
+ * Description:
+ *   Return the time in microseconds for CONFIG_EXAMPLES_MEMBENCH_ITERATIONS
+ *   calls of 'func'.
+ *
+ ****************************************************************************/
+
+static unsigned long membench_time(CODE uintptr_t (*func)(FAR uint8_t *,
+                                     FAR uint8_t *, size_t),
+                                   FAR uint8_t *dst, FAR uint8_t *src,
+                                   size_t size)
+{
+  struct timespec start;
+  struct timespec end;
+  int i;
+
+  clock_gettime(MEMBENCH_CLOCK, &start);
+
+  for (i = 0; i < CONFIG_EXAMPLES_MEMBENCH_ITERATIONS; i++)
+    {
+      (void)func(dst, src, size);
+    }
+
+  clock_gettime(MEMBENCH_CLOCK, &end);
+
+  return (end.tv_sec - start.tv_sec) * 1000000 +
+         (end.tv_nsec - start.tv_nsec) / 1000;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * membench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int membench_main(int argc, char *argv[])
+#endif
+{
+  FAR uint8_t *dstbuf;
+  FAR uint8_t *srcbuf;
+  FAR uint8_t *dst;
+  FAR uint8_t *src;
+  unsigned long libus;
+  unsigned long refus;
+  uintptr_t libret;
+  uintptr_t refret;
+  uint32_t libsum;
+  uint32_t refsum;
+#ifdef CONFIG_DMA_MEMCPY
+  size_t threshold;
+#endif
+  size_t size;
+  int align;
+  int errors = 0;
+  int i;
+
+  /* The buffers are word aligned by malloc() */
+
+  dstbuf = (FAR uint8_t *)malloc(CONFIG_EXAMPLES_MEMBENCH_BUFSIZE +
+                                 MEMBENCH_SLACK);
+  srcbuf = (FAR uint8_t *)malloc(CONFIG_EXAMPLES_MEMBENCH_BUFSIZE +
+                                 MEMBENCH_SLACK);
+  if (!dstbuf || !srcbuf)
+    {
+      fprintf(stderr, "ERROR: Failed to allocate buffers\n");
+      free(dstbuf);
+      free(srcbuf);
+      return EXIT_FAILURE;
+    }
+
+#ifdef CONFIG_DMA_MEMCPY
+  if (dma_memcpy_init() < 0)
+    {
+      printf("No DMA channel, dmacpy is done by the CPU\n");
+    }
+
+  threshold = dma_memcpy_set_threshold(0);
+#endif
+
+  printf("%d iterations, times in microseconds\n",
+         CONFIG_EXAMPLES_MEMBENCH_ITERATIONS);
+  printf("%-8s %6s %5s %10s %10s\n", "func", "size", "align", "lib", "ref");
+
+  for (i = 0; i < MEMBENCH_NTESTS; i++)
+    {
+      for (size = MEMBENCH_MINSIZE; size <= CONFIG_EXAMPLES_MEMBENCH_BUFSIZE;
+           size <<= 2)
+        {
+          /* Aligned, and with the destination one byte off */
+
+          for (align = 0; align < 2; align++)
+            {
+              dst = dstbuf + align;
+              src = srcbuf;
+
+              /* Check the result first */
+
+              membench_fill(dst, src, size);
+              libret = g_membench[i].lib(dst, src, size);
+              libsum = membench_sum(dst, src, size);
+              membench_fill(dst, src, size);
+              refret = g_membench[i].ref(dst, src, size);
+              refsum = membench_sum(dst, src, size);
+
+              if (libret != refret || libsum != refsum)
+                {
+                  printf("%-8s %6lu %5d ERROR: %lx != %lx\n",
+                         g_membench[i].name, (unsigned long)size, align,
+                         (unsigned long)libret, (unsigned long)refret);
+                  errors++;
+                  continue;
+                }
+
+              membench_fill(dst, src, size);
+              libus = membench_time(g_membench[i].lib, dst, src, size);
+              membench_fill(dst, src, size);
+              refus = membench_time(g_membench[i].ref, dst, src, size);
+
+              printf("%-8s %6lu %5d %10lu %10lu\n",
+                     g_membench[i].name, (unsigned long)size, align,
+                     libus, refus);
+            }
+        }
+    }
+
+#ifdef CONFIG_DMA_MEMCPY
+  (void)dma_memcpy_set_threshold(threshold);
+#endif
+
+  free(dstbuf);
+  free(srcbuf);
+  return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/mount.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+
+#include <nuttx/fs/fs.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_EXAMPLES_MTDBENCH_BUFSIZE
+#  define CONFIG_EXAMPLES_MTDBENCH_BUFSIZE 4096
+#endif
+
+#ifndef CONFIG_EXAMPLES_MTDBENCH_KBYTES
+#  define CONFIG_EXAMPLES_MTDBENCH_KBYTES 256
+#endif
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define MTDBENCH_CLOCK CLOCK_MONOTONIC
+#else
+#  define MTDBENCH_CLOCK CLOCK_REALTIME
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mtdbench_time
+ *
+ * Description:
+ *   Read 'nsectors' sectors from the start of the device, 'xfer' sectors at
+ *   a time, and return the time taken in microseconds or a negated errno.
+ *
+ ****************************************************************************/
+
+static long mtdbench_time(FAR struct inode *inode, FAR uint8_t *buffer,
+                          size_t nsectors, unsigned int xfer)
+{
+  struct timespec start;
+  struct timespec end;
+  ssize_t nread;
+  size_t sector;
+
+  clock_gettime(MTDBENCH_CLOCK, &start);
+
+  for (sector = 0; sector + xfer <= nsectors; sector += xfer)
+    {
+      nread = inode->u.i_bops->read(inode, buffer, sector, xfer);
+      if (nread < 0)
+        {
+          return (long)nread;
+        }
+    }
+
+  clock_gettime(MTDBENCH_CLOCK, &end);
+
+  return (end.tv_sec - start.tv_sec) * 1000000 +
+         (end.tv_nsec - start.tv_nsec) / 1000;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * mtdbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int mtdbench_main(int argc, char *argv[])
+#endif
+{
+  FAR struct inode *inode;
+  FAR uint8_t *buffer;
+  struct geometry geo;
+  unsigned long kbytes = CONFIG_EXAMPLES_MTDBENCH_KBYTES;
+  unsigned long nbytes;
+  unsigned int xfer;
+  size_t nsectors;
+  size_t maxxfer;
+  long us;
+  int ret;
+
+  if (argc < 2)
+    {
+      fprintf(stderr, "usage: mtdbench <block-device> [<kbytes>]\n");
+      return EXIT_FAILURE;
+    }
+
+  if (argc > 2)
+    {
+      kbytes = strtoul(argv[2], NULL, 0);
+    }
+
+  ret = open_blockdriver(argv[1], MS_RDONLY, &inode);
+  if (ret < 0)
+    {
+      fprintf(stderr, "ERROR: Failed to open %s: %d\n", argv[1], ret);
+      return EXIT_FAILURE;
+    }
+
+  ret = -ENOTTY;
+  if (inode->u.i_bops->geometry)
+    {
+      ret = inode->u.i_bops->geometry(inode, &geo);
+    }
+
+  if (ret < 0 || !geo.geo_available || geo.geo_sectorsize == 0 ||
+      geo.geo_sectorsize > CONFIG_EXAMPLES_MTDBENCH_BUFSIZE)
+    {
+      fprintf(stderr, "ERROR: Unusable geometry: %d\n", ret);
+      goto errout_with_driver;
+    }
+
+  /* Read the same part of the device for all transfer sizes */
+
+  nsectors = (kbytes * 1024) / geo.geo_sectorsize;
+  if (nsectors > geo.geo_nsectors)
+    {
+      nsectors = geo.geo_nsectors;
+    }
+
+  buffer = (FAR uint8_t *)malloc(CONFIG_EXAMPLES_MTDBENCH_BUFSIZE);
+  if (!buffer)
+    {
+      fprintf(stderr, "ERROR: Failed to allocate the buffer\n");
+      goto errout_with_driver;
+    }
+
+  printf("%s: %lu sectors of %lu bytes, reading %lu KiB\n", argv[1],
+         (unsigned long)geo.geo_nsectors, (unsigned long)geo.geo_sectorsize,
+         (unsigned long)(nsectors * geo.geo_sectorsize / 1024));
+  printf("%8s %10s %10s\n", "xfer", "us", "KiB/s");
+
+  maxxfer = CONFIG_EXAMPLES_MTDBENCH_BUFSIZE / geo.geo_sectorsize;
+  if (maxxfer > nsectors)
+    {
+      maxxfer = nsectors;
+    }
+
+  for (xfer = 1; xfer <= maxxfer; xfer <<= 2)
+    {
+      us = mtdbench_time(inode, buffer, nsectors, xfer);
+      if (us < 0)
+        {
+          printf("%8lu ERROR: Read failed: %ld\n",
+                 (unsigned long)(xfer * geo.geo_sectorsize), us);
+          ret = (int)us;
+          break;
+        }
+
+      /* Only whole transfers were read */
+
+      nbytes = (nsectors / xfer) * xfer * geo.geo_sectorsize;
+      if (us == 0)
+        {
+          us = 1;
+        }
+
+      printf("%8lu %10ld %10lu\n",
+             (unsigned long)(xfer * geo.geo_sectorsize), us,
+             (unsigned long)((uint64_t)nbytes * 1000000 / 1024 / us));
+    }
+
+  free(buffer);
+  (void)close_blockdriver(inode);
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+
+errout_with_driver:
+  (void)close_blockdriver(inode);
+  return EXIT_FAILURE;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __APPS_EXAMPLES_NXBENCH_NXBENCH_H
+#define __APPS_EXAMPLES_NXBENCH_NXBENCH_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+
+#include <nuttx/nx/nxglib.h>
+#include <nuttx/nx/nx.h>
+#include <nuttx/video/rgbcolors.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_NX
+#  error "NX is not enabled (CONFIG_NX)"
+#endif
+
+#if defined(CONFIG_NX_MULTIUSER) && !defined(CONFIG_NX_NXSTART)
+#  error "The multi-user NX server must be started with nx_start()"
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_ITERATIONS
+#  define CONFIG_EXAMPLES_NXBENCH_ITERATIONS 100
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_PLANEWIDTH
+#  define CONFIG_EXAMPLES_NXBENCH_PLANEWIDTH 128
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_PLANEHEIGHT
+#  define CONFIG_EXAMPLES_NXBENCH_PLANEHEIGHT 64
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_NWINDOWS
+#  define CONFIG_EXAMPLES_NXBENCH_NWINDOWS 4
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_BPP
+#  define CONFIG_EXAMPLES_NXBENCH_BPP 16
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_VPLANE
+#  define CONFIG_EXAMPLES_NXBENCH_VPLANE 0
+#endif
+
+#ifndef CONFIG_EXAMPLES_NXBENCH_DEVNO
+#  define CONFIG_EXAMPLES_NXBENCH_DEVNO 0
+#endif
+
+/* The nxglib primitives are part of the graphics subsystem and can only be
+ * called directly from the flat build.
+ */
+
+#if !defined(CONFIG_BUILD_PROTECTED) && !defined(CONFIG_BUILD_KERNEL)
+#  define NXBENCH_HAVE_NXGLIB 1
+#endif
+
+#ifdef CONFIG_CLOCK_MONOTONIC
+#  define NXBENCH_CLOCK CLOCK_MONOTONIC
+#else
+#  define NXBENCH_CLOCK CLOCK_REALTIME
+#endif
+
+/* Colors used for the display.  Adjacent windows use different colors so
+ * that the redraws can be seen.
+ */
+
+#if CONFIG_EXAMPLES_NXBENCH_BPP == 24 || CONFIG_EXAMPLES_NXBENCH_BPP == 32
+#  define NXBENCH_BGCOLOR    RGB24_DARKGREEN
+#  define NXBENCH_FONTCOLOR  RGB24_WHITE
+#  define NXBENCH_COLOR0     RGB24_BLUE
+#  define NXBENCH_COLOR1     RGB24_YELLOW
+#elif CONFIG_EXAMPLES_NXBENCH_BPP == 16
+#  define NXBENCH_BGCOLOR    RGB16_DARKGREEN
+#  define NXBENCH_FONTCOLOR  RGB16_WHITE
+#  define NXBENCH_COLOR0     RGB16_BLUE
+#  define NXBENCH_COLOR1     RGB16_YELLOW
+#else
+#  define NXBENCH_BGCOLOR    RGB8_DARKGREEN
+#  define NXBENCH_FONTCOLOR  RGB8_WHITE
+#  define NXBENCH_COLOR0     RGB8_BLUE
+#  define NXBENCH_COLOR1     RGB8_YELLOW
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+struct nxbench_state_s
+{
+  NXHANDLE hnx;                   /* Connection to NX */
+  NXWINDOW hsync;                 /* Off-screen window used by nxbench_sync() */
+  struct nxgl_size_s screen;      /* Size of the display */
+  sem_t syncsem;                  /* Posted by each position report */
+  nxgl_coord_t syncpos;           /* Position last requested by nxbench_sync() */
+  volatile nxgl_coord_t syncseen; /* Position last reported for hsync */
+#ifdef CONFIG_NX_MULTIUSER
+  volatile bool connected;        /* The listener has received a message */
+  volatile bool done;             /* The disconnection is expected */
+#endif
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+extern struct nxbench_state_s g_nxbench;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+/* Time keeping and results (nxbench_main.c) */
+
+unsigned long nxbench_now(void);
+void nxbench_report(FAR const char *name, unsigned long usec,
+                    unsigned int nops);
+int nxbench_sync(void);
+
+/* Memory-only measurements (nxbench_glib.c) */
+
+void nxbench_nxglib(void);
+void nxbench_fonts(void);
+
+/* Measurements through the NX server (nxbench_nx.c) */
+
+int nxbench_windows(void);
+
+#endif /* __APPS_EXAMPLES_NXBENCH_NXBENCH_H */
@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <nuttx/nx/nxglib.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "nxbench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define NXBENCH_PLANESTRIDE \
+  (CONFIG_EXAMPLES_NXBENCH_PLANEWIDTH * 4)
+#define NXBENCH_PLANESIZE \
+  (NXBENCH_PLANESTRIDE * CONFIG_EXAMPLES_NXBENCH_PLANEHEIGHT)
+
+/* The small rectangle used to time the per-call overhead */
+
+#define NXBENCH_SMALLRECT  16
+
+/* The characters rendered by the font measurement */
+
+#define NXBENCH_FIRSTCH    ' '
+#define NXBENCH_LASTCH     '~'
+
+/* The fill functions take the pixel in the type of its depth, so each one
+ * is called through a wrapper with a common prototype.
+ */
+
+#define NXBENCH_FILL(n, t) \
+  static void nxbench_fill##n(FAR NX_PLANEINFOTYPE *pinfo, \
+                              FAR const struct nxgl_rect_s *rect, \
+                              uint32_t color) \
+  { \
+    nxgl_fillrectangle_##n##bpp(pinfo, rect, (t)color); \
+  }
+
+#define NXBENCH_CONVERT(n, t) \
+  static int nxbench_convert##n(FAR void *dest, uint16_t height, \
+                                uint16_t width, uint16_t stride, \
+                                FAR const struct nx_fontbitmap_s *bm, \
+                                nxgl_mxpixel_t color) \
+  { \
+    return nxf_convert_##n##bpp((FAR t *)dest, height, width, stride, bm, \
+                                color); \
+  }
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+#ifdef NXBENCH_HAVE_NXGLIB
+/* The nxglib functions for one pixel depth */
+
+struct nxbench_nxglib_s
+{
+  uint8_t bpp;
+  CODE void (*fill)(FAR NX_PLANEINFOTYPE *pinfo,
+                    FAR const struct nxgl_rect_s *rect, uint32_t color);
+  CODE void (*move)(FAR NX_PLANEINFOTYPE *pinfo,
+                    FAR const struct nxgl_rect_s *rect,
+                    FAR struct nxgl_point_s *offset);
+  CODE void (*copy)(FAR NX_PLANEINFOTYPE *pinfo,
+                    FAR const struct nxgl_rect_s *dest,
+                    FAR const void *src,
+                    FAR const struct nxgl_point_s *origin,
+                    unsigned int srcstride);
+};
+#endif
+
+/* The font renderer for one pixel depth */
+
+struct nxbench_convert_s
+{
+  uint8_t bpp;
+  CODE int (*convert)(FAR void *dest, uint16_t height, uint16_t width,
+                      uint16_t stride, FAR const struct nx_fontbitmap_s *bm,
+                      nxgl_mxpixel_t color);
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+#ifdef NXBENCH_HAVE_NXGLIB
+NXBENCH_FILL(1, uint8_t)
+NXBENCH_FILL(2, uint8_t)
+NXBENCH_FILL(4, uint8_t)
+NXBENCH_FILL(8, uint8_t)
+NXBENCH_FILL(16, uint16_t)
+NXBENCH_FILL(24, uint32_t)
+NXBENCH_FILL(32, uint32_t)
+#endif
+
+NXBENCH_CONVERT(1, uint8_t)
+NXBENCH_CONVERT(2, uint8_t)
+NXBENCH_CONVERT(4, uint8_t)
+NXBENCH_CONVERT(8, uint8_t)
+NXBENCH_CONVERT(16, uint16_t)
+NXBENCH_CONVERT(24, uint32_t)
+NXBENCH_CONVERT(32, uint32_t)
+
+#if defined(NXBENCH_HAVE_NXGLIB) && defined(CONFIG_NX_LCDDRIVER)
+/* The memory "LCD" that the LCD versions of nxglib write through */
+
+static FAR uint8_t *g_lcdmem;
+static uint8_t g_lcdbpp;
+
+/****************************************************************************
+ * Name: nxbench_putrun and nxbench_getrun
+ *
+ * Description:
+ *   Raster line access to the memory plane, standing in for an LCD driver.
+ *
+ ****************************************************************************/
+
+static int nxbench_putrun(fb_coord_t row, fb_coord_t col,
+                          FAR const uint8_t *buffer, size_t npixels)
+{
+  memcpy(g_lcdmem + row * NXBENCH_PLANESTRIDE + ((col * g_lcdbpp) >> 3),
+         buffer, (npixels * g_lcdbpp + 7) >> 3);
+  return OK;
+}
+
+static int nxbench_getrun(fb_coord_t row, fb_coord_t col,
+                          FAR uint8_t *buffer, size_t npixels)
+{
+  memcpy(buffer,
+         g_lcdmem + row * NXBENCH_PLANESTRIDE + ((col * g_lcdbpp) >> 3),
+         (npixels * g_lcdbpp + 7) >> 3);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef NXBENCH_HAVE_NXGLIB
+static const struct nxbench_nxglib_s g_nxglib[] =
+{
+  { 1,  nxbench_fill1,  nxgl_moverectangle_1bpp,  nxgl_copyrectangle_1bpp  },
+  { 2,  nxbench_fill2,  nxgl_moverectangle_2bpp,  nxgl_copyrectangle_2bpp  },
+  { 4,  nxbench_fill4,  nxgl_moverectangle_4bpp,  nxgl_copyrectangle_4bpp  },
+  { 8,  nxbench_fill8,  nxgl_moverectangle_8bpp,  nxgl_copyrectangle_8bpp  },
+  { 16, nxbench_fill16, nxgl_moverectangle_16bpp, nxgl_copyrectangle_16bpp },
+  { 24, nxbench_fill24, nxgl_moverectangle_24bpp, nxgl_copyrectangle_24bpp },
+  { 32, nxbench_fill32, nxgl_moverectangle_32bpp, nxgl_copyrectangle_32bpp },
+};
+
+#define NXBENCH_NNXGLIB (sizeof(g_nxglib) / sizeof(g_nxglib[0]))
+#endif
+
+static const struct nxbench_convert_s g_convert[] =
+{
+  { 1,  nxbench_convert1  },
+  { 2,  nxbench_convert2  },
+  { 4,  nxbench_convert4  },
+  { 8,  nxbench_convert8  },
+  { 16, nxbench_convert16 },
+  { 24, nxbench_convert24 },
+  { 32, nxbench_convert32 },
+};
+
+#define NXBENCH_NCONVERT (sizeof(g_convert) / sizeof(g_convert[0]))
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbench_nxglib
+ *
+ * Description:
+ *   Time the nxglib rectangle primitives for each pixel depth, drawing
+ *   into a memory plane rather than the display:  A full plane fill, a
+ *   small fill, a one row scroll of the whole plane and a full plane copy.
+ *
+ ****************************************************************************/
+
+void nxbench_nxglib(void)
+{
+#ifdef NXBENCH_HAVE_NXGLIB
+  NX_PLANEINFOTYPE pinfo;
+  struct nxgl_rect_s full;
+  struct nxgl_rect_s small;
+  struct nxgl_rect_s scroll;
+  struct nxgl_point_s offset;
+  struct nxgl_point_s origin;
+  FAR uint8_t *plane;
+  FAR uint8_t *image;
+  unsigned long start;
+  char name[32];
+  int i;
+  int j;
+
+  plane = (FAR uint8_t *)malloc(NXBENCH_PLANESIZE);
+  image = (FAR uint8_t *)malloc(NXBENCH_PLANESIZE + NXBENCH_PLANESTRIDE);
+  if (!plane || !image)
+    {
+      printf("nxbench_nxglib: Failed to allocate the memory planes\n");
+      free(plane);
+      free(image);
+      return;
+    }
+
+  memset(image, 0x5a, NXBENCH_PLANESIZE);
+
+  full.pt1.x   = 0;
+  full.pt1.y   = 0;
+  full.pt2.x   = CONFIG_EXAMPLES_NXBENCH_PLANEWIDTH - 1;
+  full.pt2.y   = CONFIG_EXAMPLES_NXBENCH_PLANEHEIGHT - 1;
+
+  small.pt1.x  = 1;
+  small.pt1.y  = 1;
+  small.pt2.x  = NXBENCH_SMALLRECT;
+  small.pt2.y  = NXBENCH_SMALLRECT;
+
+  /* Scroll up by one row:  Move rows 1..n-1 to 0..n-2 */
+
+  scroll.pt1.x = 0;
+  scroll.pt1.y = 1;
+  scroll.pt2.x = full.pt2.x;
+  scroll.pt2.y = full.pt2.y;
+  offset.x     = 0;
+  offset.y     = -1;
+
+  origin.x     = 0;
+  origin.y     = 0;
+
+#ifdef CONFIG_NX_LCDDRIVER
+  pinfo.putrun = nxbench_putrun;
+  pinfo.getrun = nxbench_getrun;
+  pinfo.buffer = image + NXBENCH_PLANESIZE;  /* One line of working memory */
+  g_lcdmem     = plane;
+#else
+  pinfo.fbmem  = plane;
+  pinfo.fblen  = NXBENCH_PLANESIZE;
+  pinfo.stride = NXBENCH_PLANESTRIDE;
+#endif
+
+  printf("nxglib %dx%d memory plane:\n",
+         CONFIG_EXAMPLES_NXBENCH_PLANEWIDTH,
+         CONFIG_EXAMPLES_NXBENCH_PLANEHEIGHT);
+
+  for (i = 0; i < NXBENCH_NNXGLIB; i++)
+    {
+      pinfo.bpp = g_nxglib[i].bpp;
+#ifdef CONFIG_NX_LCDDRIVER
+      g_lcdbpp  = g_nxglib[i].bpp;
+#endif
+
+      start = nxbench_now();
+      for (j = 0; j < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; j++)
+        {
+          g_nxglib[i].fill(&pinfo, &full, j);
+        }
+
+      snprintf(name, sizeof(name), "  fill %dbpp", g_nxglib[i].bpp);
+      nxbench_report(name, nxbench_now() - start,
+                     CONFIG_EXAMPLES_NXBENCH_ITERATIONS);
+
+      start = nxbench_now();
+      for (j = 0; j < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; j++)
+        {
+          g_nxglib[i].fill(&pinfo, &small, j);
+        }
+
+      snprintf(name, sizeof(name), "  fill %dx%d %dbpp", NXBENCH_SMALLRECT,
+               NXBENCH_SMALLRECT, g_nxglib[i].bpp);
+      nxbench_report(name, nxbench_now() - start,
+                     CONFIG_EXAMPLES_NXBENCH_ITERATIONS);
+
+      start = nxbench_now();
+      for (j = 0; j < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; j++)
+        {
+          g_nxglib[i].move(&pinfo, &scroll, &offset);
+        }
+
+      snprintf(name, sizeof(name), "  scroll %dbpp", g_nxglib[i].bpp);
+      nxbench_report(name, nxbench_now() - start,
+                     CONFIG_EXAMPLES_NXBENCH_ITERATIONS);
+
+      start = nxbench_now();
+      for (j = 0; j < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; j++)
+        {
+          g_nxglib[i].copy(&pinfo, &full, image, &origin,
+                           NXBENCH_PLANESTRIDE);
+        }
+
+      snprintf(name, sizeof(name), "  copy %dbpp", g_nxglib[i].bpp);
+      nxbench_report(name, nxbench_now() - start,
+                     CONFIG_EXAMPLES_NXBENCH_ITERATIONS);
+    }
+
+  free(plane);
+  free(image);
+#else
+  printf("nxglib: Not available in this build\n");
+#endif
+}
+
+/****************************************************************************
+ * Name: nxbench_fonts
+ *
+ * Description:
+ *   Time rendering the printable ASCII glyphs of the default font into a
+ *   memory buffer for each pixel depth.
+ *
+ ****************************************************************************/
+
+void nxbench_fonts(void)
+{
+  FAR const struct nx_fontbitmap_s *bm;
+  FAR const struct nx_font_s *font;
+  FAR uint8_t *glyph;
+  unsigned long start;
+  NXHANDLE hfont;
+  unsigned int nglyphs;
+  uint16_t stride;
+  char name[32];
+  int ch;
+  int i;
+  int j;
+
+  hfont = nxf_getfonthandle(NXFONT_DEFAULT);
+  if (!hfont)
+    {
+      printf("nxbench_fonts: Failed to get the default font\n");
+      return;
+    }
+
+  font  = nxf_getfontset(hfont);
+  glyph = (FAR uint8_t *)malloc(font->mxwidth * 4 * font->mxheight);
+  if (!glyph)
+    {
+      printf("nxbench_fonts: Failed to allocate the glyph buffer\n");
+      return;
+    }
+
+  printf("nxfonts %dx%d glyphs:\n", font->mxwidth, font->mxheight);
+
+  for (i = 0; i < NXBENCH_NCONVERT; i++)
+    {
+      stride  = (font->mxwidth * g_convert[i].bpp + 7) >> 3;
+      nglyphs = 0;
+
+      start = nxbench_now();
+      for (j = 0; j < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; j++)
+        {
+          for (ch = NXBENCH_FIRSTCH; ch <= NXBENCH_LASTCH; ch++)
+            {
+              bm = nxf_getbitmap(hfont, ch);
+              if (bm)
+                {
+                  memset(glyph, 0, stride * font->mxheight);
+                  (void)g_convert[i].convert(glyph, font->mxheight,
+                                             font->mxwidth, stride, bm, 1);
+                  nglyphs++;
+                }
+            }
+        }
+
+      snprintf(name, sizeof(name), "  glyph %dbpp", g_convert[i].bpp);
+      nxbench_report(name, nxbench_now() - start, nglyphs);
+    }
+
+  free(glyph);
+}
@@ -0,0 +1,419 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <semaphore.h>
+#include <errno.h>
+
+#ifdef CONFIG_NX_MULTIUSER
+#  include <pthread.h>
+#else
+#  ifdef CONFIG_NX_LCDDRIVER
+#    include <nuttx/lcd/lcd.h>
+#  else
+#    include <nuttx/video/fb.h>
+#  endif
+#endif
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxglib.h>
+
+#include "nxbench.h"
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void nxbench_syncredraw(NXWINDOW hwnd,
+                               FAR const struct nxgl_rect_s *rect,
+                               bool more, FAR void *arg);
+static void nxbench_syncposition(NXWINDOW hwnd,
+                                 FAR const struct nxgl_size_s *size,
+                                 FAR const struct nxgl_point_s *pos,
+                                 FAR const struct nxgl_rect_s *bounds,
+                                 FAR void *arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Callbacks of the off-screen window that nxbench_sync() moves */
+
+static const struct nx_callback_s g_synccb =
+{
+  nxbench_syncredraw,   /* redraw */
+  nxbench_syncposition  /* position */
+#ifdef CONFIG_NX_XYINPUT
+  , NULL                /* mousein */
+#endif
+#ifdef CONFIG_NX_KBD
+  , NULL                /* kbdin */
+#endif
+};
+
+/****************************************************************************
+ * Public Data
+ ****************************************************************************/
+
+struct nxbench_state_s g_nxbench;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbench_syncredraw and nxbench_syncposition
+ *
+ * Description:
+ *   The sync window is never visible, so there is nothing to redraw.  Its
+ *   position reports tell nxbench_sync() that the server has caught up,
+ *   and give the size of the display.
+ *
+ ****************************************************************************/
+
+static void nxbench_syncredraw(NXWINDOW hwnd,
+                               FAR const struct nxgl_rect_s *rect,
+                               bool more, FAR void *arg)
+{
+}
+
+static void nxbench_syncposition(NXWINDOW hwnd,
+                                 FAR const struct nxgl_size_s *size,
+                                 FAR const struct nxgl_point_s *pos,
+                                 FAR const struct nxgl_rect_s *bounds,
+                                 FAR void *arg)
+{
+  g_nxbench.screen.w = bounds->pt2.x + 1;
+  g_nxbench.screen.h = bounds->pt2.y + 1;
+  g_nxbench.syncseen = pos->x;
+  sem_post(&g_nxbench.syncsem);
+}
+
+#ifdef CONFIG_NX_MULTIUSER
+/****************************************************************************
+ * Name: nxbench_listener
+ *
+ * Description:
+ *   Service the server messages for the whole run.  The callbacks of all
+ *   windows run on this thread.
+ *
+ ****************************************************************************/
+
+static FAR void *nxbench_listener(FAR void *arg)
+{
+  for (;;)
+    {
+      if (nx_eventhandler(g_nxbench.hnx) < 0)
+        {
+          if (g_nxbench.done)
+            {
+              return NULL;
+            }
+
+          printf("nxbench_listener: Lost server connection: %d\n", errno);
+          exit(EXIT_FAILURE);
+        }
+
+      if (!g_nxbench.connected)
+        {
+          g_nxbench.connected = true;
+          sem_post(&g_nxbench.syncsem);
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxbench_initialize
+ *
+ * Description:
+ *   Start the NX server, connect to it and start the listener thread.
+ *
+ ****************************************************************************/
+
+static int nxbench_initialize(void)
+{
+  pthread_t thread;
+  int ret;
+
+  ret = nx_start();
+  if (ret < 0)
+    {
+      printf("nxbench_initialize: nx_start failed: %d\n", ret);
+      return ERROR;
+    }
+
+  g_nxbench.hnx = nx_connect();
+  if (!g_nxbench.hnx)
+    {
+      printf("nxbench_initialize: nx_connect failed: %d\n", errno);
+      return ERROR;
+    }
+
+  ret = pthread_create(&thread, NULL, nxbench_listener, NULL);
+  if (ret != 0)
+    {
+      printf("nxbench_initialize: pthread_create failed: %d\n", ret);
+      nx_disconnect(g_nxbench.hnx);
+      return ERROR;
+    }
+
+  while (!g_nxbench.connected)
+    {
+      (void)sem_wait(&g_nxbench.syncsem);
+    }
+
+  return OK;
+}
+#else
+/****************************************************************************
+ * Name: nxbench_initialize
+ *
+ * Description:
+ *   Initialize the graphics device and open NX on it.
+ *
+ ****************************************************************************/
+
+static int nxbench_initialize(void)
+{
+  FAR NX_DRIVERTYPE *dev;
+  int ret;
+
+#ifdef CONFIG_NX_LCDDRIVER
+  ret = up_lcdinitialize();
+  if (ret < 0)
+    {
+      printf("nxbench_initialize: up_lcdinitialize failed: %d\n", -ret);
+      return ERROR;
+    }
+
+  dev = up_lcdgetdev(CONFIG_EXAMPLES_NXBENCH_DEVNO);
+  if (!dev)
+    {
+      printf("nxbench_initialize: up_lcdgetdev failed, devno=%d\n",
+             CONFIG_EXAMPLES_NXBENCH_DEVNO);
+      return ERROR;
+    }
+
+  (void)dev->setpower(dev, CONFIG_LCD_MAXPOWER);
+#else
+  ret = up_fbinitialize();
+  if (ret < 0)
+    {
+      printf("nxbench_initialize: up_fbinitialize failed: %d\n", -ret);
+      return ERROR;
+    }
+
+  dev = up_fbgetvplane(CONFIG_EXAMPLES_NXBENCH_VPLANE);
+  if (!dev)
+    {
+      printf("nxbench_initialize: up_fbgetvplane failed, vplane=%d\n",
+             CONFIG_EXAMPLES_NXBENCH_VPLANE);
+      return ERROR;
+    }
+#endif
+
+  g_nxbench.hnx = nx_open(dev);
+  if (!g_nxbench.hnx)
+    {
+      printf("nxbench_initialize: nx_open failed: %d\n", errno);
+      return ERROR;
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbench_now
+ *
+ * Description:
+ *   Return the current time in microseconds.
+ *
+ ****************************************************************************/
+
+unsigned long nxbench_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(NXBENCH_CLOCK, &ts);
+  return (unsigned long)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/****************************************************************************
+ * Name: nxbench_report
+ *
+ * Description:
+ *   Print one result: 'nops' operations took 'usec' microseconds.
+ *
+ ****************************************************************************/
+
+void nxbench_report(FAR const char *name, unsigned long usec,
+                    unsigned int nops)
+{
+  unsigned long rate = 0;
+
+  if (nops == 0)
+    {
+      printf("%-28s %10s\n", name, "-");
+      return;
+    }
+
+  if (usec > 0)
+    {
+      rate = (unsigned long)(((uint64_t)nops * 1000000) / usec);
+    }
+
+  printf("%-28s %10lu %10lu %10lu\n", name, usec, usec / nops, rate);
+}
+
+/****************************************************************************
+ * Name: nxbench_sync
+ *
+ * Description:
+ *   Wait until the NX server has executed every request sent so far.  The
+ *   sync window is moved between two off-screen positions; the server
+ *   handles requests in order, so once the new position is reported, all
+ *   earlier drawing is on the display.  In the single-user configuration
+ *   the requests are executed before they return and this returns at once.
+ *
+ ****************************************************************************/
+
+int nxbench_sync(void)
+{
+  struct nxgl_point_s pos;
+  int ret;
+
+  g_nxbench.syncpos = g_nxbench.syncpos == -2 ? -3 : -2;
+  pos.x = g_nxbench.syncpos;
+  pos.y = g_nxbench.syncpos;
+
+  ret = nx_setposition(g_nxbench.hsync, &pos);
+  if (ret < 0)
+    {
+      printf("nxbench_sync: nx_setposition failed: %d\n", errno);
+      return ret;
+    }
+
+  while (g_nxbench.syncseen != g_nxbench.syncpos)
+    {
+      (void)sem_wait(&g_nxbench.syncsem);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxbench_main
+ ****************************************************************************/
+
+#ifdef CONFIG_BUILD_KERNEL
+int main(int argc, FAR char *argv[])
+#else
+int nxbench_main(int argc, char *argv[])
+#endif
+{
+  struct nxgl_size_s size;
+  nxgl_mxpixel_t color[CONFIG_NX_NPLANES];
+  int ret;
+  int i;
+
+  printf("%d iterations, times in microseconds\n",
+         CONFIG_EXAMPLES_NXBENCH_ITERATIONS);
+  printf("%-28s %10s %10s %10s\n", "test", "total", "per op", "op/s");
+
+  /* The measurements that need no display */
+
+  nxbench_nxglib();
+  nxbench_fonts();
+
+  /* Then the ones through NX */
+
+  sem_init(&g_nxbench.syncsem, 0, 0);
+
+  ret = nxbench_initialize();
+  if (ret < 0)
+    {
+      return EXIT_FAILURE;
+    }
+
+  for (i = 0; i < CONFIG_NX_NPLANES; i++)
+    {
+      color[i] = NXBENCH_BGCOLOR;
+    }
+
+  (void)nx_setbgcolor(g_nxbench.hnx, color);
+
+  g_nxbench.hsync = nx_openwindow(g_nxbench.hnx, &g_synccb, NULL);
+  if (!g_nxbench.hsync)
+    {
+      printf("nxbench_main: nx_openwindow failed: %d\n", errno);
+      ret = ERROR;
+      goto errout_with_nx;
+    }
+
+  size.w = 1;
+  size.h = 1;
+  (void)nx_setsize(g_nxbench.hsync, &size);
+
+  /* The first sync also reports the display size */
+
+  ret = nxbench_sync();
+  if (ret >= 0)
+    {
+      printf("Display %dx%d, %d bpp\n", g_nxbench.screen.w,
+             g_nxbench.screen.h, CONFIG_EXAMPLES_NXBENCH_BPP);
+      ret = nxbench_windows();
+    }
+
+  (void)nx_closewindow(g_nxbench.hsync);
+
+errout_with_nx:
+#ifdef CONFIG_NX_MULTIUSER
+  g_nxbench.done = true;
+  nx_disconnect(g_nxbench.hnx);
+#else
+  nx_close(g_nxbench.hnx);
+#endif
+  return ret < 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
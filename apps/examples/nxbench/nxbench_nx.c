@@ -0,0 +1,513 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxglib.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "nxbench.h"
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The font renderer and pixel type for the display depth */
+
+#if CONFIG_EXAMPLES_NXBENCH_BPP == 1
+#  define NXBENCH_RENDERER nxf_convert_1bpp
+#  define NXBENCH_PIXEL    uint8_t
+#elif CONFIG_EXAMPLES_NXBENCH_BPP == 2
+#  define NXBENCH_RENDERER nxf_convert_2bpp
+#  define NXBENCH_PIXEL    uint8_t
+#elif CONFIG_EXAMPLES_NXBENCH_BPP == 4
+#  define NXBENCH_RENDERER nxf_convert_4bpp
+#  define NXBENCH_PIXEL    uint8_t
+#elif CONFIG_EXAMPLES_NXBENCH_BPP == 8
+#  define NXBENCH_RENDERER nxf_convert_8bpp
+#  define NXBENCH_PIXEL    uint8_t
+#elif CONFIG_EXAMPLES_NXBENCH_BPP == 16
+#  define NXBENCH_RENDERER nxf_convert_16bpp
+#  define NXBENCH_PIXEL    uint16_t
+#elif CONFIG_EXAMPLES_NXBENCH_BPP == 24
+#  define NXBENCH_RENDERER nxf_convert_24bpp
+#  define NXBENCH_PIXEL    uint32_t
+#elif CONFIG_EXAMPLES_NXBENCH_BPP == 32
+#  define NXBENCH_RENDERER nxf_convert_32bpp
+#  define NXBENCH_PIXEL    uint32_t
+#else
+#  error "Unsupported CONFIG_EXAMPLES_NXBENCH_BPP"
+#endif
+
+/* Size of the small fills and of the bitmap blitted */
+
+#define NXBENCH_SMALLRECT  16
+#define NXBENCH_BITMAPSIZE 64
+#define NXBENCH_BITMAPSTRIDE \
+  ((NXBENCH_BITMAPSIZE * CONFIG_EXAMPLES_NXBENCH_BPP + 7) >> 3)
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static void nxbench_redraw(NXWINDOW hwnd, FAR const struct nxgl_rect_s *rect,
+                           bool more, FAR void *arg);
+static void nxbench_position(NXWINDOW hwnd,
+                             FAR const struct nxgl_size_s *size,
+                             FAR const struct nxgl_point_s *pos,
+                             FAR const struct nxgl_rect_s *bounds,
+                             FAR void *arg);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct nx_callback_s g_nxbenchcb =
+{
+  nxbench_redraw,   /* redraw */
+  nxbench_position  /* position */
+#ifdef CONFIG_NX_XYINPUT
+  , NULL            /* mousein */
+#endif
+#ifdef CONFIG_NX_KBD
+  , NULL            /* kbdin */
+#endif
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbench_color
+ ****************************************************************************/
+
+static nxgl_mxpixel_t nxbench_color(int index)
+{
+  return (index & 1) ? NXBENCH_COLOR1 : NXBENCH_COLOR0;
+}
+
+/****************************************************************************
+ * Name: nxbench_redraw
+ *
+ * Description:
+ *   Windows are a solid color, so an exposure costs a real fill.  'arg' is
+ *   the index of the window.
+ *
+ ****************************************************************************/
+
+static void nxbench_redraw(NXWINDOW hwnd, FAR const struct nxgl_rect_s *rect,
+                           bool more, FAR void *arg)
+{
+  nxgl_mxpixel_t color[CONFIG_NX_NPLANES];
+  int i;
+
+  for (i = 0; i < CONFIG_NX_NPLANES; i++)
+    {
+      color[i] = nxbench_color((int)(uintptr_t)arg);
+    }
+
+  (void)nx_fill(hwnd, rect, color);
+}
+
+/****************************************************************************
+ * Name: nxbench_position
+ ****************************************************************************/
+
+static void nxbench_position(NXWINDOW hwnd,
+                             FAR const struct nxgl_size_s *size,
+                             FAR const struct nxgl_point_s *pos,
+                             FAR const struct nxgl_rect_s *bounds,
+                             FAR void *arg)
+{
+}
+
+/****************************************************************************
+ * Name: nxbench_openwindow
+ ****************************************************************************/
+
+static NXWINDOW nxbench_openwindow(int index, nxgl_coord_t x, nxgl_coord_t y,
+                                   FAR const struct nxgl_size_s *size)
+{
+  struct nxgl_point_s pos;
+  NXWINDOW hwnd;
+
+  hwnd = nx_openwindow(g_nxbench.hnx, &g_nxbenchcb,
+                       (FAR void *)(uintptr_t)index);
+  if (!hwnd)
+    {
+      printf("nxbench_openwindow: nx_openwindow failed: %d\n", errno);
+      return NULL;
+    }
+
+  pos.x = x;
+  pos.y = y;
+  (void)nx_setsize(hwnd, size);
+  (void)nx_setposition(hwnd, &pos);
+  return hwnd;
+}
+
+/****************************************************************************
+ * Name: nxbench_fills
+ *
+ * Description:
+ *   Time full window fills, and small fills spread over the window (with
+ *   and without batching when it is available).
+ *
+ ****************************************************************************/
+
+static void nxbench_fills(NXWINDOW hwnd, FAR const struct nxgl_size_s *size)
+{
+  nxgl_mxpixel_t color[CONFIG_NX_NPLANES];
+  struct nxgl_rect_s rect;
+  unsigned long start;
+  int batch;
+  int i;
+  int j;
+
+  rect.pt1.x = 0;
+  rect.pt1.y = 0;
+  rect.pt2.x = size->w - 1;
+  rect.pt2.y = size->h - 1;
+
+  start = nxbench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; i++)
+    {
+      for (j = 0; j < CONFIG_NX_NPLANES; j++)
+        {
+          color[j] = nxbench_color(i);
+        }
+
+      (void)nx_fill(hwnd, &rect, color);
+    }
+
+  (void)nxbench_sync();
+  nxbench_report("nx fill window", nxbench_now() - start,
+                 CONFIG_EXAMPLES_NXBENCH_ITERATIONS);
+
+#ifdef CONFIG_NX_BATCH
+  for (batch = 0; batch < 2; batch++)
+#else
+  for (batch = 0; batch < 1; batch++)
+#endif
+    {
+      (void)nx_batch(g_nxbench.hnx, batch != 0);
+
+      start = nxbench_now();
+      for (i = 0; i < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; i++)
+        {
+          rect.pt1.x = (i * NXBENCH_SMALLRECT) %
+                       (size->w - NXBENCH_SMALLRECT);
+          rect.pt1.y = ((i * 7) % (size->h - NXBENCH_SMALLRECT));
+          rect.pt2.x = rect.pt1.x + NXBENCH_SMALLRECT - 1;
+          rect.pt2.y = rect.pt1.y + NXBENCH_SMALLRECT - 1;
+
+          for (j = 0; j < CONFIG_NX_NPLANES; j++)
+            {
+              color[j] = nxbench_color(i + 1);
+            }
+
+          (void)nx_fill(hwnd, &rect, color);
+        }
+
+      (void)nx_flush(g_nxbench.hnx);
+      (void)nxbench_sync();
+      nxbench_report(batch ? "nx fill 16x16 batched" : "nx fill 16x16",
+                     nxbench_now() - start,
+                     CONFIG_EXAMPLES_NXBENCH_ITERATIONS);
+
+      (void)nx_batch(g_nxbench.hnx, false);
+    }
+}
+
+/****************************************************************************
+ * Name: nxbench_bitmaps
+ *
+ * Description:
+ *   Time blits of a square image, and of font glyphs rendered at the
+ *   display depth as nxtext does.
+ *
+ ****************************************************************************/
+
+static void nxbench_bitmaps(NXWINDOW hwnd, FAR const struct nxgl_size_s *size)
+{
+  FAR const struct nx_fontbitmap_s *bm;
+  FAR const struct nx_font_s *font;
+  FAR const void *src[CONFIG_NX_NPLANES];
+  struct nxgl_rect_s rect;
+  struct nxgl_point_s origin;
+  FAR uint8_t *image;
+  unsigned long start;
+  unsigned int nglyphs;
+  NXHANDLE hfont;
+  uint16_t stride;
+  int i;
+  int j;
+
+  if (size->w < NXBENCH_BITMAPSIZE || size->h < NXBENCH_BITMAPSIZE)
+    {
+      return;
+    }
+
+  image = (FAR uint8_t *)malloc(NXBENCH_BITMAPSTRIDE * NXBENCH_BITMAPSIZE);
+  if (!image)
+    {
+      printf("nxbench_bitmaps: Failed to allocate the image\n");
+      return;
+    }
+
+  for (i = 0; i < NXBENCH_BITMAPSTRIDE * NXBENCH_BITMAPSIZE; i++)
+    {
+      image[i] = (uint8_t)i;
+    }
+
+  for (j = 0; j < CONFIG_NX_NPLANES; j++)
+    {
+      src[j] = image;
+    }
+
+  start = nxbench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; i++)
+    {
+      rect.pt1.x = (i * 8) % (size->w - NXBENCH_BITMAPSIZE + 1);
+      rect.pt1.y = (i * 3) % (size->h - NXBENCH_BITMAPSIZE + 1);
+      rect.pt2.x = rect.pt1.x + NXBENCH_BITMAPSIZE - 1;
+      rect.pt2.y = rect.pt1.y + NXBENCH_BITMAPSIZE - 1;
+
+      (void)nx_bitmap(hwnd, &rect, src, &rect.pt1, NXBENCH_BITMAPSTRIDE);
+    }
+
+  (void)nxbench_sync();
+  nxbench_report("nx bitmap 64x64", nxbench_now() - start,
+                 CONFIG_EXAMPLES_NXBENCH_ITERATIONS);
+
+  /* Text: Render each glyph (into the same buffer) and blit it, wrapping
+   * across the window.
+   */
+
+  hfont = nxf_getfonthandle(NXFONT_DEFAULT);
+  font  = hfont ? nxf_getfontset(hfont) : NULL;
+  if (!font || font->mxwidth * font->mxheight * 4 >
+               NXBENCH_BITMAPSTRIDE * NXBENCH_BITMAPSIZE)
+    {
+      free(image);
+      return;
+    }
+
+  stride     = (font->mxwidth * CONFIG_EXAMPLES_NXBENCH_BPP + 7) >> 3;
+  origin.x   = 0;
+  origin.y   = 0;
+  nglyphs    = 0;
+
+  start = nxbench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; i++)
+    {
+      for (j = ' '; j <= '~'; j++)
+        {
+          bm = nxf_getbitmap(hfont, j);
+          if (!bm)
+            {
+              continue;
+            }
+
+          memset(image, 0, stride * font->mxheight);
+          (void)NXBENCH_RENDERER((FAR NXBENCH_PIXEL *)image, font->mxheight,
+                                 font->mxwidth, stride, bm,
+                                 NXBENCH_FONTCOLOR);
+
+          rect.pt1.x = origin.x;
+          rect.pt1.y = origin.y;
+          rect.pt2.x = origin.x + bm->metric.width - 1;
+          rect.pt2.y = origin.y + bm->metric.height - 1;
+          if (bm->metric.width > 0 && bm->metric.height > 0 &&
+              rect.pt2.x < size->w && rect.pt2.y < size->h)
+            {
+              (void)nx_bitmap(hwnd, &rect, src, &origin, stride);
+            }
+
+          nglyphs++;
+
+          /* Advance to the next character cell */
+
+          origin.x += font->mxwidth;
+          if (origin.x + font->mxwidth > size->w)
+            {
+              origin.x  = 0;
+              origin.y += font->mxheight;
+              if (origin.y + font->mxheight > size->h)
+                {
+                  origin.y = 0;
+                }
+            }
+        }
+    }
+
+  (void)nxbench_sync();
+  nxbench_report("nx text glyph", nxbench_now() - start, nglyphs);
+
+  free(image);
+}
+
+/****************************************************************************
+ * Name: nxbench_stack
+ *
+ * Description:
+ *   Open CONFIG_EXAMPLES_NXBENCH_NWINDOWS overlapping windows, then time
+ *   dragging the top one across the others and raising each in turn.  Each
+ *   operation exposes parts of the windows below, which are redrawn.
+ *
+ ****************************************************************************/
+
+static void nxbench_stack(FAR const struct nxgl_size_s *size)
+{
+  NXWINDOW hwnd[CONFIG_EXAMPLES_NXBENCH_NWINDOWS];
+  struct nxgl_point_s pos;
+  nxgl_coord_t xstep;
+  nxgl_coord_t ystep;
+  unsigned long start;
+  char name[32];
+  int nwindows;
+  int i;
+
+  xstep = (g_nxbench.screen.w - size->w) /
+          (CONFIG_EXAMPLES_NXBENCH_NWINDOWS + 1);
+  ystep = (g_nxbench.screen.h - size->h) /
+          (CONFIG_EXAMPLES_NXBENCH_NWINDOWS + 1);
+
+  for (nwindows = 0; nwindows < CONFIG_EXAMPLES_NXBENCH_NWINDOWS; nwindows++)
+    {
+      hwnd[nwindows] = nxbench_openwindow(nwindows, (nwindows + 1) * xstep,
+                                          (nwindows + 1) * ystep, size);
+      if (!hwnd[nwindows])
+        {
+          break;
+        }
+    }
+
+  if (nwindows < 1)
+    {
+      return;
+    }
+
+  (void)nxbench_sync();
+
+  /* Drag the top window back and forth along the diagonal */
+
+  start = nxbench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; i++)
+    {
+      int step = i % (2 * nwindows);
+
+      if (step > nwindows)
+        {
+          step = 2 * nwindows - step;
+        }
+
+      pos.x = step * xstep;
+      pos.y = step * ystep;
+      (void)nx_setposition(hwnd[nwindows - 1], &pos);
+    }
+
+  (void)nxbench_sync();
+  snprintf(name, sizeof(name), "nx move window (%d)", nwindows);
+  nxbench_report(name, nxbench_now() - start,
+                 CONFIG_EXAMPLES_NXBENCH_ITERATIONS);
+
+  /* Raise each window in turn, bottom first */
+
+  start = nxbench_now();
+  for (i = 0; i < CONFIG_EXAMPLES_NXBENCH_ITERATIONS; i++)
+    {
+      (void)nx_raise(hwnd[i % nwindows]);
+    }
+
+  (void)nxbench_sync();
+  snprintf(name, sizeof(name), "nx raise window (%d)", nwindows);
+  nxbench_report(name, nxbench_now() - start,
+                 CONFIG_EXAMPLES_NXBENCH_ITERATIONS);
+
+  for (i = 0; i < nwindows; i++)
+    {
+      (void)nx_closewindow(hwnd[i]);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbench_windows
+ *
+ * Description:
+ *   Run the measurements that go through the NX server.  Each one ends with
+ *   nxbench_sync(), so the times include the drawing, not just sending the
+ *   requests.
+ *
+ ****************************************************************************/
+
+int nxbench_windows(void)
+{
+  struct nxgl_size_s size;
+  NXWINDOW hwnd;
+
+  size.w = g_nxbench.screen.w / 2;
+  size.h = g_nxbench.screen.h / 2;
+  if (size.w <= NXBENCH_SMALLRECT || size.h <= NXBENCH_SMALLRECT)
+    {
+      printf("nxbench_windows: The display is too small\n");
+      return ERROR;
+    }
+
+  hwnd = nxbench_openwindow(0, size.w / 2, size.h / 2, &size);
+  if (!hwnd)
+    {
+      return ERROR;
+    }
+
+  (void)nxbench_sync();
+
+  nxbench_fills(hwnd, &size);
+  nxbench_bitmaps(hwnd, &size);
+
+  (void)nx_closewindow(hwnd);
+
+  nxbench_stack(&size);
+  return OK;
+}
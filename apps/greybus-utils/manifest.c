@@ -52,6 +52,7 @@ extern void gb_uart_register(int cport);
 extern void gb_hid_register(int cport);
 extern void gb_mods_display_register(int cport);
 extern void gb_raw_register(int cport);
+extern void gb_raw_net_register(int cport);
 extern void gb_vendor_register(int cport);
 extern void gb_lights_register(int cport);
 extern void gb_sdio_register(int cport);
@@ -76,6 +77,178 @@ static const unsigned char bridge_manifest[] = {
 #include "manifest.inc"
 };
 
+#ifdef CONFIG_GREYBUS_MANIFEST_PRECOMPILED
+/*
+ * The CPorts of bridge_manifest, compiled by mkcports.py at build time so
+ * that they can be enabled without parsing the manifest or allocating the
+ * CPort list.
+ */
+#ifdef CONFIG_GREYBUS_CONTROL_PROTOCOL
+#define GB_DRIVER_CONTROL gb_control_register
+#else
+#define GB_DRIVER_CONTROL NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_GPIO_PHY
+#define GB_DRIVER_GPIO gb_gpio_register
+#else
+#define GB_DRIVER_GPIO NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_I2C_PHY
+#define GB_DRIVER_I2C gb_i2c_register
+#else
+#define GB_DRIVER_I2C NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_UART_PHY
+#define GB_DRIVER_UART gb_uart_register
+#else
+#define GB_DRIVER_UART NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_HID
+#define GB_DRIVER_HID gb_hid_register
+#else
+#define GB_DRIVER_HID NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_USB_HOST_PHY
+#define GB_DRIVER_USB gb_usb_register
+#else
+#define GB_DRIVER_USB NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_SDIO_PHY
+#define GB_DRIVER_SDIO gb_sdio_register
+#else
+#define GB_DRIVER_SDIO NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_BATTERY
+#define GB_DRIVER_BATTERY gb_battery_register
+#else
+#define GB_DRIVER_BATTERY NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_PWM_PHY
+#define GB_DRIVER_PWM gb_pwm_register
+#else
+#define GB_DRIVER_PWM NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_MODS_I2S_PHY
+#define GB_DRIVER_I2S_MGMT gb_i2s_direct_mgmt_register
+#else
+#define GB_DRIVER_I2S_MGMT NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_SPI_PHY
+#define GB_DRIVER_SPI gb_spi_register
+#else
+#define GB_DRIVER_SPI NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_LIGHTS
+#define GB_DRIVER_LIGHTS gb_lights_register
+#else
+#define GB_DRIVER_LIGHTS NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_VIBRATOR
+#define GB_DRIVER_VIBRATOR gb_vibrator_register
+#else
+#define GB_DRIVER_VIBRATOR NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_LOOPBACK
+#define GB_DRIVER_LOOPBACK gb_loopback_register
+#else
+#define GB_DRIVER_LOOPBACK NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_FIRMWARE
+#define GB_DRIVER_FIRMWARE gb_firmware_register
+#else
+#define GB_DRIVER_FIRMWARE NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_SENSORS_EXT
+#define GB_DRIVER_SENSORS_EXT gb_sensors_ext_register
+#else
+#define GB_DRIVER_SENSORS_EXT NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_USB_EXT
+#define GB_DRIVER_USB_EXT gb_usb_ext_register
+#else
+#define GB_DRIVER_USB_EXT NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_CAMERA_EXT
+#define GB_DRIVER_CAMERA_EXT gb_camera_ext_register
+#else
+#define GB_DRIVER_CAMERA_EXT NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_MODS_DISPLAY
+#define GB_DRIVER_MODS_DISPLAY gb_mods_display_register
+#else
+#define GB_DRIVER_MODS_DISPLAY NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_PTP
+#define GB_DRIVER_PTP gb_ptp_register
+#else
+#define GB_DRIVER_PTP NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_MODS_I2S_PHY
+#define GB_DRIVER_MODS_AUDIO gb_aud_register
+#else
+#define GB_DRIVER_MODS_AUDIO NULL
+#endif
+
+#if defined(CONFIG_GREYBUS_RAW_NET)
+#define GB_DRIVER_RAW gb_raw_net_register
+#elif defined(CONFIG_GREYBUS_RAW)
+#define GB_DRIVER_RAW gb_raw_register
+#else
+#define GB_DRIVER_RAW NULL
+#endif
+
+#ifdef CONFIG_GREYBUS_VENDOR
+#define GB_DRIVER_VENDOR gb_vendor_register
+#else
+#define GB_DRIVER_VENDOR NULL
+#endif
+
+/* Protocols without a driver on this side */
+#define GB_DRIVER_AP NULL
+#define GB_DRIVER_DISPLAY NULL
+#define GB_DRIVER_CAMERA NULL
+#define GB_DRIVER_SENSOR NULL
+#define GB_DRIVER_SVC NULL
+
+struct gb_cport_driver {
+    uint16_t id;
+    uint8_t protocol;
+    const char *name;
+    void (*reg)(int cport);
+};
+
+#define GB_CPORT(_id, _protocol) {                  \
+        .id = _id,                                  \
+        .protocol = GREYBUS_PROTOCOL_##_protocol,   \
+        .name = #_protocol,                         \
+        .reg = GB_DRIVER_##_protocol,               \
+    },
+
+static const struct gb_cport_driver bridge_cports[] = {
+#include "manifest_cports.inc"
+};
+#endif
+
 static void *alloc_cport(void)
 {
     struct gb_cport *gb_cport;
@@ -101,7 +274,23 @@ static void free_cport(int cportid)
     }
 }
 
-#ifdef CONFIG_GREYBUS
+#if defined(CONFIG_GREYBUS) && defined(CONFIG_GREYBUS_MANIFEST_PRECOMPILED)
+void enable_cports(void)
+{
+    const struct gb_cport_driver *cport;
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(bridge_cports); i++) {
+        cport = &bridge_cports[i];
+        if (!cport->reg)
+            continue;
+
+        gb_info("Registering %s greybus driver. id= %d\n", cport->name,
+                cport->id);
+        cport->reg(cport->id);
+    }
+}
+#elif defined(CONFIG_GREYBUS)
 void enable_cports(void)
 {
     struct list_head *iter;
@@ -217,8 +406,13 @@ void enable_cports(void)
 
 #ifdef CONFIG_GREYBUS_RAW
         if (protocol == GREYBUS_PROTOCOL_RAW) {
+#ifdef CONFIG_GREYBUS_RAW_NET
+            gb_info("Registering Raw network greybus driver.\n");
+            gb_raw_net_register(id);
+#else
             gb_info("Registering Raw greybus driver.\n");
             gb_raw_register(id);
+#endif
         }
 #endif
 
@@ -449,10 +643,37 @@ const void *get_manifest_blob(void)
     return bridge_manifest;
 }
 
+#ifdef CONFIG_GREYBUS_MANIFEST_PRECOMPILED
+/*
+ * The built-in manifest was validated when bridge_cports was compiled, only
+ * check that the header matches this firmware.
+ */
+static bool manifest_check_header(const void *manifest)
+{
+    const struct greybus_manifest_header *mh = manifest;
+
+    if (mh->version_major > GREYBUS_VERSION_MAJOR) {
+        gb_error("manifest version too new (%hhu.%hhu > %hhu.%hhu)\n",
+                 mh->version_major, mh->version_minor,
+                 GREYBUS_VERSION_MAJOR, GREYBUS_VERSION_MINOR);
+        return false;
+    }
+
+    return true;
+}
+#endif
+
 void parse_manifest_blob(const void *manifest)
 {
     const struct greybus_manifest_header *mh = manifest;
 
+#ifdef CONFIG_GREYBUS_MANIFEST_PRECOMPILED
+    if (manifest == bridge_manifest) {
+        manifest_check_header(mh);
+        return;
+    }
+#endif
+
     manifest_parse(mh, le16_to_cpu(mh->size));
 }
 
@@ -460,6 +681,11 @@ void release_manifest_blob(const void *manifest)
 {
     const struct greybus_manifest_header *mh = manifest;
 
+#ifdef CONFIG_GREYBUS_MANIFEST_PRECOMPILED
+    if (manifest == bridge_manifest)
+        return;
+#endif
+
     manifest_release(mh, le16_to_cpu(mh->size));
 }
 
@@ -0,0 +1,151 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2016 Motorola Mobility, LLC
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 1. Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+# 3. Neither the name of the copyright holder nor the names of its
+# contributors may be used to endorse or promote products derived from this
+# software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Compile the CPort descriptors of a manifest into a constant table.
+#
+# Usage:
+#   mkcports.py manifest.inc greybus_manifest.h > manifest_cports.inc
+#
+# The input is the xxd dump of the manifest blob, optionally followed by its
+# signature, as generated for manifest.c.  The manifest is validated the same
+# way manifest_parse() does at runtime and every CPort descriptor becomes one
+# GB_CPORT(id, PROTOCOL) entry, PROTOCOL being the enum greybus_protocol name
+# without its GREYBUS_PROTOCOL_ prefix.  Unknown protocols are skipped, as
+# enable_cports() would skip them.
+#
+from __future__ import print_function
+
+import re
+import struct
+import sys
+
+GREYBUS_VERSION_MAJOR = 0x00
+
+GREYBUS_TYPE_INTERFACE = 0x01
+GREYBUS_TYPE_STRING = 0x02
+GREYBUS_TYPE_BUNDLE = 0x03
+GREYBUS_TYPE_CPORT = 0x04
+GREYBUS_TYPE_IDS = 0x05
+
+# header + payload sizes, strings add their length
+DESC_SIZES = {
+    GREYBUS_TYPE_INTERFACE: 4 + 4,
+    GREYBUS_TYPE_STRING: 4 + 2,
+    GREYBUS_TYPE_BUNDLE: 4 + 4,
+    GREYBUS_TYPE_CPORT: 4 + 4,
+    GREYBUS_TYPE_IDS: 4 + 8,
+}
+
+
+def fail(msg):
+    print('mkcports: %s' % msg, file=sys.stderr)
+    sys.exit(1)
+
+
+def parse_protocols(path):
+    """Return {protocol id: name} from enum greybus_protocol"""
+    protocols = {}
+    with open(path) as f:
+        for m in re.finditer(r'GREYBUS_PROTOCOL_(\w+)\s*=\s*(0x[0-9a-fA-F]+|\d+)',
+                             f.read()):
+            protocols[int(m.group(2), 0)] = m.group(1)
+    return protocols
+
+
+def read_manifest(path):
+    """Return the manifest bytes of an xxd -i dump, without signature"""
+    try:
+        with open(path) as f:
+            blob = bytearray(int(b, 16) for b in
+                             re.findall(r'0x([0-9a-fA-F]{2})', f.read()))
+    except IOError:
+        return None
+
+    if not blob:
+        return None
+    if len(blob) <= 4:
+        fail('short manifest (%d)' % len(blob))
+
+    size, major, minor = struct.unpack_from('<HBB', blob)
+    if size > len(blob):
+        fail('manifest size mismatch %d > %d' % (size, len(blob)))
+    if major > GREYBUS_VERSION_MAJOR:
+        fail('manifest version too new (%d.%d)' % (major, minor))
+
+    return blob[:size]
+
+
+def parse_cports(blob):
+    """Return the (cport id, protocol id) pairs of the manifest"""
+    cports = []
+    offset = 4
+    while offset < len(blob):
+        if len(blob) - offset < 4:
+            fail('manifest too small')
+        size, dtype = struct.unpack_from('<HB', blob, offset)
+        if size > len(blob) - offset:
+            fail('descriptor too big')
+        if dtype not in DESC_SIZES:
+            fail('invalid descriptor type (%d)' % dtype)
+
+        expected = DESC_SIZES[dtype]
+        if dtype == GREYBUS_TYPE_STRING:
+            expected = (expected + blob[offset + 4] + 3) & ~3
+        if size < expected:
+            fail('%d: descriptor too small (%d < %d)' % (dtype, size, expected))
+
+        if dtype == GREYBUS_TYPE_CPORT:
+            cport, bundle, protocol = struct.unpack_from('<HBB', blob,
+                                                         offset + 4)
+            cports.append((cport, protocol))
+
+        offset += size
+    return cports
+
+
+def main():
+    if len(sys.argv) != 3:
+        fail('usage: mkcports.py manifest.inc greybus_manifest.h')
+
+    protocols = parse_protocols(sys.argv[2])
+    blob = read_manifest(sys.argv[1])
+
+    print('/* Generated by mkcports.py from %s, do not edit */' % sys.argv[1])
+    if blob is None:
+        return
+
+    for cport, protocol in parse_cports(blob):
+        if protocol not in protocols:
+            print('mkcports: cport %d: unknown protocol 0x%02x' %
+                  (cport, protocol), file=sys.stderr)
+            continue
+        print('GB_CPORT(%d, %s)' % (cport, protocols[protocol]))
+
+
+if __name__ == '__main__':
+    main()
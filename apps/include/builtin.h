@@ -50,6 +50,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <spawn.h>
 
 #include <nuttx/binfmt/builtin.h>
 
@@ -103,6 +104,34 @@ extern "C" {
 EXTERN int exec_builtin(FAR const char *appname, FAR char * const *argv,
                         FAR const char *redirfile, int oflags);
 
+/****************************************************************************
+ * Name: exec_builtin_actions
+ *
+ * Description:
+ *   Executes builtin applications registered during 'make context' time,
+ *   applying a caller-provided set of file actions in the new task.  This
+ *   is the more general form of exec_builtin():  It allows the caller to
+ *   wire up both standard input and standard output (for example, to the
+ *   ends of a pipe) before the application starts.
+ *
+ * Input Parameter:
+ *   filename     - Name of the linked-in binary to be started.
+ *   argv         - Argument list
+ *   file_actions - The file actions to perform in the new task.  May be
+ *                  NULL if the new task should simply inherit the file
+ *                  descriptors of the caller.
+ *
+ * Returned Value:
+ *   This is an end-user function, so it follows the normal convention:
+ *   Returns the PID of the exec'ed module.  On failure, it.returns
+ *   -1 (ERROR) and sets errno appropriately.
+ *
+ ****************************************************************************/
+
+EXTERN int exec_builtin_actions(FAR const char *appname,
+                                FAR char * const *argv,
+                                FAR const posix_spawn_file_actions_t *file_actions);
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __APPS_INCLUDE_NETUTILS_JSON_TOKEN_H
+#define __APPS_INCLUDE_NETUTILS_JSON_TOKEN_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Token types */
+
+#define JSONTOK_UNDEFINED 0
+#define JSONTOK_OBJECT    1
+#define JSONTOK_ARRAY     2
+#define JSONTOK_STRING    3
+#define JSONTOK_PRIMITIVE 4  /* Number, true, false or null */
+
+/* Length of a token in the input buffer */
+
+#define jsontok_len(t)    ((t)->end - (t)->start)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One token.  Tokens do not own any memory: 'start' and 'end' are offsets
+ * into the caller's input buffer.  Strings exclude the quotes and are left
+ * escaped (see jsontok_unescape()).  'size' is the number of direct
+ * children: elements of an array, keys of an object, or 1 for a key that
+ * has its value.  'parent' is the index of the enclosing token or -1.
+ */
+
+struct jsontok_s
+{
+  int type;
+  int start;
+  int end;
+  int size;
+  int parent;
+};
+
+/* Parser state.  It is only a position in the input and in the token
+ * array, so a parse can be resumed once more input has been appended to
+ * the same buffer.
+ */
+
+struct jsontok_parser_s
+{
+  unsigned int pos;       /* Offset of the next character to examine */
+  unsigned int toknext;   /* Next free token */
+  int toksuper;           /* Enclosing object/array/key, -1 at top level */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: jsontok_init
+ *
+ * Description:
+ *   Prepare 'parser' for a new document.
+ *
+ ****************************************************************************/
+
+void jsontok_init(FAR struct jsontok_parser_s *parser);
+
+/****************************************************************************
+ * Name: jsontok_parse
+ *
+ * Description:
+ *   Tokenize the first 'len' bytes of 'js' into 'tokens' without allocating
+ *   any memory.  If 'tokens' is NULL, only count the tokens needed.
+ *
+ *   When the input ends in the middle of the document, -EAGAIN is returned
+ *   with the parser positioned just before the incomplete token: append
+ *   more data to the buffer and call again with the same parser and token
+ *   array to continue.
+ *
+ * Returned Value:
+ *   The total number of tokens used so far on success; -ENOMEM if 'ntokens'
+ *   is too small, -EINVAL on malformed input, or -EAGAIN as above.
+ *
+ ****************************************************************************/
+
+int jsontok_parse(FAR struct jsontok_parser_s *parser, FAR const char *js,
+                  size_t len, FAR struct jsontok_s *tokens,
+                  unsigned int ntokens);
+
+/****************************************************************************
+ * Name: jsontok_next
+ *
+ * Description:
+ *   Return the index of the token following token 'index' and all of its
+ *   children, i.e. its next sibling.  'ntokens' is the number of valid
+ *   tokens.
+ *
+ ****************************************************************************/
+
+int jsontok_next(FAR const struct jsontok_s *tokens, int ntokens, int index);
+
+/****************************************************************************
+ * Name: jsontok_streq
+ *
+ * Description:
+ *   Return true if the string or primitive token 'tok' is exactly 'str'.
+ *
+ ****************************************************************************/
+
+bool jsontok_streq(FAR const char *js, FAR const struct jsontok_s *tok,
+                   FAR const char *str);
+
+/****************************************************************************
+ * Name: jsontok_lookup
+ *
+ * Description:
+ *   Find 'key' among the members of the object token 'object'.
+ *
+ * Returned Value:
+ *   The index of the value token, or -ENOENT.
+ *
+ ****************************************************************************/
+
+int jsontok_lookup(FAR const char *js, FAR const struct jsontok_s *tokens,
+                   int ntokens, int object, FAR const char *key);
+
+/****************************************************************************
+ * Name: jsontok_toint
+ *
+ * Description:
+ *   Convert the primitive token 'tok' to a long.
+ *
+ * Returned Value:
+ *   Zero on success, -EINVAL if the token is not an integer.
+ *
+ ****************************************************************************/
+
+int jsontok_toint(FAR const char *js, FAR const struct jsontok_s *tok,
+                  FAR long *value);
+
+/****************************************************************************
+ * Name: jsontok_unescape
+ *
+ * Description:
+ *   Copy the string token 'tok' to 'buf' with escapes decoded (\uXXXX as
+ *   UTF-8) and NUL terminated.  'buf' may be the input buffer itself, as
+ *   the decoded string is never longer than its escaped form.
+ *
+ * Returned Value:
+ *   The length of the decoded string, or -E2BIG if it does not fit.
+ *
+ ****************************************************************************/
+
+int jsontok_unescape(FAR const char *js, FAR const struct jsontok_s *tok,
+                     FAR char *buf, size_t size);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __APPS_INCLUDE_NETUTILS_JSON_TOKEN_H */
@@ -46,6 +46,8 @@
 
 #include <nuttx/config.h>
 
+#include <queue.h>
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -76,6 +78,13 @@ struct nxplayer_s
 #ifdef CONFIG_AUDIO_MULTI_SESSION
   FAR void*   session;        /* Session assigment from device */
 #endif
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  pthread_t   readId;         /* Thread ID of the read-ahead thread */
+  sem_t       readsem;        /* Protects readq and reading */
+  sem_t       readwait;       /* Wakes up the read-ahead thread */
+  struct dq_queue_s readq;    /* Buffers waiting to be refilled */
+  bool        reading;        /* Read-ahead thread should keep running */
+#endif
 #ifndef CONFIG_AUDIO_EXCLUDE_VOLUME
   uint16_t    volume;         /* Volume as a whole percentage (0-100) */
 #ifndef CONFIG_AUDIO_EXCLUDE_BALANCE
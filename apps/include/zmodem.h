@@ -108,12 +108,10 @@
  * notification is needed to support interruption of the file transfer by
  * the remote receiver.
  *
- * This capapability is not yet supported.  There are only incomplete hooks
- * in the code now!
+ * The reverse channel is sampled with poll().
  */
 
-#ifdef CONFIG_SYSTEM_ZMODEM_RCVSAMPLE
-#  warning CONFIG_SYSTEM_ZMODEM_RCVSAMPLE not yet supported
+#ifdef CONFIG_DISABLE_POLL
 #  undef CONFIG_SYSTEM_ZMODEM_RCVSAMPLE
 #endif
 
@@ -28,6 +28,7 @@
  */
 
 #include <nuttx/config.h>
+#include <nuttx/bootphase.h>
 #include <nuttx/greybus/mods.h>
 #include <nuttx/greybus/mods-ctrl.h>
 
@@ -54,16 +55,25 @@ static struct srvmgr_service services[] = {
 
 int mods_main(int argc, char *argv[])
 {
+    boottrace_mark("mods_main");
     wdog_init();
 
     enable_manifest("IID-1", NULL, MANIFEST_DEVICE_ID);
     mods_network_init();
+    boottrace_mark("mods network");
     srvmgr_start(services);
+    gb_bringup_begin();
     enable_cports();
     mb_control_register(MODS_VENDOR_CTRL_CPORT);
+    gb_bringup_wait();
+    boottrace_mark("greybus cports");
 
     /* Must be after network init and after the cport registrations. */
     mods_attach_init();
+    boottrace_mark("mods attach");
+
+    /* The host can now be answered, finish the deferred initializations */
+    boot_defer_start();
 
 #ifdef CONFIG_EXAMPLES_NSH
     printf("Calling NSH\n");
@@ -659,3 +659,44 @@ int gearbox_shift_complete(struct gearbox *gearbox, int err) {
 
     return 0;
 }
+
+int gearbox_retrain(struct gearbox *gearbox) {
+    vdbg("\n");
+
+    if (!gearbox) {
+        return -ENODEV;
+    }
+
+    sem_wait(&gearbox->mutex);
+
+    int result;
+    switch (gearbox->state) {
+    case GEARBOX_STATE_IDLE:
+    case GEARBOX_STATE_RETRY:
+        /* Shift into the current gear again, the power mode change makes
+         * both ends go through the PA training sequence.
+         */
+        dbg("Retraining link\n");
+        gearbox->in_progress = gearbox->current;
+        gearbox->state = GEARBOX_STATE_SHIFTING;
+        _gearbox_start_shift(gearbox);
+        result = 0;
+        break;
+    case GEARBOX_STATE_SHIFTING:
+        /* The shift in progress will train the link anyway. */
+        result = -EBUSY;
+        break;
+    case GEARBOX_STATE_DOWN:
+        /* ignore */
+        result = -EIO;
+        break;
+    default:
+        dbg("ERROR: Invalid gearbox state: %d\n", gearbox->state);
+        result = -EINVAL;
+        break;
+    }
+
+    sem_post(&gearbox->mutex);
+
+    return result;
+}
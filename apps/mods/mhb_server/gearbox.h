@@ -76,5 +76,6 @@ int gearbox_request(struct gearbox *gearbox,
 int gearbox_link_up(struct gearbox *gearbox);
 int gearbox_link_down(struct gearbox *gearbox);
 int gearbox_shift_complete(struct gearbox *gearbox, int err);
+int gearbox_retrain(struct gearbox *gearbox);
 
 #endif
\ No newline at end of file
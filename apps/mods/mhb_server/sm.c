@@ -100,6 +100,7 @@ const static char *SVC_EVENT_STRINGS[] = {
     "QUEUE_STATS",
     "SEND_STATS",
     "CPORTS_DONE",
+    "LINK_DEGRADED",
 };
 #endif
 
@@ -304,12 +305,27 @@ static void unipro_evt_handler(enum unipro_event evt)
             llvdbg("Mod NOT detected\n");
         }
 #elif CONFIG_UNIPRO_P2P_APBE
-        llvdbg("Connected cport %d\n", v-1);
-        svc_send_event(SVC_EVENT_CPORTS_DONE, (void *)(v-1), 0, 0);
+        if (v & TSB_MAIL_CPORT_BATCH) {
+            uint32_t cport = TSB_MAIL_CPORT_BATCH_GROUP(v) * 8;
+            uint32_t map;
+
+            for (map = TSB_MAIL_CPORT_BATCH_MAP(v); map; map >>= 1, cport++) {
+                if (map & 1) {
+                    llvdbg("Connected cport %d\n", cport);
+                    svc_send_event(SVC_EVENT_CPORTS_DONE, (void *)cport, 0, 0);
+                }
+            }
+        } else {
+            llvdbg("Connected cport %d\n", v-1);
+            svc_send_event(SVC_EVENT_CPORTS_DONE, (void *)(v-1), 0, 0);
+        }
 #endif
 
         break;
     }
+    case UNIPRO_EVT_LINK_DEGRADED:
+        svc_send_event(SVC_EVENT_LINK_DEGRADED, 0, 0, 0);
+        break;
     default:
         break;
     }
@@ -548,6 +564,10 @@ static enum svc_state svc_wf_mod__mod_detected(struct svc *svc, struct svc_work
         gearbox_link_up(g_svc.gearbox);
     }
 
+    /* Announce all CPorts to the peer with as few mailbox handshakes
+       as possible. */
+    unipro_p2p_batch_begin();
+
 #if defined(CONFIG_ARCH_CHIP_TSB_I2S_TUNNEL)
     (void)i2s_unipro_tunnel_unipro_register();
 #endif
@@ -569,6 +589,10 @@ static enum svc_state svc_wf_mod__mod_detected(struct svc *svc, struct svc_work
     ipc_register_unipro();
 #endif
 
+    if (unipro_p2p_batch_end()) {
+        dbg("ERROR: CPort notification failed\n");
+    }
+
 #if CONFIG_RAMLOG_SYSLOG
     mhb_ramlog_enable();
 #endif
@@ -686,6 +710,16 @@ static enum svc_state svc_connected__gear_shifted(struct svc *svc, struct svc_wo
     return g_svc.state;
 }
 
+static enum svc_state svc_connected__link_degraded(struct svc *svc, struct svc_work *work) {
+    vdbg("\n");
+
+    if (g_svc.gearbox) {
+        gearbox_retrain(g_svc.gearbox);
+    }
+
+    return g_svc.state;
+}
+
 static enum svc_state svc__test_mode(struct svc *svc, struct svc_work *work) {
 #if CONFIG_ARCH_BOARD_APBA
     factory_mode((uint32_t)work->parameter0);
@@ -742,6 +776,7 @@ static const svc_event_handler SVC_STATES[SVC_STATE_MAX][SVC_EVENT_MAX] = {
         NULL,                        /* SVC_EVENT_QUEUE_STATS */
         NULL,                        /* SVC_EVENT_SEND_STATS */
         NULL,                        /* SVC_EVENT_CPORTS_DONE */
+        NULL,                        /* SVC_EVENT_LINK_DEGRADED */
     },
     /* SVC_SLAVE_WAIT_FOR_UNIPRO */
     {
@@ -757,6 +792,7 @@ static const svc_event_handler SVC_STATES[SVC_STATE_MAX][SVC_EVENT_MAX] = {
         svc__queue_stats,            /* SVC_EVENT_QUEUE_STATS */
         svc__send_stats,             /* SVC_EVENT_SEND_STATS */
         NULL,                        /* SVC_EVENT_CPORTS_DONE */
+        NULL,                        /* SVC_EVENT_LINK_DEGRADED */
     },
     /* SVC_SLAVE_WAIT_FOR_CPORTS */
     {
@@ -772,6 +808,7 @@ static const svc_event_handler SVC_STATES[SVC_STATE_MAX][SVC_EVENT_MAX] = {
         svc__queue_stats,            /* SVC_EVENT_QUEUE_STATS */
         svc__send_stats,             /* SVC_EVENT_SEND_STATS */
         svc_wf_cports__connected,    /* SVC_EVENT_CPORTS_DONE */
+        NULL,                        /* SVC_EVENT_LINK_DEGRADED */
     },
     /* SVC_SLAVE_CONNECTED */
     {
@@ -787,6 +824,7 @@ static const svc_event_handler SVC_STATES[SVC_STATE_MAX][SVC_EVENT_MAX] = {
         svc__queue_stats,            /* SVC_EVENT_QUEUE_STATS */
         svc__send_stats,             /* SVC_EVENT_SEND_STATS */
         NULL,                        /* SVC_EVENT_CPORTS_DONE */
+        svc_connected__link_degraded,/* SVC_EVENT_LINK_DEGRADED */
     },
     /* SVC_WAIT_FOR_UNIPRO */
     {
@@ -802,6 +840,7 @@ static const svc_event_handler SVC_STATES[SVC_STATE_MAX][SVC_EVENT_MAX] = {
         svc__queue_stats,            /* SVC_EVENT_QUEUE_STATS */
         svc__send_stats,             /* SVC_EVENT_SEND_STATS */
         NULL,                        /* SVC_EVENT_CPORTS_DONE */
+        NULL,                        /* SVC_EVENT_LINK_DEGRADED */
     },
     /* SVC_WAIT_FOR_MOD */
     {
@@ -817,6 +856,7 @@ static const svc_event_handler SVC_STATES[SVC_STATE_MAX][SVC_EVENT_MAX] = {
         svc__queue_stats,            /* SVC_EVENT_QUEUE_STATS */
         svc__send_stats,             /* SVC_EVENT_SEND_STATS */
         NULL,                        /* SVC_EVENT_CPORTS_DONE */
+        NULL,                        /* SVC_EVENT_LINK_DEGRADED */
     },
     /* SVC_CONNECTED */
     {
@@ -832,6 +872,7 @@ static const svc_event_handler SVC_STATES[SVC_STATE_MAX][SVC_EVENT_MAX] = {
         svc__queue_stats,            /* SVC_EVENT_QUEUE_STATS */
         svc__send_stats,             /* SVC_EVENT_SEND_STATS */
         NULL,                        /* SVC_EVENT_CPORTS_DONE */
+        svc_connected__link_degraded,/* SVC_EVENT_LINK_DEGRADED */
     },
     /* SVC_DISCONNECTED */
     {
@@ -847,6 +888,7 @@ static const svc_event_handler SVC_STATES[SVC_STATE_MAX][SVC_EVENT_MAX] = {
         svc__queue_stats,            /* SVC_EVENT_QUEUE_STATS */
         svc__send_stats,             /* SVC_EVENT_SEND_STATS */
         NULL,                        /* SVC_EVENT_CPORTS_DONE */
+        NULL,                        /* SVC_EVENT_LINK_DEGRADED */
     },
     /* SVC_TEST_MODE */
     {
@@ -862,6 +904,7 @@ static const svc_event_handler SVC_STATES[SVC_STATE_MAX][SVC_EVENT_MAX] = {
         NULL,                        /* SVC_EVENT_QUEUE_STATS */
         NULL,                        /* SVC_EVENT_SEND_STATS */
         NULL,                        /* SVC_EVENT_CPORTS_DONE */
+        NULL,                        /* SVC_EVENT_LINK_DEGRADED */
     },
 };
 
@@ -42,6 +42,7 @@ enum svc_event {
     SVC_EVENT_QUEUE_STATS,
     SVC_EVENT_SEND_STATS,
     SVC_EVENT_CPORTS_DONE,
+    SVC_EVENT_LINK_DEGRADED,
 
     SVC_EVENT_MAX,
 };
@@ -0,0 +1,723 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <errno.h>
+#include <limits.h>
+#include <string.h>
+
+#include <apps/netutils/json_token.h>
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: jsontok_alloc
+ *
+ * Description:
+ *   Take the next free token, or count it only if there is no token array.
+ *
+ ****************************************************************************/
+
+static FAR struct jsontok_s *jsontok_alloc(FAR struct jsontok_parser_s *parser,
+                                           FAR struct jsontok_s *tokens,
+                                           unsigned int ntokens, int type,
+                                           int start, int end)
+{
+  FAR struct jsontok_s *tok;
+
+  if (tokens == NULL)
+    {
+      parser->toknext++;
+      return NULL;
+    }
+
+  tok         = &tokens[parser->toknext++];
+  tok->type   = type;
+  tok->start  = start;
+  tok->end    = end;
+  tok->size   = 0;
+  tok->parent = parser->toksuper;
+  return tok;
+}
+
+/****************************************************************************
+ * Name: jsontok_hexval
+ *
+ * Description:
+ *   Return the value of the hexadecimal digit 'c', or -1.
+ *
+ ****************************************************************************/
+
+static int jsontok_hexval(char c)
+{
+  if (c >= '0' && c <= '9')
+    {
+      return c - '0';
+    }
+  else if (c >= 'a' && c <= 'f')
+    {
+      return c - 'a' + 10;
+    }
+  else if (c >= 'A' && c <= 'F')
+    {
+      return c - 'A' + 10;
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: jsontok_primitive
+ *
+ * Description:
+ *   Scan a number, true, false or null starting at parser->pos.  On return
+ *   the position is on the last character of the primitive.
+ *
+ ****************************************************************************/
+
+static int jsontok_primitive(FAR struct jsontok_parser_s *parser,
+                             FAR const char *js, size_t len,
+                             FAR struct jsontok_s *tokens,
+                             unsigned int ntokens)
+{
+  unsigned int start = parser->pos;
+
+  for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++)
+    {
+      switch (js[parser->pos])
+        {
+          case ' ':
+          case '\t':
+          case '\r':
+          case '\n':
+          case ',':
+          case ']':
+          case '}':
+            goto found;
+
+          default:
+            if (js[parser->pos] < 32 || js[parser->pos] >= 127 ||
+                js[parser->pos] == ':')
+              {
+                parser->pos = start;
+                return -EINVAL;
+              }
+            break;
+        }
+    }
+
+  /* A primitive inside an object or array may continue in the next chunk
+   * of input.  At the top level, the end of input ends the document.
+   */
+
+  if (parser->toksuper != -1)
+    {
+      parser->pos = start;
+      return -EAGAIN;
+    }
+
+found:
+  if (tokens != NULL && parser->toknext >= ntokens)
+    {
+      parser->pos = start;
+      return -ENOMEM;
+    }
+
+  (void)jsontok_alloc(parser, tokens, ntokens, JSONTOK_PRIMITIVE, start,
+                      parser->pos);
+  parser->pos--;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: jsontok_string
+ *
+ * Description:
+ *   Scan a string whose opening quote is at parser->pos.  The escapes are
+ *   validated but left in place.  On return the position is on the closing
+ *   quote.
+ *
+ ****************************************************************************/
+
+static int jsontok_string(FAR struct jsontok_parser_s *parser,
+                          FAR const char *js, size_t len,
+                          FAR struct jsontok_s *tokens,
+                          unsigned int ntokens)
+{
+  unsigned int start = parser->pos;
+  int i;
+
+  for (parser->pos++; parser->pos < len && js[parser->pos] != '\0';
+       parser->pos++)
+    {
+      char c = js[parser->pos];
+
+      if (c == '\"')
+        {
+          if (tokens != NULL && parser->toknext >= ntokens)
+            {
+              parser->pos = start;
+              return -ENOMEM;
+            }
+
+          (void)jsontok_alloc(parser, tokens, ntokens, JSONTOK_STRING,
+                              start + 1, parser->pos);
+          return OK;
+        }
+
+      if (c != '\\')
+        {
+          continue;
+        }
+
+      if (parser->pos + 1 >= len)
+        {
+          break;
+        }
+
+      parser->pos++;
+      switch (js[parser->pos])
+        {
+          case '\"':
+          case '/':
+          case '\\':
+          case 'b':
+          case 'f':
+          case 'r':
+          case 'n':
+          case 't':
+            break;
+
+          case 'u':
+            for (i = 0; i < 4 && parser->pos + 1 < len; i++)
+              {
+                if (jsontok_hexval(js[parser->pos + 1]) < 0)
+                  {
+                    parser->pos = start;
+                    return -EINVAL;
+                  }
+
+                parser->pos++;
+              }
+            break;
+
+          default:
+            parser->pos = start;
+            return -EINVAL;
+        }
+    }
+
+  /* The closing quote has not been received yet */
+
+  parser->pos = start;
+  return -EAGAIN;
+}
+
+/****************************************************************************
+ * Name: jsontok_pututf8
+ *
+ * Description:
+ *   Encode the code point 'cp' as UTF-8 at 'buf'.  Return the number of
+ *   bytes written, at most 4.
+ *
+ ****************************************************************************/
+
+static int jsontok_pututf8(FAR char *buf, unsigned long cp)
+{
+  if (cp < 0x80)
+    {
+      buf[0] = cp;
+      return 1;
+    }
+  else if (cp < 0x800)
+    {
+      buf[0] = 0xc0 | (cp >> 6);
+      buf[1] = 0x80 | (cp & 0x3f);
+      return 2;
+    }
+  else if (cp < 0x10000)
+    {
+      buf[0] = 0xe0 | (cp >> 12);
+      buf[1] = 0x80 | ((cp >> 6) & 0x3f);
+      buf[2] = 0x80 | (cp & 0x3f);
+      return 3;
+    }
+
+  buf[0] = 0xf0 | (cp >> 18);
+  buf[1] = 0x80 | ((cp >> 12) & 0x3f);
+  buf[2] = 0x80 | ((cp >> 6) & 0x3f);
+  buf[3] = 0x80 | (cp & 0x3f);
+  return 4;
+}
+
+/****************************************************************************
+ * Name: jsontok_getu4
+ *
+ * Description:
+ *   Return the value of the four hex digits at 'str' (already validated by
+ *   the tokenizer), or -1 if there are fewer than four before 'end'.
+ *
+ ****************************************************************************/
+
+static long jsontok_getu4(FAR const char *str, FAR const char *end)
+{
+  long value = 0;
+  int digit;
+  int i;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (str + i >= end || (digit = jsontok_hexval(str[i])) < 0)
+        {
+          return -1;
+        }
+
+      value = (value << 4) | digit;
+    }
+
+  return value;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: jsontok_init
+ ****************************************************************************/
+
+void jsontok_init(FAR struct jsontok_parser_s *parser)
+{
+  parser->pos      = 0;
+  parser->toknext  = 0;
+  parser->toksuper = -1;
+}
+
+/****************************************************************************
+ * Name: jsontok_parse
+ ****************************************************************************/
+
+int jsontok_parse(FAR struct jsontok_parser_s *parser, FAR const char *js,
+                  size_t len, FAR struct jsontok_s *tokens,
+                  unsigned int ntokens)
+{
+  FAR struct jsontok_s *tok;
+  int type;
+  int ret;
+  int i;
+
+  for (; parser->pos < len && js[parser->pos] != '\0'; parser->pos++)
+    {
+      char c = js[parser->pos];
+
+      switch (c)
+        {
+          case '{':
+          case '[':
+            if (tokens == NULL)
+              {
+                parser->toknext++;
+                break;
+              }
+
+            if (parser->toknext >= ntokens)
+              {
+                return -ENOMEM;
+              }
+
+            if (parser->toksuper != -1)
+              {
+                tok = &tokens[parser->toksuper];
+
+                /* An object or array cannot be a key */
+
+                if (tok->type == JSONTOK_OBJECT)
+                  {
+                    return -EINVAL;
+                  }
+
+                tok->size++;
+              }
+
+            (void)jsontok_alloc(parser, tokens, ntokens,
+                                c == '{' ? JSONTOK_OBJECT : JSONTOK_ARRAY,
+                                parser->pos, -1);
+            parser->toksuper = parser->toknext - 1;
+            break;
+
+          case '}':
+          case ']':
+            if (tokens == NULL)
+              {
+                break;
+              }
+
+            type = c == '}' ? JSONTOK_OBJECT : JSONTOK_ARRAY;
+            if (parser->toknext < 1)
+              {
+                return -EINVAL;
+              }
+
+            /* Walk up to the innermost container still open */
+
+            tok = &tokens[parser->toknext - 1];
+            for (; ; )
+              {
+                if (tok->start != -1 && tok->end == -1)
+                  {
+                    if (tok->type != type)
+                      {
+                        return -EINVAL;
+                      }
+
+                    tok->end = parser->pos + 1;
+                    parser->toksuper = tok->parent;
+                    break;
+                  }
+
+                if (tok->parent == -1)
+                  {
+                    return -EINVAL;
+                  }
+
+                tok = &tokens[tok->parent];
+              }
+            break;
+
+          case '\"':
+            if (tokens != NULL && parser->toksuper != -1 &&
+                tokens[parser->toksuper].type == JSONTOK_STRING &&
+                tokens[parser->toksuper].size != 0)
+              {
+                return -EINVAL;
+              }
+
+            ret = jsontok_string(parser, js, len, tokens, ntokens);
+            if (ret < 0)
+              {
+                return ret;
+              }
+
+            if (tokens != NULL && parser->toksuper != -1)
+              {
+                tokens[parser->toksuper].size++;
+              }
+            break;
+
+          case '\t':
+          case '\r':
+          case '\n':
+          case ' ':
+            break;
+
+          case ':':
+            parser->toksuper = parser->toknext - 1;
+            break;
+
+          case ',':
+            if (tokens != NULL && parser->toksuper != -1 &&
+                tokens[parser->toksuper].type != JSONTOK_ARRAY &&
+                tokens[parser->toksuper].type != JSONTOK_OBJECT)
+              {
+                parser->toksuper = tokens[parser->toksuper].parent;
+              }
+            break;
+
+          case '-':
+          case '0':
+          case '1':
+          case '2':
+          case '3':
+          case '4':
+          case '5':
+          case '6':
+          case '7':
+          case '8':
+          case '9':
+          case 't':
+          case 'f':
+          case 'n':
+            if (tokens != NULL && parser->toksuper != -1)
+              {
+                tok = &tokens[parser->toksuper];
+
+                /* A primitive cannot be a key nor a second value */
+
+                if (tok->type == JSONTOK_OBJECT ||
+                    (tok->type == JSONTOK_STRING && tok->size != 0))
+                  {
+                    return -EINVAL;
+                  }
+              }
+
+            ret = jsontok_primitive(parser, js, len, tokens, ntokens);
+            if (ret < 0)
+              {
+                return ret;
+              }
+
+            if (tokens != NULL && parser->toksuper != -1)
+              {
+                tokens[parser->toksuper].size++;
+              }
+            break;
+
+          default:
+            return -EINVAL;
+        }
+    }
+
+  /* Any container still open means the document is incomplete */
+
+  if (tokens != NULL)
+    {
+      for (i = parser->toknext - 1; i >= 0; i--)
+        {
+          if (tokens[i].start != -1 && tokens[i].end == -1)
+            {
+              return -EAGAIN;
+            }
+        }
+    }
+
+  return parser->toknext;
+}
+
+/****************************************************************************
+ * Name: jsontok_next
+ ****************************************************************************/
+
+int jsontok_next(FAR const struct jsontok_s *tokens, int ntokens, int index)
+{
+  int pending = 1;
+
+  while (pending > 0 && index < ntokens)
+    {
+      pending += tokens[index].size - 1;
+      index++;
+    }
+
+  return index;
+}
+
+/****************************************************************************
+ * Name: jsontok_streq
+ ****************************************************************************/
+
+bool jsontok_streq(FAR const char *js, FAR const struct jsontok_s *tok,
+                   FAR const char *str)
+{
+  size_t len = jsontok_len(tok);
+
+  return (tok->type == JSONTOK_STRING || tok->type == JSONTOK_PRIMITIVE) &&
+         strlen(str) == len && strncmp(js + tok->start, str, len) == 0;
+}
+
+/****************************************************************************
+ * Name: jsontok_lookup
+ ****************************************************************************/
+
+int jsontok_lookup(FAR const char *js, FAR const struct jsontok_s *tokens,
+                   int ntokens, int object, FAR const char *key)
+{
+  int nkeys;
+  int i;
+
+  if (object < 0 || object >= ntokens ||
+      tokens[object].type != JSONTOK_OBJECT)
+    {
+      return -EINVAL;
+    }
+
+  nkeys = tokens[object].size;
+  for (i = object + 1; nkeys > 0 && i < ntokens; nkeys--)
+    {
+      if (tokens[i].size > 0 && i + 1 < ntokens &&
+          jsontok_streq(js, &tokens[i], key))
+        {
+          return i + 1;
+        }
+
+      /* Skip the key and its value */
+
+      i = jsontok_next(tokens, ntokens, i);
+    }
+
+  return -ENOENT;
+}
+
+/****************************************************************************
+ * Name: jsontok_toint
+ ****************************************************************************/
+
+int jsontok_toint(FAR const char *js, FAR const struct jsontok_s *tok,
+                  FAR long *value)
+{
+  FAR const char *ptr = js + tok->start;
+  FAR const char *end = js + tok->end;
+  unsigned long limit;
+  unsigned long result = 0;
+  bool negative = false;
+
+  if (tok->type != JSONTOK_PRIMITIVE)
+    {
+      return -EINVAL;
+    }
+
+  if (ptr < end && *ptr == '-')
+    {
+      negative = true;
+      ptr++;
+    }
+
+  if (ptr == end)
+    {
+      return -EINVAL;
+    }
+
+  limit = negative ? (unsigned long)LONG_MAX + 1 : LONG_MAX;
+  for (; ptr < end; ptr++)
+    {
+      if (*ptr < '0' || *ptr > '9')
+        {
+          return -EINVAL;
+        }
+
+      if (result > (limit - (*ptr - '0')) / 10)
+        {
+          return -ERANGE;
+        }
+
+      result = result * 10 + (*ptr - '0');
+    }
+
+  *value = negative ? -(long)(result - 1) - 1 : (long)result;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: jsontok_unescape
+ ****************************************************************************/
+
+int jsontok_unescape(FAR const char *js, FAR const struct jsontok_s *tok,
+                     FAR char *buf, size_t size)
+{
+  FAR const char *ptr = js + tok->start;
+  FAR const char *end = js + tok->end;
+  char utf8[4];
+  long cp;
+  long lo;
+  size_t n = 0;
+  int len;
+
+  while (ptr < end)
+    {
+      if (*ptr != '\\' || ptr + 1 >= end)
+        {
+          utf8[0] = *ptr++;
+          len = 1;
+        }
+      else
+        {
+          ptr++;
+          len = 1;
+
+          switch (*ptr++)
+            {
+              case 'b':
+                utf8[0] = '\b';
+                break;
+
+              case 'f':
+                utf8[0] = '\f';
+                break;
+
+              case 'n':
+                utf8[0] = '\n';
+                break;
+
+              case 'r':
+                utf8[0] = '\r';
+                break;
+
+              case 't':
+                utf8[0] = '\t';
+                break;
+
+              case 'u':
+                cp = jsontok_getu4(ptr, end);
+                if (cp < 0)
+                  {
+                    return -EINVAL;
+                  }
+
+                ptr += 4;
+
+                /* Combine a UTF-16 surrogate pair */
+
+                if (cp >= 0xd800 && cp < 0xdc00 && ptr + 1 < end &&
+                    ptr[0] == '\\' && ptr[1] == 'u')
+                  {
+                    lo = jsontok_getu4(ptr + 2, end);
+                    if (lo >= 0xdc00 && lo < 0xe000)
+                      {
+                        cp = 0x10000 + ((cp - 0xd800) << 10) + (lo - 0xdc00);
+                        ptr += 6;
+                      }
+                  }
+
+                len = jsontok_pututf8(utf8, cp);
+                break;
+
+              default:
+                utf8[0] = ptr[-1];
+                break;
+            }
+        }
+
+      if (n + len >= size)
+        {
+          return -E2BIG;
+        }
+
+      /* The output never overtakes the input, so 'buf' may alias 'js' */
+
+      memcpy(&buf[n], utf8, len);
+      n += len;
+    }
+
+  buf[n] = '\0';
+  return n;
+}
@@ -103,6 +103,16 @@
 #  undef CONFIG_NSH_CMDPARMS
 #endif
 
+/* Pipelines require the pipe() interface and file descriptor redirection */
+
+#if CONFIG_NFILE_DESCRIPTORS == 0 || !defined(CONFIG_NSH_BUILTIN_APPS)
+#  undef CONFIG_NSH_PIPELINE
+#endif
+
+#if defined(CONFIG_DEV_PIPE_SIZE) && CONFIG_DEV_PIPE_SIZE == 0
+#  undef CONFIG_NSH_PIPELINE
+#endif
+
 /* rmdir, mkdir, rm, and mv are only available if mountpoints are enabled
  * AND there is a writeable file system OR if these operations on the
  * pseudo-filesystem are not disabled.
@@ -574,6 +584,18 @@
 #    define IOBUFFERSIZE (PATH_MAX + 1)
 #endif
 
+/* cp and dd may use a larger, separately allocated transfer buffer.  Zero
+ * selects the default:  IOBUFFERSIZE for cp and one sector for dd.
+ */
+
+#ifndef CONFIG_NSH_COPYBUFSIZE
+#  define CONFIG_NSH_COPYBUFSIZE 0
+#endif
+
+#ifndef CONFIG_NSH_COPYBUFALIGN
+#  define CONFIG_NSH_COPYBUFALIGN 32
+#endif
+
 /* Certain commands are not available in a kernel builds because they depend
  * on interfaces that are not exported by the kernel.  These are actually
  * bugs that need to be fixed but for now the commands are simply disabled.
@@ -793,6 +815,12 @@ int nsh_builtin(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
                 FAR char **argv, FAR const char *redirfile, int oflags);
 #endif
 
+#ifdef CONFIG_NSH_PIPELINE
+int nsh_builtin_pipe(FAR const char *cmd, FAR char **argv,
+                     FAR const int *infd, int outfd,
+                     FAR const char *redirfile, int oflags);
+#endif
+
 #ifdef CONFIG_NSH_FILE_APPS
 int nsh_fileapp(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
                 FAR char **argv, FAR const char *redirfile, int oflags);
@@ -846,6 +874,7 @@ void nsh_usbtrace(void);
 #endif
 #if defined(CONFIG_USEC_MEASURE_PERF)
   int cmd_perf_track(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
+  int cmd_top(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv);
 #endif
 
 #ifndef CONFIG_NSH_DISABLE_XD
@@ -54,6 +54,11 @@
 #include <errno.h>
 #include <string.h>
 
+#ifdef CONFIG_NSH_PIPELINE
+#  include <spawn.h>
+#  include <fcntl.h>
+#endif
+
 #include <nuttx/binfmt/builtin.h>
 #include <apps/builtin.h>
 
@@ -259,4 +264,100 @@ int nsh_builtin(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
   return ret;
 }
 
+/****************************************************************************
+ * Name: nsh_builtin_pipe
+ *
+ * Description:
+ *    Start the application task whose name is 'cmd' as one stage of a
+ *    command pipeline.  The task is always started in background; the
+ *    caller is responsible for waiting for it to exit.
+ *
+ * Input Parameters:
+ *   cmd       - The name of the built-in application
+ *   argv      - The argument list
+ *   infd      - The pipe feeding this stage or NULL for the first stage.
+ *               infd[0] becomes standard input of the new task and infd[1]
+ *               is closed in the new task so that it will see end-of-file
+ *               as soon as the upstream stage exits.
+ *   outfd     - The write end of the pipe feeding the next stage, which
+ *               becomes standard output of the new task, or -1 for the
+ *               last stage.
+ *   redirfile - If outfd is -1, an optional file to redirect the output
+ *               of the last stage to.
+ *   oflags    - The open flags to use with redirfile.
+ *
+ * Returned Value:
+ *   The PID of the new task on success; -1 (ERROR) on failure with the
+ *   errno value set appropriately.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_PIPELINE
+int nsh_builtin_pipe(FAR const char *cmd, FAR char **argv,
+                     FAR const int *infd, int outfd,
+                     FAR const char *redirfile, int oflags)
+{
+  posix_spawn_file_actions_t file_actions;
+  int ret;
+
+  ret = posix_spawn_file_actions_init(&file_actions);
+  if (ret != 0)
+    {
+      goto errout;
+    }
+
+  /* Connect standard input to the read end of the upstream pipe and drop
+   * the new task's copies of both pipe descriptors.
+   */
+
+  if (infd != NULL)
+    {
+      ret = posix_spawn_file_actions_adddup2(&file_actions, infd[0], 0);
+      if (ret == 0)
+        {
+          ret = posix_spawn_file_actions_addclose(&file_actions, infd[0]);
+        }
+
+      if (ret == 0)
+        {
+          ret = posix_spawn_file_actions_addclose(&file_actions, infd[1]);
+        }
+    }
+
+  /* Connect standard output to the downstream pipe or to the redirection
+   * file.
+   */
+
+  if (ret == 0 && outfd >= 0)
+    {
+      ret = posix_spawn_file_actions_adddup2(&file_actions, outfd, 1);
+      if (ret == 0)
+        {
+          ret = posix_spawn_file_actions_addclose(&file_actions, outfd);
+        }
+    }
+  else if (ret == 0 && redirfile != NULL)
+    {
+      ret = posix_spawn_file_actions_addopen(&file_actions, 1, redirfile,
+                                             oflags, 0666);
+    }
+
+  if (ret != 0)
+    {
+      goto errout_with_actions;
+    }
+
+  ret = exec_builtin_actions(cmd, (FAR char * const *)argv, &file_actions);
+  (void)posix_spawn_file_actions_destroy(&file_actions);
+  return ret;
+
+errout_with_actions:
+  (void)posix_spawn_file_actions_destroy(&file_actions);
+
+errout:
+  set_errno(ret);
+  return ERROR;
+}
+#endif /* CONFIG_NSH_PIPELINE */
+
 #endif /* CONFIG_NSH_BUILTIN_APPS */
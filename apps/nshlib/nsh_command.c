@@ -405,6 +405,10 @@ static const struct cmdmap_s g_cmdmap[] =
   { "test",     cmd_test,     3, CONFIG_NSH_MAXARGUMENTS, "<expression>" },
 #endif
 
+#if defined(CONFIG_USEC_MEASURE_PERF)
+  { "top",      cmd_top,      1, 5, "[-d <secs>] [-n <count>]" },
+#endif
+
 #ifndef CONFIG_NSH_DISABLESCRIPT
   { "true",     cmd_true,    1, 1, NULL },
 #endif
@@ -51,6 +51,19 @@
 #include <debug.h>
 #include <errno.h>
 
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+#  include <sys/mount.h>
+#endif
+
+#ifdef CONFIG_NSH_CMDOPT_DD_DOUBLEBUF
+#  include <pthread.h>
+#  include <semaphore.h>
+#endif
+
+#ifdef CONFIG_NSH_CMDOPT_DD_STATS
+#  include <time.h>
+#endif
+
 #include <nuttx/fs/fs.h>
 
 #include "nsh.h"
@@ -74,6 +87,24 @@
 
 #undef CAN_PIPE_FROM_STD
 
+/* Direct block driver access bypasses the BCH layer and so is only
+ * possible if block drivers are supported.
+ */
+
+#ifdef CONFIG_DISABLE_MOUNTPOINT
+#  undef CONFIG_NSH_CMDOPT_DD_DIRECT
+#endif
+
+/* With double buffering, the next buffer is read while the previous one is
+ * written by a separate writer thread.
+ */
+
+#ifdef CONFIG_NSH_CMDOPT_DD_DOUBLEBUF
+#  define DD_NBUFFERS     2
+#else
+#  define DD_NBUFFERS     1
+#endif
+
 /* Function pointer calls are only need if block drivers are supported
  * (or, rather, if mount points are supported in the file system)
  */
@@ -81,10 +112,12 @@
 #ifndef CONFIG_DISABLE_MOUNTPOINT
 #  define DD_INFD         ((dd)->inf.fd)
 #  define DD_INHANDLE     ((dd)->inf.handle)
+#  define DD_ININODE      ((dd)->inf.inode)
 #  define DD_OUTFD        ((dd)->outf.fd)
 #  define DD_OUTHANDLE    ((dd)->outf.handle)
-#  define DD_READ(dd)     ((dd)->infread(dd))
-#  define DD_WRITE(dd)    ((dd)->outfwrite(dd))
+#  define DD_OUTINODE     ((dd)->outf.inode)
+#  define DD_READ(dd,x)   ((dd)->infread(dd,x))
+#  define DD_WRITE(dd,x)  ((dd)->outfwrite(dd,x))
 #  define DD_INCLOSE(dd)  ((dd)->infclose(dd))
 #  define DD_OUTCLOSE(dd) ((dd)->outfclose(dd))
 #else
@@ -92,8 +125,8 @@
 #  undef  DD_INHANDLE
 #  define DD_OUTFD        ((dd)->outfd)
 #  undef  DD_OUTHANDLE
-#  define DD_READ(dd)     dd_readch(dd)
-#  define DD_WRITE(dd)    dd_writech(dd)
+#  define DD_READ(dd,x)   dd_readch(dd,x)
+#  define DD_WRITE(dd,x)  dd_writech(dd,x)
 #  define DD_INCLOSE(dd)  dd_infclosech(dd)
 #  define DD_OUTCLOSE(dd) dd_outfclosech(dd)
 #endif
@@ -102,6 +135,15 @@
  * Private Types
  ****************************************************************************/
 
+/* This structure describes one buffer of sectors in flight */
+
+struct dd_xfer_s
+{
+  FAR uint8_t *buffer; /* Aligned buffer of bufsectors sectors */
+  uint32_t sector;     /* First (output) sector number in the buffer */
+  uint32_t nsectors;   /* Number of valid sectors (zero: end of transfer) */
+};
+
 struct dd_s
 {
   FAR struct nsh_vtbl_s *vtbl;
@@ -110,6 +152,9 @@ struct dd_s
   union
   {
     FAR void *handle;  /* BCH lib handle for block device */
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+    FAR struct inode *inode; /* Inode of the directly accessed block device */
+#endif
     int fd;            /* File descriptor of the character device */
   } inf;
 #else
@@ -120,26 +165,44 @@ struct dd_s
   union
   {
     FAR void *handle;  /* BCH lib handle for block device */
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+    FAR struct inode *inode; /* Inode of the directly accessed block device */
+#endif
     int fd;            /* File descriptor of the character device */
   } outf;
 #else
   int outfd;           /* File descriptor of the output device */
 #endif
 
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+  uint16_t inmult;     /* Input device sectors per sector */
+  uint16_t outmult;    /* Output device sectors per sector */
+  size_t   indevsize;  /* Size of the input device in device sectors */
+  size_t   outdevsize; /* Size of the output device in device sectors */
+#endif
+
   uint32_t nsectors;   /* Number of sectors to transfer */
-  uint32_t sector;     /* The current sector number */
+  uint32_t ndone;      /* Number of sectors that were written */
   uint32_t skip;       /* The number of sectors skipped on input */
-  bool     eof;        /* true:  The of the input or output file has been hit */
-  uint16_t sectsize;   /* Size of one sector */
-  uint16_t nbytes;     /* Number of valid bytes in the buffer */
-  uint8_t *buffer;     /* Buffer of data to write to the output file */
+  uint32_t sectsize;   /* Size of one sector */
+  uint32_t bufsectors; /* Number of sectors per transfer buffer */
+  volatile bool eof;   /* true:  The of the input or output file has been hit */
+  bool     inseek;     /* true:  Input is read by sector number */
+
+  struct dd_xfer_s xfer[DD_NBUFFERS];
+
+#ifdef CONFIG_NSH_CMDOPT_DD_DOUBLEBUF
+  sem_t    filled;     /* Counts buffers ready to be written */
+  sem_t    empty;      /* Counts buffers ready to be read into */
+  volatile bool wrfail; /* true:  The writer thread hit an error */
+#endif
 
   /* Function pointers to handle differences between block and character devices */
 
 #ifndef CONFIG_DISABLE_MOUNTPOINT
-  int  (*infread)(struct dd_s *dd);
+  ssize_t (*infread)(struct dd_s *dd, FAR struct dd_xfer_s *xfer);
   void (*infclose)(struct dd_s *dd);
-  int  (*outfwrite)(struct dd_s *dd);
+  int  (*outfwrite)(struct dd_s *dd, FAR struct dd_xfer_s *xfer);
   void (*outfclose)(struct dd_s *dd);
 #endif
 };
@@ -173,6 +236,17 @@ static void dd_outfcloseblk(struct dd_s *dd)
 }
 #endif
 
+/****************************************************************************
+ * Name: dd_outfclosedirect
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+static void dd_outfclosedirect(struct dd_s *dd)
+{
+  (void)close_blockdriver(DD_OUTINODE);
+}
+#endif
+
 /****************************************************************************
  * Name: dd_outfclosech
  ****************************************************************************/
@@ -193,6 +267,17 @@ static void dd_infcloseblk(struct dd_s *dd)
 }
 #endif
 
+/****************************************************************************
+ * Name: dd_infclosedirect
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+static void dd_infclosedirect(struct dd_s *dd)
+{
+  (void)close_blockdriver(DD_ININODE);
+}
+#endif
+
 /****************************************************************************
  * Name: dd_infclosech
  ****************************************************************************/
@@ -207,14 +292,15 @@ static void dd_infclosech(struct dd_s *dd)
  ****************************************************************************/
 
 #ifndef CONFIG_DISABLE_MOUNTPOINT
-static int dd_writeblk(struct dd_s *dd)
+static int dd_writeblk(struct dd_s *dd, FAR struct dd_xfer_s *xfer)
 {
   ssize_t nbytes;
-  off_t   offset = (dd->sector - dd->skip) * dd->sectsize;
+  off_t   offset = (off_t)xfer->sector * dd->sectsize;
 
-  /* Write the sector at the specified offset */
+  /* Write the sectors at the specified offset */
 
-  nbytes = bchlib_write(DD_OUTHANDLE, (char*)dd->buffer, offset, dd->sectsize);
+  nbytes = bchlib_write(DD_OUTHANDLE, (char*)xfer->buffer, offset,
+                        xfer->nsectors * dd->sectsize);
   if (nbytes < 0)
     {
       /* bchlib_write return -EFBIG on attempts to write past the end of
@@ -237,33 +323,72 @@ static int dd_writeblk(struct dd_s *dd)
 }
 #endif
 
+/****************************************************************************
+ * Name: dd_writedirect
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+static int dd_writedirect(struct dd_s *dd, FAR struct dd_xfer_s *xfer)
+{
+  FAR struct inode *inode = DD_OUTINODE;
+  size_t  start = (size_t)xfer->sector * dd->outmult;
+  size_t  count = (size_t)xfer->nsectors * dd->outmult;
+  ssize_t nsectors;
+
+  /* Writing past the end of the device ends the transfer */
+
+  if (start >= dd->outdevsize)
+    {
+      dd->eof = true;
+      return OK;
+    }
+
+  if (count > dd->outdevsize - start)
+    {
+      count   = dd->outdevsize - start;
+      dd->eof = true;
+    }
+
+  nsectors = inode->u.i_bops->write(inode, xfer->buffer, start, count);
+  if (nsectors < 0)
+    {
+      FAR struct nsh_vtbl_s *vtbl = dd->vtbl;
+      nsh_output(vtbl, g_fmtcmdfailed, g_dd, "write", NSH_ERRNO_OF(-nsectors));
+      return ERROR;
+    }
+
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Name: dd_writech
  ****************************************************************************/
 
-static int dd_writech(struct dd_s *dd)
+static int dd_writech(struct dd_s *dd, FAR struct dd_xfer_s *xfer)
 {
-  uint8_t *buffer = dd->buffer;
-  uint16_t written ;
-  ssize_t nbytes;
+  uint8_t *buffer = xfer->buffer;
+  size_t   nwrite = xfer->nsectors * dd->sectsize;
+  size_t   written;
+  ssize_t  nbytes;
 
-  /* Is the out buffer full (or is this the last one)? */
+  /* Write until the whole buffer has been accepted */
 
   written = 0;
   do
     {
-      nbytes = write(DD_OUTFD, buffer, dd->sectsize - written);
+      nbytes = write(DD_OUTFD, buffer, nwrite - written);
       if (nbytes < 0)
         {
            FAR struct nsh_vtbl_s *vtbl = dd->vtbl;
-           nsh_output(vtbl, g_fmtcmdfailed, g_dd, "write", NSH_ERRNO_OF(-nbytes));
+           nsh_output(vtbl, g_fmtcmdfailed, g_dd, "write", NSH_ERRNO);
            return ERROR;
         }
 
       written += nbytes;
       buffer  += nbytes;
     }
-  while (written < dd->sectsize);
+  while (written < nwrite);
 
   return OK;
 }
@@ -273,12 +398,13 @@ static int dd_writech(struct dd_s *dd)
  ****************************************************************************/
 
 #ifndef CONFIG_DISABLE_MOUNTPOINT
-static int dd_readblk(struct dd_s *dd)
+static ssize_t dd_readblk(struct dd_s *dd, FAR struct dd_xfer_s *xfer)
 {
   ssize_t nbytes;
-  off_t   offset = dd->sector * dd->sectsize;
+  off_t   offset = (off_t)(xfer->sector + dd->skip) * dd->sectsize;
 
-  nbytes = bchlib_read(DD_INHANDLE, (char*)dd->buffer, offset, dd->sectsize);
+  nbytes = bchlib_read(DD_INHANDLE, (char*)xfer->buffer, offset,
+                       xfer->nsectors * dd->sectsize);
   if (nbytes < 0)
     {
       FAR struct nsh_vtbl_s *vtbl = dd->vtbl;
@@ -288,9 +414,43 @@ static int dd_readblk(struct dd_s *dd)
 
   /* bchlib_read return 0 on attempts to write past the end of the device. */
 
-  dd->nbytes = nbytes;
-  dd->eof    = (nbytes == 0);
-  return OK;
+  return nbytes;
+}
+#endif
+
+/****************************************************************************
+ * Name: dd_readdirect
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+static ssize_t dd_readdirect(struct dd_s *dd, FAR struct dd_xfer_s *xfer)
+{
+  FAR struct inode *inode = DD_ININODE;
+  size_t  start = (size_t)(xfer->sector + dd->skip) * dd->inmult;
+  size_t  count = (size_t)xfer->nsectors * dd->inmult;
+  ssize_t nsectors;
+
+  /* Reading past the end of the device returns zero bytes (end-of-file) */
+
+  if (start >= dd->indevsize)
+    {
+      return 0;
+    }
+
+  if (count > dd->indevsize - start)
+    {
+      count = dd->indevsize - start;
+    }
+
+  nsectors = inode->u.i_bops->read(inode, xfer->buffer, start, count);
+  if (nsectors < 0)
+    {
+      FAR struct nsh_vtbl_s *vtbl = dd->vtbl;
+      nsh_output(vtbl, g_fmtcmdfailed, g_dd, "read", NSH_ERRNO_OF(-nsectors));
+      return ERROR;
+    }
+
+  return nsectors * (dd->sectsize / dd->inmult);
 }
 #endif
 
@@ -298,29 +458,32 @@ static int dd_readblk(struct dd_s *dd)
  * Name: dd_readch
  ****************************************************************************/
 
-static int dd_readch(struct dd_s *dd)
+static ssize_t dd_readch(struct dd_s *dd, FAR struct dd_xfer_s *xfer)
 {
-  uint8_t *buffer = dd->buffer;
-  ssize_t nbytes;
+  uint8_t *buffer = xfer->buffer;
+  size_t   nread  = xfer->nsectors * dd->sectsize;
+  size_t   total;
+  ssize_t  nbytes;
+
+  /* Read until the buffer is full or the end of the input is reached */
 
-  dd->nbytes = 0;
+  total = 0;
   do
     {
-      nbytes = read(DD_INFD, buffer, dd->sectsize - dd->nbytes);
+      nbytes = read(DD_INFD, buffer, nread - total);
       if (nbytes < 0)
         {
            FAR struct nsh_vtbl_s *vtbl = dd->vtbl;
-           nsh_output(vtbl, g_fmtcmdfailed, g_dd, "read", NSH_ERRNO_OF(-nbytes));
+           nsh_output(vtbl, g_fmtcmdfailed, g_dd, "read", NSH_ERRNO);
            return ERROR;
         }
 
-      dd->nbytes += nbytes;
-      buffer     += nbytes;
+      total  += nbytes;
+      buffer += nbytes;
     }
-  while (dd->nbytes < dd->sectsize && nbytes > 0);
+  while (total < nread && nbytes > 0);
 
-  dd->eof |= (dd->nbytes == 0);
-  return OK;
+  return total;
 }
 
 /****************************************************************************
@@ -345,6 +508,65 @@ static int dd_filetype(const char *filename)
 }
 #endif
 
+/****************************************************************************
+ * Name: dd_directopen
+ *
+ * Description:
+ *   Open a block driver for direct access, bypassing the single sector
+ *   cache of the BCH layer.  This is only possible if the sector size
+ *   selected with bs= is a multiple of the device sector size.  Returns
+ *   a negated errno value if direct access is not possible; the caller
+ *   then falls back to the BCH layer.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+static int dd_directopen(FAR struct dd_s *dd, FAR const char *name,
+                         bool readonly, FAR struct inode **inode,
+                         FAR uint16_t *mult, FAR size_t *devsize)
+{
+  FAR const struct block_operations *bops;
+  struct geometry geo;
+  int ret;
+
+  ret = open_blockdriver(name, readonly ? MS_RDONLY : 0, inode);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  bops = (*inode)->u.i_bops;
+  if (bops->geometry == NULL ||
+      (readonly ? bops->read == NULL : bops->write == NULL))
+    {
+      ret = -ENOSYS;
+      goto errout_with_driver;
+    }
+
+  ret = bops->geometry(*inode, &geo);
+  if (ret < 0)
+    {
+      goto errout_with_driver;
+    }
+
+  if (!geo.geo_available || geo.geo_sectorsize == 0 ||
+      (dd->sectsize % geo.geo_sectorsize) != 0 ||
+      (!readonly && !geo.geo_writeenabled))
+    {
+      ret = -EINVAL;
+      goto errout_with_driver;
+    }
+
+  *mult    = dd->sectsize / geo.geo_sectorsize;
+  *devsize = geo.geo_nsectors;
+  return OK;
+
+errout_with_driver:
+  (void)close_blockdriver(*inode);
+  return ret;
+}
+#endif
+
 /****************************************************************************
  * Name: dd_infopen
  ****************************************************************************/
@@ -378,9 +600,22 @@ static inline int dd_infopen(const char *name, struct dd_s *dd)
 
       dd->infread  = dd_readch;  /* Character oriented read */
       dd->infclose = dd_infclosech;
+      dd->inseek   = false;
     }
   else
     {
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+      ret = dd_directopen(dd, name, true, &DD_ININODE, &dd->inmult,
+                          &dd->indevsize);
+      if (ret == OK)
+        {
+          dd->infread  = dd_readdirect;
+          dd->infclose = dd_infclosedirect;
+          dd->inseek   = true;
+          return OK;
+        }
+#endif
+
       ret = bchlib_setup(name, true, &DD_INHANDLE);
       if (ret < 0)
         {
@@ -389,6 +624,7 @@ static inline int dd_infopen(const char *name, struct dd_s *dd)
 
       dd->infread  = dd_readblk;
       dd->infclose = dd_infcloseblk;
+      dd->inseek   = true;
     }
 
   return OK;
@@ -426,6 +662,17 @@ static inline int dd_outfopen(const char *name, struct dd_s *dd)
 
   if (type == true)
     {
+#ifdef CONFIG_NSH_CMDOPT_DD_DIRECT
+      ret = dd_directopen(dd, name, false, &DD_OUTINODE, &dd->outmult,
+                          &dd->outdevsize);
+      if (ret == OK)
+        {
+          dd->outfwrite = dd_writedirect;  /* Direct block write */
+          dd->outfclose = dd_outfclosedirect;
+          return OK;
+        }
+#endif
+
       ret = bchlib_setup(name, true, &DD_OUTHANDLE);
       if (ret < 0)
         {
@@ -468,6 +715,284 @@ static inline int dd_outfopen(const char *name, struct dd_s *dd)
 }
 #endif
 
+/****************************************************************************
+ * Name: dd_fill
+ *
+ * Description:
+ *   Read the next buffer of sectors from the input.  A short read marks
+ *   the end of the input; the final partial sector is padded with zeros.
+ *   On return, xfer->nsectors is the number of sectors to write (possibly
+ *   zero).
+ *
+ ****************************************************************************/
+
+static int dd_fill(FAR struct dd_s *dd, FAR struct dd_xfer_s *xfer,
+                   uint32_t sector)
+{
+  ssize_t nbytes;
+  size_t  nfull;
+
+  xfer->sector   = sector;
+  xfer->nsectors = dd->bufsectors;
+  if (xfer->nsectors > dd->nsectors)
+    {
+      xfer->nsectors = dd->nsectors;
+    }
+
+  nbytes = DD_READ(dd, xfer);
+  if (nbytes < 0)
+    {
+      return ERROR;
+    }
+
+  nfull = xfer->nsectors * dd->sectsize;
+  if ((size_t)nbytes < nfull)
+    {
+      /* Pad with zero if necessary (at the end of file only) */
+
+      dd->eof        = true;
+      xfer->nsectors = (nbytes + dd->sectsize - 1) / dd->sectsize;
+      memset(&xfer->buffer[nbytes], 0,
+             xfer->nsectors * dd->sectsize - nbytes);
+    }
+
+  dd->nsectors -= xfer->nsectors;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: dd_skipch
+ *
+ * Description:
+ *   Character devices cannot be read by sector number, so the sectors
+ *   selected by skip= are read and discarded.
+ *
+ ****************************************************************************/
+
+static int dd_skipch(FAR struct dd_s *dd)
+{
+  FAR struct dd_xfer_s *xfer = &dd->xfer[0];
+  uint32_t remaining = dd->skip;
+  ssize_t nbytes;
+
+  while (remaining > 0)
+    {
+      xfer->nsectors = dd->bufsectors;
+      if (xfer->nsectors > remaining)
+        {
+          xfer->nsectors = remaining;
+        }
+
+      nbytes = DD_READ(dd, xfer);
+      if (nbytes < 0)
+        {
+          return ERROR;
+        }
+
+      if ((size_t)nbytes < xfer->nsectors * dd->sectsize)
+        {
+          dd->eof = true;
+          break;
+        }
+
+      remaining -= xfer->nsectors;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: dd_writer
+ *
+ * Description:
+ *   Writer thread for double buffered transfers.  Buffers are written in
+ *   the order that they were filled until a buffer with no sectors is
+ *   received.  After an error, the remaining buffers are still consumed
+ *   (but not written) so that the reader cannot stall.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_CMDOPT_DD_DOUBLEBUF
+static pthread_addr_t dd_writer(pthread_addr_t arg)
+{
+  FAR struct dd_s *dd = (FAR struct dd_s *)arg;
+  FAR struct dd_xfer_s *xfer;
+  int index = 0;
+
+  for (;;)
+    {
+      while (sem_wait(&dd->filled) < 0)
+        {
+          DEBUGASSERT(errno == EINTR);
+        }
+
+      xfer = &dd->xfer[index];
+      if (xfer->nsectors == 0)
+        {
+          break;
+        }
+
+      if (!dd->wrfail)
+        {
+          if (DD_WRITE(dd, xfer) < 0)
+            {
+              dd->wrfail = true;
+            }
+          else
+            {
+              dd->ndone += xfer->nsectors;
+            }
+        }
+
+      index ^= 1;
+      (void)sem_post(&dd->empty);
+    }
+
+  return NULL;
+}
+#endif
+
+/****************************************************************************
+ * Name: dd_transfer
+ *
+ * Description:
+ *   Copy sectors from the input to the output, one buffer at a time or,
+ *   with CONFIG_NSH_CMDOPT_DD_DOUBLEBUF, reading the next buffer while the
+ *   previous one is being written.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_NSH_CMDOPT_DD_DOUBLEBUF
+static int dd_transfer(FAR struct dd_s *dd)
+{
+  FAR struct dd_xfer_s *xfer = &dd->xfer[0];
+  uint32_t sector = 0;
+  int ret;
+
+  while (!dd->eof && dd->nsectors > 0)
+    {
+      /* Read one buffer of sectors from the input */
+
+      ret = dd_fill(dd, xfer, sector);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      /* Has the incoming data stream ended? */
+
+      if (xfer->nsectors > 0)
+        {
+          ret = DD_WRITE(dd, xfer);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          dd->ndone += xfer->nsectors;
+          sector    += xfer->nsectors;
+        }
+    }
+
+  return OK;
+}
+#else
+static int dd_transfer(FAR struct dd_s *dd)
+{
+  FAR struct nsh_vtbl_s *vtbl = dd->vtbl;
+  FAR struct dd_xfer_s *xfer;
+  pthread_t writer;
+  uint32_t sector = 0;
+  int index = 0;
+  int ret;
+
+  (void)sem_init(&dd->filled, 0, 0);
+  (void)sem_init(&dd->empty, 0, DD_NBUFFERS);
+  dd->wrfail = false;
+
+  ret = pthread_create(&writer, NULL, dd_writer, (pthread_addr_t)dd);
+  if (ret != 0)
+    {
+      nsh_output(vtbl, g_fmtcmdfailed, g_dd, "pthread_create",
+                 NSH_ERRNO_OF(ret));
+      ret = ERROR;
+      goto errout_with_sem;
+    }
+
+  for (;;)
+    {
+      while (sem_wait(&dd->empty) < 0)
+        {
+          DEBUGASSERT(errno == EINTR);
+        }
+
+      xfer = &dd->xfer[index];
+      if (ret == OK && !dd->eof && !dd->wrfail && dd->nsectors > 0)
+        {
+          ret = dd_fill(dd, xfer, sector);
+          if (ret == OK && xfer->nsectors > 0)
+            {
+              /* Hand the buffer to the writer and fill the other one */
+
+              sector += xfer->nsectors;
+              index  ^= 1;
+              (void)sem_post(&dd->filled);
+              continue;
+            }
+        }
+
+      /* Tell the writer that there is nothing more to write */
+
+      xfer->nsectors = 0;
+      (void)sem_post(&dd->filled);
+      break;
+    }
+
+  (void)pthread_join(writer, NULL);
+  if (dd->wrfail)
+    {
+      ret = ERROR;
+    }
+
+errout_with_sem:
+  (void)sem_destroy(&dd->filled);
+  (void)sem_destroy(&dd->empty);
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: dd_report
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_CMDOPT_DD_STATS
+static void dd_report(FAR struct dd_s *dd, FAR const struct timespec *start)
+{
+  struct timespec end;
+  uint64_t nbytes;
+  uint32_t elapsed;
+  uint32_t rate;
+
+  (void)clock_gettime(CLOCK_REALTIME, &end);
+  elapsed = (end.tv_sec - start->tv_sec) * 1000 +
+            (end.tv_nsec - start->tv_nsec) / 1000000;
+  if (elapsed == 0)
+    {
+      elapsed = 1;
+    }
+
+  /* The rate is in units of 0.01 MB/s (1 MB = 1,000,000 bytes) */
+
+  nbytes = (uint64_t)dd->ndone * dd->sectsize;
+  rate   = (uint32_t)(nbytes / (10 * (uint64_t)elapsed));
+
+  nsh_output(dd->vtbl, "%lu bytes copied, %lu.%03lu s, %lu.%02lu MB/s\n",
+             (unsigned long)nbytes, (unsigned long)(elapsed / 1000),
+             (unsigned long)(elapsed % 1000), (unsigned long)(rate / 100),
+             (unsigned long)(rate % 100));
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -479,6 +1004,9 @@ static inline int dd_outfopen(const char *name, struct dd_s *dd)
 int cmd_dd(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 {
   struct dd_s dd;
+#ifdef CONFIG_NSH_CMDOPT_DD_STATS
+  struct timespec start;
+#endif
   char *infile = NULL;
   char *outfile = NULL;
   int ret = ERROR;
@@ -548,21 +1076,39 @@ int cmd_dd(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
     }
 #endif
 
-  /* Allocate the I/O buffer */
-
-  dd.buffer = malloc(dd.sectsize);
-  if (!dd.buffer)
+  if (dd.sectsize == 0)
     {
-      nsh_output(vtbl, g_fmtcmdoutofmemory, g_dd);
+      nsh_output(vtbl, g_fmtarginvalid, g_dd);
       goto errout_with_paths;
     }
 
+  /* Allocate the I/O buffers.  Each holds as many whole sectors as fit in
+   * CONFIG_NSH_COPYBUFSIZE bytes, but at least one.
+   */
+
+  dd.bufsectors = CONFIG_NSH_COPYBUFSIZE / dd.sectsize;
+  if (dd.bufsectors == 0)
+    {
+      dd.bufsectors = 1;
+    }
+
+  for (i = 0; i < DD_NBUFFERS; i++)
+    {
+      dd.xfer[i].buffer = memalign(CONFIG_NSH_COPYBUFALIGN,
+                                   dd.bufsectors * dd.sectsize);
+      if (!dd.xfer[i].buffer)
+        {
+          nsh_output(vtbl, g_fmtcmdoutofmemory, g_dd);
+          goto errout_with_buffers;
+        }
+    }
+
   /* Open the input file */
 
   ret = dd_infopen(infile, &dd);
   if (ret < 0)
     {
-      goto errout_with_paths;
+      goto errout_with_buffers;
     }
 
   /* Open the output file */
@@ -575,57 +1121,41 @@ int cmd_dd(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 
   /* Then perform the data transfer */
 
-  dd.sector = 0;
-  while (!dd.eof && dd.nsectors > 0)
-    {
-      /* Read one sector from from the input */
-
-      ret = DD_READ(&dd);
-      if (ret < 0)
-        {
-          goto errout_with_outf;
-        }
-
-      /* Has the incoming data stream ended? */
-
-      if (!dd.eof)
-        {
-          /* Pad with zero if necessary (at the end of file only) */
-
-          for (i = dd.nbytes; i < dd.sectsize; i++)
-            {
-              dd.buffer[i] = 0;
-            }
-
-          /* Write one sector to the output file */
-
-          if (dd.sector >= dd.skip)
-            {
-              ret = DD_WRITE(&dd);
-              if (ret < 0)
-                {
-                  goto errout_with_outf;
-                }
-
-              /* Decrement to show that a sector was written */
+#ifdef CONFIG_NSH_CMDOPT_DD_STATS
+  (void)clock_gettime(CLOCK_REALTIME, &start);
+#endif
 
-              dd.nsectors--;
-            }
+  ret = OK;
+  if (!dd.inseek)
+    {
+      ret = dd_skipch(&dd);
+    }
 
-          /* Increment the sector number */
+  if (ret == OK)
+    {
+      ret = dd_transfer(&dd);
+    }
 
-          dd.sector++;
-        }
+#ifdef CONFIG_NSH_CMDOPT_DD_STATS
+  if (ret == OK)
+    {
+      dd_report(&dd, &start);
     }
+#endif
 
-  ret = OK;
+  DD_OUTCLOSE(&dd);
 
-errout_with_outf:
+errout_with_inf:
   DD_INCLOSE(&dd);
 
-errout_with_inf:
-  DD_OUTCLOSE(&dd);
-  free(dd.buffer);
+errout_with_buffers:
+  for (i = 0; i < DD_NBUFFERS; i++)
+    {
+      if (dd.xfer[i].buffer)
+        {
+          free(dd.xfer[i].buffer);
+        }
+    }
 
 errout_with_paths:
   if (infile)
@@ -642,4 +1172,3 @@ errout_with_paths:
 }
 
 #endif /* CONFIG_NFILE_DESCRIPTORS && !CONFIG_NSH_DISABLE_DD */
-
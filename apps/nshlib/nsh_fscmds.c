@@ -596,6 +596,8 @@ int cmd_cp(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
   char *srcpath  = NULL;
   char *destpath = NULL;
   char *allocpath = NULL;
+  char *iobuffer = g_iobuffer;
+  size_t iosize = IOBUFFERSIZE;
   int oflags = O_WRONLY|O_CREAT|O_TRUNC;
   int rdfd;
   int wrfd;
@@ -670,16 +672,33 @@ int cmd_cp(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
       goto errout_with_allocpath;
     }
 
+  /* Use a larger, aligned transfer buffer if one is configured.  Fall back
+   * to the shared I/O buffer if it cannot be allocated.
+   */
+
+#if CONFIG_NSH_COPYBUFSIZE > 0
+  iobuffer = memalign(CONFIG_NSH_COPYBUFALIGN, CONFIG_NSH_COPYBUFSIZE);
+  if (iobuffer)
+    {
+      iosize = CONFIG_NSH_COPYBUFSIZE;
+    }
+  else
+    {
+      iobuffer = g_iobuffer;
+    }
+#endif
+
   /* Now copy the file */
 
   for (;;)
     {
+      FAR char *ptr;
       int nbytesread;
       int nbyteswritten;
 
       do
         {
-          nbytesread = read(rdfd, g_iobuffer, IOBUFFERSIZE);
+          nbytesread = read(rdfd, iobuffer, iosize);
           if (nbytesread == 0)
             {
               /* End of file */
@@ -708,12 +727,14 @@ int cmd_cp(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
         }
       while (nbytesread <= 0);
 
+      ptr = iobuffer;
       do
         {
-          nbyteswritten = write(wrfd, g_iobuffer, nbytesread);
+          nbyteswritten = write(wrfd, ptr, nbytesread);
           if (nbyteswritten >= 0)
             {
               nbytesread -= nbyteswritten;
+              ptr        += nbyteswritten;
             }
           else
             {
@@ -740,6 +761,13 @@ int cmd_cp(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
 errout_with_wrfd:
   close(wrfd);
 
+#if CONFIG_NSH_COPYBUFSIZE > 0
+  if (iobuffer != g_iobuffer)
+    {
+      free(iobuffer);
+    }
+#endif
+
 errout_with_allocpath:
   if (allocpath)
     {
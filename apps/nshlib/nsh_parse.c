@@ -49,6 +49,12 @@
 #  include <sys/stat.h>
 #endif
 
+#ifdef CONFIG_NSH_PIPELINE
+#  include <sys/wait.h>
+#  include <sched.h>
+#  include <apps/builtin.h>
+#endif
+
 #include <nuttx/version.h>
 #include <apps/nsh.h>
 
@@ -90,6 +96,14 @@
 #  define NSH_MEMLIST_FREE(m)
 #endif
 
+/* Every stage of a pipeline but the last is followed by a '|' token, so
+ * this is the largest number of stages that will fit into argv[].
+ */
+
+#ifdef CONFIG_NSH_PIPELINE
+#  define NSH_MAX_PIPESTAGES ((MAX_ARGV_ENTRIES + 1) / 2)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -138,6 +152,14 @@ static int nsh_execute(FAR struct nsh_vtbl_s *vtbl,
                int argc, FAR char *argv[], FAR const char *redirfile,
                int oflags);
 
+#ifdef CONFIG_NSH_PIPELINE
+static int nsh_pipewait(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+               pid_t pid);
+static int nsh_pipeline(FAR struct nsh_vtbl_s *vtbl,
+               int argc, FAR char *argv[], FAR const char *redirfile,
+               int oflags);
+#endif
+
 #ifdef CONFIG_NSH_CMDPARMS
 static FAR char *nsh_filecat(FAR struct nsh_vtbl_s *vtbl, FAR char *s1,
                FAR const char *filename);
@@ -203,6 +225,9 @@ static const char g_arg_separator[]   = "`$";
 #endif
 static const char g_redirect1[]       = ">";
 static const char g_redirect2[]       = ">>";
+#ifdef CONFIG_NSH_PIPELINE
+static const char g_pipe[]            = "|";
+#endif
 #ifndef CONFIG_DISABLE_ENVIRON
 static const char g_exitstatus[]      = "?";
 #endif
@@ -746,6 +771,220 @@ errout:
   return nsh_saveresult(vtbl, true);
 }
 
+/****************************************************************************
+ * Name: nsh_pipewait
+ *
+ * Description:
+ *   Wait for one stage of a pipeline to exit.  Returns 0 (OK) if the stage
+ *   exited successfully, 1 if it returned failure exit status, and -1
+ *   (ERROR) if waitpid() failed.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_PIPELINE
+static int nsh_pipewait(FAR struct nsh_vtbl_s *vtbl, FAR const char *cmd,
+                        pid_t pid)
+{
+  int errcode;
+  int rc = 0;
+
+  if (waitpid(pid, &rc, 0) >= 0)
+    {
+      return (rc == 0) ? OK : 1;
+    }
+
+  /* As in nsh_builtin(), ECHILD means that the task has already exited and
+   * its status is lost.  Assume that it ran successfully.
+   */
+
+  errcode = errno;
+  if (errcode == ECHILD)
+    {
+      return OK;
+    }
+
+  nsh_output(vtbl, g_fmtcmdfailed, cmd, "waitpid", NSH_ERRNO_OF(errcode));
+  return ERROR;
+}
+#endif
+
+/****************************************************************************
+ * Name: nsh_pipeline
+ *
+ * Description:
+ *   Execute a pipeline of the form 'cmd1 | cmd2 | ... | cmdN'.  argv[]
+ *   holds all of the stages with the '|' tokens still in place.
+ *
+ *   The stages are started from the last to the first so that each stage
+ *   only ever inherits the pipe that it is connected to.  Stages 2..N must
+ *   be built-in applications; they are started in background with their
+ *   standard input connected to the upstream pipe.  The first stage runs
+ *   in foreground with its output directed into the first pipe.  It may be
+ *   either a built-in application or an NSH command.  Once it completes,
+ *   the NSH copy of the write end is closed so that end-of-file ripples
+ *   down the pipeline, and then each remaining stage is waited for.  The
+ *   result of the pipeline is the result of the last stage.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NSH_PIPELINE
+static int nsh_pipeline(FAR struct nsh_vtbl_s *vtbl,
+                        int argc, FAR char *argv[],
+                        FAR const char *redirfile, int oflags)
+{
+  FAR char **stage[NSH_MAX_PIPESTAGES];
+  pid_t pid[NSH_MAX_PIPESTAGES];
+  int nstages;
+  int outfd;
+  int fd[2];
+  int ret;
+  int i;
+
+  /* Split argv[] into a NULL terminated argument list per stage */
+
+  stage[0] = argv;
+  nstages  = 1;
+
+  for (i = 0; i < argc; i++)
+    {
+      if (strcmp(argv[i], g_pipe) == 0)
+        {
+          argv[i] = NULL;
+          stage[nstages++] = &argv[i + 1];
+        }
+    }
+
+  /* Every stage must name a command and all stages after the first must
+   * be built-in applications that can be wired up to a pipe.
+   */
+
+  for (i = 0; i < nstages; i++)
+    {
+      if (stage[i][0] == NULL)
+        {
+          nsh_output(vtbl, g_nshsyntax, g_pipe);
+          return nsh_saveresult(vtbl, true);
+        }
+
+      if (i > 0 && builtin_isavail(stage[i][0]) < 0)
+        {
+          nsh_output(vtbl, g_fmtcontext, stage[i][0]);
+          return nsh_saveresult(vtbl, true);
+        }
+    }
+
+#ifndef CONFIG_NSH_DISABLEBG
+  if (vtbl->np.np_bg)
+    {
+      nsh_output(vtbl, g_fmtcontext, "&");
+      return nsh_saveresult(vtbl, true);
+    }
+#endif
+
+  /* Start stages N..2 in background.  After each iteration the only pipe
+   * descriptor that NSH still holds is outfd, the write end feeding the
+   * stage that was just started.
+   */
+
+  outfd = -1;
+  for (i = nstages - 1; i > 0; i--)
+    {
+      if (pipe(fd) < 0)
+        {
+          nsh_output(vtbl, g_fmtcmdfailed, stage[i][0], "pipe", NSH_ERRNO);
+          break;
+        }
+
+      /* Hold off the new task until waitpid() can be called on it */
+
+      sched_lock();
+      pid[i] = nsh_builtin_pipe(stage[i][0], stage[i], fd, outfd,
+                                i == nstages - 1 ? redirfile : NULL, oflags);
+      sched_unlock();
+
+      if (pid[i] < 0)
+        {
+          nsh_output(vtbl, g_fmtcmdfailed, stage[i][0], "exec_builtin",
+                     NSH_ERRNO);
+          (void)close(fd[0]);
+          (void)close(fd[1]);
+          break;
+        }
+
+      (void)close(fd[0]);
+      if (outfd >= 0)
+        {
+          (void)close(outfd);
+        }
+
+      outfd = fd[1];
+    }
+
+  if (i > 0)
+    {
+      /* Some stage could not be started.  Closing our write end lets the
+       * stages that did start run to completion.
+       */
+
+      if (outfd >= 0)
+        {
+          (void)close(outfd);
+        }
+
+      for (i++; i < nstages; i++)
+        {
+          (void)nsh_pipewait(vtbl, stage[i][0], pid[i]);
+        }
+
+      return nsh_saveresult(vtbl, true);
+    }
+
+  /* Run the first stage in foreground with its output directed into the
+   * pipeline.
+   */
+
+  if (builtin_isavail(stage[0][0]) >= 0)
+    {
+      sched_lock();
+      pid[0] = nsh_builtin_pipe(stage[0][0], stage[0], NULL, outfd, NULL, 0);
+      sched_unlock();
+
+      (void)close(outfd);
+      if (pid[0] < 0)
+        {
+          nsh_output(vtbl, g_fmtcmdfailed, stage[0][0], "exec_builtin",
+                     NSH_ERRNO);
+        }
+      else
+        {
+          (void)nsh_pipewait(vtbl, stage[0][0], pid[0]);
+        }
+    }
+  else
+    {
+      uint8_t save[SAVE_SIZE];
+
+      /* nsh_undirect() closes outfd when the command completes */
+
+      nsh_redirect(vtbl, outfd, save);
+      (void)nsh_command(vtbl, (int)(stage[1] - argv) - 1, stage[0]);
+      nsh_undirect(vtbl, save);
+    }
+
+  /* Now reap the background stages.  The result of the pipeline is the
+   * result of the last stage.
+   */
+
+  ret = OK;
+  for (i = 1; i < nstages; i++)
+    {
+      ret = nsh_pipewait(vtbl, stage[i][0], pid[i]);
+    }
+
+  return nsh_saveresult(vtbl, ret != OK);
+}
+#endif
+
 /****************************************************************************
  * Name: nsh_filecat
  ****************************************************************************/
@@ -1995,6 +2234,9 @@ static int nsh_parse_command(FAR struct nsh_vtbl_s *vtbl, FAR char *cmdline)
   int       oflags = 0;
   int       argc;
   int       ret;
+#ifdef CONFIG_NSH_PIPELINE
+  int       i;
+#endif
 
   /* Initialize parser state */
 
@@ -2136,9 +2378,28 @@ static int nsh_parse_command(FAR struct nsh_vtbl_s *vtbl, FAR char *cmdline)
       nsh_output(vtbl, g_fmttoomanyargs, cmd);
     }
 
-  /* Then execute the command */
+  /* Then execute the command.  If any argument is a '|', then this is a
+   * pipeline rather than a single command.
+   */
 
-  ret = nsh_execute(vtbl, argc, argv, redirfile, oflags);
+#ifdef CONFIG_NSH_PIPELINE
+  for (i = 1; i < argc; i++)
+    {
+      if (strcmp(argv[i], g_pipe) == 0)
+        {
+          break;
+        }
+    }
+
+  if (i < argc)
+    {
+      ret = nsh_pipeline(vtbl, argc, argv, redirfile, oflags);
+    }
+  else
+#endif
+    {
+      ret = nsh_execute(vtbl, argc, argv, redirfile, oflags);
+    }
 
   /* Free any allocated resources */
 
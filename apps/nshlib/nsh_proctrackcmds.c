@@ -77,6 +77,27 @@ struct perf_track_settings {
     bool timer_test;
 };
 
+#if defined(CONFIG_USEC_MEASURE_PERF)
+/* Accounting data of one task, used by "top" */
+
+struct top_task_s {
+    pid_t pid;
+    struct perf_stats_s stats;
+#if CONFIG_TASK_NAME_SIZE > 0
+    char name[CONFIG_TASK_NAME_SIZE + 1];
+#else
+    char name[12];
+#endif
+};
+
+struct top_snapshot_s {
+    uint32_t time;
+    uint32_t irq_time;
+    int ntasks;
+    struct top_task_s tasks[CONFIG_MAX_TASKS];
+};
+#endif
+
 static bool g_active_cpu_load = false;
 static unsigned char target_load_value;
 
@@ -601,4 +622,201 @@ int cmd_perf_track(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
   return OK;
 }
 
+/************************************************************************
+ * Name: top_sample_task
+ *
+ * Description:
+ *   Function pointer is passed to sched_perf_foreach to record the
+ *   accounting data of every task.
+ *
+ *   Function must match the "sched_perf_foreach_t" type
+ *
+ * Inputs:
+ *   pid - pid from tcb
+ *   *name - string for tcb
+ *   time - time logged for tcb
+ *   arg - pointer to top_snapshot_s
+ *
+ * Return Value:
+ *   void
+ *
+ ************************************************************************/
+static void top_sample_task(pid_t pid, FAR const char *name, uint32_t time,
+                            FAR void *arg)
+{
+    struct top_snapshot_s *snap = (struct top_snapshot_s*)arg;
+    struct top_task_s *task;
+
+    if (snap->ntasks >= CONFIG_MAX_TASKS) {
+        return;
+    }
+
+    task = &snap->tasks[snap->ntasks];
+    if (sched_perf_stats(pid, &task->stats) == OK) {
+        task->pid = pid;
+        strncpy(task->name, name, sizeof(task->name) - 1);
+        task->name[sizeof(task->name) - 1] = '\0';
+        snap->ntasks++;
+    }
+}
+
+/************************************************************************
+ * Name: top_sample_irq
+ *
+ * Description:
+ *   Function pointer is passed to irq_perf_foreach to add up the time
+ *   spent in every interrupt.
+ *
+ *   Function must match the "irq_perf_foreach_t" type
+ *
+ ************************************************************************/
+static void top_sample_irq(int irq, FAR const char *name, uint32_t time,
+                           FAR void *arg)
+{
+    ((struct top_snapshot_s*)arg)->irq_time += time;
+}
+
+/************************************************************************
+ * Name: top_sample
+ *
+ * Description:
+ *   Take a snapshot of the accounting data of all tasks and interrupts.
+ *
+ ************************************************************************/
+static void top_sample(struct top_snapshot_s *snap)
+{
+    snap->ntasks = 0;
+    snap->irq_time = 0;
+    snap->time = get_total_perf_time();
+
+    sched_perf_foreach(top_sample_task, (void*)snap);
+    irq_perf_foreach(top_sample_irq, (void*)snap);
+}
+
+/************************************************************************
+ * Name: top_print
+ *
+ * Description:
+ *   Print what every task used between two snapshots.  Tasks created
+ *   in between are charged from zero.
+ *
+ ************************************************************************/
+static void top_print(FAR struct nsh_vtbl_s *vtbl,
+                      struct top_snapshot_s *prev,
+                      struct top_snapshot_s *curr)
+{
+    struct perf_stats_s zero;
+    struct perf_stats_s *old;
+    struct top_task_s *task;
+    uint32_t total;
+    uint32_t run;
+    int i;
+    int j;
+
+    memset(&zero, 0, sizeof(zero));
+
+    total = curr->time - prev->time;
+    if (total == 0) {
+        total = 1;
+    }
+
+    nsh_output(vtbl, "\r\nInterval: %u uSec, IRQ: %u uSec (%u%%)\r\n",
+               total, curr->irq_time - prev->irq_time,
+               ((curr->irq_time - prev->irq_time) * 100 + total / 200) / total);
+    nsh_output(vtbl, "%3s | %20s | %10s | %4s | %7s | %7s | %10s |\r\n",
+               "Pid", "Name", "Run uSec", "CPU", "VolSw", "InvSw",
+               "Lock uSec");
+
+    for (i = 0; i < curr->ntasks; i++) {
+        task = &curr->tasks[i];
+        old = &zero;
+
+        for (j = 0; j < prev->ntasks; j++) {
+            if (prev->tasks[j].pid == task->pid) {
+                old = &prev->tasks[j].stats;
+                break;
+            }
+        }
+
+        run = task->stats.run_time - old->run_time;
+        nsh_output(vtbl, "%3d | %20s | %10u | %3u%% | %7u | %7u | %10u |\r\n",
+                   task->pid, task->name, run,
+                   (run * 100 + total / 200) / total,
+                   task->stats.nvcsw - old->nvcsw,
+                   task->stats.nivcsw - old->nivcsw,
+                   task->stats.lock_time - old->lock_time);
+    }
+}
+
+/************************************************************************
+ * Name: cmd_top
+ *
+ * Description:
+ *   Show the CPU use of every task and of interrupts over an interval.
+ *   Performance tracking is started if it was not running.
+ *
+ * Inputs:
+ *   vtbl - print re-director
+ *   argc - argument count
+ *   argv - arguments
+ *
+ * Return Value:
+ *   OK or ERROR
+ *
+ ************************************************************************/
+int cmd_top(FAR struct nsh_vtbl_s *vtbl, int argc, char **argv)
+{
+    struct top_snapshot_s *snap[2];
+    unsigned int delay = 1;
+    unsigned int count = 1;
+    unsigned int i;
+    int option;
+
+    while ((option = getopt(argc, argv, "d:n:")) != ERROR) {
+        switch (option) {
+        case 'd':
+            delay = strtoul(optarg, NULL, 0);
+            break;
+        case 'n':
+            count = strtoul(optarg, NULL, 0);
+            break;
+        default:
+            nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+            return ERROR;
+        }
+    }
+
+    if (delay == 0 || count == 0) {
+        nsh_output(vtbl, g_fmtarginvalid, argv[0]);
+        return ERROR;
+    }
+
+    snap[0] = malloc(sizeof(struct top_snapshot_s));
+    snap[1] = malloc(sizeof(struct top_snapshot_s));
+    if (!snap[0] || !snap[1]) {
+        nsh_output(vtbl, g_fmtcmdoutofmemory, argv[0]);
+        free(snap[0]);
+        free(snap[1]);
+        return ERROR;
+    }
+
+    if (!perf_track_active()) {
+        nsh_output(vtbl, "Start Performance Tracking\r\n");
+        start_perf_track();
+    }
+
+    top_sample(snap[0]);
+
+    for (i = 0; i < count; i++) {
+        sleep(delay);
+        top_sample(snap[(i + 1) & 1]);
+        top_print(vtbl, snap[i & 1], snap[(i + 1) & 1]);
+    }
+
+    free(snap[0]);
+    free(snap[1]);
+
+    return OK;
+}
+
 #endif
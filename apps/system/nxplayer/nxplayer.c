@@ -54,6 +54,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
 #include <fcntl.h>
 #include <errno.h>
 #include <dirent.h>
@@ -86,6 +87,14 @@
 #  define CONFIG_NXPLAYER_PLAYTHREAD_STACKSIZE    1500
 #endif
 
+#ifndef CONFIG_NXPLAYER_READTHREAD_STACKSIZE
+#  define CONFIG_NXPLAYER_READTHREAD_STACKSIZE    1024
+#endif
+
+#ifndef CONFIG_NXPLAYER_PREFETCH_DEPTH
+#  define CONFIG_NXPLAYER_PREFETCH_DEPTH  0
+#endif
+
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
@@ -493,6 +502,9 @@ static int nxplayer_mediasearch(FAR struct nxplayer_s *pPlayer,
 static int nxplayer_readbuffer(FAR struct nxplayer_s *pPlayer,
                                FAR struct ap_buffer_s* apb)
 {
+  ssize_t nread = 0;
+  int fd;
+
   /* Validate the file is still open.  It will be closed automatically when
    * we encounter the end of file (or, perhaps, a read error that we cannot
    * handle.
@@ -507,17 +519,38 @@ static int nxplayer_readbuffer(FAR struct nxplayer_s *pPlayer,
       return -ENODATA;
     }
 
-  /* Read data into the buffer. */
+  /* Read data straight into the buffer, bypassing the stdio buffer.  The
+   * file is only ever read in whole buffers from offset zero, so with a
+   * buffer size that is a multiple of the sector size every read is
+   * sector aligned and large enough for multi-sector transfers.  A short
+   * return is only the end of the file if read() says so.
+   */
 
-  apb->nbytes  = fread(&apb->samp, 1, apb->nmaxbytes, pPlayer->fileFd);
+  fd           = fileno(pPlayer->fileFd);
+  apb->nbytes  = 0;
   apb->curbyte = 0;
   apb->flags   = 0;
 
+  while (apb->nbytes < apb->nmaxbytes)
+    {
+      nread = read(fd, &apb->samp[apb->nbytes], apb->nmaxbytes - apb->nbytes);
+      if (nread < 0 && errno == EINTR)
+        {
+          continue;
+        }
+      else if (nread <= 0)
+        {
+          break;
+        }
+
+      apb->nbytes += nread;
+    }
+
   if (apb->nbytes < apb->nmaxbytes)
     {
 #ifdef CONFIG_DEBUG
       int errcode   = errno;
-      int readerror = ferror(pPlayer->fileFd);
+      int readerror = nread < 0;
 
       audvdbg("Closing audio file, nbytes=%d readerr=%d\n",
               apb->nbytes, readerror);
@@ -540,7 +573,7 @@ static int nxplayer_readbuffer(FAR struct nxplayer_s *pPlayer,
       if (apb->nbytes == 0 && readerror)
         {
           DEBUGASSERT(errcode > 0);
-          auddbg("ERROR: fread failed: %d\n", errcode);
+          auddbg("ERROR: read failed: %d\n", errcode);
         }
 #endif
     }
@@ -609,6 +642,153 @@ static int nxplayer_enqueuebuffer(FAR struct nxplayer_s *pPlayer,
   return OK;
 }
 
+/****************************************************************************
+ * Name: nxplayer_readthread
+ *
+ *  This is the read-ahead thread.  It refills the buffers handed to it by
+ *  the play thread and passes them back with an AUDIO_MSG_ENQUEUE message
+ *  so that the play thread never waits on the file system.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+static void *nxplayer_readthread(pthread_addr_t pvarg)
+{
+  struct nxplayer_s       *pPlayer = (struct nxplayer_s *) pvarg;
+  struct audio_msg_s      msg;
+  FAR struct ap_buffer_s  *apb;
+  bool                    reading;
+
+  audvdbg("Entry\n");
+
+  for (; ; )
+    {
+      while (sem_wait(&pPlayer->readwait) != OK)
+        ;
+
+      while (sem_wait(&pPlayer->readsem) != OK)
+        ;
+
+      reading = pPlayer->reading;
+      apb = (FAR struct ap_buffer_s *)dq_remfirst(&pPlayer->readq);
+      sem_post(&pPlayer->readsem);
+
+      if (!reading)
+        {
+          break;
+        }
+
+      /* Past the end of the file the buffer simply stays with us */
+
+      if (apb == NULL || nxplayer_readbuffer(pPlayer, apb) != OK)
+        {
+          continue;
+        }
+
+      msg.msgId = AUDIO_MSG_ENQUEUE;
+      msg.u.pPtr = apb;
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+      msg.session = pPlayer->session;
+#endif
+      mq_send(pPlayer->mq, &msg, sizeof(msg), CONFIG_NXPLAYER_MSG_PRIO);
+    }
+
+  audvdbg("Exit\n");
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxplayer_readahead
+ *
+ *  Hand a returned buffer to the read-ahead thread to be refilled.
+ *
+ ****************************************************************************/
+
+static void nxplayer_readahead(FAR struct nxplayer_s *pPlayer,
+                               FAR struct ap_buffer_s *apb)
+{
+  while (sem_wait(&pPlayer->readsem) != OK)
+    ;
+
+  dq_addlast(&apb->dq_entry, &pPlayer->readq);
+  sem_post(&pPlayer->readsem);
+  sem_post(&pPlayer->readwait);
+}
+
+/****************************************************************************
+ * Name: nxplayer_startreader
+ *
+ *  Start the read-ahead thread once the pipeline has been primed.
+ *
+ ****************************************************************************/
+
+static int nxplayer_startreader(FAR struct nxplayer_s *pPlayer)
+{
+  struct sched_param  sparam;
+  pthread_attr_t      tattr;
+  int                 ret;
+
+  sem_init(&pPlayer->readsem, 0, 1);
+  sem_init(&pPlayer->readwait, 0, 0);
+  dq_init(&pPlayer->readq);
+  pPlayer->reading = true;
+
+  /* Run just below the play thread so that it can always collect the
+   * buffers returned by the device.
+   */
+
+  pthread_attr_init(&tattr);
+  sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 10;
+  (void)pthread_attr_setschedparam(&tattr, &sparam);
+  (void)pthread_attr_setstacksize(&tattr, CONFIG_NXPLAYER_READTHREAD_STACKSIZE);
+
+  ret = pthread_create(&pPlayer->readId, &tattr, nxplayer_readthread,
+                       (pthread_addr_t) pPlayer);
+  if (ret != OK)
+    {
+      auddbg("ERROR: Failed to create readthread: %d\n", ret);
+      pPlayer->readId = 0;
+      sem_destroy(&pPlayer->readsem);
+      sem_destroy(&pPlayer->readwait);
+      return -ret;
+    }
+
+  pthread_setname_np(pPlayer->readId, "readthread");
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxplayer_stopreader
+ *
+ *  Stop the read-ahead thread and wait for it to exit.  A read in progress
+ *  is allowed to finish.
+ *
+ ****************************************************************************/
+
+static void nxplayer_stopreader(FAR struct nxplayer_s *pPlayer)
+{
+  FAR void *value;
+
+  if (pPlayer->readId == 0)
+    {
+      return;
+    }
+
+  while (sem_wait(&pPlayer->readsem) != OK)
+    ;
+
+  pPlayer->reading = false;
+  sem_post(&pPlayer->readsem);
+  sem_post(&pPlayer->readwait);
+
+  pthread_join(pPlayer->readId, &value);
+  pPlayer->readId = 0;
+
+  sem_destroy(&pPlayer->readsem);
+  sem_destroy(&pPlayer->readwait);
+}
+#endif /* CONFIG_NXPLAYER_READAHEAD */
+
 /****************************************************************************
  * Name: nxplayer_thread_playthread
  *
@@ -641,6 +821,10 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
 
   audvdbg("Entry\n");
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  pPlayer->readId = 0;
+#endif
+
   /* Query the audio device for it's preferred buffer size / qty */
 
 #ifdef CONFIG_AUDIO_DRIVER_SPECIFIC_BUFFERS
@@ -786,6 +970,15 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
   audvdbg("%d buffers queued, running=%d streaming=%d\n",
           x, running, streaming);
 
+#if CONFIG_NXPLAYER_PREFETCH_DEPTH > 0
+  /* Ask the device to refill the whole pipeline after an underrun rather
+   * than trickle single buffers through.  Not all devices support this.
+   */
+
+  (void)ioctl(pPlayer->devFd, AUDIOIOC_SETPREFETCH,
+              CONFIG_NXPLAYER_PREFETCH_DEPTH);
+#endif
+
   /* Start the audio device */
 
   if (running && !failed)
@@ -830,6 +1023,17 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
       nxplayer_setbass(pPlayer, pPlayer->bass);
       nxplayer_settreble(pPlayer, pPlayer->treble);
 #endif
+
+#ifdef CONFIG_NXPLAYER_READAHEAD
+      /* Refill returned buffers from the read-ahead thread.  If it cannot
+       * be started, the buffers are refilled here as before.
+       */
+
+      if (streaming)
+        {
+          (void)nxplayer_startreader(pPlayer);
+        }
+#endif
     }
 
   /* Loop until we specifically break.  running == true means that we are
@@ -889,6 +1093,15 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
              * not yet hit the end-of-file.
              */
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+            if (streaming && pPlayer->readId != 0)
+              {
+                /* The read-ahead thread will send it back when filled */
+
+                nxplayer_readahead(pPlayer, msg.u.pPtr);
+              }
+            else
+#endif
             if (streaming)
               {
                 /* Read the next buffer of data */
@@ -941,6 +1154,39 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
               }
             break;
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+          /* The read-ahead thread has refilled a buffer */
+
+          case AUDIO_MSG_ENQUEUE:
+            if (streaming)
+              {
+                FAR struct ap_buffer_s *apb = msg.u.pPtr;
+                bool final = (apb->flags & AUDIO_APB_FINAL) != 0;
+
+                ret = nxplayer_enqueuebuffer(pPlayer, apb);
+                if (ret != OK)
+                  {
+                    /* As above, but the read-ahead thread owns the file.
+                     * It is stopped when we leave the loop.
+                     */
+
+                    streaming = false;
+                    failed = true;
+                  }
+                else
+                  {
+#ifdef CONFIG_DEBUG
+                    outstanding++;
+#endif
+                    if (final)
+                      {
+                        streaming = false;
+                      }
+                  }
+              }
+            break;
+#endif
+
           /* Someone wants to stop the playback. */
 
           case AUDIO_MSG_STOP:
@@ -982,6 +1228,24 @@ static void *nxplayer_playthread(pthread_addr_t pvarg)
 err_out:
   audvdbg("Clean-up and exit\n");
 
+#ifdef CONFIG_NXPLAYER_READAHEAD
+  nxplayer_stopreader(pPlayer);
+#endif
+
+#if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_VERBOSE)
+  {
+    struct audio_stats_s stats;
+
+    if (ioctl(pPlayer->devFd, AUDIOIOC_GETSTATS,
+              (unsigned long) &stats) == OK)
+      {
+        audvdbg("%lu buffers, %lu underruns, low water %u\n",
+                (unsigned long)stats.dequeued,
+                (unsigned long)stats.underruns, stats.lowwater);
+      }
+  }
+#endif
+
   /* Unregister the message queue and release the session */
 
   ioctl(pPlayer->devFd, AUDIOIOC_UNREGISTERMQ, (unsigned long) pPlayer->mq);
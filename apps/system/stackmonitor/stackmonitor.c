@@ -43,10 +43,13 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <sched.h>
+#include <stdio.h>
+#include <string.h>
 #include <syslog.h>
 #include <errno.h>
 
 #include <nuttx/arch.h>
+#include <nuttx/sched.h>
 
 #ifdef CONFIG_SYSTEM_STACKMONITOR
 
@@ -70,6 +73,17 @@
 #  define CONFIG_SYSTEM_STACKMONITOR_INTERVAL 2
 #endif
 
+#ifndef CONFIG_SYSTEM_STACKMONITOR_MARGIN
+#  define CONFIG_SYSTEM_STACKMONITOR_MARGIN 25
+#endif
+
+/* The suggested stack size leaves at least this many bytes above the peak
+ * and is rounded up to a multiple of STKMON_ALIGN.
+ */
+
+#define STKMON_MIN_MARGIN 64
+#define STKMON_ALIGN      16
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -87,6 +101,32 @@ struct stkmon_state_s
 
 static struct stkmon_state_s g_stackmonitor;
 
+#ifdef CONFIG_SCHED_STACK_USAGE
+/* Threads whose stack size is set by a single Kconfig option */
+
+struct stkmon_option_s
+{
+  FAR const char *name;
+  FAR const char *option;
+};
+
+static const struct stkmon_option_s g_stkmon_options[] =
+{
+  { "Idle Task",     "IDLETHREAD_STACKSIZE" },
+  { "init",          "USERMAIN_STACKSIZE" },
+  { "hpwork",        "SCHED_WORKSTACKSIZE" },
+  { "work",          "SCHED_WORKSTACKSIZE" },
+  { "lpwork",        "SCHED_LPWORKSTACKSIZE" },
+  { "Stack Monitor", "SYSTEM_STACKMONITOR_STACKSIZE" },
+  { "gb_rx_worker",  "GREYBUS_RX_WORKER_POOL_STACKSIZE" },
+  { "gb_uart_rx",    "GREYBUS_UART_RX_STACKSIZE" },
+  { "gb_hid_report", "GREYBUS_HID_STACKSIZE" },
+  { "<pthread>",     "PTHREAD_STACK_DEFAULT" },
+};
+
+#define NSTKMON_OPTIONS (sizeof(g_stkmon_options) / sizeof(g_stkmon_options[0]))
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -132,6 +172,53 @@ static int stackmonitor_daemon(int argc, char **argv)
   return 0;
 }
 
+/****************************************************************************
+ * Name: stkmon_report
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_STACK_USAGE
+static void stkmon_report(FAR const struct stackusage_s *usage, FAR void *arg)
+{
+  FAR const char *option = NULL;
+  size_t margin;
+  size_t suggested;
+  int i;
+
+  margin = usage->peak * CONFIG_SYSTEM_STACKMONITOR_MARGIN / 100;
+  if (margin < STKMON_MIN_MARGIN)
+    {
+      margin = STKMON_MIN_MARGIN;
+    }
+
+  suggested = (usage->peak + margin + STKMON_ALIGN - 1) & ~(STKMON_ALIGN - 1);
+
+  for (i = 0; i < NSTKMON_OPTIONS; i++)
+    {
+      if (strcmp(usage->name, g_stkmon_options[i].name) == 0)
+        {
+          option = g_stkmon_options[i].option;
+          break;
+        }
+    }
+
+  /* Threads without an option of their own are reported as comments so
+   * that the output can still be merged into a defconfig as is.
+   */
+
+  printf("# %s: size %lu, peak %lu\n",
+         usage->name, (unsigned long)usage->size, (unsigned long)usage->peak);
+
+  if (option)
+    {
+      printf("CONFIG_%s=%lu\n", option, (unsigned long)suggested);
+    }
+  else
+    {
+      printf("# suggested %lu\n", (unsigned long)suggested);
+    }
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -196,4 +283,18 @@ int stackmonitor_stop(int argc, char **argv)
   return 0;
 }
 
+#ifdef CONFIG_SCHED_STACK_USAGE
+int stackmonitor_report(int argc, char **argv)
+{
+  /* Emit a Kconfig fragment with the peak stack use of every thread seen
+   * since boot plus CONFIG_SYSTEM_STACKMONITOR_MARGIN percent.
+   */
+
+  printf("# Stack sizes suggested from peak usage + %d%%\n",
+         CONFIG_SYSTEM_STACKMONITOR_MARGIN);
+  sched_stackusage(stkmon_report, NULL);
+  return 0;
+}
+#endif
+
 #endif /* CONFIG_SYSTEM_STACKMONITOR */
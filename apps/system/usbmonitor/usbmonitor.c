@@ -44,6 +44,7 @@
 #include <stdbool.h>
 #include <unistd.h>
 #include <sched.h>
+#include <fcntl.h>
 #include <syslog.h>
 #include <errno.h>
 
@@ -72,6 +73,14 @@
 #  define CONFIG_SYSTEM_USBMONITOR_INTERVAL 2
 #endif
 
+#ifndef CONFIG_USBDEV_TRACE
+#  undef CONFIG_SYSTEM_USBMONITOR_BINARY
+#endif
+
+#ifndef CONFIG_SYSTEM_USBMONITOR_BINARY_PATH
+#  define CONFIG_SYSTEM_USBMONITOR_BINARY_PATH "/dev/ttyS1"
+#endif
+
 /* USB device trace selection */
 
 #ifdef CONFIG_USBDEV_TRACE
@@ -137,7 +146,7 @@ static struct usbmon_state_s g_usbmonitor;
  * Private Functions
  ****************************************************************************/
 
-#ifdef CONFIG_USBDEV_TRACE
+#if defined(CONFIG_USBDEV_TRACE) && !defined(CONFIG_SYSTEM_USBMONITOR_BINARY)
 static int usbmonitor_tracecallback(struct usbtrace_s *trace, void *arg)
 {
   usbtrace_trprintf((trprintf_t)syslog, trace->event, trace->value);
@@ -147,6 +156,18 @@ static int usbmonitor_tracecallback(struct usbtrace_s *trace, void *arg)
 
 static int usbmonitor_daemon(int argc, char **argv)
 {
+#ifdef CONFIG_SYSTEM_USBMONITOR_BINARY
+  int fd;
+
+  fd = open(CONFIG_SYSTEM_USBMONITOR_BINARY_PATH,
+            O_WRONLY | O_CREAT | O_APPEND, 0666);
+  if (fd < 0)
+    {
+      syslog(USBMON_PREFIX "ERROR: Failed to open %s: %d\n",
+             CONFIG_SYSTEM_USBMONITOR_BINARY_PATH, errno);
+    }
+#endif
+
   syslog(USBMON_PREFIX "Running: %d\n", g_usbmonitor.pid);
 
   /* Loop until we detect that there is a request to stop. */
@@ -154,7 +175,12 @@ static int usbmonitor_daemon(int argc, char **argv)
   while (!g_usbmonitor.stop)
     {
       sleep(CONFIG_SYSTEM_USBMONITOR_INTERVAL);
-#ifdef CONFIG_USBDEV_TRACE
+#if defined(CONFIG_SYSTEM_USBMONITOR_BINARY)
+      if (fd >= 0)
+        {
+          (void)usbtrace_dump(fd);
+        }
+#elif defined(CONFIG_USBDEV_TRACE)
       (void)usbtrace_enumerate(usbmonitor_tracecallback, NULL);
 #endif
 #ifdef CONFIG_USBHOST_TRACE
@@ -162,6 +188,13 @@ static int usbmonitor_daemon(int argc, char **argv)
 #endif
     }
 
+#ifdef CONFIG_SYSTEM_USBMONITOR_BINARY
+  if (fd >= 0)
+    {
+      close(fd);
+    }
+#endif
+
   /* Stopped */
 
   g_usbmonitor.stop    = false;
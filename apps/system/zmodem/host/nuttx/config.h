@@ -62,8 +62,11 @@
 #define CONFIG_SYSTEM_ZMODEM_RCVBUFSIZE 512
 #define CONFIG_SYSTEM_ZMODEM_PKTBUFSIZE 1024
 #define CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE 512
+#define CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE 2048
+#define CONFIG_SYSTEM_ZMODEM_SNDWINDOW 0
+#define CONFIG_SYSTEM_ZMODEM_RCVSTREAM 1
 #define CONFIG_SYSTEM_ZMODEM_MOUNTPOINT "/tmp"
-#undef  CONFIG_SYSTEM_ZMODEM_RCVSAMPLE
+#define CONFIG_SYSTEM_ZMODEM_RCVSAMPLE 1
 #undef  CONFIG_SYSTEM_ZMODEM_SENDATTN
 #define CONFIG_SYSTEM_ZMODEM_ALWAYSSINT 1
 #undef  CONFIG_SYSTEM_ZMODEM_SENDBRAK
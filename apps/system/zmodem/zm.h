@@ -49,6 +49,9 @@
 
 #include <stdint.h>
 #include <debug.h>
+#ifdef CONFIG_SERIAL_TERMIOS
+#  include <termios.h>
+#endif
 
 #include <nuttx/compiler.h>
 #include <nuttx/ascii.h>
@@ -58,6 +61,16 @@
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE
+#  define CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE 2048
+#endif
+
+#ifndef CONFIG_SYSTEM_ZMODEM_SNDWINDOW
+#  define CONFIG_SYSTEM_ZMODEM_SNDWINDOW 0
+#endif
+
 /* ZModem *******************************************************************/
 /* Zmodem ZRINIT flags.  These bits describe the cababilities of the receiver.
  * Reference: Paragraph 11.2:
@@ -202,6 +215,7 @@
 #define ZM_FLAG_APPEND    (1 << 7)   /* Append to the existing file */
 #define ZM_FLAG_TIMEOUT   (1 << 8)   /* A timeout has been detected */
 #define ZM_FLAG_OO        (1 << 9)   /* "OO" may be received */
+#define ZM_FLAG_RESYNC    (1 << 10)  /* Drop garbled headers, ZRPOS was sent */
 
 /* The Zmodem parser success/error return code definitions:
  *
@@ -344,6 +358,10 @@ struct zm_state_s
   uint16_t nerrors;          /* Number of data errors */
   timer_t  timer;            /* Watchdog timer */
   int      remfd;            /* The R/W file descritor used for communication with remote */
+#ifdef CONFIG_SERIAL_TERMIOS
+  bool     rawmode;          /* True: remfd was switched to raw mode */
+  struct termios tio;        /* Saved terminal settings of remfd */
+#endif
 
   /* Buffers.
    *
@@ -352,11 +370,14 @@ struct zm_state_s
    * scratch - Holds data sent to the remote peer.  Since the data is this
    *           buffer is short lived, this buffer may also be used for other
    *           scratch purposes.
+   * filebuf - Local file data.  The file is read or written in chunks of
+   *           this size, aligned to this size in the file.
    */
 
   uint8_t  rcvbuf[CONFIG_SYSTEM_ZMODEM_RCVBUFSIZE];
   uint8_t  pktbuf[ZM_PKTBUFSIZE];
   uint8_t  scratch[CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE];
+  uint8_t  filebuf[CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE];
 };
 
 /* Receive state information */
@@ -378,6 +399,7 @@ struct zmr_state_s
   uint8_t f3;                /* Transfer flag F3 */
 #endif
   uint8_t ntimeouts;         /* Number of timeouts */
+  uint16_t fblen;            /* Number of bytes buffered in filebuf[] */
   uint32_t crc;              /* Remove file CRC */
   FAR char *filename;        /* Local filename */
   FAR char *attn;            /* Attention string received from remote peer */
@@ -402,6 +424,8 @@ struct zms_state_s
   uint8_t dpkttype;          /* Streaming data packet type: ZCRCG, ZCRCQ, or ZCRCW */
   uint8_t fflags[4];         /* File xfer flags */
   uint16_t rcvmax;           /* Max packet size the remote can receive. */
+  uint16_t fbndx;            /* Index of the next byte to send in filebuf[] */
+  uint16_t fblen;            /* Number of valid bytes in filebuf[] */
 #ifdef CONFIG_SYSTEM_ZMODEM_TIMESTAMPS
   uint32_t timestamp;        /* Local file timestamp */
 #endif
@@ -571,7 +595,7 @@ int zm_writefile(int fd, FAR const uint8_t *buffer, size_t buflen, bool zcnl);
  *   Perform CRC32 calculation on a file.
  *
  * Assumptions:
- *   The allocated I/O buffer is available to buffer file data.
+ *   The file buffer is available to buffer file data.
  *
  ****************************************************************************/
 
@@ -739,6 +763,26 @@ int zm_timeout(FAR struct zm_state_s *pzm);
 bool zm_rcvpending(FAR struct zm_state_s *pzm);
 #endif
 
+/****************************************************************************
+ * Name: zm_rawmode and zm_restoremode
+ *
+ * Description:
+ *   Disable all input and output processing on the remote device for the
+ *   duration of the transfer, and restore the previous settings.  Without
+ *   processing, the serial driver moves data in blocks instead of one
+ *   character at a time (and the binary data is not altered by CR/LF
+ *   conversions).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SERIAL_TERMIOS
+void zm_rawmode(FAR struct zm_state_s *pzm);
+void zm_restoremode(FAR struct zm_state_s *pzm);
+#else
+#  define zm_rawmode(p)
+#  define zm_restoremode(p)
+#endif
+
 /****************************************************************************
  * Name:  zm_timerinit
  *
@@ -202,19 +202,21 @@ int zm_senddata(FAR struct zm_state_s *pzm, FAR const uint8_t *buffer,
   zmdbg("zbin=%c, buflen=%d, term=%c flags=%04x\n",
         zbin, buflen, term, pzm->flags);
 
-  /* Transfer the data to the I/O buffer, accumulating the CRC */
+  /* Accumulate the CRC over the whole buffer */
 
-  while (buflen-- > 0)
+  if (zbin == ZBIN)
     {
-      if (zbin == ZBIN)
-        {
-          crc = (uint32_t)crc16part(buffer, 1, (uint16_t)crc);
-        }
-      else /* zbin = ZBIN32 */
-        {
-          crc = crc32part(buffer, 1, crc);
-        }
+      crc = (uint32_t)crc16part(buffer, buflen, (uint16_t)crc);
+    }
+  else /* zbin = ZBIN32 */
+    {
+      crc = crc32part(buffer, buflen, crc);
+    }
 
+  /* Transfer the data to the I/O buffer */
+
+  while (buflen-- > 0)
+    {
       ptr = zm_putzdle(pzm, ptr, *buffer++);
     }
 
@@ -147,6 +147,9 @@ static int zmr_error(FAR struct zm_state_s *pzm);
 static int zmr_parsefilename(FAR struct zmr_state_s *pzmr,
                              FAR const uint8_t *namptr);
 static int zmr_openfile(FAR struct zmr_state_s *pzmr, uint32_t crc);
+static int zmr_flush(FAR struct zmr_state_s *pzmr);
+static int zmr_filewrite(FAR struct zmr_state_s *pzmr,
+                         FAR const uint8_t *buffer, size_t buflen);
 static int zmr_fileerror(FAR struct zmr_state_s *pzmr, uint8_t type,
                          uint32_t data);
 static void zmr_filecleanup(FAR struct zmr_state_s *pzmr);
@@ -326,8 +329,17 @@ static int zmr_zrinit(FAR struct zm_state_s *pzm)
   /* Send ZRINIT */
 
   pzm->timeout = CONFIG_SYSTEM_ZMODEM_RESPTIME;
+#ifdef CONFIG_SYSTEM_ZMODEM_RCVSTREAM
+  /* A buffer size of zero means that the sender may stream the whole file
+   * without waiting for a ZACK.
+   */
+
+  buf[0]       = 0;
+  buf[1]       = 0;
+#else
   buf[0]       = CONFIG_SYSTEM_ZMODEM_PKTBUFSIZE & 0xff;
   buf[1]       = (CONFIG_SYSTEM_ZMODEM_PKTBUFSIZE >> 8) & 0xff;
+#endif
   buf[2]       = 0;
   buf[3]       = pzmr->rcaps;
   return zm_sendhexhdr(pzm, ZRINIT, buf);
@@ -511,6 +523,7 @@ static int zmr_zfile(FAR struct zm_state_s *pzm)
 
   pzm->nerrors = 0;
   pzm->flags  &= ~ZM_FLAG_OO;   /* In case we get here from ZMR_FINISH */
+  pzm->flags  &= ~ZM_FLAG_RESYNC;
 
   /* Cache flags (skipping of the initial header type byte) */
 
@@ -559,8 +572,9 @@ static int zmr_zdata(FAR struct zm_state_s *pzm)
        return zmr_fileerror(pzmr, ZRPOS, (uint32_t)pzmr->offset);
    }
 
-  /* Setup to receive a data packet.  Enter PSTATE_DATA */
+  /* Back in sync.  Setup to receive a data packet.  Enter PSTATE_DATA */
 
+  pzm->flags &= ~ZM_FLAG_RESYNC;
   zm_readstate(pzm);
   return OK;
 }
@@ -762,8 +776,7 @@ static int zmr_filedata(FAR struct zm_state_s *pzm)
 
   /* Write the packet of data to the file */
 
-  ret = zm_writefile(pzmr->outfd, pzm->pktbuf, pzm->pktlen,
-                     pzmr->f0 == ZCNL);
+  ret = zmr_filewrite(pzmr, pzm->pktbuf, pzm->pktlen);
   if (ret < 0)
     {
       int errorcode = errno;
@@ -922,10 +935,11 @@ static int zmr_zeof(FAR struct zm_state_s *pzm)
       return OK;         /* it was probably spurious */
     }
 
-  /* Close the output file.
-   * TODO: if we can't close the file, send a ZFERR.
+  /* Write out any buffered data and close the output file.
+   * TODO: if we can't flush or close the file, send a ZFERR.
    */
 
+  (void)zmr_flush(pzmr);
   close(pzmr->outfd);
   pzmr->outfd = -1;
 
@@ -1430,6 +1444,8 @@ static int zmr_openfile(FAR struct zmr_state_s *pzmr, uint32_t crc)
           zmdbg("ERROR: Failed to open %s: %d\n", pzmr->filename, errno);
           goto skip;
         }
+
+      pzmr->fblen = 0;
     }
 
   /* Are we appending/resuming a transfer? */
@@ -1464,6 +1480,93 @@ skip:
   return zm_sendhexhdr(&pzmr->cmn, ZSKIP, g_zeroes);
 }
 
+/****************************************************************************
+ * Name: zmr_flush
+ *
+ * Description:
+ *   Write any file data buffered in filebuf[] to the output file.
+ *
+ ****************************************************************************/
+
+static int zmr_flush(FAR struct zmr_state_s *pzmr)
+{
+  int ret = OK;
+
+  if (pzmr->fblen > 0)
+    {
+      ret = zm_writefile(pzmr->outfd, pzmr->cmn.filebuf, pzmr->fblen, false);
+      pzmr->fblen = 0;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: zmr_filewrite
+ *
+ * Description:
+ *   Add a packet of received data to the output file.  Packets are small
+ *   so, unless newline conversion is requested, the data is accumulated in
+ *   filebuf[] and written in blocks aligned to the buffer size in the file.
+ *
+ ****************************************************************************/
+
+static int zmr_filewrite(FAR struct zmr_state_s *pzmr,
+                         FAR const uint8_t *buffer, size_t buflen)
+{
+  off_t offset = pzmr->offset;
+  size_t nbytes;
+  int ret;
+
+  if (pzmr->f0 == ZCNL)
+    {
+      ret = zmr_flush(pzmr);
+      if (ret == OK)
+        {
+          ret = zm_writefile(pzmr->outfd, buffer, buflen, true);
+        }
+
+      return ret;
+    }
+
+  while (buflen > 0)
+    {
+      /* Copy up to the next buffer-size boundary of the file */
+
+      nbytes = CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE -
+               offset % CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE;
+      if (nbytes > CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE - pzmr->fblen)
+        {
+          nbytes = CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE - pzmr->fblen;
+        }
+
+      if (nbytes > buflen)
+        {
+          nbytes = buflen;
+        }
+
+      memcpy(&pzmr->cmn.filebuf[pzmr->fblen], buffer, nbytes);
+      pzmr->fblen += nbytes;
+      offset      += nbytes;
+      buffer      += nbytes;
+      buflen      -= nbytes;
+
+      /* Write the buffer out when it is full or at a boundary */
+
+      if (pzmr->fblen >= CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE ||
+          (offset % CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE) == 0)
+        {
+          ret = zmr_flush(pzmr);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+    }
+
+  return OK;
+}
+
 /****************************************************************************
  * Name: zmr_fileerror
  *
@@ -1539,7 +1642,14 @@ static int zmr_fileerror(FAR struct zmr_state_s *pzmr, uint8_t type,
         }
     }
 
-  /* Send the specified header */
+  /* Send the specified header.  After ZRPOS, discard everything up to the
+   * ZDATA header with the requested position.
+   */
+
+  if (type == ZRPOS)
+    {
+      pzmr->cmn.flags |= ZM_FLAG_RESYNC;
+    }
 
   zm_be32toby(data, by);
   return zm_sendhexhdr(&pzmr->cmn, type, by);
@@ -1559,6 +1669,7 @@ static void zmr_filecleanup(FAR struct zmr_state_s *pzmr)
 
   if (pzmr->outfd >= 0)
     {
+      (void)zmr_flush(pzmr);
       close(pzmr->outfd);
       pzmr->outfd = -1;
     }
@@ -1618,12 +1729,26 @@ ZMRHANDLE zmr_initialize(int remfd)
       pzm->remfd     = remfd;
       pzmr->outfd    = -1;
 
+      /* We can always check 32-bit CRCs.  Data is received while the file
+       * is written, so the sender may stream if configured to do so.
+       */
+
+      pzmr->rcaps    = CANFC32;
+#ifdef CONFIG_SYSTEM_ZMODEM_RCVSTREAM
+      pzmr->rcaps   |= CANFDX | CANOVIO;
+#endif
+
+      /* Disable character processing on the remote device */
+
+      zm_rawmode(pzm);
+
       /* Create a timer to handle timeout events */
 
       ret = zm_timerinit(pzm);
       if (ret < 0)
         {
           zmdbg("ERROR: zm_timerinit failed: %d\n", ret);
+          zm_restoremode(pzm);
           free(pzmr);
           return (ZMRHANDLE)NULL;
         }
@@ -1700,6 +1825,10 @@ int zmr_release(ZMRHANDLE handle)
 
   zmr_filecleanup(pzmr);
 
+  /* Restore the remote device settings */
+
+  zm_restoremode(&pzmr->cmn);
+
   /* Then release the receive state structure itself */
 
   free(pzmr);
@@ -422,7 +422,7 @@ static int zms_zrinit(FAR struct zm_state_s *pzm)
 
   /* Set flags associated with the capabilities */
 
-  rcaps &= ~(ZM_FLAG_CRC32 | ZM_FLAG_ESCCTRL);
+  pzm->flags &= ~(ZM_FLAG_CRC32 | ZM_FLAG_ESCCTRL);
   if ((rcaps & CANFC32) != 0)
     {
       pzm->flags |= ZM_FLAG_CRC32;
@@ -460,8 +460,10 @@ static int zms_zrinit(FAR struct zm_state_s *pzm)
    *    receiver does not indicate FDX ability with the CANFDX bit.
    */
 
-#ifdef CONFIG_SYSTEM_ZMODEM_RCVSAMPLE
-  /* We support CANFDX.  We can do ZCRCG if the remote sender does too */
+#if defined(CONFIG_SYSTEM_ZMODEM_RCVSAMPLE) || CONFIG_SYSTEM_ZMODEM_SNDWINDOW > 0
+  /* We support CANFDX (or bound the stream with a send window).  We can do
+   * ZCRCG if the remote sender does too.
+   */
 
   if ((rcaps & (CANFDX | CANOVIO)) == (CANFDX | CANOVIO) && pzms->rcvmax == 0)
     {
@@ -861,19 +863,29 @@ static int zms_sendfiledata(FAR struct zm_state_s *pzm)
 static int zms_sendpacket(FAR struct zm_state_s *pzm)
 {
   FAR struct zms_state_s *pzms = (FAR struct zms_state_s *)pzm;
+  FAR const uint8_t *run;
   ssize_t nwritten;
+  ssize_t nread;
   int32_t unacked;
+  int32_t window;
   bool bcrc32;
+  bool eof;
   uint32_t crc;
   uint8_t by[4];
   uint8_t *ptr;
   uint8_t type;
-  bool wait = false;
   int sndsize;
   int pktsize;
-  int ret;
+  int nraw;
   int i;
 
+  /* The total number of unacknowledged bytes is limited by the receiver's
+   * buffer size (rcvmax) or, if the receiver can stream, by the configured
+   * send window.  Zero means no limit.
+   */
+
+  window = pzms->rcvmax != 0 ? pzms->rcvmax : CONFIG_SYSTEM_ZMODEM_SNDWINDOW;
+
   /* Loop, sending packets while we can if the receiver supports streaming
    * data.
    */
@@ -888,37 +900,26 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
 
       unacked = pzms->offset - pzms->lastoffs;
 
-      /* Can we still send?  If so, how much?   If rcvmax is zero, then the
-       * remote can handle full streaming and we never have to wait.
-       * Otherwise, we have to restrict the total number of unacknowledged
-       * bytes to rcvmax.
+      /* Can we still send?  If so, how much?  Restrict the total number of
+       * unacknowledged bytes to the window.
        */
 
-      zmdbg("sndsize: %d unacked: %d rcvmax: %d\n",
-            sndsize, unacked, pzms->rcvmax);
+      zmdbg("sndsize: %d unacked: %d window: %d\n",
+            sndsize, unacked, window);
 
-     if (pzms->rcvmax != 0)
+      if (window != 0 && sndsize + unacked > window)
         {
-          /* If we were to send 'sndsize' more bytes, would that exceed recvmax? */
-
-          if (sndsize + unacked > pzms->rcvmax)
-            {
-              /* Yes... clip the maximum so that we stay within that limit */
+          /* Clip the maximum so that we stay within that limit */
 
-              int maximum = pzms->rcvmax - unacked;
-              if (sndsize < maximum)
-                {
-                  sndsize = maximum;
-                }
-
-              wait = true;
-              zmdbg("Clipped sndsize: %d\n", sndsize);
-            }
+          sndsize = window - unacked;
+          zmdbg("Clipped sndsize: %d\n", sndsize);
         }
 
-      /* Can we send anything? */
+      /* Can we send anything?  Check the file data too:  the file might
+       * be sent completely even though its end has not been sent yet.
+       */
 
-      if (sndsize <= 0)
+      if (sndsize <= 0 && pzms->offset < pzms->filesize)
         {
           /* No, not now. Keep waiting */
 
@@ -929,6 +930,88 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
           return OK;
         }
 
+      /* Fill the packet with file data until the buffer is full, the size
+       * limit is reached, or the file is exhausted.  The file is read in
+       * aligned chunks into filebuf[] and the CRC is computed over each run
+       * of raw file data at once; only the escaping is done per byte.
+       */
+
+      bcrc32      = ((pzm->flags & ZM_FLAG_CRC32) != 0);
+      crc         = bcrc32 ? 0xffffffff : 0;
+      pzm->flags &= ~ZM_FLAG_ATSIGN;
+
+      ptr         = pzm->scratch;
+      pktsize     = 0;
+      nraw        = 0;
+      eof         = false;
+      run         = &pzm->filebuf[pzms->fbndx];
+
+      /* Leave room for an escaped byte and the trailer:  ZDLE, the packet
+       * type and up to eight bytes of escaped CRC-32.
+       */
+
+      while (pktsize <= (CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE - 14) &&
+             nraw < sndsize)
+        {
+          /* Refill the file buffer when it is empty */
+
+          if (pzms->fbndx >= pzms->fblen)
+            {
+              /* Add the file data taken so far to the CRC */
+
+              i = &pzm->filebuf[pzms->fbndx] - run;
+              crc = bcrc32 ? crc32part(run, i, crc) :
+                    (uint32_t)crc16part(run, i, (uint16_t)crc);
+
+              /* Read up to the next buffer-size boundary of the file */
+
+              nread = zm_read(pzms->infd, pzm->filebuf,
+                              CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE -
+                              (pzms->offset + nraw) %
+                              CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE);
+              if (nread < 0)
+                {
+                  zmdbg("ERROR: zm_read failed: %d\n", (int)nread);
+                  return (int)nread;
+                }
+
+              pzms->fbndx = 0;
+              pzms->fblen = nread;
+              run         = pzm->filebuf;
+
+              if (nread == 0)
+                {
+                  eof = true;
+                  break;
+                }
+            }
+
+          /* Put the character into the buffer, escaping as necessary */
+
+          ptr = zm_putzdle(pzm, ptr, pzm->filebuf[pzms->fbndx++]);
+          nraw++;
+
+          /* Recalculate the accumulated packet size to handle expansion due
+           * to escaping.
+           */
+
+          pktsize = (int32_t)(ptr - pzm->scratch);
+        }
+
+      /* Add the rest of the file data to the CRC */
+
+      i = &pzm->filebuf[pzms->fbndx] - run;
+      crc = bcrc32 ? crc32part(run, i, crc) :
+            (uint32_t)crc16part(run, i, (uint16_t)crc);
+
+      /* And advance the file offset */
+
+      pzms->offset += nraw;
+      if (pzms->offset >= pzms->filesize)
+        {
+          eof = true;
+        }
+
       /* Determine what kind of packet to send
        *
        * ZCRCW:
@@ -949,61 +1032,30 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
        *    with the last good file offset.  Another data subpacket
        *    continues immediately.  ZCRCQ subpackets are not used if the
        *    receiver does not indicate FDX ability with the CANFDX bit.
+       *
+       * While streaming with a window, ask for a ZACK once half of the
+       * window is unacknowledged so that the window keeps moving, and end
+       * the frame with ZCRCW when it is full.
        */
 
+      unacked = pzms->offset - pzms->lastoffs;
       if ((pzm->flags & ZM_FLAG_WAIT) != 0)
         {
           type = ZCRCW;
           pzm->flags &= ~ZM_FLAG_WAIT;
         }
-      else if (wait)
+      else if (window != 0 && unacked >= window)
         {
           type = ZCRCW;
         }
-      else
+      else if (pzms->dpkttype == ZCRCG && window != 0 &&
+               unacked >= window / 2)
         {
-          type = pzms->dpkttype;
+          type = ZCRCQ;
         }
-
-      /* Read characters from file and put into buffer until buffer is full
-       * or file is exhausted
-       */
-
-      bcrc32      = ((pzm->flags & ZM_FLAG_CRC32) != 0);
-      crc         = bcrc32 ? 0xffffffff : 0;
-      pzm->flags &= ~ZM_FLAG_ATSIGN;
-
-      ptr         = pzm->scratch;
-      pktsize     = 0;
-
-      while (pktsize <= (CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE - 10) &&
-             (ret = zm_getc(pzms->infd)) != EOF)
+      else
         {
-          /* Add the new value to the accumulated CRC */
-
-          uint8_t ch = (uint8_t)ret;
-          if (!bcrc32)
-            {
-              crc = (uint32_t)crc16part(&ch, 1, (uint16_t)crc);
-            }
-          else
-            {
-              crc = crc32part(&ch, 1, crc);
-            }
-
-          /* Put the character into the buffer, escaping as necessary */
-
-          ptr = zm_putzdle(pzm, ptr, ch);
-
-          /* Recalculate the accumulated packet size to handle expansion due
-           * to escaping.
-           */
-
-          pktsize = (int32_t)(ptr - pzm->scratch);
-
-          /* And increment the file offset */
-
-          pzms->offset++;
+          type = pzms->dpkttype;
         }
 
       /* If we've reached file end, a ZEOF header will follow.  If there's
@@ -1013,10 +1065,10 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
        */
 
       pzm->flags &= ~ZM_FLAG_EOF;
-      if (ret == EOF)
+      if (eof)
         {
           pzm->flags |= ZM_FLAG_EOF;
-          if (wait || (pzms->rcvmax != 0 && pktsize < 24))
+          if (type == ZCRCW || (pzms->rcvmax != 0 && pktsize < 24))
             {
               type = ZCRCW;
             }
@@ -1117,14 +1169,22 @@ static int zms_sendpacket(FAR struct zm_state_s *pzm)
         default:
           zmdbg("ZMS_STATE %d->%d: Default\n", pzm->state, ZMS_SENDING);
 
-          pzm->state = ZMS_SENDING;
+          pzm->state   = ZMS_SENDING;
+          pzm->timeout = CONFIG_SYSTEM_ZMODEM_RESPTIME;
           break;
         }
     }
+
+  /* Keep streaming until the receiver has something to say.  Without
+   * sampling the reverse channel, the window (which ends the frame with
+   * ZCRCW) is what bounds the stream.  Without either, send one ZCRCQ
+   * subpacket per ZACK.
+   */
+
 #ifdef CONFIG_SYSTEM_ZMODEM_RCVSAMPLE
   while (pzm->state == ZMS_SENDING && !zm_rcvpending(pzm));
 #else
-  while (0);
+  while (pzm->state == ZMS_SENDING && window != 0);
 #endif
 
   return OK;
@@ -1177,7 +1237,10 @@ static int zms_sendack(FAR struct zm_state_s *pzm)
     }
 
   zmdbg("ZMS_STATE %d: offset: %ld\n", pzm->state, (unsigned long)pzms->offset);
-  return OK;
+
+  /* The window may have opened up.  Continue streaming */
+
+  return zms_sendpacket(pzm);
 }
 
 /****************************************************************************
@@ -1209,6 +1272,23 @@ static int zms_sendwaitack(FAR struct zm_state_s *pzm)
 
   zmdbg("ZMS_STATE %d: offset: %ld\n", pzm->state, (unsigned long)offset);
 
+  /* This may be a late ACK of an earlier ZCRCQ subpacket.  Keep waiting if
+   * the window is still full.
+   */
+
+  if (pzms->rcvmax != 0 || CONFIG_SYSTEM_ZMODEM_SNDWINDOW > 0)
+    {
+      int32_t window = pzms->rcvmax != 0 ? pzms->rcvmax :
+                       CONFIG_SYSTEM_ZMODEM_SNDWINDOW;
+
+      if (pzms->offset - pzms->lastoffs >= window)
+        {
+          zmdbg("ZMS_STATE %d->%d: Window full\n", pzm->state, ZMS_SENDWAIT);
+          pzm->state = ZMS_SENDWAIT;
+          return OK;
+        }
+    }
+
   /* Now send the next data packet */
 
   zm_be32toby(pzms->offset, by);
@@ -1232,7 +1312,9 @@ static int zms_sendwaitack(FAR struct zm_state_s *pzm)
 static int zms_sendnak(FAR struct zm_state_s *pzm)
 {
   FAR struct zms_state_s *pzms = (FAR struct zms_state_s *)pzm;
+  uint8_t by[4];
   off_t offset;
+  int ret;
 
   /* Save the ZRPOS file offset */
 
@@ -1251,8 +1333,22 @@ static int zms_sendnak(FAR struct zm_state_s *pzm)
       return -errorcode;
     }
 
+  /* Discard any buffered file data */
+
+  pzms->fbndx = 0;
+  pzms->fblen = 0;
+
   zmdbg("ZMS_STATE %d: offset: %ld\n", pzm->state, (unsigned long)pzms->offset);
 
+  /* The receiver discards data until it sees a new ZDATA header */
+
+  zm_be32toby(pzms->offset, by);
+  ret = zm_sendbinhdr(pzm, ZDATA, by);
+  if (ret != OK)
+    {
+      return ret;
+    }
+
   return zms_sendpacket(pzm);
 }
 
@@ -1450,6 +1546,9 @@ static int zms_startfiledata(FAR struct zms_state_s *pzms)
       return -errorcode;
     }
 
+  pzms->fbndx      = 0;
+  pzms->fblen      = 0;
+
   /* Paragraph 8.2: "The sender sends a ZDATA binary header (with file
    * position) followed by one or more data subpackets."
    */
@@ -1522,6 +1621,8 @@ static int zms_sendfile(FAR struct zms_state_s *pzms, FAR const char *filename,
   /* Initialize for the transfer */
 
   pzms->cmn.flags &= ~ZM_FLAG_EOF;
+  pzms->fbndx      = 0;
+  pzms->fblen      = 0;
   pzms->filename   = filename;
   pzms->rfilename  = rfilename;
   DEBUGASSERT(pzms->filename && pzms->rfilename);
@@ -1592,6 +1693,10 @@ ZMSHANDLE zms_initialize(int remfd)
       pzm->psubstate = PIDLE_ZPAD;
       pzm->remfd     = remfd;
 
+      /* Disable character processing on the remote device */
+
+      zm_rawmode(pzm);
+
       /* Create a timer to handle timeout events */
 
       ret = zm_timerinit(pzm);
@@ -1654,6 +1759,7 @@ ZMSHANDLE zms_initialize(int remfd)
 errout_with_timer:
   (void)zm_timerrelease(&pzms->cmn);
 errout:
+  zm_restoremode(&pzms->cmn);
   free(pzms);
   return (ZMSHANDLE)NULL;
 }
@@ -1753,6 +1859,10 @@ int zms_release(ZMSHANDLE handle)
       close(pzms->infd);
     }
 
+  /* Restore the remote device settings */
+
+  zm_restoremode(&pzms->cmn);
+
   /* And free the Zmodem state structure */
 
   free(pzms);
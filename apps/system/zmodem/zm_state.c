@@ -163,6 +163,16 @@ static int zm_nakhdr(FAR struct zm_state_s *pzm)
   pzm->pstate    = PSTATE_IDLE;
   pzm->psubstate = PIDLE_ZPAD;
 
+  /* While resynchronizing after a ZRPOS, the stale data streamed by the
+   * sender is expected to look like garbled headers.  Don't NAK those:
+   * each ZNAK would restart the sender again.
+   */
+
+  if ((pzm->flags & ZM_FLAG_RESYNC) != 0)
+    {
+      return OK;
+    }
+
   /* And NAK the header */
 
   return zm_sendhexhdr(pzm, ZNAK, g_zeroes);
@@ -737,6 +747,47 @@ static int zm_data(FAR struct zm_state_s *pzm, uint8_t ch)
   return OK;
 }
 
+/****************************************************************************
+ * Name: zm_datarun
+ *
+ * Description:
+ *   Fast path of zm_data():  Copy the run of received bytes that need no
+ *   un-escaping straight into the packet buffer.  The run ends at the next
+ *   ZDLE (which is also CAN), XON or XOFF, or when the packet buffer is
+ *   full; zm_data() then handles that byte.
+ *
+ ****************************************************************************/
+
+static void zm_datarun(FAR struct zm_state_s *pzm)
+{
+  FAR const uint8_t *src = &pzm->rcvbuf[pzm->rcvndx];
+  size_t avail = pzm->rcvlen - pzm->rcvndx;
+  size_t room  = ZM_PKTBUFSIZE - pzm->pktlen;
+  size_t n;
+
+  if (avail > room)
+    {
+      avail = room;
+    }
+
+  for (n = 0; n < avail; n++)
+    {
+      uint8_t ch = src[n];
+      if (ch == ZDLE || ch == ASCII_XON || ch == ASCII_XOFF)
+        {
+          break;
+        }
+    }
+
+  if (n > 0)
+    {
+      memcpy(&pzm->pktbuf[pzm->pktlen], src, n);
+      pzm->pktlen += n;
+      pzm->rcvndx += n;
+      pzm->ncan    = 0;
+    }
+}
+
 /****************************************************************************
  * Name: zm_parse
  *
@@ -755,7 +806,7 @@ static int zm_parse(FAR struct zm_state_s *pzm, size_t rcvlen)
   uint8_t ch;
   int ret;
 
-  DEBUGASSERT(pzm && rcvlen < CONFIG_SYSTEM_ZMODEM_RCVBUFSIZE);
+  DEBUGASSERT(pzm && rcvlen <= CONFIG_SYSTEM_ZMODEM_RCVBUFSIZE);
   zm_dumpbuffer("Received", pzm->rcvbuf, rcvlen);
 
   /* We keep a copy of the length and buffer index in the state structure.
@@ -771,6 +822,20 @@ static int zm_parse(FAR struct zm_state_s *pzm, size_t rcvlen)
 
   while (pzm->rcvndx < pzm->rcvlen)
     {
+      /* Move plain packet data in bulk.  Not while the CRC is being
+       * collected or after a ZDLE.
+       */
+
+      if (pzm->pstate == PSTATE_DATA && pzm->ncrc == 0 &&
+          (pzm->flags & ZM_FLAG_ESC) == 0)
+        {
+          zm_datarun(pzm);
+          if (pzm->rcvndx >= pzm->rcvlen)
+            {
+              break;
+            }
+        }
+
       /* Get the next byte from the buffer */
 
       ch = pzm->rcvbuf[pzm->rcvndx];
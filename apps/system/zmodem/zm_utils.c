@@ -42,6 +42,7 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <assert.h>
 #include <errno.h>
 #include <crc32.h>
@@ -334,6 +335,76 @@ int zm_putc(int fd, uint8_t ch)
 }
 #endif
 
+/****************************************************************************
+ * Name: zm_rcvpending
+ *
+ * Description:
+ *   Return true if data from the remote receiver is pending.  In that case,
+ *   the local sender should stop data streaming operations and process the
+ *   incoming data.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSTEM_ZMODEM_RCVSAMPLE
+bool zm_rcvpending(FAR struct zm_state_s *pzm)
+{
+  struct pollfd fds;
+
+  /* Poll without waiting */
+
+  fds.fd      = pzm->remfd;
+  fds.events  = POLLIN;
+  fds.revents = 0;
+
+  return poll(&fds, 1, 0) > 0 && (fds.revents & POLLIN) != 0;
+}
+#endif
+
+/****************************************************************************
+ * Name: zm_rawmode
+ *
+ * Description:
+ *   Disable all input and output processing on the remote device.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SERIAL_TERMIOS
+void zm_rawmode(FAR struct zm_state_s *pzm)
+{
+  struct termios tio;
+
+  /* Not a terminal?  Then there is nothing to do */
+
+  if (tcgetattr(pzm->remfd, &pzm->tio) < 0)
+    {
+      return;
+    }
+
+  tio          = pzm->tio;
+  tio.c_iflag &= ~(INLCR | IGNCR | ICRNL);
+  tio.c_oflag &= ~OPOST;
+
+  pzm->rawmode = (tcsetattr(pzm->remfd, TCSANOW, &tio) == 0);
+}
+
+/****************************************************************************
+ * Name: zm_restoremode
+ *
+ * Description:
+ *   Restore the settings saved by zm_rawmode().
+ *
+ ****************************************************************************/
+
+void zm_restoremode(FAR struct zm_state_s *pzm)
+{
+  if (pzm->rawmode)
+    {
+      (void)tcsetattr(pzm->remfd, TCSANOW, &pzm->tio);
+      pzm->rawmode = false;
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: zm_writefile
  *
@@ -377,7 +448,7 @@ int zm_writefile(int fd, FAR const uint8_t *buffer, size_t buflen, bool zcnl)
             {
               if (nbytes > 0)
                 {
-                  ret     = zm_write(fd, start, nbytes);
+                  ret     = zm_write(fd, start, nbytes) < 0 ? ERROR : OK;
                   start   = buffer;
                   nbytes  = 0;
                 }
@@ -396,7 +467,8 @@ int zm_writefile(int fd, FAR const uint8_t *buffer, size_t buflen, bool zcnl)
                     {
                       /* Write one newline and skip the follow \r or \n */
 
-                      ret     = zm_write(fd, (FAR uint8_t *)"\n", 1);
+                      ret     = zm_write(fd, (FAR uint8_t *)"\n", 1) < 0 ?
+                                ERROR : OK;
                       newline = true;
                     }
                }
@@ -417,14 +489,14 @@ int zm_writefile(int fd, FAR const uint8_t *buffer, size_t buflen, bool zcnl)
 
       if (ret == OK && nbytes > 0)
         {
-          ret = zm_write(fd, start, nbytes);
+          ret = zm_write(fd, start, nbytes) < 0 ? ERROR : OK;
         }
     }
   else
     {
       /* We are not modifying newlines, let zm_write() do the whole job */
 
-      ret = zm_write(fd, buffer, buflen);
+      ret = zm_write(fd, buffer, buflen) < 0 ? ERROR : OK;
     }
 
   return ret;
@@ -437,7 +509,7 @@ int zm_writefile(int fd, FAR const uint8_t *buffer, size_t buflen, bool zcnl)
  *   Perform CRC32 calculation on a file.
  *
  * Assumptions:
- *   The allocated I/O buffer is available to buffer file data.
+ *   The file buffer is available to buffer file data.
  *
  ************************************************************************************************/
 
@@ -461,9 +533,10 @@ uint32_t zm_filecrc(FAR struct zm_state_s *pzm, FAR const char *filename)
   /* Calculate the file CRC */
 
   crc = 0xffffffff;
-  while ((nread = zm_read(fd, pzm->scratch, CONFIG_SYSTEM_ZMODEM_SNDBUFSIZE)) > 0)
+  while ((nread = zm_read(fd, pzm->filebuf,
+                          CONFIG_SYSTEM_ZMODEM_FILEBUFSIZE)) > 0)
     {
-      crc = crc32part(pzm->scratch, nread, crc);
+      crc = crc32part(pzm->filebuf, nread, crc);
     }
 
   /* Close the file and return the CRC */
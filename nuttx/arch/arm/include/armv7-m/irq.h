@@ -383,6 +383,30 @@ extern "C" {
 #define EXTERN extern
 #endif
 
+#ifdef CONFIG_IRQSAVE_TRACE
+/* Route irqsave()/irqrestore() through the interrupts-off tracer.  The
+ * tracer itself uses the inline versions above.
+ */
+
+EXTERN irqstate_t irqsave_trace(void);
+EXTERN void irqrestore_trace(irqstate_t flags);
+
+#  ifndef __IRQTRACE_IMPL
+#    define irqsave()          irqsave_trace()
+#    define irqrestore(flags)  irqrestore_trace(flags)
+#  endif
+
+/* True if 'flags' was returned by an irqsave() that found interrupts
+ * enabled, i.e. by the irqsave() that opened the window.
+ */
+
+#  ifdef CONFIG_ARMV7M_USEBASEPRI
+#    define IRQSTATE_ENABLED(flags) ((flags) == 0)
+#  else
+#    define IRQSTATE_ENABLED(flags) (((flags) & 1) == 0)
+#  endif
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -32,6 +32,8 @@
 uint32_t unipro_p2p_get_boot_status(void);
 void unipro_p2p_setup_connection(unsigned int cport);
 void unipro_p2p_reset_connection(unsigned int cport);
+void unipro_p2p_batch_begin(void);
+int unipro_p2p_batch_end(void);
 void unipro_p2p_setup(void);
 int unipro_p2p_detect_linkloss(bool enable);
 bool unipro_p2p_is_link_up(void);
@@ -45,4 +47,31 @@ void unipro_p2p_setup_test_connection(unsigned int cport, unsigned int test_port
 
 int unipro_test_command(unsigned int command);
 
+#ifdef CONFIG_UNIPRO_LINK_STATS
+struct unipro_link_stats {
+    /* error indications, per layer */
+    uint32_t phy_errors;
+    uint32_t pa_errors;
+    uint32_t dl_errors;
+    uint32_t n_errors;
+    uint32_t t_errors;
+    uint32_t pa_init_errors;
+    /* sampled from PA_PACPErrorCount */
+    uint32_t pacp_errors;
+    uint32_t link_lost;
+    uint32_t pwrmode_changes;
+    /* sampled power mode changes that lowered the link throughput */
+    uint32_t downshifts;
+    /* sampling periods with errors above the retrain threshold */
+    uint32_t degraded;
+    /* last sampled gears and PA_PWRMODE */
+    uint32_t tx_gear;
+    uint32_t rx_gear;
+    uint32_t pwrmode;
+};
+
+void unipro_link_stats_get(struct unipro_link_stats *stats);
+void unipro_link_stats_reset(void);
+#endif
+
 #endif
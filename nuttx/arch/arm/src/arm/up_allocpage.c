@@ -70,9 +70,9 @@ typedef uint16_t pgndx_t;
 typedef uint32_t pgndx_t;
 #endif
 
-#if PG_POOL_MAXL1NDX < 256
+#if PG_POOL_MAXL2NDX < 256
 typedef uint8_t  L1ndx_t;
-#elif PG_POOL_MAXL1NDX < 65536
+#elif PG_POOL_MAXL2NDX < 65536
 typedef uint16_t L1ndx_t;
 #else
 typedef uint32_t L1ndx_t;
@@ -88,6 +88,9 @@ typedef uint32_t L1ndx_t;
  * pages have be filled, then they are blindly freed and re-used in the
  * same order 0, 1, 2, ... because we don't know any better.  No smart "least
  * recently used" kind of logic is supported.
+ *
+ * With CONFIG_PAGING_CLOCK, g_pgndx is instead the hand of a clock (second
+ * chance) replacement policy.  See up_pgvictim().
  */
 
 static pgndx_t g_pgndx;
@@ -108,89 +111,84 @@ static L1ndx_t g_ptemap[CONFIG_PAGING_NPPAGED];
 
 static bool g_pgwrap;
 
+#ifdef CONFIG_PAGING_CLOCK
+/* The ARM9 MMU does not keep a referenced bit so it is emulated:  A page
+ * that the clock hand passes over loses its referenced flag and its PTE
+ * type bits, keeping the physical address.  The next access to the page
+ * faults and up_checkvpage() then restores the mapping and marks the page
+ * as referenced again through up_pgreference().
+ */
+
+static bool g_pgref[CONFIG_PAGING_NPPAGED];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
 /****************************************************************************
- * Public Functions
+ * Name: up_pgvictim()
+ *
+ * Description:
+ *  Return the index of the next physical page to be (re-)used and advance
+ *  g_pgndx.  With CONFIG_PAGING_CLOCK, pages that were referenced since
+ *  the last time the clock hand passed them get a second chance.  This
+ *  terminates after at most one full turn because every page passed over
+ *  loses its referenced flag.
+ *
  ****************************************************************************/
 
+static unsigned int up_pgvictim(void)
+{
+  unsigned int pgndx;
+
+  for (;;)
+    {
+      pgndx = g_pgndx++;
+      if (g_pgndx >= CONFIG_PAGING_NPPAGED)
+        {
+          g_pgndx = 0;
+        }
+
+#ifdef CONFIG_PAGING_CLOCK
+      if (g_pgwrap && g_pgref[pgndx])
+        {
+          uintptr_t vaddr = PG_POOL_NDX2VA(g_ptemap[pgndx]);
+          uint32_t *pte   = up_va2pte(vaddr);
+
+          g_pgref[pgndx] = false;
+          *pte &= ~PTE_TYPE_MASK;
+          tlb_invalidate_single(vaddr);
+          continue;
+        }
+#endif
+
+      return pgndx;
+    }
+}
+
 /****************************************************************************
- * Name: up_allocpage()
+ * Name: up_pgalloc()
  *
  * Description:
- *  This architecture-specific function will set aside page in memory and map
- *  the page to its correct virtual address.  Architecture-specific context
- *  information saved within the TCB will provide the function with the
- *  information needed to identify the virtual miss address.
- *
- *  This function will return the allocated physical page address in vpage.
- *  The size of the underlying physical page is determined by the
- *  configuration setting CONFIG_PAGING_PAGESIZE.
- *
- *  NOTE 1: This function must always return a page allocation. If all
- *  available pages are in-use (the typical case), then this function will
- *  select a page in-use, un-map it, and make it available.
- *
- *  NOTE 2: If an in-use page is un-mapped, it may be necessary to flush the
- *  instruction cache in some architectures.
- *
- *  NOTE 3: Allocating and filling a page is a two step process.  up_allocpage()
- *  allocates the page, and up_fillpage() fills it with data from some non-
- *  volatile storage device.  This distinction is made because up_allocpage()
- *  can probably be implemented in board-independent logic whereas up_fillpage()
- *  probably must be implemented as board-specific logic.
- *
- *  NOTE 4: The initial mapping of vpage should be read-able and write-
- *  able (but not cached).  No special actions will be required of
- *  up_fillpage() in order to write into this allocated page.
- *
- * Input Parameters:
- *   tcb - A reference to the task control block of the task that needs to
- *         have a page fill.  Architecture-specific logic can retrieve page
- *         fault information from the architecture-specific context
- *         information in this TCB to perform the mapping.
- *
- * Returned Value:
- *   This function will return zero (OK) if the allocation was successful.
- *   A negated errno value may be returned if an error occurs.  All errors,
- *   however, are fatal.
- *
- * Assumptions:
- *   - This function is called from the normal tasking context (but with
- *     interrupts disabled).  The implementation must take whatever actions
- *     are necessary to assure that the operation is safe within this
- *     context.
+ *  Common logic of up_allocpage() and up_allocvpage().
  *
  ****************************************************************************/
 
-int up_allocpage(FAR struct tcb_s *tcb, FAR void **vpage)
+static int up_pgalloc(uintptr_t vaddr, FAR void **vpage, bool referenced)
 {
-  uintptr_t vaddr;
   uintptr_t paddr;
   uint32_t *pte;
   unsigned int pgndx;
 
-  /* Since interrupts are disabled, we don't need to anything special. */
-
-  DEBUGASSERT(tcb && vpage);
-
-  /* Get the virtual address that caused the fault */
-
-  vaddr = tcb->xcp.far;
+  DEBUGASSERT(vpage);
   DEBUGASSERT(vaddr >= PG_PAGED_VBASE && vaddr < PG_PAGED_VEND);
 
   /* Allocate page memory to back up the mapping.  Start by getting the
    * index of the next page that we are going to allocate.
    */
 
-  pgndx = g_pgndx++;
-  if (g_pgndx >= CONFIG_PAGING)
-    {
-      g_pgndx  = 0;
-      g_pgwrap = true;
-    }
+  pgndx = up_pgvictim();
 
   /* Was this physical page previously mapped? If so, then we need to un-map
    * it.
@@ -217,6 +215,15 @@ int up_allocpage(FAR struct tcb_s *tcb, FAR void **vpage)
        */
     }
 
+  /* The contents of g_ptemap[] are valid for every page once the last page
+   * of the pool has been handed out.
+   */
+
+  if (pgndx == CONFIG_PAGING_NPPAGED - 1)
+    {
+      g_pgwrap = true;
+    }
+
   /* Then convert the index to a (physical) page address. */
 
   paddr = PG_POOL_PGPADDR(pgndx);
@@ -233,6 +240,9 @@ int up_allocpage(FAR struct tcb_s *tcb, FAR void **vpage)
   /* And save the new L1 index */
 
   g_ptemap[pgndx] = PG_POOL_VA2L2NDX(vaddr);
+#ifdef CONFIG_PAGING_CLOCK
+  g_pgref[pgndx]  = referenced;
+#endif
 
   /* Finally, return the virtual address of allocated page */
 
@@ -240,4 +250,109 @@ int up_allocpage(FAR struct tcb_s *tcb, FAR void **vpage)
   return OK;
 }
 
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_allocpage()
+ *
+ * Description:
+ *  This architecture-specific function will set aside page in memory and map
+ *  the page to its correct virtual address.  Architecture-specific context
+ *  information saved within the TCB will provide the function with the
+ *  information needed to identify the virtual miss address.
+ *
+ *  This function will return the allocated physical page address in vpage.
+ *  The size of the underlying physical page is determined by the
+ *  configuration setting CONFIG_PAGING_PAGESIZE.
+ *
+ *  NOTE 1: This function must always return a page allocation. If all
+ *  available pages are in-use (the typical case), then this function will
+ *  select a page in-use, un-map it, and make it available.
+ *
+ *  NOTE 2: If an in-use page is un-mapped, it may be necessary to flush the
+ *  instruction cache in some architectures.
+ *
+ *  NOTE 3: Allocating and filling a page is a two step process.  up_allocpage()
+ *  allocates the page, and up_fillpage() fills it with data from some non-
+ *  volatile storage device.  This distinction is made because up_allocpage()
+ *  can probably be implemented in board-independent logic whereas up_fillpage()
+ *  probably must be implemented as board-specific logic.
+ *
+ *  NOTE 4: The initial mapping of vpage should be read-able and write-
+ *  able (but not cached).  No special actions will be required of
+ *  up_fillpage() in order to write into this allocated page.
+ *
+ * Input Parameters:
+ *   tcb - A reference to the task control block of the task that needs to
+ *         have a page fill.  Architecture-specific logic can retrieve page
+ *         fault information from the architecture-specific context
+ *         information in this TCB to perform the mapping.
+ *
+ * Returned Value:
+ *   This function will return zero (OK) if the allocation was successful.
+ *   A negated errno value may be returned if an error occurs.  All errors,
+ *   however, are fatal.
+ *
+ * Assumptions:
+ *   - This function is called from the normal tasking context (but with
+ *     interrupts disabled).  The implementation must take whatever actions
+ *     are necessary to assure that the operation is safe within this
+ *     context.
+ *
+ ****************************************************************************/
+
+int up_allocpage(FAR struct tcb_s *tcb, FAR void **vpage)
+{
+  /* Since interrupts are disabled, we don't need to anything special. */
+
+  DEBUGASSERT(tcb);
+
+  /* Map the virtual address that caused the fault */
+
+  return up_pgalloc(tcb->xcp.far, vpage, true);
+}
+
+/****************************************************************************
+ * Name: up_allocvpage()
+ *
+ * Description:
+ *  The same as up_allocpage() but for the page at vaddr.  It is used to
+ *  prefetch pages so the new page is not marked as referenced.
+ *
+ ****************************************************************************/
+
+#if CONFIG_PAGING_PREFETCH > 0
+int up_allocvpage(uintptr_t vaddr, FAR void **vpage)
+{
+  return up_pgalloc(vaddr, vpage, false);
+}
+#endif
+
+/****************************************************************************
+ * Name: up_pgreference()
+ *
+ * Description:
+ *  Restore a mapping that the clock hand invalidated and mark its page as
+ *  referenced.
+ *
+ * Input Parameters:
+ *   pte - The L2 entry of the mapping.  It must still hold the physical
+ *         page address.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PAGING_CLOCK
+void up_pgreference(uint32_t *pte)
+{
+  uintptr_t paddr = *pte & ~PAGEMASK;
+
+  DEBUGASSERT(paddr >= PG_PAGED_PBASE);
+
+  *pte |= (MMU_L2_ALLOCFLAGS & PTE_TYPE_MASK);
+  g_pgref[(paddr - PG_PAGED_PBASE) >> PAGESHIFT] = true;
+}
+#endif
+
 #endif /* CONFIG_PAGING */
@@ -42,11 +42,13 @@
 #include <nuttx/config.h>
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <debug.h>
 
 #include <nuttx/sched.h>
 #include <nuttx/page.h>
 
+#include "pg_macros.h"
 #include "up_internal.h"
 
 #ifdef CONFIG_PAGING
@@ -99,6 +101,7 @@
 
 bool up_checkmapping(FAR struct tcb_s *tcb)
 {
+#ifdef CONFIG_PAGING_CLOCK
   uintptr_t vaddr;
   uint32_t *pte;
 
@@ -111,6 +114,48 @@ bool up_checkmapping(FAR struct tcb_s *tcb)
   vaddr = tcb->xcp.far;
   DEBUGASSERT(vaddr >= PG_PAGED_VBASE && vaddr < PG_PAGED_VEND);
 
+  /* A PTE that still holds a physical address but no type bits was
+   * invalidated by the clock hand.  The page is still in memory, so just
+   * restore the mapping.
+   */
+
+  pte = up_va2pte(vaddr);
+  if (*pte != 0 && (*pte & PTE_TYPE_MASK) == 0)
+    {
+      up_pgreference(pte);
+      tlb_invalidate_single(vaddr);
+    }
+
+  /* Return true if this virtual address is mapped. */
+
+  return (*pte != 0);
+#else
+  /* Since interrupts are disabled, we don't need to anything special. */
+
+  DEBUGASSERT(tcb);
+
+  /* Check the virtual address that caused the fault */
+
+  return up_checkvpage(tcb->xcp.far);
+#endif
+}
+
+/****************************************************************************
+ * Name: up_checkvpage()
+ *
+ * Description:
+ *  The same as up_checkmapping() but for the page at vaddr.  A page that
+ *  the clock hand invalidated counts as mapped because it is still in
+ *  memory, but it is not marked as referenced.
+ *
+ ****************************************************************************/
+
+bool up_checkvpage(uintptr_t vaddr)
+{
+  uint32_t *pte;
+
+  DEBUGASSERT(vaddr >= PG_PAGED_VBASE && vaddr < PG_PAGED_VEND);
+
   /* Get the PTE associated with this virtual address */
 
   pte = up_va2pte(vaddr);
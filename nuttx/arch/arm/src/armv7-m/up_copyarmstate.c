@@ -85,9 +85,13 @@ void up_copyarmstate(uint32_t *dest, uint32_t *src)
     {
       /* Save the floating point registers: This will initialize the floating
        * registers at indices SW_INT_REGS through (SW_INT_REGS+SW_FPU_REGS-1)
+       * With CONFIG_ARMV7M_DEFERFPU, they stay in the FPU until another task
+       * uses it.
        */
 
+#ifndef CONFIG_ARMV7M_DEFERFPU
       up_savefpu(dest);
+#endif
 
       /* Save the block of ARM registers that were saved by the interrupt
        * handling logic.  Indices: 0 through (SW_INT_REGS-1).
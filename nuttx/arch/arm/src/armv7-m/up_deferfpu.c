@@ -0,0 +1,244 @@
+/****************************************************************************
+ * arch/arm/src/armv7-m/up_deferfpu.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/irq.h>
+#include <arch/irq.h>
+
+#include "sched/sched.h"
+#include "nvic.h"
+#include "up_internal.h"
+#include "up_arch.h"
+
+#ifdef CONFIG_ARMV7M_DEFERFPU
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* CPACR: full access to CP10 and CP11, the FPU */
+
+#define CPACR_FPU_ACCESS   ((3 << (2*10)) | (3 << (2*11)))
+
+/* CFSR: UsageFault caused by an access to a disabled coprocessor */
+
+#define CFSR_NOCP          (1 << 19)
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The task whose FP registers are in the FPU.  The FP registers in the
+ * register save area of this task are stale, those of all the other tasks
+ * are up to date.
+ */
+
+static FAR struct tcb_s *g_fpu_owner;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static inline void up_fpu_access(bool enable)
+{
+  uint32_t regval = getreg32(NVIC_CPACR);
+
+  if (enable)
+    {
+      regval |= CPACR_FPU_ACCESS;
+    }
+  else
+    {
+      regval &= ~CPACR_FPU_ACCESS;
+    }
+
+  putreg32(regval, NVIC_CPACR);
+  __asm__ __volatile__ ("dsb\n\tisb\n" : : : "memory");
+}
+
+/* Give the FPU to 'tcb', loading its FP registers from 'regs' */
+
+static void up_fpu_claim(FAR struct tcb_s *tcb, FAR const uint32_t *regs)
+{
+  up_fpu_access(true);
+
+  if (g_fpu_owner && g_fpu_owner != tcb)
+    {
+      up_savefpu(g_fpu_owner->xcp.regs);
+    }
+
+  up_restorefpu(regs);
+  g_fpu_owner = tcb;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_deferfpu_initialize
+ *
+ * Description:
+ *   The FPU is left accessible to the IDLE thread that is running.  The
+ *   chip code must also attach up_deferfpu_fault() to the UsageFault and
+ *   enable it.
+ *
+ ****************************************************************************/
+
+void up_deferfpu_initialize(void)
+{
+  g_fpu_owner = (FAR struct tcb_s *)g_readytorun.head;
+}
+
+/****************************************************************************
+ * Name: up_deferfpu_fault
+ *
+ * Description:
+ *   UsageFault handler.  A task not owning the FPU executed a floating
+ *   point instruction: save the FP registers of the owner, load those of
+ *   the task and return to the instruction.  Any other UsageFault is
+ *   fatal.
+ *
+ ****************************************************************************/
+
+int up_deferfpu_fault(int irq, FAR void *context)
+{
+  FAR struct tcb_s *tcb = (FAR struct tcb_s *)g_readytorun.head;
+  uint32_t cfsr = getreg32(NVIC_CFAULTS);
+
+  if ((cfsr & CFSR_NOCP) == 0)
+    {
+      (void)irqsave();
+      lldbg("PANIC!!! Usage fault received: %08x\n", cfsr);
+      PANIC();
+    }
+
+  putreg32(CFSR_NOCP, NVIC_CFAULTS);
+
+  if (g_fpu_owner == tcb)
+    {
+      up_fpu_access(true);
+    }
+  else
+    {
+      up_fpu_claim(tcb, tcb->xcp.regs);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: up_deferfpu_save
+ *
+ * Description:
+ *   Store the FP registers of the running task in the register save area
+ *   'regs', a copy of its context being taken.
+ *
+ ****************************************************************************/
+
+void up_deferfpu_save(FAR uint32_t *regs)
+{
+  FAR struct tcb_s *tcb = (FAR struct tcb_s *)g_readytorun.head;
+
+  if (g_fpu_owner == tcb)
+    {
+      up_fpu_access(true);
+      up_savefpu(regs);
+    }
+  else if (regs != tcb->xcp.regs)
+    {
+      memcpy(&regs[REG_S0], &tcb->xcp.regs[REG_S0],
+             4 * SW_FPU_REGS);
+    }
+}
+
+/****************************************************************************
+ * Name: up_deferfpu_restore
+ *
+ * Description:
+ *   Called when returning from an exception to the context 'regs' of the
+ *   new running task.  Normally 'regs' is its own register save area and
+ *   only the access to the FPU is changed, so that its first floating
+ *   point instruction traps if another task owns the FPU.  Otherwise the
+ *   context is a copy (e.g. the return from a signal handler) and its FP
+ *   registers are loaded now.
+ *
+ ****************************************************************************/
+
+void up_deferfpu_restore(FAR const uint32_t *regs)
+{
+  FAR struct tcb_s *tcb = (FAR struct tcb_s *)g_readytorun.head;
+
+  if (regs != tcb->xcp.regs)
+    {
+      up_fpu_claim(tcb, regs);
+    }
+  else
+    {
+      up_fpu_access(g_fpu_owner == tcb);
+    }
+}
+
+/****************************************************************************
+ * Name: up_deferfpu_release
+ *
+ * Description:
+ *   The task is being deleted, its FP registers need no saving.
+ *
+ ****************************************************************************/
+
+void up_deferfpu_release(FAR struct tcb_s *tcb)
+{
+  irqstate_t flags = irqsave();
+
+  if (g_fpu_owner == tcb)
+    {
+      g_fpu_owner = NULL;
+    }
+
+  irqrestore(flags);
+}
+
+#endif /* CONFIG_ARMV7M_DEFERFPU */
@@ -69,7 +69,7 @@
  * Public Functions
  ****************************************************************************/
 
-uint32_t *up_doirq(int irq, uint32_t *regs)
+__ramfunc_irq__ uint32_t *up_doirq(int irq, uint32_t *regs)
 {
   board_led_on(LED_INIRQ);
 #ifdef CONFIG_SUPPRESS_INTERRUPTS
@@ -0,0 +1,132 @@
+/****************************************************************************
+ * arch/arm/src/armv7-m/up_irqtrace.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <nuttx/irqtrace.h>
+
+#include "up_arch.h"
+#include "nvic.h"
+
+#ifdef CONFIG_IRQSAVE_TRACE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Data Watchpoint and Trace unit */
+
+#define DWT_CTRL                0xe0001000
+#define DWT_CYCCNT              0xe0001004
+
+#define DWT_CTRL_CYCCNTENA      (1 << 0)
+
+/* Exception number of the SysTick timer */
+
+#define ARMV7M_IRQ_SYSTICK      15
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_irqtrace_initialize
+ *
+ * Description:
+ *   Only differences of the counter are used, so it is not reset if it is
+ *   already running: the boot trace started it first and needs it to stay
+ *   monotonic.
+ *
+ ****************************************************************************/
+
+void up_irqtrace_initialize(void)
+{
+  if ((getreg32(DWT_CTRL) & DWT_CTRL_CYCCNTENA) != 0)
+    {
+      return;
+    }
+
+  modifyreg32(NVIC_DEMCR, 0, NVIC_DEMCR_TRCENA);
+  putreg32(0, DWT_CYCCNT);
+  modifyreg32(DWT_CTRL, 0, DWT_CTRL_CYCCNTENA);
+}
+
+/****************************************************************************
+ * Name: up_irqtrace_cycles
+ ****************************************************************************/
+
+uint32_t up_irqtrace_cycles(void)
+{
+  return getreg32(DWT_CYCCNT);
+}
+
+/****************************************************************************
+ * Name: up_irqtrace_latency
+ *
+ * Description:
+ *   Only the SysTick interrupt has a known raise time: the counter reloads
+ *   when it fires and keeps counting down, so the cycles elapsed since are
+ *   RELOAD - CURRENT (SysTick clocked from the core clock).  The control
+ *   register is deliberately not read, that would clear COUNTFLAG that the
+ *   timer code relies on.
+ *
+ ****************************************************************************/
+
+bool up_irqtrace_latency(int irq, FAR uint32_t *cycles)
+{
+  uint32_t reload;
+
+  if (irq != ARMV7M_IRQ_SYSTICK)
+    {
+      return false;
+    }
+
+  reload = getreg32(NVIC_SYSTICK_RELOAD);
+  if (reload == 0)
+    {
+      return false;
+    }
+
+  *cycles = reload - getreg32(NVIC_SYSTICK_CURRENT);
+  return true;
+}
+
+#endif /* CONFIG_IRQSAVE_TRACE */
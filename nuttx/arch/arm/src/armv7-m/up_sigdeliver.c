@@ -134,6 +134,9 @@ void up_sigdeliver(void)
   /* Save the real return state on the stack. */
 
   up_copyfullstate(regs, rtcb->xcp.regs);
+#ifdef CONFIG_ARMV7M_DEFERFPU
+  up_deferfpu_save(regs);
+#endif
   regs[REG_PC]         = rtcb->xcp.saved_pc;
 #ifdef CONFIG_ARMV7M_USEBASEPRI
   regs[REG_BASEPRI]    = rtcb->xcp.saved_basepri;
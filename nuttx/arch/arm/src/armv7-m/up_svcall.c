@@ -180,7 +180,7 @@ static void dispatch_syscall(void)
  *
  ****************************************************************************/
 
-int up_svcall(int irq, FAR void *context)
+__ramfunc_irq__ int up_svcall(int irq, FAR void *context)
 {
   uint32_t *regs = (uint32_t*)context;
   uint32_t cmd;
@@ -239,7 +239,9 @@ int up_svcall(int irq, FAR void *context)
         {
           DEBUGASSERT(regs[REG_R1] != 0);
           memcpy((uint32_t*)regs[REG_R1], regs, XCPTCONTEXT_SIZE);
-#if defined(CONFIG_ARCH_FPU) && !defined(CONFIG_ARMV7M_CMNVECTOR)
+#if defined(CONFIG_ARMV7M_DEFERFPU)
+          up_deferfpu_save((uint32_t*)regs[REG_R1]);
+#elif defined(CONFIG_ARCH_FPU) && !defined(CONFIG_ARMV7M_CMNVECTOR)
           up_savefpu((uint32_t*)regs[REG_R1]);
 #endif
         }
@@ -287,7 +289,8 @@ int up_svcall(int irq, FAR void *context)
         {
           DEBUGASSERT(regs[REG_R1] != 0 && regs[REG_R2] != 0);
           memcpy((uint32_t*)regs[REG_R1], regs, XCPTCONTEXT_SIZE);
-#if defined(CONFIG_ARCH_FPU) && !defined(CONFIG_ARMV7M_CMNVECTOR)
+#if defined(CONFIG_ARCH_FPU) && !defined(CONFIG_ARMV7M_CMNVECTOR) && \
+    !defined(CONFIG_ARMV7M_DEFERFPU)
           up_savefpu((uint32_t*)regs[REG_R1]);
 #endif
           current_regs = (uint32_t*)regs[REG_R2];
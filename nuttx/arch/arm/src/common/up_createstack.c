@@ -93,6 +93,46 @@
  * Private Function Prototypes
  ****************************************************************************/
 
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_adjstacksize
+ *
+ * Description:
+ *   Return the adjusted size of a stack of 'stack_size' bytes at 'base'.
+ *
+ ****************************************************************************/
+
+static inline size_t up_adjstacksize(FAR void *base, size_t stack_size)
+{
+  size_t top_of_stack;
+
+  /* The ARM uses a push-down stack:  the stack grows toward lower
+   * addresses in memory.  The stack pointer register, points to
+   * the lowest, valid work address (the "top" of the stack).  Items
+   * on the stack are referenced as positive word offsets from sp.
+   */
+
+  top_of_stack = (uint32_t)base + stack_size - 4;
+
+  /* The ARM stack must be aligned; 4 byte alignment for OABI and
+   * 8-byte alignment for EABI. If necessary top_of_stack must be
+   * rounded down to the next boundary
+   */
+
+  top_of_stack = STACK_ALIGN_DOWN(top_of_stack);
+
+  /* The size of the stack in bytes is then the difference between
+   * the top and the bottom of the stack (+4 because if the top
+   * is the same as the bottom, then the size is one 32-bit element).
+   * The size need not be aligned.
+   */
+
+  return top_of_stack - (uint32_t)base + 4;
+}
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -137,18 +177,34 @@
 
 int up_create_stack(FAR struct tcb_s *tcb, size_t stack_size, uint8_t ttype)
 {
-  /* Is there already a stack allocated of a different size?  Because of
-   * alignment issues, stack_size might erroneously appear to be of a
-   * different size.  Fortunately, this is not a critical operation.
+#if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_STACK)
+  size_t used = 0;
+#endif
+
+  /* Is there already a stack allocated of a different size?  Compare the
+   * adjusted size that the requested size would give at the same address.
    */
 
-  if (tcb->stack_alloc_ptr && tcb->adj_stack_size != stack_size)
+  if (tcb->stack_alloc_ptr &&
+      tcb->adj_stack_size != up_adjstacksize(tcb->stack_alloc_ptr,
+                                             stack_size))
     {
       /* Yes.. Release the old stack */
 
       up_release_stack(tcb, ttype);
     }
 
+#if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_STACK)
+  /* If the stack is reused (see CONFIG_SCHED_TCBCACHE), only the part that
+   * was used by its previous thread needs to be colored again.
+   */
+
+  else if (tcb->stack_alloc_ptr)
+    {
+      used = up_check_tcbstack(tcb);
+    }
+#endif
+
   /* Do we need to allocate a new stack? */
 
   if (!tcb->stack_alloc_ptr)
@@ -194,35 +250,14 @@ int up_create_stack(FAR struct tcb_s *tcb, size_t stack_size, uint8_t ttype)
 
   if (tcb->stack_alloc_ptr)
     {
-      size_t top_of_stack;
       size_t size_of_stack;
 
-      /* The ARM uses a push-down stack:  the stack grows toward lower
-       * addresses in memory.  The stack pointer register, points to
-       * the lowest, valid work address (the "top" of the stack).  Items
-       * on the stack are referenced as positive word offsets from sp.
-       */
-
-      top_of_stack = (uint32_t)tcb->stack_alloc_ptr + stack_size - 4;
-
-      /* The ARM stack must be aligned; 4 byte alignment for OABI and
-       * 8-byte alignment for EABI. If necessary top_of_stack must be
-       * rounded down to the next boundary
-       */
-
-      top_of_stack = STACK_ALIGN_DOWN(top_of_stack);
-
-      /* The size of the stack in bytes is then the difference between
-       * the top and the bottom of the stack (+4 because if the top
-       * is the same as the bottom, then the size is one 32-bit element).
-       * The size need not be aligned.
-       */
-
-      size_of_stack = top_of_stack - (uint32_t)tcb->stack_alloc_ptr + 4;
+      size_of_stack = up_adjstacksize(tcb->stack_alloc_ptr, stack_size);
 
       /* Save the adjusted stack values in the struct tcb_s */
 
-      tcb->adj_stack_ptr  = (uint32_t*)top_of_stack;
+      tcb->adj_stack_ptr  = (uint32_t*)((uint32_t)tcb->stack_alloc_ptr +
+                                        size_of_stack - 4);
       tcb->adj_stack_size = size_of_stack;
 
       /* If stack debug is enabled, then fill the stack with a
@@ -231,7 +266,15 @@ int up_create_stack(FAR struct tcb_s *tcb, size_t stack_size, uint8_t ttype)
        */
 
 #if defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_STACK)
-      up_stack_color(tcb->stack_alloc_ptr, tcb->adj_stack_size);
+      if (used > 0)
+        {
+          up_stack_color((FAR uint8_t *)tcb->stack_alloc_ptr +
+                         size_of_stack - used, used);
+        }
+      else
+        {
+          up_stack_color(tcb->stack_alloc_ptr, size_of_stack);
+        }
 #endif
 
       board_led_on(LED_STACKCREATED);
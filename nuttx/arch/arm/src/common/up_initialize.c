@@ -72,6 +72,7 @@
 #include <nuttx/fs/fs.h>
 #include <nuttx/syslog/ramlog.h>
 #include <nuttx/buf_con.h>
+#include <nuttx/crypto/crypto.h>
 
 #include <arch/board/board.h>
 
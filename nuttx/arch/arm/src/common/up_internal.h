@@ -301,6 +301,16 @@ extern uint32_t _eramfuncs;       /* Copy destination end address in RAM */
 #  define __ramfunc__
 
 #endif /* CONFIG_ARCH_RAMFUNCS */
+
+/* The interrupt dispatch and context switch logic is moved to RAM as a
+ * group when CONFIG_ARCH_RAMFUNC_IRQ is selected.
+ */
+
+#ifdef CONFIG_ARCH_RAMFUNC_IRQ
+#  define __ramfunc_irq__ __ramfunc__
+#else
+#  define __ramfunc_irq__
+#endif
 #endif /* __ASSEMBLY__ */
 
 /****************************************************************************
@@ -406,6 +416,9 @@ void up_doirq(int irq, uint32_t *regs);
 #ifdef CONFIG_PAGING
 void up_pginitialize(void);
 uint32_t *up_va2pte(uintptr_t vaddr);
+#ifdef CONFIG_PAGING_CLOCK
+void up_pgreference(uint32_t *pte);
+#endif
 void up_dataabort(uint32_t *regs, uint32_t far, uint32_t fsr);
 #else /* CONFIG_PAGING */
 # define up_pginitialize()
@@ -438,6 +451,16 @@ void up_restorefpu(const uint32_t *regs);
 #  define up_restorefpu(regs)
 #endif
 
+#ifdef CONFIG_ARMV7M_DEFERFPU
+struct tcb_s; /* Forward reference */
+
+void up_deferfpu_initialize(void);
+int  up_deferfpu_fault(int irq, FAR void *context);
+void up_deferfpu_save(FAR uint32_t *regs);
+void up_deferfpu_restore(FAR const uint32_t *regs);
+void up_deferfpu_release(FAR struct tcb_s *tcb);
+#endif
+
 /* System timer *************************************************************/
 
 void up_timer_initialize(void);
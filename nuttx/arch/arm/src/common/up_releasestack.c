@@ -103,6 +103,12 @@
 
 void up_release_stack(FAR struct tcb_s *dtcb, uint8_t ttype)
 {
+#ifdef CONFIG_ARMV7M_DEFERFPU
+  /* The FP registers of the task need no saving any more */
+
+  up_deferfpu_release(dtcb);
+#endif
+
   /* Is there a stack allocated? */
 
   if (dtcb->stack_alloc_ptr)
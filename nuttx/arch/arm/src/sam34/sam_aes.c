@@ -72,12 +72,23 @@
  * Private Function Prototypes
  ****************************************************************************/
 
+static int sam_aes_cypher(void *out, const void *in, uint32_t size,
+                          const void *iv, const void *key, uint32_t keysize,
+                          int mode, int encrypt);
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
 static sem_t lock;
 
+static struct crypto_backend_s g_sam_aes_backend =
+{
+  .name  = "sam-aes",
+  .flags = CRYPTO_FLAG_HARDWARE,
+  .aes   = sam_aes_cypher,
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -160,12 +171,9 @@ static int aes_setup_mr(uint32_t keysize, int mode, int encrypt)
   return OK;
 }
 
-/****************************************************************************
- * Public Functions
- ****************************************************************************/
-
-int aes_cypher(void *out, const void *in, uint32_t size, const void *iv,
-               const void *key, uint32_t keysize, int mode, int encrypt)
+static int sam_aes_cypher(void *out, const void *in, uint32_t size,
+                          const void *iv, const void *key, uint32_t keysize,
+                          int mode, int encrypt)
 {
   int res = OK;
 
@@ -199,10 +207,14 @@ int aes_cypher(void *out, const void *in, uint32_t size, const void *iv,
   return res;
 }
 
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
 int up_aesinitialize()
 {
   sem_init(&lock, 0, 1);
   sam_aes_enableclk();
   putreg32(AES_CR_SWRST, SAM_AES_CR);
-  return OK;
+  return crypto_register(&g_sam_aes_backend);
 }
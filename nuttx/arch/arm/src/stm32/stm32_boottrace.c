@@ -0,0 +1,95 @@
+/****************************************************************************
+ * arch/arm/src/stm32/stm32_boottrace.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#include <nuttx/bootphase.h>
+#include <arch/board/board.h>
+
+#include "up_arch.h"
+#include "nvic.h"
+
+#ifdef CONFIG_BOOT_TRACE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Data Watchpoint and Trace unit */
+
+#define DWT_CTRL                0xe0001000
+#define DWT_CYCCNT              0xe0001004
+
+#define DWT_CTRL_CYCCNTENA      (1 << 0)
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: up_boottrace_initialize
+ ****************************************************************************/
+
+void up_boottrace_initialize(void)
+{
+  modifyreg32(NVIC_DEMCR, 0, NVIC_DEMCR_TRCENA);
+  putreg32(0, DWT_CYCCNT);
+  modifyreg32(DWT_CTRL, 0, DWT_CTRL_CYCCNTENA);
+}
+
+/****************************************************************************
+ * Name: up_boottrace_cycles
+ ****************************************************************************/
+
+uint32_t up_boottrace_cycles(void)
+{
+  return getreg32(DWT_CYCCNT);
+}
+
+/****************************************************************************
+ * Name: up_boottrace_frequency
+ ****************************************************************************/
+
+uint32_t up_boottrace_frequency(void)
+{
+  return STM32_SYSCLK_FREQUENCY;
+}
+
+#endif /* CONFIG_BOOT_TRACE */
@@ -96,6 +96,13 @@
 #  undef CONFIG_CAN_REGDEBUG
 #endif
 
+/* Acceptance filters.  Each CAN owns CAN_NFILTERS/2 filter banks.  The first
+ * one is the "accept everything" filter set up by can_filterinit(); the
+ * others are available to CANIOCTL_ADD_FILTER.
+ */
+
+#define CAN_NUSERFILTERS (CAN_NFILTERS / 2 - 1)
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -109,6 +116,7 @@ struct stm32_can_s
   uint32_t base;   /* Base address of the CAN control registers */
   uint32_t fbase;  /* Base address of the CAN filter registers */
   uint32_t baud;   /* Configured baud */
+  uint32_t filtmap; /* Bitmap of the filters added by CANIOCTL_ADD_FILTER */
 };
 
 /****************************************************************************
@@ -154,6 +162,9 @@ static int  can_txinterrupt(int irq, void *context);
 static int  can_bittiming(struct stm32_can_s *priv);
 static int  can_cellinit(struct stm32_can_s *priv);
 static int  can_filterinit(struct stm32_can_s *priv);
+static int  can_addfilter(struct stm32_can_s *priv,
+                          FAR struct canioctl_filter_s *filter);
+static int  can_delfilter(struct stm32_can_s *priv, int index);
 
 /****************************************************************************
  * Private Data
@@ -758,9 +769,31 @@ static void can_txint(FAR struct can_dev_s *dev, bool enable)
 
 static int can_ioctl(FAR struct can_dev_s *dev, int cmd, unsigned long arg)
 {
-  /* No CAN ioctls are supported */
+  FAR struct stm32_can_s *priv = dev->cd_priv;
+  FAR struct canioctl_filter_s *filter =
+    (FAR struct canioctl_filter_s *)((uintptr_t)arg);
+
+  switch (cmd)
+    {
+      case CANIOCTL_ADD_FILTER:
+        if (filter == NULL)
+          {
+            return -EINVAL;
+          }
 
-  return -ENOTTY;
+        return can_addfilter(priv, filter);
+
+      case CANIOCTL_DEL_FILTER:
+        if (filter == NULL)
+          {
+            return -EINVAL;
+          }
+
+        return can_delfilter(priv, filter->cf_index);
+
+      default:
+        return -ENOTTY;
+    }
 }
 
 /****************************************************************************
@@ -1575,6 +1608,13 @@ static int can_filterinit(struct stm32_can_s *priv)
   regval |= bitmask;
   can_putfreg(priv, STM32_CAN_FA1R_OFFSET, regval);
 
+  /* Disable any filters left over from CANIOCTL_ADD_FILTER */
+
+  regval  = can_getfreg(priv, STM32_CAN_FA1R_OFFSET);
+  regval &= ~(priv->filtmap << (priv->filter + 1));
+  can_putfreg(priv, STM32_CAN_FA1R_OFFSET, regval);
+  priv->filtmap = 0;
+
   /* Exit filter initialization mode */
 
   regval  = can_getfreg(priv, STM32_CAN_FMR_OFFSET);
@@ -1583,6 +1623,191 @@ static int can_filterinit(struct stm32_can_s *priv)
   return OK;
 }
 
+/****************************************************************************
+ * Name: can_addfilter
+ *
+ * Description:
+ *   Program a 32-bit IdMask filter bank that passes the messages matching
+ *   the requested ID and mask to FIFO 0.  The "accept everything" filter is
+ *   disabled while at least one such filter is installed.
+ *
+ * Input Parameter:
+ *   priv - A pointer to the private data structure for this CAN block
+ *   filter - The ID and mask to match.  cf_index is set on return.
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int can_addfilter(struct stm32_can_s *priv,
+                         FAR struct canioctl_filter_s *filter)
+{
+  irqstate_t flags;
+  uint32_t regval;
+  uint32_t bitmask;
+  uint32_t fr1;
+  uint32_t fr2;
+  int index;
+
+  /* The filter bank has the same layout as the RX identifier register */
+
+  if (filter->cf_extid)
+    {
+#ifdef CONFIG_CAN_EXTID
+      if (filter->cf_id > CAN_MAX_EXTMSGID)
+        {
+          return -EINVAL;
+        }
+
+      fr1 = (filter->cf_id << CAN_RIR_EXID_SHIFT) | CAN_RIR_IDE;
+      fr2 = ((filter->cf_mask & CAN_MAX_EXTMSGID) << CAN_RIR_EXID_SHIFT) |
+            CAN_RIR_IDE;
+#else
+      return -EINVAL;
+#endif
+    }
+  else
+    {
+      if (filter->cf_id > CAN_MAX_MSGID)
+        {
+          return -EINVAL;
+        }
+
+      fr1 = filter->cf_id << CAN_RIR_STID_SHIFT;
+      fr2 = ((filter->cf_mask & CAN_MAX_MSGID) << CAN_RIR_STID_SHIFT) |
+            CAN_RIR_IDE;
+    }
+
+  flags = irqsave();
+
+  for (index = 0; index < CAN_NUSERFILTERS; index++)
+    {
+      if ((priv->filtmap & (1 << index)) == 0)
+        {
+          break;
+        }
+    }
+
+  if (index >= CAN_NUSERFILTERS)
+    {
+      irqrestore(flags);
+      return -ENOSPC;
+    }
+
+  canllvdbg("CAN%d filter %d: %08x/%08x\n", priv->port, index, fr1, fr2);
+
+  bitmask = ((uint32_t)1) << (priv->filter + 1 + index);
+
+  /* Enter filter initialization mode */
+
+  regval  = can_getfreg(priv, STM32_CAN_FMR_OFFSET);
+  regval |= CAN_FMR_FINIT;
+  can_putfreg(priv, STM32_CAN_FMR_OFFSET, regval);
+
+  /* 32-bit scale, Id/Mask mode, FIFO 0 */
+
+  regval  = can_getfreg(priv, STM32_CAN_FA1R_OFFSET);
+  regval &= ~bitmask;
+  can_putfreg(priv, STM32_CAN_FA1R_OFFSET, regval);
+
+  regval  = can_getfreg(priv, STM32_CAN_FS1R_OFFSET);
+  regval |= bitmask;
+  can_putfreg(priv, STM32_CAN_FS1R_OFFSET, regval);
+
+  regval  = can_getfreg(priv, STM32_CAN_FM1R_OFFSET);
+  regval &= ~bitmask;
+  can_putfreg(priv, STM32_CAN_FM1R_OFFSET, regval);
+
+  regval  = can_getfreg(priv, STM32_CAN_FFA1R_OFFSET);
+  regval &= ~bitmask;
+  can_putfreg(priv, STM32_CAN_FFA1R_OFFSET, regval);
+
+  can_putfreg(priv, STM32_CAN_FR_OFFSET(priv->filter + 1 + index, 1), fr1);
+  can_putfreg(priv, STM32_CAN_FR_OFFSET(priv->filter + 1 + index, 2), fr2);
+
+  /* Enable the new filter and, for the first one, stop accepting
+   * everything.
+   */
+
+  regval  = can_getfreg(priv, STM32_CAN_FA1R_OFFSET);
+  regval |= bitmask;
+  if (priv->filtmap == 0)
+    {
+      regval &= ~(((uint32_t)1) << priv->filter);
+    }
+
+  can_putfreg(priv, STM32_CAN_FA1R_OFFSET, regval);
+
+  /* Exit filter initialization mode */
+
+  regval  = can_getfreg(priv, STM32_CAN_FMR_OFFSET);
+  regval &= ~CAN_FMR_FINIT;
+  can_putfreg(priv, STM32_CAN_FMR_OFFSET, regval);
+
+  priv->filtmap |= (1 << index);
+  irqrestore(flags);
+
+  filter->cf_index = index;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: can_delfilter
+ *
+ * Description:
+ *   Disable a filter installed by can_addfilter().  Removing the last one
+ *   re-enables the "accept everything" filter.
+ *
+ * Input Parameter:
+ *   priv - A pointer to the private data structure for this CAN block
+ *   index - The filter index returned by can_addfilter()
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+static int can_delfilter(struct stm32_can_s *priv, int index)
+{
+  irqstate_t flags;
+  uint32_t regval;
+
+  if (index < 0 || index >= CAN_NUSERFILTERS)
+    {
+      return -EINVAL;
+    }
+
+  flags = irqsave();
+  if ((priv->filtmap & (1 << index)) == 0)
+    {
+      irqrestore(flags);
+      return -ENOENT;
+    }
+
+  priv->filtmap &= ~(1 << index);
+
+  regval  = can_getfreg(priv, STM32_CAN_FMR_OFFSET);
+  regval |= CAN_FMR_FINIT;
+  can_putfreg(priv, STM32_CAN_FMR_OFFSET, regval);
+
+  regval  = can_getfreg(priv, STM32_CAN_FA1R_OFFSET);
+  regval &= ~(((uint32_t)1) << (priv->filter + 1 + index));
+  if (priv->filtmap == 0)
+    {
+      regval |= ((uint32_t)1) << priv->filter;
+    }
+
+  can_putfreg(priv, STM32_CAN_FA1R_OFFSET, regval);
+
+  regval  = can_getfreg(priv, STM32_CAN_FMR_OFFSET);
+  regval &= ~CAN_FMR_FINIT;
+  can_putfreg(priv, STM32_CAN_FMR_OFFSET, regval);
+
+  irqrestore(flags);
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -42,6 +42,7 @@
 #include <debug.h>
 
 #include <nuttx/arch.h>
+#include <nuttx/idle.h>
 #include <nuttx/power/pm.h>
 
 #include <arch/irq.h>
@@ -66,10 +67,46 @@
 #  define END_IDLE()
 #endif
 
+/* Sleep states known to the IDLE governor, shallowest first.  The latencies
+ * (in microseconds) are only the starting point; the governor learns the
+ * real values from the timer wakeups.  STOP can only be left through the
+ * tickless timer or an EXTI wakeup source and restarts the core on the MSI
+ * clock, hence its large residency.
+ */
+
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+#  define IDLE_STATE_WFI         0
+#  define IDLE_STATE_STOP        1
+
+#  define IDLE_WFI_LATENCY       2
+#  define IDLE_STOP_LATENCY      20
+#  define IDLE_STOP_RESIDENCY    2000
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+static struct idle_state_s g_idle_states[] =
+{
+  { "wfi",  IDLE_WFI_LATENCY,  0                   },
+#ifdef CONFIG_PM
+  { "stop", IDLE_STOP_LATENCY, IDLE_STOP_RESIDENCY },
+#endif
+};
+
+static struct idle_governor_s g_idle_gov =
+{
+  g_idle_states,
+  sizeof(g_idle_states) / sizeof(g_idle_states[0])
+};
+
+/* The deepest state that the current PM state allows */
+
+static int g_idle_maxstate = IDLE_STATE_WFI;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -125,13 +162,20 @@ static void up_idlepm(void)
       switch (newstate)
         {
         case PM_NORMAL:
-          break;
-
         case PM_IDLE:
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+          g_idle_maxstate = IDLE_STATE_WFI;
+#endif
           break;
 
         case PM_STANDBY:
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+          /* Let the governor decide on each pass whether STOP fits */
+
+          g_idle_maxstate = IDLE_STATE_STOP;
+#else
           stm32_pmstop(true);
+#endif
           break;
 
         case PM_SLEEP:
@@ -149,6 +193,45 @@ static void up_idlepm(void)
 #  define up_idlepm()
 #endif
 
+/****************************************************************************
+ * Name: up_idlesleep
+ *
+ * Description:
+ *   Enter the deepest sleep state that ends before the next timer expiry.
+ *   Interrupts stay disabled across the sleep so that the wakeup can be
+ *   timed before the interrupt handler runs; a pending interrupt still
+ *   ends WFI.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+static void up_idlesleep(void)
+{
+  irqstate_t flags;
+
+  flags = irqsave();
+  BEGIN_IDLE();
+
+  switch (idle_select(&g_idle_gov, g_idle_maxstate))
+    {
+#ifdef CONFIG_PM
+    case IDLE_STATE_STOP:
+      (void)stm32_pmstop(true);
+      break;
+#endif
+
+    case IDLE_STATE_WFI:
+    default:
+      asm("WFI");
+      break;
+    }
+
+  idle_reflect(&g_idle_gov);
+  END_IDLE();
+  irqrestore(flags);
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -204,11 +287,15 @@ void up_idle(void)
 
 #if !defined(CONFIG_STM32_CONNECTIVITYLINE) || !defined(CONFIG_STM32_ETHMAC)
 #if !(defined(CONFIG_DEBUG_SYMBOLS) && defined(CONFIG_STM32_DISABLE_IDLE_SLEEP_DURING_DEBUG))
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+  up_idlesleep();
+#else
   BEGIN_IDLE();
   asm("WFI");
   END_IDLE();
 #endif
 #endif
 #endif
+#endif
 }
 
@@ -162,6 +162,7 @@ static int stm32_busfault(int irq, FAR void *context)
   return 0;
 }
 
+#ifndef CONFIG_ARMV7M_DEFERFPU
 static int stm32_usagefault(int irq, FAR void *context)
 {
   (void)irqsave();
@@ -169,6 +170,7 @@ static int stm32_usagefault(int irq, FAR void *context)
   PANIC();
   return 0;
 }
+#endif
 
 static int stm32_pendsv(int irq, FAR void *context)
 {
@@ -388,6 +390,16 @@ void up_irqinitialize(void)
   up_enable_irq(STM32_IRQ_MEMFAULT);
 #endif
 
+  /* If the FPU context switch is deferred, the UsageFault hands the FPU
+   * over to the task using it.
+   */
+
+#ifdef CONFIG_ARMV7M_DEFERFPU
+  up_deferfpu_initialize();
+  irq_attach(STM32_IRQ_USAGEFAULT, up_deferfpu_fault);
+  up_enable_irq(STM32_IRQ_USAGEFAULT);
+#endif
+
   /* Attach all other processor exceptions (except reset and sys tick) */
 
 #ifdef CONFIG_DEBUG
@@ -396,7 +408,9 @@ void up_irqinitialize(void)
   irq_attach(STM32_IRQ_MEMFAULT, up_memfault);
 #endif
   irq_attach(STM32_IRQ_BUSFAULT, stm32_busfault);
+#ifndef CONFIG_ARMV7M_DEFERFPU
   irq_attach(STM32_IRQ_USAGEFAULT, stm32_usagefault);
+#endif
   irq_attach(STM32_IRQ_PENDSV, stm32_pendsv);
   irq_attach(STM32_IRQ_DBGMONITOR, stm32_dbgmonitor);
   irq_attach(STM32_IRQ_RESERVED, stm32_reserved);
@@ -91,7 +91,8 @@
  *    words.  Default 96 (384 bytes)
  *  CONFIG_STM32_OTGFS_DESCSIZE - Maximum size of a descriptor.  Default: 128
  *  CONFIG_STM32_OTGFS_SOFINTR - Enable SOF interrupts.  Why would you ever
- *    want to do that?
+ *    want to do that?  (With CONFIG_USBHOST_ASYNCH, SOF interrupts are
+ *    enabled on demand while NAKed asynchronous transfers await a retry).
  *  CONFIG_STM32_USBHOST_REGDEBUG - Enable very low-level register access
  *    debug.  Depends on CONFIG_DEBUG.
  *  CONFIG_STM32_USBHOST_PKTDUMP - Dump all incoming and outgoing USB
@@ -164,6 +165,12 @@
 #  define  MAX(a, b) (((a) > (b)) ? (a) : (b))
 #endif
 
+/* SOF interrupts are also used to schedule asynchronous transfer retries ******/
+
+#if defined(CONFIG_STM32_OTGFS_SOFINTR) || defined(CONFIG_USBHOST_ASYNCH)
+#  define HAVE_SOFISR 1
+#endif
+
 /* For OTGFS2 mode (FS mode of HS module), remap the IRQ number *****************/
 
 #ifdef CONFIG_STM32_OTGFS2
@@ -199,7 +206,8 @@ enum stm32_chreason_e
   CHREASON_STALL,        /* Endpoint stalled */
   CHREASON_TXERR,        /* Transfer error received */
   CHREASON_DTERR,        /* Data toggle error received */
-  CHREASON_FRMOR         /* Frame overrun */
+  CHREASON_FRMOR,        /* Frame overrun */
+  CHREASON_CANCELLED     /* Transfer cancelled */
 };
 
 /* This structure retains the state of one host channel.  NOTE: Since there
@@ -226,6 +234,17 @@ struct stm32_chan_s
   volatile uint16_t buflen;    /* Buffer length (remaining) */
   volatile uint16_t inflight;  /* Number of Tx bytes "in-flight" */
   FAR uint8_t      *buffer;    /* Transfer buffer pointer */
+#ifdef CONFIG_USBHOST_ASYNCH
+  usbhost_asynch_t  callback;  /* Transfer complete callback */
+  FAR void         *arg;       /* Argument that accompanies the callback */
+  FAR uint8_t      *reqbuf;    /* Start of the asynchronous request buffer */
+  uint16_t          reqlen;    /* Length of the asynchronous request */
+  uint16_t          xfrd;      /* Number of bytes transferred so far */
+  uint16_t          xfrlen;    /* Length of the transfer currently started */
+  uint16_t          nextframe; /* Frame in which a NAKed transfer is retried */
+  uint8_t           interval;  /* Polling interval in frames */
+  volatile bool     retry;     /* True: Retry is scheduled on SOF */
+#endif
 };
 
 /* This structure retains the state of the USB host controller */
@@ -314,7 +333,7 @@ static void stm32_chan_wakeup(FAR struct stm32_usbhost_s *priv,
 /* Control/data transfer logic *************************************************/
 
 static void stm32_transfer_start(FAR struct stm32_usbhost_s *priv, int chidx);
-#if 0 /* Not used */
+#ifdef CONFIG_USBHOST_ASYNCH
 static inline uint16_t stm32_getframe(void);
 #endif
 static int stm32_ctrl_sendsetup(FAR struct stm32_usbhost_s *priv,
@@ -327,6 +346,12 @@ static int stm32_in_transfer(FAR struct stm32_usbhost_s *priv, int chidx,
                              FAR uint8_t *buffer, size_t buflen);
 static int stm32_out_transfer(FAR struct stm32_usbhost_s *priv, int chidx,
                               FAR uint8_t *buffer, size_t buflen);
+#ifdef CONFIG_USBHOST_ASYNCH
+static void stm32_asynch_start(FAR struct stm32_usbhost_s *priv, int chidx);
+static void stm32_asynch_completion(FAR struct stm32_usbhost_s *priv,
+                                    FAR struct stm32_chan_s *chan);
+static void stm32_asynch_sof(FAR struct stm32_usbhost_s *priv);
+#endif
 
 /* Interrupt handling **********************************************************/
 /* Lower level interrupt handlers */
@@ -342,7 +367,7 @@ static void stm32_gint_disconnected(FAR struct stm32_usbhost_s *priv);
 
 /* Second level interrupt handlers */
 
-#ifdef CONFIG_STM32_OTGFS_SOFINTR
+#ifdef HAVE_SOFISR
 static inline void stm32_gint_sofisr(FAR struct stm32_usbhost_s *priv);
 #endif
 static inline void stm32_gint_rxflvlisr(FAR struct stm32_usbhost_s *priv);
@@ -392,6 +417,12 @@ static int stm32_ctrlout(FAR struct usbhost_driver_s *drvr,
                          FAR const uint8_t *buffer);
 static int stm32_transfer(FAR struct usbhost_driver_s *drvr, usbhost_ep_t ep,
                           FAR uint8_t *buffer, size_t buflen);
+#ifdef CONFIG_USBHOST_ASYNCH
+static int stm32_asynch(FAR struct usbhost_driver_s *drvr, usbhost_ep_t ep,
+                        FAR uint8_t *buffer, size_t buflen,
+                        usbhost_asynch_t callback, FAR void *arg);
+static int stm32_cancel(FAR struct usbhost_driver_s *drvr, usbhost_ep_t ep);
+#endif
 static void stm32_disconnect(FAR struct usbhost_driver_s *drvr);
 
 /* Initialization **************************************************************/
@@ -429,6 +460,10 @@ static struct stm32_usbhost_s g_usbhost =
       .ctrlin       = stm32_ctrlin,
       .ctrlout      = stm32_ctrlout,
       .transfer     = stm32_transfer,
+#ifdef CONFIG_USBHOST_ASYNCH
+      .asynch       = stm32_asynch,
+      .cancel       = stm32_cancel,
+#endif
       .disconnect   = stm32_disconnect,
     },
   .class            = NULL,
@@ -669,6 +704,19 @@ static void stm32_chan_free(FAR struct stm32_usbhost_s *priv, int chidx)
 
   stm32_chan_halt(priv, chidx, CHREASON_FREED);
 
+#ifdef CONFIG_USBHOST_ASYNCH
+  /* Terminate any pending asynchronous transfer */
+
+  priv->chan[chidx].retry = false;
+  if (priv->chan[chidx].callback)
+    {
+      usbhost_asynch_t callback = priv->chan[chidx].callback;
+
+      priv->chan[chidx].callback = NULL;
+      callback(priv->chan[chidx].arg, -ESHUTDOWN);
+    }
+#endif
+
   /* Mark the channel available */
 
   priv->chan[chidx].inuse = false;
@@ -1057,6 +1105,15 @@ static void stm32_chan_wakeup(FAR struct stm32_usbhost_s *priv,
       stm32_givesem(&chan->waitsem);
       chan->waiter = false;
     }
+
+#ifdef CONFIG_USBHOST_ASYNCH
+  /* Or is there an asynchronous transfer waiting for completion? */
+
+  else if (chan->result != EBUSY && chan->callback)
+    {
+      stm32_asynch_completion(priv, chan);
+    }
+#endif
 }
 
 /*******************************************************************************
@@ -1258,7 +1315,7 @@ static void stm32_transfer_start(FAR struct stm32_usbhost_s *priv, int chidx)
  *
  *******************************************************************************/
 
-#if 0 /* Not used */
+#ifdef CONFIG_USBHOST_ASYNCH
 static inline uint16_t stm32_getframe(void)
 {
   return (uint16_t)(stm32_getreg(STM32_OTGFS_HFNUM) & OTGFS_HFNUM_FRNUM_MASK);
@@ -1691,6 +1748,164 @@ static int stm32_out_transfer(FAR struct stm32_usbhost_s *priv, int chidx,
   return ret;
 }
 
+/*******************************************************************************
+ * Name: stm32_asynch_start
+ *
+ * Description:
+ *   Start (or restart) the next part of an asynchronous transfer.  IN
+ *   transfers are started as a whole; OUT transfers are sent one packet at a
+ *   time as in stm32_out_transfer().
+ *
+ *******************************************************************************/
+
+#ifdef CONFIG_USBHOST_ASYNCH
+static void stm32_asynch_start(FAR struct stm32_usbhost_s *priv, int chidx)
+{
+  FAR struct stm32_chan_s *chan = &priv->chan[chidx];
+  uint16_t remaining = chan->reqlen - chan->xfrd;
+
+  chan->buffer = chan->reqbuf + chan->xfrd;
+  chan->buflen = chan->in ? remaining : MIN(chan->maxpacket, remaining);
+  chan->xfrlen = chan->buflen;
+
+  if (chan->eptype == OTGFS_EPTYPE_ISOC)
+    {
+      chan->pid = OTGFS_PID_DATA0;
+    }
+  else if (chan->in)
+    {
+      chan->pid = chan->indata1 ? OTGFS_PID_DATA1 : OTGFS_PID_DATA0;
+    }
+  else
+    {
+      chan->pid = chan->outdata1 ? OTGFS_PID_DATA1 : OTGFS_PID_DATA0;
+    }
+
+  stm32_transfer_start(priv, chidx);
+}
+
+/*******************************************************************************
+ * Name: stm32_asynch_completion
+ *
+ * Description:
+ *   One part of an asynchronous transfer has finished.  Continue the transfer,
+ *   schedule a retry if the device NAKed it, or report the result.
+ *
+ * Assumptions:
+ *   Called from the channel interrupt handler with interrupts disabled.
+ *
+ *******************************************************************************/
+
+static void stm32_asynch_completion(FAR struct stm32_usbhost_s *priv,
+                                    FAR struct stm32_chan_s *chan)
+{
+  usbhost_asynch_t callback;
+  ssize_t nbytes;
+  int chidx = chan - priv->chan;
+
+  if (chan->result == OK)
+    {
+      if (chan->in)
+        {
+          /* A short packet or a full buffer ends an IN transfer */
+
+          chan->xfrd += chan->xfrlen - chan->buflen;
+        }
+      else
+        {
+          chan->xfrd += chan->xfrlen;
+          if (chan->eptype == OTGFS_EPTYPE_INTR)
+            {
+              /* Toggle the OUT data PID for the next transfer */
+
+              chan->outdata1 ^= true;
+            }
+
+          if (chan->xfrd < chan->reqlen)
+            {
+              /* Send the next packet */
+
+              stm32_asynch_start(priv, chidx);
+              return;
+            }
+        }
+
+      nbytes = chan->xfrd;
+    }
+  else if (chan->result == EAGAIN)
+    {
+      /* The device NAKed the transfer.  Retry it at the polling interval of
+       * the endpoint (or in the next frame for non-periodic endpoints) rather
+       * than spinning on the NAK here.
+       */
+
+      chan->nextframe = (stm32_getframe() + chan->interval) &
+                        OTGFS_HFNUM_FRNUM_MASK;
+      chan->retry     = true;
+      stm32_modifyreg(STM32_OTGFS_GINTMSK, 0, OTGFS_GINT_SOF);
+      return;
+    }
+  else
+    {
+      nbytes = -(ssize_t)chan->result;
+    }
+
+  callback       = chan->callback;
+  chan->callback = NULL;
+  callback(chan->arg, nbytes);
+}
+
+/*******************************************************************************
+ * Name: stm32_asynch_sof
+ *
+ * Description:
+ *   Restart the NAKed asynchronous transfers that are due in this frame.  The
+ *   SOF interrupt is disabled again when no retries remain.
+ *
+ * Assumptions:
+ *   Called from the SOF interrupt handler with interrupts disabled.
+ *
+ *******************************************************************************/
+
+static void stm32_asynch_sof(FAR struct stm32_usbhost_s *priv)
+{
+  FAR struct stm32_chan_s *chan;
+  uint16_t frame = stm32_getframe();
+  uint16_t elapsed;
+  bool pending = false;
+  int chidx;
+
+  for (chidx = 0; chidx < STM32_NHOST_CHANNELS; chidx++)
+    {
+      chan = &priv->chan[chidx];
+      if (chan->retry)
+        {
+          /* The frame number is a 14-bit counter; treat a difference in the
+           * lower half of its range as "due".
+           */
+
+          elapsed = (frame - chan->nextframe) & OTGFS_HFNUM_FRNUM_MASK;
+          if (elapsed < (OTGFS_HFNUM_FRNUM_MASK >> 1))
+            {
+              chan->retry = false;
+              stm32_asynch_start(priv, chidx);
+            }
+          else
+            {
+              pending = true;
+            }
+        }
+    }
+
+#ifndef CONFIG_STM32_OTGFS_SOFINTR
+  if (!pending)
+    {
+      stm32_modifyreg(STM32_OTGFS_GINTMSK, OTGFS_GINT_SOF, 0);
+    }
+#endif
+}
+#endif
+
 /*******************************************************************************
  * Name: stm32_gint_wrpacket
  *
@@ -2301,11 +2516,16 @@ static void stm32_gint_disconnected(FAR struct stm32_usbhost_s *priv)
  *
  *******************************************************************************/
 
-#ifdef CONFIG_STM32_OTGFS_SOFINTR
+#ifdef HAVE_SOFISR
 static inline void stm32_gint_sofisr(FAR struct stm32_usbhost_s *priv)
 {
   /* Handle SOF interrupt */
+
+#ifdef CONFIG_USBHOST_ASYNCH
+  stm32_asynch_sof(priv);
+#else
 #warning "Do what?"
+#endif
 
   /* Clear pending SOF interrupt */
 
@@ -2866,7 +3086,7 @@ static int stm32_gint_isr(int irq, FAR void *context)
 
       /* Handle the start of frame interrupt */
 
-#ifdef CONFIG_STM32_OTGFS_SOFINTR
+#ifdef HAVE_SOFISR
       if ((pending & OTGFS_GINT_SOF) != 0)
         {
           usbhost_vtrace1(OTGFS_VTRACE1_GINT_SOF, 0);
@@ -3420,6 +3640,26 @@ static int stm32_epalloc(FAR struct usbhost_driver_s *drvr,
   chan->indata1   = false;
   chan->outdata1  = false;
 
+#ifdef CONFIG_USBHOST_ASYNCH
+  /* Full speed interrupt endpoints give the polling interval in frames;
+   * isochronous endpoints give it as an exponent.  NAKed non-periodic
+   * transfers are retried in the next frame.
+   */
+
+  if (chan->eptype == OTGFS_EPTYPE_ISOC && epdesc->interval > 0)
+    {
+      chan->interval = 1 << MIN(epdesc->interval - 1, 7);
+    }
+  else if (chan->eptype == OTGFS_EPTYPE_INTR && epdesc->interval > 0)
+    {
+      chan->interval = epdesc->interval;
+    }
+  else
+    {
+      chan->interval = 1;
+    }
+#endif
+
   /* Then configure the endpoint */
 
   stm32_chan_configure(priv, chidx);
@@ -3899,6 +4139,16 @@ static int stm32_transfer(FAR struct usbhost_driver_s *drvr, usbhost_ep_t ep,
 
   stm32_takesem(&priv->exclsem);
 
+#ifdef CONFIG_USBHOST_ASYNCH
+  /* The channel may not be used while an asynchronous transfer is pending */
+
+  if (priv->chan[chidx].callback)
+    {
+      stm32_givesem(&priv->exclsem);
+      return -EBUSY;
+    }
+#endif
+
   /* Handle IN and OUT transfer slightly differently */
 
   if (priv->chan[chidx].in)
@@ -3914,6 +4164,129 @@ static int stm32_transfer(FAR struct usbhost_driver_s *drvr, usbhost_ep_t ep,
   return ret;
 }
 
+/*******************************************************************************
+ * Name: stm32_asynch
+ *
+ * Description:
+ *   Process a request to handle a transfer descriptor.  This method will
+ *   enqueue the transfer request and return immediately.  When the transfer
+ *   completes, the callback will be invoked with the provided argument.  Only
+ *   one transfer may be queued on an endpoint at a time.
+ *
+ * Input Parameters:
+ *   drvr - The USB host driver instance obtained as a parameter from the call to
+ *      the class create() method.
+ *   ep - The IN or OUT endpoint descriptor for the device endpoint on which to
+ *      perform the transfer.
+ *   buffer - A buffer containing the data to be sent (OUT endpoint) or received
+ *     (IN endpoint).  buffer must have been allocated using DRVR_ALLOC
+ *   buflen - The length of the data to be sent or received.
+ *   callback - This function will be called when the transfer completes.
+ *   arg - The arbitrary parameter that will be passed to the callback function
+ *     when the transfer completes.
+ *
+ * Returned Values:
+ *   On success, zero (OK) is returned. On a failure, a negated errno value is
+ *   returned indicating the nature of the failure
+ *
+ * Assumptions:
+ *   - Never called from an interrupt handler.
+ *
+ *******************************************************************************/
+
+#ifdef CONFIG_USBHOST_ASYNCH
+static int stm32_asynch(FAR struct usbhost_driver_s *drvr, usbhost_ep_t ep,
+                        FAR uint8_t *buffer, size_t buflen,
+                        usbhost_asynch_t callback, FAR void *arg)
+{
+  FAR struct stm32_usbhost_s *priv  = (FAR struct stm32_usbhost_s *)drvr;
+  unsigned int chidx = (unsigned int)ep;
+  FAR struct stm32_chan_s *chan;
+  irqstate_t flags;
+  int ret = OK;
+
+  uvdbg("chidx: %d buflen: %d\n",  (unsigned int)ep, buflen);
+
+  DEBUGASSERT(priv && buffer && chidx < STM32_MAX_TX_FIFOS && buflen > 0 &&
+              callback);
+
+  chan = &priv->chan[chidx];
+  if (chan->eptype == OTGFS_EPTYPE_CTRL)
+    {
+      return -ENOSYS;
+    }
+
+  /* We must have exclusive access to the USB host hardware and state structures */
+
+  stm32_takesem(&priv->exclsem);
+
+  flags = irqsave();
+  if (!priv->connected)
+    {
+      ret = -ENODEV;
+    }
+  else if (chan->callback)
+    {
+      ret = -EBUSY;
+    }
+  else
+    {
+      chan->callback = callback;
+      chan->arg      = arg;
+      chan->reqbuf   = buffer;
+      chan->reqlen   = MIN(buflen, UINT16_MAX);
+      chan->xfrd     = 0;
+      chan->retry    = false;
+
+      stm32_asynch_start(priv, chidx);
+    }
+
+  irqrestore(flags);
+  stm32_givesem(&priv->exclsem);
+  return ret;
+}
+
+/*******************************************************************************
+ * Name: stm32_cancel
+ *
+ * Description:
+ *   Cancel a pending asynchronous transfer on an endpoint.  The callback is
+ *   invoked with -ESHUTDOWN.
+ *
+ *******************************************************************************/
+
+static int stm32_cancel(FAR struct usbhost_driver_s *drvr, usbhost_ep_t ep)
+{
+  FAR struct stm32_usbhost_s *priv  = (FAR struct stm32_usbhost_s *)drvr;
+  unsigned int chidx = (unsigned int)ep;
+  FAR struct stm32_chan_s *chan;
+  usbhost_asynch_t callback;
+  irqstate_t flags;
+
+  DEBUGASSERT(priv && chidx < STM32_MAX_TX_FIFOS);
+
+  chan  = &priv->chan[chidx];
+  flags = irqsave();
+
+  callback = chan->callback;
+  if (callback)
+    {
+      chan->callback = NULL;
+      chan->retry    = false;
+      stm32_chan_halt(priv, chidx, CHREASON_CANCELLED);
+    }
+
+  irqrestore(flags);
+
+  if (callback)
+    {
+      callback(chan->arg, -ESHUTDOWN);
+    }
+
+  return OK;
+}
+#endif
+
 /*******************************************************************************
  * Name: stm32_disconnect
  *
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Sampling timer of the PC-sampling profiler (see sched/sched/sched_profile.c)
+ */
+
+#include <nuttx/config.h>
+#include <nuttx/arch.h>
+#include <nuttx/profile.h>
+
+#include <arch/irq.h>
+
+#include <errno.h>
+#include <stdint.h>
+
+#include "stm32_tim.h"
+
+#define PROFILE_TIMER_CLOCK     1000000
+
+static struct stm32_tim_dev_s *profile_timer;
+static int profile_timer_irq = -1;
+
+/*
+ * The exception frame of the interrupted code is the context given to the
+ * handler by up_doirq(): take the PC and LR that the CPU stacked there.
+ */
+static int profile_isr_handler(int irq, void *context)
+{
+    uint32_t *regs = context;
+
+    STM32_TIM_ACKINT(profile_timer, profile_timer_irq);
+    profile_sample((void *) regs[REG_PC], (void *) regs[REG_LR]);
+
+    return OK;
+}
+
+int up_profile_start(unsigned int rate)
+{
+    if (rate == 0 || rate > PROFILE_TIMER_CLOCK)
+        return -EINVAL;
+
+    profile_timer = stm32_tim_init(CONFIG_STM32_PROFILE_TIMER);
+    if (!profile_timer)
+        return -ENODEV;
+
+    STM32_TIM_DISABLEINT(profile_timer, 0);
+    STM32_TIM_SETMODE(profile_timer, STM32_TIM_MODE_UP);
+    STM32_TIM_SETCLOCK(profile_timer, PROFILE_TIMER_CLOCK);
+    STM32_TIM_SETPERIOD(profile_timer, PROFILE_TIMER_CLOCK / rate);
+    profile_timer_irq = STM32_TIM_SETISR(profile_timer, profile_isr_handler, 0);
+    STM32_TIM_ACKINT(profile_timer, profile_timer_irq);
+    STM32_TIM_ENABLEINT(profile_timer, 0);
+
+    return OK;
+}
+
+void up_profile_stop(void)
+{
+    if (!profile_timer)
+        return;
+
+    STM32_TIM_DISABLEINT(profile_timer, 0);
+    STM32_TIM_SETISR(profile_timer, NULL, 0);
+    stm32_tim_deinit(profile_timer);
+    profile_timer = NULL;
+    profile_timer_irq = -1;
+}
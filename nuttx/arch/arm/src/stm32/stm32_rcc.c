@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <assert.h>
 #include <debug.h>
@@ -263,6 +263,23 @@ void stm32_board_clockconfig(void);
 void stm32_clockenable(void);
 #endif
 
+/************************************************************************************
+ * Name: stm32_clocksave and stm32_clockrestore
+ *
+ * Description:
+ *   Fast clock restore after STOP mode.  stm32_clocksave() is called before
+ *   entering STOP and caches the running clock configuration;
+ *   stm32_clockrestore() is called after the wake-up instead of
+ *   stm32_clockenable() and only restarts what was running, without
+ *   reprogramming the registers that STOP mode preserves.
+ *
+ ************************************************************************************/
+
+#if defined(CONFIG_PM) && defined(CONFIG_STM32_STM32L4X6)
+void stm32_clocksave(void);
+void stm32_clockrestore(void);
+#endif
+
 /************************************************************************************
  * Name: stm32_rcc_enablelse
  *
@@ -303,7 +303,7 @@ struct up_dev_s
 #ifdef SERIAL_HAVE_DMA
   DMA_HANDLE        rxdma;     /* currently-open receive DMA stream */
   bool              rxenable;  /* DMA-based reception en/disable */
-  uint32_t          rxdmanext; /* Next byte in the DMA buffer to be read */
+  size_t            rxdmanext; /* Next byte in the DMA buffer to be read */
   char       *const rxfifo;    /* Receive DMA buffer */
 #endif
 
@@ -2476,7 +2476,18 @@ static void up_dma_rxcallback(DMA_HANDLE handle, uint8_t status, void *arg)
 
   if (priv->rxenable && up_dma_rxavailable(&priv->dev))
     {
+#ifndef CONFIG_SERIAL_IFLOWCONTROL
+      /* Copy everything the DMA has written since the last callback into the
+       * receive buffer as a block.
+       */
+
+      uart_recvchars_dma(&priv->dev, priv->rxfifo, RXDMA_BUFFER_SIZE,
+                         &priv->rxdmanext, up_dma_nextrx(priv));
+#else
+      /* Leave the data in the DMA buffer when RX flow control is asserted */
+
       uart_recvchars(&priv->dev);
+#endif
     }
 }
 #endif
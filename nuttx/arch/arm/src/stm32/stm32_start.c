@@ -236,6 +236,19 @@ void __start(void)
   const uint32_t *src;
   uint32_t *dest;
 
+#ifdef CONFIG_ARCH_RAMFUNCS
+  /* Copy the RAM functions from FLASH to SRAM first: they may include the
+   * exception handlers (CONFIG_ARCH_RAMFUNC_IRQ) or memcpy().  The
+   * destination in SRAM is given by _sramfuncs and _eramfuncs, the code is
+   * stored in FLASH at _framfuncs.
+   */
+
+  for (src = &_framfuncs, dest = &_sramfuncs; dest < &_eramfuncs; )
+    {
+      *dest++ = *src++;
+    }
+#endif
+
   /* Configure the uart so that we can get debug output as soon as possible */
 
   stm32_clockconfig();
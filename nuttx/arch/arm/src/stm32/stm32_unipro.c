@@ -28,6 +28,8 @@
 
 #include <nuttx/config.h>
 
+#include <errno.h>
+
 #ifndef CONFIG_GREYBUS_MODS_NUM_CPORTS
 # define CONFIG_GREYBUS_MODS_NUM_CPORTS  (32)
 #endif
@@ -41,3 +43,13 @@ unsigned int unipro_cport_count(void)
 void unipro_rxbuf_free(unsigned int cportid, void *ptr)
 {
 }
+
+int unipro_rx_pause(unsigned int cportid)
+{
+  return -ENOSYS;
+}
+
+int unipro_rx_resume(unsigned int cportid)
+{
+  return -ENOSYS;
+}
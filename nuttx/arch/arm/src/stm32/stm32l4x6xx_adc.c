@@ -64,6 +64,9 @@
 #include "chip.h"
 #include "stm32.h"
 #include "stm32_adc.h"
+#ifdef CONFIG_STM32_ADC_DMA
+#  include "stm32_dma.h"
+#endif
 
 /* ADC "upper half" support must be enabled */
 
@@ -77,8 +80,21 @@
 
 #if defined(CONFIG_STM32_STM32L4X6)
 
-#ifdef ADC_HAVE_TIMER
-#  warning "ADC timers not yet supported"
+/* Timer triggered conversions use the TRGO output of the timer, driven by
+ * its update event.  TIM5 is not an ADC trigger source on the L4.
+ */
+
+#if defined(ADC1_HAVE_TIMER) && CONFIG_STM32_ADC1_TIMTRIG != 4
+#  error "Only the TRGO trigger (CONFIG_STM32_ADC1_TIMTRIG=4) is supported"
+#endif
+#if defined(ADC2_HAVE_TIMER) && CONFIG_STM32_ADC2_TIMTRIG != 4
+#  error "Only the TRGO trigger (CONFIG_STM32_ADC2_TIMTRIG=4) is supported"
+#endif
+#if defined(ADC3_HAVE_TIMER) && CONFIG_STM32_ADC3_TIMTRIG != 4
+#  error "Only the TRGO trigger (CONFIG_STM32_ADC3_TIMTRIG=4) is supported"
+#endif
+#ifdef CONFIG_STM32_TIM5_ADC
+#  error "TIM5 cannot trigger ADC conversions on the STM32 L4"
 #endif
 
 /****************************************************************************
@@ -98,6 +114,23 @@
 
 #define container_of(x, s, f) ((void*) ((char*)(x) - offsetof(s, f)))
 
+/* External trigger selection (EXTSEL) of the timer TRGO outputs */
+
+#define ADC_EXTSEL_TIM3_TRGO  4
+#define ADC_EXTSEL_TIM8_TRGO  7
+#define ADC_EXTSEL_TIM1_TRGO  9
+#define ADC_EXTSEL_TIM2_TRGO  11
+#define ADC_EXTSEL_TIM4_TRGO  12
+
+/* In DMA mode the conversion results are transferred into a circular buffer
+ * and handed to the upper half one half buffer at a time.
+ */
+
+#ifdef CONFIG_STM32_ADC_DMA
+#  define ADC_DMA_CONTROL_WORD (DMA_CCR_MSIZE_16BITS | DMA_CCR_PSIZE_16BITS | \
+                                DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_PRIMED)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -113,6 +146,17 @@ struct stm32_dev_s
   xcpt_t   isr;       /* Interrupt handler for this ADC block */
   uint32_t base;      /* Base address of registers unique to this ADC block */
   uint8_t  chanlist[ADC_MAX_SAMPLES];
+#ifdef ADC_HAVE_TIMER
+  uint32_t tbase;     /* Base address of the trigger timer (0: no timer) */
+  uint32_t pclck;     /* The frequency of the trigger timer input clock */
+  uint32_t freq;      /* The desired sampling frequency */
+#endif
+#ifdef CONFIG_STM32_ADC_DMA
+  unsigned int dmachan; /* DMA channel needed by this ADC */
+  DMA_HANDLE dma;     /* Allocated DMA channel */
+  uint16_t dmalen;    /* Used length of dmabuffer (multiple of 2 * nchannels) */
+  uint16_t dmabuffer[CONFIG_STM32_ADC_DMABUFSIZE];
+#endif
 #ifdef CONFIG_PM
   struct pm_callback_s pm_callback;
 #endif
@@ -147,6 +191,14 @@ static void adc_rxint(FAR struct adc_dev_s *dev, bool enable);
 static int  adc_ioctl(FAR struct adc_dev_s *dev, int cmd, unsigned long arg);
 static void adc_enable(FAR struct stm32_dev_s *priv);
 static void adc_startconv(FAR struct stm32_dev_s *priv, bool enable);
+#ifdef ADC_HAVE_TIMER
+static int  adc_timinit(FAR struct stm32_dev_s *priv);
+static void adc_timstart(FAR struct stm32_dev_s *priv, bool enable);
+#endif
+#ifdef CONFIG_STM32_ADC_DMA
+static void adc_dmaconvcallback(DMA_HANDLE handle, uint8_t status,
+                                FAR void *arg);
+#endif
 
 #ifdef CONFIG_PM
 static int  pm_prepare(struct pm_callback_s *cb, enum pm_state_e state);
@@ -176,6 +228,14 @@ static struct stm32_dev_s g_adcpriv1 =
   .isr         = adc12_interrupt,
   .intf        = 1,
   .base        = STM32_ADC1_BASE,
+#ifdef ADC1_HAVE_TIMER
+  .tbase       = ADC1_TIMER_BASE,
+  .pclck       = ADC1_TIMER_PCLK_FREQUENCY,
+  .freq        = CONFIG_STM32_ADC1_SAMPLE_FREQUENCY,
+#endif
+#ifdef CONFIG_STM32_ADC_DMA
+  .dmachan     = DMACHAN_ADC1_1,
+#endif
 #ifdef CONFIG_PM
   .pm_callback =
     {
@@ -200,6 +260,14 @@ static struct stm32_dev_s g_adcpriv2 =
   .isr         = adc12_interrupt,
   .intf        = 2,
   .base        = STM32_ADC2_BASE,
+#ifdef ADC2_HAVE_TIMER
+  .tbase       = ADC2_TIMER_BASE,
+  .pclck       = ADC2_TIMER_PCLK_FREQUENCY,
+  .freq        = CONFIG_STM32_ADC2_SAMPLE_FREQUENCY,
+#endif
+#ifdef CONFIG_STM32_ADC_DMA
+  .dmachan     = DMACHAN_ADC2_1,
+#endif
 #ifdef CONFIG_PM
   .pm_callback =
     {
@@ -224,6 +292,14 @@ static struct stm32_dev_s g_adcpriv3 =
   .isr         = adc3_interrupt,
   .intf        = 3,
   .base        = STM32_ADC3_BASE,
+#ifdef ADC3_HAVE_TIMER
+  .tbase       = ADC3_TIMER_BASE,
+  .pclck       = ADC3_TIMER_PCLK_FREQUENCY,
+  .freq        = CONFIG_STM32_ADC3_SAMPLE_FREQUENCY,
+#endif
+#ifdef CONFIG_STM32_ADC_DMA
+  .dmachan     = DMACHAN_ADC3_1,
+#endif
 #ifdef CONFIG_PM
   .pm_callback =
     {
@@ -365,6 +441,128 @@ static void adc_startconv(struct stm32_dev_s *priv, bool enable)
   adc_putreg(priv, STM32_ADC_CR_OFFSET, regval);
 }
 
+/****************************************************************************
+ * Name: adc_timinit
+ *
+ * Description:
+ *   Program the trigger timer to produce a TRGO pulse at the sampling
+ *   frequency and select it as the external trigger of the regular
+ *   conversions.  The timer is left stopped.
+ *
+ * Input Parameters:
+ *   priv - A reference to the ADC block status
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef ADC_HAVE_TIMER
+static int adc_timinit(FAR struct stm32_dev_s *priv)
+{
+  uint32_t extsel;
+  uint32_t ticks;
+  uint32_t prescaler;
+  uint32_t reload;
+  uint32_t regval;
+
+  switch (priv->tbase)
+    {
+#ifdef CONFIG_STM32_TIM1_ADC
+      case STM32_TIM1_BASE:
+        extsel = ADC_EXTSEL_TIM1_TRGO;
+        break;
+#endif
+#ifdef CONFIG_STM32_TIM2_ADC
+      case STM32_TIM2_BASE:
+        extsel = ADC_EXTSEL_TIM2_TRGO;
+        break;
+#endif
+#ifdef CONFIG_STM32_TIM3_ADC
+      case STM32_TIM3_BASE:
+        extsel = ADC_EXTSEL_TIM3_TRGO;
+        break;
+#endif
+#ifdef CONFIG_STM32_TIM4_ADC
+      case STM32_TIM4_BASE:
+        extsel = ADC_EXTSEL_TIM4_TRGO;
+        break;
+#endif
+#ifdef CONFIG_STM32_TIM8_ADC
+      case STM32_TIM8_BASE:
+        extsel = ADC_EXTSEL_TIM8_TRGO;
+        break;
+#endif
+      default:
+        adbg("ADC%d: no usable trigger timer\n", priv->intf);
+        return -EINVAL;
+    }
+
+  if (priv->freq == 0 || priv->freq > priv->pclck)
+    {
+      adbg("ADC%d: bad sampling frequency %u\n", priv->intf, priv->freq);
+      return -EINVAL;
+    }
+
+  /* Split the period into a 16-bit prescaler and a 16-bit reload value */
+
+  ticks     = priv->pclck / priv->freq;
+  prescaler = (ticks >> 16) + 1;
+  reload    = ticks / prescaler;
+  if (reload > 0)
+    {
+      reload--;
+    }
+
+  avdbg("ADC%d: freq %u prescaler %u reload %u\n",
+        priv->intf, priv->freq, prescaler, reload);
+
+  putreg32(0, priv->tbase + STM32_GTIM_CR1_OFFSET);
+  putreg32(prescaler - 1, priv->tbase + STM32_GTIM_PSC_OFFSET);
+  putreg32(reload, priv->tbase + STM32_GTIM_ARR_OFFSET);
+
+  /* TRGO on update event (same MMS encoding on the advanced timers) and
+   * load the prescaler now.
+   */
+
+  putreg32(GTIM_CR2_UPDT, priv->tbase + STM32_GTIM_CR2_OFFSET);
+  putreg32(GTIM_EGR_UG, priv->tbase + STM32_GTIM_EGR_OFFSET);
+
+  /* Convert the regular sequence on each rising edge of TRGO */
+
+  regval  = adc_getreg(priv, STM32_ADC_CFGR_OFFSET);
+  regval &= ~(ADC_CFGR_EXTSEL_MASK | ADC_CFGR_EXTEN_MASK);
+  regval |= ADC_CFGR_EXTSEL(extsel) | ADC_CFGR_EXTEN_RISING;
+  adc_putreg(priv, STM32_ADC_CFGR_OFFSET, regval);
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: adc_timstart
+ *
+ * Description:
+ *   Start (or stop) the trigger timer.
+ *
+ * Input Parameters:
+ *   priv - A reference to the ADC block status
+ *   enable - True: Start the timer
+ *
+ ****************************************************************************/
+
+static void adc_timstart(FAR struct stm32_dev_s *priv, bool enable)
+{
+  if (enable)
+    {
+      modifyreg32(priv->tbase + STM32_GTIM_CR1_OFFSET, 0, GTIM_CR1_CEN);
+    }
+  else
+    {
+      modifyreg32(priv->tbase + STM32_GTIM_CR1_OFFSET, GTIM_CR1_CEN, 0);
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: adc_rccreset
  *
@@ -566,10 +764,57 @@ static int adc_setup(FAR struct adc_dev_s *dev)
 
   priv->current = 0;
 
+#ifdef CONFIG_STM32_ADC_DMA
+  /* Circular DMA of the conversion results.  Overrun overwrites DR so that
+   * a late DMA only loses samples instead of stopping the stream.
+   */
+
+  regval  = adc_getreg(priv, STM32_ADC_CFGR_OFFSET);
+  regval |= ADC_CFGR_DMAEN | ADC_CFGR_DMACFG | ADC_CFGR_OVRMOD;
+  adc_putreg(priv, STM32_ADC_CFGR_OFFSET, regval);
+
+  /* Both halves of the buffer must hold whole conversion sequences */
+
+  priv->dmalen = CONFIG_STM32_ADC_DMABUFSIZE / (2 * priv->nchannels) *
+                 (2 * priv->nchannels);
+  DEBUGASSERT(priv->dmalen > 0);
+
+  stm32_dmasetup(priv->dma, priv->base + STM32_ADC_DR_OFFSET,
+                 (uint32_t)priv->dmabuffer, priv->dmalen,
+                 ADC_DMA_CONTROL_WORD);
+  stm32_dmastart(priv->dma, adc_dmaconvcallback, dev, true);
+#endif
+
+#ifdef ADC_HAVE_TIMER
+  if (priv->tbase != 0)
+    {
+      ret = adc_timinit(priv);
+      if (ret != OK)
+        {
+#ifdef CONFIG_STM32_ADC_DMA
+          stm32_dmastop(priv->dma);
+#endif
+          irqrestore(flags);
+          irq_detach(priv->irq);
+          return ret;
+        }
+    }
+#endif
+
   /* Set ADEN to wake up the ADC from Power Down state. */
 
   adc_enable(priv);
 
+#ifdef ADC_HAVE_TIMER
+  /* Arm the hardware trigger and start the timer */
+
+  if (priv->tbase != 0)
+    {
+      adc_startconv(priv, true);
+      adc_timstart(priv, true);
+    }
+#endif
+
   irqrestore(flags);
 
   avdbg("ISR:   0x%08x CR:    0x%08x CFGR:  0x%08x CFGR2: 0x%08x\n",
@@ -606,6 +851,17 @@ static void adc_shutdown(FAR struct adc_dev_s *dev)
 {
   FAR struct stm32_dev_s *priv = (FAR struct stm32_dev_s *)dev->ad_priv;
 
+#ifdef ADC_HAVE_TIMER
+  if (priv->tbase != 0)
+    {
+      adc_timstart(priv, false);
+    }
+#endif
+
+#ifdef CONFIG_STM32_ADC_DMA
+  stm32_dmastop(priv->dma);
+#endif
+
   /* Disable ADC interrupts and detach the ADC interrupt handler */
 
   up_disable_irq(priv->irq);
@@ -637,9 +893,13 @@ static void adc_rxint(FAR struct adc_dev_s *dev, bool enable)
   regval = adc_getreg(priv, STM32_ADC_IER_OFFSET);
   if (enable)
     {
-      /* Enable end of conversion interrupt */
+#ifndef CONFIG_STM32_ADC_DMA
+      /* Enable end of conversion interrupt.  In DMA mode the results are
+       * delivered by adc_dmaconvcallback() instead.
+       */
 
       regval |= ADC_INT_EOC;
+#endif
     }
   else
     {
@@ -806,6 +1066,46 @@ static int adc_interrupt(FAR struct adc_dev_s *dev)
   return OK;
 }
 
+/****************************************************************************
+ * Name: adc_dmaconvcallback
+ *
+ * Description:
+ *   DMA half and full transfer callback.  Passes the half of the circular
+ *   buffer that has just been filled to the upper half.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_STM32_ADC_DMA
+static void adc_dmaconvcallback(DMA_HANDLE handle, uint8_t status,
+                                FAR void *arg)
+{
+  FAR struct adc_dev_s *dev = (FAR struct adc_dev_s *)arg;
+  FAR struct stm32_dev_s *priv = (FAR struct stm32_dev_s *)dev->ad_priv;
+  int half = priv->dmalen / 2;
+  int nqueued;
+
+  if ((status & DMA_STATUS_HTIF) != 0)
+    {
+      nqueued = adc_receive_block(dev, priv->chanlist, priv->nchannels,
+                                  &priv->dmabuffer[0], half);
+      if (nqueued < half)
+        {
+          allvdbg("ADC%d: dropped %d samples\n", priv->intf, half - nqueued);
+        }
+    }
+
+  if ((status & DMA_STATUS_TCIF) != 0)
+    {
+      nqueued = adc_receive_block(dev, priv->chanlist, priv->nchannels,
+                                  &priv->dmabuffer[half], half);
+      if (nqueued < half)
+        {
+          allvdbg("ADC%d: dropped %d samples\n", priv->intf, half - nqueued);
+        }
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: adc12_interrupt
  *
@@ -957,6 +1257,20 @@ struct adc_dev_s *stm32_adcinitialize(int intf, const uint8_t *chanlist,
 
   memcpy(priv->chanlist, chanlist, nchannels);
 
+#ifdef CONFIG_STM32_ADC_DMA
+  /* Allocate the DMA channel once; it stays with the ADC */
+
+  if (priv->dma == NULL)
+    {
+      priv->dma = stm32_dmachannel(priv->dmachan);
+      if (priv->dma == NULL)
+        {
+          adbg("ADC%d: no DMA channel\n", intf);
+          return NULL;
+        }
+    }
+#endif
+
 #ifdef CONFIG_PM
   if (pm_register(&priv->pm_callback) != OK)
     {
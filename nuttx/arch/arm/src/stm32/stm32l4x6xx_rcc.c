@@ -838,3 +838,101 @@ static inline void rcc_enableperipherals(void)
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
+
+/****************************************************************************
+ * Name: stm32_clocksave
+ *
+ * Description:
+ *   Remember which oscillators and PLLs run and which one clocks the
+ *   system, before entering STOP mode.  If the PLLs are fed by the HSI,
+ *   also select the HSI as the wake-up clock so that it is already running
+ *   when they are restarted.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PM
+static uint32_t g_rcc_saved_cr;
+static uint32_t g_rcc_saved_sw;
+static bool g_rcc_saved;
+
+void stm32_clocksave(void)
+{
+  uint32_t regval;
+
+  g_rcc_saved_cr = getreg32(STM32_RCC_CR) &
+                   (RCC_CR_HSION | RCC_CR_HSEON | RCC_CR_PLLON |
+                    RCC_CR_PLLSAI1ON | RCC_CR_PLLSAI2ON);
+
+  regval         = getreg32(STM32_RCC_CFGR);
+  g_rcc_saved_sw = regval & RCC_CFGR_SW_MASK;
+
+  if ((getreg32(STM32_RCC_PLLCFG) & RCC_PLLCFG_PLLSRC_MASK) ==
+      RCC_PLLCFG_PLLSRC_HSI)
+    {
+      regval |= RCC_CFGR_STOPWUCK;
+    }
+  else
+    {
+      regval &= ~RCC_CFGR_STOPWUCK;
+    }
+
+  putreg32(regval, STM32_RCC_CFGR);
+  g_rcc_saved = true;
+}
+
+/****************************************************************************
+ * Name: stm32_clockrestore
+ *
+ * Description:
+ *   Fast alternative to stm32_clockenable() after a wake-up from STOP mode.
+ *   The RCC registers keep their content in STOP, only the oscillators and
+ *   PLLs are stopped: restart those that stm32_clocksave() found running,
+ *   all PLLs at once so that their lock times overlap, and switch back to
+ *   the saved system clock.  Without a saved state, stm32_clockenable() is
+ *   used.
+ *
+ ****************************************************************************/
+
+void stm32_clockrestore(void)
+{
+  uint32_t osc;
+  uint32_t pll;
+  uint32_t ready;
+
+  if (!g_rcc_saved)
+    {
+      stm32_clockenable();
+      return;
+    }
+
+  g_rcc_saved = false;
+
+  /* Oscillators first, the PLLs need their input clock */
+
+  osc   = g_rcc_saved_cr & (RCC_CR_HSION | RCC_CR_HSEON);
+  ready = ((osc & RCC_CR_HSION) ? RCC_CR_HSIRDY : 0) |
+          ((osc & RCC_CR_HSEON) ? RCC_CR_HSERDY : 0);
+
+  modifyreg32(STM32_RCC_CR, 0, osc);
+  while ((getreg32(STM32_RCC_CR) & ready) != ready)
+    {
+    }
+
+  /* Each PLL ready flag is the bit following its enable bit */
+
+  pll   = g_rcc_saved_cr & (RCC_CR_PLLON | RCC_CR_PLLSAI1ON |
+                            RCC_CR_PLLSAI2ON);
+  ready = pll << 1;
+
+  modifyreg32(STM32_RCC_CR, 0, pll);
+  while ((getreg32(STM32_RCC_CR) & ready) != ready)
+    {
+    }
+
+  modifyreg32(STM32_RCC_CFGR, RCC_CFGR_SW_MASK, g_rcc_saved_sw);
+  while ((getreg32(STM32_RCC_CFGR) & RCC_CFGR_SWS_MASK) !=
+         (g_rcc_saved_sw << RCC_CFGR_SWS_SHIFT))
+    {
+    }
+}
+#endif
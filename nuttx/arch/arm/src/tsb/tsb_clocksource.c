@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * The 48 MHz free-running timer as the high resolution clock source.  It
+ * keeps counting while the CPU sleeps, unlike the DWT cycle counter.
+ */
+
+#include <nuttx/config.h>
+#include <nuttx/clocksource.h>
+
+#include <debug.h>
+
+#include "tsb_fr_tmr.h"
+
+/* Base frequency of the TSB timers, see TSB_TMR_RAW_TO_USEC() */
+#define TSB_CLOCKSOURCE_FREQ    48000000
+
+static uint32_t tsb_clocksource_read(void)
+{
+    return tsb_fr_tmr_get();
+}
+
+static const struct clocksource_s tsb_clocksource = {
+    .name = "tsb_fr_tmr",
+    .read = tsb_clocksource_read,
+    .freq = TSB_CLOCKSOURCE_FREQ,
+};
+
+void tsb_clocksource_initialize(void)
+{
+    int id;
+
+    tsb_fr_tmr_init();
+
+    id = tsb_fr_tmr_reserve();
+    if (id < 0 || tsb_fr_tmr_start(id)) {
+        lldbg("cannot start the free-running timer\n");
+        return;
+    }
+
+    if (clocksource_register(&tsb_clocksource))
+        lldbg("cannot register the clock source\n");
+}
@@ -190,9 +190,17 @@ int tsb_fr_tmr_stop(int tmr_id)
 
 /**
  * @brief Initialize the free running timer system.
+ *
+ * Does nothing if already initialized, so that the users of the timer
+ * reserved so far are kept.
  */
 void tsb_fr_tmr_init(void)
 {
+    if (g_tsb_fr_tmr.tmr)
+    {
+        return;
+    }
+
     memset(&g_tsb_fr_tmr, 0, sizeof(g_tsb_fr_tmr));
     g_tsb_fr_tmr.tmr = tsb_tmr_get(TSB_FR_TMR_ID);
 }
@@ -38,4 +38,8 @@ int tsb_fr_tmr_start(int tmr_id);
 int tsb_fr_tmr_stop(int tmr_id);
 void tsb_fr_tmr_init(void);
 
+#ifdef CONFIG_TSB_CLOCKSOURCE
+void tsb_clocksource_initialize(void);
+#endif
+
 #endif
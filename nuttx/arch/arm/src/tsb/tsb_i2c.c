@@ -85,6 +85,7 @@ static int              g_msg_err;
 static unsigned int     g_status;
 static uint32_t         g_abort_source;
 static unsigned int     g_rx_outstanding;
+static bool             g_watermarks;   /* Long transfer FIFO thresholds */
 
 #if defined(CONFIG_TSB_I2C_SPEED_FAST)
 #define TSB_I2C_CON_SPEED	TSB_I2C_CON_SPEED_FAST
@@ -101,6 +102,15 @@ static unsigned int     g_rx_outstanding;
 #define TSB_I2C_TX_FIFO_DEPTH   8
 #define TSB_I2C_RX_FIFO_DEPTH   8
 
+/*
+ * Transfers of at least TSB_I2C_LONG_XFER bytes refill the TX FIFO when it
+ * runs low and drain the RX FIFO when half full, instead of taking an
+ * interrupt per byte. The last bytes read are drained on STOP detection.
+ */
+#define TSB_I2C_LONG_XFER       16
+#define TSB_I2C_LONG_TX_TL      2
+#define TSB_I2C_LONG_RX_TL      (TSB_I2C_RX_FIFO_DEPTH / 2 - 1)
+
 /* IRQs handle by the driver */
 #define TSB_I2C_INTR_DEFAULT_MASK (TSB_I2C_INTR_RX_FULL | \
                                    TSB_I2C_INTR_TX_EMPTY | \
@@ -219,6 +229,15 @@ static void tsb_i2c_start_transfer(void)
     /* write target address */
     i2c_write(TSB_I2C_TAR, g_msgs[g_tx_index].addr);
 
+    /* Configure Tx/Rx FIFO threshold levels for this transfer */
+    if (g_watermarks) {
+        i2c_write(TSB_I2C_TX_TL, TSB_I2C_LONG_TX_TL);
+        i2c_write(TSB_I2C_RX_TL, TSB_I2C_LONG_RX_TL);
+    } else {
+        i2c_write(TSB_I2C_TX_TL, TSB_I2C_TX_FIFO_DEPTH - 1);
+        i2c_write(TSB_I2C_RX_TL, 0);
+    }
+
     /* Disable the interrupts */
     tsb_i2c_disable_int();
 
@@ -400,7 +419,9 @@ static int tsb_i2c_handle_tx_abort(void)
 /* Perform a sequence of I2C transfers */
 static int up_i2c_transfer(struct i2c_dev_s *idev, struct i2c_msg_s *msgs, int num)
 {
+    unsigned int length = 0;
     int ret;
+    int i;
 
     i2cvdbg("msgs: %d\n", num);
 
@@ -417,6 +438,10 @@ static int up_i2c_transfer(struct i2c_dev_s *idev, struct i2c_msg_s *msgs, int n
     g_status = TSB_I2C_STATUS_IDLE;
     g_abort_source = 0;
 
+    for (i = 0; i < num; i++)
+        length += msgs[i].length;
+    g_watermarks = length >= TSB_I2C_LONG_XFER;
+
     ret = tsb_i2c_wait_bus_ready();
     if (ret < 0)
         goto done;
@@ -534,6 +559,10 @@ static int i2c_interrupt(int irq, void *context)
     if (stat & TSB_I2C_INTR_TX_EMPTY)
         tsb_i2c_transfer_msg();
 
+    /* Fetch the bytes left below the RX threshold */
+    if ((stat & TSB_I2C_INTR_STOP_DET) && g_rx_outstanding)
+        tsb_i2c_read();
+
 tx_aborted:
     if (stat & TSB_I2C_INTR_TX_ABRT)
         i2cdbg("aborted %x %x\n", stat, g_abort_source);
@@ -39,17 +39,24 @@
 
 #include <string.h>
 #include <errno.h>
+#include <debug.h>
 #include <nuttx/lib.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/device.h>
 #include <nuttx/device_pll.h>
 #include <nuttx/device_i2s.h>
+#ifdef CONFIG_ARCH_CHIP_TSB_I2S_DMA
+#include <nuttx/device_dma.h>
+#endif
 
 #include <arch/byteorder.h>
 
 #include "up_arch.h"
 #include "tsb_scm.h"
 #include "tsb_i2s_regs.h"
+#ifdef CONFIG_ARCH_CHIP_TSB_I2S_DMA
+#include "tsb_dma.h"
+#endif
 
 #define TSB_I2S_DRIVER_NAME         "tsb i2s driver"
 
@@ -87,6 +94,25 @@ enum tsb_i2s_block {
     TSB_I2S_BLOCK_SI,
 };
 
+#ifdef CONFIG_ARCH_CHIP_TSB_I2S_DMA
+/* Ring buffer entries queued to the DMA controller at once, per direction */
+#define TSB_I2S_DMA_OPS             2
+
+/*
+ * One direction of the DMA data path.  Each ring buffer entry is moved by
+ * one DMA op, and up to TSB_I2S_DMA_OPS entries are queued so that the next
+ * one starts as soon as the current one completes.  Ops complete in order:
+ * op[head] is the oldest one in flight and always moves rx_rb/tx_rb.
+ */
+struct tsb_i2s_dma {
+    void                            *chan;
+    struct device_dma_op            *op[TSB_I2S_DMA_OPS];
+    struct ring_buf                 *rb[TSB_I2S_DMA_OPS];
+    unsigned int                    head;
+    unsigned int                    count;
+};
+#endif
+
 struct tsb_i2s_info {
     struct device                   *dev;
     struct device                   *pll_dev;
@@ -111,6 +137,11 @@ struct tsb_i2s_info {
     uint8_t                         mclk_role;
     uint8_t                         bclk_role;
     uint8_t                         wclk_role;
+#ifdef CONFIG_ARCH_CHIP_TSB_I2S_DMA
+    struct device                   *dma_dev;
+    struct tsb_i2s_dma              rx_dma;
+    struct tsb_i2s_dma              tx_dma;
+#endif
 };
 
 /*
@@ -759,6 +790,43 @@ static void tsb_i2s_stop(struct tsb_i2s_info *info, enum tsb_i2s_block block,
         tsb_i2s_stop_block(info, TSB_I2S_BLOCK_SC, is_err);
 }
 
+#ifdef CONFIG_ARCH_CHIP_TSB_I2S_DMA
+static int tsb_i2s_use_dma(struct tsb_i2s_info *info)
+{
+    return info->dma_dev != NULL;
+}
+
+static void tsb_i2s_dma_abort(struct tsb_i2s_info *info,
+                              struct tsb_i2s_dma *dma)
+{
+    unsigned int i;
+
+    if (!tsb_i2s_use_dma(info) || !dma->count)
+        return;
+
+    gdmac_abort_chan(info->dma_dev, dma->chan);
+
+    for (i = 0; i < TSB_I2S_DMA_OPS; i++) {
+        if (!device_dma_op_is_complete(info->dma_dev, dma->op[i]))
+            (void)device_dma_dequeue(info->dma_dev, dma->chan, dma->op[i]);
+    }
+
+    dma->head = 0;
+    dma->count = 0;
+}
+
+/* The FIFO interrupt when using the FIFOs, the DMA request otherwise */
+static uint32_t tsb_i2s_data_irq(struct tsb_i2s_info *info)
+{
+    return tsb_i2s_use_dma(info) ? TSB_I2S_REG_INT_DMACMSK :
+                                   TSB_I2S_REG_INT_INT;
+}
+#else
+#define tsb_i2s_use_dma(info)       0
+#define tsb_i2s_dma_abort(info, dma)
+#define tsb_i2s_data_irq(info)      TSB_I2S_REG_INT_INT
+#endif
+
 static int tsb_i2s_start_receiver(struct tsb_i2s_info *info)
 {
     irqstate_t flags;
@@ -777,7 +845,7 @@ static int tsb_i2s_start_receiver(struct tsb_i2s_info *info)
                        TSB_I2S_REG_INT_OR | TSB_I2S_REG_INT_INT);
     tsb_i2s_unmask_irqs(info, TSB_I2S_BLOCK_SI,
                         TSB_I2S_REG_INT_LRCK | TSB_I2S_REG_INT_UR |
-                        TSB_I2S_REG_INT_OR | TSB_I2S_REG_INT_INT);
+                        TSB_I2S_REG_INT_OR | tsb_i2s_data_irq(info));
 
     ret = tsb_i2s_start(info, TSB_I2S_BLOCK_SI);
     if (ret)
@@ -785,14 +853,18 @@ static int tsb_i2s_start_receiver(struct tsb_i2s_info *info)
 
     info->flags |= TSB_I2S_FLAG_RX_ACTIVE;
 
+    /* The DMA controller takes over the FIFO as soon as an op is queued */
+    if (tsb_i2s_use_dma(info))
+        ret = tsb_i2s_rx_data(info);
+
     irqrestore(flags);
 
-    return 0;
+    return ret;
 
 err_mask_irqs:
     tsb_i2s_mask_irqs(info, TSB_I2S_BLOCK_SI,
                       TSB_I2S_REG_INT_LRCK | TSB_I2S_REG_INT_UR |
-                      TSB_I2S_REG_INT_OR | TSB_I2S_REG_INT_INT);
+                      TSB_I2S_REG_INT_OR | tsb_i2s_data_irq(info));
 err_irqrestore:
     irqrestore(flags);
 
@@ -809,7 +881,8 @@ static void tsb_i2s_stop_receiver(struct tsb_i2s_info *info, int is_err)
 
     tsb_i2s_mask_irqs(info, TSB_I2S_BLOCK_SI,
                       TSB_I2S_REG_INT_LRCK | TSB_I2S_REG_INT_UR |
-                      TSB_I2S_REG_INT_OR | TSB_I2S_REG_INT_INT);
+                      TSB_I2S_REG_INT_OR | tsb_i2s_data_irq(info));
+    tsb_i2s_dma_abort(info, &info->rx_dma);
     tsb_i2s_clear_irqs(info, TSB_I2S_BLOCK_SI,
                        TSB_I2S_REG_INT_LRCK | TSB_I2S_REG_INT_UR |
                        TSB_I2S_REG_INT_OR | TSB_I2S_REG_INT_INT);
@@ -830,10 +903,15 @@ static int tsb_i2s_start_transmitter(struct tsb_i2s_info *info)
         tsb_i2s_clear_irqs(info, TSB_I2S_BLOCK_SO,
                            TSB_I2S_REG_INT_LRCK | TSB_I2S_REG_INT_UR |
                            TSB_I2S_REG_INT_OR | TSB_I2S_REG_INT_INT);
-        /* TSB_I2S_REG_INT_INT is unmasked in tsb_i2s_tx_data() */
+        /*
+         * TSB_I2S_REG_INT_INT is unmasked in tsb_i2s_tx_data().  DMA
+         * requests are only raised once an op has been queued there.
+         */
         tsb_i2s_unmask_irqs(info, TSB_I2S_BLOCK_SO,
                             TSB_I2S_REG_INT_LRCK | TSB_I2S_REG_INT_UR |
-                            TSB_I2S_REG_INT_OR);
+                            TSB_I2S_REG_INT_OR |
+                            (tsb_i2s_use_dma(info) ?
+                             TSB_I2S_REG_INT_DMACMSK : 0));
 
         ret = tsb_i2s_start(info, TSB_I2S_BLOCK_SO);
         if (ret)
@@ -860,7 +938,8 @@ static void tsb_i2s_stop_transmitter(struct tsb_i2s_info *info, int is_err)
 
     tsb_i2s_mask_irqs(info, TSB_I2S_BLOCK_SO,
                       TSB_I2S_REG_INT_LRCK | TSB_I2S_REG_INT_UR |
-                      TSB_I2S_REG_INT_OR | TSB_I2S_REG_INT_INT);
+                      TSB_I2S_REG_INT_OR | tsb_i2s_data_irq(info));
+    tsb_i2s_dma_abort(info, &info->tx_dma);
     tsb_i2s_clear_irqs(info, TSB_I2S_BLOCK_SO,
                        TSB_I2S_REG_INT_LRCK | TSB_I2S_REG_INT_UR |
                        TSB_I2S_REG_INT_OR | TSB_I2S_REG_INT_INT);
@@ -888,6 +967,300 @@ static enum device_i2s_event tsb_i2s_intstat2event(uint32_t intstat)
     return event;
 }
 
+#ifdef CONFIG_ARCH_CHIP_TSB_I2S_DMA
+static struct ring_buf *tsb_i2s_dma_next_rb(struct tsb_i2s_dma *dma,
+                                            struct ring_buf *rb)
+{
+    struct ring_buf *next;
+
+    if (!dma->count)
+        return rb;
+
+    next = ring_buf_get_next(dma->rb[(dma->head + dma->count - 1) %
+                                     TSB_I2S_DMA_OPS]);
+
+    /* Don't queue the same entry twice when the ring is shorter than us */
+    return (next == dma->rb[dma->head]) ? NULL : next;
+}
+
+static int tsb_i2s_rx_dma_queue(struct tsb_i2s_info *info,
+                                enum device_i2s_event *event)
+{
+    struct tsb_i2s_dma *dma = &info->rx_dma;
+    struct device_dma_op *op;
+    struct ring_buf *rb;
+    unsigned int idx;
+    int ret;
+
+    while (dma->count < TSB_I2S_DMA_OPS) {
+        rb = tsb_i2s_dma_next_rb(dma, info->rx_rb);
+        if (!rb || !ring_buf_is_producers(rb))
+            break;
+
+        if (ring_buf_space(rb) % 4) {
+            *event = DEVICE_I2S_EVENT_DATA_LEN;
+            return -EINVAL;
+        }
+
+        idx = (dma->head + dma->count) % TSB_I2S_DMA_OPS;
+        op = dma->op[idx];
+
+        op->sg[0].src_addr = info->si_base + TSB_I2S_REG_LMEM00;
+        op->sg[0].dst_addr = (off_t)ring_buf_get_tail(rb);
+        op->sg[0].len = ring_buf_space(rb);
+
+        ret = device_dma_enqueue(info->dma_dev, dma->chan, op);
+        if (ret) {
+            *event = DEVICE_I2S_EVENT_UNSPECIFIED;
+            return ret;
+        }
+
+        dma->rb[idx] = rb;
+        dma->count++;
+    }
+
+    return 0;
+}
+
+static int tsb_i2s_tx_dma_queue(struct tsb_i2s_info *info,
+                                enum device_i2s_event *event)
+{
+    struct tsb_i2s_dma *dma = &info->tx_dma;
+    struct device_dma_op *op;
+    struct ring_buf *rb;
+    unsigned int idx;
+    int ret;
+
+    while (dma->count < TSB_I2S_DMA_OPS) {
+        rb = tsb_i2s_dma_next_rb(dma, info->tx_rb);
+        if (!rb || !ring_buf_is_consumers(rb))
+            break;
+
+        if (ring_buf_len(rb) % 4) {
+            *event = DEVICE_I2S_EVENT_DATA_LEN;
+            return -EINVAL;
+        }
+
+        idx = (dma->head + dma->count) % TSB_I2S_DMA_OPS;
+        op = dma->op[idx];
+
+        op->sg[0].src_addr = (off_t)ring_buf_get_head(rb);
+        op->sg[0].dst_addr = info->so_base + TSB_I2S_REG_LMEM00;
+        op->sg[0].len = ring_buf_len(rb);
+
+        ret = device_dma_enqueue(info->dma_dev, dma->chan, op);
+        if (ret) {
+            *event = DEVICE_I2S_EVENT_UNSPECIFIED;
+            return ret;
+        }
+
+        dma->rb[idx] = rb;
+        dma->count++;
+    }
+
+    return 0;
+}
+
+/*
+ * DMA completion callbacks run in thread context so disable interrupts to
+ * serialize with the error irq handlers that also stop the blocks.
+ */
+static int tsb_i2s_rx_dma_callback(struct device *dev, void *chan,
+                                   struct device_dma_op *op,
+                                   unsigned int event, void *arg)
+{
+    struct tsb_i2s_info *info = arg;
+    struct tsb_i2s_dma *dma = &info->rx_dma;
+    irqstate_t flags;
+
+    flags = irqsave();
+
+    if (!tsb_i2s_rx_is_active(info) || !dma->count ||
+        (op != dma->op[dma->head]))
+        goto out;
+
+    if (event & DEVICE_DMA_CALLBACK_EVENT_ERROR) {
+        tsb_i2s_stop_receiver(info, 1);
+
+        if (info->rx_callback)
+            info->rx_callback(info->rx_rb, DEVICE_I2S_EVENT_UNSPECIFIED,
+                              info->rx_arg);
+        goto out;
+    }
+
+    dma->head = (dma->head + 1) % TSB_I2S_DMA_OPS;
+    dma->count--;
+
+    ring_buf_put(info->rx_rb, op->sg[0].len);
+    ring_buf_pass(info->rx_rb);
+
+    if (info->rx_callback)
+        info->rx_callback(info->rx_rb, DEVICE_I2S_EVENT_RX_COMPLETE,
+                          info->rx_arg);
+
+    info->rx_rb = ring_buf_get_next(info->rx_rb);
+
+    tsb_i2s_rx_data(info);
+
+out:
+    irqrestore(flags);
+
+    return 0;
+}
+
+static int tsb_i2s_tx_dma_callback(struct device *dev, void *chan,
+                                   struct device_dma_op *op,
+                                   unsigned int event, void *arg)
+{
+    struct tsb_i2s_info *info = arg;
+    struct tsb_i2s_dma *dma = &info->tx_dma;
+    irqstate_t flags;
+
+    flags = irqsave();
+
+    if (!tsb_i2s_tx_is_active(info) || !dma->count ||
+        (op != dma->op[dma->head]))
+        goto out;
+
+    if (event & DEVICE_DMA_CALLBACK_EVENT_ERROR) {
+        tsb_i2s_stop_transmitter(info, 1);
+
+        if (info->tx_callback)
+            info->tx_callback(info->tx_rb, DEVICE_I2S_EVENT_UNSPECIFIED,
+                              info->tx_arg);
+        goto out;
+    }
+
+    dma->head = (dma->head + 1) % TSB_I2S_DMA_OPS;
+    dma->count--;
+
+    ring_buf_reset(info->tx_rb);
+    ring_buf_pass(info->tx_rb);
+
+    if (info->tx_callback)
+        info->tx_callback(info->tx_rb, DEVICE_I2S_EVENT_TX_COMPLETE,
+                          info->tx_arg);
+
+    info->tx_rb = ring_buf_get_next(info->tx_rb);
+
+    tsb_i2s_tx_data(info);
+
+out:
+    irqrestore(flags);
+
+    return 0;
+}
+
+static void tsb_i2s_dma_free(struct tsb_i2s_info *info,
+                             struct tsb_i2s_dma *dma)
+{
+    unsigned int i;
+
+    for (i = 0; i < TSB_I2S_DMA_OPS; i++) {
+        if (dma->op[i]) {
+            device_dma_op_free(info->dma_dev, dma->op[i]);
+            dma->op[i] = NULL;
+        }
+    }
+
+    if (dma->chan) {
+        device_dma_chan_free(info->dma_dev, dma->chan);
+        dma->chan = NULL;
+    }
+}
+
+static int tsb_i2s_dma_alloc(struct tsb_i2s_info *info,
+                             struct tsb_i2s_dma *dma,
+                             struct device_dma_params *params,
+                             device_dma_op_callback callback)
+{
+    unsigned int i;
+    int ret;
+
+    ret = device_dma_chan_alloc(info->dma_dev, params, &dma->chan);
+    if (ret)
+        return ret;
+
+    for (i = 0; i < TSB_I2S_DMA_OPS; i++) {
+        ret = device_dma_op_alloc(info->dma_dev, 1, 0, &dma->op[i]);
+        if (ret) {
+            tsb_i2s_dma_free(info, dma);
+            return ret;
+        }
+
+        dma->op[i]->callback = callback;
+        dma->op[i]->callback_arg = info;
+        dma->op[i]->callback_events = DEVICE_DMA_CALLBACK_EVENT_COMPLETE |
+                                      DEVICE_DMA_CALLBACK_EVENT_ERROR;
+        dma->op[i]->sg_count = 1;
+    }
+
+    dma->head = 0;
+    dma->count = 0;
+
+    return 0;
+}
+
+static void tsb_i2s_dma_close(struct tsb_i2s_info *info)
+{
+    if (!info->dma_dev)
+        return;
+
+    tsb_i2s_dma_free(info, &info->rx_dma);
+    tsb_i2s_dma_free(info, &info->tx_dma);
+
+    device_close(info->dma_dev);
+    info->dma_dev = NULL;
+}
+
+/*
+ * Move the data with the GDMAC when a controller and two channels are
+ * available, otherwise fall back to filling and draining the FIFOs from
+ * the FIFO threshold irqs.
+ */
+static void tsb_i2s_dma_open(struct tsb_i2s_info *info)
+{
+    struct device_dma_params rx_params = {
+        .src_dev            = DEVICE_DMA_DEV_IO,
+        .src_devid          = TSB_I2S_SI_DMA_DEVID,
+        .src_inc_options    = DEVICE_DMA_INC_NOAUTO,
+        .dst_dev            = DEVICE_DMA_DEV_MEM,
+        .dst_devid          = 0,
+        .dst_inc_options    = DEVICE_DMA_INC_AUTO,
+        .transfer_size      = DEVICE_DMA_TRANSFER_SIZE_32,
+        .burst_len          = DEVICE_DMA_BURST_LEN_1,
+        .swap               = DEVICE_DMA_SWAP_SIZE_NONE,
+    };
+    struct device_dma_params tx_params = {
+        .src_dev            = DEVICE_DMA_DEV_MEM,
+        .src_devid          = 0,
+        .src_inc_options    = DEVICE_DMA_INC_AUTO,
+        .dst_dev            = DEVICE_DMA_DEV_IO,
+        .dst_devid          = TSB_I2S_SO_DMA_DEVID,
+        .dst_inc_options    = DEVICE_DMA_INC_NOAUTO,
+        .transfer_size      = DEVICE_DMA_TRANSFER_SIZE_32,
+        .burst_len          = DEVICE_DMA_BURST_LEN_1,
+        .swap               = DEVICE_DMA_SWAP_SIZE_NONE,
+    };
+
+    info->dma_dev = device_open(DEVICE_TYPE_DMA_HW, 0);
+    if (!info->dma_dev) {
+        lldbg("no DMA controller, using FIFO irqs\n");
+        return;
+    }
+
+    if (tsb_i2s_dma_alloc(info, &info->rx_dma, &rx_params,
+                          tsb_i2s_rx_dma_callback) ||
+        tsb_i2s_dma_alloc(info, &info->tx_dma, &tx_params,
+                          tsb_i2s_tx_dma_callback)) {
+        lldbg("no DMA channels, using FIFO irqs\n");
+        tsb_i2s_dma_close(info);
+    }
+}
+#else
+#define tsb_i2s_dma_open(info)
+#define tsb_i2s_dma_close(info)
+#endif
 
 static int tsb_i2s_drain_fifo(struct tsb_i2s_info *info,
                               enum device_i2s_event *event)
@@ -926,6 +1299,20 @@ static int tsb_i2s_rx_data(struct tsb_i2s_info *info)
     enum device_i2s_event event = DEVICE_I2S_EVENT_NONE;
     int ret = 0;
 
+#ifdef CONFIG_ARCH_CHIP_TSB_I2S_DMA
+    if (tsb_i2s_use_dma(info)) {
+        ret = tsb_i2s_rx_dma_queue(info, &event);
+        if (ret) {
+            tsb_i2s_stop_receiver(info, 1);
+
+            if (info->rx_callback)
+                info->rx_callback(info->rx_rb, event, info->rx_arg);
+        }
+
+        return ret;
+    }
+#endif
+
     while (ring_buf_is_producers(info->rx_rb)) {
         if (ring_buf_space(info->rx_rb) % 4) {
             event = DEVICE_I2S_EVENT_DATA_LEN;
@@ -1009,6 +1396,20 @@ static int tsb_i2s_tx_data(struct tsb_i2s_info *info)
     enum device_i2s_event event = DEVICE_I2S_EVENT_NONE;
     int ret = 0;
 
+#ifdef CONFIG_ARCH_CHIP_TSB_I2S_DMA
+    if (tsb_i2s_use_dma(info)) {
+        ret = tsb_i2s_tx_dma_queue(info, &event);
+        if (ret) {
+            tsb_i2s_stop_transmitter(info, 1);
+
+            if (info->tx_callback)
+                info->tx_callback(info->tx_rb, event, info->tx_arg);
+        }
+
+        return ret;
+    }
+#endif
+
     while (ring_buf_is_consumers(info->tx_rb)) {
         if (ring_buf_len(info->tx_rb) % 4) {
             event = DEVICE_I2S_EVENT_DATA_LEN;
@@ -1522,6 +1923,8 @@ static int tsb_i2s_dev_open(struct device *dev)
 
     info->flags = TSB_I2S_FLAG_OPEN;
 
+    tsb_i2s_dma_open(info);
+
 err_unlock:
     sem_post(&info->lock);
 
@@ -1549,6 +1952,8 @@ static void tsb_i2s_dev_close(struct device *dev)
     if (tsb_i2s_tx_is_prepared(info))
         tsb_i2s_op_shutdown_transmitter(dev);
 
+    tsb_i2s_dma_close(info);
+
     info->flags = 0;
 
 err_unlock:
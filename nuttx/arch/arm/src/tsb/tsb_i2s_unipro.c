@@ -125,6 +125,38 @@
  */
 #define TSB_I2S_UNIPRO_TUNNEL_BUF_ADJUST_THRESHOLD ((TSB_I2S_UNIPRO_TUNNEL_BUF_SZ - 256) / 4)
 
+/**
+ * @brief Jitter buffer headroom limits, in bytes.
+ *
+ * The headroom is how much of the previous buffer should still be waiting for
+ * the DMA when the next packet arrives from Unipro.  It grows with the measured
+ * arrival jitter and after every underrun, and slowly shrinks back towards the
+ * minimum so the latency stays as low as the link allows.
+ */
+#define TSB_I2S_UNIPRO_TUNNEL_JB_MARGIN_MIN (16)
+#define TSB_I2S_UNIPRO_TUNNEL_JB_MARGIN_MAX (TSB_I2S_UNIPRO_TUNNEL_BUF_SZ / 2)
+#define TSB_I2S_UNIPRO_TUNNEL_JB_MARGIN_INIT (TSB_I2S_UNIPRO_TUNNEL_JB_MARGIN_MAX / 2)
+
+/** @brief Headroom kept per byte of average arrival jitter. */
+#define TSB_I2S_UNIPRO_TUNNEL_JB_JITTER_MULT (4)
+
+/** @brief Packets between each one byte reduction of the headroom. */
+#define TSB_I2S_UNIPRO_TUNNEL_JB_RELEASE_PACKETS (64)
+
+/** @brief Averages are kept times 2^TSB_I2S_UNIPRO_TUNNEL_JB_SHIFT. */
+#define TSB_I2S_UNIPRO_TUNNEL_JB_SHIFT (4)
+
+/**
+ * @brief Average error, in samples, which results in one sample being inserted
+ *        or dropped per packet.
+ *
+ * The corrections are accumulated in 1/TSB_I2S_UNIPRO_TUNNEL_JB_ONE sample
+ * steps so that a small clock drift leads to an occasional single sample
+ * adjustment rather than bursts of them.
+ */
+#define TSB_I2S_UNIPRO_TUNNEL_JB_GAIN (32)
+#define TSB_I2S_UNIPRO_TUNNEL_JB_ONE (256)
+
 /**
  * @brief Select the next buffer to be used.
  *
@@ -234,6 +266,26 @@ struct tsb_i2s_unipro_tunnel_buf_s
     struct tsb_i2s_unipro_msg_s *msg;
 };
 
+/**
+ * @brief State of the adaptive jitter buffer on the I2S TX side.
+ */
+struct tsb_i2s_unipro_jb_s
+{
+    /**
+     * @brief Average arrival error in bytes (scaled by the shift).  Positive
+     *        when packets arrive later than the target.
+     */
+    int32_t err;
+    /** @brief Average absolute deviation from err in bytes (scaled). */
+    int32_t jitter;
+    /** @brief Accumulated fractional sample correction. */
+    int32_t drift;
+    /** @brief Current headroom in bytes. */
+    unsigned int margin;
+    /** @brief Packets since the headroom was last reduced. */
+    unsigned int packets;
+};
+
 /**
  * @brief Global storage for the I2S tunneled over Unipro driver.
  */
@@ -358,6 +410,8 @@ struct tsb_i2s_unipro_tunnel_s
      *        driver operation.
      */
     unsigned int i2s_tx_buffers_dropped;
+    /** @brief The adaptive jitter buffer used to compensate for clock drift. */
+    struct tsb_i2s_unipro_jb_s jb;
 } g_i2s_unipro_tunnel;
 
 /*
@@ -424,6 +478,119 @@ static int tsb_i2s_unipro_i2s_wait_set(uint32_t reg, uint32_t mask)
     return (failsafe == 0);
 }
 
+/*
+ * Reset the jitter buffer at the start of a stream.
+ */
+static void tsb_i2s_unipro_jb_reset(void)
+{
+    memset(&g_i2s_unipro_tunnel.jb, 0, sizeof(g_i2s_unipro_tunnel.jb));
+    g_i2s_unipro_tunnel.jb.margin = TSB_I2S_UNIPRO_TUNNEL_JB_MARGIN_INIT;
+}
+
+/*
+ * Called when the TX side ran out of data.  The headroom was too small for
+ * the current link jitter, so grow it by half.
+ */
+static void tsb_i2s_unipro_jb_underrun(void)
+{
+    struct tsb_i2s_unipro_jb_s *jb = &g_i2s_unipro_tunnel.jb;
+
+    jb->margin += jb->margin / 2 + 1;
+    if (jb->margin > TSB_I2S_UNIPRO_TUNNEL_JB_MARGIN_MAX)
+    {
+        jb->margin = TSB_I2S_UNIPRO_TUNNEL_JB_MARGIN_MAX;
+    }
+    jb->drift = 0;
+    jb->packets = 0;
+    reglog_log(0x34, jb->margin);
+}
+
+#if !defined(CONFIG_I2S_TUNNEL_LOCAL_LOOPBACK)
+/*
+ * Update the jitter buffer with the position of the TX DMA in the previous
+ * buffer when a packet is received, and decide if the packet should have a
+ * sample inserted or dropped to keep that position at the target.
+ *
+ * prev_bytes_sent The number of bytes of the previous buffer already sent.
+ *
+ * returns 1 to insert a sample, -1 to drop one and 0 to leave the packet as is.
+ */
+static int tsb_i2s_unipro_jb_adjust(size_t prev_bytes_sent)
+{
+    struct tsb_i2s_unipro_jb_s *jb = &g_i2s_unipro_tunnel.jb;
+    int32_t target = TSB_I2S_UNIPRO_TUNNEL_BUF_SZ - jb->margin;
+    int32_t err = (int32_t)prev_bytes_sent - target;
+    int32_t dev;
+    unsigned int wanted;
+
+    jb->err += err - (jb->err >> TSB_I2S_UNIPRO_TUNNEL_JB_SHIFT);
+    dev = err - (jb->err >> TSB_I2S_UNIPRO_TUNNEL_JB_SHIFT);
+    if (dev < 0)
+    {
+        dev = -dev;
+    }
+    jb->jitter += dev - (jb->jitter >> TSB_I2S_UNIPRO_TUNNEL_JB_SHIFT);
+
+    /* Grow the latency as soon as the jitter increases, shrink it slowly. */
+    wanted = TSB_I2S_UNIPRO_TUNNEL_JB_MARGIN_MIN +
+             TSB_I2S_UNIPRO_TUNNEL_JB_JITTER_MULT *
+             (jb->jitter >> TSB_I2S_UNIPRO_TUNNEL_JB_SHIFT);
+    if (wanted > TSB_I2S_UNIPRO_TUNNEL_JB_MARGIN_MAX)
+    {
+        wanted = TSB_I2S_UNIPRO_TUNNEL_JB_MARGIN_MAX;
+    }
+    if (wanted > jb->margin)
+    {
+        jb->margin = wanted;
+        jb->packets = 0;
+        reglog_log(0x34, jb->margin);
+    }
+    else if (++jb->packets >= TSB_I2S_UNIPRO_TUNNEL_JB_RELEASE_PACKETS)
+    {
+        jb->packets = 0;
+        if (jb->margin > wanted)
+        {
+            jb->margin--;
+        }
+    }
+
+    /*
+     * Far enough off the target that waiting for the averaged correction
+     * would underrun or keep adding latency, so correct right away.
+     */
+    if (err > (int32_t)jb->margin / 2)
+    {
+        jb->drift = 0;
+        return 1;
+    }
+    if (prev_bytes_sent < TSB_I2S_UNIPRO_TUNNEL_BUF_ADJUST_THRESHOLD)
+    {
+        jb->drift = 0;
+        return -1;
+    }
+
+    /*
+     * Otherwise spread the corrections out according to the average error,
+     * which follows the clock drift between the two sides.
+     */
+    jb->drift += (jb->err >> TSB_I2S_UNIPRO_TUNNEL_JB_SHIFT) *
+                 TSB_I2S_UNIPRO_TUNNEL_JB_ONE /
+                 (int32_t)(g_i2s_unipro_tunnel.bytes_per_sample *
+                           TSB_I2S_UNIPRO_TUNNEL_JB_GAIN);
+    if (jb->drift >= TSB_I2S_UNIPRO_TUNNEL_JB_ONE)
+    {
+        jb->drift -= TSB_I2S_UNIPRO_TUNNEL_JB_ONE;
+        return 1;
+    }
+    if (jb->drift <= -TSB_I2S_UNIPRO_TUNNEL_JB_ONE)
+    {
+        jb->drift += TSB_I2S_UNIPRO_TUNNEL_JB_ONE;
+        return -1;
+    }
+    return 0;
+}
+#endif
+
 /*
  * Restart the I2S data after an error.  This is risky as it could restart out
  * of sync with the other side.
@@ -690,6 +857,7 @@ static int tsb_i2s_unipro_i2s_out_error_handler(int irq, void *context)
          * TODO: Handle the output under run error by inserting a sample in the
          * output FIFO, unmutting and restarting the channel.
          */
+        tsb_i2s_unipro_jb_underrun();
         tsb_i2s_unipro_i2s_restart(TSB_I2S_REG_SO_BASE);
     }
     if (reg_intstat & TSB_I2S_REG_INT_OR)
@@ -788,6 +956,7 @@ static int tsb_i2s_unipro_cmd_handle_data(
     void *dma_dst;
     void *dma_src;
     size_t prev_bytes_sent;
+    int adjust;
     struct tsb_i2s_unipro_tunnel_buf_s *i2s_tx_buf_p =
         &g_i2s_unipro_tunnel.i2s_tx_unipro_rx_buf[g_i2s_unipro_tunnel.i2s_tx_buf];
     struct tsb_i2s_unipro_tunnel_buf_s *unipro_rx_buf_p =
@@ -838,11 +1007,12 @@ static int tsb_i2s_unipro_cmd_handle_data(
             prev_bytes_sent += TSB_I2S_UNIPRO_TUNNEL_BUF_SZ - i2s_tx_buf_p->len;
             reglog_log(0x31, (uint32_t)prev_bytes_sent);
         }
+        adjust = tsb_i2s_unipro_jb_adjust(prev_bytes_sent);
         /*
-         * If the number of samples sent so far is greater than the threshold,
-         * insert a sample from the data which will be sent out.
+         * If the packets are arriving late, insert a sample from the data
+         * which will be sent out.
          */
-        if (prev_bytes_sent > TSB_I2S_UNIPRO_TUNNEL_BUF_SZ - TSB_I2S_UNIPRO_TUNNEL_BUF_ADJUST_THRESHOLD)
+        if (adjust > 0)
         {
             memcpy(&unipro_rx_buf_p->msg->data.buf[unipro_rx_buf_p->len],
                    &unipro_rx_buf_p->msg->data.buf[unipro_rx_buf_p->len-g_i2s_unipro_tunnel.bytes_per_sample],
@@ -852,12 +1022,11 @@ static int tsb_i2s_unipro_cmd_handle_data(
             reglog_log(0x32, unipro_rx_buf_p->len);
         }
         /*
-         * If the number of samples left in the previous buffer is not within the
-         * threshold or fully copied into the FIFO by now, then a backlog of
-         * samples is starting.  Leave one sample off of the packet to allow the
-         * backlog to dissipate.
+         * If the packets are arriving early, a backlog of samples is
+         * starting.  Leave one sample off of the packet to allow the backlog
+         * to dissipate.
          */
-        else if (prev_bytes_sent < TSB_I2S_UNIPRO_TUNNEL_BUF_ADJUST_THRESHOLD)
+        else if (adjust < 0)
         {
             unipro_rx_buf_p->len -= g_i2s_unipro_tunnel.bytes_per_sample;
             g_i2s_unipro_tunnel.i2s_tx_samples_dropped++;
@@ -1056,6 +1225,7 @@ static int tsb_i2s_unipro_i2s_tx_dma_callback(
                                        curr_buf_p->dma_op);
             free_buf = false;
             g_i2s_unipro_tunnel.i2s_tx_samples_retransmitted += 10;
+            tsb_i2s_unipro_jb_underrun();
             reglog_log(0x2e, (uint32_t)curr_buf_p->msg);
         }
         irqrestore(flags);
@@ -1580,6 +1750,7 @@ int i2s_unipro_tunnel_arm(bool enable)
         g_i2s_unipro_tunnel.i2s_tx_samples_retransmitted = 0;
         g_i2s_unipro_tunnel.i2s_tx_samples_dropped = 0;
         g_i2s_unipro_tunnel.i2s_tx_buffers_dropped = 0;
+        tsb_i2s_unipro_jb_reset();
         reg_clk_sel = 0;
 
 #if !defined(CONFIG_I2S_TUNNEL_LOCAL_LOOPBACK)
@@ -1825,6 +1996,10 @@ int i2s_unipro_tunnel_unipro_register(void)
                                  TSB_I2S_UNIPRO_TUNNEL_CPORTID);
     if (ret == 0)
     {
+        /* Audio samples must not wait behind bulk transfers. */
+        (void)unipro_set_tx_class(TSB_I2S_UNIPRO_TUNNEL_CPORTID,
+                                  UNIPRO_TX_CLASS_ISOCHRONOUS);
+
         /* Only one side needs to make the point to point connection. */
 #if defined(CONFIG_UNIPRO_P2P_APBA)
         unipro_p2p_setup_connection(TSB_I2S_UNIPRO_TUNNEL_CPORTID);
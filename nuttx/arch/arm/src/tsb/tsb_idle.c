@@ -68,20 +68,68 @@
 #include <nuttx/config.h>
 
 #include <nuttx/arch.h>
+#include <nuttx/idle.h>
+#include <nuttx/util.h>
 #include "up_internal.h"
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/*
+ * The bridge has no deep sleep state the IDLE loop could use, so the
+ * governor only chooses between returning at once (when the next timer
+ * expiry is closer than a WFI round trip) and WFI.  Latencies are in
+ * microseconds and get replaced by the measured values.
+ */
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+#define IDLE_STATE_POLL     0
+#define IDLE_STATE_WFI      1
+
+#define IDLE_WFI_LATENCY    5
+#define IDLE_WFI_RESIDENCY  10
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+static struct idle_state_s g_idle_states[] = {
+    { "poll", 0,                0                  },
+    { "wfi",  IDLE_WFI_LATENCY, IDLE_WFI_RESIDENCY },
+};
+
+static struct idle_governor_s g_idle_gov = {
+    .states = g_idle_states,
+    .nstates = ARRAY_SIZE(g_idle_states),
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+/*
+ * Interrupts stay disabled across the sleep so the wakeup is timed before
+ * the timer interrupt handler runs.  A pending interrupt still ends WFI.
+ */
+static void tsb_idle_sleep(void)
+{
+    irqstate_t flags;
+
+    flags = irqsave();
+
+    if (idle_select(&g_idle_gov, IDLE_STATE_WFI) == IDLE_STATE_WFI) {
+        asm("WFI");
+    }
+
+    idle_reflect(&g_idle_gov);
+    irqrestore(flags);
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -157,7 +205,11 @@ void up_idle(void)
    * two approaches to resolving SW-425, with the hueristic that CONFIG_DEBUG
    * being enabled indicates a debug rather than production environment.
    */
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+  tsb_idle_sleep();
+#else
   asm("WFI");
 #endif
 #endif
+#endif
 }
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Sampling timer of the PC-sampling profiler (see sched/sched/sched_profile.c)
+ */
+
+#include <nuttx/config.h>
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/profile.h>
+
+#include <arch/irq.h>
+
+#include <errno.h>
+#include <stdint.h>
+
+#include "tsb_tmr.h"
+
+static struct tsb_tmr_ctx *profile_timer;
+
+/*
+ * The exception frame of the interrupted code is the context given to the
+ * handler by up_doirq(): take the PC and LR that the CPU stacked there.
+ */
+static int profile_isr(int irq, void *context)
+{
+    uint32_t *regs = context;
+
+    /* may still be pending when the timer was cancelled */
+    if (!profile_timer)
+        return OK;
+
+    tsb_tmr_ack_irq(profile_timer);
+    profile_sample((void *) regs[REG_PC], (void *) regs[REG_LR]);
+
+    return OK;
+}
+
+int up_profile_start(unsigned int rate)
+{
+    if (rate == 0 || rate > USEC_PER_SEC)
+        return -EINVAL;
+
+    profile_timer = tsb_tmr_get(CONFIG_TSB_PROFILE_TIMER);
+    if (!profile_timer)
+        return -ENODEV;
+
+    tsb_tmr_configure(profile_timer, TSB_TMR_MODE_PERIODIC, profile_isr);
+    tsb_tmr_set_time(profile_timer, USEC_PER_SEC / rate);
+    tsb_tmr_start(profile_timer);
+
+    return OK;
+}
+
+void up_profile_stop(void)
+{
+    if (!profile_timer)
+        return;
+
+    tsb_tmr_cancel(profile_timer);
+    profile_timer = NULL;
+}
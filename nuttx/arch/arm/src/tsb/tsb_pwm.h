@@ -57,14 +57,17 @@
 #define TSB_PWM_INTCONFIG     0x00000220
 #define   PWM_INTMODE0        (1 << 0)
 #define   PWM_INTMODE1        (1 << 1)
+#define   PWM_INTMODE(n)      (1 << (n))
 #define TSB_PWM_INTMASK       0x00000224
 #define   PWM_INTMASK0        (1 << 0)
 #define   PWM_INTMASK1        (1 << 1)
+#define   PWM_INTMASK(n)      (1 << (n))
 #define   PWM_ERRMASK0        (1 << 16)
 #define   PWM_ERRMASK1        (1 << 17)
 #define TSB_PWM_INTSTATUS     0x00000228
 #define   PWM_INTSTATUS0      (1 << 0)
 #define   PWM_INTSTATUS1      (1 << 1)
+#define   PWM_INTSTATUS(n)    (1 << (n))
 #define   PWM_ERRSTATUS0      (1 << 16)
 #define   PWM_ERRSTATUS1      (1 << 17)
 
@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <arch/irq.h>
 #include <nuttx/lib.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/device.h>
@@ -74,6 +75,18 @@ struct generator_info {
 
     /** The value for pulse of iteration output. */
     uint16_t pulse_count;
+
+    /** Duty cycles (in nanoseconds) streamed one per period, or NULL. */
+    const uint32_t *stream_buf;
+
+    /** Number of entries in stream_buf. */
+    uint16_t stream_len;
+
+    /** Next entry of stream_buf to load. */
+    uint16_t stream_pos;
+
+    /** Restart from the first entry after the last one. */
+    bool stream_repeat;
 };
 
 /**
@@ -108,6 +121,9 @@ struct pwm_ctlr_info {
 
     uint32_t int_state;
 
+    /** Generators currently fed by the period interrupt, indexed by number. */
+    struct generator_info *streams[TSB_GENERATOR_COUNTS];
+
     /** Power/clock refere count. */
     uint32_t refcount;
 
@@ -201,6 +217,51 @@ static struct generator_info *get_gntr_info(struct pwm_ctlr_info *info,
     return NULL;
 }
 
+/**
+ * @brief Convert a time in nanoseconds to generator clock ticks.
+ *
+ * @param dev_info Pointer to the generator_info structure.
+ * @param ns Time in nanoseconds.
+ *
+ * @return Number of generator clock ticks.
+ */
+static uint32_t tsb_pwm_ns_to_ticks(struct generator_info *dev_info,
+                                    uint32_t ns)
+{
+    return ns / (1000000000 / dev_info->pclk);
+}
+
+/**
+ * @brief Stop feeding duty cycles to a generator.
+ *
+ * Masks the period interrupt of the generator and forgets its stream buffer.
+ * The last loaded duty cycle stays in place.
+ *
+ * @param info Pointer to the pwm_ctlr_info structure.
+ * @param dev_info Pointer to the generator_info structure.
+ */
+static void tsb_pwm_stream_stop(struct pwm_ctlr_info *info,
+                                struct generator_info *dev_info)
+{
+    irqstate_t flags;
+    uint32_t reg_val;
+
+    if (!dev_info->stream_buf) {
+        return;
+    }
+
+    flags = irqsave();
+
+    reg_val = tsb_pwm_read(info->reg_base, TSB_PWM_INTMASK);
+    tsb_pwm_write(info->reg_base, TSB_PWM_INTMASK,
+                  reg_val | PWM_INTMASK(dev_info->which));
+
+    info->streams[dev_info->which] = NULL;
+    dev_info->stream_buf = NULL;
+
+    irqrestore(flags);
+}
+
 /**
  * @brief Stops a specific generator of toggling.
  *
@@ -240,6 +301,8 @@ static int tsb_pwm_op_disable(struct device *dev, uint16_t which)
         goto err_disable;
     }
 
+    tsb_pwm_stream_stop(info, dev_info);
+
     reg_cr = tsb_pwm_read(dev_info->gntr_base, TSB_PWM_CR);
     tsb_pwm_write(dev_info->gntr_base, TSB_PWM_CR, reg_cr & ~PWM_CR_ENB);
 
@@ -493,6 +556,8 @@ static int tsb_pwm_op_deactivate(struct device *dev, uint16_t which)
         goto no_deactivated;
     }
 
+    tsb_pwm_stream_stop(info, dev_info);
+
     if (dev_info->gntr_flag & TSB_PWM_FLAG_ENABLED) {
         reg_cr = tsb_pwm_read(dev_info->gntr_base, TSB_PWM_CR);
         tsb_pwm_write(dev_info->gntr_base, TSB_PWM_CR, reg_cr & ~PWM_CR_ENB);
@@ -581,6 +646,222 @@ err_config:
     return ret;
 }
 
+/**
+ * @brief Configure several generators at the same period boundary.
+ *
+ * This function validates every entry first, so either all generators are
+ * reconfigured or none is. New FREQ and DUTY values only go to the shadow
+ * registers; the UPD bits of all running generators are then set back to back
+ * with interrupts disabled, so their outputs switch together at the end of
+ * the current period instead of being stopped and restarted one by one.
+ * Generators that are not enabled yet are marked configured and pick the new
+ * values up in enable().
+ *
+ * @param dev Pointer to the device structure for PWM controller.
+ * @param entries Array of new settings, one per generator.
+ * @param count Number of entries in the array.
+ *
+ * @return 0: Success, error code on failure.
+ */
+static int tsb_pwm_op_config_multi(struct device *dev,
+                                   const struct pwm_config_entry *entries,
+                                   uint16_t count)
+{
+    struct pwm_ctlr_info *info = NULL;
+    struct generator_info *gntr[TSB_GENERATOR_COUNTS];
+    uint32_t set_freq[TSB_GENERATOR_COUNTS];
+    uint32_t set_duty[TSB_GENERATOR_COUNTS];
+    irqstate_t flags;
+    uint32_t reg_cr;
+    int ret = 0;
+    int i;
+
+    if (!dev || !device_get_private(dev) || !entries || !count ||
+        count > TSB_GENERATOR_COUNTS) {
+        return -EINVAL;
+    }
+
+    info = device_get_private(dev);
+
+    sem_wait(&info->op_mutex);
+
+    for (i = 0; i < count; i++) {
+        if (entries[i].which >= info->gntr_counts ||
+            entries[i].period == 0 || entries[i].duty == 0) {
+            ret = -EINVAL;
+            goto err_config_multi;
+        }
+
+        gntr[i] = get_gntr_info(info, entries[i].which);
+        if (!gntr[i]) {
+            ret = -EIO;
+            goto err_config_multi;
+        }
+
+        /* A generator fed by a stream owns its own duty cycle */
+        if (gntr[i]->stream_buf) {
+            ret = -EBUSY;
+            goto err_config_multi;
+        }
+
+        set_freq[i] = tsb_pwm_ns_to_ticks(gntr[i], entries[i].period);
+        set_duty[i] = tsb_pwm_ns_to_ticks(gntr[i], entries[i].duty);
+        if (set_freq[i] <= 1 || set_duty[i] > set_freq[i]) {
+            ret = -EINVAL;
+            goto err_config_multi;
+        }
+    }
+
+    for (i = 0; i < count; i++) {
+        tsb_pwm_write(gntr[i]->gntr_base, TSB_PWM_FREQ, set_freq[i]);
+        tsb_pwm_write(gntr[i]->gntr_base, TSB_PWM_DUTY, set_duty[i]);
+        gntr[i]->gntr_flag |= TSB_PWM_FLAG_CONFIGURED;
+    }
+
+    flags = irqsave();
+
+    for (i = 0; i < count; i++) {
+        if (gntr[i]->gntr_flag & TSB_PWM_FLAG_ENABLED) {
+            reg_cr = tsb_pwm_read(gntr[i]->gntr_base, TSB_PWM_CR);
+            tsb_pwm_write(gntr[i]->gntr_base, TSB_PWM_CR, reg_cr | PWM_CR_UPD);
+        }
+    }
+
+    irqrestore(flags);
+
+err_config_multi:
+    sem_post(&info->op_mutex);
+
+    return ret;
+}
+
+/**
+ * @brief Stream a sequence of duty cycles to a specific generator.
+ *
+ * The PWM controller has no DMA request line, so the stream is fed from the
+ * period interrupt: each time a period ends, the interrupt handler loads the
+ * next duty cycle into the shadow DUTY register and sets UPD, which the
+ * generator applies at the following period boundary. The buffer is owned by
+ * the caller and must stay valid until the stream ends or is stopped. If
+ * buffer is NULL, the current stream is stopped.
+ *
+ * @param dev Pointer to the device structure for PWM controller.
+ * @param which Specific PWM generator device number.
+ * @param duty Array of active times (in nanoseconds), or NULL to stop.
+ * @param count Number of entries in the array.
+ * @param repeat True to restart from the first entry after the last one.
+ *
+ * @return 0: Success, error code on failure.
+ */
+static int tsb_pwm_op_stream_duty(struct device *dev, uint16_t which,
+                                  const uint32_t *duty, uint16_t count,
+                                  bool repeat)
+{
+    struct pwm_ctlr_info *info = NULL;
+    struct generator_info *dev_info = NULL;
+    irqstate_t flags;
+    uint32_t set_freq;
+    uint32_t reg_val;
+    int ret = 0;
+    int i;
+
+    if (valid_param(dev, which) || (duty && !count)) {
+        return -EINVAL;
+    }
+
+    info = device_get_private(dev);
+
+    sem_wait(&info->op_mutex);
+
+    dev_info = get_gntr_info(info, which);
+    if (!dev_info) {
+        ret = -EIO;
+        goto err_stream;
+    }
+
+    tsb_pwm_stream_stop(info, dev_info);
+    if (!duty) {
+        goto err_stream;
+    }
+
+    if (!(dev_info->gntr_flag & TSB_PWM_FLAG_ENABLED)) {
+        ret = -EIO;
+        goto err_stream;
+    }
+
+    set_freq = tsb_pwm_read(dev_info->gntr_base, TSB_PWM_FREQ);
+    for (i = 0; i < count; i++) {
+        if (tsb_pwm_ns_to_ticks(dev_info, duty[i]) > set_freq) {
+            ret = -EINVAL;
+            goto err_stream;
+        }
+    }
+
+    flags = irqsave();
+
+    dev_info->stream_buf = duty;
+    dev_info->stream_len = count;
+    dev_info->stream_pos = 0;
+    dev_info->stream_repeat = repeat;
+    info->streams[which] = dev_info;
+
+    /* Interrupt at the end of every period rather than of the iteration */
+    reg_val = tsb_pwm_read(info->reg_base, TSB_PWM_INTCONFIG);
+    tsb_pwm_write(info->reg_base, TSB_PWM_INTCONFIG,
+                  reg_val & ~PWM_INTMODE(which));
+
+    tsb_pwm_write(info->reg_base, TSB_PWM_INTSTATUS, PWM_INTSTATUS(which));
+
+    reg_val = tsb_pwm_read(info->reg_base, TSB_PWM_INTMASK);
+    tsb_pwm_write(info->reg_base, TSB_PWM_INTMASK,
+                  reg_val & ~PWM_INTMASK(which));
+
+    irqrestore(flags);
+
+err_stream:
+    sem_post(&info->op_mutex);
+
+    return ret;
+}
+
+/**
+ * @brief Load the next streamed duty cycle of every fed generator.
+ *
+ * Called from the interrupt handler with the latched INTSTATUS value.
+ *
+ * @param info Pointer to the pwm_ctlr_info structure.
+ * @param status Interrupt status of the controller.
+ */
+static void tsb_pwm_stream_feed(struct pwm_ctlr_info *info, uint32_t status)
+{
+    struct generator_info *dev_info;
+    uint32_t reg_val;
+    int i;
+
+    for (i = 0; i < TSB_GENERATOR_COUNTS; i++) {
+        dev_info = info->streams[i];
+        if (!dev_info || !(status & PWM_INTSTATUS(i))) {
+            continue;
+        }
+
+        tsb_pwm_write(dev_info->gntr_base, TSB_PWM_DUTY,
+                      tsb_pwm_ns_to_ticks(dev_info,
+                          dev_info->stream_buf[dev_info->stream_pos]));
+        reg_val = tsb_pwm_read(dev_info->gntr_base, TSB_PWM_CR);
+        tsb_pwm_write(dev_info->gntr_base, TSB_PWM_CR, reg_val | PWM_CR_UPD);
+
+        if (++dev_info->stream_pos < dev_info->stream_len) {
+            continue;
+        }
+
+        if (dev_info->stream_repeat) {
+            dev_info->stream_pos = 0;
+        } else {
+            tsb_pwm_stream_stop(info, dev_info);
+        }
+    }
+}
+
 /**
  * @brief Start a specific generator of toggling.
  *
@@ -899,6 +1180,8 @@ static int tsb_pwm_irq_handler(int irq, void *context)
 
     info->int_state = tsb_pwm_read(info->reg_base, TSB_PWM_INTSTATUS);
 
+    tsb_pwm_stream_feed(info, info->int_state);
+
     if (info->handle) {
         info->handle(&info->int_state);
     }
@@ -978,6 +1261,8 @@ static void tsb_pwm_dev_close(struct device *dev)
         if (!dev_info) {
             continue;
         } else {
+            tsb_pwm_stream_stop(info, dev_info);
+
             /* If any of the generator was enabled, stop its output. */
             if (dev_info->gntr_flag & TSB_PWM_FLAG_ENABLED) {
                 reg_cr = tsb_pwm_read(dev_info->gntr_base, TSB_PWM_CR);
@@ -1136,6 +1421,12 @@ static struct device_pwm_type_ops tsb_pwm_type_ops = {
     /** Set Freq and duty for specific pulse output */
     .config       = tsb_pwm_op_config,
 
+    /** Set Freq and duty for several pulse outputs at once */
+    .config_multi = tsb_pwm_op_config_multi,
+
+    /** Feed duty cycles to a pulse output from the period interrupt */
+    .stream_duty  = tsb_pwm_op_stream_duty,
+
     /** Set a pulse of polarity output */
     .set_polarity = tsb_pwm_op_set_polarity,
 
@@ -57,8 +57,14 @@
 #define TSB_SCM_CHIPID2                 0x00000888
 #define TSB_IO_DRIVE_STRENGTH0          0x00000A00
 
+#define TSB_SCM_NREGS                   3
+#define CLK_INDEX(clk)                  ((((clk) >> 24) * 32) + ((clk) & 0x1f))
+
 static uint32_t pinshare_setting;
 
+/* Users of each clock, for tsb_clk_request() and tsb_clk_release() */
+static uint8_t clk_refcount[TSB_SCM_NREGS * 32];
+
 static uint32_t scm_read(uint32_t offset)
 {
     return getreg32(SYSCTL_BASE + offset);
@@ -89,6 +95,42 @@ void tsb_clk_disable(uint32_t clk)
     scm_write(TSB_SCM_CLOCKGATING0 + CLK_OFFSET(clk), CLK_MASK(clk));
 }
 
+/**
+ * Request a clock, reference counted
+ *
+ * Lets several drivers share a clock domain: the clock is enabled by the
+ * first request and gated by the last release.  Not to be mixed with
+ * tsb_clk_enable() and tsb_clk_disable() for the same clock.
+ *
+ * @param clk the TSB_CLK_* clock
+ */
+void tsb_clk_request(uint32_t clk)
+{
+    irqstate_t flags;
+
+    flags = irqsave();
+    DEBUGASSERT(clk_refcount[CLK_INDEX(clk)] < UINT8_MAX);
+    if (clk_refcount[CLK_INDEX(clk)]++ == 0)
+        tsb_clk_enable(clk);
+    irqrestore(flags);
+}
+
+/**
+ * Release a clock obtained with tsb_clk_request()
+ *
+ * @param clk the TSB_CLK_* clock
+ */
+void tsb_clk_release(uint32_t clk)
+{
+    irqstate_t flags;
+
+    flags = irqsave();
+    DEBUGASSERT(clk_refcount[CLK_INDEX(clk)] > 0);
+    if (clk_refcount[CLK_INDEX(clk)] && --clk_refcount[CLK_INDEX(clk)] == 0)
+        tsb_clk_disable(clk);
+    irqrestore(flags);
+}
+
 uint32_t tsb_clk_status(uint32_t clk)
 {
     return scm_read(TSB_SCM_CLOCKENABLE0 + CLK_OFFSET(clk)) & CLK_MASK(clk);
@@ -1336,7 +1336,7 @@ static void sdio_write_fifo_data(struct tsb_sdio_info *info)
     uint32_t data_mask = BUFFER_READ_ENABLE | BUFFER_WRITE_ENABLE |
                          READ_TRANSFER_ACTIVE | WRITE_TRANSFER_ACTIVE |
                          DAT_LINE_ACTIVE | COMMAND_INHIBIT_DAT;
-    int16_t remaining = 0, i = 0;
+    int16_t remaining = 0, i = 0, words;
     uint8_t *wbuf = info->write_buf.buffer;
 
     presentstate = sdio_getreg(info->sdio_reg_base, PRESENTSTATE);
@@ -1360,29 +1360,42 @@ static void sdio_write_fifo_data(struct tsb_sdio_info *info)
                              BUFFER_WRITE_RDY);
 
             /*
-             * Is there at least a full uint32_t data remaining in the user
-             * buffer?
+             * Buffer write enable means that there is room for a whole
+             * block, so write all of its words without polling the present
+             * state for each. Odd block sizes go word by word.
              */
-            remaining = info->write_buf.tail - info->write_buf.head;
-            if (remaining >= sizeof(uint32_t)) {
-                /* Yes. Write uint32_t data to the FIFO */
-                buf_port = wbuf[info->write_buf.head] |
-                           wbuf[info->write_buf.head + 1] << BYTE_SHIFT |
-                           wbuf[info->write_buf.head + 2] << (BYTE_SHIFT * 2) |
-                           wbuf[info->write_buf.head + 3] << (BYTE_SHIFT * 3);
-                info->write_buf.head += sizeof(uint32_t);
-            } else {
+            words = (info->blksz % sizeof(uint32_t)) ? 1 :
+                    info->blksz / sizeof(uint32_t);
+            while (words-- > 0 &&
+                   info->write_buf.head != info->write_buf.tail) {
                 /*
-                 * No. Write the bytes remaining in the user buffer to the
-                 * FIFO
+                 * Is there at least a full uint32_t data remaining in the
+                 * user buffer?
                  */
-                for (i = 0; i < remaining; i++) {
-                    buf_port |= wbuf[info->write_buf.head + i] <<
-                                (BYTE_SHIFT * i);
+                remaining = info->write_buf.tail - info->write_buf.head;
+                if (remaining >= sizeof(uint32_t)) {
+                    /* Yes. Write uint32_t data to the FIFO */
+                    buf_port = wbuf[info->write_buf.head] |
+                               wbuf[info->write_buf.head + 1] << BYTE_SHIFT |
+                               wbuf[info->write_buf.head + 2] <<
+                                   (BYTE_SHIFT * 2) |
+                               wbuf[info->write_buf.head + 3] <<
+                                   (BYTE_SHIFT * 3);
+                    info->write_buf.head += sizeof(uint32_t);
+                } else {
+                    /*
+                     * No. Write the bytes remaining in the user buffer to
+                     * the FIFO
+                     */
+                    buf_port = 0;
+                    for (i = 0; i < remaining; i++) {
+                        buf_port |= wbuf[info->write_buf.head + i] <<
+                                    (BYTE_SHIFT * i);
+                    }
+                    info->write_buf.head = info->write_buf.tail;
                 }
-                info->write_buf.head = info->write_buf.tail;
+                sdio_putreg(info->sdio_reg_base, DATAPORTREG, buf_port);
             }
-            sdio_putreg(info->sdio_reg_base, DATAPORTREG, buf_port);
 
             /* More blocks? */
             if (info->write_buf.head == info->write_buf.tail) { /* No */
@@ -1413,7 +1426,7 @@ static void sdio_read_fifo_data(struct tsb_sdio_info *info)
     uint32_t data_mask = BUFFER_READ_ENABLE | BUFFER_WRITE_ENABLE |
                          READ_TRANSFER_ACTIVE | WRITE_TRANSFER_ACTIVE |
                          DAT_LINE_ACTIVE | COMMAND_INHIBIT_DAT;
-    int16_t remaining = 0, i = 0;
+    int16_t remaining = 0, i = 0, words;
     uint8_t *rbuf = info->read_buf.buffer;
 
     presentstate = sdio_getreg(info->sdio_reg_base, PRESENTSTATE);
@@ -1437,31 +1450,41 @@ static void sdio_read_fifo_data(struct tsb_sdio_info *info)
                              BUFFER_READ_RDY);
 
             /*
-             * Is there at least a full uint32_t data remaining in the user
-             * buffer?
+             * Buffer read enable means that a whole block is available, so
+             * read all of its words without polling the present state for
+             * each. Odd block sizes go word by word.
              */
-            remaining = info->read_buf.tail - info->read_buf.head;
-            buf_port = sdio_getreg(info->sdio_reg_base, DATAPORTREG);
-            if (remaining >= sizeof(uint32_t)) {
-                /* Yes. Transfer uint32_t data in FIFO to the user buffer */
-                rbuf[info->read_buf.head] = (uint8_t)buf_port;
-                rbuf[info->read_buf.head + 1] =
+            words = (info->blksz % sizeof(uint32_t)) ? 1 :
+                    info->blksz / sizeof(uint32_t);
+            while (words-- > 0 &&
+                   info->read_buf.head != info->read_buf.tail) {
+                /*
+                 * Is there at least a full uint32_t data remaining in the
+                 * user buffer?
+                 */
+                remaining = info->read_buf.tail - info->read_buf.head;
+                buf_port = sdio_getreg(info->sdio_reg_base, DATAPORTREG);
+                if (remaining >= sizeof(uint32_t)) {
+                    /* Yes. Transfer uint32_t data in FIFO to the user buffer */
+                    rbuf[info->read_buf.head] = (uint8_t)buf_port;
+                    rbuf[info->read_buf.head + 1] =
                                         (uint8_t)(buf_port >> (BYTE_SHIFT * 1));
-                rbuf[info->read_buf.head + 2] =
+                    rbuf[info->read_buf.head + 2] =
                                         (uint8_t)(buf_port >> (BYTE_SHIFT * 2));
-                rbuf[info->read_buf.head + 3] =
+                    rbuf[info->read_buf.head + 3] =
                                         (uint8_t)(buf_port >> (BYTE_SHIFT * 3));
-                info->read_buf.head += sizeof(uint32_t);
-            } else {
-                /*
-                 * No. Transfer the bytes remaining in FIFO to the user
-                 * buffer
-                 */
-                for (i = 0; i < remaining; i++) {
-                    rbuf[info->read_buf.head + i] =
+                    info->read_buf.head += sizeof(uint32_t);
+                } else {
+                    /*
+                     * No. Transfer the bytes remaining in FIFO to the user
+                     * buffer
+                     */
+                    for (i = 0; i < remaining; i++) {
+                        rbuf[info->read_buf.head + i] =
                                         (uint8_t)(buf_port >> (BYTE_SHIFT * i));
+                    }
+                    info->read_buf.head = info->read_buf.tail;
                 }
-                info->read_buf.head = info->read_buf.tail;
             }
 
             /* More blocks? */
@@ -86,6 +86,23 @@ struct tsb_spi_info {
     sem_t               lock;
 };
 
+/*
+ * The SPI master and slave clocks.  With runtime PM they are only enabled
+ * while the bus is locked (and shortly after), otherwise while the device
+ * is open.
+ */
+static void tsb_spi_clk_on(void)
+{
+    tsb_clk_request(TSB_CLK_SPIP);
+    tsb_clk_request(TSB_CLK_SPIS);
+}
+
+static void tsb_spi_clk_off(void)
+{
+    tsb_clk_release(TSB_CLK_SPIP);
+    tsb_clk_release(TSB_CLK_SPIS);
+}
+
 static uint32_t spi_read(int offset)
 {
     return getreg32(SPI_BASE + offset);
@@ -130,6 +147,12 @@ static int tsb_spi_lock(struct device *dev)
          */
         return -get_errno();
     }
+
+    ret = device_pm_get(dev);
+    if (ret) {
+        sem_post(&info->bus);
+        return ret;
+    }
     info->state = TSB_SPI_STATE_LOCKED;
 
     return 0;
@@ -153,6 +176,7 @@ static int tsb_spi_unlock(struct device *dev)
     info = device_get_private(dev);
 
     info->state = TSB_SPI_STATE_OPEN;
+    device_pm_put(dev);
     sem_post(&info->bus);
     return 0;
 }
@@ -541,7 +565,7 @@ static int tsb_spi_exchange(struct device *dev,
                              struct device_spi_transfer *transfer)
 {
     struct tsb_spi_info *info = NULL;
-    int i = 0, ret = 0;
+    int ret = 0;
     uint8_t *txbuf = NULL, *rxbuf = NULL;
 
 
@@ -568,29 +592,26 @@ static int tsb_spi_exchange(struct device *dev,
     txbuf = transfer->txbuffer;
     rxbuf = transfer->rxbuffer;
 
-    if (transfer->nwords > TSB_SPIB0_PRG_SEC_DAT_SIZE &&
-         transfer->nwords <= TSB_SPIB0_PRG_PRI_DAT_SIZE +
-                              TSB_SPIB0_PRG_SEC_DAT_SIZE) {
-        /* If the transfer is bigger than the secondary buffer, but can fit
-           in both the primary and secondary buffers, then use them both. */
-        __tsb_spi_exchange_dual(dev, txbuf, rxbuf, transfer->nwords);
+    if (transfer->nwords <= TSB_SPIB0_PRG_SEC_DAT_SIZE) {
+        __tsb_spi_exchange_single(dev, txbuf, rxbuf, transfer->nwords);
     } else {
-        /* If the transfer is bigger than the primary and secondary buffers,
-           then do multiple transfers using the secondary buffer.
-           NOTE: Each iteration will toggle the HW CS.  Use GPIO CS if CS
+        /* If the transfer is bigger than the secondary buffer, use both the
+           primary and secondary buffers for each cycle, and do as many
+           cycles as needed for transfers bigger than both buffers.
+           NOTE: Each cycle will toggle the HW CS.  Use GPIO CS if CS
            has to be active for the entire transfer. */
-        int num_iterations = transfer->nwords / TSB_SPIB0_PRG_SEC_DAT_SIZE;
-        for (i=0; i < num_iterations; i++) {
-            __tsb_spi_exchange_single(dev, txbuf, rxbuf,
-                                          TSB_SPIB0_PRG_SEC_DAT_SIZE);
-
-            txbuf += TSB_SPIB0_PRG_SEC_DAT_SIZE;
-            rxbuf += TSB_SPIB0_PRG_SEC_DAT_SIZE;
-        }
-
-        int remainder = transfer->nwords % TSB_SPIB0_PRG_SEC_DAT_SIZE;
-        if (remainder) {
-            __tsb_spi_exchange_single(dev, txbuf, rxbuf, remainder);
+        size_t remaining = transfer->nwords;
+        while (remaining > 0) {
+            int nbytes = MIN(remaining, TSB_SPIB0_PRG_PRI_DAT_SIZE +
+                                        TSB_SPIB0_PRG_SEC_DAT_SIZE);
+
+            __tsb_spi_exchange_dual(dev, txbuf, rxbuf, nbytes);
+
+            txbuf += nbytes;
+            if (rxbuf) {
+                rxbuf += nbytes;
+            }
+            remaining -= nbytes;
         }
     }
 #else
@@ -601,6 +622,7 @@ static int tsb_spi_exchange(struct device *dev,
      */
 
     /* for test only */
+    int i;
     txbuf = transfer->txbuffer;
     rxbuf = transfer->rxbuffer;
     for (i=0; i < transfer->nwords; i++) {
@@ -706,9 +728,6 @@ static int tsb_spi_dev_open(struct device *dev)
     }
     info = device_get_private(dev);
 
-    tsb_clk_enable(TSB_CLK_SPIP);
-    tsb_clk_enable(TSB_CLK_SPIS);
-
     sem_wait(&info->lock);
 
     if (info->state != TSB_SPI_STATE_CLOSED) {
@@ -717,6 +736,10 @@ static int tsb_spi_dev_open(struct device *dev)
     }
     info->state = TSB_SPI_STATE_OPEN;
 
+#ifndef CONFIG_DEVICE_RUNTIME_PM
+    tsb_spi_clk_on();
+#endif
+
 err_unlock:
     sem_post(&info->lock);
     return ret;
@@ -742,14 +765,41 @@ static void tsb_spi_dev_close(struct device *dev)
     }
     info = device_get_private(dev);
 
-    tsb_clk_disable(TSB_CLK_SPIP);
-    tsb_clk_disable(TSB_CLK_SPIS);
-
     sem_wait(&info->lock);
+#ifndef CONFIG_DEVICE_RUNTIME_PM
+    if (info->state != TSB_SPI_STATE_CLOSED)
+        tsb_spi_clk_off();
+#endif
     info->state = TSB_SPI_STATE_CLOSED;
     sem_post(&info->lock);
 }
 
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+/**
+ * @brief Gate the SPI clocks, the bus being idle
+ *
+ * @param dev pointer to structure of device data
+ * @return 0 on success
+ */
+static int tsb_spi_dev_runtime_suspend(struct device *dev)
+{
+    tsb_spi_clk_off();
+    return 0;
+}
+
+/**
+ * @brief Restore the SPI clocks before the bus is used
+ *
+ * @param dev pointer to structure of device data
+ * @return 0 on success
+ */
+static int tsb_spi_dev_runtime_resume(struct device *dev)
+{
+    tsb_spi_clk_on();
+    return 0;
+}
+#endif
+
 /**
  * @brief Probe SPI device
  *
@@ -814,6 +864,10 @@ static int tsb_spi_dev_probe(struct device *dev)
     device_set_private(dev, info);
     sem_init(&info->bus, 0, 1);
     sem_init(&info->lock, 0, 1);
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+    /* Probed active, the device core suspends it when left idle */
+    tsb_spi_clk_on();
+#endif
     irqrestore(flags);
     return 0;
 
@@ -848,6 +902,10 @@ static void tsb_spi_dev_remove(struct device *dev)
 
     flags = irqsave();
     irq_detach(TSB_IRQ_SPI);
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+    /* The device core resumed it before the removal */
+    tsb_spi_clk_off();
+#endif
     info->state = TSB_SPI_STATE_INVALID;
     sem_destroy(&info->lock);
     sem_destroy(&info->bus);
@@ -873,6 +931,10 @@ static struct device_driver_ops tsb_spi_driver_ops = {
     .remove         = tsb_spi_dev_remove,
     .open           = tsb_spi_dev_open,
     .close          = tsb_spi_dev_close,
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+    .runtime_suspend = tsb_spi_dev_runtime_suspend,
+    .runtime_resume = tsb_spi_dev_runtime_resume,
+#endif
     .type_ops       = &tsb_spi_type_ops,
 };
 
@@ -29,6 +29,7 @@
  */
 
 #include "tsb_tmr.h"
+#include "tsb_fr_tmr.h"
 
 #include <sys/time.h>
 
@@ -82,6 +83,10 @@ void up_timer_initialize(void)
      * scheduler calls up_timer_cancel() so we're stuck with this mode.
      */
     tsb_tmr_configure(tickless_timer, TSB_TMR_MODE_FREERUN, tickless_isr);
+
+#ifdef CONFIG_TSB_CLOCKSOURCE
+    tsb_clocksource_initialize();
+#endif
 }
 
 int up_timer_gettime(struct timespec *ts)
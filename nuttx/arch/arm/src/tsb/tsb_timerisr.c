@@ -38,6 +38,7 @@
 
 #include "nvic.h"
 #include "up_arch.h"
+#include "tsb_fr_tmr.h"
 
 /* 96 MHz */
 #define         CLOCK_FREQUENCY         96000000
@@ -155,6 +156,10 @@ void up_timer_initialize(void)
              NVIC_SYSTICK_CTRL_TICKINT   |
              NVIC_SYSTICK_CTRL_ENABLE,
              NVIC_SYSTICK_CTRL);
+
+#ifdef CONFIG_TSB_CLOCKSOURCE
+    tsb_clocksource_initialize();
+#endif
 }
 
 /*
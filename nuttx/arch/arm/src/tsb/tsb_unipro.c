@@ -363,7 +363,7 @@ static int irq_rx_eom(int irq, void *context) {
         newbuf = unipro_rxbuf_alloc(cport->cportid);
         if (newbuf) {
             unipro_switch_rxbuf(cport->cportid, newbuf);
-            unipro_unpause_rx(cport->cportid);
+            unipro_rxbuf_ready(cport->cportid);
         } else {
             cport->switch_buf_on_free = true;
         }
@@ -379,31 +379,14 @@ static int irq_rx_eom(int irq, void *context) {
 static int tsb_unipro_mbox_ack(uint16_t val);
 
 /**
- * @brief See ENG-376.
- *
- * We use a mailbox notification from the SVC to solve a race condition
- * involving FCT transmission. When the SVC makes a connection, it sets all the
- * relevant DME parameters as defined in MIPI UniPro 1.6, then pokes the
- * bridge mailbox, telling it that it is safe to send FCTs on a given CPort.
+ * @brief Turn on FCT for a CPort the peer has connected
  */
-static int mailbox_evt(void)
+static int mailbox_enable_cport(uint32_t cportid)
 {
-    uint32_t cportid;
     int rc;
     uint32_t e2efc;
     uint32_t val;
 
-    DBG_UNIPRO("mailbox interrupt received\n");
-
-    /*
-     * Figure out which CPort to turn on FCT. The desired CPort is always
-     * the mailbox value - 1.
-     */
-    rc = unipro_attr_local_read(TSB_MAILBOX, &cportid, 0);
-    if (rc) {
-        return rc;
-    }
-    cportid--;
     if (cportid >= cport_count) {
         DBG_UNIPRO("cportid %d in mailbox exceeds count of cports %d\n",
                    cportid, cport_count);
@@ -428,14 +411,58 @@ static int mailbox_evt(void)
     }
 
     configure_connected_cport(cportid);
+    return 0;
+}
 
-    /* Acknowledge the mailbox write */
-    rc = tsb_unipro_mbox_ack(cportid + 1);
+/**
+ * @brief See ENG-376.
+ *
+ * We use a mailbox notification from the SVC to solve a race condition
+ * involving FCT transmission. When the SVC makes a connection, it sets all the
+ * relevant DME parameters as defined in MIPI UniPro 1.6, then pokes the
+ * bridge mailbox, telling it that it is safe to send FCTs on a given CPort.
+ */
+static int mailbox_evt(void)
+{
+    uint32_t cportid;
+    uint32_t map;
+    uint32_t val;
+    int rc;
+
+    DBG_UNIPRO("mailbox interrupt received\n");
+
+    rc = unipro_attr_local_read(TSB_MAILBOX, &val, 0);
     if (rc) {
         return rc;
     }
 
-    return 0;
+    if (val & TSB_MAIL_CPORT_BATCH) {
+        /* Enable every CPort of the group, then acknowledge them at once */
+        cportid = TSB_MAIL_CPORT_BATCH_GROUP(val) * 8;
+        for (map = TSB_MAIL_CPORT_BATCH_MAP(val); map; map >>= 1, cportid++) {
+            if (map & 1) {
+                rc = mailbox_enable_cport(cportid);
+                if (rc) {
+                    return rc;
+                }
+            }
+        }
+
+        return tsb_unipro_mbox_ack(TSB_MAIL_CPORT_BATCH_ACK(val));
+    }
+
+    /*
+     * Figure out which CPort to turn on FCT. The desired CPort is always
+     * the mailbox value - 1.
+     */
+    cportid = val - 1;
+    rc = mailbox_enable_cport(cportid);
+    if (rc) {
+        return rc;
+    }
+
+    /* Acknowledge the mailbox write */
+    return tsb_unipro_mbox_ack(cportid + 1);
 }
 #endif
 
@@ -443,6 +470,8 @@ static void unipro_evt_handler(enum unipro_event evt)
 {
     DBG_UNIPRO("UniPro: event %d.\n", evt);
 
+    unipro_link_stats_event(evt);
+
     switch (evt) {
     case UNIPRO_EVT_MAILBOX:
 #if !CONFIG_UNIPRO_P2P_APBA
@@ -464,6 +493,14 @@ static void unipro_evt_handler(enum unipro_event evt)
     }
 }
 
+/**
+ * @brief Pass an event raised outside of the UniPro interrupt to the handler
+ */
+void unipro_notify_event(enum unipro_event evt)
+{
+    unipro_evt_handler(evt);
+}
+
 static int irq_unipro(int irq, void *context) {
     int rc;
     uint32_t val;
@@ -539,6 +576,69 @@ int unipro_unpause_rx(unsigned int cportid)
     return 0;
 }
 
+/**
+ * @brief Restart RX on a CPort that has been given a new RX buffer
+ *
+ * The CPort stays paused if unipro_rx_pause() has been called, until
+ * unipro_rx_resume().
+ */
+void unipro_rxbuf_ready(unsigned int cportid)
+{
+    struct cport *cport = cport_handle(cportid);
+    irqstate_t flags;
+
+    if (!cport)
+        return;
+
+    flags = irqsave();
+    if (cport->rx_hold) {
+        cport->rx_held = true;
+        irqrestore(flags);
+        return;
+    }
+    irqrestore(flags);
+
+    unipro_unpause_rx(cportid);
+}
+
+/**
+ * @brief Stop receiving on a CPort
+ *
+ * The CPort pauses at the end of the message being received, the sender is
+ * then flow controlled by UniPro.
+ */
+int unipro_rx_pause(unsigned int cportid)
+{
+    struct cport *cport = cport_handle(cportid);
+
+    if (!cport)
+        return -EINVAL;
+
+    cport->rx_hold = true;
+    return 0;
+}
+
+/**
+ * @brief Restart receiving on a CPort paused by unipro_rx_pause()
+ */
+int unipro_rx_resume(unsigned int cportid)
+{
+    struct cport *cport = cport_handle(cportid);
+    irqstate_t flags;
+    bool held;
+
+    if (!cport)
+        return -EINVAL;
+
+    flags = irqsave();
+    cport->rx_hold = false;
+    held = cport->rx_held;
+    cport->rx_held = false;
+    irqrestore(flags);
+
+    return held ? unipro_unpause_rx(cportid) : 0;
+}
+
 static void configure_transfer_mode(int mode) {
     /*
      * Set transfer mode 2
@@ -757,6 +857,10 @@ static int unipro_init_cport(unsigned int cportid)
     cport->max_inflight_buf_count = CONFIG_TSB_UNIPRO_MAX_INFLIGHT_BUFCOUNT;
 #endif
     cport->switch_buf_on_free = false;
+    cport->rx_hold = false;
+    cport->rx_held = false;
+
+    unipro_rxbuf_pool_fill(cportid);
 
     cport->rx_buf = unipro_rxbuf_alloc(cportid);
     if (!cport->rx_buf) {
@@ -980,6 +1084,28 @@ int unipro_reset_cport(unsigned int cportid, cport_reset_completion_cb_t cb,
     return 0;
 }
 
+/**
+ * @brief Set the TX traffic class of a CPort
+ * @param cportid cport to configure
+ * @param tx_class traffic class used by the TX scheduler
+ * @return 0 on success, <0 on error
+ */
+int unipro_set_tx_class(unsigned int cportid, enum unipro_tx_class tx_class)
+{
+    struct cport *cport;
+
+    if (tx_class >= UNIPRO_TX_CLASS_COUNT)
+        return -EINVAL;
+
+    cport = cport_handle(cportid);
+    if (!cport)
+        return -EINVAL;
+
+    cport->tx_class = tx_class;
+
+    return 0;
+}
+
 /**
  * @brief Enable the cport registers
  * @param cportid cport number to associate this driver to
@@ -64,8 +64,17 @@ struct cport {
     atomic_t inflight_buf_count;
     size_t max_inflight_buf_count;
     bool switch_buf_on_free;
+    bool rx_hold;                   // unipro_rx_pause() requested
+    bool rx_held;                   // RX buffer ready, waiting for resume
 
     struct list_head tx_fifo;
+    enum unipro_tx_class tx_class;
+
+#ifdef CONFIG_TSB_UNIPRO_RXBUF_POOL
+    void *rxpool;                   // free RX buffers, last freed first
+    unsigned int rxpool_count;
+    bool rxpool_enabled;
+#endif
 };
 
 struct cport *cport_handle(unsigned int cportid);
@@ -74,7 +83,20 @@ int unipro_tx_init(void);
 int _unipro_reset_cport(unsigned int cportid);
 void unipro_reset_notify(unsigned int cportid);
 void unipro_switch_rxbuf(unsigned int cportid, void *buffer);
+#ifdef CONFIG_TSB_UNIPRO_RXBUF_POOL
+void unipro_rxbuf_pool_fill(unsigned int cportid);
+#else
+static inline void unipro_rxbuf_pool_fill(unsigned int cportid) {}
+#endif
 int unipro_unpause_rx(unsigned int cportid);
+void unipro_rxbuf_ready(unsigned int cportid);
+void unipro_notify_event(enum unipro_event evt);
+
+#ifdef CONFIG_UNIPRO_LINK_STATS
+void unipro_link_stats_event(enum unipro_event evt);
+#else
+static inline void unipro_link_stats_event(enum unipro_event evt) {}
+#endif
 
 #endif /* __TSB_UNIPRO_H__ */
 
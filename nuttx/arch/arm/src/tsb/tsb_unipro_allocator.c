@@ -36,6 +36,105 @@
 #include <nuttx/bufram.h>
 #include <nuttx/unipro/unipro.h>
 #include <nuttx/arch.h>
+#include <nuttx/wqueue.h>
+
+#define RXBUF_PAGE_COUNT bufram_size_to_page_count(CPORT_BUF_SIZE)
+
+#ifdef CONFIG_TSB_UNIPRO_RXBUF_POOL
+#ifdef CONFIG_SCHED_LPWORK
+#   define RXPOOL_WORK LPWORK
+#else
+#   define RXPOOL_WORK HPWORK
+#endif
+
+/* Overlay used to chain the free buffers of a pool */
+struct rxpool_buf {
+    struct rxpool_buf *next;
+};
+
+static struct work_s rxpool_work;
+
+static void *rxpool_pop(struct cport *cport)
+{
+    struct rxpool_buf *buf;
+    irqstate_t flags;
+
+    flags = irqsave();
+    buf = cport->rxpool;
+    if (buf) {
+        cport->rxpool = buf->next;
+        cport->rxpool_count--;
+    }
+    irqrestore(flags);
+
+    return buf;
+}
+
+static bool rxpool_push(struct cport *cport, void *ptr)
+{
+    struct rxpool_buf *buf = ptr;
+    irqstate_t flags;
+
+    flags = irqsave();
+    if (!cport->rxpool_enabled ||
+        cport->rxpool_count >= CONFIG_TSB_UNIPRO_RXBUF_POOL_SIZE) {
+        irqrestore(flags);
+        return false;
+    }
+
+    buf->next = cport->rxpool;
+    cport->rxpool = buf;
+    cport->rxpool_count++;
+    irqrestore(flags);
+
+    return true;
+}
+
+static void rxpool_fill(struct cport *cport)
+{
+    void *buf;
+
+    while (cport->rxpool_count < CONFIG_TSB_UNIPRO_RXBUF_POOL_SIZE) {
+        buf = bufram_page_alloc(RXBUF_PAGE_COUNT);
+        if (!buf)
+            return;
+
+        if (!rxpool_push(cport, buf)) {
+            bufram_page_free(buf, RXBUF_PAGE_COUNT);
+            return;
+        }
+    }
+}
+
+static void rxpool_refill_worker(void *arg)
+{
+    struct cport *cport;
+    unsigned int i;
+
+    for (i = 0; i < unipro_cport_count(); i++) {
+        cport = cport_handle(i);
+        if (cport && cport->rxpool_enabled &&
+            cport->rxpool_count < CONFIG_TSB_UNIPRO_RXBUF_POOL_LOW_WATERMARK) {
+            rxpool_fill(cport);
+        }
+    }
+}
+
+/**
+ * @brief Enable the RX buffer pool of a CPort and pre-fill it
+ * @param cportid CPort whose pool to fill
+ */
+void unipro_rxbuf_pool_fill(unsigned int cportid)
+{
+    struct cport *cport = cport_handle(cportid);
+
+    if (!cport)
+        return;
+
+    cport->rxpool_enabled = true;
+    rxpool_fill(cport);
+}
+#endif
 
 int unipro_set_max_inflight_rxbuf_count(unsigned int cportid,
                                         size_t max_inflight_buf)
@@ -62,7 +161,19 @@ void *unipro_rxbuf_alloc(unsigned int cportid)
         return NULL;
     }
 
-    buf = bufram_page_alloc(bufram_size_to_page_count(CPORT_BUF_SIZE));
+#ifdef CONFIG_TSB_UNIPRO_RXBUF_POOL
+    buf = rxpool_pop(cport);
+    if (cport->rxpool_enabled &&
+        cport->rxpool_count < CONFIG_TSB_UNIPRO_RXBUF_POOL_LOW_WATERMARK &&
+        work_available(&rxpool_work)) {
+        work_queue(RXPOOL_WORK, &rxpool_work, rxpool_refill_worker, NULL, 0);
+    }
+#else
+    buf = NULL;
+#endif
+
+    if (!buf)
+        buf = bufram_page_alloc(RXBUF_PAGE_COUNT);
     if (!buf)
         return NULL;
 
@@ -86,12 +197,18 @@ void unipro_rxbuf_free(unsigned int cportid, void *ptr)
         irqrestore(flags);
 
         unipro_switch_rxbuf(cportid, ptr);
-        unipro_unpause_rx(cportid);
+        unipro_rxbuf_ready(cportid);
         return;
     }
 
     irqrestore(flags);
 
     atomic_dec(&cport->inflight_buf_count);
-    bufram_page_free(ptr, bufram_size_to_page_count(CPORT_BUF_SIZE));
+
+#ifdef CONFIG_TSB_UNIPRO_RXBUF_POOL
+    if (rxpool_push(cport, ptr))
+        return;
+#endif
+
+    bufram_page_free(ptr, RXBUF_PAGE_COUNT);
 }
@@ -108,14 +108,18 @@ void unipro_reset(void) {
     tsb_reset(TSB_RST_UNIPROSYS);
 }
 
-static int unipro_mbox_enable_cport(uint32_t cport) {
+/* CPorts waiting for their mailbox notification, see unipro_p2p_batch_begin() */
+static bool mbox_batch_open;
+static uint64_t mbox_batch_cports;
+
+static int unipro_mbox_post(uint32_t mail, uint32_t ack) {
     int rc = unipro_attr_peer_write(MBOX_ACK_ATTR, TSB_MAIL_RESET, 0 /* selector */);
     if (rc) {
         lldbg("MBOX_ACK_ATTR write failed: %d\n", rc);
         return rc;
     }
 
-    rc = unipro_attr_peer_write(TSB_MAILBOX, (cport + 1), 0 /* selector */);
+    rc = unipro_attr_peer_write(TSB_MAILBOX, mail, 0 /* selector */);
     if (rc) {
         lldbg("TSB_MAILBOX write failed: %d\n", rc);
         return rc;
@@ -129,7 +133,7 @@ static int unipro_mbox_enable_cport(uint32_t cport) {
             lldbg("%s(): MBOX_ACK_ATTR poll failed: %d\n", __func__, rc);
             return rc;
         }
-    } while (val != (cport + 1) && --retries > 0);
+    } while (val != ack && --retries > 0);
 
     if (!retries) {
         return -ETIMEDOUT;
@@ -138,6 +142,34 @@ static int unipro_mbox_enable_cport(uint32_t cport) {
     return rc;
 }
 
+static int unipro_mbox_enable_cport(uint32_t cport) {
+    return unipro_mbox_post(cport + 1, cport + 1);
+}
+
+static int unipro_mbox_enable_cports(unsigned int group, uint8_t map) {
+    uint32_t mail = TSB_MAIL_CPORT_BATCH_VAL(group, map);
+    unsigned int cport;
+    int rc;
+
+    rc = unipro_mbox_post(mail, TSB_MAIL_CPORT_BATCH_ACK(mail));
+    if (rc != -ETIMEDOUT) {
+        return rc;
+    }
+
+    /* The peer might not know about batches, go one CPort at a time */
+    lldbg("CPort batch 0x%08x not acknowledged\n", mail);
+    for (cport = group * 8; map; map >>= 1, cport++) {
+        if (map & 1) {
+            rc = unipro_mbox_enable_cport(cport);
+            if (rc) {
+                return rc;
+            }
+        }
+    }
+
+    return 0;
+}
+
 uint32_t unipro_p2p_get_boot_status(void) {
     uint32_t boot_status = INIT_STATUS_UNINITIALIZED;
     int rc = unipro_attr_peer_read(DME_DDBL2_INIT_STATUS, &boot_status, 0 /* selector */);
@@ -218,7 +250,50 @@ void unipro_p2p_setup_connection(unsigned int cport) {
     unipro_enable_cport(cport);
 
     /* Notify the remote to configure it's cport registers. */
-    unipro_mbox_enable_cport(cport);
+    if (mbox_batch_open && cport < TSB_MAIL_CPORT_BATCH_GROUPS * 8) {
+        mbox_batch_cports |= (uint64_t)1 << cport;
+    } else {
+        unipro_mbox_enable_cport(cport);
+    }
+}
+
+/**
+ * @brief Defer the peer notification of the connections being set up
+ *
+ * Each CPort connection must be announced to the peer through its mailbox,
+ * which is a full handshake over the link. Between unipro_p2p_batch_begin()
+ * and unipro_p2p_batch_end(), unipro_p2p_setup_connection() only records the
+ * CPort and the announcements are sent with one handshake per group of 8
+ * CPorts. No traffic must be sent on these CPorts before the batch is ended.
+ */
+void unipro_p2p_batch_begin(void) {
+    mbox_batch_open = true;
+    mbox_batch_cports = 0;
+}
+
+int unipro_p2p_batch_end(void) {
+    unsigned int group;
+    uint8_t map;
+    int rc;
+    int ret = 0;
+
+    mbox_batch_open = false;
+
+    for (group = 0; group < TSB_MAIL_CPORT_BATCH_GROUPS; group++) {
+        map = (mbox_batch_cports >> (group * 8)) & 0xff;
+        if (!map) {
+            continue;
+        }
+
+        rc = unipro_mbox_enable_cports(group, map);
+        if (rc) {
+            lldbg("Failed to enable CPort group %u: %d\n", group, rc);
+            ret = rc;
+        }
+    }
+
+    mbox_batch_cports = 0;
+    return ret;
 }
 
 void unipro_p2p_reset_connection(unsigned int cport) {
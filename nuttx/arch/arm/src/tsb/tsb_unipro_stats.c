@@ -0,0 +1,364 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+/*
+ * UniPro P2P link health: error events are counted from the UniPro interrupt,
+ * the PACP error counter and the negotiated gears are sampled periodically
+ * while the link is up. A link that keeps producing errors is reported with
+ * UNIPRO_EVT_LINK_DEGRADED so that the owner of the link can retrain it.
+ */
+
+#include <nuttx/config.h>
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+#include <nuttx/unipro/unipro.h>
+
+#include <arch/irq.h>
+#include <arch/chip/unipro_p2p.h>
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "tsb_unipro.h"
+
+#define LINK_STATS_PERIOD       MSEC2TICK(CONFIG_UNIPRO_LINK_STATS_PERIOD)
+#define LINK_STATS_THRESHOLD    CONFIG_UNIPRO_LINK_STATS_RETRAIN_THRESHOLD
+
+static struct unipro_link_stats link_stats;
+static struct work_s link_stats_work;
+
+/* Error total at the previous sample, to evaluate the errors per period */
+static uint32_t link_stats_last_errors;
+static uint32_t link_stats_last_pacp;
+static unsigned int link_stats_last_rank;
+
+static uint32_t link_stats_errors(const struct unipro_link_stats *stats)
+{
+    return stats->phy_errors + stats->pa_errors + stats->dl_errors +
+           stats->pa_init_errors + stats->pacp_errors;
+}
+
+/*
+ * Order gears by throughput: any HS gear is faster than any PWM gear and the
+ * slower direction decides how fast the link is.
+ */
+static unsigned int link_stats_rank(uint32_t pwrmode, uint32_t tx_gear,
+                                    uint32_t rx_gear)
+{
+    unsigned int tx_rank = tx_gear;
+    unsigned int rx_rank = rx_gear;
+
+    switch (pwrmode & 0xf) {
+    case UNIPRO_FAST_MODE:
+    case UNIPRO_FASTAUTO_MODE:
+        tx_rank += 8;
+        break;
+    }
+
+    switch ((pwrmode >> 4) & 0xf) {
+    case UNIPRO_FAST_MODE:
+    case UNIPRO_FASTAUTO_MODE:
+        rx_rank += 8;
+        break;
+    }
+
+    return tx_rank < rx_rank ? tx_rank : rx_rank;
+}
+
+static void link_stats_sample(void *arg)
+{
+    uint32_t pacp, pwrmode, tx_gear, rx_gear;
+    uint32_t errors, delta;
+    unsigned int rank;
+    irqstate_t flags;
+    bool degraded = false;
+
+    if (!unipro_p2p_is_link_up())
+        return;
+
+    /*
+     * The PACP error counter is not cleared here since the test mode uses
+     * it too, so accumulate the difference and restart from a lower value.
+     */
+    if (!unipro_attr_local_read(PA_PACPERRORCOUNT, &pacp, 0)) {
+        flags = irqsave();
+        link_stats.pacp_errors += pacp >= link_stats_last_pacp ?
+                                  pacp - link_stats_last_pacp : pacp;
+        irqrestore(flags);
+        link_stats_last_pacp = pacp;
+    }
+
+    if (!unipro_attr_local_read(PA_PWRMODE, &pwrmode, 0) &&
+        !unipro_attr_local_read(PA_TXGEAR, &tx_gear, 0) &&
+        !unipro_attr_local_read(PA_RXGEAR, &rx_gear, 0)) {
+        rank = link_stats_rank(pwrmode, tx_gear, rx_gear);
+
+        flags = irqsave();
+        if (rank < link_stats_last_rank)
+            link_stats.downshifts++;
+        link_stats.pwrmode = pwrmode;
+        link_stats.tx_gear = tx_gear;
+        link_stats.rx_gear = rx_gear;
+        irqrestore(flags);
+
+        link_stats_last_rank = rank;
+    }
+
+    flags = irqsave();
+    errors = link_stats_errors(&link_stats);
+    delta = errors - link_stats_last_errors;
+    if (LINK_STATS_THRESHOLD > 0 && delta >= LINK_STATS_THRESHOLD) {
+        link_stats.degraded++;
+        degraded = true;
+    }
+    irqrestore(flags);
+
+    link_stats_last_errors = errors;
+
+    if (degraded) {
+        lldbg("UniPro link degraded: %u errors in %u ms\n",
+              delta, CONFIG_UNIPRO_LINK_STATS_PERIOD);
+        unipro_notify_event(UNIPRO_EVT_LINK_DEGRADED);
+    }
+
+    work_queue(LPWORK, &link_stats_work, link_stats_sample, NULL,
+               LINK_STATS_PERIOD);
+}
+
+/**
+ * @brief Account a UniPro event
+ *
+ * Called from the UniPro interrupt for every event, before it is passed to
+ * the registered event handler.
+ */
+void unipro_link_stats_event(enum unipro_event evt)
+{
+    switch (evt) {
+    case UNIPRO_EVT_LUP_DONE:
+        /* A new link starts from its own gears */
+        link_stats_last_rank = 0;
+        if (work_available(&link_stats_work))
+            work_queue(LPWORK, &link_stats_work, link_stats_sample, NULL,
+                       LINK_STATS_PERIOD);
+        break;
+    case UNIPRO_EVT_LINK_LOST:
+        link_stats.link_lost++;
+        break;
+    case UNIPRO_EVT_PWRMODE:
+        link_stats.pwrmode_changes++;
+        break;
+    case UNIPRO_EVT_PHY_ERROR:
+        link_stats.phy_errors++;
+        break;
+    case UNIPRO_EVT_PA_ERROR:
+        link_stats.pa_errors++;
+        break;
+    case UNIPRO_EVT_D_ERROR:
+        link_stats.dl_errors++;
+        break;
+    case UNIPRO_EVT_N_ERROR:
+        link_stats.n_errors++;
+        break;
+    case UNIPRO_EVT_T_ERROR:
+        link_stats.t_errors++;
+        break;
+    case UNIPRO_EVT_PAINIT_ERROR:
+        link_stats.pa_init_errors++;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Get a snapshot of the link statistics
+ *
+ * @param stats Filled with the current counters
+ */
+void unipro_link_stats_get(struct unipro_link_stats *stats)
+{
+    irqstate_t flags;
+
+    flags = irqsave();
+    *stats = link_stats;
+    irqrestore(flags);
+}
+
+void unipro_link_stats_reset(void)
+{
+    struct unipro_link_stats *stats = &link_stats;
+    irqstate_t flags;
+
+    /* Keep the current gears, they are not counters */
+    flags = irqsave();
+    stats->phy_errors = 0;
+    stats->pa_errors = 0;
+    stats->dl_errors = 0;
+    stats->n_errors = 0;
+    stats->t_errors = 0;
+    stats->pa_init_errors = 0;
+    stats->pacp_errors = 0;
+    stats->link_lost = 0;
+    stats->pwrmode_changes = 0;
+    stats->downshifts = 0;
+    stats->degraded = 0;
+    link_stats_last_errors = 0;
+    irqrestore(flags);
+}
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_UNIPRO)
+
+#define LINK_STATS_BUFLEN   384
+
+struct link_stats_file_s {
+    struct procfs_file_s base;
+    size_t len;
+    char buf[LINK_STATS_BUFLEN];
+};
+
+static int link_stats_open(FAR struct file *filep, FAR const char *relpath,
+                           int oflags, mode_t mode)
+{
+    FAR struct link_stats_file_s *priv;
+
+    priv = kmm_zalloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    filep->f_priv = priv;
+    return OK;
+}
+
+static int link_stats_close(FAR struct file *filep)
+{
+    kmm_free(filep->f_priv);
+    filep->f_priv = NULL;
+    return OK;
+}
+
+static ssize_t link_stats_read(FAR struct file *filep, FAR char *buffer,
+                               size_t buflen)
+{
+    FAR struct link_stats_file_s *priv = filep->f_priv;
+    struct unipro_link_stats stats;
+    off_t offset;
+    ssize_t ret;
+
+    /* Take a snapshot on the first read so that the content stays stable */
+    if (filep->f_pos == 0) {
+        unipro_link_stats_get(&stats);
+
+        priv->len = snprintf(priv->buf, LINK_STATS_BUFLEN,
+                             "link %s\n"
+                             "gear tx %u rx %u pwrmode 0x%02x\n"
+                             "phy_errors %u\npa_errors %u\ndl_errors %u\n"
+                             "n_errors %u\nt_errors %u\npa_init_errors %u\n"
+                             "pacp_errors %u\nlink_lost %u\n"
+                             "pwrmode_changes %u\ndownshifts %u\n"
+                             "degraded %u\n",
+                             unipro_p2p_is_link_up() ? "up" : "down",
+                             (unsigned int) stats.tx_gear,
+                             (unsigned int) stats.rx_gear,
+                             (unsigned int) stats.pwrmode,
+                             (unsigned int) stats.phy_errors,
+                             (unsigned int) stats.pa_errors,
+                             (unsigned int) stats.dl_errors,
+                             (unsigned int) stats.n_errors,
+                             (unsigned int) stats.t_errors,
+                             (unsigned int) stats.pa_init_errors,
+                             (unsigned int) stats.pacp_errors,
+                             (unsigned int) stats.link_lost,
+                             (unsigned int) stats.pwrmode_changes,
+                             (unsigned int) stats.downshifts,
+                             (unsigned int) stats.degraded);
+        if (priv->len >= LINK_STATS_BUFLEN)
+            priv->len = LINK_STATS_BUFLEN - 1;
+    }
+
+    offset = filep->f_pos;
+    ret = procfs_memcpy(priv->buf, priv->len, buffer, buflen, &offset);
+    if (ret > 0)
+        filep->f_pos += ret;
+
+    return ret;
+}
+
+/* Writing anything resets the counters */
+static ssize_t link_stats_write(FAR struct file *filep,
+                                FAR const char *buffer, size_t buflen)
+{
+    unipro_link_stats_reset();
+    return buflen;
+}
+
+static int link_stats_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+    FAR struct link_stats_file_s *priv;
+
+    priv = kmm_malloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    memcpy(priv, oldp->f_priv, sizeof(*priv));
+    newp->f_priv = priv;
+    return OK;
+}
+
+static int link_stats_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+    buf->st_mode    = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+    buf->st_size    = 0;
+    buf->st_blksize = 0;
+    buf->st_blocks  = 0;
+    return OK;
+}
+
+/* See fs_procfs.c -- this structure is explicitly externed there */
+const struct procfs_operations unipro_link_procfsoperations = {
+    link_stats_open,    /* open */
+    link_stats_close,   /* close */
+    link_stats_read,    /* read */
+    link_stats_write,   /* write */
+
+    link_stats_dup,     /* dup */
+
+    NULL,               /* opendir */
+    NULL,               /* closedir */
+    NULL,               /* readdir */
+    NULL,               /* rewinddir */
+
+    link_stats_stat     /* stat */
+};
+#endif
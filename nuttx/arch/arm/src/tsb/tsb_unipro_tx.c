@@ -29,10 +29,12 @@
 #include <errno.h>
 #include <pthread.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <nuttx/util.h>
 #include <nuttx/irq.h>
 #include <nuttx/arch.h>
+#include <nuttx/clock.h>
 #include <nuttx/list.h>
 #include <nuttx/unipro/unipro.h>
 
@@ -40,9 +42,24 @@
 #include "up_arch.h"
 #include "tsb_unipro.h"
 
+/*
+ * Maximum number of CPorts tracked by the TX worker pending bitmap. This is
+ * larger than what any bridge provides (see unipro_cport_count()).
+ */
+#define UNIPRO_TX_MAX_CPORTS    64
+#define UNIPRO_TX_PENDING_WORDS ((UNIPRO_TX_MAX_CPORTS + 31) / 32)
+
+/*
+ * The hardware does not raise an interrupt when TX FIFO space becomes
+ * available, so after this many passes without any progress on any pending
+ * CPort, the worker sleeps for a tick instead of spinning.
+ */
+#define UNIPRO_TX_FULL_RETRIES  16
+
 struct worker {
     pthread_t thread;
     sem_t tx_fifo_lock;
+    uint32_t pending[UNIPRO_TX_PENDING_WORDS]; /* CPorts with work to do */
 };
 
 static struct worker worker;
@@ -51,15 +68,39 @@ struct unipro_buffer {
     struct list_head list;
     unipro_send_completion_t callback;
     void *priv;
+    unsigned int cportid;
     bool som;
     int byte_sent;
     int len;
     const void *data;
 };
 
+/*
+ * Fixed pool of TX buffer descriptors for each CPort, allocated once by
+ * unipro_tx_init(). slots counts the descriptors left in free_list.
+ */
+struct unipro_tx_pool {
+    struct list_head free_list;
+    sem_t slots;
+};
+
+static struct unipro_tx_pool *tx_pools;
+static struct unipro_buffer *tx_buffers;
+
 static int unipro_send_sync(unsigned int cportid,
                             const void *buf, size_t len, bool som);
 
+/**
+ * @brief           Flag a CPort as having TX work for the worker
+ * @param[in]       cportid: CPort ID
+ *
+ * Must be called with interrupts disabled.
+ */
+static inline void unipro_tx_set_pending(unsigned int cportid)
+{
+    worker.pending[cportid / 32] |= 1 << (cportid % 32);
+}
+
 /**
  * @brief           Set EOM (End Of Message) flag
  * @param[in]       cport: CPort handle
@@ -69,6 +110,50 @@ static inline void unipro_set_eom_flag(struct cport *cport)
     putreg8(1, CPORT_EOM_BIT(cport));
 }
 
+/**
+ * @brief           Take a TX buffer descriptor from the pool of a CPort
+ * @return          descriptor, NULL if the pool is empty and !block
+ * @param[in]       cportid: CPort ID
+ * @param[in]       block: wait for a descriptor to be released if none is
+ *                  available
+ */
+static struct unipro_buffer *unipro_get_tx_buffer(unsigned int cportid,
+                                                  bool block)
+{
+    struct unipro_tx_pool *pool = &tx_pools[cportid];
+    struct unipro_buffer *buffer;
+    irqstate_t flags;
+
+    if (block) {
+        while (sem_wait(&pool->slots) < 0);
+    } else if (sem_trywait(&pool->slots) < 0) {
+        return NULL;
+    }
+
+    flags = irqsave();
+    buffer = list_entry(pool->free_list.next, struct unipro_buffer, list);
+    list_del(&buffer->list);
+    irqrestore(flags);
+
+    memset(buffer, 0, sizeof(*buffer));
+    list_init(&buffer->list);
+    buffer->cportid = cportid;
+
+    return buffer;
+}
+
+static void unipro_put_tx_buffer(struct unipro_buffer *buffer)
+{
+    struct unipro_tx_pool *pool = &tx_pools[buffer->cportid];
+    irqstate_t flags;
+
+    flags = irqsave();
+    list_add(&pool->free_list, &buffer->list);
+    irqrestore(flags);
+
+    sem_post(&pool->slots);
+}
+
 static void unipro_dequeue_tx_buffer(struct unipro_buffer *buffer, int status)
 {
     irqstate_t flags;
@@ -83,7 +168,7 @@ static void unipro_dequeue_tx_buffer(struct unipro_buffer *buffer, int status)
         buffer->callback(status, buffer->data, buffer->priv);
     }
 
-    free(buffer);
+    unipro_put_tx_buffer(buffer);
 }
 
 static void unipro_flush_cport(struct cport *cport)
@@ -121,7 +206,9 @@ reset:
  * @return          0 on success, -EINVAL on invalid parameter,
  *                  -EBUSY when buffer could not be completely transferred
  *                  (unipro_send_tx_buffer() shall be called again until
- *                  buffer is entirely sent (return value == 0)).
+ *                  buffer is entirely sent (return value == 0)),
+ *                  -EAGAIN when nothing could be sent because the TX FIFO
+ *                  is full.
  * @param[in]       operation: greybus loopback operation
  */
 static int unipro_send_tx_buffer(struct cport *cport)
@@ -161,6 +248,10 @@ static int unipro_send_tx_buffer(struct cport *cport)
         return -EINVAL;
     }
 
+    if (retval == 0) {
+        return -EAGAIN;
+    }
+
     buffer->som = false;
     buffer->byte_sent += retval;
 
@@ -175,35 +266,78 @@ static int unipro_send_tx_buffer(struct cport *cport)
 
 /**
  * @brief           Send data buffer(s) on CPort whenever ready.
- *                  Ensure that TX queues are reinspected until
- *                  all CPorts have no work available.
+ *                  Only the CPorts flagged in the pending bitmap are
+ *                  inspected, until none of them has work available.
  *                  Then suspend again until new data is available.
  */
 static void *unipro_tx_worker(void *data)
 {
-    int i;
+    uint32_t pending[UNIPRO_TX_PENDING_WORDS];
+    unsigned int cportid;
+    struct cport *cport;
+    irqstate_t flags;
+    int full_passes;
     bool is_busy;
+    bool progress;
     int retval;
-    unsigned int cport_count = unipro_cport_count();
+    int i;
 
     while (1) {
         /* Block until a buffer is pending on any CPort */
         sem_wait(&worker.tx_fifo_lock);
 
+        full_passes = 0;
+
         do {
             is_busy = false;
-
-            for (i = 0; i < cport_count; i++) {
-                /* Browse all CPorts sending any pending buffers */
-                retval = unipro_send_tx_buffer(cport_handle(i));
-                if (retval == -EBUSY) {
-                    /*
-                     * Buffer only partially sent, have to try again for
-                     * remaining part.
-                     */
-                    is_busy = true;
+            progress = false;
+
+            flags = irqsave();
+            memcpy(pending, worker.pending, sizeof(pending));
+            irqrestore(flags);
+
+            for (i = 0; i < UNIPRO_TX_PENDING_WORDS; i++) {
+                while (pending[i]) {
+                    cportid = i * 32 + __builtin_ctz(pending[i]);
+                    pending[i] &= pending[i] - 1;
+
+                    cport = cport_handle(cportid);
+                    retval = unipro_send_tx_buffer(cport);
+                    if (retval == -EBUSY) {
+                        /*
+                         * Buffer only partially sent, have to try again for
+                         * remaining part.
+                         */
+                        is_busy = true;
+                        progress = true;
+                        continue;
+                    } else if (retval == -EAGAIN) {
+                        /* TX FIFO full, try again later */
+                        is_busy = true;
+                        continue;
+                    }
+
+                    progress = true;
+
+                    /* Done with this CPort unless more work got queued */
+                    flags = irqsave();
+                    if (!cport || (list_is_empty(&cport->tx_fifo) &&
+                                   !cport->pending_reset)) {
+                        worker.pending[i] &= ~(1 << (cportid % 32));
+                    } else {
+                        is_busy = true;
+                    }
+                    irqrestore(flags);
                 }
             }
+
+            if (progress) {
+                full_passes = 0;
+            } else if (is_busy && ++full_passes >= UNIPRO_TX_FULL_RETRIES) {
+                /* Every pending CPort has a full TX FIFO: let it drain */
+                usleep(USEC_PER_TICK);
+                full_passes = 0;
+            }
         } while (is_busy); /* exit when CPort(s) current pending buffer sent */
     }
 
@@ -212,16 +346,23 @@ static void *unipro_tx_worker(void *data)
 
 void unipro_reset_notify(unsigned int cportid)
 {
+    irqstate_t flags;
+
     /*
      * if the tx worker is blocked on the semaphore, post something on it
      * in order to unlock it and have the reset happen right away.
      */
+    flags = irqsave();
+    unipro_tx_set_pending(cportid);
+    irqrestore(flags);
+
     sem_post(&worker.tx_fifo_lock);
 }
 
 /**
  * @brief           send data over UniPro asynchronously (not blocking)
- * @return          0 on success, <0 otherwise
+ * @return          0 on success, -EAGAIN if the CPort has too many pending
+ *                  messages already, <0 otherwise
  * @param[in]       cportid: target CPort ID
  * @param[in]       buf: data buffer
  * @param[in]       len: data buffer length (in bytes)
@@ -255,11 +396,10 @@ int unipro_send_async(unsigned int cportid, const void *buf, size_t len,
 
     DEBUGASSERT(TRANSFER_MODE == 2);
 
-    buffer = zalloc(sizeof(*buffer));
+    buffer = unipro_get_tx_buffer(cportid, false);
     if (!buffer) {
-        return -ENOMEM;
+        return -EAGAIN;
     }
-    list_init(&buffer->list);
     buffer->som = true;
     buffer->len = len;
     buffer->callback = callback;
@@ -268,6 +408,7 @@ int unipro_send_async(unsigned int cportid, const void *buf, size_t len,
 
     flags = irqsave();
     list_add(&cport->tx_fifo, &buffer->list);
+    unipro_tx_set_pending(cportid);
     irqrestore(flags);
 
     sem_post(&worker.tx_fifo_lock);
@@ -316,6 +457,175 @@ int unipro_send(unsigned int cportid, const void *buf, size_t len)
     return 0;
 }
 
+/**
+ * @brief send a single message gathered from several buffers down a CPort
+ * @param cportid cport to send down
+ * @param bufs data buffers, sent back to back in one message
+ * @param lens data buffer lengths (in bytes)
+ * @param count number of buffers
+ * @param 0 on success, <0 on error
+ *
+ * The buffers are copied one after the other into the CPort TX buffer, so
+ * the caller does not need to coalesce them first.
+ */
+int unipro_sendv(unsigned int cportid, const void * const bufs[],
+                 const size_t lens[], size_t count)
+{
+    int ret;
+    size_t i, sent, len;
+    bool som;
+    struct cport *cport;
+
+    for (i = 0, len = 0; i < count; i++) {
+        len += lens[i];
+    }
+
+    if (len > CPORT_BUF_SIZE) {
+        return -EINVAL;
+    }
+
+    cport = cport_handle(cportid);
+    if (!cport) {
+        return -EINVAL;
+    }
+
+    if (cport->pending_reset) {
+        return -EPIPE;
+    }
+
+    som = true;
+    for (i = 0; i < count; i++) {
+        for (sent = 0; sent < lens[i];) {
+            ret = unipro_send_sync(cportid, (const uint8_t *)bufs[i] + sent,
+                                   lens[i] - sent, som);
+            if (ret < 0) {
+                return ret;
+            } else if (ret == 0) {
+                continue;
+            }
+            sent += ret;
+            som = false;
+        }
+    }
+
+    unipro_set_eom_flag(cport);
+
+    return 0;
+}
+
+struct unipro_xfer_batch_sync {
+    sem_t lock;
+    size_t pending;
+    int retval;
+};
+
+static int unipro_send_batch_cb(int status, const void *buf, void *priv)
+{
+    struct unipro_xfer_batch_sync *sync = priv;
+    irqstate_t flags;
+    bool done;
+
+    flags = irqsave();
+    if (status && !sync->retval)
+        sync->retval = status;
+    done = --sync->pending == 0;
+    irqrestore(flags);
+
+    if (done)
+        sem_post(&sync->lock);
+
+    return 0;
+}
+
+/**
+ * @brief           send several messages over UniPro and wait for completion
+ * @return          0 on success, <0 otherwise (first error encountered)
+ * @param[in]       cportid: target CPort ID
+ * @param[in]       bufs: data buffers, each one sent as a separate message
+ * @param[in]       lens: data buffer lengths (in bytes)
+ * @param[in]       count: number of buffers
+ *
+ * All messages are queued at once and the TX worker is woken up only once,
+ * instead of once per message like with unipro_send().
+ */
+static void unipro_queue_tx_batch(struct cport *cport, struct list_head *batch)
+{
+    struct list_head *iter, *iter_next;
+    irqstate_t flags;
+
+    if (list_is_empty(batch))
+        return;
+
+    flags = irqsave();
+    list_foreach_safe(batch, iter, iter_next) {
+        list_del(iter);
+        list_add(&cport->tx_fifo, iter);
+    }
+    unipro_tx_set_pending(cport->cportid);
+    irqrestore(flags);
+
+    sem_post(&worker.tx_fifo_lock);
+}
+
+int unipro_send_batch(unsigned int cportid, const void * const bufs[],
+                      const size_t lens[], size_t count)
+{
+    struct unipro_xfer_batch_sync sync;
+    struct list_head batch;
+    struct unipro_buffer *buffer;
+    struct cport *cport;
+    size_t i;
+
+    if (!count)
+        return 0;
+
+    cport = cport_handle(cportid);
+    if (!cport)
+        return -EINVAL;
+
+    if (cport->pending_reset)
+        return -EPIPE;
+
+    if (!cport->connected) {
+        lldbg("CP%u unconnected\n", cport->cportid);
+        return -EPIPE;
+    }
+
+    for (i = 0; i < count; i++) {
+        if (lens[i] > CPORT_BUF_SIZE)
+            return -EINVAL;
+    }
+
+    sem_init(&sync.lock, 0, 0);
+    sync.pending = count;
+    sync.retval = 0;
+    list_init(&batch);
+
+    for (i = 0; i < count; i++) {
+        buffer = unipro_get_tx_buffer(cportid, false);
+        if (!buffer) {
+            /* Pool exhausted: start sending what we have, then wait */
+            unipro_queue_tx_batch(cport, &batch);
+            buffer = unipro_get_tx_buffer(cportid, true);
+        }
+
+        buffer->som = true;
+        buffer->data = bufs[i];
+        buffer->len = lens[i];
+        buffer->callback = unipro_send_batch_cb;
+        buffer->priv = &sync;
+
+        list_add(&batch, &buffer->list);
+    }
+
+    unipro_queue_tx_batch(cport, &batch);
+
+    sem_wait(&sync.lock);
+    sem_destroy(&sync.lock);
+
+    return sync.retval;
+}
+
 /**
  * @brief           Send data down to a CPort
  * @return          number of bytes effectively sent (>= 0), or error code (< 0)
@@ -372,11 +682,57 @@ static int unipro_send_sync(unsigned int cportid,
     return (int) count;
 }
 
+int unipro_get_tx_class_stats(enum unipro_tx_class tx_class,
+                              struct unipro_tx_class_stats *stats)
+{
+    /* Traffic classes are only scheduled by the DMA TX path */
+    return -ENOSYS;
+}
+
+static int unipro_tx_pools_init(void)
+{
+    unsigned int cport_count = unipro_cport_count();
+    struct unipro_buffer *buffer;
+    unsigned int i, j;
+
+    tx_pools = zalloc(cport_count * sizeof(*tx_pools));
+    tx_buffers = zalloc(cport_count * CONFIG_ARCH_UNIPROTX_DESC_PER_CPORT *
+                        sizeof(*tx_buffers));
+    if (!tx_pools || !tx_buffers) {
+        free(tx_pools);
+        free(tx_buffers);
+        tx_pools = NULL;
+        tx_buffers = NULL;
+        return -ENOMEM;
+    }
+
+    buffer = tx_buffers;
+    for (i = 0; i < cport_count; i++) {
+        list_init(&tx_pools[i].free_list);
+        sem_init(&tx_pools[i].slots, 0, CONFIG_ARCH_UNIPROTX_DESC_PER_CPORT);
+
+        for (j = 0; j < CONFIG_ARCH_UNIPROTX_DESC_PER_CPORT; j++, buffer++) {
+            list_init(&buffer->list);
+            list_add(&tx_pools[i].free_list, &buffer->list);
+        }
+    }
+
+    return 0;
+}
+
 int unipro_tx_init(void)
 {
     int retval;
 
+    DEBUGASSERT(unipro_cport_count() <= UNIPRO_TX_MAX_CPORTS);
+
+    retval = unipro_tx_pools_init();
+    if (retval) {
+        return retval;
+    }
+
     sem_init(&worker.tx_fifo_lock, 0, 0);
+    memset(worker.pending, 0, sizeof(worker.pending));
 
     retval = pthread_create(&worker.thread, NULL, unipro_tx_worker, NULL);
     if (retval) {
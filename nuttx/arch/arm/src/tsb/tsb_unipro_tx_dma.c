@@ -30,7 +30,9 @@
 
 #include <errno.h>
 #include <pthread.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <nuttx/util.h>
 #include <nuttx/irq.h>
@@ -49,6 +51,9 @@
 
 #define UNIPRO_DMA_CHANNEL_COUNT CONFIG_ARCH_UNIPROTX_DMA_NUM_CHANNELS
 
+#define USEC_PER_SEC  1000000
+#define NSEC_PER_USEC 1000
+
 struct unipro_xfer_descriptor {
     struct cport *cport;
     const void *data;
@@ -59,6 +64,7 @@ struct unipro_xfer_descriptor {
 
     size_t data_offset;
     void *channel;
+    struct timespec queued;
 
     struct list_head list;
 };
@@ -81,11 +87,117 @@ static struct {
     int max_channel;
 } unipro_dma;
 
+/*
+ * Order in which the traffic classes are served in a scheduling round, and
+ * how many transfers each of them may start per round.
+ */
+static const struct {
+    enum unipro_tx_class tx_class;
+    unsigned int weight;
+} unipro_tx_sched[] = {
+    { UNIPRO_TX_CLASS_ISOCHRONOUS, CONFIG_ARCH_UNIPROTX_DMA_WEIGHT_ISOC },
+    { UNIPRO_TX_CLASS_INTERACTIVE, CONFIG_ARCH_UNIPROTX_DMA_WEIGHT_INTERACTIVE },
+    { UNIPRO_TX_CLASS_BULK, CONFIG_ARCH_UNIPROTX_DMA_WEIGHT_BULK },
+};
+
+static struct unipro_tx_class_stats unipro_tx_stats[UNIPRO_TX_CLASS_COUNT];
+
+/*
+ * Fixed pool of TX descriptors for each CPort, allocated once by
+ * unipro_tx_init(). slots counts the descriptors left in free_list.
+ */
+struct unipro_tx_pool {
+    struct list_head free_list;
+    sem_t slots;
+};
+
+static struct unipro_tx_pool *tx_pools;
+static struct unipro_xfer_descriptor *tx_descs;
+
+static struct unipro_xfer_descriptor *unipro_get_tx_desc(struct cport *cport,
+                                                         bool block)
+{
+    struct unipro_tx_pool *pool = &tx_pools[cport->cportid];
+    struct unipro_xfer_descriptor *desc;
+    irqstate_t flags;
+
+    if (block) {
+        while (sem_wait(&pool->slots) < 0);
+    } else if (sem_trywait(&pool->slots) < 0) {
+        return NULL;
+    }
+
+    flags = irqsave();
+    desc = containerof(pool->free_list.next, struct unipro_xfer_descriptor,
+                       list);
+    list_del(&desc->list);
+    irqrestore(flags);
+
+    memset(desc, 0, sizeof(*desc));
+    list_init(&desc->list);
+    desc->cport = cport;
+
+    return desc;
+}
+
+static void unipro_put_tx_desc(struct unipro_xfer_descriptor *desc)
+{
+    struct unipro_tx_pool *pool = &tx_pools[desc->cport->cportid];
+    irqstate_t flags;
+
+    flags = irqsave();
+    list_add(&pool->free_list, &desc->list);
+    irqrestore(flags);
+
+    sem_post(&pool->slots);
+}
+
+/*
+ * When more than one channel is available, the first one is reserved for
+ * isochronous CPorts so that their transfers never queue up behind the ones
+ * of the other classes. The others are shared by the remaining CPorts.
+ */
 static void *pick_dma_channel(struct cport *cport)
 {
-    void *chan = unipro_dma.channel[cport->cportid % unipro_dma.max_channel];
+    int shared = unipro_dma.max_channel - 1;
 
-    return chan;
+    if (!shared || cport->tx_class == UNIPRO_TX_CLASS_ISOCHRONOUS)
+        return unipro_dma.channel[0];
+
+    return unipro_dma.channel[1 + cport->cportid % shared];
+}
+
+static void unipro_tx_account(struct unipro_xfer_descriptor *desc)
+{
+    struct unipro_tx_class_stats *stats;
+    struct timespec now;
+    uint32_t latency;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    latency = (now.tv_sec - desc->queued.tv_sec) * USEC_PER_SEC +
+              (now.tv_nsec - desc->queued.tv_nsec) / NSEC_PER_USEC;
+
+    stats = &unipro_tx_stats[desc->cport->tx_class];
+    stats->bytes += desc->len;
+    stats->messages++;
+    stats->total_latency_us += latency;
+    if (latency > stats->max_latency_us)
+        stats->max_latency_us = latency;
+}
+
+int unipro_get_tx_class_stats(enum unipro_tx_class tx_class,
+                              struct unipro_tx_class_stats *stats)
+{
+    irqstate_t flags;
+
+    if (tx_class >= UNIPRO_TX_CLASS_COUNT || !stats)
+        return -EINVAL;
+
+    flags = irqsave();
+    memcpy(stats, &unipro_tx_stats[tx_class], sizeof(*stats));
+    irqrestore(flags);
+
+    return 0;
 }
 
 static void unipro_dequeue_tx_desc(struct unipro_xfer_descriptor *desc, int status)
@@ -102,7 +214,7 @@ static void unipro_dequeue_tx_desc(struct unipro_xfer_descriptor *desc, int stat
         desc->callback(status, desc->data, desc->priv);
     }
 
-    free(desc);
+    unipro_put_tx_desc(desc);
 }
 
 static void unipro_flush_cport(struct cport *cport)
@@ -130,7 +242,8 @@ reset:
     cport->reset_completion_cb = cport->reset_completion_cb_priv = NULL;
 }
 
-static struct unipro_xfer_descriptor *pick_tx_descriptor(unsigned int cportid)
+static struct unipro_xfer_descriptor *
+pick_tx_descriptor(enum unipro_tx_class tx_class, unsigned int cportid)
 {
     struct unipro_xfer_descriptor *desc;
     unsigned int cport_count = unipro_cport_count();
@@ -154,8 +267,12 @@ static struct unipro_xfer_descriptor *pick_tx_descriptor(unsigned int cportid)
 
         if (cport->pending_reset) {
             unipro_flush_cport(cport);
+            continue;
         }
 
+        if (cport->tx_class != tx_class)
+            continue;
+
         desc = containerof(cport->tx_fifo.next, struct unipro_xfer_descriptor,
                 list);
         if (desc->channel)
@@ -183,7 +300,7 @@ static void unipro_xfer_dequeue_descriptor(struct unipro_xfer_descriptor *desc)
     list_del(&desc->list);
     irqrestore(flags);
 
-    free(desc);
+    unipro_put_tx_desc(desc);
 }
 
 static int unipro_dma_tx_callback(struct device *dev, void *chan,
@@ -194,6 +311,7 @@ static int unipro_dma_tx_callback(struct device *dev, void *chan,
     if (event & DEVICE_DMA_CALLBACK_EVENT_COMPLETE) {
         if (desc->data_offset >= desc->len) {
             unipro_dma_tx_set_eom_flag(desc->cport);
+            unipro_tx_account(desc);
 
             list_del(&desc->list);
             device_dma_op_free(unipro_dma.dev, op);
@@ -266,23 +384,42 @@ static int unipro_dma_xfer(struct unipro_xfer_descriptor *desc, void *channel)
     return 0;
 }
 
+/*
+ * Weighted round-robin between traffic classes: each round, every class may
+ * start up to its weight of transfers, CPorts of a same class being served
+ * in turn. Rounds go on until no CPort has a transfer ready to start.
+ */
 static void *unipro_tx_worker(void *data)
 {
     struct dma_channel *channel;
     struct unipro_xfer_descriptor *desc;
-    unsigned int next_cport;
+    unsigned int next_cport[ARRAY_SIZE(unipro_tx_sched)] = { 0 };
+    unsigned int n;
+    bool progress;
+    int i;
 
     while (1) {
         /* Block until a buffer is pending on any CPort */
         sem_wait(&worker.tx_fifo_lock);
 
-        next_cport = 0;
-        while ((desc = pick_tx_descriptor(next_cport)) != NULL) {
-            next_cport = desc->cport->cportid + 1;
-            channel = pick_dma_channel(desc->cport);
+        do {
+            progress = false;
 
-            unipro_dma_xfer(desc, channel);
-        }
+            for (i = 0; i < ARRAY_SIZE(unipro_tx_sched); i++) {
+                for (n = 0; n < unipro_tx_sched[i].weight; n++) {
+                    desc = pick_tx_descriptor(unipro_tx_sched[i].tx_class,
+                                              next_cport[i]);
+                    if (!desc)
+                        break;
+
+                    next_cport[i] = desc->cport->cportid + 1;
+                    channel = pick_dma_channel(desc->cport);
+
+                    unipro_dma_xfer(desc, channel);
+                    progress = true;
+                }
+            }
+        } while (progress);
     }
 
     return NULL;
@@ -297,8 +434,8 @@ void unipro_reset_notify(unsigned int cportid)
     sem_post(&worker.tx_fifo_lock);
 }
 
-int unipro_send_async(unsigned int cportid, const void *buf, size_t len,
-        unipro_send_completion_t callback, void *priv)
+static int unipro_queue_tx_desc(unsigned int cportid, const void *buf,
+        size_t len, unipro_send_completion_t callback, void *priv, bool block)
 {
     struct cport *cport;
     struct unipro_xfer_descriptor *desc;
@@ -315,16 +452,16 @@ int unipro_send_async(unsigned int cportid, const void *buf, size_t len,
         return -EPIPE;
     }
 
-    desc = zalloc(sizeof(*desc));
+    desc = unipro_get_tx_desc(cport, block);
     if (!desc)
-        return -ENOMEM;
+        return -EAGAIN;
 
     desc->data = buf;
     desc->len = len;
     desc->data_offset = 0;
     desc->callback = callback;
     desc->priv = priv;
-    desc->cport = cport;
+    clock_gettime(CLOCK_MONOTONIC, &desc->queued);
 
     list_init(&desc->list);
 
@@ -337,6 +474,12 @@ int unipro_send_async(unsigned int cportid, const void *buf, size_t len,
     return 0;
 }
 
+int unipro_send_async(unsigned int cportid, const void *buf, size_t len,
+        unipro_send_completion_t callback, void *priv)
+{
+    return unipro_queue_tx_desc(cportid, buf, len, callback, priv, false);
+}
+
 static int unipro_send_cb(int status, const void *buf, void *priv)
 {
     struct unipro_xfer_descriptor_sync *desc = priv;
@@ -357,7 +500,8 @@ int unipro_send(unsigned int cportid, const void *buf, size_t len)
 
     sem_init(&desc.lock, 0, 0);
 
-    retval = unipro_send_async(cportid, buf, len, unipro_send_cb, &desc);
+    retval = unipro_queue_tx_desc(cportid, buf, len, unipro_send_cb, &desc,
+                                  true);
     if (retval) {
         goto out;
     }
@@ -371,12 +515,189 @@ out:
     return retval;
 }
 
+/*
+ * Each DMA descriptor moves one buffer and ends the message, so the buffers
+ * are gathered into a bounce buffer here.
+ */
+int unipro_sendv(unsigned int cportid, const void * const bufs[],
+                 const size_t lens[], size_t count)
+{
+    uint8_t *buf, *p;
+    size_t i, len;
+    int retval;
+
+    if (count == 1)
+        return unipro_send(cportid, bufs[0], lens[0]);
+
+    for (i = 0, len = 0; i < count; i++)
+        len += lens[i];
+
+    if (len > CPORT_BUF_SIZE)
+        return -EINVAL;
+
+    buf = malloc(len ? len : 1);
+    if (!buf)
+        return -ENOMEM;
+
+    for (i = 0, p = buf; i < count; i++) {
+        memcpy(p, bufs[i], lens[i]);
+        p += lens[i];
+    }
+
+    retval = unipro_send(cportid, buf, len);
+    free(buf);
+
+    return retval;
+}
+
+struct unipro_xfer_batch_sync {
+    sem_t lock;
+    size_t pending;
+    int retval;
+};
+
+static int unipro_send_batch_cb(int status, const void *buf, void *priv)
+{
+    struct unipro_xfer_batch_sync *sync = priv;
+    irqstate_t flags;
+    bool done;
+
+    flags = irqsave();
+    if (status && !sync->retval)
+        sync->retval = status;
+    done = --sync->pending == 0;
+    irqrestore(flags);
+
+    if (done)
+        sem_post(&sync->lock);
+
+    return 0;
+}
+
+/**
+ * @brief           send several messages over UniPro and wait for completion
+ * @return          0 on success, <0 otherwise (first error encountered)
+ * @param[in]       cportid: target CPort ID
+ * @param[in]       bufs: data buffers, each one sent as a separate message
+ * @param[in]       lens: data buffer lengths (in bytes)
+ * @param[in]       count: number of buffers
+ *
+ * All messages are queued at once and the TX worker is woken up only once,
+ * instead of once per message like with unipro_send().
+ */
+static void unipro_queue_tx_batch(struct cport *cport, struct list_head *batch)
+{
+    struct list_head *iter, *iter_next;
+    irqstate_t flags;
+
+    if (list_is_empty(batch))
+        return;
+
+    flags = irqsave();
+    list_foreach_safe(batch, iter, iter_next) {
+        list_del(iter);
+        list_add(&cport->tx_fifo, iter);
+    }
+    irqrestore(flags);
+
+    sem_post(&worker.tx_fifo_lock);
+}
+
+int unipro_send_batch(unsigned int cportid, const void * const bufs[],
+                      const size_t lens[], size_t count)
+{
+    struct unipro_xfer_batch_sync sync;
+    struct list_head batch;
+    struct unipro_xfer_descriptor *desc;
+    struct cport *cport;
+    size_t i;
+
+    if (!count)
+        return 0;
+
+    cport = cport_handle(cportid);
+    if (!cport)
+        return -EINVAL;
+
+    if (cport->pending_reset)
+        return -EPIPE;
+
+    for (i = 0; i < count; i++) {
+        if (lens[i] > CPORT_BUF_SIZE)
+            return -EINVAL;
+    }
+
+    sem_init(&sync.lock, 0, 0);
+    sync.pending = count;
+    sync.retval = 0;
+    list_init(&batch);
+
+    for (i = 0; i < count; i++) {
+        desc = unipro_get_tx_desc(cport, false);
+        if (!desc) {
+            /* Pool exhausted: start sending what we have, then wait */
+            unipro_queue_tx_batch(cport, &batch);
+            desc = unipro_get_tx_desc(cport, true);
+        }
+
+        desc->data = bufs[i];
+        desc->len = lens[i];
+        desc->callback = unipro_send_batch_cb;
+        desc->priv = &sync;
+        clock_gettime(CLOCK_MONOTONIC, &desc->queued);
+
+        list_add(&batch, &desc->list);
+    }
+
+    unipro_queue_tx_batch(cport, &batch);
+
+    sem_wait(&sync.lock);
+    sem_destroy(&sync.lock);
+
+    return sync.retval;
+}
+
+static int unipro_tx_pools_init(void)
+{
+    unsigned int cport_count = unipro_cport_count();
+    struct unipro_xfer_descriptor *desc;
+    unsigned int i, j;
+
+    tx_pools = zalloc(cport_count * sizeof(*tx_pools));
+    tx_descs = zalloc(cport_count * CONFIG_ARCH_UNIPROTX_DESC_PER_CPORT *
+                      sizeof(*tx_descs));
+    if (!tx_pools || !tx_descs) {
+        free(tx_pools);
+        free(tx_descs);
+        tx_pools = NULL;
+        tx_descs = NULL;
+        return -ENOMEM;
+    }
+
+    desc = tx_descs;
+    for (i = 0; i < cport_count; i++) {
+        list_init(&tx_pools[i].free_list);
+        sem_init(&tx_pools[i].slots, 0, CONFIG_ARCH_UNIPROTX_DESC_PER_CPORT);
+
+        for (j = 0; j < CONFIG_ARCH_UNIPROTX_DESC_PER_CPORT; j++, desc++) {
+            list_init(&desc->list);
+            list_add(&tx_pools[i].free_list, &desc->list);
+        }
+    }
+
+    return 0;
+}
+
 int unipro_tx_init(void)
 {
     int i;
     int retval;
     int avail_chan = 0;
 
+    retval = unipro_tx_pools_init();
+    if (retval)
+        return retval;
+
     sem_init(&worker.tx_fifo_lock, 0, 0);
     sem_init(&unipro_dma.dma_channel_lock, 0, 0);
 
@@ -140,6 +140,7 @@ void dwc_otg_request_nuke(dwc_otg_pcd_ep_t * ep)
 	dwc_otg_pcd_request_t *req;
 
 	ep->stopped = 1;
+	ep->in_chained = 0;
 
 	/* called with irqs blocked?? */
 	while (!DWC_CIRCLEQ_EMPTY(&ep->queue)) {
@@ -2606,6 +2607,62 @@ static void dwc_otg_pcd_ep_resume(dwc_otg_pcd_ep_t *ep)
 
 }
 
+#ifdef CONFIG_DWC_CHAIN_IN_REQUESTS
+/*
+ * Program the requests waiting on a bulk IN endpoint as one descriptor
+ * list, so that the core sends them back to back. Only the last
+ * descriptor raises an interrupt; complete_in_chain() then completes
+ * every request of the list at once.
+ */
+static void init_in_dma_desc_chain(dwc_otg_core_if_t * core_if,
+				   dwc_otg_pcd_ep_t *ep)
+{
+	int i = 0;
+	unsigned int desc_cnt = 0;
+	dwc_otg_pcd_request_t *req;
+	dwc_otg_dev_dma_desc_t *dma_desc;
+
+	ep->dwc_ep.desc_cnt = 0;
+	ep->in_chained = 0;
+
+	if (ep->dwc_ep.type != DWC_OTG_EP_TYPE_BULK)
+		return;
+
+	/* Stop at the first request that needs more than one descriptor */
+	DWC_CIRCLEQ_FOREACH(req, &ep->queue, queue_entry) {
+		if (desc_cnt == MAX_DMA_DESC_CNT || !req->length ||
+		    req->length > DDMA_MAX_TRANSFER_SIZE)
+			break;
+		desc_cnt++;
+	}
+
+	/* A single request is started the usual way */
+	if (desc_cnt < 2)
+		return;
+
+	ep->dwc_ep.desc_cnt = desc_cnt;
+	DWC_CIRCLEQ_FOREACH(req, &ep->queue, queue_entry) {
+		if (i == desc_cnt)
+			break;
+
+		/** DMA Descriptor Setup */
+		dma_desc = get_ring_dma_desc_chain(&ep->dwc_ep, i);
+		dma_desc->status.b.bs = BS_HOST_BUSY;
+		dma_desc->status.b.l = (i == desc_cnt - 1);
+		dma_desc->status.b.ioc = (i == desc_cnt - 1);
+		dma_desc->status.b.sp =
+		    (req->length % ep->dwc_ep.maxpacket) ? 1 : req->sent_zlp;
+		dma_desc->status.b.bytes = req->length;
+		dma_desc->buf = req->dma;
+		dma_desc->status.b.sts = 0;
+		dma_desc->status.b.bs = BS_HOST_READY;
+		req->dma_desc = dma_desc;
+		i++;
+	}
+	ep->in_chained = desc_cnt;
+}
+#endif
+
 void init_fifo_dma_desc_chain(dwc_otg_core_if_t * core_if,
 			      dwc_otg_pcd_ep_t *ep)
 {
@@ -2615,6 +2672,13 @@ void init_fifo_dma_desc_chain(dwc_otg_core_if_t * core_if,
 	dwc_otg_pcd_request_t *next_req;
 	dwc_otg_dev_dma_desc_t *dma_desc;
 
+#ifdef CONFIG_DWC_CHAIN_IN_REQUESTS
+	if (ep->dwc_ep.is_in && core_if->dma_desc_enable) {
+		init_in_dma_desc_chain(core_if, ep);
+		return;
+	}
+#endif
+
 	desc_cnt = 0;
 	/* count request available in queue */
 	DWC_CIRCLEQ_FOREACH(req, &ep->sg_dma_queue, sg_dma_queue_entry) {
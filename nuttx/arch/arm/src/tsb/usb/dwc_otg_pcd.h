@@ -171,6 +171,9 @@ typedef struct dwc_otg_pcd_ep {
 	unsigned queue_sof:1;
 	unsigned bna:1;
 
+	/** Number of queued IN requests programmed in the descriptor chain */
+	uint32_t in_chained;
+
 #ifdef DWC_EN_ISOC
 	/** ISOC req handle passed */
 	void *iso_req_handle;
@@ -256,6 +256,12 @@ void start_pending_requests(dwc_otg_pcd_ep_t * ep, int one_requests)
 	pcd = ep->pcd;
 #endif
 
+#ifdef CONFIG_DWC_CHAIN_IN_REQUESTS
+	/* The core is still going through a chain of requests */
+	if (ep->in_chained)
+		return;
+#endif
+
 	if (!DWC_CIRCLEQ_EMPTY(&ep->queue)) {
 		req = DWC_CIRCLEQ_FIRST(&ep->queue);
 
@@ -2237,6 +2243,37 @@ static inline int cfi_calc_desc_residue(dwc_otg_pcd_ep_t * ep)
 }
 #endif
 
+#ifdef CONFIG_DWC_CHAIN_IN_REQUESTS
+/**
+ * This function completes the requests of a bulk IN descriptor chain
+ * that have been sent, and starts the requests queued in the meantime
+ * once the whole chain is done.
+ */
+static void complete_in_chain(dwc_otg_pcd_ep_t * ep)
+{
+	dev_dma_desc_sts_t desc_sts;
+	dwc_otg_pcd_request_t *req;
+
+	while (ep->in_chained && !DWC_CIRCLEQ_EMPTY(&ep->queue)) {
+		req = DWC_CIRCLEQ_FIRST(&ep->queue);
+		desc_sts = req->dma_desc->status;
+		if (desc_sts.b.bs != BS_DMA_DONE)
+			return;
+
+		req->actual = req->length - desc_sts.b.bytes;
+		ep->in_chained--;
+		dwc_otg_request_done(ep, req, 0);
+	}
+
+	ep->in_chained = 0;
+	ep->dwc_ep.start_xfer_buff = 0;
+	ep->dwc_ep.xfer_buff = 0;
+	ep->dwc_ep.xfer_len = 0;
+
+	start_pending_requests(ep, 0);
+}
+#endif
+
 /**
  * This function completes the request for the EP. If there are
  * additional requests for the EP in the queue they will be started.
@@ -2274,6 +2311,12 @@ static void complete_ep(dwc_otg_pcd_ep_t * ep)
 	DWC_DEBUGPL(DBG_PCD, "Requests %d\n", ep->pcd->request_pending);
 
 	if (ep->dwc_ep.is_in) {
+#ifdef CONFIG_DWC_CHAIN_IN_REQUESTS
+		if (ep->in_chained) {
+			complete_in_chain(ep);
+			return;
+		}
+#endif
 		deptsiz.d32 = DWC_READ_REG32(&in_ep_regs->dieptsiz);
 		depctl.d32 = DWC_READ_REG32(&in_ep_regs->diepctl);
 
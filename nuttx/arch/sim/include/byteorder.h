@@ -0,0 +1,76 @@
+/****************************************************************************
+ * arch/sim/include/byteorder.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __ARCH_SIM_INCLUDE_BYTEORDER_H
+#define __ARCH_SIM_INCLUDE_BYTEORDER_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+
+#ifdef CONFIG_ENDIAN_BIG
+#  error "big-endian unsupported"
+#endif
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+static inline uint32_t __swap32(uint32_t value)
+{
+  return __builtin_bswap32(value);
+}
+
+static inline uint16_t __swap16(uint16_t value)
+{
+  return (uint16_t)((value << 8) | (value >> 8));
+}
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define be32_to_cpu(v) __swap32(v)
+#define cpu_to_be32(v) __swap32(v)
+#define be16_to_cpu(v) __swap16(v)
+#define cpu_to_be16(v) __swap16(v)
+#define le32_to_cpu(v) (v)
+#define cpu_to_le32(v) (v)
+#define le16_to_cpu(v) (uint16_t)(v)
+#define cpu_to_le16(v) (uint16_t)(v)
+#define cpu_to_le64(v) (v)
+
+#endif /* __ARCH_SIM_INCLUDE_BYTEORDER_H */
@@ -0,0 +1,120 @@
+/****************************************************************************
+ * arch/sim/src/up_hrtimer.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/hires_tmr.h>
+
+#ifdef CONFIG_SIM_HIRES_TIMER
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Host time of the first call, taken as the time of the reboot */
+
+static unsigned long g_boot_sec;
+static unsigned long g_boot_nsec;
+static bool g_booted;
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+extern void up_hostgettime(unsigned long *sec, unsigned long *nsec);
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: hrt_gettimespec
+ *
+ * Description:
+ *   Return seconds and nanoseconds since the boot of the simulation, from
+ *   the monotonic clock of the host.  Unlike the system timer, this time
+ *   also passes while the simulation is busy and does not reach the IDLE
+ *   loop.
+ *
+ ****************************************************************************/
+
+void hrt_gettimespec(struct timespec *ts)
+{
+  unsigned long sec;
+  unsigned long nsec;
+
+  up_hostgettime(&sec, &nsec);
+  if (!g_booted)
+    {
+      g_boot_sec  = sec;
+      g_boot_nsec = nsec;
+      g_booted    = true;
+    }
+
+  if (nsec < g_boot_nsec)
+    {
+      nsec += NSEC_PER_SEC;
+      sec--;
+    }
+
+  ts->tv_sec  = sec - g_boot_sec;
+  ts->tv_nsec = nsec - g_boot_nsec;
+}
+
+/****************************************************************************
+ * Name: hrt_getusec
+ *
+ * Description:
+ *   Return the microseconds since the boot of the simulation.
+ *
+ ****************************************************************************/
+
+uint32_t hrt_getusec(void)
+{
+  struct timespec ts;
+
+  hrt_gettimespec(&ts);
+  return ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
+}
+
+#endif /* CONFIG_SIM_HIRES_TIMER */
@@ -76,6 +76,10 @@
 #  define CONFIG_AUDIO_BUFFER_DEQUEUE_PRIO  1
 #endif
 
+#ifndef CONFIG_AUDIO_PREFETCH_DEPTH
+#  define CONFIG_AUDIO_PREFETCH_DEPTH  0
+#endif
+
 /****************************************************************************
  * Private Type Definitions
  ****************************************************************************/
@@ -89,6 +93,13 @@ struct audio_upperhalf_s
   sem_t             exclsem;  /* Supports mutual exclusion */
   FAR struct audio_lowerhalf_s *dev;  /* lower-half state */
   mqd_t             usermq;   /* User mode app's message queue */
+  volatile bool     starved;  /* True: lower half ran dry, re-priming */
+  uint16_t          prefetch; /* Buffers to collect before re-priming */
+  struct dq_queue_s holdq;    /* Buffers held back while re-priming */
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  FAR void         *holdsession; /* Session of the held buffers */
+#endif
+  struct audio_stats_s stats; /* Pipeline statistics */
 };
 
 /****************************************************************************
@@ -109,6 +120,10 @@ static int      audio_start(FAR struct audio_upperhalf_s *upper);
 static void     audio_callback(FAR void *priv, uint16_t reason,
                     FAR struct ap_buffer_s *apb, uint16_t status);
 #endif /* CONFIG_AUDIO_MULTI_SESSION */
+static int      audio_enqueuebuffer(FAR struct audio_upperhalf_s *upper,
+                    FAR struct audio_buf_desc_s *bufdesc);
+static void     audio_releasehold(FAR struct audio_upperhalf_s *upper,
+                    FAR struct ap_buffer_s *except);
 
 /****************************************************************************
  * Private Data
@@ -330,15 +345,149 @@ static int audio_start(FAR struct audio_upperhalf_s *upper)
 
       if (ret == OK)
         {
-          /* Indicate that the audio stream has started */
+          irqstate_t flags;
+
+          /* Indicate that the audio stream has started and start counting
+           * the pipeline statistics afresh.  Buffers queued before the
+           * start are still in the lower half.
+           */
+
+          flags = irqsave();
+          upper->started         = true;
+          upper->starved         = false;
+          upper->stats.enqueued  = upper->stats.depth;
+          upper->stats.dequeued  = 0;
+          upper->stats.underruns = 0;
+          upper->stats.lowwater  = upper->stats.depth;
+          irqrestore(flags);
+        }
+    }
+
+  return ret;
+}
+
+/************************************************************************************
+ * Name: audio_lowerenqueue
+ *
+ * Description:
+ *   Pass one buffer to the lower half, accounting for it first since the
+ *   lower half may return it before its enqueuebuffer method returns.
+ *
+ ************************************************************************************/
+
+static int audio_lowerenqueue(FAR struct audio_upperhalf_s *upper,
+                              FAR struct ap_buffer_s *apb)
+{
+  FAR struct audio_lowerhalf_s *lower = upper->dev;
+  irqstate_t flags;
+  int ret;
+
+  flags = irqsave();
+  upper->stats.depth++;
+  upper->stats.enqueued++;
+  irqrestore(flags);
+
+  ret = lower->ops->enqueuebuffer(lower, apb);
+  if (ret < 0)
+    {
+      flags = irqsave();
+      upper->stats.depth--;
+      upper->stats.enqueued--;
+      irqrestore(flags);
+    }
 
-          upper->started = true;
+  return ret;
+}
+
+/************************************************************************************
+ * Name: audio_flushhold
+ *
+ * Description:
+ *   Pass all held buffers to the lower half and leave the re-priming state.
+ *   If the lower half refuses one, the rest are returned to the client,
+ *   except for 'current' which the client has not been told was accepted.
+ *
+ ************************************************************************************/
+
+static int audio_flushhold(FAR struct audio_upperhalf_s *upper,
+                           FAR struct ap_buffer_s *current)
+{
+  FAR struct ap_buffer_s *apb;
+  int ret = OK;
+
+  audvdbg("Re-primed with %d buffers\n", upper->stats.held);
+
+  upper->starved = false;
+  while ((apb = (FAR struct ap_buffer_s *)dq_remfirst(&upper->holdq)) != NULL)
+    {
+      upper->stats.held--;
+
+      ret = audio_lowerenqueue(upper, apb);
+      if (ret < 0)
+        {
+          auddbg("ERROR: enqueue of held buffer failed: %d\n", ret);
+
+          if (apb != current)
+            {
+              dq_addfirst(&apb->dq_entry, &upper->holdq);
+              upper->stats.held++;
+            }
+
+          audio_releasehold(upper, current);
+          break;
         }
     }
 
   return ret;
 }
 
+/************************************************************************************
+ * Name: audio_enqueuebuffer
+ *
+ * Description:
+ *   Handle the AUDIOIOC_ENQUEUEBUFFER ioctl command.  Buffers go straight to
+ *   the lower half unless it ran dry mid-stream, in which case they are held
+ *   until the prefetch depth is reached (or the final buffer arrives) and
+ *   then passed down together.
+ *
+ ************************************************************************************/
+
+static int audio_enqueuebuffer(FAR struct audio_upperhalf_s *upper,
+                               FAR struct audio_buf_desc_s *bufdesc)
+{
+  FAR struct ap_buffer_s *apb = bufdesc->u.pBuffer;
+  irqstate_t flags;
+  bool hold;
+
+  DEBUGASSERT(upper->dev->ops->enqueuebuffer != NULL && apb != NULL);
+
+  flags = irqsave();
+  hold = upper->starved;
+  if (hold)
+    {
+      dq_addlast(&apb->dq_entry, &upper->holdq);
+      upper->stats.held++;
+    }
+  irqrestore(flags);
+
+  if (!hold)
+    {
+      return audio_lowerenqueue(upper, apb);
+    }
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  upper->holdsession = bufdesc->session;
+#endif
+
+  if (upper->stats.held >= upper->prefetch ||
+      (apb->flags & AUDIO_APB_FINAL) != 0)
+    {
+      return audio_flushhold(upper, apb);
+    }
+
+  return OK;
+}
+
 /************************************************************************************
  * Name: audio_ioctl
  *
@@ -462,6 +611,10 @@ static int audio_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 #endif
               upper->started = false;
             }
+
+          /* Buffers held while re-priming never reached the lower half */
+
+          audio_releasehold(upper, NULL);
         }
         break;
 #endif  /* CONFIG_AUDIO_EXCLUDE_STOP */
@@ -571,10 +724,57 @@ static int audio_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
         {
           audvdbg("AUDIOIOC_ENQUEUEBUFFER\n");
 
-          DEBUGASSERT(lower->ops->enqueuebuffer != NULL);
-
           bufdesc = (FAR struct audio_buf_desc_s *) arg;
-          ret = lower->ops->enqueuebuffer(lower, bufdesc->u.pBuffer);
+          ret = audio_enqueuebuffer(upper, bufdesc);
+        }
+        break;
+
+      /* AUDIOIOC_SETPREFETCH - Set the re-prime depth after an underrun
+       *
+       *   ioctl argument:  The prefetch depth
+       */
+
+      case AUDIOIOC_SETPREFETCH:
+        {
+          audvdbg("AUDIOIOC_SETPREFETCH: %ld\n", arg);
+
+          if (arg > UINT16_MAX)
+            {
+              ret = -EINVAL;
+              break;
+            }
+
+          upper->prefetch = (uint16_t)arg;
+          ret = OK;
+
+          /* Lowering the depth may satisfy a re-prime in progress */
+
+          if (upper->starved && upper->stats.held >= upper->prefetch)
+            {
+              ret = audio_flushhold(upper, NULL);
+            }
+        }
+        break;
+
+      /* AUDIOIOC_GETSTATS - Get the buffer pipeline statistics
+       *
+       *   ioctl argument:  pointer to an audio_stats_s structure
+       */
+
+      case AUDIOIOC_GETSTATS:
+        {
+          FAR struct audio_stats_s *stats =
+            (FAR struct audio_stats_s *)((uintptr_t)arg);
+          irqstate_t flags;
+
+          audvdbg("AUDIOIOC_GETSTATS\n");
+          DEBUGASSERT(stats != NULL);
+
+          flags = irqsave();
+          upper->stats.prefetch = upper->prefetch;
+          memcpy(stats, &upper->stats, sizeof(struct audio_stats_s));
+          irqrestore(flags);
+          ret = OK;
         }
         break;
 
@@ -643,6 +843,12 @@ static int audio_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 #else
           ret = lower->ops->release(lower);
 #endif
+
+          /* Anything still held belongs to the released session */
+
+          dq_init(&upper->holdq);
+          upper->stats.held = 0;
+          upper->starved    = false;
         }
         break;
 
@@ -721,6 +927,36 @@ static inline void audio_dequeuebuffer(FAR struct audio_upperhalf_s *upper,
     }
 }
 
+/****************************************************************************
+ * Name: audio_releasehold
+ *
+ * Description:
+ *   Return the buffers held while re-priming to the client as though the
+ *   lower half had played them, except for 'except' which the client still
+ *   owns.
+ *
+ ****************************************************************************/
+
+static void audio_releasehold(FAR struct audio_upperhalf_s *upper,
+                              FAR struct ap_buffer_s *except)
+{
+  FAR struct ap_buffer_s *apb;
+
+  upper->starved = false;
+  while ((apb = (FAR struct ap_buffer_s *)dq_remfirst(&upper->holdq)) != NULL)
+    {
+      upper->stats.held--;
+      if (apb != except)
+        {
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+          audio_dequeuebuffer(upper, apb, OK, upper->holdsession);
+#else
+          audio_dequeuebuffer(upper, apb, OK);
+#endif
+        }
+    }
+}
+
 /****************************************************************************
  * Name: audio_complete
  *
@@ -799,6 +1035,32 @@ static void audio_callback(FAR void *handle, uint16_t reason,
     {
       case AUDIO_CALLBACK_DEQUEUE:
         {
+          /* Keep the pipeline statistics.  Running out of buffers before
+           * the final one is an underrun; with a prefetch depth set, hold
+           * the next buffers until the pipeline can be refilled.
+           */
+
+          if (upper->stats.depth > 0)
+            {
+              upper->stats.depth--;
+            }
+
+          upper->stats.dequeued++;
+          if (upper->stats.depth < upper->stats.lowwater)
+            {
+              upper->stats.lowwater = upper->stats.depth;
+            }
+
+          if (upper->stats.depth == 0 && upper->started &&
+              (apb->flags & AUDIO_APB_FINAL) == 0)
+            {
+              upper->stats.underruns++;
+              if (upper->prefetch > 1)
+                {
+                  upper->starved = true;
+                }
+            }
+
           /* Call the dequeue routine */
 
 #ifdef CONFIG_AUDIO_MULTI_SESSION
@@ -893,6 +1155,8 @@ int audio_register(FAR const char *name, FAR struct audio_lowerhalf_s *dev)
 
   sem_init(&upper->exclsem, 0, 1);
   upper->dev = dev;
+  upper->prefetch = CONFIG_AUDIO_PREFETCH_DEPTH;
+  dq_init(&upper->holdq);
 
 #ifdef CONFIG_AUDIO_CUSTOM_DEV_PATH
 
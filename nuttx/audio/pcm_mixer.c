@@ -0,0 +1,1666 @@
+/****************************************************************************
+ * audio/pcm_mixer.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <assert.h>
+#include <semaphore.h>
+#include <pthread.h>
+#include <sched.h>
+#include <queue.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/audio/audio.h>
+#include <nuttx/audio/pcm.h>
+
+#if defined(CONFIG_AUDIO) && defined(CONFIG_AUDIO_MIXER)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+/* Configuration ************************************************************/
+
+#ifndef CONFIG_AUDIO_MIXER_SAMPRATE
+#  define CONFIG_AUDIO_MIXER_SAMPRATE 48000
+#endif
+
+#ifndef CONFIG_AUDIO_MIXER_NFRAMES
+#  define CONFIG_AUDIO_MIXER_NFRAMES 256
+#endif
+
+#ifndef CONFIG_AUDIO_MIXER_NBUFFERS
+#  define CONFIG_AUDIO_MIXER_NBUFFERS 3
+#endif
+
+#ifndef CONFIG_AUDIO_MIXER_WORKER_STACKSIZE
+#  define CONFIG_AUDIO_MIXER_WORKER_STACKSIZE 1024
+#endif
+
+/* The output is always 16-bit interleaved stereo */
+
+#define PCM_MIXER_NCHANNELS   2
+#define PCM_MIXER_FRAMESIZE   (PCM_MIXER_NCHANNELS * sizeof(int16_t))
+
+/* Polyphase resampler.  Each output sample is an 8 tap FIR over the most
+ * recent input samples, using one of 32 phases selected by the fractional
+ * input position.  Positions advance in Q16 input frames.
+ */
+
+#define PCM_MIXER_TAPS        8
+#define PCM_MIXER_PHASE_BITS  5
+#define PCM_MIXER_PHASES      (1 << PCM_MIXER_PHASE_BITS)
+#define PCM_MIXER_UNITY       (1 << 16)
+
+/* Full scale Q15 gain */
+
+#define PCM_MIXER_GAIN_MAX    32767
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A FIR window.  The word view lets the dot product consume two 16-bit
+ * taps per multiply-accumulate.
+ */
+
+union pcm_mixer_taps_u
+{
+  int16_t  h[PCM_MIXER_TAPS];
+  uint32_t w[PCM_MIXER_TAPS / 2];
+};
+
+/* State of the contained output device */
+
+enum pcm_mixer_lstate_e
+{
+  PCM_MIXER_LOWER_IDLE = 0,        /* Not started */
+  PCM_MIXER_LOWER_RUNNING,         /* Started, accepting mixed buffers */
+  PCM_MIXER_LOWER_DRAINING         /* Final buffer queued, waiting for COMPLETE */
+};
+
+struct pcm_mixer_s;
+
+/* One mixer input.  Each is registered as its own audio device. */
+
+struct pcm_mixer_source_s
+{
+  /* This is our appearance to the outside world.  This *MUST* be the
+   * first element of the structure so that we can freely cast between types
+   * struct audio_lowerhalf and struct pcm_mixer_source_s.
+   */
+
+  struct audio_lowerhalf_s export;
+
+  FAR struct pcm_mixer_s *mixer;   /* The mixer that owns this source */
+  struct dq_queue_s pendq;         /* Buffers waiting to be mixed */
+
+  uint32_t samprate;               /* Input sample rate */
+  uint32_t step;                   /* Input frames per output frame, Q16 */
+  uint32_t frac;                   /* Input position past the newest tap, Q16 */
+  int16_t  gain;                   /* Q15 gain */
+  uint8_t  nchannels;              /* Mono=1, Stereo=2 */
+  bool     reserved;               /* Reserved by an upper half */
+  bool     running;                /* Between start and stop/complete */
+  bool     paused;                 /* Paused, not contributing */
+  bool     final;                  /* The final buffer has been enqueued */
+
+  union pcm_mixer_taps_u hist[PCM_MIXER_NCHANNELS]; /* Newest sample last */
+};
+
+/* This structure describes the internal state of the PCM mixer */
+
+struct pcm_mixer_s
+{
+  /* This is the contained, low-level DAC-type device and will receive the
+   * mixed PCM audio data.
+   */
+
+  FAR struct audio_lowerhalf_s *lower;
+
+  /* Session returned from the lower level driver */
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  FAR void *session;
+#endif
+
+  sem_t exclsem;                   /* Protects everything below */
+  sem_t wakeup;                    /* Wakes up the worker thread */
+  pthread_t threadid;              /* Worker thread */
+  volatile bool terminate;         /* Ask the worker thread to exit */
+  volatile bool lcomplete;         /* The lower half reported COMPLETE */
+  uint8_t lstate;                  /* See enum pcm_mixer_lstate_e */
+  uint8_t nreserved;               /* Number of reserved sources */
+  uint8_t nsources;                /* Number of sources */
+  volatile uint8_t noutstanding;   /* Mixed buffers held by the lower half */
+
+  struct dq_queue_s freeq;         /* Mixed buffers available for mixing */
+  struct dq_queue_s doneq;         /* Returned by the lower, not yet reclaimed */
+  FAR struct ap_buffer_s *outbuf[CONFIG_AUDIO_MIXER_NBUFFERS];
+
+  int32_t accum[CONFIG_AUDIO_MIXER_NFRAMES * PCM_MIXER_NCHANNELS];
+
+  FAR struct pcm_mixer_source_s *sources;
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* Helper functions *********************************************************/
+
+static void pcm_mixer_takesem(FAR sem_t *sem);
+#define     pcm_mixer_givesem(s) sem_post(s)
+
+/* struct audio_lowerhalf_s methods *****************************************/
+
+static int  pcm_mixer_getcaps(FAR struct audio_lowerhalf_s *dev, int type,
+              FAR struct audio_caps_s *caps);
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int  pcm_mixer_configure(FAR struct audio_lowerhalf_s *dev,
+              FAR void *session, FAR const struct audio_caps_s *caps);
+#else
+static int  pcm_mixer_configure(FAR struct audio_lowerhalf_s *dev,
+              FAR const struct audio_caps_s *caps);
+#endif
+
+static int  pcm_mixer_shutdown(FAR struct audio_lowerhalf_s *dev);
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int  pcm_mixer_start(FAR struct audio_lowerhalf_s *dev,
+              FAR void *session);
+#else
+static int  pcm_mixer_start(FAR struct audio_lowerhalf_s *dev);
+#endif
+
+#ifndef CONFIG_AUDIO_EXCLUDE_STOP
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int  pcm_mixer_stop(FAR struct audio_lowerhalf_s *dev,
+              FAR void *session);
+#else
+static int  pcm_mixer_stop(FAR struct audio_lowerhalf_s *dev);
+#endif
+#endif
+
+#ifndef CONFIG_AUDIO_EXCLUDE_PAUSE_RESUME
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int  pcm_mixer_pause(FAR struct audio_lowerhalf_s *dev,
+              FAR void *session);
+static int  pcm_mixer_resume(FAR struct audio_lowerhalf_s *dev,
+              FAR void *session);
+#else
+static int  pcm_mixer_pause(FAR struct audio_lowerhalf_s *dev);
+static int  pcm_mixer_resume(FAR struct audio_lowerhalf_s *dev);
+#endif
+#endif
+
+static int  pcm_mixer_enqueuebuffer(FAR struct audio_lowerhalf_s *dev,
+              FAR struct ap_buffer_s *apb);
+static int  pcm_mixer_cancelbuffer(FAR struct audio_lowerhalf_s *dev,
+              FAR struct ap_buffer_s *apb);
+static int  pcm_mixer_ioctl(FAR struct audio_lowerhalf_s *dev,
+              int cmd, unsigned long arg);
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int  pcm_mixer_reserve(FAR struct audio_lowerhalf_s *dev,
+              FAR void **session);
+static int  pcm_mixer_release(FAR struct audio_lowerhalf_s *dev,
+              FAR void *session);
+#else
+static int  pcm_mixer_reserve(FAR struct audio_lowerhalf_s *dev);
+static int  pcm_mixer_release(FAR struct audio_lowerhalf_s *dev);
+#endif
+
+/* Audio callback */
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static void pcm_mixer_callback(FAR void *arg, uint16_t reason,
+              FAR struct ap_buffer_s *apb, uint16_t status,
+              FAR void *session);
+#else
+static void pcm_mixer_callback(FAR void *arg, uint16_t reason,
+              FAR struct ap_buffer_s *apb, uint16_t status);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct audio_ops_s g_pcm_mixer_ops =
+{
+  pcm_mixer_getcaps,       /* getcaps        */
+  pcm_mixer_configure,     /* configure      */
+  pcm_mixer_shutdown,      /* shutdown       */
+  pcm_mixer_start,         /* start          */
+#ifndef CONFIG_AUDIO_EXCLUDE_STOP
+  pcm_mixer_stop,          /* stop           */
+#endif
+#ifndef CONFIG_AUDIO_EXCLUDE_PAUSE_RESUME
+  pcm_mixer_pause,         /* pause          */
+  pcm_mixer_resume,        /* resume         */
+#endif
+  NULL,                    /* allocbuffer    */
+  NULL,                    /* freebuffer     */
+  pcm_mixer_enqueuebuffer, /* enqueue_buffer */
+  pcm_mixer_cancelbuffer,  /* cancel_buffer  */
+  pcm_mixer_ioctl,         /* ioctl          */
+  NULL,                    /* read           */
+  NULL,                    /* write          */
+  pcm_mixer_reserve,       /* reserve        */
+  pcm_mixer_release        /* release        */
+};
+
+/* Kaiser windowed sinc (beta 5, cutoff 0.9 of the input Nyquist rate),
+ * one row per phase, each row normalized to unity gain at DC.  Tap 3 is
+ * the input sample at or before the output position.  The fixed cutoff
+ * suits upsampling and near unity ratios; downsampling by a large factor
+ * will alias.
+ */
+
+static const union pcm_mixer_taps_u g_pcm_mixer_fir[PCM_MIXER_PHASES] =
+{
+  {{    646,  -1688,   2786,  29370,   2786,  -1688,    646,    -91 }},
+  {{    574,  -1425,   1940,  29338,   3680,  -1955,    718,   -103 }},
+  {{    503,  -1168,   1142,  29223,   4616,  -2222,    789,   -116 }},
+  {{    433,   -918,    394,  29024,   5593,  -2489,    858,   -128 }},
+  {{    366,   -677,   -303,  28740,   6607,  -2751,    925,   -140 }},
+  {{    301,   -446,   -947,  28379,   7652,  -3007,    987,   -152 }},
+  {{    238,   -227,  -1537,  27935,   8727,  -3252,   1045,   -162 }},
+  {{    180,    -22,  -2072,  27417,   9824,  -3485,   1097,   -172 }},
+  {{    125,    169,  -2551,  26823,  10940,  -3701,   1142,   -180 }},
+  {{     75,    345,  -2976,  26160,  12070,  -3899,   1179,   -187 }},
+  {{     28,    506,  -3346,  25429,  13208,  -4074,   1207,   -191 }},
+  {{    -13,    650,  -3662,  24634,  14349,  -4223,   1225,   -193 }},
+  {{    -51,    778,  -3924,  23783,  15486,  -4344,   1231,   -192 }},
+  {{    -83,    889,  -4136,  22877,  16615,  -4433,   1225,   -187 }},
+  {{   -111,    984,  -4297,  21923,  17729,  -4487,   1206,   -180 }},
+  {{   -135,   1063,  -4411,  20926,  18823,  -4503,   1173,   -169 }},
+  {{   -154,   1126,  -4478,  19890,  19889,  -4478,   1126,   -154 }},
+  {{   -169,   1173,  -4503,  18823,  20926,  -4411,   1063,   -135 }},
+  {{   -180,   1206,  -4487,  17729,  21923,  -4297,    984,   -111 }},
+  {{   -187,   1225,  -4433,  16615,  22877,  -4136,    889,    -83 }},
+  {{   -192,   1231,  -4344,  15486,  23783,  -3924,    778,    -51 }},
+  {{   -193,   1225,  -4223,  14349,  24634,  -3662,    650,    -13 }},
+  {{   -191,   1207,  -4074,  13208,  25429,  -3346,    506,     28 }},
+  {{   -187,   1179,  -3899,  12070,  26160,  -2976,    345,     75 }},
+  {{   -180,   1142,  -3701,  10940,  26823,  -2551,    169,    125 }},
+  {{   -172,   1097,  -3485,   9824,  27417,  -2072,    -22,    180 }},
+  {{   -162,   1045,  -3252,   8727,  27935,  -1537,   -227,    238 }},
+  {{   -152,    987,  -3007,   7652,  28379,   -947,   -446,    301 }},
+  {{   -140,    925,  -2751,   6607,  28740,   -303,   -677,    366 }},
+  {{   -128,    858,  -2489,   5593,  29024,    394,   -918,    433 }},
+  {{   -116,    789,  -2222,   4616,  29223,   1142,  -1168,    503 }},
+  {{   -103,    718,  -1955,   3680,  29338,   1940,  -1425,    574 }}
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pcm_mixer_takesem
+ *
+ * Description:
+ *  Take a semaphore count, handling the nasty EINTR return if we are
+ *  interrupted by a signal.
+ *
+ ****************************************************************************/
+
+static void pcm_mixer_takesem(FAR sem_t *sem)
+{
+  int ret;
+
+  do
+    {
+      ret = sem_wait(sem);
+      DEBUGASSERT(ret == 0 || errno == EINTR);
+    }
+  while (ret < 0);
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_smlad
+ *
+ * Description:
+ *   Dual 16-bit signed multiply with a single accumulate:
+ *   acc + x.lo * y.lo + x.hi * y.hi.  One instruction on cores with the
+ *   DSP extension (Cortex-M4).
+ *
+ ****************************************************************************/
+
+static inline int32_t pcm_mixer_smlad(uint32_t x, uint32_t y, int32_t acc)
+{
+#ifdef __ARM_FEATURE_DSP
+  int32_t result;
+
+  __asm__ ("smlad %0, %1, %2, %3"
+           : "=r" (result) : "r" (x), "r" (y), "r" (acc));
+  return result;
+#else
+  return acc + (int16_t)x * (int16_t)y +
+         (int16_t)(x >> 16) * (int16_t)(y >> 16);
+#endif
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_sat16
+ *
+ * Description:
+ *   Saturate a 32-bit value to the signed 16-bit range.
+ *
+ ****************************************************************************/
+
+static inline int16_t pcm_mixer_sat16(int32_t value)
+{
+#ifdef __ARM_FEATURE_DSP
+  int32_t result;
+
+  __asm__ ("ssat %0, #16, %1" : "=r" (result) : "r" (value));
+  return (int16_t)result;
+#else
+  if (value > INT16_MAX)
+    {
+      return INT16_MAX;
+    }
+  else if (value < INT16_MIN)
+    {
+      return INT16_MIN;
+    }
+
+  return (int16_t)value;
+#endif
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_fir
+ *
+ * Description:
+ *   Q15 dot product of a history window with a coefficient row.
+ *
+ ****************************************************************************/
+
+static inline int32_t pcm_mixer_fir(FAR const union pcm_mixer_taps_u *x,
+                                    FAR const union pcm_mixer_taps_u *h)
+{
+  int32_t acc = 0;
+  int i;
+
+  for (i = 0; i < PCM_MIXER_TAPS / 2; i++)
+    {
+      acc = pcm_mixer_smlad(x->w[i], h->w[i], acc);
+    }
+
+  return acc >> 15;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_notify
+ *
+ * Description:
+ *   Forward an event to the upper half bound to a source.
+ *
+ ****************************************************************************/
+
+static void pcm_mixer_notify(FAR struct pcm_mixer_source_s *src,
+                             uint16_t reason, FAR struct ap_buffer_s *apb)
+{
+  DEBUGASSERT(src->export.upper);
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  src->export.upper(src->export.priv, reason, apb, OK, src);
+#else
+  src->export.upper(src->export.priv, reason, apb, OK);
+#endif
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_retire
+ *
+ * Description:
+ *   Return fully consumed buffers at the head of a source's queue to its
+ *   upper half.  Called with exclsem held.
+ *
+ ****************************************************************************/
+
+static void pcm_mixer_retire(FAR struct pcm_mixer_source_s *src)
+{
+  FAR struct ap_buffer_s *apb;
+  apb_samp_t framesize = src->nchannels * sizeof(int16_t);
+
+  while ((apb = (FAR struct ap_buffer_s *)dq_peek(&src->pendq)) != NULL &&
+         apb->curbyte + framesize > apb->nbytes)
+    {
+      dq_remfirst(&src->pendq);
+      apb->curbyte = apb->nbytes;
+
+      /* Release our reference and send the buffer back up */
+
+      apb_free(apb);
+      pcm_mixer_notify(src, AUDIO_CALLBACK_DEQUEUE, apb);
+    }
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_pull
+ *
+ * Description:
+ *   Shift the next input frame of a source into its FIR history.  Returns
+ *   false if the source has no data queued.
+ *
+ ****************************************************************************/
+
+static bool pcm_mixer_pull(FAR struct pcm_mixer_source_s *src)
+{
+  FAR struct ap_buffer_s *apb;
+  FAR const uint8_t *samp;
+  int16_t left;
+  int16_t right;
+
+  pcm_mixer_retire(src);
+
+  apb = (FAR struct ap_buffer_s *)dq_peek(&src->pendq);
+  if (apb == NULL)
+    {
+      return false;
+    }
+
+  /* PCM data is little endian and may not be halfword aligned */
+
+  samp  = &apb->samp[apb->curbyte];
+  left  = (int16_t)(samp[0] | (samp[1] << 8));
+  right = left;
+
+  if (src->nchannels == 2)
+    {
+      right = (int16_t)(samp[2] | (samp[3] << 8));
+    }
+
+  apb->curbyte += src->nchannels * sizeof(int16_t);
+
+  memmove(&src->hist[0].h[0], &src->hist[0].h[1],
+          (PCM_MIXER_TAPS - 1) * sizeof(int16_t));
+  memmove(&src->hist[1].h[0], &src->hist[1].h[1],
+          (PCM_MIXER_TAPS - 1) * sizeof(int16_t));
+  src->hist[0].h[PCM_MIXER_TAPS - 1] = left;
+  src->hist[1].h[PCM_MIXER_TAPS - 1] = right;
+
+  return true;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_render
+ *
+ * Description:
+ *   Resample up to nframes output frames from a source and add them, with
+ *   the source gain applied, into the accumulator.  Returns the number of
+ *   frames produced, which is less than nframes if the source ran out of
+ *   queued data.  Called with exclsem held.
+ *
+ ****************************************************************************/
+
+static int pcm_mixer_render(FAR struct pcm_mixer_source_s *src,
+                            FAR int32_t *accum, int nframes)
+{
+  FAR const union pcm_mixer_taps_u *coef;
+  int32_t left;
+  int32_t right;
+  int n;
+
+  for (n = 0; n < nframes; n++)
+    {
+      if (src->step == PCM_MIXER_UNITY)
+        {
+          /* Same rate as the output: no filtering */
+
+          if (!pcm_mixer_pull(src))
+            {
+              break;
+            }
+
+          left  = src->hist[0].h[PCM_MIXER_TAPS - 1];
+          right = src->hist[1].h[PCM_MIXER_TAPS - 1];
+        }
+      else
+        {
+          while (src->frac >= PCM_MIXER_UNITY)
+            {
+              if (!pcm_mixer_pull(src))
+                {
+                  return n;
+                }
+
+              src->frac -= PCM_MIXER_UNITY;
+            }
+
+          coef  = &g_pcm_mixer_fir[src->frac >> (16 - PCM_MIXER_PHASE_BITS)];
+          left  = pcm_mixer_fir(&src->hist[0], coef);
+          right = left;
+
+          if (src->nchannels == 2)
+            {
+              right = pcm_mixer_fir(&src->hist[1], coef);
+            }
+
+          src->frac += src->step;
+        }
+
+      accum[2 * n]     += (left  * src->gain) >> 15;
+      accum[2 * n + 1] += (right * src->gain) >> 15;
+    }
+
+  return n;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_drop
+ *
+ * Description:
+ *   Stop a source: return all of its queued buffers and report completion.
+ *   Called with exclsem held.
+ *
+ ****************************************************************************/
+
+static void pcm_mixer_drop(FAR struct pcm_mixer_source_s *src)
+{
+  FAR struct ap_buffer_s *apb;
+  bool running = src->running;
+
+  src->running = false;
+  src->paused  = false;
+  src->final   = false;
+
+  while ((apb = (FAR struct ap_buffer_s *)dq_remfirst(&src->pendq)) != NULL)
+    {
+      apb_free(apb);
+      pcm_mixer_notify(src, AUDIO_CALLBACK_DEQUEUE, apb);
+    }
+
+  if (running)
+    {
+      pcm_mixer_notify(src, AUDIO_CALLBACK_COMPLETE, NULL);
+    }
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_active
+ *
+ * Description:
+ *   Return true if any source is started and not paused.
+ *
+ ****************************************************************************/
+
+static bool pcm_mixer_active(FAR struct pcm_mixer_s *priv)
+{
+  int i;
+
+  for (i = 0; i < priv->nsources; i++)
+    {
+      if (priv->sources[i].running && !priv->sources[i].paused)
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_ready
+ *
+ * Description:
+ *   Decide whether to mix the next output buffer now.  Normally wait until
+ *   every active source has data queued so that no source underruns; once
+ *   the lower half is down to its last buffer, mix whatever is available.
+ *
+ ****************************************************************************/
+
+static bool pcm_mixer_ready(FAR struct pcm_mixer_s *priv)
+{
+  FAR struct pcm_mixer_source_s *src;
+  bool have = false;
+  bool all = true;
+  int i;
+
+  for (i = 0; i < priv->nsources; i++)
+    {
+      src = &priv->sources[i];
+      if (!src->running || src->paused)
+        {
+          continue;
+        }
+
+      if (!dq_empty(&src->pendq))
+        {
+          have = true;
+        }
+      else if (!src->final)
+        {
+          all = false;
+        }
+    }
+
+  return have && (all || priv->noutstanding < 2);
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_mix
+ *
+ * Description:
+ *   Mix one output buffer from all active sources.  Returns the number of
+ *   bytes placed in the buffer, zero if there was nothing to mix.  Called
+ *   with exclsem held.
+ *
+ ****************************************************************************/
+
+static int pcm_mixer_mix(FAR struct pcm_mixer_s *priv,
+                         FAR struct ap_buffer_s *apb)
+{
+  FAR struct pcm_mixer_source_s *src;
+  FAR int16_t *out = (FAR int16_t *)apb->samp;
+  int nframes = apb->nmaxbytes / PCM_MIXER_FRAMESIZE;
+  int maxframes = 0;
+  int n;
+  int i;
+
+  if (nframes > CONFIG_AUDIO_MIXER_NFRAMES)
+    {
+      nframes = CONFIG_AUDIO_MIXER_NFRAMES;
+    }
+
+  memset(priv->accum, 0, nframes * PCM_MIXER_NCHANNELS * sizeof(int32_t));
+
+  for (i = 0; i < priv->nsources; i++)
+    {
+      src = &priv->sources[i];
+      if (!src->running || src->paused)
+        {
+          continue;
+        }
+
+      n = pcm_mixer_render(src, priv->accum, nframes);
+      if (n > maxframes)
+        {
+          maxframes = n;
+        }
+
+      /* Return any buffers emptied by the last pull and complete the source
+       * once its final buffer has been consumed.
+       */
+
+      pcm_mixer_retire(src);
+      if (src->final && dq_empty(&src->pendq))
+        {
+          audvdbg("source %d complete\n", i);
+          src->running = false;
+          src->final   = false;
+          pcm_mixer_notify(src, AUDIO_CALLBACK_COMPLETE, NULL);
+        }
+    }
+
+  for (n = 0; n < maxframes * PCM_MIXER_NCHANNELS; n++)
+    {
+      out[n] = pcm_mixer_sat16(priv->accum[n]);
+    }
+
+  apb->curbyte = 0;
+  apb->nbytes  = maxframes * PCM_MIXER_FRAMESIZE;
+  apb->flags   = 0;
+
+  /* The last buffer before the mixer goes quiet ends the output stream */
+
+  if (!pcm_mixer_active(priv))
+    {
+      apb->flags |= AUDIO_APB_FINAL;
+    }
+
+  return apb->nbytes;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_startlower
+ *
+ * Description:
+ *   Configure the contained device for the mixer output format and start
+ *   it.
+ *
+ ****************************************************************************/
+
+static int pcm_mixer_startlower(FAR struct pcm_mixer_s *priv)
+{
+  FAR struct audio_lowerhalf_s *lower = priv->lower;
+  struct audio_caps_s caps;
+  int ret;
+
+  memset(&caps, 0, sizeof(caps));
+  caps.ac_len            = sizeof(struct audio_caps_s);
+  caps.ac_type           = AUDIO_TYPE_OUTPUT;
+  caps.ac_channels       = PCM_MIXER_NCHANNELS;
+  caps.ac_controls.hw[0] = CONFIG_AUDIO_MIXER_SAMPRATE;
+  caps.ac_controls.b[2]  = 16;
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  ret = lower->ops->configure(lower, priv->session, &caps);
+#else
+  ret = lower->ops->configure(lower, &caps);
+#endif
+  if (ret < 0)
+    {
+      auddbg("ERROR: Failed to configure lower: %d\n", ret);
+      return ret;
+    }
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  ret = lower->ops->start(lower, priv->session);
+#else
+  ret = lower->ops->start(lower);
+#endif
+  if (ret < 0)
+    {
+      auddbg("ERROR: Failed to start lower: %d\n", ret);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_stoplower
+ *
+ * Description:
+ *   Stop the contained device when all sources were stopped rather than
+ *   played to the end.
+ *
+ ****************************************************************************/
+
+static void pcm_mixer_stoplower(FAR struct pcm_mixer_s *priv)
+{
+#ifndef CONFIG_AUDIO_EXCLUDE_STOP
+  FAR struct audio_lowerhalf_s *lower = priv->lower;
+
+  audvdbg("Stopping lower\n");
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  lower->ops->stop(lower, priv->session);
+#else
+  lower->ops->stop(lower);
+#endif
+#endif
+
+  priv->lstate = PCM_MIXER_LOWER_IDLE;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_service
+ *
+ * Description:
+ *   Reclaim returned output buffers, then mix and enqueue as many new ones
+ *   as the sources allow.  Called by the worker thread with exclsem held.
+ *
+ ****************************************************************************/
+
+static void pcm_mixer_service(FAR struct pcm_mixer_s *priv)
+{
+  FAR struct audio_lowerhalf_s *lower = priv->lower;
+  FAR struct ap_buffer_s *apb;
+  irqstate_t flags;
+  int ret;
+
+  /* The doneq may be written from the lower half's interrupt handler */
+
+  flags = irqsave();
+  while ((apb = (FAR struct ap_buffer_s *)dq_remfirst(&priv->doneq)) != NULL)
+    {
+      dq_addlast(&apb->dq_entry, &priv->freeq);
+    }
+
+  if (priv->lcomplete)
+    {
+      priv->lcomplete = false;
+      if (priv->lstate == PCM_MIXER_LOWER_DRAINING)
+        {
+          priv->lstate = PCM_MIXER_LOWER_IDLE;
+        }
+    }
+  irqrestore(flags);
+
+  /* Nothing new goes to the lower half until it completes the last stream */
+
+  if (priv->lstate == PCM_MIXER_LOWER_DRAINING)
+    {
+      return;
+    }
+
+  while (!dq_empty(&priv->freeq) && pcm_mixer_ready(priv))
+    {
+      apb = (FAR struct ap_buffer_s *)dq_remfirst(&priv->freeq);
+      if (pcm_mixer_mix(priv, apb) == 0)
+        {
+          dq_addfirst(&apb->dq_entry, &priv->freeq);
+          break;
+        }
+
+      /* Count the buffer first: the lower half may return it before
+       * enqueuebuffer() even returns.
+       */
+
+      flags = irqsave();
+      priv->noutstanding++;
+      irqrestore(flags);
+
+      ret = lower->ops->enqueuebuffer(lower, apb);
+      if (ret < 0)
+        {
+          auddbg("ERROR: lower enqueuebuffer failed: %d\n", ret);
+
+          flags = irqsave();
+          priv->noutstanding--;
+          irqrestore(flags);
+
+          dq_addfirst(&apb->dq_entry, &priv->freeq);
+          break;
+        }
+
+      if (priv->lstate == PCM_MIXER_LOWER_IDLE)
+        {
+          if (pcm_mixer_startlower(priv) < 0)
+            {
+              break;
+            }
+
+          priv->lstate = PCM_MIXER_LOWER_RUNNING;
+        }
+
+      if ((apb->flags & AUDIO_APB_FINAL) != 0)
+        {
+          priv->lstate = PCM_MIXER_LOWER_DRAINING;
+          return;
+        }
+    }
+
+  /* All sources were stopped, not drained: stop the output as well */
+
+  if (priv->lstate == PCM_MIXER_LOWER_RUNNING && !pcm_mixer_active(priv))
+    {
+      pcm_mixer_stoplower(priv);
+    }
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_workerthread
+ *
+ * Description:
+ *   Runs while at least one source is reserved, mixing whenever a source
+ *   enqueues data or the lower half returns a buffer.
+ *
+ ****************************************************************************/
+
+static void *pcm_mixer_workerthread(pthread_addr_t arg)
+{
+  FAR struct pcm_mixer_s *priv = (FAR struct pcm_mixer_s *)arg;
+
+  audvdbg("Entry\n");
+
+  while (!priv->terminate)
+    {
+      pcm_mixer_takesem(&priv->wakeup);
+
+      pcm_mixer_takesem(&priv->exclsem);
+      if (!priv->terminate)
+        {
+          pcm_mixer_service(priv);
+        }
+
+      pcm_mixer_givesem(&priv->exclsem);
+    }
+
+  audvdbg("Exit\n");
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_allocbuffers
+ *
+ * Description:
+ *   Allocate the mixed output buffers, from the lower half if it has its
+ *   own allocator.
+ *
+ ****************************************************************************/
+
+static int pcm_mixer_allocbuffers(FAR struct pcm_mixer_s *priv)
+{
+  FAR struct audio_lowerhalf_s *lower = priv->lower;
+  struct audio_buf_desc_s desc;
+  int ret;
+  int i;
+
+  dq_init(&priv->freeq);
+  dq_init(&priv->doneq);
+
+  for (i = 0; i < CONFIG_AUDIO_MIXER_NBUFFERS; i++)
+    {
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+      desc.session    = priv->session;
+#endif
+      desc.numbytes   = CONFIG_AUDIO_MIXER_NFRAMES * PCM_MIXER_FRAMESIZE;
+      desc.u.ppBuffer = &priv->outbuf[i];
+
+      if (lower->ops->allocbuffer)
+        {
+          ret = lower->ops->allocbuffer(lower, &desc);
+        }
+      else
+        {
+          ret = apb_alloc(&desc);
+        }
+
+      if (ret < 0)
+        {
+          auddbg("ERROR: Failed to allocate output buffer: %d\n", ret);
+          priv->outbuf[i] = NULL;
+          return ret;
+        }
+
+      dq_addlast(&priv->outbuf[i]->dq_entry, &priv->freeq);
+    }
+
+  priv->noutstanding = 0;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_freebuffers
+ ****************************************************************************/
+
+static void pcm_mixer_freebuffers(FAR struct pcm_mixer_s *priv)
+{
+  FAR struct audio_lowerhalf_s *lower = priv->lower;
+  struct audio_buf_desc_s desc;
+  int i;
+
+  for (i = 0; i < CONFIG_AUDIO_MIXER_NBUFFERS; i++)
+    {
+      if (priv->outbuf[i] == NULL)
+        {
+          continue;
+        }
+
+      if (lower->ops->freebuffer)
+        {
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+          desc.session   = priv->session;
+#endif
+          desc.u.pBuffer = priv->outbuf[i];
+          lower->ops->freebuffer(lower, &desc);
+        }
+      else
+        {
+          apb_free(priv->outbuf[i]);
+        }
+
+      priv->outbuf[i] = NULL;
+    }
+
+  dq_init(&priv->freeq);
+  dq_init(&priv->doneq);
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_getcaps
+ *
+ * Description:
+ *   Report the capabilities of the contained device, restricted to PCM.
+ *
+ ****************************************************************************/
+
+static int pcm_mixer_getcaps(FAR struct audio_lowerhalf_s *dev, int type,
+                             FAR struct audio_caps_s *caps)
+{
+  FAR struct pcm_mixer_source_s *src = (FAR struct pcm_mixer_source_s *)dev;
+  FAR struct audio_lowerhalf_s *lower;
+  int ret;
+
+  DEBUGASSERT(src);
+
+  lower = src->mixer->lower;
+  DEBUGASSERT(lower && lower->ops->getcaps);
+
+  ret = lower->ops->getcaps(lower, type, caps);
+  if (ret < 0)
+    {
+      auddbg("Lower getcaps() failed: %d\n", ret);
+      return ret;
+    }
+
+  if (caps->ac_subtype == AUDIO_TYPE_QUERY)
+    {
+      caps->ac_format.hw = (1 << (AUDIO_FMT_PCM - 1));
+    }
+
+  return caps->ac_len;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_configure
+ *
+ * Description:
+ *   Set the input format or volume of a source.  Nothing is forwarded to
+ *   the contained device, which always runs at the mixer output format.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int pcm_mixer_configure(FAR struct audio_lowerhalf_s *dev,
+                               FAR void *session,
+                               FAR const struct audio_caps_s *caps)
+#else
+static int pcm_mixer_configure(FAR struct audio_lowerhalf_s *dev,
+                               FAR const struct audio_caps_s *caps)
+#endif
+{
+  FAR struct pcm_mixer_source_s *src = (FAR struct pcm_mixer_source_s *)dev;
+  FAR struct pcm_mixer_s *priv;
+  uint32_t samprate;
+  int ret = OK;
+
+  DEBUGASSERT(src && caps);
+  priv = src->mixer;
+
+  pcm_mixer_takesem(&priv->exclsem);
+  switch (caps->ac_type)
+    {
+    case AUDIO_TYPE_FEATURE:
+#ifndef CONFIG_AUDIO_EXCLUDE_VOLUME
+      if (caps->ac_format.hw == AUDIO_FU_VOLUME)
+        {
+          uint16_t volume = caps->ac_controls.hw[0];
+
+          audvdbg("    Volume: %d\n", volume);
+          if (volume <= 1000)
+            {
+              src->gain = (int16_t)((PCM_MIXER_GAIN_MAX * volume) / 1000);
+            }
+          else
+            {
+              ret = -EDOM;
+            }
+
+          break;
+        }
+#endif
+
+      ret = -ENOTTY;
+      break;
+
+    case AUDIO_TYPE_OUTPUT:
+      samprate = caps->ac_controls.hw[0];
+
+      audvdbg("  AUDIO_TYPE_OUTPUT:\n");
+      audvdbg("    Number of channels: %u\n", caps->ac_channels);
+      audvdbg("    Sample rate:        %u\n", samprate);
+      audvdbg("    Sample width:       %u\n", caps->ac_controls.b[2]);
+
+      if (caps->ac_controls.b[2] != 16 ||
+          (caps->ac_channels != 1 && caps->ac_channels != 2) ||
+          samprate == 0)
+        {
+          auddbg("ERROR: Unsupported format\n");
+          ret = -ERANGE;
+          break;
+        }
+
+      if (src->running)
+        {
+          ret = -EBUSY;
+          break;
+        }
+
+      src->nchannels = caps->ac_channels;
+      src->samprate  = samprate;
+      src->step      = (uint32_t)(((uint64_t)samprate << 16) /
+                                  CONFIG_AUDIO_MIXER_SAMPRATE);
+      src->frac      = 0;
+      memset(src->hist, 0, sizeof(src->hist));
+      break;
+
+    default:
+      ret = -ENOTTY;
+      break;
+    }
+
+  pcm_mixer_givesem(&priv->exclsem);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_shutdown
+ *
+ * Description:
+ *   Drop anything queued on this source.  The contained device is shared
+ *   and is only shut down when the last source is released.
+ *
+ ****************************************************************************/
+
+static int pcm_mixer_shutdown(FAR struct audio_lowerhalf_s *dev)
+{
+  FAR struct pcm_mixer_source_s *src = (FAR struct pcm_mixer_source_s *)dev;
+  FAR struct pcm_mixer_s *priv = src->mixer;
+
+  pcm_mixer_takesem(&priv->exclsem);
+  pcm_mixer_drop(src);
+  pcm_mixer_givesem(&priv->exclsem);
+
+  pcm_mixer_givesem(&priv->wakeup);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_start
+ ****************************************************************************/
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int pcm_mixer_start(FAR struct audio_lowerhalf_s *dev,
+                           FAR void *session)
+#else
+static int pcm_mixer_start(FAR struct audio_lowerhalf_s *dev)
+#endif
+{
+  FAR struct pcm_mixer_source_s *src = (FAR struct pcm_mixer_source_s *)dev;
+  FAR struct pcm_mixer_s *priv = src->mixer;
+
+  audvdbg("Entry\n");
+
+  pcm_mixer_takesem(&priv->exclsem);
+  if (!src->reserved)
+    {
+      pcm_mixer_givesem(&priv->exclsem);
+      return -EINVAL;
+    }
+
+  src->running = true;
+  src->paused  = false;
+  pcm_mixer_givesem(&priv->exclsem);
+
+  pcm_mixer_givesem(&priv->wakeup);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_stop
+ ****************************************************************************/
+
+#ifndef CONFIG_AUDIO_EXCLUDE_STOP
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int pcm_mixer_stop(FAR struct audio_lowerhalf_s *dev,
+                          FAR void *session)
+#else
+static int pcm_mixer_stop(FAR struct audio_lowerhalf_s *dev)
+#endif
+{
+  FAR struct pcm_mixer_source_s *src = (FAR struct pcm_mixer_source_s *)dev;
+  FAR struct pcm_mixer_s *priv = src->mixer;
+
+  audvdbg("Entry\n");
+
+  pcm_mixer_takesem(&priv->exclsem);
+  pcm_mixer_drop(src);
+  pcm_mixer_givesem(&priv->exclsem);
+
+  pcm_mixer_givesem(&priv->wakeup);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: pcm_mixer_pause
+ *
+ * Description:
+ *   Pause one source.  The other sources keep playing.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_AUDIO_EXCLUDE_PAUSE_RESUME
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int pcm_mixer_pause(FAR struct audio_lowerhalf_s *dev,
+                           FAR void *session)
+#else
+static int pcm_mixer_pause(FAR struct audio_lowerhalf_s *dev)
+#endif
+{
+  FAR struct pcm_mixer_source_s *src = (FAR struct pcm_mixer_source_s *)dev;
+  FAR struct pcm_mixer_s *priv = src->mixer;
+
+  pcm_mixer_takesem(&priv->exclsem);
+  src->paused = true;
+  pcm_mixer_givesem(&priv->exclsem);
+
+  pcm_mixer_givesem(&priv->wakeup);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_resume
+ ****************************************************************************/
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int pcm_mixer_resume(FAR struct audio_lowerhalf_s *dev,
+                            FAR void *session)
+#else
+static int pcm_mixer_resume(FAR struct audio_lowerhalf_s *dev)
+#endif
+{
+  FAR struct pcm_mixer_source_s *src = (FAR struct pcm_mixer_source_s *)dev;
+  FAR struct pcm_mixer_s *priv = src->mixer;
+
+  pcm_mixer_takesem(&priv->exclsem);
+  src->paused = false;
+  pcm_mixer_givesem(&priv->exclsem);
+
+  pcm_mixer_givesem(&priv->wakeup);
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Name: pcm_mixer_enqueuebuffer
+ *
+ * Description:
+ *   Queue a buffer of PCM data on a source.  The buffer is returned with
+ *   AUDIO_CALLBACK_DEQUEUE once it has been mixed.
+ *
+ ****************************************************************************/
+
+static int pcm_mixer_enqueuebuffer(FAR struct audio_lowerhalf_s *dev,
+                                   FAR struct ap_buffer_s *apb)
+{
+  FAR struct pcm_mixer_source_s *src = (FAR struct pcm_mixer_source_s *)dev;
+  FAR struct pcm_mixer_s *priv = src->mixer;
+
+  audvdbg("Enqueueing: apb=%p curbyte=%d nbytes=%d flags=%04x\n",
+          apb, apb->curbyte, apb->nbytes, apb->flags);
+
+  /* Take a reference on the new audio buffer */
+
+  apb_reference(apb);
+
+  pcm_mixer_takesem(&priv->exclsem);
+  apb->flags |= AUDIO_APB_OUTPUT_ENQUEUED;
+  dq_addlast(&apb->dq_entry, &src->pendq);
+
+  if ((apb->flags & AUDIO_APB_FINAL) != 0)
+    {
+      src->final = true;
+    }
+
+  pcm_mixer_givesem(&priv->exclsem);
+
+  pcm_mixer_givesem(&priv->wakeup);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_cancelbuffer
+ ****************************************************************************/
+
+static int pcm_mixer_cancelbuffer(FAR struct audio_lowerhalf_s *dev,
+                                  FAR struct ap_buffer_s *apb)
+{
+  audvdbg("apb=%p\n", apb);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_ioctl
+ *
+ * Description:
+ *   The contained device is shared by all sources, so device specific
+ *   ioctls are not forwarded.
+ *
+ ****************************************************************************/
+
+static int pcm_mixer_ioctl(FAR struct audio_lowerhalf_s *dev, int cmd,
+                           unsigned long arg)
+{
+  return -ENOTTY;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_reserve
+ *
+ * Description:
+ *   Reserve a source.  The first reservation also reserves the contained
+ *   device, allocates the output buffers and starts the worker thread.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int pcm_mixer_reserve(FAR struct audio_lowerhalf_s *dev,
+                             FAR void **session)
+#else
+static int pcm_mixer_reserve(FAR struct audio_lowerhalf_s *dev)
+#endif
+{
+  FAR struct pcm_mixer_source_s *src = (FAR struct pcm_mixer_source_s *)dev;
+  FAR struct pcm_mixer_s *priv = src->mixer;
+  FAR struct audio_lowerhalf_s *lower = priv->lower;
+  struct sched_param sparam;
+  pthread_attr_t tattr;
+  int ret = OK;
+
+  pcm_mixer_takesem(&priv->exclsem);
+  if (src->reserved)
+    {
+      ret = -EBUSY;
+      goto errout;
+    }
+
+  if (priv->nreserved == 0)
+    {
+      DEBUGASSERT(lower->ops->reserve);
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+      ret = lower->ops->reserve(lower, &priv->session);
+#else
+      ret = lower->ops->reserve(lower);
+#endif
+      if (ret < 0)
+        {
+          goto errout;
+        }
+
+      ret = pcm_mixer_allocbuffers(priv);
+      if (ret < 0)
+        {
+          goto errout_with_lower;
+        }
+
+      priv->terminate = false;
+      priv->lcomplete = false;
+      priv->lstate    = PCM_MIXER_LOWER_IDLE;
+
+      pthread_attr_init(&tattr);
+      sparam.sched_priority = sched_get_priority_max(SCHED_FIFO) - 3;
+      (void)pthread_attr_setschedparam(&tattr, &sparam);
+      (void)pthread_attr_setstacksize(&tattr,
+                                      CONFIG_AUDIO_MIXER_WORKER_STACKSIZE);
+
+      ret = pthread_create(&priv->threadid, &tattr, pcm_mixer_workerthread,
+                           (pthread_addr_t)priv);
+      if (ret != OK)
+        {
+          auddbg("ERROR: pthread_create failed: %d\n", ret);
+          ret = -ret;
+          goto errout_with_buffers;
+        }
+
+      pthread_setname_np(priv->threadid, "pcm_mixer");
+    }
+
+  priv->nreserved++;
+  src->reserved = true;
+  src->running  = false;
+  src->paused   = false;
+  src->final    = false;
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  *session = src;
+#endif
+
+  pcm_mixer_givesem(&priv->exclsem);
+  return OK;
+
+errout_with_buffers:
+  pcm_mixer_freebuffers(priv);
+
+errout_with_lower:
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  lower->ops->release(lower, priv->session);
+#else
+  lower->ops->release(lower);
+#endif
+
+errout:
+  pcm_mixer_givesem(&priv->exclsem);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_release
+ *
+ * Description:
+ *   Release a source.  The last release stops the worker thread and
+ *   releases the contained device.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static int pcm_mixer_release(FAR struct audio_lowerhalf_s *dev,
+                             FAR void *session)
+#else
+static int pcm_mixer_release(FAR struct audio_lowerhalf_s *dev)
+#endif
+{
+  FAR struct pcm_mixer_source_s *src = (FAR struct pcm_mixer_source_s *)dev;
+  FAR struct pcm_mixer_s *priv = src->mixer;
+  FAR struct audio_lowerhalf_s *lower = priv->lower;
+  FAR void *value;
+
+  pcm_mixer_takesem(&priv->exclsem);
+  if (!src->reserved)
+    {
+      pcm_mixer_givesem(&priv->exclsem);
+      return -EINVAL;
+    }
+
+  pcm_mixer_drop(src);
+  src->reserved = false;
+
+  if (--priv->nreserved > 0)
+    {
+      pcm_mixer_givesem(&priv->exclsem);
+      pcm_mixer_givesem(&priv->wakeup);
+      return OK;
+    }
+
+  /* Last one out: stop the worker, then the contained device */
+
+  priv->terminate = true;
+  pcm_mixer_givesem(&priv->exclsem);
+  pcm_mixer_givesem(&priv->wakeup);
+
+  pthread_join(priv->threadid, &value);
+  priv->threadid = 0;
+
+  pcm_mixer_takesem(&priv->exclsem);
+  if (priv->lstate != PCM_MIXER_LOWER_IDLE)
+    {
+      pcm_mixer_stoplower(priv);
+    }
+
+  pcm_mixer_freebuffers(priv);
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+  lower->ops->release(lower, priv->session);
+#else
+  lower->ops->release(lower);
+#endif
+
+  pcm_mixer_givesem(&priv->exclsem);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: pcm_mixer_callback
+ *
+ * Description:
+ *   Lower-to-upper level callback for the mixed output buffers.  This may
+ *   be called from an interrupt handler, so it only queues the buffer and
+ *   wakes up the worker thread.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_AUDIO_MULTI_SESSION
+static void pcm_mixer_callback(FAR void *arg, uint16_t reason,
+                               FAR struct ap_buffer_s *apb, uint16_t status,
+                               FAR void *session)
+#else
+static void pcm_mixer_callback(FAR void *arg, uint16_t reason,
+                               FAR struct ap_buffer_s *apb, uint16_t status)
+#endif
+{
+  FAR struct pcm_mixer_s *priv = (FAR struct pcm_mixer_s *)arg;
+  irqstate_t flags;
+
+  DEBUGASSERT(priv);
+
+  switch (reason)
+    {
+    case AUDIO_CALLBACK_DEQUEUE:
+      DEBUGASSERT(apb);
+
+      flags = irqsave();
+      dq_addlast(&apb->dq_entry, &priv->doneq);
+      DEBUGASSERT(priv->noutstanding > 0);
+      priv->noutstanding--;
+      irqrestore(flags);
+      break;
+
+    case AUDIO_CALLBACK_COMPLETE:
+      priv->lcomplete = true;
+      break;
+
+    case AUDIO_CALLBACK_IOERR:
+      auddbg("ERROR: lower I/O error: %d\n", status);
+      break;
+
+    default:
+      return;
+    }
+
+  pcm_mixer_givesem(&priv->wakeup);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pcm_mixer_initialize
+ *
+ * Description:
+ *   Initialize a PCM mixer.  The mixer contains a low-level audio DAC-type
+ *   device and returns nsources new audio lower halves, each of which can
+ *   be registered with audio_register().  Raw 16-bit mono or stereo PCM at
+ *   any sample rate may be played on each source; the streams are
+ *   resampled to CONFIG_AUDIO_MIXER_SAMPRATE, scaled by their volume and
+ *   summed into a single 16-bit stereo stream for the low-level device.
+ *   Use pcm_decode_initialize() on a source to accept WAV files.
+ *
+ * Input Parameters:
+ *   dev      - A reference to the low-level audio DAC-type device to
+ *              contain.
+ *   sources  - Receives the nsources mixer inputs.
+ *   nsources - Number of inputs to create.
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int pcm_mixer_initialize(FAR struct audio_lowerhalf_s *dev,
+                         FAR struct audio_lowerhalf_s **sources,
+                         int nsources)
+{
+  FAR struct pcm_mixer_s *priv;
+  FAR struct pcm_mixer_source_s *src;
+  int i;
+
+  DEBUGASSERT(dev && sources);
+
+  if (nsources < 1 || nsources > UINT8_MAX)
+    {
+      return -EINVAL;
+    }
+
+  /* Allocate the mixer and its sources in one block */
+
+  priv = (FAR struct pcm_mixer_s *)
+    kmm_zalloc(sizeof(struct pcm_mixer_s) +
+               nsources * sizeof(struct pcm_mixer_source_s));
+  if (!priv)
+    {
+      auddbg("ERROR: Failed to allocate driver structure\n");
+      return -ENOMEM;
+    }
+
+  sem_init(&priv->exclsem, 0, 1);
+  sem_init(&priv->wakeup, 0, 0);
+
+  priv->nsources = nsources;
+  priv->sources  = (FAR struct pcm_mixer_source_s *)&priv[1];
+
+  for (i = 0; i < nsources; i++)
+    {
+      src             = &priv->sources[i];
+      src->export.ops = &g_pcm_mixer_ops;
+      src->mixer      = priv;
+      src->nchannels  = PCM_MIXER_NCHANNELS;
+      src->samprate   = CONFIG_AUDIO_MIXER_SAMPRATE;
+      src->step       = PCM_MIXER_UNITY;
+      src->gain       = PCM_MIXER_GAIN_MAX;
+      dq_init(&src->pendq);
+
+      sources[i] = &src->export;
+    }
+
+  /* Bind to the low-level device.  Buffers it returns come back to the
+   * mixer rather than to any upper half.
+   */
+
+  priv->lower = dev;
+  dev->upper  = pcm_mixer_callback;
+  dev->priv   = priv;
+
+  return OK;
+}
+
+#endif /* CONFIG_AUDIO && CONFIG_AUDIO_MIXER */
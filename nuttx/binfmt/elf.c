@@ -121,6 +121,10 @@ static void elf_dumploadinfo(FAR struct elf_loadinfo_s *loadinfo)
   bdbg("  textsize:     %ld\n",   (long)loadinfo->textsize);
   bdbg("  datasize:     %ld\n",   (long)loadinfo->datasize);
   bdbg("  filelen:      %ld\n",   (long)loadinfo->filelen);
+#ifdef CONFIG_ELF_XIP
+  bdbg("  xipbase:      %08lx\n", (long)loadinfo->xipbase);
+  bdbg("  xiptext:      %08lx\n", (long)loadinfo->xiptext);
+#endif
 #ifdef CONFIG_BINFMT_CONSTRUCTORS
   bdbg("  ctoralloc:    %08lx\n", (long)loadinfo->ctoralloc);
   bdbg("  ctors:        %08lx\n", (long)loadinfo->ctors);
@@ -262,7 +266,7 @@ static int elf_loadbinary(FAR struct binary_s *binp)
 
   /* Return the load information */
 
-  binp->entrypt   = (main_t)(loadinfo.textalloc + loadinfo.ehdr.e_entry);
+  binp->entrypt   = (main_t)(ELF_TEXTBASE(&loadinfo) + loadinfo.ehdr.e_entry);
   binp->stacksize = CONFIG_ELF_STACKSIZE;
 
   /* Add the ELF allocation to the alloc[] only if there is no address
@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <sys/types.h>
+#include <sys/ioctl.h>
 
 #include <stdint.h>
 #include <stdlib.h>
@@ -51,6 +52,7 @@
 #include <debug.h>
 
 #include <nuttx/addrenv.h>
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/binfmt/elf.h>
 
 #include "libelf.h"
@@ -71,6 +73,16 @@
 #  define MIN(x,y) ((x) < (y) ? (x) : (y))
 #endif
 
+/* True if the section is used in place rather than copied into RAM */
+
+#ifdef CONFIG_ELF_XIP
+#  define elf_xipsection(l,s) \
+     ((l)->xipbase != NULL && ((s)->sh_flags & (SHF_ALLOC | SHF_WRITE)) == \
+      SHF_ALLOC && (s)->sh_type != SHT_NOBITS)
+#else
+#  define elf_xipsection(l,s) false
+#endif
+
 /****************************************************************************
  * Private Constant Data
  ****************************************************************************/
@@ -79,6 +91,71 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: elf_xipinit
+ *
+ * Description:
+ *   Decide whether the read-only sections can be executed in place: the
+ *   file must be memory mapped, no relocation section may patch a read-only
+ *   section, and each read-only section must meet its alignment where it
+ *   lies.  Sets loadinfo->xipbase (NULL if the module must be copied).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_ELF_XIP
+static void elf_xipinit(FAR struct elf_loadinfo_s *loadinfo)
+{
+  FAR void *xipbase = NULL;
+  int ret;
+  int i;
+
+  loadinfo->xipbase = NULL;
+  loadinfo->xiptext = 0;
+
+  ret = ioctl(loadinfo->filfd, FIOC_MMAP, (unsigned long)((uintptr_t)&xipbase));
+  if (ret < 0 || xipbase == NULL)
+    {
+      bvdbg("File is not memory mapped, copying text\n");
+      return;
+    }
+
+  for (i = 0; i < loadinfo->ehdr.e_shnum; i++)
+    {
+      FAR Elf32_Shdr *shdr = &loadinfo->shdr[i];
+      FAR Elf32_Shdr *dst;
+
+      if (shdr->sh_type == SHT_REL || shdr->sh_type == SHT_RELA)
+        {
+          if (shdr->sh_info >= loadinfo->ehdr.e_shnum)
+            {
+              continue;
+            }
+
+          /* Text that must be relocated cannot stay in flash */
+
+          dst = &loadinfo->shdr[shdr->sh_info];
+          if ((dst->sh_flags & (SHF_ALLOC | SHF_WRITE)) == SHF_ALLOC &&
+              shdr->sh_size > 0)
+            {
+              bvdbg("Section %d has relocations, copying text\n",
+                    shdr->sh_info);
+              return;
+            }
+        }
+      else if ((shdr->sh_flags & (SHF_ALLOC | SHF_WRITE)) == SHF_ALLOC &&
+               shdr->sh_type != SHT_NOBITS && shdr->sh_addralign > 1 &&
+               (((uintptr_t)xipbase + shdr->sh_offset) &
+                (shdr->sh_addralign - 1)) != 0)
+        {
+          bvdbg("Section %d is misaligned in place, copying text\n", i);
+          return;
+        }
+    }
+
+  loadinfo->xipbase = (FAR const uint8_t *)xipbase;
+}
+#endif
+
 /****************************************************************************
  * Name: elf_elfsize
  *
@@ -110,7 +187,8 @@ static void elf_elfsize(struct elf_loadinfo_s *loadinfo)
        * execution.
        */
 
-      if ((shdr->sh_flags & SHF_ALLOC) != 0)
+      if ((shdr->sh_flags & SHF_ALLOC) != 0 &&
+          !elf_xipsection(loadinfo, shdr))
         {
           /* SHF_WRITE indicates that the section address space is write-
            * able
@@ -172,6 +250,24 @@ static inline int elf_loadfile(FAR struct elf_loadinfo_s *loadinfo)
           continue;
         }
 
+#ifdef CONFIG_ELF_XIP
+      /* Read-only sections of an XIP module stay in the memory mapped
+       * file.  The first one is .text (see gnu-elf.ld).
+       */
+
+      if (elf_xipsection(loadinfo, shdr))
+        {
+          shdr->sh_addr = (uintptr_t)loadinfo->xipbase + shdr->sh_offset;
+          if (loadinfo->xiptext == 0)
+            {
+              loadinfo->xiptext = shdr->sh_addr;
+            }
+
+          bvdbg("%d. XIP %08lx\n", i, (unsigned long)shdr->sh_addr);
+          continue;
+        }
+#endif
+
       /* SHF_WRITE indicates that the section address space is write-
        * able
        */
@@ -259,6 +355,12 @@ int elf_load(FAR struct elf_loadinfo_s *loadinfo)
       goto errout_with_buffers;
     }
 
+#ifdef CONFIG_ELF_XIP
+  /* Check if the read-only sections can be executed in place */
+
+  elf_xipinit(loadinfo);
+#endif
+
   /* Determine total size to allocate */
 
   elf_elfsize(loadinfo);
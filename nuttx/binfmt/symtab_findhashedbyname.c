@@ -0,0 +1,133 @@
+/****************************************************************************
+ * binfmt/symtab_findhashedbyname.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include <nuttx/binfmt/symtab.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define FNV32_OFFSET 2166136261u
+#define FNV32_PRIME  16777619u
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: symtab_hash
+ *
+ * Description:
+ *   Return the hash of a symbol name (32-bit FNV-1a).  This must match the
+ *   hash computed by tools/mksymtab.c.
+ *
+ ****************************************************************************/
+
+uint32_t symtab_hash(FAR const char *name)
+{
+  uint32_t hash = FNV32_OFFSET;
+
+  while (*name != '\0')
+    {
+      hash ^= (uint8_t)*name++;
+      hash *= FNV32_PRIME;
+    }
+
+  return hash;
+}
+
+/****************************************************************************
+ * Name: symtab_findhashedbyname
+ *
+ * Description:
+ *   Find the symbol in the symbol table with the matching name.
+ *   This version assumes that table is ordered with respect to sym_hash.
+ *   The name is hashed once; the search then compares integers and only
+ *   calls strcmp() on entries with the same hash.
+ *
+ * Returned Value:
+ *   A reference to the symbol table entry if an entry with the matching
+ *   name is found; NULL is returned if the entry is not found.
+ *
+ ****************************************************************************/
+
+FAR const struct symtab_s *
+symtab_findhashedbyname(FAR const struct symtab_s *symtab,
+                        FAR const char *name, int nsyms)
+{
+  uint32_t hash;
+  int low  = 0;
+  int high = nsyms;
+  int mid;
+
+  DEBUGASSERT(symtab != NULL && name != NULL);
+  hash = symtab_hash(name);
+
+  /* Find the first entry with sym_hash >= hash */
+
+  while (low < high)
+    {
+      mid = (low + high) >> 1;
+      if (symtab[mid].sym_hash < hash)
+        {
+          low = mid + 1;
+        }
+      else
+        {
+          high = mid;
+        }
+    }
+
+  /* Then check each entry that has the same hash */
+
+  for (; low < nsyms && symtab[low].sym_hash == hash; low++)
+    {
+      if (strcmp(name, symtab[low].sym_name) == 0)
+        {
+          return &symtab[low];
+        }
+    }
+
+  return NULL;
+}
@@ -54,6 +54,7 @@
 
 #include <nuttx/list.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/bufram.h>
 #include <nuttx/arch.h>
 #include <nuttx/serial/serial.h>
 #include <nuttx/usb_device.h>
@@ -119,6 +120,10 @@
 #define APBRIDGE_NREQS               (1)
 #define APBRIDGE_REQ_SIZE            (2048)
 
+/* Messages in an aggregated transfer start on 4 bytes boundaries */
+
+#define APBRIDGE_AGG_ALIGN(len)      (((len) + 3) & ~3)
+
 #define APBRIDGE_CONFIG_ATTR \
   USB_CONFIG_ATTR_ONE | \
   USB_CONFIG_ATTR_SELFPOWER | \
@@ -176,6 +181,25 @@ struct apbridge_msg_s {
     void *priv;
 };
 
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+/* Bulk IN aggregation buffer */
+
+struct apbridge_agg_s {
+    struct list_head list;
+    uint8_t *buf;
+    size_t len;
+};
+
+/* Bulk OUT request of the multiplexed endpoint, with the number of messages
+ * of its last transfer that have not been released yet.
+ */
+
+struct apbridge_rdagg_s {
+    struct usbdev_req_s *req;
+    unsigned int pending;
+};
+#endif
+
 /* This structure describes the internal state of the driver */
 
 struct apbridge_dev_s {
@@ -196,6 +220,16 @@ struct apbridge_dev_s {
     struct gadget_descriptor *g_desc;
 
     struct apbridge_usb_driver *driver;
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+
+    bool aggregate;             /* Multiplexed endpoints are aggregated */
+    unsigned int agg_inflight;  /* Aggregates submitted on bulk IN */
+    struct list_head agg_free;  /* Empty aggregation buffers */
+    struct list_head agg_fill;  /* Aggregates not submitted yet */
+    struct list_head agg_queue; /* Messages waiting for a free buffer */
+    struct apbridge_agg_s agg[CONFIG_APBRIDGE_AGGREGATE_NBUFS];
+    struct apbridge_rdagg_s rdagg[APBRIDGE_NREQS];
+#endif
 };
 
 typedef uint16_t __le16;
@@ -232,6 +266,10 @@ static void usbclass_rdcomplete(struct usbdev_ep_s *ep,
                                 struct usbdev_req_s *req);
 static void usbclass_wrcomplete(struct usbdev_ep_s *ep,
                                 struct usbdev_req_s *req);
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+static void usbclass_aggcomplete(struct usbdev_ep_s *ep,
+                                 struct usbdev_req_s *req);
+#endif
 
 /* USB class device ********************************************************/
 
@@ -391,7 +429,7 @@ static unsigned int get_cportid(const struct gb_operation_hdr *hdr)
     return hdr->pad[0];
 }
 
-static int apbridge_queue(struct apbridge_dev_s *priv, struct usbdev_ep_s *ep,
+static int apbridge_queue(struct list_head *queue, struct usbdev_ep_s *ep,
                           const void *payload, size_t len, void *data)
 {
     irqstate_t flags;
@@ -408,24 +446,24 @@ static int apbridge_queue(struct apbridge_dev_s *priv, struct usbdev_ep_s *ep,
     info->priv = data;
 
     flags = irqsave();
-    list_add(&priv->msg_queue, &info->list);
+    list_add(queue, &info->list);
     irqrestore(flags);
 
     return OK;
 }
 
-static struct apbridge_msg_s *apbridge_dequeue(struct apbridge_dev_s *priv)
+static struct apbridge_msg_s *apbridge_dequeue(struct list_head *queue)
 {
     irqstate_t flags;
     struct list_head *list;
 
     flags = irqsave();
-    if (list_is_empty(&priv->msg_queue)) {
+    if (list_is_empty(queue)) {
         irqrestore(flags);
         return NULL;
     }
 
-    list = priv->msg_queue.next;
+    list = queue->next;
     list_del(list);
     irqrestore(flags);
     return list_entry(list, struct apbridge_msg_s, list);
@@ -467,6 +505,217 @@ static int _to_usb_submit(struct usbdev_ep_s *ep, struct usbdev_req_s *req,
     return 0;
 }
 
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+/*
+ * Submit the aggregates that are ready: all but the last one, which are
+ * full, and the last one too if it is big enough or if nothing is in flight
+ * on the endpoint. A partial aggregate therefore never waits for more than
+ * one transfer. Must be called with interrupts disabled.
+ */
+static void apbridge_agg_flush(struct apbridge_dev_s *priv, bool force)
+{
+    struct usbdev_ep_s *ep = priv->ep[CONFIG_APBRIDGE_EPBULKIN];
+    struct apbridge_agg_s *agg;
+    struct usbdev_req_s *req;
+    int ret;
+
+    while (!list_is_empty(&priv->agg_fill)) {
+        agg = list_entry(priv->agg_fill.next, struct apbridge_agg_s, list);
+        if (!force && agg->list.next == &priv->agg_fill &&
+            agg->len < CONFIG_APBRIDGE_AGGREGATE_THRESHOLD &&
+            priv->agg_inflight > 0) {
+            break;
+        }
+
+        req = get_request(ep, usbclass_aggcomplete, APBRIDGE_REQ_SIZE, agg);
+        if (!req) {
+            break;
+        }
+
+        list_del(&agg->list);
+        req->buf = agg->buf;
+        req->len = agg->len;
+        req->flags = USBDEV_REQFLAGS_NULLPKT;
+
+        ret = EP_SUBMIT(ep, req);
+        if (ret != OK) {
+            usbtrace(TRACE_CLSERROR(USBSER_TRACEERR_SUBMITFAIL),
+                     (uint16_t) - ret);
+            put_request(req);
+            agg->len = 0;
+            list_add(&priv->agg_free, &agg->list);
+            continue;
+        }
+        priv->agg_inflight++;
+    }
+}
+
+/*
+ * Copy a message at the end of the last aggregate, or in a new one if it
+ * does not fit, and give the UniPro buffer back right away.
+ * Must be called with interrupts disabled.
+ * @return false if there is no aggregation buffer left
+ */
+static bool apbridge_agg_copy(struct apbridge_dev_s *priv,
+                              unsigned int cportid,
+                              const void *payload, size_t len)
+{
+    const struct gb_operation_hdr *gbhdr = payload;
+    struct apbridge_agg_s *agg = NULL;
+    size_t padded = APBRIDGE_AGG_ALIGN(len);
+
+    if (!list_is_empty(&priv->agg_fill)) {
+        agg = list_entry(priv->agg_fill.prev, struct apbridge_agg_s, list);
+        if (agg->len + padded > APBRIDGE_REQ_SIZE) {
+            agg = NULL;
+        }
+    }
+
+    if (!agg) {
+        if (list_is_empty(&priv->agg_free)) {
+            return false;
+        }
+
+        agg = list_entry(priv->agg_free.next, struct apbridge_agg_s, list);
+        list_del(&agg->list);
+        list_add(&priv->agg_fill, &agg->list);
+    }
+
+    gb_timestamp_tag_exit_time(&priv->ts[cportid], cportid);
+    if (gbhdr->type & GB_TYPE_RESPONSE_FLAG) {
+        gb_timestamp_log(&priv->ts[cportid], cportid,
+                         (void *) payload, len, GREYBUS_FW_TIMESTAMP_APBRIDGE);
+    }
+
+    memcpy(agg->buf + agg->len, payload, len);
+    memset(agg->buf + agg->len + len, 0, padded - len);
+    agg->len += padded;
+
+    unipro_rxbuf_free(cportid, (void *) payload);
+    return true;
+}
+
+static int apbridge_agg_to_usb(struct apbridge_dev_s *priv,
+                               unsigned int cportid,
+                               const void *payload, size_t len)
+{
+    irqstate_t flags;
+    int ret = 0;
+
+    flags = irqsave();
+
+    /* Keep the messages in order while some wait for a buffer */
+
+    if (!list_is_empty(&priv->agg_queue) ||
+        !apbridge_agg_copy(priv, cportid, payload, len)) {
+        ret = apbridge_queue(&priv->agg_queue,
+                             priv->ep[CONFIG_APBRIDGE_EPBULKIN],
+                             payload, len, (void*) cportid);
+    }
+
+    apbridge_agg_flush(priv, false);
+    irqrestore(flags);
+
+    return ret;
+}
+
+static struct apbridge_rdagg_s *
+apbridge_rdagg_find(struct apbridge_dev_s *priv, const void *buf)
+{
+    const uint8_t *start;
+    int i;
+
+    for (i = 0; i < APBRIDGE_NREQS; i++) {
+        if (!priv->rdagg[i].req) {
+            continue;
+        }
+
+        start = priv->rdagg[i].req->buf;
+        if ((const uint8_t *) buf >= start &&
+            (const uint8_t *) buf < start + APBRIDGE_REQ_SIZE) {
+            return &priv->rdagg[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Release one message of an aggregated bulk OUT transfer, and submit the
+ * request again once all of them have been released.
+ */
+static int apbridge_rdagg_put(struct apbridge_dev_s *priv,
+                              struct apbridge_rdagg_s *rdagg)
+{
+    irqstate_t flags;
+    unsigned int pending;
+    int ret;
+
+    flags = irqsave();
+    pending = --rdagg->pending;
+    irqrestore(flags);
+
+    if (pending) {
+        return 0;
+    }
+
+    ret = EP_SUBMIT(priv->ep[CONFIG_APBRIDGE_EPBULKOUT], rdagg->req);
+    if (ret != OK) {
+        usbtrace(TRACE_CLSERROR(USBSER_TRACEERR_RDSUBMIT),
+                 (uint16_t) -ret);
+    }
+    return ret;
+}
+
+/*
+ * Split an aggregated transfer from the AP in its greybus messages. Each
+ * message starts on a 4 bytes boundary and its length is the one of its
+ * operation header.
+ */
+static void apbridge_agg_to_unipro(struct apbridge_dev_s *priv,
+                                   struct usbdev_req_s *req)
+{
+    struct apbridge_rdagg_s *rdagg;
+    struct gb_operation_hdr *hdr;
+    irqstate_t flags;
+    unsigned int cportid;
+    size_t offset = 0;
+    size_t len;
+
+    rdagg = apbridge_rdagg_find(priv, req->buf);
+    DEBUGASSERT(rdagg);
+
+    /* Hold the request until every message has been handed over */
+
+    rdagg->pending = 1;
+
+    while (offset + sizeof(*hdr) <= req->xfrd) {
+        hdr = (struct gb_operation_hdr *)((uint8_t *) req->buf + offset);
+        len = le16_to_cpu(hdr->size);
+        if (len < sizeof(*hdr) || offset + len > req->xfrd) {
+            usbtrace(TRACE_CLSERROR(USBSER_TRACEERR_RDUNEXPECTED),
+                     (uint16_t) len);
+            break;
+        }
+
+        cportid = hdr->pad[0];
+        hdr->pad[0] = 0;
+
+        flags = irqsave();
+        rdagg->pending++;
+        irqrestore(flags);
+
+        gb_timestamp_tag_entry_time(&priv->ts[cportid], cportid);
+        if (priv->driver->usb_to_unipro(priv, cportid, hdr, len)) {
+            apbridge_rdagg_put(priv, rdagg);
+        }
+
+        offset += APBRIDGE_AGG_ALIGN(len);
+    }
+
+    apbridge_rdagg_put(priv, rdagg);
+}
+#endif
+
 /**
  * @brief Send incoming data from unipro to AP module
  * priv usb device.
@@ -490,11 +739,18 @@ int unipro_to_usb(struct apbridge_dev_s *priv, unsigned int cportid,
     hdr->pad[0] = cportid & 0xff;
 
     epno = priv->cport_to_epin_n[cportid];
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+    if (priv->aggregate && epno == CONFIG_APBRIDGE_EPBULKIN) {
+        return apbridge_agg_to_usb(priv, cportid, payload, len);
+    }
+#endif
+
     ep = priv->ep[epno & USB_EPNO_MASK];
     req = get_request(ep, usbclass_wrcomplete, APBRIDGE_REQ_SIZE,
                       (void*) cportid);
     if (!req) {
-        return apbridge_queue(priv, ep, payload, len, (void*) cportid);
+        return apbridge_queue(&priv->msg_queue, ep, payload, len,
+                              (void*) cportid);
     }
 
     return _to_usb_submit(ep, req, payload, len);
@@ -505,7 +761,14 @@ int usb_release_buffer(struct apbridge_dev_s *priv, const void *buf)
     struct usbdev_ep_s *ep;
     struct usbdev_req_s *req;
     int ret = 0;
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+    struct apbridge_rdagg_s *rdagg;
 
+    rdagg = apbridge_rdagg_find(priv, buf);
+    if (rdagg && rdagg->pending) {
+        return apbridge_rdagg_put(priv, rdagg);
+    }
+#endif
 
     req = find_request_by_priv(buf);
     if (!req) {
@@ -664,6 +927,12 @@ static int usbclass_setconfig(struct apbridge_dev_s *priv, uint8_t config)
             req = get_request(ep, usbclass_rdcomplete,
                               APBRIDGE_REQ_SIZE, NULL);
             request_set_priv(req, req->buf);
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+            if (i == 0) {
+                priv->rdagg[j].req = req;
+                priv->rdagg[j].pending = 0;
+            }
+#endif
             ret = EP_SUBMIT(ep, req);
 
             if (ret != OK) {
@@ -748,6 +1017,12 @@ static void usbclass_rdcomplete(struct usbdev_ep_s *ep,
     case OK:                    /* Normal completion */
         usbtrace(TRACE_CLASSRDCOMPLETE, 0);
         ep_n = BULKEP_TO_N(ep);
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+        if (ep_n == 0 && priv->aggregate) {
+            apbridge_agg_to_unipro(priv, req);
+            break;
+        }
+#endif
         hdr = (struct gb_operation_hdr *)req->buf;
         /* Legacy ep: copy from payload cportid */
 
@@ -794,7 +1069,7 @@ static void usbclass_wrcomplete(struct usbdev_ep_s *ep,
     unipro_rxbuf_free((unsigned int) request_get_priv(req), req->buf);
 
     priv = ep_to_apbridge(ep);
-    info = apbridge_dequeue(priv);
+    info = apbridge_dequeue(&priv->msg_queue);
     if (info) {
         request_set_priv(req, info->priv);
         _to_usb_submit(info->ep, req, info->buf, info->len);
@@ -819,6 +1094,56 @@ static void usbclass_wrcomplete(struct usbdev_ep_s *ep,
     }
 }
 
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+static void usbclass_aggcomplete(struct usbdev_ep_s *ep,
+                                 struct usbdev_req_s *req)
+{
+    struct apbridge_msg_s *info;
+    struct apbridge_dev_s *priv;
+    struct apbridge_agg_s *agg;
+    irqstate_t flags;
+
+    priv = ep_to_apbridge(ep);
+    agg = request_get_priv(req);
+
+    flags = irqsave();
+    priv->agg_inflight--;
+    agg->len = 0;
+    list_add(&priv->agg_free, &agg->list);
+    put_request(req);
+
+    /* Copy the messages that were waiting for a buffer */
+
+    while (!list_is_empty(&priv->agg_queue)) {
+        info = list_entry(priv->agg_queue.next, struct apbridge_msg_s, list);
+        if (!apbridge_agg_copy(priv, (unsigned int) info->priv,
+                               info->buf, info->len)) {
+            break;
+        }
+        list_del(&info->list);
+        free(info);
+    }
+
+    apbridge_agg_flush(priv, false);
+    irqrestore(flags);
+
+    switch (req->result) {
+    case OK:                   /* Normal completion */
+        usbtrace(TRACE_CLASSWRCOMPLETE, 0);
+        break;
+
+    case -ESHUTDOWN:           /* Disconnection */
+        usbtrace(TRACE_CLSERROR(USBSER_TRACEERR_WRSHUTDOWN), 0);
+        break;
+
+    default:                   /* Some other error occurred */
+        usbtrace(TRACE_CLSERROR(USBSER_TRACEERR_WRUNEXPECTED),
+                 (uint16_t) - req->result);
+        break;
+    }
+}
+#endif
+
 /****************************************************************************
  * USB Class Driver Methods
 ****************************************************************************/
@@ -932,6 +1257,19 @@ static int usbclass_bind(struct usbdevclass_driver_s *driver,
 
     /* TODO test result of prealloc */
 
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+    for (i = 0; i < CONFIG_APBRIDGE_AGGREGATE_NBUFS; i++) {
+        priv->agg[i].buf =
+            bufram_page_alloc(bufram_size_to_page_count(APBRIDGE_REQ_SIZE));
+        if (!priv->agg[i].buf) {
+            ret = -ENOMEM;
+            goto error;
+        }
+        priv->agg[i].len = 0;
+        list_add(&priv->agg_free, &priv->agg[i].list);
+    }
+#endif
+
     /* Report if we are selfpowered */
 
     DEV_SETSELFPOWERED(dev);
@@ -998,6 +1336,19 @@ static void usbclass_unbind(struct usbdevclass_driver_s *driver,
 
         request_pool_freeall();
 
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+        list_init(&priv->agg_free);
+        list_init(&priv->agg_fill);
+        priv->agg_inflight = 0;
+        for (i = 0; i < CONFIG_APBRIDGE_AGGREGATE_NBUFS; i++) {
+            if (priv->agg[i].buf) {
+                bufram_page_free(priv->agg[i].buf,
+                    bufram_size_to_page_count(APBRIDGE_REQ_SIZE));
+                priv->agg[i].buf = NULL;
+            }
+        }
+#endif
+
         for (i = 0; i < APBRIDGE_MAX_ENDPOINTS; i++) {
             freeep(priv, i);
         }
@@ -1098,6 +1449,30 @@ static int latency_tag_dis_vendor_request_out(struct usbdev_s *dev, uint8_t req,
     return ret;
 }
 
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+static int aggregate_vendor_request_out(struct usbdev_s *dev, uint8_t req,
+                                        uint16_t index, uint16_t value,
+                                        void *buf, uint16_t len)
+{
+    struct apbridge_dev_s *priv = usbdev_to_apbridge(dev);
+    irqstate_t flags;
+
+    flags = irqsave();
+    priv->aggregate = value != 0;
+
+    /* Don't leave a partial aggregate behind */
+
+    if (!priv->aggregate) {
+        apbridge_agg_flush(priv, true);
+    }
+    irqrestore(flags);
+
+    lldbg("%s aggregation on the multiplexed endpoints\n",
+          value ? "enable" : "disable");
+    return 0;
+}
+#endif
+
 /****************************************************************************
  * Name: usbclass_setup
  *
@@ -1343,6 +1718,11 @@ int usbdev_apbinitialize(struct device *dev,
     if (register_vendor_request(APBRIDGE_ROREQUEST_LATENCY_TAG_DIS, VENDOR_REQ_OUT,
                                 latency_tag_dis_vendor_request_out))
         goto errout_vendor_req;
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+    if (register_vendor_request(APBRIDGE_WOREQUEST_AGGREGATE, VENDOR_REQ_OUT,
+                                aggregate_vendor_request_out))
+        goto errout_vendor_req;
+#endif
 
     /* Allocate the structures needed */
 
@@ -1379,6 +1759,11 @@ int usbdev_apbinitialize(struct device *dev,
     }
     sem_init(&priv->config_sem, 0, 0);
     list_init(&priv->msg_queue);
+#ifdef CONFIG_APBRIDGE_AGGREGATE
+    list_init(&priv->agg_free);
+    list_init(&priv->agg_fill);
+    list_init(&priv->agg_queue);
+#endif
     gb_timestamp_init();
 
     /* Initialize the USB class driver structure */
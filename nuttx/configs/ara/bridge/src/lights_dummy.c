@@ -66,6 +66,9 @@ struct lights_info {
     uint8_t                 lights_count;
     struct light_info       *light_attri[LIGHTS_COUNT];
     lights_event_callback   event_callback;
+#ifdef CONFIG_LIGHTS_PATTERN
+    struct lights_pattern   pattern[LIGHTS_COUNT][CHANNEL_COUNT];
+#endif
 };
 
 /* [FAKE] Fake channel data of lights - Beginning */
@@ -335,6 +338,83 @@ static bool is_channel_valid(struct lights_info *info, uint8_t light_id,
     return false;
 }
 
+#ifdef CONFIG_LIGHTS_PATTERN
+/**
+ * @brief Pattern player output, sets the channel brightness
+ *
+ * @param level brightness to be set
+ * @param priv the channel_info of the channel
+ */
+static void lights_pattern_brightness(uint8_t level, void *priv)
+{
+    struct channel_info *channel = priv;
+
+    channel->brightness = (level > channel->cfg.max_brightness)
+                          ? channel->cfg.max_brightness : level;
+}
+
+/**
+ * @brief Stop the pattern of a channel, keeping its brightness
+ *
+ * @param info pointer to a private lights device information
+ * @param light_id the ID of specific light
+ * @param channel_id the ID of specific channel
+ */
+static void lights_stop_pattern(struct lights_info *info, uint8_t light_id,
+                                uint8_t channel_id)
+{
+    if (channel_id < CHANNEL_COUNT) {
+        lights_pattern_stop(&info->pattern[light_id][channel_id], false);
+    }
+}
+
+/**
+ * @brief Play a pattern on a channel
+ *
+ * @param dev pointer to structure of device data
+ * @param light_id the ID of specific light
+ * @param channel_id the ID of specific channel
+ * @param frames keyframes of the pattern
+ * @param nframes number of keyframes, 0 to stop the pattern
+ * @param repeat number of times the pattern is played, 0 for ever
+ * @return 0 on success, negative errno on error
+ */
+static int lights_set_pattern(struct device *dev, uint8_t light_id,
+                              uint8_t channel_id,
+                              const struct lights_keyframe *frames,
+                              uint8_t nframes, uint16_t repeat)
+{
+    struct lights_info *info = NULL;
+    struct lights_pattern *pattern;
+
+    /* check input parameters */
+    if (!dev || !device_get_private(dev)) {
+        return -EINVAL;
+    }
+
+    info = device_get_private(dev);
+
+    if (info->state != LIGHTS_STATE_OPEN) {
+        return -EPERM;
+    }
+
+    if (!is_channel_valid(info, light_id, channel_id) ||
+        channel_id >= CHANNEL_COUNT) {
+        return -EINVAL;
+    }
+
+    pattern = &info->pattern[light_id][channel_id];
+    if (!nframes) {
+        lights_pattern_stop(pattern, false);
+        return 0;
+    }
+
+    return lights_pattern_start(pattern, frames, nframes, repeat);
+}
+#else
+#define lights_stop_pattern(info, light_id, channel_id)
+#endif
+
 /**
  * @brief Check if channel supports flash type.
  *
@@ -668,6 +748,7 @@ static int lights_set_color(struct device *dev, uint8_t light_id,
         return -EINVAL;
     }
 
+    lights_stop_pattern(info, light_id, channel_id);
     info->light_attri[light_id]->channels[channel_id].cfg.color = color;
 
     return 0;
@@ -707,6 +788,7 @@ static int lights_set_blink(struct device *dev, uint8_t light_id,
         return -EINVAL;
     }
 
+    lights_stop_pattern(info, light_id, channel_id);
     info->light_attri[light_id]->channels[channel_id].time_on_ms = time_on_ms;
     info->light_attri[light_id]->channels[channel_id].time_off_ms = time_off_ms;
 
@@ -748,6 +830,7 @@ static int lights_set_brightness(struct device *dev, uint8_t light_id,
     }
     channel = &(info->light_attri[light_id]->channels[channel_id]);
 
+    lights_stop_pattern(info, light_id, channel_id);
     channel->brightness = (brightness > channel->cfg.max_brightness)
                           ? channel->cfg.max_brightness : brightness;
 
@@ -951,6 +1034,9 @@ static int lights_dev_open(struct device *dev)
     int ret = 0;
     int i;
     int success_cnt;
+#ifdef CONFIG_LIGHTS_PATTERN
+    int j;
+#endif
 
     /* check input parameter */
     if (!dev || !device_get_private(dev)) {
@@ -975,6 +1061,17 @@ static int lights_dev_open(struct device *dev)
 
     info->event_callback = NULL;
 
+#ifdef CONFIG_LIGHTS_PATTERN
+    for (i = 0; i < info->lights_count; i++) {
+        for (j = 0; j < CHANNEL_COUNT &&
+                    j < info->light_attri[i]->cfg.channel_count; j++) {
+            lights_pattern_init(&info->pattern[i][j],
+                                lights_pattern_brightness,
+                                &info->light_attri[i]->channels[j]);
+        }
+    }
+#endif
+
     info->state = LIGHTS_STATE_OPEN;
 
     return ret;
@@ -1002,6 +1099,9 @@ static void lights_dev_close(struct device *dev)
 {
     struct lights_info *info = NULL;
     int i;
+#ifdef CONFIG_LIGHTS_PATTERN
+    int j;
+#endif
 
     /* check input parameter */
     if (!dev || !device_get_private(dev)) {
@@ -1011,6 +1111,12 @@ static void lights_dev_close(struct device *dev)
     info = device_get_private(dev);
 
     for (i = 0; i < info->lights_count; i++) {
+#ifdef CONFIG_LIGHTS_PATTERN
+        for (j = 0; j < CHANNEL_COUNT &&
+                    j < info->light_attri[i]->cfg.channel_count; j++) {
+            lights_pattern_stop(&info->pattern[i][j], false);
+        }
+#endif
          lights_free(info->light_attri[i]);
     }
     info->lights_count = 0;
@@ -1094,6 +1200,9 @@ static struct device_lights_type_ops lights_type_ops = {
     .set_flash_strobe           = lights_set_flash_strobe,
     .set_flash_timeout          = lights_set_flash_timeout,
     .get_flash_fault            = lights_get_flash_fault,
+#ifdef CONFIG_LIGHTS_PATTERN
+    .set_pattern                = lights_set_pattern,
+#endif
 };
 
 static struct device_driver_ops lights_driver_ops = {
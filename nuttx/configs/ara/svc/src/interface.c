@@ -53,12 +53,22 @@
 #define WAKEOUT_PULSE_DURATION_IN_US                (100000)
 #define MODULE_PORT_WAKEOUT_PULSE_DURATION_IN_US    (500000)
 
+#ifndef CONFIG_SVC_IFACE_PWRUP_MAX
+#define CONFIG_SVC_IFACE_PWRUP_MAX                  0
+#endif
+
 static struct interface **interfaces;
 static unsigned int nr_interfaces;
 static unsigned int nr_spring_interfaces;
 
+/* Number of interfaces with a WAKEOUT pulse in progress */
+static unsigned int nr_pwrup_interfaces;
+/* End of the power off time started by interface_early_init() */
+static uint32_t power_off_deadline;
+
 static void interface_uninstall_wd_handler(struct wd_data *wd);
 static int interface_install_wd_handler(struct wd_data *wd);
+static int interface_wd_delay_check(struct wd_data *wd);
 
 /**
  * @brief Configure all the voltage regulators associated with an interface
@@ -176,24 +186,27 @@ int interface_pwr_disable(struct interface *iface)
 
 
 /*
- * @brief Generate a WAKEOUT signal to wake-up/power-up modules.
- * If assert is true, keep the WAKEOUT lines asserted.
- *
- * The corresponding power supplies must already be enabled.
+ * Duration of the WAKEOUT pulse of an interface, 0 if the interface has
+ * no WAKEOUT line.
  */
-int interface_generate_wakeout(struct interface *iface, bool assert)
+static unsigned int interface_wakeout_duration(struct interface *iface)
 {
-    int rc;
-
-    if (!iface) {
-        dbg_error("%s: called with null interface\n", __func__);
-        return -ENODEV;
+    switch (iface->if_type) {
+    case ARA_IFACE_TYPE_MODULE_PORT:
+        return iface->detect_in.gpio ?
+               MODULE_PORT_WAKEOUT_PULSE_DURATION_IN_US : 0;
+    default:
+        return iface->wake_out ? WAKEOUT_PULSE_DURATION_IN_US : 0;
     }
+}
 
-    dbg_info("Generating WAKEOUT on interface %s\n",
-             iface->name ? iface->name : "unknown");
+/*
+ * Start the WAKEOUT pulse on an interface
+ */
+static int interface_wakeout_assert(struct interface *iface)
+{
+    int rc;
 
-    /* Generate a WAKEOUT pulse according to the interface type */
     switch (iface->if_type) {
     case ARA_IFACE_TYPE_MODULE_PORT:
         /*
@@ -218,15 +231,6 @@ int interface_generate_wakeout(struct interface *iface, bool assert)
                           iface->name ? iface->name : "unknown");
                 return rc;
             }
-
-            /* Keep the line asserted for the given duration */
-            up_udelay(MODULE_PORT_WAKEOUT_PULSE_DURATION_IN_US);
-
-            /* Finally re-install the interrupt handler on the pin */
-            rc = interface_install_wd_handler(&iface->detect_in);
-            if (rc) {
-                return rc;
-            }
         }
         break;
     default:
@@ -245,18 +249,45 @@ int interface_generate_wakeout(struct interface *iface, bool assert)
                           iface->name ? iface->name : "unknown");
                 return rc;
             }
+        }
+        break;
+    }
 
-            if (!assert) {
-                /* Wait for the bridges to react */
-                usleep(WAKEOUT_PULSE_DURATION_IN_US);
+    return 0;
+}
 
-                /* De-assert the lines */
-                rc = stm32_configgpio(iface->wake_out | GPIO_INPUT);
-                if (rc < 0) {
-                    dbg_error("Failed to de-assert WAKEOUT pin for interface %s\n",
-                              iface->name ? iface->name : "unknown");
-                    return rc;
-                }
+/*
+ * End the WAKEOUT pulse on an interface
+ */
+static int interface_wakeout_release(struct interface *iface)
+{
+    struct wd_data *wd = &iface->detect_in;
+    int rc;
+
+    switch (iface->if_type) {
+    case ARA_IFACE_TYPE_MODULE_PORT:
+        /* Re-install the interrupt handler on the WD pin */
+        if (wd->gpio) {
+            rc = interface_install_wd_handler(wd);
+            if (rc) {
+                return rc;
+            }
+
+            /* Resume a debounce that was ignored during the pulse */
+            if (wd->db_state == WD_ST_ACTIVE_DEBOUNCE ||
+                wd->db_state == WD_ST_INACTIVE_DEBOUNCE) {
+                interface_wd_delay_check(wd);
+            }
+        }
+        break;
+    default:
+        /* De-assert the lines */
+        if (iface->wake_out) {
+            rc = stm32_configgpio(iface->wake_out | GPIO_INPUT);
+            if (rc < 0) {
+                dbg_error("Failed to de-assert WAKEOUT pin for interface %s\n",
+                          iface->name ? iface->name : "unknown");
+                return rc;
             }
         }
         break;
@@ -265,6 +296,52 @@ int interface_generate_wakeout(struct interface *iface, bool assert)
     return 0;
 }
 
+/*
+ * @brief Generate a WAKEOUT signal to wake-up/power-up modules.
+ * If assert is true, keep the WAKEOUT lines asserted.
+ *
+ * The corresponding power supplies must already be enabled.
+ */
+int interface_generate_wakeout(struct interface *iface, bool assert)
+{
+    int rc;
+
+    if (!iface) {
+        dbg_error("%s: called with null interface\n", __func__);
+        return -ENODEV;
+    }
+
+    dbg_info("Generating WAKEOUT on interface %s\n",
+             iface->name ? iface->name : "unknown");
+
+    if (!interface_wakeout_duration(iface)) {
+        return 0;
+    }
+
+    rc = interface_wakeout_assert(iface);
+    if (rc) {
+        return rc;
+    }
+
+    /* Generate a WAKEOUT pulse according to the interface type */
+    switch (iface->if_type) {
+    case ARA_IFACE_TYPE_MODULE_PORT:
+        /* Keep the line asserted for the given duration */
+        up_udelay(MODULE_PORT_WAKEOUT_PULSE_DURATION_IN_US);
+        break;
+    default:
+        if (assert) {
+            return 0;
+        }
+
+        /* Wait for the bridges to react */
+        usleep(WAKEOUT_PULSE_DURATION_IN_US);
+        break;
+    }
+
+    return interface_wakeout_release(iface);
+}
+
 
 /**
  * @brief Get interface power supply state
@@ -281,27 +358,174 @@ enum ara_iface_pwr_state interface_get_pwr_state(struct interface *iface)
 }
 
 
+/*
+ * Interface power-up sequencer
+ *
+ * Powering an interface up takes the regulators hold times plus the
+ * WAKEOUT pulse, up to half a second on module ports. Rather than doing
+ * it one interface after the other, each interface runs its own sequence:
+ * the supplies are enabled and the WAKEOUT pulse started right away, and
+ * the pulse is ended from the high priority work queue. All the modules
+ * thus boot and train their links concurrently.
+ *
+ * CONFIG_SVC_IFACE_PWRUP_MAX caps the number of sequences in progress to
+ * bound the inrush current, the other interfaces are left pending until
+ * a sequence completes.
+ *
+ * The sequencer state is protected by disabling interrupts, as for the
+ * Wake & Detect debounce.
+ */
+static bool interface_pwrup_room(void)
+{
+    return !CONFIG_SVC_IFACE_PWRUP_MAX ||
+           nr_pwrup_interfaces < CONFIG_SVC_IFACE_PWRUP_MAX;
+}
+
+static void interface_pwrup_end(struct interface *iface)
+{
+    if (interface_wakeout_release(iface)) {
+        dbg_error("Failed to end wakeout on interface %s\n", iface->name);
+    }
+
+    iface->pwrup_state = ARA_IFACE_PWRUP_IDLE;
+    nr_pwrup_interfaces--;
+}
+
+static void interface_pwrup_kick(void);
+static void interface_pwrup_notify(void);
+
+static void interface_pwrup_worker(void *data)
+{
+    struct interface *iface = data;
+    irqstate_t flags;
+
+    flags = irqsave();
+    if (iface->pwrup_state == ARA_IFACE_PWRUP_WAKEOUT) {
+        dbg_verbose("Interface %s powered up\n", iface->name);
+        interface_pwrup_end(iface);
+        interface_pwrup_kick();
+    }
+    irqrestore(flags);
+
+    interface_pwrup_notify();
+}
+
+static void interface_pwrup_start(struct interface *iface)
+{
+    unsigned int duration;
+    int rc;
+
+    iface->pwrup_state = ARA_IFACE_PWRUP_IDLE;
+
+    /* If powered OFF, power it ON now */
+    if (!interface_get_pwr_state(iface)) {
+        rc = interface_pwr_enable(iface);
+        if (rc < 0) {
+            dbg_error("Failed to enable interface %s\n", iface->name);
+            return;
+        }
+    }
+
+    duration = interface_wakeout_duration(iface);
+    if (!duration) {
+        return;
+    }
+
+    /* Generate WAKE_OUT */
+    dbg_info("Generating WAKEOUT on interface %s\n", iface->name);
+    rc = interface_wakeout_assert(iface);
+    if (rc) {
+        dbg_error("Failed to generate wakeout on interface %s\n", iface->name);
+        return;
+    }
+
+    rc = work_queue(HPWORK, &iface->pwrup_work, interface_pwrup_worker, iface,
+                    USEC2TICK(duration));
+    if (rc) {
+        dbg_error("Failed to schedule end of wakeout on interface %s: %d\n",
+                  iface->name, rc);
+        interface_wakeout_release(iface);
+        return;
+    }
+
+    iface->pwrup_state = ARA_IFACE_PWRUP_WAKEOUT;
+    nr_pwrup_interfaces++;
+}
+
+/* Start the pending sequences the power budget has room for */
+static void interface_pwrup_kick(void)
+{
+    struct interface *ifc;
+    int i;
+
+    interface_foreach(ifc, i) {
+        if (!interface_pwrup_room()) {
+            break;
+        }
+
+        if (ifc->pwrup_state == ARA_IFACE_PWRUP_PENDING) {
+            interface_pwrup_start(ifc);
+        }
+    }
+}
+
+/* Send the hot_plug events of the interfaces done powering up */
+static void interface_pwrup_notify(void)
+{
+    struct interface *ifc;
+    irqstate_t flags;
+    bool notify;
+    int i;
+
+    interface_foreach(ifc, i) {
+        flags = irqsave();
+        notify = ifc->pwrup_notify &&
+                 ifc->pwrup_state == ARA_IFACE_PWRUP_IDLE;
+        if (notify) {
+            ifc->pwrup_notify = false;
+        }
+        irqrestore(flags);
+
+        if (notify && ifc->switch_portid != INVALID_PORT) {
+            svc_hot_plug(ifc->switch_portid);
+        }
+    }
+}
+
 /*
  * Interface power control helper, to be used by the DETECT_IN/hotplug
  * mechanism.
  *
- * Power OFF the interface
+ * Power OFF the interface, aborting its power-up sequence if any.
  */
 static int interface_power_off(struct interface *iface)
 {
+    irqstate_t flags;
     int rc;
 
     if (!iface) {
         return -EINVAL;
     }
 
+    flags = irqsave();
+    if (iface->pwrup_state == ARA_IFACE_PWRUP_WAKEOUT) {
+        work_cancel(HPWORK, &iface->pwrup_work);
+        interface_pwrup_end(iface);
+    }
+    iface->pwrup_state = ARA_IFACE_PWRUP_IDLE;
+    iface->pwrup_notify = false;
+    irqrestore(flags);
+
     rc = interface_pwr_disable(iface);
     if (rc < 0) {
         dbg_error("Failed to disable interface %s\n", iface->name);
-        return rc;
     }
 
-    return 0;
+    flags = irqsave();
+    interface_pwrup_kick();
+    irqrestore(flags);
+
+    return rc < 0 ? rc : 0;
 }
 
 /*
@@ -311,30 +535,29 @@ static int interface_power_off(struct interface *iface)
  * Power ON the interface in order to cleanly reboot the interface
  * module(s). Then an initial handshake between the module(s) and the
  * interface can take place.
+ *
+ * The power-up sequence completes in the background. If notify is true,
+ * a hot_plug event is sent once it is done.
  */
-static int interface_power_on(struct interface *iface)
+static int interface_power_on(struct interface *iface, bool notify)
 {
-    int rc;
+    irqstate_t flags;
 
     if (!iface) {
         return -EINVAL;
     }
 
-    /* If powered OFF, power it ON now */
-    if (!interface_get_pwr_state(iface)) {
-        rc = interface_pwr_enable(iface);
-        if (rc < 0) {
-            dbg_error("Failed to enable interface %s\n", iface->name);
-            return rc;
-        }
+    flags = irqsave();
+    if (notify) {
+        iface->pwrup_notify = true;
     }
-
-    /* Generate WAKE_OUT */
-    rc = interface_generate_wakeout(iface, false);
-    if (rc) {
-        dbg_error("Failed to generate wakeout on interface %s\n", iface->name);
-        return rc;
+    if (iface->pwrup_state == ARA_IFACE_PWRUP_IDLE) {
+        iface->pwrup_state = ARA_IFACE_PWRUP_PENDING;
     }
+    interface_pwrup_kick();
+    irqrestore(flags);
+
+    interface_pwrup_notify();
 
     return 0;
 }
@@ -694,15 +917,13 @@ static int interface_debounce_wd(struct interface *iface,
                  *         transition, power cycle (OFF/ON) the interface.
                  *         In that case consecutive hotplug events are
                  *         sent to the AP.
-                 * - Signal HOTPLUG state to the higher layer
+                 * - Signal HOTPLUG state to the higher layer, once
+                 *   powered up
                  */
                 if (wd->last_state == WD_ST_ACTIVE_STABLE) {
                     interface_power_off(iface);
                 }
-                interface_power_on(iface);
-                if (iface->switch_portid != INVALID_PORT) {
-                    svc_hot_plug(iface->switch_portid);
-                }
+                interface_power_on(iface, true);
                 /* Save last stable state for power ON/OFF handling */
                 wd->last_state = wd->db_state;
             } else {
@@ -815,16 +1036,14 @@ static int interface_debounce_wakein_detectin(struct interface *iface,
                  *         transition, power cycle (OFF/ON) the interface.
                  *         In that case consecutive hotplug events are
                  *         sent to the AP.
-                 * - Signal HOTPLUG state to the higher layer
+                 * - Signal HOTPLUG state to the higher layer, once
+                 *   powered up
                  */
                 if (wd == &iface->detect_in) {
                     if (wd->last_state == WD_ST_ACTIVE_STABLE) {
                         interface_power_off(iface);
                     }
-                    interface_power_on(iface);
-                    if (iface->switch_portid != INVALID_PORT) {
-                        svc_hot_plug(iface->switch_portid);
-                    }
+                    interface_power_on(iface, true);
                 }
                 /* Save last stable state for power ON/OFF handling */
                 wd->last_state = wd->db_state;
@@ -925,6 +1144,15 @@ static int interface_wd_handler(int irq, void *context)
         polarity = (iface->flags & ARA_IFACE_FLAG_DETECT_IN_ACTIVE_HIGH) ?
             true : false;
     }
+    /*
+     * On module ports the WD line is driven by the SVC during the WAKEOUT
+     * pulse, ignore it until the pulse ends.
+     */
+    if (interface_is_module_port(iface) && wd == &iface->detect_in &&
+        iface->pwrup_state == ARA_IFACE_PWRUP_WAKEOUT) {
+        return 0;
+    }
+
     active = (gpio_get_value(irq) == polarity);
 
     dbg_insane("W&D: got %s_%s %s (gpio %d)\n",
@@ -1030,8 +1258,11 @@ int interface_early_init(struct interface **ints,
         return -1;
     }
 
-    /* Let everything settle for a good long while.*/
-    up_udelay(POWER_OFF_TIME_IN_US);
+    /*
+     * Let everything settle for a good long while. The wait is done by
+     * interface_init(), so that the switch gets initialized meanwhile.
+     */
+    power_off_deadline = clock_systimer() + USEC2TICK(POWER_OFF_TIME_IN_US);
 
     return 0;
 }
@@ -1040,6 +1271,10 @@ int interface_early_init(struct interface **ints,
 /**
  * @brief Given a table of interfaces, initialize and enable all associated
  *        power supplies
+ *
+ * The interfaces are powered up concurrently, the power-up sequences
+ * complete in the background after this function returns.
+ *
  * @param interfaces table of interfaces to initialize
  * @param nr_ints number of interfaces to initialize
  * @param nr_spring_ints number of spring interfaces
@@ -1049,6 +1284,7 @@ int interface_early_init(struct interface **ints,
 int interface_init(struct interface **ints,
                    size_t nr_ints, size_t nr_spring_ints) {
     unsigned int i;
+    int32_t remaining;
     int rc;
     struct interface *ifc;
 
@@ -1061,15 +1297,41 @@ int interface_init(struct interface **ints,
     interfaces = ints;
     nr_interfaces = nr_ints;
     nr_spring_interfaces = nr_spring_ints;
+    nr_pwrup_interfaces = 0;
+
+    /* Complete the power off time started by interface_early_init() */
+    remaining = (int32_t)(power_off_deadline - clock_systimer());
+    if (remaining > 0) {
+        usleep(TICK2USEC(remaining));
+    }
 
     interface_foreach(ifc, i) {
+        ifc->pwrup_state = ARA_IFACE_PWRUP_IDLE;
+        ifc->pwrup_notify = false;
         /* Initialize the hotplug state */
         ifc->hp_state = interface_get_hotplug_state(ifc);
+
+        /*
+         * Install handlers for WAKE_IN and DETECT_IN signals. This is done
+         * before powering the interface on since a module port WAKEOUT
+         * pulse temporarily takes the DETECT_IN pin over.
+         */
+        ifc->wake_in.db_state = WD_ST_INVALID;
+        ifc->detect_in.db_state = WD_ST_INVALID;
+        ifc->wake_in.last_state = WD_ST_INVALID;
+        ifc->detect_in.last_state = WD_ST_INVALID;
+        rc = interface_install_wd_handler(&ifc->wake_in);
+        if (rc)
+            return rc;
+        rc = interface_install_wd_handler(&ifc->detect_in);
+        if (rc)
+            return rc;
+
         /* Power on/off the interface based on the DETECT_IN signal state */
         switch (ifc->hp_state) {
         case HOTPLUG_ST_PLUGGED:
             /* Port is plugged in, power ON the interface */
-            if (interface_power_on(ifc) < 0) {
+            if (interface_power_on(ifc, false) < 0) {
                 dbg_error("Failed to power ON interface %s\n", ifc->name);
             }
             break;
@@ -1083,18 +1345,6 @@ int interface_init(struct interface **ints,
         default:
             break;
         }
-
-        /* Install handlers for WAKE_IN and DETECT_IN signals */
-        ifc->wake_in.db_state = WD_ST_INVALID;
-        ifc->detect_in.db_state = WD_ST_INVALID;
-        ifc->wake_in.last_state = WD_ST_INVALID;
-        ifc->detect_in.last_state = WD_ST_INVALID;
-        rc = interface_install_wd_handler(&ifc->wake_in);
-        if (rc)
-            return rc;
-        rc = interface_install_wd_handler(&ifc->detect_in);
-        if (rc)
-            return rc;
     }
 
     return 0;
@@ -1109,6 +1359,7 @@ void interface_exit(void) {
     unsigned int i;
     int rc;
     struct interface *ifc;
+    irqstate_t flags;
 
     dbg_info("Disabling all interfaces\n");
 
@@ -1116,6 +1367,18 @@ void interface_exit(void) {
         return;
     }
 
+    /* Abort the power-up sequences in progress */
+    interface_foreach(ifc, i) {
+        flags = irqsave();
+        if (ifc->pwrup_state == ARA_IFACE_PWRUP_WAKEOUT) {
+            work_cancel(HPWORK, &ifc->pwrup_work);
+            interface_pwrup_end(ifc);
+        }
+        ifc->pwrup_state = ARA_IFACE_PWRUP_IDLE;
+        ifc->pwrup_notify = false;
+        irqrestore(flags);
+    }
+
     /* Uninstall handlers for WAKE_IN and DETECT_IN signals */
     interface_foreach(ifc, i) {
         interface_uninstall_wd_handler(&ifc->wake_in);
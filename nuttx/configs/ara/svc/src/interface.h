@@ -111,6 +111,13 @@ enum ara_iface_pwr_state {
     ARA_IFACE_PWR_UP = 1,
 };
 
+/* Interface power-up sequence states */
+enum ara_iface_pwrup_state {
+    ARA_IFACE_PWRUP_IDLE,           /* No power-up in progress */
+    ARA_IFACE_PWRUP_PENDING,        /* Waiting for room in the power budget */
+    ARA_IFACE_PWRUP_WAKEOUT,        /* Supplies on, WAKEOUT pulse running */
+};
+
 struct interface {
     const char *name;
     unsigned int switch_portid;
@@ -124,6 +131,9 @@ struct interface {
     struct wd_data wake_in;
     struct wd_data detect_in;
     enum hotplug_state hp_state;
+    enum ara_iface_pwrup_state pwrup_state;
+    bool pwrup_notify;                  /* Send hot_plug once powered up */
+    struct work_s pwrup_work;           /* End of the WAKEOUT pulse */
 };
 
 #define interface_foreach(iface, idx)                       \
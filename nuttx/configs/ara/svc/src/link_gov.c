@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * UniPro link power mode governor.
+ *
+ * Every sampling period, the SVC reads the per-port bandwidth statistics of
+ * the switch arbiter and moves each governed link along a ladder of power
+ * modes, from PWM-G1 to the fastest HS configuration both ends support.
+ * A busy link is moved up as soon as it goes over the up threshold; a link
+ * only goes down one step at a time, after it has fitted in the lower step
+ * for several consecutive samples.
+ *
+ * The switch only counts the traffic entering it. A link is full duplex and
+ * both of its directions are set to the same mode, so its load is taken as
+ * its busiest direction: the ingress of the port, or an upper bound of its
+ * egress. All module traffic goes through the AP, so the egress of the AP
+ * port is bounded by the ingress of the module ports, and the egress of a
+ * module port by the ingress of the AP port.
+ */
+
+#define DBG_COMP ARADBG_SVC
+
+#include <nuttx/config.h>
+#include <nuttx/util.h>
+#include <nuttx/unipro/unipro.h>
+
+#include <errno.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include <ara_debug.h>
+#include "tsb_switch.h"
+#include "link_gov.h"
+
+#define LINK_GOV_PERIOD_MS          CONFIG_SVC_LINK_GOVERNOR_PERIOD_MS
+#define LINK_GOV_MAX_ERRORS         (3)
+
+struct link_gov_level {
+    bool hs;
+    uint8_t gear;
+    uint8_t nlanes;
+    uint32_t capacity;  /* payload bandwidth, in kB/s */
+};
+
+/* From the M-PHY line rates, minus the 8b10b encoding */
+static const struct link_gov_level link_gov_levels[] = {
+    { false, 1, 1,    300 },    /* PWM-G1, 3 Mbps */
+    { false, 4, 1,   2400 },    /* PWM-G4, 24 Mbps */
+    { true,  1, 1, 124800 },    /* HS-G1A, 1248 Mbps */
+    { true,  2, 1, 249600 },    /* HS-G2A, 2496 Mbps */
+    { true,  2, 2, 499200 },    /* HS-G2A, 2 lanes */
+};
+
+struct link_gov_port {
+    bool governed;
+    uint8_t level;
+    uint8_t max_level;
+    uint8_t calm;       /* consecutive samples fitting the level below */
+    uint8_t errors;
+    uint16_t quantity[2];   /* last TC0 and TC1 source quantities */
+    uint32_t ingress;       /* bytes received during the last period */
+};
+
+static struct link_gov_port link_gov_ports[SWITCH_PORT_MAX];
+static unsigned int link_gov_nports;
+static struct timespec link_gov_deadline;
+
+static void link_gov_arm(void) {
+    clock_gettime(CLOCK_REALTIME, &link_gov_deadline);
+    link_gov_deadline.tv_nsec += LINK_GOV_PERIOD_MS * 1000000;
+    link_gov_deadline.tv_sec += link_gov_deadline.tv_nsec / 1000000000;
+    link_gov_deadline.tv_nsec %= 1000000000;
+}
+
+static bool link_gov_expired(void) {
+    struct timespec now;
+
+    clock_gettime(CLOCK_REALTIME, &now);
+    if (now.tv_sec != link_gov_deadline.tv_sec) {
+        return now.tv_sec > link_gov_deadline.tv_sec;
+    }
+    return now.tv_nsec >= link_gov_deadline.tv_nsec;
+}
+
+/*
+ * The arbiter counters are 16-bit wide: the sampling period must be short
+ * enough for them not to wrap twice in between two samples.
+ */
+static int link_gov_sample(struct tsb_switch *sw, uint8_t portid,
+                           struct link_gov_port *port) {
+    static const uint8_t tcs[] = {
+        SWITCH_TRAFFIC_CLASS_TC0,
+        SWITCH_TRAFFIC_CLASS_TC1,
+    };
+    uint32_t quantity;
+    uint32_t ingress = 0;
+    unsigned int i;
+    int rc;
+
+    for (i = 0; i < ARRAY_SIZE(tcs); i++) {
+        rc = switch_qos_source_quantity(sw, portid, tcs[i], &quantity);
+        if (rc) {
+            return rc;
+        }
+        ingress += (uint16_t)(quantity - port->quantity[i]);
+        port->quantity[i] = quantity;
+    }
+
+    port->ingress = ingress * CONFIG_SVC_LINK_GOVERNOR_UNIT_BYTES;
+    return 0;
+}
+
+static int link_gov_apply(struct tsb_switch *sw, uint8_t portid,
+                          uint8_t level) {
+    const struct link_gov_level *l = &link_gov_levels[level];
+
+    if (l->hs) {
+        return switch_configure_link_hs(sw, portid, l->gear, l->nlanes,
+                                        UNIPRO_LINK_CFGF_AUTO);
+    }
+    return switch_configure_link_pwm(sw, portid, l->gear, l->nlanes,
+                                     UNIPRO_LINK_CFGF_AUTO);
+}
+
+/* Lowest level that can carry load (kB/s) under the given percentage */
+static uint8_t link_gov_fit(uint32_t load, uint8_t max_level,
+                            unsigned int percent) {
+    uint8_t level;
+
+    for (level = 0; level < max_level; level++) {
+        if (load * 100 <= link_gov_levels[level].capacity * percent) {
+            break;
+        }
+    }
+    return level;
+}
+
+static void link_gov_update(struct tsb_switch *sw, uint8_t portid,
+                            struct link_gov_port *port, uint32_t load) {
+    uint8_t level = port->level;
+    uint8_t target;
+    int rc;
+
+    target = link_gov_fit(load, port->max_level,
+                          CONFIG_SVC_LINK_GOVERNOR_UP_THRESHOLD);
+    if (target > level) {
+        port->calm = 0;
+        level = target;
+    } else if (level > 0 &&
+               load * 100 < link_gov_levels[level - 1].capacity *
+                            CONFIG_SVC_LINK_GOVERNOR_DOWN_THRESHOLD) {
+        if (++port->calm < CONFIG_SVC_LINK_GOVERNOR_DOWN_SAMPLES) {
+            return;
+        }
+        port->calm = 0;
+        level--;
+    } else {
+        port->calm = 0;
+        return;
+    }
+
+    rc = link_gov_apply(sw, portid, level);
+    if (rc) {
+        dbg_error("%s(): port %u: can't change to level %u: %d\n",
+                  __func__, portid, level, rc);
+        if (++port->errors >= LINK_GOV_MAX_ERRORS) {
+            dbg_error("%s(): giving up on port %u\n", __func__, portid);
+            link_gov_port_remove(portid);
+        }
+        return;
+    }
+
+    dbg_info("port %u: %u kB/s, level %u -> %u\n", portid, load,
+             port->level, level);
+    port->errors = 0;
+    port->level = level;
+}
+
+/**
+ * @brief Start governing the link of a switch port
+ *
+ * The link is set to the lowest power mode, and will be moved up as soon as
+ * traffic requires it.
+ */
+int link_gov_port_add(struct tsb_switch *sw, uint8_t portid) {
+    struct link_gov_port *port;
+    uint32_t tx_lanes, rx_lanes;
+    uint8_t nlanes = 1;
+    uint8_t max_level;
+    int rc;
+
+    if (portid >= SWITCH_UNIPORT_MAX) {
+        return -EINVAL;
+    }
+
+    port = &link_gov_ports[portid];
+    if (port->governed) {
+        return 0;
+    }
+
+    if (!switch_dme_get(sw, portid, PA_CONNECTEDTXDATALANES,
+                        UNIPRO_SELINDEX_NULL, &tx_lanes) &&
+        !switch_dme_get(sw, portid, PA_CONNECTEDRXDATALANES,
+                        UNIPRO_SELINDEX_NULL, &rx_lanes) &&
+        tx_lanes && rx_lanes) {
+        nlanes = tx_lanes < rx_lanes ? tx_lanes : rx_lanes;
+    }
+
+    max_level = ARRAY_SIZE(link_gov_levels) - 1;
+    while (max_level > 0 && link_gov_levels[max_level].nlanes > nlanes) {
+        max_level--;
+    }
+
+    rc = link_gov_apply(sw, portid, 0);
+    if (rc) {
+        dbg_error("%s(): port %u: can't set the initial mode: %d\n",
+                  __func__, portid, rc);
+        return rc;
+    }
+
+    port->level = 0;
+    port->max_level = max_level;
+    port->calm = 0;
+    port->errors = 0;
+    link_gov_sample(sw, portid, port);
+    port->ingress = 0;
+    port->governed = true;
+
+    if (!link_gov_nports++) {
+        link_gov_arm();
+    }
+
+    dbg_info("port %u: governed, %u lane(s)\n", portid, nlanes);
+    return 0;
+}
+
+/**
+ * @brief Stop governing the link of a switch port
+ */
+void link_gov_port_remove(uint8_t portid) {
+    if (portid >= SWITCH_UNIPORT_MAX || !link_gov_ports[portid].governed) {
+        return;
+    }
+
+    link_gov_ports[portid].governed = false;
+    link_gov_nports--;
+}
+
+/**
+ * @brief Wait for an SVC event, or for the next sampling period
+ *
+ * Same as pthread_cond_wait(), except it also returns ETIMEDOUT when the
+ * links are due for sampling.
+ */
+int link_gov_wait(pthread_cond_t *cv, pthread_mutex_t *lock) {
+    if (!link_gov_nports) {
+        return pthread_cond_wait(cv, lock);
+    }
+    return pthread_cond_timedwait(cv, lock, &link_gov_deadline);
+}
+
+/**
+ * @brief Sample the governed links and adjust their power modes
+ *
+ * Does nothing until the current sampling period is over.
+ *
+ * @param sw Switch handle
+ * @param ap_portid Port of the AP, negative if unknown
+ */
+void link_gov_poll(struct tsb_switch *sw, int ap_portid) {
+    struct link_gov_port *port;
+    uint32_t modules = 0;
+    uint32_t ap = 0;
+    uint32_t load;
+    int i;
+
+    if (!link_gov_nports || !link_gov_expired()) {
+        return;
+    }
+    link_gov_arm();
+
+    for (i = 0; i < SWITCH_UNIPORT_MAX; i++) {
+        port = &link_gov_ports[i];
+        if (!port->governed) {
+            continue;
+        }
+
+        if (link_gov_sample(sw, i, port)) {
+            port->ingress = 0;
+        }
+
+        if (i == ap_portid) {
+            ap = port->ingress;
+        } else {
+            modules += port->ingress;
+        }
+    }
+
+    for (i = 0; i < SWITCH_UNIPORT_MAX; i++) {
+        port = &link_gov_ports[i];
+        if (!port->governed) {
+            continue;
+        }
+
+        load = port->ingress;
+        if (i == ap_portid && modules > load) {
+            load = modules;
+        } else if (i != ap_portid && ap > load) {
+            load = ap;
+        }
+
+        /* bytes per millisecond are kB/s */
+        link_gov_update(sw, i, port, load / LINK_GOV_PERIOD_MS);
+    }
+}
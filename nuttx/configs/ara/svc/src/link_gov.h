@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _LINK_GOV_H_
+#define _LINK_GOV_H_
+
+#include <nuttx/config.h>
+
+#include <pthread.h>
+#include <stdint.h>
+
+struct tsb_switch;
+
+#ifdef CONFIG_SVC_LINK_GOVERNOR
+int link_gov_port_add(struct tsb_switch *sw, uint8_t portid);
+void link_gov_port_remove(uint8_t portid);
+int link_gov_wait(pthread_cond_t *cv, pthread_mutex_t *lock);
+void link_gov_poll(struct tsb_switch *sw, int ap_portid);
+#else
+static inline int link_gov_port_add(struct tsb_switch *sw, uint8_t portid) {
+    return 0;
+}
+
+static inline void link_gov_port_remove(uint8_t portid) {
+}
+
+static inline int link_gov_wait(pthread_cond_t *cv, pthread_mutex_t *lock) {
+    return pthread_cond_wait(cv, lock);
+}
+
+static inline void link_gov_poll(struct tsb_switch *sw, int ap_portid) {
+}
+#endif
+
+#endif
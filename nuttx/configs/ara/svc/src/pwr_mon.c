@@ -410,3 +410,59 @@ int pwrmon_measure_rail(pwrmon_rail *pwrmon_r, ina230_sample *m)
 
     return ret;
 }
+
+/**
+ * @brief           Enable the conversion ready flag and alert of a given
+ *                  power rail, for use with pwrmon_sample_rail().
+ * @return          0 on success, standard error codes otherwise.
+ * @param[in]       pwrmon_r: power rail device structure
+ */
+int pwrmon_enable_sampling(pwrmon_rail *pwrmon_r)
+{
+    int ret;
+
+    if (!pwrmon_r) {
+        dbg_error("%s(): invalid pwrmon_r!\n", __func__);
+        return -EINVAL;
+    }
+
+    ret = pwrmon_ina230_select(pwrmon_r->dev);
+    if (ret) {
+        dbg_error("%s(): failed to configure i2c mux! (%d)\n",
+                  __func__, ret);
+        return ret;
+    }
+
+    return ina230_enable_cnvr_alert(pwrmon_r->ina230_dev);
+}
+
+/**
+ * @brief           Return a new sample of a given power rail, if the
+ *                  monitor completed a conversion since the last call.
+ *                  Lighter than pwrmon_measure_rail(), meant to be called
+ *                  at the conversion rate.
+ * @return          0 on success, -EAGAIN if no new sample is available yet,
+ *                  standard error codes otherwise.
+ * @param[in]       pwrmon_r: power rail device structure
+ * @param[out]      m: power measurement data (voltage, current, power)
+ */
+int pwrmon_sample_rail(pwrmon_rail *pwrmon_r, ina230_sample *m)
+{
+    int ret;
+
+    if ((!pwrmon_r) || (!m)) {
+        return -EINVAL;
+    }
+
+    ret = pwrmon_ina230_select(pwrmon_r->dev);
+    if (ret) {
+        return ret;
+    }
+
+    ret = ina230_conversion_ready(pwrmon_r->ina230_dev);
+    if (ret <= 0) {
+        return ret ? ret : -EAGAIN;
+    }
+
+    return ina230_get_fast_data(pwrmon_r->ina230_dev, m);
+}
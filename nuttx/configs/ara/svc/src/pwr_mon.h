@@ -37,6 +37,7 @@
 
 #include <stdint.h>
 #include <sys/types.h>
+#include <nuttx/fs/ioctl.h>
 #include <nuttx/sensors/ina230.h>
 
 struct pwrmon_rail_ctx {
@@ -80,6 +81,8 @@ int pwrmon_init(uint32_t current_lsb_uA,
 pwrmon_rail *pwrmon_init_rail(uint8_t dev, uint8_t rail);
 uint32_t pwrmon_get_sampling_time(pwrmon_rail *pwrmon_r);
 int pwrmon_measure_rail(pwrmon_rail *pwrmon_dev, ina230_sample *m);
+int pwrmon_enable_sampling(pwrmon_rail *pwrmon_r);
+int pwrmon_sample_rail(pwrmon_rail *pwrmon_r, ina230_sample *m);
 const char *pwrmon_dev_name(uint8_t dev);
 const char *pwrmon_rail_name(uint8_t dev, uint8_t rail);
 int pwrmon_device_id(const char *name, uint8_t *dev);
@@ -88,6 +91,42 @@ int pwrmon_dev_rail_count(uint8_t dev);
 void pwrmon_deinit_rail(pwrmon_rail *pwrmon_dev);
 void pwrmon_deinit(void);
 
+/*
+ * Power monitor sampler character device.
+ *
+ * Once started with PWRMON_IOC_START, the driver samples a single rail at
+ * the monitor conversion rate and aggregates the samples into windows.
+ * read() returns whole struct pwrmon_window records, oldest first.
+ */
+#define PWRMON_DEV_PATH             "/dev/pwrmon"
+
+#define PWRMON_IOC_START            _SNIOC(0x0080) /* struct pwrmon_sampler_cfg* */
+#define PWRMON_IOC_STOP             _SNIOC(0x0081) /* None */
+
+struct pwrmon_sampler_cfg {
+    uint8_t dev;                    /* Device ID */
+    uint8_t rail;                   /* Power rail ID */
+    ina230_conversion_time ct;      /* Conversion time */
+    ina230_avg_count avg_count;     /* Averaging sample count */
+    uint32_t current_lsb_uA;        /* Current measurement precision */
+    uint16_t window;                /* Samples per window */
+};
+
+struct pwrmon_window {
+    uint32_t timestamp;             /* End of the window, in ms */
+    uint16_t count;                 /* Samples in the window */
+    uint16_t lost;                  /* Windows dropped before this one */
+    int32_t uV_avg;
+    int32_t uA_min;
+    int32_t uA_max;
+    int32_t uA_avg;
+    int32_t uW_min;
+    int32_t uW_max;
+    int32_t uW_avg;
+};
+
+int pwrmon_dev_register(void);
+
 /*
  * These functions are board-specific and must be implemented
  * in appropriate board files.
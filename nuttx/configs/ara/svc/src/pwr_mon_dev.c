@@ -0,0 +1,373 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * @file    configs/ara/svc/src/pwr_mon_dev.c
+ * @brief   ARA Power Monitor Sampler Device
+ */
+
+#define DBG_COMP ARADBG_POWER
+
+#include <nuttx/config.h>
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/kthread.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <semaphore.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <ara_debug.h>
+#include <pwr_mon.h>
+
+#define PWRMON_DEV_NWINDOWS     CONFIG_ARA_SVC_PWRMON_DEV_WINDOWS
+#define PWRMON_DEV_STACK        1024
+
+struct pwrmon_dev {
+    sem_t lock;             /* Protects everything below but the ring */
+    sem_t ring_lock;        /* Protects the ring */
+    sem_t avail;            /* Counts the windows in the ring */
+    sem_t stopped;          /* Posted by the sampler when it exits */
+    bool opened;
+    volatile bool running;
+    pwrmon_rail *rail;
+    struct pwrmon_sampler_cfg cfg;
+
+    struct pwrmon_window ring[PWRMON_DEV_NWINDOWS];
+    unsigned int head;      /* Next window to write */
+    unsigned int count;     /* Windows in the ring */
+    uint16_t lost;          /* Windows dropped since the start */
+};
+
+static struct pwrmon_dev pwrmon_dev;
+
+/*
+ * Queue a window, dropping the oldest one if the reader does not keep up.
+ */
+static void pwrmon_dev_push(struct pwrmon_window *w)
+{
+    bool dropped = false;
+
+    while (sem_wait(&pwrmon_dev.ring_lock) != OK);
+
+    if (pwrmon_dev.count == PWRMON_DEV_NWINDOWS) {
+        pwrmon_dev.count--;
+        if (pwrmon_dev.lost < UINT16_MAX) {
+            pwrmon_dev.lost++;
+        }
+        dropped = true;
+    }
+
+    w->lost = pwrmon_dev.lost;
+    pwrmon_dev.ring[pwrmon_dev.head] = *w;
+    pwrmon_dev.head = (pwrmon_dev.head + 1) % PWRMON_DEV_NWINDOWS;
+    pwrmon_dev.count++;
+
+    sem_post(&pwrmon_dev.ring_lock);
+
+    /* The count is unchanged when the oldest window was replaced */
+    if (!dropped) {
+        sem_post(&pwrmon_dev.avail);
+    }
+}
+
+/*
+ * Dequeue the oldest window. Returns false if the ring is empty, which
+ * happens when the reader is woken up by the sampler exiting.
+ */
+static bool pwrmon_dev_pop(struct pwrmon_window *w)
+{
+    unsigned int tail;
+    bool popped = false;
+
+    while (sem_wait(&pwrmon_dev.ring_lock) != OK);
+
+    if (pwrmon_dev.count) {
+        tail = (pwrmon_dev.head + PWRMON_DEV_NWINDOWS - pwrmon_dev.count) %
+               PWRMON_DEV_NWINDOWS;
+        *w = pwrmon_dev.ring[tail];
+        pwrmon_dev.count--;
+        popped = true;
+    }
+
+    sem_post(&pwrmon_dev.ring_lock);
+
+    return popped;
+}
+
+/*
+ * Sampler thread: poll the conversion ready flag and aggregate the samples
+ * into windows. The I2C transfers sleep on the bus interrupts, so polling
+ * the flag does not keep the CPU busy.
+ */
+static int pwrmon_dev_sampler(int argc, char *argv[])
+{
+    struct pwrmon_window w;
+    int64_t uV_sum = 0, uA_sum = 0, uW_sum = 0;
+    ina230_sample m;
+    uint32_t idle_us;
+    uint16_t count = 0;
+    int ret;
+
+    /*
+     * Sleep through the part of the conversion time that the system tick
+     * can resolve, poll for the rest.
+     */
+    idle_us = pwrmon_get_sampling_time(pwrmon_dev.rail);
+    idle_us -= idle_us % USEC_PER_TICK;
+
+    while (pwrmon_dev.running) {
+        ret = pwrmon_sample_rail(pwrmon_dev.rail, &m);
+        if (ret == -EAGAIN) {
+            continue;
+        }
+        if (ret) {
+            dbg_error("%s(): sampling failed, stopping (%d)\n", __func__, ret);
+            break;
+        }
+
+        if (!count) {
+            w.uA_min = w.uA_max = m.uA;
+            w.uW_min = w.uW_max = m.uW;
+        } else {
+            w.uA_min = m.uA < w.uA_min ? m.uA : w.uA_min;
+            w.uA_max = m.uA > w.uA_max ? m.uA : w.uA_max;
+            w.uW_min = m.uW < w.uW_min ? m.uW : w.uW_min;
+            w.uW_max = m.uW > w.uW_max ? m.uW : w.uW_max;
+        }
+        uV_sum += m.uV;
+        uA_sum += m.uA;
+        uW_sum += m.uW;
+
+        if (idle_us) {
+            usleep(idle_us);
+        }
+
+        if (++count < pwrmon_dev.cfg.window) {
+            continue;
+        }
+
+        w.timestamp = TICK2MSEC(clock_systimer());
+        w.count = count;
+        w.uV_avg = uV_sum / count;
+        w.uA_avg = uA_sum / count;
+        w.uW_avg = uW_sum / count;
+        pwrmon_dev_push(&w);
+
+        uV_sum = uA_sum = uW_sum = 0;
+        count = 0;
+    }
+
+    pwrmon_dev.running = false;
+    /* Wake up a blocked reader, which then gets end-of-file */
+    sem_post(&pwrmon_dev.avail);
+    sem_post(&pwrmon_dev.stopped);
+
+    return 0;
+}
+
+static void pwrmon_dev_release(void)
+{
+    pwrmon_deinit_rail(pwrmon_dev.rail);
+    pwrmon_dev.rail = NULL;
+    pwrmon_deinit();
+}
+
+static int pwrmon_dev_start(struct pwrmon_sampler_cfg *cfg)
+{
+    int ret;
+
+    if (!cfg || !cfg->window) {
+        return -EINVAL;
+    }
+
+    if (pwrmon_dev.rail) {
+        return -EBUSY;
+    }
+
+    if (cfg->dev >= pwrmon_num_devs ||
+        cfg->rail >= pwrmon_dev_rail_count(cfg->dev)) {
+        return -ENODEV;
+    }
+
+    ret = pwrmon_init(cfg->current_lsb_uA, cfg->ct, cfg->avg_count);
+    if (ret) {
+        return ret;
+    }
+
+    pwrmon_dev.rail = pwrmon_init_rail(cfg->dev, cfg->rail);
+    if (!pwrmon_dev.rail) {
+        pwrmon_deinit();
+        return -EIO;
+    }
+
+    ret = pwrmon_enable_sampling(pwrmon_dev.rail);
+    if (ret) {
+        pwrmon_dev_release();
+        return ret;
+    }
+
+    /* Discard the windows of a previous run */
+    while (sem_trywait(&pwrmon_dev.avail) == OK);
+    pwrmon_dev.head = 0;
+    pwrmon_dev.count = 0;
+    pwrmon_dev.lost = 0;
+
+    pwrmon_dev.cfg = *cfg;
+    pwrmon_dev.running = true;
+    ret = kernel_thread("pwrmon", CONFIG_ARA_SVC_PWRMON_DEV_PRIO,
+                        PWRMON_DEV_STACK, pwrmon_dev_sampler, NULL);
+    if (ret < 0) {
+        pwrmon_dev.running = false;
+        pwrmon_dev_release();
+        return -errno;
+    }
+
+    return 0;
+}
+
+static int pwrmon_dev_stop(void)
+{
+    if (!pwrmon_dev.rail) {
+        return 0;
+    }
+
+    /* The sampler may have stopped by itself on error */
+    pwrmon_dev.running = false;
+    while (sem_wait(&pwrmon_dev.stopped) != OK);
+
+    pwrmon_dev_release();
+
+    return 0;
+}
+
+static int pwrmon_dev_open(struct file *filep)
+{
+    int ret = 0;
+
+    while (sem_wait(&pwrmon_dev.lock) != OK);
+    if (pwrmon_dev.opened) {
+        ret = -EBUSY;
+    } else {
+        pwrmon_dev.opened = true;
+    }
+    sem_post(&pwrmon_dev.lock);
+
+    return ret;
+}
+
+static int pwrmon_dev_close(struct file *filep)
+{
+    while (sem_wait(&pwrmon_dev.lock) != OK);
+    pwrmon_dev_stop();
+    pwrmon_dev.opened = false;
+    sem_post(&pwrmon_dev.lock);
+
+    return 0;
+}
+
+static ssize_t pwrmon_dev_read(struct file *filep, char *buffer,
+                               size_t buflen)
+{
+    struct pwrmon_window *w = (struct pwrmon_window *) buffer;
+    size_t nr = buflen / sizeof(*w);
+    size_t i;
+
+    if (!nr) {
+        return -EINVAL;
+    }
+
+    /* Block for the first window only, return what is there beyond it */
+    if (filep->f_oflags & O_NONBLOCK) {
+        if (sem_trywait(&pwrmon_dev.avail) != OK) {
+            return -EAGAIN;
+        }
+    } else if (sem_wait(&pwrmon_dev.avail) != OK) {
+        return -EINTR;
+    }
+
+    for (i = 0; i < nr; i++) {
+        if (i && sem_trywait(&pwrmon_dev.avail) != OK) {
+            break;
+        }
+        if (!pwrmon_dev_pop(&w[i])) {
+            break;
+        }
+    }
+
+    return i * sizeof(*w);
+}
+
+static int pwrmon_dev_ioctl(struct file *filep, int cmd, unsigned long arg)
+{
+    int ret;
+
+    while (sem_wait(&pwrmon_dev.lock) != OK);
+
+    switch (cmd) {
+    case PWRMON_IOC_START:
+        ret = pwrmon_dev_start((struct pwrmon_sampler_cfg *) arg);
+        break;
+    case PWRMON_IOC_STOP:
+        ret = pwrmon_dev_stop();
+        break;
+    default:
+        ret = -ENOTTY;
+        break;
+    }
+
+    sem_post(&pwrmon_dev.lock);
+
+    return ret;
+}
+
+static const struct file_operations pwrmon_dev_fops = {
+    .open = pwrmon_dev_open,
+    .close = pwrmon_dev_close,
+    .read = pwrmon_dev_read,
+    .ioctl = pwrmon_dev_ioctl,
+};
+
+/**
+ * @brief           Register the power monitor sampler device.
+ * @return          0 on success, standard error codes otherwise.
+ */
+int pwrmon_dev_register(void)
+{
+    sem_init(&pwrmon_dev.lock, 0, 1);
+    sem_init(&pwrmon_dev.ring_lock, 0, 1);
+    sem_init(&pwrmon_dev.avail, 0, 0);
+    sem_init(&pwrmon_dev.stopped, 0, 0);
+
+    return register_driver(PWRMON_DEV_PATH, &pwrmon_dev_fops, 0444, NULL);
+}
@@ -50,6 +50,7 @@
 #include "svc.h"
 #include "vreg.h"
 #include "gb_svc.h"
+#include "link_gov.h"
 
 #define SVCD_PRIORITY      (60)
 #define SVCD_STACK_SIZE    (2048)
@@ -504,6 +505,8 @@ static int svc_handle_hot_unplug(uint8_t portid) {
         return intf_id;
     }
 
+    link_gov_port_remove(portid);
+
     return gb_svc_intf_hot_unplug(intf_id);
 }
 
@@ -538,6 +541,8 @@ static int svc_handle_module_ready(uint8_t portid) {
     ara_vend_id = 0x0000;
     ara_prod_id = 0x0000;
 
+    link_gov_port_add(svc->sw, portid);
+
     return gb_svc_intf_hotplug(intf_id, unipro_mfg_id, unipro_prod_id,
                                ara_vend_id, ara_prod_id);
 }
@@ -808,7 +813,7 @@ static int svcd_main(int argc, char **argv) {
     }
 
     while (!svc->stop) {
-        pthread_cond_wait(&svc->cv, &svc->lock);
+        link_gov_wait(&svc->cv, &svc->lock);
         /* check to see if we were told to stop */
         if (svc->stop) {
             dbg_verbose("svc stop requested\n");
@@ -823,12 +828,17 @@ static int svcd_main(int argc, char **argv) {
             dbg_info("AP initialized on interface %u\n", svc->ap_intf_id);
             svc->ap_initialized = 1;
 
+            link_gov_port_add(svc->sw,
+                              interface_get_portid_by_id(svc->ap_intf_id));
+
             /* Send hotplug events to the AP */
             svc_consume_hotplug_events();
         }
 
         if (svc->ap_initialized) {
             svc_handle_events();
+            link_gov_poll(svc->sw,
+                          interface_get_portid_by_id(svc->ap_intf_id));
         }
     };
 
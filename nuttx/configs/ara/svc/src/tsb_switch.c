@@ -190,6 +190,98 @@ int switch_dme_peer_get(struct tsb_switch *sw,
     return sw->ops->peer_get(sw, portid, attrid, select_index, attr_value);
 }
 
+/**
+ * @brief Apply several DME attribute writes, in order
+ *
+ * Switches able to pipeline NCP requests send them all before collecting
+ * the confirmations, the others fall back to one request at a time.
+ *
+ * @return 0 on success, the first error otherwise. The writes following a
+ *         failed one may or may not have been applied.
+ */
+int switch_dme_set_batch(struct tsb_switch *sw,
+                         const struct switch_dme_write *writes,
+                         size_t count) {
+    size_t i;
+    int rc;
+
+    if (sw->ops->set_batch) {
+        return sw->ops->set_batch(sw, writes, count);
+    }
+
+    for (i = 0; i < count; i++) {
+        if (writes[i].peer) {
+            rc = switch_dme_peer_set(sw, writes[i].portid, writes[i].attrid,
+                                     writes[i].select_index,
+                                     writes[i].attr_value);
+        } else {
+            rc = switch_dme_set(sw, writes[i].portid, writes[i].attrid,
+                                writes[i].select_index,
+                                writes[i].attr_value);
+        }
+        if (rc) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+void switch_dme_batch_init(struct switch_dme_batch *batch,
+                           struct tsb_switch *sw) {
+    batch->sw = sw;
+    batch->rc = 0;
+    batch->count = 0;
+}
+
+/**
+ * @brief Queue a DME attribute write
+ *
+ * The queue is sent when full. Once a write failed, the following ones are
+ * dropped and the error is returned by switch_dme_batch_flush().
+ */
+void switch_dme_batch_add(struct switch_dme_batch *batch,
+                          uint8_t portid,
+                          bool peer,
+                          uint16_t attrid,
+                          uint16_t select_index,
+                          uint32_t attr_value) {
+    struct switch_dme_write *w;
+
+    if (batch->rc) {
+        return;
+    }
+
+    if (batch->count == SWITCH_DME_BATCH_MAX) {
+        switch_dme_batch_flush(batch);
+        if (batch->rc) {
+            return;
+        }
+    }
+
+    w = &batch->writes[batch->count++];
+    w->portid = portid;
+    w->peer = peer;
+    w->attrid = attrid;
+    w->select_index = select_index;
+    w->attr_value = attr_value;
+}
+
+/**
+ * @brief Send the queued DME attribute writes
+ *
+ * @return 0 if all the writes queued since switch_dme_batch_init()
+ *         succeeded, the first error otherwise
+ */
+int switch_dme_batch_flush(struct switch_dme_batch *batch) {
+    if (!batch->rc && batch->count) {
+        batch->rc = switch_dme_set_batch(batch->sw, batch->writes,
+                                         batch->count);
+    }
+    batch->count = 0;
+    return batch->rc;
+}
+
 int switch_port_irq_enable(struct tsb_switch *sw,
                            uint8_t portid,
                            bool enable) {
@@ -1249,7 +1341,7 @@ int switch_qos_source_quantity(struct tsb_switch *sw, uint8_t port, uint8_t tc,
             *val = attr_val & AR_BSTAT_QUANTITY_RATE00_TC0;
             break;
         case SWITCH_TRAFFIC_CLASS_TC1:
-            *val = attr_val & AR_BSTAT_QUANTITY_RATE00_TC1 >> 16;
+            *val = (attr_val & AR_BSTAT_QUANTITY_RATE00_TC1) >> 16;
             break;
         default:
             return -EINVAL;
@@ -1439,57 +1531,57 @@ static int switch_set_pair_attr(struct tsb_switch *sw,
     return 0;
 }
 
+static void switch_batch_pair_attr(struct switch_dme_batch *batch,
+                                   struct unipro_connection *c,
+                                   uint16_t attrid,
+                                   uint32_t val0,
+                                   uint32_t val1) {
+    switch_dme_batch_add(batch, c->port_id0, c->port_id0 != SWITCH_PORT_ID,
+                         attrid, c->cport_id0, val0);
+    switch_dme_batch_add(batch, c->port_id1, c->port_id1 != SWITCH_PORT_ID,
+                         attrid, c->cport_id1, val1);
+}
+
 static int switch_cport_connect(struct tsb_switch *sw,
                                 struct unipro_connection *c) {
     int e2efc_enabled = (!!(c->flags & CPORT_FLAGS_E2EFC) == 1);
     int csd_enabled = (!!(c->flags & CPORT_FLAGS_CSD_N) == 0);
+    struct switch_dme_batch batch;
     int rc = 0;
 
+    switch_dme_batch_init(&batch, sw);
+
     /* Disable any existing connection(s). */
-    rc = switch_set_pair_attr(sw, c, T_CONNECTIONSTATE, 0, 0);
-    if (rc) {
-        return rc;
-    }
+    switch_batch_pair_attr(&batch, c, T_CONNECTIONSTATE, 0, 0);
 
     /*
      * Point each device at the other.
      */
-    rc = switch_set_pair_attr(sw,
-                              c,
-                              T_PEERDEVICEID,
-                              c->device_id1,
-                              c->device_id0);
-    if (rc) {
-        return rc;
-    }
+    switch_batch_pair_attr(&batch,
+                           c,
+                           T_PEERDEVICEID,
+                           c->device_id1,
+                           c->device_id0);
 
     /*
      * Point each CPort at the other.
      */
-    rc = switch_set_pair_attr(sw, c, T_PEERCPORTID, c->cport_id1, c->cport_id0);
-    if (rc) {
-        return rc;
-    }
+    switch_batch_pair_attr(&batch, c, T_PEERCPORTID, c->cport_id1,
+                           c->cport_id0);
 
     /*
      * Match up traffic classes.
      */
-    rc = switch_set_pair_attr(sw, c, T_TRAFFICCLASS, c->tc, c->tc);
-    if (rc) {
-        return rc;
-    }
+    switch_batch_pair_attr(&batch, c, T_TRAFFICCLASS, c->tc, c->tc);
 
     /*
      * Make sure the protocol IDs are equal. (We don't use them otherwise.)
      */
-    rc = switch_set_pair_attr(sw,
-                              c,
-                              T_PROTOCOLID,
-                              CPORT_DEFAULT_T_PROTOCOLID,
-                              CPORT_DEFAULT_T_PROTOCOLID);
-    if (rc) {
-        return rc;
-    }
+    switch_batch_pair_attr(&batch,
+                           c,
+                           T_PROTOCOLID,
+                           CPORT_DEFAULT_T_PROTOCOLID,
+                           CPORT_DEFAULT_T_PROTOCOLID);
 
     /*
      * Set default TxTokenValue and RxTokenValue values.
@@ -1498,24 +1590,17 @@ static int switch_cport_connect(struct tsb_switch *sw,
      * enabled, so don't change them to different values unless you
      * also patch up the E2EFC case, below.
      */
-    rc = switch_set_pair_attr(sw,
-                              c,
-                              T_TXTOKENVALUE,
-                              CPORT_DEFAULT_TOKENVALUE,
-                              CPORT_DEFAULT_TOKENVALUE);
-    if (rc) {
-        return rc;
-    }
-
-    rc = switch_set_pair_attr(sw,
-                              c,
-                              T_RXTOKENVALUE,
-                              CPORT_DEFAULT_TOKENVALUE,
-                              CPORT_DEFAULT_TOKENVALUE);
-    if (rc) {
-        return rc;
-    }
-
+    switch_batch_pair_attr(&batch,
+                           c,
+                           T_TXTOKENVALUE,
+                           CPORT_DEFAULT_TOKENVALUE,
+                           CPORT_DEFAULT_TOKENVALUE);
+
+    switch_batch_pair_attr(&batch,
+                           c,
+                           T_RXTOKENVALUE,
+                           CPORT_DEFAULT_TOKENVALUE,
+                           CPORT_DEFAULT_TOKENVALUE);
 
     /*
      * Set CPort flags.
@@ -1523,7 +1608,9 @@ static int switch_cport_connect(struct tsb_switch *sw,
      * (E2EFC needs to be the same on both sides, which is handled by
      * having a single flags value for now.)
      */
-    rc = switch_set_pair_attr(sw, c, T_CPORTFLAGS, c->flags, c->flags);
+    switch_batch_pair_attr(&batch, c, T_CPORTFLAGS, c->flags, c->flags);
+
+    rc = switch_dme_batch_flush(&batch);
     if (rc) {
         return rc;
     }
@@ -1554,47 +1641,45 @@ static int switch_cport_connect(struct tsb_switch *sw,
             return rc;
         }
 
-        rc = switch_set_pair_attr(sw,
-                                  c,
-                                  T_LOCALBUFFERSPACE,
-                                  cport0_local,
-                                  cport1_local);
-        if (rc) {
-            return rc;
-        }
+        switch_batch_pair_attr(&batch,
+                               c,
+                               T_LOCALBUFFERSPACE,
+                               cport0_local,
+                               cport1_local);
     }
 
     /*
      * Ensure the CPorts aren't in test mode.
      */
-    rc = switch_set_pair_attr(sw,
-                              c,
-                              T_CPORTMODE,
-                              CPORT_MODE_APPLICATION,
-                              CPORT_MODE_APPLICATION);
-    if (rc) {
-        return rc;
-    }
+    switch_batch_pair_attr(&batch,
+                           c,
+                           T_CPORTMODE,
+                           CPORT_MODE_APPLICATION,
+                           CPORT_MODE_APPLICATION);
 
     /*
      * Clear out the credits to send on each side.
      */
-    rc = switch_set_pair_attr(sw, c, T_CREDITSTOSEND, 0, 0);
-    if (rc) {
-        return rc;
-    }
+    switch_batch_pair_attr(&batch, c, T_CREDITSTOSEND, 0, 0);
 
     /*
      * XXX Toshiba-specific TSB_MaxSegmentConfig (move to bridge ASIC code.)
      */
-    rc = switch_set_pair_attr(sw,
-                              c,
-                              TSB_MAXSEGMENTCONFIG,
-                              CPORT_DEFAULT_TSB_MAXSEGMENTCONFIG,
-                              CPORT_DEFAULT_TSB_MAXSEGMENTCONFIG);
+    switch_batch_pair_attr(&batch,
+                           c,
+                           TSB_MAXSEGMENTCONFIG,
+                           CPORT_DEFAULT_TSB_MAXSEGMENTCONFIG,
+                           CPORT_DEFAULT_TSB_MAXSEGMENTCONFIG);
+
+    /*
+     * Only establish the connections once everything else is known to
+     * be in place.
+     */
+    rc = switch_dme_batch_flush(&batch);
     if (rc) {
         return rc;
     }
+
     /*
      * Establish the connections!
      */
@@ -267,6 +267,25 @@ struct tsb_link_cfg {
  */
 struct tsb_switch;
 
+/* One DME attribute write of a batch */
+struct switch_dme_write {
+    uint8_t portid;
+    bool peer;
+    uint16_t attrid;
+    uint16_t select_index;
+    uint32_t attr_value;
+};
+
+/* Writes queued before they are sent to the switch in one go */
+#define SWITCH_DME_BATCH_MAX    (16)
+
+struct switch_dme_batch {
+    struct tsb_switch *sw;
+    int rc;
+    size_t count;
+    struct switch_dme_write writes[SWITCH_DME_BATCH_MAX];
+};
+
 struct tsb_switch_ops {
     int (*init_comm)(struct tsb_switch *);
 
@@ -290,6 +309,10 @@ struct tsb_switch_ops {
                     uint16_t attrid,
                     uint16_t select_index,
                     uint32_t *attr_value);
+    /* Optional: issue several sets and peer sets at once, in order */
+    int (*set_batch)(struct tsb_switch *,
+                     const struct switch_dme_write *writes,
+                     size_t count);
     int (*port_irq_enable)(struct tsb_switch *sw,
                            uint8_t port_id,
                            bool enable);
@@ -604,6 +627,20 @@ int switch_dme_peer_get(struct tsb_switch *sw,
                         uint16_t select_index,
                         uint32_t *attr_value);
 
+int switch_dme_set_batch(struct tsb_switch *sw,
+                         const struct switch_dme_write *writes,
+                         size_t count);
+
+void switch_dme_batch_init(struct switch_dme_batch *batch,
+                           struct tsb_switch *sw);
+void switch_dme_batch_add(struct switch_dme_batch *batch,
+                          uint8_t portid,
+                          bool peer,
+                          uint16_t attrid,
+                          uint16_t select_index,
+                          uint32_t attr_value);
+int switch_dme_batch_flush(struct switch_dme_batch *batch);
+
 int switch_port_irq_enable(struct tsb_switch *sw,
                            uint8_t portid,
                            bool enable);
@@ -312,16 +312,18 @@ static int es2_read_status(struct tsb_switch *sw,
     return 0;
 }
 
-static int es2_write(struct tsb_switch *sw,
-                     uint8_t cportid,
-                     uint8_t *tx_buf,
-                     size_t tx_size) {
+/*
+ * Send one message and check its write status. The caller must have selected
+ * the switch; several messages can be sent in a row with a single selection.
+ */
+static int es2_spi_write_msg(struct tsb_switch *sw,
+                             uint8_t cportid,
+                             uint8_t *tx_buf,
+                             size_t tx_size) {
     struct sw_es2_priv *priv = sw->priv;
     struct spi_dev_s *spi_dev = priv->spi_dev;
-    struct srpt_read_status_report rpt;
     uint8_t *rxbuf = cport_to_rxbuf(priv, cportid);
     unsigned int size;
-    int ret = OK;
 
     uint8_t write_header[] = {
         LNUL,
@@ -336,6 +338,36 @@ static int es2_write(struct tsb_switch *sw,
         LNUL,
     };
 
+    /* Write */
+    SPI_SNDBLOCK(spi_dev, write_header, sizeof write_header);
+    SPI_SNDBLOCK(spi_dev, tx_buf, tx_size);
+    SPI_SNDBLOCK(spi_dev, write_trailer, sizeof write_trailer);
+    // Wait write status, send NULL frames while waiting
+    SPI_EXCHANGE(spi_dev, NULL, rxbuf, SWITCH_WRITE_STATUS_NNULL);
+
+    dbg_insane("Write payload:\n");
+    dbg_print_buf(ARADBG_INSANE, tx_buf, tx_size);
+    dbg_insane("Write status:\n");
+    dbg_print_buf(ARADBG_INSANE, rxbuf, SWITCH_WRITE_STATUS_NNULL);
+
+    // Make sure we use 16-bit frames
+    size = sizeof write_header + tx_size + sizeof write_trailer
+           + SWITCH_WRITE_STATUS_NNULL;
+    if (size % 2) {
+        SPI_SEND(spi_dev, LNUL);
+    }
+
+    // Parse the write status and bail on error.
+    return es2_transfer_check_write_status(rxbuf, SWITCH_WRITE_STATUS_NNULL);
+}
+
+static int es2_write(struct tsb_switch *sw,
+                     uint8_t cportid,
+                     uint8_t *tx_buf,
+                     size_t tx_size) {
+    struct srpt_read_status_report rpt;
+    int ret = OK;
+
     switch (cportid) {
     case CPORT_NCP:
         if (tx_size >= ES2_CPORT_NCP_MAX_PAYLOAD) {
@@ -366,33 +398,7 @@ static int es2_write(struct tsb_switch *sw,
     }
 
     es2_spi_select(sw, true);
-    /* Write */
-    SPI_SNDBLOCK(spi_dev, write_header, sizeof write_header);
-    SPI_SNDBLOCK(spi_dev, tx_buf, tx_size);
-    SPI_SNDBLOCK(spi_dev, write_trailer, sizeof write_trailer);
-    // Wait write status, send NULL frames while waiting
-    SPI_EXCHANGE(spi_dev, NULL, rxbuf, SWITCH_WRITE_STATUS_NNULL);
-
-    dbg_insane("Write payload:\n");
-    dbg_print_buf(ARADBG_INSANE, tx_buf, tx_size);
-    dbg_insane("Write status:\n");
-    dbg_print_buf(ARADBG_INSANE, rxbuf, SWITCH_WRITE_STATUS_NNULL);
-
-    // Make sure we use 16-bit frames
-    size = sizeof write_header + tx_size + sizeof write_trailer
-           + SWITCH_WRITE_STATUS_NNULL;
-    if (size % 2) {
-        SPI_SEND(spi_dev, LNUL);
-    }
-
-    // Parse the write status and bail on error.
-    ret = es2_transfer_check_write_status(rxbuf,
-                                          SWITCH_WRITE_STATUS_NNULL);
-    if (ret) {
-        goto out;
-    }
-
-out:
+    ret = es2_spi_write_msg(sw, cportid, tx_buf, tx_size);
     es2_spi_select(sw, false);
     return ret;
 }
@@ -609,6 +615,7 @@ static uint32_t es2_mphy_trim_fixup_value(uint32_t mphy_trim[4], uint8_t port)
  */
 static int es2_fixup_mphy(struct tsb_switch *sw)
 {
+    struct switch_dme_batch batch;
     uint32_t mphy_trim[4];
     int rc;
     uint8_t port;
@@ -628,52 +635,33 @@ static int es2_fixup_mphy(struct tsb_switch *sw)
     for (port = 0; port < ES2_SWITCH_NUM_UNIPORTS; port++) {
         const struct tsb_mphy_fixup *fu;
 
+        switch_dme_batch_init(&batch, sw);
+
         /*
          * Apply the "register 2" map fixups.
          */
-        rc = switch_dme_set(sw, port, TSB_MPHY_MAP, 0,
-                            TSB_MPHY_MAP_TSB_REGISTER_2);
-        if (rc) {
-            dbg_error("%s(): failed to set switch map to \"TSB register 2\": %d\n",
-                      __func__, rc);
-            return rc;
-        }
+        switch_dme_batch_add(&batch, port, false, TSB_MPHY_MAP, 0,
+                             TSB_MPHY_MAP_TSB_REGISTER_2);
         fu = tsb_register_2_map_mphy_fixups;
         do {
             dbg_verbose("%s: port=%u, attrid=0x%04x, select_index=%u, value=0x%02x\n",
                         __func__, port, fu->attrid, fu->select_index,
                         fu->value);
-            rc = switch_dme_set(sw, port, fu->attrid, fu->select_index,
-                                fu->value);
-            if (rc) {
-                dbg_error("%s(): failed to apply register 2 map fixup: %d\n",
-                          __func__, rc);
-                return rc;
-            }
+            switch_dme_batch_add(&batch, port, false, fu->attrid,
+                                 fu->select_index, fu->value);
         } while (!tsb_mphy_fixup_is_last(fu++));
 
-
         /*
          * Switch to "normal" map.
          */
-        rc = switch_dme_set(sw, port, TSB_MPHY_MAP, 0,
-                            TSB_MPHY_MAP_NORMAL);
-        if (rc) {
-            dbg_error("%s(): failed to set switch map to normal: %d\n",
-                      __func__, rc);
-            return rc;
-        }
+        switch_dme_batch_add(&batch, port, false, TSB_MPHY_MAP, 0,
+                             TSB_MPHY_MAP_NORMAL);
 
         /*
          * Apply the "register 1" map fixups.
          */
-        rc = switch_dme_set(sw, port, TSB_MPHY_MAP, 0,
-                          TSB_MPHY_MAP_TSB_REGISTER_1);
-        if (rc) {
-            dbg_error("%s(): failed to switch to TSB register 1 map: %d\n",
-                      __func__, rc);
-            return rc;
-        }
+        switch_dme_batch_add(&batch, port, false, TSB_MPHY_MAP, 0,
+                             TSB_MPHY_MAP_TSB_REGISTER_1);
         fu = tsb_register_1_map_mphy_fixups;
         do {
             if (tsb_mphy_r1_fixup_is_magic(fu)) {
@@ -682,29 +670,26 @@ static int es2_fixup_mphy(struct tsb_switch *sw)
                 uint32_t mpt = es2_mphy_trim_fixup_value(mphy_trim, port);
                 dbg_verbose("%s: port=%u, attrid=0x%04x, select_index=%u, value=0x%02x\n",
                             __func__, port, 0x8002, 0, mpt);
-                rc = switch_dme_set(sw, port, 0x8002, 0, mpt);
+                switch_dme_batch_add(&batch, port, false, 0x8002, 0, mpt);
             } else {
                 dbg_verbose("%s: port=%u, attrid=0x%04x, select_index=%u, value=0x%02x\n",
                             __func__, port, fu->attrid, fu->select_index,
                             fu->value);
-                rc = switch_dme_set(sw, port, fu->attrid,
-                                    fu->select_index, fu->value);
-            }
-            if (rc) {
-                dbg_error("%s(): failed to apply register 1 map fixup: %d\n",
-                          __func__, rc);
-                return rc;
+                switch_dme_batch_add(&batch, port, false, fu->attrid,
+                                     fu->select_index, fu->value);
             }
         } while (!tsb_mphy_fixup_is_last(fu++));
 
         /*
          * Switch to "normal" map.
          */
-        rc = switch_dme_set(sw, port, TSB_MPHY_MAP, 0,
-                            TSB_MPHY_MAP_NORMAL);
+        switch_dme_batch_add(&batch, port, false, TSB_MPHY_MAP, 0,
+                             TSB_MPHY_MAP_NORMAL);
+
+        rc = switch_dme_batch_flush(&batch);
         if (rc) {
-            dbg_error("%s(): failed to re-set switch map to normal: %d\n",
-                      __func__, rc);
+            dbg_error("%s(): failed to apply fixups to port %u: %d\n",
+                      __func__, port, rc);
             return rc;
         }
     }
@@ -1186,6 +1171,98 @@ static int es2_peer_get(struct tsb_switch *sw,
     return cnf.rc;
 }
 
+#define ES2_SET_REQ_SIZE    (11)
+
+static void es2_set_req(uint8_t *req, const struct switch_dme_write *w) {
+    req[0] = SWITCH_DEVICE_ID;
+    req[1] = w->portid;
+    req[2] = w->peer ? NCP_PEERSETREQ : NCP_SETREQ;
+    req[3] = w->attrid >> 8;
+    req[4] = w->attrid & 0xff;
+    req[5] = w->select_index >> 8;
+    req[6] = w->select_index & 0xff;
+    req[7] = (w->attr_value >> 24) & 0xff;
+    req[8] = (w->attr_value >> 16) & 0xff;
+    req[9] = (w->attr_value >> 8) & 0xff;
+    req[10] = w->attr_value & 0xff;
+}
+
+/*
+ * Pipeline set and peer set requests: send as many requests as the NCP
+ * entry FIFO takes within a single SPI selection, then collect all their
+ * confirmations. This saves waiting for each confirmation in turn.
+ */
+static int es2_set_batch(struct tsb_switch *sw,
+                         const struct switch_dme_write *writes,
+                         size_t count)
+{
+    struct sw_es2_priv *priv = sw->priv;
+    uint8_t req[ES2_SET_REQ_SIZE];
+    struct __attribute__ ((__packed__)) cnf {
+        uint8_t port_id;
+        uint8_t function_id;
+        uint8_t reserved;
+        uint8_t rc;
+    } cnf;
+    size_t sent, i;
+    int first_rc = 0;
+    int rc = 0;
+
+    pthread_mutex_lock(&priv->ncp_cport.lock);
+
+    while (count && !rc) {
+        es2_spi_select(sw, true);
+        for (sent = 0; sent < count; sent++) {
+            es2_set_req(req, &writes[sent]);
+            rc = es2_spi_write_msg(sw, CPORT_NCP, req, sizeof(req));
+            if (rc) {
+                break;
+            }
+        }
+        es2_spi_select(sw, false);
+
+        /* The entry FIFO is full: collect what was sent, then go on */
+        if (rc == -EAGAIN && sent) {
+            rc = 0;
+        } else if (rc) {
+            dbg_error("%s() write failed: rc=%d\n", __func__, rc);
+        }
+
+        for (i = 0; i < sent; i++) {
+            const struct switch_dme_write *w = &writes[i];
+            int err;
+
+            err = es2_read(sw, CPORT_NCP, (uint8_t *) &cnf, sizeof(cnf));
+            if (!err && cnf.function_id !=
+                        (w->peer ? NCP_PEERSETCNF : NCP_SETCNF)) {
+                dbg_error("%s(): unexpected CNF 0x%x\n", __func__,
+                          cnf.function_id);
+                err = -EPROTO;
+            } else if (!err) {
+                err = cnf.rc;
+            }
+
+            if (err) {
+                dbg_error("%s(): portId=%u, attrId=0x%04x failed: rc=%d\n",
+                          __func__, w->portid, w->attrid, err);
+                if (!first_rc) {
+                    first_rc = err;
+                }
+            }
+        }
+
+        writes += sent;
+        count -= sent;
+        if (first_rc) {
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&priv->ncp_cport.lock);
+
+    return first_rc ? first_rc : rc;
+}
+
 static int es2_lut_set(struct tsb_switch *sw,
                        uint8_t unipro_portid,
                        uint8_t lut_address,
@@ -1778,6 +1855,7 @@ static struct tsb_switch_ops es2_ops = {
 
     .peer_set              = es2_peer_set,
     .peer_get              = es2_peer_get,
+    .set_batch             = es2_set_batch,
 
     .lut_set               = es2_lut_set,
     .lut_get               = es2_lut_get,
@@ -34,6 +34,8 @@
 
 #include <errno.h>
 #include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <nuttx/config.h>
 #include <arch/board/board.h>
@@ -81,6 +83,51 @@ int unipro_send(unsigned int cportid, const void *buf, size_t len) {
     return 0;
 }
 
+int unipro_send_batch(unsigned int cportid, const void * const bufs[],
+                      const size_t lens[], size_t count) {
+    size_t i;
+    int retval;
+
+    for (i = 0; i < count; i++) {
+        retval = unipro_send(cportid, bufs[i], lens[i]);
+        if (retval) {
+            return retval;
+        }
+    }
+
+    return 0;
+}
+
+int unipro_sendv(unsigned int cportid, const void * const bufs[],
+                 const size_t lens[], size_t count) {
+    uint8_t *buf, *p;
+    size_t i, len;
+    int retval;
+
+    for (i = 0, len = 0; i < count; i++) {
+        len += lens[i];
+    }
+
+    buf = malloc(len ? len : 1);
+    if (!buf) {
+        return -ENOMEM;
+    }
+
+    for (i = 0, p = buf; i < count; i++) {
+        memcpy(p, bufs[i], lens[i]);
+        p += lens[i];
+    }
+
+    retval = unipro_send(cportid, buf, len);
+    free(buf);
+
+    return retval;
+}
+
+
+int unipro_set_tx_class(unsigned int cportid, enum unipro_tx_class tx_class) {
+    return -ENOSYS;
+}
 
 int unipro_driver_register(struct unipro_driver *drv, unsigned int cportid) {
     lldbg("Registering driver %s on cport: %u\n", drv->name, cportid);
@@ -137,3 +184,13 @@ void unipro_if_rx(unsigned int cportid, void *data, size_t len) {
 void unipro_rxbuf_free(unsigned int cportid, void *ptr)
 {
 }
+
+int unipro_rx_pause(unsigned int cportid)
+{
+    return -ENOSYS;
+}
+
+int unipro_rx_resume(unsigned int cportid)
+{
+    return -ENOSYS;
+}
@@ -67,6 +67,10 @@
 #include <nuttx/config.h>
 #include <stdio.h>
 
+#ifdef CONFIG_ARA_SVC_PWRMON_DEV
+#include <pwr_mon.h>
+#endif
+
 
 /****************************************************************************
  * Name: nsh_archinitialize
@@ -77,5 +81,8 @@
  ****************************************************************************/
 
 int nsh_archinitialize(void) {
+#ifdef CONFIG_ARA_SVC_PWRMON_DEV
+	pwrmon_dev_register();
+#endif
 	return OK;
 }
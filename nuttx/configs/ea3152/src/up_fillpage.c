@@ -413,8 +413,13 @@ int up_fillpage(FAR struct tcb_s *tcb, FAR void *vpage)
   off_t   offset;
 #endif
 
-  pglldbg("TCB: %p vpage: %p far: %08x\n", tcb, vpage, tcb->xcp.far);
-  DEBUGASSERT(tcb->xcp.far >= PG_PAGED_VBASE && tcb->xcp.far < PG_PAGED_VEND);
+  /* tcb is NULL when the page is being prefetched.  The page to fill is
+   * always identified by vpage.
+   */
+
+  pglldbg("TCB: %p vpage: %p\n", tcb, vpage);
+  DEBUGASSERT((uintptr_t)vpage >= PG_PAGED_VBASE &&
+              (uintptr_t)vpage < PG_PAGED_VEND);
 
   /* If BINPATH is defined, then it is the full path to a file on a mounted file
    * system.  In this case initialization will be deferred until the first
@@ -431,7 +436,7 @@ int up_fillpage(FAR struct tcb_s *tcb, FAR void *vpage)
    * virtual address.   File offset 0 corresponds to PG_LOCKED_VBASE.
    */
 
-  offset = (off_t)tcb->xcp.far - PG_LOCKED_VBASE;
+  offset = (off_t)((uintptr_t)vpage - PG_LOCKED_VBASE);
 
   /* Seek to that position */
 
@@ -454,7 +459,8 @@ int up_fillpage(FAR struct tcb_s *tcb, FAR void *vpage)
    * virtual address.   File offset 0 corresponds to PG_LOCKED_VBASE.
    */
 
-  offset = (off_t)tcb->xcp.far - PG_LOCKED_VBASE + CONFIG_EA3152_PAGING_BINOFFSET;
+  offset = (off_t)((uintptr_t)vpage - PG_LOCKED_VBASE) +
+           CONFIG_EA3152_PAGING_BINOFFSET;
 
   /* Read the page at the correct offset into the SPI FLASH device */
 
@@ -37,6 +37,7 @@
 #include <errno.h>
 
 #include <nuttx/config.h>
+#include <nuttx/bootphase.h>
 #include <nuttx/device.h>
 #include <nuttx/device_battery.h>
 #include <nuttx/device_battery_good.h>
@@ -970,6 +971,11 @@ void board_initialize(void)
 #ifdef CONFIG_DEVICE_CORE
   device_table_register(&muc_device_table);
 
+  /* Drivers of the functions needed to attach to the host are probed now,
+   * the others are registered with device_register_driver_deferred() and
+   * probed by the deferred initialization thread, or on first open.
+   */
+
 #ifdef CONFIG_FUSB302
   fusb302_register(GPIO_MODS_FUSB302_INT_N, GPIO_MODS_VBUS_PWR_EN);
 #endif
@@ -1039,19 +1045,19 @@ void board_initialize(void)
 #endif
 #ifdef CONFIG_GREYBUS_SENSORS_EXT_DUMMY_PRESSURE
   extern struct device_driver sensor_dummy_pressure_driver;
-  device_register_driver(&sensor_dummy_pressure_driver);
+  device_register_driver_deferred(&sensor_dummy_pressure_driver);
 #endif
 #ifdef CONFIG_GREYBUS_SENSORS_EXT_DUMMY_ACCEL
   extern struct device_driver sensor_dummy_accel_driver;
-  device_register_driver(&sensor_dummy_accel_driver);
+  device_register_driver_deferred(&sensor_dummy_accel_driver);
 #endif
 #ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL
   extern struct device_driver sensor_lsm9sd1_accel_driver;
-  device_register_driver(&sensor_lsm9sd1_accel_driver);
+  device_register_driver_deferred(&sensor_lsm9sd1_accel_driver);
 #endif
 #ifdef CONFIG_HDMI_DISPLAY
    extern struct device_driver hdmi_display_driver;
-   device_register_driver(&hdmi_display_driver);
+   device_register_driver_deferred(&hdmi_display_driver);
 #endif
 #ifdef CONFIG_STM32_UART_DEVICE
   extern struct device_driver stm32_uart_driver;
@@ -1063,53 +1069,53 @@ void board_initialize(void)
 #endif
 #ifdef CONFIG_MHB_DSI_DISPLAY
    extern struct device_driver dsi_display_driver;
-   device_register_driver(&dsi_display_driver);
+   device_register_driver_deferred(&dsi_display_driver);
 #endif
 #ifdef CONFIG_BACKLIGHT_DCS
    extern struct device_driver dcs_backlight_driver;
-   device_register_driver(&dcs_backlight_driver);
+   device_register_driver_deferred(&dcs_backlight_driver);
 #endif
 #ifdef CONFIG_BACKLIGHT_ISL98611
    extern struct device_driver isl98611_backlight_driver;
-   device_register_driver(&isl98611_backlight_driver);
+   device_register_driver_deferred(&isl98611_backlight_driver);
 #endif
 #ifdef CONFIG_BACKLIGHT_LM27965
    extern struct device_driver lm27965_backlight_driver;
-   device_register_driver(&lm27965_backlight_driver);
+   device_register_driver_deferred(&lm27965_backlight_driver);
 #endif
 #if defined(CONFIG_MHB_CAMERA)
    extern struct device_driver cam_ext_mhb_driver;
-   device_register_driver(&cam_ext_mhb_driver);
+   device_register_driver_deferred(&cam_ext_mhb_driver);
 #endif
 #if defined(CONFIG_CAMERA_IMX220)
     extern struct device_driver imx220_mhb_camera_driver;
-    device_register_driver(&imx220_mhb_camera_driver);
+    device_register_driver_deferred(&imx220_mhb_camera_driver);
 #endif
 #if defined(CONFIG_CAMERA_IMX230)
     extern struct device_driver imx230_mhb_camera_driver;
-    device_register_driver(&imx230_mhb_camera_driver);
+    device_register_driver_deferred(&imx230_mhb_camera_driver);
 #endif
 #if defined(CONFIG_CAMERA_OV5647_PI)
     extern struct device_driver ov5647_pi_mhb_camera_driver;
-    device_register_driver(&ov5647_pi_mhb_camera_driver);
+    device_register_driver_deferred(&ov5647_pi_mhb_camera_driver);
 #endif
 #if defined(CONFIG_CAMERA_IMX219_PI)
     extern struct device_driver imx219_pi_mhb_camera_driver;
-    device_register_driver(&imx219_pi_mhb_camera_driver);
+    device_register_driver_deferred(&imx219_pi_mhb_camera_driver);
 #endif
 #if defined(CONFIG_MODS_HDMI_TO_CSI)
     extern struct device_driver hdmi_to_csi_camera_driver;
-    device_register_driver(&hdmi_to_csi_camera_driver);
+    device_register_driver_deferred(&hdmi_to_csi_camera_driver);
 #endif
 #ifdef CONFIG_MODS_AUDIO_TFA9890
   extern struct device_driver tfa9890_i2s_direct_driver;
-  device_register_driver(&tfa9890_i2s_direct_driver);
+  device_register_driver_deferred(&tfa9890_i2s_direct_driver);
   extern struct device_driver tfa9890_audio_dev_driver;
-  device_register_driver(&tfa9890_audio_dev_driver);
+  device_register_driver_deferred(&tfa9890_audio_dev_driver);
 #endif
 #ifdef CONFIG_MODS_MHB_AUDIO_TFA9890
   extern struct device_driver tfa9890_audio_dev_driver;
-  device_register_driver(&tfa9890_audio_dev_driver);
+  device_register_driver_deferred(&tfa9890_audio_dev_driver);
   extern struct device_driver mhb_i2s_driver;
   device_register_driver(&mhb_i2s_driver);
 #endif
@@ -1131,7 +1137,7 @@ void board_initialize(void)
 #endif
 #ifdef CONFIG_MODS_HID_EXAMPLE
    extern struct device_driver hid_game_driver;
-   device_register_driver(&hid_game_driver);
+   device_register_driver_deferred(&hid_game_driver);
 #endif
 #ifdef CONFIG_MODS_RAW_FLIR
    extern struct device_driver mods_flir_raw_driver;
@@ -1139,6 +1145,8 @@ void board_initialize(void)
 #endif
 #endif
 
+  boottrace_mark("board drivers");
+
 #ifdef CONFIG_BATTERY_MAX17050
    struct i2c_dev_s *i2c = up_i2cinitialize(MAX17050_I2C_BUS);
    if (i2c) {
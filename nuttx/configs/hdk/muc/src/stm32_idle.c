@@ -45,10 +45,156 @@
 #include <arch/irq.h>
 
 #include "up_internal.h"
+#include "up_arch.h"
+#include "nvic.h"
 #include "stm32_pm.h"
 #include "stm32_rcc.h"
 #include "stm32_exti.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Data Watchpoint and Trace unit, to time the clock restore */
+
+#define DWT_CTRL                0xe0001000
+#define DWT_CYCCNT              0xe0001004
+
+#define DWT_CTRL_CYCCNTENA      (1 << 0)
+
+/* The core wakes up from STOP on the 16 MHz HSI (see stm32_clocksave())
+ * and spends nearly all of the restore on it, waiting for the PLLs.
+ */
+
+#define WAKEUP_CLOCK_MHZ        16
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* A low-power state entered from the IDLE loop.  exit_latency is the
+ * datasheet wake-up time; restore is the worst clock restore time measured
+ * so far.  Both are in microseconds.
+ */
+
+#ifdef CONFIG_PM
+struct sleep_state_s
+{
+  FAR const char *name;
+  int (*enter)(void);
+  uint32_t exit_latency;
+  uint32_t restore;
+  uint32_t count;
+};
+#endif
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_PM
+static int stop1_enter(void);
+#endif
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_PM
+/* Deepest first.  STOP 2 does not let the serial console wake the MCU, so
+ * it is left out of debug builds.
+ */
+
+static struct sleep_state_s g_sleep_states[] =
+{
+#ifndef CONFIG_DEBUG
+  { "stop2", stm32_pmstop2, 9, 0, 0 },
+#endif
+  { "stop1", stop1_enter,   7, 0, 0 },
+};
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: stop1_enter
+ *
+ * Description:
+ *   STOP 1 with the low-power regulator.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PM
+static int stop1_enter(void)
+{
+  return stm32_pmstop(true);
+}
+#endif
+
+/****************************************************************************
+ * Name: sleep_select
+ *
+ * Description:
+ *   Return the deepest sleep state that is left, clocks restored, within
+ *   the PM QoS wake-up latency constraint, or NULL if none is.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PM
+static FAR struct sleep_state_s *sleep_select(void)
+{
+  uint32_t qos = pm_qos_latency();
+  int i;
+
+  for (i = 0; i < sizeof(g_sleep_states) / sizeof(g_sleep_states[0]); i++)
+    {
+      if (g_sleep_states[i].exit_latency + g_sleep_states[i].restore <= qos)
+        {
+          return &g_sleep_states[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: sleep_enter
+ *
+ * Description:
+ *   Enter a sleep state and restore the clocks from the cached RCC
+ *   configuration on the way out, timing the restore.  Called with
+ *   interrupts disabled.
+ *
+ ****************************************************************************/
+
+static void sleep_enter(FAR struct sleep_state_s *state)
+{
+  uint32_t start;
+  uint32_t usec;
+
+  /* Idempotent, and does not reset a counter already in use */
+
+  modifyreg32(NVIC_DEMCR, 0, NVIC_DEMCR_TRCENA);
+  modifyreg32(DWT_CTRL, 0, DWT_CTRL_CYCCNTENA);
+
+  stm32_clocksave();
+  (void)state->enter();
+
+  start = getreg32(DWT_CYCCNT);
+  stm32_clockrestore();
+  usec  = (getreg32(DWT_CYCCNT) - start) / WAKEUP_CLOCK_MHZ;
+
+  if (usec > state->restore)
+    {
+      state->restore = usec;
+    }
+
+  state->count++;
+}
+#endif
+
 /****************************************************************************
  * Name: idlepm
  *
@@ -60,6 +206,7 @@
 #ifdef CONFIG_PM
 static void idlepm(void)
 {
+  FAR struct sleep_state_s *state;
   static enum pm_state_e oldstate = PM_NORMAL;
   enum pm_state_e newstate;
   irqstate_t flags;
@@ -98,18 +245,12 @@ static void idlepm(void)
 
         case PM_STANDBY:
         case PM_SLEEP:
-          {
-#ifdef CONFIG_DEBUG
-            /* Use STOP 1 mode when debugging so serial console can wake */
-            stm32_pmstop(true);
-#else
-            /* Use STOP 2 mode to achieve lower current drain */
-            stm32_pmstop2();
-#endif
-
-            /* Resume normal operation */
-            stm32_clockenable();
-          }
+          /* The deepest STOP mode the drivers' latency constraints allow */
+          state = sleep_select();
+          if (state)
+            {
+              sleep_enter(state);
+            }
           break;
 
         default:
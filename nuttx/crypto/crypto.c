@@ -41,10 +41,12 @@
 
 #include <sys/types.h>
 #include <stdbool.h>
+#include <sched.h>
 #include <string.h>
 #include <poll.h>
 #include <errno.h>
 
+#include <nuttx/arch.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/crypto/crypto.h>
 
@@ -56,15 +58,176 @@
  * Private Data
  ****************************************************************************/
 
+/* Registered backends: hardware ones first, then software ones, each in
+ * registration order.
+ */
+
+static FAR struct crypto_backend_s *g_backends;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+static bool crypto_supports(FAR const struct crypto_backend_s *backend,
+                            int alg)
+{
+  switch (alg)
+    {
+      case CRYPTO_ALG_AES:
+        return backend->aes != NULL;
+
+      case CRYPTO_ALG_SHA256:
+        return backend->sha256 != NULL;
+
+      default:
+        return false;
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
 
-void up_cryptoinitialize(void)
+/****************************************************************************
+ * Name: crypto_register
+ *
+ * Description:
+ *   Add a backend.  Hardware backends are preferred over software ones
+ *   regardless of the registration order.
+ *
+ ****************************************************************************/
+
+int crypto_register(FAR struct crypto_backend_s *backend)
+{
+  FAR struct crypto_backend_s **link;
+
+  if (backend == NULL || backend->name == NULL)
+    {
+      return -EINVAL;
+    }
+
+  sched_lock();
+  for (link = &g_backends; *link != NULL; link = &(*link)->flink)
+    {
+      if (*link == backend)
+        {
+          sched_unlock();
+          return -EEXIST;
+        }
+
+      if ((backend->flags & CRYPTO_FLAG_HARDWARE) != 0 &&
+          ((*link)->flags & CRYPTO_FLAG_HARDWARE) == 0)
+        {
+          break;
+        }
+    }
+
+  backend->flink = *link;
+  *link = backend;
+  sched_unlock();
+
+  cryptllvdbg("Registered %s backend %s\n",
+              (backend->flags & CRYPTO_FLAG_HARDWARE) ? "hardware" : "software",
+              backend->name);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: crypto_nextbackend
+ *
+ * Description:
+ *   Return the backend after 'backend', or the first one if 'backend' is
+ *   NULL.  Used to enumerate the backends in order of preference.
+ *
+ ****************************************************************************/
+
+FAR const struct crypto_backend_s *
+crypto_nextbackend(FAR const struct crypto_backend_s *backend)
+{
+  return backend == NULL ? g_backends : backend->flink;
+}
+
+/****************************************************************************
+ * Name: crypto_findbackend
+ *
+ * Description:
+ *   Return the preferred backend implementing CRYPTO_ALG_* 'alg', or NULL.
+ *
+ ****************************************************************************/
+
+FAR const struct crypto_backend_s *crypto_findbackend(int alg)
+{
+  FAR const struct crypto_backend_s *backend;
+
+  for (backend = g_backends; backend != NULL; backend = backend->flink)
+    {
+      if (crypto_supports(backend, alg))
+        {
+          break;
+        }
+    }
+
+  return backend;
+}
+
+#if defined(CONFIG_CRYPTO_AES)
+/****************************************************************************
+ * Name: aes_cypher
+ *
+ * Description:
+ *   Encrypt or decrypt 'size' bytes with the preferred AES backend.
+ *
+ ****************************************************************************/
+
+int aes_cypher(FAR void *out, FAR const void *in, uint32_t size,
+               FAR const void *iv, FAR const void *key, uint32_t keysize,
+               int mode, int encrypt)
+{
+  FAR const struct crypto_backend_s *backend;
+
+  backend = crypto_findbackend(CRYPTO_ALG_AES);
+  if (backend == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return backend->aes(out, in, size, iv, key, keysize, mode, encrypt);
+}
+#endif
+
+#if defined(CONFIG_CRYPTO_SHA256)
+/****************************************************************************
+ * Name: crypto_sha256
+ *
+ * Description:
+ *   Compute the SHA-256 digest of 'size' bytes with the preferred backend.
+ *
+ ****************************************************************************/
+
+int crypto_sha256(FAR const void *in, uint32_t size, FAR uint8_t *digest)
+{
+  FAR const struct crypto_backend_s *backend;
+
+  backend = crypto_findbackend(CRYPTO_ALG_SHA256);
+  if (backend == NULL)
+    {
+      return -ENOSYS;
+    }
+
+  return backend->sha256(in, size, digest);
+}
+#endif
+
+/****************************************************************************
+ * Name: up_cryptoinitialize
+ *
+ * Description:
+ *   Register the available backends, then optionally run the self tests
+ *   and the benchmark.
+ *
+ ****************************************************************************/
+
+int up_cryptoinitialize(void)
 {
   int res = OK;
 
@@ -74,6 +237,12 @@ void up_cryptoinitialize(void)
     return res;
 #endif
 
+#if defined(CONFIG_CRYPTO_SHA256)
+  res = sha256_initialize();
+  if (res)
+    return res;
+#endif
+
 #if defined(CONFIG_CRYPTO_ALGTEST)
   res = crypto_test();
   if (res)
@@ -82,5 +251,9 @@ void up_cryptoinitialize(void)
     cryptllvdbg("crypto test OK\n");
 #endif
 
+#if defined(CONFIG_CRYPTO_BENCHMARK)
+  crypto_benchmark();
+#endif
+
   return res;
 }
\ No newline at end of file
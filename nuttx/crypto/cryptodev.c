@@ -94,63 +94,111 @@ static ssize_t cryptodev_write(FAR struct file *filep, FAR const char *buffer,
   return -EACCES;
 }
 
-static int cryptodev_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
+/* Perform one request.  The source and destination buffers are handed to
+ * the backend as they are:  no bounce buffers.
+ */
+
+static int cryptodev_crypt(FAR struct crypt_op *op)
 {
-  switch(cmd)
-  {
-  case CIOCGSESSION:
-    {
-      struct session_op *ses = (struct session_op*)arg;
-      ses->ses = (uint32_t)ses;
-      return OK;
-    }
+  FAR struct session_op *ses = (struct session_op*)op->ses;
+  int encrypt;
 
-  case CIOCFSESSION:
+  if (ses == NULL)
     {
-      return OK;
+      return -EINVAL;
     }
 
-  case CIOCCRYPT:
-    {
-      FAR struct crypt_op *op = (struct crypt_op*)arg;
-      FAR struct session_op *ses = (struct session_op*)op->ses;
-      int encrypt;
+  switch (op->op)
+  {
+  case COP_ENCRYPT:
+    encrypt = 1;
+    break;
+
+  case COP_DECRYPT:
+    encrypt = 0;
+    break;
 
-      switch (op->op)
-      {
-      case COP_ENCRYPT:
-        encrypt = 1;
-        break;
+  default:
+    return -EINVAL;
+  }
 
-      case COP_DECRYPT:
-        encrypt = 0;
-        break;
+#if defined(CONFIG_CRYPTO_SHA256)
+  if (ses->cipher == 0 && ses->mac == CRYPTO_SHA2_256)
+    {
+      if (op->mac == NULL)
+        {
+          return -EINVAL;
+        }
 
-      default:
-        return -EINVAL;
-      }
+      return crypto_sha256(op->src, op->len, (FAR uint8_t *)op->mac);
+    }
+#endif
 
-      switch (ses->cipher)
-      {
+  switch (ses->cipher)
+  {
 
 #if defined(CONFIG_CRYPTO_AES)
 #  define AES_CYPHER(mode) aes_cypher(op->dst, op->src, op->len, op->iv, ses->key, ses->keylen, mode, encrypt)
 
-      case CRYPTO_AES_ECB:
-        return AES_CYPHER(AES_MODE_ECB);
+  case CRYPTO_AES_ECB:
+    return AES_CYPHER(AES_MODE_ECB);
 
-      case CRYPTO_AES_CBC:
-        return AES_CYPHER(AES_MODE_CBC);
+  case CRYPTO_AES_CBC:
+    return AES_CYPHER(AES_MODE_CBC);
 
-      case CRYPTO_AES_CTR:
-        return AES_CYPHER(AES_MODE_CTR);
+  case CRYPTO_AES_CTR:
+    return AES_CYPHER(AES_MODE_CTR);
 
 #  undef AES_CYPHER
 #endif
 
-      default:
-        return -EINVAL;
-      }
+  default:
+    UNUSED(encrypt);
+    return -EINVAL;
+  }
+}
+
+static int cryptodev_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
+{
+  switch(cmd)
+  {
+  case CIOCGSESSION:
+    {
+      struct session_op *ses = (struct session_op*)arg;
+      ses->ses = (uint32_t)ses;
+      return OK;
+    }
+
+  case CIOCFSESSION:
+    {
+      return OK;
+    }
+
+  case CIOCCRYPT:
+    {
+      return cryptodev_crypt((FAR struct crypt_op *)arg);
+    }
+
+  case CIOCNCRYPTM:
+    {
+      FAR struct crypt_n_op *nop = (FAR struct crypt_n_op *)arg;
+      int ret = OK;
+
+      if (nop == NULL || (nop->reqs == NULL && nop->count > 0))
+        {
+          return -EINVAL;
+        }
+
+      for (nop->done = 0; nop->done < nop->count; nop->done++)
+        {
+          ret = cryptodev_crypt(&nop->reqs[nop->done]);
+          if (ret < 0)
+            {
+              break;
+            }
+        }
+
+      return ret;
     }
 
   default:
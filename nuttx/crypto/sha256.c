@@ -0,0 +1,314 @@
+/****************************************************************************
+ * crypto/sha256.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <nuttx/crypto/crypto.h>
+#include <nuttx/crypto/cryptodev.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define SHA256_BLOCK_SIZE 64
+
+#define ROR32(x, n)  (((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z)  (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define EP0(x)       (ROR32(x, 2) ^ ROR32(x, 13) ^ ROR32(x, 22))
+#define EP1(x)       (ROR32(x, 6) ^ ROR32(x, 11) ^ ROR32(x, 25))
+#define SIG0(x)      (ROR32(x, 7) ^ ROR32(x, 18) ^ ((x) >> 3))
+#define SIG1(x)      (ROR32(x, 17) ^ ROR32(x, 19) ^ ((x) >> 10))
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+static int sha256_soft(FAR const void *in, uint32_t size,
+                       FAR uint8_t *digest);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const uint32_t g_sha256_k[64] =
+{
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+  0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+  0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+  0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+  0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+  0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+  0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+  0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+  0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t g_sha256_h0[8] =
+{
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static struct crypto_backend_s g_sha256_backend =
+{
+  .name   = "sha256-soft",
+  .flags  = CRYPTO_FLAG_SOFTWARE,
+  .sha256 = sha256_soft,
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sha256_block
+ *
+ * Description:
+ *   Process one 64-byte block into the hash state.
+ *
+ ****************************************************************************/
+
+static void sha256_block(FAR uint32_t *state, FAR const uint8_t *block)
+{
+  uint32_t w[64];
+  uint32_t a, b, c, d, e, f, g, h;
+  uint32_t t1;
+  uint32_t t2;
+  int i;
+
+  for (i = 0; i < 16; i++, block += 4)
+    {
+      w[i] = ((uint32_t)block[0] << 24) | ((uint32_t)block[1] << 16) |
+             ((uint32_t)block[2] << 8) | block[3];
+    }
+
+  for (; i < 64; i++)
+    {
+      w[i] = SIG1(w[i - 2]) + w[i - 7] + SIG0(w[i - 15]) + w[i - 16];
+    }
+
+  a = state[0];
+  b = state[1];
+  c = state[2];
+  d = state[3];
+  e = state[4];
+  f = state[5];
+  g = state[6];
+  h = state[7];
+
+  for (i = 0; i < 64; i++)
+    {
+      t1 = h + EP1(e) + CH(e, f, g) + g_sha256_k[i] + w[i];
+      t2 = EP0(a) + MAJ(a, b, c);
+      h  = g;
+      g  = f;
+      f  = e;
+      e  = d + t1;
+      d  = c;
+      c  = b;
+      b  = a;
+      a  = t1 + t2;
+    }
+
+  state[0] += a;
+  state[1] += b;
+  state[2] += c;
+  state[3] += d;
+  state[4] += e;
+  state[5] += f;
+  state[6] += g;
+  state[7] += h;
+}
+
+/****************************************************************************
+ * Name: sha256_soft
+ *
+ * Description:
+ *   Software SHA-256 of a whole buffer (the backend operation).
+ *
+ ****************************************************************************/
+
+static int sha256_soft(FAR const void *in, uint32_t size,
+                       FAR uint8_t *digest)
+{
+  struct sha256_ctx_s ctx;
+
+  if ((in == NULL && size > 0) || digest == NULL)
+    {
+      return -EINVAL;
+    }
+
+  sha256_init(&ctx);
+  sha256_update(&ctx, in, size);
+  sha256_final(&ctx, digest);
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sha256_init
+ *
+ * Description:
+ *   Start a new incremental digest.
+ *
+ ****************************************************************************/
+
+void sha256_init(FAR struct sha256_ctx_s *ctx)
+{
+  memcpy(ctx->state, g_sha256_h0, sizeof(ctx->state));
+  ctx->count = 0;
+}
+
+/****************************************************************************
+ * Name: sha256_update
+ *
+ * Description:
+ *   Add 'size' bytes to the digest.  Whole blocks are hashed straight from
+ *   'in'; only a partial block is kept in the context.
+ *
+ ****************************************************************************/
+
+void sha256_update(FAR struct sha256_ctx_s *ctx, FAR const void *in,
+                   size_t size)
+{
+  FAR const uint8_t *src = in;
+  size_t used = ctx->count % SHA256_BLOCK_SIZE;
+  size_t nbytes;
+
+  ctx->count += size;
+
+  /* Complete a partial block first */
+
+  if (used > 0)
+    {
+      nbytes = SHA256_BLOCK_SIZE - used;
+      if (nbytes > size)
+        {
+          nbytes = size;
+        }
+
+      memcpy(&ctx->buffer[used], src, nbytes);
+      src  += nbytes;
+      size -= nbytes;
+
+      if (used + nbytes < SHA256_BLOCK_SIZE)
+        {
+          return;
+        }
+
+      sha256_block(ctx->state, ctx->buffer);
+    }
+
+  for (; size >= SHA256_BLOCK_SIZE; size -= SHA256_BLOCK_SIZE)
+    {
+      sha256_block(ctx->state, src);
+      src += SHA256_BLOCK_SIZE;
+    }
+
+  memcpy(ctx->buffer, src, size);
+}
+
+/****************************************************************************
+ * Name: sha256_final
+ *
+ * Description:
+ *   Pad the message, and return the 32-byte digest.
+ *
+ ****************************************************************************/
+
+void sha256_final(FAR struct sha256_ctx_s *ctx, FAR uint8_t *digest)
+{
+  uint64_t bits = ctx->count << 3;
+  size_t used = ctx->count % SHA256_BLOCK_SIZE;
+  int i;
+
+  /* 0x80, zero padding and the 64-bit length: one or two blocks */
+
+  ctx->buffer[used++] = 0x80;
+  if (used > SHA256_BLOCK_SIZE - 8)
+    {
+      memset(&ctx->buffer[used], 0, SHA256_BLOCK_SIZE - used);
+      sha256_block(ctx->state, ctx->buffer);
+      used = 0;
+    }
+
+  memset(&ctx->buffer[used], 0, SHA256_BLOCK_SIZE - 8 - used);
+  for (i = 0; i < 8; i++)
+    {
+      ctx->buffer[SHA256_BLOCK_SIZE - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+
+  sha256_block(ctx->state, ctx->buffer);
+
+  for (i = 0; i < 8; i++)
+    {
+      digest[4 * i]     = (uint8_t)(ctx->state[i] >> 24);
+      digest[4 * i + 1] = (uint8_t)(ctx->state[i] >> 16);
+      digest[4 * i + 2] = (uint8_t)(ctx->state[i] >> 8);
+      digest[4 * i + 3] = (uint8_t)ctx->state[i];
+    }
+}
+
+/****************************************************************************
+ * Name: sha256_initialize
+ *
+ * Description:
+ *   Register the software SHA-256 backend.  A hardware backend registered
+ *   by the architecture takes precedence.
+ *
+ ****************************************************************************/
+
+int sha256_initialize(void)
+{
+  return crypto_register(&g_sha256_backend);
+}
@@ -41,11 +41,14 @@
 
 #include <sys/types.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
+#include <syslog.h>
 #include <poll.h>
 #include <errno.h>
 #include <debug.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/crypto/crypto.h>
@@ -106,10 +109,82 @@ static int test_aes(void)
 }
 #endif
 
+#if defined(CONFIG_CRYPTO_SHA256)
+struct hash_testvec
+{
+  FAR const char *input;
+  uint8_t digest[SHA256_DIGEST_SIZE];
+};
+
+static const struct hash_testvec sha256_tv_template[] =
+{
+  {
+    "",
+    { 0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14,
+      0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+      0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c,
+      0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55 }
+  },
+  {
+    "abc",
+    { 0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+      0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+      0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+      0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad }
+  },
+  {
+    "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+    { 0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8,
+      0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+      0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
+      0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1 }
+  },
+};
+
+#define SHA256_TEST_VECTORS \
+  (sizeof(sha256_tv_template) / sizeof(sha256_tv_template[0]))
+
+/* Check every backend, not only the preferred one, so that a broken
+ * hardware engine cannot hide behind the software fallback or vice versa.
+ */
+
+static int test_sha256(void)
+{
+  FAR const struct crypto_backend_s *backend = NULL;
+  uint8_t digest[SHA256_DIGEST_SIZE];
+  int i;
+
+  while ((backend = crypto_nextbackend(backend)) != NULL)
+    {
+      if (backend->sha256 == NULL)
+        {
+          continue;
+        }
+
+      for (i = 0; i < SHA256_TEST_VECTORS; i++)
+        {
+          FAR const struct hash_testvec *tv = &sha256_tv_template[i];
+
+          if (backend->sha256(tv->input, strlen(tv->input), digest) != OK ||
+              memcmp(digest, tv->digest, SHA256_DIGEST_SIZE) != 0)
+            {
+              cryptlldbg("Failed %s SHA-256 test #%i\n", backend->name, i);
+              return -1;
+            }
+        }
+    }
+
+  return OK;
+}
+#endif
+
 int crypto_test(void)
 {
 #if defined(CONFIG_CRYPTO_AES)
   if (test_aes()) return -1;
+#endif
+#if defined(CONFIG_CRYPTO_SHA256)
+  if (test_sha256()) return -1;
 #endif
   return OK;
 }
@@ -122,3 +197,123 @@ int crypto_test(void)
 }
 
 #endif
+
+#if defined(CONFIG_CRYPTO_BENCHMARK)
+
+/****************************************************************************
+ * Benchmark
+ ****************************************************************************/
+
+#ifndef CONFIG_CRYPTO_BENCHMARK_SIZE
+#  define CONFIG_CRYPTO_BENCHMARK_SIZE 4096
+#endif
+
+#ifndef CONFIG_CRYPTO_BENCHMARK_ITERATIONS
+#  define CONFIG_CRYPTO_BENCHMARK_ITERATIONS 64
+#endif
+
+#define BENCH_BYTES \
+  ((uint64_t)CONFIG_CRYPTO_BENCHMARK_SIZE * CONFIG_CRYPTO_BENCHMARK_ITERATIONS)
+
+/* Report the throughput as MB/s with two decimals */
+
+static void bench_report(FAR const struct crypto_backend_s *backend,
+                         FAR const char *alg, uint32_t start, int ret)
+{
+  uint64_t usecs = (uint64_t)(clock_systimer() - start) * USEC_PER_TICK;
+  uint64_t rate;
+
+  if (ret < 0)
+    {
+      syslog("%-12s %-8s failed: %d\n", backend->name, alg, ret);
+      return;
+    }
+
+  if (usecs == 0)
+    {
+      usecs = 1;
+    }
+
+  /* Bytes per usec == MB/s (10^6 bytes per second) */
+
+  rate = BENCH_BYTES * 100 / usecs;
+  syslog("%-12s %-8s %lu.%02lu MB/s\n", backend->name, alg,
+         (unsigned long)(rate / 100), (unsigned long)(rate % 100));
+}
+
+/****************************************************************************
+ * Name: crypto_benchmark
+ *
+ * Description:
+ *   Time each algorithm of each registered backend on a
+ *   CONFIG_CRYPTO_BENCHMARK_SIZE buffer and report MB/s on the syslog.
+ *
+ ****************************************************************************/
+
+void crypto_benchmark(void)
+{
+  FAR const struct crypto_backend_s *backend = NULL;
+  FAR uint8_t *buf;
+  uint32_t start;
+  int ret;
+  int i;
+#if defined(CONFIG_CRYPTO_AES)
+  static const char key[16] = "0123456789abcdef";
+  char iv[16];
+  int mode;
+#endif
+#if defined(CONFIG_CRYPTO_SHA256)
+  uint8_t digest[SHA256_DIGEST_SIZE];
+#endif
+
+  buf = kmm_zalloc(CONFIG_CRYPTO_BENCHMARK_SIZE);
+  if (buf == NULL)
+    {
+      cryptlldbg("No memory for the benchmark buffer\n");
+      return;
+    }
+
+  while ((backend = crypto_nextbackend(backend)) != NULL)
+    {
+#if defined(CONFIG_CRYPTO_AES)
+      if (backend->aes != NULL)
+        {
+          for (mode = AES_MODE_MIN; mode <= AES_MODE_MAX; mode++)
+            {
+              memset(iv, 0, sizeof(iv));
+              start = clock_systimer();
+              for (i = 0, ret = OK;
+                   i < CONFIG_CRYPTO_BENCHMARK_ITERATIONS && ret >= 0; i++)
+                {
+                  ret = backend->aes(buf, buf, CONFIG_CRYPTO_BENCHMARK_SIZE,
+                                     iv, key, sizeof(key), mode,
+                                     CYPHER_ENCRYPT);
+                }
+
+              bench_report(backend, mode == AES_MODE_ECB ? "aes-ecb" :
+                           mode == AES_MODE_CBC ? "aes-cbc" : "aes-ctr",
+                           start, ret);
+            }
+        }
+#endif
+
+#if defined(CONFIG_CRYPTO_SHA256)
+      if (backend->sha256 != NULL)
+        {
+          start = clock_systimer();
+          for (i = 0, ret = OK;
+               i < CONFIG_CRYPTO_BENCHMARK_ITERATIONS && ret >= 0; i++)
+            {
+              ret = backend->sha256(buf, CONFIG_CRYPTO_BENCHMARK_SIZE,
+                                    digest);
+            }
+
+          bench_report(backend, "sha256", start, ret);
+        }
+#endif
+    }
+
+  kmm_free(buf);
+}
+
+#endif /* CONFIG_CRYPTO_BENCHMARK */
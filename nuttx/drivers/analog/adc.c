@@ -53,6 +53,7 @@
 #include <semaphore.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <assert.h>
 #include <debug.h>
 
 #include <nuttx/fs/fs.h>
@@ -534,6 +535,55 @@ int adc_receive(FAR struct adc_dev_s *dev, uint8_t ch, int32_t data)
     return err;
 }
 
+/****************************************************************************
+ * Name: adc_receive_block
+ ****************************************************************************/
+
+int adc_receive_block(FAR struct adc_dev_s *dev, FAR const uint8_t *chanlist,
+                      int nchannels, FAR const uint16_t *data, int nsamples)
+{
+  FAR struct adc_fifo_s *fifo = &dev->ad_recv;
+  int                    nexttail;
+  int                    nqueued;
+  int                    ch;
+
+  DEBUGASSERT(chanlist != NULL && nchannels > 0);
+
+  for (nqueued = 0, ch = 0; nqueued < nsamples; nqueued++)
+    {
+      nexttail = fifo->af_tail + 1;
+      if (nexttail >= CONFIG_ADC_FIFOSIZE)
+        {
+          nexttail = 0;
+        }
+
+      /* Drop the rest of the block if the FIFO is full */
+
+      if (nexttail == fifo->af_head)
+        {
+          break;
+        }
+
+      fifo->af_buffer[fifo->af_tail].am_channel = chanlist[ch];
+      fifo->af_buffer[fifo->af_tail].am_data    = data[nqueued];
+      fifo->af_tail = nexttail;
+
+      if (++ch >= nchannels)
+        {
+          ch = 0;
+        }
+    }
+
+  /* Wake up the readers once for the whole block */
+
+  if (nqueued > 0)
+    {
+      adc_notify(dev);
+    }
+
+  return nqueued;
+}
+
 /****************************************************************************
  * Name: adc_register
  ****************************************************************************/
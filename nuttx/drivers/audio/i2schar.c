@@ -58,6 +58,10 @@
 #include <nuttx/audio/audio.h>
 #include <nuttx/audio/i2s.h>
 
+#ifdef CONFIG_AUDIO_I2SCHAR_BUFQUEUE
+#  include <nuttx/bufqueue.h>
+#endif
+
 /****************************************************************************
  * Private Definitions
  ****************************************************************************/
@@ -109,6 +113,9 @@ struct i2schar_dev_s
 {
   FAR struct i2s_dev_s *i2s;  /* The lower half i2s driver */
   sem_t exclsem;              /* Assures mutually exclusive access */
+#ifdef CONFIG_AUDIO_I2SCHAR_BUFQUEUE
+  struct bufqueue_s bufq;     /* Zero-copy buffer queue */
+#endif
 };
 
 /****************************************************************************
@@ -128,6 +135,17 @@ static ssize_t i2schar_read(FAR struct file *filep, FAR char *buffer,
                  size_t buflen);
 static ssize_t i2schar_write(FAR struct file *filep, FAR const char *buffer,
                  size_t buflen);
+#ifdef CONFIG_AUDIO_I2SCHAR_BUFQUEUE
+static int     i2schar_ioctl(FAR struct file *filep, int cmd,
+                 unsigned long arg);
+
+/* Buffer queue callbacks */
+
+static void    i2schar_bqcallback(FAR struct i2s_dev_s *dev,
+                 FAR struct ap_buffer_s *apb, FAR void *arg, int result);
+static int     i2schar_bqqueue(FAR struct bufqueue_s *bq,
+                 unsigned int index, size_t bytesused);
+#endif
 
 /****************************************************************************
  * Private Data
@@ -140,12 +158,24 @@ static const struct file_operations i2schar_fops =
   i2schar_read,         /* read  */
   i2schar_write,        /* write */
   NULL,                 /* seek  */
+#ifdef CONFIG_AUDIO_I2SCHAR_BUFQUEUE
+  i2schar_ioctl,        /* ioctl */
+#else
   NULL,                 /* ioctl */
+#endif
 #ifndef CONFIG_DISABLE_POLL
   NULL,                 /* poll  */
 #endif
 };
 
+#ifdef CONFIG_AUDIO_I2SCHAR_BUFQUEUE
+static const struct bq_ops_s i2schar_bqops =
+{
+  i2schar_bqqueue,      /* queue  */
+  NULL,                 /* stream */
+};
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -374,6 +404,85 @@ errout_with_reference:
   return ret;
 }
 
+#ifdef CONFIG_AUDIO_I2SCHAR_BUFQUEUE
+/****************************************************************************
+ * Name: i2schar_ioctl
+ *
+ * Description:
+ *   Standard character driver ioctl method
+ *
+ ****************************************************************************/
+
+static int i2schar_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
+{
+  FAR struct inode *inode = filep->f_inode;
+  FAR struct i2schar_dev_s *priv;
+
+  DEBUGASSERT(inode);
+  priv = (FAR struct i2schar_dev_s *)inode->i_private;
+  DEBUGASSERT(priv);
+
+  return bq_ioctl(&priv->bufq, filep, cmd, arg);
+}
+
+/****************************************************************************
+ * Name: i2schar_bqcallback
+ *
+ * Description:
+ *   I2S transfer complete callback for a queued buffer.  The audio buffer
+ *   lives in the buffer queue pool and is never freed here; it is simply
+ *   returned to the queue for BQIOC_DQBUF.
+ *
+ ****************************************************************************/
+
+static void i2schar_bqcallback(FAR struct i2s_dev_s *dev,
+                               FAR struct ap_buffer_s *apb,
+                               FAR void *arg, int result)
+{
+  FAR struct i2schar_dev_s *priv = (FAR struct i2schar_dev_s *)arg;
+
+  DEBUGASSERT(priv && apb);
+  i2svdbg("apb=%p nbytes=%d result=%d\n", apb, apb->nbytes, result);
+
+  bq_done(&priv->bufq, bq_index(&priv->bufq, apb), apb->nbytes, result);
+}
+
+/****************************************************************************
+ * Name: i2schar_bqqueue
+ *
+ * Description:
+ *   Give one buffer of the queue to the I2S driver.  The audio buffer
+ *   header is placed in the headroom just before the data so that the
+ *   samples are the application's buffer.
+ *
+ ****************************************************************************/
+
+static int i2schar_bqqueue(FAR struct bufqueue_s *bq, unsigned int index,
+                           size_t bytesused)
+{
+  FAR struct i2schar_dev_s *priv = (FAR struct i2schar_dev_s *)bq->priv;
+  FAR struct ap_buffer_s *apb;
+
+  apb = (FAR struct ap_buffer_s *)
+    ((FAR uint8_t *)bq_data(bq, index) - sizeof(struct ap_buffer_s));
+
+  memset(apb, 0, sizeof(struct ap_buffer_s));
+  apb->nmaxbytes = bq->size;
+  apb->crefs     = 1;
+  sem_init(&apb->sem, 0, 1);
+
+  if (bq->type == BQ_CAPTURE)
+    {
+      return I2S_RECEIVE(priv->i2s, apb, i2schar_bqcallback, priv,
+                         CONFIG_AUDIO_I2SCHAR_RXTIMEOUT);
+    }
+
+  apb->nbytes = bytesused;
+  return I2S_SEND(priv->i2s, apb, i2schar_bqcallback, priv,
+                  CONFIG_AUDIO_I2SCHAR_TXTIMEOUT);
+}
+#endif /* CONFIG_AUDIO_I2SCHAR_BUFQUEUE */
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -421,6 +530,13 @@ int i2schar_register(FAR struct i2s_dev_s *i2s, int minor)
       priv->i2s = i2s;
       sem_init(&priv->exclsem, 0, 1);
 
+#ifdef CONFIG_AUDIO_I2SCHAR_BUFQUEUE
+      priv->bufq.ops      = &i2schar_bqops;
+      priv->bufq.priv     = priv;
+      priv->bufq.headroom = sizeof(struct ap_buffer_s);
+      bq_initialize(&priv->bufq);
+#endif
+
       /* Create the character device name */
 
       snprintf(devname, DEVNAME_FMTLEN, DEVNAME_FMT, minor);
@@ -52,6 +52,14 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#ifndef CONFIG_BCH_CACHE_NLINES
+#  define CONFIG_BCH_CACHE_NLINES 1
+#endif
+
+#ifndef CONFIG_BCH_CACHE_LINESECTORS
+#  define CONFIG_BCH_CACHE_LINESECTORS 1
+#endif
+
 #define bchlib_semgive(d) sem_post(&(d)->sem)  /* To match bchlib_semtake */
 #define MAX_OPENCNT     (255)                  /* Limit of uint8_t */
 
@@ -59,6 +67,19 @@
  * Public Types
  ****************************************************************************/
 
+/* One line of the sector cache:  Up to CONFIG_BCH_CACHE_LINESECTORS
+ * consecutive sectors, starting at a multiple of that number.
+ */
+
+struct bchlib_cline_s
+{
+  size_t   sector;     /* First sector of the line; (size_t)-1 if empty */
+  uint32_t dirty;      /* Bit n set: Sector 'sector + n' was modified */
+  uint32_t stamp;      /* Time of last use, for LRU replacement */
+  uint8_t  nsectors;   /* Number of valid sectors in the line */
+  FAR uint8_t *buffer; /* The sector data */
+};
+
 struct bchlib_s
 {
   struct inode *inode; /* I-node of the block driver */
@@ -67,9 +88,16 @@ struct bchlib_s
   size_t   sector;     /* The current sector in the buffer */
   uint16_t sectsize;   /* The size of one sector on the device */
   uint8_t  refs;       /* Number of references */
-  bool  dirty;         /* Data has been written to the buffer */
   bool  readonly;      /* true:  Only read operations are supported */
-  FAR uint8_t *buffer; /* One sector buffer */
+  FAR uint8_t *buffer; /* The current sector, within its cache line */
+  FAR struct bchlib_cline_s *cline;  /* The line holding the current sector */
+
+  /* The sector cache */
+
+  FAR uint8_t *cachemem;             /* Data of all the cache lines */
+  uint32_t stamp;                    /* Incremented on each cache access */
+  struct bch_stats_s stats;          /* Cache statistics */
+  struct bchlib_cline_s cache[CONFIG_BCH_CACHE_NLINES];
 
 #if defined(CONFIG_BCH_ENCRYPTION)
   uint8_t   key[CONFIG_BCH_ENCRYPTION_KEY_SIZE];   /* Encryption key */
@@ -97,6 +125,12 @@ EXTERN const struct file_operations bch_fops;
 EXTERN void bchlib_semtake(FAR struct bchlib_s *bch);
 EXTERN int  bchlib_flushsector(FAR struct bchlib_s *bch);
 EXTERN int  bchlib_readsector(FAR struct bchlib_s *bch, size_t sector);
+EXTERN void bchlib_dirtysector(FAR struct bchlib_s *bch);
+EXTERN void bchlib_cacheread(FAR struct bchlib_s *bch, FAR uint8_t *buffer,
+                             size_t sector, size_t nsectors);
+EXTERN void bchlib_cachewrite(FAR struct bchlib_s *bch,
+                              FAR const uint8_t *buffer, size_t sector,
+                              size_t nsectors);
 
 #undef EXTERN
 #if defined(__cplusplus)
@@ -252,6 +252,23 @@ static int bch_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
       bchlib_semgive(bch);
     }
+  else if (cmd == DIOC_GETSTATS)
+    {
+      FAR struct bch_stats_s *stats =
+        (FAR struct bch_stats_s *)((uintptr_t)arg);
+
+      if (!stats)
+        {
+          ret = -EINVAL;
+        }
+      else
+        {
+          bchlib_semtake(bch);
+          *stats = bch->stats;
+          bchlib_semgive(bch);
+          ret = OK;
+        }
+    }
 #if defined(CONFIG_BCH_ENCRYPTION)
   else if (cmd == DIOC_SETKEY)
     {
@@ -41,6 +41,7 @@
 
 #include <sys/types.h>
 #include <stdbool.h>
+#include <string.h>
 #include <errno.h>
 #include <assert.h>
 #include <debug.h>
@@ -88,16 +89,17 @@ static void bch_xor(uint32_t *R, uint32_t *A, uint32_t *B)
  ****************************************************************************/
 
 #if defined(CONFIG_BCH_ENCRYPTION)
-static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
+static int bch_cypher(FAR struct bchlib_s *bch, FAR uint8_t *data,
+                      size_t sector, int encrypt)
 {
   int blocks = bch->sectsize / 16;
-  uint32_t *buffer = (uint32_t*)bch->buffer;
+  uint32_t *buffer = (uint32_t*)data;
   int i;
 
   for (i = 0; i < blocks; i++, buffer += 16 / sizeof(uint32_t) )
     {
       uint32_t T[4];
-      uint32_t X[4] = {bch->sector, 0, 0, i};
+      uint32_t X[4] = {sector, 0, 0, i};
 
       aes_cypher(X, X, 16, NULL, bch->key, CONFIG_BCH_ENCRYPTION_KEY_SIZE,
                  AES_MODE_ECB, CYPHER_ENCRYPT);
@@ -115,45 +117,77 @@ static int bch_cypher(FAR struct bchlib_s *bch, int encrypt)
 #endif
 
 /****************************************************************************
- * Public Functions
+ * Name: bch_runmask
+ *
+ * Description:
+ *   Return a mask of the 'n' lowest bits, 'n' being 1 to 32.
+ *
  ****************************************************************************/
 
+static inline uint32_t bch_runmask(int n)
+{
+  return n < 32 ? ((uint32_t)1 << n) - 1 : UINT32_MAX;
+}
+
 /****************************************************************************
- * Name: bchlib_flushsector
+ * Name: bch_flushline
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
- *
- * Assumptions:
- *   Caller must assume mutual exclusion
+ *   Write the dirty sectors of one cache line to the media.  Each run of
+ *   consecutive dirty sectors is written with one request.
  *
  ****************************************************************************/
 
-int bchlib_flushsector(FAR struct bchlib_s *bch)
+static int bch_flushline(FAR struct bchlib_s *bch,
+                         FAR struct bchlib_cline_s *line)
 {
-  FAR struct inode *inode;
+  FAR struct inode *inode = bch->inode;
+  FAR uint8_t *data;
   ssize_t ret = OK;
+  ssize_t err;
+  int first;
+  int last;
+#if defined(CONFIG_BCH_ENCRYPTION)
+  int i;
+#endif
 
-  /* Check if the sector has been modified and is out of synch with the
-   * media.
-   */
-
-  if (bch->dirty)
+  first = 0;
+  while (line->dirty != 0)
     {
-      inode = bch->inode;
+      /* Find the next run of dirty sectors */
+
+      while ((line->dirty & ((uint32_t)1 << first)) == 0)
+        {
+          first++;
+        }
+
+      last = first;
+      while (last + 1 < line->nsectors &&
+             (line->dirty & ((uint32_t)1 << (last + 1))) != 0)
+        {
+          last++;
+        }
+
+      data = line->buffer + first * bch->sectsize;
 
 #if defined(CONFIG_BCH_ENCRYPTION)
       /* Encrypt data as necessary */
 
-      bch_cypher(bch, CYPHER_ENCRYPT);
+      for (i = first; i <= last; i++)
+        {
+          bch_cypher(bch, line->buffer + i * bch->sectsize,
+                     line->sector + i, CYPHER_ENCRYPT);
+        }
 #endif
 
-      /* Write the sector to the media */
+      /* Write the sectors to the media */
 
-      ret = inode->u.i_bops->write(inode, bch->buffer, bch->sector, 1);
-      if (ret < 0)
+      err = inode->u.i_bops->write(inode, data, line->sector + first,
+                                   last - first + 1);
+      if (err < 0)
         {
-          fdbg("Write failed: %d\n");
+          fdbg("Write failed: %d\n", err);
+          ret = err;
         }
 
 #if defined(CONFIG_BCH_ENCRYPTION)
@@ -161,22 +195,63 @@ int bchlib_flushsector(FAR struct bchlib_s *bch)
        * TODO: Add configuration switch for extra sector buffer
        */
 
-      bch_cypher(bch, CYPHER_DECRYPT);
+      for (i = first; i <= last; i++)
+        {
+          bch_cypher(bch, line->buffer + i * bch->sectsize,
+                     line->sector + i, CYPHER_DECRYPT);
+        }
 #endif
 
-      /* The sector is now in sync with the media */
+      /* The sectors are now in sync with the media */
 
-      bch->dirty = false;
+      bch->stats.writebacks += last - first + 1;
+      line->dirty &= ~(bch_runmask(last - first + 1) << first);
+      first = last + 1;
     }
 
   return (int)ret;
 }
 
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bchlib_flushsector
+ *
+ * Description:
+ *   Flush all dirty sectors in the sector cache
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+int bchlib_flushsector(FAR struct bchlib_s *bch)
+{
+  int ret = OK;
+  int err;
+  int i;
+
+  for (i = 0; i < CONFIG_BCH_CACHE_NLINES; i++)
+    {
+      err = bch_flushline(bch, &bch->cache[i]);
+      if (err < 0)
+        {
+          ret = err;
+        }
+    }
+
+  return ret;
+}
+
 /****************************************************************************
  * Name: bchlib_readsector
  *
  * Description:
- *   Flush the current contents of the sector buffer (if dirty)
+ *   Make 'sector' the current sector:  Find it in the sector cache or read
+ *   its cache line from the media, replacing the least recently used line.
+ *   On return, bch->buffer refers to the sector data.
  *
  * Assumptions:
  *   Caller must assume mutual exclusion
@@ -186,25 +261,183 @@ int bchlib_flushsector(FAR struct bchlib_s *bch)
 int bchlib_readsector(FAR struct bchlib_s *bch, size_t sector)
 {
   FAR struct inode *inode;
+  FAR struct bchlib_cline_s *line;
+  FAR struct bchlib_cline_s *victim;
+  size_t base;
   ssize_t ret = OK;
+  int i;
+
+  bch->stamp++;
 
-  if (bch->sector != sector)
+  if (bch->sector == sector)
     {
-      inode = bch->inode;
+      bch->cline->stamp = bch->stamp;
+      bch->stats.hits++;
+      return OK;
+    }
 
-      (void)bchlib_flushsector(bch);
-      bch->sector = (size_t)-1;
+  /* Is the line holding the sector already in the cache? */
 
-      ret = inode->u.i_bops->read(inode, bch->buffer, sector, 1);
-      if (ret < 0)
+  base   = sector - sector % CONFIG_BCH_CACHE_LINESECTORS;
+  victim = &bch->cache[0];
+
+  for (i = 0; i < CONFIG_BCH_CACHE_NLINES; i++)
+    {
+      line = &bch->cache[i];
+      if (line->sector == base)
+        {
+          bch->stats.hits++;
+          goto found;
+        }
+
+      /* Otherwise remember the least recently used (or an empty) line */
+
+      if (victim->sector != (size_t)-1 &&
+          (line->sector == (size_t)-1 ||
+           (int32_t)(line->stamp - victim->stamp) < 0))
         {
-          fdbg("Read failed: %d\n");
+          victim = line;
         }
-      bch->sector = sector;
+    }
+
+  /* No.. Replace the victim line with the line holding the sector */
+
+  bch->stats.misses++;
+  inode = bch->inode;
+  line  = victim;
+
+  (void)bch_flushline(bch, line);
+  line->sector   = (size_t)-1;
+  line->nsectors = CONFIG_BCH_CACHE_LINESECTORS;
+  if (base + line->nsectors > bch->nsectors)
+    {
+      line->nsectors = bch->nsectors - base;
+    }
+
+  ret = inode->u.i_bops->read(inode, line->buffer, base, line->nsectors);
+  if (ret < 0)
+    {
+      fdbg("Read failed: %d\n", ret);
+      bch->sector = (size_t)-1;
+      bch->buffer = line->buffer;
+      bch->cline  = line;
+      return (int)ret;
+    }
+
+  line->sector = base;
 #if defined(CONFIG_BCH_ENCRYPTION)
-      bch_cypher(bch, CYPHER_DECRYPT);
+  for (i = 0; i < line->nsectors; i++)
+    {
+      bch_cypher(bch, line->buffer + i * bch->sectsize, base + i,
+                 CYPHER_DECRYPT);
+    }
 #endif
+
+found:
+  line->stamp = bch->stamp;
+  bch->sector = sector;
+  bch->buffer = line->buffer + (sector - base) * bch->sectsize;
+  bch->cline  = line;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bchlib_dirtysector
+ *
+ * Description:
+ *   Mark the current sector as modified.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+void bchlib_dirtysector(FAR struct bchlib_s *bch)
+{
+  if (bch->sector != (size_t)-1)
+    {
+      bch->cline->dirty |= (uint32_t)1 << (bch->sector - bch->cline->sector);
     }
-  return (int)ret;
 }
 
+/****************************************************************************
+ * Name: bchlib_cacheread
+ *
+ * Description:
+ *   'nsectors' sectors starting at 'sector' were read from the media into
+ *   'buffer' without going through the cache.  Replace those that are
+ *   modified in the cache with the cached data.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+void bchlib_cacheread(FAR struct bchlib_s *bch, FAR uint8_t *buffer,
+                      size_t sector, size_t nsectors)
+{
+  FAR struct bchlib_cline_s *line;
+  size_t cached;
+  int i;
+  int j;
+
+  for (i = 0; i < CONFIG_BCH_CACHE_NLINES; i++)
+    {
+      line = &bch->cache[i];
+      for (j = 0; line->dirty != 0 && j < line->nsectors; j++)
+        {
+          cached = line->sector + j;
+          if ((line->dirty & ((uint32_t)1 << j)) != 0 &&
+              cached >= sector && cached < sector + nsectors)
+            {
+              memcpy(buffer + (cached - sector) * bch->sectsize,
+                     line->buffer + j * bch->sectsize, bch->sectsize);
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: bchlib_cachewrite
+ *
+ * Description:
+ *   'nsectors' sectors starting at 'sector' were written from 'buffer' to
+ *   the media without going through the cache.  Update the cached copies
+ *   of those sectors, which are now in sync with the media.
+ *
+ * Assumptions:
+ *   Caller must assume mutual exclusion
+ *
+ ****************************************************************************/
+
+void bchlib_cachewrite(FAR struct bchlib_s *bch, FAR const uint8_t *buffer,
+                       size_t sector, size_t nsectors)
+{
+  FAR struct bchlib_cline_s *line;
+  size_t cached;
+  int i;
+  int j;
+
+  for (i = 0; i < CONFIG_BCH_CACHE_NLINES; i++)
+    {
+      line = &bch->cache[i];
+      if (line->sector == (size_t)-1 ||
+          line->sector >= sector + nsectors ||
+          line->sector + line->nsectors <= sector)
+        {
+          continue;
+        }
+
+      for (j = 0; j < line->nsectors; j++)
+        {
+          cached = line->sector + j;
+          if (cached >= sector && cached < sector + nsectors)
+            {
+              memcpy(line->buffer + j * bch->sectsize,
+                     buffer + (cached - sector) * bch->sectsize,
+                     bch->sectsize);
+              line->dirty &= ~((uint32_t)1 << j);
+            }
+        }
+    }
+}
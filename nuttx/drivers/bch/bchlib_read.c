@@ -165,6 +165,10 @@ ssize_t bchlib_read(FAR void *handle, FAR char *buffer, size_t offset, size_t le
           return ret;
         }
 
+      /* The cache may hold newer data for some of those sectors */
+
+      bchlib_cacheread(bch, (FAR uint8_t *)buffer, sector, nsectors);
+
       /* Adjust pointers and counts */
 
       sectoffset = 0;
@@ -88,6 +88,7 @@ int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
   FAR struct bchlib_s *bch;
   struct geometry geo;
   int ret;
+  int i;
 
   DEBUGASSERT(blkdev);
 
@@ -140,16 +141,28 @@ int bchlib_setup(const char *blkdev, bool readonly, FAR void **handle)
   bch->sector   = (size_t)-1;
   bch->readonly = readonly;
 
-  /* Allocate the sector I/O buffer */
+  /* Allocate the sector cache */
 
-  bch->buffer = (FAR uint8_t *)kmm_malloc(bch->sectsize);
-  if (!bch->buffer)
+  bch->cachemem = (FAR uint8_t *)
+    kmm_malloc(CONFIG_BCH_CACHE_NLINES * CONFIG_BCH_CACHE_LINESECTORS *
+               bch->sectsize);
+  if (!bch->cachemem)
     {
       fdbg("Failed to allocate sector buffer\n");
       ret = -ENOMEM;
       goto errout_with_bch;
     }
 
+  for (i = 0; i < CONFIG_BCH_CACHE_NLINES; i++)
+    {
+      bch->cache[i].sector = (size_t)-1;
+      bch->cache[i].buffer = bch->cachemem +
+        i * CONFIG_BCH_CACHE_LINESECTORS * bch->sectsize;
+    }
+
+  bch->cline  = &bch->cache[0];
+  bch->buffer = bch->cache[0].buffer;
+
   *handle = bch;
   return OK;
 
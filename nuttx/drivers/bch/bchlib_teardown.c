@@ -101,9 +101,9 @@ int bchlib_teardown(FAR void *handle)
 
   /* Free the BCH state structure */
 
-  if (bch->buffer)
+  if (bch->cachemem)
     {
-      kmm_free(bch->buffer);
+      kmm_free(bch->cachemem);
     }
 
   sem_destroy(&bch->sem);
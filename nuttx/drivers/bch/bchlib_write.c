@@ -128,7 +128,7 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
         }
 
       memcpy(&bch->buffer[sectoffset], buffer, nbytes);
-      bch->dirty = true;
+      bchlib_dirtysector(bch);
 
       /* Adjust pointers and counts */
 
@@ -167,6 +167,10 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
           return ret;
         }
 
+      /* Keep any cached copies of those sectors up to date */
+
+      bchlib_cachewrite(bch, (FAR const uint8_t *)buffer, sector, nsectors);
+
       /* Adjust pointers and counts */
 
       sectoffset    = 0;
@@ -195,13 +199,14 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
       /* Copy the head end of the sector from the user buffer */
 
       memcpy(bch->buffer, buffer, len);
-      bch->dirty = true;
+      bchlib_dirtysector(bch);
 
       /* Adjust counts */
 
       byteswritten += len;
     }
 
+#ifndef CONFIG_BCH_CACHE_WRITEBACK
   /* Finally, flush any cached writes to the device as well */
 
   ret = bchlib_flushsector(bch);
@@ -210,6 +215,7 @@ ssize_t bchlib_write(FAR void *handle, FAR const char *buffer, size_t offset, si
       fdbg("Flush failed: %d\n", ret);
       return ret;
     }
+#endif
 
   return byteswritten;
 }
@@ -0,0 +1,511 @@
+/****************************************************************************
+ * drivers/bufqueue.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/bufqueue.h>
+
+#ifdef CONFIG_DRVR_BUFQUEUE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Buffers in the pool are aligned to this many bytes */
+
+#define BQ_ALIGN         8
+#define BQ_ALIGN_UP(n)   (((n) + BQ_ALIGN - 1) & ~(BQ_ALIGN - 1))
+
+/* Who owns a buffer */
+
+#define BQ_STATE_USER    0  /* The application */
+#define BQ_STATE_PENDING 1  /* Queued, waiting for BQIOC_STREAMON */
+#define BQ_STATE_DRIVER  2  /* Given to the driver */
+#define BQ_STATE_DONE    3  /* Completed, waiting for BQIOC_DQBUF */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bq_takesem
+ ****************************************************************************/
+
+static void bq_takesem(FAR sem_t *sem)
+{
+  /* Take the semaphore (perhaps waiting) */
+
+  while (sem_wait(sem) != 0)
+    {
+      /* The only case that an error should occur here is if the wait was
+       * awakened by a signal.
+       */
+
+      DEBUGASSERT(errno == EINTR);
+    }
+}
+
+#define bq_givesem(s) sem_post(s)
+
+/****************************************************************************
+ * Name: bq_submit
+ *
+ * Description:
+ *   Give one buffer to the driver.  A buffer that the driver refuses is
+ *   completed with the error.
+ *
+ ****************************************************************************/
+
+static void bq_submit(FAR struct bufqueue_s *bq, unsigned int index)
+{
+  int ret;
+
+  bq->state[index] = BQ_STATE_DRIVER;
+
+  ret = bq->ops->queue(bq, index, bq->bytesused[index]);
+  if (ret < 0)
+    {
+      bq_done(bq, index, 0, ret);
+    }
+}
+
+/****************************************************************************
+ * Name: bq_reqbufs
+ ****************************************************************************/
+
+static int bq_reqbufs(FAR struct bufqueue_s *bq,
+                      FAR struct bq_request_s *req)
+{
+  unsigned int count;
+  int i;
+
+  if (bq->streaming)
+    {
+      return -EBUSY;
+    }
+
+  for (i = 0; i < bq->count; i++)
+    {
+      if (bq->state[i] != BQ_STATE_USER)
+        {
+          return -EBUSY;
+        }
+    }
+
+  /* Release the old pool */
+
+  if (bq->pool)
+    {
+      kumm_free(bq->pool);
+      bq->pool  = NULL;
+      bq->count = 0;
+    }
+
+  count = req->count;
+  if (count == 0)
+    {
+      return OK;
+    }
+
+  if (req->size == 0 ||
+      (req->type != BQ_CAPTURE && req->type != BQ_OUTPUT))
+    {
+      return -EINVAL;
+    }
+
+  if (count > CONFIG_DRVR_BUFQUEUE_MAXBUFS)
+    {
+      count = CONFIG_DRVR_BUFQUEUE_MAXBUFS;
+    }
+
+  /* The pool is allocated from the user heap so that the application can
+   * access the buffers directly.
+   */
+
+  bq->stride = BQ_ALIGN_UP(bq->headroom) + BQ_ALIGN_UP(req->size);
+  bq->pool   = (FAR uint8_t *)kumm_malloc(count * bq->stride);
+  if (!bq->pool)
+    {
+      return -ENOMEM;
+    }
+
+  bq->size     = req->size;
+  bq->type     = req->type;
+  bq->count    = count;
+  bq->npending = 0;
+  bq->donehead = 0;
+  bq->ndone    = 0;
+
+  memset(bq->state, BQ_STATE_USER, sizeof(bq->state));
+  memset(bq->bytesused, 0, sizeof(bq->bytesused));
+  memset(bq->status, 0, sizeof(bq->status));
+
+  req->count = count;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bq_qbuf
+ ****************************************************************************/
+
+static int bq_qbuf(FAR struct bufqueue_s *bq, FAR struct bq_buffer_s *buf)
+{
+  unsigned int index = buf->index;
+
+  if (index >= bq->count || bq->state[index] != BQ_STATE_USER)
+    {
+      return -EINVAL;
+    }
+
+  if (bq->type == BQ_OUTPUT)
+    {
+      if (buf->bytesused > bq->size)
+        {
+          return -EINVAL;
+        }
+
+      bq->bytesused[index] = buf->bytesused;
+    }
+  else
+    {
+      bq->bytesused[index] = 0;
+    }
+
+  if (bq->streaming)
+    {
+      bq_submit(bq, index);
+    }
+  else
+    {
+      bq->state[index] = BQ_STATE_PENDING;
+      bq->pending[bq->npending++] = index;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bq_dqbuf
+ *
+ * Description:
+ *   Take the oldest completed buffer.  This is called without exclusive
+ *   access to the queue so that bq_qbuf() can go on while we wait.
+ *
+ ****************************************************************************/
+
+static int bq_dqbuf(FAR struct bufqueue_s *bq, FAR struct file *filep,
+                    FAR struct bq_buffer_s *buf)
+{
+  irqstate_t flags;
+  unsigned int index;
+
+  if ((filep->f_oflags & O_NONBLOCK) != 0)
+    {
+      if (sem_trywait(&bq->donesem) < 0)
+        {
+          return -EAGAIN;
+        }
+    }
+  else if (sem_wait(&bq->donesem) < 0)
+    {
+      return -errno;
+    }
+
+  flags = irqsave();
+  DEBUGASSERT(bq->ndone > 0);
+
+  index        = bq->done[bq->donehead];
+  bq->donehead = (bq->donehead + 1) % CONFIG_DRVR_BUFQUEUE_MAXBUFS;
+  bq->ndone--;
+  bq->state[index] = BQ_STATE_USER;
+  irqrestore(flags);
+
+  buf->index     = index;
+  buf->bytesused = bq->bytesused[index];
+  buf->status    = bq->status[index];
+  buf->addr      = bq_data(bq, index);
+  buf->length    = bq->size;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: bq_stream
+ ****************************************************************************/
+
+static int bq_stream(FAR struct bufqueue_s *bq, bool on)
+{
+  int ret = OK;
+  int i;
+
+  if (on == bq->streaming)
+    {
+      return OK;
+    }
+
+  if (on && !bq->pool)
+    {
+      return -EINVAL;
+    }
+
+  if (bq->ops->stream)
+    {
+      ret = bq->ops->stream(bq, on);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  bq->streaming = on;
+
+  /* Start with the buffers queued so far, in order, or return them */
+
+  for (i = 0; i < bq->npending; i++)
+    {
+      if (on)
+        {
+          bq_submit(bq, bq->pending[i]);
+        }
+      else
+        {
+          bq_done(bq, bq->pending[i], 0, -ESHUTDOWN);
+        }
+    }
+
+  bq->npending = 0;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: bq_initialize
+ *
+ * Description:
+ *   Initialize a buffer queue.  The caller must have set ops, priv and
+ *   headroom.  No buffers exist until the application asks for them with
+ *   BQIOC_REQBUFS.
+ *
+ ****************************************************************************/
+
+void bq_initialize(FAR struct bufqueue_s *bq)
+{
+  DEBUGASSERT(bq && bq->ops && bq->ops->queue);
+
+  sem_init(&bq->exclsem, 0, 1);
+  sem_init(&bq->donesem, 0, 0);
+
+  bq->pool      = NULL;
+  bq->count     = 0;
+  bq->streaming = false;
+  bq->npending  = 0;
+  bq->ndone     = 0;
+}
+
+/****************************************************************************
+ * Name: bq_uninitialize
+ *
+ * Description:
+ *   Release the pool.  The driver must have stopped all transfers.
+ *
+ ****************************************************************************/
+
+void bq_uninitialize(FAR struct bufqueue_s *bq)
+{
+  if (bq->pool)
+    {
+      kumm_free(bq->pool);
+      bq->pool = NULL;
+    }
+
+  sem_destroy(&bq->exclsem);
+  sem_destroy(&bq->donesem);
+}
+
+/****************************************************************************
+ * Name: bq_ioctl
+ *
+ * Description:
+ *   Process the BQIOC_* commands for a driver.
+ *
+ * Returned Value:
+ *   OK or a negated errno value.  -ENOTTY if 'cmd' is not a buffer queue
+ *   command.
+ *
+ ****************************************************************************/
+
+int bq_ioctl(FAR struct bufqueue_s *bq, FAR struct file *filep, int cmd,
+             unsigned long arg)
+{
+  FAR struct bq_buffer_s *buf = (FAR struct bq_buffer_s *)((uintptr_t)arg);
+  int ret;
+
+  if (!_BQIOCVALID(cmd))
+    {
+      return -ENOTTY;
+    }
+
+  /* Waiting for a completed buffer must not keep the queue locked */
+
+  if (cmd == BQIOC_DQBUF)
+    {
+      DEBUGASSERT(buf);
+      return bq_dqbuf(bq, filep, buf);
+    }
+
+  bq_takesem(&bq->exclsem);
+
+  switch (cmd)
+    {
+      case BQIOC_REQBUFS:
+        DEBUGASSERT(arg);
+        ret = bq_reqbufs(bq, (FAR struct bq_request_s *)((uintptr_t)arg));
+        break;
+
+      case BQIOC_QUERYBUF:
+        DEBUGASSERT(buf);
+        if (buf->index >= bq->count)
+          {
+            ret = -EINVAL;
+            break;
+          }
+
+        buf->addr      = bq_data(bq, buf->index);
+        buf->length    = bq->size;
+        buf->bytesused = bq->bytesused[buf->index];
+        buf->status    = bq->status[buf->index];
+        ret            = OK;
+        break;
+
+      case BQIOC_QBUF:
+        DEBUGASSERT(buf);
+        ret = bq_qbuf(bq, buf);
+        break;
+
+      case BQIOC_STREAMON:
+        ret = bq_stream(bq, true);
+        break;
+
+      case BQIOC_STREAMOFF:
+        ret = bq_stream(bq, false);
+        break;
+
+      default:
+        ret = -ENOTTY;
+        break;
+    }
+
+  bq_givesem(&bq->exclsem);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: bq_done
+ *
+ * Description:
+ *   Complete a buffer that was given to the driver.  May be called from
+ *   interrupt level.
+ *
+ ****************************************************************************/
+
+void bq_done(FAR struct bufqueue_s *bq, unsigned int index,
+             size_t bytesused, int status)
+{
+  irqstate_t flags;
+
+  DEBUGASSERT(index < bq->count);
+
+  flags = irqsave();
+
+  if (bq->type == BQ_CAPTURE)
+    {
+      bq->bytesused[index] = bytesused;
+    }
+
+  bq->status[index] = status;
+  bq->state[index]  = BQ_STATE_DONE;
+  bq->done[(bq->donehead + bq->ndone) % CONFIG_DRVR_BUFQUEUE_MAXBUFS] = index;
+  bq->ndone++;
+
+  irqrestore(flags);
+  bq_givesem(&bq->donesem);
+}
+
+/****************************************************************************
+ * Name: bq_header, bq_data and bq_index
+ *
+ * Description:
+ *   Map between buffer indices and pool memory.
+ *
+ ****************************************************************************/
+
+FAR void *bq_header(FAR struct bufqueue_s *bq, unsigned int index)
+{
+  DEBUGASSERT(index < bq->count);
+  return bq->pool + index * bq->stride;
+}
+
+FAR void *bq_data(FAR struct bufqueue_s *bq, unsigned int index)
+{
+  return (FAR uint8_t *)bq_header(bq, index) + BQ_ALIGN_UP(bq->headroom);
+}
+
+int bq_index(FAR struct bufqueue_s *bq, FAR const void *addr)
+{
+  uintptr_t offset = (uintptr_t)addr - (uintptr_t)bq->pool;
+
+  DEBUGASSERT(offset / bq->stride < bq->count);
+  return offset / bq->stride;
+}
+
+#endif /* CONFIG_DRVR_BUFQUEUE */
@@ -65,22 +65,17 @@ struct dev_private_s s_data;
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 
-struct cam_i2c_reg_array {
-    const uint16_t reg_addr;
-    const uint8_t data;
-};
-
 struct cam_i2c_reg_setting {
     const uint16_t size;
-    struct cam_i2c_reg_array const *regs;
+    struct mhb_camera_i2c_reg_array const *regs;
 };
 
-static const struct cam_i2c_reg_array init_reg_array[] = {
+static const struct mhb_camera_i2c_reg_array init_reg_array[] = {
 	{0x0103, 0x01},
 };
 
 /* 3280 x 2464 */
-static const struct cam_i2c_reg_array res0_array[] = {
+static const struct mhb_camera_i2c_reg_array res0_array[] = {
     { 0x0103, 0x01, },
     { 0x0100, 0x00, },
     { 0x6620, 0x01, },
@@ -155,7 +150,7 @@ static const struct cam_i2c_reg_array res0_array[] = {
 };
 
 #if 0
-static const struct cam_i2c_reg_array res1_array[] = {
+static const struct mhb_camera_i2c_reg_array res1_array[] = {
     { 0x0103, 0x01, },
     { 0x0100, 0x00, },
     { 0x6620, 0x01, },
@@ -226,7 +221,7 @@ static const struct cam_i2c_reg_array res1_array[] = {
 };
 
 /* 1920 x 1080 */
-static const struct cam_i2c_reg_array res2_array[] = {
+static const struct mhb_camera_i2c_reg_array res2_array[] = {
     { 0x0103, 0x01, },
     { 0x0100, 0x00, },
     { 0x6620, 0x01, },
@@ -469,15 +464,9 @@ static int _mhb_camera_soc_enable(struct device *dev, uint8_t bootmode)
 
     /* configure init registers */
     size_t num = ARRAY_SIZE(init_reg_array);
-    int i;
     int ret;
-    for (i = 0; i < num; i++) {
-        ret = mhb_camera_i2c_write_reg1_16(CAMERA_SENSOR_I2C_ADDR,
-                                        init_reg_array[i].reg_addr,
-                                        init_reg_array[i].data);
-        if (ret)
-            break;
-    }
+    ret = mhb_camera_i2c_write_regs1_16(CAMERA_SENSOR_I2C_ADDR,
+                                        init_reg_array, num);
     return 0;
 }
 
@@ -509,15 +498,9 @@ static int _mhb_camera_stream_configure(struct device *dev)
         return -1;
     }
 
-    int i;
     int ret;
-    for (i = 0; i < udata->size; i++) {
-        ret = mhb_camera_i2c_write_reg1_16(CAMERA_SENSOR_I2C_ADDR,
-                                        udata->regs[i].reg_addr,
-                                        udata->regs[i].data);
-        if (ret)
-            break;
-    }
+    ret = mhb_camera_i2c_write_regs1_16(CAMERA_SENSOR_I2C_ADDR,
+                                        udata->regs, udata->size);
     return 0;
 }
 
@@ -69,17 +69,12 @@ struct dev_private_s s_data;
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 
-struct cam_i2c_reg_array {
-    const uint16_t reg_addr;
-    const uint8_t data;
-};
-
 struct cam_i2c_reg_setting {
     const uint16_t size;
-    struct cam_i2c_reg_array const *regs;
+    struct mhb_camera_i2c_reg_array const *regs;
 };
 
-static const struct cam_i2c_reg_array init_reg_array[] = {
+static const struct mhb_camera_i2c_reg_array init_reg_array[] = {
     { 0x0103, 0x01 },
     /* External Clock Setting - 19.2 */
     { 0x011E, 0x13 },
@@ -255,7 +250,7 @@ static const struct cam_i2c_reg_array init_reg_array[] = {
     { 0xAC3E, 0x70 },
 };
 
-static const struct cam_i2c_reg_array res_2624x1968_24fps_arrray[] = {
+static const struct mhb_camera_i2c_reg_array res_2624x1968_24fps_arrray[] = {
     /* V1/2 (4:3) 2624x1968 24fps  */
     /* Clock Setting */
     { 0x0301, 0x08 },
@@ -431,7 +426,7 @@ static const struct cam_i2c_reg_array res_2624x1968_24fps_arrray[] = {
     { 0x3522, 0x00 },
 };
 
-static const struct cam_i2c_reg_array res_5248x3936_12fps_array[] = {
+static const struct mhb_camera_i2c_reg_array res_5248x3936_12fps_array[] = {
     /* Full size 5248x3936 (4:3) 12fps */
     /* Clock Setting */
     { 0x0301, 0x08 },
@@ -608,7 +603,7 @@ static const struct cam_i2c_reg_array res_5248x3936_12fps_array[] = {
     { 0x3522, 0x00 },
 };
 
-static const struct cam_i2c_reg_array res_2624x1476_30fps_array[] = {
+static const struct mhb_camera_i2c_reg_array res_2624x1476_30fps_array[] = {
     /* V1/2 2624x1476 (16:9) 30fps  */
     /* Clock Setting */
     { 0x0301, 0x08 },
@@ -785,7 +780,7 @@ static const struct cam_i2c_reg_array res_2624x1476_30fps_array[] = {
     { 0x3522, 0x00 },
 };
 
-static const struct cam_i2c_reg_array res_3600x2024_24fps_arrays[] = {
+static const struct mhb_camera_i2c_reg_array res_3600x2024_24fps_arrays[] = {
     /* 4K UHDish (16:9) @ 24 fps */
     /* 3600 x 2024 */
     /* Clock Setting */
@@ -1149,15 +1144,9 @@ int imx220_soc_enable(struct device *dev, uint8_t bootmode)
 
     /* configure init registers */
     size_t num = ARRAY_SIZE(init_reg_array);
-    int i;
     int ret;
-    for (i = 0; i < num; i++) {
-        ret = mhb_camera_i2c_write_reg1_16(CAMERA_SENSOR_I2C_ADDR,
-                                        init_reg_array[i].reg_addr,
-                                        init_reg_array[i].data);
-        if (ret)
-            break;
-    }
+    ret = mhb_camera_i2c_write_regs1_16(CAMERA_SENSOR_I2C_ADDR,
+                                        init_reg_array, num);
     return ret;
 }
 
@@ -1174,7 +1163,6 @@ int imx220_soc_disable(struct device *dev)
 
 int imx220_stream_configure(struct device *dev)
 {
-    int i;
     int ret;
     const struct camera_ext_format_user_config *cfg = camera_ext_get_user_config();
     const struct camera_ext_frmival_node *ival;
@@ -1192,13 +1180,8 @@ int imx220_stream_configure(struct device *dev)
         return -1;
     }
 
-    for (i = 0; i < udata->size; i++) {
-        ret = mhb_camera_i2c_write_reg1_16(CAMERA_SENSOR_I2C_ADDR,
-                                        udata->regs[i].reg_addr,
-                                        udata->regs[i].data);
-        if (ret)
-            break;
-    }
+    ret = mhb_camera_i2c_write_regs1_16(CAMERA_SENSOR_I2C_ADDR,
+                                        udata->regs, udata->size);
 
     return ret;
 }
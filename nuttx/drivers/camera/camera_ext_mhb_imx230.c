@@ -69,17 +69,12 @@ struct dev_private_s s_data;
 
 #define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 
-struct cam_i2c_reg_array {
-    const uint16_t reg_addr;
-    const uint8_t data;
-};
-
 struct cam_i2c_reg_setting {
     const uint16_t size;
-    struct cam_i2c_reg_array const *regs;
+    struct mhb_camera_i2c_reg_array const *regs;
 };
 
-static const struct cam_i2c_reg_array init_reg_array[] = {
+static const struct mhb_camera_i2c_reg_array init_reg_array[] = {
     /* External Clock Settings - 19.2*/
     { 0x0136, 0x13 },
     { 0x0137, 0x02 },
@@ -504,7 +499,7 @@ static const struct cam_i2c_reg_array init_reg_array[] = {
     { 0x3129, 0x01 },
 };
 
-static const struct cam_i2c_reg_array res0_array[] = {
+static const struct mhb_camera_i2c_reg_array res0_array[] = {
     /* Mode G1: 2136x1202 1080p 16:9 30 fps */
     /* Preset Settings*/
     { 0x9004, 0x00 },
@@ -626,7 +621,7 @@ static const struct cam_i2c_reg_array res0_array[] = {
 };
 
 #if 0  /* TODO: debug this resolution */
-static const struct cam_i2c_reg_array res1_array[] = {
+static const struct mhb_camera_i2c_reg_array res1_array[] = {
     /* Mode A1: 5344x4016 Full 24fps */
     /* Preset Settings*/
     { 0x9004, 0x00 },
@@ -900,15 +895,9 @@ int imx230_soc_enable(struct device *dev, uint8_t bootmode)
 
     /* configure init registers */
     size_t num = ARRAY_SIZE(init_reg_array);
-    int i;
     int ret;
-    for (i = 0; i < num; i++) {
-        ret = mhb_camera_i2c_write_reg1_16(CAMERA_SENSOR_I2C_ADDR,
-                                        init_reg_array[i].reg_addr,
-                                        init_reg_array[i].data);
-        if (ret)
-            break;
-    }
+    ret = mhb_camera_i2c_write_regs1_16(CAMERA_SENSOR_I2C_ADDR,
+                                        init_reg_array, num);
     return ret;
 }
 
@@ -925,7 +914,6 @@ int imx230_soc_disable(struct device *dev)
 
 int imx230_stream_configure(struct device *dev)
 {
-    int i;
     int ret;
     const struct camera_ext_format_user_config *cfg = camera_ext_get_user_config();
     const struct camera_ext_frmival_node *ival;
@@ -943,13 +931,8 @@ int imx230_stream_configure(struct device *dev)
         return -1;
     }
 
-    for (i = 0; i < udata->size; i++) {
-        ret = mhb_camera_i2c_write_reg1_16(CAMERA_SENSOR_I2C_ADDR,
-                                        udata->regs[i].reg_addr,
-                                        udata->regs[i].data);
-        if (ret)
-            break;
-    }
+    ret = mhb_camera_i2c_write_regs1_16(CAMERA_SENSOR_I2C_ADDR,
+                                        udata->regs, udata->size);
 
     return ret;
 }
@@ -52,6 +52,8 @@
 
 #include <nuttx/fs/fs.h>
 #include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/wdog.h>
 #include <nuttx/can.h>
 
 #include <arch/irq.h>
@@ -93,6 +95,10 @@ static int            can_open(FAR struct file *filep);
 static int            can_close(FAR struct file *filep);
 static ssize_t        can_read(FAR struct file *filep, FAR char *buffer,
                          size_t buflen);
+static int            can_rxpending(FAR struct can_dev_s *dev);
+static bool           can_rxready(FAR struct can_dev_s *dev);
+static void           can_rxarm(FAR struct can_dev_s *dev);
+static void           can_rxtimeout(int argc, uint32_t arg, ...);
 static int            can_xmit(FAR struct can_dev_s *dev);
 static ssize_t        can_write(FAR struct file *filep,
                          FAR const char *buffer, size_t buflen);
@@ -265,6 +271,10 @@ static int can_close(FAR struct file *filep)
 
           flags = irqsave();       /* Disable interrupts */
           dev_shutdown(dev);       /* Disable the CAN */
+
+          (void)wd_cancel(dev->cd_rxwdog);
+          dev->cd_rxwdactive = false;
+          dev->cd_rxexpired  = false;
           irqrestore(flags);
 
           sem_post(&dev->cd_closesem);
@@ -274,11 +284,99 @@ static int can_close(FAR struct file *filep)
   return ret;
 }
 
+/****************************************************************************
+ * Name: can_rxpending
+ *
+ * Description:
+ *   Return the number of messages in the cd_recv FIFO
+ *
+ * Assumptions:
+ *   Called with interrupts disabled
+ *
+ ****************************************************************************/
+
+static int can_rxpending(FAR struct can_dev_s *dev)
+{
+  int npending = dev->cd_recv.rx_tail - dev->cd_recv.rx_head;
+
+  if (npending < 0)
+    {
+      npending += CONFIG_CAN_FIFOSIZE;
+    }
+
+  return npending;
+}
+
+/****************************************************************************
+ * Name: can_rxready
+ *
+ * Description:
+ *   Return true if a blocked reader should be released:  Enough messages
+ *   have been queued or the oldest one has waited long enough.
+ *
+ * Assumptions:
+ *   Called with interrupts disabled
+ *
+ ****************************************************************************/
+
+static bool can_rxready(FAR struct can_dev_s *dev)
+{
+  int npending = can_rxpending(dev);
+
+  return npending > 0 &&
+         (npending >= dev->cd_rxcount || dev->cd_rxexpired);
+}
+
+/****************************************************************************
+ * Name: can_rxarm
+ *
+ * Description:
+ *   Start the wakeup delay for an incomplete batch of received messages, if
+ *   one is configured and not already running.
+ *
+ * Assumptions:
+ *   Called with interrupts disabled
+ *
+ ****************************************************************************/
+
+static void can_rxarm(FAR struct can_dev_s *dev)
+{
+  if (dev->cd_rxdelay > 0 && !dev->cd_rxwdactive && !dev->cd_rxexpired)
+    {
+      dev->cd_rxwdactive = true;
+      (void)wd_start(dev->cd_rxwdog, dev->cd_rxdelay,
+                     (wdentry_t)can_rxtimeout, 1, (uint32_t)dev);
+    }
+}
+
+/****************************************************************************
+ * Name: can_rxtimeout
+ *
+ * Description:
+ *   The wakeup delay elapsed:  Release the readers with whatever has been
+ *   queued so far.
+ *
+ ****************************************************************************/
+
+static void can_rxtimeout(int argc, uint32_t arg, ...)
+{
+  FAR struct can_dev_s *dev = (FAR struct can_dev_s *)arg;
+
+  dev->cd_rxwdactive = false;
+  dev->cd_rxexpired  = true;
+
+  if (dev->cd_nrxwaiters > 0)
+    {
+      sem_post(&dev->cd_recv.rx_sem);
+    }
+}
+
 /****************************************************************************
  * Name: can_read
  *
  * Description:
- *   Read standard CAN messages
+ *   Read standard CAN messages.  All queued messages that fit in the user
+ *   buffer are returned by one call.
  *
  ****************************************************************************/
 
@@ -303,19 +401,37 @@ static ssize_t can_read(FAR struct file *filep, FAR char *buffer,
       /* Interrupts must be disabled while accessing the cd_recv FIFO */
 
       flags = irqsave();
-      while (dev->cd_recv.rx_head == dev->cd_recv.rx_tail)
+      while (!can_rxready(dev))
         {
-          /* The receive FIFO is empty -- was non-blocking mode selected? */
+          /* Not enough messages yet -- was non-blocking mode selected?  If
+           * so, return whatever is queued.
+           */
 
           if (filep->f_oflags & O_NONBLOCK)
             {
+              if (dev->cd_recv.rx_head != dev->cd_recv.rx_tail)
+                {
+                  break;
+                }
+
               ret = -EAGAIN;
               goto return_with_irqdisabled;
             }
 
-          /* Wait for a message to be received */
+          /* Bound the wait for a batch that has already started */
+
+          if (dev->cd_recv.rx_head != dev->cd_recv.rx_tail)
+            {
+              can_rxarm(dev);
+            }
+
+          /* Wait for more messages to be received */
 
+          DEBUGASSERT(dev->cd_nrxwaiters < 255);
+          dev->cd_nrxwaiters++;
           ret = sem_wait(&dev->cd_recv.rx_sem);
+          dev->cd_nrxwaiters--;
+
           if (ret < 0)
             {
               ret = -get_errno();
@@ -354,6 +470,19 @@ static ssize_t can_read(FAR struct file *filep, FAR char *buffer,
         }
       while (dev->cd_recv.rx_head != dev->cd_recv.rx_tail);
 
+      /* Start the next batch once the FIFO has been drained */
+
+      if (dev->cd_recv.rx_head == dev->cd_recv.rx_tail)
+        {
+          if (dev->cd_rxwdactive)
+            {
+              (void)wd_cancel(dev->cd_rxwdog);
+              dev->cd_rxwdactive = false;
+            }
+
+          dev->cd_rxexpired = false;
+        }
+
       /* All on the messages have bee transferred.  Return the number of bytes
        * that were read.
        */
@@ -656,6 +785,46 @@ static int can_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
         ret = can_rtrread(dev, (struct canioctl_rtr_s*)((uintptr_t)arg));
         break;
 
+      /* CANIOCTL_RXWAKEUP: Set the reader wakeup count and delay.  Argument
+       * is a reference to struct canioctl_rxwakeup_s.
+       */
+
+      case CANIOCTL_RXWAKEUP:
+        {
+          FAR struct canioctl_rxwakeup_s *wakeup =
+            (FAR struct canioctl_rxwakeup_s *)((uintptr_t)arg);
+          irqstate_t flags;
+
+          if (wakeup == NULL || wakeup->cw_count < 1)
+            {
+              ret = -EINVAL;
+              break;
+            }
+
+          flags = irqsave();
+
+          /* The FIFO can hold at most CONFIG_CAN_FIFOSIZE - 1 messages */
+
+          dev->cd_rxcount = wakeup->cw_count;
+          if (dev->cd_rxcount > CONFIG_CAN_FIFOSIZE - 1)
+            {
+              dev->cd_rxcount = CONFIG_CAN_FIFOSIZE - 1;
+            }
+
+          dev->cd_rxdelay = MSEC2TICK(wakeup->cw_msec);
+          if (wakeup->cw_msec > 0 && dev->cd_rxdelay == 0)
+            {
+              dev->cd_rxdelay = 1;
+            }
+
+          irqrestore(flags);
+        }
+        break;
+
+      /* CANIOCTL_ADD_FILTER and CANIOCTL_DEL_FILTER are handled by the lower
+       * half, as are all commands that are not "built-in".
+       */
+
       /* Not a "built-in" ioctl command.. perhaps it is unique to this
        * device driver.
        */
@@ -687,6 +856,14 @@ int can_register(FAR const char *path, FAR struct can_dev_s *dev)
   /* Initialize the CAN device structure */
 
   dev->cd_ocount = 0;
+  dev->cd_rxcount = 1;
+  dev->cd_rxdelay = 0;
+
+  dev->cd_rxwdog = wd_create();
+  if (dev->cd_rxwdog == NULL)
+    {
+      return -ENOMEM;
+    }
 
   sem_init(&dev->cd_xmit.tx_sem, 0, 0);
   sem_init(&dev->cd_recv.rx_sem, 0, 0);
@@ -802,12 +979,22 @@ int can_receive(FAR struct can_dev_s *dev, FAR struct can_hdr_s *hdr,
 
       fifo->rx_tail = nexttail;
 
-      /* The increment the counting semaphore. The maximum value should be
-       * CONFIG_CAN_FIFOSIZE -- one possible count for each allocated
-       * message buffer.
+      /* Wake up a waiting reader if the batch is complete.  Otherwise bound
+       * how long the messages may wait.
        */
 
-      sem_post(&fifo->rx_sem);
+      if (can_rxready(dev))
+        {
+          if (dev->cd_nrxwaiters > 0)
+            {
+              sem_post(&fifo->rx_sem);
+            }
+        }
+      else
+        {
+          can_rxarm(dev);
+        }
+
       err = OK;
     }
 
@@ -30,12 +30,210 @@
  */
 
 #include <errno.h>
+#include <stdbool.h>
 #include <string.h>
+#include <unistd.h>
+#include <semaphore.h>
 
 #include <arch/irq.h>
 
+#include <nuttx/bootphase.h>
+#include <nuttx/clock.h>
 #include <nuttx/device.h>
 #include <nuttx/device_table.h>
+#ifdef CONFIG_DEVICE_STATS
+#include <nuttx/hires_tmr.h>
+#endif
+
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+#ifdef CONFIG_SCHED_LPWORK
+#   define DEVICE_PM_WORK LPWORK
+#else
+#   define DEVICE_PM_WORK HPWORK
+#endif
+
+/* Serializes the runtime suspend and resume of all the devices */
+static sem_t device_pm_lock = SEM_INITIALIZER(1);
+
+static bool device_has_runtime_pm(struct device *dev)
+{
+    return dev->driver && dev->driver->ops->runtime_suspend &&
+           dev->driver->ops->runtime_resume;
+}
+
+static void device_pm_suspend_worker(void *arg)
+{
+    struct device *dev = arg;
+    irqstate_t flags;
+    bool idle;
+
+    while (sem_wait(&device_pm_lock) < 0)
+        ;
+
+    flags = irqsave();
+    idle = !dev->pm_usage && !dev->pm_suspended && device_has_runtime_pm(dev);
+    irqrestore(flags);
+
+    if (idle && !dev->driver->ops->runtime_suspend(dev))
+        dev->pm_suspended = true;
+
+    sem_post(&device_pm_lock);
+}
+
+static void device_pm_schedule_suspend(struct device *dev)
+{
+    work_cancel(DEVICE_PM_WORK, &dev->pm_work);
+    work_queue(DEVICE_PM_WORK, &dev->pm_work, device_pm_suspend_worker, dev,
+               MSEC2TICK(CONFIG_DEVICE_RUNTIME_PM_DELAY));
+}
+
+/* Stop the runtime PM of a device about to be removed, leaving it active */
+static void device_pm_stop(struct device *dev)
+{
+    if (!device_has_runtime_pm(dev))
+        return;
+
+    work_cancel(DEVICE_PM_WORK, &dev->pm_work);
+
+    while (sem_wait(&device_pm_lock) < 0)
+        ;
+
+    if (dev->pm_suspended)
+        dev->driver->ops->runtime_resume(dev);
+    dev->pm_suspended = false;
+    dev->pm_usage = 0;
+
+    sem_post(&device_pm_lock);
+}
+
+/**
+ * @brief Mark a device as in use, resuming it if it was suspended
+ *
+ * Drivers implementing the runtime PM callbacks bracket their hardware
+ * accesses with device_pm_get() and device_pm_put(); device_open() and
+ * device_close() already do it around the driver open and close.  Must not
+ * be called from an interrupt handler.
+ *
+ * @param dev Device to resume
+ * @return 0 on success, or the error returned by runtime_resume
+ */
+int device_pm_get(struct device *dev)
+{
+    irqstate_t flags;
+    int ret = 0;
+
+    if (!dev || !device_has_runtime_pm(dev))
+        return 0;
+
+    while (sem_wait(&device_pm_lock) < 0)
+        ;
+
+    if (dev->pm_suspended) {
+        ret = dev->driver->ops->runtime_resume(dev);
+        if (ret)
+            goto out;
+        dev->pm_suspended = false;
+    }
+
+    flags = irqsave();
+    dev->pm_usage++;
+    irqrestore(flags);
+
+out:
+    sem_post(&device_pm_lock);
+    return ret;
+}
+
+/**
+ * @brief Release a device, suspending it once it stayed idle for
+ * CONFIG_DEVICE_RUNTIME_PM_DELAY milliseconds
+ * @param dev Device given to device_pm_get()
+ */
+void device_pm_put(struct device *dev)
+{
+    irqstate_t flags;
+    bool idle;
+
+    if (!dev || !device_has_runtime_pm(dev))
+        return;
+
+    flags = irqsave();
+    DEBUGASSERT(dev->pm_usage > 0);
+    idle = --dev->pm_usage == 0;
+    irqrestore(flags);
+
+    if (idle)
+        device_pm_schedule_suspend(dev);
+}
+#endif
+
+#ifdef CONFIG_BOOT_DEFER
+/* Drivers registered with device_register_driver_deferred() not probed yet.
+ * device_defer_lock is held from the moment one is taken from the list
+ * until its probing is done, so that a device_open() racing with the
+ * deferred thread waits for the probe rather than failing.
+ */
+static struct device_driver *device_deferred[CONFIG_BOOT_DEFER_NENTRIES];
+static sem_t device_defer_lock = SEM_INITIALIZER(1);
+static pid_t device_defer_holder = -1;
+
+/* Must be called with interrupts disabled */
+static int device_find_deferred(const char *type, const char *name)
+{
+    int i;
+
+    for (i = 0; i < CONFIG_BOOT_DEFER_NENTRIES; i++) {
+        if (device_deferred[i] &&
+            !strcmp(device_deferred[i]->type, type) &&
+            !strcmp(device_deferred[i]->name, name))
+            return i;
+    }
+
+    return -ENOENT;
+}
+
+/*
+ * Probe the deferred driver of type 'type' and name 'name', if any.  Also
+ * called to wait for the deferred probe in progress.  The lock is not
+ * taken again by a deferred probe opening other devices.
+ */
+static void device_probe_deferred(const char *type, const char *name)
+{
+    struct device_driver *driver = NULL;
+    bool nested = device_defer_holder == getpid();
+    irqstate_t flags;
+    int i;
+
+    if (!nested) {
+        while (sem_wait(&device_defer_lock) < 0)
+            ;
+        device_defer_holder = getpid();
+    }
+
+    flags = irqsave();
+    i = device_find_deferred(type, name);
+    if (i >= 0) {
+        driver = device_deferred[i];
+        device_deferred[i] = NULL;
+    }
+    irqrestore(flags);
+
+    if (driver)
+        device_register_driver(driver);
+
+    if (!nested) {
+        device_defer_holder = -1;
+        sem_post(&device_defer_lock);
+    }
+}
+
+static void device_deferred_worker(void *arg)
+{
+    struct device_driver *driver = arg;
+
+    device_probe_deferred(driver->type, driver->name);
+}
+#endif
 
 /**
  * @brief Open specified device
@@ -46,38 +244,62 @@
 struct device *device_open(char *type, unsigned int id)
 {
     struct device *dev;
-    struct device_table_iter iter = DEVICE_TABLE_ITER_INITIALIZER;
     irqstate_t flags;
     int ret;
+#ifdef CONFIG_DEVICE_STATS
+    uint32_t start = hrt_getusec();
+    uint32_t elapsed;
+#endif
 
-    if (!type)
+    dev = device_table_lookup(type, id);
+    if (!dev)
         return NULL;
 
     flags = irqsave();
 
-    device_table_for_each_dev(dev, &iter) {
-        if (!strcmp(dev->type, type) && (dev->id == id)) {
-            if (dev->state != DEVICE_STATE_PROBED)
-                goto err_irqrestore;
-
-            dev->state = DEVICE_STATE_OPENING;
+#ifdef CONFIG_BOOT_DEFER
+    /*
+     * Opened before its deferred driver got probed: probe it now, or wait
+     * for the probe in progress, and try again.
+     */
+    if ((dev->state == DEVICE_STATE_REMOVED &&
+         device_find_deferred(dev->type, dev->name) >= 0) ||
+        dev->state == DEVICE_STATE_PROBING) {
+        irqrestore(flags);
+        device_probe_deferred(dev->type, dev->name);
+        flags = irqsave();
+    }
+#endif
+    if (dev->state != DEVICE_STATE_PROBED)
+        goto err_irqrestore;
 
-            if (dev->driver->ops->open) {
-                irqrestore(flags);
-                ret = dev->driver->ops->open(dev);
-                flags = irqsave();
+    dev->state = DEVICE_STATE_OPENING;
 
-                if (ret) {
-                    dev->state = DEVICE_STATE_PROBED;
-                    goto err_irqrestore;
-                }
-            }
+    if (dev->driver->ops->open) {
+        irqrestore(flags);
+        ret = device_pm_get(dev);
+        if (!ret) {
+            ret = dev->driver->ops->open(dev);
+            device_pm_put(dev);
+        }
+        flags = irqsave();
 
-            dev->state = DEVICE_STATE_OPEN;
-            break;
+        if (ret) {
+            dev->state = DEVICE_STATE_PROBED;
+            goto err_irqrestore;
         }
     }
 
+    dev->state = DEVICE_STATE_OPEN;
+
+#ifdef CONFIG_DEVICE_STATS
+    elapsed = hrt_getusec() - start;
+    dev->open_count++;
+    dev->open_usec_total += elapsed;
+    if (elapsed > dev->open_usec_max)
+        dev->open_usec_max = elapsed;
+#endif
+
     irqrestore(flags);
 
     return dev;
@@ -95,6 +317,7 @@ err_irqrestore:
 void device_close(struct device *dev)
 {
     irqstate_t flags;
+    int ret;
 
     if (!dev)
         return;
@@ -110,7 +333,10 @@ void device_close(struct device *dev)
 
     if (dev->driver->ops->close) {
         irqrestore(flags);
+        ret = device_pm_get(dev);
         dev->driver->ops->close(dev);
+        if (!ret)
+            device_pm_put(dev);
         flags = irqsave();
     }
 
@@ -160,6 +386,17 @@ int device_register_driver(struct device_driver *driver)
             }
 
             dev->state = DEVICE_STATE_PROBED;
+
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+            /* Probed active: suspend it if nobody uses it */
+            if (device_has_runtime_pm(dev)) {
+                dev->pm_usage = 0;
+                dev->pm_suspended = false;
+                irqrestore(flags);
+                device_pm_schedule_suspend(dev);
+                flags = irqsave();
+            }
+#endif
         }
     }
 
@@ -168,6 +405,44 @@ int device_register_driver(struct device_driver *driver)
     return 0;
 }
 
+/**
+ * @brief Register specified driver, probing its devices later
+ *
+ * The probing is queued with boot_defer() so that it is taken off the
+ * essential boot path.  A device of the driver opened before that is probed
+ * on demand.  Without CONFIG_BOOT_DEFER this is device_register_driver().
+ *
+ * @param driver Address of structure containing driver information
+ * @return 0: Driver registered
+ *         -errno: Negative errno value indicating reason for failure
+ */
+int device_register_driver_deferred(struct device_driver *driver)
+{
+#ifdef CONFIG_BOOT_DEFER
+    irqstate_t flags;
+    int i;
+
+    if (!driver || !driver->type || !driver->name || !driver->ops)
+        return -EINVAL;
+
+    flags = irqsave();
+
+    for (i = 0; i < CONFIG_BOOT_DEFER_NENTRIES; i++) {
+        if (!device_deferred[i]) {
+            device_deferred[i] = driver;
+            break;
+        }
+    }
+
+    irqrestore(flags);
+
+    if (i < CONFIG_BOOT_DEFER_NENTRIES)
+        return boot_defer(driver->name, device_deferred_worker, driver);
+#endif
+
+    return device_register_driver(driver);
+}
+
 /**
  * @brief Unregister specified driver
  * @param driver Address of structure used to register the driver
@@ -190,6 +465,12 @@ void device_unregister_driver(struct device_driver *driver)
 
             dev->state = DEVICE_STATE_REMOVING;
 
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+            irqrestore(flags);
+            device_pm_stop(dev);
+            flags = irqsave();
+#endif
+
             if (driver->ops->remove) {
                 irqrestore(flags);
                 driver->ops->remove(dev);
@@ -30,14 +30,40 @@
  */
 
 #include <errno.h>
+#include <string.h>
+
+#include <arch/irq.h>
 
 #include <nuttx/list.h>
 #include <nuttx/device.h>
 #include <nuttx/device_table.h>
 #include <nuttx/kmalloc.h>
 
+#ifdef CONFIG_DEVICE_TABLE_HASH_SIZE
+#define DEVICE_TABLE_HASH_SIZE  CONFIG_DEVICE_TABLE_HASH_SIZE
+#else
+#define DEVICE_TABLE_HASH_SIZE  32
+#endif
+
+#if (DEVICE_TABLE_HASH_SIZE & (DEVICE_TABLE_HASH_SIZE - 1)) != 0
+#  error CONFIG_DEVICE_TABLE_HASH_SIZE must be a power of 2
+#endif
+
 static LIST_DECLARE(device_table_list);
 
+/* Devices of all the registered tables, chained by hash of (type, id) */
+static struct device *device_table_hash[DEVICE_TABLE_HASH_SIZE];
+
+static unsigned int device_table_hash_key(const char *type, unsigned int id)
+{
+    unsigned int hash = id;
+
+    while (*type)
+        hash = hash * 31 + *type++;
+
+    return hash & (DEVICE_TABLE_HASH_SIZE - 1);
+}
+
 struct device *device_table_iter_next(struct device_table_iter *iter)
 {
     if (!iter) {
@@ -82,12 +108,55 @@ struct device *device_table_iter_next(struct device_table_iter *iter)
  */
 int device_table_register(struct device_table *table)
 {
+    struct device *dev;
+    irqstate_t flags;
+    unsigned int key;
+    unsigned int i;
+
     if (!table || !table->device || !table->device_count) {
         return -EINVAL;
     }
 
+    flags = irqsave();
+
     list_init(&table->list);
     list_add(&device_table_list, &table->list);
 
+    /* Backwards, so that the first of duplicate devices is found first */
+    for (i = table->device_count; i-- > 0;) {
+        dev = &table->device[i];
+        if (!dev->type) {
+            continue;
+        }
+
+        key = device_table_hash_key(dev->type, dev->id);
+        dev->hash_next = device_table_hash[key];
+        device_table_hash[key] = dev;
+    }
+
+    irqrestore(flags);
+
     return 0;
 }
+
+/**
+ * @brief Find a registered device
+ * @param type Type of the device
+ * @param id ID of the device within its type
+ * @return The device, or NULL if no registered table holds it
+ */
+struct device *device_table_lookup(const char *type, unsigned int id)
+{
+    struct device *dev;
+
+    if (!type) {
+        return NULL;
+    }
+
+    dev = device_table_hash[device_table_hash_key(type, id)];
+    while (dev && (dev->id != id || strcmp(dev->type, type))) {
+        dev = dev->hash_next;
+    }
+
+    return dev;
+}
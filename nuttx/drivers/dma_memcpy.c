@@ -0,0 +1,295 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Memory to memory copies offloaded to the DMA channels of the
+ * DEVICE_TYPE_DMA_HW device.  The copies smaller than the threshold, or
+ * made while no channel could be allocated, are done by the CPU: setting
+ * up a DMA operation costs more than copying a few hundred bytes.
+ */
+
+#include <errno.h>
+#include <semaphore.h>
+#include <string.h>
+
+#include <arch/irq.h>
+
+#include <nuttx/device.h>
+#include <nuttx/device_dma.h>
+#include <nuttx/dma_memcpy.h>
+
+#ifndef CONFIG_DMA_MEMCPY_THRESHOLD
+#define CONFIG_DMA_MEMCPY_THRESHOLD 512
+#endif
+
+#ifndef CONFIG_DMA_MEMCPY_NCHANNELS
+#define CONFIG_DMA_MEMCPY_NCHANNELS 1
+#endif
+
+/* Kept in the extra space of the DMA operation */
+struct dma_memcpy_req {
+    dma_memcpy_callback callback;
+    void *arg;
+};
+
+struct dma_memcpy_sync {
+    sem_t done;
+    int status;
+};
+
+static struct {
+    sem_t lock;
+    struct device *dev;
+    void *chan[CONFIG_DMA_MEMCPY_NCHANNELS];
+    unsigned int nchan;
+    unsigned int next;
+    size_t threshold;
+} dma_memcpy_info = {
+    .lock = SEM_INITIALIZER(1),
+    .threshold = CONFIG_DMA_MEMCPY_THRESHOLD,
+};
+
+static int dma_memcpy_complete(struct device *dev, void *chan,
+                               struct device_dma_op *op, unsigned int event,
+                               void *arg)
+{
+    struct dma_memcpy_req req = *(struct dma_memcpy_req *)arg;
+    enum device_dma_error error = DEVICE_DMA_ERROR_NONE;
+
+    if (!(event & DEVICE_DMA_CALLBACK_EVENT_COMPLETE))
+        return OK;
+
+    device_dma_op_get_error(dev, op, &error);
+    device_dma_op_free(dev, op);
+
+    if (req.callback)
+        req.callback(error == DEVICE_DMA_ERROR_NONE ? 0 : -EIO, req.arg);
+
+    return OK;
+}
+
+static void dma_memcpy_sync_done(int status, void *arg)
+{
+    struct dma_memcpy_sync *sync = arg;
+
+    sync->status = status;
+    sem_post(&sync->done);
+}
+
+/**
+ * @brief Allocate the DMA channels used for the copies
+ *
+ * To be called once the DMA driver is registered, and after the drivers
+ * needing channels of their own got them.  Does nothing if already done.
+ *
+ * @return 0 on success, -errno if no channel could be allocated
+ */
+int dma_memcpy_init(void)
+{
+    struct device_dma_params params = {
+        .src_dev = DEVICE_DMA_DEV_MEM,
+        .src_devid = 0,
+        .src_inc_options = DEVICE_DMA_INC_AUTO,
+        .dst_dev = DEVICE_DMA_DEV_MEM,
+        .dst_devid = 0,
+        .dst_inc_options = DEVICE_DMA_INC_AUTO,
+        .transfer_size = DEVICE_DMA_TRANSFER_SIZE_64,
+        .burst_len = DEVICE_DMA_BURST_LEN_16,
+        .swap = DEVICE_DMA_SWAP_SIZE_NONE,
+    };
+    struct device *dev;
+    unsigned int nchan = 0;
+    int avail;
+    int ret = 0;
+
+    while (sem_wait(&dma_memcpy_info.lock) < 0)
+        ;
+
+    if (dma_memcpy_info.dev)
+        goto out;
+
+    dev = device_open(DEVICE_TYPE_DMA_HW, 0);
+    if (!dev) {
+        ret = -ENODEV;
+        goto out;
+    }
+
+    avail = device_dma_chan_free_count(dev);
+    while (nchan < CONFIG_DMA_MEMCPY_NCHANNELS && (int)nchan < avail) {
+        if (device_dma_chan_alloc(dev, &params,
+                                  &dma_memcpy_info.chan[nchan]) ||
+            !dma_memcpy_info.chan[nchan])
+            break;
+        nchan++;
+    }
+
+    if (!nchan) {
+        device_close(dev);
+        ret = -EBUSY;
+        goto out;
+    }
+
+    dma_memcpy_info.next = 0;
+    dma_memcpy_info.nchan = nchan;
+    dma_memcpy_info.dev = dev;
+
+out:
+    sem_post(&dma_memcpy_info.lock);
+    return ret;
+}
+
+/**
+ * @brief Free the channels allocated by dma_memcpy_init()
+ *
+ * No copy may be in progress.
+ */
+void dma_memcpy_deinit(void)
+{
+    struct device *dev;
+    irqstate_t flags;
+    unsigned int i;
+
+    while (sem_wait(&dma_memcpy_info.lock) < 0)
+        ;
+
+    flags = irqsave();
+    dev = dma_memcpy_info.dev;
+    dma_memcpy_info.dev = NULL;
+    irqrestore(flags);
+
+    if (dev) {
+        for (i = 0; i < dma_memcpy_info.nchan; i++)
+            device_dma_chan_free(dev, dma_memcpy_info.chan[i]);
+        dma_memcpy_info.nchan = 0;
+        device_close(dev);
+    }
+
+    sem_post(&dma_memcpy_info.lock);
+}
+
+/**
+ * @brief Change the size from which the copies are offloaded
+ * @param threshold Smallest copy made by DMA, 0 to offload all the copies
+ * @return The previous threshold
+ */
+size_t dma_memcpy_set_threshold(size_t threshold)
+{
+    size_t old = dma_memcpy_info.threshold;
+
+    dma_memcpy_info.threshold = threshold;
+    return old;
+}
+
+/**
+ * @brief Copy memory, by DMA if the copy is large enough
+ *
+ * The callback is called from the context of the DMA driver completion
+ * thread once the copy is done, or before returning when the CPU made the
+ * copy.  The buffers must not be touched until then.
+ *
+ * @param dst Destination buffer
+ * @param src Source buffer, not overlapping dst
+ * @param len Number of bytes to copy
+ * @param callback Called when the copy is done, may be NULL
+ * @param arg Argument of the callback
+ * @return 0 if the copy is done or started, -errno if it failed
+ */
+int dma_memcpy_async(void *dst, const void *src, size_t len,
+                     dma_memcpy_callback callback, void *arg)
+{
+    struct device_dma_op *op;
+    struct dma_memcpy_req *req;
+    struct device *dev;
+    irqstate_t flags;
+    void *chan;
+    int ret;
+
+    flags = irqsave();
+    dev = dma_memcpy_info.dev;
+    if (dev && len && len >= dma_memcpy_info.threshold) {
+        chan = dma_memcpy_info.chan[dma_memcpy_info.next];
+        dma_memcpy_info.next = (dma_memcpy_info.next + 1) %
+                               dma_memcpy_info.nchan;
+    } else {
+        dev = NULL;
+    }
+    irqrestore(flags);
+
+    if (!dev || device_dma_op_alloc(dev, 1, sizeof(*req), &op))
+        goto cpu_copy;
+
+    req = (struct dma_memcpy_req *)&op->sg[1];
+    req->callback = callback;
+    req->arg = arg;
+
+    op->callback = dma_memcpy_complete;
+    op->callback_arg = req;
+    op->callback_events = DEVICE_DMA_CALLBACK_EVENT_COMPLETE;
+    op->sg_count = 1;
+    op->sg[0].src_addr = (off_t)src;
+    op->sg[0].dst_addr = (off_t)dst;
+    op->sg[0].len = len;
+
+    ret = device_dma_enqueue(dev, chan, op);
+    if (!ret)
+        return 0;
+
+    device_dma_op_free(dev, op);
+
+cpu_copy:
+    memcpy(dst, src, len);
+    if (callback)
+        callback(0, arg);
+    return 0;
+}
+
+/**
+ * @brief Copy memory, by DMA if the copy is large enough, and wait for it
+ * @param dst Destination buffer
+ * @param src Source buffer, not overlapping dst
+ * @param len Number of bytes to copy
+ * @return 0 on success, -errno if the DMA transfer failed
+ */
+int dma_memcpy(void *dst, const void *src, size_t len)
+{
+    struct dma_memcpy_sync sync;
+    int ret;
+
+    sem_init(&sync.done, 0, 0);
+    sync.status = 0;
+
+    ret = dma_memcpy_async(dst, src, len, dma_memcpy_sync_done, &sync);
+    if (!ret) {
+        while (sem_wait(&sync.done) < 0)
+            ;
+        ret = sync.status;
+    }
+
+    sem_destroy(&sync.done);
+    return ret;
+}
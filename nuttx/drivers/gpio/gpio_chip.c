@@ -181,6 +181,14 @@ uint8_t gpio_line_count(void)
     return g_gpio_line_count;
 }
 
+bool gpio_can_sleep(uint8_t which)
+{
+    struct gpio_chip_s *chip = get_gpio_chip(&which);
+
+    DEBUGASSERT(chip);
+    return chip->ops->can_sleep;
+}
+
 int gpio_irqattach(uint8_t which, xcpt_t isr)
 {
     struct gpio_chip_s *chip = get_gpio_chip(&which);
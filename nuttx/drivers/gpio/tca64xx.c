@@ -924,6 +924,7 @@ struct gpio_ops_s tca64xx_gpio_ops = {
     .mask_irq = tca64xx_gpio_mask_irq,
     .unmask_irq = tca64xx_gpio_unmask_irq,
     .clear_interrupt = tca64xx_gpio_clear_interrupt,
+    .can_sleep = true,
 };
 
 static int tca64xx_polling_worker(int argc, char *argv[])
@@ -330,6 +330,7 @@ static struct gb_driver gb_aud_driver = {
     .exit = gb_aud_exit,
     .op_handlers = (struct gb_operation_handler*)gb_aud_handlers,
     .op_handlers_count = ARRAY_SIZE(gb_aud_handlers),
+    .init_group = GB_INIT_GROUP_AUDIO,
 };
 
 void gb_aud_register(int cport)
@@ -248,7 +248,7 @@ static int muc_aud_dev_set_current_use_case(struct device *dev, uint32_t use_cas
 
     caps.ac_type = AUDIO_TYPE_FEATURE;
     caps.ac_format.hw = AUDIO_FU_EQUALIZER;
-    caps.ac_controls.hw[0] = tfa9890_use_case;
+    caps.ac_controls.hw[0] = gb_aud.use_case;
 
     for (i = 0; i < ARRAY_SIZE(tfa9890_devices); i++)
     {
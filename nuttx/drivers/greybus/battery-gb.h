@@ -46,6 +46,14 @@
 #define GB_BATTERY_TYPE_CURRENT             0x08
 #define GB_BATTERY_TYPE_CAPACITY            0x09
 #define GB_BATTERY_TYPE_SHUTDOWN_TEMP       0x0a
+#define GB_BATTERY_TYPE_EVENT               0x0b
+
+/* Greybus battery event bits */
+#define GB_BATTERY_EVENT_STATUS             0x00000001
+#define GB_BATTERY_EVENT_PERCENT_CAPACITY   0x00000002
+#define GB_BATTERY_EVENT_TEMPERATURE        0x00000004
+#define GB_BATTERY_EVENT_VOLTAGE            0x00000008
+#define GB_BATTERY_EVENT_CURRENT            0x00000010
 
 struct gb_battery_technology_response {
     __le32  technology;
@@ -89,4 +97,9 @@ struct gb_battery_proto_version_response {
     __u8    minor;
 };
 
+/* event requests originate on the module, they have no response */
+struct gb_battery_event_request {
+    __le32  events;
+};
+
 #endif /* __BATTERY_GB_H__ */
@@ -32,6 +32,13 @@
 #include <errno.h>
 #include <debug.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef CONFIG_GREYBUS_BATTERY_CACHE
+#include <semaphore.h>
+#include <nuttx/clock.h>
+#include <nuttx/wqueue.h>
+#endif
 
 #include <arch/byteorder.h>
 #include <nuttx/greybus/greybus.h>
@@ -47,6 +54,236 @@
 /* Allocated in initial function for internal data store */
 static struct device *batt_dev = NULL;
 
+/* Telemetry values that may be cached, in the GB_BATTERY_EVENT_* bit order */
+enum gb_battery_prop {
+    GB_BATTERY_PROP_STATUS,
+    GB_BATTERY_PROP_PERCENT_CAPACITY,
+    GB_BATTERY_PROP_TEMPERATURE,
+    GB_BATTERY_PROP_VOLTAGE,
+    GB_BATTERY_PROP_CURRENT,
+    GB_BATTERY_PROP_COUNT,
+};
+
+#ifdef CONFIG_GREYBUS_BATTERY_CACHE
+#define BATTERY_MAX_AGE     MSEC2TICK(CONFIG_GREYBUS_BATTERY_CACHE_MAX_AGE)
+#define BATTERY_REFRESH     MSEC2TICK(CONFIG_GREYBUS_BATTERY_REFRESH_PERIOD)
+
+struct gb_battery_value {
+    bool valid;
+    int32_t value;
+    uint32_t time;
+#ifdef CONFIG_GREYBUS_BATTERY_NOTIFY
+    /* value the host was last told about */
+    bool notified_valid;
+    int32_t notified;
+#endif
+};
+
+static struct {
+    sem_t lock;
+    struct work_s work;
+    unsigned int cport;
+    struct gb_battery_value values[GB_BATTERY_PROP_COUNT];
+} batt_cache;
+
+#ifdef CONFIG_GREYBUS_BATTERY_NOTIFY
+/* Change needed to notify the host, 0 notifies any change */
+static const int32_t batt_thresholds[GB_BATTERY_PROP_COUNT] = {
+    [GB_BATTERY_PROP_STATUS] = 0,
+    [GB_BATTERY_PROP_PERCENT_CAPACITY] = CONFIG_GREYBUS_BATTERY_NOTIFY_CAPACITY,
+    [GB_BATTERY_PROP_TEMPERATURE] = CONFIG_GREYBUS_BATTERY_NOTIFY_TEMPERATURE,
+    [GB_BATTERY_PROP_VOLTAGE] = CONFIG_GREYBUS_BATTERY_NOTIFY_VOLTAGE,
+    [GB_BATTERY_PROP_CURRENT] = CONFIG_GREYBUS_BATTERY_NOTIFY_CURRENT,
+};
+#endif
+#endif
+
+/**
+* @brief Read a telemetry value from the battery driver.
+*
+* @param prop The value to read.
+* @param value The output value.
+*
+* @return 0 on success, negative errno on error.
+*/
+static int gb_battery_read(enum gb_battery_prop prop, int32_t *value)
+{
+    uint16_t status;
+    uint32_t uvalue;
+    int svalue;
+    int ret;
+
+    switch (prop) {
+    case GB_BATTERY_PROP_STATUS:
+        ret = device_battery_status(batt_dev, &status);
+        *value = status;
+        break;
+    case GB_BATTERY_PROP_PERCENT_CAPACITY:
+        ret = device_battery_percent_capacity(batt_dev, &uvalue);
+        *value = uvalue;
+        break;
+    case GB_BATTERY_PROP_TEMPERATURE:
+        ret = device_battery_temperature(batt_dev, &svalue);
+        *value = svalue;
+        break;
+    case GB_BATTERY_PROP_VOLTAGE:
+        ret = device_battery_voltage(batt_dev, &uvalue);
+        *value = uvalue;
+        break;
+    case GB_BATTERY_PROP_CURRENT:
+        ret = device_battery_current(batt_dev, &svalue);
+        *value = svalue;
+        break;
+    default:
+        return -EINVAL;
+    }
+
+    return ret;
+}
+
+#ifdef CONFIG_GREYBUS_BATTERY_CACHE
+static void gb_battery_cache_lock(void)
+{
+    while (sem_wait(&batt_cache.lock) != OK) {
+        DEBUGASSERT(get_errno() == EINTR);
+    }
+}
+
+static void gb_battery_cache_unlock(void)
+{
+    sem_post(&batt_cache.lock);
+}
+
+/* Must be called with the cache locked */
+static int gb_battery_refresh(enum gb_battery_prop prop)
+{
+    struct gb_battery_value *entry = &batt_cache.values[prop];
+    int32_t value;
+    int ret;
+
+    ret = gb_battery_read(prop, &value);
+    if (ret) {
+        entry->valid = false;
+        return ret;
+    }
+
+    entry->value = value;
+    entry->time = clock_systimer();
+    entry->valid = true;
+
+    return 0;
+}
+
+/**
+* @brief Get a telemetry value, from the cache when recent enough.
+*
+* @param prop The value to get.
+* @param value The output value.
+*
+* @return 0 on success, negative errno on error.
+*/
+static int gb_battery_get(enum gb_battery_prop prop, int32_t *value)
+{
+    struct gb_battery_value *entry = &batt_cache.values[prop];
+    int ret = 0;
+
+    gb_battery_cache_lock();
+
+    if (!entry->valid || clock_systimer() - entry->time > BATTERY_MAX_AGE)
+        ret = gb_battery_refresh(prop);
+
+    *value = entry->value;
+
+    gb_battery_cache_unlock();
+
+    return ret;
+}
+
+#ifdef CONFIG_GREYBUS_BATTERY_NOTIFY
+/* Must be called with the cache locked */
+static uint32_t gb_battery_check_notify(enum gb_battery_prop prop)
+{
+    struct gb_battery_value *entry = &batt_cache.values[prop];
+    int32_t delta;
+
+    if (!entry->valid)
+        return 0;
+
+    delta = entry->value - entry->notified;
+    if (delta < 0)
+        delta = -delta;
+
+    if (entry->notified_valid &&
+        (delta == 0 || delta < batt_thresholds[prop]))
+        return 0;
+
+    entry->notified = entry->value;
+    entry->notified_valid = true;
+
+    return 1 << prop;
+}
+
+static void gb_battery_notify(uint32_t events)
+{
+    struct gb_battery_event_request *request;
+    struct gb_operation *operation;
+
+    operation = gb_operation_create(batt_cache.cport, GB_BATTERY_TYPE_EVENT,
+                                    sizeof(*request));
+    if (!operation)
+        return;
+
+    request = gb_operation_get_request_payload(operation);
+    request->events = cpu_to_le32(events);
+
+    gb_operation_send_request(operation, NULL, false);
+    gb_operation_destroy(operation);
+}
+#endif
+
+/* Refresh all the cached values, runs on the low priority work queue */
+static void gb_battery_worker(void *arg)
+{
+    uint32_t events = 0;
+    int prop;
+
+    gb_battery_cache_lock();
+
+    for (prop = 0; prop < GB_BATTERY_PROP_COUNT; prop++) {
+        gb_battery_refresh(prop);
+#ifdef CONFIG_GREYBUS_BATTERY_NOTIFY
+        events |= gb_battery_check_notify(prop);
+#endif
+    }
+
+    gb_battery_cache_unlock();
+
+#ifdef CONFIG_GREYBUS_BATTERY_NOTIFY
+    /* the first refresh only records the initial values */
+    if (events && arg == NULL)
+        gb_battery_notify(events);
+#else
+    (void)events;
+#endif
+
+    if (BATTERY_REFRESH > 0)
+        work_queue(LPWORK, &batt_cache.work, gb_battery_worker, NULL,
+                   BATTERY_REFRESH);
+}
+
+/* The gauge reported a change, possibly from interrupt context */
+static void gb_battery_changed(struct device *dev, void *arg)
+{
+    work_cancel(LPWORK, &batt_cache.work);
+    work_queue(LPWORK, &batt_cache.work, gb_battery_worker, NULL, 0);
+}
+#else
+static int gb_battery_get(enum gb_battery_prop prop, int32_t *value)
+{
+    return gb_battery_read(prop, value);
+}
+#endif
+
 /**
  * @brief Get this firmware supported BATTERY protocol vsersion.
  *
@@ -104,14 +341,14 @@ static uint8_t gb_battery_technology(struct gb_operation *operation)
 static uint8_t gb_battery_status(struct gb_operation *operation)
 {
     struct gb_battery_status_response *response;
-    uint16_t status = 0;
+    int32_t status = 0;
     int ret = 0;
 
     response = gb_operation_alloc_response(operation, sizeof(*response));
     if (!response)
         return GB_OP_NO_MEMORY;
 
-    ret = device_battery_status(batt_dev, &status);
+    ret = gb_battery_get(GB_BATTERY_PROP_STATUS, &status);
 
     response->status = cpu_to_le16(status);
 
@@ -152,14 +389,14 @@ static uint8_t gb_battery_max_voltage(struct gb_operation *operation)
 static uint8_t gb_battery_percent_capacity(struct gb_operation *operation)
 {
     struct gb_battery_capacity_response *response;
-    uint32_t capacity = 0;
+    int32_t capacity = 0;
     int ret = 0;
 
     response = gb_operation_alloc_response(operation, sizeof(*response));
     if (!response)
         return GB_OP_NO_MEMORY;
 
-    ret = device_battery_percent_capacity(batt_dev, &capacity);
+    ret = gb_battery_get(GB_BATTERY_PROP_PERCENT_CAPACITY, &capacity);
 
     response->capacity = cpu_to_le32(capacity);
 
@@ -176,14 +413,14 @@ static uint8_t gb_battery_percent_capacity(struct gb_operation *operation)
 static uint8_t gb_battery_temperature(struct gb_operation *operation)
 {
     struct gb_battery_temperature_response *response;
-    int temp = 0;
+    int32_t temp = 0;
     int ret = 0;
 
     response = gb_operation_alloc_response(operation, sizeof(*response));
     if (!response)
         return GB_OP_NO_MEMORY;
 
-    ret = device_battery_temperature(batt_dev, &temp);
+    ret = gb_battery_get(GB_BATTERY_PROP_TEMPERATURE, &temp);
 
     response->temperature = cpu_to_le32(temp);
 
@@ -200,14 +437,14 @@ static uint8_t gb_battery_temperature(struct gb_operation *operation)
 static uint8_t gb_battery_voltage(struct gb_operation *operation)
 {
     struct gb_battery_voltage_response *response;
-    uint32_t voltage = 0;
+    int32_t voltage = 0;
     int ret = 0;
 
     response = gb_operation_alloc_response(operation, sizeof(*response));
     if (!response)
         return GB_OP_NO_MEMORY;
 
-    ret = device_battery_voltage(batt_dev, &voltage);
+    ret = gb_battery_get(GB_BATTERY_PROP_VOLTAGE, &voltage);
 
     response->voltage = cpu_to_le32(voltage);
 
@@ -224,14 +461,14 @@ static uint8_t gb_battery_voltage(struct gb_operation *operation)
 static uint8_t gb_battery_current(struct gb_operation *operation)
 {
     struct gb_battery_current_response *response;
-    int current = 0;
+    int32_t current = 0;
     int ret = 0;
 
     response = gb_operation_alloc_response(operation, sizeof(*response));
     if (!response)
         return GB_OP_NO_MEMORY;
 
-    ret = device_battery_current(batt_dev, &current);
+    ret = gb_battery_get(GB_BATTERY_PROP_CURRENT, &current);
 
     response->current = cpu_to_le32(current);
 
@@ -300,6 +537,18 @@ static int gb_battery_init(unsigned int cport)
         return -ENODEV;
     }
 
+#ifdef CONFIG_GREYBUS_BATTERY_CACHE
+    memset(batt_cache.values, 0, sizeof(batt_cache.values));
+    batt_cache.cport = cport;
+    sem_init(&batt_cache.lock, 0, 1);
+
+    /* not all the gauges report changes, the refresh period covers them */
+    device_battery_register_callback(batt_dev, gb_battery_changed, NULL);
+
+    /* fill the cache, recording the values the host starts from */
+    work_queue(LPWORK, &batt_cache.work, gb_battery_worker, batt_dev, 0);
+#endif
+
     return 0;
 }
 
@@ -310,6 +559,12 @@ static int gb_battery_init(unsigned int cport)
  */
 static void gb_battery_exit(unsigned int cport)
 {
+#ifdef CONFIG_GREYBUS_BATTERY_CACHE
+    device_battery_register_callback(batt_dev, NULL, NULL);
+    work_cancel(LPWORK, &batt_cache.work);
+    sem_destroy(&batt_cache.lock);
+#endif
+
     device_close(batt_dev);
     batt_dev = NULL;
 }
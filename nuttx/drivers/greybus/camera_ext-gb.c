@@ -616,6 +616,7 @@ static struct gb_driver gb_camera_driver = {
     .exit = gb_camera_ext_exit,
     .op_handlers = gb_camera_handlers,
     .op_handlers_count = ARRAY_SIZE(gb_camera_handlers),
+    .rx_priority = GB_RX_PRIORITY_HIGH,
 };
 
 void gb_camera_ext_register(int cport)
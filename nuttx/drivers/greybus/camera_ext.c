@@ -31,8 +31,25 @@
 #include <string.h>
 #include <nuttx/camera/camera_ext.h>
 
+/* Flattened lookup index over the format db, built once at registration.
+ * A format entry is keyed by (input node, fourcc), a frame size entry by
+ * (format node, width, height). Open addressing, parent == NULL is empty.
+ */
+struct camera_ext_fmt_index_entry {
+    const void *parent;
+    uint32_t a;
+    uint32_t b;
+    int index;
+};
+
+struct camera_ext_fmt_index {
+    size_t mask;
+    struct camera_ext_fmt_index_entry *entries;
+};
+
 struct camera_ext_db {
     const struct camera_ext_format_db *format_db;
+    struct camera_ext_fmt_index fmt_index;
     struct camera_ext_format_user_config user_cfg;
     struct camera_ext_ctrl_db *ctrl_db;
 };
@@ -99,12 +116,109 @@ int camera_ext_send_error(uint32_t err)
     return s_event_cb(s_dev, CAMERA_EXT_REPORT_ERROR, (uint8_t *)&err_msg, sizeof(err_msg));
 }
 
+static size_t fmt_index_hash(const void *parent, uint32_t a, uint32_t b)
+{
+    uint32_t h = (uint32_t)(uintptr_t)parent;
+
+    h = (h ^ a) * 0x9e3779b1;
+    h = (h ^ b) * 0x85ebca6b;
+    return h ^ (h >> 16);
+}
+
+static void fmt_index_insert(struct camera_ext_fmt_index *fi,
+    const void *parent, uint32_t a, uint32_t b, int index)
+{
+    size_t slot = fmt_index_hash(parent, a, b) & fi->mask;
+
+    while (fi->entries[slot].parent != NULL) {
+        /* keep the first match so the index agrees with a linear scan */
+        if (fi->entries[slot].parent == parent &&
+            fi->entries[slot].a == a && fi->entries[slot].b == b)
+            return;
+        slot = (slot + 1) & fi->mask;
+    }
+
+    fi->entries[slot].parent = parent;
+    fi->entries[slot].a = a;
+    fi->entries[slot].b = b;
+    fi->entries[slot].index = index;
+}
+
+/* return the index of the key, -1 not found, -2 no index available */
+static int fmt_index_find(const struct camera_ext_fmt_index *fi,
+    const void *parent, uint32_t a, uint32_t b)
+{
+    size_t slot;
+
+    if (fi->entries == NULL)
+        return -2;
+
+    slot = fmt_index_hash(parent, a, b) & fi->mask;
+    while (fi->entries[slot].parent != NULL) {
+        if (fi->entries[slot].parent == parent &&
+            fi->entries[slot].a == a && fi->entries[slot].b == b)
+            return fi->entries[slot].index;
+        slot = (slot + 1) & fi->mask;
+    }
+
+    return -1;
+}
+
+static void fmt_index_build(struct camera_ext_fmt_index *fi,
+    const struct camera_ext_format_db *db)
+{
+    int i, j, k;
+    size_t count = 0;
+    size_t size = 4;
+    struct camera_ext_input_node const *input_node;
+    struct camera_ext_format_node const *format_node;
+    struct camera_ext_frmsize_node const *frmsize_node;
+
+    free(fi->entries);
+    fi->entries = NULL;
+
+    for (i = 0; i < db->num_inputs; i++) {
+        input_node = &db->input_nodes[i];
+        count += input_node->num_formats;
+        for (j = 0; j < input_node->num_formats; j++)
+            count += input_node->format_nodes[j].num_frmsizes;
+    }
+
+    /* keep the load factor at or below 1/2 */
+    while (size < count * 2)
+        size <<= 1;
+
+    fi->entries = calloc(size, sizeof(*fi->entries));
+    if (fi->entries == NULL) {
+        /* lookups fall back to the linear scan */
+        CAM_ERR("no memory for format index\n");
+        return;
+    }
+    fi->mask = size - 1;
+
+    for (i = 0; i < db->num_inputs; i++) {
+        input_node = &db->input_nodes[i];
+        for (j = 0; j < input_node->num_formats; j++) {
+            format_node = &input_node->format_nodes[j];
+            fmt_index_insert(fi, input_node, format_node->fourcc, 0, j);
+            for (k = 0; k < format_node->num_frmsizes; k++) {
+                frmsize_node = &format_node->frmsize_nodes[k];
+                fmt_index_insert(fi, format_node, frmsize_node->width,
+                                 frmsize_node->height, k);
+            }
+        }
+    }
+
+    CAM_DBG("format index: %zu entries in %zu slots\n", count, size);
+}
+
 void camera_ext_register_format_db(const struct camera_ext_format_db *db)
 {
     if (db == NULL)
         return;
 
     g_camera_ext_db.format_db = db;
+    fmt_index_build(&g_camera_ext_db.fmt_index, db);
 }
 
 const struct camera_ext_format_db *camera_ext_get_format_db(void)
@@ -138,6 +252,11 @@ static int find_format_node(struct camera_ext_input_node const *input_node,
     int index;
     struct camera_ext_format_node const *format_node;
 
+    index = fmt_index_find(&g_camera_ext_db.fmt_index, input_node,
+                           le32_to_cpu(pixelformat), 0);
+    if (index != -2)
+        return index;
+
     for (index = 0; index < input_node->num_formats; index++) {
         format_node = &input_node->format_nodes[index];
         if (format_node->fourcc == le32_to_cpu(pixelformat)) {
@@ -158,6 +277,11 @@ static int find_frmsize_node(struct camera_ext_format_node const *format_node,
     int index;
     struct camera_ext_frmsize_node const *frmsize_node;
 
+    index = fmt_index_find(&g_camera_ext_db.fmt_index, format_node,
+                           le32_to_cpu(width), le32_to_cpu(height));
+    if (index != -2)
+        return index;
+
     for (index = 0; index < format_node->num_frmsizes; index++) {
         frmsize_node = &format_node->frmsize_nodes[index];
         if (frmsize_node->width == le32_to_cpu(width)
@@ -42,6 +42,24 @@
 #define METADATA_MAX_IDLE_TIME_MS 5000LL
 #define META_PAYLOAD_LENGTH 1024
 
+/* one frame of metadata, see populate_metadata_frame() for the maximum size */
+#define META_FRAME_LENGTH 256
+
+/* how long a partial batch waits for more frames before it is sent */
+#define METADATA_BATCH_WAIT_MS 50LL
+
+#ifdef CONFIG_GREYBUS_CAMERA_EXT_META_RING
+#define META_RING_FRAMES CONFIG_GREYBUS_CAMERA_EXT_META_RING
+#else
+#define META_RING_FRAMES 4
+#endif
+
+#ifdef CONFIG_GREYBUS_CAMERA_EXT_META_BATCH
+#define META_BATCH_FRAMES CONFIG_GREYBUS_CAMERA_EXT_META_BATCH
+#else
+#define META_BATCH_FRAMES 1
+#endif
+
 /*
 ================================================================================
 * Byte Order:
@@ -307,11 +325,26 @@ typedef struct cam_metadata {
     cam_metadata_focus_distance_t focusdistance;
 } cam_metadata_t;
 
+/* metadata of the frames not sent yet, allocated at stream on */
+struct meta_frame {
+    uint16_t length;
+    uint8_t data[META_FRAME_LENGTH];
+};
+
+struct meta_ring {
+    struct meta_frame *frames;
+    unsigned int head; /* oldest frame */
+    unsigned int count;
+    uint32_t sent;
+    uint32_t dropped;
+};
+
 static sem_t sem;
 
 static uint8_t meta[META_PAYLOAD_LENGTH];
 static cam_metadata_t metadata_value;
 static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct meta_ring ring;
 
 /* this empty_meta buffer will read by meta task */
 static uint8_t empty_meta[META_PAYLOAD_LENGTH];
@@ -641,17 +674,15 @@ static uint16_t populate_metadata_focusdistance(uint8_t *point, uint16_t tag)
     return offset;
 }
 
-static void populate_metadata_stream(void)
+/* Serialize and clear the current metadata values, called with mutex held */
+static uint16_t populate_metadata_frame(uint8_t *frame)
 {
     uint8_t *pos;
     uint16_t payload_length;
 
-    memset(meta, 0, META_PAYLOAD_LENGTH);
-    meta[0] = 0xaa;
-    meta[1] = 0x01;
-    pos = meta + METADATA_HEADER;
-
-    pthread_mutex_lock(&mutex);
+    frame[0] = 0xaa;
+    frame[1] = 0x01;
+    pos = frame + METADATA_HEADER;
 
     payload_length = populate_metadata_autofocus(pos, 0);
     pos += payload_length;
@@ -669,40 +700,103 @@ static void populate_metadata_stream(void)
     pos += payload_length;
 
     // With current structure of cam_metadata, the payload size will be 246 in maxium case.
-    // will not exceed the 1024 size.
+    // will not exceed META_FRAME_LENGTH.
 
-    uint16_t total_length = (uint16_t)(pos - meta);
-    memcpy((uint16_t *)(meta + sizeof(uint16_t)), &total_length, sizeof(uint16_t));
+    uint16_t total_length = (uint16_t)(pos - frame);
+    memcpy((uint16_t *)(frame + sizeof(uint16_t)), &total_length, sizeof(uint16_t));
     memset(&metadata_value, 0, sizeof(metadata_value));
+
+    return total_length;
+}
+
+static void populate_metadata_stream(void)
+{
+    memset(meta, 0, META_PAYLOAD_LENGTH);
+
+    pthread_mutex_lock(&mutex);
+    populate_metadata_frame(meta);
     pthread_mutex_unlock(&mutex);
 }
 
+/*
+ * Pack up to META_BATCH_FRAMES queued frames back to back into meta, each
+ * with its own line header.  Called with mutex held, returns the number of
+ * frames packed.
+ */
+static unsigned int pack_metadata_frames(void)
+{
+    struct meta_frame *frame;
+    unsigned int packed = 0;
+    size_t offset = 0;
+
+    memset(meta, 0, META_PAYLOAD_LENGTH);
+
+    while (ring.count && packed < META_BATCH_FRAMES) {
+        frame = &ring.frames[ring.head];
+        if (offset + frame->length > META_PAYLOAD_LENGTH)
+            break;
+
+        memcpy(meta + offset, frame->data, frame->length);
+        offset += frame->length;
+        packed++;
+
+        ring.head = (ring.head + 1) % META_RING_FRAMES;
+        ring.count--;
+    }
+
+    return packed;
+}
+
 static void *metadata_task(void* arg)
 {
     struct timespec now_ts;
     uint64_t now_ns;
+    uint64_t wait_ms;
     struct timespec next_cp_ts;
+    unsigned int queued;
+    unsigned int packed;
+    bool timedout;
 
-    sem_init(&sem, 0, 0);
     CAM_DBG("metadata task enter\n");
     while (true) {
+        /* a partial batch only waits a little for the rest of its frames */
+        pthread_mutex_lock(&mutex);
+        queued = ring.count;
+        pthread_mutex_unlock(&mutex);
+        wait_ms = queued ? METADATA_BATCH_WAIT_MS : METADATA_MAX_IDLE_TIME_MS;
+
         clock_gettime(CLOCK_REALTIME, &now_ts);
         now_ns = timespec_to_nsec(&now_ts);
-        nsec_to_timespec(now_ns + METADATA_MAX_IDLE_TIME_MS * NSEC_PER_MSEC,
-                &next_cp_ts);
+        nsec_to_timespec(now_ns + wait_ms * NSEC_PER_MSEC, &next_cp_ts);
 
+        timedout = false;
         if (sem_timedwait(&sem, &next_cp_ts) != 0) {
             if (errno != ETIMEDOUT) {
                 CAM_ERR("sem wait errno %d\n", errno);
                 break;
-            } else {
-                camera_ext_send_metadata(empty_meta, META_PAYLOAD_LENGTH);
             }
-        } else if (task_running) {
-            populate_metadata_stream();
-            camera_ext_send_metadata(meta, META_PAYLOAD_LENGTH);
-        } else
+            timedout = true;
+        }
+
+        if (!task_running)
             break;
+
+        pthread_mutex_lock(&mutex);
+        if (ring.count >= META_BATCH_FRAMES || (timedout && ring.count))
+            packed = pack_metadata_frames();
+        else
+            packed = 0;
+        pthread_mutex_unlock(&mutex);
+
+        if (packed) {
+            if (camera_ext_send_metadata(meta, META_PAYLOAD_LENGTH) == 0) {
+                pthread_mutex_lock(&mutex);
+                ring.sent += packed;
+                pthread_mutex_unlock(&mutex);
+            }
+        } else if (timedout) {
+            camera_ext_send_metadata(empty_meta, META_PAYLOAD_LENGTH);
+        }
     }
     CAM_DBG("metadata task exit\n");
 
@@ -742,10 +836,30 @@ int start_metadata_task(void)
         return 0; /* re-use */
     }
 
+    /* pre-allocate the frames so the per frame path never allocates */
+    pthread_mutex_lock(&mutex);
+    ring.frames = zalloc(META_RING_FRAMES * sizeof(*ring.frames));
+    ring.head = 0;
+    ring.count = 0;
+    ring.sent = 0;
+    ring.dropped = 0;
+    pthread_mutex_unlock(&mutex);
+    if (ring.frames == NULL) {
+        CAM_ERR("Failed to allocate metadata ring\n");
+        pthread_mutex_unlock(&task_mutex);
+        return -ENOMEM;
+    }
+
+    sem_init(&sem, 0, 0);
     task_running = true; /* metadata_task loop condition */
     if (pthread_create(&thread, NULL, &metadata_task, NULL) != 0) {
         CAM_ERR("Failed to start metadata thread\n");
         task_running = false;
+        sem_destroy(&sem);
+        pthread_mutex_lock(&mutex);
+        free(ring.frames);
+        ring.frames = NULL;
+        pthread_mutex_unlock(&mutex);
         pthread_mutex_unlock(&task_mutex);
         return -1;
     }
@@ -757,13 +871,57 @@ int start_metadata_task(void)
 void stop_metadata_task(void)
 {
     pthread_mutex_lock(&task_mutex);
+    if (!task_running) {
+        pthread_mutex_unlock(&task_mutex);
+        return;
+    }
+
     task_running = false; /* meta task loop condition */
     sem_post(&sem);
     pthread_join(thread, NULL);
+
+    pthread_mutex_lock(&mutex);
+    CAM_DBG("metadata frames sent %u dropped %u\n", ring.sent, ring.dropped);
+    free(ring.frames);
+    ring.frames = NULL;
+    ring.count = 0;
+    pthread_mutex_unlock(&mutex);
+
+    sem_destroy(&sem);
     pthread_mutex_unlock(&task_mutex);
 }
 
+/*
+ * Snapshot the metadata set for this frame into the ring.  When the host
+ * falls behind and the ring is full the oldest frame is dropped.
+ */
 void send_metadata_oneshot(void)
 {
+    struct meta_frame *frame;
+
+    pthread_mutex_lock(&mutex);
+    if (ring.frames == NULL) {
+        pthread_mutex_unlock(&mutex);
+        return;
+    }
+
+    if (ring.count == META_RING_FRAMES) {
+        ring.head = (ring.head + 1) % META_RING_FRAMES;
+        ring.count--;
+        ring.dropped++;
+    }
+
+    frame = &ring.frames[(ring.head + ring.count) % META_RING_FRAMES];
+    frame->length = populate_metadata_frame(frame->data);
+    ring.count++;
     sem_post(&sem);
+    pthread_mutex_unlock(&mutex);
+}
+
+void get_metadata_stats(uint32_t *sent, uint32_t *dropped)
+{
+    pthread_mutex_lock(&mutex);
+    *sent = ring.sent;
+    *dropped = ring.dropped;
+    pthread_mutex_unlock(&mutex);
 }
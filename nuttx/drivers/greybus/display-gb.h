@@ -40,9 +40,10 @@
 #define GB_MODS_DISPLAY_TYPE_GET_STATE                0x06
 #define GB_MODS_DISPLAY_TYPE_SET_STATE                0x07
 #define GB_MODS_DISPLAY_TYPE_NOTIFICATION             0x08
+#define GB_MODS_DISPLAY_TYPE_SET_PARTIAL              0x09
 
 #define GB_MODS_DISPLAY_VERSION_MAJOR              0
-#define GB_MODS_DISPLAY_VERSION_MINOR              3
+#define GB_MODS_DISPLAY_VERSION_MINOR              4
 
 #define GB_MODS_DISPLAY_DISPLAY_TYPE_INVALID          0x00
 #define GB_MODS_DISPLAY_DISPLAY_TYPE_DSI              0x01
@@ -86,6 +87,13 @@
 #define GB_MODS_DISPLAY_SUPPORT_STATE_BLANKING_MAJOR 0
 #define GB_MODS_DISPLAY_SUPPORT_STATE_BLANKING_MINOR 3
 
+/**
+ * New in version 0.4
+ *   added GB_MODS_DISPLAY_TYPE_SET_PARTIAL for damage rectangle updates
+ */
+#define GB_MODS_DISPLAY_SUPPORT_SET_PARTIAL_MAJOR 0
+#define GB_MODS_DISPLAY_SUPPORT_SET_PARTIAL_MINOR 4
+
 /**
  * Greybus Display Protocol Version Request
  */
@@ -143,6 +151,17 @@ struct gb_mods_display_get_display_state_response {
     __u8 state;
 } __packed;
 
+/**
+ * Greybus Display Set Partial Update Region
+ */
+
+struct gb_mods_display_set_partial_request {
+    __le16 x;
+    __le16 y;
+    __le16 width;
+    __le16 height;
+} __packed;
+
 /**
  * Greybus Display Notification
  */
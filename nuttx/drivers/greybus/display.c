@@ -314,6 +314,44 @@ static uint8_t gb_mods_display_set_state(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
+/**
+ * @brief Restrict the following frames to a damage rectangle
+ *
+ * @param operation Pointer to structure of gb_operation.
+ * @return GB_OP_SUCCESS on success, error code on failure
+ */
+static uint8_t gb_mods_display_set_partial(struct gb_operation *operation)
+{
+    struct gb_mods_display_set_partial_request *request;
+    struct display_rect rect;
+    int ret;
+
+    if (gb_operation_get_request_payload_size(operation) < sizeof(*request)) {
+        gb_error("%s(): dropping short message\n", __func__);
+        return GB_OP_INVALID;
+    }
+
+    if (!GB_MODS_DISPLAY_SUPPORTS(SET_PARTIAL)) {
+        gb_error("%s(): partial update NOT supported\n", __func__);
+        return GB_OP_INVALID;
+    }
+
+    request = gb_operation_get_request_payload(operation);
+
+    rect.x = le16_to_cpu(request->x);
+    rect.y = le16_to_cpu(request->y);
+    rect.width = le16_to_cpu(request->width);
+    rect.height = le16_to_cpu(request->height);
+
+    ret = device_display_set_partial(display_info->dev, &rect);
+    if (ret == -EINVAL || ret == -ENOSYS || ret == -EOPNOTSUPP)
+        return GB_OP_INVALID;
+    else if (ret)
+        return GB_OP_UNKNOWN_ERROR;
+
+    return GB_OP_SUCCESS;
+}
+
 /**
  * @brief Send notification of state change
  *
@@ -427,6 +465,7 @@ static struct gb_operation_handler gb_mods_display_handlers[] = {
     GB_HANDLER(GB_MODS_DISPLAY_TYPE_SET_CONFIG, gb_mods_display_set_config),
     GB_HANDLER(GB_MODS_DISPLAY_TYPE_SET_STATE, gb_mods_display_set_state),
     GB_HANDLER(GB_MODS_DISPLAY_TYPE_GET_STATE, gb_mods_display_get_state),
+    GB_HANDLER(GB_MODS_DISPLAY_TYPE_SET_PARTIAL, gb_mods_display_set_partial),
 };
 
 static struct gb_driver gb_mods_display_driver = {
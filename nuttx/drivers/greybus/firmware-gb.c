@@ -28,6 +28,7 @@
  */
 
 #include <errno.h>
+#include <semaphore.h>
 #include <string.h>
 #include <stdlib.h>
 #include <nuttx/arch.h>
@@ -37,9 +38,14 @@
 #include <nuttx/progmem.h>
 #include <nuttx/greybus/debug.h>
 #include <nuttx/greybus/greybus.h>
+#include <nuttx/greybus/firmware.h>
 #include <apps/greybus-utils/manifest.h>
 #include <nuttx/wqueue.h>
 
+#ifdef CONFIG_GREYBUS_FIRMWARE_VERIFY
+#include <nuttx/crypto/crypto.h>
+#endif
+
 #define GB_FIRMWARE_TFTF_HDR_SIZE         512
 
 /* Version of the Greybus firmware protocol we support */
@@ -67,6 +73,9 @@
 /* Max firmware data fetch size in bytes */
 #define GB_FIRMWARE_FETCH_MAX             2000
 
+/* Number of get firmware requests kept outstanding while flashing */
+#define GB_FIRMWARE_FETCH_DEPTH           CONFIG_FIRMWARE_FETCH_DEPTH
+
 /* version request has no payload */
 struct gb_firmware_proto_version_response {
     __u8      major;
@@ -183,6 +192,9 @@ struct gb_firmware_info {
     uint32_t firmware_size;
     struct work_s flash_work;
     struct work_s reset_work;
+#ifdef CONFIG_GREYBUS_FIRMWARE_VERIFY
+    struct sha256_ctx_s sha256; /* digest of the image being flashed */
+#endif
 };
 
 static struct gb_firmware_info *g_firmware_info = NULL;
@@ -313,24 +325,19 @@ static int gb_firmware_flash_chunk(size_t flash_address, uint8_t *data, size_t s
     return (int)err;
 }
 
-static int gb_firmware_get_header(
-        size_t firmware_size,
-        struct gb_firmware_tftf_header *hdr)
+/* synchronously read size bytes of the image at offset into buf */
+static int gb_firmware_read(uint32_t offset, void *buf, size_t size)
 {
     struct gb_operation *operation;
+    struct gb_operation *response_op;
     struct gb_firmware_get_firmware_request *request;
     struct gb_firmware_get_firmware_response *response;
-    int ret = -ENOENT;
-
-    if (firmware_size < GB_FIRMWARE_TFTF_HDR_SIZE)
-        goto out;
+    int ret;
 
     operation = gb_operation_create(g_firmware_info->cport,
             GB_FIRMWARE_TYPE_GET_FIRMWARE, sizeof(*request));
-    if (!operation) {
-        ret = -ENOMEM;
-        goto out;
-    }
+    if (!operation)
+        return -ENOMEM;
 
     request = (struct gb_firmware_get_firmware_request *)
     gb_operation_get_request_payload(operation);
@@ -339,8 +346,8 @@ static int gb_firmware_get_header(
         goto cleanup;
     }
 
-    request->offset = 0;
-    request->size = GB_FIRMWARE_TFTF_HDR_SIZE;
+    request->offset = cpu_to_le32(offset);
+    request->size = cpu_to_le32(size);
 
     ret = gb_operation_send_request_sync(operation);
     if (ret != GB_OP_SUCCESS) {
@@ -349,39 +356,274 @@ static int gb_firmware_get_header(
         goto cleanup;
     }
 
-    if (!operation->response) {
+    response_op = gb_operation_get_response_op(operation);
+    if (!response_op ||
+        gb_operation_get_request_payload_size(response_op) < size) {
         gb_error("No firmware received\n");
-        gb_operation_destroy(operation);
         ret = -EIO;
         goto cleanup;
     }
 
-    response = gb_operation_get_request_payload(operation->response);
-
-    if (!memcmp(response->data, "TFTF", 4)) {
-        memcpy(hdr, response->data, sizeof(*hdr));
-        dump_header(hdr);
-        ret = 0;
-    } else
-        ret = -ENOENT;
+    response = gb_operation_get_request_payload(response_op);
+    memcpy(buf, response->data, size);
+    ret = 0;
 
 cleanup:
     gb_operation_destroy(operation);
-out:
     return ret;
 }
 
-static int gb_firmware_get_firmware(size_t size)
+static int gb_firmware_get_header(
+        size_t firmware_size,
+        struct gb_firmware_tftf_header *hdr)
 {
+    int ret;
+
+    if (firmware_size < GB_FIRMWARE_TFTF_HDR_SIZE)
+        return -ENOENT;
+
+    ret = gb_firmware_read(0, hdr, sizeof(*hdr));
+    if (ret)
+        return ret;
+
+    if (memcmp(hdr->sentinel_value, "TFTF", 4))
+        return -ENOENT;
+
+    dump_header(hdr);
+    return 0;
+}
+
+/* A chunk requested from the AP and not flashed yet */
+struct gb_firmware_fetch {
     struct gb_operation *operation;
+    uint32_t write_offset;
+    uint32_t size;
+};
+
+static void gb_firmware_fetch_callback(struct gb_operation *operation)
+{
+    sem_post(&operation->sync_sem);
+}
+
+static int gb_firmware_fetch_send(struct gb_firmware_fetch *fetch,
+                                  uint32_t offset, uint32_t size)
+{
     struct gb_firmware_get_firmware_request *request;
+    int ret;
+
+    fetch->operation = gb_operation_create(g_firmware_info->cport,
+            GB_FIRMWARE_TYPE_GET_FIRMWARE, sizeof(*request));
+    if (!fetch->operation)
+        return -ENOMEM;
+
+    request = gb_operation_get_request_payload(fetch->operation);
+    request->offset = cpu_to_le32(offset);
+    request->size = cpu_to_le32(size);
+
+    sem_init(&fetch->operation->sync_sem, 0, 0);
+
+    ret = gb_operation_send_request(fetch->operation,
+                                    gb_firmware_fetch_callback, true);
+    if (ret) {
+        gb_error("failed to send firmware request\n");
+        gb_operation_destroy(fetch->operation);
+        return -EIO;
+    }
+
+    return 0;
+}
+
+/* wait for the chunk to be received, or for the request to time out */
+static int gb_firmware_fetch_wait(struct gb_firmware_fetch *fetch)
+{
+    struct gb_operation *response_op;
+    int ret;
+
+    do {
+        ret = sem_wait(&fetch->operation->sync_sem);
+    } while (ret < 0 && errno == EINTR);
+
+    response_op = gb_operation_get_response_op(fetch->operation);
+    if (!response_op ||
+        gb_operation_get_response_result(fetch->operation) != GB_OP_SUCCESS) {
+        gb_error("No firmware received\n");
+        return -EIO;
+    }
+
+    if (gb_operation_get_request_payload_size(response_op) < fetch->size) {
+        gb_error("short firmware chunk\n");
+        return -EIO;
+    }
+
+    return 0;
+}
+
+/*
+ * Download and flash a firmware image. Up to GB_FIRMWARE_FETCH_DEPTH chunks
+ * are requested ahead, so that the next chunks are transferred over the link
+ * while the current one is being programmed. Chunks are flashed in order as
+ * their responses come in.
+ */
+static int gb_firmware_fetch_and_flash(uint32_t fetch_offset,
+                                       uint32_t write_offset,
+                                       ssize_t remaining)
+{
+    struct gb_firmware_fetch fetches[GB_FIRMWARE_FETCH_DEPTH];
     struct gb_firmware_get_firmware_response *response;
+    struct gb_firmware_fetch *fetch;
+    unsigned int head = 0;
+    unsigned int count = 0;
+    uint32_t size;
+    int ret = 0;
+    int err;
+
+    while (count > 0 || (!ret && remaining > 0)) {
+        /* keep the request window full before waiting on the oldest one */
+        while (!ret && remaining > 0 && count < GB_FIRMWARE_FETCH_DEPTH) {
+            fetch = &fetches[(head + count) % GB_FIRMWARE_FETCH_DEPTH];
+            size = MIN(g_firmware_info->chunk_size, remaining);
+
+            ret = gb_firmware_fetch_send(fetch, fetch_offset, size);
+            if (ret)
+                break;
+
+            fetch->write_offset = write_offset;
+            fetch->size = size;
+            fetch_offset += size;
+            write_offset += size;
+            remaining -= size;
+            count++;
+        }
+
+        if (!count)
+            break;
+
+        /* on error, just drain the requests still in flight */
+        fetch = &fetches[head];
+        err = gb_firmware_fetch_wait(fetch);
+        if (!err && !ret) {
+            response = gb_operation_get_request_payload(
+                    gb_operation_get_response_op(fetch->operation));
+#ifdef CONFIG_GREYBUS_FIRMWARE_VERIFY
+            /* hash the chunk while it is at hand, rather than reading the
+             * whole image back from flash afterwards */
+            sha256_update(&g_firmware_info->sha256, response->data,
+                          fetch->size);
+#endif
+            err = gb_firmware_flash_chunk(fetch->write_offset, response->data,
+                                          fetch->size);
+            if (err) {
+                /* well this isn't good!  what can we really do */
+                gb_error("FLASHING FAILED!!!\n")
+            }
+            gb_debug("remaining bytes = %d\n", remaining);
+        }
+        if (!ret)
+            ret = err;
+
+        gb_operation_destroy(fetch->operation);
+        head = (head + 1) % GB_FIRMWARE_FETCH_DEPTH;
+        count--;
+    }
+
+    return ret;
+}
+
+#ifdef CONFIG_GREYBUS_FIRMWARE_VERIFY
+/* default: no key to check signatures with, see nuttx/greybus/firmware.h */
+int weak_function gb_firmware_verify_signature(const uint8_t *digest,
+                                               const uint8_t *sig,
+                                               size_t siglen)
+{
+    return -ENOSYS;
+}
+
+/*
+ * Fetch the signature section before anything is erased, so that an image
+ * with a missing or malformed signature is refused up front.
+ */
+static int gb_firmware_get_signature(uint32_t offset, uint32_t length,
+                                     uint8_t **sig)
+{
+    int ret;
+
+    *sig = NULL;
+
+    if (!length) {
+#ifdef CONFIG_GREYBUS_FIRMWARE_REQUIRE_SIGNATURE
+        gb_error("image is not signed\n");
+        return -EPERM;
+#else
+        return 0;
+#endif
+    }
+
+    if (length < sizeof(struct tftf_signature) ||
+        length > GB_FIRMWARE_FETCH_MAX) {
+        gb_error("invalid signature section size %u\n", length);
+        return -EINVAL;
+    }
+
+    *sig = malloc(length);
+    if (!*sig)
+        return -ENOMEM;
+
+    ret = gb_firmware_read(offset, *sig, length);
+    if (ret) {
+        free(*sig);
+        *sig = NULL;
+    }
+
+    return ret;
+}
+
+/* check the digest computed while flashing against the signature */
+static int gb_firmware_check_signature(const uint8_t *sig, size_t siglen,
+                                       uint8_t *status)
+{
+    uint8_t digest[GB_FIRMWARE_DIGEST_SIZE];
+    int ret;
+
+    sha256_final(&g_firmware_info->sha256, digest);
+
+    if (!sig) {
+        *status = GB_FIRMWARE_BOOT_STATUS_INSECURE;
+        return 0;
+    }
+
+    ret = gb_firmware_verify_signature(digest, sig, siglen);
+    if (!ret) {
+        *status = GB_FIRMWARE_BOOT_STATUS_SECURE;
+        return 0;
+    }
+
+#ifndef CONFIG_GREYBUS_FIRMWARE_REQUIRE_SIGNATURE
+    if (ret == -ENOSYS) {
+        *status = GB_FIRMWARE_BOOT_STATUS_INSECURE;
+        return 0;
+    }
+#endif
+
+    gb_error("signature verification failed: %d\n", ret);
+    return ret;
+}
+#endif
+
+static int gb_firmware_get_firmware(size_t size, uint8_t *status)
+{
     ssize_t remaining;
     uint32_t fetch_offset;
     uint32_t write_offset;
     struct gb_firmware_tftf_header *hdr;
+#ifdef CONFIG_GREYBUS_FIRMWARE_VERIFY
+    uint32_t sig_offset = 0;
+    uint32_t sig_length = 0;
+    uint8_t *sig = NULL;
+#endif
     int ret;
 
+    *status = GB_FIRMWARE_BOOT_STATUS_SECURE;
+
     hdr = zalloc(sizeof(*hdr));
     if (!hdr) {
         gb_error("Failed to allocate memory for header\n");
@@ -393,9 +635,7 @@ static int gb_firmware_get_firmware(size_t size)
         /* Header found */
         int section;
         bool found_code_section = false;
-
-        fetch_offset = hdr->header_size;
-        remaining = size - fetch_offset;
+        uint32_t section_offset = hdr->header_size;
 
         /* Use the load address from the header if it is available          */
         for (section = 0; section < TFTF_NUM_SECTIONS; section++) {
@@ -403,14 +643,24 @@ static int gb_firmware_get_firmware(size_t size)
 
             if (section_type == TFTF_SECTION_TYPE_END) {
                 break;
-            } else if (section_type == TFTF_SECTION_TYPE_RAW_CODE) {
+            } else if (section_type == TFTF_SECTION_TYPE_RAW_CODE &&
+                       !found_code_section) {
+                fetch_offset = section_offset;
                 write_offset = hdr->desc[section].section_load_address;
                 remaining = hdr->desc[section].section_length;
                 found_code_section = true;
+#ifndef CONFIG_GREYBUS_FIRMWARE_VERIFY
                 break;
-            } else {
-                fetch_offset += hdr->desc[section].section_length;
+#endif
+            }
+#ifdef CONFIG_GREYBUS_FIRMWARE_VERIFY
+            else if (section_type == TFTF_SECTION_TYPE_SIGNATURE &&
+                     !sig_length) {
+                sig_offset = section_offset;
+                sig_length = hdr->desc[section].section_length;
             }
+#endif
+            section_offset += hdr->desc[section].section_length;
         }
 
         if (!found_code_section) {
@@ -425,6 +675,17 @@ static int gb_firmware_get_firmware(size_t size)
     } else
         goto out;
 
+#ifdef CONFIG_GREYBUS_FIRMWARE_VERIFY
+    ret = gb_firmware_get_signature(sig_offset, sig_length, &sig);
+    if (ret)
+        goto out;
+
+    /* the digest covers the TFTF header, if any, and the code section */
+    sha256_init(&g_firmware_info->sha256);
+    if (!memcmp(hdr->sentinel_value, "TFTF", 4))
+        sha256_update(&g_firmware_info->sha256, hdr, sizeof(*hdr));
+#endif
+
     ret = gb_bootmode_set(BOOTMODE_FLASHING);
     if (ret) {
         gb_error("failed to write FLASHING barker\n");
@@ -436,62 +697,22 @@ static int gb_firmware_get_firmware(size_t size)
     if (ret)
         goto out;
 
-    while (remaining > 0) {
-        operation = gb_operation_create(g_firmware_info->cport,
-                GB_FIRMWARE_TYPE_GET_FIRMWARE, sizeof(*request));
-        if (!operation) {
-            ret = -ENOMEM;
-            break;
-        }
-
-        request = gb_operation_get_request_payload(operation);
-        if (!request) {
-            gb_operation_destroy(operation);
-            ret = -EIO;
-            break;
-        }
-
-        request->offset = fetch_offset;
-        request->size = MIN(g_firmware_info->chunk_size, remaining);
-
-        ret = gb_operation_send_request_sync(operation);
-        if (ret != GB_OP_SUCCESS) {
-            gb_error("failed to send firmware request\n");
-            gb_operation_destroy(operation);
-            ret = -EIO;
-            break;
-        }
-
-        if (!operation->response) {
-            gb_error("No firmware received\n");
-            gb_operation_destroy(operation);
-            ret = -EIO;
-            break;
-        }
+    ret = gb_firmware_fetch_and_flash(fetch_offset, write_offset, remaining);
 
-        response = gb_operation_get_request_payload(operation->response);
-
-        ret = gb_firmware_flash_chunk(write_offset, response->data, request->size);
-        if (ret) {
-            /* well this isn't good!  what can we really do */
-            gb_error("FLASHING FAILED!!!\n")
-            gb_operation_destroy(operation);
-            break;
-        }
-
-        fetch_offset += request->size;
-        write_offset += request->size;
-        remaining -= request->size;
-        gb_debug("remaining bytes = %d\n", remaining);
-
-        gb_operation_destroy(operation);
-    }
+#ifdef CONFIG_GREYBUS_FIRMWARE_VERIFY
+    /* a bad image stays in FLASHING mode and is not booted */
+    if (!ret)
+        ret = gb_firmware_check_signature(sig, sig_length, status);
+#endif
 
     if (!ret) {
         ret = gb_bootmode_set(BOOTMODE_NORMAL);
     }
 
 out:
+#ifdef CONFIG_GREYBUS_FIRMWARE_VERIFY
+    free(sig);
+#endif
     free(hdr);
     return ret;
 }
@@ -540,8 +761,10 @@ static int gb_firmware_ready_to_boot(uint8_t stage, uint8_t status)
 }
 
 /*
- * main flashing algorithm.  We will check the signatures on booting
- * so just send up that the everything is secure if flashing works.
+ * main flashing algorithm.  Without CONFIG_GREYBUS_FIRMWARE_VERIFY the
+ * signatures are checked on booting, so just send up that everything is
+ * secure if flashing works.  Otherwise report the weakest status of the
+ * stages flashed.
  */
 
 static void gb_firmware_worker(FAR void *arg)
@@ -549,6 +772,7 @@ static void gb_firmware_worker(FAR void *arg)
     int err;
     size_t firmware_size = 0;  /* initialize to prevent spurious warning */
     uint8_t status = GB_FIRMWARE_BOOT_STATUS_SECURE;
+    uint8_t image_status;
     uint8_t stage;
     uint8_t last_stage_attempted = GB_FIRMWARE_BOOT_STAGE_ONE;
 
@@ -567,12 +791,14 @@ static void gb_firmware_worker(FAR void *arg)
             continue;
         }
 
-        err = gb_firmware_get_firmware(firmware_size);
+        err = gb_firmware_get_firmware(firmware_size, &image_status);
         if (err) {
             gb_error("failed to get firmware\n");
             status = GB_FIRMWARE_BOOT_STATUS_INVALID;
             break;
         }
+
+        status = MIN(status, image_status);
     }
 
     /* in all cases, send up the ready to boot.  At least then
@@ -638,6 +864,7 @@ struct gb_driver firmware_driver = {
     .exit = gb_firmware_exit,
     .op_handlers = (struct gb_operation_handler*) gb_firmware_handlers,
     .op_handlers_count = ARRAY_SIZE(gb_firmware_handlers),
+    .tx_class = GB_TX_CLASS_BULK,
 };
 
 void gb_firmware_register(int cport)
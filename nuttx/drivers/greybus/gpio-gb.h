@@ -45,6 +45,11 @@
 #define GB_GPIO_TYPE_IRQ_MASK           0x0c
 #define GB_GPIO_TYPE_IRQ_UNMASK         0x0d
 #define GB_GPIO_TYPE_IRQ_EVENT          0x0e
+#define GB_GPIO_TYPE_GET_VALUES         0x0f
+#define GB_GPIO_TYPE_SET_VALUES         0x10
+#define GB_GPIO_TYPE_SET_DIRECTIONS     0x11
+#define GB_GPIO_TYPE_IRQ_COALESCE       0x12
+#define GB_GPIO_TYPE_IRQ_EVENTS         0x13
 #define GB_GPIO_TYPE_RESPONSE           0x80    /* OR'd with rest */
 
 
@@ -59,6 +64,8 @@
     (GB_GPIO_IRQ_TYPE_LEVEL_LOW | GB_GPIO_IRQ_TYPE_LEVEL_HIGH)
 #define GB_GPIO_IRQ_TYPE_SENSE_MASK     0x0000000f
 
+#define GB_GPIO_IRQ_EVENTS_OVERFLOW     0x01
+
 /* version request has no payload */
 struct gb_gpio_proto_version_response {
 	__u8	major;
@@ -139,5 +146,58 @@ struct gb_gpio_irq_event_request {
 };
 /* irq event has no response */
 
+/*
+ * Multi-line operations work on up to 32 consecutive lines starting at
+ * 'base', bit n of the masks and values being line base + n.
+ */
+struct gb_gpio_get_values_request {
+	__u8	base;
+	__le32	mask;
+} __packed;
+struct gb_gpio_get_values_response {
+	__le32	values;
+} __packed;
+
+struct gb_gpio_set_values_request {
+	__u8	base;
+	__le32	mask;
+	__le32	values;
+} __packed;
+/* set values response has no payload */
+
+/* lines set in 'out' become outputs driven to 'values', the others inputs */
+struct gb_gpio_set_directions_request {
+	__u8	base;
+	__le32	mask;
+	__le32	out;
+	__le32	values;
+} __packed;
+/* set directions response has no payload */
+
+/*
+ * Report the IRQ events through coalesced irq events requests, gathering
+ * the events occurring up to 'usec' after the first one. Edge triggered
+ * lines are no longer masked after each event. Sending a request with
+ * 'enable' cleared goes back to one irq event request per interrupt.
+ */
+struct gb_gpio_irq_coalesce_request {
+	__u8	enable;
+	__le16	usec;
+} __packed;
+/* irq coalesce response has no payload */
+
+struct gb_gpio_irq_edge {
+	__u8	which;
+	__u8	value;
+	__le64	timestamp;	/* nanoseconds, monotonic clock */
+} __packed;
+
+struct gb_gpio_irq_events_request {
+	__u8	count;
+	__u8	flags;
+	struct gb_gpio_irq_edge	edges[];
+} __packed;
+/* irq events has no response */
+
 #endif /* __GPIO_GB_H__ */
 
@@ -28,18 +28,53 @@
  * Author: Fabien Parent <fparent@baylibre.com>
  */
 
+#include <errno.h>
+
 #include <nuttx/greybus/greybus.h>
 #include <nuttx/greybus/debug.h>
 #include "gpio-gb.h"
 
 #include <arch/byteorder.h>
+#include <nuttx/arch.h>
 #include <nuttx/gpio.h>
 
+#ifdef CONFIG_GREYBUS_GPIO_IRQ_COALESCE
+#include <arch/irq.h>
+#include <nuttx/clock.h>
+#include <nuttx/wqueue.h>
+#include <time.h>
+#endif
+
 #define GB_GPIO_VERSION_MAJOR 0
 #define GB_GPIO_VERSION_MINOR 1
 
+#define GB_GPIO_BULK_LINES  32
+
 static int g_gpio_cport;
 
+#ifdef CONFIG_GREYBUS_GPIO_IRQ_COALESCE
+#define GB_GPIO_IRQ_EVENTS  CONFIG_GREYBUS_GPIO_IRQ_EVENTS
+#define GB_GPIO_MAX_LINES   256
+
+struct gb_gpio_irq_coalesce {
+    struct work_s work;
+    bool enabled;
+    uint32_t delay;
+    uint8_t flags;
+    uint8_t head;
+    uint8_t count;
+    struct {
+        uint8_t which;
+        uint8_t value;
+        uint64_t timestamp;
+    } edges[GB_GPIO_IRQ_EVENTS];
+    /* lines whose IRQ are level triggered */
+    uint32_t level[GB_GPIO_MAX_LINES / 32];
+};
+
+static struct gb_gpio_irq_coalesce g_gpio_coalesce;
+#endif
+
 static uint8_t gb_gpio_protocol_version(struct gb_operation *operation)
 {
     struct gb_gpio_proto_version_response *response;
@@ -161,6 +196,25 @@ static uint8_t gb_gpio_direction_out(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
+/*
+ * Lines behind a bus can not be accessed from interrupt context, such
+ * requests are left to the CPort worker.
+ */
+static bool gb_gpio_must_defer(uint8_t base, uint32_t mask)
+{
+    int i;
+
+    if (!up_interrupt_context())
+        return false;
+
+    for (i = 0; i < GB_GPIO_BULK_LINES; i++) {
+        if ((mask & (1u << i)) && gpio_can_sleep(base + i))
+            return true;
+    }
+
+    return false;
+}
+
 static uint8_t gb_gpio_get_value(struct gb_operation *operation)
 {
     struct gb_gpio_get_value_response *response;
@@ -175,6 +229,9 @@ static uint8_t gb_gpio_get_value(struct gb_operation *operation)
     if (request->which >= gpio_line_count())
         return GB_OP_INVALID;
 
+    if (gb_gpio_must_defer(request->which, 1))
+        return GB_OP_RX_DEFER;
+
     response = gb_operation_alloc_response(operation, sizeof(*response));
     if (!response)
         return GB_OP_NO_MEMORY;
@@ -196,6 +253,9 @@ static uint8_t gb_gpio_set_value(struct gb_operation *operation)
     if (request->which >= gpio_line_count())
         return GB_OP_INVALID;
 
+    if (gb_gpio_must_defer(request->which, 1))
+        return GB_OP_RX_DEFER;
+
     gpio_set_value(request->which, request->value);
     return GB_OP_SUCCESS;
 }
@@ -255,11 +315,251 @@ static uint8_t gb_gpio_irq_unmask(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
+static int gb_gpio_check_lines(uint8_t base, uint32_t mask)
+{
+    unsigned int top;
+
+    if (!mask)
+        return -EINVAL;
+
+    /* highest line of the mask, counted from base */
+    top = base + 31 - __builtin_clz(mask);
+    return top < gpio_line_count() ? 0 : -EINVAL;
+}
+
+static uint8_t gb_gpio_get_values(struct gb_operation *operation)
+{
+    struct gb_gpio_get_values_response *response;
+    struct gb_gpio_get_values_request *request =
+        gb_operation_get_request_payload(operation);
+    uint32_t mask;
+    uint32_t values = 0;
+    int i;
+
+    if (gb_operation_get_request_payload_size(operation) < sizeof(*request)) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    mask = le32_to_cpu(request->mask);
+    if (gb_gpio_check_lines(request->base, mask))
+        return GB_OP_INVALID;
+
+    if (gb_gpio_must_defer(request->base, mask))
+        return GB_OP_RX_DEFER;
+
+    response = gb_operation_alloc_response(operation, sizeof(*response));
+    if (!response)
+        return GB_OP_NO_MEMORY;
+
+    for (i = 0; i < GB_GPIO_BULK_LINES; i++) {
+        if ((mask & (1u << i)) && gpio_get_value(request->base + i))
+            values |= 1u << i;
+    }
+
+    response->values = cpu_to_le32(values);
+    return GB_OP_SUCCESS;
+}
+
+static uint8_t gb_gpio_set_values(struct gb_operation *operation)
+{
+    struct gb_gpio_set_values_request *request =
+        gb_operation_get_request_payload(operation);
+    uint32_t mask;
+    uint32_t values;
+    int i;
+
+    if (gb_operation_get_request_payload_size(operation) < sizeof(*request)) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    mask = le32_to_cpu(request->mask);
+    if (gb_gpio_check_lines(request->base, mask))
+        return GB_OP_INVALID;
+
+    if (gb_gpio_must_defer(request->base, mask))
+        return GB_OP_RX_DEFER;
+
+    values = le32_to_cpu(request->values);
+    for (i = 0; i < GB_GPIO_BULK_LINES; i++) {
+        if (mask & (1u << i))
+            gpio_set_value(request->base + i, !!(values & (1u << i)));
+    }
+
+    return GB_OP_SUCCESS;
+}
+
+static uint8_t gb_gpio_set_directions(struct gb_operation *operation)
+{
+    struct gb_gpio_set_directions_request *request =
+        gb_operation_get_request_payload(operation);
+    uint32_t mask;
+    uint32_t out;
+    uint32_t values;
+    int i;
+
+    if (gb_operation_get_request_payload_size(operation) < sizeof(*request)) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    mask = le32_to_cpu(request->mask);
+    if (gb_gpio_check_lines(request->base, mask))
+        return GB_OP_INVALID;
+
+    out = le32_to_cpu(request->out);
+    values = le32_to_cpu(request->values);
+    for (i = 0; i < GB_GPIO_BULK_LINES; i++) {
+        if (!(mask & (1u << i)))
+            continue;
+
+        if (out & (1u << i))
+            gpio_direction_out(request->base + i, !!(values & (1u << i)));
+        else
+            gpio_direction_in(request->base + i);
+    }
+
+    return GB_OP_SUCCESS;
+}
+
+#ifdef CONFIG_GREYBUS_GPIO_IRQ_COALESCE
+static bool gb_gpio_irq_is_level(uint8_t which)
+{
+    return g_gpio_coalesce.level[which / 32] & (1u << (which % 32));
+}
+
+static void gb_gpio_irq_set_level(uint8_t which, bool level)
+{
+    if (level)
+        g_gpio_coalesce.level[which / 32] |= 1u << (which % 32);
+    else
+        g_gpio_coalesce.level[which / 32] &= ~(1u << (which % 32));
+}
+
+/**
+ * @brief Report the pending IRQ events, runs on the low priority work queue
+ */
+static void gb_gpio_irq_worker(void *arg)
+{
+    struct gb_gpio_irq_events_request *request;
+    struct gb_operation *operation;
+    irqstate_t flags;
+    uint8_t count;
+    uint8_t first;
+    int i;
+
+    /* events keep being queued while the previous ones are sent */
+    count = g_gpio_coalesce.count;
+    if (!count)
+        return;
+
+    operation = gb_operation_create(g_gpio_cport, GB_GPIO_TYPE_IRQ_EVENTS,
+                                    sizeof(*request) +
+                                    count * sizeof(request->edges[0]));
+
+    flags = irqsave();
+    first = (g_gpio_coalesce.head + GB_GPIO_IRQ_EVENTS -
+             g_gpio_coalesce.count) % GB_GPIO_IRQ_EVENTS;
+    if (!operation) {
+        /* the events are lost, let the host know */
+        g_gpio_coalesce.count -= count;
+        g_gpio_coalesce.flags |= GB_GPIO_IRQ_EVENTS_OVERFLOW;
+        irqrestore(flags);
+        return;
+    }
+
+    request = gb_operation_get_request_payload(operation);
+    request->count = count;
+    request->flags = g_gpio_coalesce.flags;
+    for (i = 0; i < count; i++) {
+        uint8_t n = (first + i) % GB_GPIO_IRQ_EVENTS;
+
+        request->edges[i].which = g_gpio_coalesce.edges[n].which;
+        request->edges[i].value = g_gpio_coalesce.edges[n].value;
+        request->edges[i].timestamp =
+            cpu_to_le64(g_gpio_coalesce.edges[n].timestamp);
+    }
+    g_gpio_coalesce.count -= count;
+    g_gpio_coalesce.flags = 0;
+    irqrestore(flags);
+
+    /* Send unidirectional operation. */
+    gb_operation_send_request(operation, NULL, false);
+
+    gb_operation_destroy(operation);
+}
+
+/**
+ * @brief Queue an IRQ event for the next coalesced report
+ *
+ * Runs in interrupt context.
+ */
+static void gb_gpio_irq_queue(int irq)
+{
+    struct timespec ts;
+    uint8_t n;
+
+    /* Host is responsible for unmasking level triggered lines. */
+    if (gb_gpio_irq_is_level(irq))
+        gpio_mask_irq(irq);
+
+    if (g_gpio_coalesce.count == GB_GPIO_IRQ_EVENTS) {
+        g_gpio_coalesce.flags |= GB_GPIO_IRQ_EVENTS_OVERFLOW;
+    } else {
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+
+        n = g_gpio_coalesce.head;
+        g_gpio_coalesce.edges[n].which = irq;
+        g_gpio_coalesce.edges[n].value = gpio_get_value(irq);
+        g_gpio_coalesce.edges[n].timestamp =
+            (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+        g_gpio_coalesce.head = (n + 1) % GB_GPIO_IRQ_EVENTS;
+        g_gpio_coalesce.count++;
+    }
+
+    /* the window starts with the first event after the last report */
+    if (work_available(&g_gpio_coalesce.work))
+        work_queue(LPWORK, &g_gpio_coalesce.work, gb_gpio_irq_worker, NULL,
+                   g_gpio_coalesce.delay);
+}
+
+static uint8_t gb_gpio_irq_coalesce(struct gb_operation *operation)
+{
+    struct gb_gpio_irq_coalesce_request *request =
+        gb_operation_get_request_payload(operation);
+    irqstate_t flags;
+
+    if (gb_operation_get_request_payload_size(operation) < sizeof(*request)) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    flags = irqsave();
+    g_gpio_coalesce.delay = USEC2TICK(le16_to_cpu(request->usec));
+    g_gpio_coalesce.enabled = !!request->enable;
+    irqrestore(flags);
+
+    /* report what was gathered so far at once */
+    if (!g_gpio_coalesce.enabled && work_available(&g_gpio_coalesce.work))
+        work_queue(LPWORK, &g_gpio_coalesce.work, gb_gpio_irq_worker, NULL, 0);
+
+    return GB_OP_SUCCESS;
+}
+#endif
+
 int gb_gpio_irq_event(int irq, FAR void *context)
 {
     struct gb_gpio_irq_event_request *request;
     struct gb_operation *operation;
 
+#ifdef CONFIG_GREYBUS_GPIO_IRQ_COALESCE
+    if (g_gpio_coalesce.enabled) {
+        gb_gpio_irq_queue(irq);
+        return OK;
+    }
+#endif
+
     operation = gb_operation_create(g_gpio_cport, GB_GPIO_TYPE_IRQ_EVENT,
                                     sizeof(*request));
     if (!operation)
@@ -316,6 +616,10 @@ static uint8_t gb_gpio_irq_type(struct gb_operation *operation)
     ret = set_gpio_triggering(request->which, trigger);
     if (ret)
         return GB_OP_INVALID;
+#ifdef CONFIG_GREYBUS_GPIO_IRQ_COALESCE
+    gb_gpio_irq_set_level(request->which,
+                          request->type & GB_GPIO_IRQ_TYPE_LEVEL_MASK);
+#endif
     ret = gpio_irqattach(request->which, gb_gpio_irq_event);
     if (ret)
         return GB_OP_UNKNOWN_ERROR;
@@ -331,12 +635,18 @@ static struct gb_operation_handler gb_gpio_handlers[] = {
     GB_HANDLER(GB_GPIO_TYPE_GET_DIRECTION, gb_gpio_get_direction),
     GB_HANDLER(GB_GPIO_TYPE_DIRECTION_IN, gb_gpio_direction_in),
     GB_HANDLER(GB_GPIO_TYPE_DIRECTION_OUT, gb_gpio_direction_out),
-    GB_HANDLER(GB_GPIO_TYPE_GET_VALUE, gb_gpio_get_value),
-    GB_HANDLER(GB_GPIO_TYPE_SET_VALUE, gb_gpio_set_value),
+    GB_RX_HANDLER(GB_GPIO_TYPE_GET_VALUE, gb_gpio_get_value),
+    GB_RX_HANDLER(GB_GPIO_TYPE_SET_VALUE, gb_gpio_set_value),
     GB_HANDLER(GB_GPIO_TYPE_SET_DEBOUNCE, gb_gpio_set_debounce),
     GB_HANDLER(GB_GPIO_TYPE_IRQ_TYPE, gb_gpio_irq_type),
     GB_HANDLER(GB_GPIO_TYPE_IRQ_MASK, gb_gpio_irq_mask),
     GB_HANDLER(GB_GPIO_TYPE_IRQ_UNMASK, gb_gpio_irq_unmask),
+    GB_RX_HANDLER(GB_GPIO_TYPE_GET_VALUES, gb_gpio_get_values),
+    GB_RX_HANDLER(GB_GPIO_TYPE_SET_VALUES, gb_gpio_set_values),
+    GB_HANDLER(GB_GPIO_TYPE_SET_DIRECTIONS, gb_gpio_set_directions),
+#ifdef CONFIG_GREYBUS_GPIO_IRQ_COALESCE
+    GB_HANDLER(GB_GPIO_TYPE_IRQ_COALESCE, gb_gpio_irq_coalesce),
+#endif
 };
 
 struct gb_driver gpio_driver = {
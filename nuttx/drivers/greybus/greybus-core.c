@@ -46,6 +46,10 @@
 #include <errno.h>
 
 #include "rtr.h"
+#include "greybus-slab.h"
+#include "greybus-stats.h"
+#include "greybus-irqoff.h"
+#include "greybus-trace.h"
 
 #define DEFAULT_STACK_SIZE      CONFIG_PTHREAD_STACK_DEFAULT
 #define TIMEOUT_IN_MS           1000
@@ -56,25 +60,87 @@
 
 #define TIMEOUT_WD_DELAY    (TIMEOUT_IN_MS * CLOCKS_PER_SEC) / ONE_SEC_IN_MSEC
 
+#define GB_BATCH_MAX        8
+
+/* RX hot path, moved to SRAM on XIP targets */
+#ifdef CONFIG_GREYBUS_RAMFUNCS
+#define GB_RAMFUNC          locate_code(".ramfunc")
+#else
+#define GB_RAMFUNC
+#endif
+
+/*
+ * Requests waiting for a response are hashed on their ID, which is unique
+ * among all CPorts, so that a response is matched without walking tx_fifo.
+ */
+#define GB_PENDING_HASH_SIZE    32
+#define GB_PENDING_HASH(id)     (le16_to_cpu(id) & (GB_PENDING_HASH_SIZE - 1))
+
+/* Request types covered by the handler lookup table */
+#define GB_HANDLER_TABLE_SIZE   128
+
+#ifdef CONFIG_GREYBUS_RX_WORKER_POOL
+#if CONFIG_GREYBUS_RX_WORKER_POOL_HIPRI_SIZE > 0
+#define GB_RX_LANE_COUNT        2
+#else
+#define GB_RX_LANE_COUNT        1
+#endif
+
+#if CONFIG_GREYBUS_RX_WORKER_POOL_SIZE > CONFIG_GREYBUS_RX_WORKER_POOL_HIPRI_SIZE
+#define GB_RX_LANE_MAX_WORKERS  CONFIG_GREYBUS_RX_WORKER_POOL_SIZE
+#else
+#define GB_RX_LANE_MAX_WORKERS  CONFIG_GREYBUS_RX_WORKER_POOL_HIPRI_SIZE
+#endif
+
+/*
+ * A lane is a set of workers sharing a list of CPorts which have pending
+ * messages. A CPort is on the ready list at most once and is never handled
+ * by two workers at the same time, so messages of a given CPort are still
+ * processed in order. A worker only processes one message before putting
+ * the CPort back at the tail of the ready list, so busy CPorts can't starve
+ * the others.
+ */
+struct gb_rx_lane {
+    struct list_head ready;
+    sem_t ready_sem;
+    volatile bool exit_worker;
+    int nworkers;
+    pthread_t workers[GB_RX_LANE_MAX_WORKERS];
+};
+
+static struct gb_rx_lane gb_rx_lanes[GB_RX_LANE_COUNT];
+#endif
+
 struct gb_cport_driver {
     struct gb_driver *driver;
     struct list_head tx_fifo;
     struct list_head rx_fifo;
     sem_t rx_fifo_lock;
+#ifdef CONFIG_GREYBUS_RX_WORKER_POOL
+    struct gb_rx_lane *lane;
+    struct list_head lane_node;
+    bool rx_scheduled;
+#else
     pthread_t thread;
+#endif
+    bool rx_busy;
+#ifdef CONFIG_GREYBUS_RX_CREDITS
+    bool rx_paused;
+    unsigned int rx_budget;
+    unsigned int rx_queued;
+    unsigned int rx_max_queued;
+    uint32_t rx_stalls;
+#endif
     volatile bool exit_worker;
     struct wdog_s timeout_wd;
     struct gb_operation timedout_operation;
     uint16_t cport;
 };
 
-struct gb_tape_record_header {
-    uint16_t size;
-    uint16_t cport;
-};
-
 static atomic_t request_id;
 
+static struct list_head gb_pending_hash[GB_PENDING_HASH_SIZE];
+
 static void **cport_tbl;
 
 static struct gb_cport_driver *_g_cport(unsigned int cport)
@@ -107,11 +173,17 @@ static void g_cport_add_entry(uint16_t cport, struct gb_driver *driver)
         sem_init(&entry->rx_fifo_lock, 0, 0);
         list_init(&entry->rx_fifo);
         list_init(&entry->tx_fifo);
+#ifdef CONFIG_GREYBUS_RX_WORKER_POOL
+        list_init(&entry->lane_node);
+#endif
         wd_static(&entry->timeout_wd);
         entry->timedout_operation.request_buffer = timedout_hdr;
         list_init(&entry->timedout_operation.list);
         entry->driver = driver;
         entry->cport = cport;
+#ifdef CONFIG_GREYBUS_RX_CREDITS
+        entry->rx_budget = CONFIG_GREYBUS_RX_CREDITS_DEFAULT;
+#endif
 
         rtr_add_value(cport_tbl, cport, (void *)entry);
     }
@@ -130,6 +202,29 @@ static inline void g_cport_remove_entry(uint16_t cport)
 static void gb_operation_timeout(int argc, uint32_t cport, ...);
 static struct gb_operation *_gb_operation_create(unsigned int cport);
 
+static void *gb_buf_alloc(size_t size)
+{
+    void *buf = gb_slab_alloc_buf(size);
+
+    if (buf)
+        return buf;
+
+    gb_stats_count_alloc();
+    return transport_backend->alloc_buf(size);
+}
+
+static void gb_buf_free(void *buf)
+{
+    if (!gb_slab_free_buf(buf))
+        transport_backend->free_buf(buf);
+}
+
+static void gb_operation_free(struct gb_operation *operation)
+{
+    if (!gb_slab_free_op(operation))
+        free(operation);
+}
+
 uint8_t gb_errno_to_op_result(int err)
 {
     switch (err) {
@@ -199,6 +294,32 @@ static int gb_compare_handlers(const void *data1, const void *data2)
     return (int)handler1->type - (int)handler2->type;
 }
 
+#ifdef CONFIG_GREYBUS_HANDLER_TABLE
+/*
+ * Build the direct lookup table of a driver. Must be called once the
+ * handlers are sorted. Without a table, or for types that do not fit in it,
+ * find_operation_handler() falls back to a binary search.
+ */
+static void gb_build_handler_table(struct gb_driver *driver)
+{
+    size_t i;
+
+    if (driver->handler_table ||
+        driver->op_handlers_count >= UINT8_MAX) {
+        return;
+    }
+
+    driver->handler_table = zalloc(GB_HANDLER_TABLE_SIZE);
+    if (!driver->handler_table)
+        return;
+
+    for (i = 0; i < driver->op_handlers_count; i++) {
+        if (driver->op_handlers[i].type < GB_HANDLER_TABLE_SIZE)
+            driver->handler_table[driver->op_handlers[i].type] = i + 1;
+    }
+}
+#endif
+
 static struct gb_operation_handler *find_operation_handler(uint8_t type,
                                                            unsigned int cport)
 {
@@ -209,6 +330,13 @@ static struct gb_operation_handler *find_operation_handler(uint8_t type,
         return NULL;
     }
 
+#ifdef CONFIG_GREYBUS_HANDLER_TABLE
+    if (driver->handler_table && type < GB_HANDLER_TABLE_SIZE) {
+        l = driver->handler_table[type];
+        return l ? &driver->op_handlers[l - 1] : NULL;
+    }
+#endif
+
     /*
      * This function is performance sensitive, so let's use an inline binary
      * search algorithm. The libc version takes pointer to the comparison
@@ -234,8 +362,17 @@ static void gb_process_request(struct gb_operation_hdr *hdr,
                                struct gb_operation *operation)
 {
     struct gb_operation_handler *op_handler;
+    uint32_t start;
     uint8_t result;
 
+#ifdef CONFIG_GREYBUS_RX_HANDLERS
+    if (operation->rx_handled) {
+        gb_operation_send_response(operation, operation->rx_result);
+        op_mark_send_time(operation);
+        return;
+    }
+#endif
+
     op_handler = find_operation_handler(hdr->type, operation->cport);
     if (!op_handler) {
         gb_error("Cport %u: Invalid operation type %u\n",
@@ -244,7 +381,10 @@ static void gb_process_request(struct gb_operation_hdr *hdr,
         return;
     }
 
+    start = gb_stats_now();
     result = op_handler->handler(operation);
+    gb_stats_record(operation->cport, hdr->type, GB_STATS_HANDLER,
+                    gb_stats_now() - start);
     gb_debug("%s: %u\n", gb_handler_name(op_handler), result);
 
     if (hdr->id)
@@ -252,67 +392,112 @@ static void gb_process_request(struct gb_operation_hdr *hdr,
     op_mark_send_time(operation);
 }
 
-static bool gb_operation_has_timedout(struct gb_operation *operation)
+/**
+ * Get the time left before an operation times out
+ *
+ * @param operation Operation waiting for a response
+ * @param now Current time
+ * @return Time left in system ticks, 0 if the operation has timed out
+ */
+static int gb_operation_time_left(struct gb_operation *operation,
+                                  const struct timespec *now)
 {
-    struct timespec current_time;
-    struct timespec timeout_time;
+    int32_t elapsed_ms;
 
-    timeout_time.tv_sec = operation->time.tv_sec +
-                          TIMEOUT_IN_MS / ONE_SEC_IN_MSEC;
-    timeout_time.tv_nsec = operation->time.tv_nsec +
-                          (TIMEOUT_IN_MS % ONE_SEC_IN_MSEC) * ONE_MSEC_IN_NSEC;
-    clock_gettime(CLOCK_MONOTONIC, &current_time);
+    elapsed_ms = (now->tv_sec - operation->time.tv_sec) * ONE_SEC_IN_MSEC +
+                 (now->tv_nsec - operation->time.tv_nsec) / ONE_MSEC_IN_NSEC;
 
-    if (current_time.tv_sec > timeout_time.tv_sec)
-        return true;
-
-    if (current_time.tv_sec < timeout_time.tv_sec)
-        return false;
+    if (elapsed_ms >= TIMEOUT_IN_MS)
+        return 0;
 
-    return current_time.tv_nsec > timeout_time.tv_nsec;
+    /* Round up so that the watchdog never fires early */
+    return ((TIMEOUT_IN_MS - elapsed_ms) * CLOCKS_PER_SEC +
+            ONE_SEC_IN_MSEC - 1) / ONE_SEC_IN_MSEC;
 }
 
 /**
  * Update watchdog state
  *
  * Cancel cport watchdog if there is no outgoing message waiting for a response,
- * or update the watchdog if there is still outgoing messages.
- *
- * TODO use fine-grain timeout delay when doing the update
+ * or arm it for the deadline of the oldest one. All requests share the same
+ * timeout, so tx_fifo, which is in send order, is also in deadline order.
  *
  * @note This function should be called from an atomic context
  */
 static void gb_watchdog_update(unsigned int cport)
 {
+    struct gb_operation *op;
+    struct timespec now;
     irqstate_t flags;
+    int delay;
 
     flags = irqsave();
 
     if (list_is_empty(&g_cport(cport).tx_fifo)) {
         wd_cancel(&g_cport(cport).timeout_wd);
     } else {
-        wd_start(&g_cport(cport).timeout_wd, TIMEOUT_WD_DELAY,
+        op = list_entry(g_cport(cport).tx_fifo.next, struct gb_operation,
+                        list);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        delay = gb_operation_time_left(op, &now);
+
+        wd_start(&g_cport(cport).timeout_wd, delay ? delay : 1,
                  gb_operation_timeout, 1, cport);
     }
 
     irqrestore(flags);
 }
 
+static void gb_pending_add(struct gb_operation *operation)
+{
+    struct gb_operation_hdr *hdr = operation->request_buffer;
+
+    list_add(&g_cport(operation->cport).tx_fifo, &operation->list);
+    list_add(&gb_pending_hash[GB_PENDING_HASH(hdr->id)],
+             &operation->pending_list);
+}
+
+/**
+ * Remove an operation from the requests waiting for a response
+ *
+ * @return true if it was the oldest one of its CPort
+ * @note This function should be called from an atomic context
+ */
+static bool gb_pending_del(struct gb_operation *operation)
+{
+    bool oldest = g_cport(operation->cport).tx_fifo.next == &operation->list;
+
+    list_del(&operation->list);
+    list_del(&operation->pending_list);
+
+    return oldest;
+}
+
 static void gb_clean_timedout_operation(unsigned int cport)
 {
     irqstate_t flags;
-    struct list_head *iter, *iter_next;
     struct gb_operation *op;
+    struct timespec now;
 
-    list_foreach_safe(&g_cport(cport).tx_fifo, iter, iter_next) {
-        op = list_entry(iter, struct gb_operation, list);
+    clock_gettime(CLOCK_MONOTONIC, &now);
 
-        if (!gb_operation_has_timedout(op)) {
-            continue;
+    while (1) {
+        flags = irqsave();
+
+        if (list_is_empty(&g_cport(cport).tx_fifo)) {
+            irqrestore(flags);
+            break;
         }
 
-        flags = irqsave();
-        list_del(iter);
+        /* Oldest first: stop at the first one still in time */
+        op = list_entry(g_cport(cport).tx_fifo.next, struct gb_operation,
+                        list);
+        if (gb_operation_time_left(op, &now)) {
+            irqrestore(flags);
+            break;
+        }
+
+        gb_pending_del(op);
         irqrestore(flags);
 
         if (op->callback) {
@@ -328,21 +513,25 @@ static void gb_process_response(struct gb_operation_hdr *hdr,
                                 struct gb_operation *operation)
 {
     irqstate_t flags;
-    struct list_head *iter, *iter_next;
+    struct list_head *iter;
     struct gb_operation *op;
     struct gb_operation_hdr *op_hdr;
 
-    list_foreach_safe(&g_cport(operation->cport).tx_fifo, iter, iter_next) {
-        op = list_entry(iter, struct gb_operation, list);
+    flags = gb_irqsave();
+
+    list_foreach(&gb_pending_hash[GB_PENDING_HASH(hdr->id)], iter) {
+        op = list_entry(iter, struct gb_operation, pending_list);
         op_hdr = op->request_buffer;
 
-        if (hdr->id != op_hdr->id)
+        if (hdr->id != op_hdr->id || op->cport != operation->cport)
             continue;
 
-        flags = irqsave();
-        list_del(iter);
-        gb_watchdog_update(operation->cport);
-        irqrestore(flags);
+        if (gb_pending_del(op))
+            gb_watchdog_update(operation->cport);
+        gb_irqrestore(flags);
+
+        gb_stats_record(op->cport, op_hdr->type, GB_STATS_ROUND_TRIP,
+                        gb_stats_now() - gb_stats_timespec_us(&op->time));
 
         /* attach this response with the original request */
         gb_operation_ref(operation);
@@ -354,193 +543,1003 @@ static void gb_process_response(struct gb_operation_hdr *hdr,
         return;
     }
 
+    gb_irqrestore(flags);
+
     gb_error("CPort %u: cannot find matching request for response %hu. Dropping message.\n",
              operation->cport, le16_to_cpu(hdr->id));
 }
 
-static void *gb_pending_message_worker(void *data)
+static void gb_process_operation(unsigned int cportid,
+                                 struct gb_operation *operation)
+{
+    struct gb_operation_hdr *hdr = operation->request_buffer;
+
+    if (hdr == timedout_hdr) {
+        gb_clean_timedout_operation(cportid);
+        return;
+    }
+
+#ifdef CONFIG_GREYBUS_STATS
+    gb_stats_record(cportid, hdr->type, GB_STATS_QUEUE,
+                    gb_stats_now() - operation->rx_time);
+#endif
+
+    if (hdr->type & GB_TYPE_RESPONSE_FLAG)
+        gb_process_response(hdr, operation);
+    else
+        gb_process_request(hdr, operation);
+    gb_operation_destroy(operation);
+}
+
+#ifdef CONFIG_GREYBUS_RX_CREDITS
+/**
+ * Take an RX credit for an operation added to the RX fifo
+ *
+ * When the last credit is taken, the transport is asked to pause the RX of
+ * the CPort. Messages already on their way are still queued.
+ *
+ * @note This function should be called from an atomic context
+ */
+static void gb_rx_credit_take(struct gb_cport_driver *entry)
+{
+    entry->rx_queued++;
+    if (entry->rx_queued > entry->rx_max_queued)
+        entry->rx_max_queued = entry->rx_queued;
+
+    if (!entry->rx_budget || entry->rx_paused ||
+        entry->rx_queued < entry->rx_budget)
+        return;
+
+    entry->rx_paused = true;
+    entry->rx_stalls++;
+    if (transport_backend->rx_pause)
+        transport_backend->rx_pause(entry->cport);
+}
+
+/**
+ * Give back the RX credit of a processed operation
+ *
+ * RX is resumed once the worker has caught up with half of the budget.
+ *
+ * @note This function should be called from an atomic context
+ */
+static void gb_rx_credit_give(struct gb_cport_driver *entry)
+{
+    DEBUGASSERT(entry->rx_queued > 0);
+    entry->rx_queued--;
+
+    if (!entry->rx_paused || entry->rx_queued > entry->rx_budget / 2)
+        return;
+
+    entry->rx_paused = false;
+    if (transport_backend->rx_resume)
+        transport_backend->rx_resume(entry->cport);
+}
+#else
+static inline void gb_rx_credit_take(struct gb_cport_driver *entry)
+{
+}
+
+static inline void gb_rx_credit_give(struct gb_cport_driver *entry)
+{
+}
+#endif
+
+#ifdef CONFIG_GREYBUS_RX_WORKER_POOL
+/**
+ * Queue a received operation and schedule its CPort on its lane
+ *
+ * @note This function should be called from an atomic context
+ */
+GB_RAMFUNC static void gb_rx_enqueue(struct gb_cport_driver *entry,
+                                     struct gb_operation *operation)
+{
+    list_add(&entry->rx_fifo, &operation->list);
+    gb_rx_credit_take(entry);
+
+    if (entry->rx_scheduled || entry->rx_busy)
+        return;
+
+    entry->rx_scheduled = true;
+    list_add(&entry->lane->ready, &entry->lane_node);
+    sem_post(&entry->lane->ready_sem);
+}
+
+static void *gb_pending_message_worker(void *data)
+{
+    struct gb_rx_lane *lane = data;
+    struct gb_cport_driver *entry;
+    struct gb_operation *operation;
+    struct list_head *head;
+    irqstate_t flags;
+    int retval;
+
+    while (1) {
+        retval = sem_wait(&lane->ready_sem);
+        if (retval < 0)
+            continue;
+
+        flags = irqsave();
+
+        if (list_is_empty(&lane->ready)) {
+            irqrestore(flags);
+            if (lane->exit_worker)
+                break;
+            continue;
+        }
+
+        entry = list_entry(lane->ready.next, struct gb_cport_driver,
+                           lane_node);
+        list_del(&entry->lane_node);
+        entry->rx_scheduled = false;
+        entry->rx_busy = true;
+
+        head = entry->rx_fifo.next;
+        list_del(head);
+
+        irqrestore(flags);
+
+        operation = list_entry(head, struct gb_operation, list);
+        gb_process_operation(entry->cport, operation);
+
+        flags = irqsave();
+
+        entry->rx_busy = false;
+        gb_rx_credit_give(entry);
+        if (!list_is_empty(&entry->rx_fifo)) {
+            entry->rx_scheduled = true;
+            list_add(&lane->ready, &entry->lane_node);
+            sem_post(&lane->ready_sem);
+        } else if (entry->exit_worker) {
+            /* Wake up gb_unregister_driver() waiting for the drain */
+            sem_post(&entry->rx_fifo_lock);
+        }
+
+        irqrestore(flags);
+    }
+
+    return NULL;
+}
+
+static int gb_rx_lane_start(struct gb_rx_lane *lane, int nworkers,
+                            int priority)
+{
+    struct sched_param param;
+    pthread_attr_t thread_attr;
+    int retval;
+
+    list_init(&lane->ready);
+    sem_init(&lane->ready_sem, 0, 0);
+    lane->exit_worker = false;
+    lane->nworkers = 0;
+
+    retval = pthread_attr_init(&thread_attr);
+    if (retval)
+        return -retval;
+
+    retval = pthread_attr_setstacksize(&thread_attr,
+                                       CONFIG_GREYBUS_RX_WORKER_POOL_STACKSIZE);
+    if (retval)
+        goto out;
+
+    param.sched_priority = priority;
+    retval = pthread_attr_setschedparam(&thread_attr, &param);
+    if (retval)
+        goto out;
+
+    while (lane->nworkers < nworkers) {
+        retval = pthread_create(&lane->workers[lane->nworkers], &thread_attr,
+                                gb_pending_message_worker, lane);
+        if (retval)
+            goto out;
+        pthread_setname_np(lane->workers[lane->nworkers], "gb_rx_worker");
+        lane->nworkers++;
+    }
+
+out:
+    pthread_attr_destroy(&thread_attr);
+    return -retval;
+}
+
+static void gb_rx_lane_stop(struct gb_rx_lane *lane)
+{
+    int i;
+
+    lane->exit_worker = true;
+    for (i = 0; i < lane->nworkers; i++)
+        sem_post(&lane->ready_sem);
+
+    for (i = 0; i < lane->nworkers; i++)
+        pthread_join(lane->workers[i], NULL);
+
+    lane->nworkers = 0;
+    sem_destroy(&lane->ready_sem);
+}
+
+static void gb_rx_pool_stop(void)
+{
+    int i;
+
+    for (i = 0; i < GB_RX_LANE_COUNT; i++)
+        gb_rx_lane_stop(&gb_rx_lanes[i]);
+}
+
+static int gb_rx_pool_start(void)
+{
+    int retval;
+
+    retval = gb_rx_lane_start(&gb_rx_lanes[GB_RX_PRIORITY_NORMAL],
+                              CONFIG_GREYBUS_RX_WORKER_POOL_SIZE,
+                              CONFIG_GREYBUS_RX_WORKER_POOL_PRIORITY);
+#if GB_RX_LANE_COUNT > 1
+    if (!retval) {
+        retval = gb_rx_lane_start(&gb_rx_lanes[GB_RX_PRIORITY_HIGH],
+                                  CONFIG_GREYBUS_RX_WORKER_POOL_HIPRI_SIZE,
+                                  CONFIG_GREYBUS_RX_WORKER_POOL_HIPRI_PRIORITY);
+    }
+#endif
+
+    if (retval) {
+        gb_error("Can not start the RX worker pool: %d\n", retval);
+        gb_rx_pool_stop();
+    }
+
+    return retval;
+}
+
+static struct gb_rx_lane *gb_rx_lane_get(struct gb_driver *driver)
+{
+#if GB_RX_LANE_COUNT > 1
+    if (driver->rx_priority == GB_RX_PRIORITY_HIGH)
+        return &gb_rx_lanes[GB_RX_PRIORITY_HIGH];
+#endif
+    return &gb_rx_lanes[GB_RX_PRIORITY_NORMAL];
+}
+
+/**
+ * Wait for the pool to process all pending messages of a CPort
+ */
+static void gb_rx_drain(unsigned int cport)
+{
+    irqstate_t flags;
+    bool idle;
+
+    flags = irqsave();
+    g_cport(cport).exit_worker = true;
+    idle = list_is_empty(&g_cport(cport).rx_fifo) &&
+           !g_cport(cport).rx_busy;
+    irqrestore(flags);
+
+    while (!idle) {
+        sem_wait(&g_cport(cport).rx_fifo_lock);
+
+        flags = irqsave();
+        idle = list_is_empty(&g_cport(cport).rx_fifo) &&
+               !g_cport(cport).rx_busy;
+        irqrestore(flags);
+    }
+}
+#else
+/**
+ * Queue a received operation and wake up the CPort worker
+ *
+ * @note This function should be called from an atomic context
+ */
+GB_RAMFUNC static void gb_rx_enqueue(struct gb_cport_driver *entry,
+                                     struct gb_operation *operation)
+{
+    list_add(&entry->rx_fifo, &operation->list);
+    gb_rx_credit_take(entry);
+    sem_post(&entry->rx_fifo_lock);
+}
+
+static void *gb_pending_message_worker(void *data)
+{
+    const int cportid = (int) data;
+    irqstate_t flags;
+    struct gb_operation *operation;
+    struct list_head *head;
+    int retval;
+
+    while (1) {
+        retval = sem_wait(&g_cport(cportid).rx_fifo_lock);
+        if (retval < 0)
+            continue;
+
+        if (g_cport(cportid).exit_worker &&
+            list_is_empty(&g_cport(cportid).rx_fifo)) {
+            break;
+        }
+
+        flags = irqsave();
+        head = g_cport(cportid).rx_fifo.next;
+        list_del(g_cport(cportid).rx_fifo.next);
+        g_cport(cportid).rx_busy = true;
+        irqrestore(flags);
+
+        operation = list_entry(head, struct gb_operation, list);
+        gb_process_operation(cportid, operation);
+        g_cport(cportid).rx_busy = false;
+
+#ifdef CONFIG_GREYBUS_RX_CREDITS
+        flags = irqsave();
+        gb_rx_credit_give(_g_cport(cportid));
+        irqrestore(flags);
+#endif
+    }
+
+    return NULL;
+}
+#endif
+
+#if defined(CONFIG_UNIPRO_ZERO_COPY)
+static struct gb_operation *gb_rx_create_operation(unsigned cport, void *data,
+                                                   size_t size)
+{
+    struct gb_operation *op;
+
+    if (transport_backend->headroom) {
+        gb_error("headroom allocation cannot be used with zero copy\n");
+        return NULL;
+    }
+
+    op = _gb_operation_create(cport);
+    if (!op)
+        return NULL;
+
+    op->is_unipro_rx_buf = true;
+    op->request_headroom = data;
+    op->request_buffer = data;
+
+    return op;
+}
+#else
+static struct gb_operation *gb_rx_create_operation(unsigned cport, void *data,
+                                                   size_t size)
+{
+    struct gb_operation *op;
+
+    op = gb_operation_create(cport, 0, size - sizeof(struct gb_operation_hdr));
+    if (!op)
+        return NULL;
+
+    memcpy(op->request_buffer, data, size);
+
+    return op;
+}
+#endif
+
+/**
+ * Create an operation around a buffer handed over by the transport
+ *
+ * The buffer must have been allocated with transport_backend->alloc_buf() and
+ * have transport_backend->headroom bytes available in front of data. It is
+ * given back to the transport with free_buf() when the last reference to the
+ * operation is dropped.
+ */
+static struct gb_operation *gb_rx_adopt_operation(unsigned cport, void *data)
+{
+    struct gb_operation *op;
+
+    op = _gb_operation_create(cport);
+    if (!op)
+        return NULL;
+
+    op->request_headroom = (char *)data - transport_backend->headroom;
+    op->request_buffer = data;
+
+    return op;
+}
+
+static void gb_rx_release_buffer(void *data)
+{
+    gb_buf_free((char *)data - transport_backend->headroom);
+}
+
+#ifdef CONFIG_GREYBUS_RX_HANDLERS
+static inline uint32_t gb_rx_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static int gb_rx_response_sent(int status, const void *buf, void *priv)
+{
+    struct gb_operation *operation = priv;
+
+    if (status)
+        gb_error("Cport %u: failed to send response: %d\n",
+                 operation->cport, status);
+
+    gb_operation_destroy(operation);
+    return 0;
+}
+
+/**
+ * Send a response without blocking
+ *
+ * The operation is kept alive until the transport is done with the response.
+ *
+ * @return 0 on success, a negative errno if the response must be sent from
+ *         the CPort worker instead
+ */
+static int gb_operation_send_response_async(struct gb_operation *operation,
+                                            uint8_t result)
+{
+    struct gb_operation_hdr *resp_hdr;
+    int retval;
+
+    if (!transport_backend->send_async)
+        return -EOPNOTSUPP;
+
+    if (!operation->response_buffer &&
+        !gb_operation_alloc_response(operation, 0))
+        return -ENOMEM;
+
+    resp_hdr = operation->response_buffer;
+    resp_hdr->result = result;
+
+    gb_trace_record(GB_TRACE_TX, operation->cport, operation->response_buffer,
+                    le16_to_cpu(resp_hdr->size));
+
+    gb_operation_ref(operation);
+    retval = transport_backend->send_async(operation->cport,
+                                           operation->response_buffer,
+                                           le16_to_cpu(resp_hdr->size),
+                                           gb_rx_response_sent, operation);
+    if (retval) {
+        gb_operation_destroy(operation);
+        return retval;
+    }
+
+    gb_loopback_log_exit(operation->cport, operation, resp_hdr->size);
+    operation->has_responded = true;
+    return 0;
+}
+
+/**
+ * Run a request handler from the RX context
+ *
+ * Only done when nothing is queued or being processed on the CPort, so the
+ * operations are still handled in order. A handler exceeding its time budget
+ * is moved back to the CPort worker for good.
+ *
+ * @return true if the operation has been fully handled
+ */
+static bool gb_rx_run_handler(struct gb_operation_handler *op_handler,
+                              struct gb_operation *operation)
+{
+    struct gb_operation_hdr *hdr = operation->request_buffer;
+    struct gb_cport_driver *entry = _g_cport(operation->cport);
+    irqstate_t flags;
+    uint32_t elapsed;
+    uint8_t result;
+    bool idle;
+
+    flags = irqsave();
+    idle = list_is_empty(&entry->rx_fifo) && !entry->rx_busy &&
+           !entry->exit_worker;
+    irqrestore(flags);
+
+    if (!idle)
+        return false;
+
+    elapsed = gb_rx_now();
+    result = op_handler->handler(operation);
+    elapsed = gb_rx_now() - elapsed;
+
+    if (result == GB_OP_RX_DEFER)
+        return false;
+
+    gb_stats_record(operation->cport, hdr->type, GB_STATS_HANDLER, elapsed);
+    gb_debug("%s: %u (rx)\n", gb_handler_name(op_handler), result);
+
+    if (elapsed > CONFIG_GREYBUS_RX_HANDLER_BUDGET) {
+        gb_error("%s took %u us, moved to the CPort worker\n",
+                 gb_handler_name(op_handler), elapsed);
+        op_handler->in_rx = false;
+    }
+
+    if (hdr->id && gb_operation_send_response_async(operation, result)) {
+        operation->rx_handled = true;
+        operation->rx_result = result;
+        return false;
+    }
+
+    op_mark_send_time(operation);
+    gb_operation_destroy(operation);
+    return true;
+}
+#endif
+
+GB_RAMFUNC static int _greybus_rx_handler(unsigned int cport, void *data,
+                                          size_t size, bool adopt)
+{
+    irqstate_t flags;
+    struct gb_operation *op;
+    struct gb_operation_hdr *hdr = data;
+    struct gb_operation_handler *op_handler;
+    size_t hdr_size;
+
+    gb_loopback_log_entry(cport);
+    if ((!gb_is_valid_cport(cport) || (!_g_cport(cport)) || !data)) {
+        gb_error("Invalid cport number: %u\n", cport);
+        return -EINVAL;
+    }
+
+    if (!g_cport(cport).driver || !g_cport(cport).driver->op_handlers) {
+        gb_error("Cport %u does not have a valid driver registered\n", cport);
+        if (adopt)
+            gb_rx_release_buffer(data);
+        return 0;
+    }
+
+    if (sizeof(*hdr) > size) {
+        gb_error("Dropping garbage request\n");
+        return -EINVAL; /* Dropping garbage request */
+    }
+
+    hdr_size = le16_to_cpu(hdr->size);
+
+    if (hdr_size > size || sizeof(*hdr) > hdr_size) {
+        gb_error("Dropping garbage request\n");
+        return -EINVAL; /* Dropping garbage request */
+    }
+
+    gb_trace_record(GB_TRACE_RX, cport, data, size);
+
+    op_handler = find_operation_handler(hdr->type, cport);
+    if (op_handler && op_handler->fast_handler) {
+        gb_debug("%s\n", gb_handler_name(op_handler));
+        op_handler->fast_handler(cport, data);
+        if (adopt)
+            gb_rx_release_buffer(data);
+        return 0;
+    }
+
+    if (adopt)
+        op = gb_rx_adopt_operation(cport, data);
+    else
+        op = gb_rx_create_operation(cport, data, hdr_size);
+    if (!op)
+        return -ENOMEM;
+
+    op_mark_recv_time(op);
+#ifdef CONFIG_GREYBUS_STATS
+    op->rx_time = gb_stats_now();
+#endif
+
+#ifdef CONFIG_GREYBUS_RX_HANDLERS
+    if (op_handler && op_handler->in_rx && gb_rx_run_handler(op_handler, op))
+        return 0;
+#endif
+
+    flags = irqsave();
+    gb_rx_enqueue(_g_cport(cport), op);
+    irqrestore(flags);
+
+    return 0;
+}
+
+GB_RAMFUNC int greybus_rx_handler(unsigned int cport, void *data, size_t size)
+{
+    return _greybus_rx_handler(cport, data, size, false);
+}
+
+/**
+ * Receive a message without copying it
+ *
+ * On success, greybus takes ownership of the buffer, which must have been
+ * allocated with the transport alloc_buf() callback and must provide the
+ * transport headroom in front of data. On failure, the buffer still belongs
+ * to the caller.
+ *
+ * @param cport CPort the message was received on
+ * @param data Greybus message, located headroom bytes after the buffer start
+ * @param size Size of the message
+ * @return 0 on success, a negative errno otherwise
+ */
+GB_RAMFUNC int greybus_rx_handler_zero_copy(unsigned int cport, void *data,
+                                           size_t size)
+{
+    return _greybus_rx_handler(cport, data, size, true);
+}
+
+static void gb_flush_tx_fifo(unsigned int cport)
+{
+    struct list_head *iter, *iter_next;
+    irqstate_t flags;
+
+    list_foreach_safe(&_g_cport(cport)->tx_fifo, iter, iter_next) {
+        struct gb_operation *op = list_entry(iter, struct gb_operation, list);
+
+        flags = irqsave();
+        gb_pending_del(op);
+        irqrestore(flags);
+        gb_operation_unref(op);
+    }
+}
+
+int gb_unregister_driver(unsigned int cport)
+{
+    if (!gb_is_valid_cport(cport) || !_g_cport(cport) ||
+		!_g_cport(cport)->driver || !transport_backend)
+        return -EINVAL;
+
+    if (transport_backend->stop_listening)
+        transport_backend->stop_listening(cport);
+
+    wd_cancel(&g_cport(cport).timeout_wd);
+
+#ifdef CONFIG_GREYBUS_RX_WORKER_POOL
+    gb_rx_drain(cport);
+#else
+    g_cport(cport).exit_worker = true;
+    sem_post(&g_cport(cport).rx_fifo_lock);
+    pthread_join(g_cport(cport).thread, NULL);
+#endif
+
+    gb_flush_tx_fifo(cport);
+
+    if (g_cport(cport).driver->exit)
+        g_cport(cport).driver->exit(cport);
+    _g_cport(cport)->driver = NULL;
+
+    return 0;
+}
+
+#ifdef CONFIG_GREYBUS_RX_CREDITS
+/**
+ * Set the RX credits of a CPort
+ *
+ * @param cport CPort to configure
+ * @param credits Number of operations that may wait in the RX fifo before
+ *        the RX of the CPort is paused, 0 for no limit
+ * @return 0 on success, -EINVAL if the CPort has no driver
+ */
+int gb_rx_set_credits(unsigned int cport, unsigned int credits)
+{
+    struct gb_cport_driver *entry;
+    irqstate_t flags;
+
+    if (!gb_is_valid_cport(cport) || !_g_cport(cport))
+        return -EINVAL;
+
+    entry = _g_cport(cport);
+
+    flags = irqsave();
+    entry->rx_budget = credits;
+    if (entry->rx_paused &&
+        (!credits || entry->rx_queued <= credits / 2)) {
+        entry->rx_paused = false;
+        if (transport_backend && transport_backend->rx_resume)
+            transport_backend->rx_resume(cport);
+    }
+    irqrestore(flags);
+
+    return 0;
+}
+
+/**
+ * Get the RX credit accounting of a CPort
+ *
+ * @param cport CPort to query
+ * @param stats Filled with the current state and the stall count
+ * @return 0 on success, -EINVAL if the CPort has no driver
+ */
+int gb_rx_get_credit_stats(unsigned int cport,
+                           struct gb_rx_credit_stats *stats)
+{
+    struct gb_cport_driver *entry;
+    irqstate_t flags;
+
+    if (!gb_is_valid_cport(cport) || !_g_cport(cport) || !stats)
+        return -EINVAL;
+
+    entry = _g_cport(cport);
+
+    flags = irqsave();
+    stats->budget = entry->rx_budget;
+    stats->queued = entry->rx_queued;
+    stats->max_queued = entry->rx_max_queued;
+    stats->stalls = entry->rx_stalls;
+    stats->paused = entry->rx_paused;
+    irqrestore(flags);
+
+    return 0;
+}
+#endif
+
+static int gb_driver_start(unsigned int cport, struct gb_driver *driver)
+{
+#ifndef CONFIG_GREYBUS_RX_WORKER_POOL
+    pthread_attr_t thread_attr;
+    pthread_attr_t *thread_attr_ptr = &thread_attr;
+#endif
+    int retval;
+
+    if (driver->tx_class != GB_TX_CLASS_INTERACTIVE &&
+        transport_backend && transport_backend->set_tx_class) {
+        retval = transport_backend->set_tx_class(cport, driver->tx_class);
+        if (retval)
+            gb_debug("Can not set TX class of CP%u: %d\n", cport, retval);
+    }
+
+    if (driver->op_handlers) {
+        qsort(driver->op_handlers, driver->op_handlers_count,
+              sizeof(*driver->op_handlers), gb_compare_handlers);
+#ifdef CONFIG_GREYBUS_HANDLER_TABLE
+        gb_build_handler_table(driver);
+#endif
+    }
+
+    g_cport(cport).exit_worker = false;
+
+#ifdef CONFIG_GREYBUS_RX_WORKER_POOL
+    gb_debug("add cport %d\n", cport);
+    g_cport_add_entry(cport, NULL);
+
+    _g_cport(cport)->lane = gb_rx_lane_get(driver);
+    _g_cport(cport)->driver = driver;
+
+    return 0;
+#else
+    if (!driver->stack_size)
+        driver->stack_size = DEFAULT_STACK_SIZE;
+
+    retval = pthread_attr_init(&thread_attr);
+    if (retval)
+        goto pthread_attr_init_error;
+
+    retval = pthread_attr_setstacksize(&thread_attr, driver->stack_size);
+    if (retval)
+        goto pthread_attr_setstacksize_error;
+
+    gb_debug("add cport %d\n", cport);
+    g_cport_add_entry(cport, NULL);
+
+    retval = pthread_create(&g_cport(cport).thread, &thread_attr,
+                            gb_pending_message_worker, (unsigned*) cport);
+    if (retval)
+        goto pthread_create_error;
+
+    pthread_setname_np(g_cport(cport).thread, "gb_cport");
+
+    pthread_attr_destroy(&thread_attr);
+    thread_attr_ptr = NULL;
+
+    _g_cport(cport)->driver = driver;
+
+    return 0;
+
+pthread_create_error:
+pthread_attr_setstacksize_error:
+    if (thread_attr_ptr != NULL)
+        pthread_attr_destroy(&thread_attr);
+pthread_attr_init_error:
+    gb_error("Can not create thread for %s\n: ", gb_driver_name(driver));
+    if (driver->exit)
+        driver->exit(cport);
+    return retval;
+#endif
+}
+
+#ifdef CONFIG_GREYBUS_PARALLEL_INIT
+struct gb_bringup_job {
+    struct list_head list;
+    unsigned int cport;
+    struct gb_driver *driver;
+};
+
+static struct {
+    bool active;
+    bool stop;
+    struct list_head jobs;
+    sem_t lock;     /* protects jobs and busy_groups */
+    sem_t work;     /* posted when a job may be picked up */
+    uint32_t busy_groups[256 / 32];
+    int nworkers;
+    pthread_t workers[CONFIG_GREYBUS_PARALLEL_INIT_THREADS];
+} gb_bringup;
+
+/* Serializes gb_driver_start(), which updates the CPort table */
+static sem_t gb_driver_start_lock = SEM_INITIALIZER(1);
+
+static bool gb_bringup_group_busy(enum gb_init_group group)
+{
+    if (group == GB_INIT_GROUP_NONE)
+        return false;
+    return gb_bringup.busy_groups[group / 32] & (1 << (group % 32));
+}
+
+static void gb_bringup_group_set(enum gb_init_group group, bool busy)
+{
+    if (group == GB_INIT_GROUP_NONE)
+        return;
+
+    if (busy)
+        gb_bringup.busy_groups[group / 32] |= 1 << (group % 32);
+    else
+        gb_bringup.busy_groups[group / 32] &= ~(1 << (group % 32));
+}
+
+/*
+ * Take the first queued job whose group is not being initialized. Jobs are
+ * queued in registration order, so the jobs of a group also start in that
+ * order. Called with gb_bringup.lock held.
+ */
+static struct gb_bringup_job *gb_bringup_next_job(void)
+{
+    struct gb_bringup_job *job;
+    struct list_head *iter;
+
+    list_foreach(&gb_bringup.jobs, iter) {
+        job = list_entry(iter, struct gb_bringup_job, list);
+        if (!gb_bringup_group_busy(job->driver->init_group)) {
+            list_del(iter);
+            gb_bringup_group_set(job->driver->init_group, true);
+            return job;
+        }
+    }
+
+    return NULL;
+}
+
+static void *gb_bringup_worker(void *data)
 {
-    const int cportid = (int) data;
-    irqstate_t flags;
-    struct gb_operation *operation;
-    struct list_head *head;
-    struct gb_operation_hdr *hdr;
+    struct gb_bringup_job *job;
+    struct gb_driver *driver;
     int retval;
 
     while (1) {
-        retval = sem_wait(&g_cport(cportid).rx_fifo_lock);
-        if (retval < 0)
-            continue;
-
-        if (g_cport(cportid).exit_worker &&
-            list_is_empty(&g_cport(cportid).rx_fifo)) {
+        sem_wait(&gb_bringup.lock);
+        job = gb_bringup_next_job();
+        if (!job && gb_bringup.stop && list_is_empty(&gb_bringup.jobs)) {
+            sem_post(&gb_bringup.lock);
             break;
         }
+        sem_post(&gb_bringup.lock);
 
-        flags = irqsave();
-        head = g_cport(cportid).rx_fifo.next;
-        list_del(g_cport(cportid).rx_fifo.next);
-        irqrestore(flags);
-
-        operation = list_entry(head, struct gb_operation, list);
-        hdr = operation->request_buffer;
-
-        if (hdr == timedout_hdr) {
-            gb_clean_timedout_operation(cportid);
+        if (!job) {
+            sem_wait(&gb_bringup.work);
             continue;
         }
 
-        if (hdr->type & GB_TYPE_RESPONSE_FLAG)
-            gb_process_response(hdr, operation);
-        else
-            gb_process_request(hdr, operation);
-        gb_operation_destroy(operation);
+        driver = job->driver;
+        retval = driver->init(job->cport);
+        if (retval) {
+            gb_error("Can not init %s\n", gb_driver_name(driver));
+        } else {
+            while (sem_wait(&gb_driver_start_lock) != OK);
+            gb_driver_start(job->cport, driver);
+            sem_post(&gb_driver_start_lock);
+        }
+
+        sem_wait(&gb_bringup.lock);
+        gb_bringup_group_set(driver->init_group, false);
+        sem_post(&gb_bringup.lock);
+
+        /* the next job of that group may now be picked up */
+        sem_post(&gb_bringup.work);
+        free(job);
     }
 
     return NULL;
 }
 
-#if defined(CONFIG_UNIPRO_ZERO_COPY)
-static struct gb_operation *gb_rx_create_operation(unsigned cport, void *data,
-                                                   size_t size)
+static int gb_bringup_queue(unsigned int cport, struct gb_driver *driver)
 {
-    struct gb_operation *op;
-
-    if (transport_backend->headroom) {
-        gb_error("headroom allocation cannot be used with zero copy\n");
-        return NULL;
-    }
-
-    op = _gb_operation_create(cport);
-    if (!op)
-        return NULL;
+    struct gb_bringup_job *job;
 
-    op->is_unipro_rx_buf = true;
-    op->request_headroom = data;
-    op->request_buffer = data;
+    job = malloc(sizeof(*job));
+    if (!job)
+        return -ENOMEM;
 
-    return op;
-}
-#else
-static struct gb_operation *gb_rx_create_operation(unsigned cport, void *data,
-                                                   size_t size)
-{
-    struct gb_operation *op;
+    job->cport = cport;
+    job->driver = driver;
 
-    op = gb_operation_create(cport, 0, size - sizeof(struct gb_operation_hdr));
-    if (!op)
-        return NULL;
+    sem_wait(&gb_bringup.lock);
+    list_add(&gb_bringup.jobs, &job->list);
+    sem_post(&gb_bringup.lock);
 
-    memcpy(op->request_buffer, data, size);
+    sem_post(&gb_bringup.work);
 
-    return op;
+    return 0;
 }
-#endif
 
-int greybus_rx_handler(unsigned int cport, void *data, size_t size)
+/**
+ * Start a parallel CPort bring-up
+ *
+ * Until gb_bringup_wait() is called, the drivers registered with an init
+ * function and no GB_INIT_GROUP_SYNC hint are initialized by a pool of
+ * threads, gb_register_driver() returning as soon as the driver is queued.
+ * Enumeration then takes as long as the slowest driver init rather than the
+ * sum of them.
+ *
+ * @return 0 on success, a negative errno otherwise
+ */
+int gb_bringup_begin(void)
 {
-    irqstate_t flags;
-    struct gb_operation *op;
-    struct gb_operation_hdr *hdr = data;
-    struct gb_operation_handler *op_handler;
-    size_t hdr_size;
-
-    gb_loopback_log_entry(cport);
-    if ((!gb_is_valid_cport(cport) || (!_g_cport(cport)) || !data)) {
-        gb_error("Invalid cport number: %u\n", cport);
-        return -EINVAL;
-    }
-
-    if (!g_cport(cport).driver || !g_cport(cport).driver->op_handlers) {
-        gb_error("Cport %u does not have a valid driver registered\n", cport);
-        return 0;
-    }
-
-    if (sizeof(*hdr) > size) {
-        gb_error("Dropping garbage request\n");
-        return -EINVAL; /* Dropping garbage request */
-    }
-
-    hdr_size = le16_to_cpu(hdr->size);
+    pthread_attr_t thread_attr;
+    int retval;
 
-    if (hdr_size > size || sizeof(*hdr) > hdr_size) {
-        gb_error("Dropping garbage request\n");
-        return -EINVAL; /* Dropping garbage request */
-    }
+    if (gb_bringup.active)
+        return -EBUSY;
 
-    gb_dump(data, size);
+    list_init(&gb_bringup.jobs);
+    sem_init(&gb_bringup.lock, 0, 1);
+    sem_init(&gb_bringup.work, 0, 0);
+    memset(gb_bringup.busy_groups, 0, sizeof(gb_bringup.busy_groups));
+    gb_bringup.stop = false;
+    gb_bringup.nworkers = 0;
 
-    if (gb_tape && gb_tape_fd >= 0) {
-        struct gb_tape_record_header record_hdr = {
-            .size = size,
-            .cport = cport,
-        };
+    retval = pthread_attr_init(&thread_attr);
+    if (retval)
+        return -retval;
 
-        gb_tape->write(gb_tape_fd, &record_hdr, sizeof(record_hdr));
-        gb_tape->write(gb_tape_fd, data, size);
-    }
+    retval = pthread_attr_setstacksize(&thread_attr,
+                                       CONFIG_GREYBUS_PARALLEL_INIT_STACKSIZE);
+    if (retval)
+        goto out;
 
-    op_handler = find_operation_handler(hdr->type, cport);
-    if (op_handler && op_handler->fast_handler) {
-        gb_debug("%s\n", gb_handler_name(op_handler));
-        op_handler->fast_handler(cport, data);
-        return 0;
+    while (gb_bringup.nworkers < CONFIG_GREYBUS_PARALLEL_INIT_THREADS) {
+        retval = pthread_create(&gb_bringup.workers[gb_bringup.nworkers],
+                                &thread_attr, gb_bringup_worker, NULL);
+        if (retval)
+            break;
+        pthread_setname_np(gb_bringup.workers[gb_bringup.nworkers],
+                           "gb_bringup");
+        gb_bringup.nworkers++;
     }
 
-    op = gb_rx_create_operation(cport, data, hdr_size);
-    if (!op)
-        return -ENOMEM;
-
-    op_mark_recv_time(op);
+    /* a partial pool only makes the bring-up less parallel */
+    if (gb_bringup.nworkers)
+        retval = 0;
 
-    flags = irqsave();
-    list_add(&g_cport(cport).rx_fifo, &op->list);
-    sem_post(&g_cport(cport).rx_fifo_lock);
-    irqrestore(flags);
+    gb_bringup.active = !retval;
 
-    return 0;
+out:
+    pthread_attr_destroy(&thread_attr);
+    return -retval;
 }
 
-static void gb_flush_tx_fifo(unsigned int cport)
+/**
+ * Wait for the end of a parallel CPort bring-up
+ *
+ * Drivers registered after this call are initialized synchronously again.
+ *
+ * @return 0 on success, -EINVAL if no bring-up was started
+ */
+int gb_bringup_wait(void)
 {
-    struct list_head *iter, *iter_next;
-
-    list_foreach_safe(&_g_cport(cport)->tx_fifo, iter, iter_next) {
-        struct gb_operation *op = list_entry(iter, struct gb_operation, list);
-
-        list_del(iter);
-        gb_operation_unref(op);
-    }
-}
+    int i;
 
-int gb_unregister_driver(unsigned int cport)
-{
-    if (!gb_is_valid_cport(cport) || !_g_cport(cport) ||
-		!_g_cport(cport)->driver || !transport_backend)
+    if (!gb_bringup.active)
         return -EINVAL;
 
-    if (transport_backend->stop_listening)
-        transport_backend->stop_listening(cport);
+    sem_wait(&gb_bringup.lock);
+    gb_bringup.stop = true;
+    sem_post(&gb_bringup.lock);
 
-    wd_cancel(&g_cport(cport).timeout_wd);
+    for (i = 0; i < gb_bringup.nworkers; i++)
+        sem_post(&gb_bringup.work);
 
-    g_cport(cport).exit_worker = true;
-    sem_post(&g_cport(cport).rx_fifo_lock);
-    pthread_join(g_cport(cport).thread, NULL);
+    for (i = 0; i < gb_bringup.nworkers; i++)
+        pthread_join(gb_bringup.workers[i], NULL);
 
-    gb_flush_tx_fifo(cport);
+    gb_bringup.active = false;
 
-    if (g_cport(cport).driver->exit)
-        g_cport(cport).driver->exit(cport);
-    _g_cport(cport)->driver = NULL;
+    sem_destroy(&gb_bringup.work);
+    sem_destroy(&gb_bringup.lock);
 
     return 0;
 }
+#endif
 
 int _gb_register_driver(unsigned int cport, struct gb_driver *driver)
 {
-    pthread_attr_t thread_attr;
-    pthread_attr_t *thread_attr_ptr = &thread_attr;
     struct gb_cport_driver *cport_entry;
     int retval;
 
@@ -570,6 +1569,12 @@ int _gb_register_driver(unsigned int cport, struct gb_driver *driver)
         return -EINVAL;
     }
 
+#ifdef CONFIG_GREYBUS_PARALLEL_INIT
+    if (gb_bringup.active && driver->init &&
+        driver->init_group != GB_INIT_GROUP_SYNC)
+        return gb_bringup_queue(cport, driver);
+#endif
+
     if (driver->init) {
         retval = driver->init(cport);
         if (retval) {
@@ -578,48 +1583,15 @@ int _gb_register_driver(unsigned int cport, struct gb_driver *driver)
         }
     }
 
-    if (driver->op_handlers) {
-        qsort(driver->op_handlers, driver->op_handlers_count,
-              sizeof(*driver->op_handlers), gb_compare_handlers);
-    }
-
-    g_cport(cport).exit_worker = false;
-
-    if (!driver->stack_size)
-        driver->stack_size = DEFAULT_STACK_SIZE;
-
-    retval = pthread_attr_init(&thread_attr);
-    if (retval)
-        goto pthread_attr_init_error;
-
-    retval = pthread_attr_setstacksize(&thread_attr, driver->stack_size);
-    if (retval)
-        goto pthread_attr_setstacksize_error;
-
-    gb_debug("add cport %d\n", cport);
-    g_cport_add_entry(cport, NULL);
-
-    retval = pthread_create(&g_cport(cport).thread, &thread_attr,
-                            gb_pending_message_worker, (unsigned*) cport);
-    if (retval)
-        goto pthread_create_error;
-
-    pthread_attr_destroy(&thread_attr);
-    thread_attr_ptr = NULL;
-
-    _g_cport(cport)->driver = driver;
-
-    return 0;
+#ifdef CONFIG_GREYBUS_PARALLEL_INIT
+    while (sem_wait(&gb_driver_start_lock) != OK);
+    retval = gb_driver_start(cport, driver);
+    sem_post(&gb_driver_start_lock);
 
-pthread_create_error:
-pthread_attr_setstacksize_error:
-    if (thread_attr_ptr != NULL)
-        pthread_attr_destroy(&thread_attr);
-pthread_attr_init_error:
-    gb_error("Can not create thread for %s\n: ", gb_driver_name(driver));
-    if (driver->exit)
-        driver->exit(cport);
     return retval;
+#else
+    return gb_driver_start(cport, driver);
+#endif
 }
 
 int gb_listen(unsigned int cport)
@@ -671,8 +1643,7 @@ static void gb_operation_timeout(int argc, uint32_t cport, ...)
         return;
     }
 
-    list_add(&g_cport(cport).rx_fifo, &g_cport(cport).timedout_operation.list);
-    sem_post(&g_cport(cport).rx_fifo_lock);
+    gb_rx_enqueue(_g_cport(cport), &g_cport(cport).timedout_operation);
     irqrestore(flags);
 }
 
@@ -693,8 +1664,6 @@ int gb_operation_send_request(struct gb_operation *operation,
 
     hdr->id = 0;
 
-    flags = irqsave();
-
     if (need_response) {
         hdr->id = cpu_to_le16(atomic_inc(&request_id));
         if (hdr->id == 0) /* ID 0 is for request with no response */
@@ -702,29 +1671,123 @@ int gb_operation_send_request(struct gb_operation *operation,
         clock_gettime(CLOCK_MONOTONIC, &operation->time);
         operation->callback = callback;
         gb_operation_ref(operation);
-        list_add(&g_cport(operation->cport).tx_fifo, &operation->list);
+
+        /*
+         * The operation must be visible to gb_process_response() before the
+         * request goes out, but only the list updates need interrupts off:
+         * the transport send below may block.
+         */
+        flags = gb_irqsave();
+        gb_pending_add(operation);
         if (!WDOG_ISACTIVE(&g_cport(operation->cport).timeout_wd)) {
             wd_start(&g_cport(operation->cport).timeout_wd, TIMEOUT_WD_DELAY,
                      gb_operation_timeout, 1, operation->cport);
         }
+        gb_irqrestore(flags);
     }
 
-    gb_dump(operation->request_buffer, hdr->size);
+    gb_trace_record(GB_TRACE_TX, operation->cport, operation->request_buffer,
+                    le16_to_cpu(hdr->size));
     retval = transport_backend->send(operation->cport,
                                      operation->request_buffer,
                                      le16_to_cpu(hdr->size));
     op_mark_send_time(operation);
     if (need_response && retval) {
-        list_del(&operation->list);
-        gb_watchdog_update(operation->cport);
-        gb_operation_unref(operation);
+        bool pending;
+
+        /* A flush or a timeout may already have taken it off the list */
+        flags = gb_irqsave();
+        pending = !list_is_empty(&operation->pending_list);
+        if (pending && gb_pending_del(operation))
+            gb_watchdog_update(operation->cport);
+        gb_irqrestore(flags);
+
+        if (pending)
+            gb_operation_unref(operation);
     }
 
-    irqrestore(flags);
+    return retval;
+}
+
+static int gb_operation_send_batch_chunk(struct gb_operation **operations,
+                                         size_t count)
+{
+    const void *bufs[GB_BATCH_MAX];
+    size_t lens[GB_BATCH_MAX];
+    struct gb_operation_hdr *hdr;
+    unsigned int cport = operations[0]->cport;
+    int retval = 0;
+    size_t i;
+
+    for (i = 0; i < count; i++) {
+        if (operations[i]->cport != cport)
+            return -EINVAL;
+
+        hdr = operations[i]->request_buffer;
+        hdr->id = 0;
+        gb_trace_record(GB_TRACE_TX, operations[i]->cport,
+                        operations[i]->request_buffer, le16_to_cpu(hdr->size));
+
+        bufs[i] = operations[i]->request_buffer;
+        lens[i] = le16_to_cpu(hdr->size);
+    }
+
+    if (transport_backend->send_batch) {
+        retval = transport_backend->send_batch(cport, bufs, lens, count);
+    } else {
+        for (i = 0; i < count && !retval; i++)
+            retval = transport_backend->send(cport, bufs[i], lens[i]);
+    }
+
+    for (i = 0; i < count; i++)
+        op_mark_send_time(operations[i]);
 
     return retval;
 }
 
+/**
+ * Send several unidirectional requests on the same CPort at once
+ *
+ * This is equivalent to calling gb_operation_send_request() without response
+ * on each operation, but lets the transport queue all the messages at once
+ * when it supports it, which saves a worker wake-up and a completion wait per
+ * message for streaming protocols.
+ *
+ * @param operations Operations to send, all on the same CPort
+ * @param count Number of operations
+ * @return 0 on success, the first error reported by the transport otherwise
+ */
+int gb_operation_send_request_batch(struct gb_operation **operations,
+                                    size_t count)
+{
+    size_t chunk;
+    int retval;
+
+    DEBUGASSERT(transport_backend);
+    DEBUGASSERT(transport_backend->send);
+
+    if (!count)
+        return 0;
+
+    DEBUGASSERT(operations && operations[0]);
+
+    if (g_cport(operations[0]->cport).exit_worker)
+        return -ENETDOWN;
+
+    while (count) {
+        chunk = count > GB_BATCH_MAX ? GB_BATCH_MAX : count;
+
+        retval = gb_operation_send_batch_chunk(operations, chunk);
+        if (retval)
+            return retval;
+
+        operations += chunk;
+        count -= chunk;
+    }
+
+    return 0;
+}
+
 static void gb_operation_callback_sync(struct gb_operation *operation)
 {
     sem_post(&operation->sync_sem);
@@ -797,7 +1860,8 @@ int gb_operation_send_response(struct gb_operation *operation, uint8_t result)
     resp_hdr = operation->response_buffer;
     resp_hdr->result = result;
 
-    gb_dump(operation->response_buffer, resp_hdr->size);
+    gb_trace_record(GB_TRACE_TX, operation->cport, operation->response_buffer,
+                    le16_to_cpu(resp_hdr->size));
     gb_loopback_log_exit(operation->cport, operation, resp_hdr->size);
     retval = transport_backend->send(operation->cport,
                                      operation->response_buffer,
@@ -806,7 +1870,7 @@ int gb_operation_send_response(struct gb_operation *operation, uint8_t result)
         gb_error("Greybus backend failed to send: error %d\n", retval);
         if (has_allocated_response) {
             gb_debug("Free the response buffer\n");
-            transport_backend->free_buf(operation->response_headroom);
+            gb_buf_free(operation->response_headroom);
             operation->response_headroom = NULL;
             operation->response_buffer = NULL;
         }
@@ -825,8 +1889,7 @@ void *gb_operation_alloc_response(struct gb_operation *operation, size_t size)
     DEBUGASSERT(operation);
 
     operation->response_headroom =
-        transport_backend->alloc_buf(
-                size + sizeof(*resp_hdr) + transport_backend->headroom);
+        gb_buf_alloc(size + sizeof(*resp_hdr) + transport_backend->headroom);
     if (!operation->response_headroom) {
         gb_error("Can not allocate a response_buffer\n");
         return NULL;
@@ -870,14 +1933,14 @@ void gb_operation_unref(struct gb_operation *operation)
     if (operation->is_unipro_rx_buf) {
         unipro_rxbuf_free(operation->cport, operation->request_headroom);
     } else {
-        transport_backend->free_buf(operation->request_headroom);
+        gb_buf_free(operation->request_headroom);
     }
 
-    transport_backend->free_buf(operation->response_headroom);
+    gb_buf_free(operation->response_headroom);
     if (operation->response) {
         gb_operation_unref(operation->response);
     }
-    free(operation);
+    gb_operation_free(operation);
 }
 
 static struct gb_operation *_gb_operation_create(unsigned int cport)
@@ -887,7 +1950,11 @@ static struct gb_operation *_gb_operation_create(unsigned int cport)
     if (!gb_is_valid_cport(cport))
         return NULL;
 
-    operation = malloc(sizeof(*operation));
+    operation = gb_slab_alloc_op();
+    if (!operation) {
+        gb_stats_count_alloc();
+        operation = malloc(sizeof(*operation));
+    }
     if (!operation)
         return NULL;
 
@@ -895,6 +1962,7 @@ static struct gb_operation *_gb_operation_create(unsigned int cport)
     operation->cport = cport;
 
     list_init(&operation->list);
+    list_init(&operation->pending_list);
     atomic_init(&operation->ref_count, 1);
 
     return operation;
@@ -915,8 +1983,7 @@ struct gb_operation *gb_operation_create(unsigned int cport, uint8_t type,
     }
 
     operation->request_headroom =
-        transport_backend->alloc_buf(
-                req_size + sizeof(*hdr) + transport_backend->headroom);
+        gb_buf_alloc(req_size + sizeof(*hdr) + transport_backend->headroom);
     if (!operation->request_headroom)
         goto malloc_error;
 
@@ -928,7 +1995,7 @@ struct gb_operation *gb_operation_create(unsigned int cport, uint8_t type,
 
     return operation;
 malloc_error:
-    free(operation);
+    gb_operation_free(operation);
     return NULL;
 }
 
@@ -970,6 +2037,9 @@ uint8_t gb_operation_get_request_result(struct gb_operation *operation)
 
 int gb_init(struct gb_transport_backend *transport)
 {
+    int retval;
+    int i;
+
     if (!transport)
         return -EINVAL;
 
@@ -1003,6 +2073,31 @@ int gb_init(struct gb_transport_backend *transport)
     cport_tbl = rtr_alloc_table();
 
     atomic_init(&request_id, (uint32_t) 0);
+    for (i = 0; i < GB_PENDING_HASH_SIZE; i++)
+        list_init(&gb_pending_hash[i]);
+
+    gb_irqoff_init();
+
+    /* not fatal, operations are just not accounted for */
+    if (gb_stats_init())
+        gb_error("Can not allocate the latency histograms\n");
+
+    retval = gb_slab_init(transport->alloc_buf);
+    if (retval) {
+        rtr_free_table(cport_tbl);
+        cport_tbl = NULL;
+        return retval;
+    }
+
+#ifdef CONFIG_GREYBUS_RX_WORKER_POOL
+    retval = gb_rx_pool_start();
+    if (retval) {
+        gb_slab_deinit(transport->free_buf);
+        rtr_free_table(cport_tbl);
+        cport_tbl = NULL;
+        return retval;
+    }
+#endif
 
     transport_backend = transport;
     transport_backend->init();
@@ -1037,6 +2132,12 @@ void gb_deinit(void)
     rtr_free_table(cport_tbl);
     cport_tbl = NULL;
 
+#ifdef CONFIG_GREYBUS_RX_WORKER_POOL
+    gb_rx_pool_stop();
+#endif
+
+    gb_slab_deinit(transport_backend->free_buf);
+
     if (transport_backend->exit)
         transport_backend->exit();
     transport_backend = NULL;
@@ -1058,6 +2159,8 @@ int gb_tape_register_mechanism(struct gb_tape_mechanism *mechanism)
 
 int gb_tape_communication(const char *pathname)
 {
+    int retval;
+
     if (!gb_tape)
         return -EINVAL;
 
@@ -1068,7 +2171,13 @@ int gb_tape_communication(const char *pathname)
     if (gb_tape_fd < 0)
         return gb_tape_fd;
 
-    return 0;
+    retval = gb_trace_tape_start(gb_tape, gb_tape_fd);
+    if (retval) {
+        gb_tape->close(gb_tape_fd);
+        gb_tape_fd = -EBADFD;
+    }
+
+    return retval;
 }
 
 int gb_tape_stop(void)
@@ -1076,6 +2185,7 @@ int gb_tape_stop(void)
     if (!gb_tape || gb_tape_fd < 0)
         return -EINVAL;
 
+    gb_trace_tape_stop();
     gb_tape->close(gb_tape_fd);
     gb_tape_fd = -EBADFD;
 
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <nuttx/config.h>
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#include <arch/irq.h>
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "greybus-irqoff.h"
+
+#define GB_DEMCR                (*(volatile uint32_t *) 0xe000edfc)
+#define GB_DEMCR_TRCENA         (1 << 24)
+#define GB_DWT_CTRL             (*(volatile uint32_t *) 0xe0001000)
+#define GB_DWT_CTRL_CYCCNTENA   (1 << 0)
+
+uint32_t gb_irqoff_start;
+
+static struct {
+    uint32_t count;
+    uint32_t max;
+    uint64_t total;
+} gb_irqoff_stats;
+
+/* Called with interrupts disabled, right before they are restored */
+void gb_irqoff_record(uint32_t cycles)
+{
+    gb_irqoff_stats.count++;
+    gb_irqoff_stats.total += cycles;
+    if (cycles > gb_irqoff_stats.max)
+        gb_irqoff_stats.max = cycles;
+}
+
+void gb_irqoff_init(void)
+{
+    GB_DEMCR |= GB_DEMCR_TRCENA;
+    GB_DWT_CTRL |= GB_DWT_CTRL_CYCCNTENA;
+
+    memset(&gb_irqoff_stats, 0, sizeof(gb_irqoff_stats));
+}
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+
+#define GB_IRQOFF_BUFLEN    128
+
+struct gb_irqoff_file_s {
+    struct procfs_file_s base;
+    size_t len;
+    char buf[GB_IRQOFF_BUFLEN];
+};
+
+static int gb_irqoff_open(FAR struct file *filep, FAR const char *relpath,
+                          int oflags, mode_t mode)
+{
+    FAR struct gb_irqoff_file_s *priv;
+
+    if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+        return -EACCES;
+
+    priv = kmm_zalloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    filep->f_priv = priv;
+    return OK;
+}
+
+static int gb_irqoff_close(FAR struct file *filep)
+{
+    kmm_free(filep->f_priv);
+    filep->f_priv = NULL;
+    return OK;
+}
+
+static ssize_t gb_irqoff_read(FAR struct file *filep, FAR char *buffer,
+                              size_t buflen)
+{
+    FAR struct gb_irqoff_file_s *priv = filep->f_priv;
+    uint32_t count, max;
+    uint64_t total;
+    irqstate_t flags;
+    off_t offset;
+    ssize_t ret;
+
+    /* Take a snapshot on the first read so that the content stays stable */
+    if (filep->f_pos == 0) {
+        flags = irqsave();
+        count = gb_irqoff_stats.count;
+        max = gb_irqoff_stats.max;
+        total = gb_irqoff_stats.total;
+        irqrestore(flags);
+
+        priv->len = snprintf(priv->buf, GB_IRQOFF_BUFLEN,
+                             "sections %u\nmax %u cycles\navg %u cycles\n",
+                             (unsigned int) count, (unsigned int) max,
+                             count ? (unsigned int) (total / count) : 0);
+    }
+
+    offset = filep->f_pos;
+    ret = procfs_memcpy(priv->buf, priv->len, buffer, buflen, &offset);
+    if (ret > 0)
+        filep->f_pos += ret;
+
+    return ret;
+}
+
+static int gb_irqoff_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+    FAR struct gb_irqoff_file_s *priv;
+
+    priv = kmm_malloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    memcpy(priv, oldp->f_priv, sizeof(*priv));
+    newp->f_priv = priv;
+    return OK;
+}
+
+static int gb_irqoff_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+    buf->st_mode    = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+    buf->st_size    = 0;
+    buf->st_blksize = 0;
+    buf->st_blocks  = 0;
+    return OK;
+}
+
+/* See fs_procfs.c -- this structure is explicitly externed there */
+const struct procfs_operations gb_irqoff_procfsoperations = {
+    gb_irqoff_open,     /* open */
+    gb_irqoff_close,    /* close */
+    gb_irqoff_read,     /* read */
+    NULL,               /* write */
+
+    gb_irqoff_dup,      /* dup */
+
+    NULL,               /* opendir */
+    NULL,               /* closedir */
+    NULL,               /* readdir */
+    NULL,               /* rewinddir */
+
+    gb_irqoff_stat      /* stat */
+};
+#endif
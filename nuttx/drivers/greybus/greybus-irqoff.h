@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GREYBUS_IRQOFF_H_
+#define _GREYBUS_IRQOFF_H_
+
+#include <nuttx/config.h>
+#include <nuttx/irq.h>
+
+#include <arch/irq.h>
+
+#include <stdint.h>
+
+/*
+ * Measurement of the time greybus-core spends with interrupts disabled.
+ *
+ * gb_irqsave() and gb_irqrestore() are drop-in replacements for irqsave()
+ * and irqrestore() around the critical sections of the operation path. When
+ * CONFIG_GREYBUS_IRQOFF_STATS is enabled, the length of each section is
+ * measured with the Cortex-M DWT cycle counter and summarized in
+ * /proc/greybus/irqoff.
+ */
+
+#ifdef CONFIG_GREYBUS_IRQOFF_STATS
+#define GB_DWT_CYCCNT   (*(volatile uint32_t *) 0xe0001004)
+
+extern uint32_t gb_irqoff_start;
+
+void gb_irqoff_init(void);
+void gb_irqoff_record(uint32_t cycles);
+
+static inline irqstate_t gb_irqsave(void)
+{
+    irqstate_t flags = irqsave();
+
+    gb_irqoff_start = GB_DWT_CYCCNT;
+    return flags;
+}
+
+static inline void gb_irqrestore(irqstate_t flags)
+{
+    gb_irqoff_record(GB_DWT_CYCCNT - gb_irqoff_start);
+    irqrestore(flags);
+}
+#else
+static inline void gb_irqoff_init(void)
+{
+}
+
+static inline irqstate_t gb_irqsave(void)
+{
+    return irqsave();
+}
+
+static inline void gb_irqrestore(irqstate_t flags)
+{
+    irqrestore(flags);
+}
+#endif
+
+#endif /* _GREYBUS_IRQOFF_H_ */
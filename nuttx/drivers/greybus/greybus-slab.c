@@ -0,0 +1,355 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <nuttx/config.h>
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/greybus/greybus.h>
+#include <nuttx/greybus/debug.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#include <arch/irq.h>
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "greybus-slab.h"
+
+#define GB_SLAB_ALIGN(x)    (((x) + 7) & ~7)
+
+struct gb_slab_cache {
+    const char *name;
+    size_t obj_size;
+    unsigned int nobjs;
+
+    char *base;
+    char *end;
+    void *free_list;
+
+    unsigned int in_use;
+    unsigned int hwm;
+    unsigned int misses;
+};
+
+static struct gb_slab_cache gb_op_cache = {
+    .name = "op",
+    .nobjs = CONFIG_GREYBUS_SLAB_NR_OPS,
+};
+
+static struct gb_slab_cache gb_buf_caches[] = {
+    { .name = "buf64", .obj_size = 64, .nobjs = CONFIG_GREYBUS_SLAB_NR_64 },
+    { .name = "buf256", .obj_size = 256, .nobjs = CONFIG_GREYBUS_SLAB_NR_256 },
+    { .name = "buf1024", .obj_size = 1024,
+      .nobjs = CONFIG_GREYBUS_SLAB_NR_1024 },
+    { .name = "buf2048", .obj_size = 2048,
+      .nobjs = CONFIG_GREYBUS_SLAB_NR_2048 },
+};
+
+static void gb_slab_cache_setup(struct gb_slab_cache *cache, void *mem)
+{
+    unsigned int i;
+    char *obj;
+
+    cache->free_list = NULL;
+    cache->in_use = 0;
+    cache->hwm = 0;
+    cache->misses = 0;
+
+    cache->base = mem;
+    cache->end = mem ? cache->base + cache->obj_size * cache->nobjs : NULL;
+    if (!mem)
+        return;
+
+    for (i = cache->nobjs; i > 0; i--) {
+        obj = cache->base + (i - 1) * cache->obj_size;
+        *(void **)obj = cache->free_list;
+        cache->free_list = obj;
+    }
+}
+
+/**
+ * Pop an object from the cache free list
+ *
+ * The free list is only touched with interrupts masked for a few
+ * instructions, so allocations and releases are safe from interrupt context.
+ */
+static void *gb_slab_cache_alloc(struct gb_slab_cache *cache)
+{
+    irqstate_t flags;
+    void *obj;
+
+    flags = irqsave();
+
+    obj = cache->free_list;
+    if (obj) {
+        cache->free_list = *(void **)obj;
+        if (++cache->in_use > cache->hwm)
+            cache->hwm = cache->in_use;
+    } else {
+        cache->misses++;
+    }
+
+    irqrestore(flags);
+
+    return obj;
+}
+
+static bool gb_slab_cache_free(struct gb_slab_cache *cache, void *ptr)
+{
+    irqstate_t flags;
+
+    if ((char *)ptr < cache->base || (char *)ptr >= cache->end)
+        return false;
+
+    flags = irqsave();
+
+    *(void **)ptr = cache->free_list;
+    cache->free_list = ptr;
+    cache->in_use--;
+
+    irqrestore(flags);
+
+    return true;
+}
+
+void *gb_slab_alloc_op(void)
+{
+    return gb_slab_cache_alloc(&gb_op_cache);
+}
+
+bool gb_slab_free_op(void *ptr)
+{
+    return gb_slab_cache_free(&gb_op_cache, ptr);
+}
+
+void *gb_slab_alloc_buf(size_t size)
+{
+    struct gb_slab_cache *cache;
+    void *buf;
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(gb_buf_caches); i++) {
+        cache = &gb_buf_caches[i];
+        if (size > cache->obj_size || !cache->base)
+            continue;
+
+        buf = gb_slab_cache_alloc(cache);
+        if (buf) {
+            /* Transport allocators hand out zeroed memory */
+            memset(buf, 0, size);
+            return buf;
+        }
+    }
+
+    return NULL;
+}
+
+bool gb_slab_free_buf(void *ptr)
+{
+    int i;
+
+    if (!ptr)
+        return false;
+
+    for (i = 0; i < ARRAY_SIZE(gb_buf_caches); i++) {
+        if (gb_slab_cache_free(&gb_buf_caches[i], ptr))
+            return true;
+    }
+
+    return false;
+}
+
+int gb_slab_init(void *(*alloc_buf)(size_t size))
+{
+    struct gb_slab_cache *cache;
+    void *mem;
+    int i;
+
+    gb_op_cache.obj_size = GB_SLAB_ALIGN(sizeof(struct gb_operation));
+    mem = gb_op_cache.nobjs ?
+          malloc(gb_op_cache.obj_size * gb_op_cache.nobjs) : NULL;
+    if (gb_op_cache.nobjs && !mem)
+        return -ENOMEM;
+    gb_slab_cache_setup(&gb_op_cache, mem);
+
+    /*
+     * Payload caches are carved out of transport memory since some transports
+     * need their buffers in a specific memory region. A cache that cannot be
+     * reserved is simply disabled and its requests go to the transport.
+     */
+    for (i = 0; i < ARRAY_SIZE(gb_buf_caches); i++) {
+        cache = &gb_buf_caches[i];
+        mem = cache->nobjs ? alloc_buf(cache->obj_size * cache->nobjs) : NULL;
+        if (cache->nobjs && !mem)
+            gb_error("Can not reserve the %s cache\n", cache->name);
+        gb_slab_cache_setup(cache, mem);
+    }
+
+    return 0;
+}
+
+void gb_slab_deinit(void (*free_buf)(void *ptr))
+{
+    int i;
+
+    free(gb_op_cache.base);
+    gb_slab_cache_setup(&gb_op_cache, NULL);
+
+    for (i = 0; i < ARRAY_SIZE(gb_buf_caches); i++) {
+        if (gb_buf_caches[i].base)
+            free_buf(gb_buf_caches[i].base);
+        gb_slab_cache_setup(&gb_buf_caches[i], NULL);
+    }
+}
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+
+#define GB_SLAB_LINELEN     48
+#define GB_SLAB_BUFLEN      ((ARRAY_SIZE(gb_buf_caches) + 2) * GB_SLAB_LINELEN)
+
+struct gb_slab_file_s {
+    struct procfs_file_s base;
+    size_t len;
+    char buf[GB_SLAB_BUFLEN];
+};
+
+static size_t gb_slab_format(struct gb_slab_cache *cache, char *buf,
+                             size_t len)
+{
+    irqstate_t flags;
+    unsigned int in_use, hwm, misses;
+
+    flags = irqsave();
+    in_use = cache->in_use;
+    hwm = cache->hwm;
+    misses = cache->misses;
+    irqrestore(flags);
+
+    return snprintf(buf, len, "%-8s %5u %5u %5u %5u %7u\n", cache->name,
+                    (unsigned int)cache->obj_size,
+                    cache->base ? cache->nobjs : 0, in_use, hwm, misses);
+}
+
+static int gb_slab_open(FAR struct file *filep, FAR const char *relpath,
+                        int oflags, mode_t mode)
+{
+    FAR struct gb_slab_file_s *priv;
+
+    if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+        return -EACCES;
+
+    priv = kmm_zalloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    filep->f_priv = priv;
+    return OK;
+}
+
+static int gb_slab_close(FAR struct file *filep)
+{
+    kmm_free(filep->f_priv);
+    filep->f_priv = NULL;
+    return OK;
+}
+
+static ssize_t gb_slab_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen)
+{
+    FAR struct gb_slab_file_s *priv = filep->f_priv;
+    off_t offset;
+    ssize_t ret;
+    int i;
+
+    /* Take a snapshot on the first read so that the content stays stable */
+    if (filep->f_pos == 0) {
+        priv->len = snprintf(priv->buf, GB_SLAB_BUFLEN,
+                             "%-8s %5s %5s %5s %5s %7s\n", "cache", "size",
+                             "total", "used", "hwm", "misses");
+        priv->len += gb_slab_format(&gb_op_cache, priv->buf + priv->len,
+                                    GB_SLAB_BUFLEN - priv->len);
+        for (i = 0; i < ARRAY_SIZE(gb_buf_caches); i++) {
+            priv->len += gb_slab_format(&gb_buf_caches[i],
+                                        priv->buf + priv->len,
+                                        GB_SLAB_BUFLEN - priv->len);
+        }
+    }
+
+    offset = filep->f_pos;
+    ret = procfs_memcpy(priv->buf, priv->len, buffer, buflen, &offset);
+    if (ret > 0)
+        filep->f_pos += ret;
+
+    return ret;
+}
+
+static int gb_slab_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+    FAR struct gb_slab_file_s *priv;
+
+    priv = kmm_malloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    memcpy(priv, oldp->f_priv, sizeof(*priv));
+    newp->f_priv = priv;
+    return OK;
+}
+
+static int gb_slab_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+    buf->st_mode    = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+    buf->st_size    = 0;
+    buf->st_blksize = 0;
+    buf->st_blocks  = 0;
+    return OK;
+}
+
+/* See fs_procfs.c -- this structure is explicitly externed there */
+const struct procfs_operations gb_slab_procfsoperations = {
+    gb_slab_open,       /* open */
+    gb_slab_close,      /* close */
+    gb_slab_read,       /* read */
+    NULL,               /* write */
+
+    gb_slab_dup,        /* dup */
+
+    NULL,               /* opendir */
+    NULL,               /* closedir */
+    NULL,               /* readdir */
+    NULL,               /* rewinddir */
+
+    gb_slab_stat        /* stat */
+};
+#endif
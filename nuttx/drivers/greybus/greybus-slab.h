@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GREYBUS_SLAB_H_
+#define _GREYBUS_SLAB_H_
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Fixed-size object caches for the operation fast path.
+ *
+ * When CONFIG_GREYBUS_SLAB is enabled, greybus-core takes struct gb_operation
+ * objects and transport buffers (headroom included) from caches reserved when
+ * the transport is initialized. The allocation functions return NULL when no
+ * cache can serve the request, and the free functions return false when the
+ * pointer does not belong to a cache, so the caller can fall back to the heap
+ * or to the transport allocator.
+ */
+
+#ifdef CONFIG_GREYBUS_SLAB
+int gb_slab_init(void *(*alloc_buf)(size_t size));
+void gb_slab_deinit(void (*free_buf)(void *ptr));
+
+void *gb_slab_alloc_op(void);
+bool gb_slab_free_op(void *ptr);
+
+void *gb_slab_alloc_buf(size_t size);
+bool gb_slab_free_buf(void *ptr);
+#else
+static inline int gb_slab_init(void *(*alloc_buf)(size_t size))
+{
+    return 0;
+}
+
+static inline void gb_slab_deinit(void (*free_buf)(void *ptr))
+{
+}
+
+static inline void *gb_slab_alloc_op(void)
+{
+    return NULL;
+}
+
+static inline bool gb_slab_free_op(void *ptr)
+{
+    return false;
+}
+
+static inline void *gb_slab_alloc_buf(size_t size)
+{
+    return NULL;
+}
+
+static inline bool gb_slab_free_buf(void *ptr)
+{
+    return false;
+}
+#endif
+
+#endif /* _GREYBUS_SLAB_H_ */
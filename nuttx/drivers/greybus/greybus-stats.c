@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <nuttx/config.h>
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+#include <nuttx/greybus/stats.h>
+
+#include <arch/atomic.h>
+#include <arch/irq.h>
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "greybus-stats.h"
+
+#define GB_STATS_SLOTS      CONFIG_GREYBUS_STATS_SLOTS
+#define GB_STATS_HASH(cport, type) \
+    ((((cport) << 3) ^ (type)) % GB_STATS_SLOTS)
+
+static const char *gb_stats_kind_names[GB_STATS_KIND_COUNT] = {
+    [GB_STATS_QUEUE] = "queue",
+    [GB_STATS_HANDLER] = "handler",
+    [GB_STATS_ROUND_TRIP] = "rtt",
+};
+
+struct gb_stats_slot {
+    bool used;
+    struct gb_stats_entry entry;
+};
+
+static struct gb_stats_slot *gb_stats_slots;
+static uint32_t gb_stats_dropped;
+static atomic_t gb_stats_allocs;
+
+int gb_stats_init(void)
+{
+    if (gb_stats_slots)
+        return 0;
+
+    gb_stats_slots = zalloc(GB_STATS_SLOTS * sizeof(*gb_stats_slots));
+    return gb_stats_slots ? 0 : -ENOMEM;
+}
+
+static unsigned int gb_stats_bucket(uint32_t delta_us)
+{
+    unsigned int bucket = 0;
+
+    while (delta_us >>= 1)
+        bucket++;
+
+    return bucket < GB_STATS_BUCKETS ? bucket : GB_STATS_BUCKETS - 1;
+}
+
+/**
+ * Find the slot of a CPort and operation type, claiming a free one if needed
+ *
+ * @note This function should be called from an atomic context
+ */
+static struct gb_stats_slot *gb_stats_lookup(unsigned int cport, uint8_t type)
+{
+    struct gb_stats_slot *slot;
+    unsigned int i, n;
+
+    i = GB_STATS_HASH(cport, type);
+    for (n = 0; n < GB_STATS_SLOTS; n++, i = (i + 1) % GB_STATS_SLOTS) {
+        slot = &gb_stats_slots[i];
+
+        if (!slot->used) {
+            slot->used = true;
+            slot->entry.cport = cport;
+            slot->entry.type = type;
+            return slot;
+        }
+
+        if (slot->entry.cport == cport && slot->entry.type == type)
+            return slot;
+    }
+
+    return NULL;
+}
+
+void gb_stats_record(unsigned int cport, uint8_t type,
+                     enum gb_stats_kind kind, uint32_t delta_us)
+{
+    struct gb_stats_histogram *hist;
+    struct gb_stats_slot *slot;
+    irqstate_t flags;
+
+    if (!gb_stats_slots)
+        return;
+
+    flags = irqsave();
+
+    slot = gb_stats_lookup(cport, type);
+    if (!slot) {
+        gb_stats_dropped++;
+        irqrestore(flags);
+        return;
+    }
+
+    hist = &slot->entry.hist[kind];
+    hist->count++;
+    hist->buckets[gb_stats_bucket(delta_us)]++;
+    if (delta_us > hist->max_us)
+        hist->max_us = delta_us;
+
+    irqrestore(flags);
+}
+
+void gb_stats_count_alloc(void)
+{
+    atomic_inc(&gb_stats_allocs);
+}
+
+/**
+ * Number of operations and buffers allocated from the heap or the transport
+ *
+ * Allocations served by the slab caches are not counted, nonzero values
+ * in a steady state show that the caches are too small.
+ */
+uint32_t gb_stats_allocations(void)
+{
+    return atomic_get(&gb_stats_allocs);
+}
+
+/**
+ * Get a snapshot of the histograms of a CPort and operation type
+ *
+ * @param index Index of the entry, starting from 0
+ * @param entry Filled with the histograms
+ * @return 0 on success, -ENOENT past the last entry
+ */
+int gb_stats_get(unsigned int index, struct gb_stats_entry *entry)
+{
+    irqstate_t flags;
+    unsigned int i;
+
+    if (!gb_stats_slots)
+        return -ENOENT;
+
+    for (i = 0; i < GB_STATS_SLOTS; i++) {
+        if (!gb_stats_slots[i].used || index--)
+            continue;
+
+        flags = irqsave();
+        memcpy(entry, &gb_stats_slots[i].entry, sizeof(*entry));
+        irqrestore(flags);
+        return 0;
+    }
+
+    return -ENOENT;
+}
+
+/**
+ * Format the histograms of an entry, one line per kind of latency
+ *
+ * Only the populated buckets are shown, labelled with their lower bound in
+ * microseconds.
+ *
+ * @return number of characters written, truncated to len
+ */
+ssize_t gb_stats_format(const struct gb_stats_entry *entry, char *buf,
+                        size_t len)
+{
+    const struct gb_stats_histogram *hist;
+    size_t n = 0;
+    int kind, i;
+
+    for (kind = 0; kind < GB_STATS_KIND_COUNT && n < len; kind++) {
+        hist = &entry->hist[kind];
+        if (!hist->count)
+            continue;
+
+        n += snprintf(buf + n, len - n, "%3u 0x%02x %-7s %7u %7u |",
+                      entry->cport, entry->type, gb_stats_kind_names[kind],
+                      (unsigned int) hist->count,
+                      (unsigned int) hist->max_us);
+
+        for (i = 0; i < GB_STATS_BUCKETS && n < len; i++) {
+            if (hist->buckets[i]) {
+                n += snprintf(buf + n, len - n, " %u:%u", 1u << i,
+                              (unsigned int) hist->buckets[i]);
+            }
+        }
+
+        if (n < len)
+            n += snprintf(buf + n, len - n, "\n");
+    }
+
+    return n < len ? n : len;
+}
+
+void gb_stats_reset(void)
+{
+    irqstate_t flags;
+    int i;
+
+    if (!gb_stats_slots)
+        return;
+
+    /* one slot at a time, to keep the interrupts latency low */
+    for (i = 0; i < GB_STATS_SLOTS; i++) {
+        flags = irqsave();
+        memset(&gb_stats_slots[i], 0, sizeof(gb_stats_slots[i]));
+        irqrestore(flags);
+    }
+
+    gb_stats_dropped = 0;
+    atomic_init(&gb_stats_allocs, 0);
+}
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+
+#define GB_STATS_LINELEN    (40 + GB_STATS_BUCKETS * 12)
+#define GB_STATS_BUFLEN     (GB_STATS_KIND_COUNT * GB_STATS_LINELEN)
+
+/* The entries are formatted one at a time, as the file is being read */
+struct gb_stats_file_s {
+    struct procfs_file_s base;
+    unsigned int index;
+    size_t pos;
+    size_t len;
+    char buf[GB_STATS_BUFLEN];
+};
+
+static int gb_stats_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+    FAR struct gb_stats_file_s *priv;
+
+    priv = kmm_zalloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    filep->f_priv = priv;
+    return OK;
+}
+
+static int gb_stats_close(FAR struct file *filep)
+{
+    kmm_free(filep->f_priv);
+    filep->f_priv = NULL;
+    return OK;
+}
+
+static ssize_t gb_stats_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+    FAR struct gb_stats_file_s *priv = filep->f_priv;
+    struct gb_stats_entry entry;
+    size_t copied = 0;
+    size_t n;
+
+    if (filep->f_pos == 0) {
+        priv->index = 0;
+        priv->pos = 0;
+        priv->len = snprintf(priv->buf, GB_STATS_BUFLEN,
+                             "%3s %4s %-7s %7s %7s | %s (dropped %u)\n",
+                             "cp", "type", "kind", "count", "max_us",
+                             "us:count", (unsigned int) gb_stats_dropped);
+    }
+
+    while (copied < buflen) {
+        if (priv->pos == priv->len) {
+            if (gb_stats_get(priv->index, &entry))
+                break;
+
+            priv->index++;
+            priv->pos = 0;
+            priv->len = gb_stats_format(&entry, priv->buf, GB_STATS_BUFLEN);
+            continue;
+        }
+
+        n = priv->len - priv->pos;
+        if (n > buflen - copied)
+            n = buflen - copied;
+
+        memcpy(buffer + copied, priv->buf + priv->pos, n);
+        priv->pos += n;
+        copied += n;
+    }
+
+    filep->f_pos += copied;
+    return copied;
+}
+
+/* Writing anything resets the histograms */
+static ssize_t gb_stats_write(FAR struct file *filep, FAR const char *buffer,
+                              size_t buflen)
+{
+    gb_stats_reset();
+    return buflen;
+}
+
+static int gb_stats_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+    FAR struct gb_stats_file_s *priv;
+
+    priv = kmm_malloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    memcpy(priv, oldp->f_priv, sizeof(*priv));
+    newp->f_priv = priv;
+    return OK;
+}
+
+static int gb_stats_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+    buf->st_mode    = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+    buf->st_size    = 0;
+    buf->st_blksize = 0;
+    buf->st_blocks  = 0;
+    return OK;
+}
+
+/* See fs_procfs.c -- this structure is explicitly externed there */
+const struct procfs_operations gb_stats_procfsoperations = {
+    gb_stats_open,      /* open */
+    gb_stats_close,     /* close */
+    gb_stats_read,      /* read */
+    gb_stats_write,     /* write */
+
+    gb_stats_dup,       /* dup */
+
+    NULL,               /* opendir */
+    NULL,               /* closedir */
+    NULL,               /* readdir */
+    NULL,               /* rewinddir */
+
+    gb_stats_stat       /* stat */
+};
+#endif
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GREYBUS_STATS_INTERNAL_H_
+#define _GREYBUS_STATS_INTERNAL_H_
+
+#include <nuttx/config.h>
+#include <nuttx/greybus/stats.h>
+
+#include <stdint.h>
+#include <time.h>
+
+/*
+ * Recording side of the latency histograms. Times are taken in microseconds
+ * with gb_stats_now(). Everything compiles away when CONFIG_GREYBUS_STATS is
+ * disabled.
+ */
+
+#ifdef CONFIG_GREYBUS_STATS
+int gb_stats_init(void);
+void gb_stats_record(unsigned int cport, uint8_t type,
+                     enum gb_stats_kind kind, uint32_t delta_us);
+void gb_stats_count_alloc(void);
+
+static inline uint32_t gb_stats_timespec_us(const struct timespec *ts)
+{
+    return ts->tv_sec * 1000000 + ts->tv_nsec / 1000;
+}
+
+static inline uint32_t gb_stats_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return gb_stats_timespec_us(&ts);
+}
+#else
+static inline int gb_stats_init(void)
+{
+    return 0;
+}
+
+static inline void gb_stats_record(unsigned int cport, uint8_t type,
+                                   enum gb_stats_kind kind, uint32_t delta_us)
+{
+}
+
+static inline void gb_stats_count_alloc(void)
+{
+}
+
+static inline uint32_t gb_stats_timespec_us(const struct timespec *ts)
+{
+    return 0;
+}
+
+static inline uint32_t gb_stats_now(void)
+{
+    return 0;
+}
+#endif
+
+#endif /* _GREYBUS_STATS_INTERNAL_H_ */
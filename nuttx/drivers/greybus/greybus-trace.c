@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <nuttx/config.h>
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+#include <nuttx/greybus/debug.h>
+#include <nuttx/greybus/greybus.h>
+
+#include <arch/atomic.h>
+
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "greybus-trace.h"
+
+#define GB_TRACE_ENTRIES        CONFIG_GREYBUS_TRACE_ENTRIES
+#define GB_TRACE_MASK           (GB_TRACE_ENTRIES - 1)
+#define GB_TRACE_DATA_SIZE      CONFIG_GREYBUS_TRACE_DATA_SIZE
+
+#if (GB_TRACE_ENTRIES & GB_TRACE_MASK) != 0
+#error "CONFIG_GREYBUS_TRACE_ENTRIES must be a power of 2"
+#endif
+
+#ifdef CONFIG_SCHED_LPWORK
+#define GB_TRACE_WORK           LPWORK
+#else
+#define GB_TRACE_WORK           HPWORK
+#endif
+
+/* Let a few messages accumulate before waking up the tape worker */
+#define GB_TRACE_DRAIN_DELAY    MSEC2TICK(20)
+
+#define gb_trace_barrier()      __asm__ __volatile__("" ::: "memory")
+
+struct gb_trace_entry {
+    /* index + 1 of the message once fully written, 0 while being written */
+    volatile uint32_t seq;
+    uint32_t timestamp; /* in microseconds */
+    uint16_t cport;
+    uint16_t size;
+    uint16_t len;
+    uint8_t dir;
+    uint8_t data[GB_TRACE_DATA_SIZE];
+};
+
+volatile bool gb_trace_enabled;
+
+static struct gb_trace_entry *gb_trace_ring;
+static atomic_t gb_trace_head;
+
+#ifdef CONFIG_SCHED_WORKQUEUE
+static struct {
+    struct gb_tape_mechanism *mechanism;
+    int fd;
+    uint32_t tail;
+    uint32_t lost;
+    bool enabled_tracing;
+    atomic_t kicked;
+    sem_t lock;
+    struct work_s work;
+} gb_trace_tape = {
+    .lock = SEM_INITIALIZER(1),
+};
+
+static void gb_trace_tape_worker(FAR void *arg);
+#endif
+
+void _gb_trace_record(enum gb_trace_dir dir, unsigned int cport,
+                      const void *data, size_t size)
+{
+    struct gb_trace_entry *entry;
+    struct timespec ts;
+    uint32_t idx;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    idx = atomic_inc(&gb_trace_head) - 1;
+    entry = &gb_trace_ring[idx & GB_TRACE_MASK];
+
+    entry->seq = 0;
+    gb_trace_barrier();
+
+    entry->timestamp = ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
+    entry->cport = cport;
+    entry->size = size;
+    entry->len = size < GB_TRACE_DATA_SIZE ? size : GB_TRACE_DATA_SIZE;
+    entry->dir = dir;
+    memcpy(entry->data, data, entry->len);
+
+    gb_trace_barrier();
+    entry->seq = idx + 1;
+
+#ifdef CONFIG_SCHED_WORKQUEUE
+    if (dir == GB_TRACE_RX && gb_trace_tape.mechanism &&
+        atomic_inc(&gb_trace_tape.kicked) == 1) {
+        work_queue(GB_TRACE_WORK, &gb_trace_tape.work, gb_trace_tape_worker,
+                   NULL, GB_TRACE_DRAIN_DELAY);
+    }
+#endif
+}
+
+/**
+ * Copy a ring entry
+ *
+ * @return 0 on success, -EAGAIN if the entry is still being written and
+ *         -ENOENT if it has already been overwritten
+ */
+static int gb_trace_read_entry(uint32_t idx, struct gb_trace_entry *entry)
+{
+    struct gb_trace_entry *slot = &gb_trace_ring[idx & GB_TRACE_MASK];
+    uint32_t seq = slot->seq;
+
+    if (seq != idx + 1)
+        return seq ? -ENOENT : -EAGAIN;
+
+    memcpy(entry, slot, sizeof(*entry));
+
+    /* a writer may have reclaimed the slot while we were copying it */
+    gb_trace_barrier();
+    return slot->seq == idx + 1 ? 0 : -ENOENT;
+}
+
+int gb_trace_enable(void)
+{
+    /* the ring is never freed, as writers do not take any lock */
+    if (!gb_trace_ring) {
+        gb_trace_ring = zalloc(GB_TRACE_ENTRIES * sizeof(*gb_trace_ring));
+        if (!gb_trace_ring)
+            return -ENOMEM;
+    }
+
+    gb_trace_enabled = true;
+    return 0;
+}
+
+void gb_trace_disable(void)
+{
+    gb_trace_enabled = false;
+}
+
+#ifdef CONFIG_SCHED_WORKQUEUE
+/* Write the received messages to the tape. Called with the tape lock held */
+static void gb_trace_tape_drain(struct gb_tape_mechanism *tape)
+{
+    struct gb_tape_record_header record_hdr;
+    struct gb_trace_entry entry;
+    uint32_t head = atomic_get(&gb_trace_head);
+    int ret;
+
+    if (head - gb_trace_tape.tail > GB_TRACE_ENTRIES) {
+        gb_trace_tape.lost += head - gb_trace_tape.tail - GB_TRACE_ENTRIES;
+        gb_trace_tape.tail = head - GB_TRACE_ENTRIES;
+    }
+
+    for (; gb_trace_tape.tail != head; gb_trace_tape.tail++) {
+        ret = gb_trace_read_entry(gb_trace_tape.tail, &entry);
+        if (ret == -EAGAIN)
+            break;
+
+        if (ret) {
+            gb_trace_tape.lost++;
+            continue;
+        }
+
+        if (entry.dir != GB_TRACE_RX)
+            continue;
+
+        record_hdr.size = entry.len;
+        record_hdr.cport = entry.cport;
+
+        tape->write(gb_trace_tape.fd, &record_hdr, sizeof(record_hdr));
+        tape->write(gb_trace_tape.fd, entry.data, entry.len);
+    }
+}
+
+static void gb_trace_tape_lock(void)
+{
+    while (sem_wait(&gb_trace_tape.lock) < 0 && errno == EINTR);
+}
+
+static void gb_trace_tape_worker(FAR void *arg)
+{
+    struct gb_tape_mechanism *tape;
+
+    atomic_init(&gb_trace_tape.kicked, 0);
+
+    gb_trace_tape_lock();
+    tape = gb_trace_tape.mechanism;
+    if (tape)
+        gb_trace_tape_drain(tape);
+    sem_post(&gb_trace_tape.lock);
+}
+
+/**
+ * Record the received messages to a tape
+ *
+ * The messages are written, by a work queue, with only their first
+ * CONFIG_GREYBUS_TRACE_DATA_SIZE bytes. That option must be at least as
+ * large as the biggest message for the tape to be replayable.
+ *
+ * @param tape Tape mechanism
+ * @param fd Tape file, opened for writing
+ * @return 0 on success, a negative errno otherwise
+ */
+int gb_trace_tape_start(struct gb_tape_mechanism *tape, int fd)
+{
+    int ret;
+
+    gb_trace_tape.enabled_tracing = !gb_trace_enabled;
+    ret = gb_trace_enable();
+    if (ret)
+        return ret;
+
+    gb_trace_tape.fd = fd;
+    gb_trace_tape.tail = atomic_get(&gb_trace_head);
+    gb_trace_tape.lost = 0;
+    atomic_init(&gb_trace_tape.kicked, 0);
+    gb_trace_barrier();
+    gb_trace_tape.mechanism = tape;
+
+    return 0;
+}
+
+/* Flush the messages not written yet; the tape can be closed afterwards */
+void gb_trace_tape_stop(void)
+{
+    struct gb_tape_mechanism *tape = gb_trace_tape.mechanism;
+
+    if (!tape)
+        return;
+
+    gb_trace_tape.mechanism = NULL;
+    work_cancel(GB_TRACE_WORK, &gb_trace_tape.work);
+
+    gb_trace_tape_lock();
+    gb_trace_tape_drain(tape);
+    sem_post(&gb_trace_tape.lock);
+
+    if (gb_trace_tape.lost)
+        gb_error("gb-tape: %u messages lost\n", gb_trace_tape.lost);
+
+    if (gb_trace_tape.enabled_tracing)
+        gb_trace_disable();
+}
+#else
+int gb_trace_tape_start(struct gb_tape_mechanism *tape, int fd)
+{
+    return -ENOSYS;
+}
+
+void gb_trace_tape_stop(void)
+{
+}
+#endif
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+
+/* Number of payload bytes shown after the operation header */
+#define GB_TRACE_DUMP_BYTES     8
+#define GB_TRACE_LINELEN        (48 + 3 * GB_TRACE_DUMP_BYTES)
+#define GB_TRACE_BUFLEN         ((GB_TRACE_ENTRIES + 1) * GB_TRACE_LINELEN)
+
+struct gb_trace_file_s {
+    struct procfs_file_s base;
+    size_t len;
+    char buf[GB_TRACE_BUFLEN];
+};
+
+static size_t gb_trace_format(struct gb_trace_entry *entry, char *buf,
+                              size_t len)
+{
+    struct gb_operation_hdr *hdr = (struct gb_operation_hdr *) entry->data;
+    size_t n;
+    int i;
+
+    if (entry->len < sizeof(*hdr)) {
+        return snprintf(buf, len, "%10u %s %3u %4u\n",
+                        (unsigned int) entry->timestamp,
+                        entry->dir == GB_TRACE_RX ? "rx" : "tx",
+                        entry->cport, entry->size);
+    }
+
+    n = snprintf(buf, len, "%10u %s %3u %4u 0x%02x %5u 0x%02x",
+                 (unsigned int) entry->timestamp,
+                 entry->dir == GB_TRACE_RX ? "rx" : "tx", entry->cport,
+                 entry->size, hdr->type, le16_to_cpu(hdr->id), hdr->result);
+
+    for (i = sizeof(*hdr);
+         i < entry->len && i < sizeof(*hdr) + GB_TRACE_DUMP_BYTES && n < len;
+         i++) {
+        n += snprintf(buf + n, len - n, " %02x", entry->data[i]);
+    }
+
+    if (n < len)
+        n += snprintf(buf + n, len - n, "\n");
+
+    return n < len ? n : len;
+}
+
+static int gb_trace_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+    FAR struct gb_trace_file_s *priv;
+
+    priv = kmm_zalloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    filep->f_priv = priv;
+    return OK;
+}
+
+static int gb_trace_close(FAR struct file *filep)
+{
+    kmm_free(filep->f_priv);
+    filep->f_priv = NULL;
+    return OK;
+}
+
+static ssize_t gb_trace_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+    FAR struct gb_trace_file_s *priv = filep->f_priv;
+    struct gb_trace_entry entry;
+    uint32_t head, idx;
+    off_t offset;
+    ssize_t ret;
+
+    /* Take a snapshot on the first read so that the content stays stable */
+    if (filep->f_pos == 0) {
+        priv->len = snprintf(priv->buf, GB_TRACE_BUFLEN,
+                             "%10s %s %3s %4s %4s %5s %4s %s\n", "time_us",
+                             "  ", "cp", "size", "type", "id", "res",
+                             "payload");
+
+        head = atomic_get(&gb_trace_head);
+        idx = head > GB_TRACE_ENTRIES ? head - GB_TRACE_ENTRIES : 0;
+        for (; gb_trace_ring && idx != head; idx++) {
+            if (gb_trace_read_entry(idx, &entry))
+                continue;
+
+            priv->len += gb_trace_format(&entry, priv->buf + priv->len,
+                                         GB_TRACE_BUFLEN - priv->len);
+        }
+    }
+
+    offset = filep->f_pos;
+    ret = procfs_memcpy(priv->buf, priv->len, buffer, buflen, &offset);
+    if (ret > 0)
+        filep->f_pos += ret;
+
+    return ret;
+}
+
+static ssize_t gb_trace_write(FAR struct file *filep, FAR const char *buffer,
+                              size_t buflen)
+{
+    int ret = 0;
+
+    if (!buflen)
+        return 0;
+
+    switch (buffer[0]) {
+    case '0':
+        gb_trace_disable();
+        break;
+
+    case '1':
+        ret = gb_trace_enable();
+        break;
+
+    default:
+        ret = -EINVAL;
+        break;
+    }
+
+    return ret ? ret : buflen;
+}
+
+static int gb_trace_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+    FAR struct gb_trace_file_s *priv;
+
+    priv = kmm_malloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    memcpy(priv, oldp->f_priv, sizeof(*priv));
+    newp->f_priv = priv;
+    return OK;
+}
+
+static int gb_trace_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+    buf->st_mode    = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR | S_IWUSR;
+    buf->st_size    = 0;
+    buf->st_blksize = 0;
+    buf->st_blocks  = 0;
+    return OK;
+}
+
+/* See fs_procfs.c -- this structure is explicitly externed there */
+const struct procfs_operations gb_trace_procfsoperations = {
+    gb_trace_open,      /* open */
+    gb_trace_close,     /* close */
+    gb_trace_read,      /* read */
+    gb_trace_write,     /* write */
+
+    gb_trace_dup,       /* dup */
+
+    NULL,               /* opendir */
+    NULL,               /* closedir */
+    NULL,               /* readdir */
+    NULL,               /* rewinddir */
+
+    gb_trace_stat       /* stat */
+};
+#endif
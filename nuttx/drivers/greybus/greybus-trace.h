@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GREYBUS_TRACE_H_
+#define _GREYBUS_TRACE_H_
+
+#include <nuttx/config.h>
+#include <nuttx/greybus/tape.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary trace of the Greybus messages.
+ *
+ * gb_trace_record() stores a timestamp, the CPort, the size and the first
+ * CONFIG_GREYBUS_TRACE_DATA_SIZE bytes of a message (the operation header
+ * included) in a ring buffer. It takes no lock and may be called from
+ * interrupt context. It costs a single test while tracing is disabled.
+ *
+ * The ring can be read from /proc/greybus/trace; writing 1 or 0 to that
+ * file enables or disables tracing. While a tape is recording, the received
+ * messages are written to it from a work queue instead of the RX path.
+ */
+
+enum gb_trace_dir {
+    GB_TRACE_RX,
+    GB_TRACE_TX,
+};
+
+extern volatile bool gb_trace_enabled;
+
+int gb_trace_enable(void);
+void gb_trace_disable(void);
+
+void _gb_trace_record(enum gb_trace_dir dir, unsigned int cport,
+                      const void *data, size_t size);
+
+static inline void gb_trace_record(enum gb_trace_dir dir, unsigned int cport,
+                                   const void *data, size_t size)
+{
+    if (gb_trace_enabled)
+        _gb_trace_record(dir, cport, data, size);
+}
+
+int gb_trace_tape_start(struct gb_tape_mechanism *tape, int fd);
+void gb_trace_tape_stop(void);
+
+#endif /* _GREYBUS_TRACE_H_ */
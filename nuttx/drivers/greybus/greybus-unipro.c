@@ -58,13 +58,31 @@ static int gb_unipro_stop_listening(unsigned int cport)
     return unipro_driver_unregister(cport);
 }
 
+static int gb_unipro_set_tx_class(unsigned int cport,
+                                  enum gb_tx_class tx_class)
+{
+    switch (tx_class) {
+    case GB_TX_CLASS_ISOCHRONOUS:
+        return unipro_set_tx_class(cport, UNIPRO_TX_CLASS_ISOCHRONOUS);
+    case GB_TX_CLASS_BULK:
+        return unipro_set_tx_class(cport, UNIPRO_TX_CLASS_BULK);
+    default:
+        return unipro_set_tx_class(cport, UNIPRO_TX_CLASS_INTERACTIVE);
+    }
+}
+
 const static struct gb_transport_backend gb_unipro_backend = {
     .init = unipro_init,
     .send = unipro_send,
+    .send_batch = unipro_send_batch,
+    .send_async = unipro_send_async,
     .listen = gb_unipro_listen,
     .stop_listening = gb_unipro_stop_listening,
     .alloc_buf = bufram_alloc,
     .free_buf = bufram_free,
+    .set_tx_class = gb_unipro_set_tx_class,
+    .rx_pause = unipro_rx_pause,
+    .rx_resume = unipro_rx_resume,
 };
 
 int gb_unipro_init(void)
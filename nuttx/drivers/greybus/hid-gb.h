@@ -38,6 +38,7 @@
 #define GB_HID_TYPE_GET_REPORT          0x06    /* Get Report */
 #define GB_HID_TYPE_SET_REPORT          0x07    /* Set Report */
 #define GB_HID_TYPE_IRQ_EVENT           0x08    /* Irq Event */
+#define GB_HID_TYPE_IRQ_EVENTS          0x09    /* Packed Irq Events */
 
 /* Greybus HID Report type */
 #define GB_HID_INPUT_REPORT             0       /* Input Report */
@@ -88,4 +89,14 @@ struct gb_hid_input_report_request {
     __u8 report[0]; /**< data */
 };
 
+/**
+ * Greybus HID Packed Input Reports Request
+ */
+struct gb_hid_input_reports_request {
+    __u8 count; /**< Number of reports */
+    __u8 reserved;
+    __le16 report_len; /**< Length of each report */
+    __u8 reports[0]; /**< count reports of report_len bytes */
+} __packed;
+
 #endif /* __HID_GB_H__ */
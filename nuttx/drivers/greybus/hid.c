@@ -31,7 +31,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <queue.h>
+#include <unistd.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/device.h>
 #include <nuttx/device_hid.h>
 #include <nuttx/greybus/greybus.h>
@@ -45,7 +47,28 @@
 #define GB_HID_VERSION_MINOR 1
 
 /* Reserved operations for IRQ event input report buffer. */
+#ifdef CONFIG_GREYBUS_HID_REPORT_OPS
+#define MAX_REPORT_OPERATIONS CONFIG_GREYBUS_HID_REPORT_OPS
+#else
 #define MAX_REPORT_OPERATIONS 5
+#endif
+
+#ifndef CONFIG_GREYBUS_HID_MAX_REPORT_RATE
+#define CONFIG_GREYBUS_HID_MAX_REPORT_RATE 0
+#endif
+
+/* Report descriptor short item prefixes, with the size bits cleared. */
+#define HID_ITEM_LONG           0xfe
+#define HID_ITEM_INPUT          0x80
+#define HID_ITEM_REPORT_ID      0x84
+
+/* Input item data bit: Absolute (0) or Relative (1) */
+#define HID_INPUT_RELATIVE      0x04
+
+#define HID_REPORT_IDS          256
+
+/* Maximum number of queued input reports sent in one batch. */
+#define HID_REPORT_BATCH MAX_REPORT_OPERATIONS
 
 /**
  * The structure for an operation queue.
@@ -100,6 +123,22 @@ struct gb_hid_info {
 
     /** inform the thread should be terminated */
     int thread_stop;
+
+#if CONFIG_GREYBUS_HID_MAX_REPORT_RATE > 0
+    /** earliest system time the next reports can be sent */
+    uint32_t next_send;
+#endif
+
+#ifdef CONFIG_GREYBUS_HID_MERGE
+    /** pending input reports can be replaced by newer ones */
+    bool merge;
+
+    /** input reports start with a report ID */
+    bool report_ids;
+
+    /** bitmap of report IDs declaring relative inputs */
+    uint32_t relative[HID_REPORT_IDS / 32];
+#endif
 };
 
 static struct gb_hid_info *hid_info = NULL;
@@ -390,11 +429,71 @@ static uint8_t gb_hid_set_report(struct gb_operation *operation)
  * @param len Returned buffer lenght.
  * @return None.
  */
+#ifdef CONFIG_GREYBUS_HID_MERGE
+/**
+ * @brief Check whether a report may overwrite a pending one.
+ *
+ * @param id Report ID, 0 if the device does not use report IDs.
+ * @return true if only the latest report with this ID matters.
+ */
+static bool hid_report_mergeable(uint8_t id)
+{
+    return hid_info->merge &&
+           !(hid_info->relative[id / 32] & (1 << (id % 32)));
+}
+
+/**
+ * @brief Replace a pending report with the same report ID.
+ *
+ * Absolute reports carry the whole state of their controls, so a queued one
+ * that has not been sent yet is superseded by the newer report. Relative
+ * reports, such as mouse motion, must all reach the host and never merge.
+ *
+ * @param report Pointer to a received data buffer.
+ * @param len Buffer length.
+ * @return true if the report was merged into a pending one.
+ */
+static bool hid_merge_report(uint8_t *report, uint16_t len)
+{
+    struct op_node *node;
+    sq_entry_t *entry;
+    irqstate_t flags;
+    uint8_t id = hid_info->report_ids ? report[0] : 0;
+
+    if (!hid_report_mergeable(id)) {
+        return false;
+    }
+
+    flags = irqsave();
+
+    for (entry = sq_peek(&hid_info->data_queue); entry;
+         entry = sq_next(entry)) {
+        node = (struct op_node *)entry;
+        if (!hid_info->report_ids || node->buffer[0] == id) {
+            memcpy(node->buffer, report, len);
+            irqrestore(flags);
+            return true;
+        }
+    }
+
+    irqrestore(flags);
+
+    return false;
+}
+#endif
+
 static int hid_event_callback_routine(struct device *dev, uint8_t report_type,
                                       uint8_t *report, uint16_t len)
 {
     struct op_node *node;
 
+#ifdef CONFIG_GREYBUS_HID_MERGE
+    if (hid_info->report_buf_size == len && hid_merge_report(report, len)) {
+        sem_post(&hid_info->active_sem);
+        return 0;
+    }
+#endif
+
     if (!hid_info->report_node) {
         /**
          * active report_proc_thread to send operation for node free
@@ -427,6 +526,44 @@ static int hid_event_callback_routine(struct device *dev, uint8_t report_type,
     return 0;
 }
 
+#ifdef CONFIG_GREYBUS_HID_PACKED_REPORTS
+/**
+ * @brief Send pending input reports in a single operation.
+ *
+ * @param nodes Nodes holding the reports to send.
+ * @param count Number of nodes.
+ * @return 0 on success, negative errno on error.
+ */
+static int hid_send_packed_reports(struct op_node **nodes, int count)
+{
+    struct gb_hid_input_reports_request *request;
+    struct gb_operation *operation;
+    int ret;
+    int i;
+
+    operation = gb_operation_create(hid_info->cport, GB_HID_TYPE_IRQ_EVENTS,
+                                    sizeof(*request) +
+                                    count * hid_info->report_buf_size);
+    if (!operation) {
+        return -ENOMEM;
+    }
+
+    request = gb_operation_get_request_payload(operation);
+    request->count = count;
+    request->report_len = cpu_to_le16(hid_info->report_buf_size);
+
+    for (i = 0; i < count; i++) {
+        memcpy(&request->reports[i * hid_info->report_buf_size],
+               nodes[i]->buffer, hid_info->report_buf_size);
+    }
+
+    ret = gb_operation_send_request(operation, NULL, false);
+    gb_operation_destroy(operation);
+
+    return ret;
+}
+#endif
+
 /**
  * @brief Data receiving process thread
  *
@@ -439,8 +576,15 @@ static int hid_event_callback_routine(struct device *dev, uint8_t report_type,
  */
 static void *report_proc_thread(void *data)
 {
+    struct gb_operation *operations[HID_REPORT_BATCH];
+    struct op_node *nodes[HID_REPORT_BATCH];
     struct op_node *node = NULL;
+#if CONFIG_GREYBUS_HID_MAX_REPORT_RATE > 0
+    int32_t delay;
+#endif
+    int count;
     int ret;
+    int i;
 
     while (1) {
         sem_wait(&hid_info->active_sem);
@@ -449,14 +593,46 @@ static void *report_proc_thread(void *data)
             break;
         }
 
-        node = node_dequeue(&hid_info->data_queue);
-        if (node) {
-            ret = gb_operation_send_request(node->operation, NULL, false);
+#if CONFIG_GREYBUS_HID_MAX_REPORT_RATE > 0
+        /* reports coming in meanwhile are queued or merged */
+        delay = (int32_t)(hid_info->next_send - clock_systimer());
+        if (delay > 0) {
+            usleep(TICK2USEC(delay));
+            if (hid_info->thread_stop) {
+                break;
+            }
+        }
+#endif
+
+        /* send every pending report at once; extra posts find it empty */
+        for (count = 0; count < HID_REPORT_BATCH; count++) {
+            nodes[count] = node_dequeue(&hid_info->data_queue);
+            if (!nodes[count]) {
+                break;
+            }
+            operations[count] = nodes[count]->operation;
+        }
+
+        if (count) {
+#ifdef CONFIG_GREYBUS_HID_PACKED_REPORTS
+            ret = hid_send_packed_reports(nodes, count);
+            if (ret == -ENOMEM) {
+                ret = gb_operation_send_request_batch(operations, count);
+            }
+#else
+            ret = gb_operation_send_request_batch(operations, count);
+#endif
             if (ret) {
                 gb_info("IRQ Event operation failed (%x)!\n",
                          ret);
             }
-            node_requeue(&hid_info->free_queue, node);
+            for (i = 0; i < count; i++) {
+                node_requeue(&hid_info->free_queue, nodes[i]);
+            }
+#if CONFIG_GREYBUS_HID_MAX_REPORT_RATE > 0
+            hid_info->next_send = clock_systimer() +
+                USEC2TICK(1000000 / CONFIG_GREYBUS_HID_MAX_REPORT_RATE);
+#endif
         }
 
         if (hid_info->node_request) {
@@ -533,6 +709,85 @@ err_free_op:
     return -ENOMEM;
 }
 
+#ifdef CONFIG_GREYBUS_HID_MERGE
+/**
+ * @brief Find the report IDs declaring relative inputs.
+ *
+ * Walks the main and global items of the report descriptor and marks every
+ * report ID with at least one relative Input item. Merging is left disabled
+ * if the descriptor cannot be read.
+ *
+ * @param None.
+ * @return None.
+ */
+static void hid_parse_report_descriptor(void)
+{
+    struct hid_descriptor hid_desc;
+    uint8_t *desc;
+    uint32_t data;
+    uint8_t id = 0;
+    int size;
+    int i;
+    int j;
+
+    if (device_hid_get_descriptor(hid_info->dev, &hid_desc) ||
+        !hid_desc.report_desc_length) {
+        return;
+    }
+
+    desc = malloc(hid_desc.report_desc_length);
+    if (!desc) {
+        return;
+    }
+
+    if (device_hid_get_report_descriptor(hid_info->dev, desc)) {
+        goto out;
+    }
+
+    for (i = 0; i < hid_desc.report_desc_length; i += 1 + size) {
+        if (desc[i] == HID_ITEM_LONG) {
+            if (i + 1 >= hid_desc.report_desc_length) {
+                goto out;
+            }
+            size = desc[i + 1] + 2;
+            continue;
+        }
+
+        size = desc[i] & 0x3;
+        if (size == 3) {
+            size = 4;
+        }
+
+        if (i + size >= hid_desc.report_desc_length) {
+            goto out;
+        }
+
+        for (data = 0, j = size; j > 0; j--) {
+            data = (data << 8) | desc[i + j];
+        }
+
+        switch (desc[i] & 0xfc) {
+        case HID_ITEM_REPORT_ID:
+            id = data;
+            hid_info->report_ids = true;
+            break;
+        case HID_ITEM_INPUT:
+            if (data & HID_INPUT_RELATIVE) {
+                hid_info->relative[id / 32] |= 1 << (id % 32);
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    hid_info->merge = true;
+
+out:
+    free(desc);
+}
+#endif
+
 /**
  * @brief Receiving data process initialization
  *
@@ -546,6 +801,7 @@ err_free_op:
  */
 static int hid_receiver_callback_init(void)
 {
+    pthread_attr_t attr;
     int ret;
 
     sq_init(&hid_info->free_queue);
@@ -553,6 +809,10 @@ static int hid_receiver_callback_init(void)
 
     hid_info->entries = MAX_REPORT_OPERATIONS;
 
+#ifdef CONFIG_GREYBUS_HID_MERGE
+    hid_parse_report_descriptor();
+#endif
+
     ret = hid_alloc_op(hid_info->entries, hid_info->report_buf_size,
                        &hid_info->free_queue);
     if (ret) {
@@ -564,12 +824,24 @@ static int hid_receiver_callback_init(void)
         goto err_free_data_op;
     }
 
-    ret = pthread_create(&hid_info->pthread_handler, NULL, report_proc_thread,
+    ret = pthread_attr_init(&attr);
+    if (ret) {
+        goto err_destroy_active_sem;
+    }
+
+#if CONFIG_GREYBUS_HID_STACKSIZE > 0
+    pthread_attr_setstacksize(&attr, CONFIG_GREYBUS_HID_STACKSIZE);
+#endif
+
+    ret = pthread_create(&hid_info->pthread_handler, &attr, report_proc_thread,
                          hid_info);
+    pthread_attr_destroy(&attr);
     if (ret) {
         goto err_destroy_active_sem;
     }
 
+    pthread_setname_np(hid_info->pthread_handler, "gb_hid_report");
+
     return 0;
 
 err_destroy_active_sem:
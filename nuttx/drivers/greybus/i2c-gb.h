@@ -39,6 +39,7 @@
 #define GB_I2C_PROTOCOL_TIMEOUT             0x03
 #define GB_I2C_PROTOCOL_RETRIES             0x04
 #define GB_I2C_PROTOCOL_TRANSFER            0x05
+#define GB_I2C_PROTOCOL_SCRIPT              0x06
 
 #define GB_I2C_FUNC_I2C                     0x00000001
 #define GB_I2C_FUNC_10BIT_ADDR              0x00000002
@@ -63,6 +64,10 @@
 #define GB_I2C_M_RECV_LEN                   0x0400
 #define GB_I2C_M_NOSTART                    0x4000
 
+/* script transfer only */
+#define GB_I2C_M_SCRIPT_STOP                0x2000
+#define GB_I2C_M_SCRIPT_DELAY               0x8000
+
 
 /* version request has no payload */
 struct gb_i2c_proto_version_response {
@@ -89,5 +94,15 @@ struct gb_i2c_transfer_rsp {
 	__u8	data[0];
 };
 
+/*
+ * Script transfer requests and responses are laid out as the transfer
+ * ones. Consecutive ops are issued as one I2C transaction, which ends
+ * after an op flagged GB_I2C_M_SCRIPT_STOP. Ops flagged
+ * GB_I2C_M_SCRIPT_DELAY end the current transaction and wait 'size'
+ * microseconds, they carry no data. A write op flagged GB_I2C_M_NOSTART
+ * is sent as a continuation of the previous write to the same address.
+ * The response carries the data of all the read ops.
+ */
+
 #endif /* _GREYBUS_I2C_H_ */
 
@@ -29,6 +29,7 @@
 #include <errno.h>
 #include <debug.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 #include <arch/byteorder.h>
 #include <nuttx/i2c.h>
@@ -84,18 +85,19 @@ static uint8_t gb_i2c_protocol_retries(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
-static uint8_t gb_i2c_protocol_transfer(struct gb_operation *operation)
+/*
+ * Check a transfer or script request and allocate the response holding
+ * the read data
+ */
+static uint8_t gb_i2c_check_request(struct gb_operation *operation,
+                                    bool script)
 {
     int i, op_count;
+    uint16_t flags;
     uint32_t size = 0;
-    int ret;
-    uint8_t *write_data;
-    bool read_op;
-    int read_count = 0;
-    struct i2c_msg_s *msg;
+    uint32_t write_size = 0;
     struct gb_i2c_transfer_desc *desc;
     struct gb_i2c_transfer_req *request;
-    struct gb_i2c_transfer_rsp *response;
     const size_t req_size = gb_operation_get_request_payload_size(operation);
 
     if (req_size < sizeof(*request)) {
@@ -105,7 +107,6 @@ static uint8_t gb_i2c_protocol_transfer(struct gb_operation *operation)
 
     request = gb_operation_get_request_payload(operation);
     op_count = le16_to_cpu(request->op_count);
-    write_data = (uint8_t *)&request->desc[op_count];
 
     if (req_size < sizeof(*request) + op_count * sizeof(request->desc[0])) {
         gb_error("dropping short message\n");
@@ -114,44 +115,182 @@ static uint8_t gb_i2c_protocol_transfer(struct gb_operation *operation)
 
     for (i = 0; i < op_count; i++) {
         desc = &request->desc[i];
-        read_op = (le16_to_cpu(desc->flags) & GB_I2C_M_RD) ? true : false;
+        flags = le16_to_cpu(desc->flags);
+
+        if (script && (flags & GB_I2C_M_SCRIPT_DELAY))
+            continue;
 
-        if (read_op)
+        if (flags & GB_I2C_M_RD)
             size += le16_to_cpu(desc->size);
+        else
+            write_size += le16_to_cpu(desc->size);
     }
 
-    response = gb_operation_alloc_response(operation, size);
-    if (!response) {
+    if (script && req_size < sizeof(*request) +
+                             op_count * sizeof(request->desc[0]) + write_size) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    if (!gb_operation_alloc_response(operation, size))
         return GB_OP_NO_MEMORY;
+
+    return GB_OP_SUCCESS;
+}
+
+/*
+ * Convert descriptors into I2C messages, merging the writes flagged
+ * GB_I2C_M_NOSTART into the previous write to the same address since
+ * their data follow each other in the request.
+ *
+ * Return the number of messages.
+ */
+static int gb_i2c_build_msgs(struct gb_i2c_transfer_desc *desc, int count,
+                             uint8_t **write_data, uint8_t **read_data,
+                             struct i2c_msg_s *msg)
+{
+    int i;
+    int n = 0;
+    uint16_t flags;
+    uint16_t addr;
+    uint16_t size;
+
+    for (i = 0; i < count; i++) {
+        flags = le16_to_cpu(desc[i].flags);
+        addr = le16_to_cpu(desc[i].addr);
+        size = le16_to_cpu(desc[i].size);
+
+        if (flags & GB_I2C_M_RD) {
+            msg[n].flags = I2C_M_READ;
+            msg[n].addr = addr;
+            msg[n].length = size;
+            msg[n].buffer = *read_data;
+            *read_data += size;
+            n++;
+            continue;
+        }
+
+        if ((flags & GB_I2C_M_NOSTART) && n > 0 &&
+            !(msg[n - 1].flags & I2C_M_READ) && msg[n - 1].addr == addr &&
+            msg[n - 1].buffer + msg[n - 1].length == *write_data) {
+            msg[n - 1].length += size;
+        } else {
+            msg[n].flags = 0;
+            msg[n].addr = addr;
+            msg[n].length = size;
+            msg[n].buffer = *write_data;
+            n++;
+        }
+        *write_data += size;
     }
 
+    return n;
+}
+
+static uint8_t gb_i2c_protocol_transfer(struct gb_operation *operation)
+{
+    int op_count;
+    int msg_count;
+    int ret;
+    uint8_t result;
+    uint8_t *write_data;
+    uint8_t *read_data;
+    struct i2c_msg_s *msg;
+    struct gb_i2c_transfer_req *request;
+    struct gb_i2c_transfer_rsp *response;
+
+    result = gb_i2c_check_request(operation, false);
+    if (result != GB_OP_SUCCESS)
+        return result;
+
+    request = gb_operation_get_request_payload(operation);
+    response = gb_operation_get_response_payload(operation);
+    op_count = le16_to_cpu(request->op_count);
+    write_data = (uint8_t *)&request->desc[op_count];
+    read_data = response->data;
+
     msg = malloc(sizeof(struct i2c_msg_s) * op_count);
     if (!msg) {
         return GB_OP_NO_MEMORY;
     }
 
-    for (i = 0; i < op_count; i++) {
-        desc = &request->desc[i];
-        read_op = (le16_to_cpu(desc->flags) & GB_I2C_M_RD) ? true : false;
+    msg_count = gb_i2c_build_msgs(request->desc, op_count, &write_data,
+                                  &read_data, msg);
 
-        msg[i].flags = 0;
-        msg[i].addr = le16_to_cpu(desc->addr);
-        msg[i].length = le16_to_cpu(desc->size);
+    ret = I2C_TRANSFER(i2c_dev, msg, msg_count);
 
-        if (read_op) {
-            msg[i].flags |= GB_I2C_M_RD;
-            msg[i].buffer = &response->data[read_count];
-            read_count += le16_to_cpu(desc->size);
-        } else {
-            msg[i].buffer = write_data;
-            write_data += le16_to_cpu(desc->size);
-        }
+    free(msg);
+
+    return gb_errno_to_op_result(ret);
+}
+
+/*
+ * Run a sequence of I2C transactions and delays in a single greybus
+ * operation, saving the host a round trip per register access.
+ */
+static uint8_t gb_i2c_protocol_script(struct gb_operation *operation)
+{
+    int i, start, op_count;
+    int msg_count;
+    int ret = 0;
+    uint8_t result;
+    uint16_t flags;
+    uint8_t *write_data;
+    uint8_t *read_data;
+    struct i2c_msg_s *msg;
+    struct gb_i2c_transfer_req *request;
+    struct gb_i2c_transfer_rsp *response;
+
+    result = gb_i2c_check_request(operation, true);
+    if (result != GB_OP_SUCCESS)
+        return result;
+
+    request = gb_operation_get_request_payload(operation);
+    response = gb_operation_get_response_payload(operation);
+    op_count = le16_to_cpu(request->op_count);
+    write_data = (uint8_t *)&request->desc[op_count];
+    read_data = response->data;
+
+    msg = malloc(sizeof(struct i2c_msg_s) * op_count);
+    if (!msg) {
+        return GB_OP_NO_MEMORY;
     }
 
-    ret = I2C_TRANSFER(i2c_dev, msg, op_count);
+    for (start = 0, i = 0; i < op_count; i++) {
+        flags = le16_to_cpu(request->desc[i].flags);
+
+        if (flags & GB_I2C_M_SCRIPT_DELAY) {
+            /* flush the transaction preceding the delay */
+            if (i > start) {
+                msg_count = gb_i2c_build_msgs(&request->desc[start],
+                                              i - start, &write_data,
+                                              &read_data, msg);
+                ret = I2C_TRANSFER(i2c_dev, msg, msg_count);
+                if (ret)
+                    break;
+            }
+
+            usleep(le16_to_cpu(request->desc[i].size));
+            start = i + 1;
+            continue;
+        }
+
+        if ((flags & GB_I2C_M_SCRIPT_STOP) || i == op_count - 1) {
+            msg_count = gb_i2c_build_msgs(&request->desc[start],
+                                          i + 1 - start, &write_data,
+                                          &read_data, msg);
+            ret = I2C_TRANSFER(i2c_dev, msg, msg_count);
+            if (ret)
+                break;
+            start = i + 1;
+        }
+    }
 
     free(msg);
 
+    if (ret)
+        gb_error("script failed at op %d: %d\n", i, ret);
+
     return gb_errno_to_op_result(ret);
 }
 
@@ -168,6 +307,7 @@ static struct gb_operation_handler gb_i2c_handlers[] = {
     GB_HANDLER(GB_I2C_PROTOCOL_TIMEOUT, gb_i2c_protocol_timeout),
     GB_HANDLER(GB_I2C_PROTOCOL_RETRIES, gb_i2c_protocol_retries),
     GB_HANDLER(GB_I2C_PROTOCOL_TRANSFER, gb_i2c_protocol_transfer),
+    GB_HANDLER(GB_I2C_PROTOCOL_SCRIPT, gb_i2c_protocol_script),
 };
 
 static struct gb_driver gb_i2c_driver = {
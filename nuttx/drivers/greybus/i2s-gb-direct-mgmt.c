@@ -558,6 +558,8 @@ static struct gb_driver gb_i2s_mgmt_driver = {
     .init = gb_i2s_mgmt_init,
     .op_handlers = (struct gb_operation_handler*)gb_i2s_mgmt_handlers,
     .op_handlers_count = ARRAY_SIZE(gb_i2s_mgmt_handlers),
+    .rx_priority = GB_RX_PRIORITY_HIGH,
+    .init_group = GB_INIT_GROUP_AUDIO,
 };
 
 void gb_i2s_direct_mgmt_register(int cport)
@@ -49,6 +49,7 @@
 #define GB_LIGHTS_TYPE_SET_FLASH_STROBE         0x0C
 #define GB_LIGHTS_TYPE_SET_FLASH_TIMEOUT        0x0D
 #define GB_LIGHTS_TYPE_GET_FLASH_FAULT          0x0E
+#define GB_LIGHTS_TYPE_SET_PATTERN              0x0F
 
 /**
  * Lights Protocol version response payload, version request has no payload
@@ -194,6 +195,37 @@ struct gb_lights_set_fade_request {
     __u8    fade_out;
 } __packed;
 
+/**
+ * Lights Protocol pattern keyframe
+ */
+struct gb_lights_keyframe {
+    /** time the level is held, or ramped to */
+    __le16  duration_ms;
+    /** brightness at the end of the keyframe */
+    __u8    level;
+    /** GB_LIGHTS_KEYFRAME_* flags */
+    __u8    flags;
+} __packed;
+
+#define GB_LIGHTS_KEYFRAME_RAMP                 0x01
+
+/**
+ * Lights Protocol set pattern request payload, response have no payload
+ */
+struct gb_lights_set_pattern_request {
+    /** light identification number */
+    __u8    light_id;
+    /** channel identification number */
+    __u8    channel_id;
+    /** number of keyframes, 0 to stop the pattern */
+    __u8    count;
+    __u8    reserved;
+    /** number of times the pattern is played, 0 for ever */
+    __le16  repeat;
+    __le16  reserved2;
+    struct gb_lights_keyframe frames[0];
+} __packed;
+
 /**
  * Lights Protocol event request payload, response have no payload
  */
@@ -31,6 +31,7 @@
 #include <string.h>
 #include <errno.h>
 
+#include <nuttx/arch.h>
 #include <nuttx/device.h>
 #include <nuttx/device_lights.h>
 #include <nuttx/greybus/greybus.h>
@@ -41,7 +42,7 @@
 #include "lights-gb.h"
 
 #define GB_LIGHTS_VERSION_MAJOR 0
-#define GB_LIGHTS_VERSION_MINOR 1
+#define GB_LIGHTS_VERSION_MINOR 2
 
 /**
  * The structure for Lights Protocol information
@@ -297,6 +298,11 @@ static uint8_t gb_lights_set_brightness(struct gb_operation *operation)
         return GB_OP_INVALID;
     }
 
+    /* lights controllers are usually behind a bus */
+    if (up_interrupt_context()) {
+        return GB_OP_RX_DEFER;
+    }
+
     request = gb_operation_get_request_payload(operation);
 
     /* set brightness to channel */
@@ -330,6 +336,10 @@ static uint8_t gb_lights_set_blink(struct gb_operation *operation)
         return GB_OP_INVALID;
     }
 
+    if (up_interrupt_context()) {
+        return GB_OP_RX_DEFER;
+    }
+
     request = gb_operation_get_request_payload(operation);
 
     /* set blink to channel */
@@ -363,6 +373,10 @@ static uint8_t gb_lights_set_color(struct gb_operation *operation)
         return GB_OP_INVALID;
     }
 
+    if (up_interrupt_context()) {
+        return GB_OP_RX_DEFER;
+    }
+
     request = gb_operation_get_request_payload(operation);
 
     /* set color to channel */
@@ -409,6 +423,56 @@ static uint8_t gb_lights_set_fade(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
+/**
+ * @brief Play a pattern on specific channel
+ *
+ * This operation allows the AP Module to upload a keyframe sequence, which
+ * the lights device driver then plays by itself, instead of the AP Module
+ * sending a request for every brightness change.
+ *
+ * @param operation pointer to structure of Greybus operation message
+ * @return GB_OP_SUCCESS on success, error code on failure
+ */
+static uint8_t gb_lights_set_pattern(struct gb_operation *operation)
+{
+    struct gb_lights_set_pattern_request *request;
+    struct lights_keyframe *frames;
+    size_t size;
+    int ret;
+    int i;
+
+    size = gb_operation_get_request_payload_size(operation);
+    if (size < sizeof(*request)) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    request = gb_operation_get_request_payload(operation);
+    if (size < sizeof(*request) + request->count * sizeof(request->frames[0])) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    /* Convert the keyframes in place */
+    frames = (struct lights_keyframe *)request->frames;
+    for (i = 0; i < request->count; i++) {
+        frames[i].duration_ms = le16_to_cpu(request->frames[i].duration_ms);
+        frames[i].flags = (request->frames[i].flags &
+                           GB_LIGHTS_KEYFRAME_RAMP) ?
+                          LIGHTS_KEYFRAME_RAMP : 0;
+    }
+
+    ret = device_lights_set_pattern(lights_info->dev, request->light_id,
+                                    request->channel_id, frames,
+                                    request->count,
+                                    le16_to_cpu(request->repeat));
+    if (ret) {
+        return gb_errno_to_op_result(ret);
+    }
+
+    return GB_OP_SUCCESS;
+}
+
 /**
  * @brief Set flash intensity to specific channel
  *
@@ -609,15 +673,16 @@ static struct gb_operation_handler gb_lights_handlers[] = {
     GB_HANDLER(GB_LIGHTS_TYPE_GET_CHANNEL_CONFIG, gb_lights_get_channel_config),
     GB_HANDLER(GB_LIGHTS_TYPE_GET_CHANNEL_FLASH_CONFIG,
                gb_lights_get_channel_flash_config),
-    GB_HANDLER(GB_LIGHTS_TYPE_SET_BRIGHTNESS, gb_lights_set_brightness),
-    GB_HANDLER(GB_LIGHTS_TYPE_SET_BLINK, gb_lights_set_blink),
-    GB_HANDLER(GB_LIGHTS_TYPE_SET_COLOR, gb_lights_set_color),
+    GB_RX_HANDLER(GB_LIGHTS_TYPE_SET_BRIGHTNESS, gb_lights_set_brightness),
+    GB_RX_HANDLER(GB_LIGHTS_TYPE_SET_BLINK, gb_lights_set_blink),
+    GB_RX_HANDLER(GB_LIGHTS_TYPE_SET_COLOR, gb_lights_set_color),
     GB_HANDLER(GB_LIGHTS_TYPE_SET_FADE, gb_lights_set_fade),
     GB_HANDLER(GB_LIGHTS_TYPE_SET_FLASH_INTENSITY,
                gb_lights_set_flash_intensity),
     GB_HANDLER(GB_LIGHTS_TYPE_SET_FLASH_STROBE, gb_lights_set_flash_strobe),
     GB_HANDLER(GB_LIGHTS_TYPE_SET_FLASH_TIMEOUT, gb_lights_set_flash_timeout),
     GB_HANDLER(GB_LIGHTS_TYPE_GET_FLASH_FAULT, gb_lights_get_flash_fault),
+    GB_HANDLER(GB_LIGHTS_TYPE_SET_PATTERN, gb_lights_set_pattern),
 };
 
 static struct gb_driver gb_lights_driver = {
@@ -255,6 +255,21 @@ static void update_loopback_stats(struct gb_operation *operation, int xfer)
 }
 #endif /* CONFIG_GREYBUS_FEATURE_HAVE_TIMESTAMPS */
 
+static void loopback_async_done(struct gb_operation *operation, int status)
+{
+    struct gb_loopback_async *async = operation->priv_data;
+    struct timespec now, elapsed;
+
+    if (!async)
+        return;
+
+    /* operation->time was taken by greybus-core when the request was sent */
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    timespecsub(&now, &operation->time, &elapsed);
+
+    async->done(async, status, timespec_to_usec(&elapsed));
+}
+
 /* Callbacks for gb_operation_send_request(). */
 
 static void gb_loopback_ping_sink_resp_cb(struct gb_operation *operation)
@@ -264,9 +279,11 @@ static void gb_loopback_ping_sink_resp_cb(struct gb_operation *operation)
     ret = gb_operation_get_request_result(operation);
     if (ret != OK) {
         loopback_error_notify(operation->cport);
+        loopback_async_done(operation, -EIO);
     } else {
         loopback_recv_inc(operation->cport);
         update_loopback_stats(operation, 0 /* not xfer */);
+        loopback_async_done(operation, 0);
     }
 }
 
@@ -275,26 +292,29 @@ static void gb_loopback_transfer_resp_cb(struct gb_operation *operation)
     struct gb_loopback_transfer_response *response;
     struct gb_loopback_transfer_request *request;
 
+    if (!operation->response) {
+        /* timed out */
+        loopback_error_notify(operation->cport);
+        loopback_async_done(operation, -ETIMEDOUT);
+        return;
+    }
+
     request = gb_operation_get_request_payload(operation);
     response = gb_operation_get_request_payload(operation->response);
 
     if ((request->len != response->len) ||
         (memcmp(request->data, response->data, le32_to_cpu(request->len)))) {
         loopback_error_notify(operation->cport);
+        loopback_async_done(operation, -EIO);
     } else {
         loopback_recv_inc(operation->cport);
         update_loopback_stats(operation, 1 /* xfer */);
+        loopback_async_done(operation, 0);
     }
 }
 
-/**
- * @brief           Send loopback operation request
- * @return          OK in case of success, <0 otherwise
- * @param[in]       cport: cport number
- * @param[in]       size: request payload size in bytes
- * @param[in]       type: operation type (ping / transfer / sink)
- */
-int gb_loopback_send_req(int cport, size_t size, uint8_t type)
+static int loopback_send_req(int cport, size_t size, uint8_t type,
+                             struct gb_loopback_async *async)
 {
     struct gb_loopback_transfer_request *request;
     struct gb_operation *operation;
@@ -314,6 +334,8 @@ int gb_loopback_send_req(int cport, size_t size, uint8_t type)
     if (!operation)
         return -ENOMEM;
 
+    operation->priv_data = async;
+
     switch(type) {
     case GB_LOOPBACK_TYPE_PING:
         status = gb_operation_send_request(operation,
@@ -353,6 +375,34 @@ int gb_loopback_send_req(int cport, size_t size, uint8_t type)
     return retval;
 }
 
+/**
+ * @brief           Send loopback operation request
+ * @return          OK in case of success, <0 otherwise
+ * @param[in]       cport: cport number
+ * @param[in]       size: request payload size in bytes
+ * @param[in]       type: operation type (ping / transfer / sink)
+ */
+int gb_loopback_send_req(int cport, size_t size, uint8_t type)
+{
+    return loopback_send_req(cport, size, type, NULL);
+}
+
+/**
+ * @brief           Send loopback operation request and notify its completion
+ * @return          OK in case of success, <0 otherwise, in which case
+ *                  async->done() is not called
+ * @param[in]       cport: cport number
+ * @param[in]       size: request payload size in bytes
+ * @param[in]       type: operation type (ping / transfer / sink)
+ * @param[in]       async: completion notified once the response is received
+ *                  or the request timed out
+ */
+int gb_loopback_send_req_async(int cport, size_t size, uint8_t type,
+                               struct gb_loopback_async *async)
+{
+    return loopback_send_req(cport, size, type, async);
+}
+
 /*
  * The below functions are called by greybus-core upon
  * reception of inbound packets.
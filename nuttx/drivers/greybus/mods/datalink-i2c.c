@@ -32,21 +32,31 @@
 #include <debug.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <sys/types.h>
 
 #include <arch/board/mods.h>
 #include <arch/byteorder.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/config.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
 #include <nuttx/gpio.h>
 #include <nuttx/greybus/mods.h>
 #include <nuttx/greybus/types.h>
 #include <nuttx/i2c.h>
+#include <nuttx/kmalloc.h>
 #include <nuttx/power/pm.h>
 #include <nuttx/ring_buf.h>
 #include <nuttx/util.h>
+#include <nuttx/wdog.h>
+
+#include <fcntl.h>
 
 #include "datalink.h"
 
@@ -71,6 +81,19 @@
 /* Initial number of entries for the ring buffer (will grow as needed). */
 #define INITIAL_RB_ENTRIES (10)
 
+/* Possible values for bus config features */
+#define DL_BIT_BURST   (1 << 1)     /* Flag to indicate burst reads supported */
+
+/* Number of packets the base reads at once, if the base supports it */
+#define BURST_PKTS     CONFIG_GREYBUS_MODS_I2C_BURST_PKTS
+
+/* Delay the base interrupt to coalesce several messages in one read */
+#if CONFIG_GREYBUS_MODS_I2C_INT_DELAY > 0
+#  define INT_COALESCE
+#  define INT_DELAY_TICKS \
+     MAX(USEC2TICK(CONFIG_GREYBUS_MODS_I2C_INT_DELAY), 1)
+#endif
+
 /* I2C packet header bit definitions */
 #define HDR_BIT_ACK    (0x01 << 10) /* 1 = Base has ACK'd last packet sent */
 #define HDR_BIT_DUMMY  (0x01 <<  9) /* 1 = dummy packet */
@@ -144,6 +167,8 @@ struct mods_i2c_dl_s
   enum base_attached_e bstate;   /* Base state (attached/detached) */
   size_t pl_size;                /* Size of packet payload in bytes */
   size_t new_pl_size;            /* Payload size to use next time TX queue empty */
+  uint8_t burst_pkts;            /* Number of packets per read by the base */
+  uint8_t new_burst_pkts;        /* Burst length to use next time TX queue empty */
   __u8 proto_ver;                /* Protocol version supported by base */
 
   enum dl_state_e txn_state;     /* Current transaction state */
@@ -152,6 +177,25 @@ struct mods_i2c_dl_s
   struct ring_buf *txp_rb;       /* Producer TX ring buffer */
   struct ring_buf *txc_rb;       /* Consumer TX ring buffer */
 
+  __u8 *burst_buf;               /* Buffer the TX burst is assembled in */
+  uint8_t burst_count;           /* Number of TX ring entries in the burst */
+  int txn_len;                   /* Expected length of current transaction */
+
+  bool int_asserted;             /* Base interrupt line is asserted */
+#ifdef INT_COALESCE
+  WDOG_ID int_wd;                /* Coalescing window timer */
+  uint8_t int_pending;           /* Messages queued while interrupt held */
+#endif
+
+#ifdef CONFIG_GREYBUS_MODS_I2C_STATS
+  uint32_t int_msgs;             /* Messages queued since last interrupt */
+  uint32_t stat_ints;            /* Number of interrupts raised */
+  uint32_t stat_msgs;            /* Number of messages covered by them */
+  uint32_t stat_max_msgs;        /* Most messages covered by one interrupt */
+  uint32_t stat_bursts;          /* Number of reads carrying data */
+  uint32_t stat_burst_pkts;      /* Number of packets sent by those reads */
+#endif
+
   __u8 *rx_buf;                  /* Buffer for received packets */
   uint32_t stop_err_cnt;         /* Count of stop errors seen since last success */
   uint32_t crc_err_cnt;          /* Count of CRC errors seen since last success */
@@ -178,6 +222,7 @@ struct i2c_dl_msg_bus_config_resp
   __le16 pl_size;                /* Payload size that mod has selected to use */
   __u8   features;               /* See DL_BIT_* defines for values */
   __u8   version;                /* I2C msg format version supported by mod */
+  __u8   burst_pkts;             /* Packets per read, if DL_BIT_BURST */
 } __packed;
 
 struct i2c_dl_msg
@@ -199,20 +244,27 @@ struct state_funcs
   int (*stop_error)(FAR struct mods_i2c_dl_s *priv);
 };
 
-static void set_pl_size(FAR struct mods_i2c_dl_s *priv, size_t pl_size)
+static void set_pl_size(FAR struct mods_i2c_dl_s *priv, size_t pl_size,
+                        uint8_t burst_pkts)
 {
   /*
    * Immediately return if payload size is not changing and ring buffer is
    * in a good state.
    */
-  if ((pl_size == priv->pl_size) && (priv->txp_rb == priv->txc_rb) &&
-      ring_buf_is_producers(priv->txp_rb))
+  if ((pl_size == priv->pl_size) && (burst_pkts == priv->burst_pkts) &&
+      (priv->txp_rb == priv->txc_rb) && ring_buf_is_producers(priv->txp_rb))
       return;
 
-  /* Free any existing RX buffer (if any) */
+  /* Free any existing RX and TX burst buffers (if any) */
   if (priv->rx_buf)
       free(priv->rx_buf);
 
+  if (priv->burst_buf)
+    {
+      free(priv->burst_buf);
+      priv->burst_buf = NULL;
+    }
+
   /* Free existing TX ring buffer (if any) */
   ring_buf_free_ring(priv->txp_rb, NULL /* free_callback */, NULL /* arg */);
 
@@ -220,6 +272,14 @@ static void set_pl_size(FAR struct mods_i2c_dl_s *priv, size_t pl_size)
   priv->rx_buf = malloc(PKT_SIZE(pl_size));
   ASSERT(priv->rx_buf);
 
+  /* Packets are copied from the ring buffer into bursts */
+  if (burst_pkts > 1)
+    {
+      priv->burst_buf = malloc(burst_pkts * PKT_SIZE(pl_size));
+      ASSERT(priv->burst_buf);
+    }
+  priv->burst_count = 0;
+
   /* Allocate TX ring buffer */
   priv->txp_rb = ring_buf_alloc_ring(INITIAL_RB_ENTRIES,
       HDR_SIZE /* headroom */, pl_size /* data_len */,
@@ -230,8 +290,9 @@ static void set_pl_size(FAR struct mods_i2c_dl_s *priv, size_t pl_size)
 
   /* Save new packet size */
   priv->pl_size = pl_size;
+  priv->burst_pkts = burst_pkts;
 
-  lldbg("%d bytes\n", priv->pl_size);
+  lldbg("%d bytes, %d pkts/burst\n", priv->pl_size, priv->burst_pkts);
 }
 
 static struct ring_buf *find_prev_rb_entry(struct ring_buf *next_rb)
@@ -293,10 +354,66 @@ static inline void set_ack_txc_hdr(FAR struct mods_i2c_dl_s *priv)
   hdr->bitmask = cpu_to_le16(le16_to_cpu(hdr->bitmask) | HDR_BIT_ACK);
 }
 
+static void host_int_set(FAR struct mods_i2c_dl_s *priv, bool assert)
+{
+  if (assert && !priv->int_asserted)
+    {
+#ifdef INT_COALESCE
+      /* The window is over once the interrupt is raised */
+      wd_cancel(priv->int_wd);
+      priv->int_pending = 0;
+#endif
+
+#ifdef CONFIG_GREYBUS_MODS_I2C_STATS
+      priv->stat_ints++;
+      priv->stat_msgs += priv->int_msgs;
+      priv->stat_max_msgs = MAX(priv->stat_max_msgs, priv->int_msgs);
+      priv->int_msgs = 0;
+#endif
+    }
+
+  priv->int_asserted = assert;
+  mods_host_int_set(assert);
+}
+
 static inline void set_int_if_needed(FAR struct mods_i2c_dl_s *priv)
 {
   /* Set the base interrupt line if data is available to be sent. */
-  mods_host_int_set(ring_buf_is_consumers(priv->txc_rb));
+  host_int_set(priv, ring_buf_is_consumers(priv->txc_rb));
+}
+
+#ifdef INT_COALESCE
+static void int_timeout(int argc, uint32_t arg, ...)
+{
+  FAR struct mods_i2c_dl_s *priv = (FAR struct mods_i2c_dl_s *)arg;
+  irqstate_t flags;
+
+  flags = irqsave();
+  priv->int_pending = 0;
+  set_int_if_needed(priv);
+  irqrestore(flags);
+}
+#endif
+
+/*
+ * Called when a new message has been queued. Unless enough messages are
+ * already waiting, hold the interrupt for up to the coalescing delay so that
+ * the base picks up several messages on a single wakeup.
+ */
+static void coalesce_int(FAR struct mods_i2c_dl_s *priv)
+{
+#ifdef INT_COALESCE
+  if (!priv->int_asserted && ring_buf_is_consumers(priv->txc_rb) &&
+      (++priv->int_pending < CONFIG_GREYBUS_MODS_I2C_INT_COUNT))
+    {
+      if (priv->int_pending == 1)
+          wd_start(priv->int_wd, INT_DELAY_TICKS, int_timeout, 1,
+                   (uint32_t)priv);
+      return;
+    }
+#endif
+
+  set_int_if_needed(priv);
 }
 
 static void set_crc(FAR struct mods_i2c_dl_s *priv)
@@ -319,6 +436,86 @@ static void reset_txc_rb_entry(FAR struct mods_i2c_dl_s *priv)
   priv->txc_rb = ring_buf_get_next(priv->txc_rb);
 }
 
+/* Release the ring buffer entries sent in the last read */
+static void reset_txc(FAR struct mods_i2c_dl_s *priv)
+{
+  if (priv->burst_pkts == 1)
+    {
+      reset_txc_rb_entry(priv);
+      return;
+    }
+
+  for (; priv->burst_count > 0; priv->burst_count--)
+    {
+      reset_txc_rb_entry(priv);
+    }
+}
+
+/*
+ * Copy as many queued packets as fit into the TX burst, then pad it with
+ * dummy packets. The ring buffer entries are only released once the base
+ * has ACK'd the burst.
+ */
+static void setup_burst_tx(FAR struct mods_i2c_dl_s *priv, bool ack)
+{
+  struct ring_buf *rb = priv->txc_rb;
+  struct i2c_msg_hdr *hdr;
+  size_t pkt_size = PKT_SIZE(priv->pl_size);
+  __u8 *pkt = priv->burst_buf;
+  uint16_t crc;
+  uint8_t i;
+
+  for (i = 0; (i < priv->burst_pkts) && ring_buf_is_consumers(rb); i++)
+    {
+      memcpy(&pkt[i * pkt_size], ring_buf_get_buf(rb), pkt_size - CRC_SIZE);
+      rb = ring_buf_get_next(rb);
+    }
+
+  priv->burst_count = i;
+
+  for (; i < priv->burst_pkts; i++)
+    {
+      memset(&pkt[i * pkt_size], 0, pkt_size - CRC_SIZE);
+      hdr = (struct i2c_msg_hdr *)&pkt[i * pkt_size];
+      hdr->bitmask = cpu_to_le16(HDR_BIT_DUMMY);
+    }
+
+  /* A single ACK covers the whole burst */
+  if (ack)
+    {
+      hdr = (struct i2c_msg_hdr *)pkt;
+      hdr->bitmask = cpu_to_le16(le16_to_cpu(hdr->bitmask) | HDR_BIT_ACK);
+    }
+
+  /* Each packet keeps its own CRC */
+  for (i = 0; i < priv->burst_pkts; i++, pkt += pkt_size)
+    {
+      crc = crc16_poly8005(pkt, priv->pl_size + HDR_SIZE, CRC_INIT_VAL);
+      *((uint16_t *)&pkt[priv->pl_size + HDR_SIZE]) = cpu_to_le16(crc);
+    }
+
+#ifdef CONFIG_GREYBUS_MODS_I2C_STATS
+  if (priv->burst_count)
+    {
+      priv->stat_bursts++;
+      priv->stat_burst_pkts += priv->burst_count;
+    }
+#endif
+}
+
+/* Bitmask of the first packet sent in the last read */
+static uint16_t txc_bitmask(FAR struct mods_i2c_dl_s *priv)
+{
+  struct i2c_msg_hdr *hdr;
+
+  if (priv->burst_pkts > 1)
+      hdr = (struct i2c_msg_hdr *)priv->burst_buf;
+  else
+      hdr = ring_buf_get_buf(priv->txc_rb);
+
+  return le16_to_cpu(hdr->bitmask);
+}
+
 #ifdef CONFIG_DEBUG_VERBOSE
 static const char* state_name(enum dl_state_e state)
 {
@@ -358,7 +555,11 @@ static int attach_cb(FAR void *arg, const void *data)
 
       /* Reset GPIOs to initial state */
       mods_rfr_set(0);
-      mods_host_int_set(false);
+      host_int_set(priv, false);
+#ifdef INT_COALESCE
+      wd_cancel(priv->int_wd);
+      priv->int_pending = 0;
+#endif
 #ifdef GPIO_MODS_I2C_PU_EN
       gpio_direction_in(GPIO_MODS_I2C_PU_EN);
 #endif
@@ -371,9 +572,12 @@ static int attach_cb(FAR void *arg, const void *data)
         {
           reset_txc_rb_entry(priv);
         }
+      priv->burst_count = 0;
 
-      /* Return packet size back to default */
-      set_pl_size(priv, DEFAULT_PAYLOAD_SZ);
+      /* Return packet size back to default, without bursts */
+      set_pl_size(priv, DEFAULT_PAYLOAD_SZ, 1);
+      priv->new_pl_size = 0;
+      priv->new_burst_pkts = 0;
 
       /* Assume next base only supports the minimum protocol version */
       priv->proto_ver = MIN_PROTO_VER;
@@ -450,7 +654,12 @@ static int queue_data(FAR struct mods_i2c_dl_s *priv, __u8 msg_type,
       next_txp(priv);
     }
 
-  set_int_if_needed(priv);
+#ifdef CONFIG_GREYBUS_MODS_I2C_STATS
+  if (msg_type == MSG_TYPE_NW)
+      priv->int_msgs++;
+#endif
+
+  coalesce_int(priv);
 
   return OK;
 }
@@ -460,6 +669,7 @@ static int dl_recv(FAR struct mods_dl_s *dl, FAR const void *buf, size_t len)
   FAR struct mods_i2c_dl_s *priv = (FAR struct mods_i2c_dl_s *)dl;
   struct i2c_dl_msg req;
   struct i2c_dl_msg resp;
+  size_t resp_len;
   uint16_t pl_size;
   int ret;
 
@@ -515,11 +725,24 @@ static int dl_recv(FAR struct mods_dl_s *dl, FAR const void *buf, size_t len)
   resp.bus_resp.version = PROTO_VER;
   resp.bus_resp.features = 0;
 
-  ret = queue_data(priv, MSG_TYPE_DL, &resp, sizeof(resp));
+  /* Bases not supporting bursts get the response they know about */
+  resp_len = offsetof(struct i2c_dl_msg, bus_resp.burst_pkts);
+
+  if ((BURST_PKTS > 1) && (req.bus_req.features & DL_BIT_BURST))
+    {
+      /* Like the payload size, switch once the response has been sent */
+      priv->new_burst_pkts = BURST_PKTS;
+      resp.bus_resp.features |= DL_BIT_BURST;
+      resp.bus_resp.burst_pkts = BURST_PKTS;
+      resp_len = sizeof(resp);
+    }
+
+  ret = queue_data(priv, MSG_TYPE_DL, &resp, resp_len);
   if (ret)
     {
       /* Abort packet size change due to the send error */
       priv->new_pl_size = 0;
+      priv->new_burst_pkts = 0;
     }
 
   return ret;
@@ -527,9 +750,26 @@ static int dl_recv(FAR struct mods_dl_s *dl, FAR const void *buf, size_t len)
 
 static int idle_start_tx(FAR struct mods_i2c_dl_s *priv, uint8_t **buffer)
 {
+  if (priv->burst_pkts > 1)
+    {
+      setup_burst_tx(priv, false);
+      if (priv->burst_count)
+        {
+          host_int_set(priv, false);
+          set_state(priv, DL_STATE_TX);
+        }
+      else /* Nothing to send! */
+        {
+          set_state(priv, DL_STATE_DUMMY);
+        }
+
+      *buffer = priv->burst_buf;
+      return OK;
+    }
+
   if (ring_buf_is_consumers(priv->txc_rb))
     {
-      mods_host_int_set(false);
+      host_int_set(priv, false);
       set_state(priv, DL_STATE_TX);
     }
   else /* Nothing to send! */
@@ -611,12 +851,16 @@ static int rx_stop_success(FAR struct mods_i2c_dl_s *priv)
       if (!(bitmask & HDR_BIT_DUMMY))
           lldbg("garbage packet\n");
 
-      /* Change packet size if needed */
-      if (priv->new_pl_size > 0)
+      /* Change packet size or burst length if needed */
+      if ((priv->new_pl_size > 0) || (priv->new_burst_pkts > 0))
         {
           DEBUGASSERT(priv->txp_rb == priv->txc_rb);
-          set_pl_size(priv, priv->new_pl_size);
+          set_pl_size(priv,
+                      priv->new_pl_size ? priv->new_pl_size : priv->pl_size,
+                      priv->new_burst_pkts ? priv->new_burst_pkts :
+                                             priv->burst_pkts);
           priv->new_pl_size = 0;
+          priv->new_burst_pkts = 0;
         }
 
       next_state = DL_STATE_IDLE;
@@ -714,7 +958,7 @@ static int tx_stop_error(FAR struct mods_i2c_dl_s *priv)
     {
       lldbg("abort\n");
 
-      reset_txc_rb_entry(priv);
+      reset_txc(priv);
       priv->tx_tries_remaining = NUM_TRIES;
     }
   else
@@ -732,7 +976,7 @@ static int ack_rx_start_tx(FAR struct mods_i2c_dl_s *priv, uint8_t **buffer)
   set_state(priv, DL_STATE_IDLE);
 
   /* Assume the base was happy with last transmission */
-  reset_txc_rb_entry(priv);
+  reset_txc(priv);
   priv->tx_tries_remaining = NUM_TRIES;
 
   set_int_if_needed(priv);
@@ -757,7 +1001,7 @@ static int ack_rx_stop_success(FAR struct mods_i2c_dl_s *priv)
       if (priv->tx_tries_remaining <= 0)
           lldbg("abort\n");
 
-      reset_txc_rb_entry(priv);
+      reset_txc(priv);
       priv->tx_tries_remaining = NUM_TRIES;
     }
   else
@@ -770,9 +1014,19 @@ static int ack_rx_stop_success(FAR struct mods_i2c_dl_s *priv)
 
 static int ack_tx_start_tx(FAR struct mods_i2c_dl_s *priv, uint8_t **buffer)
 {
+  if (priv->burst_pkts > 1)
+    {
+      setup_burst_tx(priv, true);
+      if (priv->burst_count)
+          host_int_set(priv, false);
+
+      *buffer = priv->burst_buf;
+      return OK;
+    }
+
   if (ring_buf_is_consumers(priv->txc_rb))
     {
-      mods_host_int_set(false);
+      host_int_set(priv, false);
     }
   else /* Nothing to send! */
     {
@@ -789,8 +1043,7 @@ static int ack_tx_start_tx(FAR struct mods_i2c_dl_s *priv, uint8_t **buffer)
 
 static int ack_tx_stop_success(FAR struct mods_i2c_dl_s *priv)
 {
-  struct i2c_msg_hdr *hdr = ring_buf_get_buf(priv->txc_rb);
-  uint16_t bitmask = le16_to_cpu(hdr->bitmask);
+  uint16_t bitmask = txc_bitmask(priv);
 
   /* It is possible we sent a valid packet with ACK */
   if (bitmask & HDR_BIT_VALID)
@@ -799,7 +1052,7 @@ static int ack_tx_stop_success(FAR struct mods_i2c_dl_s *priv)
       return -EAGAIN;
     }
 
-  reset_txc_rb_entry(priv);
+  reset_txc(priv);
   set_state(priv, DL_STATE_IDLE);
 
   return OK;
@@ -807,15 +1060,14 @@ static int ack_tx_stop_success(FAR struct mods_i2c_dl_s *priv)
 
 static int ack_tx_stop_error(FAR struct mods_i2c_dl_s *priv)
 {
-  struct i2c_msg_hdr *hdr = ring_buf_get_buf(priv->txc_rb);
-  uint16_t bitmask = le16_to_cpu(hdr->bitmask);
+  uint16_t bitmask = txc_bitmask(priv);
 
   if (!(bitmask & HDR_BIT_VALID) || --priv->tx_tries_remaining <= 0)
     {
       if (priv->tx_tries_remaining <= 0)
           lldbg("abort\n");
 
-      reset_txc_rb_entry(priv);
+      reset_txc(priv);
       priv->tx_tries_remaining = NUM_TRIES;
     }
   else
@@ -829,7 +1081,7 @@ static int ack_tx_stop_error(FAR struct mods_i2c_dl_s *priv)
 
 static int dummy_stop(FAR struct mods_i2c_dl_s *priv)
 {
-  reset_txc_rb_entry(priv);
+  reset_txc(priv);
   set_state(priv, DL_STATE_IDLE);
 
   return OK;
@@ -881,7 +1133,13 @@ static int txn_start_cb(void *v, uint8_t dir, uint8_t **buffer, int *buflen)
     }
   while (ret == -EAGAIN);
 
-  *buflen = PKT_SIZE(priv->pl_size);
+  /* The base reads whole bursts */
+  if ((dir == I2C_READBIT) && (priv->burst_pkts > 1))
+      priv->txn_len = priv->burst_pkts * PKT_SIZE(priv->pl_size);
+  else
+      priv->txn_len = PKT_SIZE(priv->pl_size);
+
+  *buflen = priv->txn_len;
 
   irqrestore(flags);
 
@@ -901,7 +1159,7 @@ static void txn_stop_cb(void *v, int status, int xfered)
 
   do
     {
-      if ((status == OK) && (xfered >= PKT_SIZE(priv->pl_size)))
+      if ((status == OK) && (xfered >= priv->txn_len))
         {
           ret = state_funcs_tbl[priv->txn_state].stop_success(priv);
           priv->stop_err_cnt = 0;
@@ -951,6 +1209,122 @@ static struct mods_i2c_dl_s mods_i2c_dl =
   .dl  = { &mods_dl_ops },
 };
 
+#if defined(CONFIG_GREYBUS_MODS_I2C_STATS) && \
+    !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+
+#define STATS_BUFLEN 160
+
+struct i2c_dl_stats_file_s
+{
+  struct procfs_file_s base;
+  size_t len;
+  char buf[STATS_BUFLEN];
+};
+
+static int stats_open(FAR struct file *filep, FAR const char *relpath,
+                      int oflags, mode_t mode)
+{
+  FAR struct i2c_dl_stats_file_s *file;
+
+  if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+      return -EACCES;
+
+  file = kmm_zalloc(sizeof(*file));
+  if (!file)
+      return -ENOMEM;
+
+  filep->f_priv = file;
+  return OK;
+}
+
+static int stats_close(FAR struct file *filep)
+{
+  kmm_free(filep->f_priv);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+static ssize_t stats_read(FAR struct file *filep, FAR char *buffer,
+                          size_t buflen)
+{
+  FAR struct i2c_dl_stats_file_s *file = filep->f_priv;
+  FAR struct mods_i2c_dl_s *priv = &mods_i2c_dl;
+  uint32_t ints, msgs, max_msgs, bursts, burst_pkts;
+  irqstate_t flags;
+  off_t offset;
+  ssize_t ret;
+
+  /* Take a snapshot on the first read so that the content stays stable */
+  if (filep->f_pos == 0)
+    {
+      flags = irqsave();
+      ints = priv->stat_ints;
+      msgs = priv->stat_msgs;
+      max_msgs = priv->stat_max_msgs;
+      bursts = priv->stat_bursts;
+      burst_pkts = priv->stat_burst_pkts;
+      irqrestore(flags);
+
+      file->len = snprintf(file->buf, STATS_BUFLEN,
+                           "interrupts %u\nmessages %u\n"
+                           "max msgs/int %u\navg msgs/int %u.%02u\n"
+                           "bursts %u\npackets %u\n",
+                           ints, msgs, max_msgs,
+                           ints ? msgs / ints : 0,
+                           ints ? (msgs % ints) * 100 / ints : 0,
+                           bursts, burst_pkts);
+    }
+
+  offset = filep->f_pos;
+  ret = procfs_memcpy(file->buf, file->len, buffer, buflen, &offset);
+  if (ret > 0)
+      filep->f_pos += ret;
+
+  return ret;
+}
+
+static int stats_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct i2c_dl_stats_file_s *file;
+
+  file = kmm_malloc(sizeof(*file));
+  if (!file)
+      return -ENOMEM;
+
+  memcpy(file, oldp->f_priv, sizeof(*file));
+  newp->f_priv = file;
+  return OK;
+}
+
+static int stats_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+  buf->st_mode    = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+/* See fs_procfs.c -- this structure is explicitly externed there */
+const struct procfs_operations mods_i2c_dl_procfsoperations =
+{
+  stats_open,       /* open */
+  stats_close,      /* close */
+  stats_read,       /* read */
+  NULL,             /* write */
+
+  stats_dup,        /* dup */
+
+  NULL,             /* opendir */
+  NULL,             /* closedir */
+  NULL,             /* readdir */
+  NULL,             /* rewinddir */
+
+  stats_stat        /* stat */
+};
+#endif
+
 #ifdef CONFIG_PM
 static int pm_prepare(struct pm_callback_s *cb, enum pm_state_e state)
 {
@@ -1007,7 +1381,12 @@ FAR struct mods_dl_s *mods_dl_init(struct mods_dl_cb_s *cb)
   mods_i2c_dl.cb = cb;
   mods_i2c_dl.i2c = i2c;
 
-  set_pl_size(&mods_i2c_dl, DEFAULT_PAYLOAD_SZ);
+  set_pl_size(&mods_i2c_dl, DEFAULT_PAYLOAD_SZ, 1);
+
+#ifdef INT_COALESCE
+  mods_i2c_dl.int_wd = wd_create();
+  DEBUGASSERT(mods_i2c_dl.int_wd);
+#endif
 
   /* RDY GPIO must be initialized before the WAKE interrupt */
   mods_rfr_init();
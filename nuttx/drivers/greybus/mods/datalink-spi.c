@@ -33,6 +33,7 @@
 #include <queue.h>
 #include <semaphore.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/types.h>
@@ -40,9 +41,11 @@
 #include <arch/board/mods.h>
 #include <arch/byteorder.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/config.h>
 #include <nuttx/gpio.h>
 #include <nuttx/greybus/mods.h>
+#include <nuttx/greybus/mods-ctrl.h>
 #include <nuttx/greybus/types.h>
 #include <nuttx/hires_tmr.h>
 #include <nuttx/kthread.h>
@@ -59,6 +62,14 @@
 #  error "CONFIG_GREYBUS_MODS_DESIRED_PKT_SIZE > MODS_DL_PAYLOAD_MAX_SZ"
 #endif
 
+#ifdef CONFIG_GREYBUS_MODS_SPI_DYNAMIC_PKT_SIZE
+/* Number of messages between two evaluations of the packet size */
+#  define PKT_SIZE_WINDOW   (32)
+
+/* Minimum time between two packet size changes */
+#  define PKT_SIZE_HOLDOFF  MSEC2TICK(CONFIG_GREYBUS_MODS_SPI_PKT_SIZE_HOLDOFF)
+#endif
+
 /*
  * Before root version 3, the MuC was responsible for deasserting the RFR and
  * INT signals manually. The signals must be deasserted ASAP when the transfer
@@ -104,6 +115,10 @@
 
 /* Possible values for bus config features */
 #define DL_BIT_ACK     (1 << 0)     /* Flag to indicate ACKing is supported */
+#define DL_BIT_FRAME   (1 << 1)     /* Flag to indicate framing is supported */
+
+/* Number of packets to send per SPI transaction, if the base supports it */
+#define FRAME_PKTS     CONFIG_GREYBUS_MODS_SPI_FRAME_PKTS
 
 /* SPI packet CRC size (in bytes) */
 #define CRC_SIZE       (2)
@@ -126,6 +141,14 @@
 /* Macro to determine the packet size from the payload size */
 #define PKT_SIZE(pl_size)  (pl_size + HDR_SIZE + CRC_SIZE)
 
+/*
+ * Macros to determine the size taken by a packet in a frame, and the size of
+ * a frame. A frame packs several packets (header and payload) in a single
+ * SPI transaction, protected by a single CRC at the end.
+ */
+#define SLOT_SIZE(pkt_size)  (pkt_size - CRC_SIZE)
+#define FRAME_SIZE(pkt_size, pkts)  ((pkts) * SLOT_SIZE(pkt_size) + CRC_SIZE)
+
 /* Macro for checking if the provided number is a power of two. */
 #define IS_PWR_OF_TWO(x) (!(x & (x - 1)) && x)
 
@@ -168,6 +191,8 @@ struct mods_spi_dl_s
   bool xfer_setup;               /* Flag to indicate transfer in progress */
   size_t pkt_size;               /* Size of packet (hdr + pl + CRC) in bytes */
   size_t new_pkt_size;           /* Packet size to use next time TX queue empty */
+  uint8_t frame_pkts;            /* Number of packets per SPI transaction */
+  uint8_t new_frame_pkts;        /* Frame length to use next time TX queue empty */
   __u8 proto_ver;                /* Protocol version supported by base */
 
   pid_t pid;                     /* The task ID of the worker thread */
@@ -177,6 +202,15 @@ struct mods_spi_dl_s
   struct spi_work_s terr_work;
   sem_t sem;
 
+#ifdef CONFIG_GREYBUS_MODS_SPI_DYNAMIC_PKT_SIZE
+  uint16_t max_pl_size;          /* Largest payload size usable with base */
+  uint16_t want_pl_size;         /* Payload size to ask for at next bus config */
+  uint32_t avg_msg_len;          /* Moving average of message length (x8) */
+  uint16_t msg_count;            /* Messages since last evaluation */
+  uint32_t last_change;          /* Time of last packet size request (ticks) */
+  struct spi_work_s pkt_work;
+#endif
+
 #ifdef CONFIG_GREYBUS_MODS_ACK
   bool ack_supported;            /* Base supports ACK'ing on success */
   gpio_cfg_t tack_cfg;           /* Saved config for the ACK transmit line */
@@ -187,6 +221,9 @@ struct mods_spi_dl_s
   struct ring_buf *txp_rb;       /* Producer TX ring buffer */
   struct ring_buf *txc_rb;       /* Consumer TX ring buffer */
 
+  __u8 *frame_tx_buf;            /* Buffer the TX frame is assembled in */
+  uint8_t frame_tx_count;        /* Number of TX ring entries in the frame */
+
   __u8 *rx_buf;                  /* Buffer for received packets */
 
   /*
@@ -195,6 +232,15 @@ struct mods_spi_dl_s
    */
   __u8 rcvd_payload[MODS_DL_PAYLOAD_MAX_SZ];
   uint32_t rcvd_payload_idx;
+
+  /*
+   * Buffer the current message is reassembled into. Points either to
+   * rcvd_payload or to owned_payload when the network layer supports
+   * zero-copy receive.
+   */
+  __u8 *payload;
+  __u8 *owned_payload;           /* Buffer from cb->alloc_buf() (if any) */
+  size_t owned_payload_sz;
   uint8_t pkts_remaining;        /* Number of packets needed to complete msg */
 };
 
@@ -211,6 +257,7 @@ struct spi_dl_msg_bus_config_resp
   __le16 pl_size;                /* Payload size that mod has selected to use */
   __u8   features;               /* See DL_BIT_* defines for values */
   __u8   version;                /* SPI msg format version supported by mod */
+  __u8   frame_pkts;             /* Packets per transaction, if DL_BIT_FRAME */
 } __packed;
 
 struct spi_dl_msg
@@ -262,8 +309,12 @@ static void dl_work_cancel(FAR struct mods_spi_dl_s *priv,
 
 static inline bool txc_rb_is_valid(FAR struct mods_spi_dl_s *priv)
 {
-  struct spi_msg_hdr *hdr = ring_buf_get_data(priv->txc_rb);
+  struct spi_msg_hdr *hdr;
+
+  if (priv->frame_pkts > 1)
+      return priv->frame_tx_count > 0;
 
+  hdr = ring_buf_get_data(priv->txc_rb);
   return (le16_to_cpu(hdr->bitmask) & HDR_BIT_VALID) != 0;
 }
 
@@ -277,7 +328,8 @@ static int alloc_callback(struct ring_buf *rb, void *arg)
   return OK;
 }
 
-static void set_pkt_size(FAR struct mods_spi_dl_s *priv, size_t pkt_size)
+static void set_pkt_size(FAR struct mods_spi_dl_s *priv, size_t pkt_size,
+                         uint8_t frame_pkts)
 {
   int rb_num;
   unsigned int rb_entries;
@@ -286,13 +338,20 @@ static void set_pkt_size(FAR struct mods_spi_dl_s *priv, size_t pkt_size)
    * Immediately return if packet size is not changing and ring buffer is
    * in a good state.
    */
-  if ((pkt_size == priv->pkt_size) && (priv->txp_rb == priv->txc_rb))
+  if ((pkt_size == priv->pkt_size) && (frame_pkts == priv->frame_pkts) &&
+      (priv->txp_rb == priv->txc_rb))
       return;
 
-  /* Free any existing RX buffer (if any) */
+  /* Free any existing RX and TX frame buffers (if any) */
   if (priv->rx_buf)
     free(priv->rx_buf);
 
+  if (priv->frame_tx_buf)
+    {
+      free(priv->frame_tx_buf);
+      priv->frame_tx_buf = NULL;
+    }
+
   /* Free existing TX ring buffer (if any) */
   ring_buf_free_ring(priv->txp_rb, NULL /* free_callback */, NULL /* arg */);
 
@@ -302,22 +361,74 @@ static void set_pkt_size(FAR struct mods_spi_dl_s *priv, size_t pkt_size)
   rb_entries  = MIN(rb_entries, MAX_NUM_RB_ENTRIES);
 
   /* Allocate RX buffer */
-  priv->rx_buf = malloc(pkt_size);
+  priv->rx_buf = malloc(FRAME_SIZE(pkt_size, frame_pkts));
   ASSERT(priv->rx_buf);
 
-  /* Allocate TX ring buffer */
+  /* Packets are copied from the ring buffer into frames */
+  if (frame_pkts > 1)
+    {
+      priv->frame_tx_buf = malloc(FRAME_SIZE(pkt_size, frame_pkts));
+      ASSERT(priv->frame_tx_buf);
+    }
+  priv->frame_tx_count = 0;
+
+  /* Allocate TX ring buffer (one block, cache line aligned for DMA) */
   rb_num = 0;
-  priv->txp_rb = ring_buf_alloc_ring(rb_entries /* entries */,
+  priv->txp_rb = ring_buf_alloc_ring_contig(rb_entries /* entries */,
       sizeof(rb_num) /* headroom */, pkt_size /* data len */,
-      0 /* tailroom */, alloc_callback /* alloc_callback */,
+      0 /* tailroom */, 0 /* align */, alloc_callback /* alloc_callback */,
       NULL /* free_callback */, &rb_num /* arg */);
   ASSERT(priv->txp_rb);
   priv->txc_rb = priv->txp_rb;
 
   /* Save new packet size */
   priv->pkt_size = pkt_size;
+  priv->frame_pkts = frame_pkts;
+
+  dbg("%d bytes, %d entries, %d pkts/frame\n", priv->pkt_size, rb_entries,
+      priv->frame_pkts);
+}
+
+/* Caller must hold semaphore before calling this function! */
+static inline void set_txp_hdr(FAR struct mods_spi_dl_s *priv, uint16_t bits)
+{
+  struct spi_msg_hdr *hdr = ring_buf_get_data(priv->txp_rb);
+  hdr->bitmask = cpu_to_le16(bits);
+}
+
+/* Caller must hold semaphore before calling this function! */
+static inline void next_txp(FAR struct mods_spi_dl_s *priv)
+{
+  ring_buf_pass(priv->txp_rb);
+  priv->txp_rb = ring_buf_get_next(priv->txp_rb);
+}
+
+/*
+ * Return the payload area of the next free TX ring buffer entry, if a message
+ * of len bytes fits in a single packet.
+ *
+ * Caller must hold semaphore before calling this function!
+ */
+static FAR void *reserve_txp(FAR struct mods_spi_dl_s *priv, size_t len)
+{
+  if (len > PL_SIZE(priv->pkt_size) || ring_buf_is_consumers(priv->txp_rb))
+      return NULL;
+
+  return (__u8 *)ring_buf_get_data(priv->txp_rb) + HDR_SIZE;
+}
 
-  dbg("%d bytes, %d entries\n", priv->pkt_size, rb_entries);
+/*
+ * Hand a message built in the entry returned by reserve_txp() over to the
+ * consumer.
+ *
+ * Caller must hold semaphore before calling this function!
+ */
+static void commit_txp(FAR struct mods_spi_dl_s *priv, __u8 msg_type,
+                       size_t len)
+{
+  set_txp_hdr(priv, HDR_BIT_VALID | HDR_BIT_PKT1 | (msg_type & HDR_BIT_TYPE));
+  ring_buf_put(priv->txp_rb, priv->pkt_size);
+  next_txp(priv);
 }
 
 /* Caller must hold semaphore before calling this function! */
@@ -325,7 +436,8 @@ static int dl_recv(FAR struct mods_dl_s *dl, FAR const void *buf, size_t len)
 {
   FAR struct mods_spi_dl_s *priv = (FAR struct mods_spi_dl_s *)dl;
   struct spi_dl_msg req;
-  struct spi_dl_msg resp;
+  struct spi_dl_msg *resp;
+  size_t resp_len;
   uint16_t pl_size;
 
   /*
@@ -350,11 +462,26 @@ static int dl_recv(FAR struct mods_dl_s *dl, FAR const void *buf, size_t len)
 
   priv->proto_ver = req.bus_req.version;
 
-  resp.id = DL_MSG_ID_BUS_CFG_RESP;
-  resp.bus_resp.max_speed = cpu_to_le32(CONFIG_GREYBUS_MODS_MAX_BUS_SPEED);
+  /* The response always fits in a single packet, build it in place */
+  resp = reserve_txp(priv, sizeof(*resp));
+  if (!resp)
+    {
+      dbg("Ring buffer is full!\n");
+      return -ENOMEM;
+    }
+
+  resp->id = DL_MSG_ID_BUS_CFG_RESP;
+  resp->bus_resp.max_speed = cpu_to_le32(CONFIG_GREYBUS_MODS_MAX_BUS_SPEED);
 
   pl_size = MIN(CONFIG_GREYBUS_MODS_DESIRED_PKT_SIZE,
                 le16_to_cpu(req.bus_req.max_pl_size));
+
+#ifdef CONFIG_GREYBUS_MODS_SPI_DYNAMIC_PKT_SIZE
+  /* Traffic statistics may ask for less than the largest payload size */
+  priv->max_pl_size = pl_size;
+  if (priv->want_pl_size)
+      pl_size = MIN(pl_size, priv->want_pl_size);
+#endif
   /*
    * Verify new packet size is valid. The payload must be no smaller than
    * the default packet size and must be a power of two.
@@ -375,37 +502,99 @@ static int dl_recv(FAR struct mods_dl_s *dl, FAR const void *buf, size_t len)
        */
       pl_size = 0;
     }
-  resp.bus_resp.pl_size = cpu_to_le16(pl_size);
+  resp->bus_resp.pl_size = cpu_to_le16(pl_size);
 
-  resp.bus_resp.version = PROTO_VER;
-  resp.bus_resp.features = 0;
+  resp->bus_resp.version = PROTO_VER;
+  resp->bus_resp.features = 0;
 
 #ifdef CONFIG_GREYBUS_MODS_ACK
   if (req.bus_req.features & DL_BIT_ACK)
     {
       priv->ack_supported = true;
-      resp.bus_resp.features |= DL_BIT_ACK;
+      resp->bus_resp.features |= DL_BIT_ACK;
     }
 
   vdbg("ack_supported = %d\n", priv->ack_supported);
 #endif
 
-  return queue_data(priv, MSG_TYPE_DL, &resp, sizeof(resp));
+  /* Bases not supporting frames get the response they know about */
+  resp_len = offsetof(struct spi_dl_msg, bus_resp.frame_pkts);
+
+  if ((FRAME_PKTS > 1) && (req.bus_req.features & DL_BIT_FRAME))
+    {
+      /* Like the packet size, switch once the response has been sent */
+      priv->new_frame_pkts = FRAME_PKTS;
+      resp->bus_resp.features |= DL_BIT_FRAME;
+      resp->bus_resp.frame_pkts = FRAME_PKTS;
+      resp_len = sizeof(*resp);
+    }
+
+  commit_txp(priv, MSG_TYPE_DL, resp_len);
+  return OK;
 }
 
-/* Caller must hold semaphore before calling this function! */
-static inline void set_txp_hdr(FAR struct mods_spi_dl_s *priv, uint16_t bits)
+#ifdef CONFIG_GREYBUS_MODS_SPI_DYNAMIC_PKT_SIZE
+/* Runs on the data link thread without the semaphore held */
+static void pkt_size_worker(FAR void *arg)
 {
-  struct spi_msg_hdr *hdr = ring_buf_get_data(priv->txp_rb);
-  hdr->bitmask = cpu_to_le16(bits);
+  FAR struct mods_spi_dl_s *priv = arg;
+  int ret;
+
+  ret = mb_control_send_dl_reconfig(priv->want_pl_size);
+  if (ret)
+      dbg("Failed to request payload size %d: %d\n", priv->want_pl_size, ret);
 }
 
-/* Caller must hold semaphore before calling this function! */
-static inline void next_txp(FAR struct mods_spi_dl_s *priv)
+/*
+ * Track the length of the messages exchanged with the base, and ask the base
+ * to renegotiate the packet size when it no longer fits the traffic. A larger
+ * payload is asked for as soon as the average message spans several packets,
+ * but a smaller one only once the average message fits in a quarter of a
+ * packet, so that mixed traffic does not flip back and forth.
+ *
+ * Caller must hold semaphore before calling this function!
+ */
+static void pkt_size_update(FAR struct mods_spi_dl_s *priv, size_t len)
 {
-  ring_buf_pass(priv->txp_rb);
-  priv->txp_rb = ring_buf_get_next(priv->txp_rb);
+  uint16_t cur_pl_size = PL_SIZE(priv->pkt_size);
+  uint16_t pl_size;
+  uint32_t avg;
+
+  priv->avg_msg_len += len - (priv->avg_msg_len >> 3);
+  if (++priv->msg_count < PKT_SIZE_WINDOW)
+      return;
+
+  priv->msg_count = 0;
+
+  /* Nothing to do until bus config with base has been done */
+  if (priv->max_pl_size <= DEFAULT_PAYLOAD_SZ)
+      return;
+
+  /* A previous request is still pending */
+  if (priv->new_pkt_size || !work_available(&priv->pkt_work))
+      return;
+
+  if ((clock_systimer() - priv->last_change) < PKT_SIZE_HOLDOFF)
+      return;
+
+  /* Smallest power of two payload holding the average message */
+  avg = priv->avg_msg_len >> 3;
+  for (pl_size = DEFAULT_PAYLOAD_SZ;
+       (pl_size < priv->max_pl_size) && (pl_size < avg);
+       pl_size <<= 1);
+
+  if ((pl_size <= cur_pl_size) && ((pl_size << 2) > cur_pl_size))
+      return;
+
+  vdbg("avg=%d, pl_size %d -> %d\n", avg, cur_pl_size, pl_size);
+
+  priv->want_pl_size = pl_size;
+  priv->last_change = clock_systimer();
+  dl_work_queue(priv, &priv->pkt_work, pkt_size_worker);
 }
+#else
+#  define pkt_size_update(p, l)
+#endif
 
 /* Caller must hold semaphore before calling this function! */
 static inline void setup_for_dummy_tx(FAR struct mods_spi_dl_s *priv)
@@ -414,6 +603,39 @@ static inline void setup_for_dummy_tx(FAR struct mods_spi_dl_s *priv)
   next_txp(priv);
 }
 
+/*
+ * Copy as many queued packets as fit into the TX frame, then pad it with
+ * dummy packets. The ring buffer entries are only released once the frame
+ * has been sent.
+ *
+ * Caller must hold semaphore before calling this function!
+ */
+static void setup_frame_tx(FAR struct mods_spi_dl_s *priv)
+{
+  struct ring_buf *rb = priv->txc_rb;
+  struct spi_msg_hdr *hdr;
+  size_t slot_size = SLOT_SIZE(priv->pkt_size);
+  __u8 *slot = priv->frame_tx_buf;
+  uint8_t i;
+
+  for (i = 0; (i < priv->frame_pkts) && ring_buf_is_consumers(rb); i++)
+    {
+      memcpy(slot, ring_buf_get_data(rb), slot_size);
+      slot += slot_size;
+      rb = ring_buf_get_next(rb);
+    }
+
+  priv->frame_tx_count = i;
+
+  for (; i < priv->frame_pkts; i++)
+    {
+      memset(slot, 0, slot_size);
+      hdr = (struct spi_msg_hdr *)slot;
+      hdr->bitmask = cpu_to_le16(HDR_BIT_DUMMY);
+      slot += slot_size;
+    }
+}
+
 static inline void deassert_rfr_int(void)
 {
   mods_rfr_set(0);
@@ -425,6 +647,7 @@ static void xfer(FAR struct mods_spi_dl_s *priv)
 {
   struct ring_buf *rb;
   bool set_int = false;
+  void *tx_buf;
 
   rb = priv->txc_rb;
 
@@ -449,7 +672,8 @@ static void xfer(FAR struct mods_spi_dl_s *priv)
   if (ring_buf_is_producers(rb))
     {
       vdbg("%d RX\n", *((int *)ring_buf_get_buf(rb)));
-      setup_for_dummy_tx(priv);
+      if (priv->frame_pkts == 1)
+          setup_for_dummy_tx(priv);
     }
   else
     {
@@ -457,6 +681,16 @@ static void xfer(FAR struct mods_spi_dl_s *priv)
       set_int = true;
     }
 
+  if (priv->frame_pkts > 1)
+    {
+      setup_frame_tx(priv);
+      tx_buf = priv->frame_tx_buf;
+    }
+  else
+    {
+      tx_buf = ring_buf_get_data(rb);
+    }
+
 #ifdef CONFIG_GREYBUS_MODS_ACK
   if (priv->ack_supported)
     {
@@ -468,7 +702,8 @@ static void xfer(FAR struct mods_spi_dl_s *priv)
     }
 #endif
 
-  SPI_EXCHANGE(priv->spi, ring_buf_get_data(rb), priv->rx_buf, priv->pkt_size);
+  SPI_EXCHANGE(priv->spi, tx_buf, priv->rx_buf,
+               FRAME_SIZE(priv->pkt_size, priv->frame_pkts));
 
   /* Signal to base that we're ready to transceive */
   mods_rfr_set(1);
@@ -493,6 +728,21 @@ static void reset_txc_rb_entry(FAR struct mods_spi_dl_s *priv)
   priv->txc_rb = ring_buf_get_next(priv->txc_rb);
 }
 
+/* Release the ring buffer entries sent in the last transaction */
+static void reset_txc(FAR struct mods_spi_dl_s *priv)
+{
+  if (priv->frame_pkts == 1)
+    {
+      reset_txc_rb_entry(priv);
+      return;
+    }
+
+  for (; priv->frame_tx_count > 0; priv->frame_tx_count--)
+    {
+      reset_txc_rb_entry(priv);
+    }
+}
+
 static int attach_cb(FAR void *arg, const void *data)
 {
   FAR struct mods_spi_dl_s *priv = (FAR struct mods_spi_dl_s *)arg;
@@ -542,15 +792,28 @@ static int attach_cb(FAR void *arg, const void *data)
       dl_work_cancel(priv, &priv->wake_work);
       dl_work_cancel(priv, &priv->tend_work);
       dl_work_cancel(priv, &priv->terr_work);
+#ifdef CONFIG_GREYBUS_MODS_SPI_DYNAMIC_PKT_SIZE
+      dl_work_cancel(priv, &priv->pkt_work);
+#endif
 
       /* Cleanup any unsent messages */
       while (ring_buf_is_consumers(priv->txc_rb))
         {
           reset_txc_rb_entry(priv);
         }
-
-      /* Return packet size back to default */
-      set_pkt_size(priv, PKT_SIZE(DEFAULT_PAYLOAD_SZ));
+      priv->frame_tx_count = 0;
+
+      /* Return packet size back to default, without framing */
+      set_pkt_size(priv, PKT_SIZE(DEFAULT_PAYLOAD_SZ), 1);
+      priv->new_pkt_size = 0;
+      priv->new_frame_pkts = 0;
+
+#ifdef CONFIG_GREYBUS_MODS_SPI_DYNAMIC_PKT_SIZE
+      priv->max_pl_size = 0;
+      priv->want_pl_size = 0;
+      priv->avg_msg_len = 0;
+      priv->msg_count = 0;
+#endif
 
       /* Assume next base only supports the minimum protocol version */
       priv->proto_ver = MIN_PROTO_VER;
@@ -645,68 +908,117 @@ static bool ack_handler(FAR struct mods_spi_dl_s *priv, enum ack ack_req)
   return true;
 }
 
-static void txn_finished_worker(FAR void *arg)
+/*
+ * Select the buffer to reassemble the next message into. Network messages
+ * are received in a buffer owned by the network layer when possible, to
+ * avoid copying them once more in the upper layers.
+ */
+static void payload_setup(FAR struct mods_spi_dl_s *priv, bool nw, size_t len)
 {
-  FAR struct mods_spi_dl_s *priv = arg;
-  struct spi_msg_hdr *hdr = (struct spi_msg_hdr *)priv->rx_buf;
-  uint16_t bitmask = le16_to_cpu(hdr->bitmask);
-  size_t pl_size = PL_SIZE(priv->pkt_size);
-  buf_t recv = priv->cb->recv;
-  int ret;
-  enum ack ack_req;
+  priv->payload = priv->rcvd_payload;
 
-  do
+  if (!nw || !priv->cb->alloc_buf || len > MODS_DL_PAYLOAD_MAX_SZ)
+    return;
+
+  if (priv->owned_payload && priv->owned_payload_sz < len)
     {
-      ret = sem_wait(&priv->sem);
+      priv->cb->free_buf(priv->owned_payload);
+      priv->owned_payload = NULL;
     }
-  while (ret < 0 && errno == EINTR);
 
-  vdbg("bitmask=0x%04X\n", bitmask);
+  if (!priv->owned_payload)
+    {
+      priv->owned_payload = priv->cb->alloc_buf(len);
+      priv->owned_payload_sz = priv->owned_payload ? len : 0;
+    }
 
-  deassert_rfr_int();
+  if (priv->owned_payload)
+      priv->payload = priv->owned_payload;
+}
+
+static void payload_deliver(FAR struct mods_spi_dl_s *priv, buf_t recv)
+{
+  if (recv != dl_recv)
+      pkt_size_update(priv, priv->rcvd_payload_idx);
+
+  if (priv->payload == priv->owned_payload && priv->cb->recv_owned)
+    {
+      if (!priv->cb->recv_owned(&priv->dl, priv->payload,
+                                priv->rcvd_payload_idx))
+        {
+          /* Ownership was transferred to the network layer */
+          priv->owned_payload = NULL;
+          priv->owned_payload_sz = 0;
+        }
+    }
+  else
+    {
+      recv(&priv->dl, priv->payload, priv->rcvd_payload_idx);
+    }
+
+  priv->payload = priv->rcvd_payload;
+}
 
-  switch (bitmask & (HDR_BIT_VALID | HDR_BIT_DUMMY))
+static enum ack pkt_ack_req(const __u8 *pkt)
+{
+  const struct spi_msg_hdr *hdr = (const struct spi_msg_hdr *)pkt;
+
+  switch (le16_to_cpu(hdr->bitmask) & (HDR_BIT_VALID | HDR_BIT_DUMMY))
     {
       case HDR_BIT_VALID:
-        ack_req = ACK_NEEDED;
-        break;
+        return ACK_NEEDED;
 
       case HDR_BIT_DUMMY:
-        ack_req = ACK_NOT_NEEDED;
-        break;
+        return ACK_NOT_NEEDED;
 
       /* If valid and dummy are equal (both 0 or both 1), the packet is
        * garbage.
        */
       default:
         dbg("garbage packet\n");
-        ack_req = ACK_ERROR;
-        break;
-    }
-
-  if (ack_handler(priv, ack_req))
-    {
-      /* Reset TX consumer ring buffer entry */
-      reset_txc_rb_entry(priv);
+        return ACK_ERROR;
     }
+}
 
-  /* Clear transfer setup flag */
-  priv->xfer_setup = false;
+/*
+ * A frame is ACK'd once for all its packets. It needs an ACK if any of them
+ * is valid, and is in error if any of them is garbage.
+ */
+static enum ack frame_ack_req(FAR struct mods_spi_dl_s *priv)
+{
+  size_t slot_size = SLOT_SIZE(priv->pkt_size);
+  enum ack ack_req = ACK_NOT_NEEDED;
+  uint8_t i;
 
-  if (ack_req != ACK_NEEDED)
+  for (i = 0; i < priv->frame_pkts; i++)
     {
-      /* Received a dummy or garbage packet - no processing to do! */
-
-      /* Only change packet size if TX buffer is empty */
-      if ((priv->new_pkt_size > 0) && (priv->txp_rb == priv->txc_rb))
+      switch (pkt_ack_req(&priv->rx_buf[i * slot_size]))
         {
-          set_pkt_size(priv, priv->new_pkt_size);
-          priv->new_pkt_size = 0;
-        }
+          case ACK_ERROR:
+            return ACK_ERROR;
 
-      goto done;
+          case ACK_NEEDED:
+            ack_req = ACK_NEEDED;
+            break;
+
+          default:
+            break;
+        }
     }
 
+  return ack_req;
+}
+
+/* Caller must hold semaphore before calling this function! */
+static void rx_pkt(FAR struct mods_spi_dl_s *priv, const __u8 *pkt)
+{
+  const struct spi_msg_hdr *hdr = (const struct spi_msg_hdr *)pkt;
+  uint16_t bitmask = le16_to_cpu(hdr->bitmask);
+  size_t pl_size = PL_SIZE(priv->pkt_size);
+  buf_t recv = priv->cb->recv;
+
+  vdbg("bitmask=0x%04X\n", bitmask);
+
   if ((bitmask & HDR_BIT_TYPE) == MSG_TYPE_DL)
       recv = dl_recv;
 
@@ -715,10 +1027,14 @@ static void txn_finished_worker(FAR void *arg)
   if (MODS_DL_PAYLOAD_MAX_SZ == pl_size)
     {
       if (bitmask & HDR_BIT_PKT1)
-          recv(&priv->dl, &priv->rx_buf[HDR_SIZE], pl_size);
+        {
+          if (recv != dl_recv)
+              pkt_size_update(priv, pl_size);
+          recv(&priv->dl, &pkt[HDR_SIZE], pl_size);
+        }
       else
           dbg("1st pkt bit not set\n");
-      goto done;
+      return;
     }
 #endif
 
@@ -732,6 +1048,8 @@ static void txn_finished_worker(FAR void *arg)
         }
 
       priv->pkts_remaining = bitmask & HDR_BIT_PKTS;
+      payload_setup(priv, (bitmask & HDR_BIT_TYPE) == MSG_TYPE_NW,
+                    (priv->pkts_remaining + 1) * pl_size);
     }
   else /* not first packet of message */
     {
@@ -739,7 +1057,7 @@ static void txn_finished_worker(FAR void *arg)
       if (!priv->rcvd_payload_idx)
         {
           dbg("Ignore non-first packet\n");
-          goto done;
+          return;
         }
 
       if ((bitmask & HDR_BIT_PKTS) != --priv->pkts_remaining)
@@ -749,7 +1067,7 @@ static void txn_finished_worker(FAR void *arg)
           /* Drop the entire message */
           priv->rcvd_payload_idx = 0;
           priv->pkts_remaining = 0;
-          goto done;
+          return;
         }
     }
 
@@ -760,21 +1078,77 @@ static void txn_finished_worker(FAR void *arg)
       /* Drop the entire message */
       priv->rcvd_payload_idx = 0;
       priv->pkts_remaining = 0;
-      goto done;
+      return;
     }
 
-  memcpy(&priv->rcvd_payload[priv->rcvd_payload_idx],
-         &priv->rx_buf[HDR_SIZE], pl_size);
+  memcpy(&priv->payload[priv->rcvd_payload_idx], &pkt[HDR_SIZE], pl_size);
   priv->rcvd_payload_idx += pl_size;
 
   if (bitmask & HDR_BIT_PKTS)
     {
       /* Need additional packets */
-      goto done;
+      return;
     }
 
-  recv(&priv->dl, priv->rcvd_payload, priv->rcvd_payload_idx);
+  payload_deliver(priv, recv);
   priv->rcvd_payload_idx = 0;
+}
+
+static void txn_finished_worker(FAR void *arg)
+{
+  FAR struct mods_spi_dl_s *priv = arg;
+  size_t slot_size;
+  const __u8 *pkt;
+  enum ack ack_req;
+  uint8_t i;
+  int ret;
+
+  do
+    {
+      ret = sem_wait(&priv->sem);
+    }
+  while (ret < 0 && errno == EINTR);
+
+  deassert_rfr_int();
+
+  ack_req = frame_ack_req(priv);
+
+  if (ack_handler(priv, ack_req))
+    {
+      /* Reset TX consumer ring buffer entries */
+      reset_txc(priv);
+    }
+
+  /* Clear transfer setup flag */
+  priv->xfer_setup = false;
+
+  if (ack_req != ACK_NEEDED)
+    {
+      /* Received a dummy or garbage packet - no processing to do! */
+
+      /* Only change packet size or framing if TX buffer is empty */
+      if ((priv->new_pkt_size > 0 || priv->new_frame_pkts > 0) &&
+          (priv->txp_rb == priv->txc_rb))
+        {
+          set_pkt_size(priv,
+                       priv->new_pkt_size ? priv->new_pkt_size : priv->pkt_size,
+                       priv->new_frame_pkts ? priv->new_frame_pkts :
+                                              priv->frame_pkts);
+          priv->new_pkt_size = 0;
+          priv->new_frame_pkts = 0;
+        }
+
+      goto done;
+    }
+
+  /* Dummy packets pad the frames that are not full */
+  slot_size = SLOT_SIZE(priv->pkt_size);
+  for (i = 0; i < priv->frame_pkts; i++)
+    {
+      pkt = &priv->rx_buf[i * slot_size];
+      if (pkt_ack_req(pkt) == ACK_NEEDED)
+          rx_pkt(priv, pkt);
+    }
 
 done:
   xfer(priv);
@@ -816,8 +1190,8 @@ static void txn_error_worker(FAR void *arg)
 
   if (ack_handler(priv, ACK_ERROR))
     {
-      /* Reset TX consumer ring buffer entry */
-      reset_txc_rb_entry(priv);
+      /* Reset TX consumer ring buffer entries */
+      reset_txc(priv);
     }
 
   /* Ignore any received payload from previous packets */
@@ -929,6 +1303,8 @@ static int queue_data_nw(FAR struct mods_dl_s *dl, const void *buf, size_t len)
   if (ret)
       goto err;
 
+  pkt_size_update(priv, len);
+
   xfer(priv);
 
 err:
@@ -937,9 +1313,50 @@ err:
   return ret;
 }
 
+/* Called by network layer to build a message in place in the TX ring */
+static FAR void *reserve_nw(FAR struct mods_dl_s *dl, size_t len)
+{
+  FAR struct mods_spi_dl_s *priv = (FAR struct mods_spi_dl_s *)dl;
+  FAR void *buf = NULL;
+  int ret;
+
+  do
+    {
+      ret = sem_wait(&priv->sem);
+    }
+  while (ret < 0 && errno == EINTR);
+
+  if (priv->bstate == BASE_ATTACHED)
+      buf = reserve_txp(priv, len);
+
+  /* The semaphore is held until the message is committed */
+  if (!buf)
+      sem_post(&priv->sem);
+
+  return buf;
+}
+
+static int commit_nw(FAR struct mods_dl_s *dl, FAR void *buf, size_t len)
+{
+  FAR struct mods_spi_dl_s *priv = (FAR struct mods_spi_dl_s *)dl;
+
+  if (len > 0)
+    {
+      commit_txp(priv, MSG_TYPE_NW, len);
+      pkt_size_update(priv, len);
+      xfer(priv);
+    }
+
+  sem_post(&priv->sem);
+
+  return OK;
+}
+
 static struct mods_dl_ops_s mods_dl_ops =
 {
   .send = queue_data_nw,
+  .reserve = reserve_nw,
+  .commit = commit_nw,
 };
 
 static struct mods_spi_dl_s mods_spi_dl =
@@ -1079,6 +1496,7 @@ FAR struct mods_dl_s *mods_dl_init(struct mods_dl_cb_s *cb)
   SPI_SLAVE_REGISTERCALLBACK(spi, &cb_ops, &mods_spi_dl);
 
   mods_spi_dl.cb = cb;
+  mods_spi_dl.payload = mods_spi_dl.rcvd_payload;
   mods_spi_dl.spi = spi;
   sem_init(&mods_spi_dl.sem, 0, 0);
 
@@ -1087,7 +1505,7 @@ FAR struct mods_dl_s *mods_dl_init(struct mods_dl_cb_s *cb)
                                   work_process_thread, NULL);
   DEBUGASSERT(mods_spi_dl.pid > 0);
 
-  set_pkt_size(&mods_spi_dl, PKT_SIZE(DEFAULT_PAYLOAD_SZ));
+  set_pkt_size(&mods_spi_dl, PKT_SIZE(DEFAULT_PAYLOAD_SZ), 1);
 
   /* RDY GPIO must be initialized before the WAKE interrupt */
   mods_rfr_init();
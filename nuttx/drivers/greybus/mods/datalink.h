@@ -53,6 +53,49 @@
 
 #define MODS_DL_SEND(d,b,l) ((d)->ops->send(d,b,l))
 
+/****************************************************************************
+ * Name: MODS_DL_RESERVE
+ *
+ * Description:
+ *   Reserve room for a message of up to len bytes directly in the transmit
+ *   queue of the physical layer, so that it can be built in place instead of
+ *   being copied by MODS_DL_SEND. Optional.
+ *
+ *   On success, the data link layer is locked until MODS_DL_COMMIT is
+ *   called, so the message must be filled in without blocking.
+ *
+ * Input Parameters:
+ *   dev - Device-specific state data
+ *   len - The maximum length of the message
+ *
+ * Returned Value:
+ *   A pointer to the reserved room, or NULL if the message cannot be built
+ *   in place (the caller must fall back to MODS_DL_SEND).
+ *
+ ****************************************************************************/
+
+#define MODS_DL_RESERVE(d,l) \
+  ((d)->ops->reserve ? (d)->ops->reserve(d,l) : NULL)
+
+/****************************************************************************
+ * Name: MODS_DL_COMMIT
+ *
+ * Description:
+ *   Queue a message built with MODS_DL_RESERVE for transmission, and unlock
+ *   the data link layer. A length of zero drops the reservation.
+ *
+ * Input Parameters:
+ *   dev - Device-specific state data
+ *   buf - The pointer returned by MODS_DL_RESERVE
+ *   len - The actual length of the message
+ *
+ * Returned Value:
+ *   0 on success, negative errno on failure.
+ *
+ ****************************************************************************/
+
+#define MODS_DL_COMMIT(d,b,l) ((d)->ops->commit(d,b,l))
+
 struct mods_dl_s;
 
 typedef int (*buf_t)(FAR struct mods_dl_s *dev, FAR const void *buf, size_t len);
@@ -60,11 +103,24 @@ typedef int (*buf_t)(FAR struct mods_dl_s *dev, FAR const void *buf, size_t len)
 struct mods_dl_ops_s
 {
   buf_t send;
+  FAR void *(*reserve)(FAR struct mods_dl_s *dev, size_t len);
+  int (*commit)(FAR struct mods_dl_s *dev, FAR void *buf, size_t len);
 };
 
 struct mods_dl_cb_s
 {
   buf_t recv;
+
+  /*
+   * Optional zero-copy receive path. When provided, the data link layer
+   * reassembles network messages directly into a buffer obtained from
+   * alloc_buf() and hands it over with recv_owned(). A return value of 0
+   * means the network layer took ownership of the buffer; otherwise the
+   * data link layer still owns it and must release it with free_buf().
+   */
+  FAR void *(*alloc_buf)(size_t len);
+  void (*free_buf)(FAR void *buf);
+  int (*recv_owned)(FAR struct mods_dl_s *dev, FAR void *buf, size_t len);
 };
 
 /*
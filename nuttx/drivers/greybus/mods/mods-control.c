@@ -54,7 +54,7 @@
 
 /* Version of the Greybus control protocol we support */
 #define MB_CONTROL_VERSION_MAJOR              0x00
-#define MB_CONTROL_VERSION_MINOR              0x09
+#define MB_CONTROL_VERSION_MINOR              0x0a
 
 /* Version of the Greybus control protocol to support
  * send slave state
@@ -74,6 +74,12 @@
 #define MB_CONTROL_VERSION_TEST_MODE_MAJOR    0x00
 #define MB_CONTROL_VERSION_TEST_MODE_MINOR    0x09
 
+/* Version of the Greybus control protocol to support
+ * requesting a data link reconfiguration
+ */
+#define MB_CONTROL_VERSION_DL_RECONFIG_MAJOR  0x00
+#define MB_CONTROL_VERSION_DL_RECONFIG_MINOR  0x0a
+
 /* Greybus control request types */
 #define MB_CONTROL_TYPE_INVALID               0x00
 #define MB_CONTROL_TYPE_PROTOCOL_VERSION      0x01
@@ -92,6 +98,7 @@
 #define MB_CONTROL_TYPE_CURRENT_RSV           0x0d
 #define MB_CONTROL_TYPE_CURRENT_RSV_ACK       0x0e
 #define MB_CONTROL_TYPE_TEST_MODE             0x0f
+#define MB_CONTROL_TYPE_DL_RECONFIG           0x10
 
 /* Valid modes for the reboot request */
 #define MB_CONTROL_REBOOT_MODE_RESET          0x01
@@ -211,6 +218,11 @@ struct mb_control_test_mode_request {
     __le32  value;
 } __packed;
 
+struct mb_control_dl_reconfig_request {
+    __le16  pl_size;
+} __packed;
+/* Control protocol data link reconfig has no response */
+
 /* Keep track of changes in the clock, for potential */
 /* detection of 'jumps' in time.                     */
 static uint32_t mods_rtc_sync_cntr;
@@ -679,6 +691,43 @@ static uint8_t mb_control_current_rsv_ack(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
+/**
+ * @brief ask the base to renegotiate the data link bus configuration
+ *
+ * @param pl_size: payload size the data link would like to switch to
+ * @return 0 on success, error code on failure.
+ */
+int mb_control_send_dl_reconfig(uint16_t pl_size)
+{
+    struct mb_control_dl_reconfig_request *request;
+    struct gb_operation *operation;
+    int ret;
+
+    if (!ctrl_info)
+        return -ENODEV;
+
+    if (ctrl_info->host_major < MB_CONTROL_VERSION_DL_RECONFIG_MAJOR ||
+        (ctrl_info->host_major == MB_CONTROL_VERSION_DL_RECONFIG_MAJOR &&
+         ctrl_info->host_minor < MB_CONTROL_VERSION_DL_RECONFIG_MINOR))
+        return -EOPNOTSUPP;
+
+    operation = gb_operation_create(ctrl_info->cport,
+            MB_CONTROL_TYPE_DL_RECONFIG, sizeof(*request));
+    if (!operation)
+        return -ENOMEM;
+
+    request = gb_operation_get_request_payload(operation);
+    request->pl_size = cpu_to_le16(pl_size);
+
+    ret = gb_operation_send_request(operation, NULL, false);
+    if (ret)
+        ret = -EIO;
+
+    gb_operation_destroy(operation);
+
+    return ret;
+}
+
 static uint8_t mb_control_test_mode(struct gb_operation *operation)
 {
     struct mb_control_test_mode_request *request =
@@ -785,6 +834,8 @@ struct gb_driver mb_control_driver = {
     .exit = mb_control_exit,
     .op_handlers = (struct gb_operation_handler*) mb_control_handlers,
     .op_handlers_count = ARRAY_SIZE(mb_control_handlers),
+    /* gb_listen() follows the registration */
+    .init_group = GB_INIT_GROUP_SYNC,
 };
 
 int mods_cport_valid(int c)
@@ -51,6 +51,16 @@ struct mods_msg
 } __packed;
 
 
+/* Transport headroom, which must hold the message header */
+#define NETWORK_HEADROOM  ((sizeof(struct mods_msg_hdr) + 3) & ~0x0003)
+
+/*
+ * Offset between the start of a zero-copy RX allocation and the message
+ * header, so that the Greybus message lands right after the transport
+ * headroom as greybus_rx_handler_zero_copy() expects.
+ */
+#define RX_BUF_OFFSET     (NETWORK_HEADROOM - sizeof(struct mods_msg_hdr))
+
 /* Handle to Mods data link layer */
 static struct mods_dl_s *dl;
 
@@ -62,9 +72,38 @@ static int network_recv(FAR struct mods_dl_s *dev, const void *buf, size_t len)
                             (len - sizeof(m->hdr)));
 }
 
+static FAR void *network_alloc_rx_buf(size_t len)
+{
+  char *buf = malloc(len + RX_BUF_OFFSET);
+
+  return buf ? buf + RX_BUF_OFFSET : NULL;
+}
+
+static void network_free_rx_buf(FAR void *buf)
+{
+  free((char *)buf - RX_BUF_OFFSET);
+}
+
+static int network_recv_owned(FAR struct mods_dl_s *dev, FAR void *buf,
+                              size_t len)
+{
+  struct mods_msg *m = (struct mods_msg *)buf;
+
+  if (len < sizeof(m->hdr))
+    {
+      return -EINVAL;
+    }
+
+  return greybus_rx_handler_zero_copy(le16_to_cpu(m->hdr.cport), m->gb_msg,
+                                      (len - sizeof(m->hdr)));
+}
+
 struct mods_dl_cb_s mods_dl_cb =
 {
   .recv = network_recv,
+  .alloc_buf = network_alloc_rx_buf,
+  .free_buf = network_free_rx_buf,
+  .recv_owned = network_recv_owned,
 };
 
 static void network_init(void)
@@ -74,9 +113,19 @@ static void network_init(void)
 
 static int network_send(unsigned int cport, const void *buf, size_t len)
 {
-  struct mods_msg *m =
-    (struct mods_msg *)((char *)buf - sizeof(struct mods_msg_hdr));
+  struct mods_msg *m;
+
+  /* Build the message straight in the data link TX queue if it fits */
+  m = MODS_DL_RESERVE(dl, len + sizeof(struct mods_msg_hdr));
+  if (m)
+    {
+      m->hdr.cport = cpu_to_le16(cport);
+      memcpy(m->gb_msg, buf, len);
+
+      return MODS_DL_COMMIT(dl, m, len + sizeof(struct mods_msg_hdr));
+    }
 
+  m = (struct mods_msg *)((char *)buf - sizeof(struct mods_msg_hdr));
   m->hdr.cport = cpu_to_le16(cport);
 
   return MODS_DL_SEND(dl, m, len + sizeof(struct mods_msg_hdr));
@@ -96,7 +145,7 @@ static int network_stop_listening(unsigned int cport)
 
 const static struct gb_transport_backend mods_network =
 {
-  .headroom = (sizeof(struct mods_msg_hdr) + 3) & ~0x0003,
+  .headroom = NETWORK_HEADROOM,
   .init = network_init,
   .send = network_send,
   .listen = network_listen,
@@ -29,6 +29,7 @@
 #include <stddef.h>
 #include <string.h>
 #include <errno.h>
+#include <unistd.h>
 #include <arch/atomic.h>
 #include <nuttx/clock.h>
 #include <nuttx/lib.h>
@@ -57,8 +58,7 @@
 #define ACCEL_MAX_RANGE     1024 * 16
 #define ACCEL_MIN_DELAY     4000
 #define ACCEL_MAX_DELAY     1000000
-#define ACCEL_FIFO_REC      0
-#define ACCEL_FIFO_MEC      0
+#define ACCEL_FIFO_DEPTH    32
 #define ACCEL_FLAGS        SENSOR_EXT_FLAG_CONTINUOUS_MODE
 #define REPORTING_SENSORS   1
 
@@ -69,6 +69,8 @@ struct sensor_accel_info {
     sensors_ext_event_callback callback;
     uint8_t sensor_id;
     int latency_ms;
+    uint32_t period_us;
+    uint8_t watermark;      /* Simulated FIFO threshold, 1 without batching */
     pthread_t tx_thread;
     pthread_mutex_t run_mutex;
     bool should_run;
@@ -83,24 +85,49 @@ struct sensor_event_data {
     uint32_t    data_value[ACCEL_CHANNEL_SIZE];
 } __packed;
 
-#ifdef BATCH_PROCESS_ENABLED
-#define ACCEL_READING_NUM 2
-#else
-#define ACCEL_READING_NUM 1
-#endif
+#define ACCEL_READING_NUM ACCEL_FIFO_DEPTH
 #define TX_PROCESSING_DELAY     1 /* processing and tx delay (mS)*/
 
 static int data = 1000;
 static atomic_t txn;       /* Flag to indicate reporting in progress */
 
+/*
+ * Model a sensor with a hardware FIFO: the samples of the last watermark
+ * periods come out together, the reference time is the one of the oldest.
+ */
+static uint16_t sensor_accel_fill_report(struct sensor_accel_info *info,
+                                         struct report_info *rinfo,
+                                         uint16_t readings)
+{
+    struct sensor_event_data *event_data;
+    struct timespec ts;
+    uint16_t i;
+
+    event_data = (struct sensor_event_data *)&rinfo->data_payload[0];
+
+    up_rtc_gettime(&ts);
+    rinfo->reference_time = timespec_to_nsec(&ts) -
+        (uint64_t)(readings - 1) * info->period_us * NSEC_PER_USEC;
+    rinfo->readings = readings;
+
+    for (i = 0; i < readings; i++) {
+        /* time_delta is the distance to the previous event in uS */
+        event_data[i].time_delta = i ? MIN(info->period_us, UINT16_MAX) : 0;
+        event_data[i].data_value[0] = data++;
+        event_data[i].data_value[1] = data++;
+        event_data[i].data_value[2] = data++;
+    }
+
+    return readings;
+}
+
 static void *sensor_tx_thread(void *arg)
 {
     struct sensor_accel_info *info;
     struct report_info *rinfo;
     struct report_info_data *rinfo_data;
-    struct sensor_event_data *event_data;
-    struct timespec ts;
     uint16_t payload_size;
+    uint16_t readings;
 
     info = arg;
     payload_size = (ACCEL_READING_NUM * sizeof(struct sensor_event_data))
@@ -118,31 +145,22 @@ static void *sensor_tx_thread(void *arg)
             rinfo = rinfo_data->reportinfo;
             rinfo->id = info->sensor_id;
             rinfo->flags = 0;
-            event_data = (struct sensor_event_data *)&rinfo->data_payload[0];
-
-            up_rtc_gettime(&ts);
-            rinfo->reference_time = timespec_to_nsec(&ts);
-#ifdef BATCH_PROCESS_ENABLED
-            /*
-             * Batch sensor data values and its time_deltas
-             * until max fifo event count
-            */
-#else
-            /* Single sensor event data */
-            rinfo->readings = ACCEL_READING_NUM;
-            event_data->time_delta = 0;
-            event_data->data_value[0] = data++;
-            event_data->data_value[1] = data++;
-            event_data->data_value[2] = data++;
-#endif
-            gb_debug("report sensor: %d\n", rinfo->id);
-            info->callback(info->sensor_id, rinfo_data, payload_size);
+
+            readings = sensor_accel_fill_report(info, rinfo, info->watermark);
+            gb_debug("report sensor: %d (%d)\n", rinfo->id, readings);
+            info->callback(info->sensor_id, rinfo_data,
+                           (readings * sizeof(struct sensor_event_data)) +
+                           (REPORTING_SENSORS * sizeof(struct report_info)));
         }
 
         if (!info->should_run)
             break;
 
-        up_mdelay(info->latency_ms);
+        /* One wakeup per watermark, as the FIFO interrupt would do */
+        if (info->watermark > 1)
+            usleep(info->watermark * info->period_us);
+        else
+            up_mdelay(info->latency_ms);
     }
 
     free(rinfo_data);
@@ -168,18 +186,8 @@ static int sensor_accel_op_get_sensor_info(struct device *dev,
     sinfo->resolution = 1;
     sinfo->min_delay = ACCEL_MIN_DELAY;
     sinfo->max_delay = ACCEL_MAX_DELAY;
-#ifdef BATCH_PROCESS_ENABLED
-    /*
-     * Example to calculate number of sensor events that can be batched in the
-     * payload. Each event consists of time_delta and sensor data fields.
-     * Reading size provides the number of sensor data fields reported.
-    */
-    sinfo->fifo_rec = ACCEL_READING_NUM;
-    sinfo->fifo_mec = sinfo->fifo_rec;
-#else
-    sinfo->fifo_rec = ACCEL_FIFO_REC;
-    sinfo->fifo_mec = ACCEL_FIFO_MEC;
-#endif
+    sinfo->fifo_rec = ACCEL_FIFO_DEPTH;
+    sinfo->fifo_mec = ACCEL_FIFO_DEPTH;
     sinfo->flags = ACCEL_FLAGS;
     sinfo->scale_int = ACCEL_SCALE_INT;
     sinfo->scale_nano = ACCEL_SCALE_NANO;
@@ -213,6 +221,14 @@ static int sensor_accel_op_start_reporting(struct device *dev,
     if (info->latency_ms > TX_PROCESSING_DELAY) {
         info->latency_ms -= TX_PROCESSING_DELAY;
     }
+
+    info->period_us = MAX(sampling_period / NSEC_PER_USEC, 1);
+    info->watermark = 0;
+    if (sampling_period)
+        info->watermark = MIN(max_report_latency / sampling_period,
+                              ACCEL_FIFO_DEPTH);
+    if (!info->watermark)
+        info->watermark = 1;
     data = 1000;
     info->should_run = true;
 
@@ -232,12 +248,11 @@ static int sensor_accel_op_start_reporting(struct device *dev,
 
 static int sensor_accel_op_flush(struct device *dev, uint8_t id)
 {
-    struct sensor_event_data *event_data;
     struct sensor_accel_info *info;
     struct report_info_data *rinfo_data;
     struct report_info *rinfo;
-    struct timespec ts;
     uint16_t payload_size;
+    uint16_t readings;
 
     payload_size = (ACCEL_READING_NUM * sizeof(struct sensor_event_data))
                     + (REPORTING_SENSORS * sizeof(struct report_info));
@@ -250,33 +265,19 @@ static int sensor_accel_op_flush(struct device *dev, uint8_t id)
     info = device_get_private(dev);
 
     if (info->callback) {
-        rinfo_data = malloc(sizeof(struct report_info) + payload_size);
+        rinfo_data = malloc(sizeof(struct report_info_data) + payload_size);
         if (!rinfo_data)
             return -ENOMEM;
 
         rinfo_data->num_sensors_reporting = REPORTING_SENSORS;
         rinfo = rinfo_data->reportinfo;
         rinfo->id = info->sensor_id;
-        event_data = (struct sensor_event_data *)&rinfo->data_payload[0];
-
-        up_rtc_gettime(&ts);
-        rinfo->reference_time = timespec_to_nsec(&ts);
-        gb_debug("[%u.%03u]\n", ts.tv_sec, (ts.tv_nsec / 1000000));
         rinfo->flags = REPORT_INFO_FLAG_FLUSHING | REPORT_INFO_FLAG_FLUSH_COMPLETE;
-#ifdef BATCH_PROCESS_ENABLED
-        /*
-         * Batch sensor data values and its time_deltas
-         * until max fifo event count
-        */
-#else
-        /* Single sensor event data */
-        rinfo->readings = ACCEL_READING_NUM;
-        event_data->time_delta = 0;
-        event_data->data_value[0] = data++;
-        event_data->data_value[1] = data++;
-        event_data->data_value[2] = data++;
-#endif
-        info->callback(info->sensor_id, rinfo_data, payload_size);
+
+        readings = sensor_accel_fill_report(info, rinfo, 1);
+        info->callback(info->sensor_id, rinfo_data,
+                       (readings * sizeof(struct sensor_event_data)) +
+                       (REPORTING_SENSORS * sizeof(struct report_info)));
 
         free(rinfo_data);
     }
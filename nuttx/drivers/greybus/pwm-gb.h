@@ -39,6 +39,7 @@
 #define GB_PWM_PROTOCOL_POLARITY        0x06
 #define GB_PWM_PROTOCOL_ENABLE          0x07
 #define GB_PWM_PROTOCOL_DISABLE         0x08
+#define GB_PWM_PROTOCOL_CONFIG_MULTI    0x09
 
 struct gb_pwm_version_request {
     /** Offered PWM Protocol major version. */
@@ -121,5 +122,30 @@ struct gb_pwm_disable_request {
     __u8    which;
 };
 
+/**
+ * One generator setting of a config multi request.
+ */
+struct gb_pwm_config_entry {
+    /** Controller-relative PWM generator number */
+    __u8    which;
+
+    /** Active time (in nanoseconds). */
+    __le32  duty __packed;
+
+    /** Period (in nanoseconds). */
+    __le32  period __packed;
+};
+
+/**
+ * Config multi response has no payload.
+ */
+struct gb_pwm_config_multi_request {
+    /** Number of entries that follow. */
+    __u8    count;
+
+    /** New settings, applied together at the next period boundary. */
+    struct gb_pwm_config_entry config[0];
+};
+
 #endif /* _GREYBUS_PWM_H_ */
 
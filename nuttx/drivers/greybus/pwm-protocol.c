@@ -31,6 +31,7 @@
 #include <string.h>
 #include <errno.h>
 
+#include <nuttx/arch.h>
 #include <nuttx/device.h>
 #include <nuttx/device_pwm.h>
 #include <nuttx/greybus/greybus.h>
@@ -45,7 +46,7 @@
  * report major version 0, minor version 1.
  */
 #define GB_PWM_VERSION_MAJOR 0
-#define GB_PWM_VERSION_MINOR 1
+#define GB_PWM_VERSION_MINOR 2
 
 struct gb_pwm_info {
     /** assigned CPort number */
@@ -255,6 +256,11 @@ static uint8_t gb_pwm_protocol_config(struct gb_operation *operation)
         return GB_OP_INVALID;
     }
 
+    /* the PWM device ops take a semaphore */
+    if (up_interrupt_context()) {
+        return GB_OP_RX_DEFER;
+    }
+
     duty = le32_to_cpu(request->duty);
     period = le32_to_cpu(request->period);
     ret = device_pwm_request_config(pwm_info->dev, request->which, duty,
@@ -267,6 +273,76 @@ static uint8_t gb_pwm_protocol_config(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
+/**
+ * @brief Configure several generators with one request.
+ *
+ * This function will parse the gb_pwm_config_multi_request to get the new
+ * duty and period of each listed generator, and then calls PWM controller
+ * driver to apply all of them together at the next period boundary. This
+ * saves a round trip per channel and avoids glitches between channels that
+ * are meant to change at the same time, like the components of an RGB LED.
+ *
+ * @param operation Pointer to structure of gb_operation.
+ *
+ * @return GB_OP_SUCCESS on success, error code on failure.
+ */
+static uint8_t gb_pwm_protocol_config_multi(struct gb_operation *operation)
+{
+    struct gb_pwm_config_multi_request *request;
+    struct pwm_config_entry *entries;
+    size_t size;
+    int ret;
+    int i;
+
+    size = gb_operation_get_request_payload_size(operation);
+    if (size < sizeof(*request)) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    if (!pwm_info || !pwm_info->dev) {
+        return GB_OP_UNKNOWN_ERROR;
+    }
+
+    request = gb_operation_get_request_payload(operation);
+
+    if (!request->count || request->count > pwm_info->num_pwms ||
+        size < sizeof(*request) + request->count * sizeof(request->config[0])) {
+        return GB_OP_INVALID;
+    }
+
+    /* the PWM device ops take a semaphore */
+    if (up_interrupt_context()) {
+        return GB_OP_RX_DEFER;
+    }
+
+    entries = malloc(request->count * sizeof(*entries));
+    if (!entries) {
+        return GB_OP_NO_MEMORY;
+    }
+
+    for (i = 0; i < request->count; i++) {
+        if (request->config[i].which >= pwm_info->num_pwms) {
+            free(entries);
+            return GB_OP_INVALID;
+        }
+
+        entries[i].which = request->config[i].which;
+        entries[i].duty = le32_to_cpu(request->config[i].duty);
+        entries[i].period = le32_to_cpu(request->config[i].period);
+    }
+
+    ret = device_pwm_request_config_multi(pwm_info->dev, entries,
+                                          request->count);
+    free(entries);
+    if (ret) {
+        gb_info("%s(): %x error in ops\n", __func__, ret);
+        return ret == -EINVAL ? GB_OP_INVALID : GB_OP_UNKNOWN_ERROR;
+    }
+
+    return GB_OP_SUCCESS;
+}
+
 /**
  * @brief Configure specific generator for a particular polarity.
  *
@@ -339,6 +415,10 @@ static uint8_t gb_pwm_protocol_enable(struct gb_operation *operation)
         return GB_OP_INVALID;
     }
 
+    if (up_interrupt_context()) {
+        return GB_OP_RX_DEFER;
+    }
+
     ret = device_pwm_request_enable(pwm_info->dev, request->which);
     if (ret) {
         gb_info("%s(): error %x in ops return\n", __func__, ret);
@@ -379,6 +459,10 @@ static uint8_t gb_pwm_protocol_disable(struct gb_operation *operation)
         return GB_OP_INVALID;
     }
 
+    if (up_interrupt_context()) {
+        return GB_OP_RX_DEFER;
+    }
+
     ret = device_pwm_request_disable(pwm_info->dev, request->which);
     if (ret) {
         gb_info("%s(): %x error in ops\n", __func__, ret);
@@ -449,10 +533,11 @@ static struct gb_operation_handler gb_pwm_handlers[] = {
     GB_HANDLER(GB_PWM_PROTOCOL_COUNT, gb_pwm_protocol_count),
     GB_HANDLER(GB_PWM_PROTOCOL_ACTIVATE, gb_pwm_protocol_activate),
     GB_HANDLER(GB_PWM_PROTOCOL_DEACTIVATE, gb_pwm_protocol_deactivate),
-    GB_HANDLER(GB_PWM_PROTOCOL_CONFIG, gb_pwm_protocol_config),
+    GB_RX_HANDLER(GB_PWM_PROTOCOL_CONFIG, gb_pwm_protocol_config),
     GB_HANDLER(GB_PWM_PROTOCOL_POLARITY, gb_pwm_protocol_polarity),
-    GB_HANDLER(GB_PWM_PROTOCOL_ENABLE, gb_pwm_protocol_enable),
-    GB_HANDLER(GB_PWM_PROTOCOL_DISABLE, gb_pwm_protocol_disable),
+    GB_RX_HANDLER(GB_PWM_PROTOCOL_ENABLE, gb_pwm_protocol_enable),
+    GB_RX_HANDLER(GB_PWM_PROTOCOL_DISABLE, gb_pwm_protocol_disable),
+    GB_RX_HANDLER(GB_PWM_PROTOCOL_CONFIG_MULTI, gb_pwm_protocol_config_multi),
 };
 
 
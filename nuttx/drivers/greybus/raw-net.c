@@ -0,0 +1,620 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Network interface tunnelled over a Greybus Raw CPort.
+ *
+ * Each GB_RAW_TYPE_SEND message carries a batch of link layer frames
+ * instead of a single one.  The raw payload is a sequence of records, each
+ * a 4-byte header followed by the frame, padded to a multiple of 4 bytes:
+ *
+ *   | size (le16) | reserved (le16) | frame[size] | pad |
+ *
+ * All frames produced by one pass of the network stack (a TX poll, or the
+ * replies to one received batch) are packed into the same message, up to
+ * CONFIG_GREYBUS_RAW_NET_MSGSIZE bytes.
+ */
+
+#include <nuttx/config.h>
+
+#include <errno.h>
+#include <debug.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <arch/byteorder.h>
+
+#include <nuttx/wdog.h>
+#include <nuttx/wqueue.h>
+#include <nuttx/net/net.h>
+#include <nuttx/net/arp.h>
+#include <nuttx/net/netdev.h>
+#include <nuttx/greybus/greybus.h>
+
+#include <apps/greybus-utils/utils.h>
+
+/* Greybus RAW operation types */
+#define GB_RAW_TYPE_PROTOCOL_VERSION   0x01
+#define GB_RAW_TYPE_SEND               0x02
+
+#define GB_RAW_VERSION_MAJOR              0
+#define GB_RAW_VERSION_MINOR              1
+
+/* TX poll every second, the TCP timers run in half seconds */
+#define GB_RAW_NET_WDDELAY      (1 * CLK_TCK)
+#define GB_RAW_NET_POLLHSEC     (1 * 2)
+
+#define GB_RAW_NET_ALIGN(x)     (((x) + 3) & ~3)
+
+#if CONFIG_GREYBUS_RAW_NET_MSGSIZE > 0
+# define GB_RAW_NET_MSGSIZE     CONFIG_GREYBUS_RAW_NET_MSGSIZE
+#else
+# define GB_RAW_NET_MSGSIZE     (GB_MAX_PAYLOAD_SIZE - \
+                                 sizeof(struct gb_raw_send_request))
+#endif
+
+#ifdef CONFIG_NET_ETHERNET
+# define ETHBUF(p) ((struct eth_hdr_s *)(p)->dev.d_buf)
+#endif
+
+/**
+ * Greybus Raw Protocol Version Response
+ */
+struct gb_raw_proto_version_response {
+    __u8 major; /**< Greybus Raw Protocol major version */
+    __u8 minor; /**< Greybus Raw Protocol minor version */
+};
+
+/**
+ * Greybus Raw Protocol Send Request
+ */
+struct gb_raw_send_request {
+    __le32  len;
+    __u8    data[0];
+};
+
+/**
+ * One frame in the payload of a Send Request
+ */
+struct gb_raw_net_record {
+    __le16  size;
+    __le16  reserved;
+    __u8    data[0];
+};
+
+struct gb_raw_net_info {
+    /** assigned CPort number */
+    unsigned int cport;
+    /** true once the interface has been brought up */
+    bool bifup;
+    /** periodic TX poll timer */
+    WDOG_ID txpoll;
+    /** deferred TX poll, greybus messages cannot be sent from interrupts */
+    struct work_s txwork;
+    /** batch being filled, NULL if none */
+    struct gb_operation *txop;
+    /** bytes of records in txop */
+    size_t txlen;
+    /** packet buffer used by the network stack */
+#ifdef CONFIG_NET_MULTIBUFFER
+    uint8_t pktbuf[CONFIG_NET_BUFSIZE + CONFIG_NET_GUARDSIZE];
+#endif
+    /** interface understood by the network stack */
+    struct net_driver_s dev;
+};
+
+static struct gb_raw_net_info *raw_net_info;
+
+static void gb_raw_net_polltimer(int argc, uint32_t arg, ...);
+
+/**
+ * @brief Detach the batch being filled, if any
+ *
+ * Must be called with the network locked.  The returned operation is ready
+ * to be passed to gb_raw_net_send().
+ *
+ * @param info Driver state.
+ * @return the operation holding the batch, or NULL if it is empty
+ */
+static struct gb_operation *gb_raw_net_detach(struct gb_raw_net_info *info)
+{
+    struct gb_operation *operation = info->txop;
+    struct gb_operation_hdr *hdr;
+    struct gb_raw_send_request *request;
+
+    if (!operation)
+        return NULL;
+
+    /* Trim the message to the records actually queued */
+    request = gb_operation_get_request_payload(operation);
+    request->len = cpu_to_le32(info->txlen);
+
+    hdr = operation->request_buffer;
+    hdr->size = cpu_to_le16(sizeof(*hdr) + sizeof(*request) + info->txlen);
+
+    info->txop = NULL;
+    info->txlen = 0;
+
+    return operation;
+}
+
+/**
+ * @brief Send a batch detached by gb_raw_net_detach()
+ *
+ * Called without the network lock: the transport may block.
+ *
+ * @param operation The batch, may be NULL.
+ */
+static void gb_raw_net_send(struct gb_operation *operation)
+{
+    int ret;
+
+    if (!operation)
+        return;
+
+    ret = gb_operation_send_request(operation, NULL, false);
+    if (ret)
+        gb_error("failed to send batch: %d\n", ret);
+
+    gb_operation_destroy(operation);
+}
+
+/**
+ * @brief Append the frame in d_buf to the batch being filled
+ *
+ * Must be called with the network locked.  If the frame does not fit,
+ * the full batch is returned through @a full and a new one is started.
+ *
+ * @param info Driver state.
+ * @param full Set to a batch that must be sent with gb_raw_net_send().
+ * @return 0 on success, a negative errno if the frame was dropped
+ */
+static int gb_raw_net_queue(struct gb_raw_net_info *info,
+                            struct gb_operation **full)
+{
+    struct gb_raw_send_request *request;
+    struct gb_raw_net_record *record;
+    size_t reclen = GB_RAW_NET_ALIGN(sizeof(*record) + info->dev.d_len);
+
+    if (reclen > GB_RAW_NET_MSGSIZE) {
+        gb_error("dropping frame of %u bytes\n", info->dev.d_len);
+        info->dev.d_len = 0;
+        return -EMSGSIZE;
+    }
+
+    if (info->txop && info->txlen + reclen > GB_RAW_NET_MSGSIZE) {
+        *full = gb_raw_net_detach(info);
+    }
+
+    if (!info->txop) {
+        info->txop = gb_operation_create(info->cport, GB_RAW_TYPE_SEND,
+                                         sizeof(*request) +
+                                         GB_RAW_NET_MSGSIZE);
+        if (!info->txop) {
+            gb_error("dropping frame: out of memory\n");
+            info->dev.d_len = 0;
+            return -ENOMEM;
+        }
+        info->txlen = 0;
+    }
+
+    request = gb_operation_get_request_payload(info->txop);
+    record = (struct gb_raw_net_record *)(request->data + info->txlen);
+    record->size = cpu_to_le16(info->dev.d_len);
+    record->reserved = 0;
+    memcpy(record->data, info->dev.d_buf, info->dev.d_len);
+
+    info->txlen += reclen;
+    info->dev.d_len = 0;
+
+    return 0;
+}
+
+/**
+ * @brief Queue a frame produced by the network stack
+ *
+ * Resolves the link layer address when needed, then adds the frame to the
+ * batch.  A batch that was filled up in the process is sent right away,
+ * which only happens for a poll producing more than one message worth of
+ * frames.
+ *
+ * @param info Driver state.
+ * @param ll true if d_buf already holds a complete link layer frame.
+ */
+static void gb_raw_net_output(struct gb_raw_net_info *info, bool ll)
+{
+    struct gb_operation *full = NULL;
+
+    if (info->dev.d_len == 0)
+        return;
+
+    if (!ll)
+        arp_out(&info->dev);
+
+    (void)gb_raw_net_queue(info, &full);
+
+    if (full) {
+        /* Rare: the network stays locked while this message goes out */
+        gb_raw_net_send(full);
+    }
+}
+
+/**
+ * @brief devif_poll() and devif_timer() callback
+ */
+static int gb_raw_net_txpoll(struct net_driver_s *dev)
+{
+    struct gb_raw_net_info *info = dev->d_private;
+
+    gb_raw_net_output(info, false);
+
+    /* Continue with the next connection */
+    return 0;
+}
+
+/**
+ * @brief Poll the network stack for TX data and send it as one batch
+ *
+ * @param arg Driver state.
+ */
+static void gb_raw_net_txwork(FAR void *arg)
+{
+    struct gb_raw_net_info *info = arg;
+    struct gb_operation *operation;
+    net_lock_t flags;
+
+    flags = net_lock();
+    if (info->bifup)
+        (void)devif_poll(&info->dev, gb_raw_net_txpoll);
+    operation = gb_raw_net_detach(info);
+    net_unlock(flags);
+
+    gb_raw_net_send(operation);
+}
+
+/**
+ * @brief Periodic timer work: run the TCP timers and send the result
+ *
+ * @param arg Driver state.
+ */
+static void gb_raw_net_timerwork(FAR void *arg)
+{
+    struct gb_raw_net_info *info = arg;
+    struct gb_operation *operation;
+    net_lock_t flags;
+
+    flags = net_lock();
+    if (info->bifup)
+        (void)devif_timer(&info->dev, gb_raw_net_txpoll, GB_RAW_NET_POLLHSEC);
+    operation = gb_raw_net_detach(info);
+    net_unlock(flags);
+
+    gb_raw_net_send(operation);
+
+    (void)wd_start(info->txpoll, GB_RAW_NET_WDDELAY,
+                   gb_raw_net_polltimer, 1, (uint32_t)info);
+}
+
+/**
+ * @brief TX poll timer expiration, runs in interrupt context
+ */
+static void gb_raw_net_polltimer(int argc, uint32_t arg, ...)
+{
+    struct gb_raw_net_info *info = (struct gb_raw_net_info *)arg;
+
+    /* Share the work structure with TX notifications: a pending TX poll
+     * will do, the timers run again on the next expiration.
+     */
+    if (work_available(&info->txwork))
+        (void)work_queue(LPWORK, &info->txwork, gb_raw_net_timerwork,
+                         info, 0);
+    else
+        (void)wd_start(info->txpoll, GB_RAW_NET_WDDELAY,
+                       gb_raw_net_polltimer, 1, arg);
+}
+
+/**
+ * @brief Hand one received frame to the network stack
+ *
+ * Must be called with the network locked.  Frames generated in reply are
+ * added to the current batch.
+ *
+ * @param info Driver state.
+ * @param data Frame data.
+ * @param len Frame length.
+ */
+static void gb_raw_net_input(struct gb_raw_net_info *info,
+                             const uint8_t *data, size_t len)
+{
+    memcpy(info->dev.d_buf, data, len);
+    info->dev.d_len = len;
+
+#ifdef CONFIG_NET_ETHERNET
+# ifdef CONFIG_NET_IPv6
+    if (ETHBUF(info)->type == HTONS(ETHTYPE_IP6)) {
+# else
+    if (ETHBUF(info)->type == HTONS(ETHTYPE_IP)) {
+# endif
+        arp_ipin(&info->dev);
+        devif_input(&info->dev);
+        gb_raw_net_output(info, false);
+    } else if (ETHBUF(info)->type == HTONS(ETHTYPE_ARP)) {
+        arp_arpin(&info->dev);
+        gb_raw_net_output(info, true);
+    }
+#else
+    devif_input(&info->dev);
+    gb_raw_net_output(info, false);
+#endif
+}
+
+/**
+ * @brief Get this firmware supported Raw protocol version.
+ *
+ * @param operation Pointer to structure of gb_operation.
+ * @return GB_OP_SUCCESS on success, error code on failure
+ */
+static uint8_t gb_raw_net_protocol_version(struct gb_operation *operation)
+{
+    struct gb_raw_proto_version_response *response;
+
+    response = gb_operation_alloc_response(operation, sizeof(*response));
+    if (!response) {
+        return GB_OP_NO_MEMORY;
+    }
+
+    response->major = GB_RAW_VERSION_MAJOR;
+    response->minor = GB_RAW_VERSION_MINOR;
+
+    return GB_OP_SUCCESS;
+}
+
+/**
+ * @brief Called on receive of a batch of frames
+ *
+ * @param operation Pointer to structure of gb_operation
+ * @return GB_OP_SUCCESS on success, error code on failure
+ */
+static uint8_t gb_raw_net_protocol_recv(struct gb_operation *operation)
+{
+    struct gb_raw_net_info *info = raw_net_info;
+    struct gb_raw_send_request *request;
+    struct gb_raw_net_record *record;
+    struct gb_operation *reply;
+    size_t payload_size;
+    size_t offset;
+    size_t len;
+    net_lock_t flags;
+
+    request = gb_operation_get_request_payload(operation);
+    payload_size = gb_operation_get_request_payload_size(operation);
+
+    if (payload_size < sizeof(*request)) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    len = le32_to_cpu(request->len);
+    if (len > payload_size - sizeof(*request)) {
+        gb_error("dropping truncated message\n");
+        return GB_OP_INVALID;
+    }
+
+    flags = net_lock();
+
+    for (offset = 0; offset + sizeof(*record) <= len; ) {
+        size_t size;
+
+        record = (struct gb_raw_net_record *)(request->data + offset);
+        size = le16_to_cpu(record->size);
+
+        if (offset + sizeof(*record) + size > len) {
+            gb_error("dropping truncated frame\n");
+            break;
+        }
+
+        if (!info->bifup || size > CONFIG_NET_BUFSIZE) {
+            gb_debug("dropping frame of %u bytes\n", (unsigned int)size);
+        } else {
+            gb_raw_net_input(info, record->data, size);
+        }
+
+        offset += GB_RAW_NET_ALIGN(sizeof(*record) + size);
+    }
+
+    /* Replies to the whole batch go out together */
+    reply = gb_raw_net_detach(info);
+    net_unlock(flags);
+
+    gb_raw_net_send(reply);
+
+    return GB_OP_SUCCESS;
+}
+
+/**
+ * @brief Interface up callback
+ */
+static int gb_raw_net_ifup(struct net_driver_s *dev)
+{
+    struct gb_raw_net_info *info = dev->d_private;
+
+    info->bifup = true;
+    (void)wd_start(info->txpoll, GB_RAW_NET_WDDELAY,
+                   gb_raw_net_polltimer, 1, (uint32_t)info);
+
+    return OK;
+}
+
+/**
+ * @brief Interface down callback
+ */
+static int gb_raw_net_ifdown(struct net_driver_s *dev)
+{
+    struct gb_raw_net_info *info = dev->d_private;
+    irqstate_t flags;
+
+    flags = irqsave();
+    wd_cancel(info->txpoll);
+    info->bifup = false;
+    irqrestore(flags);
+
+    return OK;
+}
+
+/**
+ * @brief New TX data callback, may be called from interrupt context
+ */
+static int gb_raw_net_txavail(struct net_driver_s *dev)
+{
+    struct gb_raw_net_info *info = dev->d_private;
+    irqstate_t flags;
+
+    /* Several notifications before the work runs result in a single poll,
+     * and so in a single message.
+     */
+    flags = irqsave();
+    if (info->bifup && work_available(&info->txwork))
+        (void)work_queue(LPWORK, &info->txwork, gb_raw_net_txwork, info, 0);
+    irqrestore(flags);
+
+    return OK;
+}
+
+/**
+ * @brief called on initialization of raw network interface
+ *
+ * @param cport our cport used for greybus operations
+ */
+static int gb_raw_net_init(unsigned int cport)
+{
+    struct gb_raw_net_info *info;
+    int ret;
+
+    info = zalloc(sizeof(*info));
+    if (!info)
+        return -ENOMEM;
+
+    info->cport = cport;
+    info->txpoll = wd_create();
+    if (!info->txpoll) {
+        ret = -ENOMEM;
+        goto err_free;
+    }
+
+#ifdef CONFIG_NET_MULTIBUFFER
+    info->dev.d_buf = info->pktbuf;
+#endif
+    info->dev.d_ifup = gb_raw_net_ifup;
+    info->dev.d_ifdown = gb_raw_net_ifdown;
+    info->dev.d_txavail = gb_raw_net_txavail;
+    info->dev.d_private = info;
+
+#ifdef CONFIG_NET_ETHERNET
+    /* Locally administered address, unique per CPort */
+    info->dev.d_mac.ether_addr_octet[0] = 0x02;
+    info->dev.d_mac.ether_addr_octet[1] = 'g';
+    info->dev.d_mac.ether_addr_octet[2] = 'b';
+    info->dev.d_mac.ether_addr_octet[4] = (cport >> 8) & 0xff;
+    info->dev.d_mac.ether_addr_octet[5] = cport & 0xff;
+#endif
+
+    raw_net_info = info;
+
+    ret = netdev_register(&info->dev);
+    if (ret) {
+        gb_error("failed to register network device: %d\n", ret);
+        goto err_delete;
+    }
+
+    return 0;
+
+err_delete:
+    raw_net_info = NULL;
+    wd_delete(info->txpoll);
+err_free:
+    free(info);
+    return ret;
+}
+
+/**
+ * @brief called on teardown of raw network interface
+ *
+ * @param cport our cport used for greybus operations
+ */
+static void gb_raw_net_exit(unsigned int cport)
+{
+    struct gb_raw_net_info *info = raw_net_info;
+    struct gb_operation *operation;
+    net_lock_t flags;
+
+    if (!info)
+        return;
+
+    gb_raw_net_ifdown(&info->dev);
+    (void)work_cancel(LPWORK, &info->txwork);
+    (void)netdev_unregister(&info->dev);
+
+    flags = net_lock();
+    operation = info->txop;
+    info->txop = NULL;
+    net_unlock(flags);
+
+    if (operation)
+        gb_operation_destroy(operation);
+
+    wd_delete(info->txpoll);
+    free(info);
+    raw_net_info = NULL;
+}
+
+/**
+ * @brief Greybus Raw network protocol operation handler
+ */
+static struct gb_operation_handler gb_raw_net_handlers[] = {
+    GB_HANDLER(GB_RAW_TYPE_PROTOCOL_VERSION, gb_raw_net_protocol_version),
+    GB_HANDLER(GB_RAW_TYPE_SEND, gb_raw_net_protocol_recv),
+};
+
+static struct gb_driver gb_raw_net_driver = {
+    .init = gb_raw_net_init,
+    .exit = gb_raw_net_exit,
+    .op_handlers = gb_raw_net_handlers,
+    .op_handlers_count = ARRAY_SIZE(gb_raw_net_handlers),
+    .rx_priority = GB_RX_PRIORITY_HIGH,
+    .tx_class = GB_TX_CLASS_BULK,
+};
+
+/**
+ * @brief Register Greybus Raw network protocol
+ *
+ * @param cport CPort number
+ */
+void gb_raw_net_register(int cport)
+{
+    gb_register_driver(cport, &gb_raw_net_driver);
+}
@@ -31,6 +31,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <queue.h>
+#include <semaphore.h>
 
 #include <arch/byteorder.h>
 
@@ -43,6 +44,7 @@
 /* Greybus RAW operation types */
 #define GB_RAW_TYPE_PROTOCOL_VERSION   0x01
 #define GB_RAW_TYPE_SEND               0x02
+#define GB_RAW_TYPE_SEND_FRAGMENT      0x03
 
 #define GB_RAW_VERSION_MAJOR              0
 #define GB_RAW_VERSION_MINOR              1
@@ -63,11 +65,46 @@ struct gb_raw_send_request {
         __u8    data[0];
 };
 
+/**
+ * Greybus Raw Protocol Send Fragment Request
+ */
+struct gb_raw_send_fragment_request {
+        __le32  total_len;  /**< Length of the whole message */
+        __le32  offset;     /**< Offset of the fragment in the message */
+        __le32  len;        /**< Length of the fragment */
+        __u8    data[0];
+};
+
+#ifdef CONFIG_GREYBUS_RAW_FRAGMENT
+#if CONFIG_GREYBUS_RAW_FRAGMENT_SIZE > 0
+#define GB_RAW_FRAGMENT_SIZE    CONFIG_GREYBUS_RAW_FRAGMENT_SIZE
+#else
+#define GB_RAW_FRAGMENT_SIZE    (GB_MAX_PAYLOAD_SIZE - \
+                                 sizeof(struct gb_raw_send_fragment_request))
+#endif
+
+/* Messages up to this size still go out in a single send request */
+#define GB_RAW_SEND_MAX         (GB_MAX_PAYLOAD_SIZE - \
+                                 sizeof(struct gb_raw_send_request))
+#endif
+
 struct gb_raw_info {
     /** opened device driver handler */
     struct device *dev;
     /** assigned CPort number */
     unsigned int cport;
+#ifdef CONFIG_GREYBUS_RAW_FRAGMENT
+    /** serializes the fragmented messages */
+    sem_t tx_lock;
+    /** free slots in the transmit window */
+    sem_t tx_window;
+    /** first error reported by a fragment response */
+    volatile uint8_t tx_error;
+    /** message being reassembled */
+    uint8_t *rx_buf;
+    uint32_t rx_len;
+    uint32_t rx_received;
+#endif
 };
 
 static struct gb_raw_info *raw_info;
@@ -131,6 +168,98 @@ static uint8_t gb_raw_protocol_send(uint32_t len, uint8_t data[])
     return ret;
 }
 
+#ifdef CONFIG_GREYBUS_RAW_FRAGMENT
+static void gb_raw_fragment_callback(struct gb_operation *operation)
+{
+    uint8_t result = gb_operation_get_request_result(operation);
+
+    if (result != GB_OP_SUCCESS && raw_info->tx_error == GB_OP_SUCCESS) {
+        raw_info->tx_error = result;
+    }
+
+    sem_post(&raw_info->tx_window);
+}
+
+/**
+ * @brief Send a message too large for a single greybus message
+ *
+ * Up to CONFIG_GREYBUS_RAW_FRAGMENT_WINDOW fragments are sent before
+ * waiting for the response of the oldest one, and the function returns
+ * once every fragment has been acknowledged.
+ *
+ * @param len length of data field
+ * @param data data to send
+ * @return GB_OP_SUCCESS on success, error code on failure
+ */
+static uint8_t gb_raw_protocol_send_fragments(uint32_t len, uint8_t data[])
+{
+    struct gb_raw_send_fragment_request *request;
+    struct gb_operation *operation;
+    uint32_t offset;
+    uint32_t size;
+    uint8_t ret = GB_OP_SUCCESS;
+    int i;
+
+    while (sem_wait(&raw_info->tx_lock) != OK);
+
+    raw_info->tx_error = GB_OP_SUCCESS;
+
+    for (offset = 0; offset < len; offset += size) {
+        size = MIN(len - offset, GB_RAW_FRAGMENT_SIZE);
+
+        while (sem_wait(&raw_info->tx_window) != OK);
+
+        if (raw_info->tx_error != GB_OP_SUCCESS) {
+            sem_post(&raw_info->tx_window);
+            break;
+        }
+
+        operation = gb_operation_create(raw_info->cport,
+                                        GB_RAW_TYPE_SEND_FRAGMENT,
+                                        sizeof(*request) + size);
+        if (!operation) {
+            sem_post(&raw_info->tx_window);
+            ret = GB_OP_NO_MEMORY;
+            break;
+        }
+
+        request = gb_operation_get_request_payload(operation);
+        request->total_len = cpu_to_le32(len);
+        request->offset = cpu_to_le32(offset);
+        request->len = cpu_to_le32(size);
+        memcpy(request->data, &data[offset], size);
+
+        if (gb_operation_send_request(operation, gb_raw_fragment_callback,
+                                      true)) {
+            sem_post(&raw_info->tx_window);
+            ret = GB_OP_UNKNOWN_ERROR;
+        }
+
+        gb_operation_destroy(operation);
+
+        if (ret != GB_OP_SUCCESS) {
+            break;
+        }
+    }
+
+    /* wait for the fragments in flight */
+    for (i = 0; i < CONFIG_GREYBUS_RAW_FRAGMENT_WINDOW; i++) {
+        while (sem_wait(&raw_info->tx_window) != OK);
+    }
+    for (i = 0; i < CONFIG_GREYBUS_RAW_FRAGMENT_WINDOW; i++) {
+        sem_post(&raw_info->tx_window);
+    }
+
+    if (ret == GB_OP_SUCCESS) {
+        ret = raw_info->tx_error;
+    }
+
+    sem_post(&raw_info->tx_lock);
+
+    return ret;
+}
+#endif
+
 /**
  * @brief Callback for data sending
  *
@@ -141,6 +270,12 @@ static uint8_t gb_raw_protocol_send(uint32_t len, uint8_t data[])
 static int raw_callback_routine(struct device *dev,
                                 uint32_t len, uint8_t data[])
 {
+#ifdef CONFIG_GREYBUS_RAW_FRAGMENT
+    if (len > GB_RAW_SEND_MAX) {
+        return (int) gb_raw_protocol_send_fragments(len, data);
+    }
+#endif
+
     return (int) gb_raw_protocol_send(len, data);
 }
 
@@ -172,6 +307,87 @@ static uint8_t gb_raw_protocol_recv(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
+#ifdef CONFIG_GREYBUS_RAW_FRAGMENT
+static void gb_raw_reassembly_reset(void)
+{
+    free(raw_info->rx_buf);
+    raw_info->rx_buf = NULL;
+    raw_info->rx_len = 0;
+    raw_info->rx_received = 0;
+}
+
+/**
+ * @brief Called on receive of a message fragment
+ *
+ * Fragments of a message must arrive in order. The message is passed to the
+ * device once its last fragment is received.
+ *
+ * @param operation Pointer to structure of gb_operation
+ * @return GB_OP_SUCCESS on success, error code on failure
+ */
+static uint8_t gb_raw_protocol_recv_fragment(struct gb_operation *operation)
+{
+    struct gb_raw_send_fragment_request *request;
+    uint32_t total_len;
+    uint32_t offset;
+    uint32_t len;
+    int ret;
+
+    request = gb_operation_get_request_payload(operation);
+
+    if (gb_operation_get_request_payload_size(operation) < sizeof(*request)) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    total_len = le32_to_cpu(request->total_len);
+    offset = le32_to_cpu(request->offset);
+    len = le32_to_cpu(request->len);
+
+    if (gb_operation_get_request_payload_size(operation) <
+        sizeof(*request) + len) {
+        gb_error("dropping short fragment\n");
+        return GB_OP_INVALID;
+    }
+
+    if (offset == 0) {
+        gb_raw_reassembly_reset();
+
+        if (total_len > CONFIG_GREYBUS_RAW_FRAGMENT_MAX) {
+            return GB_OP_OVERFLOW;
+        }
+
+        raw_info->rx_buf = malloc(total_len);
+        if (!raw_info->rx_buf) {
+            return GB_OP_NO_MEMORY;
+        }
+        raw_info->rx_len = total_len;
+    }
+
+    if (!raw_info->rx_buf || total_len != raw_info->rx_len ||
+        offset != raw_info->rx_received || len > total_len - offset) {
+        gb_error("dropping out of sequence fragment\n");
+        gb_raw_reassembly_reset();
+        return GB_OP_INVALID;
+    }
+
+    memcpy(&raw_info->rx_buf[offset], request->data, len);
+    raw_info->rx_received += len;
+
+    if (raw_info->rx_received < raw_info->rx_len) {
+        return GB_OP_SUCCESS;
+    }
+
+    ret = device_raw_recv(raw_info->dev, raw_info->rx_len, raw_info->rx_buf);
+    gb_raw_reassembly_reset();
+    if (ret) {
+        return GB_OP_UNKNOWN_ERROR;
+    }
+
+    return GB_OP_SUCCESS;
+}
+#endif
+
 /**
  * @brief called on initialization of raw interface
  *
@@ -189,6 +405,11 @@ static int gb_raw_init(unsigned int cport)
 
     raw_info->cport = cport;
 
+#ifdef CONFIG_GREYBUS_RAW_FRAGMENT
+    sem_init(&raw_info->tx_lock, 0, 1);
+    sem_init(&raw_info->tx_window, 0, CONFIG_GREYBUS_RAW_FRAGMENT_WINDOW);
+#endif
+
     raw_info->dev = device_open(DEVICE_TYPE_RAW_HW, 0);
     if (!raw_info->dev) {
         gb_info("failed to open %s device!\n", DEVICE_TYPE_RAW_HW);
@@ -210,6 +431,10 @@ static int gb_raw_init(unsigned int cport)
 err_close:
     device_close(raw_info->dev);
 err_free:
+#ifdef CONFIG_GREYBUS_RAW_FRAGMENT
+    sem_destroy(&raw_info->tx_window);
+    sem_destroy(&raw_info->tx_lock);
+#endif
     free(raw_info);
 err_out:
     return ret;
@@ -225,6 +450,11 @@ static void gb_raw_exit(unsigned int cport)
     if (raw_info) {
         device_raw_unregister_callback(raw_info->dev);
         device_close(raw_info->dev);
+#ifdef CONFIG_GREYBUS_RAW_FRAGMENT
+        gb_raw_reassembly_reset();
+        sem_destroy(&raw_info->tx_window);
+        sem_destroy(&raw_info->tx_lock);
+#endif
         free(raw_info);
         raw_info = NULL;
     }
@@ -236,6 +466,9 @@ static void gb_raw_exit(unsigned int cport)
 static struct gb_operation_handler gb_raw_handlers[] = {
     GB_HANDLER(GB_RAW_TYPE_PROTOCOL_VERSION, gb_raw_protocol_version),
     GB_HANDLER(GB_RAW_TYPE_SEND, gb_raw_protocol_recv),
+#ifdef CONFIG_GREYBUS_RAW_FRAGMENT
+    GB_HANDLER(GB_RAW_TYPE_SEND_FRAGMENT, gb_raw_protocol_recv_fragment),
+#endif
 };
 
 static struct gb_driver gb_raw_driver = {
@@ -243,6 +476,7 @@ static struct gb_driver gb_raw_driver = {
     .exit = gb_raw_exit,
     .op_handlers = gb_raw_handlers,
     .op_handlers_count = ARRAY_SIZE(gb_raw_handlers),
+    .rx_priority = GB_RX_PRIORITY_HIGH,
 };
 
 /**
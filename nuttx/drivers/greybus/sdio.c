@@ -145,6 +145,8 @@ static uint8_t gb_sdio_protocol_get_capabilities(struct gb_operation *operation)
     struct gb_sdio_get_capabilities_response *response;
     struct sdio_cap cap;
     uint16_t max_data_size;
+    uint16_t max_blk_size;
+    uint16_t blksz;
     int ret;
 
     ret = device_sdio_get_capabilities(info->dev, &cap);
@@ -160,20 +162,28 @@ static uint8_t gb_sdio_protocol_get_capabilities(struct gb_operation *operation)
     /*
      * The host Greybus uses max_blk_count * max_blk_size to request data,
      * we must restrict the size under max protocol response package size.
+     * Pick the block length that moves the most data per operation: three
+     * 512 byte blocks fit where only one 1024 byte block would.
      */
     max_data_size = GB_MAX_PAYLOAD_SIZE -
                     sizeof(struct gb_sdio_transfer_response);
-    max_data_size = scale_max_sd_block_length(max_data_size);
-    if (!max_data_size) {
+    max_blk_size = cap.max_blk_size < max_data_size ? cap.max_blk_size :
+                                                       max_data_size;
+    max_blk_size = scale_max_sd_block_length(max_blk_size);
+    if (!max_blk_size) {
         return GB_OP_INVALID;
     }
-    if (cap.max_blk_count * cap.max_blk_size > max_data_size ) {
-        if (cap.max_blk_size > max_data_size) {
-            cap.max_blk_size = max_data_size;
-        } else {
-            cap.max_blk_count = max_data_size / cap.max_blk_size;
+    for (blksz = MAX_BLOCK_SIZE_0; blksz < max_blk_size; blksz <<= 1) {
+        if ((max_data_size / blksz) * blksz >
+            (max_data_size / max_blk_size) * max_blk_size) {
+            max_blk_size = blksz;
+            break;
         }
     }
+    cap.max_blk_size = max_blk_size;
+    if (cap.max_blk_count * cap.max_blk_size > max_data_size) {
+        cap.max_blk_count = max_data_size / cap.max_blk_size;
+    }
 
     response->caps = cpu_to_le32(cap.caps);
     response->ocr = cpu_to_le32(cap.ocr);
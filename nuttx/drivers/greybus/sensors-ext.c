@@ -40,18 +40,57 @@
 #include <nuttx/list.h>
 #include <nuttx/util.h>
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+#include <semaphore.h>
+#include <nuttx/clock.h>
+#include <nuttx/wdog.h>
+#include <nuttx/wqueue.h>
+#endif
+
 #include "sensors-ext-gb.h"
 
 #define GB_SENSORS_EXT_VERSION_MAJOR 0
 #define GB_SENSORS_EXT_VERSION_MINOR 2
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+#define BATCH_SIZE      CONFIG_GREYBUS_SENSORS_EXT_BATCH_SIZE
+#define BATCH_THRESHOLD CONFIG_GREYBUS_SENSORS_EXT_BATCH_THRESHOLD
+
+#if BATCH_THRESHOLD > BATCH_SIZE
+#  error "GREYBUS_SENSORS_EXT_BATCH_THRESHOLD larger than the batch buffer"
+#endif
+
+#define BATCH_MAX_LATENCY_MSEC  (60 * 1000)
+#endif
 
 struct gb_sensors_ext_info {
     struct list_head node;
     struct device *dev;
     uint8_t sensor_id;
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+    /* max report latency requested by the host, 0 when not batching */
+    uint32_t latency;
+#endif
 };
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+/*
+ * Reports pending transmission, stored back to back as they will be laid
+ * out in the event request payload.
+ */
+struct gb_sensors_ext_batch {
+    sem_t lock;
+    WDOG_ID wdog;
+    struct work_s work;
+    uint32_t deadline;
+    uint16_t len;
+    uint8_t num_sensors_reporting;
+    uint8_t buf[BATCH_SIZE];
+};
+
+static struct gb_sensors_ext_batch s_batch;
+#endif
+
 static unsigned int sensors_ext_cport;
 static struct list_head s_device_list;
 
@@ -69,8 +108,8 @@ static struct gb_sensors_ext_info *get_dev_from_id(uint8_t sensor_id)
     return NULL;
 }
 
-static int event_callback(uint8_t se_id, struct report_info_data *rinfo_data,
-                            uint16_t payload_size)
+static int send_event(uint8_t num_sensors_reporting, const void *reports,
+                      uint16_t payload_size)
 {
     struct gb_operation *operation;
     struct gb_sensors_ext_report_data *request;
@@ -84,10 +123,9 @@ static int event_callback(uint8_t se_id, struct report_info_data *rinfo_data,
 
     request = gb_operation_get_request_payload(operation);
 
-    request->num_sensors_reporting = rinfo_data->num_sensors_reporting;
+    request->num_sensors_reporting = num_sensors_reporting;
 
-    memcpy((void *)&request->event_report[0],
-            (void *)&rinfo_data->reportinfo[0], payload_size);
+    memcpy((void *)&request->event_report[0], reports, payload_size);
 
     gb_operation_send_request(operation, NULL, false);
     gb_operation_destroy(operation);
@@ -95,6 +133,142 @@ static int event_callback(uint8_t se_id, struct report_info_data *rinfo_data,
     return 0;
 }
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+static void batch_lock(void)
+{
+    while (sem_wait(&s_batch.lock) != OK) {
+        DEBUGASSERT(get_errno() == EINTR);
+    }
+}
+
+static void batch_unlock(void)
+{
+    sem_post(&s_batch.lock);
+}
+
+/* Must be called with the batch locked */
+static void batch_discard(void)
+{
+    wd_cancel(s_batch.wdog);
+    s_batch.len = 0;
+    s_batch.num_sensors_reporting = 0;
+}
+
+/* Must be called with the batch locked */
+static int batch_send(void)
+{
+    int ret;
+
+    if (!s_batch.len)
+        return 0;
+
+    ret = send_event(s_batch.num_sensors_reporting, s_batch.buf,
+                     s_batch.len);
+    if (ret)
+        gb_error("%s: dropping %u batched reports\n", __func__,
+                 s_batch.num_sensors_reporting);
+
+    batch_discard();
+    return ret;
+}
+
+static void batch_worker(void *arg)
+{
+    batch_lock();
+    batch_send();
+    batch_unlock();
+}
+
+/* Latency deadline expiration, runs in interrupt context */
+static void batch_timeout(int argc, uint32_t arg, ...)
+{
+    if (work_available(&s_batch.work))
+        work_queue(LPWORK, &s_batch.work, batch_worker, NULL, 0);
+}
+
+/* Convert the max report latency requested by the host into ticks */
+static uint32_t batch_latency(uint64_t max_report_latency)
+{
+    uint64_t msec = max_report_latency / NSEC_PER_MSEC;
+
+    /* keep the deadlines comparable across timer wraparounds */
+    if (msec > BATCH_MAX_LATENCY_MSEC)
+        msec = BATCH_MAX_LATENCY_MSEC;
+
+    return MSEC2TICK((uint32_t)msec);
+}
+
+static void batch_flush(void)
+{
+    batch_lock();
+    batch_send();
+    batch_unlock();
+}
+
+static int batch_add(struct gb_sensors_ext_info *se_info,
+                     struct report_info_data *rinfo_data,
+                     uint16_t payload_size)
+{
+    struct report_info *rinfo = &rinfo_data->reportinfo[0];
+    uint32_t now;
+    int32_t remaining;
+    int ret = 0;
+
+    batch_lock();
+
+    /*
+     * Flush reports must reach the host right after the data preceding
+     * them, sensors without a latency budget are never held back.
+     */
+    if (!se_info || !se_info->latency ||
+        (rinfo->flags & REPORT_INFO_FLAG_FLUSHING) ||
+        payload_size > BATCH_SIZE) {
+        batch_send();
+        ret = send_event(rinfo_data->num_sensors_reporting, rinfo,
+                         payload_size);
+        goto out;
+    }
+
+    if (s_batch.len + payload_size > BATCH_SIZE ||
+        s_batch.num_sensors_reporting + rinfo_data->num_sensors_reporting >
+            UINT8_MAX) {
+        batch_send();
+    }
+
+    memcpy(&s_batch.buf[s_batch.len], rinfo, payload_size);
+    s_batch.len += payload_size;
+    s_batch.num_sensors_reporting += rinfo_data->num_sensors_reporting;
+
+    if (s_batch.len >= BATCH_THRESHOLD) {
+        ret = batch_send();
+        goto out;
+    }
+
+    /* The earliest deadline of all the buffered reports wins */
+    now = clock_systimer();
+    remaining = (int32_t)(s_batch.deadline - now);
+    if (s_batch.len == payload_size || (int32_t)se_info->latency < remaining) {
+        s_batch.deadline = now + se_info->latency;
+        wd_start(s_batch.wdog, se_info->latency, (wdentry_t)batch_timeout, 0);
+    }
+
+out:
+    batch_unlock();
+    return ret;
+}
+#endif
+
+static int event_callback(uint8_t se_id, struct report_info_data *rinfo_data,
+                            uint16_t payload_size)
+{
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+    return batch_add(get_dev_from_id(se_id), rinfo_data, payload_size);
+#else
+    return send_event(rinfo_data->num_sensors_reporting,
+                      &rinfo_data->reportinfo[0], payload_size);
+#endif
+}
+
 
 static uint8_t gb_sensors_ext_protocol_version(struct gb_operation *operation)
 {
@@ -236,9 +410,16 @@ static uint8_t gb_sensors_ext_start_reporting(struct gb_operation *operation)
         return GB_OP_INVALID;
     }
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+    se_info->latency = batch_latency(request->max_report_latency);
+#endif
+
     ret = device_sensors_ext_start_reporting(se_info->dev, request->id,
                     request->sampling_period, request->max_report_latency);
     if (ret) {
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+        se_info->latency = 0;
+#endif
         return gb_errno_to_op_result(ret);
     }
 
@@ -265,6 +446,10 @@ static uint8_t gb_sensors_ext_flush(struct gb_operation *operation)
         return GB_OP_INVALID;
     }
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+    batch_flush();
+#endif
+
     ret = device_sensors_ext_flush(se_info->dev, request->id);
     if (ret) {
         return gb_errno_to_op_result(ret);
@@ -299,6 +484,12 @@ static uint8_t gb_sensors_ext_stop_reporting(struct gb_operation *operation)
         return gb_errno_to_op_result(ret);
     }
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+    /* don't hold the last reports of the sensor back any longer */
+    se_info->latency = 0;
+    batch_flush();
+#endif
+
     return GB_OP_SUCCESS;
 }
 
@@ -311,7 +502,17 @@ static void gb_sensors_ext_disconnected(unsigned int cport)
     list_foreach(&s_device_list, iter) {
         se_info = list_entry(iter, struct gb_sensors_ext_info, node);
         device_sensors_ext_stop_reporting(se_info->dev, se_info->sensor_id);
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+        se_info->latency = 0;
+#endif
     }
+
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+    /* nobody is listening anymore */
+    batch_lock();
+    batch_discard();
+    batch_unlock();
+#endif
 }
 
 static int gb_sensors_ext_init(unsigned int cport)
@@ -325,6 +526,16 @@ static int gb_sensors_ext_init(unsigned int cport)
 
     sensors_ext_cport = cport;
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+    s_batch.wdog = wd_create();
+    if (!s_batch.wdog)
+        return -ENOMEM;
+
+    sem_init(&s_batch.lock, 0, 1);
+    s_batch.len = 0;
+    s_batch.num_sensors_reporting = 0;
+#endif
+
     i = 0;
     do {
         se_info = zalloc(sizeof(*se_info));
@@ -374,6 +585,11 @@ err_close:
         se_info = NULL;
     }
 err_out:
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+    sem_destroy(&s_batch.lock);
+    wd_delete(s_batch.wdog);
+    s_batch.wdog = NULL;
+#endif
     return ret;
 }
 
@@ -390,6 +606,13 @@ static void gb_sensors_ext_exit(unsigned int cport)
         free(se_info);
         se_info = NULL;
     }
+
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_BATCH
+    wd_delete(s_batch.wdog);
+    s_batch.wdog = NULL;
+    work_cancel(LPWORK, &s_batch.work);
+    sem_destroy(&s_batch.lock);
+#endif
 }
 
 static struct gb_operation_handler gb_sensors_ext_handlers[] = {
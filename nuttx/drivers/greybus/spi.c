@@ -30,13 +30,22 @@
 #include <debug.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <nuttx/device.h>
 #include <nuttx/device_spi.h>
 #include <nuttx/greybus/greybus.h>
 #include <nuttx/greybus/debug.h>
+#include <nuttx/greybus/spi.h>
 #include <apps/greybus-utils/utils.h>
 
+#ifdef CONFIG_GREYBUS_SPI_STATS
+#include <sys/time.h>
+#include <nuttx/clock.h>
+#include <nuttx/time.h>
+#include <nuttx/util.h>
+#endif
+
 #include <arch/byteorder.h>
 
 #include "spi-gb.h"
@@ -46,6 +55,21 @@
 
 static struct device *spi_dev = NULL;
 
+/**
+ * Bus configuration last applied, the SPI device being owned by greybus
+ * once opened or handed over with gb_spi_set_dev().
+ */
+static struct {
+    bool valid;
+    uint8_t mode;
+    uint8_t bits_per_word;
+    uint32_t speed_hz;
+} spi_config;
+
+#ifdef CONFIG_GREYBUS_SPI_STATS
+static struct gb_spi_statistics spi_stats;
+#endif
+
 /**
  * @brief Returns the major and minor Greybus SPI protocol version number
  *        supported by the SPI master
@@ -177,25 +201,170 @@ static uint8_t gb_spi_protocol_num_chipselect(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
+/**
+ * @brief Apply a bus configuration, skipping what is already set
+ *
+ * Must be called with the SPI bus locked.
+ *
+ * @param mode Greybus SPI protocol mode
+ * @param bits_per_word number of bits per word
+ * @param speed_hz SPI clock requested
+ * @return 0 on success, negative errno on error
+ */
+static int gb_spi_configure(uint8_t mode, uint8_t bits_per_word,
+                            uint32_t speed_hz)
+{
+    uint32_t freq = speed_hz;
+    int ret;
+
+    if (!spi_config.valid || spi_config.mode != mode) {
+        ret = device_spi_setmode(spi_dev, mode);
+        if (ret) {
+            goto err_invalidate;
+        }
+    }
+
+    if (!spi_config.valid || spi_config.bits_per_word != bits_per_word) {
+        ret = device_spi_setbits(spi_dev, bits_per_word);
+        if (ret) {
+            goto err_invalidate;
+        }
+    }
+
+    /* cache what was asked for, the driver rounds the frequency */
+    if (!spi_config.valid || spi_config.speed_hz != speed_hz) {
+        ret = device_spi_setfrequency(spi_dev, &freq);
+        if (ret) {
+            goto err_invalidate;
+        }
+    }
+
+    spi_config.mode = mode;
+    spi_config.bits_per_word = bits_per_word;
+    spi_config.speed_hz = speed_hz;
+    spi_config.valid = true;
+    return 0;
+
+err_invalidate:
+    spi_config.valid = false;
+    return ret;
+}
+
+#ifdef CONFIG_GREYBUS_SPI_STATS
+/**
+ * @brief Account for a transfer request
+ *
+ * @param start time the request processing started at
+ * @param transfers number of transfer descriptors in the request
+ * @param exchanges number of bus exchanges done for the request
+ * @param size number of bytes exchanged
+ * @param error errno of the request, 0 on success
+ */
+static void gb_spi_update_stats(const struct timespec *start, int transfers,
+                                unsigned exchanges, uint32_t size, int error)
+{
+    struct gb_spi_statistics *stats = &spi_stats;
+    struct timespec now;
+    struct timespec elapsed;
+    useconds_t total;
+    unsigned tps;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    timespecsub(&now, start, &elapsed);
+    total = timespec_to_usec(&elapsed);
+    if (!total) {
+        total = 1;
+    }
+
+    stats->reqs++;
+    stats->transfers += transfers;
+    stats->exchanges += exchanges;
+    if (error) {
+        stats->reqs_err++;
+        return;
+    }
+
+    tps = (uint64_t)size * USEC_PER_SEC / total;
+
+#define UPDATE_AVG(avg, new)                                            \
+    do {                                                                \
+        if ((avg) == 0)                                                 \
+            (avg) = (new);                                              \
+        else                                                            \
+            (avg) = DIV_ROUND_CLOSEST((avg) + (new), 2);                \
+    } while (0)
+
+#define UPDATE_MIN(min, new)                                            \
+    do {                                                                \
+        if ((min) == 0 || (new) < (min))                                \
+            (min) = (new);                                              \
+    } while (0)
+
+#define UPDATE_MAX(max, new)                                            \
+    do {                                                                \
+        if ((new) > (max))                                              \
+            (max) = (new);                                              \
+    } while (0)
+
+    UPDATE_AVG(stats->latency_avg, total);
+    UPDATE_AVG(stats->throughput_avg, tps);
+    UPDATE_MIN(stats->latency_min, total);
+    UPDATE_MIN(stats->throughput_min, tps);
+    UPDATE_MAX(stats->latency_max, total);
+    UPDATE_MAX(stats->throughput_max, tps);
+
+#undef UPDATE_AVG
+#undef UPDATE_MIN
+#undef UPDATE_MAX
+}
+
+/**
+ * @brief Get the SPI transfer statistics
+ *
+ * @param stats pointer to the statistics container
+ * @return 0 on success
+ */
+int gb_spi_get_stats(struct gb_spi_statistics *stats)
+{
+    memcpy(stats, &spi_stats, sizeof(*stats));
+    return 0;
+}
+
+/**
+ * @brief Reset the SPI transfer statistics
+ */
+void gb_spi_reset_stats(void)
+{
+    memset(&spi_stats, 0, sizeof(spi_stats));
+}
+#endif
+
 /**
  * @brief Performs a SPI transaction as one or more SPI transfers, defined
  *        in the supplied array.
  *
+ * Consecutive transfers sharing the same bus configuration, with no delay
+ * nor chip-select change in between, are issued as a single exchange.
+ *
  * @param operation pointer to structure of Greybus operation message
  * @return GB_OP_SUCCESS on success, error code on failure
  */
 static uint8_t gb_spi_protocol_transfer(struct gb_operation *operation)
 {
-    int i, op_count;
+    int i, first, op_count;
     uint32_t size = 0;
+    uint32_t len;
     int ret = 0, errcode = GB_OP_SUCCESS;
     uint8_t *write_data;
     uint8_t *read_buf;
-    uint32_t freq = 0;
     bool selected = false;
     struct device_spi_transfer transfer;
     size_t request_size = gb_operation_get_request_payload_size(operation);
     size_t expected_size;
+    unsigned exchanges = 0;
+#ifdef CONFIG_GREYBUS_SPI_STATS
+    struct timespec start;
+#endif
 
     struct gb_spi_transfer_desc *desc;
     struct gb_spi_transfer_request *request;
@@ -227,31 +396,43 @@ static uint8_t gb_spi_protocol_transfer(struct gb_operation *operation)
     }
     read_buf = response->data;
 
+#ifdef CONFIG_GREYBUS_SPI_STATS
+    clock_gettime(CLOCK_MONOTONIC, &start);
+#endif
+
     /* lock SPI bus */
     ret = device_spi_lock(spi_dev);
     if (ret) {
-        return (ret == -EINVAL)? GB_OP_INVALID : GB_OP_UNKNOWN_ERROR;
-    }
-
-    /* set SPI mode */
-    ret = device_spi_setmode(spi_dev, request->mode);
-    if (ret) {
-        goto spi_err;
+        errcode = ret;
+        goto spi_stats;
     }
 
     /* parse all transfer request from AP host side */
-    for (i = 0; i < op_count; i++) {
+    for (i = 0; i < op_count; i = first + 1) {
         desc = &request->transfers[i];
-        freq = le32_to_cpu(desc->speed_hz);
-
-        /* set SPI bits-per-word */
-        ret = device_spi_setbits(spi_dev, desc->bits_per_word);
-        if (ret) {
-            goto spi_err;
+        len = le32_to_cpu(desc->len);
+
+        /*
+         * Chain the following transfers into a single exchange as long as
+         * the bus configuration doesn't change, nothing has to happen in
+         * between, and the data follows in the request and the response.
+         */
+        for (first = i; first + 1 < op_count; first++) {
+            struct gb_spi_transfer_desc *next = &request->transfers[first + 1];
+
+            if (le16_to_cpu(request->transfers[first].delay_usecs) ||
+                request->transfers[first].cs_change ||
+                next->speed_hz != desc->speed_hz ||
+                next->bits_per_word != desc->bits_per_word) {
+                break;
+            }
+            len += le32_to_cpu(next->len);
         }
+        desc = &request->transfers[first];
 
-        /* set SPI clock */
-        ret = device_spi_setfrequency(spi_dev, &freq);
+        /* set SPI mode, bits-per-word and clock */
+        ret = gb_spi_configure(request->mode, desc->bits_per_word,
+                               le32_to_cpu(desc->speed_hz));
         if (ret) {
             goto spi_err;
         }
@@ -269,7 +450,7 @@ static uint8_t gb_spi_protocol_transfer(struct gb_operation *operation)
         memset(&transfer, 0, sizeof(struct device_spi_transfer));
         transfer.txbuffer = write_data;
         transfer.rxbuffer = read_buf;
-        transfer.nwords = le32_to_cpu(desc->len);
+        transfer.nwords = len;
         transfer.flags = SPI_FLAG_DMA_TRNSFER; // synchronous & DMA transfer
 
         /* start SPI transfer */
@@ -277,9 +458,11 @@ static uint8_t gb_spi_protocol_transfer(struct gb_operation *operation)
         if (ret) {
             goto spi_err;
         }
+        exchanges++;
+
         /* move to next gb_spi_transfer data buffer */
-        write_data += le32_to_cpu(desc->len);
-        read_buf += le32_to_cpu(desc->len);
+        write_data += len;
+        read_buf += len;
 
         if (le16_to_cpu(desc->delay_usecs) > 0) {
             usleep(le16_to_cpu(desc->delay_usecs));
@@ -313,6 +496,11 @@ spi_err:
         errcode = ret;
     }
 
+spi_stats:
+#ifdef CONFIG_GREYBUS_SPI_STATS
+    gb_spi_update_stats(&start, op_count, exchanges, size, errcode);
+#endif
+
     if (errcode) {
         /* get error code */
         errcode = (errcode == -EINVAL)? GB_OP_INVALID : GB_OP_UNKNOWN_ERROR;
@@ -348,6 +536,7 @@ static void gb_spi_exit(unsigned int cport)
         device_close(spi_dev);
         spi_dev = NULL;
     }
+    spi_config.valid = false;
 }
 
 /**
@@ -391,6 +580,7 @@ int gb_spi_set_dev(struct device *dev)
         spi_dev = dev;
     else
         return -EBUSY;
+    spi_config.valid = false;
     return 0;
 }
 
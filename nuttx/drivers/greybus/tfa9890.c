@@ -56,6 +56,21 @@
                     TFA9890_STATUS_VDDS | \
                     TFA9890_STATUS_ARFS )
 
+/*
+ * Control registers I2S_CTRL..SYSTEM_CTRL_2 only change when written by us,
+ * so they are shadowed: reads come from the shadow and writes of an
+ * unchanged value are skipped.  Status, MTP and DSP access registers are
+ * always accessed on the bus.
+ */
+#define TFA9890_SHADOW_FIRST    TFA9890_REG_I2S_CTRL
+#define TFA9890_SHADOW_LAST     TFA9890_REG_SYSTEM_CTRL_2
+#define TFA9890_SHADOW_NREGS    (TFA9890_SHADOW_LAST - TFA9890_SHADOW_FIRST + 1)
+#define TFA9890_IS_SHADOWED(reg) ((reg) >= TFA9890_SHADOW_FIRST && \
+                                  (reg) <= TFA9890_SHADOW_LAST)
+
+/* max consecutive registers sent in one auto-increment write */
+#define TFA9890_BURST_MAX_REGS  16
+
 struct tfa9890_dev_s {
     struct audio_lowerhalf_s dev;
     bool is_dsp_cfg_done;
@@ -67,7 +82,10 @@ struct tfa9890_dev_s {
     int type;
     int32_t sys_vol_db;
     int preset_update_pending;
+    const uint8_t *loaded_preset;
     sem_t preset_lock;
+    uint16_t shadow[TFA9890_SHADOW_NREGS];
+    uint16_t shadow_valid;
 };
 
 static int tfa9890_reg_read(FAR struct tfa9890_dev_s *priv, uint8_t reg);
@@ -134,11 +152,47 @@ static void tfa9890_dump_regs(FAR struct tfa9890_dev_s *priv)
 }
 #endif
 
+static int tfa9890_shadow_get(FAR struct tfa9890_dev_s *priv, uint8_t reg)
+{
+    int idx;
+
+    if (!TFA9890_IS_SHADOWED(reg))
+        return -ENOENT;
+
+    idx = reg - TFA9890_SHADOW_FIRST;
+    if (!(priv->shadow_valid & (1 << idx)))
+        return -ENOENT;
+
+    return priv->shadow[idx];
+}
+
+static void tfa9890_shadow_set(FAR struct tfa9890_dev_s *priv, uint8_t reg,
+                uint16_t val)
+{
+    int idx;
+
+    if (!TFA9890_IS_SHADOWED(reg))
+        return;
+
+    idx = reg - TFA9890_SHADOW_FIRST;
+    priv->shadow[idx] = val;
+    priv->shadow_valid |= (1 << idx);
+}
+
+static void tfa9890_shadow_invalidate(FAR struct tfa9890_dev_s *priv)
+{
+    priv->shadow_valid = 0;
+}
+
 int tfa9890_reg_read(FAR struct tfa9890_dev_s *priv, uint8_t reg)
 {
      uint8_t reg_val[2];
      int ret;
 
+     ret = tfa9890_shadow_get(priv, reg);
+     if (ret >= 0)
+         return ret;
+
      I2C_SETADDRESS(priv->i2c, priv->i2c_addr, 7);
 
      ret = I2C_WRITEREAD(priv->i2c, (uint8_t *)&reg, sizeof(reg),
@@ -151,12 +205,17 @@ int tfa9890_reg_read(FAR struct tfa9890_dev_s *priv, uint8_t reg)
 #else
      ret = be16_to_cpu(*((uint16_t *)reg_val));
 #endif
+     tfa9890_shadow_set(priv, reg, ret);
      return ret;
 }
 
 int tfa9890_reg_write(FAR struct tfa9890_dev_s *priv, uint8_t reg, uint16_t val)
 {
     uint8_t buf[3];
+    int ret;
+
+    if (tfa9890_shadow_get(priv, reg) == val)
+        return 0;
 
     I2C_SETADDRESS(priv->i2c, priv->i2c_addr, 7);
 
@@ -168,7 +227,71 @@ int tfa9890_reg_write(FAR struct tfa9890_dev_s *priv, uint8_t reg, uint16_t val)
     buf[2] = val & 0x00ff;
     buf[1] = (val & 0xff00) >> 8;
 #endif
-    return I2C_WRITE(priv->i2c, (uint8_t *)buf, 4);
+    ret = I2C_WRITE(priv->i2c, (uint8_t *)buf, sizeof(buf));
+    if (ret)
+    {
+        tfa9890_shadow_invalidate(priv);
+        return ret;
+    }
+
+    tfa9890_shadow_set(priv, reg, val);
+    return 0;
+}
+
+/*
+ * Write a register table.  Entries whose shadowed value already matches
+ * are skipped, and runs of consecutive registers are sent as a single
+ * auto-increment write instead of one transfer per register.
+ */
+static int tfa9890_write_table(FAR struct tfa9890_dev_s *priv,
+                const struct tfa9890_registers *regs, int num)
+{
+    uint8_t buf[1 + 2 * TFA9890_BURST_MAX_REGS];
+    int first = 0;
+    int count;
+    int ret;
+    int i;
+
+    I2C_SETADDRESS(priv->i2c, priv->i2c_addr, 7);
+
+    while (first < num)
+    {
+        if (tfa9890_shadow_get(priv, regs[first].reg) == regs[first].val)
+        {
+            first++;
+            continue;
+        }
+
+        /* extend the run while the next register follows and needs writing */
+        count = 1;
+        while (first + count < num && count < TFA9890_BURST_MAX_REGS &&
+               regs[first + count].reg == regs[first].reg + count &&
+               tfa9890_shadow_get(priv, regs[first + count].reg) !=
+                                                   regs[first + count].val)
+            count++;
+
+        buf[0] = regs[first].reg;
+        for (i = 0; i < count; i++)
+        {
+            buf[1 + 2 * i] = (regs[first + i].val >> 8) & 0xff;
+            buf[2 + 2 * i] = regs[first + i].val & 0xff;
+        }
+
+        ret = I2C_WRITE(priv->i2c, buf, 1 + 2 * count);
+        if (ret)
+        {
+            lldbg("burst write at 0x%02x failed %d\n", regs[first].reg, ret);
+            tfa9890_shadow_invalidate(priv);
+            return ret;
+        }
+
+        for (i = 0; i < count; i++)
+            tfa9890_shadow_set(priv, regs[first + i].reg, regs[first + i].val);
+
+        first += count;
+    }
+
+    return 0;
 }
 
 static int tfa9890_modify(FAR struct tfa9890_dev_s *priv, uint16_t reg,
@@ -183,7 +306,7 @@ static int tfa9890_modify(FAR struct tfa9890_dev_s *priv, uint16_t reg,
     }
 
     val = SETBITS(val, mask << offset, s << offset);
-    return tfa9890_reg_write(priv, reg, val);
+    return tfa9890_reg_write(priv, reg, val & 0xffff);
 }
 
 static int tfa9890_bulk_read(FAR struct i2c_dev_s *i2c_dev, uint32_t i2c_addr,
@@ -442,10 +565,6 @@ static int tfa9890_update_preset(FAR struct tfa9890_dev_s *priv)
     const uint8_t *pst;
     int ret;
 
-    ret = tfa9890_wait_pll_sync(priv);
-    if (ret) {
-        goto err;
-    }
     sys_vol_db = priv->sys_vol_db;
     use_case = priv->current_eq;
 
@@ -473,11 +592,28 @@ static int tfa9890_update_preset(FAR struct tfa9890_dev_s *priv)
         ret = -EINVAL;
         goto err;
     }
+    pst += TFA9890_PST_FW_SIZE * preset_index;
+
+    /*
+     * Use cases and volume steps often map to the preset already in the
+     * DSP; skip the PLL wait and the RPC transfer in that case.
+     */
+    if (pst == priv->loaded_preset) {
+        priv->preset_update_pending = 0;
+        return 0;
+    }
+
+    ret = tfa9890_wait_pll_sync(priv);
+    if (ret) {
+        goto err;
+    }
     ret = tfa9890_dsp_transfer(priv, TFA9890_DSP_MOD_SPEAKERBOOST,
-                               TFA9890_PARAM_SET_PRESET, (pst + TFA9890_PST_FW_SIZE * preset_index),
+                               TFA9890_PARAM_SET_PRESET, pst,
                                TFA9890_PST_FW_SIZE,
                                TFA9890_DSP_WRITE, 0);
-    priv->preset_update_pending = 0;
+    /* a failed transfer is retried on the next start */
+    priv->loaded_preset = ret ? NULL : pst;
+    priv->preset_update_pending = ret ? 1 : 0;
     return 0;
 err:
     priv->preset_update_pending = 1;
@@ -518,6 +654,7 @@ int tfa9890_load_config(FAR struct tfa9890_dev_s *priv)
 {
     int ret = -EIO;
 
+    priv->loaded_preset = NULL;
     ret = tfa9887_load_dsp_patch(priv, tfa9890_n1c2_patch,
                      tfa9890_n1c2_patch_len);
     if (ret)
@@ -770,41 +907,27 @@ static int tfa9890_configure(FAR struct audio_lowerhalf_s *dev,
 
 static void tfa9890_init_registers(FAR struct tfa9890_dev_s *priv)
 {
-    int i;
-
     /* set up initial register values*/
-    for (i = 0; i < ARRAY_SIZE(tfa9890_registers_init_list); i++)
-    {
-         tfa9890_reg_write(priv, tfa9890_registers_init_list[i].reg,
-                     tfa9890_registers_init_list[i].val);
-    }
+    tfa9890_write_table(priv, tfa9890_registers_init_list,
+                        ARRAY_SIZE(tfa9890_registers_init_list));
 }
 
 #if defined (CONFIG_GREYBUS_MODS_AUDIO_TFA9890_STEREO)
 static int tfa9890_driver_stereo_setup(FAR struct tfa9890_dev_s *priv, int type)
 {
-    int i;
-
      /* set up right/left channel and Gain sharing channels
       * for stereo config.
       */
     if (type == TFA9890_LEFT)
     {
-
-        for (i = 0; i < ARRAY_SIZE(tfa9890_registers_left_init); i++)
-        {
-             tfa9890_reg_write(priv, tfa9890_registers_left_init[i].reg,
-                     tfa9890_registers_left_init[i].val);
-        }
+        tfa9890_write_table(priv, tfa9890_registers_left_init,
+                            ARRAY_SIZE(tfa9890_registers_left_init));
         priv->type = TFA9890_LEFT;
     }
     else if (type == TFA9890_RIGHT)
     {
-        for (i = 0; i < ARRAY_SIZE(tfa9890_registers_right_init); i++)
-        {
-             tfa9890_reg_write(priv, tfa9890_registers_right_init[i].reg,
-                     tfa9890_registers_right_init[i].val);
-        }
+        tfa9890_write_table(priv, tfa9890_registers_right_init,
+                            ARRAY_SIZE(tfa9890_registers_right_init));
         priv->type = TFA9890_RIGHT;
     }
     else if (type == TFA9890_MONO)
@@ -847,6 +970,8 @@ FAR struct audio_lowerhalf_s *tfa9890_driver_init(FAR struct i2c_dev_s *i2c,
         goto err;
     }
     tfa9890_modify(priv, TFA9890_REG_SYSTEM_CTRL_1, 1, 1, TFA9890_RESET_OFFSET);
+    /* reset restores the register defaults */
+    tfa9890_shadow_invalidate(priv);
 
     tfa9890_init_registers(priv);
     sem_init(&priv->preset_lock, 0, 1);
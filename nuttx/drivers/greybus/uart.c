@@ -32,11 +32,18 @@
 #include <queue.h>
 #include <stdio.h>
 #include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/device.h>
 #include <nuttx/device_uart.h>
+#include <nuttx/kmalloc.h>
 #include <nuttx/util.h>
+#include <nuttx/wdog.h>
 #include <nuttx/config.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
 #include <nuttx/greybus/types.h>
 #include <nuttx/greybus/greybus.h>
 #include <nuttx/greybus/debug.h>
@@ -57,6 +64,58 @@
 #define GB_UART_EVENT_PROTOCOL_ERROR    1
 #define GB_UART_EVENT_DEVICE_ERROR      2
 
+#ifdef CONFIG_GREYBUS_UART_RX_BATCH
+/*
+ * In batching mode the driver receives into a small staging buffer and the
+ * data is appended to the operation being filled, so that a batch can be
+ * sent from the timer without stopping the receiver.
+ */
+#define RX_CHUNK_SIZE           32
+
+#if CONFIG_GREYBUS_UART_RX_BATCH_SIZE + RX_CHUNK_SIZE > MAX_RX_BUF_SIZE
+#error "CONFIG_GREYBUS_UART_RX_BATCH_SIZE too large"
+#endif
+
+#define RX_IDLE_TICKS \
+    (MSEC2TICK(CONFIG_GREYBUS_UART_RX_IDLE_MSEC) > 0 ? \
+     MSEC2TICK(CONFIG_GREYBUS_UART_RX_IDLE_MSEC) : 1)
+#define RX_LATENCY_TICKS \
+    (MSEC2TICK(CONFIG_GREYBUS_UART_RX_LATENCY_MSEC) > 0 ? \
+     MSEC2TICK(CONFIG_GREYBUS_UART_RX_LATENCY_MSEC) : 1)
+#endif
+
+/* Why a batch of received data was sent */
+enum uart_rx_flush {
+    RX_FLUSH_SIZE,
+    RX_FLUSH_ERROR,
+    RX_FLUSH_IDLE,
+    RX_FLUSH_LATENCY,
+    RX_FLUSH_COUNT,
+};
+
+#ifdef CONFIG_GREYBUS_UART_RX_STATS
+/**
+ * Receive statistics, kept across protocol restarts.
+ */
+struct uart_rx_stats {
+    /** bytes sent in receive_data operations */
+    uint32_t            bytes;
+    /** receive_data operations sent */
+    uint32_t            ops;
+    /** receive callbacks from the UART driver */
+    uint32_t            callbacks;
+    /** batches sent, by reason */
+    uint32_t            flush[RX_FLUSH_COUNT];
+    /** times the receiver stopped for lack of a free operation */
+    uint32_t            no_op;
+    /** sum and maximum of the first byte to send delay, in ticks */
+    uint32_t            latency_total;
+    uint32_t            latency_max;
+};
+
+static struct uart_rx_stats uart_rx_stats;
+#endif
+
 /**
  * The buffer in operation structure.
  */
@@ -71,6 +130,10 @@ struct op_node {
     uint8_t             *data_flags;
     /** pointer to buffer of request in operation */
     uint8_t             *buffer;
+#ifdef CONFIG_GREYBUS_UART_RX_STATS
+    /** system time of the first byte in the buffer */
+    uint32_t            first;
+#endif
 };
 
 /**
@@ -105,6 +168,19 @@ struct gb_uart_info {
     int                 entries;
     /** flag for requesting a free operation in callback */
     int                 require_node;
+#ifdef CONFIG_GREYBUS_UART_RX_BATCH
+    /** bytes collected in rx_node */
+    int                 rx_fill;
+    /** line error flags collected in rx_node */
+    uint8_t             rx_flags;
+    /** system time of the first and the last byte in rx_node */
+    uint32_t            rx_first;
+    uint32_t            rx_last;
+    /** idle and latency timer */
+    WDOG_ID             rx_wdog;
+    /** staging buffer the driver receives into */
+    uint8_t             rx_chunk[RX_CHUNK_SIZE];
+#endif
     /** semaphore for notifying data received */
     sem_t               rx_sem;
     /** receiving data process threed */
@@ -281,6 +357,123 @@ static void uart_ls_callback(uint8_t ls)
     sem_post(&info->status_sem);
 }
 
+/**
+ * @brief Convert the line errors of the driver to receive_data flags
+ *
+ * @param error Error code from the driver.
+ * @return The GB_UART_RECV_FLAG_* flags.
+ */
+static uint8_t uart_rx_flags(int error)
+{
+    uint8_t flags = 0;
+
+    if (error & LSR_OE) {
+        flags |= GB_UART_RECV_FLAG_OVERRUN;
+    }
+    if (error & LSR_PE) {
+        flags |= GB_UART_RECV_FLAG_PARITY;
+    }
+    if (error & LSR_FE) {
+        flags |= GB_UART_RECV_FLAG_FRAMING;
+    }
+    if (error & LSR_BI) {
+        flags |= GB_UART_RECV_FLAG_BREAK;
+    }
+
+    return flags;
+}
+
+static void uart_rx_callback(uint8_t *buffer, int length, int error);
+
+/**
+ * @brief Start the receiver on the current operation
+ *
+ * @return 0 for success, -errno for failures.
+ */
+static int uart_rx_start(void)
+{
+#ifdef CONFIG_GREYBUS_UART_RX_BATCH
+    return device_uart_start_receiver(info->dev, info->rx_chunk,
+                                      RX_CHUNK_SIZE, NULL, NULL,
+                                      uart_rx_callback);
+#else
+    return device_uart_start_receiver(info->dev, info->rx_node->buffer,
+                                      info->rx_buf_size, NULL, NULL,
+                                      uart_rx_callback);
+#endif
+}
+
+#ifdef CONFIG_GREYBUS_UART_RX_BATCH
+/**
+ * @brief Hand the batch being filled to the rx thread
+ *
+ * Must be called with interrupts disabled. Takes the next free operation, if
+ * any, to collect the following data.
+ *
+ * @param reason Why the batch is sent.
+ * @return None.
+ */
+static void uart_rx_flush(enum uart_rx_flush reason)
+{
+    struct op_node *node = info->rx_node;
+
+    *node->data_size = cpu_to_le16(info->rx_fill);
+    *node->data_flags = info->rx_flags;
+#ifdef CONFIG_GREYBUS_UART_RX_STATS
+    node->first = info->rx_first;
+    uart_rx_stats.flush[reason]++;
+#endif
+
+    put_node_back(&info->data_queue, node);
+    /* notify rx thread to process this data*/
+    sem_post(&info->rx_sem);
+
+    info->rx_fill = 0;
+    info->rx_flags = 0;
+    info->rx_node = get_node_from(&info->free_queue);
+}
+
+/**
+ * @brief Idle and latency timer
+ *
+ * Sends the batch being filled once the line has been idle for
+ * CONFIG_GREYBUS_UART_RX_IDLE_MSEC or its first byte is older than
+ * CONFIG_GREYBUS_UART_RX_LATENCY_MSEC. Called from the timer interrupt.
+ *
+ * @return None.
+ */
+static void uart_rx_timeout(int argc, uint32_t arg, ...)
+{
+    uint32_t now = clock_systimer();
+    irqstate_t flags = irqsave();
+    int reason = -1;
+
+    if (!info->rx_node || info->rx_fill == 0) {
+        irqrestore(flags);
+        return;
+    }
+
+    if (now - info->rx_last >= RX_IDLE_TICKS) {
+        reason = RX_FLUSH_IDLE;
+    } else if (now - info->rx_first >= RX_LATENCY_TICKS) {
+        reason = RX_FLUSH_LATENCY;
+    }
+
+    /*
+     * The receiver keeps running into the staging buffer, so the batch can
+     * only be sent if there is an operation to continue with. Otherwise the
+     * rx thread is behind anyway: try again later.
+     */
+    if (reason >= 0 && !sq_empty(&info->free_queue)) {
+        uart_rx_flush(reason);
+    } else {
+        wd_start(info->rx_wdog, RX_IDLE_TICKS, (wdentry_t)uart_rx_timeout, 0);
+    }
+
+    irqrestore(flags);
+}
+#endif
+
 /**
  * @brief Callback for data receiving
  *
@@ -292,32 +485,80 @@ static void uart_ls_callback(uint8_t ls)
  * It put the current operation to received queue and gets another operation to
  * continue receiving. Then notifies rx thread to process.
  *
+ * In batching mode, the data is appended to the current operation instead,
+ * which is only handed to the rx thread when full enough or on a line error.
+ * The timer sends it when the line goes idle.
+ *
  * @param buffer Data buffer.
  * @param length Received data length.
  * @param error Error code when driver receiving.
  * @return None.
  */
+#ifdef CONFIG_GREYBUS_UART_RX_BATCH
 static void uart_rx_callback(uint8_t *buffer, int length, int error)
 {
-    struct op_node *node;
+    uint8_t flags = uart_rx_flags(error);
+    irqstate_t irqflags;
     int ret;
-    uint8_t flags = 0;
 
-    *info->rx_node->data_size = cpu_to_le16(length);
+#ifdef CONFIG_GREYBUS_UART_RX_STATS
+    uart_rx_stats.callbacks++;
+#endif
 
-    if (error & LSR_OE) {
-        flags |= GB_UART_RECV_FLAG_OVERRUN;
-    }
-    if (error & LSR_PE) {
-        flags |= GB_UART_RECV_FLAG_PARITY;
+    irqflags = irqsave();
+
+    if (length > 0 || flags) {
+        info->rx_last = clock_systimer();
+        if (info->rx_fill == 0) {
+            info->rx_first = info->rx_last;
+            wd_start(info->rx_wdog, RX_IDLE_TICKS,
+                     (wdentry_t)uart_rx_timeout, 0);
+        }
+
+        memcpy(info->rx_node->buffer + info->rx_fill, buffer, length);
+        info->rx_fill += length;
+        info->rx_flags |= flags;
+
+        if (flags) {
+            uart_rx_flush(RX_FLUSH_ERROR);
+        } else if (info->rx_fill >= CONFIG_GREYBUS_UART_RX_BATCH_SIZE) {
+            uart_rx_flush(RX_FLUSH_SIZE);
+        }
     }
-    if (error & LSR_FE) {
-        flags |= GB_UART_RECV_FLAG_FRAMING;
+
+    if (!info->rx_node) {
+        /*
+         * there is no free buffer, inform the rx thread to engage another uart
+         * receiver.
+         */
+#ifdef CONFIG_GREYBUS_UART_RX_STATS
+        uart_rx_stats.no_op++;
+#endif
+        info->require_node = 1;
+        irqrestore(irqflags);
+        return;
     }
-    if (error & LSR_BI) {
-        flags |= GB_UART_RECV_FLAG_BREAK;
+
+    irqrestore(irqflags);
+
+    ret = uart_rx_start();
+    if (ret) {
+        uart_report_error(GB_UART_EVENT_PROTOCOL_ERROR, __func__);
     }
-    *info->rx_node->data_flags = flags;
+}
+#else
+static void uart_rx_callback(uint8_t *buffer, int length, int error)
+{
+    struct op_node *node;
+    int ret;
+
+    *info->rx_node->data_size = cpu_to_le16(length);
+    *info->rx_node->data_flags = uart_rx_flags(error);
+#ifdef CONFIG_GREYBUS_UART_RX_STATS
+    info->rx_node->first = clock_systimer();
+    uart_rx_stats.callbacks++;
+    uart_rx_stats.flush[RX_FLUSH_SIZE]++;
+#endif
 
     put_node_back(&info->data_queue, info->rx_node);
     /* notify rx thread to process this data*/
@@ -330,17 +571,20 @@ static void uart_rx_callback(uint8_t *buffer, int length, int error)
          * there is no free buffer, inform the rx thread to engage another uart
          * receiver.
          */
+#ifdef CONFIG_GREYBUS_UART_RX_STATS
+        uart_rx_stats.no_op++;
+#endif
         info->require_node = 1;
         return;
     }
 
     info->rx_node = node;
-    ret = device_uart_start_receiver(info->dev, node->buffer, info->rx_buf_size,
-                                     NULL, NULL, uart_rx_callback);
+    ret = uart_rx_start();
     if (ret) {
         uart_report_error(GB_UART_EVENT_PROTOCOL_ERROR, __func__);
     }
 }
+#endif
 
 /**
  * @brief Parse the modem and line stauts
@@ -448,6 +692,16 @@ static void *uart_rx_thread(void *data)
 
         node = get_node_from(&info->data_queue);
         if (node) {
+#ifdef CONFIG_GREYBUS_UART_RX_STATS
+            uint32_t latency = clock_systimer() - node->first;
+
+            uart_rx_stats.ops++;
+            uart_rx_stats.bytes += le16_to_cpu(*node->data_size);
+            uart_rx_stats.latency_total += latency;
+            if (latency > uart_rx_stats.latency_max) {
+                uart_rx_stats.latency_max = latency;
+            }
+#endif
             ret = gb_operation_send_request(node->operation, NULL, false);
             if (ret) {
                 uart_report_error(GB_UART_EVENT_PROTOCOL_ERROR, __func__);
@@ -461,9 +715,7 @@ static void *uart_rx_thread(void *data)
         if (info->require_node) {
             node = get_node_from(&info->free_queue);
             info->rx_node = node;
-            ret = device_uart_start_receiver(info->dev, node->buffer,
-                                             info->rx_buf_size, NULL, NULL,
-                                             uart_rx_callback);
+            ret = uart_rx_start();
             if (ret) {
                 uart_report_error(GB_UART_EVENT_DEVICE_ERROR, __func__);
             }
@@ -556,6 +808,13 @@ static void uart_receiver_cb_deinit(void)
         pthread_join(info->rx_thread, NULL);
     }
 
+#ifdef CONFIG_GREYBUS_UART_RX_BATCH
+    if (info->rx_wdog) {
+        wd_delete(info->rx_wdog);
+        info->rx_wdog = NULL;
+    }
+#endif
+
     sem_destroy(&info->rx_sem);
 
     uart_free_op(&info->data_queue);
@@ -575,6 +834,7 @@ static void uart_receiver_cb_deinit(void)
  */
 static int uart_receiver_cb_init(void)
 {
+    pthread_attr_t attr;
     int ret;
 
     sq_init(&info->free_queue);
@@ -588,21 +848,45 @@ static int uart_receiver_cb_init(void)
         return ret;
     }
 
+#ifdef CONFIG_GREYBUS_UART_RX_BATCH
+    info->rx_wdog = wd_create();
+    if (!info->rx_wdog) {
+        uart_free_op(&info->free_queue);
+        return -ENOMEM;
+    }
+#endif
+
     ret = sem_init(&info->rx_sem, 0, 0);
     if (ret) {
-        goto err_free_data_op;
+        goto err_delete_wdog;
+    }
+
+    ret = pthread_attr_init(&attr);
+    if (ret) {
+        goto err_destroy_rx_sem;
     }
 
-    ret = pthread_create(&info->rx_thread, NULL, uart_rx_thread, info);
+#if CONFIG_GREYBUS_UART_RX_STACKSIZE > 0
+    pthread_attr_setstacksize(&attr, CONFIG_GREYBUS_UART_RX_STACKSIZE);
+#endif
+
+    ret = pthread_create(&info->rx_thread, &attr, uart_rx_thread, info);
+    pthread_attr_destroy(&attr);
     if (ret) {
         goto err_destroy_rx_sem;
     }
 
+    pthread_setname_np(info->rx_thread, "gb_uart_rx");
+
     return 0;
 
 err_destroy_rx_sem:
     sem_destroy(&info->rx_sem);
-err_free_data_op:
+err_delete_wdog:
+#ifdef CONFIG_GREYBUS_UART_RX_BATCH
+    wd_delete(info->rx_wdog);
+    info->rx_wdog = NULL;
+#endif
     uart_free_op(&info->free_queue);
 
     return -ret;
@@ -952,3 +1236,120 @@ void gb_uart_register(int cport)
     gb_register_driver(cport, &uart_driver);
 }
 
+#if defined(CONFIG_GREYBUS_UART_RX_STATS) && \
+    !defined(CONFIG_DISABLE_MOUNTPOINT) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+
+#define GB_UART_PROCFS_BUFLEN   256
+
+struct gb_uart_file_s {
+    struct procfs_file_s base;
+    size_t len;
+    char buf[GB_UART_PROCFS_BUFLEN];
+};
+
+static int gb_uart_procfs_open(FAR struct file *filep, FAR const char *relpath,
+                               int oflags, mode_t mode)
+{
+    FAR struct gb_uart_file_s *priv;
+
+    if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+        return -EACCES;
+
+    priv = kmm_zalloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    filep->f_priv = priv;
+    return OK;
+}
+
+static int gb_uart_procfs_close(FAR struct file *filep)
+{
+    kmm_free(filep->f_priv);
+    filep->f_priv = NULL;
+    return OK;
+}
+
+static ssize_t gb_uart_procfs_read(FAR struct file *filep, FAR char *buffer,
+                                   size_t buflen)
+{
+    FAR struct gb_uart_file_s *priv = filep->f_priv;
+    struct uart_rx_stats stats;
+    irqstate_t flags;
+    off_t offset;
+    ssize_t ret;
+
+    /* Take a snapshot on the first read so that the content stays stable */
+    if (filep->f_pos == 0) {
+        flags = irqsave();
+        stats = uart_rx_stats;
+        irqrestore(flags);
+
+        priv->len = snprintf(priv->buf, GB_UART_PROCFS_BUFLEN,
+                             "rx bytes %u\nrx ops %u\nrx callbacks %u\n"
+                             "flush size %u error %u idle %u latency %u\n"
+                             "no free op %u\n"
+                             "latency avg %u ms max %u ms\n",
+                             (unsigned int) stats.bytes,
+                             (unsigned int) stats.ops,
+                             (unsigned int) stats.callbacks,
+                             (unsigned int) stats.flush[RX_FLUSH_SIZE],
+                             (unsigned int) stats.flush[RX_FLUSH_ERROR],
+                             (unsigned int) stats.flush[RX_FLUSH_IDLE],
+                             (unsigned int) stats.flush[RX_FLUSH_LATENCY],
+                             (unsigned int) stats.no_op,
+                             stats.ops ? (unsigned int)
+                                 TICK2MSEC(stats.latency_total / stats.ops) : 0,
+                             (unsigned int) TICK2MSEC(stats.latency_max));
+    }
+
+    offset = filep->f_pos;
+    ret = procfs_memcpy(priv->buf, priv->len, buffer, buflen, &offset);
+    if (ret > 0)
+        filep->f_pos += ret;
+
+    return ret;
+}
+
+static int gb_uart_procfs_dup(FAR const struct file *oldp,
+                              FAR struct file *newp)
+{
+    FAR struct gb_uart_file_s *priv;
+
+    priv = kmm_malloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    memcpy(priv, oldp->f_priv, sizeof(*priv));
+    newp->f_priv = priv;
+    return OK;
+}
+
+static int gb_uart_procfs_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+    buf->st_mode    = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+    buf->st_size    = 0;
+    buf->st_blksize = 0;
+    buf->st_blocks  = 0;
+    return OK;
+}
+
+/* See fs_procfs.c -- this structure is explicitly externed there */
+const struct procfs_operations gb_uart_procfsoperations = {
+    gb_uart_procfs_open,    /* open */
+    gb_uart_procfs_close,   /* close */
+    gb_uart_procfs_read,    /* read */
+    NULL,                   /* write */
+
+    gb_uart_procfs_dup,     /* dup */
+
+    NULL,                   /* opendir */
+    NULL,                   /* closedir */
+    NULL,                   /* readdir */
+    NULL,                   /* rewinddir */
+
+    gb_uart_procfs_stat     /* stat */
+};
+#endif
+
@@ -33,7 +33,7 @@
 
 /* Version of the Greybus USB protocol we support */
 #define GB_USB_VERSION_MAJOR		0x00
-#define GB_USB_VERSION_MINOR		0x01
+#define GB_USB_VERSION_MINOR		0x02
 
 /* Greybus USB request types */
 #define GB_USB_TYPE_INVALID		0x00
@@ -41,6 +41,9 @@
 #define GB_USB_TYPE_HCD_START		0x02
 #define GB_USB_TYPE_HCD_STOP		0x03
 #define GB_USB_TYPE_HUB_CONTROL		0x04
+#define GB_USB_TYPE_URB_ENQUEUE		0x05
+#define GB_USB_TYPE_URB_DEQUEUE		0x06
+#define GB_USB_TYPE_URB_COMPLETE	0x07
 
 struct gb_usb_proto_version_response {
 	__u8	major;
@@ -58,5 +61,38 @@ struct gb_usb_hub_control_response {
 	__u8 buf[0];
 };
 
+/*
+ * URBs are asynchronous: the enqueue response only reports whether the URB
+ * was queued.  Its outcome is sent later by the module in a unidirectional
+ * URB complete request carrying the same AP-chosen id, so the AP may keep
+ * several URBs in flight on one endpoint.
+ */
+struct gb_usb_urb_enqueue_request {
+	__le32 id;
+	__u8 pipe_type;
+	__u8 devnum;
+	__u8 endpoint;
+	__u8 direction;
+	__u8 dev_speed;
+	__u8 dev_ttport;
+	__le16 maxpacket;
+	__le32 flags;
+	__le32 length;
+	__le32 interval;
+	__u8 setup_packet[8];
+	__u8 payload[0];		/* OUT data */
+};
+
+struct gb_usb_urb_dequeue_request {
+	__le32 id;
+};
+
+struct gb_usb_urb_complete_request {
+	__le32 id;
+	__le32 status;
+	__le32 actual_length;
+	__u8 payload[0];		/* IN data */
+};
+
 #endif /* __USB_GB_H__ */
 
@@ -29,10 +29,15 @@
  */
 
 #include <arch/byteorder.h>
+#include <arch/irq.h>
 #include <nuttx/greybus/greybus.h>
+#include <nuttx/list.h>
 #include <nuttx/usb.h>
 #include "usb-gb.h"
 
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -43,7 +48,23 @@
 #define gb_usb_debug(x...)
 #endif
 
+struct gb_usb_urb {
+    struct list_head list;
+    uint32_t id;
+    struct urb *urb;
+};
+
 static struct device *usbdev;
+static unsigned int usb_cport;
+
+/* URBs queued on the HCD, and URBs completed but not yet reported */
+static LIST_DECLARE(urb_inflight);
+static LIST_DECLARE(urb_done);
+static unsigned int urb_count;
+
+static pthread_t urb_thread;
+static sem_t urb_sem;
+static bool urb_thread_stop;
 
 static uint8_t gb_usb_protocol_version(struct gb_operation *operation)
 {
@@ -120,20 +141,307 @@ static uint8_t gb_usb_hub_control(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
+static void gb_usb_urb_free(struct gb_usb_urb *gurb)
+{
+#ifdef CONFIG_MODS_USB_HCD_ROUTER
+    free(gurb->urb->setup_packet);
+#endif
+    free(gurb->urb->buffer);
+    urb_destroy(gurb->urb);
+    free(gurb);
+}
+
+/*
+ * Called by the HCD, generally in interrupt context: hand the URB over to
+ * the completion thread, which reports it to the AP.
+ */
+static void gb_usb_urb_complete(struct urb *urb)
+{
+    struct gb_usb_urb *gurb;
+    struct list_head *iter;
+    irqstate_t flags;
+
+    flags = irqsave();
+    list_foreach(&urb_inflight, iter) {
+        gurb = list_entry(iter, struct gb_usb_urb, list);
+        if (gurb->urb == urb) {
+            list_del(iter);
+            list_add(&urb_done, iter);
+            sem_post(&urb_sem);
+            break;
+        }
+    }
+    irqrestore(flags);
+}
+
+static void gb_usb_urb_report(struct gb_usb_urb *gurb)
+{
+    struct gb_usb_urb_complete_request *request;
+    struct gb_operation *operation;
+    struct urb *urb = gurb->urb;
+    size_t payload = 0;
+
+    if (urb->pipe.direction == USB_HOST_DIR_IN && !urb->status) {
+        payload = urb->actual_length;
+    }
+
+    operation = gb_operation_create(usb_cport, GB_USB_TYPE_URB_COMPLETE,
+                                    sizeof(*request) + payload);
+    if (!operation) {
+        return;
+    }
+
+    request = gb_operation_get_request_payload(operation);
+    request->id = cpu_to_le32(gurb->id);
+    request->status = cpu_to_le32(urb->status);
+    request->actual_length = cpu_to_le32(urb->actual_length);
+    memcpy(request->payload, urb->buffer, payload);
+
+    gb_operation_send_request(operation, NULL, false);
+    gb_operation_destroy(operation);
+}
+
+static void *gb_usb_urb_thread(void *data)
+{
+    struct gb_usb_urb *gurb;
+    irqstate_t flags;
+
+    while (1) {
+        sem_wait(&urb_sem);
+        if (urb_thread_stop) {
+            break;
+        }
+
+        flags = irqsave();
+        if (list_is_empty(&urb_done)) {
+            irqrestore(flags);
+            continue;
+        }
+        gurb = list_entry(urb_done.next, struct gb_usb_urb, list);
+        list_del(&gurb->list);
+        urb_count--;
+        irqrestore(flags);
+
+        gb_usb_urb_report(gurb);
+        gb_usb_urb_free(gurb);
+    }
+
+    return NULL;
+}
+
+static uint8_t gb_usb_urb_enqueue(struct gb_operation *operation)
+{
+    struct gb_usb_urb_enqueue_request *request =
+        gb_operation_get_request_payload(operation);
+    size_t request_size = gb_operation_get_request_payload_size(operation);
+    struct gb_usb_urb *gurb;
+    struct urb *urb;
+    irqstate_t flags;
+    size_t length;
+    int retval;
+
+    if (request_size < sizeof(*request)) {
+        return GB_OP_INVALID;
+    }
+
+    length = le32_to_cpu(request->length);
+    if (request->direction == USB_HOST_DIR_OUT &&
+        request_size < sizeof(*request) + length) {
+        return GB_OP_INVALID;
+    }
+
+    gb_usb_debug("%s(%u, ep %u, %zu)\n", __func__, le32_to_cpu(request->id),
+                 request->endpoint, length);
+
+    if (urb_count >= CONFIG_GREYBUS_USB_HOST_MAX_URBS) {
+        return GB_OP_NO_MEMORY;
+    }
+
+    gurb = zalloc(sizeof(*gurb));
+    if (!gurb) {
+        return GB_OP_NO_MEMORY;
+    }
+
+    urb = urb_create();
+    if (!urb) {
+        goto err_free_gurb;
+    }
+
+    if (length) {
+        urb->buffer = malloc(length);
+        if (!urb->buffer) {
+            goto err_free_urb;
+        }
+    }
+
+    if (request->direction == USB_HOST_DIR_OUT) {
+        memcpy(urb->buffer, request->payload, length);
+    }
+
+    urb->complete = gb_usb_urb_complete;
+    urb->dev_speed = request->dev_speed;
+    urb->devnum = request->devnum;
+    urb->dev_ttport = request->dev_ttport;
+    urb->pipe.type = request->pipe_type;
+    urb->pipe.device = request->devnum;
+    urb->pipe.endpoint = request->endpoint;
+    urb->pipe.direction = request->direction;
+    urb->length = length;
+    urb->maxpacket = le16_to_cpu(request->maxpacket);
+    urb->interval = le32_to_cpu(request->interval);
+    urb->flags = le32_to_cpu(request->flags);
+#ifdef CONFIG_MODS_USB_HCD_ROUTER
+    urb->setup_packet = malloc(sizeof(request->setup_packet));
+    if (!urb->setup_packet) {
+        goto err_free_buffer;
+    }
+#endif
+    memcpy(urb->setup_packet, request->setup_packet,
+           sizeof(request->setup_packet));
+
+    gurb->id = le32_to_cpu(request->id);
+    gurb->urb = urb;
+
+    /*
+     * Track the URB before handing it over: it may complete before
+     * urb_enqueue() returns.
+     */
+    flags = irqsave();
+    list_add(&urb_inflight, &gurb->list);
+    urb_count++;
+    irqrestore(flags);
+
+    retval = device_usb_hcd_urb_enqueue(usbdev, urb);
+    if (retval) {
+        flags = irqsave();
+        list_del(&gurb->list);
+        urb_count--;
+        irqrestore(flags);
+
+#ifdef CONFIG_MODS_USB_HCD_ROUTER
+        free(urb->setup_packet);
+#endif
+        goto err_free_buffer;
+    }
+
+    return GB_OP_SUCCESS;
+
+err_free_buffer:
+    free(urb->buffer);
+err_free_urb:
+    urb_destroy(urb);
+err_free_gurb:
+    free(gurb);
+    return GB_OP_NO_MEMORY;
+}
+
+static uint8_t gb_usb_urb_dequeue(struct gb_operation *operation)
+{
+    struct gb_usb_urb_dequeue_request *request =
+        gb_operation_get_request_payload(operation);
+    struct gb_usb_urb *gurb = NULL;
+    struct gb_usb_urb *entry;
+    struct list_head *iter;
+    irqstate_t flags;
+    uint32_t id;
+
+    if (gb_operation_get_request_payload_size(operation) < sizeof(*request)) {
+        return GB_OP_INVALID;
+    }
+
+    id = le32_to_cpu(request->id);
+
+    gb_usb_debug("%s(%u)\n", __func__, id);
+
+    flags = irqsave();
+    list_foreach(&urb_inflight, iter) {
+        entry = list_entry(iter, struct gb_usb_urb, list);
+        if (entry->id == id) {
+            gurb = entry;
+            list_del(iter);
+            urb_count--;
+            device_usb_hcd_urb_dequeue(usbdev, gurb->urb);
+            break;
+        }
+    }
+    irqrestore(flags);
+
+    /* Already completed: the AP gets (or got) the complete request */
+    if (!gurb) {
+        return GB_OP_NONEXISTENT;
+    }
+
+    gb_usb_urb_free(gurb);
+
+    return GB_OP_SUCCESS;
+}
+
+static void gb_usb_urb_flush(void)
+{
+    struct gb_usb_urb *gurb;
+    irqstate_t flags;
+
+    flags = irqsave();
+    while (!list_is_empty(&urb_inflight)) {
+        gurb = list_entry(urb_inflight.next, struct gb_usb_urb, list);
+        list_del(&gurb->list);
+        device_usb_hcd_urb_dequeue(usbdev, gurb->urb);
+        irqrestore(flags);
+
+        gb_usb_urb_free(gurb);
+
+        flags = irqsave();
+    }
+
+    while (!list_is_empty(&urb_done)) {
+        gurb = list_entry(urb_done.next, struct gb_usb_urb, list);
+        list_del(&gurb->list);
+        irqrestore(flags);
+
+        gb_usb_urb_free(gurb);
+
+        flags = irqsave();
+    }
+    urb_count = 0;
+    irqrestore(flags);
+}
+
 static int gb_usb_init(unsigned int cport)
 {
+    int retval;
+
     usbdev = device_open(DEVICE_TYPE_USB_HCD, 0);
     if (!usbdev) {
         return -ENODEV;
     }
 
+    usb_cport = cport;
+    urb_thread_stop = false;
+    sem_init(&urb_sem, 0, 0);
+
+    retval = pthread_create(&urb_thread, NULL, gb_usb_urb_thread, NULL);
+    if (retval) {
+        sem_destroy(&urb_sem);
+        device_close(usbdev);
+        usbdev = NULL;
+        return -retval;
+    }
+
     return 0;
 }
 
 static void gb_usb_exit(unsigned int cport)
 {
     if (usbdev) {
+        urb_thread_stop = true;
+        sem_post(&urb_sem);
+        pthread_join(urb_thread, NULL);
+        sem_destroy(&urb_sem);
+
+        gb_usb_urb_flush();
+
         device_close(usbdev);
+        usbdev = NULL;
     }
 }
 
@@ -142,6 +450,8 @@ static struct gb_operation_handler gb_usb_handlers[] = {
     GB_HANDLER(GB_USB_TYPE_HCD_STOP, gb_usb_hcd_stop),
     GB_HANDLER(GB_USB_TYPE_HCD_START, gb_usb_hcd_start),
     GB_HANDLER(GB_USB_TYPE_HUB_CONTROL, gb_usb_hub_control),
+    GB_HANDLER(GB_USB_TYPE_URB_ENQUEUE, gb_usb_urb_enqueue),
+    GB_HANDLER(GB_USB_TYPE_URB_DEQUEUE, gb_usb_urb_dequeue),
 };
 
 struct gb_driver usb_driver = {
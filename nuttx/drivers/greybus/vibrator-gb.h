@@ -37,6 +37,7 @@
 #define GB_VIBRATOR_TYPE_PROTOCOL_VERSION    0x01
 #define GB_VIBRATOR_TYPE_VIBRATOR_ON         0x02
 #define GB_VIBRATOR_TYPE_VIBRATOR_OFF        0x03
+#define GB_VIBRATOR_TYPE_SET_PATTERN         0x04
 
 /* version request has no payload */
 struct gb_vibrator_proto_version_response {
@@ -48,4 +49,20 @@ struct gb_vibrator_on_request {
     __le16 timeout_ms;
 };
 
+struct gb_vibrator_keyframe {
+    __le16 duration_ms;
+    __u8 level;                 /* 0 is off */
+    __u8 flags;                 /* GB_VIBRATOR_KEYFRAME_* */
+} __packed;
+
+#define GB_VIBRATOR_KEYFRAME_RAMP            0x01
+
+/* A count of 0 stops the pattern, a repeat of 0 plays it until stopped */
+struct gb_vibrator_set_pattern_request {
+    __u8 count;
+    __u8 reserved;
+    __le16 repeat;
+    struct gb_vibrator_keyframe frames[0];
+} __packed;
+
 #endif /* __VIBRATOR_GB_H__ */
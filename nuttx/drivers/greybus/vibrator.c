@@ -34,7 +34,9 @@
 #include <nuttx/greybus/greybus.h>
 #include <nuttx/greybus/debug.h>
 #include <apps/greybus-utils/utils.h>
+#include <nuttx/arch.h>
 #include <nuttx/gpio.h>
+#include <nuttx/lights_pattern.h>
 #include <arch/byteorder.h>
 
 #include "vibrator-gb.h"
@@ -42,11 +44,41 @@
 
 /* Version of the Greybus vibrator protocol we support */
 #define GB_VIBRATOR_VERSION_MAJOR    0x00
+#ifdef CONFIG_LIGHTS_PATTERN
+#define GB_VIBRATOR_VERSION_MINOR    0x02
+#else
 #define GB_VIBRATOR_VERSION_MINOR    0x01
+#endif
 
 /* Pick a GPIO line exposed on APBridge2 via the schematics */
 #define GB_VIBRATOR_DUMMY_GPIO       0x00
 
+#ifdef CONFIG_LIGHTS_PATTERN
+/*
+ * Waveforms are played from a timer, which needs a GPIO that can be set
+ * from interrupt context.
+ */
+static struct lights_pattern gb_vibrator_pattern;
+
+static void gb_vibrator_output(uint8_t level, void *priv)
+{
+    gpio_set_value(GB_VIBRATOR_DUMMY_GPIO, level ? 1 : 0);
+}
+
+static bool gb_vibrator_can_play(void)
+{
+    return !gpio_can_sleep(GB_VIBRATOR_DUMMY_GPIO);
+}
+
+static int gb_vibrator_play(const struct lights_keyframe *frames,
+                            unsigned int nframes, uint16_t repeat)
+{
+    gpio_activate(GB_VIBRATOR_DUMMY_GPIO);
+    return lights_pattern_start(&gb_vibrator_pattern, frames, nframes,
+                                repeat);
+}
+#endif
+
 static uint8_t gb_vibrator_protocol_version(struct gb_operation *operation)
 {
     struct gb_vibrator_proto_version_response *response;
@@ -71,6 +103,20 @@ static uint8_t gb_vibrator_vibrator_on(struct gb_operation *operation)
         return GB_OP_INVALID;
     }
 
+#ifdef CONFIG_LIGHTS_PATTERN
+    /* Don't block the CPort for the whole vibration */
+    if (gb_vibrator_can_play()) {
+        struct lights_keyframe frames[] = {
+            { .duration_ms = le16_to_cpu(request->timeout_ms), .level = 255 },
+            { .duration_ms = 0, .level = 0 },
+        };
+
+        if (gb_vibrator_play(frames, ARRAY_SIZE(frames), 1))
+            return GB_OP_UNKNOWN_ERROR;
+        return GB_OP_SUCCESS;
+    }
+#endif
+
     gpio_activate(GB_VIBRATOR_DUMMY_GPIO);
     gpio_set_value(GB_VIBRATOR_DUMMY_GPIO, 1);
 
@@ -85,6 +131,13 @@ static uint8_t gb_vibrator_vibrator_off(struct gb_operation *operation)
 {
     // Deactivate the GPIO line, somehow.
 
+    if (up_interrupt_context() && gpio_can_sleep(GB_VIBRATOR_DUMMY_GPIO))
+        return GB_OP_RX_DEFER;
+
+#ifdef CONFIG_LIGHTS_PATTERN
+    lights_pattern_stop(&gb_vibrator_pattern, true);
+#endif
+
     gpio_activate(GB_VIBRATOR_DUMMY_GPIO);
     gpio_set_value(GB_VIBRATOR_DUMMY_GPIO, 0);
     gpio_deactivate(GB_VIBRATOR_DUMMY_GPIO);
@@ -92,10 +145,57 @@ static uint8_t gb_vibrator_vibrator_off(struct gb_operation *operation)
     return GB_OP_SUCCESS;
 }
 
+#ifdef CONFIG_LIGHTS_PATTERN
+/*
+ * Play a waveform uploaded by the AP, without any further request. Any
+ * level other than 0 switches the vibrator on.
+ */
+static uint8_t gb_vibrator_set_pattern(struct gb_operation *operation)
+{
+    struct gb_vibrator_set_pattern_request *request =
+            gb_operation_get_request_payload(operation);
+    size_t size = gb_operation_get_request_payload_size(operation);
+    struct lights_keyframe *frames;
+    int i;
+
+    if (size < sizeof(*request) ||
+        size < sizeof(*request) + request->count * sizeof(request->frames[0])) {
+        gb_error("dropping short message\n");
+        return GB_OP_INVALID;
+    }
+
+    if (!gb_vibrator_can_play())
+        return GB_OP_PROTOCOL_BAD;
+
+    if (!request->count) {
+        lights_pattern_stop(&gb_vibrator_pattern, true);
+        return GB_OP_SUCCESS;
+    }
+
+    /* Same layout, convert the keyframes in place */
+    frames = (struct lights_keyframe *)request->frames;
+    for (i = 0; i < request->count; i++) {
+        frames[i].duration_ms = le16_to_cpu(request->frames[i].duration_ms);
+        frames[i].flags = (request->frames[i].flags &
+                           GB_VIBRATOR_KEYFRAME_RAMP) ?
+                          LIGHTS_KEYFRAME_RAMP : 0;
+    }
+
+    if (gb_vibrator_play(frames, request->count,
+                         le16_to_cpu(request->repeat)))
+        return GB_OP_INVALID;
+
+    return GB_OP_SUCCESS;
+}
+#endif
+
 static struct gb_operation_handler gb_vibrator_handlers[] = {
     GB_HANDLER(GB_VIBRATOR_TYPE_PROTOCOL_VERSION, gb_vibrator_protocol_version),
     GB_HANDLER(GB_VIBRATOR_TYPE_VIBRATOR_ON, gb_vibrator_vibrator_on),
-    GB_HANDLER(GB_VIBRATOR_TYPE_VIBRATOR_OFF, gb_vibrator_vibrator_off),
+    GB_RX_HANDLER(GB_VIBRATOR_TYPE_VIBRATOR_OFF, gb_vibrator_vibrator_off),
+#ifdef CONFIG_LIGHTS_PATTERN
+    GB_HANDLER(GB_VIBRATOR_TYPE_SET_PATTERN, gb_vibrator_set_pattern),
+#endif
 };
 
 static struct gb_driver gb_vibrator_driver = {
@@ -105,5 +205,8 @@ static struct gb_driver gb_vibrator_driver = {
 
 void gb_vibrator_register(int cport)
 {
+#ifdef CONFIG_LIGHTS_PATTERN
+    lights_pattern_init(&gb_vibrator_pattern, gb_vibrator_output, NULL);
+#endif
     gb_register_driver(cport, &gb_vibrator_driver);
 }
@@ -53,6 +53,11 @@
 #include <nuttx/lcd/lcd.h>
 #include <nuttx/lcd/memlcd.h>
 
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+#  include <nuttx/clock.h>
+#  include <nuttx/wqueue.h>
+#endif
+
 #include <arch/irq.h>
 
 /******************************************************************************
@@ -92,6 +97,10 @@
 /* display memory allocation */
 #define MEMLCD_FBSIZE        (MEMLCD_XSTRIDE*MEMLCD_YRES)
 
+/* One dirty bit per line of the shadow framebuffer */
+
+#define MEMLCD_DIRTYWORDS    ((MEMLCD_YRES + 31) >> 5)
+
 /* contrast setting, related to VCOM toggle frequency
  * higher frequency gives better contrast, instead, saves power
  */
@@ -142,6 +151,13 @@ struct memlcd_dev_s
    */
 
   uint8_t fb[MEMLCD_FBSIZE];
+
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+  /* Lines written by putrun() since the last flush */
+
+  struct work_s work;
+  uint32_t dirty[MEMLCD_DIRTYWORDS];
+#endif
 };
 
 /******************************************************************************
@@ -165,6 +181,9 @@ static int memlcd_putrun(fb_coord_t row, fb_coord_t col,
                          FAR const uint8_t * buffer, size_t npixels);
 static int memlcd_getrun(fb_coord_t row, fb_coord_t col, FAR uint8_t * buffer,
                          size_t npixels);
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+static void memlcd_flush(FAR void *arg);
+#endif
 
 /* lcd configuration */
 
@@ -464,7 +483,11 @@ static int memlcd_putrun(fb_coord_t row, fb_coord_t col,
                          FAR const uint8_t * buffer, size_t npixels)
 {
   FAR struct memlcd_dev_s *mlcd = (FAR struct memlcd_dev_s *)&g_memlcddev;
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+  irqstate_t flags;
+#else
   uint16_t cmd;
+#endif
   uint8_t *p;
   uint8_t *pfb;
   uint8_t usrmask;
@@ -515,6 +538,21 @@ static int memlcd_putrun(fb_coord_t row, fb_coord_t col,
 #endif
     }
 
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+  /* Only mark the line, the runs of a redraw are sent together by
+   * memlcd_flush() once NX is done with them.
+   */
+
+  flags = irqsave();
+  mlcd->dirty[row >> 5] |= (uint32_t)1 << (row & 31);
+  irqrestore(flags);
+
+  if (work_available(&mlcd->work))
+    {
+      (void)work_queue(LPWORK, &mlcd->work, memlcd_flush, mlcd,
+                       MSEC2TICK(CONFIG_LCD_DEFERRED_DELAY));
+    }
+#else
   /* Need to adjust start row by one because Memory LCD starts counting
    * lines from 1, while the display interface starts from 0.
    */
@@ -534,10 +572,79 @@ static int memlcd_putrun(fb_coord_t row, fb_coord_t col,
   /* XXX Ensure 2us here */
 
   memlcd_deselect(mlcd->spi);
+#endif
 
   return OK;
 }
 
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+/*******************************************************************************
+ * Name:  memlcd_flush
+ *
+ * Description:
+ *   Send the lines marked dirty by putrun() to the panel.  They all go in a
+ *   single multiple-line update command, i.e. a single chip select, so that
+ *   the SPI driver can move each line as one block.
+ *
+ * Input Parameters:
+ *   arg - Reference to private driver structure
+ *
+ ******************************************************************************/
+
+static void memlcd_flush(FAR void *arg)
+{
+  FAR struct memlcd_dev_s *mlcd = (FAR struct memlcd_dev_s *)arg;
+  uint32_t dirty[MEMLCD_DIRTYWORDS];
+  irqstate_t flags;
+  uint16_t cmd;
+  bool first;
+  int row;
+
+  /* Lines written from now on will be picked by the next flush */
+
+  flags = irqsave();
+  memcpy(dirty, mlcd->dirty, sizeof(dirty));
+  memset(mlcd->dirty, 0, sizeof(mlcd->dirty));
+  irqrestore(flags);
+
+  first = true;
+  for (row = 0; row < MEMLCD_YRES; row++)
+    {
+      if ((dirty[row >> 5] & ((uint32_t)1 << (row & 31))) == 0)
+        {
+          continue;
+        }
+
+      /* The first line address follows the update command, the next ones
+       * follow the dummy byte closing the previous line.  Memory LCD starts
+       * counting lines from 1.
+       */
+
+      if (first)
+        {
+          memlcd_select(mlcd->spi);
+          cmd = MEMLCD_CMD_UPDATE | (row + 1) << 8;
+          first = false;
+        }
+      else
+        {
+          cmd = 0xff | (row + 1) << 8;
+        }
+
+      SPI_SNDBLOCK(mlcd->spi, &cmd, 2);
+      SPI_SNDBLOCK(mlcd->spi, &mlcd->fb[row * MEMLCD_XSTRIDE],
+                   MEMLCD_XSTRIDE + MEMLCD_CONTROL_BYTES);
+    }
+
+  if (!first)
+    {
+      cmd = 0xffff;
+      SPI_SNDBLOCK(mlcd->spi, &cmd, 2);
+      memlcd_deselect(mlcd->spi);
+    }
+}
+#endif
+
 /*******************************************************************************
  * Name:  memlcd_getrun
  *
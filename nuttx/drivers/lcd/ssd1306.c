@@ -133,6 +133,11 @@
 #include <nuttx/lcd/lcd.h>
 #include <nuttx/lcd/ssd1306.h>
 
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+#  include <nuttx/clock.h>
+#  include <nuttx/wqueue.h>
+#endif
+
 #include <arch/irq.h>
 
 #ifdef CONFIG_LCD_SSD1306
@@ -331,6 +336,16 @@ struct ssd1306_dev_s
   */
 
   uint8_t fb[SSD1306_DEV_FBSIZE];
+
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+  /* Columns [dirtystart, dirtyend) of each page written by putrun() since
+   * the last flush, the page is clean when dirtyend is 0.
+   */
+
+  struct work_s work;
+  uint8_t dirtystart[SSD1306_DEV_PAGES];
+  uint8_t dirtyend[SSD1306_DEV_PAGES];
+#endif
 };
 
 /**************************************************************************************
@@ -355,6 +370,9 @@ static int ssd1306_putrun(fb_coord_t row, fb_coord_t col,
                           FAR const uint8_t *buffer, size_t npixels);
 static int ssd1306_getrun(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
                           size_t npixels);
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+static void ssd1306_flush(FAR void *arg);
+#endif
 
 /* LCD Configuration */
 
@@ -560,7 +578,11 @@ static int ssd1306_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buf
   FAR struct ssd1306_dev_s *priv = (FAR struct ssd1306_dev_s *)&g_oleddev;
   FAR uint8_t *fbptr;
   FAR uint8_t *ptr;
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+  irqstate_t flags;
+#else
   uint8_t devcol;
+#endif
   uint8_t fbmask;
   uint8_t page;
   uint8_t usrmask;
@@ -703,6 +725,32 @@ static int ssd1306_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buf
 #endif
     }
 
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+  /* Only extend the dirty area of the page, the runs of a redraw are sent
+   * together by ssd1306_flush() once NX is done with them.
+   */
+
+  flags = irqsave();
+  if (priv->dirtyend[page] == 0 || col < priv->dirtystart[page])
+    {
+      priv->dirtystart[page] = col;
+    }
+
+  if (col + pixlen > priv->dirtyend[page])
+    {
+      priv->dirtyend[page] = col + pixlen;
+    }
+
+  irqrestore(flags);
+
+  if (work_available(&priv->work))
+    {
+      (void)work_queue(LPWORK, &priv->work, ssd1306_flush, priv,
+                       MSEC2TICK(CONFIG_LCD_DEFERRED_DELAY));
+    }
+
+  return OK;
+#else
   /* Offset the column position to account for smaller horizontal
    * display range.
    */
@@ -741,11 +789,77 @@ static int ssd1306_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buf
   SPI_SELECT(priv->spi, SPIDEV_DISPLAY, false);
   ssd1306_unlock(priv->spi);
   return OK;
+#endif
 }
 #else
 #  error "Configuration not implemented"
 #endif
 
+/**************************************************************************************
+ * Name:  ssd1306_flush
+ *
+ * Description:
+ *   Send the dirty part of each page of the shadow frame buffer to the display, in
+ *   one block per page and with a single lock of the SPI bus.
+ *
+ * Input Parameters:
+ *   arg - Reference to private driver structure
+ *
+ **************************************************************************************/
+
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+static void ssd1306_flush(FAR void *arg)
+{
+  FAR struct ssd1306_dev_s *priv = (FAR struct ssd1306_dev_s *)arg;
+  uint8_t start[SSD1306_DEV_PAGES];
+  uint8_t end[SSD1306_DEV_PAGES];
+  irqstate_t flags;
+  unsigned int page;
+  uint8_t devcol;
+
+  /* Runs written from now on will be picked by the next flush */
+
+  flags = irqsave();
+  memcpy(start, priv->dirtystart, sizeof(start));
+  memcpy(end, priv->dirtyend, sizeof(end));
+  memset(priv->dirtyend, 0, sizeof(priv->dirtyend));
+  irqrestore(flags);
+
+  /* Lock and select device */
+
+  ssd1306_lock(priv->spi);
+  SPI_SELECT(priv->spi, SPIDEV_DISPLAY, true);
+
+  for (page = 0; page < SSD1306_DEV_PAGES; page++)
+    {
+      if (end[page] == 0)
+        {
+          continue;
+        }
+
+      devcol = start[page] + SSD1306_DEV_XOFFSET;
+
+      /* Select command transfer and set the starting position */
+
+      SPI_CMDDATA(priv->spi, SPIDEV_DISPLAY, true);
+      SPI_SEND(priv->spi, SSD1306_SETCOLL(devcol & 0x0f));
+      SPI_SEND(priv->spi, SSD1306_SETCOLH(devcol >> 4));
+      SPI_SEND(priv->spi, SSD1306_PAGEADDR(page));
+
+      /* Select data transfer and send the dirty columns */
+
+      SPI_CMDDATA(priv->spi, SPIDEV_DISPLAY, false);
+      (void)SPI_SNDBLOCK(priv->spi, &priv->fb[page * SSD1306_DEV_XRES + start[page]],
+                         end[page] - start[page]);
+    }
+
+  /* De-select and unlock the device */
+
+  SPI_SELECT(priv->spi, SPIDEV_DISPLAY, false);
+  ssd1306_unlock(priv->spi);
+}
+#endif
+
 /**************************************************************************************
  * Name:  ssd1306_getrun
  *
@@ -62,6 +62,12 @@
 #include <nuttx/lcd/lcd.h>
 #include <nuttx/lcd/st7567.h>
 
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+#  include <nuttx/clock.h>
+#  include <nuttx/wqueue.h>
+#  include <arch/irq.h>
+#endif
+
 #include "st7567.h"
 
 /**************************************************************************************
@@ -238,6 +244,16 @@ struct st7567_dev_s
   */
 
   uint8_t fb[ST7567_FBSIZE];
+
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+  /* Columns [dirtystart, dirtyend) of each page written by putrun() since
+   * the last flush, the page is clean when dirtyend is 0.
+   */
+
+  struct work_s work;
+  uint8_t dirtystart[ST7567_YSTRIDE];
+  uint8_t dirtyend[ST7567_YSTRIDE];
+#endif
 };
 
 /**************************************************************************************
@@ -260,6 +276,9 @@ static int st7567_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
                      size_t npixels);
 static int st7567_getrun(fb_coord_t row, fb_coord_t col, FAR uint8_t *buffer,
                      size_t npixels);
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+static void st7567_flush(FAR void *arg);
+#endif
 
 /* LCD Configuration */
 
@@ -455,6 +474,9 @@ static int st7567_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
   FAR struct st7567_dev_s *priv = &g_st7567dev;
   FAR uint8_t *fbptr;
   FAR uint8_t *ptr;
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+  irqstate_t flags;
+#endif
   uint8_t fbmask;
   uint8_t page;
   uint8_t usrmask;
@@ -554,6 +576,30 @@ static int st7567_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
 #endif
     }
 
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+  /* Only extend the dirty area of the page, the runs of a redraw are sent
+   * together by st7567_flush() once NX is done with them.
+   */
+
+  flags = irqsave();
+  if (priv->dirtyend[page] == 0 || col < priv->dirtystart[page])
+    {
+      priv->dirtystart[page] = col;
+    }
+
+  if (col + pixlen > priv->dirtyend[page])
+    {
+      priv->dirtyend[page] = col + pixlen;
+    }
+
+  irqrestore(flags);
+
+  if (work_available(&priv->work))
+    {
+      (void)work_queue(LPWORK, &priv->work, st7567_flush, priv,
+                       MSEC2TICK(CONFIG_LCD_DEFERRED_DELAY));
+    }
+#else
   /* Select and lock the device */
 
   st7567_select(priv->spi);
@@ -579,9 +625,70 @@ static int st7567_putrun(fb_coord_t row, fb_coord_t col, FAR const uint8_t *buff
   /* Unlock and de-select the device */
 
   st7567_deselect(priv->spi);
+#endif
   return OK;
 }
 
+/**************************************************************************************
+ * Name:  st7567_flush
+ *
+ * Description:
+ *   Send the dirty part of each page of the shadow frame buffer to the display, in
+ *   one block per page and with a single selection of the device.
+ *
+ * Input Parameters:
+ *   arg - Reference to private driver structure
+ *
+ **************************************************************************************/
+
+#ifdef CONFIG_LCD_DEFERRED_UPDATE
+static void st7567_flush(FAR void *arg)
+{
+  FAR struct st7567_dev_s *priv = (FAR struct st7567_dev_s *)arg;
+  uint8_t start[ST7567_YSTRIDE];
+  uint8_t end[ST7567_YSTRIDE];
+  irqstate_t flags;
+  unsigned int page;
+
+  /* Runs written from now on will be picked by the next flush */
+
+  flags = irqsave();
+  memcpy(start, priv->dirtystart, sizeof(start));
+  memcpy(end, priv->dirtyend, sizeof(end));
+  memset(priv->dirtyend, 0, sizeof(priv->dirtyend));
+  irqrestore(flags);
+
+  /* Select and lock the device */
+
+  st7567_select(priv->spi);
+
+  for (page = 0; page < ST7567_YSTRIDE; page++)
+    {
+      if (end[page] == 0)
+        {
+          continue;
+        }
+
+      /* Select command transfer and set the starting position */
+
+      SPI_CMDDATA(priv->spi, SPIDEV_DISPLAY, true);
+      (void)SPI_SEND(priv->spi, ST7567_SETPAGESTART + page);
+      (void)SPI_SEND(priv->spi, ST7567_SETCOLL + (start[page] & 0x0f));
+      (void)SPI_SEND(priv->spi, ST7567_SETCOLH + (start[page] >> 4));
+
+      /* Select data transfer and send the dirty columns */
+
+      SPI_CMDDATA(priv->spi, SPIDEV_DISPLAY, false);
+      (void)SPI_SNDBLOCK(priv->spi, &priv->fb[page * ST7567_XRES + start[page]],
+                         end[page] - start[page]);
+    }
+
+  /* Unlock and de-select the device */
+
+  st7567_deselect(priv->spi);
+}
+#endif
+
 /**************************************************************************************
  * Name:  st7567_getrun
  *
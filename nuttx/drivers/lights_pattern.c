@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Keyframe player for lights and vibrators.  The host uploads a pattern
+ * once and the keyframes are then played from a watchdog timer, only
+ * calling the output callback of the driver at each level change, instead
+ * of the host sending a request, or a thread waking up, for every change.
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <arch/irq.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/lights_pattern.h>
+
+#ifndef CONFIG_LIGHTS_PATTERN_RAMP_MS
+#define CONFIG_LIGHTS_PATTERN_RAMP_MS 20
+#endif
+
+static void lights_pattern_timeout(int argc, uint32_t arg, ...);
+
+static void lights_pattern_set(struct lights_pattern *pattern, uint8_t level)
+{
+    if (level != pattern->level || pattern->resync) {
+        pattern->level = level;
+        pattern->resync = false;
+        pattern->output(level, pattern->priv);
+    }
+}
+
+/* Keyframes last at least one tick, even with a duration of 0 */
+static void lights_pattern_arm(struct lights_pattern *pattern,
+                               unsigned int msec)
+{
+    int delay = MSEC2TICK(msec);
+
+    wd_start(&pattern->wdog, delay > 0 ? delay : 1, lights_pattern_timeout,
+             1, (uint32_t)pattern);
+}
+
+/* Start playing the current keyframe */
+static void lights_pattern_enter(struct lights_pattern *pattern)
+{
+    const struct lights_keyframe *frame = &pattern->frames[pattern->frame];
+
+    pattern->step = 0;
+    pattern->nsteps = 0;
+
+    if ((frame->flags & LIGHTS_KEYFRAME_RAMP) &&
+        frame->duration_ms >= 2 * CONFIG_LIGHTS_PATTERN_RAMP_MS &&
+        frame->level != pattern->level) {
+        pattern->from = pattern->level;
+        pattern->nsteps = frame->duration_ms / CONFIG_LIGHTS_PATTERN_RAMP_MS;
+        lights_pattern_arm(pattern, CONFIG_LIGHTS_PATTERN_RAMP_MS);
+        return;
+    }
+
+    lights_pattern_set(pattern, frame->level);
+    lights_pattern_arm(pattern, frame->duration_ms);
+}
+
+static void lights_pattern_timeout(int argc, uint32_t arg, ...)
+{
+    struct lights_pattern *pattern = (struct lights_pattern *)arg;
+    const struct lights_keyframe *frame = &pattern->frames[pattern->frame];
+    int delta;
+
+    if (!pattern->active)
+        return;
+
+    if (pattern->step < pattern->nsteps) {
+        pattern->step++;
+        delta = (int)frame->level - (int)pattern->from;
+        lights_pattern_set(pattern, pattern->from +
+                           delta * pattern->step / pattern->nsteps);
+        if (pattern->step < pattern->nsteps) {
+            lights_pattern_arm(pattern, CONFIG_LIGHTS_PATTERN_RAMP_MS);
+            return;
+        }
+    }
+
+    if (++pattern->frame == pattern->nframes) {
+        pattern->frame = 0;
+        if (pattern->repeat && --pattern->repeat == 0) {
+            /* Done, the output keeps the level of the last keyframe */
+            pattern->active = false;
+            return;
+        }
+    }
+
+    lights_pattern_enter(pattern);
+}
+
+/**
+ * Initialize a pattern player
+ *
+ * @param pattern player to initialize
+ * @param output callback setting the output level, from interrupt context
+ * @param priv argument of the callback
+ */
+void lights_pattern_init(struct lights_pattern *pattern,
+                         lights_pattern_output output, void *priv)
+{
+    memset(pattern, 0, sizeof(*pattern));
+    wd_static(&pattern->wdog);
+    pattern->output = output;
+    pattern->priv = priv;
+}
+
+/**
+ * Play a pattern, replacing the one being played if any
+ *
+ * @param pattern player
+ * @param frames keyframes, copied
+ * @param nframes number of keyframes
+ * @param repeat number of times the keyframes are played, 0 for ever
+ * @return 0 on success, -EINVAL if there are no or too many keyframes
+ */
+int lights_pattern_start(struct lights_pattern *pattern,
+                         const struct lights_keyframe *frames,
+                         unsigned int nframes, uint16_t repeat)
+{
+    irqstate_t flags;
+
+    if (!nframes || nframes > CONFIG_LIGHTS_PATTERN_MAX_FRAMES)
+        return -EINVAL;
+
+    flags = irqsave();
+    wd_cancel(&pattern->wdog);
+    memcpy(pattern->frames, frames, nframes * sizeof(*frames));
+    pattern->nframes = nframes;
+    pattern->frame = 0;
+    pattern->repeat = repeat;
+    pattern->active = true;
+    /* The driver may have changed the output since the last pattern */
+    pattern->resync = true;
+    lights_pattern_enter(pattern);
+    irqrestore(flags);
+
+    return 0;
+}
+
+/**
+ * Stop playing
+ *
+ * @param pattern player
+ * @param off true to switch the output off, false to keep the current level
+ */
+void lights_pattern_stop(struct lights_pattern *pattern, bool off)
+{
+    irqstate_t flags;
+
+    flags = irqsave();
+    wd_cancel(&pattern->wdog);
+    pattern->active = false;
+    if (off)
+        lights_pattern_set(pattern, 0);
+    irqrestore(flags);
+}
+
+/**
+ * Check if a pattern is being played
+ *
+ * @param pattern player
+ * @return true until the last repetition is done or the player is stopped
+ */
+bool lights_pattern_active(struct lights_pattern *pattern)
+{
+    return pattern->active;
+}
@@ -38,6 +38,7 @@
 #include <nuttx/arch.h>
 #include <nuttx/config.h>
 #include <nuttx/ring_buf.h>
+#include <nuttx/spsc.h>
 #include <nuttx/unipro/unipro.h>
 #include <nuttx/list.h>
 
@@ -46,25 +47,31 @@
 #include "transport.h"
 
 /* need a ring buffer and a thread to switch from interrupt context to thread
- * context to further process the response or request.
+ * context to further process the response or request. Filled entries are
+ * handed to the thread through a lock-free queue, which only wakes the thread
+ * when it is idle, so the rx handler never disables interrupts.
+ *
+ * The entries have no data area of their own: each one points at the unipro
+ * rx buffer the message arrived in, which is freed once the thread is done
+ * with it.
  */
 #define BUFF_SIZE 8
 static pthread_t rx_thread_handler;
-static pthread_t tx_thread_handler;
 
-//control flag of rx interrupt handler and rx/tx thread. 0 - stop
+//control flag of rx interrupt handler and rx thread. 0 - stop
 static volatile uint32_t ipc_control;
 
 struct ipc_ring_buffer_s
 {
     struct ring_buf* ring_buffer;
-    struct ring_buf* volatile rbc; //consumer
-    struct ring_buf* volatile rbp; //producer
-    sem_t sem;
+    struct ring_buf* rbp; //producer
+    struct spsc_queue queue; //filled entries, in order
+    void *slots[BUFF_SIZE];
 };
 static struct ipc_ring_buffer_s rx_ring_buffer;
-static struct ipc_ring_buffer_s tx_ring_buffer;
-static pthread_mutex_t tx_producer_lock;
+
+//serializes the senders, a packet is written to the cport in one go
+static pthread_mutex_t tx_lock;
 
 /*
  * Provide the max data size which can be sent by ipc_request_sync.
@@ -74,11 +81,10 @@ size_t ipc_get_sync_data_sz(void)
     return (IPC_PACKET_MAX_SIZE-sizeof(struct response_s));
 }
 
-/* Receive ipc request/response in thread handler */
-static void *unipro_rx_thread_func(void *data)
+/* Handle one received ipc request/response */
+static void unipro_rx_process(struct ring_buf *rb)
 {
     uint32_t *pkg_type;
-    struct ring_buf *rb;
     size_t pkt_size;
     void *pkt_data;
 #ifdef CONFIG_MHB_IPC_CLIENT
@@ -89,54 +95,70 @@ static void *unipro_rx_thread_func(void *data)
     struct request_s *req_msg;
 #endif
 
-    while (1) {
-        sem_wait(&rx_ring_buffer.sem);
-        if (!ipc_control) break;
+    pkt_size = ring_buf_len(rb);
+    if (pkt_size < sizeof(uint32_t)) {
+        IPC_ERR("invalid packet received bytes %d\n", pkt_size);
+        return;
+    }
 
-        rb = rx_ring_buffer.rbc;
-        if (!ring_buf_is_consumers(rb)) {
-            IPC_ERR("emtpy ring buffer\n");
-            continue;
-        }
-        pkt_size = ring_buf_len(rb);
-        if (pkt_size < sizeof(uint32_t)) {
-            IPC_ERR("invalid packet received bytes %d\n", pkt_size);
-        } else {
-            pkt_data = ring_buf_get_data(rb);
-            pkg_type = (uint32_t*) pkt_data;
-            if (*pkg_type == IPC_PACKET_RESPONSE_TYPE) {
+    pkt_data = ring_buf_get_data(rb);
+    pkg_type = (uint32_t*) pkt_data;
+    if (*pkg_type == IPC_PACKET_RESPONSE_TYPE) {
 #ifdef CONFIG_MHB_IPC_CLIENT
-                resp_msg = (struct response_s*)pkt_data;
-                if (pkt_size ==
-                        sizeof(*resp_msg) + resp_msg->param_len) {
-                    ipc_handle_response(resp_msg);
-                } else {
-                    IPC_ERR("wrong response size\n");
-                }
+        resp_msg = (struct response_s*)pkt_data;
+        if (pkt_size == sizeof(*resp_msg) + resp_msg->param_len) {
+            ipc_handle_response(resp_msg);
+        } else {
+            IPC_ERR("wrong response size\n");
+        }
 #else
-                IPC_ERR("receive unwanted response\n");
+        IPC_ERR("receive unwanted response\n");
 #endif
-            } else if (*pkg_type == IPC_PACKET_REQUEST_TYPE) {
+    } else if (*pkg_type == IPC_PACKET_REQUEST_TYPE) {
 #ifdef CONFIG_MHB_IPC_SERVER
-                req_msg = (struct request_s*)pkt_data;
-                if (pkt_size == sizeof(*req_msg) + req_msg->param_len) {
-                    ipc_handle_request(req_msg);
-                } else {
-                    IPC_ERR("wrong request szie\n");
-                }
+        req_msg = (struct request_s*)pkt_data;
+        if (pkt_size == sizeof(*req_msg) + req_msg->param_len) {
+            ipc_handle_request(req_msg);
+        } else {
+            IPC_ERR("wrong request szie\n");
+        }
 #else
-                IPC_ERR("receive unwanted request\n");
+        IPC_ERR("receive unwanted request\n");
 #endif
-            } else {
-                IPC_ERR("ipc: unknown packet type\n");
-            }
+    } else {
+        IPC_ERR("ipc: unknown packet type\n");
+    }
+}
+
+/* Receive ipc request/response in thread handler */
+static void *unipro_rx_thread_func(void *data)
+{
+    struct ring_buf *rb;
+
+    while (1) {
+        spsc_wait(&rx_ring_buffer.queue);
+        if (!ipc_control) break;
+
+        while ((rb = spsc_pop(&rx_ring_buffer.queue)) != NULL) {
+            unipro_rx_process(rb);
+            unipro_rxbuf_free(CONFIG_MHB_IPC_CPORT_ID, ring_buf_get_buf(rb));
+            ring_buf_reset(rb);
+            ring_buf_pass(rb);
         }
+    }
+    return NULL;
+}
+
+/* Release the unipro buffers still queued when the rx thread is stopped */
+static void unipro_rx_flush(void)
+{
+    struct ring_buf *rb;
 
-        rx_ring_buffer.rbc = ring_buf_get_next(rb);
+    while ((rb = spsc_pop(&rx_ring_buffer.queue)) != NULL) {
+        unipro_rxbuf_free(CONFIG_MHB_IPC_CPORT_ID, ring_buf_get_buf(rb));
         ring_buf_reset(rb);
         ring_buf_pass(rb);
     }
-    return NULL;
 }
 
 /* Receive ipc request/response (in interrupt context) */
@@ -155,12 +177,14 @@ static int unipro_rx_irq_handler(unsigned int cport, void *data, size_t size)
     } else {
         rb = rx_ring_buffer.rbp;
         if (ring_buf_is_producers(rb)) {
-            memcpy(ring_buf_get_data(rb), data, size);
+            //hand the unipro buffer itself over, freed by the rx thread
+            ring_buf_init(rb, data, 0, size);
             ring_buf_put(rb, size);
             ring_buf_pass(rb);
 
             rx_ring_buffer.rbp = ring_buf_get_next(rb);
-            sem_post(&rx_ring_buffer.sem);
+            spsc_push(&rx_ring_buffer.queue, rb);
+            return 0;
         } else {
             IPC_IRQ_ERR("no ring buffer to hold incoming message\n");
         }
@@ -171,65 +195,24 @@ static int unipro_rx_irq_handler(unsigned int cport, void *data, size_t size)
     return 0;
 }
 
-static void *unipro_tx_thread_func(void *data)
-{
-    struct ring_buf *rb;
-    size_t pkt_size;
-    void *pkt_data;
-    int retval;
-
-    while (1) {
-        sem_wait(&tx_ring_buffer.sem);
-        if (!ipc_control) break;
-
-        rb = tx_ring_buffer.rbc;
-        if (!ring_buf_is_consumers(rb)) {
-            IPC_ERR("empty ring buffer\n");
-            continue;
-        }
-        pkt_size = ring_buf_len(rb);
-        pkt_data = ring_buf_get_data(rb);
-
-        IPC_DBG("send %d bytes\n", pkt_size);
-        retval = unipro_send(CONFIG_MHB_IPC_CPORT_ID, pkt_data, pkt_size);
-        if (retval != 0) {
-            IPC_ERR("failed to send ipc packet\n");
-        }
-        tx_ring_buffer.rbc = ring_buf_get_next(rb);
-        ring_buf_reset(rb);
-        ring_buf_pass(rb);
-    }
-
-    return NULL;
-}
-
 int send_ipc_packet(void *hdr, size_t hdr_len,
         void *payload, size_t payload_size)
 {
-    struct ring_buf *rb;
-    char *buf;
+    const void *bufs[2] = { hdr, payload };
+    const size_t lens[2] = { hdr_len, payload_size };
     int retval;
 
-    retval = -EINVAL;
-    pthread_mutex_lock(&tx_producer_lock);
-    rb = tx_ring_buffer.rbp;
-    if (ring_buf_is_producers(rb)) {
-        //can't make use of ring buffer's head room, since
-        //ipc request/response have different header
-        buf = ring_buf_get_data(rb);
-        memcpy(buf, hdr, hdr_len);
-        buf += hdr_len;
-        memcpy(buf, payload, payload_size);
-        ring_buf_put(rb, hdr_len + payload_size);
-
-        tx_ring_buffer.rbp = ring_buf_get_next(rb);
-        ring_buf_pass(rb);
-        sem_post(&tx_ring_buffer.sem);
-        retval = 0;
-    } else {
-        IPC_ERR("no ring buffer to hold outgoing message\n");
+    IPC_DBG("send %d bytes\n", hdr_len + payload_size);
+
+    //header and payload are gathered straight into the cport
+    pthread_mutex_lock(&tx_lock);
+    retval = unipro_sendv(CONFIG_MHB_IPC_CPORT_ID, bufs, lens,
+                          payload_size ? 2 : 1);
+    pthread_mutex_unlock(&tx_lock);
+
+    if (retval != 0) {
+        IPC_ERR("failed to send ipc packet\n");
     }
-    pthread_mutex_unlock(&tx_producer_lock);
 
     return retval;
 }
@@ -244,15 +227,15 @@ int ipc_init(void)
 {
     int retval;
 
-    //rx initialize
-    rx_ring_buffer.ring_buffer = ring_buf_alloc_ring(BUFF_SIZE,
-        0, IPC_PACKET_MAX_SIZE, 0, NULL, NULL, NULL);
+    //rx initialize, entries point at the unipro rx buffers
+    rx_ring_buffer.ring_buffer = ring_buf_alloc_ring_contig(BUFF_SIZE,
+        0, 0, 0, 0, NULL, NULL, NULL);
     if (rx_ring_buffer.ring_buffer == NULL) {
         IPC_ERR("ipc rx ring buffer alloc failed\n");
         return -ENOMEM;
     }
-    rx_ring_buffer.rbc = rx_ring_buffer.rbp = rx_ring_buffer.ring_buffer;
-    sem_init(&rx_ring_buffer.sem, 0, 0);
+    rx_ring_buffer.rbp = rx_ring_buffer.ring_buffer;
+    spsc_init(&rx_ring_buffer.queue, rx_ring_buffer.slots, BUFF_SIZE);
 
     retval = pthread_create(&rx_thread_handler,
             NULL, unipro_rx_thread_func, NULL);
@@ -262,28 +245,10 @@ int ipc_init(void)
     }
 
     //tx initialize
-    tx_ring_buffer.ring_buffer = ring_buf_alloc_ring(BUFF_SIZE,
-        0, IPC_PACKET_MAX_SIZE, 0, NULL, NULL, NULL);
-    if (tx_ring_buffer.ring_buffer == NULL) {
-        IPC_ERR("ipc tx ring buffer alloc failed\n");
-        retval = -ENOMEM;
-        goto tx_ring_buffer_init_err;
-    }
-    tx_ring_buffer.rbc = tx_ring_buffer.rbp = tx_ring_buffer.ring_buffer;
-    sem_init(&tx_ring_buffer.sem, 0, 0);
-
-    retval = pthread_create(&tx_thread_handler,
-            NULL, unipro_tx_thread_func, NULL);
-
+    retval = pthread_mutex_init(&tx_lock, NULL);
     if (retval != 0) {
-        IPC_ERR("failed to create tx handler thread\n");
-        goto tx_thread_init_err;
-    }
-
-    retval = pthread_mutex_init(&tx_producer_lock, NULL);
-    if (retval != 0) {
-        IPC_ERR("failed to init tx producer lock\n");
-        goto tx_producer_lock_err;
+        IPC_ERR("failed to init tx lock\n");
+        goto tx_lock_err;
     }
 
 #ifdef CONFIG_MHB_IPC_CLIENT
@@ -313,19 +278,13 @@ server_init_err:
     ipc_client_deinit();
 client_init_err:
 #endif
-    pthread_mutex_destroy(&tx_producer_lock);
-tx_producer_lock_err:
-    sem_post(&tx_ring_buffer.sem);//quit tx thread
-    pthread_join(tx_thread_handler, NULL);
-tx_thread_init_err:
-    ring_buf_free_ring(tx_ring_buffer.ring_buffer, NULL, NULL);
-    sem_destroy(&tx_ring_buffer.sem);
-tx_ring_buffer_init_err:
-    sem_post(&rx_ring_buffer.sem);//quit rx thread
+    pthread_mutex_destroy(&tx_lock);
+tx_lock_err:
+    spsc_kick(&rx_ring_buffer.queue);//quit rx thread
     pthread_join(rx_thread_handler, NULL);
 rx_thread_init_err:
     ring_buf_free_ring(rx_ring_buffer.ring_buffer, NULL, NULL);
-    sem_destroy(&rx_ring_buffer.sem);
+    spsc_deinit(&rx_ring_buffer.queue);
 
     return retval;
 }
@@ -369,15 +328,11 @@ void ipc_deinit(void)
 #endif
     ipc_control = 0;
 
-    sem_post(&rx_ring_buffer.sem);//wake to exit thread
+    spsc_kick(&rx_ring_buffer.queue);//wake to exit thread
     pthread_join(rx_thread_handler, NULL);
-    sem_destroy(&rx_ring_buffer.sem);
+    unipro_rx_flush();
+    spsc_deinit(&rx_ring_buffer.queue);
     ring_buf_free_ring(rx_ring_buffer.ring_buffer, NULL, NULL);
 
-    sem_post(&tx_ring_buffer.sem);//wake to exit thread
-    pthread_join(tx_thread_handler, NULL);
-    sem_destroy(&tx_ring_buffer.sem);
-    ring_buf_free_ring(tx_ring_buffer.ring_buffer, NULL, NULL);
-
-    pthread_mutex_destroy(&tx_producer_lock);
+    pthread_mutex_destroy(&tx_lock);
 }
@@ -102,8 +102,9 @@ void ipc_client_deinit(void);
 void ipc_server_deinit(void);
 
 /*
- * send ipc packet
- * return 0 - work delivered to tx thread,otherwise fails
+ * send ipc packet, header and payload are sent as one unipro message
+ * without being copied together first
+ * return 0 - packet sent,otherwise fails
  */
 int send_ipc_packet(void *hdr, size_t hdr_len,
         void *payload, size_t payload_size);
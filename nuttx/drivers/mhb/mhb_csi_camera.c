@@ -62,6 +62,7 @@
 
 #define UNIPRO_RECOVER_RETRIES   2
 #define CTRL_RETRIES             5
+#define CTRL_CACHE_BUCKETS       16 /* power of 2 */
 #define MHB_CDSI_CAM_INSTANCE    0
 #define MHB_PCTRL_OP_TIMEOUT_NS  3000000000LL
 #define MHB_CDSI_OP_TIMEOUT_NS   1000000000LL
@@ -84,8 +85,10 @@ enum soc_status {
     SOC_ENABLED,
 };
 
+/* node is the replay order (oldest set first), hnode the hash bucket */
 struct cached_ctrls_node {
     struct list_head node;
+    struct list_head hnode;
     struct device *dev;
     uint32_t idx;
     uint8_t *ctrl_val;
@@ -110,11 +113,16 @@ struct mhb_camera_s
     pthread_cond_t slave_cond;
     pthread_cond_t cdsi_cond;
     uint16_t mhb_wait_event;
+    uint8_t mhb_wait_done;
+    /* CSI config built for cdsi_frmival, reused by the next stream on */
+    const struct camera_ext_frmival_node *cdsi_frmival;
+    struct mhb_cdsi_config *cdsi_config;
     mhb_camera_notification_cb callbacks[MHB_CAM_MAX_CALLBACKS];
 };
 
 static struct mhb_camera_s s_mhb_camera;
 static LIST_DECLARE(cached_ctrl_list);
+static struct list_head cached_ctrl_hash[CTRL_CACHE_BUCKETS];
 
 static void mhb_cam_error_cb(int err);
 
@@ -355,6 +363,39 @@ int mhb_camera_i2c_write_reg(uint16_t i2c_addr, uint16_t regaddr,
     return ret;
 }
 
+int mhb_camera_i2c_write_regs1_16(uint16_t i2c_addr,
+                                  const struct mhb_camera_i2c_reg_array *regs,
+                                  size_t num)
+{
+    uint8_t buf[2 + CONFIG_MHB_CAMERA_I2C_BURST_MAX];
+    uint16_t regaddr;
+    size_t i = 0;
+    int len;
+    int ret;
+
+    while (i < num) {
+        regaddr = regs[i].reg_addr;
+        buf[0] = (regaddr >> 8) & 0xFF;
+        buf[1] = regaddr & 0xFF;
+
+        len = 0;
+        do {
+            buf[2 + len++] = regs[i++].data;
+        } while (i < num && len < CONFIG_MHB_CAMERA_I2C_BURST_MAX &&
+                 regs[i].reg_addr == (uint16_t)(regaddr + len));
+
+        CTRL_DBG("burst %d to %02x addr 0x%04x\n", len, i2c_addr, regaddr);
+        ret = mhb_camera_i2c_write(i2c_addr, buf, len + 2);
+        if (ret != 0) {
+            CAM_ERR("Failed i2c burst %d to %02x addr 0x%04x err %d\n",
+                    len, i2c_addr, regaddr, ret);
+            return ret;
+        }
+    }
+
+    return 0;
+}
+
 static void mhb_csi_camera_callback(uint8_t event)
 {
     int i;
@@ -399,14 +440,25 @@ int mhb_csi_camera_status_register_callback(
 }
 
 /* MHB Ops */
-static int _mhb_camera_wait_for_response(pthread_cond_t *cond,
-                                         uint16_t wait_event, char *str,
+
+/* Arm the wait for a response before the request is sent, with the mutex
+ * held. A response that arrives before _mhb_camera_wait_for_expected() is
+ * called is then recorded rather than dropped as unexpected.
+ */
+static void _mhb_camera_expect_response(uint16_t wait_event)
+{
+    s_mhb_camera.mhb_wait_event = wait_event;
+    s_mhb_camera.mhb_wait_done = 0;
+}
+
+static int _mhb_camera_wait_for_expected(pthread_cond_t *cond, char *str,
                                          uint64_t timeout)
 {
-    int result;
+    int result = 0;
     struct timespec expires;
 
     if (clock_gettime(CLOCK_REALTIME, &expires)) {
+        s_mhb_camera.mhb_wait_event = MHB_CAM_WAIT_EV_NONE;
         return -EBADF;
     }
 
@@ -414,8 +466,8 @@ static int _mhb_camera_wait_for_response(pthread_cond_t *cond,
     new_ns += timeout;
     nsec_to_timespec(new_ns, &expires);
 
-    s_mhb_camera.mhb_wait_event = wait_event;
-    result = pthread_cond_timedwait(cond, &s_mhb_camera.mutex, &expires);
+    while (!s_mhb_camera.mhb_wait_done && !result)
+        result = pthread_cond_timedwait(cond, &s_mhb_camera.mutex, &expires);
     if (!result)
         result = s_mhb_camera.mhb_wait_event;
     s_mhb_camera.mhb_wait_event = MHB_CAM_WAIT_EV_NONE;
@@ -428,6 +480,14 @@ static int _mhb_camera_wait_for_response(pthread_cond_t *cond,
     return result;
 }
 
+static int _mhb_camera_wait_for_response(pthread_cond_t *cond,
+                                         uint16_t wait_event, char *str,
+                                         uint64_t timeout)
+{
+    _mhb_camera_expect_response(wait_event);
+    return _mhb_camera_wait_for_expected(cond, str, timeout);
+}
+
 static int _mhb_camera_slave_status_callback(struct device *dev, uint32_t slave_status)
 {
     pthread_mutex_lock(&s_mhb_camera.mutex);
@@ -442,6 +502,7 @@ static int _mhb_camera_slave_status_callback(struct device *dev, uint32_t slave_
 
     if (s_mhb_camera.mhb_wait_event == (slave_status|MHB_CAM_PWRCTL_WAIT_MASK)) {
         s_mhb_camera.mhb_wait_event = MHB_CAM_WAIT_EV_NONE;
+        s_mhb_camera.mhb_wait_done = 1;
          pthread_cond_signal(&s_mhb_camera.slave_cond);
     }
     pthread_mutex_unlock(&s_mhb_camera.mutex);
@@ -539,6 +600,7 @@ static int _mhb_csi_camera_handle_msg(struct device *dev,
                 if (hdr->result == MHB_RESULT_SUCCESS) {
                     s_mhb_camera.mhb_wait_event = MHB_CAM_WAIT_EV_NONE;
                 }
+                s_mhb_camera.mhb_wait_done = 1;
                 pthread_cond_signal(&s_mhb_camera.cdsi_cond);
             } else {
                  CAM_ERR("ERROR Unexpected Rsp addr=%02x type=%02x result=%02x wait=0x%04x\n",
@@ -559,22 +621,39 @@ static int _mhb_csi_camera_handle_msg(struct device *dev,
 
 static int _mhb_csi_camera_start_stream(uint8_t *cfg, size_t cfg_size)
 {
-    if(MHB_CAM_DEV_OP(s_mhb_camera.cam_device, stream_configure)) {
-        return -EREMOTEIO;
-    }
+    int ret;
 
+    /* Send the CDSI config first and program the sensor mode while the
+     * APBE sets up its receiver, the response is collected afterwards.
+     */
     pthread_mutex_lock(&s_mhb_camera.mutex);
+    _mhb_camera_expect_response(MHB_CAM_CDSI_WAIT_MASK|MHB_TYPE_CDSI_CONFIG_RSP);
     if (_mhb_csi_camera_config_req(cfg, cfg_size)) {
         CAM_ERR("ERROR: Send Config Failed\n");
+        s_mhb_camera.mhb_wait_event = MHB_CAM_WAIT_EV_NONE;
         pthread_mutex_unlock(&s_mhb_camera.mutex);
         return -EIO;
     }
+    pthread_mutex_unlock(&s_mhb_camera.mutex);
 
-    if (_mhb_camera_wait_for_response(&s_mhb_camera.cdsi_cond,
-                                  MHB_CAM_CDSI_WAIT_MASK|MHB_TYPE_CDSI_CONFIG_RSP,
-                                  "CDSI CONFIG", MHB_CDSI_OP_TIMEOUT_NS)) {
+    ret = MHB_CAM_DEV_OP(s_mhb_camera.cam_device, stream_configure);
+
+    pthread_mutex_lock(&s_mhb_camera.mutex);
+    if (_mhb_camera_wait_for_expected(&s_mhb_camera.cdsi_cond,
+                                      "CDSI CONFIG", MHB_CDSI_OP_TIMEOUT_NS)) {
         pthread_mutex_unlock(&s_mhb_camera.mutex);
-        return -EIO;
+        return ret ? -EREMOTEIO : -EIO;
+    }
+
+    if (ret) {
+        /* sensor failed, do not leave the APBE configured */
+        CAM_ERR("ERROR: stream_configure Failed\n");
+        if (!_mhb_csi_camera_unconfig_req())
+            _mhb_camera_wait_for_response(&s_mhb_camera.cdsi_cond,
+                                  MHB_CAM_CDSI_WAIT_MASK|MHB_TYPE_CDSI_UNCONFIG_RSP,
+                                  "CDSI UNCONFIG", MHB_CDSI_OP_TIMEOUT_NS);
+        pthread_mutex_unlock(&s_mhb_camera.mutex);
+        return -EREMOTEIO;
     }
     pthread_mutex_unlock(&s_mhb_camera.mutex);
 
@@ -665,6 +744,7 @@ void mhb_camera_process_ctrl_cache(int dump)
                     CTRL_RETRIES - retries, CTRL_RETRIES);
         }
         list_del(&item->node);
+        list_del(&item->hnode);
         kmm_free(item->ctrl_val);
         kmm_free(item);
     }
@@ -765,35 +845,45 @@ mhb_camera_sm_event_t mhb_camera_power_off(void)
         s_mhb_camera.cam_i2c = NULL;
     }
 
+    s_mhb_camera.cdsi_frmival = NULL;
+
     return MHB_CAMERA_EV_NONE;
 }
 
-mhb_camera_sm_event_t mhb_camera_stream_on(void)
+/* Build the CSI config for the current user config. The result is kept
+ * until the next power off and reused while the frame interval node (which
+ * identifies format, frame size and rate) does not change.
+ */
+static struct mhb_cdsi_config *_mhb_camera_get_cdsi_config(void)
 {
     const struct camera_ext_format_db *db = camera_ext_get_format_db();
     const struct camera_ext_format_user_config *cfg = camera_ext_get_user_config();
     const struct camera_ext_format_node *fmt;
     const struct camera_ext_frmsize_node *frmsize;
+    const struct camera_ext_frmival_node *frmival;
     struct mhb_cdsi_config *cdsi_config;
-    int retry;
 
-    CAM_DBG("\n");
+    frmival = get_current_frmival_node(db, cfg);
+    if (frmival != NULL && frmival == s_mhb_camera.cdsi_frmival)
+        return s_mhb_camera.cdsi_config;
+
+    s_mhb_camera.cdsi_frmival = NULL;
 
     fmt = get_current_format_node(db, cfg);
     if (fmt == NULL) {
         CAM_ERR("Failed to get current format\n");
-        goto failed_stream_on;
+        return NULL;
     }
 
     frmsize = get_current_frmsize_node(db, cfg);
     if (frmsize == NULL) {
         CAM_ERR("Failed to get current frame size\n");
-        goto failed_stream_on;
+        return NULL;
     }
 
     if (MHB_CAM_DEV_OP(s_mhb_camera.cam_device, get_csi_config, (void*)&cdsi_config)) {
         CAM_ERR("Failed to get CSI Params\n");
-        goto failed_stream_on;
+        return NULL;
     }
 
     switch(fmt->fourcc) {
@@ -820,12 +910,27 @@ mhb_camera_sm_event_t mhb_camera_stream_on(void)
             cdsi_config->bpp = 8;
         default:
             CAM_ERR("Unsupported format 0x%x\n", fmt->fourcc);
-            goto failed_stream_on;
+            return NULL;
     }
 
     cdsi_config->width = frmsize->width;
     cdsi_config->height = frmsize->height;
 
+    s_mhb_camera.cdsi_frmival = frmival;
+    s_mhb_camera.cdsi_config = cdsi_config;
+    return cdsi_config;
+}
+
+mhb_camera_sm_event_t mhb_camera_stream_on(void)
+{
+    struct mhb_cdsi_config *cdsi_config;
+    int retry;
+
+    CAM_DBG("\n");
+
+    cdsi_config = _mhb_camera_get_cdsi_config();
+    if (cdsi_config == NULL)
+        goto failed_stream_on;
 
     if (s_mhb_camera.apbe_config_state == APBE_CONFIGURED) {
 
@@ -990,6 +1095,7 @@ static int _camera_attach(void *arg, const void *data)
 static int _dev_probe(struct device *dev)
 {
     struct mhb_camera_s* mhb_camera = &s_mhb_camera;
+    int i;
     CAM_DBG("mhb_camera_csi\n");
 
     device_set_private(dev, (void*)mhb_camera);
@@ -1001,6 +1107,8 @@ static int _dev_probe(struct device *dev)
     pthread_mutex_init(&mhb_camera->mutex, NULL);
     pthread_mutex_init(&mhb_camera->i2c_mutex, NULL);
     pthread_mutex_init(&mhb_camera->ctrl_mutex, NULL);
+    for (i = 0; i < CTRL_CACHE_BUCKETS; i++)
+        list_init(&cached_ctrl_hash[i]);
 
     pthread_cond_init(&mhb_camera->slave_cond, NULL);
     pthread_cond_init(&mhb_camera->cdsi_cond, NULL);
@@ -1113,29 +1221,74 @@ static void mhb_cam_error_cb(int err) {
     _power_off(NULL);
 }
 
+static struct cached_ctrls_node *_mhb_camera_ext_ctrl_cache_find(
+    struct device *dev, uint32_t idx)
+{
+    struct list_head *bucket = &cached_ctrl_hash[idx & (CTRL_CACHE_BUCKETS - 1)];
+    struct list_head *iter;
+    struct cached_ctrls_node *item;
+
+    list_foreach(bucket, iter) {
+        item = list_entry(iter, struct cached_ctrls_node, hnode);
+        if (item->idx == idx && item->dev == dev)
+            return item;
+    }
+
+    return NULL;
+}
+
+/* Only the last value set for a control is kept: a repeated set replaces
+ * the cached value and moves the control to the end of the replay order.
+ */
 static int _mhb_camera_ext_ctrl_cache(struct device *dev,
     uint32_t idx, uint8_t *ctrl_val, uint32_t ctrl_val_size)
 {
     struct cached_ctrls_node *item;
+    uint8_t *val;
+    int ret = 0;
+
+    pthread_mutex_lock(&s_mhb_camera.ctrl_mutex);
+    item = _mhb_camera_ext_ctrl_cache_find(dev, idx);
+    if (item) {
+        if (item->ctrl_val_size != ctrl_val_size) {
+            val = kmm_malloc(ctrl_val_size);
+            if (!val) {
+                ret = -1;
+                goto out;
+            }
+            kmm_free(item->ctrl_val);
+            item->ctrl_val = val;
+            item->ctrl_val_size = ctrl_val_size;
+        }
+        memcpy(item->ctrl_val, ctrl_val, ctrl_val_size);
+        list_del(&item->node);
+        list_add(&cached_ctrl_list, &item->node);
+        goto out;
+    }
 
     item = kmm_malloc(sizeof(struct cached_ctrls_node));
-    if (!item) return -1;
+    if (!item) {
+        ret = -1;
+        goto out;
+    }
 
     item->ctrl_val = kmm_malloc(ctrl_val_size);
     if (!item->ctrl_val) {
         kmm_free(item);
-        return -1;
+        ret = -1;
+        goto out;
     }
 
     memcpy(item->ctrl_val, ctrl_val, ctrl_val_size);
     item->dev = dev;
     item->idx = idx;
     item->ctrl_val_size = ctrl_val_size;
-    pthread_mutex_lock(&s_mhb_camera.ctrl_mutex);
     list_add(&cached_ctrl_list, &item->node);
-    pthread_mutex_unlock(&s_mhb_camera.ctrl_mutex);
+    list_add(&cached_ctrl_hash[idx & (CTRL_CACHE_BUCKETS - 1)], &item->hnode);
 
-    return 0;
+out:
+    pthread_mutex_unlock(&s_mhb_camera.ctrl_mutex);
+    return ret;
 }
 
 static int _mhb_camera_ext_ctrl_set(struct device *dev,
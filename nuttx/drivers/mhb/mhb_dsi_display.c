@@ -120,6 +120,7 @@ enum {
     MHB_DSI_DISPLAY_STATE_STARTING,
     MHB_DSI_DISPLAY_STATE_ON,
     MHB_DSI_DISPLAY_STATE_BRIGHTNESS,
+    MHB_DSI_DISPLAY_STATE_PARTIAL,
     MHB_DSI_DISPLAY_STATE_STOPPING,
     MHB_DSI_DISPLAY_STATE_UNCONFIG_DCS,
     MHB_DSI_DISPLAY_STATE_UNCONFIG_DSI,
@@ -160,6 +161,12 @@ static struct mhb_dsi_display
     struct mhb_dsi_panel_info panel_info;
     struct display_dsi_config cfg;
 
+    /* Partial update window, double-buffered. window[window_active] is what
+       the panel currently addresses; the other one is staged until the APBE
+       acknowledges the DCS commands. A zero-sized window is the full frame. */
+    struct display_rect window[2];
+    uint8_t window_active;
+
     /* Link/APBE interface */
     struct device *slave_pwr_ctrl;
     uint8_t link_state;
@@ -542,6 +549,44 @@ int mhb_dsi_display_set_brightness(uint8_t brightness)
     return result;
 }
 
+static void _mhb_dsi_display_address_cmd(struct mhb_cdsi_cmd *cmd,
+    uint8_t dcs, uint16_t start, uint16_t end)
+{
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->ctype = MHB_CTYPE_LP_LONG;
+    cmd->dtype = MHB_DTYPE_DCS_LONG_WRITE;
+    cmd->length = 5;
+
+    /* DCS parameters go out MSB first; the FIFO words are little-endian. */
+    cmd->u.lpdata[0] = dcs | ((start >> 8) << 8) | ((start & 0xff) << 16) |
+        ((end >> 8) << 24);
+    cmd->u.lpdata[1] = end & 0xff;
+}
+
+static int _mhb_dsi_display_send_window_req(struct mhb_dsi_display *display,
+    const struct mhb_cdsi_config *cfg, const struct display_rect *window)
+{
+    struct mhb_cdsi_cmd cmds[2];
+    struct mhb_hdr hdr;
+    uint16_t x = 0, y = 0, width = cfg->width, height = cfg->height;
+
+    if (window->width && window->height) {
+        x = window->x;
+        y = window->y;
+        width = window->width;
+        height = window->height;
+    }
+
+    _mhb_dsi_display_address_cmd(&cmds[0], 0x2a, x, x + width - 1); /* set_column_address */
+    _mhb_dsi_display_address_cmd(&cmds[1], 0x2b, y, y + height - 1); /* set_page_address */
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.addr = MHB_ADDR_CDSI0;
+    hdr.type = MHB_TYPE_CDSI_WRITE_CMDS_REQ;
+
+    return device_mhb_send(display->mhb_dev, &hdr, (uint8_t *)cmds, sizeof(cmds), 0);
+}
+
 static int _mhb_dsi_display_send_control_req(struct mhb_dsi_display *display,
                                              uint8_t command)
 {
@@ -618,12 +663,25 @@ static int _mhb_dsi_display_mhb_handle_msg(struct device *dev,
             /* dcs-brightness complete */
             _mhb_dsi_display_signal_response(display);
             error = 0;
+        } else if (display->state == MHB_DSI_DISPLAY_STATE_PARTIAL) {
+            display->state = MHB_DSI_DISPLAY_STATE_ON;
+            if (hdr->result == MHB_RESULT_SUCCESS) {
+                /* Staged window is now live on the panel. */
+                display->window_active = !display->window_active;
+            } else {
+                dbg("ERROR: DCS window failed.\n");
+            }
+            /* dcs-partial complete */
+            _mhb_dsi_display_signal_response(display);
+            error = 0;
         }
         break;
     case MHB_TYPE_CDSI_CONTROL_RSP:
         if (display->state == MHB_DSI_DISPLAY_STATE_STARTING) {
             /* starting -> on */
             display->state = MHB_DSI_DISPLAY_STATE_ON;
+            /* The panel on-commands address the full frame. */
+            memset(display->window, 0, sizeof(display->window));
             /* state-unblank complete */
             _mhb_dsi_display_signal_response(display);
             error = 0;
@@ -926,6 +984,7 @@ static int mhb_dsi_display_get_state(struct device *dev, uint8_t *state)
     case MHB_DSI_DISPLAY_STATE_STARTING:
     case MHB_DSI_DISPLAY_STATE_ON:
     case MHB_DSI_DISPLAY_STATE_BRIGHTNESS:
+    case MHB_DSI_DISPLAY_STATE_PARTIAL:
         *state = DISPLAY_STATE_UNBLANK;
         break;
     }
@@ -1248,6 +1307,89 @@ static int mhb_dsi_display_set_state(struct device *dev, uint8_t state)
     return result;
 }
 
+static int mhb_dsi_display_set_partial(struct device *dev,
+        const struct display_rect *rect)
+{
+    int result;
+    const struct mhb_cdsi_config *cfg = NULL;
+    size_t cfg_size = 0;
+    struct display_rect *staged;
+    uint8_t staged_index;
+
+    struct mhb_dsi_display *display = device_get_private(dev);
+    if (!display) {
+        return -ENODEV;
+    }
+
+    result = _mhb_dsi_display_get_config(display->cdsi_instance,
+                &display->panel_info, &cfg, &cfg_size);
+    if (result || !cfg || !cfg_size) {
+        dbg("ERROR: failed to get config.\n");
+        return -EINVAL;
+    }
+
+    /* Video-mode panels have no frame memory to update partially. */
+    if (cfg->video_mode) {
+        return -EOPNOTSUPP;
+    }
+
+    MHB_DSI_LOCK(&display->sem);
+
+    MHB_DSI_DUMP_STATE(display);
+
+    if (display->state != MHB_DSI_DISPLAY_STATE_ON) {
+        dbg("ERROR: display not on\n");
+        MHB_DSI_UNLOCK(&display->sem);
+        return -EAGAIN;
+    }
+
+    staged_index = !display->window_active;
+    staged = &display->window[staged_index];
+    memset(staged, 0, sizeof(*staged));
+
+    if (rect && rect->width && rect->height) {
+        if ((uint32_t)rect->x + rect->width > cfg->width ||
+            (uint32_t)rect->y + rect->height > cfg->height) {
+            dbg("ERROR: invalid window %d,%d %dx%d\n",
+                rect->x, rect->y, rect->width, rect->height);
+            MHB_DSI_UNLOCK(&display->sem);
+            return -EINVAL;
+        }
+
+        /* A window covering the whole panel is the full frame. */
+        if (rect->width != cfg->width || rect->height != cfg->height) {
+            *staged = *rect;
+        }
+    }
+
+    /* Nothing to send if the panel already addresses this window. */
+    if (!memcmp(staged, &display->window[display->window_active],
+                sizeof(*staged))) {
+        MHB_DSI_UNLOCK(&display->sem);
+        return 0;
+    }
+
+    result = _mhb_dsi_display_send_window_req(display, cfg, staged);
+    if (result) {
+        dbg("ERROR: send window failed: %d\n", result);
+        MHB_DSI_UNLOCK(&display->sem);
+        return result;
+    }
+
+    display->state = MHB_DSI_DISPLAY_STATE_PARTIAL;
+
+    /* Release the lock before waiting for the response. */
+    MHB_DSI_UNLOCK(&display->sem);
+
+    result = _mhb_dsi_display_wait_for_response(display);
+    if (result) {
+        dbg("ERROR: partial failed: %d\n", result);
+        return result;
+    }
+
+    return display->window_active == staged_index ? 0 : -EIO;
+}
+
 static int mhb_dsi_display_register_callback(struct device *dev,
         display_notification_cb callback)
 {
@@ -1380,6 +1522,7 @@ const static struct device_display_type_ops mhb_dsi_display_ops = {
     .set_config = mhb_dsi_display_set_config,
     .get_state = mhb_dsi_display_get_state,
     .set_state = mhb_dsi_display_set_state,
+    .set_partial = mhb_dsi_display_set_partial,
     .register_callback = mhb_dsi_display_register_callback,
     .unregister_callback = mhb_dsi_display_unregister_callback,
 };
@@ -32,6 +32,7 @@
 #include <string.h>
 #include <unistd.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/device.h>
 #include <nuttx/device_usbtun.h>
 #include <nuttx/device_slave_pwrctrl.h>
@@ -47,6 +48,8 @@ struct usbtun_s {
     usbtun_status_cb cb;
     pthread_mutex_t mutex;
     pthread_cond_t cond;
+    uint32_t start_time;
+    struct usbtun_stats stats;
 };
 
 static struct usbtun_s *s_data = NULL;
@@ -78,6 +81,7 @@ static int _wait_for_response(struct usbtun_s *data) {
     if (ret) {
         /* timeout or other erros */
         lldbg("ERROR: wait error %d\n", -ret);
+        data->stats.timeouts++;
         return -ETIMEDOUT;
     }
 
@@ -91,13 +95,28 @@ static int _mhb_handle_msg(struct device *dev,
     }
 
     switch(hdr->type) {
+    case MHB_TYPE_HSIC_CONFIG_RSP:
+        if (hdr->result != MHB_RESULT_SUCCESS) {
+            lldbg("MHB HSIC Config RSP with failure\n");
+            s_data->stats.failures++;
+        }
+        break;
     case MHB_TYPE_HSIC_CONTROL_RSP:
         if (hdr->result != MHB_RESULT_SUCCESS) {
             lldbg("MHB HSIC Control RSP with failure\n");
+            s_data->stats.failures++;
         }
         _signal_response(s_data);
         break;
     case MHB_TYPE_HSIC_STATUS_NOT:
+        if (payload_length && *payload) {
+            s_data->stats.attaches++;
+            s_data->stats.attach_ms =
+                TICK2MSEC(clock_systimer() - s_data->start_time);
+        } else if (payload_length) {
+            s_data->stats.detaches++;
+        }
+
         if (payload_length && s_data->cb) {
             s_data->cb(dev, *payload);
         }
@@ -108,6 +127,28 @@ static int _mhb_handle_msg(struct device *dev,
 
     return 0;
 }
+
+#ifdef CONFIG_MHB_USBTUN_CONFIG
+static int _send_config(struct usbtun_s *data) {
+    struct mhb_hdr hdr;
+    struct mhb_hsic_config_req req;
+
+    hdr.addr = MHB_ADDR_HSIC;
+    hdr.type = MHB_TYPE_HSIC_CONFIG_REQ;
+    hdr.result = 0;
+
+    req.rx_bufs = CONFIG_MHB_USBTUN_RX_BUFS;
+#ifdef CONFIG_MHB_USBTUN_E2EFC
+    req.e2efc = 1;
+#else
+    req.e2efc = 0;
+#endif
+    req.rx_bufsize = CONFIG_MHB_USBTUN_RX_BUFSIZE;
+
+    return device_mhb_send(data->mhb_dev, &hdr, (const uint8_t *)&req, sizeof(req), 0);
+}
+#endif
+
 static int _slave_status_callback(struct device *dev, uint32_t slave_status) {
     struct mhb_hdr hdr;
     struct mhb_hsic_control_req req;
@@ -129,11 +170,22 @@ static int _slave_status_callback(struct device *dev, uint32_t slave_status) {
         device_mhb_register_receiver(s_data->mhb_dev, MHB_ADDR_HSIC,
                                      _mhb_handle_msg);
 
+#ifdef CONFIG_MHB_USBTUN_CONFIG
+        /* Tune the data plane before the tunneled CPorts are set up. A
+         * failure here is not fatal: the server defaults still work. */
+        if (_send_config(s_data)) {
+            lldbg("Failed to send HSIC config\n");
+        }
+#endif
+
         hdr.addr = MHB_ADDR_HSIC;
         hdr.type = MHB_TYPE_HSIC_CONTROL_REQ;
         hdr.result = 0;
         req.command = MHB_HSIC_COMMAND_START;
 
+        s_data->stats.starts++;
+        s_data->start_time = clock_systimer();
+
         return device_mhb_send(s_data->mhb_dev, &hdr, (const uint8_t *)&req, sizeof(req), 0);
     }
 
@@ -223,6 +275,7 @@ static int _off(struct device *dev) {
     hdr.type = MHB_TYPE_HSIC_CONTROL_REQ;
     hdr.result = 0;
     req.command = MHB_HSIC_COMMAND_STOP;
+    data->stats.stops++;
     ret = device_mhb_send(data->mhb_dev, &hdr, (const uint8_t *)&req, sizeof(req), 0);
 
     if (ret) {
@@ -255,6 +308,17 @@ static int _unreg_cb(struct device *dev) {
     return 0;
 }
 
+static int _get_stats(struct device *dev, struct usbtun_stats *stats) {
+    struct usbtun_s *data = device_get_private(dev);
+
+    if (!stats)
+        return -EINVAL;
+
+    memcpy(stats, &data->stats, sizeof(*stats));
+
+    return 0;
+}
+
 static void _close(struct device *dev) {
     struct usbtun_s *data = device_get_private(dev);
 
@@ -290,6 +354,7 @@ static struct device_usbtun_type_ops _type_ops = {
     .off = _off,
     .register_callback = _reg_cb,
     .unregister_callback = _unreg_cb,
+    .get_stats = _get_stats,
 };
 
 static struct device_driver_ops _driver_ops = {
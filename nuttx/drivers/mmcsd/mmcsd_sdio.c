@@ -98,6 +98,20 @@
 #define MMCSD_BLOCK_RDATADELAY  (100)      /* Wait up to 100MS to get one data block */
 #define MMCSD_BLOCK_WDATADELAY  (200)      /* Wait up to 200MS to write one data block */
 
+/* Read-ahead and write buffering.  The block size is always 512 bytes (see
+ * mmcsd_decodeCSD()), so the buffers can be set up before a card is found.
+ */
+
+#ifndef CONFIG_MMCSD_WRBUFFER_NBLOCKS
+#  define CONFIG_MMCSD_WRBUFFER_NBLOCKS 16
+#endif
+
+#ifndef CONFIG_MMCSD_RHBUFFER_NBLOCKS
+#  define CONFIG_MMCSD_RHBUFFER_NBLOCKS 16
+#endif
+
+#define MMCSD_RWB_BLOCKSIZE     512
+
 #define IS_EMPTY(priv) (priv->type == MMCSD_CARDTYPE_UNKNOWN)
 
 /****************************************************************************
@@ -203,7 +217,7 @@ static ssize_t mmcsd_readsingle(FAR struct mmcsd_state_s *priv,
 static ssize_t mmcsd_readmultiple(FAR struct mmcsd_state_s *priv,
                  FAR uint8_t *buffer, off_t startblock, size_t nblocks);
 #endif
-#ifdef CONFIG_DRVR_READAHEAD
+#if defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_READAHEAD)
 static ssize_t mmcsd_reload(FAR void *dev, FAR uint8_t *buffer,
                  off_t startblock, size_t nblocks);
 #endif
@@ -214,7 +228,7 @@ static ssize_t mmcsd_writesingle(FAR struct mmcsd_state_s *priv,
 static ssize_t mmcsd_writemultiple(FAR struct mmcsd_state_s *priv,
                  FAR const uint8_t *buffer, off_t startblock, size_t nblocks);
 #endif
-#ifdef CONFIG_DRVR_WRITEBUFFER
+#if defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_READAHEAD)
 static ssize_t mmcsd_flush(FAR void *dev, FAR const uint8_t *buffer,
                  off_t startblock, size_t nblocks);
 #endif
@@ -1426,7 +1440,7 @@ static ssize_t mmcsd_readmultiple(FAR struct mmcsd_state_s *priv,
 
   if (priv->dma)
     {
-      ret = SDIO_DMAPREFLIGHT(priv->dev, buffer, priv->blocksize);
+      ret = SDIO_DMAPREFLIGHT(priv->dev, buffer, nblocks << priv->blockshift);
 
       if (ret != OK)
         {
@@ -1535,11 +1549,11 @@ static ssize_t mmcsd_readmultiple(FAR struct mmcsd_state_s *priv,
  *
  * Description:
  *   Reload the specified number of sectors from the physical device into the
- *   read-ahead buffer.
+ *   read-ahead buffer (or, for reads that bypass it, into the user buffer).
  *
  ****************************************************************************/
 
-#ifdef CONFIG_DRVR_READAHEAD
+#if defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_READAHEAD)
 static ssize_t mmcsd_reload(FAR void *dev, FAR uint8_t *buffer,
                             off_t startblock, size_t nblocks)
 {
@@ -1552,6 +1566,10 @@ static ssize_t mmcsd_reload(FAR void *dev, FAR uint8_t *buffer,
 
   DEBUGASSERT(priv != NULL && buffer != NULL && nblocks > 0)
 
+  /* This is called by the rwbuffer, without the slot */
+
+  mmcsd_takesem(priv);
+
 #ifdef CONFIG_MMCSD_MULTIBLOCK_DISABLE
   /* Read each block using only the single block transfer method */
 
@@ -1587,6 +1605,7 @@ static ssize_t mmcsd_reload(FAR void *dev, FAR uint8_t *buffer,
     }
 
 #endif
+  mmcsd_givesem(priv);
 
   /* On success, return the number of blocks read */
 
@@ -1764,7 +1783,7 @@ static ssize_t mmcsd_writemultiple(FAR struct mmcsd_state_s *priv,
 
   if (priv->dma)
     {
-      ret = SDIO_DMAPREFLIGHT(priv->dev, buffer, priv->blocksize);
+      ret = SDIO_DMAPREFLIGHT(priv->dev, buffer, nblocks << priv->blockshift);
 
       if (ret != OK)
         {
@@ -1830,9 +1849,11 @@ static ssize_t mmcsd_writemultiple(FAR struct mmcsd_state_s *priv,
           return ret;
         }
 
-      /* Send CMD23, SET_WR_BLK_COUNT, and verify that good R1 status is returned */
+      /* Send CMD23, SET_WR_BLK_COUNT, and verify that good R1 status is
+       * returned.  The block count is in bits 0-22 of the argument.
+       */
 
-      mmcsd_sendcmdpoll(priv, SD_ACMD23, 0);
+      mmcsd_sendcmdpoll(priv, SD_ACMD23, nblocks & 0x007fffff);
       ret = mmcsd_recvR1(priv, SD_ACMD23);
       if (ret != OK)
         {
@@ -1911,7 +1932,8 @@ static ssize_t mmcsd_writemultiple(FAR struct mmcsd_state_s *priv,
  *
  ****************************************************************************/
 
-#if defined(CONFIG_FS_WRITABLE) && defined(CONFIG_DRVR_WRITEBUFFER)
+#if defined(CONFIG_FS_WRITABLE) && \
+    (defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_READAHEAD))
 static ssize_t mmcsd_flush(FAR void *dev, FAR const uint8_t *buffer,
                            off_t startblock, size_t nblocks)
 {
@@ -1924,6 +1946,12 @@ static ssize_t mmcsd_flush(FAR void *dev, FAR const uint8_t *buffer,
 
   DEBUGASSERT(priv != NULL && buffer != NULL && nblocks > 0)
 
+  /* This is called by the rwbuffer, possibly from the worker thread,
+   * without the slot
+   */
+
+  mmcsd_takesem(priv);
+
 #ifdef CONFIG_MMCSD_MULTIBLOCK_DISABLE
   /* Write each block using only the single block transfer method */
 
@@ -1957,6 +1985,7 @@ static ssize_t mmcsd_flush(FAR void *dev, FAR const uint8_t *buffer,
     }
 
 #endif
+  mmcsd_givesem(priv);
 
   /* On success, return the number of blocks written */
 
@@ -2028,7 +2057,8 @@ static ssize_t mmcsd_read(FAR struct inode *inode, unsigned char *buffer,
                           size_t startsector, unsigned int nsectors)
 {
   FAR struct mmcsd_state_s *priv;
-#if !defined(CONFIG_DRVR_READAHEAD) && defined(CONFIG_MMCSD_MULTIBLOCK_DISABLE)
+#if !defined(CONFIG_DRVR_WRITEBUFFER) && !defined(CONFIG_DRVR_READAHEAD) && \
+    defined(CONFIG_MMCSD_MULTIBLOCK_DISABLE)
   size_t sector;
   size_t endsector;
 #endif
@@ -2041,16 +2071,19 @@ static ssize_t mmcsd_read(FAR struct inode *inode, unsigned char *buffer,
 
   if (nsectors > 0)
     {
-      mmcsd_takesem(priv);
-
-#if defined(CONFIG_DRVR_READAHEAD)
-      /* Get the data from the read-ahead buffer */
+#if defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_READAHEAD)
+      /* Get the data from the read-ahead buffer (or from the card, after
+       * overlapping blocks in the write buffer were flushed).  The buffers
+       * have their own locking and mmcsd_reload() takes the slot when it
+       * goes to the card.
+       */
 
       ret = rwb_read(&priv->rwbuffer, startsector, nsectors, buffer);
 
 #elif defined(CONFIG_MMCSD_MULTIBLOCK_DISABLE)
       /* Read each block using only the single block transfer method */
 
+      mmcsd_takesem(priv);
       endsector = startsector + nsectors - 1;
       for (sector = startsector; sector <= endsector; sector++)
         {
@@ -2068,9 +2101,12 @@ static ssize_t mmcsd_read(FAR struct inode *inode, unsigned char *buffer,
           buffer += priv->blocksize;
         }
 
+      mmcsd_givesem(priv);
+
 #else
       /* Use either the single- or muliple-block transfer method */
 
+      mmcsd_takesem(priv);
       if (nsectors == 1)
         {
           ret = mmcsd_readsingle(priv, buffer, startsector);
@@ -2080,8 +2116,8 @@ static ssize_t mmcsd_read(FAR struct inode *inode, unsigned char *buffer,
           ret = mmcsd_readmultiple(priv, buffer, startsector, nsectors);
         }
 
-#endif
       mmcsd_givesem(priv);
+#endif
     }
 
   /* On success, return the number of blocks read */
@@ -2103,26 +2139,31 @@ static ssize_t mmcsd_write(FAR struct inode *inode, FAR const unsigned char *buf
                            size_t startsector, unsigned int nsectors)
 {
   FAR struct mmcsd_state_s *priv;
-#if defined(CONFIG_MMCSD_MULTIBLOCK_DISABLE)
+#if !defined(CONFIG_DRVR_WRITEBUFFER) && !defined(CONFIG_DRVR_READAHEAD) && \
+    defined(CONFIG_MMCSD_MULTIBLOCK_DISABLE)
   size_t sector;
   size_t endsector;
 #endif
   ssize_t ret = nsectors;
 
-  fvdbg("sector: %d nsectors: %d sectorsize: %d\n");
+  fvdbg("sector: %d nsectors: %d\n", startsector, nsectors);
   DEBUGASSERT(inode && inode->i_private);
   priv = (FAR struct mmcsd_state_s *)inode->i_private;
 
-  mmcsd_takesem(priv);
-
-#if defined(CONFIG_DRVR_WRITEBUFFER)
-  /* Write the data to the write buffer */
+#if defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_READAHEAD)
+  /* Write the data to the write buffer (or to the card, after dropping
+   * overlapping blocks from the read-ahead buffer).  Adjacent writes are
+   * merged in the write buffer and flushed to the card as one multiple
+   * block write by mmcsd_flush(), which takes the slot when it goes to the
+   * card.
+   */
 
   ret = rwb_write(&priv->rwbuffer, startsector, nsectors, buffer);
 
 #elif defined(CONFIG_MMCSD_MULTIBLOCK_DISABLE)
   /* Write each block using only the single block transfer method */
 
+  mmcsd_takesem(priv);
   endsector = startsector + nsectors - 1;
   for (sector = startsector; sector <= endsector; sector++)
     {
@@ -2140,9 +2181,12 @@ static ssize_t mmcsd_write(FAR struct inode *inode, FAR const unsigned char *buf
       buffer += priv->blocksize;
     }
 
+  mmcsd_givesem(priv);
+
 #else
   /* Use either the single- or multiple-block transfer method */
 
+  mmcsd_takesem(priv);
   if (nsectors == 1)
     {
       ret = mmcsd_writesingle(priv, buffer, startsector);
@@ -2152,8 +2196,8 @@ static ssize_t mmcsd_write(FAR struct inode *inode, FAR const unsigned char *buf
       ret = mmcsd_writemultiple(priv, buffer, startsector, nsectors);
     }
 
-#endif
   mmcsd_givesem(priv);
+#endif
 
   /* On success, return the number of blocks written */
 
@@ -2278,6 +2322,16 @@ static int mmcsd_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
     }
 
   mmcsd_givesem(priv);
+
+#if defined(CONFIG_DRVR_REMOVABLE)
+  /* Drop the buffered data of the ejected card (see mmcsd_mediachange()) */
+
+  if (cmd == BIOC_EJECT)
+    {
+      (void)rwb_mediaremoved(&priv->rwbuffer);
+    }
+#endif
+
   return ret;
 }
 
@@ -2333,6 +2387,14 @@ static void mmcsd_mediachange(FAR void *arg)
     }
 
   mmcsd_givesem(priv);
+
+#if defined(CONFIG_DRVR_REMOVABLE)
+  /* Drop the buffered data of the old card.  The buffers are always taken
+   * before the slot, so this happens after the slot was given up.
+   */
+
+  (void)rwb_mediaremoved(&priv->rwbuffer);
+#endif
 }
 
 /****************************************************************************
@@ -3019,6 +3081,12 @@ static int mmcsd_probe(FAR struct mmcsd_state_s *priv)
               fvdbg("Capacity: %lu Kbytes\n", (unsigned long)(priv->capacity / 1024));
               priv->mediachanged = true;
 
+#if defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_READAHEAD)
+              /* Let the buffers know where the card ends */
+
+              priv->rwbuffer.nblocks = priv->nblocks;
+#endif
+
               /* Set up to receive asynchronous, media removal events */
 
               SDIO_CALLBACKENABLE(priv->dev, SDIOMEDIA_EJECTED);
@@ -3243,6 +3311,26 @@ int mmcsd_slotinitialize(int minor, FAR struct sdio_dev_s *dev)
 
       priv->dev = dev;
 
+#if defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_READAHEAD)
+      /* Describe the buffering.  The number of blocks is updated when a
+       * card is found.
+       */
+
+      priv->rwbuffer.blocksize   = MMCSD_RWB_BLOCKSIZE;
+      priv->rwbuffer.nblocks     = 1;
+      priv->rwbuffer.dev         = (FAR void *)priv;
+      priv->rwbuffer.rhreload    = mmcsd_reload;
+#ifdef CONFIG_FS_WRITABLE
+      priv->rwbuffer.wrflush     = mmcsd_flush;
+#ifdef CONFIG_DRVR_WRITEBUFFER
+      priv->rwbuffer.wrmaxblocks = CONFIG_MMCSD_WRBUFFER_NBLOCKS;
+#endif
+#endif
+#ifdef CONFIG_DRVR_READAHEAD
+      priv->rwbuffer.rhmaxblocks = CONFIG_MMCSD_RHBUFFER_NBLOCKS;
+#endif
+#endif
+
       /* Initialize the hardware associated with the slot */
 
       ret = mmcsd_hwinitialize(priv);
@@ -3278,7 +3366,6 @@ int mmcsd_slotinitialize(int minor, FAR struct sdio_dev_s *dev)
 #if defined(CONFIG_DRVR_WRITEBUFFER) || defined(CONFIG_DRVR_READAHEAD)
       /* Initialize buffering */
 
-#warning "Missing setup of rwbuffer"
       ret = rwb_initialize(&priv->rwbuffer);
       if (ret < 0)
         {
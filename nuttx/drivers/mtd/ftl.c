@@ -46,10 +46,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <semaphore.h>
 #include <debug.h>
 #include <errno.h>
 
 #include <nuttx/kmalloc.h>
+#include <nuttx/clock.h>
+#include <nuttx/wqueue.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
 #include <nuttx/mtd/mtd.h>
@@ -63,10 +66,35 @@
 #  define FTL_HAVE_RWBUFFER 1
 #endif
 
+#ifdef CONFIG_FTL_EBCACHE
+#  ifndef CONFIG_FTL_EBCACHE_NENTRIES
+#    define CONFIG_FTL_EBCACHE_NENTRIES 2
+#  endif
+#  ifndef CONFIG_FTL_EBCACHE_DELAY
+#    define CONFIG_FTL_EBCACHE_DELAY 500
+#  endif
+#  define FTL_NOBLOCK ((off_t)-1)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+#ifdef CONFIG_FTL_EBCACHE
+/* One cached erase block.  Only the R/W blocks marked in the dirty bitmap
+ * hold data.  The others are read from FLASH when the entry is written
+ * back.
+ */
+
+struct ftl_ebcache_s
+{
+  off_t                 eblock;  /* Cached erase block or FTL_NOBLOCK */
+  uint32_t              lastuse; /* For least recently used replacement */
+  FAR uint8_t          *buffer;  /* Erase block data */
+  FAR uint8_t          *dirty;   /* One bit per R/W block with new data */
+};
+#endif
+
 struct ftl_struct_s
 {
   FAR struct mtd_dev_s *mtd;     /* Contained MTD interface */
@@ -78,6 +106,12 @@ struct ftl_struct_s
 #ifdef CONFIG_FS_WRITABLE
   FAR uint8_t          *eblock;  /* One, in-memory erase block */
 #endif
+#ifdef CONFIG_FTL_EBCACHE
+  sem_t                 exclsem; /* Serializes access to the cache */
+  struct work_s         work;    /* Delayed write-back of the cache */
+  uint32_t              clock;   /* Use counter of the cache entries */
+  struct ftl_ebcache_s  cache[CONFIG_FTL_EBCACHE_NENTRIES];
+#endif
 };
 
 /****************************************************************************
@@ -96,6 +130,7 @@ static ssize_t ftl_flush(FAR void *priv, FAR const uint8_t *buffer,
 static ssize_t ftl_write(FAR struct inode *inode, const unsigned char *buffer,
                  size_t start_sector, unsigned int nsectors);
 #endif
+
 static int     ftl_geometry(FAR struct inode *inode, struct geometry *geometry);
 static int     ftl_ioctl(FAR struct inode *inode, int cmd, unsigned long arg);
 
@@ -121,6 +156,323 @@ static const struct block_operations g_bops =
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: ftl_lock
+ ****************************************************************************/
+
+#ifdef CONFIG_FTL_EBCACHE
+static void ftl_lock(FAR struct ftl_struct_s *dev)
+{
+  /* Take the semaphore (perhaps waiting) */
+
+  while (sem_wait(&dev->exclsem) != 0)
+    {
+      /* The only case that an error should occur here is if the wait was
+       * awakened by a signal.
+       */
+
+      DEBUGASSERT(errno == EINTR);
+    }
+}
+
+/****************************************************************************
+ * Name: ftl_unlock
+ ****************************************************************************/
+
+static inline void ftl_unlock(FAR struct ftl_struct_s *dev)
+{
+  sem_post(&dev->exclsem);
+}
+
+/****************************************************************************
+ * Name: ftl_isdirty
+ ****************************************************************************/
+
+static inline bool ftl_isdirty(FAR struct ftl_ebcache_s *entry, uint16_t blk)
+{
+  return (entry->dirty[blk >> 3] & (1 << (blk & 7))) != 0;
+}
+
+/****************************************************************************
+ * Name: ftl_cacheflush
+ *
+ * Description: Write one cached erase block back to FLASH.  The R/W blocks
+ *   that were not written are read from FLASH first, unless all of them
+ *   were written.  The entry is free afterwards.
+ *
+ ****************************************************************************/
+
+static int ftl_cacheflush(FAR struct ftl_struct_s *dev,
+                          FAR struct ftl_ebcache_s *entry)
+{
+  off_t    rwblock;
+  ssize_t  nxfrd;
+  uint16_t i;
+  uint16_t j;
+
+  if (entry->eblock == FTL_NOBLOCK)
+    {
+      return OK;
+    }
+
+  rwblock = entry->eblock * dev->blkper;
+  for (i = 0; i < dev->blkper; i = j)
+    {
+      if (ftl_isdirty(entry, i))
+        {
+          j = i + 1;
+          continue;
+        }
+
+      /* Read the whole run of unwritten R/W blocks */
+
+      for (j = i + 1; j < dev->blkper && !ftl_isdirty(entry, j); j++);
+
+      nxfrd = MTD_BREAD(dev->mtd, rwblock + i, j - i,
+                        entry->buffer + i * dev->geo.blocksize);
+      if (nxfrd != j - i)
+        {
+          fdbg("Read block %d failed: %d\n", rwblock + i, nxfrd);
+          return -EIO;
+        }
+    }
+
+  /* Erase and write the full erase block */
+
+  nxfrd = ftl_flush(dev, entry->buffer, rwblock, dev->blkper);
+  if (nxfrd < 0)
+    {
+      return (int)nxfrd;
+    }
+
+  entry->eblock = FTL_NOBLOCK;
+  memset(entry->dirty, 0, (dev->blkper + 7) >> 3);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_cacheflushall
+ *
+ * Description: Write all cached erase blocks back to FLASH.
+ *
+ ****************************************************************************/
+
+static int ftl_cacheflushall(FAR struct ftl_struct_s *dev)
+{
+  int ret = OK;
+  int tmp;
+  int i;
+
+  for (i = 0; i < CONFIG_FTL_EBCACHE_NENTRIES; i++)
+    {
+      tmp = ftl_cacheflush(dev, &dev->cache[i]);
+      if (tmp < 0)
+        {
+          ret = tmp;
+        }
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: ftl_cachetimeout
+ *
+ * Description: Runs on the worker thread when there was no write for
+ *   CONFIG_FTL_EBCACHE_DELAY milliseconds.
+ *
+ ****************************************************************************/
+
+static void ftl_cachetimeout(FAR void *arg)
+{
+  FAR struct ftl_struct_s *dev = (FAR struct ftl_struct_s *)arg;
+
+  ftl_lock(dev);
+  (void)ftl_cacheflushall(dev);
+  ftl_unlock(dev);
+}
+
+/****************************************************************************
+ * Name: ftl_cachefind
+ *
+ * Description: Return the cache entry of an erase block or, if it is not
+ *   cached, NULL.
+ *
+ ****************************************************************************/
+
+static FAR struct ftl_ebcache_s *ftl_cachefind(FAR struct ftl_struct_s *dev,
+                                               off_t eblock)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_FTL_EBCACHE_NENTRIES; i++)
+    {
+      if (dev->cache[i].eblock == eblock)
+        {
+          return &dev->cache[i];
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: ftl_cachealloc
+ *
+ * Description: Get a cache entry for an erase block that is not cached:
+ *   A free entry or else the least recently used one, which is written back
+ *   first.
+ *
+ ****************************************************************************/
+
+static int ftl_cachealloc(FAR struct ftl_struct_s *dev, off_t eblock,
+                          FAR struct ftl_ebcache_s **entryp)
+{
+  FAR struct ftl_ebcache_s *entry = &dev->cache[0];
+  int ret;
+  int i;
+
+  for (i = 0; i < CONFIG_FTL_EBCACHE_NENTRIES; i++)
+    {
+      if (dev->cache[i].eblock == FTL_NOBLOCK)
+        {
+          entry = &dev->cache[i];
+          break;
+        }
+
+      if ((int32_t)(dev->cache[i].lastuse - entry->lastuse) < 0)
+        {
+          entry = &dev->cache[i];
+        }
+    }
+
+  ret = ftl_cacheflush(dev, entry);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  entry->eblock = eblock;
+  *entryp = entry;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: ftl_cacheread
+ *
+ * Description: Copy the cached R/W blocks in the range over the data that
+ *   was read from FLASH.
+ *
+ ****************************************************************************/
+
+static void ftl_cacheread(FAR struct ftl_struct_s *dev, FAR uint8_t *buffer,
+                          off_t startblock, size_t nblocks)
+{
+  FAR struct ftl_ebcache_s *entry;
+  off_t first;
+  off_t block;
+  int i;
+
+  for (i = 0; i < CONFIG_FTL_EBCACHE_NENTRIES; i++)
+    {
+      entry = &dev->cache[i];
+      if (entry->eblock == FTL_NOBLOCK)
+        {
+          continue;
+        }
+
+      first = entry->eblock * dev->blkper;
+      for (block = first; block < first + dev->blkper; block++)
+        {
+          if (block >= startblock && block < startblock + nblocks &&
+              ftl_isdirty(entry, block - first))
+            {
+              memcpy(buffer + (block - startblock) * dev->geo.blocksize,
+                     entry->buffer + (block - first) * dev->geo.blocksize,
+                     dev->geo.blocksize);
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: ftl_cachewrite
+ *
+ * Description: Write the specified number of sectors into the cache.
+ *   Full erase blocks that are not cached are written directly.
+ *
+ ****************************************************************************/
+
+static ssize_t ftl_cachewrite(FAR void *priv, FAR const uint8_t *buffer,
+                              off_t startblock, size_t nblocks)
+{
+  FAR struct ftl_struct_s *dev = (FAR struct ftl_struct_s *)priv;
+  FAR struct ftl_ebcache_s *entry;
+  off_t    eblock;
+  uint16_t offset;
+  uint16_t nwrite;
+  uint16_t i;
+  size_t   remaining;
+  ssize_t  ret = nblocks;
+
+  ftl_lock(dev);
+  (void)work_cancel(LPWORK, &dev->work);
+
+  for (remaining = nblocks; remaining > 0; remaining -= nwrite)
+    {
+      eblock = startblock / dev->blkper;
+      offset = startblock - eblock * dev->blkper;
+      nwrite = dev->blkper - offset;
+      if (nwrite > remaining)
+        {
+          nwrite = remaining;
+        }
+
+      entry = ftl_cachefind(dev, eblock);
+      if (!entry && nwrite == dev->blkper)
+        {
+          /* Nothing to merge with:  Erase and write it right away */
+
+          ret = ftl_flush(dev, buffer, startblock, nwrite);
+          if (ret < 0)
+            {
+              break;
+            }
+        }
+      else
+        {
+          if (!entry)
+            {
+              ret = ftl_cachealloc(dev, eblock, &entry);
+              if (ret < 0)
+                {
+                  break;
+                }
+            }
+
+          memcpy(entry->buffer + offset * dev->geo.blocksize, buffer,
+                 nwrite * dev->geo.blocksize);
+          for (i = offset; i < offset + nwrite; i++)
+            {
+              entry->dirty[i >> 3] |= 1 << (i & 7);
+            }
+
+          entry->lastuse = ++dev->clock;
+        }
+
+      startblock += nwrite;
+      buffer     += nwrite * dev->geo.blocksize;
+    }
+
+  /* Write the cache back if there is no more write for a while */
+
+  (void)work_queue(LPWORK, &dev->work, ftl_cachetimeout, (FAR void *)dev,
+                   MSEC2TICK(CONFIG_FTL_EBCACHE_DELAY));
+  ftl_unlock(dev);
+  return ret < 0 ? ret : (ssize_t)nblocks;
+}
+#endif
+
 /****************************************************************************
  * Name: ftl_open
  *
@@ -143,8 +495,25 @@ static int ftl_open(FAR struct inode *inode)
 
 static int ftl_close(FAR struct inode *inode)
 {
+#ifdef CONFIG_FTL_EBCACHE
+  FAR struct ftl_struct_s *dev;
+  int ret;
+
+  fvdbg("Entry\n");
+
+  DEBUGASSERT(inode && inode->i_private);
+  dev = (FAR struct ftl_struct_s *)inode->i_private;
+
+  /* Write back anything still cached */
+
+  ftl_lock(dev);
+  ret = ftl_cacheflushall(dev);
+  ftl_unlock(dev);
+  return ret;
+#else
   fvdbg("Entry\n");
   return OK;
+#endif
 }
 
 /****************************************************************************
@@ -160,6 +529,10 @@ static ssize_t ftl_reload(FAR void *priv, FAR uint8_t *buffer,
   struct ftl_struct_s *dev = (struct ftl_struct_s *)priv;
   ssize_t nread;
 
+#ifdef CONFIG_FTL_EBCACHE
+  ftl_lock(dev);
+#endif
+
   /* Read the full erase block into the buffer */
 
   nread   = MTD_BREAD(dev->mtd, startblock, nblocks, buffer);
@@ -168,6 +541,16 @@ static ssize_t ftl_reload(FAR void *priv, FAR uint8_t *buffer,
       fdbg("Read %d blocks starting at block %d failed: %d\n",
             nblocks, startblock, nread);
     }
+#ifdef CONFIG_FTL_EBCACHE
+  else
+    {
+      /* Replace what is on FLASH with any newer data in the cache */
+
+      ftl_cacheread(dev, buffer, startblock, nblocks);
+    }
+
+  ftl_unlock(dev);
+#endif
 
   return nread;
 }
@@ -390,8 +773,10 @@ static ssize_t ftl_write(FAR struct inode *inode, const unsigned char *buffer,
 
   DEBUGASSERT(inode && inode->i_private);
   dev = (struct ftl_struct_s *)inode->i_private;
-#ifdef CONFIG_FTL_WRITEBUFFER
+#if defined(CONFIG_FTL_WRITEBUFFER)
   return rwb_write(&dev->rwb, start_sector, nsectors, buffer);
+#elif defined(CONFIG_FTL_EBCACHE)
+  return ftl_cachewrite(dev, buffer, start_sector, nsectors);
 #else
   return ftl_flush(dev, buffer, start_sector, nsectors);
 #endif
@@ -451,6 +836,21 @@ static int ftl_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
   fvdbg("Entry\n");
   DEBUGASSERT(inode && inode->i_private);
 
+  dev = (struct ftl_struct_s *)inode->i_private;
+  if (cmd == BIOC_FLUSH)
+    {
+      /* Write back all cached data */
+
+#ifdef CONFIG_FTL_EBCACHE
+      ftl_lock(dev);
+      ret = ftl_cacheflushall(dev);
+      ftl_unlock(dev);
+      return ret;
+#else
+      return OK;
+#endif
+    }
+
   /* Only one block driver ioctl command is supported by this driver (and
    * that command is just passed on to the MTD driver in a slightly
    * different form).
@@ -481,7 +881,6 @@ static int ftl_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
    * to the MTD driver (unchanged).
    */
 
-  dev = (struct ftl_struct_s *)inode->i_private;
   ret = MTD_IOCTL(dev->mtd, cmd, arg);
   if (ret < 0)
     {
@@ -513,6 +912,9 @@ int ftl_initialize(int minor, FAR struct mtd_dev_s *mtd)
   struct ftl_struct_s *dev;
   char devname[16];
   int ret = -ENOMEM;
+#ifdef CONFIG_FTL_EBCACHE
+  int i;
+#endif
 
   /* Sanity check */
 
@@ -562,6 +964,40 @@ int ftl_initialize(int minor, FAR struct mtd_dev_s *mtd)
       dev->blkper = dev->geo.erasesize / dev->geo.blocksize;
       DEBUGASSERT(dev->blkper * dev->geo.blocksize == dev->geo.erasesize);
 
+      /* Allocate the erase block cache.  The dirty bitmap of each entry
+       * follows its erase block buffer.
+       */
+
+#ifdef CONFIG_FTL_EBCACHE
+      sem_init(&dev->exclsem, 0, 1);
+      memset(&dev->work, 0, sizeof(struct work_s));
+      dev->clock = 0;
+
+      for (i = 0; i < CONFIG_FTL_EBCACHE_NENTRIES; i++)
+        {
+          dev->cache[i].eblock  = FTL_NOBLOCK;
+          dev->cache[i].lastuse = 0;
+          dev->cache[i].buffer  =
+            (FAR uint8_t *)kmm_zalloc(dev->geo.erasesize +
+                                      ((dev->blkper + 7) >> 3));
+          if (!dev->cache[i].buffer)
+            {
+              fdbg("Failed to allocate the erase block cache\n");
+              while (i-- > 0)
+                {
+                  kmm_free(dev->cache[i].buffer);
+                }
+
+              sem_destroy(&dev->exclsem);
+              kmm_free(dev->eblock);
+              kmm_free(dev);
+              return -ENOMEM;
+            }
+
+          dev->cache[i].dirty = dev->cache[i].buffer + dev->geo.erasesize;
+        }
+#endif
+
       /* Configure read-ahead/write buffering */
 
 #ifdef FTL_HAVE_RWBUFFER
@@ -571,8 +1007,12 @@ int ftl_initialize(int minor, FAR struct mtd_dev_s *mtd)
 
 #if defined(CONFIG_FS_WRITABLE) && defined(CONFIG_FTL_WRITEBUFFER)
       dev->rwb.wrmaxblocks = dev->blkper;
+#ifdef CONFIG_FTL_EBCACHE
+      dev->rwb.wrflush     = ftl_cachewrite;
+#else
       dev->rwb.wrflush     = ftl_flush;
 #endif
+#endif
 
 #ifdef CONFIG_FTL_READAHEAD
       dev->rwb.rhmaxblocks = dev->blkper;
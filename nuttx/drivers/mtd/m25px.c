@@ -187,6 +187,14 @@
 
 #define M25P_DUMMY     0xa5
 
+/* Size of the read command header: Instruction, address and dummy byte */
+
+#ifdef CONFIG_M25P_FASTREAD
+#  define M25P_READHDR   5
+#else
+#  define M25P_READHDR   4
+#endif
+
 /************************************************************************************
  * Private Types
  ************************************************************************************/
@@ -207,6 +215,7 @@ struct m25p_dev_s
 #ifdef CONFIG_M25P_SUBSECTOR_ERASE
   uint8_t  subsectorshift;   /* 0, 12 or 13 (4K or 8K) */
 #endif
+  bool     erasing;          /* An erase may still be in progress */
 };
 
 /************************************************************************************
@@ -218,6 +227,7 @@ struct m25p_dev_s
 static void m25p_lock(FAR struct spi_dev_s *dev);
 static inline void m25p_unlock(FAR struct spi_dev_s *dev);
 static inline int m25p_readid(struct m25p_dev_s *priv);
+static uint8_t m25p_readstatus(struct m25p_dev_s *priv);
 static void m25p_waitwritecomplete(struct m25p_dev_s *priv);
 static void m25p_writeenable(struct m25p_dev_s *priv);
 static inline void m25p_sectorerase(struct m25p_dev_s *priv, off_t offset, uint8_t type);
@@ -385,17 +395,13 @@ static inline int m25p_readid(struct m25p_dev_s *priv)
 }
 
 /************************************************************************************
- * Name: m25p_waitwritecomplete
+ * Name: m25p_readstatus
  ************************************************************************************/
 
-static void m25p_waitwritecomplete(struct m25p_dev_s *priv)
+static uint8_t m25p_readstatus(struct m25p_dev_s *priv)
 {
   uint8_t status;
 
-  /* Are we the only device on the bus? */
-
-#ifdef CONFIG_SPI_OWNBUS
-
   /* Select this FLASH part */
 
   SPI_SELECT(priv->dev, SPIDEV_FLASH, true);
@@ -404,25 +410,32 @@ static void m25p_waitwritecomplete(struct m25p_dev_s *priv)
 
   (void)SPI_SEND(priv->dev, M25P_RDSR);
 
-  /* Loop as long as the memory is busy with a write cycle */
-
-  do
-    {
-      /* Send a dummy byte to generate the clock needed to shift out the status */
+  /* Send a dummy byte to generate the clock needed to shift out the status */
 
-      status = SPI_SEND(priv->dev, M25P_DUMMY);
-    }
-  while ((status & M25P_SR_WIP) != 0);
+  status = SPI_SEND(priv->dev, M25P_DUMMY);
 
   /* Deselect the FLASH */
 
   SPI_SELECT(priv->dev, SPIDEV_FLASH, false);
+  return status;
+}
 
-#else
+/************************************************************************************
+ * Name: m25p_waitwritecomplete
+ ************************************************************************************/
 
-  /* Loop as long as the memory is busy with a write cycle */
+static void m25p_waitwritecomplete(struct m25p_dev_s *priv)
+{
+  uint8_t status;
 
-  do
+  /* Are we the only device on the bus?  Then spin on the status register
+   * for page programs, which complete in a millisecond or so.  Erases take
+   * tens of milliseconds or more and are polled as below so that other
+   * threads may run in the meantime.
+   */
+
+#ifdef CONFIG_SPI_OWNBUS
+  if (!priv->erasing)
     {
       /* Select this FLASH part */
 
@@ -432,13 +445,29 @@ static void m25p_waitwritecomplete(struct m25p_dev_s *priv)
 
       (void)SPI_SEND(priv->dev, M25P_RDSR);
 
-      /* Send a dummy byte to generate the clock needed to shift out the status */
+      /* Loop as long as the memory is busy with a write cycle */
 
-      status = SPI_SEND(priv->dev, M25P_DUMMY);
+      do
+        {
+          /* Send a dummy byte to generate the clock needed to shift out the status */
+
+          status = SPI_SEND(priv->dev, M25P_DUMMY);
+        }
+      while ((status & M25P_SR_WIP) != 0);
 
       /* Deselect the FLASH */
 
       SPI_SELECT(priv->dev, SPIDEV_FLASH, false);
+      fvdbg("Complete\n");
+      return;
+    }
+#endif
+
+  /* Loop as long as the memory is busy with a write cycle */
+
+  do
+    {
+      status = m25p_readstatus(priv);
 
       /* Given that writing could take up to few tens of milliseconds, and erasing
        * could take more.  The following short delay in the "busy" case will allow
@@ -453,8 +482,8 @@ static void m25p_waitwritecomplete(struct m25p_dev_s *priv)
         }
     }
   while ((status & M25P_SR_WIP) != 0);
-#endif
 
+  priv->erasing = false;
   fvdbg("Complete\n");
 }
 
@@ -533,6 +562,7 @@ static void m25p_sectorerase(struct m25p_dev_s *priv, off_t sector, uint8_t type
   /* Deselect the FLASH */
 
   SPI_SELECT(priv->dev, SPIDEV_FLASH, false);
+  priv->erasing = true;
   fvdbg("Erased\n");
 }
 
@@ -567,6 +597,7 @@ static inline int m25p_bulkerase(struct m25p_dev_s *priv)
   /* Deselect the FLASH */
 
   SPI_SELECT(priv->dev, SPIDEV_FLASH, false);
+  priv->erasing = true;
   fvdbg("Return: OK\n");
   return OK;
 }
@@ -790,6 +821,7 @@ static ssize_t m25p_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes,
                          FAR uint8_t *buffer)
 {
   FAR struct m25p_dev_s *priv = (FAR struct m25p_dev_s *)dev;
+  uint8_t cmd[M25P_READHDR];
 
   fvdbg("offset: %08lx nbytes: %d\n", (long)offset, (int)nbytes);
 
@@ -806,15 +838,25 @@ static ssize_t m25p_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes,
   m25p_lock(priv->dev);
   SPI_SELECT(priv->dev, SPIDEV_FLASH, true);
 
-  /* Send "Read from Memory " instruction */
+  /* Send "Read from Memory " instruction and the page offset high byte
+   * first, followed by a dummy byte for the fast read.  The header goes out
+   * as one block so that the SPI driver can use a single (DMA) exchange for
+   * it.
+   */
 
-  (void)SPI_SEND(priv->dev, M25P_READ);
+#ifdef CONFIG_M25P_FASTREAD
+  cmd[0] = M25P_FAST_READ;
+#else
+  cmd[0] = M25P_READ;
+#endif
+  cmd[1] = (offset >> 16) & 0xff;
+  cmd[2] = (offset >> 8) & 0xff;
+  cmd[3] = offset & 0xff;
+#ifdef CONFIG_M25P_FASTREAD
+  cmd[4] = M25P_DUMMY;
+#endif
 
-  /* Send the page offset high byte first. */
-
-  (void)SPI_SEND(priv->dev, (offset >> 16) & 0xff);
-  (void)SPI_SEND(priv->dev, (offset >> 8) & 0xff);
-  (void)SPI_SEND(priv->dev, offset & 0xff);
+  SPI_SNDBLOCK(priv->dev, cmd, M25P_READHDR);
 
   /* Then read all of the requested bytes */
 
@@ -960,6 +1002,30 @@ static int m25p_ioctl(FAR struct mtd_dev_s *dev, int cmd, unsigned long arg)
         }
         break;
 
+      case MTDIOC_ERASEBUSY:
+        {
+          /* Report whether the last erase is still in progress without
+           * waiting for it.
+           */
+
+          ret = 0;
+          if (priv->erasing)
+            {
+              m25p_lock(priv->dev);
+              if ((m25p_readstatus(priv) & M25P_SR_WIP) != 0)
+                {
+                  ret = 1;
+                }
+              else
+                {
+                  priv->erasing = false;
+                }
+
+              m25p_unlock(priv->dev);
+            }
+        }
+        break;
+
       case MTDIOC_XIPBASE:
       default:
         ret = -ENOTTY; /* Bad command */
@@ -49,7 +49,9 @@
 #include <fcntl.h>
 #include <stdio.h>
 #include <sys/stat.h>
+#include <semaphore.h>
 
+#include <nuttx/irq.h>
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/ioctl.h>
@@ -61,10 +63,36 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Priority classes of the partition I/O scheduler.  A lower number is a
+ * higher priority.
+ */
+
+#define PART_CLASS_READ     0  /* bread() and read() */
+#define PART_CLASS_PROGRAM  1  /* bwrite() and write() */
+#define PART_CLASS_ERASE    2  /* erase() and MTDIOC_BULKERASE */
+#define PART_NCLASSES       3
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+#ifdef CONFIG_MTD_PARTITION_SCHED
+/* This structure is shared by all partitions of the same physical FLASH.
+ * It serializes the accesses of the partitions and lets pending reads
+ * overtake long program and erase sequences.
+ */
+
+struct part_sched_s
+{
+  FAR struct part_sched_s *flink; /* Next scheduler in the list */
+  FAR struct mtd_dev_s *mtd;    /* The physical FLASH device */
+  sem_t exclsem;                /* Exclusive access to the FLASH */
+  uint8_t nwaiting[PART_NCLASSES]; /* Number of waiters in each class */
+  uint8_t depth;                /* Current number of waiters */
+  uint8_t maxdepth;             /* Largest number of waiters seen */
+};
+#endif
+
 /* This type represents the state of the MTD device.  The struct mtd_dev_s
  * must appear at the beginning of the definition so that you can freely
  * cast between pointers to struct mtd_dev_s and struct mtd_partition_s.
@@ -95,6 +123,12 @@ struct mtd_partition_s
 #ifdef CONFIG_MTD_PARTITION_NAMES
   FAR const char *name;         /* Name of the partition */
 #endif
+#ifdef CONFIG_MTD_PARTITION_SCHED
+  FAR struct part_sched_s *sched; /* Scheduler of the physical FLASH */
+  uint32_t nops[PART_NCLASSES]; /* Operations issued in each class */
+  uint32_t nyields;             /* Times the FLASH was handed to a higher
+                                 * priority class in mid-operation */
+#endif
 };
 
 /* This structure describes one open "file" */
@@ -111,6 +145,18 @@ struct part_procfs_file_s
  * Private Function Prototypes
  ****************************************************************************/
 
+/* I/O scheduling */
+
+#ifdef CONFIG_MTD_PARTITION_SCHED
+static void    part_take(FAR struct mtd_partition_s *priv, int class);
+static void    part_give(FAR struct mtd_partition_s *priv);
+static void    part_yield(FAR struct mtd_partition_s *priv, int class);
+#else
+#  define part_take(p,c)
+#  define part_give(p)
+#  define part_yield(p,c)
+#endif
+
 /* MTD driver methods */
 
 static int     part_erase(FAR struct mtd_dev_s *dev, off_t startblock,
@@ -156,6 +202,12 @@ static int     part_procfs_stat(FAR const char *relpath,
  * Private Data
  ****************************************************************************/
 
+#ifdef CONFIG_MTD_PARTITION_SCHED
+/* The list of schedulers, one per partitioned physical FLASH */
+
+static FAR struct part_sched_s *g_partsched;
+#endif
+
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_PROCFS_EXCLUDE_PARTITIONS)
 struct mtd_partition_s *g_pfirstpartition = NULL;
 
@@ -215,6 +267,152 @@ static bool part_bytecheck(FAR struct mtd_partition_s *priv, off_t byoff)
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_MTD_PARTITION_SCHED
+/****************************************************************************
+ * Name: part_pending
+ *
+ * Description:
+ *   Return true if an operation of a higher priority class than 'class' is
+ *   waiting for the FLASH.
+ *
+ ****************************************************************************/
+
+static bool part_pending(FAR struct part_sched_s *sched, int class)
+{
+  int i;
+
+  for (i = 0; i < class; i++)
+    {
+      if (sched->nwaiting[i] > 0)
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: part_wait
+ *
+ * Description:
+ *   Queue up in the given class and wait for exclusive access to the FLASH.
+ *
+ ****************************************************************************/
+
+static void part_wait(FAR struct part_sched_s *sched, int class)
+{
+  irqstate_t flags;
+
+  flags = irqsave();
+  sched->nwaiting[class]++;
+  if (++sched->depth > sched->maxdepth)
+    {
+      sched->maxdepth = sched->depth;
+    }
+
+  irqrestore(flags);
+
+  while (sem_wait(&sched->exclsem) < 0)
+    {
+      /* The only case that an error should occur here is if the wait was
+       * awakened by a signal.
+       */
+
+      DEBUGASSERT(errno == EINTR);
+    }
+
+  flags = irqsave();
+  sched->nwaiting[class]--;
+  sched->depth--;
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: part_yield
+ *
+ * Description:
+ *   Called between the pieces of a long program or erase sequence.  If an
+ *   operation of a higher priority class is waiting, hand the FLASH over to
+ *   it and queue up again behind it.  sem_post() gives the count directly
+ *   to the waiter, so it always runs before we get the FLASH back.
+ *
+ ****************************************************************************/
+
+static void part_yield(FAR struct mtd_partition_s *priv, int class)
+{
+  FAR struct part_sched_s *sched = priv->sched;
+
+  while (part_pending(sched, class))
+    {
+      priv->nyields++;
+      sem_post(&sched->exclsem);
+      part_wait(sched, class);
+    }
+}
+
+/****************************************************************************
+ * Name: part_take
+ *
+ * Description:
+ *   Get exclusive access to the FLASH for an operation of the given class.
+ *   The semaphore wakes waiters in task priority order, so an operation
+ *   that gets the FLASH while one of a higher class is still queued steps
+ *   aside first.
+ *
+ ****************************************************************************/
+
+static void part_take(FAR struct mtd_partition_s *priv, int class)
+{
+  part_wait(priv->sched, class);
+  priv->nops[class]++;
+  part_yield(priv, class);
+}
+
+/****************************************************************************
+ * Name: part_give
+ ****************************************************************************/
+
+static void part_give(FAR struct mtd_partition_s *priv)
+{
+  sem_post(&priv->sched->exclsem);
+}
+
+/****************************************************************************
+ * Name: part_getsched
+ *
+ * Description:
+ *   Find the scheduler of a physical FLASH, creating it on the first
+ *   partition of that FLASH.
+ *
+ ****************************************************************************/
+
+static FAR struct part_sched_s *part_getsched(FAR struct mtd_dev_s *mtd)
+{
+  FAR struct part_sched_s *sched;
+
+  for (sched = g_partsched; sched != NULL; sched = sched->flink)
+    {
+      if (sched->mtd == mtd)
+        {
+          return sched;
+        }
+    }
+
+  sched = (FAR struct part_sched_s *)kmm_zalloc(sizeof(struct part_sched_s));
+  if (sched != NULL)
+    {
+      sched->mtd   = mtd;
+      sem_init(&sched->exclsem, 0, 1);
+
+      sched->flink = g_partsched;
+      g_partsched  = sched;
+    }
+
+  return sched;
+}
+#endif
+
 /****************************************************************************
  * Name: part_erase
  *
@@ -228,6 +426,10 @@ static int part_erase(FAR struct mtd_dev_s *dev, off_t startblock,
 {
   FAR struct mtd_partition_s *priv = (FAR struct mtd_partition_s *)dev;
   off_t eoffset;
+#ifdef CONFIG_MTD_PARTITION_SCHED
+  size_t i;
+  int ret = OK;
+#endif
 
   DEBUGASSERT(priv);
 
@@ -248,7 +450,27 @@ static int part_erase(FAR struct mtd_dev_s *dev, off_t startblock,
   eoffset = priv->firstblock / priv->blkpererase;
   DEBUGASSERT(eoffset * priv->blkpererase == priv->firstblock);
 
+#ifdef CONFIG_MTD_PARTITION_SCHED
+  /* Erase one block at a time so that reads and programs waiting for the
+   * FLASH get it between the blocks.
+   */
+
+  part_take(priv, PART_CLASS_ERASE);
+  for (i = 0; i < nblocks && ret >= 0; i++)
+    {
+      if (i > 0)
+        {
+          part_yield(priv, PART_CLASS_ERASE);
+        }
+
+      ret = priv->parent->erase(priv->parent, startblock + eoffset + i, 1);
+    }
+
+  part_give(priv);
+  return ret < 0 ? ret : (int)nblocks;
+#else
   return priv->parent->erase(priv->parent, startblock + eoffset, nblocks);
+#endif
 }
 
 /****************************************************************************
@@ -263,6 +485,7 @@ static ssize_t part_bread(FAR struct mtd_dev_s *dev, off_t startblock,
                           size_t nblocks, FAR uint8_t *buf)
 {
   FAR struct mtd_partition_s *priv = (FAR struct mtd_partition_s *)dev;
+  ssize_t ret;
 
   DEBUGASSERT(priv && (buf || nblocks == 0));
 
@@ -278,8 +501,11 @@ static ssize_t part_bread(FAR struct mtd_dev_s *dev, off_t startblock,
    * underlying MTD driver perform the read.
    */
 
-  return priv->parent->bread(priv->parent, startblock + priv->firstblock,
-                             nblocks, buf);
+  part_take(priv, PART_CLASS_READ);
+  ret = priv->parent->bread(priv->parent, startblock + priv->firstblock,
+                            nblocks, buf);
+  part_give(priv);
+  return ret;
 }
 
 /****************************************************************************
@@ -294,6 +520,10 @@ static ssize_t part_bwrite(FAR struct mtd_dev_s *dev, off_t startblock,
                            size_t nblocks, FAR const uint8_t *buf)
 {
   FAR struct mtd_partition_s *priv = (FAR struct mtd_partition_s *)dev;
+#ifdef CONFIG_MTD_PARTITION_SCHED
+  size_t i;
+  ssize_t ret = OK;
+#endif
 
   DEBUGASSERT(priv && (buf || nblocks == 0));
 
@@ -309,8 +539,30 @@ static ssize_t part_bwrite(FAR struct mtd_dev_s *dev, off_t startblock,
    * underlying MTD driver perform the write.
    */
 
+#ifdef CONFIG_MTD_PARTITION_SCHED
+  /* Program one block at a time so that waiting reads get the FLASH
+   * between the blocks.
+   */
+
+  part_take(priv, PART_CLASS_PROGRAM);
+  for (i = 0; i < nblocks && ret >= 0; i++)
+    {
+      if (i > 0)
+        {
+          part_yield(priv, PART_CLASS_PROGRAM);
+        }
+
+      ret = priv->parent->bwrite(priv->parent,
+                                 startblock + priv->firstblock + i, 1,
+                                 &buf[i * priv->blocksize]);
+    }
+
+  part_give(priv);
+  return ret < 0 ? ret : (ssize_t)nblocks;
+#else
   return priv->parent->bwrite(priv->parent, startblock + priv->firstblock,
                               nblocks, buf);
+#endif
 }
 
 /****************************************************************************
@@ -326,6 +578,7 @@ static ssize_t part_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes,
 {
   FAR struct mtd_partition_s *priv = (FAR struct mtd_partition_s *)dev;
   off_t newoffset;
+  ssize_t ret;
 
   DEBUGASSERT(priv && (buffer || nbytes == 0));
 
@@ -346,7 +599,11 @@ static ssize_t part_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes,
        */
 
       newoffset = offset + priv->firstblock * priv->blocksize;
-      return priv->parent->read(priv->parent, newoffset, nbytes, buffer);
+
+      part_take(priv, PART_CLASS_READ);
+      ret = priv->parent->read(priv->parent, newoffset, nbytes, buffer);
+      part_give(priv);
+      return ret;
     }
 
   /* The underlying MTD driver does not support the read() method */
@@ -364,6 +621,7 @@ static ssize_t part_write(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes
 {
   FAR struct mtd_partition_s *priv = (FAR struct mtd_partition_s *)dev;
   off_t newoffset;
+  ssize_t ret;
 
   DEBUGASSERT(priv && (buffer || nbytes == 0));
 
@@ -384,7 +642,11 @@ static ssize_t part_write(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes
        */
 
       newoffset = offset + priv->firstblock * priv->blocksize;
-      return priv->parent->write(priv->parent, newoffset, nbytes, buffer);
+
+      part_take(priv, PART_CLASS_PROGRAM);
+      ret = priv->parent->write(priv->parent, newoffset, nbytes, buffer);
+      part_give(priv);
+      return ret;
     }
 
   /* The underlying MTD driver does not support the write() method */
@@ -450,9 +712,13 @@ static int part_ioctl(FAR struct mtd_dev_s *dev, int cmd, unsigned long arg)
         {
           /* Erase the entire partition */
 
+#ifdef CONFIG_MTD_PARTITION_SCHED
+          ret = part_erase(dev, 0, priv->neraseblocks);
+#else
           ret = priv->parent->erase(priv->parent,
                                     priv->firstblock / priv->blkpererase,
                                     priv->neraseblocks);
+#endif
         }
         break;
 
@@ -574,6 +840,11 @@ static ssize_t part_procfs_read(FAR struct file *filep, FAR char *buffer,
           total = snprintf(buffer, buflen, "  Start    Size");
 #endif
 
+#ifdef CONFIG_MTD_PARTITION_SCHED
+          total += snprintf(&buffer[total], buflen - total,
+                            "    Reads    Progs   Erases   Yields Queue Max");
+#endif
+
 #ifndef CONFIG_FS_PROCFS_EXCLUDE_MTD
           total += snprintf(&buffer[total], buflen - total, "   MTD\n");
 #else
@@ -643,6 +914,24 @@ static ssize_t part_procfs_read(FAR struct file *filep, FAR char *buffer,
                   attr->nextpart->neraseblocks);
 #endif
 
+#ifdef CONFIG_MTD_PARTITION_SCHED
+          /* Add the operation counts of the partition and the queue depth of
+           * the FLASH it lives on.
+           */
+
+          if (ret + total < buflen)
+            {
+              ret += snprintf(&buffer[total + ret], buflen - (total + ret),
+                        " %8lu %8lu %8lu %8lu %5u %3u",
+                        (unsigned long)attr->nextpart->nops[PART_CLASS_READ],
+                        (unsigned long)attr->nextpart->nops[PART_CLASS_PROGRAM],
+                        (unsigned long)attr->nextpart->nops[PART_CLASS_ERASE],
+                        (unsigned long)attr->nextpart->nyields,
+                        attr->nextpart->sched->depth,
+                        attr->nextpart->sched->maxdepth);
+            }
+#endif
+
 #ifndef CONFIG_FS_PROCFS_EXCLUDE_MTD
           if (ret + total < buflen)
             {
@@ -863,6 +1152,18 @@ FAR struct mtd_dev_s *mtd_partition(FAR struct mtd_dev_s *mtd, off_t firstblock,
   part->name         = NULL;
 #endif
 
+#ifdef CONFIG_MTD_PARTITION_SCHED
+  /* All partitions of the same FLASH share one scheduler */
+
+  part->sched        = part_getsched(mtd);
+  if (!part->sched)
+    {
+      fdbg("ERROR: Failed to allocate the partition scheduler\n");
+      kmm_free(part);
+      return NULL;
+    }
+#endif
+
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_PROCFS_EXCLUDE_PARTITIONS)
   /* Add this partition to the list of known partitions */
 
@@ -54,6 +54,7 @@
 #include <debug.h>
 
 #include <nuttx/arch.h>
+#include <nuttx/clock.h>
 #include <nuttx/kmalloc.h>
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/procfs.h>
@@ -74,6 +75,9 @@ struct mtd_file_s
 {
   struct procfs_file_s  base;        /* Base open file structure */
   FAR struct mtd_dev_s  *pnextmtd;   /* Pointer to next registered MTD */
+#ifdef CONFIG_MTD_STATS
+  uint8_t               line;        /* Next line of pnextmtd (stats only) */
+#endif
 };
 
 /****************************************************************************
@@ -91,6 +95,10 @@ static int     mtd_dup(FAR const struct file *oldp,
                  FAR struct file *newp);
 
 static int     mtd_stat(FAR const char *relpath, FAR struct stat *buf);
+#ifdef CONFIG_MTD_STATS
+static ssize_t mtdstats_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+#endif
 
 /****************************************************************************
  * Private Variables
@@ -122,6 +130,31 @@ const struct procfs_operations mtd_procfsoperations =
   mtd_stat        /* stat */
 };
 
+#ifdef CONFIG_MTD_STATS
+/* The /proc/fs/stats file shares everything but read() with /proc/mtd */
+
+const struct procfs_operations mtdstats_procfsoperations =
+{
+  mtd_open,       /* open */
+  mtd_close,      /* close */
+  mtdstats_read,  /* read */
+  NULL,           /* write */
+  mtd_dup,        /* dup */
+  NULL,           /* opendir */
+  NULL,           /* closedir */
+  NULL,           /* readdir */
+  NULL,           /* rewinddir */
+  mtd_stat        /* stat */
+};
+
+/* Names of the operations in the order of the MTD_STATS_* indices */
+
+static const char *g_mtdstats_opname[MTD_STATS_NOPS] =
+{
+  "bread", "bwrite", "read", "write", "erase"
+};
+#endif
+
 /* MTD registration variables */
 
 static struct mtd_dev_s *g_pfirstmtd = NULL;
@@ -254,6 +287,254 @@ static ssize_t mtd_read(FAR struct file *filep, FAR char *buffer,
   return total;
 }
 
+/****************************************************************************
+ * Name: mtdstats_line
+ *
+ * Description:
+ *   Format one line of the /proc/fs/stats output for an MTD:  Line zero is
+ *   the device name and the lines 1 to MTD_STATS_NOPS give the counters of
+ *   one operation.  Zero is returned for operations the driver does not
+ *   provide.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_STATS
+static int mtdstats_line(FAR struct mtd_dev_s *mtd, int line,
+                         FAR char *buffer, size_t buflen)
+{
+  FAR const struct mtd_opstats_s *op;
+  bool present;
+
+  if (line == 0)
+    {
+      return snprintf(buffer, buflen, "%-5d%s\n", mtd->mtdno, mtd->name);
+    }
+
+  switch (line - 1)
+    {
+      case MTD_STATS_BREAD:
+        present = mtd->stats.bread != NULL;
+        break;
+
+      case MTD_STATS_BWRITE:
+        present = mtd->stats.bwrite != NULL;
+        break;
+
+      case MTD_STATS_READ:
+        present = mtd->stats.read != NULL;
+        break;
+
+#ifdef CONFIG_MTD_BYTE_WRITE
+      case MTD_STATS_WRITE:
+        present = mtd->stats.write != NULL;
+        break;
+#endif
+
+      case MTD_STATS_ERASE:
+        present = mtd->stats.erase != NULL;
+        break;
+
+      default:
+        present = false;
+        break;
+    }
+
+  if (!present)
+    {
+      return 0;
+    }
+
+  op = &mtd->stats.op[line - 1];
+  return snprintf(buffer, buflen,
+                  "  %-6s %8lu %6lu %10lu %8lu %6lu"
+                  " %6lu %6lu %6lu %6lu %6lu %6lu\n",
+                  g_mtdstats_opname[line - 1],
+                  (unsigned long)op->count, (unsigned long)op->errors,
+                  (unsigned long)op->units, (unsigned long)op->ticks,
+                  (unsigned long)op->maxticks,
+                  (unsigned long)op->hist[0], (unsigned long)op->hist[1],
+                  (unsigned long)op->hist[2], (unsigned long)op->hist[3],
+                  (unsigned long)op->hist[4], (unsigned long)op->hist[5]);
+}
+#endif
+
+/****************************************************************************
+ * Name: mtdstats_read
+ *
+ * Description:
+ *   Read the counters of all registered MTD devices.  Output stops at the
+ *   last complete line that fits in the buffer and continues there on the
+ *   next read.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_STATS
+static ssize_t mtdstats_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+  FAR struct mtd_file_s *priv;
+  ssize_t total = 0;
+  ssize_t ret;
+
+  priv = (FAR struct mtd_file_s *)filep->f_priv;
+  DEBUGASSERT(priv);
+
+  if (priv->pnextmtd)
+    {
+      /* Output a header before the first entry */
+
+      if (priv->pnextmtd == g_pfirstmtd && priv->line == 0)
+        {
+          total = snprintf(buffer, buflen,
+                           "Num  Device\n"
+                           "  Op        Count Errors      Units    Ticks"
+                           "  MaxTk      0      1    2-3    4-7   8-15"
+                           "    16+\n");
+          if (total >= buflen)
+            {
+              return 0;
+            }
+        }
+
+      do
+        {
+          ret = mtdstats_line(priv->pnextmtd, priv->line, &buffer[total],
+                              buflen - total);
+          if (ret + total >= buflen)
+            {
+              buffer[total] = '\0';
+              break;
+            }
+
+          total += ret;
+          if (++priv->line > MTD_STATS_NOPS)
+            {
+              priv->line     = 0;
+              priv->pnextmtd = priv->pnextmtd->pnext;
+            }
+        }
+      while (priv->pnextmtd);
+    }
+
+  /* Update the file offset */
+
+  if (total > 0)
+    {
+      filep->f_pos += total;
+    }
+
+  return total;
+}
+#endif
+
+/****************************************************************************
+ * Name: mtdstats_account
+ *
+ * Description:
+ *   Add the result of one MTD operation to the counters.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_STATS
+static void mtdstats_account(FAR struct mtd_opstats_s *op, uint32_t start,
+                             ssize_t result, size_t units)
+{
+  uint32_t elapsed = clock_systimer() - start;
+  int bucket = 0;
+
+  op->count++;
+  if (result < 0)
+    {
+      op->errors++;
+    }
+  else
+    {
+      op->units += units;
+    }
+
+  op->ticks += elapsed;
+  if (elapsed > op->maxticks)
+    {
+      op->maxticks = elapsed;
+    }
+
+  /* Buckets are powers of two:  0, 1, 2-3, 4-7, ... */
+
+  while (bucket < MTD_STATS_NHIST - 1 && elapsed >= (1u << bucket))
+    {
+      bucket++;
+    }
+
+  op->hist[bucket]++;
+}
+
+/****************************************************************************
+ * Name: mtdstats_erase, mtdstats_bread, mtdstats_bwrite, mtdstats_rd,
+ *       mtdstats_wr
+ *
+ * Description:
+ *   Counting wrappers around the driver methods saved by mtd_register().
+ *
+ ****************************************************************************/
+
+static int mtdstats_erase(FAR struct mtd_dev_s *dev, off_t startblock,
+                          size_t nblocks)
+{
+  uint32_t start = clock_systimer();
+  int ret;
+
+  ret = dev->stats.erase(dev, startblock, nblocks);
+  mtdstats_account(&dev->stats.op[MTD_STATS_ERASE], start, ret, nblocks);
+  return ret;
+}
+
+static ssize_t mtdstats_bread(FAR struct mtd_dev_s *dev, off_t startblock,
+                              size_t nblocks, FAR uint8_t *buffer)
+{
+  uint32_t start = clock_systimer();
+  ssize_t ret;
+
+  ret = dev->stats.bread(dev, startblock, nblocks, buffer);
+  mtdstats_account(&dev->stats.op[MTD_STATS_BREAD], start, ret, ret);
+  return ret;
+}
+
+static ssize_t mtdstats_bwrite(FAR struct mtd_dev_s *dev, off_t startblock,
+                               size_t nblocks, FAR const uint8_t *buffer)
+{
+  uint32_t start = clock_systimer();
+  ssize_t ret;
+
+  ret = dev->stats.bwrite(dev, startblock, nblocks, buffer);
+  mtdstats_account(&dev->stats.op[MTD_STATS_BWRITE], start, ret, ret);
+  return ret;
+}
+
+static ssize_t mtdstats_rd(FAR struct mtd_dev_s *dev, off_t offset,
+                           size_t nbytes, FAR uint8_t *buffer)
+{
+  uint32_t start = clock_systimer();
+  ssize_t ret;
+
+  ret = dev->stats.read(dev, offset, nbytes, buffer);
+  mtdstats_account(&dev->stats.op[MTD_STATS_READ], start, ret, ret);
+  return ret;
+}
+
+#ifdef CONFIG_MTD_BYTE_WRITE
+static ssize_t mtdstats_wr(FAR struct mtd_dev_s *dev, off_t offset,
+                           size_t nbytes, FAR const uint8_t *buffer)
+{
+  uint32_t start = clock_systimer();
+  ssize_t ret;
+
+  ret = dev->stats.write(dev, offset, nbytes, buffer);
+  mtdstats_account(&dev->stats.op[MTD_STATS_WRITE], start, ret, ret);
+  return ret;
+}
+#endif
+#endif /* CONFIG_MTD_STATS */
+
 /****************************************************************************
  * Name: mtd_dup
  *
@@ -338,6 +619,43 @@ int mtd_register(FAR struct mtd_dev_s *mtd, FAR const char *name)
   mtd->name = name;
   mtd->pnext = NULL;
 
+#ifdef CONFIG_MTD_STATS
+  /* Route the driver methods through the counting wrappers */
+
+  memset(&mtd->stats, 0, sizeof(struct mtd_stats_s));
+  if (mtd->erase)
+    {
+      mtd->stats.erase = mtd->erase;
+      mtd->erase       = mtdstats_erase;
+    }
+
+  if (mtd->bread)
+    {
+      mtd->stats.bread = mtd->bread;
+      mtd->bread       = mtdstats_bread;
+    }
+
+  if (mtd->bwrite)
+    {
+      mtd->stats.bwrite = mtd->bwrite;
+      mtd->bwrite       = mtdstats_bwrite;
+    }
+
+  if (mtd->read)
+    {
+      mtd->stats.read = mtd->read;
+      mtd->read       = mtdstats_rd;
+    }
+
+#ifdef CONFIG_MTD_BYTE_WRITE
+  if (mtd->write)
+    {
+      mtd->stats.write = mtd->write;
+      mtd->write       = mtdstats_wr;
+    }
+#endif
+#endif
+
   /* Add to the list of registered devices */
 
   if (g_pfirstmtd == NULL)
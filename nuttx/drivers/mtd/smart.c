@@ -49,10 +49,19 @@
 #include <stdlib.h>
 #include <stddef.h>
 #include <string.h>
+#include <unistd.h>
+#include <semaphore.h>
+#include <assert.h>
 #include <debug.h>
 #include <errno.h>
 
 #include <nuttx/kmalloc.h>
+#ifdef CONFIG_MTD_SMART_BGGC
+#  include <nuttx/kthread.h>
+#endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+#  include <crc32.h>
+#endif
 #include <nuttx/fs/fs.h>
 #include <nuttx/fs/ioctl.h>
 #include <nuttx/mtd/mtd.h>
@@ -94,6 +103,7 @@
 #define SMART_FMT_VERSION_POS     (SMART_FMT_POS1 + 4)
 #define SMART_FMT_NAMESIZE_POS    (SMART_FMT_POS1 + 5)
 #define SMART_FMT_ROOTDIRS_POS    (SMART_FMT_POS1 + 6)
+#define SMART_FMT_CKPT_POS        (SMART_FMT_POS1 + 7)
 #define SMARTFS_FMT_AGING_POS     32
 
 #define SMART_FMT_VERSION           1
@@ -119,6 +129,65 @@
 #define offsetof(type, member) ( (size_t) &( ( (type *) 0)->member))
 #endif
 
+/* Garbage collection is forced in the context of the caller once the free
+ * sector count drops to the reserve needed to relocate a complete erase
+ * block.  With background collection enabled the collector thread is woken
+ * one erase block earlier so that the reserve is normally never reached.
+ */
+
+#define SMART_GC_RESERVE(d)         ((d)->sectorsPerBlk + 4)
+
+#ifdef CONFIG_MTD_SMART_BGGC
+#  define SMART_GC_THRESHOLD(d)     (SMART_GC_RESERVE(d) + (d)->sectorsPerBlk)
+#else
+#  define SMART_GC_THRESHOLD(d)     SMART_GC_RESERVE(d)
+#endif
+
+#define SMART_GC_UNLIMITED          0xFFFF
+
+#ifndef CONFIG_MTD_SMART_BGGC_PRIORITY
+#  define CONFIG_MTD_SMART_BGGC_PRIORITY 50
+#endif
+
+#ifndef CONFIG_MTD_SMART_BGGC_STACKSIZE
+#  define CONFIG_MTD_SMART_BGGC_STACKSIZE 1024
+#endif
+
+#ifndef CONFIG_MTD_SMART_BGGC_BUDGET
+#  define CONFIG_MTD_SMART_BGGC_BUDGET 4
+#endif
+
+#ifndef CONFIG_MTD_SMART_BGGC_INTERVAL
+#  define CONFIG_MTD_SMART_BGGC_INTERVAL 10
+#endif
+
+#ifndef CONFIG_MTD_SMART_WEAR_THRESHOLD
+#  define CONFIG_MTD_SMART_WEAR_THRESHOLD 0
+#endif
+
+/* Checkpoint area definitions.  Each of the two areas starts with a header
+ * block, followed by the map snapshot and the journal of 8 byte records.
+ * The header status byte is programmed to COMMITTED once the snapshot is
+ * complete and to INVALID when the area no longer describes the device.
+ */
+
+#define SMART_CKPT_SIG1           'S'
+#define SMART_CKPT_SIG2           'M'
+#define SMART_CKPT_SIG3           'C'
+#define SMART_CKPT_SIG4           'P'
+#define SMART_CKPT_VERSION        1
+
+#define SMART_CKPT_COMMITTED      (CONFIG_SMARTFS_ERASEDSTATE ^ 0x55)
+#define SMART_CKPT_INVALID        (CONFIG_SMARTFS_ERASEDSTATE ^ 0xFF)
+
+#define SMART_CKPT_MAP            1   /* Logical sector written to physical */
+#define SMART_CKPT_FREE           2   /* Logical sector released */
+#define SMART_CKPT_ERASE          3   /* Erase block erased */
+
+#ifndef CONFIG_MTD_SMART_CHECKPOINT_JOURNAL
+#  define CONFIG_MTD_SMART_CHECKPOINT_JOURNAL 512
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -133,9 +202,37 @@ struct smart_struct_s
   uint16_t              sectorsPerBlk;    /* Number of sectors per erase block */
   uint16_t              sectorsize;       /* Sector size on device */
   uint16_t              totalsectors;     /* Total number of sectors on device */
+  uint16_t              releasesectors;   /* Total number of released sectors */
   FAR uint16_t         *sMap;             /* Virtual to physical sector map */
+  FAR uint16_t         *freeheap;         /* Erase blocks as a max-heap on freecount */
+  FAR uint16_t         *heappos;          /* Position of each erase block in freeheap */
+  FAR uint16_t         *erasecount;       /* Erase count per erase block (RAM only) */
   FAR uint8_t          *releasecount;     /* Count of released sectors per erase block */
   FAR uint8_t          *freecount;        /* Count of free sectors per erase block */
+  uint16_t              gcblock;          /* Erase block being collected or 0xFFFF */
+  uint16_t              gcsector;         /* Next sector to examine in gcblock */
+  sem_t                 exclsem;          /* Serializes access to the device */
+#ifdef CONFIG_MTD_SMART_BGGC
+  sem_t                 gcsem;            /* Wakes up the collector thread */
+  pid_t                 gcpid;            /* PID of the collector thread */
+#endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  bool                  ckptenabled;      /* Device has checkpoint areas */
+  bool                  ckptvalid;        /* Current checkpoint describes the device */
+  uint8_t               ckptblocks;       /* Erase blocks per checkpoint area */
+  uint8_t               ckptarea;         /* Area holding the current checkpoint */
+  uint8_t               fmtckptblocks;    /* ckptblocks recorded by the format */
+  uint16_t              ckptnrec;         /* Records used in the current journal */
+  uint16_t              ckptmaxrec;       /* Capacity of the journal */
+  uint32_t              ckptseq;          /* Sequence of the current checkpoint */
+  uint32_t              mapsize;          /* Snapshot size, rounded to MTD blocks */
+  FAR uint8_t          *ckptbuf;          /* MTD block buffer for checkpoint I/O */
+#endif
+#ifdef CONFIG_MTD_STATS
+  uint32_t              nerases;          /* Number of erase block erases */
+  uint32_t              ngcblocks;        /* Erase blocks collected */
+  uint32_t              nrelocs;          /* Sectors relocated by collection */
+#endif
   FAR char             *rwbuffer;         /* Our sector read/write buffer */
   char                  partname[SMART_PARTNAME_SIZE]; /* Optional partition name */
   uint8_t               formatversion;    /* Format version on the device */
@@ -171,6 +268,29 @@ struct smart_sect_header_s
                                            * Bit 1-0: Format version    */
 };
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+struct smart_ckpt_header_s
+{
+  uint8_t               sig[4];           /* SMART_CKPT_SIG1-4 */
+  uint8_t               status;           /* Erased, COMMITTED or INVALID */
+  uint8_t               version;          /* SMART_CKPT_VERSION */
+  uint16_t              sectorsize;       /* Geometry the snapshot applies to */
+  uint16_t              neraseblocks;
+  uint16_t              totalsectors;
+  uint32_t              seq;              /* Incremented on every checkpoint */
+  uint32_t              crc;              /* CRC32 of the snapshot */
+};
+
+struct smart_ckpt_rec_s
+{
+  uint8_t               type;             /* SMART_CKPT_MAP, FREE or ERASE */
+  uint8_t               check;            /* Inverted XOR of the other bytes */
+  uint16_t              logical;          /* Logical sector */
+  uint16_t              physical;         /* Physical sector or erase block */
+  uint16_t              reserved;         /* Left in the erased state */
+};
+#endif
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -185,6 +305,14 @@ static ssize_t smart_read(FAR struct inode *inode, unsigned char *buffer,
 static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
                  size_t start_sector, unsigned int nsectors);
 #endif
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static void    smart_ckpt_invalidate(FAR struct smart_struct_s *dev);
+static void    smart_ckpt_log(FAR struct smart_struct_s *dev, uint8_t type,
+                 uint16_t logical, uint16_t physical);
+#else
+#  define smart_ckpt_invalidate(d)
+#  define smart_ckpt_log(d,t,l,p)
+#endif
 static int     smart_geometry(FAR struct inode *inode, struct geometry *geometry);
 static int     smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg);
 
@@ -210,6 +338,39 @@ static const struct block_operations g_bops =
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: smart_lock
+ *
+ * Description: Get exclusive access to the device.  The device is shared
+ *              between the file system and, if enabled, the background
+ *              garbage collection thread.
+ *
+ ****************************************************************************/
+
+static void smart_lock(FAR struct smart_struct_s *dev)
+{
+  while (sem_wait(&dev->exclsem) != OK)
+    {
+      /* The only case that an error should occur here is if
+       * the wait was awakened by a signal.
+       */
+
+      ASSERT(*get_errno_ptr() == EINTR);
+    }
+}
+
+/****************************************************************************
+ * Name: smart_unlock
+ *
+ * Description: Relinquish exclusive access to the device.
+ *
+ ****************************************************************************/
+
+static inline void smart_unlock(FAR struct smart_struct_s *dev)
+{
+  sem_post(&dev->exclsem);
+}
+
 /****************************************************************************
  * Name: smart_open
  *
@@ -281,6 +442,7 @@ static ssize_t smart_read(FAR struct inode *inode, unsigned char *buffer,
                           size_t start_sector, unsigned int nsectors)
 {
   struct smart_struct_s *dev;
+  ssize_t ret;
 
   fvdbg("SMART: sector: %d nsectors: %d\n", start_sector, nsectors);
 
@@ -290,7 +452,11 @@ static ssize_t smart_read(FAR struct inode *inode, unsigned char *buffer,
 #else
   dev = (struct smart_struct_s *)inode->i_private;
 #endif
-  return smart_reload(dev, buffer, start_sector, nsectors);
+
+  smart_lock(dev);
+  ret = smart_reload(dev, buffer, start_sector, nsectors);
+  smart_unlock(dev);
+  return ret;
 }
 
 /****************************************************************************
@@ -326,7 +492,13 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
   dev = (struct smart_struct_s *)inode->i_private;
 #endif
 
-  /* I think maybe we need to lock on a mutex here */
+  smart_lock(dev);
+
+  /* Raw writes bypass the sector map, so the checkpoint can no longer
+   * describe the device.
+   */
+
+  smart_ckpt_invalidate(dev);
 
   /* Get the aligned block.  Here is is assumed: (1) The number of R/W blocks
    * per erase block is a power of 2, and (2) the erase begins with that same
@@ -365,10 +537,7 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
           if (ret < 0)
             {
               fdbg("Erase block=%d failed: %d\n", eraseblock, ret);
-
-              /* Unlock the mutex if we add one */
-
-              return ret;
+              goto errout;
             }
         }
 
@@ -394,10 +563,8 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
           /* The block is not empty!!  What to do? */
 
           fdbg("Write block %d failed: %d.\n", nextblock, nxfrd);
-
-          /* Unlock the mutex if we add one */
-
-          return -EIO;
+          ret = -EIO;
+          goto errout;
         }
 
       /* Then update for amount written */
@@ -408,7 +575,11 @@ static ssize_t smart_write(FAR struct inode *inode, const unsigned char *buffer,
       alignedblock += mtdBlksPerErase;
     }
 
-  return nsectors;
+  ret = nsectors;
+
+errout:
+  smart_unlock(dev);
+  return ret;
 }
 #endif /* CONFIG_FS_WRITABLE */
 
@@ -463,6 +634,43 @@ static int smart_geometry(FAR struct inode *inode, struct geometry *geometry)
   return -EINVAL;
 }
 
+/****************************************************************************
+ * Name: smart_ckpt_nblocks
+ *
+ * Description: Returns the number of erase blocks needed by one checkpoint
+ *              area for the current sector size, or zero if the device is
+ *              too small to spare two of them.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static uint8_t smart_ckpt_nblocks(struct smart_struct_s *dev,
+                                  uint32_t erasesize)
+{
+  uint32_t  nbytes;
+  uint32_t  nblocks;
+
+  /* Size the area for the whole device; the map of the remaining erase
+   * blocks is a little smaller.
+   */
+
+  nbytes = (uint32_t)dev->geo.neraseblocks * dev->sectorsPerBlk *
+           sizeof(uint16_t) + dev->geo.neraseblocks * (sizeof(uint16_t) + 2);
+  nbytes = (nbytes + dev->geo.blocksize - 1) / dev->geo.blocksize *
+           dev->geo.blocksize;
+  nbytes += dev->geo.blocksize + CONFIG_MTD_SMART_CHECKPOINT_JOURNAL *
+            sizeof(struct smart_ckpt_rec_s);
+
+  nblocks = (nbytes + erasesize - 1) / erasesize;
+  if (nblocks > 0xFE || (nblocks << 2) > dev->geo.neraseblocks)
+    {
+      return 0;
+    }
+
+  return (uint8_t)nblocks;
+}
+#endif
+
 /****************************************************************************
  * Name: smart_setsectorsize
  *
@@ -475,6 +683,10 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
 {
   uint32_t  erasesize;
   uint32_t  totalsectors;
+  uint32_t  mapsize;
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  uint32_t  offset;
+#endif
 
   /* Validate the size isn't zero so we don't divide by zero below */
 
@@ -499,6 +711,25 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
   dev->mtdBlksPerSector = dev->sectorsize / dev->geo.blocksize;
   dev->sectorsPerBlk = erasesize / dev->sectorsize;
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Reserve the two checkpoint areas at the end of the device */
+
+  dev->ckptblocks = 0;
+  dev->ckptvalid = false;
+  if (dev->ckptenabled)
+    {
+      dev->ckptblocks = smart_ckpt_nblocks(dev, erasesize);
+      if (dev->ckptblocks == 0)
+        {
+          dev->ckptenabled = false;
+        }
+      else
+        {
+          dev->neraseblocks -= dev->ckptblocks << 1;
+        }
+    }
+#endif
+
   /* Release any existing rwbuffer and sMap */
 
   if (dev->sMap != NULL)
@@ -512,14 +743,30 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
     }
 
   /* Allocate a virtual to physical sector map buffer.  Also allocate
-   * the storage space for releasecount and freecounts.
+   * the storage space for the erase counts, the releasecount and
+   * freecounts and the free block heap.  Everything up to the heap is
+   * what a checkpoint saves, padded to whole MTD blocks.
    */
 
   totalsectors = dev->neraseblocks * dev->sectorsPerBlk;
   dev->totalsectors = (uint16_t) totalsectors;
 
-  dev->sMap = (uint16_t *) kmm_malloc(totalsectors * sizeof(uint16_t) +
-              (dev->neraseblocks << 1));
+  mapsize = totalsectors * sizeof(uint16_t) +
+            dev->neraseblocks * (sizeof(uint16_t) + 2);
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  mapsize = (mapsize + dev->geo.blocksize - 1) / dev->geo.blocksize *
+            dev->geo.blocksize;
+  dev->mapsize = mapsize;
+  if (dev->ckptenabled)
+    {
+      offset = ((uint32_t)dev->ckptblocks * erasesize - dev->geo.blocksize -
+                mapsize) / sizeof(struct smart_ckpt_rec_s);
+      dev->ckptmaxrec = offset > 0xFFFF ? 0xFFFF : (uint16_t)offset;
+    }
+#endif
+
+  dev->sMap = (uint16_t *) kmm_malloc(mapsize +
+              dev->neraseblocks * 2 * sizeof(uint16_t));
   if (!dev->sMap)
     {
       fdbg("Error allocating SMART virtual map buffer\n");
@@ -527,8 +774,16 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
       return -EINVAL;
     }
 
-  dev->releasecount = (uint8_t *) dev->sMap + (totalsectors * sizeof(uint16_t));
+  dev->erasecount = dev->sMap + totalsectors;
+  dev->releasecount = (uint8_t *) (dev->erasecount + dev->neraseblocks);
   dev->freecount = dev->releasecount + dev->neraseblocks;
+  dev->freeheap = (uint16_t *) ((uint8_t *) dev->sMap + mapsize);
+  dev->heappos = dev->freeheap + dev->neraseblocks;
+
+  memset(dev->erasecount, 0, dev->neraseblocks * sizeof(uint16_t));
+  dev->releasesectors = 0;
+  dev->gcblock = 0xFFFF;
+  dev->gcsector = 0;
 
   /* Allocate a read/write buffer */
 
@@ -544,6 +799,144 @@ static int smart_setsectorsize(struct smart_struct_s *dev, uint16_t size)
   return OK;
 }
 
+/****************************************************************************
+ * Name: smart_heapless
+ *
+ * Description:  Returns true if erase block a is a worse allocation choice
+ *               than erase block b:  It has fewer free sectors or, with the
+ *               same number of free sectors, it has been erased more often.
+ *
+ ****************************************************************************/
+
+static inline bool smart_heapless(FAR struct smart_struct_s *dev,
+                                  uint16_t a, uint16_t b)
+{
+  if (dev->freecount[a] != dev->freecount[b])
+    {
+      return dev->freecount[a] < dev->freecount[b];
+    }
+
+  return dev->erasecount[a] > dev->erasecount[b];
+}
+
+/****************************************************************************
+ * Name: smart_heapswap
+ *
+ * Description:  Exchanges two entries of the free block heap.
+ *
+ ****************************************************************************/
+
+static void smart_heapswap(FAR struct smart_struct_s *dev, uint16_t i,
+                           uint16_t j)
+{
+  uint16_t block;
+
+  block = dev->freeheap[i];
+  dev->freeheap[i] = dev->freeheap[j];
+  dev->freeheap[j] = block;
+
+  dev->heappos[dev->freeheap[i]] = i;
+  dev->heappos[dev->freeheap[j]] = j;
+}
+
+/****************************************************************************
+ * Name: smart_heapdown
+ *
+ * Description:  Moves the heap entry at pos down until neither of its
+ *               children is a better allocation choice.
+ *
+ ****************************************************************************/
+
+static void smart_heapdown(FAR struct smart_struct_s *dev, uint16_t pos)
+{
+  uint32_t child;
+
+  for (; ; )
+    {
+      child = ((uint32_t)pos << 1) + 1;
+      if (child >= dev->neraseblocks)
+        {
+          break;
+        }
+
+      if (child + 1 < dev->neraseblocks &&
+          smart_heapless(dev, dev->freeheap[child], dev->freeheap[child + 1]))
+        {
+          child++;
+        }
+
+      if (!smart_heapless(dev, dev->freeheap[pos], dev->freeheap[child]))
+        {
+          break;
+        }
+
+      smart_heapswap(dev, pos, (uint16_t)child);
+      pos = (uint16_t)child;
+    }
+}
+
+/****************************************************************************
+ * Name: smart_heapinit
+ *
+ * Description:  Builds the free block heap from the freecount array.  The
+ *               erase block to allocate from is then always freeheap[0].
+ *
+ ****************************************************************************/
+
+static void smart_heapinit(FAR struct smart_struct_s *dev)
+{
+  uint16_t x;
+
+  for (x = 0; x < dev->neraseblocks; x++)
+    {
+      dev->freeheap[x] = x;
+      dev->heappos[x] = x;
+    }
+
+  for (x = dev->neraseblocks >> 1; x > 0; x--)
+    {
+      smart_heapdown(dev, x - 1);
+    }
+}
+
+/****************************************************************************
+ * Name: smart_setfreecount
+ *
+ * Description:  Updates the free sector count of an erase block and
+ *               restores the heap order in O(log n).
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_WRITABLE
+static void smart_setfreecount(FAR struct smart_struct_s *dev,
+                               uint16_t block, uint8_t count)
+{
+  uint16_t pos;
+  uint16_t parent;
+
+  dev->freecount[block] = count;
+
+  /* Move the block up while it is a better choice than its parent, then
+   * down while one of its children is a better choice.
+   */
+
+  pos = dev->heappos[block];
+  while (pos > 0)
+    {
+      parent = (pos - 1) >> 1;
+      if (!smart_heapless(dev, dev->freeheap[parent], block))
+        {
+          break;
+        }
+
+      smart_heapswap(dev, pos, parent);
+      pos = parent;
+    }
+
+  smart_heapdown(dev, pos);
+}
+#endif /* CONFIG_FS_WRITABLE */
+
 /****************************************************************************
  * Name: smart_bytewrite
  *
@@ -615,85 +1008,850 @@ errout:
 }
 
 /****************************************************************************
- * Name: smart_scan
+ * Name: smart_eraseblock
  *
- * Description: Performs a scan of the MTD device searching for format
- *              information and fills in logical sector mapping, freesector
- *              count, etc.
+ * Description:  Erases an erase block that no longer holds live data and
+ *               accounts for the erase.  Block zero also gets the sector
+ *               size written back to its first header.
  *
  ****************************************************************************/
 
-static int smart_scan(struct smart_struct_s *dev)
+#ifdef CONFIG_FS_WRITABLE
+static int smart_eraseblock(struct smart_struct_s *dev, uint16_t block)
 {
-  int       sector;
+  size_t    offset;
+  uint8_t   newstatus;
+  uint8_t   sectsize;
   int       ret;
-  int       offset;
-  uint16_t  totalsectors;
-  uint16_t  sectorsize;
-  uint16_t  logicalsector;
-  uint16_t  seq1;
-  uint16_t  seq2;
-  size_t    readaddress;
-  struct    smart_sect_header_s header;
-#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
-  int       x;
-  char      devname[22];
-  struct    smart_multiroot_device_s *rootdirdev;
-#endif
-
-  fvdbg("Entry\n");
-
-  /* Read the 1st header from the device.  We always keep the
-   * 1st sector's header's sectorsize field accurate, even
-   * after we erase an MTD block/sector */
-
-  ret = MTD_READ(dev->mtd, 0, sizeof(struct smart_sect_header_s),
-                 (uint8_t *) &header);
-  if (ret != sizeof(struct smart_sect_header_s))
-    {
-      goto err_out;
-    }
 
-  /* Now set the sectorsize and other sectorsize derived variables */
-
-  if (header.status == CONFIG_SMARTFS_ERASEDSTATE)
-    {
-      sectorsize = CONFIG_MTD_SMART_SECTOR_SIZE;
-    }
-  else
+  ret = MTD_ERASE(dev->mtd, block, 1);
+  if (ret < 0)
     {
-      sectorsize = (header.status & SMART_STATUS_SIZEBITS) << 7;
+      fdbg("Error %d erasing block %d\n", -ret, block);
+      return ret;
     }
 
-  ret = smart_setsectorsize(dev, sectorsize);
-  if (ret != OK)
+  if (dev->erasecount[block] < 0xFFFF)
     {
-      goto err_out;
+      dev->erasecount[block]++;
     }
 
-  /* Initialize the device variables */
-
-  totalsectors = dev->neraseblocks * dev->sectorsPerBlk;
-  dev->formatstatus = SMART_FMT_STAT_NOFMT;
-  dev->freesectors = totalsectors;
+#ifdef CONFIG_MTD_STATS
+  dev->nerases++;
+#endif
 
-  /* Initialize the freecount and releasecount arrays */
+  /* If this is block zero, then be sure to write the sector size */
 
-  for (sector = 0; sector < dev->neraseblocks; sector++)
+  if (block == 0)
     {
-      dev->freecount[sector] = dev->sectorsPerBlk;
-      dev->releasecount[sector] = 0;
-    }
+      /* Set the sector size in the 1st header */
 
-  /* Initialize the sector map */
+      sectsize = dev->sectorsize >> 7;
+#if ( CONFIG_SMARTFS_ERASEDSTATE == 0xFF )
+      newstatus = (uint8_t) ~SMART_STATUS_SIZEBITS | sectsize;
+#else
+      newstatus = (uint8_t) sectsize;
+#endif
+      /* Write the sector size to the device */
 
-  for (sector = 0; sector < totalsectors; sector++)
-    {
-      dev->sMap[sector] = -1;
+      offset = offsetof(struct smart_sect_header_s, status);
+      ret = smart_bytewrite(dev, offset, 1, &newstatus);
+      if (ret < 0)
+        {
+          fdbg("Error %d setting sector 0 size\n", -ret);
+        }
     }
 
-  /* Now scan the MTD device */
-
+  return OK;
+}
+#endif /* CONFIG_FS_WRITABLE */
+
+/****************************************************************************
+ * Name: smart_readformat
+ *
+ * Description:  Reads and validates the format signature stored in logical
+ *               sector zero at the given address and updates the device
+ *               format information.  Returns -EINVAL if the signature is
+ *               not valid.
+ *
+ ****************************************************************************/
+
+static int smart_readformat(struct smart_struct_s *dev, size_t readaddress)
+{
+  int       ret;
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  int       x;
+  char      devname[22];
+  struct    smart_multiroot_device_s *rootdirdev;
+#endif
+
+  /* Read the sector data */
+
+  ret = MTD_READ(dev->mtd, readaddress, 32, (uint8_t*) dev->rwbuffer);
+  if (ret != 32)
+    {
+      fdbg("Error reading format sector.\n");
+      return -EIO;
+    }
+
+  /* Validate the format signature */
+
+  if (dev->rwbuffer[SMART_FMT_POS1] != SMART_FMT_SIG1 ||
+      dev->rwbuffer[SMART_FMT_POS2] != SMART_FMT_SIG2 ||
+      dev->rwbuffer[SMART_FMT_POS3] != SMART_FMT_SIG3 ||
+      dev->rwbuffer[SMART_FMT_POS4] != SMART_FMT_SIG4)
+    {
+      /* Invalid signature on a sector claiming to be sector 0!
+       * What should we do?  Release it?*/
+
+      return -EINVAL;
+    }
+
+  /* TODO: May want to validate / save the erase block aging info */
+
+  /* Mark the volume as formatted and set the sector size */
+
+  dev->formatstatus = SMART_FMT_STAT_FORMATTED;
+  dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
+  dev->formatversion = dev->rwbuffer[SMART_FMT_VERSION_POS];
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  dev->fmtckptblocks = dev->rwbuffer[SMART_FMT_CKPT_POS];
+#endif
+
+#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
+  dev->rootdirentries = dev->rwbuffer[SMART_FMT_ROOTDIRS_POS];
+
+  /* If rootdirentries is greater than 1, then we need to register
+   * additional block devices.
+   */
+
+  for (x = 1; x < dev->rootdirentries; x++)
+    {
+      if (dev->partname[0] != '\0')
+        {
+          snprintf(dev->rwbuffer, sizeof(devname), "/dev/smart%d%sd%d",
+                  dev->minor, dev->partname, x+1);
+        }
+      else
+        {
+          snprintf(devname, sizeof(devname), "/dev/smart%dd%d", dev->minor,
+                   x + 1);
+        }
+
+      /* Inode private data is a reference to a struct containing
+       * the SMART device structure and the root directory number.
+       */
+
+      rootdirdev = (struct smart_multiroot_device_s*) kmm_malloc(sizeof(*rootdirdev));
+      if (rootdirdev == NULL)
+        {
+          fdbg("Memory alloc failed\n");
+          return -ENOMEM;
+        }
+
+      /* Populate the rootdirdev */
+
+      rootdirdev->dev = dev;
+      rootdirdev->rootdirnum = x;
+      ret = register_blockdriver(dev->rwbuffer, &g_bops, 0, rootdirdev);
+
+      /* Inode private data is a reference to the SMART device structure */
+
+      ret = register_blockdriver(devname, &g_bops, 0, rootdirdev);
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_offset
+ *
+ * Description:  Returns the byte address of a checkpoint area.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+static inline uint32_t smart_ckpt_offset(struct smart_struct_s *dev,
+                                         uint8_t area)
+{
+  return (uint32_t)(dev->neraseblocks + area * dev->ckptblocks) *
+         dev->sectorsPerBlk * dev->sectorsize;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_check
+ *
+ * Description:  Computes the check byte of a journal record.  The erased
+ *               state never yields a valid record.
+ *
+ ****************************************************************************/
+
+static uint8_t smart_ckpt_check(FAR const struct smart_ckpt_rec_s *rec)
+{
+  return ~(rec->type ^ (rec->logical & 0xFF) ^ (rec->logical >> 8) ^
+           (rec->physical & 0xFF) ^ (rec->physical >> 8));
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_program
+ *
+ * Description:  Programs bytes within a single MTD block of a checkpoint
+ *               area.  Unlike smart_bytewrite() this leaves the sector
+ *               rwbuffer alone, so it may be used in the middle of a sector
+ *               update.
+ *
+ ****************************************************************************/
+
+static int smart_ckpt_program(struct smart_struct_s *dev, uint32_t offset,
+                              FAR const void *buffer, size_t nbytes)
+{
+  uint32_t  block;
+  ssize_t   ret;
+
+#ifdef CONFIG_MTD_BYTE_WRITE
+  if (dev->mtd->write != NULL)
+    {
+      ret = dev->mtd->write(dev->mtd, offset, nbytes, buffer);
+      return ret == nbytes ? OK : -EIO;
+    }
+#endif
+
+  block = offset / dev->geo.blocksize;
+  DEBUGASSERT(offset + nbytes <= (block + 1) * dev->geo.blocksize);
+
+  ret = MTD_BREAD(dev->mtd, block, 1, dev->ckptbuf);
+  if (ret != 1)
+    {
+      return -EIO;
+    }
+
+  memcpy(&dev->ckptbuf[offset - block * dev->geo.blocksize], buffer, nbytes);
+
+  ret = MTD_BWRITE(dev->mtd, block, 1, dev->ckptbuf);
+  return ret == 1 ? OK : -EIO;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_setstatus
+ *
+ * Description:  Programs the status byte of a checkpoint area header.
+ *
+ ****************************************************************************/
+
+static int smart_ckpt_setstatus(struct smart_struct_s *dev, uint8_t area,
+                                uint8_t status)
+{
+  return smart_ckpt_program(dev, smart_ckpt_offset(dev, area) +
+                            offsetof(struct smart_ckpt_header_s, status),
+                            &status, 1);
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_invalidate
+ *
+ * Description:  Marks the current checkpoint as no longer describing the
+ *               device, so the next mount performs a full scan.
+ *
+ ****************************************************************************/
+
+static void smart_ckpt_invalidate(FAR struct smart_struct_s *dev)
+{
+  if (dev->ckptvalid)
+    {
+      (void)smart_ckpt_setstatus(dev, dev->ckptarea, SMART_CKPT_INVALID);
+      dev->ckptvalid = false;
+    }
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_write
+ *
+ * Description:  Writes a snapshot of the sector map and the per erase block
+ *               counts to the checkpoint area not in use and starts a new
+ *               journal there.
+ *
+ ****************************************************************************/
+
+static int smart_ckpt_write(FAR struct smart_struct_s *dev)
+{
+  struct    smart_ckpt_header_s *header;
+  uint32_t  startblock;
+  size_t    nblocks;
+  uint8_t   area;
+  int       ret;
+
+  /* Retire the current checkpoint first.  Should we lose power before the
+   * new one is committed, the next mount simply scans the device.
+   */
+
+  (void)smart_ckpt_setstatus(dev, dev->ckptarea, SMART_CKPT_INVALID);
+  dev->ckptvalid = false;
+
+  area = dev->ckptarea ^ 1;
+  ret = MTD_ERASE(dev->mtd, dev->neraseblocks + area * dev->ckptblocks,
+                  dev->ckptblocks);
+  if (ret < 0)
+    {
+      fdbg("Error %d erasing checkpoint area %d\n", -ret, area);
+      return ret;
+    }
+
+  /* Write the snapshot behind the header block */
+
+  startblock = smart_ckpt_offset(dev, area) / dev->geo.blocksize;
+  nblocks = dev->mapsize / dev->geo.blocksize;
+  ret = MTD_BWRITE(dev->mtd, startblock + 1, nblocks, (uint8_t *) dev->sMap);
+  if (ret != nblocks)
+    {
+      fdbg("Error writing checkpoint snapshot\n");
+      return -EIO;
+    }
+
+  /* Then the header, committed separately once it is on the device */
+
+  memset(dev->ckptbuf, CONFIG_SMARTFS_ERASEDSTATE, dev->geo.blocksize);
+  header = (FAR struct smart_ckpt_header_s *) dev->ckptbuf;
+  header->sig[0] = SMART_CKPT_SIG1;
+  header->sig[1] = SMART_CKPT_SIG2;
+  header->sig[2] = SMART_CKPT_SIG3;
+  header->sig[3] = SMART_CKPT_SIG4;
+  header->version = SMART_CKPT_VERSION;
+  header->sectorsize = dev->sectorsize;
+  header->neraseblocks = dev->neraseblocks;
+  header->totalsectors = dev->totalsectors;
+  header->seq = dev->ckptseq + 1;
+  header->crc = crc32((FAR const uint8_t *) dev->sMap, dev->mapsize);
+
+  ret = MTD_BWRITE(dev->mtd, startblock, 1, dev->ckptbuf);
+  if (ret != 1)
+    {
+      fdbg("Error writing checkpoint header\n");
+      return -EIO;
+    }
+
+  ret = smart_ckpt_setstatus(dev, area, SMART_CKPT_COMMITTED);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  dev->ckptarea = area;
+  dev->ckptseq++;
+  dev->ckptnrec = 0;
+  dev->ckptvalid = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_log
+ *
+ * Description:  Appends a record to the journal of the current checkpoint.
+ *               This must be called before the operation is performed on
+ *               the device and before the in-memory state is updated, so
+ *               that a snapshot taken when the journal is full does not
+ *               include it yet.
+ *
+ ****************************************************************************/
+
+static void smart_ckpt_log(FAR struct smart_struct_s *dev, uint8_t type,
+                           uint16_t logical, uint16_t physical)
+{
+  struct    smart_ckpt_rec_s rec;
+  uint32_t  offset;
+
+  if (!dev->ckptvalid)
+    {
+      return;
+    }
+
+  if (dev->ckptnrec >= dev->ckptmaxrec && smart_ckpt_write(dev) != OK)
+    {
+      return;
+    }
+
+  memset(&rec, CONFIG_SMARTFS_ERASEDSTATE, sizeof(rec));
+  rec.type = type;
+  rec.logical = logical;
+  rec.physical = physical;
+  rec.check = smart_ckpt_check(&rec);
+
+  offset = smart_ckpt_offset(dev, dev->ckptarea) + dev->geo.blocksize +
+           dev->mapsize + dev->ckptnrec * sizeof(struct smart_ckpt_rec_s);
+  if (smart_ckpt_program(dev, offset, &rec, sizeof(rec)) != OK)
+    {
+      smart_ckpt_invalidate(dev);
+      return;
+    }
+
+  dev->ckptnrec++;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_apply
+ *
+ * Description:  Applies a journal record to the in-memory state.  The last
+ *               record may describe an operation interrupted by a power
+ *               loss; with verify set, its outcome is checked on the device
+ *               first and 1 is returned if it never took effect.
+ *
+ ****************************************************************************/
+
+static int smart_ckpt_apply(FAR struct smart_struct_s *dev,
+                            FAR const struct smart_ckpt_rec_s *rec,
+                            bool verify)
+{
+  struct    smart_sect_header_s header;
+  uint32_t  readaddr;
+  uint16_t  oldsector;
+  uint16_t  block;
+  int       ret;
+
+  switch (rec->type)
+    {
+    case SMART_CKPT_MAP:
+      if (rec->logical >= dev->totalsectors ||
+          rec->physical >= dev->totalsectors)
+        {
+          return -EINVAL;
+        }
+
+      if (verify)
+        {
+          /* The new sector must have been committed */
+
+          readaddr = rec->physical * dev->mtdBlksPerSector *
+                     dev->geo.blocksize;
+          ret = MTD_READ(dev->mtd, readaddr,
+                         sizeof(struct smart_sect_header_s),
+                         (uint8_t *) &header);
+          if (ret != sizeof(struct smart_sect_header_s))
+            {
+              return -EIO;
+            }
+
+          if ((header.status & SMART_STATUS_COMMITTED) ==
+              (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED) ||
+              *((uint16_t *) header.logicalsector) != rec->logical)
+            {
+              /* A partially written sector is accounted as released,
+               * just like smart_scan() does.
+               */
+
+              if ((header.status & SMART_STATUS_COMMITTED) ==
+                  (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED) &&
+                  (*((uint16_t *) header.logicalsector) != 0xFFFF ||
+                   *((uint16_t *) header.seq) != 0xFFFF))
+                {
+                  block = rec->physical / dev->sectorsPerBlk;
+                  if (dev->freecount[block] > 0)
+                    {
+                      dev->freecount[block]--;
+                    }
+
+                  dev->releasecount[block]++;
+                }
+
+              return 1;
+            }
+        }
+
+      oldsector = dev->sMap[rec->logical];
+      if (oldsector != 0xFFFF)
+        {
+          if (verify)
+            {
+              /* Finish releasing the old copy like smart_scan() does for
+               * duplicate logical sectors.
+               */
+
+              readaddr = oldsector * dev->mtdBlksPerSector *
+                         dev->geo.blocksize;
+              ret = MTD_READ(dev->mtd, readaddr,
+                             sizeof(struct smart_sect_header_s),
+                             (uint8_t *) &header);
+              if (ret != sizeof(struct smart_sect_header_s))
+                {
+                  return -EIO;
+                }
+
+              if ((header.status & SMART_STATUS_RELEASED) ==
+                  (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED))
+                {
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+                  header.status &= ~SMART_STATUS_RELEASED;
+#else
+                  header.status |= SMART_STATUS_RELEASED;
+#endif
+                  ret = smart_bytewrite(dev, readaddr +
+                          offsetof(struct smart_sect_header_s, status), 1,
+                          &header.status);
+                  if (ret < 0)
+                    {
+                      return ret;
+                    }
+                }
+            }
+
+          dev->releasecount[oldsector / dev->sectorsPerBlk]++;
+        }
+
+      block = rec->physical / dev->sectorsPerBlk;
+      dev->sMap[rec->logical] = rec->physical;
+      if (dev->freecount[block] > 0)
+        {
+          dev->freecount[block]--;
+        }
+      break;
+
+    case SMART_CKPT_FREE:
+      if (rec->logical >= dev->totalsectors ||
+          rec->physical >= dev->totalsectors)
+        {
+          return -EINVAL;
+        }
+
+      if (verify)
+        {
+          /* The sector must have been marked released */
+
+          readaddr = rec->physical * dev->mtdBlksPerSector *
+                     dev->geo.blocksize;
+          ret = MTD_READ(dev->mtd, readaddr,
+                         sizeof(struct smart_sect_header_s),
+                         (uint8_t *) &header);
+          if (ret != sizeof(struct smart_sect_header_s))
+            {
+              return -EIO;
+            }
+
+          if ((header.status & SMART_STATUS_RELEASED) ==
+              (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED))
+            {
+              return 1;
+            }
+        }
+
+      dev->sMap[rec->logical] = 0xFFFF;
+      dev->releasecount[rec->physical / dev->sectorsPerBlk]++;
+      break;
+
+    case SMART_CKPT_ERASE:
+      block = rec->physical;
+      if (block >= dev->neraseblocks)
+        {
+          return -EINVAL;
+        }
+
+      /* The block held no more live data when the record was written.
+       * Erasing it again is harmless and completes an interrupted erase.
+       */
+
+      if (verify)
+        {
+          ret = smart_eraseblock(dev, block);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+      else if (dev->erasecount[block] < 0xFFFF)
+        {
+          dev->erasecount[block]++;
+        }
+
+      dev->freecount[block] = dev->sectorsPerBlk;
+      dev->releasecount[block] = 0;
+      break;
+
+    default:
+      return -EINVAL;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smart_ckpt_load
+ *
+ * Description:  Restores the device state from the most recent committed
+ *               checkpoint and replays its journal.  Any mismatch makes
+ *               this fail so that the caller falls back to a full scan.
+ *
+ ****************************************************************************/
+
+static int smart_ckpt_load(FAR struct smart_struct_s *dev)
+{
+  struct    smart_ckpt_header_s header;
+  FAR struct smart_ckpt_rec_s *rec;
+  struct    smart_ckpt_rec_s pending;
+  uint32_t  offset;
+  uint32_t  crc = 0;
+  uint32_t  seq = 0;
+  size_t    nblocks;
+  uint16_t  nrec;
+  uint16_t  x;
+  bool      havepending;
+  bool      dirty;
+  int       area;
+  int       ret;
+
+  /* Find the committed checkpoint with the highest sequence number */
+
+  area = -1;
+  dev->ckptseq = 0;
+  for (x = 0; x < 2; x++)
+    {
+      ret = MTD_READ(dev->mtd, smart_ckpt_offset(dev, x),
+                     sizeof(struct smart_ckpt_header_s), (uint8_t *) &header);
+      if (ret != sizeof(struct smart_ckpt_header_s) ||
+          header.sig[0] != SMART_CKPT_SIG1 ||
+          header.sig[1] != SMART_CKPT_SIG2 ||
+          header.sig[2] != SMART_CKPT_SIG3 ||
+          header.sig[3] != SMART_CKPT_SIG4)
+        {
+          continue;
+        }
+
+      /* New checkpoints must sort after any one still on the device */
+
+      if (header.seq > dev->ckptseq)
+        {
+          dev->ckptseq = header.seq;
+        }
+
+      if (header.status != SMART_CKPT_COMMITTED ||
+          header.version != SMART_CKPT_VERSION ||
+          header.sectorsize != dev->sectorsize ||
+          header.neraseblocks != dev->neraseblocks ||
+          header.totalsectors != dev->totalsectors)
+        {
+          continue;
+        }
+
+      if (area < 0 || header.seq > seq)
+        {
+          area = x;
+          seq = header.seq;
+          crc = header.crc;
+        }
+    }
+
+  if (area < 0)
+    {
+      return -ENOENT;
+    }
+
+  /* Load the snapshot */
+
+  offset = smart_ckpt_offset(dev, area);
+  nblocks = dev->mapsize / dev->geo.blocksize;
+  ret = MTD_BREAD(dev->mtd, offset / dev->geo.blocksize + 1, nblocks,
+                  (uint8_t *) dev->sMap);
+  if (ret != nblocks ||
+      crc32((FAR const uint8_t *) dev->sMap, dev->mapsize) != crc)
+    {
+      fdbg("Checkpoint %d is corrupted\n", area);
+      return -EIO;
+    }
+
+  /* Replay the journal.  Each record is applied once the next one shows
+   * that its operation completed; the last one is verified on the device.
+   * The journal ends at the first record that is not valid, which is
+   * either erased or torn by a power loss before its operation started.
+   */
+
+  offset += dev->geo.blocksize + dev->mapsize;
+  havepending = false;
+  dirty = false;
+
+  for (nrec = 0; nrec < dev->ckptmaxrec; nrec++)
+    {
+      x = (nrec * sizeof(struct smart_ckpt_rec_s)) % dev->geo.blocksize;
+      if (x == 0)
+        {
+          ret = MTD_BREAD(dev->mtd, (offset + nrec *
+                          sizeof(struct smart_ckpt_rec_s)) /
+                          dev->geo.blocksize, 1, dev->ckptbuf);
+          if (ret != 1)
+            {
+              return -EIO;
+            }
+        }
+
+      rec = (FAR struct smart_ckpt_rec_s *) &dev->ckptbuf[x];
+      if (rec->type < SMART_CKPT_MAP || rec->type > SMART_CKPT_ERASE ||
+          rec->check != smart_ckpt_check(rec))
+        {
+          dirty = rec->type != CONFIG_SMARTFS_ERASEDSTATE;
+          break;
+        }
+
+      if (havepending)
+        {
+          ret = smart_ckpt_apply(dev, &pending, false);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
+
+      memcpy(&pending, rec, sizeof(struct smart_ckpt_rec_s));
+      havepending = true;
+    }
+
+  if (havepending)
+    {
+      ret = smart_ckpt_apply(dev, &pending, true);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      dirty |= ret > 0;
+    }
+
+  /* Derive the totals and build the allocation heap */
+
+  dev->freesectors = 0;
+  dev->releasesectors = 0;
+  for (x = 0; x < dev->neraseblocks; x++)
+    {
+      dev->freesectors += dev->freecount[x];
+      dev->releasesectors += dev->releasecount[x];
+    }
+
+  smart_heapinit(dev);
+
+  dev->ckptarea = area;
+  dev->ckptnrec = nrec;
+  dev->ckptvalid = true;
+
+  /* Get the format information from logical sector zero */
+
+  dev->formatstatus = SMART_FMT_STAT_NOFMT;
+  if (dev->sMap[0] != 0xFFFF)
+    {
+      ret = smart_readformat(dev, dev->sMap[0] * dev->mtdBlksPerSector *
+                             dev->geo.blocksize);
+      if (ret == -EIO || ret == -ENOMEM)
+        {
+          return ret;
+        }
+    }
+
+  /* Start over with a clean journal if the last record did not complete,
+   * so that no record in the middle of a journal needs verification.
+   */
+
+  if (dirty)
+    {
+      (void)smart_ckpt_write(dev);
+    }
+
+  fvdbg("Loaded checkpoint %d seq %d, %d journal records\n", area, seq,
+        nrec);
+  return OK;
+}
+#endif /* CONFIG_MTD_SMART_CHECKPOINT */
+
+/****************************************************************************
+ * Name: smart_scan
+ *
+ * Description: Performs a scan of the MTD device searching for format
+ *              information and fills in logical sector mapping, freesector
+ *              count, etc.
+ *
+ ****************************************************************************/
+
+static int smart_scan(struct smart_struct_s *dev)
+{
+  int       sector;
+  int       ret;
+  int       offset;
+  uint16_t  totalsectors;
+  uint16_t  sectorsize;
+  uint16_t  logicalsector;
+  uint16_t  seq1;
+  uint16_t  seq2;
+  size_t    readaddress;
+  struct    smart_sect_header_s header;
+
+  fvdbg("Entry\n");
+
+  /* Read the 1st header from the device.  We always keep the
+   * 1st sector's header's sectorsize field accurate, even
+   * after we erase an MTD block/sector */
+
+  ret = MTD_READ(dev->mtd, 0, sizeof(struct smart_sect_header_s),
+                 (uint8_t *) &header);
+  if (ret != sizeof(struct smart_sect_header_s))
+    {
+      goto err_out;
+    }
+
+  /* Now set the sectorsize and other sectorsize derived variables */
+
+  if (header.status == CONFIG_SMARTFS_ERASEDSTATE)
+    {
+      sectorsize = CONFIG_MTD_SMART_SECTOR_SIZE;
+    }
+  else
+    {
+      sectorsize = (header.status & SMART_STATUS_SIZEBITS) << 7;
+    }
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+rescan:
+#endif
+  ret = smart_setsectorsize(dev, sectorsize);
+  if (ret != OK)
+    {
+      goto err_out;
+    }
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Restore the state from a checkpoint if there is a valid one.  This
+   * only reads the snapshot and the journal instead of every sector header.
+   */
+
+  if (dev->ckptenabled)
+    {
+      if (smart_ckpt_load(dev) == OK)
+        {
+          return OK;
+        }
+
+      /* The checkpoint may have been partially loaded */
+
+      memset(dev->erasecount, 0, dev->neraseblocks * sizeof(uint16_t));
+      dev->releasesectors = 0;
+    }
+#endif
+
+  /* Initialize the device variables */
+
+  totalsectors = dev->neraseblocks * dev->sectorsPerBlk;
+  dev->formatstatus = SMART_FMT_STAT_NOFMT;
+  dev->freesectors = totalsectors;
+
+  /* Initialize the freecount and releasecount arrays */
+
+  for (sector = 0; sector < dev->neraseblocks; sector++)
+    {
+      dev->freecount[sector] = dev->sectorsPerBlk;
+      dev->releasecount[sector] = 0;
+    }
+
+  /* Initialize the sector map */
+
+  for (sector = 0; sector < totalsectors; sector++)
+    {
+      dev->sMap[sector] = -1;
+    }
+
+  /* Now scan the MTD device */
+
   for (sector = 0; sector < totalsectors; sector++)
     {
       fvdbg("Scan sector %d\n", sector);
@@ -726,6 +1884,20 @@ static int smart_scan(struct smart_struct_s *dev)
       if ((header.status & SMART_STATUS_COMMITTED) ==
               (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED))
         {
+          /* A sector whose write was interrupted before the commit is
+           * neither free nor valid.  Account for it as released so the
+           * allocator skips it and garbage collection reclaims it.
+           */
+
+          if (*((uint16_t *) header.logicalsector) != 0xFFFF ||
+              *((uint16_t *) header.seq) != 0xFFFF)
+            {
+              dev->freecount[sector / dev->sectorsPerBlk]--;
+              dev->freesectors--;
+              dev->releasecount[sector / dev->sectorsPerBlk]++;
+              dev->releasesectors++;
+            }
+
           continue;
         }
 
@@ -744,6 +1916,7 @@ static int smart_scan(struct smart_struct_s *dev)
               (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED))
         {
           dev->releasecount[sector / dev->sectorsPerBlk]++;
+          dev->releasesectors++;
           continue;
         }
 
@@ -769,80 +1942,15 @@ static int smart_scan(struct smart_struct_s *dev)
 
       if (logicalsector == 0)
         {
-          /* Read the sector data */
-
-          ret = MTD_READ(dev->mtd, readaddress, 32,
-                         (uint8_t*) dev->rwbuffer);
-          if (ret != 32)
+          ret = smart_readformat(dev, readaddress);
+          if (ret == -EINVAL)
             {
-              fdbg("Error reading physical sector %d.\n", sector);
-              goto err_out;
+              continue;
             }
-
-          /* Validate the format signature */
-
-          if (dev->rwbuffer[SMART_FMT_POS1] != SMART_FMT_SIG1 ||
-              dev->rwbuffer[SMART_FMT_POS2] != SMART_FMT_SIG2 ||
-              dev->rwbuffer[SMART_FMT_POS3] != SMART_FMT_SIG3 ||
-              dev->rwbuffer[SMART_FMT_POS4] != SMART_FMT_SIG4)
-           {
-             /* Invalid signature on a sector claiming to be sector 0!
-              * What should we do?  Release it?*/
-
-             continue;
-           }
-
-          /* TODO: May want to validate / save the erase block aging info */
-
-          /* Mark the volume as formatted and set the sector size */
-
-          dev->formatstatus = SMART_FMT_STAT_FORMATTED;
-          dev->namesize = dev->rwbuffer[SMART_FMT_NAMESIZE_POS];
-          dev->formatversion = dev->rwbuffer[SMART_FMT_VERSION_POS];
-
-#ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
-          dev->rootdirentries = dev->rwbuffer[SMART_FMT_ROOTDIRS_POS];
-
-          /* If rootdirentries is greater than 1, then we need to register
-           * additional block devices.
-           */
-
-          for (x = 1; x < dev->rootdirentries; x++)
+          else if (ret < 0)
             {
-              if (dev->partname[0] != '\0')
-                {
-                  snprintf(dev->rwbuffer, sizeof(devname), "/dev/smart%d%sd%d",
-                          dev->minor, dev->partname, x+1);
-                }
-              else
-                {
-                  snprintf(devname, sizeof(devname), "/dev/smart%dd%d", dev->minor,
-                           x + 1);
-                }
-
-              /* Inode private data is a reference to a struct containing
-               * the SMART device structure and the root directory number.
-               */
-
-              rootdirdev = (struct smart_multiroot_device_s*) kmm_malloc(sizeof(*rootdirdev));
-              if (rootdirdev == NULL)
-                {
-                  fdbg("Memory alloc failed\n");
-                  ret = -ENOMEM;
-                  goto err_out;
-                }
-
-              /* Populate the rootdirdev */
-
-              rootdirdev->dev = dev;
-              rootdirdev->rootdirnum = x;
-              ret = register_blockdriver(dev->rwbuffer, &g_bops, 0, rootdirdev);
-
-              /* Inode private data is a reference to the SMART device structure */
-
-              ret = register_blockdriver(devname, &g_bops, 0, rootdirdev);
+              goto err_out;
             }
-#endif
         }
 
       /* Test for duplicate logical sectors on the device */
@@ -915,6 +2023,14 @@ static int smart_scan(struct smart_struct_s *dev)
               fdbg("Error %d releasing duplicate sector\n", -ret);
               goto err_out;
             }
+
+          dev->releasecount[loser / dev->sectorsPerBlk]++;
+          dev->releasesectors++;
+
+          if (loser == sector)
+            {
+              continue;
+            }
         }
 
       /* Update the logical to physical sector map */
@@ -922,6 +2038,31 @@ static int smart_scan(struct smart_struct_s *dev)
       dev->sMap[logicalsector] = sector;
     }
 
+  /* Now that the free counts are known, build the allocation heap */
+
+  smart_heapinit(dev);
+
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  if (dev->ckptenabled)
+    {
+      /* A device formatted without checkpoint areas keeps its data up to
+       * the end of the flash.  Scan it again as a whole.
+       */
+
+      if (dev->formatstatus != SMART_FMT_STAT_FORMATTED ||
+          dev->fmtckptblocks != dev->ckptblocks)
+        {
+          fvdbg("No checkpoint areas, rescanning the whole device\n");
+          dev->ckptenabled = false;
+          goto rescan;
+        }
+
+      /* Save the scan results so the next mount can skip the scan */
+
+      (void)smart_ckpt_write(dev);
+    }
+#endif
+
   fdbg("SMART Scan\n");
   fdbg("   Erase size:   %10d\n", dev->sectorsPerBlk * dev->sectorsize);
   fdbg("   Erase count:  %10d\n", dev->neraseblocks);
@@ -952,7 +2093,6 @@ static inline int smart_getformat(struct smart_struct_s *dev,
 #endif
 {
   int ret;
-  int x;
 
   fvdbg("Entry\n");
   DEBUGASSERT(fmt);
@@ -997,14 +2137,11 @@ static inline int smart_getformat(struct smart_struct_s *dev,
 
   /* Add the released sectors to the reported free sector count */
 
-  for (x = 0; x < dev->neraseblocks; x++)
-    {
-      fmt->nfreesectors += dev->releasecount[x];
-    }
+  fmt->nfreesectors += dev->releasesectors;
 
   /* Subtract the reserved sector count */
 
-  fmt->nfreesectors -= dev->sectorsPerBlk + 4;
+  fmt->nfreesectors -= SMART_GC_RESERVE(dev);
 
   ret = OK;
 
@@ -1033,6 +2170,17 @@ static inline int smart_llformat(struct smart_struct_s *dev, unsigned long arg)
 
   fvdbg("Entry\n");
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Lay out the checkpoint areas for the sector size being formatted */
+
+  dev->ckptenabled = true;
+  ret = smart_setsectorsize(dev, CONFIG_MTD_SMART_SECTOR_SIZE);
+  if (ret != OK)
+    {
+      return ret;
+    }
+#endif
+
   /* Erase the MTD device */
 
   ret = MTD_IOCTL(dev->mtd, MTDIOC_BULKERASE, 0);
@@ -1078,6 +2226,15 @@ static inline int smart_llformat(struct smart_struct_s *dev, unsigned long arg)
 
   dev->rwbuffer[SMART_FMT_ROOTDIRS_POS] = (uint8_t) arg;
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+  /* Record the size of the checkpoint areas at the end of the device */
+
+  if (dev->ckptenabled)
+    {
+      dev->rwbuffer[SMART_FMT_CKPT_POS] = dev->ckptblocks;
+    }
+#endif
+
   /* Write the sector to the flash */
 
   wrcount = MTD_BWRITE(dev->mtd, 0, dev->mtdBlksPerSector,
@@ -1114,6 +2271,7 @@ static inline int smart_llformat(struct smart_struct_s *dev, unsigned long arg)
   /* Account for the format sector */
 
   dev->freecount[0]--;
+  smart_heapinit(dev);
 
   /* Now initialize the logical to physical sector map */
 
@@ -1136,315 +2294,531 @@ static inline int smart_llformat(struct smart_struct_s *dev, unsigned long arg)
       snprintf(dev->rwbuffer, 18, "/dev/smart%dd%d", dev->minor, x);
       unregister_blockdriver(dev->rwbuffer);
     }
-#endif
+#endif
+
+  return OK;
+}
+#endif /* CONFIG_FS_WRITABLE */
+
+/****************************************************************************
+ * Name: smart_isfreesector
+ *
+ * Description:  Reads the header of a physical sector and returns 1 if the
+ *               sector is still erased, 0 if it is not and a negated errno
+ *               value on a read failure.
+ *
+ ****************************************************************************/
+
+static int smart_isfreesector(struct smart_struct_s *dev, uint16_t sector)
+{
+  struct    smart_sect_header_s header;
+  uint32_t  readaddr;
+  int       ret;
+
+  readaddr = sector * dev->mtdBlksPerSector * dev->geo.blocksize;
+  ret = MTD_READ(dev->mtd, readaddr, sizeof(struct smart_sect_header_s),
+          (uint8_t *) &header);
+  if (ret != sizeof(struct smart_sect_header_s))
+    {
+      fvdbg("Error reading phys sector %d\n", sector);
+      return -EIO;
+    }
+
+  return (*((uint16_t *) header.logicalsector) == 0xFFFF) &&
+         (*((uint16_t *) header.seq) == 0xFFFF) &&
+         ((header.status & SMART_STATUS_COMMITTED) ==
+          (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED));
+}
+
+/****************************************************************************
+ * Name: smart_findfreephyssector
+ *
+ * Description:  Finds a free physical sector based on free and released
+ *               count logic, taking into account reserved sectors.
+ *               Returns 0xFFFF if no free sector is available.
+ *
+ ****************************************************************************/
+
+static int smart_findfreephyssector(struct smart_struct_s *dev)
+{
+  uint16_t  allocblock;
+  uint16_t  firstsector;
+  uint16_t  hint;
+  uint16_t  x;
+  int       ret;
+
+  /* The erase block with the most free sectors (and the fewest erases
+   * among those) is always at the top of the free block heap.
+   */
+
+  allocblock = dev->freeheap[0];
+  if (dev->freecount[allocblock] == 0)
+    {
+      /* No free sectors found!  Bug? */
+
+      return 0xFFFF;
+    }
+
+  /* Sectors are handed out in ascending order within an erase block and
+   * only become free again when the whole block is erased, so the free
+   * sectors normally are the last freecount sectors of the block.  Try
+   * that one first and only scan the block if a partially written sector
+   * left behind by a power loss broke that ordering.
+   */
+
+  firstsector = allocblock * dev->sectorsPerBlk;
+  hint = firstsector + dev->sectorsPerBlk - dev->freecount[allocblock];
+
+  ret = smart_isfreesector(dev, hint);
+  if (ret != 0)
+    {
+      return ret < 0 ? 0xFFFF : hint;
+    }
+
+  for (x = firstsector; x < firstsector + dev->sectorsPerBlk; x++)
+    {
+      if (x == hint)
+        {
+          continue;
+        }
+
+      ret = smart_isfreesector(dev, x);
+      if (ret < 0)
+        {
+          return 0xFFFF;
+        }
+      else if (ret > 0)
+        {
+          return x;
+        }
+    }
 
-  return OK;
+  return 0xFFFF;
 }
-#endif /* CONFIG_FS_WRITABLE */
 
 /****************************************************************************
- * Name: smart_findfreephyssector
+ * Name: smart_gcneeded
  *
- * Description:  Finds a free physical sector based on free and released
- *               count logic, taking into account reserved sectors.
+ * Description:  Returns true when garbage collection should run.  This is
+ *               determined by the count of released sectors relative to
+ *               free and total sectors.
  *
  ****************************************************************************/
 
-static int smart_findfreephyssector(struct smart_struct_s *dev)
+#ifdef CONFIG_FS_WRITABLE
+static inline bool smart_gcneeded(struct smart_struct_s *dev)
 {
-  uint16_t  allocfreecount;
-  uint16_t  allocblock;
-  uint16_t  physicalsector;
-  uint16_t  x;
-  uint32_t  readaddr;
-  struct    smart_sect_header_s header;
-  int       ret;
+  return dev->releasesectors > dev->freesectors ||
+         dev->freesectors <= SMART_GC_THRESHOLD(dev);
+}
+
+/****************************************************************************
+ * Name: smart_gcselect
+ *
+ * Description:  Selects the erase block to collect:  The one with the most
+ *               released sectors or, among those, the least erased one.
+ *               Returns 0xFFFF if no block has released sectors.
+ *
+ ****************************************************************************/
 
-  /* Determine which erase block we should allocate the new
-   * sector from. This is based on the number of free sectors
-   * available in each erase block. */
+static uint16_t smart_gcselect(struct smart_struct_s *dev)
+{
+  uint16_t  collectblock;
+  uint16_t  x;
 
-  allocfreecount = 0;
-  allocblock = 0xFFFF;
-  physicalsector = 0xFFFF;
+  collectblock = 0xFFFF;
   for (x = 0; x < dev->neraseblocks; x++)
     {
-      /* Test if this block has more free blocks than the
-       * currently selected block */
-
-      if (dev->freecount[x] > allocfreecount)
+      if (dev->releasecount[x] == 0)
         {
-          /* Assign this block to alloc from */
-
-          allocblock = x;
-          allocfreecount = dev->freecount[x];
+          continue;
         }
-    }
-
-  /* Check if we found an allocblock. */
 
-  if (allocblock == 0xFFFF)
-    {
-      /* No free sectors found!  Bug? */
-      return -EIO;
+      if (collectblock == 0xFFFF ||
+          dev->releasecount[x] > dev->releasecount[collectblock] ||
+          (dev->releasecount[x] == dev->releasecount[collectblock] &&
+           dev->erasecount[x] < dev->erasecount[collectblock]))
+        {
+          collectblock = x;
+        }
     }
 
-  /* Now find a free physical sector within this selected
-   * erase block to allocate. */
-
-  for (x = allocblock * dev->sectorsPerBlk;
-          x < (allocblock+1) * dev->sectorsPerBlk; x++)
-    {
-      /* Check if this physical sector is available */
+  return collectblock;
+}
 
-      readaddr = x * dev->mtdBlksPerSector * dev->geo.blocksize;
-      ret = MTD_READ(dev->mtd, readaddr, sizeof(struct smart_sect_header_s),
-              (uint8_t *) &header);
-      if (ret != sizeof(struct smart_sect_header_s))
-        {
-          fvdbg("Error reading phys sector %d\n", physicalsector);
-          return -EIO;
-        }
+/****************************************************************************
+ * Name: smart_gcstart
+ *
+ * Description:  Starts the collection of an erase block.
+ *
+ ****************************************************************************/
 
-      if ((*((uint16_t *) header.logicalsector) == 0xFFFF) &&
-          (*((uint16_t *) header.seq) == 0xFFFF) &&
-          ((header.status & SMART_STATUS_COMMITTED) ==
-           (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)))
-        {
-          physicalsector = x;
-          break;
-        }
-    }
+static void smart_gcstart(struct smart_struct_s *dev, uint16_t collectblock)
+{
+  fdbg("Collecting block %d, free=%d released=%d\n",
+      collectblock, dev->freecount[collectblock],
+      dev->releasecount[collectblock]);
+
+  /* First mark the block as having no free sectors so we don't try to move
+   * sectors into the block we are trying to erase.  Its free sectors are
+   * only given back when the block is erased, so that freesectors stays
+   * accurate while file system requests run between collection steps.
+   */
 
-  return physicalsector;
+  dev->freesectors -= dev->freecount[collectblock];
+  smart_setfreecount(dev, collectblock, 0);
+  dev->gcblock = collectblock;
+  dev->gcsector = 0;
 }
 
 /****************************************************************************
- * Name: smart_garbagecollect
+ * Name: smart_gcstep
+ *
+ * Description:  Performs one step of garbage collection:  Moves at most
+ *               budget live sectors out of the erase block being collected
+ *               (selecting one first if needed) and erases the block once
+ *               it holds no more live data.  The collection state is kept
+ *               in the device structure so that file system requests may
+ *               run between two steps.
  *
- * Description:  Performs garbage collection if needed.  This is determined
- *               by the count of released sectors relative to free and
- *               total sectors.
+ *               Returns OK if the block was erased, 1 if the budget ran
+ *               out first and a negated errno value on failure.
  *
  ****************************************************************************/
 
-#ifdef CONFIG_FS_WRITABLE
-static int smart_garbagecollect(struct smart_struct_s *dev)
+static int smart_gcstep(struct smart_struct_s *dev, uint16_t budget)
 {
-  uint16_t  releasedsectors;
   uint16_t  collectblock;
-  uint16_t  releasemax;
   uint16_t  newsector;
-  bool      collect = TRUE;
-  int       x;
+  uint16_t  x;
   int       ret;
   size_t    offset;
   struct    smart_sect_header_s *header;
   uint8_t   newstatus;
 
-  while (collect)
+  if (dev->gcblock == 0xFFFF)
     {
-      collect = FALSE;
-
-      /* Calculate the number of released sectors on the device */
-
-      releasedsectors = 0;
-      collectblock = 0xFFFF;
-      releasemax = 0;
-      for (x = 0; x < dev->neraseblocks; x++)
+      collectblock = smart_gcselect(dev);
+      if (collectblock == 0xFFFF)
         {
-          releasedsectors += dev->releasecount[x];
-          if (dev->releasecount[x] > releasemax)
-            {
-              releasemax = dev->releasecount[x];
-              collectblock = x;
-            }
+          /* Need to collect, but no sectors with released blocks! */
+
+          return -ENOSPC;
         }
 
-      /* Test if the released sectors count is greater than the
-       * free sectors.  If it is, then we will do garbage collection.
-       */
+      smart_gcstart(dev, collectblock);
+    }
 
-      if (releasedsectors > dev->freesectors)
-        collect = TRUE;
+  collectblock = dev->gcblock;
 
-      /* Test if we have more reached our reserved free sector limit */
+  /* Next move all live data in the block to a new home. */
 
-      if (dev->freesectors <= (dev->sectorsPerBlk << 0) + 4)
-        collect = TRUE;
+  for (; dev->gcsector < dev->sectorsPerBlk; dev->gcsector++)
+    {
+      if (budget == 0)
+        {
+          return 1;
+        }
 
-      /* Test if we need to garbage collect */
+      /* Read the next sector header from this erase block */
 
-      if (collect)
+      x = collectblock * dev->sectorsPerBlk + dev->gcsector;
+      header = (struct smart_sect_header_s *) dev->rwbuffer;
+      ret = MTD_READ(dev->mtd, x * dev->mtdBlksPerSector * dev->geo.blocksize,
+                     sizeof(struct smart_sect_header_s), (uint8_t *) header);
+      if (ret != sizeof(struct smart_sect_header_s))
         {
-          if (collectblock == 0xFFFF)
-            {
-              /* Need to collect, but no sectors with released blocks! */
+          fdbg("Error reading sector %d\n", x);
+          return -EIO;
+        }
 
-              ret = -ENOSPC;
-              goto errout;
-            }
+      /* Test if if the block is in use */
 
-          fdbg("Collecting block %d, free=%d released=%d\n",
-              collectblock, dev->freecount[collectblock],
-              dev->releasecount[collectblock]);
+      if (((header->status & SMART_STATUS_COMMITTED) ==
+          (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)) ||
+          ((header->status & SMART_STATUS_RELEASED) !=
+           (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED)))
+        {
+          /* This sector doesn't have live data (free or released).
+           * just continue to the next sector and don't move it.
+           */
 
-          if (dev->freecount[collectblock] == 6)
-            {
-              fdbg("here!\n");
-            }
+          continue;
+        }
 
-          /* Perform collection on block with the most released sectors.
-           * First mark the block as having no free sectors so we don't
-           * try to move sectors into the block we are trying to erase.
-           */
+      /* Read the whole sector now that we know it must be moved */
 
-          dev->freecount[collectblock] = 0;
+      ret = MTD_BREAD(dev->mtd, x * dev->mtdBlksPerSector,
+          dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
+      if (ret != dev->mtdBlksPerSector)
+        {
+          fdbg("Error reading sector %d\n", x);
+          return -EIO;
+        }
 
-          /* Next move all live data in the block to a new home. */
+      /* Find a new sector where it can live, NOT in this erase block */
 
-          for (x = collectblock * dev->sectorsPerBlk; x <
-             (collectblock + 1) * dev->sectorsPerBlk; x++)
-            {
-              /* Read the next sector from this erase block */
+      newsector = smart_findfreephyssector(dev);
+      if (newsector == 0xFFFF)
+        {
+          /* Unable to find a free sector!!! */
 
-              ret = MTD_BREAD(dev->mtd, x * dev->mtdBlksPerSector,
-                  dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
-              if (ret != dev->mtdBlksPerSector)
-                {
-                  fdbg("Error reading sector %d\n", x);
-                  ret = -EIO;
-                  goto errout;
-                }
+          fdbg("Can't find a free sector for relocation\n");
+          return -EIO;
+        }
 
-              /* Test if if the block is in use */
+      /* Increment the sequence number and clear the "commit" flag */
 
-              header = (struct smart_sect_header_s *) dev->rwbuffer;
-              if (((header->status & SMART_STATUS_COMMITTED) ==
-                  (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_COMMITTED)) ||
-                  ((header->status & SMART_STATUS_RELEASED) !=
-                   (CONFIG_SMARTFS_ERASEDSTATE & SMART_STATUS_RELEASED)))
-                {
-                  /* This sector doesn't have live data (free or released).
-                   * just continue to the next sector and don't move it.
-                   */
+      (*((uint16_t *) header->seq))++;
+      if (*((uint16_t *) header->seq) == 0xFFFF)
+        {
+          *((uint16_t *) header->seq) = 1;
+        }
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+      header->status |= SMART_STATUS_COMMITTED;
+#else
+      header->status &= ~SMART_STATUS_COMMITTED;
+#endif
 
-                  continue;
-                }
+      /* Write the data to the new physical sector location */
 
-              /* Find a new sector where it can live, NOT in this erase block */
+      smart_ckpt_log(dev, SMART_CKPT_MAP, *((uint16_t *) header->logicalsector),
+                     newsector);
+      ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdBlksPerSector,
+                       dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
 
-              newsector = smart_findfreephyssector(dev);
-              if (newsector == 0xFFFF)
-                {
-                  /* Unable to find a free sector!!! */
+      /* Commit the sector */
 
-                  fdbg("Can't find a free sector for relocation\n");
-                  ret = -EIO;
-                  goto errout;
-                }
+      offset = newsector * dev->mtdBlksPerSector * dev->geo.blocksize +
+          offsetof(struct smart_sect_header_s, status);
+#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
+      newstatus = header->status & ~SMART_STATUS_COMMITTED;
+#else
+      newstatus = header->status | SMART_STATUS_COMMITTED;
+#endif
+      ret = smart_bytewrite(dev, offset, 1, &newstatus);
+      if (ret < 0)
+        {
+          fdbg("Error %d committing new sector %d\n", -ret, newsector);
+          return ret;
+        }
 
-              /* Increment the sequence number and clear the "commit" flag */
+      /* Release the old physical sector */
 
-              (*((uint16_t *) header->seq))++;
-              if (*((uint16_t *) header->seq) == 0xFFFF)
-                {
-                  *((uint16_t *) header->seq) = 1;
-                }
 #if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-              header->status |= SMART_STATUS_COMMITTED;
+      newstatus = header->status & ~SMART_STATUS_RELEASED;
 #else
-              header->status &= ~SMART_STATUS_COMMITTED;
+      newstatus = header->status | SMART_STATUS_RELEASED;
 #endif
+      offset = x * dev->mtdBlksPerSector * dev->geo.blocksize +
+          offsetof(struct smart_sect_header_s, status);
+      ret = smart_bytewrite(dev, offset, 1, &newstatus);
+      if (ret < 0)
+        {
+          fdbg("Error %d releasing old sector %d\n", -ret, x);
+          return ret;
+        }
 
-              /* Write the data to the new physical sector location */
+      /* Update the variables */
+
+      dev->sMap[*((uint16_t *) header->logicalsector)] = newsector;
+      smart_setfreecount(dev, newsector / dev->sectorsPerBlk,
+                         dev->freecount[newsector / dev->sectorsPerBlk] - 1);
+      dev->freesectors--;
+#ifdef CONFIG_MTD_STATS
+      dev->nrelocs++;
+#endif
 
-              ret = MTD_BWRITE(dev->mtd, newsector * dev->mtdBlksPerSector,
-                               dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
+      if (budget != SMART_GC_UNLIMITED)
+        {
+          budget--;
+        }
+    }
 
-              /* Commit the sector */
+  /* Now erase the erase block */
 
-              offset = newsector * dev->mtdBlksPerSector * dev->geo.blocksize +
-                  offsetof(struct smart_sect_header_s, status);
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-              newstatus = header->status & ~SMART_STATUS_COMMITTED;
-#else
-              newstatus = header->status | SMART_STATUS_COMMITTED;
+  smart_ckpt_log(dev, SMART_CKPT_ERASE, 0xFFFF, collectblock);
+  ret = smart_eraseblock(dev, collectblock);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  dev->freesectors += dev->sectorsPerBlk;
+  dev->releasesectors -= dev->releasecount[collectblock];
+  dev->releasecount[collectblock] = 0;
+  smart_setfreecount(dev, collectblock, dev->sectorsPerBlk);
+  dev->gcblock = 0xFFFF;
+#ifdef CONFIG_MTD_STATS
+  dev->ngcblocks++;
 #endif
-              ret = smart_bytewrite(dev, offset, 1, &newstatus);
-              if (ret < 0)
-                {
-                  fdbg("Error %d committing new sector %d\n" -ret, newsector);
-                  goto errout;
-                }
 
-              /* Release the old physical sector */
+  /* Update the block aging information in the format signature sector */
 
-#if CONFIG_SMARTFS_ERASEDSTATE == 0xFF
-              newstatus = header->status & ~SMART_STATUS_RELEASED;
-#else
-              newstatus = header->status | SMART_STATUS_RELEASED;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: smart_garbagecollect
+ *
+ * Description:  Performs garbage collection if needed.  With background
+ *               collection enabled this only wakes up the collector thread
+ *               unless the free sectors reserved for relocation are about
+ *               to run out, in which case the collection is completed in
+ *               the context of the caller.
+ *
+ ****************************************************************************/
+
+static int smart_garbagecollect(struct smart_struct_s *dev)
+{
+  int       ret;
+#ifdef CONFIG_MTD_SMART_BGGC
+  int       semcount;
+
+  if (dev->freesectors > SMART_GC_RESERVE(dev))
+    {
+      if ((dev->gcblock != 0xFFFF || smart_gcneeded(dev)) &&
+          sem_getvalue(&dev->gcsem, &semcount) == OK && semcount <= 0)
+        {
+          sem_post(&dev->gcsem);
+        }
+
+      return OK;
+    }
 #endif
-              offset = x * dev->mtdBlksPerSector * dev->geo.blocksize +
-                  offsetof(struct smart_sect_header_s, status);
-              ret = smart_bytewrite(dev, offset, 1, &newstatus);
-              if (ret < 0)
-                {
-                  fdbg("Error %d releasing old sector %d\n" -ret, x);
-                  goto errout;
-                }
 
-              /* Update the variables */
+  while (dev->gcblock != 0xFFFF || smart_gcneeded(dev))
+    {
+      ret = smart_gcstep(dev, SMART_GC_UNLIMITED);
+      if (ret < 0)
+        {
+          return ret;
+        }
+    }
+
+  return OK;
+}
 
-              dev->sMap[*((uint16_t *) header->logicalsector)] = newsector;
-              dev->freecount[newsector / dev->sectorsPerBlk]--;
-            }
+/****************************************************************************
+ * Name: smart_wearlevel
+ *
+ * Description:  Starts the collection of the least erased erase block if
+ *               its erase count lags too far behind the most erased one.
+ *               This moves long lived data out of rarely erased blocks so
+ *               that they take their share of the erases.
+ *
+ ****************************************************************************/
 
-          /* Now erase the erase block */
+#ifdef CONFIG_MTD_SMART_BGGC
+static void smart_wearlevel(struct smart_struct_s *dev)
+{
+#if CONFIG_MTD_SMART_WEAR_THRESHOLD > 0
+  uint16_t  coldblock;
+  uint16_t  maxerase;
+  uint16_t  x;
 
-          MTD_ERASE(dev->mtd, collectblock, 1);
+  /* Only level wear when there is room to relocate a full block */
 
-          dev->freesectors += dev->releasecount[collectblock];
-          dev->freecount[collectblock] = dev->sectorsPerBlk;
-          dev->releasecount[collectblock] = 0;
+  if (dev->freesectors <= SMART_GC_THRESHOLD(dev) + dev->sectorsPerBlk)
+    {
+      return;
+    }
 
-          /* If this is block zero, then be sure to write the sector size */
+  coldblock = 0;
+  maxerase = 0;
+  for (x = 0; x < dev->neraseblocks; x++)
+    {
+      if (dev->erasecount[x] > maxerase)
+        {
+          maxerase = dev->erasecount[x];
+        }
 
-          if (collectblock == 0)
-            {
-              /* Set the sector size in the 1st header */
+      if (dev->erasecount[x] < dev->erasecount[coldblock])
+        {
+          coldblock = x;
+        }
+    }
 
-              uint8_t sectsize = dev->sectorsize >> 7;
-#if ( CONFIG_SMARTFS_ERASEDSTATE == 0xFF )
-              newstatus = (uint8_t) ~SMART_STATUS_SIZEBITS | sectsize;
-#else
-              newstatus = (uint8_t) sectsize;
+  if (maxerase - dev->erasecount[coldblock] > CONFIG_MTD_SMART_WEAR_THRESHOLD &&
+      dev->freecount[coldblock] < dev->sectorsPerBlk)
+    {
+      smart_gcstart(dev, coldblock);
+    }
 #endif
-              /* Write the sector size to the device */
+}
 
-              offset = offsetof(struct smart_sect_header_s, status);
-              ret = smart_bytewrite(dev, offset, 1, &newstatus);
-              if (ret < 0)
-                {
-                  fdbg("Error %d setting sector 0 size\n", -ret);
-                }
-            }
+/****************************************************************************
+ * Name: smart_gcthread
+ *
+ * Description:  Background garbage collection thread.  It is woken up by
+ *               smart_garbagecollect() and then collects in steps of at
+ *               most CONFIG_MTD_SMART_BGGC_BUDGET relocated sectors, giving
+ *               up the device between two steps, until no more collection
+ *               is needed.  Erases are left to complete in the FLASH while
+ *               the device is given up.
+ *
+ ****************************************************************************/
+
+static int smart_gcthread(int argc, char *argv[])
+{
+  FAR struct smart_struct_s *dev;
+  bool more;
+  int ret;
+
+  DEBUGASSERT(argc == 2);
+  dev = (FAR struct smart_struct_s *)((uintptr_t)strtoul(argv[1], NULL, 16));
+
+  for (; ; )
+    {
+      /* Wait until there is something to collect.  Nothing to do if we
+       * were awakened by a signal.
+       */
 
-          /* Update the block aging information in the format signature sector */
+      if (sem_wait(&dev->gcsem) != OK)
+        {
+          continue;
         }
-      else
+
+      do
         {
-          /* Test for aging sectors and push them to a new location
-           * so we wear evenly.
+          /* Let an erase started by the previous step complete before
+           * taking the device, so that file system requests are not held
+           * up behind the collector while the FLASH is busy.  Drivers
+           * that cannot tell fail the ioctl and are not waited for.
            */
+
+          while (MTD_IOCTL(dev->mtd, MTDIOC_ERASEBUSY, 0) > 0)
+            {
+              usleep(1000);
+            }
+
+          smart_lock(dev);
+
+          if (dev->gcblock == 0xFFFF && !smart_gcneeded(dev))
+            {
+              smart_wearlevel(dev);
+            }
+
+          ret = OK;
+          if (dev->gcblock != 0xFFFF || smart_gcneeded(dev))
+            {
+              ret = smart_gcstep(dev, CONFIG_MTD_SMART_BGGC_BUDGET);
+            }
+
+          more = ret >= 0 && (dev->gcblock != 0xFFFF || smart_gcneeded(dev));
+          smart_unlock(dev);
+
+          if (more)
+            {
+              usleep(CONFIG_MTD_SMART_BGGC_INTERVAL * 1000);
+            }
         }
+      while (more);
     }
 
   return OK;
-
-errout:
-  return ret;
 }
+#endif /* CONFIG_MTD_SMART_BGGC */
 #endif /* CONFIG_FS_WRITABLE */
 
 /****************************************************************************
@@ -1562,6 +2936,7 @@ static inline int smart_writesector(struct smart_struct_s *dev, unsigned long ar
     {
       /* Write the entire sector to the new physical location, uncommitted. */
 
+      smart_ckpt_log(dev, SMART_CKPT_MAP, req->logsector, physsector);
       ret = MTD_BWRITE(dev->mtd, physsector * dev->mtdBlksPerSector,
               dev->mtdBlksPerSector, (uint8_t *) dev->rwbuffer);
       if (ret != dev->mtdBlksPerSector)
@@ -1603,7 +2978,9 @@ static inline int smart_writesector(struct smart_struct_s *dev, unsigned long ar
        * newly allocated physical sector. */
 
       dev->releasecount[dev->sMap[req->logsector] / dev->sectorsPerBlk]++;
-      dev->freecount[physsector / dev->sectorsPerBlk]--;
+      dev->releasesectors++;
+      smart_setfreecount(dev, physsector / dev->sectorsPerBlk,
+                         dev->freecount[physsector / dev->sectorsPerBlk] - 1);
       dev->freesectors--;
 
       /* Update the sector map */
@@ -1730,7 +3107,6 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
   int       ret;
   uint16_t  logsector = 0xFFFF; /* Logical sector number selected */
   uint16_t  physicalsector;     /* The selected physical sector */
-  uint16_t  releasecount;
   struct    smart_sect_header_s  *header;
   uint8_t   sectsize;
 
@@ -1738,18 +3114,12 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
    * allocation.  We have to ensure we keep enough reserved sectors
    * on hand to do released sector garbage collection. */
 
-  releasecount = 0;
-  for (x = 0; x < dev->neraseblocks; x++)
-    {
-      releasecount += dev->releasecount[x];
-    }
-
-  if (dev->freesectors <= (dev->sectorsPerBlk << 0) + 4)
+  if (dev->freesectors <= SMART_GC_RESERVE(dev))
     {
       /* We are at our free sector limit.  Test if we have
        * sectors we can release */
 
-      if (releasecount == 0)
+      if (dev->releasesectors == 0)
         {
           /* No space left!! */
 
@@ -1817,7 +3187,12 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
   physicalsector = smart_findfreephyssector(dev);
   fvdbg("Alloc: log=%d, phys=%d, erase block=%d, free=%d, released=%d\n",
           logsector, physicalsector, physicalsector /
-          dev->sectorsPerBlk, dev->freesectors, releasecount);
+          dev->sectorsPerBlk, dev->freesectors, dev->releasesectors);
+
+  if (physicalsector == 0xFFFF)
+    {
+      return -ENOSPC;
+    }
 
   /* Create a header to assign the logical sector */
 
@@ -1839,6 +3214,7 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
   x = physicalsector * dev->mtdBlksPerSector;
 
   fvdbg("Write MTD block %d\n", x);
+  smart_ckpt_log(dev, SMART_CKPT_MAP, logsector, physicalsector);
   ret = MTD_BWRITE(dev->mtd, x, 1, (uint8_t *) dev->rwbuffer);
   if (ret != 1)
     {
@@ -1854,7 +3230,8 @@ static inline int smart_allocsector(struct smart_struct_s *dev, unsigned long re
   /* Map the sector and update the free sector counts */
 
   dev->sMap[logsector] = physicalsector;
-  dev->freecount[physicalsector / dev->sectorsPerBlk]--;
+  smart_setfreecount(dev, physicalsector / dev->sectorsPerBlk,
+                     dev->freecount[physicalsector / dev->sectorsPerBlk] - 1);
   dev->freesectors--;
 
   /* Return the logical sector number */
@@ -1930,6 +3307,7 @@ static inline int smart_freesector(struct smart_struct_s *dev, unsigned long
   /* Write the status back to the device */
 
   offset = readaddr + offsetof(struct smart_sect_header_s, status);
+  smart_ckpt_log(dev, SMART_CKPT_FREE, logicalsector, physsector);
   ret = smart_bytewrite(dev, offset, 1, &header.status);
   if (ret != 1)
     {
@@ -1941,22 +3319,28 @@ static inline int smart_freesector(struct smart_struct_s *dev, unsigned long
 
   block = physsector / dev->sectorsPerBlk;
   dev->releasecount[block]++;
+  dev->releasesectors++;
 
   /* Unmap this logical sector */
 
   dev->sMap[logicalsector] = (uint16_t) -1;
 
-  /* If this block has only released blocks, then erase it */
+  /* If this block has only released blocks, then erase it.  A block being
+   * garbage collected is left to the collector which erases it anyway.
+   */
 
-  if (dev->releasecount[block] + dev->freecount[block] == dev->sectorsPerBlk)
+  if (block != dev->gcblock &&
+      dev->releasecount[block] + dev->freecount[block] == dev->sectorsPerBlk)
     {
       /* Erase the block */
 
-      MTD_ERASE(dev->mtd, block, 1);
+      smart_ckpt_log(dev, SMART_CKPT_ERASE, 0xFFFF, block);
+      smart_eraseblock(dev, block);
 
       dev->freesectors += dev->releasecount[block];
+      dev->releasesectors -= dev->releasecount[block];
       dev->releasecount[block] = 0;
-      dev->freecount[block] = dev->sectorsPerBlk;
+      smart_setfreecount(dev, block, dev->sectorsPerBlk);
     }
 
   ret = OK;
@@ -1977,7 +3361,6 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
 {
   struct smart_struct_s *dev ;
   int ret;
-  uint32_t sector;
   struct mtd_smart_procfs_data_s * procfs_data;
 
   fvdbg("Entry\n");
@@ -1989,6 +3372,8 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
   dev = (struct smart_struct_s *)inode->i_private;
 #endif
 
+  smart_lock(dev);
+
   /* Process the ioctl's we care about first, pass any we don't respond
    * to directly to the underlying MTD device.
    */
@@ -2005,7 +3390,8 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       if (arg == 0)
         {
           fdbg("ERROR: BIOC_XIPBASE argument is NULL\n");
-          return -EINVAL;
+          ret = -EINVAL;
+          goto ok_out;
         }
 #endif
 
@@ -2071,16 +3457,18 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
       procfs_data->totalsectors = dev->totalsectors;
       procfs_data->sectorsize = dev->sectorsize;
       procfs_data->freesectors = dev->freesectors;
-      procfs_data->releasesectors = 0;
-      for (sector = 0; sector < dev->neraseblocks; sector++)
-        {
-          procfs_data->releasesectors += dev->releasecount[sector];
-        }
+      procfs_data->releasesectors = dev->releasesectors;
 
       procfs_data->namelen = dev->namesize;
       procfs_data->formatversion = dev->formatversion;
       procfs_data->unusedsectors = 0;
+#ifdef CONFIG_MTD_STATS
+      procfs_data->blockerases = dev->nerases;
+      procfs_data->gcblocks = dev->ngcblocks;
+      procfs_data->relocations = dev->nrelocs;
+#else
       procfs_data->blockerases = 0;
+#endif
       procfs_data->sectorsperblk = dev->sectorsPerBlk;
 
 #ifndef CONFIG_MTD_SMART_MINIMIZE_RAM
@@ -2113,6 +3501,7 @@ static int smart_ioctl(FAR struct inode *inode, int cmd, unsigned long arg)
     }
 
 ok_out:
+  smart_unlock(dev);
   return ret;
 }
 
@@ -2138,6 +3527,10 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, const char *partname)
   struct smart_struct_s *dev;
   int ret = -ENOMEM;
   uint32_t  totalsectors;
+#ifdef CONFIG_MTD_SMART_BGGC
+  FAR char *argv[2];
+  char arg1[16];
+#endif
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
   struct smart_multiroot_device_s *rootdirdev;
 #endif
@@ -2175,6 +3568,22 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, const char *partname)
           goto errout;
         }
 
+#ifdef CONFIG_MTD_SMART_CHECKPOINT
+      /* Allocate the buffer used for checkpoint I/O */
+
+      dev->ckptbuf = (FAR uint8_t *)kmm_malloc(dev->geo.blocksize);
+      if (dev->ckptbuf == NULL)
+        {
+          kmm_free(dev);
+          ret = -ENOMEM;
+          goto errout;
+        }
+
+      dev->ckptenabled = true;
+      dev->ckptarea = 0;
+      dev->ckptseq = 0;
+#endif
+
       /* Set the sector size to the default for now */
 
       dev->sMap = NULL;
@@ -2216,6 +3625,11 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, const char *partname)
       dev->minor = minor;
 #endif
 
+      sem_init(&dev->exclsem, 0, 1);
+#ifdef CONFIG_MTD_SMART_BGGC
+      sem_init(&dev->gcsem, 0, 0);
+#endif
+
       /* Create a MTD block device name */
 
 #ifdef CONFIG_SMARTFS_MULTI_ROOT_DIRS
@@ -2276,6 +3690,25 @@ int smart_initialize(int minor, FAR struct mtd_dev_s *mtd, const char *partname)
       /* Do a scan of the device */
 
       smart_scan(dev);
+
+#ifdef CONFIG_MTD_SMART_BGGC
+      /* Start the background garbage collection thread.  The device is
+       * still usable without it, collection then happens synchronously
+       * once the free sector reserve is reached.
+       */
+
+      snprintf(arg1, sizeof(arg1), "%lx", (unsigned long)((uintptr_t)dev));
+      argv[0] = arg1;
+      argv[1] = NULL;
+
+      dev->gcpid = kernel_thread("smart_gc", CONFIG_MTD_SMART_BGGC_PRIORITY,
+                                 CONFIG_MTD_SMART_BGGC_STACKSIZE,
+                                 smart_gcthread, (FAR char * const *)argv);
+      if (dev->gcpid <= 0)
+        {
+          fdbg("Failed to start the garbage collection thread\n");
+        }
+#endif
     }
 
 errout:
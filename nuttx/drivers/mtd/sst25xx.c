@@ -153,6 +153,14 @@
 
 #define SST25_DUMMY     0xa5
 
+/* Size of the read command header: Instruction, address and dummy byte */
+
+#ifdef CONFIG_SST25XX_FASTREAD
+#  define SST25_READHDR   5
+#else
+#  define SST25_READHDR   4
+#endif
+
 /************************************************************************************
  * Private Types
  ************************************************************************************/
@@ -750,6 +758,7 @@ static ssize_t sst25xx_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbyt
                             FAR uint8_t *buffer)
 {
   FAR struct sst25xx_dev_s *priv = (FAR struct sst25xx_dev_s *)dev;
+  uint8_t cmd[SST25_READHDR];
 
   fvdbg("offset: %08lx nbytes: %d\n", (long)offset, (int)nbytes);
 
@@ -769,15 +778,25 @@ static ssize_t sst25xx_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbyt
   sst25xx_lock(priv->dev);
   SPI_SELECT(priv->dev, SPIDEV_FLASH, true);
 
-  /* Send "Read from Memory " instruction */
-
-  (void)SPI_SEND(priv->dev, SST25_READ);
+  /* Send "Read from Memory " instruction and the page offset high byte
+   * first, followed by a dummy byte for the fast read.  The header goes out
+   * as one block so that the SPI driver can use a single (DMA) exchange for
+   * it.
+   */
 
-  /* Send the page offset high byte first. */
+#ifdef CONFIG_SST25XX_FASTREAD
+  cmd[0] = SST25_FAST_READ;
+#else
+  cmd[0] = SST25_READ;
+#endif
+  cmd[1] = (offset >> 16) & 0xff;
+  cmd[2] = (offset >> 8) & 0xff;
+  cmd[3] = offset & 0xff;
+#ifdef CONFIG_SST25XX_FASTREAD
+  cmd[4] = SST25_DUMMY;
+#endif
 
-  (void)SPI_SEND(priv->dev, (offset >> 16) & 0xff);
-  (void)SPI_SEND(priv->dev, (offset >> 8) & 0xff);
-  (void)SPI_SEND(priv->dev, offset & 0xff);
+  SPI_SNDBLOCK(priv->dev, cmd, SST25_READHDR);
 
   /* Then read all of the requested bytes */
 
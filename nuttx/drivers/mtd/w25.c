@@ -177,6 +177,14 @@
 
 #define W25_DUMMY                  0xa5
 
+/* Size of the read command header: Instruction, address and dummy byte */
+
+#ifdef CONFIG_W25_SLOWREAD
+#  define W25_READHDR              4
+#else
+#  define W25_READHDR              5
+#endif
+
 /* Chip Geometries ******************************************************************/
 /* All members of the family support uniform 4K-byte sectors and 256 byte pages */
 
@@ -650,6 +658,7 @@ static inline int w25_chiperase(struct w25_dev_s *priv)
 static void w25_byteread(FAR struct w25_dev_s *priv, FAR uint8_t *buffer,
                            off_t address, size_t nbytes)
 {
+  uint8_t cmd[5];
   uint8_t status;
 
   fvdbg("address: %08lx nbytes: %d\n", (long)address, (int)nbytes);
@@ -667,26 +676,25 @@ static void w25_byteread(FAR struct w25_dev_s *priv, FAR uint8_t *buffer,
 
   SPI_SELECT(priv->spi, SPIDEV_FLASH, true);
 
-  /* Send "Read from Memory " instruction */
+  /* Send "Read from Memory " instruction and the address high byte first,
+   * followed by a dummy byte for the fast read.  The header goes out as one
+   * block so that the SPI driver can use a single (DMA) exchange for it.
+   */
 
 #ifdef CONFIG_W25_SLOWREAD
-  (void)SPI_SEND(priv->spi, W25_RDDATA);
+  cmd[0] = W25_RDDATA;
 #else
-  (void)SPI_SEND(priv->spi, W25_FRD);
+  cmd[0] = W25_FRD;
 #endif
-
-  /* Send the address high byte first. */
-
-  (void)SPI_SEND(priv->spi, (address >> 16) & 0xff);
-  (void)SPI_SEND(priv->spi, (address >> 8) & 0xff);
-  (void)SPI_SEND(priv->spi, address & 0xff);
-
-  /* Send a dummy byte */
-
+  cmd[1] = (address >> 16) & 0xff;
+  cmd[2] = (address >> 8) & 0xff;
+  cmd[3] = address & 0xff;
 #ifndef CONFIG_W25_SLOWREAD
-  (void)SPI_SEND(priv->spi, W25_DUMMY);
+  cmd[4] = W25_DUMMY;
 #endif
 
+  SPI_SNDBLOCK(priv->spi, cmd, W25_READHDR);
+
   /* Then read all of the requested bytes */
 
   SPI_RECVBLOCK(priv->spi, buffer, nbytes);
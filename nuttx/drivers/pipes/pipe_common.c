@@ -85,6 +85,11 @@
  ****************************************************************************/
 
 static void pipecommon_semtake(sem_t *sem);
+static size_t pipecommon_nbytes(FAR struct pipe_dev_s *dev);
+static size_t pipecommon_copyin(FAR struct pipe_dev_s *dev,
+                                FAR const char *buffer, size_t len);
+static size_t pipecommon_copyout(FAR struct pipe_dev_s *dev,
+                                 FAR char *buffer, size_t len);
 
 /****************************************************************************
  * Private Data
@@ -110,6 +115,133 @@ static void pipecommon_semtake(sem_t *sem)
     }
 }
 
+/****************************************************************************
+ * Name: pipecommon_nbytes
+ *
+ * Description:
+ *   Return the number of bytes held in the circular buffer.  One slot is
+ *   always left empty so that a full buffer can be told from an empty one.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_nbytes(FAR struct pipe_dev_s *dev)
+{
+  if (dev->d_wrndx >= dev->d_rdndx)
+    {
+      return dev->d_wrndx - dev->d_rdndx;
+    }
+
+  return CONFIG_DEV_PIPE_SIZE + dev->d_wrndx - dev->d_rdndx;
+}
+
+/****************************************************************************
+ * Name: pipecommon_copyin
+ *
+ * Description:
+ *   Copy as much of the user buffer into the circular buffer as will fit.
+ *   The free space is at most two contiguous segments: from the write index
+ *   to the end of the buffer and from the start of the buffer up to the
+ *   read index.  Returns the number of bytes copied.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_copyin(FAR struct pipe_dev_s *dev,
+                                FAR const char *buffer, size_t len)
+{
+  size_t nfree = (CONFIG_DEV_PIPE_SIZE - 1) - pipecommon_nbytes(dev);
+  size_t wrndx = dev->d_wrndx;
+  size_t total;
+  size_t n;
+
+  if (len > nfree)
+    {
+      len = nfree;
+    }
+
+  total = len;
+
+  /* First segment: up to the end of the buffer */
+
+  n = CONFIG_DEV_PIPE_SIZE - wrndx;
+  if (n > len)
+    {
+      n = len;
+    }
+
+  memcpy(&dev->d_buffer[wrndx], buffer, n);
+  wrndx += n;
+  len   -= n;
+
+  /* Second segment: wrap around to the start of the buffer */
+
+  if (wrndx >= CONFIG_DEV_PIPE_SIZE)
+    {
+      wrndx = 0;
+    }
+
+  if (len > 0)
+    {
+      memcpy(dev->d_buffer, buffer + n, len);
+      wrndx = len;
+    }
+
+  dev->d_wrndx = wrndx;
+  return total;
+}
+
+/****************************************************************************
+ * Name: pipecommon_copyout
+ *
+ * Description:
+ *   Copy up to len bytes out of the circular buffer in at most two
+ *   contiguous segments.  Returns the number of bytes copied.
+ *
+ ****************************************************************************/
+
+static size_t pipecommon_copyout(FAR struct pipe_dev_s *dev,
+                                 FAR char *buffer, size_t len)
+{
+  size_t nbytes = pipecommon_nbytes(dev);
+  size_t rdndx  = dev->d_rdndx;
+  size_t total;
+  size_t n;
+
+  if (len > nbytes)
+    {
+      len = nbytes;
+    }
+
+  total = len;
+
+  /* First segment: up to the end of the buffer */
+
+  n = CONFIG_DEV_PIPE_SIZE - rdndx;
+  if (n > len)
+    {
+      n = len;
+    }
+
+  memcpy(buffer, &dev->d_buffer[rdndx], n);
+  rdndx += n;
+  len   -= n;
+
+  /* Second segment: wrap around to the start of the buffer */
+
+  if (rdndx >= CONFIG_DEV_PIPE_SIZE)
+    {
+      rdndx = 0;
+    }
+
+  if (len > 0)
+    {
+      memcpy(buffer + n, dev->d_buffer, len);
+      rdndx = len;
+    }
+
+  dev->d_rdndx = rdndx;
+  return total;
+}
+
 /****************************************************************************
  * Name: pipecommon_pollnotify
  ****************************************************************************/
@@ -360,6 +492,7 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
   FAR uint8_t       *start  = (uint8_t*)buffer;
 #endif
   ssize_t            nread  = 0;
+  bool               full;
   int                sval;
   int                ret;
 
@@ -413,28 +546,23 @@ ssize_t pipecommon_read(FAR struct file *filep, FAR char *buffer, size_t len)
 
   /* Then return whatever is available in the pipe (which is at least one byte) */
 
-  nread = 0;
-  while (nread < len && dev->d_wrndx != dev->d_rdndx)
+  full  = (pipecommon_nbytes(dev) >= CONFIG_DEV_PIPE_SIZE - 1);
+  nread = pipecommon_copyout(dev, buffer, len);
+
+  /* Writers only wait on a full buffer.  If it was full, notify all waiting
+   * writers and poll/select waiters that bytes have been removed.
+   */
+
+  if (full)
     {
-      *buffer++ = dev->d_buffer[dev->d_rdndx];
-      if (++dev->d_rdndx >= CONFIG_DEV_PIPE_SIZE)
+      while (sem_getvalue(&dev->d_wrsem, &sval) == 0 && sval < 0)
         {
-          dev->d_rdndx = 0;
+          sem_post(&dev->d_wrsem);
         }
-      nread++;
-    }
 
-  /* Notify all waiting writers that bytes have been removed from the buffer */
-
-  while (sem_getvalue(&dev->d_wrsem, &sval) == 0 && sval < 0)
-    {
-      sem_post(&dev->d_wrsem);
+      pipecommon_pollnotify(dev, POLLOUT);
     }
 
-  /* Notify all poll/select waiters that they can write to the FIFO */
-
-  pipecommon_pollnotify(dev, POLLOUT);
-
   sem_post(&dev->d_bfsem);
   pipe_dumpbuffer("From PIPE:", start, nread);
   return nread;
@@ -449,8 +577,8 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer, size_t
   struct inode      *inode    = filep->f_inode;
   struct pipe_dev_s *dev      = inode->i_private;
   ssize_t            nwritten = 0;
-  ssize_t            last;
-  int                nxtwrndx;
+  size_t             n;
+  bool               empty;
   int                sval;
 
   /* Some sanity checking */
@@ -487,82 +615,61 @@ ssize_t pipecommon_write(FAR struct file *filep, FAR const char *buffer, size_t
 
   /* Loop until all of the bytes have been written */
 
-  last = 0;
   for (;;)
     {
-      /* Calculate the write index AFTER the next byte is written */
+      /* Copy as much as will fit into the circular buffer */
 
-      nxtwrndx = dev->d_wrndx + 1;
-      if (nxtwrndx >= CONFIG_DEV_PIPE_SIZE)
-        {
-          nxtwrndx = 0;
-        }
+      empty     = (dev->d_wrndx == dev->d_rdndx);
+      n         = pipecommon_copyin(dev, buffer, len - nwritten);
+      buffer   += n;
+      nwritten += n;
 
-      /* Would the next write overflow the circular buffer? */
+      /* Readers only wait on an empty buffer.  If it was empty, notify all
+       * waiting readers and poll/select waiters that data is available.
+       */
 
-      if (nxtwrndx != dev->d_rdndx)
+      if (empty && n > 0)
         {
-          /* No... copy the byte */
-
-          dev->d_buffer[dev->d_wrndx] = *buffer++;
-          dev->d_wrndx = nxtwrndx;
-
-          /* Is the write complete? */
-
-          if (++nwritten >= len)
+          while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0)
             {
-              /* Yes.. Notify all of the waiting readers that more data is available */
-
-              while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0)
-                {
-                  sem_post(&dev->d_rdsem);
-                }
-
-              /* Notify all poll/select waiters that they can write to the FIFO */
+              sem_post(&dev->d_rdsem);
+            }
 
-              pipecommon_pollnotify(dev, POLLIN);
+          pipecommon_pollnotify(dev, POLLIN);
+        }
 
-              /* Return the number of bytes written */
+      /* Is the write complete? */
 
-              sem_post(&dev->d_bfsem);
-              return len;
-            }
-        }
-      else
+      if (nwritten >= len)
         {
-          /* There is not enough room for the next byte.  Was anything written in this pass? */
+          /* Yes.. Return the number of bytes written */
 
-          if (last < nwritten)
-            {
-              /* Yes.. Notify all of the waiting readers that more data is available */
-
-              while (sem_getvalue(&dev->d_rdsem, &sval) == 0 && sval < 0)
-                {
-                  sem_post(&dev->d_rdsem);
-                }
-            }
-          last = nwritten;
+          sem_post(&dev->d_bfsem);
+          return len;
+        }
 
-          /* If O_NONBLOCK was set, then return partial bytes written or EGAIN */
+      /* There is not enough room for the remainder.  If O_NONBLOCK was set,
+       * then return partial bytes written or EGAIN
+       */
 
-          if (filep->f_oflags & O_NONBLOCK)
+      if (filep->f_oflags & O_NONBLOCK)
+        {
+          if (nwritten == 0)
             {
-              if (nwritten == 0)
-                {
-                  nwritten = -EAGAIN;
-                }
-              sem_post(&dev->d_bfsem);
-              return nwritten;
+              nwritten = -EAGAIN;
             }
 
-          /* There is more to be written.. wait for data to be removed from the pipe */
-
-          sched_lock();
           sem_post(&dev->d_bfsem);
-          pipecommon_semtake(&dev->d_wrsem);
-          sched_unlock();
-          pipecommon_semtake(&dev->d_bfsem);
+          return nwritten;
         }
+
+      /* There is more to be written.. wait for data to be removed from the pipe */
+
+      sched_lock();
+      sem_post(&dev->d_bfsem);
+      pipecommon_semtake(&dev->d_wrsem);
+      sched_unlock();
+      pipecommon_semtake(&dev->d_bfsem);
     }
 }
 
@@ -624,14 +731,7 @@ int pipecommon_poll(FAR struct file *filep, FAR struct pollfd *fds,
        * First, determine how many bytes are in the buffer
        */
 
-      if (dev->d_wrndx >= dev->d_rdndx)
-        {
-          nbytes = dev->d_wrndx - dev->d_rdndx;
-        }
-      else
-        {
-          nbytes = (CONFIG_DEV_PIPE_SIZE-1) + dev->d_wrndx - dev->d_rdndx;
-        }
+      nbytes = pipecommon_nbytes(dev);
 
       /* Notify the POLLOUT event if the pipe is not full */
 
@@ -70,8 +70,24 @@ static FAR struct i2c_dev_s *i2c;
 
 #define BQ24292_STATUS_PG           0x04
 #define BQ24292_FAULT_BOOST         0x40
+#define BQ24292_FAULT_WATCHDOG      0x80
 #define BQ24292_FAULT_DELAY         MSEC2TICK(100)
 
+/*
+ * Shadow copy of the control registers, so that repeated charger
+ * reconfigurations with unchanged limits do not reach the bus. Bits listed in
+ * reg_volatile self-clear in the IC and are never kept in the shadow.
+ */
+#define BQ24292_REG_CACHE_SIZE      BQ24292_REG_STATUS
+
+static const uint8_t reg_volatile[BQ24292_REG_CACHE_SIZE] = {
+    [0x01] = 0xC0, /* REG_RST, WD_RST */
+    [0x07] = 0x80, /* DPDM_EN */
+};
+
+static uint8_t reg_cache[BQ24292_REG_CACHE_SIZE];
+static uint8_t reg_cache_valid;
+
 int bq24292_register_callback(bq24292_callback cb, void *arg)
 {
     struct notify_node *node;
@@ -89,6 +105,24 @@ int bq24292_register_callback(bq24292_callback cb, void *arg)
     return 0;
 }
 
+static void reg_cache_update(uint8_t reg, uint8_t val)
+{
+    if (reg < BQ24292_REG_CACHE_SIZE) {
+        reg_cache[reg] = val & ~reg_volatile[reg];
+        reg_cache_valid |= 1 << reg;
+    }
+}
+
+/*
+ * The IC returns to its default register values on power-on and on I2C
+ * watchdog expiry, so the shadow must be dropped whenever either may have
+ * happened.
+ */
+static void reg_cache_invalidate(void)
+{
+    reg_cache_valid = 0;
+}
+
 static void pg_worker(FAR void *arg)
 {
     struct notify_node *node;
@@ -159,6 +193,9 @@ static void int_worker(FAR void *arg)
 
     /* Boost fault */
     regval = read_fault_reg();
+    if (regval > 0 && regval & BQ24292_FAULT_WATCHDOG)
+        reg_cache_invalidate();
+
     if (regval > 0 && regval & BQ24292_FAULT_BOOST) {
         vdbg("possible fault\n");
         if (work_available(&fault_work)) {
@@ -199,26 +236,50 @@ static int reg_read(uint8_t reg)
     int ret;
 
     ret = I2C_WRITEREAD(i2c, &reg, sizeof(reg), &val, sizeof(val));
-    return ret ? ret : val;
+    if (ret)
+        return ret;
+
+    reg_cache_update(reg, val);
+    return val;
 }
 
 static int reg_write(uint8_t reg, uint8_t val)
 {
     uint8_t buf[2];
 
+    int ret;
+
     buf[0] = reg;
     buf[1] = val;
 
-    return I2C_WRITE(i2c, buf, sizeof(buf));
+    ret = I2C_WRITE(i2c, buf, sizeof(buf));
+    if (ret)
+        /* Register content is unknown after a failed transfer */
+        reg_cache_valid &= ~(1 << reg);
+    else
+        reg_cache_update(reg, val);
+
+    return ret;
 }
 
 static int reg_modify(uint8_t reg, uint8_t mask, uint8_t set)
 {
-    int ret = reg_read(reg);
-    if (ret < 0)
-        return ret;
+    uint8_t val;
+    int ret;
+
+    if (reg < BQ24292_REG_CACHE_SIZE && (reg_cache_valid & (1 << reg))) {
+        val = (reg_cache[reg] & ~mask) | (set & mask);
+        if (val == reg_cache[reg])
+            return 0;
+    } else {
+        ret = reg_read(reg);
+        if (ret < 0)
+            return ret;
+
+        val = (ret & ~mask) | (set & mask);
+    }
 
-    return reg_write(reg, (ret & ~mask) | (set & mask));
+    return reg_write(reg, val);
 }
 
 static int configure_device(void)
@@ -226,6 +287,7 @@ static int configure_device(void)
     int i, ret;
 
     dbg("Reconfiguring BQ24292\n");
+    reg_cache_invalidate();
     for (i = 0; i < bq24292_cfg_size; i++) {
         if (bq24292_cfg[i].mask == 0xFF)
             ret = reg_write(bq24292_cfg[i].reg, bq24292_cfg[i].set);
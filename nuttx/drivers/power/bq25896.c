@@ -63,6 +63,28 @@ static FAR struct i2c_dev_s *i2c;
 
 #define BQ25896_FAULT_DELAY         MSEC2TICK(100)
 
+#define BQ25896_REG0C_WATCHDOG_FAULT    (1 << 7)
+
+/*
+ * Shadow copy of the control registers. Charger reconfiguration requests
+ * usually carry unchanged limits, so masked writes are served from the shadow
+ * and only reach the bus when the value actually changes. Bits listed in
+ * reg_volatile self-clear in the IC and are never kept in the shadow, a value
+ * of 0xFF marks a register that is not cached at all.
+ */
+#define BQ25896_REG_CACHE_SIZE      (BQ25896_REG0D + 1)
+
+static const uint8_t reg_volatile[BQ25896_REG_CACHE_SIZE] = {
+    [BQ25896_REG02] = 0xFF, /* ADC and D+/D- detection triggers */
+    [BQ25896_REG03] = 0x40, /* WD_RST */
+    [BQ25896_REG09] = 0x83, /* FORCE_ICO, PUMPX_UP, PUMPX_DN */
+    [BQ25896_REG0B] = 0xFF, /* status */
+    [BQ25896_REG0C] = 0xFF, /* faults */
+};
+
+static uint8_t reg_cache[BQ25896_REG_CACHE_SIZE];
+static uint16_t reg_cache_valid;
+
 int bq25896_register_callback(bq25896_callback cb, void *arg)
 {
     struct notify_node *node;
@@ -80,11 +102,36 @@ int bq25896_register_callback(bq25896_callback cb, void *arg)
     return 0;
 }
 
+static bool reg_cacheable(uint8_t reg)
+{
+    return reg < BQ25896_REG_CACHE_SIZE && reg_volatile[reg] != 0xFF;
+}
+
+static void reg_cache_update(uint8_t reg, uint8_t val)
+{
+    if (reg_cacheable(reg)) {
+        reg_cache[reg] = val & ~reg_volatile[reg];
+        reg_cache_valid |= 1 << reg;
+    }
+}
+
+/*
+ * The IC returns to its default register values on power-on and on I2C
+ * watchdog expiry, so the shadow must be dropped whenever either may have
+ * happened.
+ */
+static void reg_cache_invalidate(void)
+{
+    reg_cache_valid = 0;
+}
+
 static void pg_worker(FAR void *arg)
 {
     struct notify_node *node;
     struct list_head *iter;
 
+    reg_cache_invalidate();
+
     list_foreach(&notify_list, iter) {
         node = list_entry(iter, struct notify_node, list);
         node->callback(POWER_GOOD, node->arg);
@@ -124,10 +171,22 @@ static void int_worker(FAR void *arg)
 {
     struct notify_node *node;
     struct list_head *iter;
+    uint8_t status[2];
     int regval;
 
+    /*
+     * Status and fault registers are adjacent, so fetch the status together
+     * with the first (pre-existing) fault read in one transfer and follow up
+     * with the second fault read for the current state.
+     */
+    if (bq25896_reg_read_block(BQ25896_REG0B, status, sizeof(status)))
+        return;
+
+    regval = bq25896_reg_read(BQ25896_REG0C);
+    if (regval > 0 && regval & BQ25896_REG0C_WATCHDOG_FAULT)
+        reg_cache_invalidate();
+
     /* Boost fault */
-    regval = read_fault_reg();
     if (regval > 0 && regval & BQ25896_REG0C_BOOST_FAULT) {
         vdbg("possible fault\n");
         if (work_available(&fault_work)) {
@@ -146,13 +205,8 @@ static void int_worker(FAR void *arg)
      * previous one to detect when power becomes good, so notify the detection
      * of a good power source whenever the power good bit is asserted.
      */
-    regval = bq25896_reg_read(BQ25896_REG0B);
-    if (regval < 0)
-        /* If unable to communicate with the IC, assume power is not good */
-        return;
-
-    /* Only interested in the power good bit */
-    if (regval &= BQ25896_REG0B_PG) {
+    if (status[0] & BQ25896_REG0B_PG) {
+        reg_cache_invalidate();
         list_foreach(&notify_list, iter) {
             node = list_entry(iter, struct notify_node, list);
             node->callback(POWER_GOOD, node->arg);
@@ -182,27 +236,50 @@ static int reg_read(uint8_t reg)
     int ret;
 
     ret = I2C_WRITEREAD(i2c, &reg, sizeof(reg), &val, sizeof(val));
-    return ret ? ret : val;
+    if (ret)
+        return ret;
+
+    reg_cache_update(reg, val);
+    return val;
 }
 
 static int reg_write(uint8_t reg, uint8_t val)
 {
     uint8_t buf[2];
 
+    int ret;
+
     buf[0] = reg;
     buf[1] = val;
 
-    return I2C_WRITE(i2c, buf, sizeof(buf));
+    ret = I2C_WRITE(i2c, buf, sizeof(buf));
+    if (ret)
+        /* Register content is unknown after a failed transfer */
+        reg_cache_valid &= ~(1 << reg);
+    else
+        reg_cache_update(reg, val);
+
+    return ret;
 }
 
 static int reg_modify(uint8_t reg, uint8_t mask, uint8_t set)
 {
-    int ret = reg_read(reg);
+    uint8_t val;
+    int ret;
 
-    if (ret < 0)
-        return ret;
+    if (reg_cacheable(reg) && (reg_cache_valid & (1 << reg))) {
+        val = (reg_cache[reg] & ~mask) | (set & mask);
+        if (val == reg_cache[reg])
+            return 0;
+    } else {
+        ret = reg_read(reg);
+        if (ret < 0)
+            return ret;
 
-    return reg_write(reg, (ret & ~mask) | (set & mask));
+        val = (ret & ~mask) | (set & mask);
+    }
+
+    return reg_write(reg, val);
 }
 
 static int configure_device(const struct bq25896_config *cfg)
@@ -234,6 +311,19 @@ int bq25896_reg_read(uint8_t reg)
     return ret;
 }
 
+int bq25896_reg_read_block(uint8_t reg, uint8_t *buf, size_t len)
+{
+    int ret;
+
+    ret = sem_wait(&sem);
+    if (ret < 0)
+        return -errno;
+
+    ret = i2c ? I2C_WRITEREAD(i2c, &reg, sizeof(reg), buf, len) : -ENODEV;
+    sem_post(&sem);
+    return ret;
+}
+
 int bq25896_reg_write(uint8_t reg, uint8_t val)
 {
     int ret;
@@ -268,6 +358,8 @@ int bq25896_configure(const struct bq25896_config *cfg)
     if (ret < 0)
         return -errno;
 
+    /* Always program the full set, the IC may have lost its settings */
+    reg_cache_invalidate();
     ret = i2c ? configure_device(cfg) : -ENODEV;
     sem_post(&sem);
     return ret;
@@ -0,0 +1,155 @@
+/****************************************************************************
+ * drivers/power/pm_qos.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <queue.h>
+#include <assert.h>
+
+#include <nuttx/power/pm.h>
+#include <arch/irq.h>
+
+#ifdef CONFIG_PM_QOS
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* The constraints in place and the tightest of them */
+
+static sq_queue_t g_pmqos_list;
+static uint32_t g_pmqos_latency = PM_QOS_LATENCY_ANY;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pm_qos_refresh
+ *
+ * Description:
+ *   Recompute the tightest constraint.  Called with interrupts disabled.
+ *
+ ****************************************************************************/
+
+static void pm_qos_refresh(void)
+{
+  FAR sq_entry_t *entry;
+  uint32_t latency = PM_QOS_LATENCY_ANY;
+
+  for (entry = sq_peek(&g_pmqos_list); entry; entry = sq_next(entry))
+    {
+      FAR struct pm_qos_s *req = (FAR struct pm_qos_s *)entry;
+
+      if (req->latency < latency)
+        {
+          latency = req->latency;
+        }
+    }
+
+  g_pmqos_latency = latency;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: pm_qos_add
+ ****************************************************************************/
+
+void pm_qos_add(FAR struct pm_qos_s *req, uint32_t latency)
+{
+  irqstate_t flags;
+
+  DEBUGASSERT(req != NULL);
+
+  flags = irqsave();
+  req->latency = latency;
+  sq_addlast(&req->entry, &g_pmqos_list);
+  if (latency < g_pmqos_latency)
+    {
+      g_pmqos_latency = latency;
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: pm_qos_update
+ ****************************************************************************/
+
+void pm_qos_update(FAR struct pm_qos_s *req, uint32_t latency)
+{
+  irqstate_t flags;
+
+  DEBUGASSERT(req != NULL);
+
+  flags = irqsave();
+  req->latency = latency;
+  pm_qos_refresh();
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: pm_qos_remove
+ ****************************************************************************/
+
+void pm_qos_remove(FAR struct pm_qos_s *req)
+{
+  irqstate_t flags;
+
+  DEBUGASSERT(req != NULL);
+
+  flags = irqsave();
+  sq_rem(&req->entry, &g_pmqos_list);
+  pm_qos_refresh();
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: pm_qos_latency
+ ****************************************************************************/
+
+uint32_t pm_qos_latency(void)
+{
+  return g_pmqos_latency;
+}
+
+#endif /* CONFIG_PM_QOS */
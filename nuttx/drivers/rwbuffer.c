@@ -47,6 +47,7 @@
 #include <time.h>
 #include <assert.h>
 #include <semaphore.h>
+#include <sched.h>
 #include <errno.h>
 #include <debug.h>
 
@@ -70,14 +71,34 @@
 #  define CONFIG_DRVR_WRDELAY 350
 #endif
 
+#ifdef CONFIG_DRVR_RWBSTATS
+#  define rwb_count(r,f,n) ((r)->f += (n))
+#else
+#  define rwb_count(r,f,n)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+#ifdef CONFIG_DRVR_WRITEBEHIND
+static void rwb_wrstarttimeout(FAR struct rwbuffer_s *rwb);
+#endif
+
 /****************************************************************************
  * Private Variables
  ****************************************************************************/
 
+/* All initialized buffers, for rwb_foreach() */
+
+#ifdef CONFIG_DRVR_RWBSTATS
+static FAR struct rwbuffer_s *g_rwbhead;
+#endif
+
 /****************************************************************************
  * Public Variables
  ****************************************************************************/
@@ -163,8 +184,18 @@ static void rwb_wrflush(struct rwbuffer_s *rwb)
 
   fvdbg("Timeout!\n");
 
+#ifdef CONFIG_DRVR_WRITEBEHIND
+  /* Let a flush of the write-behind buffer complete first so that the
+   * blocks reach the media in the order in which they were written.
+   */
+
+  rwb_semtake(&rwb->wbsem);
+#endif
+
   if (rwb->wrnblocks > 0)
     {
+      rwb_count(rwb, wrflushes, 1);
+
       fvdbg("Flushing: blockstart=0x%08lx nblocks=%d from buffer=%p\n",
       (long)rwb->wrblockstart, rwb->wrnblocks, rwb->wrbuffer);
 
@@ -182,6 +213,9 @@ static void rwb_wrflush(struct rwbuffer_s *rwb)
       rwb_resetwrbuffer(rwb);
     }
 
+#ifdef CONFIG_DRVR_WRITEBEHIND
+  rwb_semgive(&rwb->wbsem);
+#endif
 }
 #endif
 
@@ -189,6 +223,7 @@ static void rwb_wrflush(struct rwbuffer_s *rwb)
  * Name: rwb_wrtimeout
  ****************************************************************************/
 
+#ifdef CONFIG_DRVR_WRITEBUFFER
 static void rwb_wrtimeout(FAR void *arg)
 {
   /* The following assumes that the size of a pointer is 4-bytes or less */
@@ -201,7 +236,34 @@ static void rwb_wrtimeout(FAR void *arg)
    * worker thread.
    */
 
+#ifdef CONFIG_DRVR_WRITEBEHIND
+  /* The flush of the write-behind buffer runs on this same worker thread,
+   * so it must never be waited for here.  If the write buffer is busy,
+   * then its holder restarts the timeout when it gives the buffer up (see
+   * rwb_wrgive()).  If a write-behind flush is still pending, try again
+   * later.
+   */
+
+  if (sem_trywait(&rwb->wrsem) != OK)
+    {
+      return;
+    }
+
+  if (sem_trywait(&rwb->wbsem) != OK)
+    {
+      if (work_available(&rwb->work))
+        {
+          rwb_wrstarttimeout(rwb);
+        }
+
+      rwb_semgive(&rwb->wrsem);
+      return;
+    }
+
+  rwb_semgive(&rwb->wbsem);
+#else
   rwb_semtake(&rwb->wrsem);
+#endif
   rwb_wrflush(rwb);
   rwb_semgive(&rwb->wrsem);
 }
@@ -228,6 +290,119 @@ static inline void rwb_wrcanceltimeout(struct rwbuffer_s *rwb)
 {
   (void)work_cancel(LPWORK, &rwb->work);
 }
+#endif
+
+/****************************************************************************
+ * Name: rwb_wrgive
+ *
+ * Description:
+ *   Give up the write buffer.  With write-behind, the timeout may have
+ *   found the buffer busy and given up, so it is restarted if blocks are
+ *   left in the buffer.  The timeout is only ever queued by the holder of
+ *   wrsem.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DRVR_WRITEBEHIND
+static void rwb_wrgive(FAR struct rwbuffer_s *rwb)
+{
+  if (rwb->wrnblocks > 0 && work_available(&rwb->work))
+    {
+      rwb_wrstarttimeout(rwb);
+    }
+
+  rwb_semgive(&rwb->wrsem);
+}
+#elif defined(CONFIG_DRVR_WRITEBUFFER)
+#  define rwb_wrgive(r) rwb_semgive(&(r)->wrsem)
+#endif
+
+/****************************************************************************
+ * Name: rwb_wbworker
+ *
+ * Description:
+ *   Flush the write-behind buffer on the worker thread.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DRVR_WRITEBEHIND
+static void rwb_wbworker(FAR void *arg)
+{
+  FAR struct rwbuffer_s *rwb = (FAR struct rwbuffer_s *)arg;
+  int ret;
+
+  fvdbg("Flushing: blockstart=0x%08lx nblocks=%d from buffer=%p\n",
+        (long)rwb->wbblockstart, rwb->wbnblocks, rwb->wbbuffer);
+
+  ret = rwb->wrflush(rwb->dev, rwb->wbbuffer, rwb->wbblockstart,
+                     rwb->wbnblocks);
+  if (ret != rwb->wbnblocks)
+    {
+      fdbg("ERROR: Error flushing write-behind buffer: %d\n", ret);
+    }
+
+  rwb->wbnblocks = 0;
+  rwb_semgive(&rwb->wbsem);
+}
+
+/****************************************************************************
+ * Name: rwb_wbstart
+ *
+ * Description:
+ *   Swap the (full) write buffer with the write-behind buffer and start
+ *   flushing it on the worker thread.  Only waits if the previous
+ *   write-behind flush has not completed yet.
+ *
+ * Assumptions:
+ *   The caller holds the wrsem semaphore.
+ *
+ ****************************************************************************/
+
+static void rwb_wbstart(FAR struct rwbuffer_s *rwb)
+{
+  FAR uint8_t *buffer;
+#ifdef CONFIG_DRVR_RWBSTATS
+  int semcount;
+
+  if (sem_getvalue(&rwb->wbsem, &semcount) == OK && semcount <= 0)
+    {
+      rwb->wrwaits++;
+    }
+#endif
+
+  rwb_semtake(&rwb->wbsem);
+
+  buffer             = rwb->wbbuffer;
+  rwb->wbbuffer      = rwb->wrbuffer;
+  rwb->wbblockstart  = rwb->wrblockstart;
+  rwb->wbnblocks     = rwb->wrnblocks;
+  rwb->wrbuffer      = buffer;
+  rwb_resetwrbuffer(rwb);
+  rwb_count(rwb, wrflushes, 1);
+
+  (void)work_queue(LPWORK, &rwb->wbwork, rwb_wbworker, (FAR void *)rwb, 0);
+}
+
+/****************************************************************************
+ * Name: rwb_wbwait
+ *
+ * Description:
+ *   Wait until a write-behind flush of any of the given blocks has
+ *   completed.
+ *
+ ****************************************************************************/
+
+static void rwb_wbwait(FAR struct rwbuffer_s *rwb, off_t startblock,
+                       size_t nblocks)
+{
+  if (rwb->wbnblocks > 0 &&
+      rwb_overlap(rwb->wbblockstart, rwb->wbnblocks, startblock, nblocks))
+    {
+      rwb_semtake(&rwb->wbsem);
+      rwb_semgive(&rwb->wbsem);
+    }
+}
+#endif
 
 /****************************************************************************
  * Name: rwb_writebuffer
@@ -238,7 +413,9 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
                                off_t startblock, uint32_t nblocks,
                                FAR const uint8_t *wrbuffer)
 {
+#ifndef CONFIG_DRVR_WRITEBEHIND
   int ret;
+#endif
 
   /* Write writebuffer Logic */
 
@@ -257,7 +434,12 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
 
       /* Flush the write buffer */
 
-      ret = rwb->wrflush(rwb, rwb->wrbuffer, rwb->wrblockstart, rwb->wrnblocks);
+#ifdef CONFIG_DRVR_WRITEBEHIND
+      rwb_wbstart(rwb);
+#else
+      rwb_count(rwb, wrflushes, 1);
+      ret = rwb->wrflush(rwb->dev, rwb->wrbuffer, rwb->wrblockstart,
+                         rwb->wrnblocks);
       if (ret < 0)
         {
           fdbg("ERROR: Error writing multiple from cache: %d\n", -ret);
@@ -265,6 +447,7 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
         }
 
       rwb_resetwrbuffer(rwb);
+#endif
     }
 
   /* writebuffer is empty? Then initialize it */
@@ -285,6 +468,7 @@ static ssize_t rwb_writebuffer(FAR struct rwbuffer_s *rwb,
 
   rwb->wrnblocks      += nblocks;
   rwb->wrexpectedblock = rwb->wrblockstart + rwb->wrnblocks;
+  rwb_count(rwb, wrblocks, nblocks);
   rwb_wrstarttimeout(rwb);
   return nblocks;
 }
@@ -331,6 +515,7 @@ rwb_bufferread(struct rwbuffer_s *rwb,  off_t startblock,
   /* Copy the data from the read-ahead buffer into the IO buffer */
 
   memcpy(*rdbuffer, rhbuffer, nbytes);
+  rwb_count(rwb, rhhits, nblocks);
 
   /* Update the caller's copy for the next address */
 
@@ -343,7 +528,8 @@ rwb_bufferread(struct rwbuffer_s *rwb,  off_t startblock,
  ****************************************************************************/
 
 #ifdef CONFIG_DRVR_READAHEAD
-static int rwb_rhreload(struct rwbuffer_s *rwb, off_t startblock)
+static int rwb_rhreload(struct rwbuffer_s *rwb, off_t startblock,
+                        size_t minblocks)
 {
   off_t  endblock;
   size_t nblocks;
@@ -360,7 +546,35 @@ static int rwb_rhreload(struct rwbuffer_s *rwb, off_t startblock)
    * read-ahead buffer
    */
 
+#ifdef CONFIG_DRVR_READAHEAD_ADAPTIVE
+  /* Or read less:  The window doubles while the reads are sequential and
+   * halves on every other reload, but at least the requested blocks are
+   * read.
+   */
+
+  if (startblock == rwb->rhnextblock)
+    {
+      rwb->rhwindow <<= 1;
+      if (rwb->rhwindow > rwb->rhmaxblocks)
+        {
+          rwb->rhwindow = rwb->rhmaxblocks;
+        }
+    }
+  else if (rwb->rhwindow > 1)
+    {
+      rwb->rhwindow >>= 1;
+    }
+
+  nblocks = rwb->rhwindow;
+  if (nblocks < minblocks)
+    {
+      nblocks = minblocks < rwb->rhmaxblocks ? minblocks : rwb->rhmaxblocks;
+    }
+
+  endblock = startblock + nblocks;
+#else
   endblock = startblock + rwb->rhmaxblocks;
+#endif
 
   /* Make sure that we don't read past the end of the device */
 
@@ -378,12 +592,16 @@ static int rwb_rhreload(struct rwbuffer_s *rwb, off_t startblock)
   /* Now perform the read */
 
   ret = rwb->rhreload(rwb->dev, rwb->rhbuffer, startblock, nblocks);
+  rwb_count(rwb, rhloads, 1);
   if (ret == nblocks)
     {
       /* Update information about what is in the read-ahead buffer */
 
       rwb->rhnblocks    = nblocks;
       rwb->rhblockstart = startblock;
+#ifdef CONFIG_DRVR_READAHEAD_ADAPTIVE
+      rwb->rhnextblock  = endblock;
+#endif
 
       /* The return value is not the number of blocks we asked to be loaded. */
 
@@ -408,6 +626,17 @@ int rwb_invalidate_writebuffer(FAR struct rwbuffer_s *rwb,
 {
   int ret;
 
+#ifdef CONFIG_DRVR_WRITEBEHIND
+  /* Blocks that are being written behind cannot be invalidated anymore:
+   * Let them reach the media before the caller changes it.
+   */
+
+  if (rwb->wrmaxblocks > 0)
+    {
+      rwb_wbwait(rwb, startblock, blockcount);
+    }
+#endif
+
   if (rwb->wrmaxblocks > 0 && rwb->wrnblocks > 0)
     {
       off_t wrbend;
@@ -523,7 +752,7 @@ int rwb_invalidate_writebuffer(FAR struct rwbuffer_s *rwb,
           ret = OK;
         }
 
-      rwb_semgive(&rwb->wrsem);
+      rwb_wrgive(rwb);
     }
 
   return ret;
@@ -642,6 +871,12 @@ int rwb_initialize(FAR struct rwbuffer_s *rwb)
 #ifdef CONFIG_DRVR_WRITEBUFFER
   DEBUGASSERT(rwb->wrflush!= NULL);
   rwb->wrbuffer = NULL;
+  memset(&rwb->work, 0, sizeof(struct work_s));
+#endif
+#ifdef CONFIG_DRVR_WRITEBEHIND
+  rwb->wbbuffer  = NULL;
+  rwb->wbnblocks = 0;
+  memset(&rwb->wbwork, 0, sizeof(struct work_s));
 #endif
 #ifdef CONFIG_DRVR_READAHEAD
   DEBUGASSERT(rwb->rhreload != NULL);
@@ -673,6 +908,18 @@ int rwb_initialize(FAR struct rwbuffer_s *rwb)
               fdbg("Write buffer kmm_malloc(%d) failed\n", allocsize);
               return -ENOMEM;
             }
+
+#ifdef CONFIG_DRVR_WRITEBEHIND
+          /* And the buffer that is flushed while the next one fills */
+
+          sem_init(&rwb->wbsem, 0, 1);
+          rwb->wbbuffer = kmm_malloc(allocsize);
+          if (!rwb->wbbuffer)
+            {
+              fdbg("Write-behind buffer kmm_malloc(%d) failed\n", allocsize);
+              return -ENOMEM;
+            }
+#endif
         }
 
       fvdbg("Write buffer size: %d bytes\n", allocsize);
@@ -691,6 +938,10 @@ int rwb_initialize(FAR struct rwbuffer_s *rwb)
       /* Initialize read-ahead buffer parameters */
 
       rwb_resetrhbuffer(rwb);
+#ifdef CONFIG_DRVR_READAHEAD_ADAPTIVE
+      rwb->rhwindow    = rwb->rhmaxblocks;
+      rwb->rhnextblock = -1;
+#endif
 
       /* Allocate the read-ahead buffer */
 
@@ -710,6 +961,21 @@ int rwb_initialize(FAR struct rwbuffer_s *rwb)
     }
 #endif /* CONFIG_DRVR_READAHEAD */
 
+#ifdef CONFIG_DRVR_RWBSTATS
+  /* Make the buffer visible to rwb_foreach() */
+
+  rwb->rhhits    = 0;
+  rwb->rhloads   = 0;
+  rwb->wrblocks  = 0;
+  rwb->wrflushes = 0;
+  rwb->wrwaits   = 0;
+
+  sched_lock();
+  rwb->flink = g_rwbhead;
+  g_rwbhead  = rwb;
+  sched_unlock();
+#endif
+
   return OK;
 }
 
@@ -719,10 +985,44 @@ int rwb_initialize(FAR struct rwbuffer_s *rwb)
 
 void rwb_uninitialize(FAR struct rwbuffer_s *rwb)
 {
+#ifdef CONFIG_DRVR_RWBSTATS
+  FAR struct rwbuffer_s *prev;
+
+  sched_lock();
+  if (g_rwbhead == rwb)
+    {
+      g_rwbhead = rwb->flink;
+    }
+  else
+    {
+      for (prev = g_rwbhead; prev != NULL; prev = prev->flink)
+        {
+          if (prev->flink == rwb)
+            {
+              prev->flink = rwb->flink;
+              break;
+            }
+        }
+    }
+
+  sched_unlock();
+#endif
+
 #ifdef CONFIG_DRVR_WRITEBUFFER
   if (rwb->wrmaxblocks > 0)
     {
       rwb_wrcanceltimeout(rwb);
+#ifdef CONFIG_DRVR_WRITEBEHIND
+      /* Wait for a pending write-behind flush */
+
+      rwb_semtake(&rwb->wbsem);
+      sem_destroy(&rwb->wbsem);
+      if (rwb->wbbuffer)
+        {
+          kmm_free(rwb->wbbuffer);
+        }
+#endif
+
       sem_destroy(&rwb->wrsem);
       if (rwb->wrbuffer)
         {
@@ -750,7 +1050,9 @@ void rwb_uninitialize(FAR struct rwbuffer_s *rwb)
 int rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock, uint32_t nblocks,
              FAR uint8_t *rdbuffer)
 {
+#ifdef CONFIG_DRVR_READAHEAD
   uint32_t remaining;
+#endif
   int ret = OK;
 
   fvdbg("startblock=%ld nblocks=%ld rdbuffer=%p\n",
@@ -775,7 +1077,12 @@ int rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock, uint32_t nblocks,
           rwb_wrflush(rwb);
         }
 
-      rwb_semgive(&rwb->wrsem);
+#ifdef CONFIG_DRVR_WRITEBEHIND
+      /* The same goes for blocks that are still being written behind */
+
+      rwb_wbwait(rwb, startblock, nblocks);
+#endif
+      rwb_wrgive(rwb);
     }
 #endif
 
@@ -816,9 +1123,28 @@ int rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock, uint32_t nblocks,
            * to refill the buffer and try again.
            */
 
-          if (remaining > 0)
+          /* Blocks that would fill the whole read-ahead buffer anyway are
+           * read directly into the user buffer.  This lets the driver
+           * transfer them in one multiple block command and saves the
+           * copy.
+           */
+
+          if (remaining >= rwb->rhmaxblocks)
+            {
+              ret = rwb->rhreload(rwb->dev, rdbuffer, startblock, remaining);
+              if (ret != remaining)
+                {
+                  fdbg("ERROR: Failed to read %d blocks: %d\n",
+                       remaining, ret);
+                  rwb_semgive(&rwb->rhsem);
+                  return ret < 0 ? ret : -EIO;
+                }
+
+              remaining = 0;
+            }
+          else if (remaining > 0)
             {
-              ret = rwb_rhreload(rwb, startblock);
+              ret = rwb_rhreload(rwb, startblock, remaining);
               if (ret < 0)
                 {
                   fdbg("ERROR: Failed to fill the read-ahead buffer: %d\n", ret);
@@ -842,7 +1168,7 @@ int rwb_read(FAR struct rwbuffer_s *rwb, off_t startblock, uint32_t nblocks,
        * the user buffer.
        */
 
-      ret = rwb->rhreload(rwb->dev, startblock, nblocks, rdbuffer);
+      ret = rwb->rhreload(rwb->dev, rdbuffer, startblock, nblocks);
     }
 #endif
 
@@ -890,17 +1216,19 @@ int rwb_write(FAR struct rwbuffer_s *rwb, off_t startblock,
 
           rwb_semtake(&rwb->wrsem);
           rwb_wrflush(rwb);
-          rwb_semgive(&rwb->wrsem);
 
           /* Then transfer the data directly to the media */
 
           ret = rwb->wrflush(rwb->dev, wrbuffer, startblock, nblocks);
+          rwb_semgive(&rwb->wrsem);
         }
       else
         {
           /* Buffer the data in the write buffer */
 
+          rwb_semtake(&rwb->wrsem);
           ret = rwb_writebuffer(rwb, startblock, nblocks, wrbuffer);
+          rwb_semgive(&rwb->wrsem);
         }
 
       /* On success, return the number of blocks that we were requested to
@@ -970,7 +1298,7 @@ int rwb_mediaremoved(FAR struct rwbuffer_s *rwb)
 #endif
 
 #ifdef CONFIG_DRVR_READAHEAD
-  if (rhmaxblocks > 0)
+  if (rwb->rhmaxblocks > 0)
     {
       rwb_semtake(&rwb->rhsem);
       rwb_resetrhbuffer(rwb);
@@ -1020,3 +1348,27 @@ int rwb_invalidate(FAR struct rwbuffer_s *rwb,
 
 #endif /* CONFIG_DRVR_WRITEBUFFER || CONFIG_DRVR_READAHEAD */
 
+/****************************************************************************
+ * Name: rwb_foreach
+ *
+ * Description:
+ *   Call the handler for each initialized buffer, e.g. to report the
+ *   statistics in procfs.  The scheduler is locked while the list is
+ *   traversed, so the handler must not block.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_DRVR_RWBSTATS
+void rwb_foreach(rwb_handler_t handler, FAR void *arg)
+{
+  FAR struct rwbuffer_s *rwb;
+
+  sched_lock();
+  for (rwb = g_rwbhead; rwb != NULL; rwb = rwb->flink)
+    {
+      handler(rwb, arg);
+    }
+
+  sched_unlock();
+}
+#endif
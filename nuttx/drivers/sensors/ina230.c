@@ -46,6 +46,7 @@
 #define INA230_POWER                0x03
 #define INA230_CURRENT              0x04
 #define INA230_CALIBRATION          0x05
+#define INA230_MASK_ENABLE          0x06
 
 /* CONFIG register bitfields */
 #define INA230_CONFIG_POWER_MODE_MASK       ((uint16_t) 0x0007)
@@ -59,6 +60,10 @@
 #define INA230_CONFIG_RST_MASK              ((uint16_t) 0x8000)
 #define INA230_CONFIG_RST_SHIFT             ((uint8_t) 15)
 
+/* MASK/ENABLE register bitfields */
+#define INA230_MASK_ENABLE_CNVR             ((uint16_t) 0x0400)
+#define INA230_MASK_ENABLE_CVRF             ((uint16_t) 0x0008)
+
 #define INA230_CALIBRATION_VALUE_MAX        ((uint16_t) 0x7FFF)
 #define INA230_CALIBRATION_MULT             5120000 /* 0.00512 / uA / mohm */
 #define INA230_VOLTAGE_LSB                  ((int32_t) 1250) /* 1.25mV */
@@ -488,6 +493,75 @@ int ina230_get_data(ina230_device *dev, ina230_sample *m)
     return ret;
 }
 
+/**
+ * @brief           Enable the Conversion Ready alert of INA230 device.
+ * @return          0 on success, standard error codes otherwise
+ * @param[in]       dev: INA230 device
+ */
+int ina230_enable_cnvr_alert(ina230_device *dev)
+{
+    if (!dev) {
+        return -EINVAL;
+    }
+
+    return ina230_i2c_set(dev->i2c_dev, dev->addr,
+                          INA230_MASK_ENABLE, INA230_MASK_ENABLE_CNVR);
+}
+
+/**
+ * @brief           Check whether a new conversion completed since the last
+ *                  call. Reading the flag clears it and the alert.
+ * @return          1 if a new sample is available, 0 if not,
+ *                  standard error codes otherwise
+ * @param[in]       dev: INA230 device
+ */
+int ina230_conversion_ready(ina230_device *dev)
+{
+    uint16_t mask_enable;
+
+    if (!dev) {
+        return -EINVAL;
+    }
+
+    if (ina230_i2c_get(dev->i2c_dev, dev->addr,
+                       INA230_MASK_ENABLE, &mask_enable)) {
+        return -EIO;
+    }
+
+    return !!(mask_enable & INA230_MASK_ENABLE_CVRF);
+}
+
+/**
+ * @brief           Return latest sample measurements from INA230 device,
+ *                  reading the bus voltage and current registers only.
+ *                  The power is computed from them rather than read, which
+ *                  saves one I2C transfer per sample.
+ * @return          0 on success, standard error codes otherwise
+ * @param[in]       dev: INA230 device
+ * @param[in]       m: measurement data (voltage, current, power)
+ */
+int ina230_get_fast_data(ina230_device *dev, ina230_sample *m)
+{
+    int16_t raw_vbus, raw_current;
+
+    if ((!dev) || (!m)) {
+        return -EINVAL;
+    }
+
+    if (ina230_i2c_get(dev->i2c_dev, dev->addr,
+                       INA230_BUS_VOLTAGE, (uint16_t *) &raw_vbus) ||
+        ina230_i2c_get(dev->i2c_dev, dev->addr,
+                       INA230_CURRENT, (uint16_t *) &raw_current)) {
+        return -EIO;
+    }
+
+    m->uV = (int32_t) raw_vbus * INA230_VOLTAGE_LSB;
+    m->uA = (int32_t) raw_current * dev->current_lsb;
+    m->uW = (int32_t) (((int64_t) m->uV * m->uA) / 1000000);
+
+    return 0;
+}
+
 /**
  * @brief           Denitialize INA230 device.
  * @return          0 on success, standard error codes otherwise
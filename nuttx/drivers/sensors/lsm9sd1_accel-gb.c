@@ -43,6 +43,11 @@
 #include <nuttx/rtc.h>
 #include <nuttx/time.h>
 #include <nuttx/i2c.h>
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+#include <semaphore.h>
+#include <unistd.h>
+#include <nuttx/gpio.h>
+#endif
 
 
 #define SENSOR_ACCEL_FLAG_OPEN       BIT(0)
@@ -118,6 +123,26 @@
 #define INT_GEN_THS_ZL_G    0x36
 #define INT_GEN_DUR_G       0x37
 
+/* INT1_CTRL bits */
+#define INT1_CTRL_FTH       BIT(3)
+
+/* CTRL_REG9 bits */
+#define CTRL_REG9_FIFO_EN   BIT(1)
+
+/* FIFO_CTRL fields */
+#define FIFO_CTRL_FMODE_BYPASS  (0x0 << 5)
+#define FIFO_CTRL_FMODE_CONT    (0x6 << 5)
+#define FIFO_CTRL_FTH_MASK      0x1f
+
+/* FIFO_SRC fields */
+#define FIFO_SRC_FTH        BIT(7)
+#define FIFO_SRC_OVRN       BIT(6)
+#define FIFO_SRC_FSS_MASK   0x3f
+
+#define ACCEL_FIFO_DEPTH    32
+#define ACCEL_FIFO_WTM_MAX  FIFO_CTRL_FTH_MASK
+#define ACCEL_SAMPLE_SIZE   6
+
 /* CTRL_REG6_XL/FS_XL, Full scale selection of accel*/
 enum accel_scale
 {
@@ -139,6 +164,19 @@ typedef enum accel_odr
     A_ODR_952       /* 952 Hz (0x6) */
 }accel_odr;
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+/* Sampling period of each output data rate in uS */
+static const uint32_t accel_odr_period_us[] = {
+    [A_POWER_DOWN] = 0,
+    [A_ODR_10] = 100000,
+    [A_ODR_50] = 20000,
+    [A_ODR_119] = 8403,
+    [A_ODR_238] = 4202,
+    [A_ODR_476] = 2101,
+    [A_ODR_952] = 1050,
+};
+#endif
+
 /* CTRL_REG6_XL/BW_XL bandwiths for low-pass filter of the accel */
 enum accel_bw
 {
@@ -162,6 +200,14 @@ struct sensor_accel_info {
     int latency_ms;
     pthread_t tx_thread;
     bool should_run;
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+    uint32_t period_us;
+    uint8_t watermark;      /* FIFO threshold, 0 when the FIFO is bypassed */
+    int int_gpio;           /* INT1 line, -1 to poll the FIFO instead */
+    sem_t fifo_sem;
+    pthread_mutex_t fifo_mutex;
+    uint8_t fifo_buf[ACCEL_FIFO_DEPTH * ACCEL_SAMPLE_SIZE];
+#endif
 };
 
 /*
@@ -173,8 +219,8 @@ struct sensor_event_data {
     uint32_t    data_value[ACCEL_CHANNEL_SIZE];
 } __packed;
 
-#ifdef BATCH_PROCESS_ENABLED
-#define ACCEL_READING_NUM 2
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+#define ACCEL_READING_NUM ACCEL_FIFO_DEPTH
 #else
 #define ACCEL_READING_NUM 1
 #endif
@@ -182,6 +228,9 @@ struct sensor_event_data {
 
 
 static atomic_t txn;       /* Flag to indicate reporting in progress */
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+static struct sensor_accel_info *fifo_info; /* Owner of the INT1 line */
+#endif
 
 static uint8_t i2c_reg_read(struct sensor_accel_info *info,
                              uint8_t reg, uint8_t *regdata, int len)
@@ -196,6 +245,16 @@ static uint8_t i2c_reg_read(struct sensor_accel_info *info,
     return ret;
 }
 
+static int i2c_reg_write(struct sensor_accel_info *info,
+                         uint8_t reg, uint8_t val)
+{
+    uint8_t buf[2];
+
+    buf[0] = reg;
+    buf[1] = val;
+    return I2C_WRITE(info->i2c, buf, sizeof(buf));
+}
+
 void calc_aresolution(struct sensor_accel_info *info)
 {
 /* Possible accelerometer scales(register settings):
@@ -275,14 +334,173 @@ void set_accel_ODR(struct sensor_accel_info *info, accel_odr aRate)
     I2C_WRITE(info->i2c, cmd, sizeof(cmd));
 }
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+static int accel_fifo_isr(int irq, void *context)
+{
+    if (fifo_info)
+        sem_post(&fifo_info->fifo_sem);
+
+    return OK;
+}
+
+/*
+ * Program the FIFO in continuous mode with the given threshold, or bypass it
+ * when watermark is 0. The threshold status is routed to INT1 when the line
+ * is wired.
+ */
+static void set_accel_fifo(struct sensor_accel_info *info, uint8_t watermark)
+{
+    uint8_t reg9 = 0;
+
+    i2c_reg_read(info, CTRL_REG9, &reg9, 1);
+
+    /* Going through bypass mode empties the FIFO */
+    i2c_reg_write(info, FIFO_CTRL, FIFO_CTRL_FMODE_BYPASS);
+    if (info->int_gpio >= 0)
+        i2c_reg_write(info, INT1_CTRL, 0);
+
+    if (!watermark) {
+        i2c_reg_write(info, CTRL_REG9, reg9 & ~CTRL_REG9_FIFO_EN);
+        info->watermark = 0;
+        return;
+    }
+
+    while (sem_trywait(&info->fifo_sem) == 0)
+        ;
+
+    i2c_reg_write(info, CTRL_REG9, reg9 | CTRL_REG9_FIFO_EN);
+    i2c_reg_write(info, FIFO_CTRL, FIFO_CTRL_FMODE_CONT |
+                  (watermark & FIFO_CTRL_FTH_MASK));
+    if (info->int_gpio >= 0)
+        i2c_reg_write(info, INT1_CTRL, INT1_CTRL_FTH);
+
+    info->watermark = watermark;
+}
+
+/*
+ * Empty the FIFO with a single burst read. While the FIFO is enabled the
+ * register address rolls over from OUT_Z_H_XL back to OUT_X_L_XL, so all the
+ * stored samples come out of one I2C transaction, oldest first.
+ *
+ * Returns the number of events written to event_data.
+ */
+static uint16_t read_accel_fifo(struct sensor_accel_info *info,
+                                struct sensor_event_data *event_data)
+{
+    uint8_t *sample;
+    uint8_t src;
+    int count;
+    int ret;
+    int i;
+
+    pthread_mutex_lock(&info->fifo_mutex);
+
+    ret = i2c_reg_read(info, FIFO_SRC, &src, 1);
+    if (ret) {
+        gb_error("%s: fifo status read failed %d\n", __func__, ret);
+        count = 0;
+        goto out;
+    }
+
+    if (src & FIFO_SRC_OVRN)
+        gb_debug("%s: fifo overrun\n", __func__);
+
+    count = MIN(src & FIFO_SRC_FSS_MASK, ACCEL_FIFO_DEPTH);
+    if (!count)
+        goto out;
+
+    ret = i2c_reg_read(info, OUT_X_L_XL, info->fifo_buf,
+                       count * ACCEL_SAMPLE_SIZE);
+    if (ret) {
+        gb_error("%s: fifo read failed %d\n", __func__, ret);
+        count = 0;
+        goto out;
+    }
+
+    for (i = 0; i < count; i++) {
+        sample = &info->fifo_buf[i * ACCEL_SAMPLE_SIZE];
+
+        /* time_delta is the distance to the previous event in uS */
+        event_data[i].time_delta = i ? MIN(info->period_us, UINT16_MAX) : 0;
+        event_data[i].data_value[0] = (int16_t)(sample[0] | (sample[1] << 8));
+        event_data[i].data_value[1] = (int16_t)(sample[2] | (sample[3] << 8));
+        event_data[i].data_value[2] = (int16_t)(sample[4] | (sample[5] << 8));
+    }
+
+out:
+    pthread_mutex_unlock(&info->fifo_mutex);
+    return count;
+}
+
+/*
+ * Sleep until the FIFO reaches its threshold: wait for INT1 when it is wired,
+ * otherwise for the time the sensor takes to produce watermark samples.
+ */
+static void wait_accel_fifo(struct sensor_accel_info *info)
+{
+    uint8_t src;
+
+    if (info->int_gpio < 0) {
+        usleep(info->watermark * info->period_us);
+        return;
+    }
+
+    /* A FIFO still above its threshold won't raise another edge */
+    if (!i2c_reg_read(info, FIFO_SRC, &src, 1) && (src & FIFO_SRC_FTH))
+        return;
+
+    sem_wait(&info->fifo_sem);
+}
+#endif
+
+/*
+ * Fill a report with the data available: the whole FIFO content in watermark
+ * mode, a single fresh sample otherwise.
+ *
+ * Returns the number of events in the report.
+ */
+static uint16_t sensor_accel_fill_report(struct sensor_accel_info *info,
+                                         struct report_info *rinfo)
+{
+    struct sensor_event_data *event_data;
+    struct timespec ts;
+
+    event_data = (struct sensor_event_data *)&rinfo->data_payload[0];
+
+    up_rtc_gettime(&ts);
+    rinfo->reference_time = timespec_to_nsec(&ts);
+
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+    if (info->watermark) {
+        rinfo->readings = read_accel_fifo(info, event_data);
+
+        /* The reference time is the one of the oldest sample */
+        if (rinfo->readings > 1)
+            rinfo->reference_time -= (uint64_t)(rinfo->readings - 1) *
+                                     info->period_us * NSEC_PER_USEC;
+        return rinfo->readings;
+    }
+#endif
+
+    read_accel(info);
+
+    /* Single sensor event data */
+    rinfo->readings = 1;
+    event_data->time_delta = 0;
+    event_data->data_value[0] = ax_raw;
+    event_data->data_value[1] = ay_raw;
+    event_data->data_value[2] = az_raw;
+
+    return rinfo->readings;
+}
+
 static void *sensor_tx_thread(void *arg)
 {
     struct sensor_accel_info *info;
     struct report_info *rinfo;
     struct report_info_data *rinfo_data;
-    struct sensor_event_data *event_data;
-    struct timespec ts;
     uint16_t payload_size;
+    uint16_t readings;
 
     info = arg;
     payload_size = (ACCEL_READING_NUM * sizeof(struct sensor_event_data))
@@ -300,31 +518,25 @@ static void *sensor_tx_thread(void *arg)
             rinfo = rinfo_data->reportinfo;
             rinfo->id = info->sensor_id;
             rinfo->flags = 0;
-            event_data = (struct sensor_event_data *)&rinfo->data_payload[0];
-
-            up_rtc_gettime(&ts);
-            rinfo->reference_time = timespec_to_nsec(&ts);
-            read_accel(info);
-#ifdef BATCH_PROCESS_ENABLED
-            /*
-             * Batch sensor data values and its time_deltas
-             * until max fifo event count
-            */
-#else
-            /* Single sensor event data */
-            rinfo->readings = ACCEL_READING_NUM;
-            event_data->time_delta = 0;
-            event_data->data_value[0] = ax_raw;
-            event_data->data_value[1] = ay_raw;
-            event_data->data_value[2] = az_raw;
-#endif
-            gb_debug("report sensor: %d\n", rinfo->id);
-            info->callback(info->sensor_id, rinfo_data, payload_size);
+
+            readings = sensor_accel_fill_report(info, rinfo);
+            if (readings) {
+                gb_debug("report sensor: %d (%d)\n", rinfo->id, readings);
+                info->callback(info->sensor_id, rinfo_data,
+                    (readings * sizeof(struct sensor_event_data)) +
+                    (REPORTING_SENSORS * sizeof(struct report_info)));
+            }
         }
 
         if (!info->should_run)
             break;
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+        if (info->watermark) {
+            wait_accel_fifo(info);
+            continue;
+        }
+#endif
         up_mdelay(info->latency_ms);
     }
 
@@ -351,14 +563,10 @@ static int sensor_accel_op_get_sensor_info(struct device *dev,
     sinfo->resolution = 1;
     sinfo->min_delay = ACCEL_MIN_DELAY;
     sinfo->max_delay = ACCEL_MAX_DELAY;
-#ifdef BATCH_PROCESS_ENABLED
-    /*
-     * Example to calculate number of sensor events that can be batched in the
-     * payload. Each event consists of time_delta and sensor data fields.
-     * Reading size provides the number of sensor data fields reported.
-    */
-    sinfo->fifo_rec = ACCEL_READING_NUM;
-    sinfo->fifo_mec = sinfo->fifo_rec;
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+    /* The hardware FIFO is dedicated to the accelerometer */
+    sinfo->fifo_rec = ACCEL_FIFO_DEPTH;
+    sinfo->fifo_mec = ACCEL_FIFO_DEPTH;
 #else
     sinfo->fifo_rec = ACCEL_FIFO_REC;
     sinfo->fifo_mec = ACCEL_FIFO_MEC;
@@ -385,6 +593,9 @@ static int sensor_accel_op_start_reporting(struct device *dev,
     struct sensor_accel_info *info = NULL;
     uint32_t sampling_ms;
     accel_odr aRate;
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+    uint8_t watermark;
+#endif
     int ret;
 
     gb_debug("%s:\n",__func__);
@@ -439,6 +650,19 @@ static int sensor_accel_op_start_reporting(struct device *dev,
     }
     gb_info("%s: set sampling period %d mS\n", __func__, info->latency_ms);
     set_accel_ODR(info, aRate);
+
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+    /*
+     * Let the samples pile up in the FIFO for as long as the host accepts to
+     * wait for them, the events are then delivered as one batched report.
+     */
+    info->period_us = accel_odr_period_us[aRate];
+    watermark = MIN(max_report_latency /
+                    ((uint64_t)info->period_us * NSEC_PER_USEC),
+                    ACCEL_FIFO_WTM_MAX);
+    set_accel_fifo(info, watermark > 1 ? watermark : 0);
+    gb_info("%s: fifo watermark %d\n", __func__, info->watermark);
+#endif
     info->should_run = true;
 
     if (!info->tx_thread) {
@@ -457,12 +681,11 @@ static int sensor_accel_op_start_reporting(struct device *dev,
 
 static int sensor_accel_op_flush(struct device *dev, uint8_t id)
 {
-    struct sensor_event_data *event_data;
     struct sensor_accel_info *info;
     struct report_info_data *rinfo_data;
     struct report_info *rinfo;
-    struct timespec ts;
     uint16_t payload_size;
+    uint16_t readings;
 
     payload_size = (ACCEL_READING_NUM * sizeof(struct sensor_event_data))
                     + (REPORTING_SENSORS * sizeof(struct report_info));
@@ -475,34 +698,22 @@ static int sensor_accel_op_flush(struct device *dev, uint8_t id)
     info = device_get_private(dev);
 
     if (info->callback) {
-        rinfo_data = malloc(sizeof(struct report_info) + payload_size);
+        rinfo_data = malloc(sizeof(struct report_info_data) + payload_size);
         if (!rinfo_data)
             return -ENOMEM;
 
         rinfo_data->num_sensors_reporting = REPORTING_SENSORS;
         rinfo = rinfo_data->reportinfo;
         rinfo->id = info->sensor_id;
-        event_data = (struct sensor_event_data *)&rinfo->data_payload[0];
-
-        up_rtc_gettime(&ts);
-        rinfo->reference_time = timespec_to_nsec(&ts);
-        gb_debug("[%u.%03u]\n", ts.tv_sec, (ts.tv_nsec / 1000000));
         rinfo->flags = REPORT_INFO_FLAG_FLUSHING | REPORT_INFO_FLAG_FLUSH_COMPLETE;
-        read_accel(info);
-#ifdef BATCH_PROCESS_ENABLED
-        /*
-         * Batch sensor data values and its time_deltas
-         * until max fifo event count
-        */
-#else
-        /* Single sensor event data */
-        rinfo->readings = ACCEL_READING_NUM;
-        event_data->time_delta = 0;
-        event_data->data_value[0] = ax_raw;
-        event_data->data_value[1] = ay_raw;
-        event_data->data_value[2] = az_raw;
-#endif
-        info->callback(info->sensor_id, rinfo_data, payload_size);
+
+        /* In watermark mode this drains whatever the FIFO holds */
+        readings = sensor_accel_fill_report(info, rinfo);
+        gb_debug("flush %d readings\n", readings);
+
+        info->callback(info->sensor_id, rinfo_data,
+                       (readings * sizeof(struct sensor_event_data)) +
+                       (REPORTING_SENSORS * sizeof(struct report_info)));
 
         free(rinfo_data);
     }
@@ -534,6 +745,9 @@ static int sensor_accel_op_stop_reporting(struct device *dev,
     info = device_get_private(dev);
     sensor_accel_kill_pthread(info);
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+    set_accel_fifo(info, 0);
+#endif
     set_accel_ODR(info, A_POWER_DOWN);
     atomic_dec(&txn);
 
@@ -606,6 +820,9 @@ static void sensor_accel_dev_close(struct device *dev)
     }
     info = device_get_private(dev);
     sensor_accel_kill_pthread(info);
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+    set_accel_fifo(info, 0);
+#endif
     set_accel_ODR(info, A_POWER_DOWN);
 
     if (!(info->flags & SENSOR_ACCEL_FLAG_OPEN)) {
@@ -621,6 +838,9 @@ static int sensor_accel_dev_probe(struct device *dev)
     int ret = 0;
     uint8_t rbuf[0];
     struct device_resource *i2c_bus;
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+    struct device_resource *int_gpio;
+#endif
 
     gb_debug("%s:\n",__func__);
     if (!dev) {
@@ -677,6 +897,28 @@ static int sensor_accel_dev_probe(struct device *dev)
 
     set_accel_scale(info);
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+    sem_init(&info->fifo_sem, 0, 0);
+    pthread_mutex_init(&info->fifo_mutex, NULL);
+    info->int_gpio = -1;
+
+    /* Without the INT1 line the FIFO threshold is polled */
+    int_gpio = device_resource_get_by_name(dev, DEVICE_RESOURCE_TYPE_GPIO,
+            "int1");
+    if (int_gpio) {
+        fifo_info = info;
+        gpio_direction_in(int_gpio->start);
+        if (gpio_irqattach(int_gpio->start, accel_fifo_isr) ||
+            set_gpio_triggering(int_gpio->start, IRQ_TYPE_EDGE_RISING)) {
+            dbg("failed to attach the int1 interrupt\n");
+            fifo_info = NULL;
+        } else {
+            info->int_gpio = int_gpio->start;
+            gpio_unmask_irq(info->int_gpio);
+        }
+    }
+#endif
+
 #ifdef CONFIG_PM
     if (pm_register(&pm_callback) != OK)
     {
@@ -707,6 +949,16 @@ static void sensor_accel_dev_remove(struct device *dev)
     }
     info->flags = 0;
 
+#ifdef CONFIG_GREYBUS_SENSORS_EXT_LSM9DS1_ACCEL_FIFO
+    if (info->int_gpio >= 0) {
+        gpio_mask_irq(info->int_gpio);
+        gpio_irqattach(info->int_gpio, NULL);
+        fifo_info = NULL;
+    }
+    sem_destroy(&info->fifo_sem);
+    pthread_mutex_destroy(&info->fifo_mutex);
+#endif
+
     free(info);
     device_set_private(dev, NULL);
 }
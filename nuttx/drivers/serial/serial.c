@@ -175,13 +175,82 @@ static void uart_pollnotify(FAR uart_dev_t *dev, pollevent_t eventset)
 #  define uart_pollnotify(dev,event)
 #endif
 
+/************************************************************************************
+ * Name: uart_xmitwait
+ *
+ * Description:
+ *   Wait for the TX interrupt logic to remove some data from a full xmit buffer.
+ *   Returns OK when woken up, -EINTR if a signal was received or -ENOTCONN if a
+ *   removable device was disconnected.
+ *
+ ************************************************************************************/
+
+static int uart_xmitwait(FAR uart_dev_t *dev)
+{
+  irqstate_t flags;
+  int ret;
+
+  /* Inform the interrupt level logic that we are waiting. This and the following
+   * steps must be atomic.
+   */
+
+  flags = irqsave();
+
+#ifdef CONFIG_SERIAL_REMOVABLE
+  /* Check if the removable device is no longer connected while we have
+   * interrupts off.  We do not want the transition to occur as a race
+   * condition before we begin the wait.
+   */
+
+  if (dev->disconnected)
+    {
+      ret = -ENOTCONN;
+    }
+  else
+#endif
+    {
+      /* Wait for some characters to be sent from the buffer with the TX
+       * interrupt enabled.  When the TX interrupt is enabled, uart_xmitchars
+       * should execute and remove some of the data from the TX buffer.
+       */
+
+      dev->xmitwaiting = true;
+      uart_enabletxint(dev);
+      ret = uart_takesem(&dev->xmitsem, true);
+      uart_disabletxint(dev);
+    }
+
+  irqrestore(flags);
+
+#ifdef CONFIG_SERIAL_REMOVABLE
+  /* Check if the removable device was disconnected while we were waiting. */
+
+  if (dev->disconnected)
+    {
+      return -ENOTCONN;
+    }
+#endif
+
+  /* Check if we were awakened by signal. */
+
+  if (ret < 0)
+    {
+      /* A signal received while waiting for the xmit buffer to become non-full
+       * will abort the transfer.
+       */
+
+      return -EINTR;
+    }
+
+  return OK;
+}
+
 /************************************************************************************
  * Name: uart_putxmitchar
  ************************************************************************************/
 
 static int uart_putxmitchar(FAR uart_dev_t *dev, int ch, bool oktoblock)
 {
-  irqstate_t flags;
   int nexthead;
   int ret;
 
@@ -213,76 +282,152 @@ static int uart_putxmitchar(FAR uart_dev_t *dev, int ch, bool oktoblock)
 
       else if (oktoblock)
         {
-          /* Inform the interrupt level logic that we are waiting. This and
-           * the following steps must be atomic.
-           */
+          ret = uart_xmitwait(dev);
+          if (ret < 0)
+            {
+              return ret;
+            }
+        }
 
-          flags = irqsave();
+      /* The caller has request that we not block for data.  So return the
+       * EAGAIN error to signal this situation.
+       */
 
-#ifdef CONFIG_SERIAL_REMOVABLE
-          /* Check if the removable device is no longer connected while we
-           * have interrupts off.  We do not want the transition to occur
-           * as a race condition before we begin the wait.
-           */
+      else
+        {
+          return -EAGAIN;
+        }
+    }
 
-          if (dev->disconnected)
-            {
-              ret = -ENOTCONN;
-            }
-          else
-#endif
-            {
-              /* Wait for some characters to be sent from the buffer with
-               * the TX interrupt enabled.  When the TX interrupt is
-               * enabled, uart_xmitchars should execute and remove some
-               * of the data from the TX buffer.
-               */
+  /* We won't get here.  Some compilers may complain that this code is
+   * unreachable.
+   */
 
-              dev->xmitwaiting = true;
-              uart_enabletxint(dev);
-              ret = uart_takesem(&dev->xmitsem, true);
-              uart_disabletxint(dev);
-            }
+  return OK;
+}
 
-          irqrestore(flags);
+/************************************************************************************
+ * Name: uart_putxmitbuf
+ *
+ * Description:
+ *   Copy a block of characters into the xmit buffer with no output processing.
+ *   The free space is copied as (at most) two contiguous spans.  Returns the
+ *   number of characters buffered.  Fewer than buflen are returned only if
+ *   buffering was stopped by an error; in that case the error is returned
+ *   through 'errcode'.
+ *
+ ************************************************************************************/
 
-#ifdef CONFIG_SERIAL_REMOVABLE
-          /* Check if the removable device was disconnected while we were
-           * waiting.
-           */
+static size_t uart_putxmitbuf(FAR uart_dev_t *dev, FAR const char *buffer,
+                              size_t buflen, bool oktoblock, FAR int *errcode)
+{
+  size_t nbuffered = 0;
+  size_t nspan;
+  int16_t head;
+  int16_t tail;
+  int ret;
 
-          if (dev->disconnected)
+  while (nbuffered < buflen)
+    {
+      /* Get the contiguous free space at the head of the buffer.  One slot is
+       * always left empty to tell a full buffer from an empty one.
+       */
+
+      head = dev->xmit.head;
+      tail = dev->xmit.tail;
+
+      if (head >= tail)
+        {
+          nspan = dev->xmit.size - head;
+          if (tail == 0)
             {
-              return -ENOTCONN;
+              nspan--;
             }
-#endif
-          /* Check if we were awakened by signal. */
+        }
+      else
+        {
+          nspan = tail - head - 1;
+        }
 
-          if (ret < 0)
+      if (nspan > 0)
+        {
+          if (nspan > buflen - nbuffered)
             {
-             /* A signal received while waiting for the xmit buffer to become
-              * non-full will abort the transfer.
-              */
+              nspan = buflen - nbuffered;
+            }
+
+          memcpy(&dev->xmit.buffer[head], buffer, nspan);
+          buffer    += nspan;
+          nbuffered += nspan;
 
-              return -EINTR;
+          head += nspan;
+          if (head >= dev->xmit.size)
+            {
+              head = 0;
             }
+
+          dev->xmit.head = head;
+          continue;
         }
 
-      /* The caller has request that we not block for data.  So return the
-       * EAGAIN error to signal this situation.
+      /* The buffer is full.  Wait for the hardware to remove some data or
+       * return EAGAIN if we may not block.
        */
 
-      else
+      ret = oktoblock ? uart_xmitwait(dev) : -EAGAIN;
+      if (ret < 0)
         {
-          return -EAGAIN;
+          *errcode = ret;
+          break;
         }
     }
 
-  /* We won't get here.  Some compilers may complain that this code is
-   * unreachable.
-   */
+  return nbuffered;
+}
 
-  return OK;
+/************************************************************************************
+ * Name: uart_xmitrun
+ *
+ * Description:
+ *   Return the number of characters at the start of 'buffer' that are written
+ *   as-is, i.e. before the first character that needs output processing.
+ *
+ ************************************************************************************/
+
+static size_t uart_xmitrun(FAR uart_dev_t *dev, FAR const char *buffer,
+                           size_t buflen)
+{
+  bool crlf;
+  bool ocrnl;
+  size_t n;
+
+#ifdef CONFIG_SERIAL_TERMIOS
+  if ((dev->tc_oflag & OPOST) == 0)
+    {
+      return buflen;
+    }
+
+  crlf  = (dev->tc_oflag & (ONLCR | ONLRET)) != 0;
+  ocrnl = (dev->tc_oflag & OCRNL) != 0;
+#else
+  crlf  = dev->isconsole;
+  ocrnl = false;
+#endif
+
+  if (!crlf && !ocrnl)
+    {
+      return buflen;
+    }
+
+  for (n = 0; n < buflen; n++)
+    {
+      if ((crlf && buffer[n] == '\n') || (ocrnl && buffer[n] == '\r'))
+        {
+          break;
+        }
+    }
+
+  return n;
 }
 
 /************************************************************************************
@@ -325,6 +470,7 @@ static ssize_t uart_write(FAR struct file *filep, FAR const char *buffer,
   FAR struct inode *inode    = filep->f_inode;
   FAR uart_dev_t   *dev      = inode->i_private;
   ssize_t           nwritten = buflen;
+  size_t            nrun;
   bool              oktoblock;
   int               ret;
   char              ch;
@@ -403,68 +549,81 @@ static ssize_t uart_write(FAR struct file *filep, FAR const char *buffer,
    */
 
   uart_disabletxint(dev);
-  for (; buflen; buflen--)
+  while (buflen > 0)
     {
-      ch  = *buffer++;
-      ret = OK;
+      /* Buffer the characters that need no output processing as one block */
 
-#ifdef CONFIG_SERIAL_TERMIOS
-      /* Do output post-processing */
-
-      if (dev->tc_oflag & OPOST)
+      nrun = uart_xmitrun(dev, buffer, buflen);
+      if (nrun > 0)
+        {
+          ret     = OK;
+          nrun    = uart_putxmitbuf(dev, buffer, nrun, oktoblock, &ret);
+          buffer += nrun;
+          buflen -= nrun;
+        }
+      else
         {
-          /* Mapping CR to NL? */
+          ch  = *buffer;
+          ret = OK;
+
+#ifdef CONFIG_SERIAL_TERMIOS
+          /* Do output post-processing */
 
-          if ((ch == '\r') && (dev->tc_oflag & OCRNL))
+          if (dev->tc_oflag & OPOST)
             {
-              ch = '\n';
-            }
+              /* Mapping CR to NL? */
 
-          /* Are we interested in newline processing? */
+              if ((ch == '\r') && (dev->tc_oflag & OCRNL))
+                {
+                  ch = '\n';
+                }
 
-          if ((ch == '\n') && (dev->tc_oflag & (ONLCR | ONLRET)))
-            {
-              ret = uart_putxmitchar(dev, '\r', oktoblock);
-              if (ret < 0)
+              /* Are we interested in newline processing? */
+
+              if ((ch == '\n') && (dev->tc_oflag & (ONLCR | ONLRET)))
                 {
-                  nwritten = ret;
-                  break;
+                  ret = uart_putxmitchar(dev, '\r', oktoblock);
                 }
-            }
 
-          /* Specifically not handled:
-           *
-           * OXTABS - primarily a full-screen terminal optimisation
-           * ONOEOT - Unix interoperability hack
-           * OLCUC  - Not specified by POSIX
-           * ONOCR  - low-speed interactive optimisation
-           */
-        }
+              /* Specifically not handled:
+               *
+               * OXTABS - primarily a full-screen terminal optimisation
+               * ONOEOT - Unix interoperability hack
+               * OLCUC  - Not specified by POSIX
+               * ONOCR  - low-speed interactive optimisation
+               */
+            }
 
 #else /* !CONFIG_SERIAL_TERMIOS */
-      /* If this is the console, convert \n -> \r\n */
+          /* If this is the console, convert \n -> \r\n */
 
-      if (dev->isconsole && ch == '\n')
-        {
-          ret = uart_putxmitchar(dev, '\r', oktoblock);
-        }
+          if (dev->isconsole && ch == '\n')
+            {
+              ret = uart_putxmitchar(dev, '\r', oktoblock);
+            }
 #endif
 
-      /* Put the character into the transmit buffer */
+          /* Put the character into the transmit buffer */
 
-      if (ret == OK)
-        {
-          ret = uart_putxmitchar(dev, ch, oktoblock);
+          if (ret == OK)
+            {
+              ret = uart_putxmitchar(dev, ch, oktoblock);
+            }
+
+          if (ret == OK)
+            {
+              buffer++;
+              buflen--;
+            }
         }
 
-      /* uart_putxmitchar() might return an error under one of two
+      /* uart_putxmitchar() and uart_putxmitbuf() might fail under one of three
        * conditions:  (1) The wait for buffer space might have been
        * interrupted by a signal (ret should be -EINTR), (2) if
-       * CONFIG_SERIAL_REMOVABLE is defined, then uart_putxmitchar()
-       * might also return if the serial device was disconnected
-       * (with -ENOTCONN), or (3) if O_NONBLOCK is specified, then
-       * then uart_putxmitchar() might return -EAGAIN if the output
-       * TX buffer is full.
+       * CONFIG_SERIAL_REMOVABLE is defined, then the wait might also
+       * return if the serial device was disconnected (with -ENOTCONN), or
+       * (3) if O_NONBLOCK is specified, then -EAGAIN is returned if the
+       * output TX buffer is full.
        */
 
       if (ret < 0)
@@ -504,6 +663,20 @@ static ssize_t uart_write(FAR struct file *filep, FAR const char *buffer,
   return nwritten;
 }
 
+/************************************************************************************
+ * Name: uart_rxprocessing
+ *
+ * Description:
+ *   Return true if received characters must be examined one at a time.
+ *
+ ************************************************************************************/
+
+#ifdef CONFIG_SERIAL_TERMIOS
+#  define uart_rxprocessing(dev) (((dev)->tc_iflag & (INLCR | IGNCR | ICRNL)) != 0)
+#else
+#  define uart_rxprocessing(dev) false
+#endif
+
 /************************************************************************************
  * Name: uart_read
  ************************************************************************************/
@@ -514,6 +687,8 @@ static ssize_t uart_read(FAR struct file *filep, FAR char *buffer, size_t buflen
   FAR uart_dev_t   *dev   = inode->i_private;
   irqstate_t        flags;
   ssize_t           recvd = 0;
+  size_t            nspan;
+  int16_t           head;
   int16_t           tail;
   int               ret;
   char              ch;
@@ -566,7 +741,32 @@ static ssize_t uart_read(FAR struct file *filep, FAR char *buffer, size_t buflen
        */
 
       tail = dev->recv.tail;
-      if (dev->recv.head != tail)
+      head = dev->recv.head;
+      if (head != tail && !uart_rxprocessing(dev))
+        {
+          /* No input processing: copy the contiguous span at the tail of the
+           * buffer as one block.
+           */
+
+          nspan = (head > tail) ? head - tail : dev->recv.size - tail;
+          if (nspan > buflen - recvd)
+            {
+              nspan = buflen - recvd;
+            }
+
+          memcpy(buffer, &dev->recv.buffer[tail], nspan);
+          buffer += nspan;
+          recvd  += nspan;
+
+          tail += nspan;
+          if (tail >= dev->recv.size)
+            {
+              tail = 0;
+            }
+
+          dev->recv.tail = tail;
+        }
+      else if (head != tail)
         {
           /* Take the next character from the tail of the buffer */
 
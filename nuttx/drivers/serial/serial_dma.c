@@ -0,0 +1,148 @@
+/****************************************************************************
+ * drivers/serial/serial_dma.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <debug.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/serial/serial.h>
+
+#ifdef CONFIG_SERIAL_DMA
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: uart_xmitchars_dma
+ *
+ * Description:
+ *   Start a TX DMA transfer of the contiguous data at the tail of the xmit
+ *   buffer, if there is any and no transfer is already in progress.  Data
+ *   that wraps around the end of the buffer goes out in the next transfer,
+ *   started from uart_xmitchars_done().
+ *
+ ****************************************************************************/
+
+void uart_xmitchars_dma(FAR uart_dev_t *dev)
+{
+  FAR char *span;
+  irqstate_t flags;
+  size_t nbytes;
+
+  flags = irqsave();
+  if (dev->dmatxlen == 0)
+    {
+      nbytes = uart_xmitspan(dev, &span);
+      if (nbytes > 0)
+        {
+          dev->dmatxlen = nbytes;
+          uart_dmasend(dev, span, nbytes);
+        }
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: uart_xmitchars_done
+ *
+ * Description:
+ *   Called by the lower half when a TX DMA transfer completes.  Releases the
+ *   transmitted data, wakes up waiting writers and starts the next transfer.
+ *
+ ****************************************************************************/
+
+void uart_xmitchars_done(FAR uart_dev_t *dev)
+{
+  size_t nbytes = dev->dmatxlen;
+
+  dev->dmatxlen = 0;
+  uart_xmitcommit(dev, nbytes);
+  uart_xmitchars_dma(dev);
+}
+
+/****************************************************************************
+ * Name: uart_recvchars_dma
+ *
+ * Description:
+ *   Called by a lower half running its RX DMA in circular mode, from the
+ *   half-transfer, transfer-complete and idle-line interrupts.  The bytes
+ *   written by the DMA since the previous call are copied into the receive
+ *   buffer as (at most) two blocks.  Bytes that do not fit are dropped, as
+ *   uart_recvchars() drops them.
+ *
+ ****************************************************************************/
+
+void uart_recvchars_dma(FAR uart_dev_t *dev, FAR const char *buffer,
+                        size_t size, FAR size_t *lastpos, size_t pos)
+{
+  size_t start = *lastpos;
+  size_t nbytes;
+
+  if (pos == start)
+    {
+      return;
+    }
+
+  if (pos < start)
+    {
+      /* The DMA wrapped: first the end of the buffer, then the start */
+
+      nbytes = size - start;
+      if (uart_recvbuf(dev, &buffer[start], nbytes) < nbytes)
+        {
+          lldbg("RX overrun\n");
+        }
+
+      start = 0;
+    }
+
+  nbytes = pos - start;
+  if (nbytes > 0 && uart_recvbuf(dev, &buffer[start], nbytes) < nbytes)
+    {
+      lldbg("RX overrun\n");
+    }
+
+  *lastpos = (pos >= size) ? 0 : pos;
+}
+
+#endif /* CONFIG_SERIAL_DMA */
@@ -41,6 +41,7 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <string.h>
 #include <semaphore.h>
 #include <debug.h>
 #include <nuttx/serial/serial.h>
@@ -208,3 +209,170 @@ void uart_recvchars(FAR uart_dev_t *dev)
       uart_datareceived(dev);
     }
 }
+
+/************************************************************************************
+ * Name: uart_xmitspan
+ *
+ * Description:
+ *   Return the number of contiguous characters waiting at the tail of the xmit
+ *   buffer and a pointer to the first one in 'span'.  The characters stay in the
+ *   buffer until they are released with uart_xmitcommit().
+ *
+ ************************************************************************************/
+
+size_t uart_xmitspan(FAR uart_dev_t *dev, FAR char **span)
+{
+  int16_t head = dev->xmit.head;
+  int16_t tail = dev->xmit.tail;
+
+  *span = &dev->xmit.buffer[tail];
+  return (head >= tail) ? head - tail : dev->xmit.size - tail;
+}
+
+/************************************************************************************
+ * Name: uart_xmitcommit
+ *
+ * Description:
+ *   Release 'nbytes' characters returned by uart_xmitspan() once they have been
+ *   handed to the hardware, and wake up any writer waiting for space.
+ *
+ ************************************************************************************/
+
+void uart_xmitcommit(FAR uart_dev_t *dev, size_t nbytes)
+{
+  int16_t tail;
+
+  if (nbytes == 0)
+    {
+      return;
+    }
+
+  tail = dev->xmit.tail + nbytes;
+  if (tail >= dev->xmit.size)
+    {
+      tail -= dev->xmit.size;
+    }
+
+  dev->xmit.tail = tail;
+  uart_datasent(dev);
+}
+
+/************************************************************************************
+ * Name: uart_recvspan
+ *
+ * Description:
+ *   Return the size of the contiguous free space at the head of the receive
+ *   buffer and a pointer to it in 'span'.  Characters written there become
+ *   visible to read() when they are published with uart_recvcommit().
+ *
+ ************************************************************************************/
+
+size_t uart_recvspan(FAR uart_dev_t *dev, FAR char **span)
+{
+  int16_t head = dev->recv.head;
+  int16_t tail = dev->recv.tail;
+  size_t nfree;
+
+  /* One slot is always left empty to tell a full buffer from an empty one */
+
+  if (head >= tail)
+    {
+      nfree = dev->recv.size - head;
+      if (tail == 0)
+        {
+          nfree--;
+        }
+    }
+  else
+    {
+      nfree = tail - head - 1;
+    }
+
+  *span = &dev->recv.buffer[head];
+  return nfree;
+}
+
+/************************************************************************************
+ * Name: uart_recvcommit
+ *
+ * Description:
+ *   Publish 'nbytes' characters written into the span returned by
+ *   uart_recvspan() and wake up any reader waiting for data.
+ *
+ ************************************************************************************/
+
+void uart_recvcommit(FAR uart_dev_t *dev, size_t nbytes)
+{
+  int16_t head;
+
+  if (nbytes == 0)
+    {
+      return;
+    }
+
+  head = dev->recv.head + nbytes;
+  if (head >= dev->recv.size)
+    {
+      head -= dev->recv.size;
+    }
+
+  dev->recv.head = head;
+  uart_datareceived(dev);
+}
+
+/************************************************************************************
+ * Name: uart_recvbuf
+ *
+ * Description:
+ *   Add a block of received characters to the head of the receive buffer, for
+ *   lower halves that drain their hardware a block at a time (a FIFO, a DMA
+ *   buffer).  Characters that do not fit are discarded, as uart_recvchars()
+ *   does.  Returns the number of characters buffered.
+ *
+ ************************************************************************************/
+
+size_t uart_recvbuf(FAR uart_dev_t *dev, FAR const char *buffer, size_t buflen)
+{
+  size_t nbuffered = 0;
+  size_t nspan;
+  FAR char *span;
+  int16_t head;
+
+  /* The free space is at most two spans: up to the end of the buffer and then
+   * from its start.
+   */
+
+  while (nbuffered < buflen)
+    {
+      nspan = uart_recvspan(dev, &span);
+      if (nspan == 0)
+        {
+          break;
+        }
+
+      if (nspan > buflen - nbuffered)
+        {
+          nspan = buflen - nbuffered;
+        }
+
+      memcpy(span, buffer + nbuffered, nspan);
+      nbuffered += nspan;
+
+      /* Only move the head, wake up the reader once below */
+
+      head = dev->recv.head + nspan;
+      if (head >= dev->recv.size)
+        {
+          head = 0;
+        }
+
+      dev->recv.head = head;
+    }
+
+  if (nbuffered > 0)
+    {
+      uart_datareceived(dev);
+    }
+
+  return nbuffered;
+}
@@ -0,0 +1,706 @@
+/****************************************************************************
+ * drivers/syslog/binlog.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/irq.h>
+#include <nuttx/streams.h>
+#include <nuttx/syslog/binlog.h>
+#ifdef CONFIG_SYSLOG_BINARY_FORMAT
+#  include <nuttx/wqueue.h>
+#endif
+
+#ifdef CONFIG_SYSLOG_BINARY
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define BINLOG_NWORDS   (CONFIG_SYSLOG_BINARY_BUFSIZE / sizeof(uint32_t))
+#define BINLOG_HDRWORDS (sizeof(struct binlog_rec_s) / sizeof(uint32_t))
+#define BINLOG_STRWORDS(n) (((n) + sizeof(uint32_t)) / sizeof(uint32_t))
+
+/* Largest record accepted, so that the formatter can copy it out */
+
+#define BINLOG_MAXREC   128
+
+#if defined(CONFIG_SYSLOG_BINARY_FORMAT) && !defined(CONFIG_SCHED_LPWORK)
+#  error "CONFIG_SYSLOG_BINARY_FORMAT requires CONFIG_SCHED_LPWORK"
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+enum binlog_arg_e
+{
+  BINLOG_ARG_INT = 0,   /* One word */
+  BINLOG_ARG_LONGLONG,  /* Two words */
+  BINLOG_ARG_DOUBLE,    /* Two words */
+  BINLOG_ARG_STRING     /* Copied string */
+};
+
+/* One conversion specification in a format string */
+
+struct binlog_spec_s
+{
+  FAR const char *start; /* The '%' */
+  FAR const char *end;   /* Just after the conversion character */
+  uint8_t nstar;         /* Number of '*' width/precision arguments */
+  uint8_t type;          /* enum binlog_arg_e */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint32_t g_binlog[BINLOG_NWORDS];
+static volatile uint32_t g_head;   /* Word index of the next record written */
+static volatile uint32_t g_tail;   /* Word index of the oldest record */
+static uint32_t g_wrap = BINLOG_NWORDS; /* End of the records before the
+                                         * head wrapped to the start */
+static uint32_t g_lost;            /* Records dropped since the last drain */
+
+#ifdef CONFIG_SYSLOG_BINARY_FORMAT
+static struct work_s g_binlog_work;
+static uint32_t g_fmtrec[BINLOG_MAXREC];
+#endif
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: binlog_nextspec
+ *
+ * Description:
+ *   Find the next conversion specification in 'fmt'.  Returns false at the
+ *   end of the string.  "%%" is not a conversion and is skipped.
+ *
+ ****************************************************************************/
+
+static bool binlog_nextspec(FAR const char *fmt,
+                            FAR struct binlog_spec_s *spec)
+{
+  int nlong;
+
+  for (; *fmt; fmt++)
+    {
+      if (*fmt != '%')
+        {
+          continue;
+        }
+
+      if (fmt[1] == '%')
+        {
+          fmt++;
+          continue;
+        }
+
+      spec->start = fmt++;
+      spec->nstar = 0;
+
+      /* Flags, field width and precision */
+
+      while (*fmt && strchr("-+ #0123456789.*~", *fmt))
+        {
+          if (*fmt == '*')
+            {
+              spec->nstar++;
+            }
+
+          fmt++;
+        }
+
+      /* Length modifiers */
+
+      nlong = 0;
+      while (*fmt && strchr("hlLqjzt", *fmt))
+        {
+          if (*fmt == 'l' || *fmt == 'L' || *fmt == 'q')
+            {
+              nlong++;
+            }
+
+          fmt++;
+        }
+
+      if (*fmt == '\0')
+        {
+          return false;
+        }
+
+      if (*fmt == 's')
+        {
+          spec->type = BINLOG_ARG_STRING;
+        }
+      else if (strchr("eEfgG", *fmt))
+        {
+          spec->type = BINLOG_ARG_DOUBLE;
+        }
+      else if (nlong > 1 || (nlong == 1 && *fmt != 'c' &&
+               sizeof(long) == sizeof(long long)))
+        {
+          spec->type = BINLOG_ARG_LONGLONG;
+        }
+      else
+        {
+          spec->type = BINLOG_ARG_INT;
+        }
+
+      spec->end = fmt + 1;
+      return true;
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: binlog_strlen
+ ****************************************************************************/
+
+static size_t binlog_strlen(FAR const char *str)
+{
+  size_t len = 0;
+
+  if (str != NULL)
+    {
+      while (len < CONFIG_SYSLOG_BINARY_MAXSTR && str[len] != '\0')
+        {
+          len++;
+        }
+    }
+
+  return len;
+}
+
+/****************************************************************************
+ * Name: binlog_recsize
+ *
+ * Description:
+ *   Return the number of words needed to record 'fmt' with the arguments
+ *   in 'ap'.
+ *
+ ****************************************************************************/
+
+static size_t binlog_recsize(FAR const char *fmt, va_list ap)
+{
+  struct binlog_spec_s spec;
+  size_t nwords = BINLOG_HDRWORDS;
+
+  while (binlog_nextspec(fmt, &spec))
+    {
+      for (; spec.nstar > 0; spec.nstar--)
+        {
+          (void)va_arg(ap, int);
+          nwords++;
+        }
+
+      switch (spec.type)
+        {
+          case BINLOG_ARG_STRING:
+            nwords += BINLOG_STRWORDS(binlog_strlen(va_arg(ap, FAR char *)));
+            break;
+
+          case BINLOG_ARG_DOUBLE:
+            (void)va_arg(ap, double);
+            nwords += 2;
+            break;
+
+          case BINLOG_ARG_LONGLONG:
+            (void)va_arg(ap, long long);
+            nwords += 2;
+            break;
+
+          default:
+            (void)va_arg(ap, int);
+            nwords++;
+            break;
+        }
+
+      fmt = spec.end;
+    }
+
+  return nwords;
+}
+
+/****************************************************************************
+ * Name: binlog_reserve
+ *
+ * Description:
+ *   Reserve 'nwords' contiguous words at the head of the ring.  Returns the
+ *   word index or -1 if there is no room.  Interrupts must be disabled.
+ *
+ ****************************************************************************/
+
+static int binlog_reserve(size_t nwords)
+{
+  uint32_t head = g_head;
+  uint32_t tail = g_tail;
+
+  /* One word is always left unused to tell a full ring from an empty one */
+
+  if (head >= tail)
+    {
+      if (BINLOG_NWORDS - head - (tail == 0 ? 1 : 0) >= nwords)
+        {
+          return head;
+        }
+
+      /* Not enough room at the end: leave it unused and wrap */
+
+      if (tail > nwords)
+        {
+          g_wrap = head;
+          g_head = 0;
+          return 0;
+        }
+    }
+  else if (tail - head - 1 >= nwords)
+    {
+      return head;
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: binlog_putstr
+ ****************************************************************************/
+
+#ifdef CONFIG_SYSLOG_BINARY_FORMAT
+static void binlog_putstr(FAR struct lib_outstream_s *stream,
+                          FAR const char *str, size_t len)
+{
+  while (len-- > 0)
+    {
+      stream->put(stream, *str++);
+    }
+}
+
+/****************************************************************************
+ * Name: binlog_format
+ *
+ * Description:
+ *   Format one record to the SYSLOG output, as lowsyslog() would have.
+ *
+ ****************************************************************************/
+
+static void binlog_format(FAR struct lib_outstream_s *stream,
+                          FAR const uint32_t *rec)
+{
+  FAR const struct binlog_rec_s *hdr = (FAR const struct binlog_rec_s *)rec;
+  FAR const char *fmt = (FAR const char *)(uintptr_t)hdr->fmt;
+  FAR const uint32_t *arg = rec + BINLOG_HDRWORDS;
+  struct binlog_spec_s spec;
+  char specbuf[32];
+  char outbuf[80];
+  long long llval;
+  double dval;
+  size_t speclen;
+  int istar;
+  int n;
+
+  while (binlog_nextspec(fmt, &spec))
+    {
+      /* Literal text before the conversion (with "%%" still escaped) */
+
+      for (; fmt < spec.start; fmt++)
+        {
+          stream->put(stream, *fmt);
+          if (fmt[0] == '%' && fmt[1] == '%')
+            {
+              fmt++;
+            }
+        }
+
+      /* Copy the specification, with any '*' replaced by its value */
+
+      speclen = 0;
+      istar   = 0;
+      for (; fmt < spec.end && speclen < sizeof(specbuf) - 12; fmt++)
+        {
+          if (*fmt == '*' && istar < spec.nstar)
+            {
+              speclen += sprintf(&specbuf[speclen], "%d", (int)arg[istar++]);
+            }
+          else
+            {
+              specbuf[speclen++] = *fmt;
+            }
+
+          specbuf[speclen] = '\0';
+        }
+
+      arg += spec.nstar;
+
+      fmt = spec.end;
+
+      switch (spec.type)
+        {
+          case BINLOG_ARG_STRING:
+            n = snprintf(outbuf, sizeof(outbuf), specbuf, (FAR char *)arg);
+            arg += BINLOG_STRWORDS(strlen((FAR char *)arg));
+            break;
+
+          case BINLOG_ARG_DOUBLE:
+            memcpy(&dval, arg, sizeof(dval));
+            n = snprintf(outbuf, sizeof(outbuf), specbuf, dval);
+            arg += 2;
+            break;
+
+          case BINLOG_ARG_LONGLONG:
+            memcpy(&llval, arg, sizeof(llval));
+            n = snprintf(outbuf, sizeof(outbuf), specbuf, llval);
+            arg += 2;
+            break;
+
+          default:
+            n = snprintf(outbuf, sizeof(outbuf), specbuf, (int)*arg);
+            arg++;
+            break;
+        }
+
+      if (n > 0)
+        {
+          binlog_putstr(stream, outbuf,
+                        n < sizeof(outbuf) ? n : sizeof(outbuf) - 1);
+        }
+    }
+
+  /* Trailing literal text */
+
+  for (; *fmt; fmt++)
+    {
+      stream->put(stream, *fmt);
+      if (fmt[0] == '%' && fmt[1] == '%')
+        {
+          fmt++;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: binlog_worker
+ *
+ * Description:
+ *   Drain the ring from the low-priority work queue, formatting each record
+ *   to the SYSLOG output.
+ *
+ ****************************************************************************/
+
+static void binlog_worker(FAR void *arg)
+{
+  struct lib_outstream_s stream;
+  FAR struct binlog_rec_s *hdr;
+  irqstate_t flags;
+  uint32_t lost;
+
+#ifdef CONFIG_SYSLOG
+  lib_syslogstream(&stream);
+#else
+  lib_lowoutstream(&stream);
+#endif
+
+  for (;;)
+    {
+      /* Copy the oldest record out so that the ring can be refilled while
+       * it is formatted.
+       */
+
+      flags = irqsave();
+      if (g_tail == g_head)
+        {
+          irqrestore(flags);
+          break;
+        }
+
+      hdr = (FAR struct binlog_rec_s *)&g_binlog[g_tail];
+      memcpy(g_fmtrec, hdr, hdr->nwords * sizeof(uint32_t));
+      g_tail += hdr->nwords;
+      if (g_tail >= g_wrap)
+        {
+          g_tail = 0;
+        }
+
+      lost   = g_lost;
+      g_lost = 0;
+      irqrestore(flags);
+
+      if (lost > 0)
+        {
+          char buf[40];
+          binlog_putstr(&stream, buf,
+                        snprintf(buf, sizeof(buf),
+                                 "--- %u log records lost ---\n",
+                                 (unsigned int)lost));
+        }
+
+      binlog_format(&stream, g_fmtrec);
+    }
+}
+#endif /* CONFIG_SYSLOG_BINARY_FORMAT */
+
+/****************************************************************************
+ * Name: binlog_dumpbuf
+ *
+ * Description:
+ *   write() all of 'buf' to 'fd'
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_SYSLOG_BINARY_FORMAT
+static int binlog_dumpbuf(int fd, FAR const void *buf, size_t len)
+{
+  FAR const uint8_t *ptr = (FAR const uint8_t *)buf;
+  ssize_t nwritten;
+
+  while (len > 0)
+    {
+      nwritten = write(fd, ptr, len);
+      if (nwritten < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return -errno;
+        }
+
+      ptr += nwritten;
+      len -= nwritten;
+    }
+
+  return OK;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: binlog_vrecord
+ *
+ * Description:
+ *   Record one log message.  The format string must stay valid for the
+ *   lifetime of the image (a string literal); the argument values are
+ *   copied.  Safe to call from interrupt handlers.
+ *
+ ****************************************************************************/
+
+int binlog_vrecord(FAR const char *fmt, va_list ap)
+{
+  FAR struct binlog_rec_s *hdr;
+  struct binlog_spec_s spec;
+  FAR const char *str;
+  FAR uint32_t *arg;
+  irqstate_t flags;
+  long long llval;
+  double dval;
+  size_t nwords;
+  size_t len;
+  va_list ap2;
+  int index;
+
+  va_copy(ap2, ap);
+  nwords = binlog_recsize(fmt, ap2);
+  va_end(ap2);
+
+  if (nwords > BINLOG_MAXREC)
+    {
+      g_lost++;
+      return -ENOSPC;
+    }
+
+  flags = irqsave();
+  index = binlog_reserve(nwords);
+  if (index < 0)
+    {
+      g_lost++;
+      irqrestore(flags);
+      return -ENOSPC;
+    }
+
+  hdr           = (FAR struct binlog_rec_s *)&g_binlog[index];
+  hdr->nwords   = nwords;
+  hdr->reserved = 0;
+  hdr->time     = clock_systimer();
+  hdr->fmt      = (uint32_t)(uintptr_t)fmt;
+  arg           = (FAR uint32_t *)&g_binlog[index + BINLOG_HDRWORDS];
+
+  while (binlog_nextspec(fmt, &spec))
+    {
+      for (; spec.nstar > 0; spec.nstar--)
+        {
+          *arg++ = (uint32_t)va_arg(ap, int);
+        }
+
+      switch (spec.type)
+        {
+          case BINLOG_ARG_STRING:
+            str = va_arg(ap, FAR const char *);
+            len = binlog_strlen(str);
+            arg[len / sizeof(uint32_t)] = 0;
+            if (len > 0)
+              {
+                memcpy(arg, str, len);
+              }
+
+            arg += BINLOG_STRWORDS(len);
+            break;
+
+          case BINLOG_ARG_DOUBLE:
+            dval = va_arg(ap, double);
+            memcpy(arg, &dval, sizeof(dval));
+            arg += 2;
+            break;
+
+          case BINLOG_ARG_LONGLONG:
+            llval = va_arg(ap, long long);
+            memcpy(arg, &llval, sizeof(llval));
+            arg += 2;
+            break;
+
+          default:
+            *arg++ = (uint32_t)va_arg(ap, int);
+            break;
+        }
+
+      fmt = spec.end;
+    }
+
+  g_head = index + nwords;
+  if (g_head >= BINLOG_NWORDS)
+    {
+      g_wrap = BINLOG_NWORDS;
+      g_head = 0;
+    }
+
+  irqrestore(flags);
+
+#ifdef CONFIG_SYSLOG_BINARY_FORMAT
+  /* Let the low-priority worker format it */
+
+  if (work_available(&g_binlog_work))
+    {
+      (void)work_queue(LPWORK, &g_binlog_work, binlog_worker, NULL, 0);
+    }
+#endif
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: binlog_dump
+ *
+ * Description:
+ *   Write all recorded messages to 'fd' in binary form and discard them.
+ *
+ * Assumptions:
+ *   NEVER called from an interrupt handler
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_SYSLOG_BINARY_FORMAT
+int binlog_dump(int fd)
+{
+  struct binlog_dumphdr_s hdr;
+  irqstate_t flags;
+  uint32_t head;
+  uint32_t tail;
+  uint32_t wrap;
+  int ret;
+
+  /* Take a snapshot of the ring.  Records added while dumping stay for the
+   * next dump.
+   */
+
+  flags    = irqsave();
+  head     = g_head;
+  tail     = g_tail;
+  wrap     = g_wrap;
+  hdr.lost = g_lost;
+  g_lost   = 0;
+  irqrestore(flags);
+
+  hdr.magic    = BINLOG_DUMP_MAGIC;
+  hdr.version  = BINLOG_DUMP_VERSION;
+  hdr.reserved = 0;
+  hdr.maxstr   = CONFIG_SYSLOG_BINARY_MAXSTR;
+  hdr.nwords   = head >= tail ? head - tail : wrap - tail + head;
+  hdr.tickhz   = CLK_TCK;
+
+  /* The records are written as they are stored: at most two contiguous
+   * pieces of the ring.
+   */
+
+  ret = binlog_dumpbuf(fd, &hdr, sizeof(hdr));
+  if (ret == OK && head < tail)
+    {
+      ret = binlog_dumpbuf(fd, &g_binlog[tail],
+                           (wrap - tail) * sizeof(uint32_t));
+      tail = 0;
+    }
+
+  if (ret == OK)
+    {
+      ret = binlog_dumpbuf(fd, &g_binlog[tail],
+                           (head - tail) * sizeof(uint32_t));
+    }
+
+  /* Discard the records after they have been reported */
+
+  g_tail = head;
+  return ret < 0 ? ret : (int)hdr.nwords;
+}
+#endif /* !CONFIG_SYSLOG_BINARY_FORMAT */
+
+#endif /* CONFIG_SYSLOG_BINARY */
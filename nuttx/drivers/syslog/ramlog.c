@@ -61,6 +61,9 @@
 #include <nuttx/syslog/ramlog.h>
 
 #include <arch/irq.h>
+#ifdef CONFIG_RAMLOG_LOCKLESS
+#  include <arch/atomic.h>
+#endif
 
 #ifdef CONFIG_RAMLOG
 
@@ -72,6 +75,10 @@
 #define __ramlog
 #endif
 
+#ifdef CONFIG_RAMLOG_LOCKLESS
+#  define ramlog_barrier() __asm__ __volatile__("" ::: "memory")
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -94,8 +101,15 @@ struct ramlog_dev_s
 #ifndef CONFIG_RAMLOG_NONBLOCKING
   volatile uint8_t  rl_nwaiters;     /* Number of threads waiting for data */
 #endif
+#ifdef CONFIG_RAMLOG_LOCKLESS
+  atomic_t          rl_reserve;      /* Bytes reserved by writers (free running) */
+  atomic_t          rl_commit;       /* Bytes written by writers (free running) */
+  uint32_t          rl_stable;       /* rl_commit when last seen equal to rl_reserve */
+  uint32_t          rl_rdpos;        /* Read position (free running) */
+#else
   volatile uint16_t rl_head;         /* The head index (where data is added) */
   volatile uint16_t rl_tail;         /* The tail index (where data is removed) */
+#endif
   sem_t             rl_exclsem;      /* Enforces mutually exclusive access */
 #ifndef CONFIG_RAMLOG_NONBLOCKING
   sem_t             rl_waitsem;      /* Used to wait for data */
@@ -122,7 +136,14 @@ struct ramlog_dev_s
 static void ramlog_pollnotify(FAR struct ramlog_dev_s *priv,
                               pollevent_t eventset);
 #endif
+#ifdef CONFIG_RAMLOG_LOCKLESS
+static void    ramlog_addbuf(FAR struct ramlog_dev_s *priv,
+                             FAR const char *buffer, size_t len);
+static size_t  ramlog_getbuf(FAR struct ramlog_dev_s *priv,
+                             FAR char *buffer, size_t len);
+#else
 static ssize_t ramlog_addchar(FAR struct ramlog_dev_s *priv, char ch);
+#endif
 
 /* Character driver methods */
 
@@ -186,8 +207,15 @@ static struct ramlog_dev_s g_sysdev =
 #ifndef CONFIG_RAMLOG_NONBLOCKING
   0,                             /* rl_nwaiters */
 #endif
+#ifdef CONFIG_RAMLOG_LOCKLESS
+  0,                             /* rl_reserve */
+  0,                             /* rl_commit */
+  0,                             /* rl_stable */
+  0,                             /* rl_rdpos */
+#else
   0,                             /* rl_head */
   0,                             /* rl_tail */
+#endif
   SEM_INITIALIZER(1),            /* rl_exclsem */
 #ifndef CONFIG_RAMLOG_NONBLOCKING
   SEM_INITIALIZER(0),            /* rl_waitsem */
@@ -235,10 +263,212 @@ static void ramlog_pollnotify(FAR struct ramlog_dev_s *priv,
 #  define ramlog_pollnotify(priv,event)
 #endif
 
+/****************************************************************************
+ * Name: ramlog_readend
+ *
+ * Description:
+ *   Return the end of the data that may be read.  Data is readable once
+ *   every writer that reserved space before it has committed, i.e. the
+ *   last time that no write was in progress.  The caller must hold
+ *   rl_exclsem.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_RAMLOG_LOCKLESS
+static uint32_t ramlog_readend(FAR struct ramlog_dev_s *priv)
+{
+  uint32_t commit;
+
+  /* rl_commit must be sampled first:  If it then equals rl_reserve, all
+   * reservations up to it were complete when it was sampled.
+   */
+
+  commit = atomic_get(&priv->rl_commit);
+  ramlog_barrier();
+  if (commit == atomic_get(&priv->rl_reserve))
+    {
+      priv->rl_stable = commit;
+    }
+
+  return priv->rl_stable;
+}
+
+/****************************************************************************
+ * Name: ramlog_addbuf
+ *
+ * Description:
+ *   Add data to the RAM log without locks or disabling interrupts, so that
+ *   it may be called from any context.  Each writer reserves its range of
+ *   the buffer with one atomic add, copies into it while other writers may
+ *   be copying into theirs, then commits it with a second atomic add.  The
+ *   oldest data is overwritten when the buffer is full.
+ *
+ *   The indices are free-running 32-bit counters.  When they wrap (after
+ *   4GB of output), one buffer's worth of log may come out misordered.
+ *
+ ****************************************************************************/
+
+static void ramlog_addbuf(FAR struct ramlog_dev_s *priv,
+                          FAR const char *buffer, size_t len)
+{
+  uint32_t start;
+  size_t total;
+  size_t ndx;
+  size_t i;
+#ifndef CONFIG_RAMLOG_CRLF
+  size_t nbytes;
+#endif
+
+#ifdef CONFIG_RAMLOG_CRLF
+  /* Carriage returns are dropped and one is added before each linefeed */
+
+  for (i = 0, total = 0; i < len; i++)
+    {
+      if (buffer[i] == '\n')
+        {
+          total += 2;
+        }
+      else if (buffer[i] != '\r')
+        {
+          total++;
+        }
+    }
+#else
+  total = len;
+#endif
+
+  if (total == 0)
+    {
+      return;
+    }
+
+  /* Reserve the space */
+
+  start = atomic_add(&priv->rl_reserve, total) - total;
+  ndx   = start % priv->rl_bufsize;
+
+  /* Copy the data */
+
+#ifdef CONFIG_RAMLOG_CRLF
+  for (i = 0; i < len; i++)
+    {
+      if (buffer[i] == '\r')
+        {
+          continue;
+        }
+
+      if (buffer[i] == '\n')
+        {
+          priv->rl_buffer[ndx] = '\r';
+          if (++ndx >= priv->rl_bufsize)
+            {
+              ndx = 0;
+            }
+        }
+
+      priv->rl_buffer[ndx] = buffer[i];
+      if (++ndx >= priv->rl_bufsize)
+        {
+          ndx = 0;
+        }
+    }
+#else
+  for (i = 0; i < len; i += nbytes)
+    {
+      nbytes = priv->rl_bufsize - ndx;
+      if (nbytes > len - i)
+        {
+          nbytes = len - i;
+        }
+
+      memcpy(&priv->rl_buffer[ndx], &buffer[i], nbytes);
+      ndx = 0;
+    }
+#endif
+
+  /* And commit it */
+
+  ramlog_barrier();
+  atomic_add(&priv->rl_commit, total);
+}
+
+/****************************************************************************
+ * Name: ramlog_getbuf
+ *
+ * Description:
+ *   Copy up to len bytes of readable data to the caller's buffer and return
+ *   the number of bytes copied.  Writers never wait for the reader, so data
+ *   that is overwritten before or while it is copied is skipped.  The
+ *   caller must hold rl_exclsem.
+ *
+ ****************************************************************************/
+
+static size_t ramlog_getbuf(FAR struct ramlog_dev_s *priv,
+                            FAR char *buffer, size_t len)
+{
+  uint32_t reserve;
+  uint32_t lost;
+  uint32_t end;
+  size_t nread;
+  size_t nbytes;
+  size_t ndx;
+  size_t i;
+
+  end = ramlog_readend(priv);
+  if (end - priv->rl_rdpos > priv->rl_bufsize)
+    {
+      priv->rl_rdpos = end - priv->rl_bufsize;
+    }
+
+  nread = end - priv->rl_rdpos;
+  if (nread > len)
+    {
+      nread = len;
+    }
+
+  ndx = priv->rl_rdpos % priv->rl_bufsize;
+  for (i = 0; i < nread; i += nbytes)
+    {
+      nbytes = priv->rl_bufsize - ndx;
+      if (nbytes > nread - i)
+        {
+          nbytes = nread - i;
+        }
+
+      memcpy(&buffer[i], &priv->rl_buffer[ndx], nbytes);
+      ndx = 0;
+    }
+
+  /* Drop whatever writers reserved (and so may have overwritten) while we
+   * were copying.
+   */
+
+  ramlog_barrier();
+  reserve = atomic_get(&priv->rl_reserve);
+  if (reserve - priv->rl_rdpos > priv->rl_bufsize)
+    {
+      lost = reserve - priv->rl_bufsize - priv->rl_rdpos;
+      if (lost >= nread)
+        {
+          priv->rl_rdpos = reserve - priv->rl_bufsize;
+          return 0;
+        }
+
+      memmove(buffer, &buffer[lost], nread - lost);
+      nread          -= lost;
+      priv->rl_rdpos += lost;
+    }
+
+  priv->rl_rdpos += nread;
+  return nread;
+}
+#endif
+
 /****************************************************************************
  * Name: ramlog_addchar
  ****************************************************************************/
 
+#ifndef CONFIG_RAMLOG_LOCKLESS
 static int ramlog_addchar(FAR struct ramlog_dev_s *priv, char ch)
 {
   irqstate_t flags;
@@ -286,6 +516,7 @@ static int ramlog_addchar(FAR struct ramlog_dev_s *priv, char ch)
   irqrestore(flags);
   return OK;
 }
+#endif
 
 /****************************************************************************
  * Name: ramlog_read
@@ -296,7 +527,11 @@ static ssize_t ramlog_read(FAR struct file *filep, FAR char *buffer, size_t len)
   struct inode *inode  = filep->f_inode;
   struct ramlog_dev_s *priv;
   ssize_t nread;
+#ifdef CONFIG_RAMLOG_LOCKLESS
+  size_t ncopied;
+#else
   char ch;
+#endif
   int ret;
 
   /* Some sanity checking */
@@ -322,9 +557,18 @@ static ssize_t ramlog_read(FAR struct file *filep, FAR char *buffer, size_t len)
 
   for (nread = 0; nread < len; )
     {
+#ifdef CONFIG_RAMLOG_LOCKLESS
+      /* Get as much as there is from the buffer */
+
+      ncopied = ramlog_getbuf(priv, &buffer[nread], len - nread);
+      nread  += ncopied;
+
+      if (ncopied == 0)
+#else
       /* Get the next byte from the buffer */
 
       if (priv->rl_head == priv->rl_tail)
+#endif
         {
           /* The circular buffer is empty. */
 
@@ -416,6 +660,7 @@ static ssize_t ramlog_read(FAR struct file *filep, FAR char *buffer, size_t len)
             }
 #endif /* CONFIG_RAMLOG_NONBLOCKING */
         }
+#ifndef CONFIG_RAMLOG_LOCKLESS
       else
         {
           /* The circular buffer is not empty, get the next byte from the
@@ -436,6 +681,7 @@ static ssize_t ramlog_read(FAR struct file *filep, FAR char *buffer, size_t len)
           buffer[nread] = ch;
           nread++;
         }
+#endif
     }
 
   /* Relinquish the mutual exclusion semaphore */
@@ -468,15 +714,22 @@ static ssize_t ramlog_write(FAR struct file *filep, FAR const char *buffer, size
 {
   struct inode *inode = filep->f_inode;
   struct ramlog_dev_s *priv;
+#ifndef CONFIG_RAMLOG_LOCKLESS
   ssize_t nwritten;
   char ch;
   int ret;
+#endif
 
   /* Some sanity checking */
 
   DEBUGASSERT(inode && inode->i_private);
   priv = inode->i_private;
 
+#ifdef CONFIG_RAMLOG_LOCKLESS
+  /* Add the whole buffer at once */
+
+  ramlog_addbuf(priv, buffer, len);
+#else
  /* Loop until all of the bytes have been written.  This function may be
   * called from an interrupt handler!  Semaphores cannot be used!
   *
@@ -530,11 +783,16 @@ static ssize_t ramlog_write(FAR struct file *filep, FAR const char *buffer, size
           break;
         }
     }
+#endif
 
   /* Was anything written? */
 
 #if !defined(CONFIG_RAMLOG_NONBLOCKING) || !defined(CONFIG_DISABLE_POLL)
+#ifdef CONFIG_RAMLOG_LOCKLESS
+  if (len > 0)
+#else
   if (nwritten > 0)
+#endif
     {
       irqstate_t flags;
 #ifndef CONFIG_RAMLOG_NONBLOCKING
@@ -578,7 +836,9 @@ int ramlog_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup)
   FAR struct inode *inode = filep->f_inode;
   FAR struct ramlog_dev_s *priv;
   pollevent_t eventset;
+#ifndef CONFIG_RAMLOG_LOCKLESS
   int ndx;
+#endif
   int ret;
   int i;
 
@@ -631,6 +891,18 @@ int ramlog_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup)
 
       eventset = 0;
 
+#ifdef CONFIG_RAMLOG_LOCKLESS
+      /* Writes never block */
+
+      eventset |= POLLOUT;
+
+      /* Check if the receive buffer is empty */
+
+      if (ramlog_readend(priv) != priv->rl_rdpos)
+       {
+         eventset |= POLLIN;
+       }
+#else
       ndx = priv->rl_head + 1;
       if (ndx >= priv->rl_bufsize)
         {
@@ -648,6 +920,7 @@ int ramlog_poll(FAR struct file *filep, FAR struct pollfd *fds, bool setup)
        {
          eventset |= POLLIN;
        }
+#endif
 
       if (eventset)
         {
@@ -882,16 +1155,37 @@ void ramlog_preserve_last(void)
       /* Copy previous ramlog */
 
       g_syslastdev.rl_validity = priv->rl_validity;
+#ifdef CONFIG_RAMLOG_LOCKLESS
+      /* Keep everything that was reserved, a write that was interrupted by
+       * the reset may be the most interesting one.
+       */
+
+      g_syslastdev.rl_head = priv->rl_reserve % priv->rl_bufsize;
+      g_syslastdev.rl_tail = 0;
+      if ((uint32_t)priv->rl_reserve >= priv->rl_bufsize)
+        {
+          g_syslastdev.rl_tail = (g_syslastdev.rl_head + 1) %
+                                 priv->rl_bufsize;
+        }
+#else
       g_syslastdev.rl_head = priv->rl_head;
       g_syslastdev.rl_tail = priv->rl_tail;
+#endif
       g_syslastdev.rl_bufsize = priv->rl_bufsize;
       memcpy(g_syslastbuffer, priv->rl_buffer, priv->rl_bufsize);
     }
 
   /* Must initialize g_sysdev here since it is not statically initialized */
   priv->rl_validity = RAMLOG_VALIDITY;
+#ifdef CONFIG_RAMLOG_LOCKLESS
+  atomic_init(&priv->rl_reserve, 0);
+  atomic_init(&priv->rl_commit, 0);
+  priv->rl_stable = 0;
+  priv->rl_rdpos = 0;
+#else
   priv->rl_head = 0;
   priv->rl_tail = 0;
+#endif
   sem_init(&priv->rl_exclsem, 0, 1);
   priv->rl_bufsize = CONFIG_RAMLOG_BUFSIZE;
   priv->rl_buffer = g_sysbuffer;
@@ -919,6 +1213,12 @@ void ramlog_preserve_last(void)
 int syslog_putc(int ch)
 {
   FAR struct ramlog_dev_s *priv = &g_sysdev;
+#ifdef CONFIG_RAMLOG_LOCKLESS
+  char buffer = ch;
+
+  ramlog_addbuf(priv, &buffer, 1);
+  return ch;
+#else
   int ret;
 
 #ifdef CONFIG_RAMLOG_CRLF
@@ -960,6 +1260,7 @@ int syslog_putc(int ch)
 errout:
   set_errno(-ret);
   return EOF;
+#endif
 }
 #endif
 
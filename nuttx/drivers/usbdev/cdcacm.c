@@ -53,6 +53,8 @@
 
 #include <nuttx/kmalloc.h>
 #include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/wdog.h>
 #include <nuttx/serial/serial.h>
 
 #include <nuttx/usb/usb.h>
@@ -63,7 +65,7 @@
 
 #include "cdcacm.h"
 
-#ifdef CONFIG_USBMSC_COMPOSITE
+#ifdef CONFIG_CDCACM_COMPOSITE
 #  include <nuttx/usb/composite.h>
 #  include "composite.h"
 #endif
@@ -72,6 +74,20 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Report bulk transfers to the composite arbiter */
+
+#ifdef CONFIG_CDCACM_COMPOSITE
+#  define CDCACM_TXSTART()      composite_txstart(COMPOSITE_CDCACM_FUNC)
+#  define CDCACM_TXDONE(n)      composite_txdone(COMPOSITE_CDCACM_FUNC, n)
+#  define CDCACM_RXDONE(n)      composite_rxdone(COMPOSITE_CDCACM_FUNC, n)
+#  define CDCACM_MAYXFER()      composite_mayxfer(COMPOSITE_CDCACM_FUNC)
+#else
+#  define CDCACM_TXSTART()
+#  define CDCACM_TXDONE(n)
+#  define CDCACM_RXDONE(n)
+#  define CDCACM_MAYXFER()      (true)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -107,6 +123,14 @@ struct cdcacm_dev_s
   FAR struct usbdev_ep_s  *epbulkout;  /* Bulk OUT endpoint structure */
   FAR struct usbdev_req_s *ctrlreq;    /* Allocated control request */
   struct sq_queue_s        reqlist;    /* List of write request containers */
+#if CONFIG_CDCACM_TXCOALESCE_MSEC > 0
+  WDOG_ID                  txflush;    /* Flushes coalesced short TX data */
+  bool                     txarmed;    /* Flush timer is running */
+  bool                     txforce;    /* Flush timer expired: send short data */
+#endif
+#ifdef CONFIG_CDCACM_STATS
+  struct cdcacm_stats_s    stats;      /* Transfer statistics */
+#endif
 
   /* Pre-allocated write request containers.  The write requests will
    * be linked in a free list (reqlist), and used to send requests to
@@ -114,7 +138,7 @@ struct cdcacm_dev_s
    */
 
   struct cdcacm_req_s wrreqs[CONFIG_CDCACM_NWRREQS];
-  struct cdcacm_req_s rdreqs[CONFIG_CDCACM_NWRREQS];
+  struct cdcacm_req_s rdreqs[CONFIG_CDCACM_NRDREQS];
 
   /* Serial I/O buffers */
 
@@ -147,6 +171,9 @@ struct cdcacm_alloc_s
 static uint16_t cdcacm_fillrequest(FAR struct cdcacm_dev_s *priv,
                  uint8_t *reqbuf, uint16_t reqlen);
 static int     cdcacm_sndpacket(FAR struct cdcacm_dev_s *priv);
+#if CONFIG_CDCACM_TXCOALESCE_MSEC > 0
+static void    cdcacm_txflush(int argc, uint32_t arg1, ...);
+#endif
 static inline int cdcacm_recvpacket(FAR struct cdcacm_dev_s *priv,
                  uint8_t *reqbuf, uint16_t reqlen);
 
@@ -274,21 +301,42 @@ static uint16_t cdcacm_fillrequest(FAR struct cdcacm_dev_s *priv, uint8_t *reqbu
   FAR struct uart_buffer_s *xmit = &serdev->xmit;
   irqstate_t flags;
   uint16_t nbytes = 0;
+  uint16_t ncopy;
 
   /* Disable interrupts */
 
   flags = irqsave();
 
-  /* Transfer bytes while we have bytes available and there is room in the request */
+  /* Transfer bytes while we have bytes available and there is room in the
+   * request.  The data in the circular buffer is contiguous from the tail
+   * up to either the head or the end of the buffer, so at most two copies
+   * are needed.
+   */
 
   while (xmit->head != xmit->tail && nbytes < reqlen)
     {
-      *reqbuf++ = xmit->buffer[xmit->tail];
-      nbytes++;
+      if (xmit->head > xmit->tail)
+        {
+          ncopy = xmit->head - xmit->tail;
+        }
+      else
+        {
+          ncopy = xmit->size - xmit->tail;
+        }
+
+      if (ncopy > reqlen - nbytes)
+        {
+          ncopy = reqlen - nbytes;
+        }
+
+      memcpy(reqbuf, &xmit->buffer[xmit->tail], ncopy);
+      reqbuf += ncopy;
+      nbytes += ncopy;
 
       /* Increment the tail pointer */
 
-      if (++(xmit->tail) >= xmit->size)
+      xmit->tail += ncopy;
+      if (xmit->tail >= xmit->size)
         {
           xmit->tail = 0;
         }
@@ -334,6 +382,10 @@ static int cdcacm_sndpacket(FAR struct cdcacm_dev_s *priv)
   FAR struct cdcacm_req_s *reqcontainer;
   uint16_t reqlen;
   irqstate_t flags;
+#if CONFIG_CDCACM_TXCOALESCE_MSEC > 0
+  FAR struct uart_buffer_s *xmit;
+  int pending;
+#endif
   int len;
   int ret = OK;
 
@@ -364,8 +416,42 @@ static int cdcacm_sndpacket(FAR struct cdcacm_dev_s *priv)
 
   reqlen = MAX(CONFIG_CDCACM_BULKIN_REQLEN, ep->maxpacket);
 
-  while (!sq_empty(&priv->reqlist))
+  while (!sq_empty(&priv->reqlist) && CDCACM_MAYXFER())
     {
+#if CONFIG_CDCACM_TXCOALESCE_MSEC > 0
+      /* Don't send a short packet if more data is likely to follow.  If
+       * a write is still in flight, its completion will send what has
+       * accumulated by then.  Otherwise start the flush timer so that the
+       * data is not held for longer than CONFIG_CDCACM_TXCOALESCE_MSEC.
+       */
+
+      xmit    = &priv->serdev.xmit;
+      pending = (int)xmit->head - (int)xmit->tail;
+      if (pending < 0)
+        {
+          pending += xmit->size;
+        }
+
+      if (pending > 0 && pending < ep->maxpacket && !priv->txforce)
+        {
+          if (priv->nwrq >= CONFIG_CDCACM_NWRREQS && !priv->txarmed)
+            {
+              priv->txarmed = true;
+              (void)wd_start(priv->txflush,
+                             MSEC2TICK(CONFIG_CDCACM_TXCOALESCE_MSEC),
+                             (wdentry_t)cdcacm_txflush, 1,
+                             (uint32_t)priv);
+            }
+
+#ifdef CONFIG_CDCACM_STATS
+          priv->stats.txdeferred++;
+#endif
+          break;
+        }
+
+      priv->txforce = false;
+#endif
+
       /* Peek at the request in the container at the head of the list */
 
       reqcontainer = (FAR struct cdcacm_req_s *)sq_peek(&priv->reqlist);
@@ -386,12 +472,20 @@ static int cdcacm_sndpacket(FAR struct cdcacm_dev_s *priv)
           req->len     = len;
           req->priv    = reqcontainer;
           req->flags   = USBDEV_REQFLAGS_NULLPKT;
+
+          CDCACM_TXSTART();
           ret          = EP_SUBMIT(ep, req);
           if (ret != OK)
             {
               usbtrace(TRACE_CLSERROR(USBSER_TRACEERR_SUBMITFAIL), (uint16_t)-ret);
+              CDCACM_TXDONE(0);
               break;
             }
+
+#ifdef CONFIG_CDCACM_STATS
+          priv->stats.txreqs++;
+          priv->stats.txbytes += len;
+#endif
         }
       else
         {
@@ -403,6 +497,32 @@ static int cdcacm_sndpacket(FAR struct cdcacm_dev_s *priv)
   return ret;
 }
 
+/****************************************************************************
+ * Name: cdcacm_txflush
+ *
+ * Description:
+ *   The TX coalescing timer expired.  Send whatever short data has
+ *   accumulated in the TX buffer.
+ *
+ * Assumptions:
+ *   Called from the timer interrupt handler.
+ *
+ ****************************************************************************/
+
+#if CONFIG_CDCACM_TXCOALESCE_MSEC > 0
+static void cdcacm_txflush(int argc, uint32_t arg1, ...)
+{
+  FAR struct cdcacm_dev_s *priv = (FAR struct cdcacm_dev_s *)arg1;
+
+  priv->txarmed = false;
+  if (priv->config != CDCACM_CONFIGIDNONE)
+    {
+      priv->txforce = true;
+      (void)cdcacm_sndpacket(priv);
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: cdcacm_recvpacket
  *
@@ -422,8 +542,8 @@ static inline int cdcacm_recvpacket(FAR struct cdcacm_dev_s *priv,
   FAR uart_dev_t *serdev = &priv->serdev;
   FAR struct uart_buffer_s *recv = &serdev->recv;
   uint16_t currhead;
-  uint16_t nexthead;
   uint16_t nbytes = 0;
+  uint16_t ncopy;
 
   uvdbg("head=%d tail=%d nrdq=%d reqlen=%d\n",
         priv->serdev.recv.head, priv->serdev.recv.tail, priv->nrdq, reqlen);
@@ -444,39 +564,53 @@ static inline int cdcacm_recvpacket(FAR struct cdcacm_dev_s *priv,
       currhead = priv->rxhead;
     }
 
-  /* Pre-calculate the head index and check for wrap around.  We need to do this
-   * so that we can determine if the circular buffer will overrun BEFORE we
-   * overrun the buffer!
-   */
-
-  nexthead = currhead + 1;
-  if (nexthead >= recv->size)
-    {
-      nexthead = 0;
-    }
-
   /* Then copy data into the RX buffer until either: (1) all of the data has been
    * copied, or (2) the RX buffer is full.  NOTE:  If the RX buffer becomes full,
    * then we have overrun the serial driver and data will be lost.
+   *
+   * One slot is always left empty so that a full buffer can be distinguished
+   * from an empty one.  The free space is contiguous from the head up to
+   * either the slot before the tail or the end of the buffer, so at most two
+   * copies are needed.
    */
 
-  while (nexthead != recv->tail && nbytes < reqlen)
+  while (nbytes < reqlen)
     {
-      /* Copy one byte to the head of the circular RX buffer */
+      if (currhead >= recv->tail)
+        {
+          ncopy = recv->size - currhead;
+          if (recv->tail == 0)
+            {
+              ncopy--;
+            }
+        }
+      else
+        {
+          ncopy = recv->tail - currhead - 1;
+        }
 
-      recv->buffer[currhead] = *reqbuf++;
+      if (ncopy == 0)
+        {
+          break;
+        }
 
-      /* Update counts and indices */
+      if (ncopy > reqlen - nbytes)
+        {
+          ncopy = reqlen - nbytes;
+        }
+
+      /* Copy to the head of the circular RX buffer */
 
-      currhead = nexthead;
-      nbytes++;
+      memcpy(&recv->buffer[currhead], reqbuf, ncopy);
+      reqbuf += ncopy;
+      nbytes += ncopy;
 
       /* Increment the head index and check for wrap around */
 
-      nexthead = currhead + 1;
-      if (nexthead >= recv->size)
+      currhead += ncopy;
+      if (currhead >= recv->size)
         {
-          nexthead = 0;
+          currhead = 0;
         }
     }
 
@@ -506,9 +640,17 @@ static inline int cdcacm_recvpacket(FAR struct cdcacm_dev_s *priv,
 
   /* Return an error if the entire packet could not be transferred */
 
+#ifdef CONFIG_CDCACM_STATS
+  priv->stats.rxreqs++;
+  priv->stats.rxbytes += nbytes;
+#endif
+
   if (nbytes < reqlen)
     {
       usbtrace(TRACE_CLSERROR(USBSER_TRACEERR_RXOVERRUN), 0);
+#ifdef CONFIG_CDCACM_STATS
+      priv->stats.rxoverruns++;
+#endif
       return -ENOSPC;
     }
   return OK;
@@ -581,6 +723,14 @@ static void cdcacm_resetconfig(FAR struct cdcacm_dev_s *priv)
 
       priv->config = CDCACM_CONFIGIDNONE;
 
+#if CONFIG_CDCACM_TXCOALESCE_MSEC > 0
+      /* Cancel any pending TX flush */
+
+      wd_cancel(priv->txflush);
+      priv->txarmed = false;
+      priv->txforce = false;
+#endif
+
       /* Inform the "upper half" driver that there is no (functional) USB
        * connection.
        */
@@ -825,6 +975,7 @@ static void cdcacm_rdcomplete(FAR struct usbdev_ep_s *ep,
     {
     case 0: /* Normal completion */
       usbtrace(TRACE_CLASSRDCOMPLETE, priv->nrdq);
+      CDCACM_RXDONE(req->xfrd);
       cdcacm_recvpacket(priv, req->buf, req->xfrd);
       break;
 
@@ -887,6 +1038,7 @@ static void cdcacm_wrcomplete(FAR struct usbdev_ep_s *ep,
   flags = irqsave();
   sq_addlast((sq_entry_t*)reqcontainer, &priv->reqlist);
   priv->nwrq++;
+  CDCACM_TXDONE(req->xfrd);
   irqrestore(flags);
 
   /* Send the next packet unless this was some unusual termination
@@ -966,6 +1118,17 @@ static int cdcacm_bind(FAR struct usbdevclass_driver_s *driver,
 
   priv->ctrlreq->callback = cdcacm_ep0incomplete;
 
+#if CONFIG_CDCACM_TXCOALESCE_MSEC > 0
+  /* Create the watchdog used to flush coalesced TX data */
+
+  priv->txflush = wd_create();
+  if (priv->txflush == NULL)
+    {
+      ret = -ENOMEM;
+      goto errout;
+    }
+#endif
+
   /* Pre-allocate all endpoints... the endpoints will not be functional
    * until the SET CONFIGURATION request is processed in cdcacm_setconfig.
    * This is done here because there may be calls to kmm_malloc and the SET
@@ -1167,6 +1330,16 @@ static void cdcacm_unbind(FAR struct usbdevclass_driver_s *driver,
           priv->ctrlreq = NULL;
         }
 
+#if CONFIG_CDCACM_TXCOALESCE_MSEC > 0
+      /* Delete the TX flush watchdog */
+
+      if (priv->txflush != NULL)
+        {
+          wd_delete(priv->txflush);
+          priv->txflush = NULL;
+        }
+#endif
+
       /* Free pre-allocated read requests (which should all have
        * been returned to the free list at this time -- we don't check)
        */
@@ -1928,6 +2101,30 @@ static int cdcuart_ioctl(FAR struct file *filep,int cmd,unsigned long arg)
       }
       break;
 
+#ifdef CONFIG_CDCACM_STATS
+    /* CAIOC_GETSTATS
+     *   Get the transfer statistics.  Argument: struct cdcacm_stats_s*.
+     */
+
+    case CAIOC_GETSTATS:
+      {
+        FAR struct cdcacm_stats_s *ptr = (FAR struct cdcacm_stats_s *)((uintptr_t)arg);
+        irqstate_t flags;
+
+        if (ptr)
+          {
+            flags = irqsave();
+            memcpy(ptr, &priv->stats, sizeof(struct cdcacm_stats_s));
+            irqrestore(flags);
+          }
+        else
+          {
+            ret = -EINVAL;
+          }
+      }
+      break;
+#endif
+
 #ifdef CONFIG_SERIAL_TERMIOS
     case TCGETS:
       {
@@ -63,6 +63,19 @@
  * Private Types
  ****************************************************************************/
 
+/* Arbitration state of one member of the composite */
+
+#if defined(CONFIG_COMPOSITE_ARBITER) || defined(CONFIG_COMPOSITE_STATS)
+struct composite_func_s
+{
+  uint8_t                      prio;     /* Arbitration priority */
+  volatile uint8_t             txbusy;   /* Bulk IN requests in flight */
+#ifdef CONFIG_COMPOSITE_STATS
+  struct composite_stats_s     stats;    /* Transfer statistics */
+#endif
+};
+#endif
+
 /* This structure describes the internal state of the driver */
 
 struct composite_dev_s
@@ -72,6 +85,9 @@ struct composite_dev_s
   FAR struct usbdev_req_s     *ctrlreq;  /* Allocated control request */
   struct usbdevclass_driver_s *dev1;     /* Device 1 class object */
   struct usbdevclass_driver_s *dev2;     /* Device 2 class object */
+#if defined(CONFIG_COMPOSITE_ARBITER) || defined(CONFIG_COMPOSITE_STATS)
+  struct composite_func_s      func[COMPOSITE_NFUNCS];
+#endif
 };
 
 /* The internal version of the class driver */
@@ -146,6 +162,14 @@ const char g_compvendorstr[]  = CONFIG_COMPOSITE_VENDORSTR;
 const char g_compproductstr[] = CONFIG_COMPOSITE_PRODUCTSTR;
 const char g_compserialstr[]  = CONFIG_COMPOSITE_SERIALSTR;
 
+/* The members report their transfers without a reference to the composite,
+ * so keep one here.  There can be only one composite device.
+ */
+
+#if defined(CONFIG_COMPOSITE_ARBITER) || defined(CONFIG_COMPOSITE_STATS)
+static FAR struct composite_dev_s *g_compdev;
+#endif
+
  /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -375,6 +399,10 @@ static void composite_unbind(FAR struct usbdevclass_driver_s *driver,
       /* Free the pre-allocated control request */
 
       priv->config = COMPOSITE_CONFIGIDNONE;
+#if defined(CONFIG_COMPOSITE_ARBITER) || defined(CONFIG_COMPOSITE_STATS)
+      priv->func[COMPOSITE_FUNC_DEV1].txbusy = 0;
+      priv->func[COMPOSITE_FUNC_DEV2].txbusy = 0;
+#endif
       if (priv->ctrlreq != NULL)
         {
           composite_freereq(dev->ep0, priv->ctrlreq);
@@ -839,6 +867,12 @@ FAR void *composite_initialize(void)
   drvr->drvr.ops           = &g_driverops;
   drvr->dev                = priv;
 
+#if defined(CONFIG_COMPOSITE_ARBITER) || defined(CONFIG_COMPOSITE_STATS)
+  priv->func[COMPOSITE_FUNC_DEV1].prio = DEV1_PRIO;
+  priv->func[COMPOSITE_FUNC_DEV2].prio = DEV2_PRIO;
+  g_compdev                = priv;
+#endif
+
   /* Register the USB composite class driver */
 
   ret = usbdev_register(&drvr->drvr);
@@ -851,6 +885,9 @@ FAR void *composite_initialize(void)
   return (FAR void *)alloc;
 
 errout_with_alloc:
+#if defined(CONFIG_COMPOSITE_ARBITER) || defined(CONFIG_COMPOSITE_STATS)
+  g_compdev = NULL;
+#endif
   kmm_free(alloc);
   return NULL;
 }
@@ -901,6 +938,9 @@ void composite_uninitialize(FAR void *handle)
 
   /* Then free the composite driver state structure itself */
 
+#if defined(CONFIG_COMPOSITE_ARBITER) || defined(CONFIG_COMPOSITE_STATS)
+  g_compdev = NULL;
+#endif
   kmm_free(priv);
 }
 
@@ -927,4 +967,177 @@ int composite_ep0submit(FAR struct usbdevclass_driver_s *driver,
    return EP_SUBMIT(dev->ep0, ctrlreq);
 }
 
+/****************************************************************************
+ * Name: composite_txstart
+ *
+ * Description:
+ *   A member of the composite is about to submit a bulk IN request
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_COMPOSITE_ARBITER) || defined(CONFIG_COMPOSITE_STATS)
+void composite_txstart(int func)
+{
+  FAR struct composite_dev_s *priv = g_compdev;
+  FAR struct composite_func_s *member;
+  irqstate_t flags;
+
+  if (priv != NULL && func >= 0 && func < COMPOSITE_NFUNCS)
+    {
+      member = &priv->func[func];
+
+      flags = irqsave();
+      member->txbusy++;
+#ifdef CONFIG_COMPOSITE_STATS
+      if (member->txbusy > member->stats.txmax)
+        {
+          member->stats.txmax = member->txbusy;
+        }
+#endif
+      irqrestore(flags);
+    }
+}
+
+/****************************************************************************
+ * Name: composite_txdone
+ *
+ * Description:
+ *   A bulk IN request of a member of the composite has completed
+ *
+ ****************************************************************************/
+
+void composite_txdone(int func, size_t nbytes)
+{
+  FAR struct composite_dev_s *priv = g_compdev;
+  FAR struct composite_func_s *member;
+  irqstate_t flags;
+
+  if (priv != NULL && func >= 0 && func < COMPOSITE_NFUNCS)
+    {
+      member = &priv->func[func];
+
+      flags = irqsave();
+      if (member->txbusy > 0)
+        {
+          member->txbusy--;
+        }
+
+#ifdef CONFIG_COMPOSITE_STATS
+      member->stats.txreqs++;
+      member->stats.txbytes += nbytes;
+#endif
+      irqrestore(flags);
+    }
+}
+#endif /* CONFIG_COMPOSITE_ARBITER || CONFIG_COMPOSITE_STATS */
+
+/****************************************************************************
+ * Name: composite_rxdone
+ *
+ * Description:
+ *   A bulk OUT request of a member of the composite has completed
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_COMPOSITE_STATS
+void composite_rxdone(int func, size_t nbytes)
+{
+  FAR struct composite_dev_s *priv = g_compdev;
+  irqstate_t flags;
+
+  if (priv != NULL && func >= 0 && func < COMPOSITE_NFUNCS)
+    {
+      flags = irqsave();
+      priv->func[func].stats.rxreqs++;
+      priv->func[func].stats.rxbytes += nbytes;
+      irqrestore(flags);
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: composite_mayxfer
+ *
+ * Description:
+ *   Return true if the member 'func' may submit another bulk IN request now
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_COMPOSITE_ARBITER
+bool composite_mayxfer(int func)
+{
+  FAR struct composite_dev_s *priv = g_compdev;
+  FAR struct composite_func_s *member;
+  bool ret = true;
+  int i;
+
+  if (priv == NULL || func < 0 || func >= COMPOSITE_NFUNCS)
+    {
+      return true;
+    }
+
+  /* A member may always keep a few requests in flight, so that it keeps
+   * making progress and is woken up by its own completions.
+   */
+
+  member = &priv->func[func];
+  if (member->txbusy < CONFIG_COMPOSITE_ARBITER_NREQS)
+    {
+      return true;
+    }
+
+  /* Beyond that, it has to wait while a higher priority member is busy */
+
+  for (i = 0; i < COMPOSITE_NFUNCS; i++)
+    {
+      if (i != func && priv->func[i].prio > member->prio &&
+          priv->func[i].txbusy > 0)
+        {
+          ret = false;
+          break;
+        }
+    }
+
+#ifdef CONFIG_COMPOSITE_STATS
+  if (!ret)
+    {
+      member->stats.yields++;
+    }
+#endif
+
+  return ret;
+}
+#endif
+
+/****************************************************************************
+ * Name: composite_getstats
+ *
+ * Description:
+ *   Return the transfer statistics of a member of the composite
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_COMPOSITE_STATS
+int composite_getstats(int func, FAR struct composite_stats_s *stats)
+{
+  FAR struct composite_dev_s *priv = g_compdev;
+  irqstate_t flags;
+
+  if (priv == NULL)
+    {
+      return -ENODEV;
+    }
+
+  if (func < 0 || func >= COMPOSITE_NFUNCS || stats == NULL)
+    {
+      return -EINVAL;
+    }
+
+  flags = irqsave();
+  memcpy(stats, &priv->func[func].stats, sizeof(struct composite_stats_s));
+  irqrestore(flags);
+  return OK;
+}
+#endif
+
 #endif /* CONFIG_USBDEV_COMPOSITE */
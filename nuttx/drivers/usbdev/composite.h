@@ -140,7 +140,7 @@
 #  define DEV1_STRIDBASE      CONFIG_CDCACM_STRBASE
 #  define DEV1_NSTRIDS        CDCACM_NSTRIDS
 #  define DEV1_CFGDESCSIZE    SIZEOF_CDCACM_CFGDESC
-#elif defined(CONFIG_CDCACM_COMPOSITE)
+#elif defined(CONFIG_USBMSC_COMPOSITE)
 #  define DEV1_IS_USBMSC     1
 #  define DEV1_MKCFGDESC      usbmsc_mkcfgdesc
 #  define DEV1_MKSTRDESC      usbmsc_mkstrdesc
@@ -174,7 +174,7 @@
 #  define DEV2_STRIDBASE      CONFIG_CDCACM_STRBASE
 #  define DEV2_NSTRIDS        CDCACM_NSTRIDS
 #  define DEV2_CFGDESCSIZE    SIZEOF_CDCACM_CFGDESC
-#elif defined(CONFIG_CDCACM_COMPOSITE) && !defined(DEV1_IS_USBMSC)
+#elif defined(CONFIG_USBMSC_COMPOSITE) && !defined(DEV1_IS_USBMSC)
 #  define DEV2_IS_USBMSC     1
 #  define DEV2_MKCFGDESC      usbmsc_mkcfgdesc
 #  define DEV2_MKSTRDESC      usbmsc_mkstrdesc
@@ -191,6 +191,44 @@
 #  error "Insufficient members of the composite defined"
 #endif
 
+/* Position and arbitration priority of each class in the composite */
+
+#ifdef DEV1_IS_CDCACM
+#  define COMPOSITE_CDCACM_FUNC COMPOSITE_FUNC_DEV1
+#elif defined(DEV2_IS_CDCACM)
+#  define COMPOSITE_CDCACM_FUNC COMPOSITE_FUNC_DEV2
+#endif
+
+#ifdef DEV1_IS_USBMSC
+#  define COMPOSITE_USBMSC_FUNC COMPOSITE_FUNC_DEV1
+#elif defined(DEV2_IS_USBMSC)
+#  define COMPOSITE_USBMSC_FUNC COMPOSITE_FUNC_DEV2
+#endif
+
+#ifndef CONFIG_CDCACM_COMPOSITE_PRIO
+#  define CONFIG_CDCACM_COMPOSITE_PRIO 1
+#endif
+
+#ifndef CONFIG_USBMSC_COMPOSITE_PRIO
+#  define CONFIG_USBMSC_COMPOSITE_PRIO 0
+#endif
+
+#ifdef DEV1_IS_CDCACM
+#  define DEV1_PRIO           CONFIG_CDCACM_COMPOSITE_PRIO
+#else
+#  define DEV1_PRIO           CONFIG_USBMSC_COMPOSITE_PRIO
+#endif
+
+#ifdef DEV2_IS_CDCACM
+#  define DEV2_PRIO           CONFIG_CDCACM_COMPOSITE_PRIO
+#else
+#  define DEV2_PRIO           CONFIG_USBMSC_COMPOSITE_PRIO
+#endif
+
+#ifndef CONFIG_COMPOSITE_ARBITER_NREQS
+#  define CONFIG_COMPOSITE_ARBITER_NREQS 1
+#endif
+
 /* Verify interface configuration */
 
 #if DEV1_FIRSTINTERFACE != 0
@@ -41,11 +41,16 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <unistd.h>
 #include <errno.h>
 #include <debug.h>
 
 #include <arch/irq.h>
+#include <nuttx/clock.h>
 #include <nuttx/usb/usbdev_trace.h>
+#ifdef CONFIG_IRQSAVE_TRACE
+#  include <nuttx/irqtrace.h>
+#endif
 #undef usbtrace
 
 /****************************************************************************
@@ -62,6 +67,25 @@
 #  define CONFIG_USBDEV_TRACE_INITIALIDSET 0
 #endif
 
+/* Timestamps use the IRQ tracer's free-running cycle counter when there is
+ * one and fall back to the system timer otherwise.
+ */
+
+#ifdef CONFIG_USBDEV_TRACE_TIMESTAMP
+#  ifdef CONFIG_IRQSAVE_TRACE
+#    define usbtrace_now()  up_irqtrace_cycles()
+#    define USBTRACE_TFLAGS (USBTRACE_DUMP_FLAG_TIME | USBTRACE_DUMP_FLAG_CYCLES)
+#    define USBTRACE_TICKHZ 0
+#  else
+#    define usbtrace_now()  ((uint32_t)clock_systimer())
+#    define USBTRACE_TFLAGS USBTRACE_DUMP_FLAG_TIME
+#    define USBTRACE_TICKHZ CLK_TCK
+#  endif
+#else
+#  define USBTRACE_TFLAGS   0
+#  define USBTRACE_TICKHZ   0
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -78,6 +102,7 @@
 static struct usbtrace_s g_trace[CONFIG_USBDEV_TRACE_NRECORDS];
 static uint16_t g_head = 0;
 static uint16_t g_tail = 0;
+static uint32_t g_lost = 0;
 #endif
 
 #if defined(CONFIG_USBDEV_TRACE) || (defined(CONFIG_DEBUG) && defined(CONFIG_DEBUG_USB))
@@ -152,6 +177,9 @@ void usbtrace(uint16_t event, uint16_t value)
 
       g_trace[g_head].event = event;
       g_trace[g_head].value = value;
+#ifdef CONFIG_USBDEV_TRACE_TIMESTAMP
+      g_trace[g_head].time  = usbtrace_now();
+#endif
 
       /* Increment the head and (probably) the tail index */
 
@@ -162,6 +190,7 @@ void usbtrace(uint16_t event, uint16_t value)
 
       if (g_head == g_tail)
         {
+          g_lost++;
           if (++g_tail >= CONFIG_USBDEV_TRACE_NRECORDS)
             {
               g_tail = 0;
@@ -232,3 +261,107 @@ int usbtrace_enumerate(trace_callback_t callback, void *arg)
   return ret;
 }
 #endif /* CONFIG_USBDEV_TRACE */
+
+/*******************************************************************************
+ * Name: usbtrace_dumpbuf
+ *
+ * Description:
+ *   write() all of 'buf' to 'fd'
+ *
+ *******************************************************************************/
+
+#ifdef CONFIG_USBDEV_TRACE
+static int usbtrace_dumpbuf(int fd, FAR const void *buf, size_t len)
+{
+  FAR const uint8_t *ptr = (FAR const uint8_t *)buf;
+  ssize_t nwritten;
+
+  while (len > 0)
+    {
+      nwritten = write(fd, ptr, len);
+      if (nwritten < 0)
+        {
+          if (errno == EINTR)
+            {
+              continue;
+            }
+
+          return -errno;
+        }
+
+      ptr += nwritten;
+      len -= nwritten;
+    }
+
+  return OK;
+}
+
+/*******************************************************************************
+ * Name: usbtrace_dump
+ *
+ * Description:
+ *   Write all buffered trace data to 'fd' in binary form (will temporarily
+ *   disable tracing)
+ *
+ * Assumptions:
+ *   NEVER called from an interrupt handler
+ *
+ *******************************************************************************/
+
+int usbtrace_dump(int fd)
+{
+  struct usbtrace_dumphdr_s hdr;
+  irqstate_t flags;
+  uint32_t idset;
+  uint16_t head;
+  uint16_t tail;
+  int ret;
+
+  /* Temporarily disable tracing and take a snapshot of the ring */
+
+  idset = usbtrace_enable(0);
+
+  flags  = irqsave();
+  head   = g_head;
+  tail   = g_tail;
+  hdr.lost = g_lost;
+  g_lost = 0;
+  irqrestore(flags);
+
+  hdr.magic    = USBTRACE_DUMP_MAGIC;
+  hdr.version  = USBTRACE_DUMP_VERSION;
+  hdr.flags    = USBTRACE_TFLAGS;
+  hdr.recsize  = sizeof(struct usbtrace_s);
+  hdr.nrecords = head >= tail ? head - tail :
+                 CONFIG_USBDEV_TRACE_NRECORDS - tail + head;
+  hdr.tickhz   = USBTRACE_TICKHZ;
+
+  /* The records are written as they are stored: at most two contiguous
+   * pieces of the ring.
+   */
+
+  ret = usbtrace_dumpbuf(fd, &hdr, sizeof(hdr));
+  if (ret == OK && head < tail)
+    {
+      ret = usbtrace_dumpbuf(fd, &g_trace[tail],
+                             (CONFIG_USBDEV_TRACE_NRECORDS - tail) *
+                             sizeof(struct usbtrace_s));
+      tail = 0;
+    }
+
+  if (ret == OK)
+    {
+      ret = usbtrace_dumpbuf(fd, &g_trace[tail],
+                             (head - tail) * sizeof(struct usbtrace_s));
+    }
+
+  /* Discard the trace data after it has been reported */
+
+  g_tail = head;
+
+  /* Restore tracing state */
+
+  (void)usbtrace_enable(idset);
+  return ret < 0 ? ret : (int)hdr.nrecords;
+}
+#endif /* CONFIG_USBDEV_TRACE */
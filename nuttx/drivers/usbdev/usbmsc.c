@@ -1090,6 +1090,7 @@ void usbmsc_wrcomplete(FAR struct usbdev_ep_s *ep, FAR struct usbdev_req_s *req)
 
   flags = irqsave();
   sq_addlast((sq_entry_t*)privreq, &priv->wrreqlist);
+  USBMSC_TXDONE(req->xfrd);
   irqrestore(flags);
 
   /* Process the received data unless this is some unusual condition */
@@ -1154,6 +1155,7 @@ void usbmsc_rdcomplete(FAR struct usbdev_ep_s *ep, FAR struct usbdev_req_s *req)
     case 0: /* Normal completion */
       {
         usbtrace(TRACE_CLASSRDCOMPLETE, req->xfrd);
+        USBMSC_RXDONE(req->xfrd);
 
         /* Add the filled read request from the rdreqlist */
 
@@ -71,6 +71,22 @@
 #  define CONFIG_USBMSC_STRBASE (4)
 #endif
 
+/* Report bulk transfers to the composite arbiter.  Users of these must
+ * include composite.h when CONFIG_USBMSC_COMPOSITE is defined.
+ */
+
+#ifdef CONFIG_USBMSC_COMPOSITE
+#  define USBMSC_TXSTART()      composite_txstart(COMPOSITE_USBMSC_FUNC)
+#  define USBMSC_TXDONE(n)      composite_txdone(COMPOSITE_USBMSC_FUNC, n)
+#  define USBMSC_RXDONE(n)      composite_rxdone(COMPOSITE_USBMSC_FUNC, n)
+#  define USBMSC_MAYXFER()      composite_mayxfer(COMPOSITE_USBMSC_FUNC)
+#else
+#  define USBMSC_TXSTART()
+#  define USBMSC_TXDONE(n)
+#  define USBMSC_RXDONE(n)
+#  define USBMSC_MAYXFER()      (true)
+#endif
+
 /* Interface IDs.  If the mass storage driver is built as a component of a
  * composite device, then the interface IDs may need to be offset.
  */
@@ -76,6 +76,11 @@
 
 #include "usbmsc.h"
 
+#ifdef CONFIG_USBMSC_COMPOSITE
+#  include <nuttx/usb/composite.h>
+#  include "composite.h"
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -2098,6 +2103,9 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
   ssize_t nread;
   uint8_t *src;
   uint8_t *dest;
+#ifdef CONFIG_USBMSC_PIPELINE
+  uint32_t nsect;
+#endif
   int nbytes;
   int ret;
 
@@ -2110,13 +2118,38 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
     {
       usbtrace(TRACE_CLASSSTATE(USBMSC_CLASSSTATE_CMDREAD), priv->u.xfrlen);
 
-      /* Is the I/O buffer empty? */
+      /* Before starting to fill a new request, give way to a higher
+       * priority member of the composite.  As with an empty wrreqlist, we
+       * remain in the CMDREAD state and are called again when one of our
+       * write requests is returned.
+       */
 
-      if (priv->nsectbytes <= 0)
+      if (priv->nreqbytes == 0 && !USBMSC_MAYXFER())
         {
-          /* Yes.. read the next sector */
+          return -ENOMEM;
+        }
+
+#ifdef CONFIG_USBMSC_PIPELINE
+      /* If a new request is to be filled with whole sectors, then read them
+       * from the block driver directly into the request buffer.  While the
+       * request is sent, the next one is read into the next free request.
+       */
 
-          nread = USBMSC_DRVR_READ(lun, priv->iobuffer, priv->sector, 1);
+      if (priv->nsectbytes <= 0 && priv->nreqbytes == 0 &&
+          priv->u.xfrlen > 0 && lun->sectorsize <= CONFIG_USBMSC_BULKINREQLEN)
+        {
+          privreq = (FAR struct usbmsc_req_s *)sq_peek(&priv->wrreqlist);
+          if (!privreq)
+            {
+              usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADWRRQEMPTY), 0);
+              return -ENOMEM;
+            }
+
+          req   = privreq->req;
+          nsect = MIN(CONFIG_USBMSC_BULKINREQLEN / lun->sectorsize,
+                      priv->u.xfrlen);
+
+          nread = USBMSC_DRVR_READ(lun, req->buf, priv->sector, nsect);
           if (nread < 0)
             {
               usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADREADFAIL), -nread);
@@ -2125,46 +2158,69 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
               break;
             }
 
-          priv->nsectbytes = lun->sectorsize;
-          priv->u.xfrlen--;
-          priv->sector++;
+          priv->nreqbytes = nsect * lun->sectorsize;
+          priv->u.xfrlen -= nsect;
+          priv->sector   += nsect;
         }
+      else
+#endif
+        {
+          /* Is the I/O buffer empty? */
 
-      /* Check if there is a request in the wrreqlist that we will be able to
-       * use for data transfer.
-       */
+          if (priv->nsectbytes <= 0)
+            {
+              /* Yes.. read the next sector */
 
-      privreq = (FAR struct usbmsc_req_s *)sq_peek(&priv->wrreqlist);
+              nread = USBMSC_DRVR_READ(lun, priv->iobuffer, priv->sector, 1);
+              if (nread < 0)
+                {
+                  usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADREADFAIL), -nread);
+                  lun->sd     = SCSI_KCQME_UNRRE1;
+                  lun->sdinfo = priv->sector;
+                  break;
+                }
 
-      /* If there no request structures available, then just return an error.
-       * This will cause us to remain in the CMDREAD state.  When a request is
-       * returned, the worker thread will be awakened in the USBMSC_STATE_CMDREAD
-       * and we will be called again.
-       */
+              priv->nsectbytes = lun->sectorsize;
+              priv->u.xfrlen--;
+              priv->sector++;
+            }
 
-      if (!privreq)
-        {
-          usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADWRRQEMPTY), 0);
-          priv->nreqbytes = 0;
-          return -ENOMEM;
-        }
+          /* Check if there is a request in the wrreqlist that we will be able to
+           * use for data transfer.
+           */
 
-      req = privreq->req;
+          privreq = (FAR struct usbmsc_req_s *)sq_peek(&priv->wrreqlist);
 
-      /* Transfer all of the data that will (1) fit into the request buffer, OR (2)
-       * all of the data available in the sector buffer.
-       */
+          /* If there no request structures available, then just return an error.
+           * This will cause us to remain in the CMDREAD state.  When a request is
+           * returned, the worker thread will be awakened in the USBMSC_STATE_CMDREAD
+           * and we will be called again.
+           */
+
+          if (!privreq)
+            {
+              usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADWRRQEMPTY), 0);
+              priv->nreqbytes = 0;
+              return -ENOMEM;
+            }
+
+          req = privreq->req;
 
-      src    = &priv->iobuffer[lun->sectorsize - priv->nsectbytes];
-      dest   = &req->buf[priv->nreqbytes];
+          /* Transfer all of the data that will (1) fit into the request buffer, OR (2)
+           * all of the data available in the sector buffer.
+           */
+
+          src    = &priv->iobuffer[lun->sectorsize - priv->nsectbytes];
+          dest   = &req->buf[priv->nreqbytes];
 
-      nbytes = MIN(CONFIG_USBMSC_BULKINREQLEN - priv->nreqbytes, priv->nsectbytes);
+          nbytes = MIN(CONFIG_USBMSC_BULKINREQLEN - priv->nreqbytes, priv->nsectbytes);
 
-      /* Copy the data from the sector buffer to the USB request and update counts */
+          /* Copy the data from the sector buffer to the USB request and update counts */
 
-      memcpy(dest, src, nbytes);
-      priv->nreqbytes  += nbytes;
-      priv->nsectbytes -= nbytes;
+          memcpy(dest, src, nbytes);
+          priv->nreqbytes  += nbytes;
+          priv->nsectbytes -= nbytes;
+        }
 
       /* If (1) the request buffer is full OR (2) this is the final request full of data,
        * then submit the request
@@ -2188,10 +2244,12 @@ static int usbmsc_cmdreadstate(FAR struct usbmsc_dev_s *priv)
           req->callback = usbmsc_wrcomplete;
           req->flags    = 0;
 
+          USBMSC_TXSTART();
           ret           = EP_SUBMIT(priv->epbulkin, req);
           if (ret != OK)
             {
               usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDREADSUBMIT), (uint16_t)-ret);
+              USBMSC_TXDONE(0);
               lun->sd     = SCSI_KCQME_UNRRE1;
               lun->sdinfo = priv->sector;
               break;
@@ -2245,6 +2303,9 @@ static int usbmsc_cmdwritestate(FAR struct usbmsc_dev_s *priv)
   uint16_t xfrd;
   uint8_t *src;
   uint8_t *dest;
+#ifdef CONFIG_USBMSC_PIPELINE
+  uint32_t nsect;
+#endif
   int nbytes;
   int ret;
 
@@ -2286,9 +2347,37 @@ static int usbmsc_cmdwritestate(FAR struct usbmsc_dev_s *priv)
 
       while (priv->nreqbytes > 0 && priv->u.xfrlen > 0)
         {
+          src  = &req->buf[xfrd - priv->nreqbytes];
+
+#ifdef CONFIG_USBMSC_PIPELINE
+          /* If the request holds whole sectors, then write them from the
+           * request buffer directly.  The other read requests keep
+           * receiving data from the host meanwhile.
+           */
+
+          if (priv->nsectbytes == 0 && priv->nreqbytes >= lun->sectorsize)
+            {
+              nsect = MIN(priv->nreqbytes / lun->sectorsize, priv->u.xfrlen);
+
+              nwritten = USBMSC_DRVR_WRITE(lun, src, priv->sector, nsect);
+              if (nwritten < 0)
+                {
+                  usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDWRITEWRITEFAIL), -nwritten);
+                  lun->sd     = SCSI_KCQME_WRITEFAULTAUTOREALLOCFAILED;
+                  lun->sdinfo = priv->sector;
+                  goto errout;
+                }
+
+              priv->nreqbytes -= nsect * lun->sectorsize;
+              priv->residue   -= nsect * lun->sectorsize;
+              priv->u.xfrlen  -= nsect;
+              priv->sector    += nsect;
+              continue;
+            }
+#endif
+
           /* Copy the data received in the read request into the sector I/O buffer */
 
-          src  = &req->buf[xfrd - priv->nreqbytes];
           dest = &priv->iobuffer[priv->nsectbytes];
 
           nbytes = MIN(lun->sectorsize - priv->nsectbytes, priv->nreqbytes);
@@ -2424,10 +2513,12 @@ static int usbmsc_cmdfinishstate(FAR struct usbmsc_dev_s *priv)
               req->priv     = privreq;
               req->flags    = USBDEV_REQFLAGS_NULLPKT;
 
+              USBMSC_TXSTART();
               ret           = EP_SUBMIT(priv->epbulkin, privreq->req);
               if (ret < 0)
                 {
                   usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_CMDFINISHSUBMIT), (uint16_t)-ret);
+                  USBMSC_TXDONE(0);
                 }
              }
 
@@ -2584,10 +2675,12 @@ static int usbmsc_cmdstatusstate(FAR struct usbmsc_dev_s *priv)
   req->priv      = privreq;
   req->flags     = USBDEV_REQFLAGS_NULLPKT;
 
+  USBMSC_TXSTART();
   ret            = EP_SUBMIT(priv->epbulkin, req);
   if (ret < 0)
     {
       usbtrace(TRACE_CLSERROR(USBMSC_TRACEERR_SNDSTATUSSUBMIT), (uint16_t)-ret);
+      USBMSC_TXDONE(0);
       flags = irqsave();
       (void)sq_addlast((sq_entry_t*)privreq, &priv->wrreqlist);
       irqrestore(flags);
@@ -106,7 +106,7 @@ CCASSERT(sizeof(cc3000_buffer_desc) <= CONFIG_MQ_MAXMSGSIZE);
 #ifndef ARRAY_SIZE
 #  define ARRAY_SIZE(x) (sizeof(x) / sizeof((x)[0]))
 #endif
-#define NUMBER_OF_MSGS 1
+#define NUMBER_OF_MSGS CONFIG_CC3000_RX_BUFFERS
 
 #define FREE_SLOT -1
 #define CLOSE_SLOT -2
@@ -659,17 +659,18 @@ static void * cc3000_worker(FAR void *arg)
             case eSPI_STATE_IDLE: /* IRQ when Idel => cc3000 has data for the hosts Unsolicited */
               {
                 uint16_t data_to_recv;
+                FAR uint8_t *pbuffer = priv->rx_pool[priv->rx_next];
                 priv->state = eSPI_STATE_READ_IRQ;
 
                 /* Issue the read command */
 
                 cc3000_lock_and_select(priv->spi); /* Assert CS */
                 priv->state = eSPI_STATE_READ_PROCEED;
-                SPI_EXCHANGE(priv->spi,spi_readCommand,priv->rx_buffer.pbuffer, ARRAY_SIZE(spi_readCommand));
+                SPI_EXCHANGE(priv->spi,spi_readCommand,pbuffer, ARRAY_SIZE(spi_readCommand));
 
                /* Extract Length bytes from Rx Buffer */
 
-               uint16_t *pnetlen = (uint16_t *) &priv->rx_buffer.pbuffer[READ_OFFSET_TO_LENGTH];
+               uint16_t *pnetlen = (uint16_t *) &pbuffer[READ_OFFSET_TO_LENGTH];
                data_to_recv = ntohs(*pnetlen);
 
                if (data_to_recv)
@@ -691,19 +692,24 @@ static void * cc3000_worker(FAR void *arg)
                         lowsyslog("data_to_recv %d",data_to_recv);
                     }
                     DEBUGASSERT(data_to_recv < priv->rx_buffer_max_len);
-                    SPI_RECVBLOCK(priv->spi, priv->rx_buffer.pbuffer, data_to_recv);
+                    SPI_RECVBLOCK(priv->spi, pbuffer, data_to_recv);
                   }
 
                 cc3000_deselect_and_unlock(priv->spi); /* De assert CS */
 
-                /* Disable more messages as the wl code will resume via CC3000IOC_COMPLETE */
+                /* Hand the buffer itself to the wl code and move on to the
+                 * next one in the ring.  Each buffer is returned by
+                 * cc3000_resume() once the wl code has consumed it.
+                 */
 
                 if (data_to_recv)
                   {
                     int count;
 
                     priv->state = eSPI_STATE_READ_READY;
+                    priv->rx_buffer.pbuffer = pbuffer;
                     priv->rx_buffer.len = data_to_recv;
+                    priv->rx_next = (priv->rx_next + 1) % CONFIG_CC3000_RX_BUFFERS;
 
                     ret = mq_send(priv->queue, &priv->rx_buffer, sizeof(priv->rx_buffer), 1);
                     DEBUGASSERT(ret >= 0);
@@ -717,6 +723,8 @@ static void * cc3000_worker(FAR void *arg)
 
                     cc3000_devgive(priv);
 
+                    /* Only blocks once every buffer is owned by the wl code */
+
                     nllvdbg("Wait On Completion\n");
                     sem_wait(priv->wrkwaitsem);
                     nllvdbg("Completed S:%d irq :%d\n",
@@ -796,6 +804,7 @@ static int cc3000_open(FAR struct file *filep)
   FAR struct cc3000_dev_s *priv;
   uint8_t tmp;
   int ret;
+  int i;
 
   DEBUGASSERT(filep);
   inode = filep->f_inode;
@@ -836,6 +845,17 @@ static int cc3000_open(FAR struct file *filep)
 
       priv->config->power_enable(priv->config, false);
 
+      /* All but the buffer being filled start out free */
+
+      while (sem_trywait(priv->wrkwaitsem) == 0)
+        {
+        }
+
+      for (i = 1; i < CONFIG_CC3000_RX_BUFFERS; i++)
+        {
+          sem_post(priv->wrkwaitsem);
+        }
+
       attr.mq_maxmsg  = NUMBER_OF_MSGS;
       attr.mq_msgsize = sizeof(cc3000_buffer_desc);
       attr.mq_flags   = 0;
@@ -894,15 +914,28 @@ static int cc3000_open(FAR struct file *filep)
 
       /* Do late allocation with hopes of realloc not fragmenting */
 
-      priv->rx_buffer.pbuffer =  kmm_malloc(priv->rx_buffer_max_len);
-      DEBUGASSERT(priv->rx_buffer.pbuffer);
-      if (!priv->rx_buffer.pbuffer)
+      for (i = 0; i < CONFIG_CC3000_RX_BUFFERS; i++)
         {
-          priv->crefs--;
-          ret = -errno;
-          goto errout_with_sem;
+          priv->rx_pool[i] = kmm_malloc(priv->rx_buffer_max_len);
+          DEBUGASSERT(priv->rx_pool[i]);
+          if (!priv->rx_pool[i])
+            {
+              while (i-- > 0)
+                {
+                  kmm_free(priv->rx_pool[i]);
+                  priv->rx_pool[i] = 0;
+                }
+
+              priv->crefs--;
+              ret = -ENOMEM;
+              goto errout_with_sem;
+            }
         }
 
+      priv->rx_next = 0;
+      priv->rx_buffer.pbuffer = priv->rx_pool[0];
+      priv->rx_buffer.len = 0;
+
       priv->state = eSPI_STATE_POWERUP;
       priv->config->irq_clear(priv->config);
 
@@ -934,6 +967,7 @@ static int cc3000_close(FAR struct file *filep)
   FAR struct inode         *inode;
   FAR struct cc3000_dev_s *priv;
   int                       ret;
+  int                       i;
 
   DEBUGASSERT(filep);
   inode = filep->f_inode;
@@ -983,7 +1017,12 @@ static int cc3000_close(FAR struct file *filep)
       mq_close(priv->queue);
       priv->queue = 0;
 
-      kmm_free(priv->rx_buffer.pbuffer);
+      for (i = 0; i < CONFIG_CC3000_RX_BUFFERS; i++)
+        {
+          kmm_free(priv->rx_pool[i]);
+          priv->rx_pool[i] = 0;
+        }
+
       priv->rx_buffer.pbuffer = 0;
 
     }
@@ -1338,12 +1377,24 @@ static int cc3000_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
           irqstate_t flags;
           FAR int *psize = (FAR int *)(arg);
           int rv;
+          int i;
 
           DEBUGASSERT(psize != NULL);
           rv = priv->rx_buffer_max_len;
           flags = irqsave();
           priv->rx_buffer_max_len = *psize;
-          priv->rx_buffer.pbuffer = kmm_realloc(priv->rx_buffer.pbuffer,*psize);
+          for (i = 0; i < CONFIG_CC3000_RX_BUFFERS; i++)
+            {
+              bool last = priv->rx_buffer.pbuffer == priv->rx_pool[i];
+
+              priv->rx_pool[i] = kmm_realloc(priv->rx_pool[i],*psize);
+              DEBUGASSERT(priv->rx_pool[i]);
+              if (last)
+                {
+                  priv->rx_buffer.pbuffer = priv->rx_pool[i];
+                }
+            }
+
           irqrestore(flags);
           DEBUGASSERT(priv->rx_buffer.pbuffer);
           *psize = rv;
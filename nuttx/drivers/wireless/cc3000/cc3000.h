@@ -69,6 +69,10 @@
 #  define CONFIG_WL_MAX_SOCKETS 5
 #endif
 
+#ifndef CONFIG_CC3000_RX_BUFFERS
+#  define CONFIG_CC3000_RX_BUFFERS 2
+#endif
+
 /* CC3000 Interfaces ********************************************************/
 
 /* Driver support ***********************************************************/
@@ -135,7 +139,7 @@ struct cc3000_dev_s
   uint8_t nwaiters;                     /* Number of threads waiting for CC3000 data */
   uint8_t minor;                        /* minor */
   sem_t devsem;                         /* Manages exclusive access to this structure */
-  sem_t *wrkwaitsem;                    /* Suspend and resume the delivery of messages */
+  sem_t *wrkwaitsem;                    /* Counts receive buffers released by the wl code */
   sem_t waitsem;                        /* Used to wait for the availability of data */
   sem_t irqsem;                         /* Used to signal irq from cc3000 */
   sem_t readysem;                       /* Used to wait for Ready Condition from the cc3000 */
@@ -144,8 +148,10 @@ struct cc3000_dev_s
   FAR struct spi_dev_s *spi;            /* Saved SPI driver instance */
   mqd_t queue;                          /* For unsolicited data delivery */
   eDeviceStates state;                  /* The device state */
-  cc3000_buffer_desc rx_buffer;
+  cc3000_buffer_desc rx_buffer;         /* Last buffer delivered */
   ssize_t rx_buffer_max_len;
+  FAR uint8_t *rx_pool[CONFIG_CC3000_RX_BUFFERS]; /* Receive buffer ring */
+  uint8_t rx_next;                      /* Next buffer in rx_pool to fill */
 
   /* The following is a list if socket structures of threads waiting
    * long operations to finish;
@@ -832,6 +832,21 @@ long hci_event_unsol_flowcontrol_handler(char *pEvent)
   tSLInformation.usNumberOfFreeBuffers += temp;
   tSLInformation.NumberOfReleasedPackets += temp;
 
+  /* Wake a sender blocked in HostFlowControlConsumeBuff().  The count is
+   * only a wake up, the sender re-checks usNumberOfFreeBuffers.
+   */
+
+  if (temp > 0)
+    {
+      int count;
+
+      sem_getvalue(&g_cc3000_freebufsem, &count);
+      if (count <= 0)
+        {
+          sem_post(&g_cc3000_freebufsem);
+        }
+    }
+
   return(ESUCCESS);
 }
 
@@ -42,6 +42,8 @@
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#include <time.h>
+#include <semaphore.h>
 #include <debug.h>
 #include <stdlib.h>
 #include <nuttx/wireless/cc3000/hci.h>
@@ -124,7 +126,12 @@
 int HostFlowControlConsumeBuff(int sd)
 {
 #ifndef SEND_NON_BLOCKING
-  /* Wait in busy loop */
+  struct timespec abstime;
+
+  /* Wait until the CC3000 returns a buffer.  The flow control event posts
+   * g_cc3000_freebufsem, the timeout only bounds how long it takes to notice a
+   * transmit error or an inactive socket.
+   */
 
   do
     {
@@ -151,7 +158,15 @@ int HostFlowControlConsumeBuff(int sd)
 
       if (0 == tSLInformation.usNumberOfFreeBuffers)
         {
-          usleep(100000);
+          clock_gettime(CLOCK_REALTIME, &abstime);
+          abstime.tv_nsec += 100 * 1000 * 1000;
+          if (abstime.tv_nsec >= 1000 * 1000 * 1000)
+            {
+              abstime.tv_sec++;
+              abstime.tv_nsec -= 1000 * 1000 * 1000;
+            }
+
+          (void)sem_timedwait(&g_cc3000_freebufsem, &abstime);
         }
     }
   while (0 == tSLInformation.usNumberOfFreeBuffers);
@@ -107,6 +107,7 @@
  *****************************************************************************/
 
 volatile sSimplLinkInformation tSLInformation;
+sem_t g_cc3000_freebufsem;
 #ifndef CC3000_UNENCRYPTED_SMART_CONFIG
 uint8_t akey[AES128_KEY_SIZE];
 uint8_t profileArray[SMART_CONFIG_PROFILE_SIZE];
@@ -285,6 +286,7 @@ void wlan_start(uint16_t usPatchesAvailableAtHost)
   tSLInformation.NumberOfReleasedPackets = 0;
   tSLInformation.usRxEventOpcode = 0;
   tSLInformation.usNumberOfFreeBuffers = 0;
+  sem_init(&g_cc3000_freebufsem, 0, 0);
   tSLInformation.usSlBufferLength = 0;
   tSLInformation.usBufferSize = 0;
   tSLInformation.usRxDataPending = 0;
@@ -0,0 +1,448 @@
+/****************************************************************************
+ * fs/fs_epoll.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/epoll.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <poll.h>
+#include <time.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/clock.h>
+#include <nuttx/kmalloc.h>
+
+#include "fs_internal.h"
+
+#if CONFIG_NFILE_DESCRIPTORS > 0 && !defined(CONFIG_DISABLE_POLL)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* An epoll instance.  Each descriptor in the interest set keeps its poll
+ * set up between calls to epoll_wait(), so that a wait only has to visit
+ * the drivers of the descriptors that reported events.
+ */
+
+struct epoll_head_s
+{
+  int                  size;  /* Number of entries in fds[] and data[] */
+  int                  next;  /* Entry where the next scan for events starts */
+  sem_t                sem;   /* Posted by the drivers of all entries */
+  FAR struct pollfd   *fds;   /* The interest set.  fd < 0: free entry */
+  FAR epoll_data_t    *data;  /* User data returned with the events */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: epoll_find
+ *
+ * Description:
+ *   Return the index of 'fd' in the interest set, or -1 if not present.
+ *
+ ****************************************************************************/
+
+static int epoll_find(FAR struct epoll_head_s *eph, int fd)
+{
+  int i;
+
+  for (i = 0; i < eph->size; i++)
+    {
+      if (eph->fds[i].fd == fd)
+        {
+          return i;
+        }
+    }
+
+  return -1;
+}
+
+/****************************************************************************
+ * Name: epoll_arm
+ *
+ * Description:
+ *   Set up the poll of one entry.  Drivers check the current state of the
+ *   descriptor when the poll is set up, so this also re-evaluates a level
+ *   that has already been reported.
+ *
+ ****************************************************************************/
+
+static int epoll_arm(FAR struct epoll_head_s *eph, FAR struct pollfd *fds)
+{
+  fds->sem     = &eph->sem;
+  fds->revents = 0;
+  fds->priv    = NULL;
+
+  return poll_fdsetup(fds->fd, fds, true);
+}
+
+/****************************************************************************
+ * Name: epoll_collect
+ *
+ * Description:
+ *   Return up to 'maxevents' entries with pending events, re-arming each
+ *   entry that is returned.  The scan resumes after the last entry
+ *   returned so that busy descriptors cannot starve the others.
+ *
+ ****************************************************************************/
+
+static int epoll_collect(FAR struct epoll_head_s *eph,
+                         FAR struct epoll_event *evs, int maxevents)
+{
+  FAR struct pollfd *fds;
+  int count = 0;
+  int ndx = eph->next;
+  int i;
+
+  for (i = 0; i < eph->size && count < maxevents; i++)
+    {
+      fds = &eph->fds[ndx];
+      if (fds->fd >= 0 && fds->revents != 0)
+        {
+          evs[count].events = fds->revents;
+          evs[count].data   = eph->data[ndx];
+          count++;
+
+          (void)poll_fdsetup(fds->fd, fds, false);
+          (void)epoll_arm(eph, fds);
+        }
+
+      if (++ndx >= eph->size)
+        {
+          ndx = 0;
+        }
+    }
+
+  if (count > 0)
+    {
+      eph->next = ndx;
+    }
+
+  return count;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: epoll_create
+ *
+ * Description:
+ *   Create an epoll instance able to watch up to 'size' descriptors.
+ *
+ * Return:
+ *   A handle to be passed to the other epoll functions on success. -1 is
+ *   returned on failure with errno set: EINVAL if size is not positive,
+ *   ENOMEM if the instance could not be allocated.
+ *
+ ****************************************************************************/
+
+int epoll_create(int size)
+{
+  FAR struct epoll_head_s *eph;
+  int i;
+
+  if (size <= 0)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  eph = (FAR struct epoll_head_s *)
+    kumm_zalloc(sizeof(struct epoll_head_s) +
+                size * (sizeof(struct pollfd) + sizeof(epoll_data_t)));
+  if (!eph)
+    {
+      set_errno(ENOMEM);
+      return ERROR;
+    }
+
+  eph->size = size;
+  eph->fds  = (FAR struct pollfd *)&eph[1];
+  eph->data = (FAR epoll_data_t *)&eph->fds[size];
+
+  for (i = 0; i < size; i++)
+    {
+      eph->fds[i].fd = -1;
+    }
+
+  sem_init(&eph->sem, 0, 0);
+  return (int)eph;
+}
+
+/****************************************************************************
+ * Name: epoll_close
+ *
+ * Description:
+ *   Tear down the polls of all descriptors still in the interest set and
+ *   free the epoll instance.
+ *
+ ****************************************************************************/
+
+void epoll_close(int epfd)
+{
+  FAR struct epoll_head_s *eph = (FAR struct epoll_head_s *)epfd;
+  int i;
+
+  if (eph)
+    {
+      for (i = 0; i < eph->size; i++)
+        {
+          if (eph->fds[i].fd >= 0)
+            {
+              (void)poll_fdsetup(eph->fds[i].fd, &eph->fds[i], false);
+            }
+        }
+
+      sem_destroy(&eph->sem);
+      kumm_free(eph);
+    }
+}
+
+/****************************************************************************
+ * Name: epoll_ctl
+ *
+ * Description:
+ *   Add, modify or remove a descriptor of the interest set.  The poll of
+ *   the descriptor is set up or torn down here rather than in each
+ *   epoll_wait().
+ *
+ * Return:
+ *   Zero on success.  -1 is returned on failure with errno set:
+ *
+ *   EBADF  - epfd is not a valid handle
+ *   EEXIST - EPOLL_CTL_ADD of a descriptor already in the set
+ *   ENOENT - EPOLL_CTL_MOD or EPOLL_CTL_DEL of a descriptor not in the set
+ *   ENOSPC - The interest set is full
+ *   EINVAL - Unknown operation, or the poll setup errors of the driver
+ *
+ ****************************************************************************/
+
+int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev)
+{
+  FAR struct epoll_head_s *eph = (FAR struct epoll_head_s *)epfd;
+  FAR struct pollfd *fds;
+  int ndx;
+  int ret;
+
+  if (!eph)
+    {
+      set_errno(EBADF);
+      return ERROR;
+    }
+
+  if (fd < 0 || (op != EPOLL_CTL_DEL && !ev))
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  ndx = epoll_find(eph, fd);
+  switch (op)
+    {
+      case EPOLL_CTL_ADD:
+        if (ndx >= 0)
+          {
+            ret = -EEXIST;
+            break;
+          }
+
+        ndx = epoll_find(eph, -1);
+        if (ndx < 0)
+          {
+            ret = -ENOSPC;
+            break;
+          }
+
+        fds         = &eph->fds[ndx];
+        fds->fd     = fd;
+        fds->events = (pollevent_t)ev->events;
+        eph->data[ndx] = ev->data;
+
+        ret = epoll_arm(eph, fds);
+        if (ret < 0)
+          {
+            fds->fd  = -1;
+            fds->sem = NULL;
+          }
+        break;
+
+      case EPOLL_CTL_MOD:
+        if (ndx < 0)
+          {
+            ret = -ENOENT;
+            break;
+          }
+
+        fds = &eph->fds[ndx];
+        (void)poll_fdsetup(fd, fds, false);
+
+        fds->events = (pollevent_t)ev->events;
+        eph->data[ndx] = ev->data;
+
+        ret = epoll_arm(eph, fds);
+        if (ret < 0)
+          {
+            fds->fd  = -1;
+            fds->sem = NULL;
+          }
+        break;
+
+      case EPOLL_CTL_DEL:
+        if (ndx < 0)
+          {
+            ret = -ENOENT;
+            break;
+          }
+
+        fds = &eph->fds[ndx];
+        ret = poll_fdsetup(fd, fds, false);
+
+        fds->fd  = -1;
+        fds->sem = NULL;
+        break;
+
+      default:
+        ret = -EINVAL;
+        break;
+    }
+
+  if (ret < 0)
+    {
+      set_errno(-ret);
+      return ERROR;
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: epoll_wait
+ *
+ * Description:
+ *   Wait for events on the descriptors of the interest set.  Events are
+ *   level-triggered: a descriptor that is still ready is returned again by
+ *   the next call.
+ *
+ * Inputs:
+ *   epfd      - The handle returned by epoll_create()
+ *   evs       - Where to return the events
+ *   maxevents - The maximum number of events to return
+ *   timeout   - Upper limit of the wait in milliseconds.  A negative value
+ *     waits forever, zero does not wait.
+ *
+ * Return:
+ *   The number of events returned, zero on timeout.  -1 is returned on
+ *   failure with errno set: EBADF if epfd is not valid, EINVAL if
+ *   maxevents is not positive, EINTR if a signal was received.
+ *
+ ****************************************************************************/
+
+int epoll_wait(int epfd, FAR struct epoll_event *evs, int maxevents,
+               int timeout)
+{
+  FAR struct epoll_head_s *eph = (FAR struct epoll_head_s *)epfd;
+  struct timespec abstime;
+  int count;
+  int ret;
+
+  if (!eph)
+    {
+      set_errno(EBADF);
+      return ERROR;
+    }
+
+  if (!evs || maxevents <= 0)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  if (timeout > 0)
+    {
+      time_t sec = timeout / MSEC_PER_SEC;
+
+      (void)clock_gettime(CLOCK_REALTIME, &abstime);
+      abstime.tv_sec  += sec;
+      abstime.tv_nsec += (timeout - MSEC_PER_SEC * sec) * NSEC_PER_MSEC;
+      if (abstime.tv_nsec >= NSEC_PER_SEC)
+        {
+          abstime.tv_sec++;
+          abstime.tv_nsec -= NSEC_PER_SEC;
+        }
+    }
+
+  for (; ; )
+    {
+      /* Drivers post the semaphore once per event, so it may still count
+       * events that an earlier scan already returned.  Scan until events
+       * are found or the wait times out.
+       */
+
+      count = epoll_collect(eph, evs, maxevents);
+      if (count > 0 || timeout == 0)
+        {
+          return count;
+        }
+
+      if (timeout < 0)
+        {
+          ret = sem_wait(&eph->sem);
+        }
+      else
+        {
+          ret = sem_timedwait(&eph->sem, &abstime);
+        }
+
+      if (ret < 0)
+        {
+          /* ETIMEDOUT is not an error, errno is already set otherwise */
+
+          return get_errno() == ETIMEDOUT ? 0 : ERROR;
+        }
+    }
+}
+
+#endif /* CONFIG_NFILE_DESCRIPTORS > 0 && !CONFIG_DISABLE_POLL */
@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <semaphore.h>
 #include <fcntl.h>
@@ -239,9 +240,16 @@ FAR struct file_struct *fs_fdopen(int fd, int oflags, FAR struct tcb_s *tcb)
               goto errout_with_sem;
             }
 
-          /* Set up pointers */
+          /* Set up pointers.  In the flat build, also use any slack that
+           * the allocator left at the end of the buffer.
+           */
 
+#ifdef CONFIG_BUILD_FLAT
+          stream->fs_bufend  = stream->fs_bufstart +
+                               malloc_usable_size(stream->fs_bufstart);
+#else
           stream->fs_bufend  = &stream->fs_bufstart[CONFIG_STDIO_BUFFER_SIZE];
+#endif
           stream->fs_bufpos  = stream->fs_bufstart;
           stream->fs_bufpos  = stream->fs_bufstart;
           stream->fs_bufread = stream->fs_bufstart;
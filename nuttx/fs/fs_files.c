@@ -48,6 +48,7 @@
 
 #include <nuttx/fs/fs.h>
 #include <nuttx/kmalloc.h>
+#include <arch/irq.h>
 
 #include "fs_internal.h"
 
@@ -95,6 +96,106 @@ static void _files_semtake(FAR struct filelist *list)
 
 #define _files_semgive(list) sem_post(&list->fl_sem)
 
+/****************************************************************************
+ * Name: _files_mapset, _files_mapclr
+ *
+ * Description:
+ *   Mark a descriptor as allocated or free in the list bitmap.
+ *
+ * Assumuptions:
+ *   Caller holds the list semaphore.
+ *
+ ****************************************************************************/
+
+#define _files_mapset(list,fd) \
+  ((list)->fl_map[(fd) >> 5] |= (uint32_t)1 << ((fd) & 31))
+#define _files_mapclr(list,fd) \
+  ((list)->fl_map[(fd) >> 5] &= ~((uint32_t)1 << ((fd) & 31)))
+
+/****************************************************************************
+ * Name: _files_mapsync
+ *
+ * Description:
+ *   Update the bitmap after a file structure was set up or closed by
+ *   files_dup().  Nothing is done if the file structure is not in the list,
+ *   as when the files of a new task are cloned: files_allocate() finds
+ *   those descriptors when it checks the free bits it gets.
+ *
+ * Assumuptions:
+ *   Caller holds the list semaphore.
+ *
+ ****************************************************************************/
+
+static void _files_mapsync(FAR struct filelist *list, FAR struct file *filep)
+{
+  int fd;
+
+  if (filep >= list->fl_files &&
+      filep < &list->fl_files[CONFIG_NFILE_DESCRIPTORS])
+    {
+      fd = filep - list->fl_files;
+      if (filep->f_inode)
+        {
+          _files_mapset(list, fd);
+        }
+      else
+        {
+          _files_mapclr(list, fd);
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: _files_mapfind
+ *
+ * Description:
+ *   Find the first free descriptor greater than or equal to minfd.  Returns
+ *   the descriptor or ERROR if there is none.
+ *
+ * Assumuptions:
+ *   Caller holds the list semaphore.
+ *
+ ****************************************************************************/
+
+static int _files_mapfind(FAR struct filelist *list, int minfd)
+{
+  uint32_t avail;
+  int word;
+  int fd;
+
+  for (word = minfd >> 5; word < FILELIST_MAPWORDS; word++)
+    {
+      avail = ~list->fl_map[word];
+      if (word == (minfd >> 5))
+        {
+          avail &= ~(((uint32_t)1 << (minfd & 31)) - 1);
+        }
+
+      while (avail != 0)
+        {
+          fd = (word << 5) + __builtin_ctz(avail);
+          if (fd >= CONFIG_NFILE_DESCRIPTORS)
+            {
+              return ERROR;
+            }
+
+          /* Descriptors cloned from the parent task are not in the map
+           * yet.
+           */
+
+          if (!list->fl_files[fd].f_inode)
+            {
+              return fd;
+            }
+
+          _files_mapset(list, fd);
+          avail &= avail - 1;
+        }
+    }
+
+  return ERROR;
+}
+
 /****************************************************************************
  * Name: _files_close
  *
@@ -133,6 +234,9 @@ static int _files_close(FAR struct file *filep)
       filep->f_oflags  = 0;
       filep->f_pos     = 0;
       filep->f_inode = NULL;
+#ifdef CONFIG_FS_FILE_REFS
+      filep->f_closing = false;
+#endif
     }
 
   return ret;
@@ -168,6 +272,10 @@ void files_initlist(FAR struct filelist *list)
   /* Initialize the list access mutex */
 
   (void)sem_init(&list->fl_sem, 0, 1);
+
+  /* No descriptor is allocated yet */
+
+  memset(list->fl_map, 0, sizeof(list->fl_map));
 }
 
 /****************************************************************************
@@ -226,6 +334,16 @@ int files_dup(FAR struct file *filep1, FAR struct file *filep2)
 
   _files_semtake(list);
 
+#ifdef CONFIG_FS_FILE_REFS
+  /* The new file structure can't be replaced while it is in use */
+
+  if (filep2->f_refs > 0)
+    {
+      ret = -EBUSY;
+      goto errout_with_ret;
+    }
+#endif
+
   /* If there is already an inode contained in the new file structure,
    * close the file and release the inode.
    */
@@ -278,6 +396,7 @@ int files_dup(FAR struct file *filep1, FAR struct file *filep2)
         }
     }
 
+  _files_mapsync(list, filep2);
   _files_semgive(list);
   return OK;
 
@@ -291,6 +410,7 @@ errout_with_inode:
 
 errout_with_ret:
   err              = -ret;
+  _files_mapsync(list, filep2);
   _files_semgive(list);
 
 errout:
@@ -315,22 +435,24 @@ int files_allocate(FAR struct inode *inode, int oflags, off_t pos, int minfd)
   list = sched_getfiles();
   DEBUGASSERT(list);
 
+  if (minfd < 0 || minfd >= CONFIG_NFILE_DESCRIPTORS)
+    {
+      return ERROR;
+    }
+
   _files_semtake(list);
-  for (i = minfd; i < CONFIG_NFILE_DESCRIPTORS; i++)
+  i = _files_mapfind(list, minfd);
+  if (i >= 0)
     {
-      if (!list->fl_files[i].f_inode)
-        {
-           list->fl_files[i].f_oflags = oflags;
-           list->fl_files[i].f_pos    = pos;
-           list->fl_files[i].f_inode  = inode;
-           list->fl_files[i].f_priv   = NULL;
-           _files_semgive(list);
-           return i;
-        }
+      list->fl_files[i].f_oflags = oflags;
+      list->fl_files[i].f_pos    = pos;
+      list->fl_files[i].f_inode  = inode;
+      list->fl_files[i].f_priv   = NULL;
+      _files_mapset(list, i);
     }
 
   _files_semgive(list);
-  return ERROR;
+  return i;
 }
 
 /****************************************************************************
@@ -347,6 +469,11 @@ int files_allocate(FAR struct inode *inode, int oflags, off_t pos, int minfd)
 int files_close(int fd)
 {
   FAR struct filelist *list;
+  FAR struct file     *filep;
+#ifdef CONFIG_FS_FILE_REFS
+  irqstate_t           flags;
+  bool                 busy;
+#endif
   int                  ret;
 
   /* Get the thread-specific file list */
@@ -363,8 +490,33 @@ int files_close(int fd)
 
   /* Perform the protected close operation */
 
+  filep = &list->fl_files[fd];
   _files_semtake(list);
-  ret = _files_close(&list->fl_files[fd]);
+
+#ifdef CONFIG_FS_FILE_REFS
+  /* Stop new users, then leave the close to the last current one, if any */
+
+  flags = irqsave();
+  if (filep->f_closing)
+    {
+      irqrestore(flags);
+      _files_semgive(list);
+      return -EBADF;
+    }
+
+  filep->f_closing = true;
+  busy = filep->f_refs > 0;
+  irqrestore(flags);
+
+  if (busy)
+    {
+      _files_semgive(list);
+      return OK;
+    }
+#endif
+
+  ret = _files_close(filep);
+  _files_mapclr(list, fd);
   _files_semgive(list);
   return ret;
 }
@@ -391,6 +543,94 @@ void files_release(int fd)
       list->fl_files[fd].f_oflags  = 0;
       list->fl_files[fd].f_pos     = 0;
       list->fl_files[fd].f_inode = NULL;
+      _files_mapclr(list, fd);
+      _files_semgive(list);
+    }
+}
+
+/****************************************************************************
+ * Name: fs_getfilep
+ *
+ * Description:
+ *   Get the file structure of a file descriptor of the current task.  The
+ *   file list is not locked: a file structure does not move and, with
+ *   CONFIG_FS_FILE_REFS, the reference taken here keeps close() from
+ *   releasing it until fs_putfilep().
+ *
+ ****************************************************************************/
+
+FAR struct file *fs_getfilep(int fd)
+{
+  FAR struct filelist *list;
+  FAR struct file     *filep;
+#ifdef CONFIG_FS_FILE_REFS
+  irqstate_t           flags;
+#endif
+
+  if ((unsigned int)fd >= CONFIG_NFILE_DESCRIPTORS)
+    {
+      return NULL;
+    }
+
+  /* The file list can be NULL when memory management debug output is
+   * written by malloc() before the group data has been allocated.
+   */
+
+  list = sched_getfiles();
+  if (!list)
+    {
+      return NULL;
+    }
+
+  filep = &list->fl_files[fd];
+
+#ifdef CONFIG_FS_FILE_REFS
+  flags = irqsave();
+  if (!filep->f_inode || filep->f_closing || filep->f_refs == UINT8_MAX)
+    {
+      filep = NULL;
+    }
+  else
+    {
+      filep->f_refs++;
+    }
+
+  irqrestore(flags);
+#endif
+
+  return filep;
+}
+
+/****************************************************************************
+ * Name: fs_putfilep
+ *
+ * Description:
+ *   Release a file obtained with fs_getfilep().  The last user of a file
+ *   closed in the meantime completes the close.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_FILE_REFS
+void fs_putfilep(FAR struct file *filep)
+{
+  FAR struct filelist *list;
+  irqstate_t           flags;
+  bool                 closing;
+
+  flags = irqsave();
+  DEBUGASSERT(filep->f_refs > 0);
+  closing = (--filep->f_refs == 0 && filep->f_closing);
+  irqrestore(flags);
+
+  if (closing)
+    {
+      list = sched_getfiles();
+      DEBUGASSERT(list);
+
+      _files_semtake(list);
+      (void)_files_close(filep);
+      _files_mapclr(list, filep - list->fl_files);
       _files_semgive(list);
     }
 }
+#endif
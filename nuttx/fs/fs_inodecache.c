@@ -0,0 +1,214 @@
+/****************************************************************************
+ * fs/fs_inodecache.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name NuttX nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include <nuttx/fs/fs.h>
+
+#include "fs_internal.h"
+
+#ifdef CONFIG_FS_INODECACHE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_FS_INODECACHE_SIZE
+#  define CONFIG_FS_INODECACHE_SIZE 16
+#endif
+
+#ifndef CONFIG_FS_INODECACHE_PATHLEN
+#  define CONFIG_FS_INODECACHE_PATHLEN 32
+#endif
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One cached path lookup.  An entry is valid only if its generation is the
+ * current generation of the inode tree.
+ */
+
+struct inode_cache_s
+{
+  uint32_t          gen;                 /* Tree generation of the entry */
+  FAR struct inode *node;                /* The inode found for 'path' */
+  uint16_t          reloff;              /* Offset to the relative path */
+  char              path[CONFIG_FS_INODECACHE_PATHLEN];
+};
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+static struct inode_cache_s g_inode_cache[CONFIG_FS_INODECACHE_SIZE];
+
+/* The inode tree generation.  Zero is never used so that the zeroed cache
+ * entries are invalid.
+ */
+
+static uint32_t g_inode_gen = 1;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_cacheslot
+ *
+ * Description:
+ *   Return the cache entry for a path and its length, or NULL if the path
+ *   is too long to be cached.
+ *
+ ****************************************************************************/
+
+static FAR struct inode_cache_s *inode_cacheslot(FAR const char *path,
+                                                 FAR size_t *len)
+{
+  uint32_t hash = 2166136261u;
+  FAR const char *ptr;
+
+  /* FNV-1a hash of the path */
+
+  for (ptr = path; *ptr; ptr++)
+    {
+      hash = (hash ^ (uint8_t)*ptr) * 16777619u;
+    }
+
+  *len = ptr - path;
+  if (*len >= CONFIG_FS_INODECACHE_PATHLEN)
+    {
+      return NULL;
+    }
+
+  return &g_inode_cache[hash % CONFIG_FS_INODECACHE_SIZE];
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: inode_cachelookup
+ *
+ * Description:
+ *   Look up a full path in the inode cache.
+ *
+ * Assumptions:
+ *   The caller holds the inode semaphore
+ *
+ ****************************************************************************/
+
+FAR struct inode *inode_cachelookup(FAR const char *path,
+                                    FAR const char **relpath)
+{
+  FAR struct inode_cache_s *entry;
+  size_t len;
+
+  entry = inode_cacheslot(path, &len);
+  if (entry && entry->gen == g_inode_gen &&
+      memcmp(entry->path, path, len + 1) == 0)
+    {
+      if (relpath)
+        {
+          *relpath = path + entry->reloff;
+        }
+
+      return entry->node;
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: inode_cacheinsert
+ *
+ * Description:
+ *   Remember the result of a successful inode_search() for a full path.
+ *   'relpath' is the relative path returned by inode_search().
+ *
+ * Assumptions:
+ *   The caller holds the inode semaphore
+ *
+ ****************************************************************************/
+
+void inode_cacheinsert(FAR const char *path, FAR struct inode *node,
+                       FAR const char *relpath)
+{
+  FAR struct inode_cache_s *entry;
+  size_t len;
+
+  entry = inode_cacheslot(path, &len);
+  if (entry)
+    {
+      memcpy(entry->path, path, len + 1);
+      entry->node   = node;
+      entry->reloff = relpath ? (size_t)(relpath - path) : len;
+      entry->gen    = g_inode_gen;
+    }
+}
+
+/****************************************************************************
+ * Name: inode_cacheflush
+ *
+ * Description:
+ *   Invalidate all cached lookups.  This must be called whenever a node is
+ *   linked into or unlinked from the inode tree.
+ *
+ * Assumptions:
+ *   The caller holds the inode semaphore
+ *
+ ****************************************************************************/
+
+void inode_cacheflush(void)
+{
+  /* Advancing the generation invalidates all entries.  Should it ever wrap
+   * around, then old entries could become valid again and must be cleared.
+   */
+
+  if (++g_inode_gen == 0)
+    {
+      memset(g_inode_cache, 0, sizeof(g_inode_cache));
+      g_inode_gen = 1;
+    }
+}
+
+#endif /* CONFIG_FS_INODECACHE */
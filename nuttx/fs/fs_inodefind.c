@@ -76,6 +76,10 @@
 FAR struct inode *inode_find(FAR const char *path, FAR const char **relpath)
 {
   FAR struct inode *node;
+#ifdef CONFIG_FS_INODECACHE
+  FAR const char *fullpath = path;
+  FAR const char *name = NULL;
+#endif
 
   if (!*path || path[0] != '/')
     {
@@ -83,11 +87,30 @@ FAR struct inode *inode_find(FAR const char *path, FAR const char **relpath)
     }
 
   /* Find the node matching the path.  If found, increment the count of
-   * references on the node.
+   * references on the node.  Recently found paths are remembered in the
+   * inode cache so that the tree does not have to be searched again.
    */
 
   inode_semtake();
+  node = inode_cachelookup(path, relpath);
+#ifdef CONFIG_FS_INODECACHE
+  if (!node)
+    {
+      node = inode_search(&path, (FAR struct inode**)NULL,
+                          (FAR struct inode**)NULL, &name);
+      if (node)
+        {
+          inode_cacheinsert(fullpath, node, name);
+          if (relpath)
+            {
+              *relpath = name;
+            }
+        }
+    }
+#else
   node = inode_search(&path, (FAR struct inode**)NULL, (FAR struct inode**)NULL, relpath);
+#endif
+
   if (node)
     {
       node->i_crefs++;
@@ -124,6 +124,10 @@ FAR struct inode *inode_unlink(FAR const char *path)
         }
 
       node->i_peer = NULL;
+
+      /* Cached path lookups may refer to the unlinked node */
+
+      inode_cacheflush();
     }
 
   return node;
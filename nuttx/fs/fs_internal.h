@@ -44,6 +44,7 @@
 
 #include <sys/types.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <dirent.h>
 
 #include <nuttx/fs/fs.h>
@@ -238,6 +239,32 @@ int inode_remove(FAR const char *path);
 
 FAR struct inode *inode_find(FAR const char *path, const char **relpath);
 
+/* fs_inodecache.c **********************************************************/
+/****************************************************************************
+ * Name: inode_cachelookup, inode_cacheinsert, inode_cacheflush
+ *
+ * Description:
+ *   Small hashed cache of full path to inode lookups used by inode_find().
+ *   inode_cacheflush() invalidates all entries and is called whenever the
+ *   inode tree is modified.
+ *
+ * Assumptions/Limitations:
+ *   The caller must hold the inode semaphore
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_INODECACHE
+FAR struct inode *inode_cachelookup(FAR const char *path,
+                                    FAR const char **relpath);
+void inode_cacheinsert(FAR const char *path, FAR struct inode *node,
+                       FAR const char *relpath);
+void inode_cacheflush(void);
+#else
+#  define inode_cachelookup(p,r) ((FAR struct inode *)NULL)
+#  define inode_cacheinsert(p,n,r)
+#  define inode_cacheflush()
+#endif
+
 /* fs_inodeaddref.c *********************************************************/
 
 void inode_addref(FAR struct inode *inode);
@@ -311,6 +338,34 @@ int files_close(int fd);
 
 void files_release(int fd);
 
+/****************************************************************************
+ * Name: fs_getfilep
+ *
+ * Description:
+ *   Get the file structure of a file descriptor of the current task, without
+ *   taking the list semaphore.  With CONFIG_FS_FILE_REFS, NULL is also
+ *   returned for a descriptor which is not open and the file must be released
+ *   with fs_putfilep() when the caller is done with it.
+ *
+ ****************************************************************************/
+
+FAR struct file *fs_getfilep(int fd);
+
+/****************************************************************************
+ * Name: fs_putfilep
+ *
+ * Description:
+ *   Release a file obtained with fs_getfilep(), completing a close() which
+ *   was deferred while it was in use.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_FILE_REFS
+void fs_putfilep(FAR struct file *filep);
+#else
+#  define fs_putfilep(filep)
+#endif
+
 /* fs_findblockdriver.c *****************************************************/
 /****************************************************************************
  * Name: find_blockdriver
@@ -338,6 +393,22 @@ void files_release(int fd);
 int find_blockdriver(FAR const char *pathname, int mountflags,
                      FAR struct inode **ppinode);
 
+/* fs_poll.c ****************************************************************/
+/****************************************************************************
+ * Name: poll_fdsetup
+ *
+ * Description:
+ *   Set up (setup == true) or tear down the poll of one file or socket
+ *   descriptor.  Also used by the epoll interface, which keeps the poll
+ *   set up across waits.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NFILE_DESCRIPTORS > 0 && !defined(CONFIG_DISABLE_POLL)
+struct pollfd;
+int poll_fdsetup(int fd, FAR struct pollfd *fds, bool setup);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -89,7 +89,6 @@ int ioctl(int fd, int req, unsigned long arg)
 {
   int err;
 #if CONFIG_NFILE_DESCRIPTORS > 0
-  FAR struct filelist *list;
   FAR struct file     *filep;
   FAR struct inode    *inode;
   int                  ret = OK;
@@ -115,14 +114,17 @@ int ioctl(int fd, int req, unsigned long arg)
     }
 
 #if CONFIG_NFILE_DESCRIPTORS > 0
-  /* Get the thread-specific file list */
+  /* Get the file structure from the thread-specific file list */
 
-  list = sched_getfiles();
-  DEBUGASSERT(list);
+  filep = fs_getfilep(fd);
+  if (!filep)
+    {
+      err = EBADF;
+      goto errout;
+    }
 
   /* Is a driver registered? Does it support the ioctl method? */
 
-  filep = &list->fl_files[fd];
   inode = filep->f_inode;
 
   if (inode && inode->u.i_ops && inode->u.i_ops->ioctl)
@@ -130,11 +132,13 @@ int ioctl(int fd, int req, unsigned long arg)
       /* Yes, then let it perform the ioctl */
 
       ret = (int)inode->u.i_ops->ioctl(filep, req, arg);
-      if (ret < 0)
-        {
-          err = -ret;
-          goto errout;
-        }
+    }
+
+  fs_putfilep(filep);
+  if (ret < 0)
+    {
+      err = -ret;
+      goto errout;
     }
 
   return ret;
@@ -95,7 +95,7 @@ static void poll_semtake(FAR sem_t *sem)
  ****************************************************************************/
 
 #if CONFIG_NFILE_DESCRIPTORS > 0
-static int poll_fdsetup(int fd, FAR struct pollfd *fds, bool setup)
+int poll_fdsetup(int fd, FAR struct pollfd *fds, bool setup)
 {
   FAR struct filelist *list;
   FAR struct file     *filep;
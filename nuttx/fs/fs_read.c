@@ -142,7 +142,8 @@ ssize_t file_read(FAR struct file *filep, FAR void *buf, size_t nbytes)
 ssize_t read(int fd, FAR void *buf, size_t nbytes)
 {
 #if CONFIG_NFILE_DESCRIPTORS > 0
-  FAR struct filelist *list;
+  FAR struct file *filep;
+  ssize_t ret;
 #endif
 
   /* Did we get a valid file descriptor? */
@@ -169,15 +170,21 @@ ssize_t read(int fd, FAR void *buf, size_t nbytes)
   else
     {
       /* Thee descriptor is in a valid range to file descriptor... do the
-       * read. Get the thread-specific file list.
+       * read. Get the file structure from the thread-specific file list.
        */
 
-      list = sched_getfiles();
-      DEBUGASSERT(list);
+      filep = fs_getfilep(fd);
+      if (!filep)
+        {
+          set_errno(EBADF);
+          return ERROR;
+        }
 
       /* Then let file_read do all of the work */
 
-      return file_read(&list->fl_files[fd], buf, nbytes);
+      ret = file_read(filep, buf, nbytes);
+      fs_putfilep(filep);
+      return ret;
     }
 #endif
 }
@@ -58,34 +58,37 @@
 #if CONFIG_NFILE_DESCRIPTORS > 0
 static inline ssize_t file_write(int fd, FAR const void *buf, size_t nbytes)
 {
-  FAR struct filelist *list;
   FAR struct file *filep;
   FAR struct inode *inode;
   int ret;
   int err;
 
-  /* Get the thread-specific file list */
-
-  list = sched_getfiles();
-
   /* The file list can be NULL under one obscure cornercase:  When memory
    * management debug output is enabled.  Then there may be attempts to
    * write to stdout from malloc before the group data has been allocated.
    */
 
-  if (!list)
+  if (!sched_getfiles())
     {
       err = EAGAIN;
       goto errout;
     }
 
+  /* Get the file structure from the thread-specific file list */
+
+  filep = fs_getfilep(fd);
+  if (!filep)
+    {
+      err = EBADF;
+      goto errout;
+    }
+
   /* Was this file opened for write access? */
 
-  filep = &list->fl_files[fd];
   if ((filep->f_oflags & O_WROK) == 0)
     {
       err = EBADF;
-      goto errout;
+      goto errout_with_filep;
     }
 
   /* Is a driver registered? Does it support the write method? */
@@ -94,7 +97,7 @@ static inline ssize_t file_write(int fd, FAR const void *buf, size_t nbytes)
   if (!inode || !inode->u.i_ops || !inode->u.i_ops->write)
     {
       err = EBADF;
-      goto errout;
+      goto errout_with_filep;
     }
 
   /* Yes, then let the driver perform the write */
@@ -103,11 +106,15 @@ static inline ssize_t file_write(int fd, FAR const void *buf, size_t nbytes)
   if (ret < 0)
     {
       err = -ret;
-      goto errout;
+      goto errout_with_filep;
     }
 
+  fs_putfilep(filep);
   return ret;
 
+errout_with_filep:
+  fs_putfilep(filep);
+
 errout:
   set_errno(err);
   return ERROR;
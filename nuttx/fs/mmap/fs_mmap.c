@@ -66,11 +66,14 @@
  *     a. The filesystem supports the FIOC_MMAP ioctl command.  Any file
  *        system that maps files contiguously on the media should support
  *        this ioctl. (vs. file system that scatter files over the media
- *        in non-contiguous sectors).  As of this writing, ROMFS is the
- *        only file system that meets this requirement.
+ *        in non-contiguous sectors).  ROMFS meets this requirement for
+ *        all files.  NXFFS (with CONFIG_NXFFS_MMAP) meets it for files
+ *        held in a single data block.
  *     b. The underlying block driver supports the BIOC_XIPBASE ioctl
- *        command that maps the underlying media to a randomly accessible
- *        address. At  present, only the RAM/ROM disk driver does this.
+ *        command (or the MTD driver supports MTDIOC_XIPBASE) that maps
+ *        the underlying media to a randomly accessible address.  MTD
+ *        partitions add the partition offset to the XIP base of the
+ *        FLASH part.
  *
  *   2. If CONFIG_FS_RAMMAP is defined in the configuration, then mmap() will
  *      support simulation of memory mapped files by copying files whole
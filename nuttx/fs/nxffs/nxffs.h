@@ -51,6 +51,9 @@
 
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/fs/nxffs.h>
+#ifdef CONFIG_NXFFS_BGPACK
+#  include <nuttx/wqueue.h>
+#endif
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -184,6 +187,25 @@
 
 #define NXFFS_NERASED             128
 
+/* Number of blocks in the volume cache */
+
+#ifndef CONFIG_NXFFS_NCACHE
+#  define CONFIG_NXFFS_NCACHE     1
+#endif
+
+/* Background packing */
+
+#ifdef CONFIG_NXFFS_BGPACK
+#  ifndef CONFIG_NXFFS_BGPACK_THRESHOLD
+#    define CONFIG_NXFFS_BGPACK_THRESHOLD 25
+#  endif
+#  ifdef CONFIG_SCHED_LPWORK
+#    define NXFFS_PACK_WORK       LPWORK
+#  else
+#    define NXFFS_PACK_WORK       HPWORK
+#  endif
+#endif
+
 /* Quasi-standard definitions */
 
 #ifndef MIN
@@ -301,6 +323,16 @@ struct nxffs_volume_s
   FAR struct nxffs_ofile_s *ofiles;    /* A singly-linked list of open files */
   FAR uint8_t              *cache;     /* On cached erase block for general I/O */
   FAR uint8_t              *pack;      /* A full erase block to support packing */
+#if CONFIG_NXFFS_NCACHE > 1
+  FAR uint8_t              *cbuffer;   /* Memory for all cached blocks */
+  uint32_t                  cclock;    /* Incremented on each cache access */
+  off_t                     cblocks[CONFIG_NXFFS_NCACHE]; /* Cached blocks */
+  uint32_t                  cused[CONFIG_NXFFS_NCACHE];   /* Last slot use */
+#endif
+#ifdef CONFIG_NXFFS_BGPACK
+  bool                      packpending; /* Inodes deleted since pack */
+  struct work_s             packwork;  /* Schedules background packing */
+#endif
 };
 
 /* This structure describes the state of the blocks on the NXFFS volume */
@@ -507,6 +539,29 @@ int nxffs_rdcache(FAR struct nxffs_volume_s *volume, off_t block);
 
 int nxffs_wrcache(FAR struct nxffs_volume_s *volume);
 
+/****************************************************************************
+ * Name: nxffs_invcache
+ *
+ * Description:
+ *   Discard any cached copies of a range of logical blocks.  This must be
+ *   called after the blocks were erased or written without going through
+ *   the cache.
+ *
+ * Input Parameters:
+ *   volume - Describes the current volume
+ *   block  - The first logical block to discard
+ *   nblocks - The number of logical blocks to discard
+ *
+ * Returned Value:
+ *   None
+ *
+ * Defined in nxffs_cache.c
+ *
+ ****************************************************************************/
+
+void nxffs_invcache(FAR struct nxffs_volume_s *volume, off_t block,
+                    off_t nblocks);
+
 /****************************************************************************
  * Name: nxffs_ioseek
  *
@@ -1059,6 +1114,30 @@ int nxffs_rminode(FAR struct nxffs_volume_s *volume, FAR const char *name);
 
 int nxffs_pack(FAR struct nxffs_volume_s *volume);
 
+/****************************************************************************
+ * Name: nxffs_packsched
+ *
+ * Description:
+ *   Schedule background packing of the volume if the free FLASH space is
+ *   below the threshold and inodes were deleted since the last pack.  The
+ *   caller must hold the volume exclsem.
+ *
+ * Input Parameters:
+ *   volume - The volume to be packed.
+ *
+ * Returned Values:
+ *   None
+ *
+ * Defined in nxffs_pack.c
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BGPACK
+void nxffs_packsched(FAR struct nxffs_volume_s *volume);
+#else
+#  define nxffs_packsched(v)
+#endif
+
 /****************************************************************************
  * Standard mountpoint operation methods
  *
@@ -65,6 +65,58 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: nxffs_cacheslot
+ *
+ * Description:
+ *   Select the cache slot for a block:  The slot already holding the block
+ *   or, if there is none, the least recently used slot.  volume->cache is
+ *   set to point at the selected slot.
+ *
+ * Input Parameters:
+ *   volume - Describes the current volume
+ *   block  - The logical block to be accessed
+ *
+ * Returned Value:
+ *   The index of the selected slot.
+ *
+ ****************************************************************************/
+
+#if CONFIG_NXFFS_NCACHE > 1
+static int nxffs_cacheslot(FAR struct nxffs_volume_s *volume, off_t block)
+{
+  uint32_t age;
+  uint32_t oldest = 0;
+  int victim = 0;
+  int i;
+
+  for (i = 0; i < CONFIG_NXFFS_NCACHE; i++)
+    {
+      if (volume->cblocks[i] == block)
+        {
+          victim = i;
+          break;
+        }
+
+      /* Ages are computed relative to the clock so that wrap-around of the
+       * counter does not matter.  Empty slots are always preferred.
+       */
+
+      age = volume->cblocks[i] < 0 ? UINT32_MAX :
+            volume->cclock - volume->cused[i];
+      if (age > oldest)
+        {
+          oldest = age;
+          victim = i;
+        }
+    }
+
+  volume->cused[victim] = ++volume->cclock;
+  volume->cache = &volume->cbuffer[victim * volume->geo.blocksize];
+  return victim;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -73,7 +125,9 @@
  * Name: nxffs_rdcache
  *
  * Description:
- *   Read one I/O block into the volume block cache memory.
+ *   Read one I/O block into the volume block cache memory.  If
+ *   CONFIG_NXFFS_NCACHE > 1, several recently used blocks are retained and
+ *   volume->cache is redirected to the copy of the requested block.
  *
  * Input Parameters:
  *   volume - Describes the current volume
@@ -88,7 +142,43 @@
 int nxffs_rdcache(FAR struct nxffs_volume_s *volume, off_t block)
 {
   size_t nxfrd;
+#if CONFIG_NXFFS_NCACHE > 1
+  int slot;
+
+  /* Check if the requested data is the current cache block */
+
+  if (block == volume->cblock)
+    {
+      return OK;
+    }
+
+  /* Check if the requested data is in any other cache slot */
+
+  slot = nxffs_cacheslot(volume, block);
+  if (volume->cblocks[slot] == block)
+    {
+      volume->cblock = block;
+      return OK;
+    }
+
+  /* Read the block into the selected slot */
 
+  volume->cblocks[slot] = (off_t)-1;
+  volume->cblock        = (off_t)-1;
+
+  nxfrd = MTD_BREAD(volume->mtd, block, 1, volume->cache);
+  if (nxfrd != 1)
+    {
+      fdbg("ERROR: Read block %d failed: %d\n", block, nxfrd);
+      return -EIO;
+    }
+
+  /* Remember what is in the cache */
+
+  volume->cblocks[slot] = block;
+  volume->cblock        = block;
+
+#else
   /* Check if the requested data is already in the cache */
 
   if (block != volume->cblock)
@@ -106,6 +196,7 @@ int nxffs_rdcache(FAR struct nxffs_volume_s *volume, off_t block)
 
       volume->cblock  = block;
     }
+#endif
 
   return OK;
 }
@@ -134,6 +225,10 @@ int nxffs_wrcache(FAR struct nxffs_volume_s *volume)
   if (nxfrd != 1)
     {
       fdbg("ERROR: Write block %d failed: %d\n", volume->cblock, nxfrd);
+
+      /* The cached copy no longer matches FLASH */
+
+      nxffs_invcache(volume, volume->cblock, 1);
       return -EIO;
     }
 
@@ -142,6 +237,46 @@ int nxffs_wrcache(FAR struct nxffs_volume_s *volume)
   return OK;
 }
 
+/****************************************************************************
+ * Name: nxffs_invcache
+ *
+ * Description:
+ *   Discard any cached copies of a range of logical blocks.  This must be
+ *   called after the blocks were erased or written without going through
+ *   the cache.
+ *
+ * Input Parameters:
+ *   volume - Describes the current volume
+ *   block  - The first logical block to discard
+ *   nblocks - The number of logical blocks to discard
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxffs_invcache(FAR struct nxffs_volume_s *volume, off_t block,
+                    off_t nblocks)
+{
+#if CONFIG_NXFFS_NCACHE > 1
+  int i;
+
+  for (i = 0; i < CONFIG_NXFFS_NCACHE; i++)
+    {
+      if (volume->cblocks[i] >= block &&
+          volume->cblocks[i] < block + nblocks)
+        {
+          volume->cblocks[i] = (off_t)-1;
+        }
+    }
+#endif
+
+  if (volume->cblock >= block && volume->cblock < block + nblocks)
+    {
+      volume->cblock = (off_t)-1;
+    }
+}
+
 /****************************************************************************
  * Name: nxffs_ioseek
  *
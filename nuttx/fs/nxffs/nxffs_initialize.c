@@ -159,6 +159,9 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
 #ifdef CONFIG_NXFFS_SCAN_VOLUME
   struct nxffs_blkstats_s stats;
   off_t threshold;
+#endif
+#if CONFIG_NXFFS_NCACHE > 1
+  int i;
 #endif
   int ret;
 
@@ -201,6 +204,27 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
       goto errout_with_volume;
     }
 
+#if CONFIG_NXFFS_NCACHE > 1
+  /* Allocate CONFIG_NXFFS_NCACHE I/O block buffers for general file system
+   * access.  volume->cache will point to the slot holding volume->cblock.
+   */
+
+  volume->cbuffer = (FAR uint8_t *)
+    kmm_malloc(CONFIG_NXFFS_NCACHE * volume->geo.blocksize);
+  if (!volume->cbuffer)
+    {
+      fdbg("ERROR: Failed to allocate the block cache\n");
+      ret = -ENOMEM;
+      goto errout_with_volume;
+    }
+
+  for (i = 0; i < CONFIG_NXFFS_NCACHE; i++)
+    {
+      volume->cblocks[i] = (off_t)-1;
+    }
+
+  volume->cache = volume->cbuffer;
+#else
   /* Allocate one I/O block buffer to general files system access */
 
   volume->cache = (FAR uint8_t *)kmm_malloc(volume->geo.blocksize);
@@ -210,6 +234,7 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
       ret = -ENOMEM;
       goto errout_with_volume;
     }
+#endif
 
   /* Pre-allocate one, full, in-memory erase block.  This is needed for filesystem
    * packing (but is useful in other places as well). This buffer is not needed
@@ -315,7 +340,11 @@ int nxffs_initialize(FAR struct mtd_dev_s *mtd)
 errout_with_buffer:
   kmm_free(volume->pack);
 errout_with_cache:
+#if CONFIG_NXFFS_NCACHE > 1
+  kmm_free(volume->cbuffer);
+#else
   kmm_free(volume->cache);
+#endif
 errout_with_volume:
 #ifndef CONFIG_NXFFS_PREALLOCATED
   kmm_free(volume);
@@ -56,6 +56,15 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Helpers for scanning FLASH data one 32-bit word at a time:  NXFFS_WORD
+ * replicates a byte value into all four bytes of a word and NXFFS_HASBYTE
+ * is non-zero if any byte of the word w is equal to b.
+ */
+
+#define NXFFS_WORD(b)       ((uint32_t)(b) * 0x01010101)
+#define NXFFS_HASZERO(w)    (((w) - 0x01010101) & ~(w) & 0x80808080)
+#define NXFFS_HASBYTE(w,b)  NXFFS_HASZERO((w) ^ NXFFS_WORD(b))
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -263,6 +272,8 @@ void nxffs_freeentry(FAR struct nxffs_entry_s *entry)
 int nxffs_nextentry(FAR struct nxffs_volume_s *volume, off_t offset,
                     FAR struct nxffs_entry_s *entry)
 {
+  off_t vblock = (off_t)-1;
+  uint32_t word;
   int nmagic;
   int ch;
   int nerased;
@@ -278,6 +289,44 @@ int nxffs_nextentry(FAR struct nxffs_volume_s *volume, off_t offset,
   nmagic  = 0;
   for (;;)
     {
+      /* If we are not in the middle of a magic sequence and the current
+       * block has already been verified and is still in the cache, then
+       * skip over runs of erased bytes and of data that cannot start an
+       * inode a word at a time.  Stop short of the end of the block where
+       * nxffs_getc() would advance to the next block.  Anything else is
+       * handled one byte at a time below.
+       */
+
+      if (nmagic == 0 && vblock == volume->ioblock &&
+          volume->cblock == volume->ioblock)
+        {
+          while ((size_t)volume->iooffset + sizeof(uint32_t) - 1 +
+                 SIZEOF_NXFFS_INODE_HDR <= volume->geo.blocksize)
+            {
+              memcpy(&word, &volume->cache[volume->iooffset], sizeof(uint32_t));
+              if (word == NXFFS_WORD(CONFIG_NXFFS_ERASEDSTATE))
+                {
+                  nerased += sizeof(uint32_t);
+                  if (nerased >= NXFFS_NERASED)
+                    {
+                      fvdbg("No entry found\n");
+                      return -ENOENT;
+                    }
+                }
+              else if (!NXFFS_HASBYTE(word, CONFIG_NXFFS_ERASEDSTATE) &&
+                       !NXFFS_HASBYTE(word, g_inodemagic[0]))
+                {
+                  nerased = 0;
+                }
+              else
+                {
+                  break;
+                }
+
+              volume->iooffset += sizeof(uint32_t);
+            }
+        }
+
       /* Read the next character */
 
       ch = nxffs_getc(volume, SIZEOF_NXFFS_INODE_HDR - nmagic);
@@ -287,9 +336,13 @@ int nxffs_nextentry(FAR struct nxffs_volume_s *volume, off_t offset,
           return ch;
         }
 
+      /* nxffs_getc() verified the block holding this character */
+
+      vblock = volume->ioblock;
+
       /* Check for another erased byte */
 
-      else if (ch == CONFIG_NXFFS_ERASEDSTATE)
+      if (ch == CONFIG_NXFFS_ERASEDSTATE)
         {
           /* If we have encountered NXFFS_NERASED number of consecutive
            * erased bytes, then presume we have reached the end of valid
@@ -42,6 +42,7 @@
 #include <nuttx/config.h>
 
 #include <string.h>
+#include <fcntl.h>
 #include <assert.h>
 #include <errno.h>
 #include <debug.h>
@@ -68,6 +69,68 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: nxffs_mmap
+ *
+ * Description:
+ *   Return the address of the file data in directly addressable FLASH.
+ *   This is only possible if all of the file data is held in a single
+ *   data block; otherwise the data is interrupted by block and data block
+ *   headers.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_MMAP
+static int nxffs_mmap(FAR struct nxffs_volume_s *volume,
+                      FAR struct nxffs_ofile_s *ofile, FAR void **ppv)
+{
+  FAR uint8_t *base;
+  uint16_t datlen;
+  int ret;
+
+  if (ppv == NULL)
+    {
+      return -EINVAL;
+    }
+
+  /* A file being written is not on FLASH yet */
+
+  if ((ofile->oflags & O_WROK) != 0 || ofile->entry.datlen == 0)
+    {
+      return -ENODEV;
+    }
+
+  /* Is the FLASH directly addressable? */
+
+  ret = MTD_IOCTL(volume->mtd, MTDIOC_XIPBASE,
+                  (unsigned long)((uintptr_t)&base));
+  if (ret < 0)
+    {
+      fvdbg("MTD does not support XIP: %d\n", -ret);
+      return -ENODEV;
+    }
+
+  /* Is the entire file contained in the first data block? */
+
+  ret = nxffs_rdblkhdr(volume, ofile->entry.doffset, &datlen);
+  if (ret < 0)
+    {
+      fdbg("ERROR: Failed to read data block header: %d\n", -ret);
+      return ret;
+    }
+
+  if (datlen != ofile->entry.datlen)
+    {
+      fvdbg("File is not contiguous: %d of %d bytes\n",
+            datlen, ofile->entry.datlen);
+      return -ENODEV;
+    }
+
+  *ppv = (FAR void *)(base + ofile->entry.doffset + SIZEOF_NXFFS_DATA_HDR);
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -108,7 +171,7 @@ int nxffs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
       goto errout;
     }
 
-  /* Only a reformat and optimize commands are supported */
+  /* Only reformat, optimize and (optionally) mmap commands are supported */
 
   if (cmd == FIOC_REFORMAT)
     {
@@ -136,6 +199,19 @@ int nxffs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
       ret = nxffs_pack(volume);
     }
+
+#ifdef CONFIG_NXFFS_MMAP
+  else if (cmd == FIOC_MMAP)
+    {
+      fvdbg("Mmap command\n");
+
+      /* Return the in-place address of the file data */
+
+      ret = nxffs_mmap(volume, (FAR struct nxffs_ofile_s *)filep->f_priv,
+                       (FAR void **)((uintptr_t)arg));
+    }
+#endif
+
   else
     {
       /* No other commands supported */
@@ -1196,6 +1196,9 @@ int nxffs_close(FAR struct file *filep)
       ofile->crefs--;
     }
 
+  /* Start background packing if this freed up enough space */
+
+  nxffs_packsched(volume);
 
   filep->f_priv = NULL;
   sem_post(&volume->exclsem);
@@ -1247,6 +1247,49 @@ static inline int nxffs_packwriter(FAR struct nxffs_volume_s *volume,
   return -ENOSYS;
 }
 
+/****************************************************************************
+ * Name: nxffs_packworker
+ *
+ * Description:
+ *   Work queue entry point for background packing.  Packing is skipped if
+ *   any file was opened in the meantime:  Packing moves inodes and data
+ *   blocks and would invalidate the FLASH offsets held by open readers.
+ *
+ * Input Parameters:
+ *   arg - The volume to be packed.
+ *
+ * Returned Values:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BGPACK
+static void nxffs_packworker(FAR void *arg)
+{
+  FAR struct nxffs_volume_s *volume = (FAR struct nxffs_volume_s *)arg;
+  int ret;
+
+  ret = sem_wait(&volume->exclsem);
+  if (ret != OK)
+    {
+      return;
+    }
+
+  if (volume->packpending && volume->ofiles == NULL)
+    {
+      fvdbg("Background packing, froffset: %d\n", volume->froffset);
+
+      ret = nxffs_pack(volume);
+      if (ret < 0 && ret != -ENOSPC)
+        {
+          fdbg("ERROR: Background packing failed: %d\n", -ret);
+        }
+    }
+
+  sem_post(&volume->exclsem);
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -1278,6 +1321,14 @@ int nxffs_pack(FAR struct nxffs_volume_s *volume)
   int i;
   int ret = OK;
 
+#ifdef CONFIG_NXFFS_BGPACK
+  /* Whatever the outcome, there is no point in trying again until more
+   * inodes are deleted.
+   */
+
+  volume->packpending = false;
+#endif
+
   /* Get the offset to the first valid inode entry */
 
   wrfile = NULL;
@@ -1581,6 +1632,7 @@ start_pack:
        * appear. Now it is safe to erase the block.
        */
 
+      nxffs_invcache(volume, pack.block0, volume->blkper);
       ret = MTD_ERASE(volume->mtd, eblock, 1);
       if (ret < 0)
         {
@@ -1605,3 +1657,42 @@ errout_with_pack:
   nxffs_freeentry(&pack.dest.entry);
   return ret;
 }
+
+/****************************************************************************
+ * Name: nxffs_packsched
+ *
+ * Description:
+ *   Schedule background packing of the volume if the free FLASH space is
+ *   below the threshold and inodes were deleted since the last pack.  The
+ *   caller must hold the volume exclsem.
+ *
+ * Input Parameters:
+ *   volume - The volume to be packed.
+ *
+ * Returned Values:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NXFFS_BGPACK
+void nxffs_packsched(FAR struct nxffs_volume_s *volume)
+{
+  off_t total;
+  off_t nfree;
+
+  if (!volume->packpending || volume->ofiles != NULL ||
+      !work_available(&volume->packwork))
+    {
+      return;
+    }
+
+  total = volume->nblocks * volume->geo.blocksize;
+  nfree = total - volume->froffset;
+
+  if (nfree < (total / 100) * CONFIG_NXFFS_BGPACK_THRESHOLD)
+    {
+      (void)work_queue(NXFFS_PACK_WORK, &volume->packwork, nxffs_packworker,
+                       volume, 0);
+    }
+}
+#endif
@@ -105,6 +105,7 @@ static int nxffs_format(FAR struct nxffs_volume_s *volume)
     {
       /* Erase the block */
 
+      nxffs_invcache(volume, eblock * volume->blkper, volume->blkper);
       ret = MTD_ERASE(volume->mtd, eblock, 1);
       if (ret < 0)
         {
@@ -253,6 +254,7 @@ static int nxffs_badblocks(FAR struct nxffs_volume_s *volume)
 
       if (modified)
         {
+          nxffs_invcache(volume, lblock, volume->blkper);
           nxfrd = MTD_BWRITE(volume->mtd, lblock, volume->blkper, volume->pack);
           if (nxfrd != volume->blkper)
             {
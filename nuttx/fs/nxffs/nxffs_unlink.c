@@ -145,6 +145,14 @@ int nxffs_rminode(FAR struct nxffs_volume_s *volume, FAR const char *name)
       fdbg("ERROR: Failed to write block %d: %d\n",
            volume->ioblock, ret);
     }
+#ifdef CONFIG_NXFFS_BGPACK
+  else
+    {
+      /* The space held by the inode can now be recovered by packing */
+
+      volume->packpending = true;
+    }
+#endif
 
 errout_with_entry:
   nxffs_freeentry(&entry);
@@ -182,6 +190,7 @@ int nxffs_unlink(FAR struct inode *mountpt, FAR const char *relpath)
   /* Then remove the NXFFS inode */
 
   ret = nxffs_rminode(volume, relpath);
+  nxffs_packsched(volume);
 
   sem_post(&volume->exclsem);
 errout:
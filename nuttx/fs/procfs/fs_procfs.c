@@ -78,6 +78,15 @@
 extern const struct procfs_operations proc_operations;
 extern const struct procfs_operations cpuload_operations;
 extern const struct procfs_operations uptime_operations;
+extern const struct procfs_operations irqtrace_operations;
+extern const struct procfs_operations profile_operations;
+extern const struct procfs_operations boottrace_operations;
+extern const struct procfs_operations wqueue_operations;
+extern const struct procfs_operations heapprof_operations;
+extern const struct procfs_operations heapfrag_operations;
+extern const struct procfs_operations mempool_operations;
+extern const struct procfs_operations rwbuffer_operations;
+extern const struct procfs_operations paging_operations;
 
 /* This is not good.  These are implemented in drivers/mtd.  Having to
  * deal with them here is not a good coupling.
@@ -86,6 +95,7 @@ extern const struct procfs_operations uptime_operations;
 extern const struct procfs_operations mtd_procfsoperations;
 extern const struct procfs_operations part_procfsoperations;
 extern const struct procfs_operations smartfs_procfsoperations;
+extern const struct procfs_operations mtdstats_procfsoperations;
 
 /* And even worse, this one is specific to the STM32.  The solution to
  * this nasty couple would be to replace this hard-coded, ROM-able
@@ -96,6 +106,38 @@ extern const struct procfs_operations smartfs_procfsoperations;
 extern const struct procfs_operations ccm_procfsoperations;
 #endif
 
+#if defined(CONFIG_MM_BUFRAM_ALLOCATOR) && !defined(CONFIG_FS_PROCFS_EXCLUDE_BUFRAM)
+extern const struct procfs_operations bufram_procfsoperations;
+#endif
+
+#if defined(CONFIG_GREYBUS_SLAB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+extern const struct procfs_operations gb_slab_procfsoperations;
+#endif
+
+#if defined(CONFIG_GREYBUS_IRQOFF_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+extern const struct procfs_operations gb_irqoff_procfsoperations;
+#endif
+
+#if defined(CONFIG_GREYBUS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+extern const struct procfs_operations gb_trace_procfsoperations;
+#endif
+
+#if defined(CONFIG_GREYBUS_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+extern const struct procfs_operations gb_stats_procfsoperations;
+#endif
+
+#if defined(CONFIG_GREYBUS_MODS_I2C_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+extern const struct procfs_operations mods_i2c_dl_procfsoperations;
+#endif
+
+#if defined(CONFIG_GREYBUS_UART_RX_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+extern const struct procfs_operations gb_uart_procfsoperations;
+#endif
+
+#if defined(CONFIG_UNIPRO_LINK_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_UNIPRO)
+extern const struct procfs_operations unipro_link_procfsoperations;
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -112,11 +154,43 @@ static const struct procfs_entry_s g_procfsentries[] =
   { "cpuload",          &cpuload_operations },
 #endif
 
+#if defined(CONFIG_MM_FRAGINFO) && !defined(CONFIG_FS_PROCFS_EXCLUDE_HEAPFRAG)
+  { "heapfrag",         &heapfrag_operations },
+#endif
+
+#if defined(CONFIG_MM_PROFILE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_HEAPPROF)
+  { "heapprof",         &heapprof_operations },
+#endif
+
+#if defined(CONFIG_MM_MEMPOOL) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMPOOL)
+  { "mempool",          &mempool_operations },
+#endif
+
+#if defined(CONFIG_IRQSAVE_TRACE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IRQTRACE)
+  { "irqtrace",         &irqtrace_operations },
+#endif
+
+#if defined(CONFIG_BOOT_TRACE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_BOOTTRACE)
+  { "boottrace",        &boottrace_operations },
+#endif
+
+#if defined(CONFIG_SCHED_PROFILE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_PROFILE)
+  { "profile",          &profile_operations },
+#endif
+
 #if defined(CONFIG_FS_SMARTFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
 //{ "fs/smartfs",       &smartfs_procfsoperations },
   { "fs/smartfs**",     &smartfs_procfsoperations },
 #endif
 
+#if defined(CONFIG_MTD_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MTD)
+  { "fs/stats",         &mtdstats_procfsoperations },
+#endif
+
+#if defined(CONFIG_DRVR_RWBSTATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_RWBUFFER)
+  { "fs/rwbuffer",      &rwbuffer_operations },
+#endif
+
 #if defined(CONFIG_MTD) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MTD)
   { "mtd",              &mtd_procfsoperations },
 #endif
@@ -125,13 +199,53 @@ static const struct procfs_entry_s g_procfsentries[] =
   { "partitions",       &part_procfsoperations },
 #endif
 
+#if defined(CONFIG_PAGING_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_PAGING)
+  { "paging",           &paging_operations },
+#endif
+
 #if !defined(CONFIG_FS_PROCFS_EXCLUDE_UPTIME)
   { "uptime",           &uptime_operations },
 #endif
 
+#if defined(CONFIG_SCHED_WORKQUEUE_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_WQUEUE)
+  { "wqueue",           &wqueue_operations },
+#endif
+
 #if defined(CONFIG_STM32_CCM_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_CCM)
   { "ccm",             &ccm_procfsoperations },
 #endif
+
+#if defined(CONFIG_MM_BUFRAM_ALLOCATOR) && !defined(CONFIG_FS_PROCFS_EXCLUDE_BUFRAM)
+  { "bufram",          &bufram_procfsoperations },
+#endif
+
+#if defined(CONFIG_GREYBUS_SLAB) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+  { "greybus/slab",     &gb_slab_procfsoperations },
+#endif
+
+#if defined(CONFIG_GREYBUS_IRQOFF_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+  { "greybus/irqoff",   &gb_irqoff_procfsoperations },
+#endif
+
+#if defined(CONFIG_GREYBUS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+  { "greybus/trace",    &gb_trace_procfsoperations },
+#endif
+
+#if defined(CONFIG_GREYBUS_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+  { "greybus/stats",    &gb_stats_procfsoperations },
+#endif
+
+#if defined(CONFIG_GREYBUS_MODS_I2C_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+  { "greybus/mods_i2c", &mods_i2c_dl_procfsoperations },
+#endif
+
+#if defined(CONFIG_GREYBUS_UART_RX_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_GREYBUS)
+  { "greybus/uart",     &gb_uart_procfsoperations },
+#endif
+
+#if defined(CONFIG_UNIPRO_LINK_STATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_UNIPRO)
+  { "unipro",           &unipro_link_procfsoperations },
+#endif
 };
 
 static const uint8_t g_procfsentrycount = sizeof(g_procfsentries) /
@@ -151,6 +265,8 @@ static int     procfs_open(FAR struct file *filep, FAR const char *relpath,
 static int     procfs_close(FAR struct file *filep);
 static ssize_t procfs_read(FAR struct file *filep, FAR char *buffer,
                  size_t buflen);
+static ssize_t procfs_write(FAR struct file *filep, FAR const char *buffer,
+                 size_t buflen);
 static int     procfs_ioctl(FAR struct file *filep, int cmd,
                  unsigned long arg);
 
@@ -193,7 +309,7 @@ const struct mountpt_operations procfs_operations =
   procfs_open,       /* open */
   procfs_close,      /* close */
   procfs_read,       /* read */
-  NULL,              /* write */
+  procfs_write,      /* write */
   NULL,              /* seek */
   procfs_ioctl,      /* ioctl */
 
@@ -360,6 +476,34 @@ static ssize_t procfs_read(FAR struct file *filep, FAR char *buffer,
   return ret;
 }
 
+/****************************************************************************
+ * Name: procfs_write
+ ****************************************************************************/
+
+static ssize_t procfs_write(FAR struct file *filep, FAR const char *buffer,
+                            size_t buflen)
+{
+  FAR struct procfs_file_s *handler;
+
+  fvdbg("buffer=%p buflen=%d\n", buffer, (int)buflen);
+
+  /* Recover our private data from the struct file instance */
+
+  handler = (FAR struct procfs_file_s *)filep->f_priv;
+  DEBUGASSERT(handler);
+
+  /* Most entries are read-only and refuse to be opened for writing, but
+   * check anyway.
+   */
+
+  if (!handler->procfsentry->ops->write)
+    {
+      return -EACCES;
+    }
+
+  return handler->procfsentry->ops->write(filep, buffer, buflen);
+}
+
 /****************************************************************************
  * Name: procfs_ioctl
  ****************************************************************************/
@@ -0,0 +1,342 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsheapfrag.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/mm.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_MM_FRAGINFO) && !defined(CONFIG_FS_PROCFS_EXCLUDE_HEAPFRAG)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The heaps that can be reached from here */
+
+#if !defined(CONFIG_BUILD_PROTECTED) && !defined(CONFIG_BUILD_KERNEL)
+#  define HAVE_USER_HEAP 1
+#endif
+
+#if defined(HAVE_USER_HEAP) && defined(CONFIG_MM_KERNEL_HEAP)
+#  define HEAPFRAG_NHEAPS 2
+#else
+#  define HEAPFRAG_NHEAPS 1
+#endif
+
+/* Size of the formatted output:  Per heap, a summary line, a header and
+ * one line per size class.
+ */
+
+#define HEAPFRAG_LINELEN 40
+#define HEAPFRAG_BUFLEN  \
+  (HEAPFRAG_NHEAPS * (MM_NNODES + 2) * HEAPFRAG_LINELEN)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct heapfrag_file_s
+{
+  struct procfs_file_s base;         /* Base open file structure */
+  size_t len;                        /* Number of valid characters in buf[] */
+  char buf[HEAPFRAG_BUFLEN];         /* Snapshot taken on the first read */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     heapfrag_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     heapfrag_close(FAR struct file *filep);
+static ssize_t heapfrag_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     heapfrag_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     heapfrag_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct
+{
+  FAR const char *name;
+  FAR struct mm_heap_s *heap;
+} g_heapfrag_heaps[HEAPFRAG_NHEAPS] =
+{
+#ifdef HAVE_USER_HEAP
+  { "user",   &g_mmheap },
+#endif
+#ifdef CONFIG_MM_KERNEL_HEAP
+  { "kernel", &g_kmmheap },
+#endif
+};
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there. */
+
+const struct procfs_operations heapfrag_operations =
+{
+  heapfrag_open,     /* open */
+  heapfrag_close,    /* close */
+  heapfrag_read,     /* read */
+  NULL,              /* write */
+
+  heapfrag_dup,      /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  heapfrag_stat      /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: heapfrag_format
+ ****************************************************************************/
+
+static size_t heapfrag_format(FAR struct heapfrag_file_s *attr)
+{
+  struct mm_fraginfo_s info;
+  struct mallinfo mem;
+  FAR struct mm_heap_s *heap;
+  size_t len = 0;
+  int ndx;
+  int i;
+
+  for (ndx = 0; ndx < HEAPFRAG_NHEAPS; ndx++)
+    {
+      heap = g_heapfrag_heaps[ndx].heap;
+
+      (void)mm_mallinfo(heap, &mem);
+      mm_fraginfo(heap, &info);
+
+      len += snprintf(attr->buf + len, HEAPFRAG_BUFLEN - len,
+                      "%s: free %lu largest %lu lowest %lu reclaimed %lu\n",
+                      g_heapfrag_heaps[ndx].name,
+                      (unsigned long)mem.fordblks,
+                      (unsigned long)info.largest,
+                      (unsigned long)info.largest_min,
+                      (unsigned long)info.reclaimed);
+      len += snprintf(attr->buf + len, HEAPFRAG_BUFLEN - len,
+                      "     SIZE    CHUNKS\n");
+
+      for (i = 0; i < MM_NNODES && len < HEAPFRAG_BUFLEN; i++)
+        {
+          if (info.nfree[i] > 0)
+            {
+              len += snprintf(attr->buf + len, HEAPFRAG_BUFLEN - len,
+                              "%9lu%c %8lu\n",
+                              (unsigned long)MM_MIN_CHUNK << i,
+                              i < MM_NNODES - 1 ? ' ' : '+',
+                              (unsigned long)info.nfree[i]);
+            }
+        }
+
+      if (len >= HEAPFRAG_BUFLEN)
+        {
+          break;
+        }
+    }
+
+  return len < HEAPFRAG_BUFLEN ? len : HEAPFRAG_BUFLEN - 1;
+}
+
+/****************************************************************************
+ * Name: heapfrag_open
+ ****************************************************************************/
+
+static int heapfrag_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct heapfrag_file_s *attr;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* "heapfrag" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "heapfrag") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = (FAR struct heapfrag_file_s *)
+    kmm_zalloc(sizeof(struct heapfrag_file_s));
+  if (!attr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: heapfrag_close
+ ****************************************************************************/
+
+static int heapfrag_close(FAR struct file *filep)
+{
+  FAR struct heapfrag_file_s *attr;
+
+  attr = (FAR struct heapfrag_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: heapfrag_read
+ ****************************************************************************/
+
+static ssize_t heapfrag_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+  FAR struct heapfrag_file_s *attr;
+  off_t offset;
+  ssize_t ret;
+
+  attr = (FAR struct heapfrag_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Take the snapshot on the first read so that it stays stable while it
+   * is read in pieces.
+   */
+
+  if (filep->f_pos == 0)
+    {
+      attr->len = heapfrag_format(attr);
+    }
+
+  offset = filep->f_pos;
+  ret    = procfs_memcpy(attr->buf, attr->len, buffer, buflen, &offset);
+
+  if (ret > 0)
+    {
+      filep->f_pos += ret;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: heapfrag_dup
+ ****************************************************************************/
+
+static int heapfrag_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct heapfrag_file_s *oldattr;
+  FAR struct heapfrag_file_s *newattr;
+
+  oldattr = (FAR struct heapfrag_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  newattr = (FAR struct heapfrag_file_s *)
+    kmm_malloc(sizeof(struct heapfrag_file_s));
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  memcpy(newattr, oldattr, sizeof(struct heapfrag_file_s));
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: heapfrag_stat
+ ****************************************************************************/
+
+static int heapfrag_stat(const char *relpath, struct stat *buf)
+{
+  if (strcmp(relpath, "heapfrag") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_MM_FRAGINFO && !CONFIG_FS_PROCFS_EXCLUDE_HEAPFRAG */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -0,0 +1,421 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsheapprof.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/mm.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_MM_PROFILE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_HEAPPROF)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The heaps that can be reached from here */
+
+#if !defined(CONFIG_BUILD_PROTECTED) && !defined(CONFIG_BUILD_KERNEL)
+#  define HAVE_USER_HEAP 1
+#endif
+
+#if defined(HAVE_USER_HEAP) && defined(CONFIG_MM_KERNEL_HEAP)
+#  define HEAPPROF_NHEAPS 2
+#else
+#  define HEAPPROF_NHEAPS 1
+#endif
+
+/* Size of the formatted output:  Per heap, a counter line, a header, one
+ * line per call site and one line for the call sites that did not fit.
+ */
+
+#define HEAPPROF_NSITES  CONFIG_MM_PROFILE_NSITES
+#define HEAPPROF_LINELEN 48
+#define HEAPPROF_BUFLEN  \
+  (HEAPPROF_NHEAPS * (HEAPPROF_NSITES + 4) * HEAPPROF_LINELEN)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Live allocations of one thread from one call site */
+
+struct heapprof_site_s
+{
+  FAR void *caller;                  /* Return address of the allocation */
+  pid_t pid;                         /* Thread that allocated */
+  uint32_t nchunks;                  /* Number of live chunks */
+  uint32_t nbytes;                   /* Size of the live chunks */
+};
+
+/* The call sites of one heap */
+
+struct heapprof_sites_s
+{
+  int nsites;                        /* Number of valid entries in site[] */
+  struct heapprof_site_s site[HEAPPROF_NSITES];
+  struct heapprof_site_s other;      /* Everything that did not fit */
+};
+
+/* This structure describes one open "file" */
+
+struct heapprof_file_s
+{
+  struct procfs_file_s base;         /* Base open file structure */
+  struct heapprof_sites_s sites;     /* Scratch space for one heap */
+  size_t len;                        /* Number of valid characters in buf[] */
+  char buf[HEAPPROF_BUFLEN];         /* Snapshot taken on the first read */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     heapprof_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     heapprof_close(FAR struct file *filep);
+static ssize_t heapprof_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     heapprof_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     heapprof_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static const struct
+{
+  FAR const char *name;
+  FAR struct mm_heap_s *heap;
+} g_heapprof_heaps[HEAPPROF_NHEAPS] =
+{
+#ifdef HAVE_USER_HEAP
+  { "user",   &g_mmheap },
+#endif
+#ifdef CONFIG_MM_KERNEL_HEAP
+  { "kernel", &g_kmmheap },
+#endif
+};
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there. */
+
+const struct procfs_operations heapprof_operations =
+{
+  heapprof_open,     /* open */
+  heapprof_close,    /* close */
+  heapprof_read,     /* read */
+  NULL,              /* write */
+
+  heapprof_dup,      /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  heapprof_stat      /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: heapprof_collect
+ *
+ * Description:
+ *   mm_profile() callback:  Account one allocated chunk to its call site.
+ *   This runs with the heap held, so it only does a short table search.
+ *
+ ****************************************************************************/
+
+static void heapprof_collect(FAR const struct mm_allocnode_s *node,
+                             FAR void *arg)
+{
+  FAR struct heapprof_sites_s *sites = (FAR struct heapprof_sites_s *)arg;
+  FAR struct heapprof_site_s *site;
+  int i;
+
+  for (i = 0; i < sites->nsites; i++)
+    {
+      site = &sites->site[i];
+      if (site->caller == node->caller && site->pid == node->pid)
+        {
+          goto found;
+        }
+    }
+
+  if (sites->nsites < HEAPPROF_NSITES)
+    {
+      site         = &sites->site[sites->nsites++];
+      site->caller = node->caller;
+      site->pid    = node->pid;
+    }
+  else
+    {
+      site = &sites->other;
+    }
+
+found:
+  site->nchunks++;
+  site->nbytes += node->size;
+}
+
+/****************************************************************************
+ * Name: heapprof_format
+ ****************************************************************************/
+
+static size_t heapprof_format(FAR struct heapprof_file_s *attr)
+{
+  FAR struct heapprof_sites_s *sites = &attr->sites;
+  FAR struct mm_heap_s *heap;
+  struct heapprof_site_s tmp;
+  size_t len = 0;
+  int ndx;
+  int i;
+  int j;
+
+  for (ndx = 0; ndx < HEAPPROF_NHEAPS; ndx++)
+    {
+      heap = g_heapprof_heaps[ndx].heap;
+
+      memset(sites, 0, sizeof(struct heapprof_sites_s));
+      mm_profile(heap, heapprof_collect, sites);
+
+      /* Largest live size first */
+
+      for (i = 1; i < sites->nsites; i++)
+        {
+          tmp = sites->site[i];
+          for (j = i; j > 0 && sites->site[j - 1].nbytes < tmp.nbytes; j--)
+            {
+              sites->site[j] = sites->site[j - 1];
+            }
+
+          sites->site[j] = tmp;
+        }
+
+      len += snprintf(attr->buf + len, HEAPPROF_BUFLEN - len,
+                      "%s: allocs %lu frees %lu bytes %lu\n",
+                      g_heapprof_heaps[ndx].name,
+                      (unsigned long)heap->mm_nallocs,
+                      (unsigned long)heap->mm_nfrees,
+                      (unsigned long)heap->mm_allocbytes);
+      len += snprintf(attr->buf + len, HEAPPROF_BUFLEN - len,
+                      "  PID     CALLER   CHUNKS    BYTES\n");
+
+      for (i = 0; i < sites->nsites && len < HEAPPROF_BUFLEN; i++)
+        {
+          len += snprintf(attr->buf + len, HEAPPROF_BUFLEN - len,
+                          "%5d %10p %8lu %8lu\n",
+                          (int)sites->site[i].pid, sites->site[i].caller,
+                          (unsigned long)sites->site[i].nchunks,
+                          (unsigned long)sites->site[i].nbytes);
+        }
+
+      if (sites->other.nchunks > 0 && len < HEAPPROF_BUFLEN)
+        {
+          len += snprintf(attr->buf + len, HEAPPROF_BUFLEN - len,
+                          "    - %10s %8lu %8lu\n", "other",
+                          (unsigned long)sites->other.nchunks,
+                          (unsigned long)sites->other.nbytes);
+        }
+
+      if (len >= HEAPPROF_BUFLEN)
+        {
+          break;
+        }
+    }
+
+  return len < HEAPPROF_BUFLEN ? len : HEAPPROF_BUFLEN - 1;
+}
+
+/****************************************************************************
+ * Name: heapprof_open
+ ****************************************************************************/
+
+static int heapprof_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct heapprof_file_s *attr;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* "heapprof" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "heapprof") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = (FAR struct heapprof_file_s *)
+    kmm_zalloc(sizeof(struct heapprof_file_s));
+  if (!attr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: heapprof_close
+ ****************************************************************************/
+
+static int heapprof_close(FAR struct file *filep)
+{
+  FAR struct heapprof_file_s *attr;
+
+  attr = (FAR struct heapprof_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: heapprof_read
+ ****************************************************************************/
+
+static ssize_t heapprof_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+  FAR struct heapprof_file_s *attr;
+  off_t offset;
+  ssize_t ret;
+
+  attr = (FAR struct heapprof_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Take the snapshot on the first read so that it stays stable while it
+   * is read in pieces.
+   */
+
+  if (filep->f_pos == 0)
+    {
+      attr->len = heapprof_format(attr);
+    }
+
+  offset = filep->f_pos;
+  ret    = procfs_memcpy(attr->buf, attr->len, buffer, buflen, &offset);
+
+  if (ret > 0)
+    {
+      filep->f_pos += ret;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: heapprof_dup
+ ****************************************************************************/
+
+static int heapprof_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct heapprof_file_s *oldattr;
+  FAR struct heapprof_file_s *newattr;
+
+  oldattr = (FAR struct heapprof_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  newattr = (FAR struct heapprof_file_s *)
+    kmm_malloc(sizeof(struct heapprof_file_s));
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  memcpy(newattr, oldattr, sizeof(struct heapprof_file_s));
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: heapprof_stat
+ ****************************************************************************/
+
+static int heapprof_stat(const char *relpath, struct stat *buf)
+{
+  if (strcmp(relpath, "heapprof") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_MM_PROFILE && !CONFIG_FS_PROCFS_EXCLUDE_HEAPPROF */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
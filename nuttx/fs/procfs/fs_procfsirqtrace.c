@@ -0,0 +1,308 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsirqtrace.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/irqtrace.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_IRQSAVE_TRACE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_IRQTRACE)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Size of the formatted output: a header, one line per worst window and
+ * the latency summary.
+ */
+
+#define IRQTRACE_LINELEN  48
+#define IRQTRACE_BUFLEN   ((CONFIG_IRQSAVE_TRACE_NWORST + 4) * IRQTRACE_LINELEN)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct irqtrace_file_s
+{
+  struct procfs_file_s base;         /* Base open file structure */
+  size_t len;                        /* Number of valid characters in buf[] */
+  char buf[IRQTRACE_BUFLEN];         /* Snapshot taken on the first read */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     irqtrace_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     irqtrace_close(FAR struct file *filep);
+static ssize_t irqtrace_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+static ssize_t irqtrace_write(FAR struct file *filep, FAR const char *buffer,
+                 size_t buflen);
+
+static int     irqtrace_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     irqtrace_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there. */
+
+const struct procfs_operations irqtrace_operations =
+{
+  irqtrace_open,     /* open */
+  irqtrace_close,    /* close */
+  irqtrace_read,     /* read */
+  irqtrace_write,    /* write */
+
+  irqtrace_dup,      /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  irqtrace_stat      /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: irqtrace_format
+ ****************************************************************************/
+
+static size_t irqtrace_format(FAR char *buf)
+{
+  struct irqtrace_s trace;
+  size_t len;
+  int i;
+
+  irqtrace_get(&trace);
+
+  len = snprintf(buf, IRQTRACE_BUFLEN, "windows %lu\n",
+                 (unsigned long)trace.nwindows);
+  len += snprintf(buf + len, IRQTRACE_BUFLEN - len,
+                  "  cycles    irqsave    irqrestore\n");
+
+  for (i = 0; i < CONFIG_IRQSAVE_TRACE_NWORST && trace.worst[i].cycles; i++)
+    {
+      len += snprintf(buf + len, IRQTRACE_BUFLEN - len, "%8lu %p %p\n",
+                      (unsigned long)trace.worst[i].cycles,
+                      trace.worst[i].save_pc, trace.worst[i].restore_pc);
+    }
+
+  len += snprintf(buf + len, IRQTRACE_BUFLEN - len,
+                  "latency %lu samples max %lu avg %lu cycles\n",
+                  (unsigned long)trace.lat_count,
+                  (unsigned long)trace.lat_max,
+                  trace.lat_count ?
+                  (unsigned long)(trace.lat_total / trace.lat_count) : 0);
+
+  return len < IRQTRACE_BUFLEN ? len : IRQTRACE_BUFLEN - 1;
+}
+
+/****************************************************************************
+ * Name: irqtrace_open
+ ****************************************************************************/
+
+static int irqtrace_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct irqtrace_file_s *attr;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* "irqtrace" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "irqtrace") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = (FAR struct irqtrace_file_s *)kmm_zalloc(sizeof(struct irqtrace_file_s));
+  if (!attr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: irqtrace_close
+ ****************************************************************************/
+
+static int irqtrace_close(FAR struct file *filep)
+{
+  FAR struct irqtrace_file_s *attr;
+
+  attr = (FAR struct irqtrace_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: irqtrace_read
+ ****************************************************************************/
+
+static ssize_t irqtrace_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+  FAR struct irqtrace_file_s *attr;
+  off_t offset;
+  ssize_t ret;
+
+  attr = (FAR struct irqtrace_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Take the snapshot on the first read so that it stays stable while it
+   * is read in pieces.
+   */
+
+  if (filep->f_pos == 0)
+    {
+      attr->len = irqtrace_format(attr->buf);
+    }
+
+  offset = filep->f_pos;
+  ret    = procfs_memcpy(attr->buf, attr->len, buffer, buflen, &offset);
+
+  if (ret > 0)
+    {
+      filep->f_pos += ret;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: irqtrace_write
+ *
+ * Description:
+ *   Any write clears the results.
+ *
+ ****************************************************************************/
+
+static ssize_t irqtrace_write(FAR struct file *filep, FAR const char *buffer,
+                              size_t buflen)
+{
+  irqtrace_reset();
+  return buflen;
+}
+
+/****************************************************************************
+ * Name: irqtrace_dup
+ ****************************************************************************/
+
+static int irqtrace_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct irqtrace_file_s *oldattr;
+  FAR struct irqtrace_file_s *newattr;
+
+  oldattr = (FAR struct irqtrace_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  newattr = (FAR struct irqtrace_file_s *)kmm_malloc(sizeof(struct irqtrace_file_s));
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  memcpy(newattr, oldattr, sizeof(struct irqtrace_file_s));
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: irqtrace_stat
+ ****************************************************************************/
+
+static int irqtrace_stat(const char *relpath, struct stat *buf)
+{
+  if (strcmp(relpath, "irqtrace") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR|S_IWUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_IRQSAVE_TRACE && !CONFIG_FS_PROCFS_EXCLUDE_IRQTRACE */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -0,0 +1,300 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsmempool.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/mm/mempool.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_MM_MEMPOOL) && !defined(CONFIG_FS_PROCFS_EXCLUDE_MEMPOOL)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Size of the formatted output:  A header and one line per pool */
+
+#define POOLINFO_LINELEN 64
+#define POOLINFO_BUFLEN  \
+  ((CONFIG_FS_PROCFS_MEMPOOL_NPOOLS + 1) * POOLINFO_LINELEN)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct poolinfo_file_s
+{
+  struct procfs_file_s base;         /* Base open file structure */
+  size_t len;                        /* Number of valid characters in buf[] */
+  char buf[POOLINFO_BUFLEN];         /* Snapshot taken on the first read */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     poolinfo_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     poolinfo_close(FAR struct file *filep);
+static ssize_t poolinfo_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     poolinfo_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     poolinfo_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there. */
+
+const struct procfs_operations mempool_operations =
+{
+  poolinfo_open,     /* open */
+  poolinfo_close,    /* close */
+  poolinfo_read,     /* read */
+  NULL,              /* write */
+
+  poolinfo_dup,      /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  poolinfo_stat      /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: poolinfo_collect
+ *
+ * Description:
+ *   mempool_foreach() callback:  Format the line of one pool.
+ *
+ ****************************************************************************/
+
+static void poolinfo_collect(FAR const struct mempool_s *pool,
+                             FAR void *arg)
+{
+  FAR struct poolinfo_file_s *attr = (FAR struct poolinfo_file_s *)arg;
+
+  if (attr->len < POOLINFO_BUFLEN)
+    {
+      attr->len += snprintf(attr->buf + attr->len,
+                            POOLINFO_BUFLEN - attr->len,
+                            "%-12.12s %5u %5u %5u %5u %8lu %6lu\n",
+                            pool->name ? pool->name : "-",
+                            (unsigned int)pool->bsize,
+                            (unsigned int)pool->nblocks,
+                            (unsigned int)pool->nused,
+                            (unsigned int)pool->peak,
+                            (unsigned long)pool->nalloc,
+                            (unsigned long)pool->nfail);
+    }
+}
+
+/****************************************************************************
+ * Name: poolinfo_format
+ ****************************************************************************/
+
+static size_t poolinfo_format(FAR struct poolinfo_file_s *attr)
+{
+  attr->len = snprintf(attr->buf, POOLINFO_BUFLEN, "%-12s %5s %5s %5s %5s "
+                       "%8s %6s\n", "NAME", "BSIZE", "TOTAL", "USED", "PEAK",
+                       "ALLOCS", "FAILS");
+
+  mempool_foreach(poolinfo_collect, attr);
+  return attr->len < POOLINFO_BUFLEN ? attr->len : POOLINFO_BUFLEN - 1;
+}
+
+/****************************************************************************
+ * Name: poolinfo_open
+ ****************************************************************************/
+
+static int poolinfo_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct poolinfo_file_s *attr;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* "mempool" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "mempool") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = (FAR struct poolinfo_file_s *)
+    kmm_zalloc(sizeof(struct poolinfo_file_s));
+  if (!attr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: poolinfo_close
+ ****************************************************************************/
+
+static int poolinfo_close(FAR struct file *filep)
+{
+  FAR struct poolinfo_file_s *attr;
+
+  attr = (FAR struct poolinfo_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: poolinfo_read
+ ****************************************************************************/
+
+static ssize_t poolinfo_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+  FAR struct poolinfo_file_s *attr;
+  off_t offset;
+  ssize_t ret;
+
+  attr = (FAR struct poolinfo_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Take the snapshot on the first read so that it stays stable while it
+   * is read in pieces.
+   */
+
+  if (filep->f_pos == 0)
+    {
+      attr->len = poolinfo_format(attr);
+    }
+
+  offset = filep->f_pos;
+  ret    = procfs_memcpy(attr->buf, attr->len, buffer, buflen, &offset);
+
+  if (ret > 0)
+    {
+      filep->f_pos += ret;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: poolinfo_dup
+ ****************************************************************************/
+
+static int poolinfo_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct poolinfo_file_s *oldattr;
+  FAR struct poolinfo_file_s *newattr;
+
+  oldattr = (FAR struct poolinfo_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  newattr = (FAR struct poolinfo_file_s *)
+    kmm_malloc(sizeof(struct poolinfo_file_s));
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  memcpy(newattr, oldattr, sizeof(struct poolinfo_file_s));
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: poolinfo_stat
+ ****************************************************************************/
+
+static int poolinfo_stat(const char *relpath, struct stat *buf)
+{
+  if (strcmp(relpath, "mempool") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_MM_MEMPOOL && !CONFIG_FS_PROCFS_EXCLUDE_MEMPOOL */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
@@ -92,6 +92,9 @@ enum proc_node_e
   PROC_CMDLINE,                       /* Task command line */
 #ifdef CONFIG_SCHED_CPULOAD
   PROC_LOADAVG,                       /* Average CPU utilization */
+#endif
+#ifdef CONFIG_USEC_MEASURE_PERF
+  PROC_PERF,                          /* uSec CPU accounting */
 #endif
   PROC_STACK,                         /* Task stack info */
   PROC_GROUP,                         /* Group directory */
@@ -148,6 +151,11 @@ static ssize_t proc_loadavg(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
 #endif
+#ifdef CONFIG_USEC_MEASURE_PERF
+static ssize_t proc_perf(FAR struct proc_file_s *procfile,
+                 FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
+                 off_t offset);
+#endif
 static ssize_t proc_stack(FAR struct proc_file_s *procfile,
                  FAR struct tcb_s *tcb, FAR char *buffer, size_t buflen,
                  off_t offset);
@@ -230,6 +238,13 @@ static const struct proc_node_s g_loadavg =
 };
 #endif
 
+#ifdef CONFIG_USEC_MEASURE_PERF
+static const struct proc_node_s g_perf =
+{
+  "perf",         "perf",    (uint8_t)PROC_PERF,         DTYPE_FILE        /* uSec CPU accounting */
+};
+#endif
+
 static const struct proc_node_s g_stack =
 {
   "stack",        "stack",   (uint8_t)PROC_STACK,        DTYPE_FILE        /* Task stack info */
@@ -258,6 +273,9 @@ static FAR const struct proc_node_s * const g_nodeinfo[] =
   &g_cmdline,      /* Task command line */
 #ifdef CONFIG_SCHED_CPULOAD
   &g_loadavg,      /* Average CPU utilization */
+#endif
+#ifdef CONFIG_USEC_MEASURE_PERF
+  &g_perf,         /* uSec CPU accounting */
 #endif
   &g_stack,        /* Task stack info */
   &g_group,        /* Group directory */
@@ -274,6 +292,9 @@ static const struct proc_node_s * const g_level0info[] =
   &g_cmdline,      /* Task command line */
 #ifdef CONFIG_SCHED_CPULOAD
   &g_loadavg,      /* Average CPU utilization */
+#endif
+#ifdef CONFIG_USEC_MEASURE_PERF
+  &g_perf,         /* uSec CPU accounting */
 #endif
   &g_stack,        /* Task stack info */
   &g_group,        /* Group directory */
@@ -590,6 +611,57 @@ static ssize_t proc_loadavg(FAR struct proc_file_s *procfile,
 }
 #endif
 
+/****************************************************************************
+ * Name: proc_perf
+ ****************************************************************************/
+
+#ifdef CONFIG_USEC_MEASURE_PERF
+static ssize_t proc_perf(FAR struct proc_file_s *procfile,
+                         FAR struct tcb_s *tcb, FAR char *buffer,
+                         size_t buflen, off_t offset)
+{
+  static FAR const char *names[4] =
+  {
+    "RunTime:", "VolSwitch:", "InvSwitch:", "LockTime:"
+  };
+
+  struct perf_stats_s perf;
+  uint32_t values[4];
+  size_t remaining;
+  size_t linesize;
+  size_t copysize;
+  size_t totalsize;
+  int i;
+
+  /* As with loadavg, the thread may have exited since it was opened */
+
+  memset(&perf, 0, sizeof(perf));
+  (void)sched_perf_stats(procfile->pid, &perf);
+
+  values[0] = perf.run_time;
+  values[1] = perf.nvcsw;
+  values[2] = perf.nivcsw;
+  values[3] = perf.lock_time;
+
+  remaining = buflen;
+  totalsize = 0;
+
+  for (i = 0; i < 4 && totalsize < buflen; i++)
+    {
+      linesize   = snprintf(procfile->line, STATUS_LINELEN, "%-12s%lu\n",
+                            names[i], (unsigned long)values[i]);
+      copysize   = procfs_memcpy(procfile->line, linesize, buffer, remaining,
+                                 &offset);
+
+      totalsize += copysize;
+      buffer    += copysize;
+      remaining -= copysize;
+    }
+
+  return totalsize;
+}
+#endif
+
 /****************************************************************************
  * Name: proc_stack
  ****************************************************************************/
@@ -1063,6 +1135,11 @@ static ssize_t proc_read(FAR struct file *filep, FAR char *buffer,
     case PROC_LOADAVG: /* Average CPU utilization */
       ret = proc_loadavg(procfile, tcb, buffer, buflen, filep->f_pos);
       break;
+#endif
+#ifdef CONFIG_USEC_MEASURE_PERF
+    case PROC_PERF: /* uSec CPU accounting */
+      ret = proc_perf(procfile, tcb, buffer, buflen, filep->f_pos);
+      break;
 #endif
     case PROC_STACK: /* Task stack info */
       ret = proc_stack(procfile, tcb, buffer, buflen, filep->f_pos);
@@ -0,0 +1,351 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsprofile.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/profile.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_SCHED_PROFILE) && !defined(CONFIG_FS_PROCFS_EXCLUDE_PROFILE)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The table can be large, so it is formatted one line at a time as it is
+ * read rather than in one snapshot.
+ */
+
+#define PROFILE_LINELEN  80
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct profile_file_s
+{
+  struct procfs_file_s base;         /* Base open file structure */
+  unsigned int cursor;               /* Next entry of the profile table */
+  size_t pos;                        /* First character of line[] to copy */
+  size_t len;                        /* Number of valid characters in line[] */
+  char line[PROFILE_LINELEN];        /* Line being read */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     profile_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     profile_close(FAR struct file *filep);
+static ssize_t profile_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+static ssize_t profile_write(FAR struct file *filep, FAR const char *buffer,
+                 size_t buflen);
+
+static int     profile_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     profile_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there. */
+
+const struct procfs_operations profile_operations =
+{
+  profile_open,      /* open */
+  profile_close,     /* close */
+  profile_read,      /* read */
+  profile_write,     /* write */
+
+  profile_dup,       /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  profile_stat       /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: profile_header
+ *
+ * Description:
+ *   The header lines start with '#' so that the host side tool can skip
+ *   them.
+ *
+ ****************************************************************************/
+
+static size_t profile_header(FAR char *buf)
+{
+  struct profile_status_s status;
+
+  profile_status(&status);
+  return snprintf(buf, PROFILE_LINELEN,
+                  "# %s rate %lu samples %lu dropped %lu entries %lu\n",
+                  status.running ? "running" : "stopped",
+                  (unsigned long)status.rate,
+                  (unsigned long)status.nsamples,
+                  (unsigned long)status.ndropped,
+                  (unsigned long)status.nentries);
+}
+
+/****************************************************************************
+ * Name: profile_open
+ ****************************************************************************/
+
+static int profile_open(FAR struct file *filep, FAR const char *relpath,
+                        int oflags, mode_t mode)
+{
+  FAR struct profile_file_s *attr;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* "profile" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "profile") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = (FAR struct profile_file_s *)
+    kmm_zalloc(sizeof(struct profile_file_s));
+  if (!attr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: profile_close
+ ****************************************************************************/
+
+static int profile_close(FAR struct file *filep)
+{
+  FAR struct profile_file_s *attr;
+
+  attr = (FAR struct profile_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: profile_read
+ *
+ * Description:
+ *   After the header, one line "<pc> <lr> <count>" per sampled location,
+ *   in hexadecimal for the addresses.
+ *
+ ****************************************************************************/
+
+static ssize_t profile_read(FAR struct file *filep, FAR char *buffer,
+                            size_t buflen)
+{
+  FAR struct profile_file_s *attr;
+  struct profile_entry_s entry;
+  size_t copied = 0;
+  size_t n;
+
+  attr = (FAR struct profile_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  if (filep->f_pos == 0)
+    {
+      attr->cursor = 0;
+      attr->pos    = 0;
+      attr->len    = profile_header(attr->line);
+    }
+
+  while (copied < buflen)
+    {
+      if (attr->pos >= attr->len)
+        {
+          if (profile_next(&attr->cursor, &entry) < 0)
+            {
+              break;
+            }
+
+          attr->pos = 0;
+          attr->len = snprintf(attr->line, PROFILE_LINELEN,
+                               "%08lx %08lx %lu\n",
+                               (unsigned long)(uintptr_t)entry.pc,
+                               (unsigned long)(uintptr_t)entry.lr,
+                               (unsigned long)entry.count);
+          continue;
+        }
+
+      n = attr->len - attr->pos;
+      if (n > buflen - copied)
+        {
+          n = buflen - copied;
+        }
+
+      memcpy(buffer + copied, attr->line + attr->pos, n);
+      attr->pos += n;
+      copied    += n;
+    }
+
+  filep->f_pos += copied;
+  return copied;
+}
+
+/****************************************************************************
+ * Name: profile_write
+ *
+ * Description:
+ *   "start" starts or resumes the sampling, "stop" stops it and "reset"
+ *   clears the results.
+ *
+ ****************************************************************************/
+
+static ssize_t profile_write(FAR struct file *filep, FAR const char *buffer,
+                             size_t buflen)
+{
+  size_t len = buflen;
+  int ret = OK;
+
+  while (len > 0 && (buffer[len - 1] == '\n' || buffer[len - 1] == ' '))
+    {
+      len--;
+    }
+
+  if (len == 5 && strncmp(buffer, "start", 5) == 0)
+    {
+      ret = profile_start();
+    }
+  else if (len == 4 && strncmp(buffer, "stop", 4) == 0)
+    {
+      profile_stop();
+    }
+  else if (len == 5 && strncmp(buffer, "reset", 5) == 0)
+    {
+      profile_reset();
+    }
+  else
+    {
+      ret = -EINVAL;
+    }
+
+  return ret < 0 ? ret : buflen;
+}
+
+/****************************************************************************
+ * Name: profile_dup
+ ****************************************************************************/
+
+static int profile_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct profile_file_s *oldattr;
+  FAR struct profile_file_s *newattr;
+
+  oldattr = (FAR struct profile_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  newattr = (FAR struct profile_file_s *)
+    kmm_malloc(sizeof(struct profile_file_s));
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  memcpy(newattr, oldattr, sizeof(struct profile_file_s));
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: profile_stat
+ ****************************************************************************/
+
+static int profile_stat(const char *relpath, struct stat *buf)
+{
+  if (strcmp(relpath, "profile") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR|S_IWUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_SCHED_PROFILE && !CONFIG_FS_PROCFS_EXCLUDE_PROFILE */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
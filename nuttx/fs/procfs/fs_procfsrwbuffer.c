@@ -0,0 +1,310 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsrwbuffer.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/kmalloc.h>
+#include <nuttx/rwbuffer.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS)
+#if defined(CONFIG_DRVR_RWBSTATS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_RWBUFFER)
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Size of the formatted output:  A header and one line per buffer */
+
+#define RWBINFO_LINELEN 96
+#define RWBINFO_BUFLEN  \
+  ((CONFIG_FS_PROCFS_RWBUFFER_NBUFFERS + 1) * RWBINFO_LINELEN)
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* This structure describes one open "file" */
+
+struct rwbinfo_file_s
+{
+  struct procfs_file_s base;         /* Base open file structure */
+  size_t len;                        /* Number of valid characters in buf[] */
+  char buf[RWBINFO_BUFLEN];          /* Snapshot taken on the first read */
+};
+
+/****************************************************************************
+ * Private Function Prototypes
+ ****************************************************************************/
+
+/* File system methods */
+
+static int     rwbinfo_open(FAR struct file *filep, FAR const char *relpath,
+                 int oflags, mode_t mode);
+static int     rwbinfo_close(FAR struct file *filep);
+static ssize_t rwbinfo_read(FAR struct file *filep, FAR char *buffer,
+                 size_t buflen);
+
+static int     rwbinfo_dup(FAR const struct file *oldp,
+                 FAR struct file *newp);
+
+static int     rwbinfo_stat(FAR const char *relpath, FAR struct stat *buf);
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* See fs_procfs.c -- this structure is explicitly externed there. */
+
+const struct procfs_operations rwbuffer_operations =
+{
+  rwbinfo_open,      /* open */
+  rwbinfo_close,     /* close */
+  rwbinfo_read,      /* read */
+  NULL,              /* write */
+
+  rwbinfo_dup,       /* dup */
+
+  NULL,              /* opendir */
+  NULL,              /* closedir */
+  NULL,              /* readdir */
+  NULL,              /* rewinddir */
+
+  rwbinfo_stat       /* stat */
+};
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: rwbinfo_collect
+ *
+ * Description:
+ *   rwb_foreach() callback:  Format the line of one buffer.
+ *
+ ****************************************************************************/
+
+static void rwbinfo_collect(FAR const struct rwbuffer_s *rwb, FAR void *arg)
+{
+  FAR struct rwbinfo_file_s *attr = (FAR struct rwbinfo_file_s *)arg;
+  unsigned int window;
+
+#ifdef CONFIG_DRVR_READAHEAD_ADAPTIVE
+  window = rwb->rhwindow;
+#elif defined(CONFIG_DRVR_READAHEAD)
+  window = rwb->rhmaxblocks;
+#else
+  window = 0;
+#endif
+
+  if (attr->len < RWBINFO_BUFLEN)
+    {
+      attr->len += snprintf(attr->buf + attr->len,
+                            RWBINFO_BUFLEN - attr->len,
+                            "%-10p %5u %8lu %8lu %7lu %6u %8lu %7lu %6lu\n",
+                            rwb->dev,
+                            (unsigned int)rwb->blocksize,
+                            (unsigned long)rwb->nblocks,
+                            (unsigned long)rwb->rhhits,
+                            (unsigned long)rwb->rhloads,
+                            window,
+                            (unsigned long)rwb->wrblocks,
+                            (unsigned long)rwb->wrflushes,
+                            (unsigned long)rwb->wrwaits);
+    }
+}
+
+/****************************************************************************
+ * Name: rwbinfo_format
+ ****************************************************************************/
+
+static size_t rwbinfo_format(FAR struct rwbinfo_file_s *attr)
+{
+  attr->len = snprintf(attr->buf, RWBINFO_BUFLEN, "%-10s %5s %8s %8s %7s "
+                       "%6s %8s %7s %6s\n", "DEV", "BSIZE", "NBLOCKS",
+                       "RHHITS", "RHLOADS", "WINDOW", "WRBLOCKS", "FLUSHES",
+                       "WAITS");
+
+  rwb_foreach(rwbinfo_collect, attr);
+  return attr->len < RWBINFO_BUFLEN ? attr->len : RWBINFO_BUFLEN - 1;
+}
+/****************************************************************************
+ * Name: rwbinfo_open
+ ****************************************************************************/
+
+static int rwbinfo_open(FAR struct file *filep, FAR const char *relpath,
+                         int oflags, mode_t mode)
+{
+  FAR struct rwbinfo_file_s *attr;
+
+  fvdbg("Open '%s'\n", relpath);
+
+  /* "fs/rwbuffer" is the only acceptable value for the relpath */
+
+  if (strcmp(relpath, "fs/rwbuffer") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  /* Allocate a container to hold the file attributes */
+
+  attr = (FAR struct rwbinfo_file_s *)
+    kmm_zalloc(sizeof(struct rwbinfo_file_s));
+  if (!attr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  /* Save the attributes as the open-specific state in filep->f_priv */
+
+  filep->f_priv = (FAR void *)attr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: rwbinfo_close
+ ****************************************************************************/
+
+static int rwbinfo_close(FAR struct file *filep)
+{
+  FAR struct rwbinfo_file_s *attr;
+
+  attr = (FAR struct rwbinfo_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  kmm_free(attr);
+  filep->f_priv = NULL;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: rwbinfo_read
+ ****************************************************************************/
+
+static ssize_t rwbinfo_read(FAR struct file *filep, FAR char *buffer,
+                             size_t buflen)
+{
+  FAR struct rwbinfo_file_s *attr;
+  off_t offset;
+  ssize_t ret;
+
+  attr = (FAR struct rwbinfo_file_s *)filep->f_priv;
+  DEBUGASSERT(attr);
+
+  /* Take the snapshot on the first read so that it stays stable while it
+   * is read in pieces.
+   */
+
+  if (filep->f_pos == 0)
+    {
+      attr->len = rwbinfo_format(attr);
+    }
+
+  offset = filep->f_pos;
+  ret    = procfs_memcpy(attr->buf, attr->len, buffer, buflen, &offset);
+
+  if (ret > 0)
+    {
+      filep->f_pos += ret;
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: rwbinfo_dup
+ ****************************************************************************/
+
+static int rwbinfo_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+  FAR struct rwbinfo_file_s *oldattr;
+  FAR struct rwbinfo_file_s *newattr;
+
+  oldattr = (FAR struct rwbinfo_file_s *)oldp->f_priv;
+  DEBUGASSERT(oldattr);
+
+  newattr = (FAR struct rwbinfo_file_s *)
+    kmm_malloc(sizeof(struct rwbinfo_file_s));
+  if (!newattr)
+    {
+      fdbg("ERROR: Failed to allocate file attributes\n");
+      return -ENOMEM;
+    }
+
+  memcpy(newattr, oldattr, sizeof(struct rwbinfo_file_s));
+  newp->f_priv = (FAR void *)newattr;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: rwbinfo_stat
+ ****************************************************************************/
+
+static int rwbinfo_stat(const char *relpath, struct stat *buf)
+{
+  if (strcmp(relpath, "fs/rwbuffer") != 0)
+    {
+      fdbg("ERROR: relpath is '%s'\n", relpath);
+      return -ENOENT;
+    }
+
+  buf->st_mode    = S_IFREG|S_IROTH|S_IRGRP|S_IRUSR;
+  buf->st_size    = 0;
+  buf->st_blksize = 0;
+  buf->st_blocks  = 0;
+  return OK;
+}
+
+#endif /* CONFIG_DRVR_RWBSTATS && !CONFIG_FS_PROCFS_EXCLUDE_RWBUFFER */
+#endif /* !CONFIG_DISABLE_MOUNTPOINT && CONFIG_FS_PROCFS */
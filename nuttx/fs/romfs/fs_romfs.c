@@ -316,7 +316,7 @@ static int romfs_close(FAR struct file *filep)
    * accesses.
    */
 
-  if (!rm->rm_xipbase && rf->rf_buffer)
+  if (!rm->rm_xipbase && !ROMFS_ISCOMPRESSED(rf) && rf->rf_buffer)
     {
       kmm_free(rf->rf_buffer);
     }
@@ -340,6 +340,7 @@ static ssize_t romfs_read(FAR struct file *filep, FAR char *buffer,
   unsigned int                bytesread;
   unsigned int                readsize;
   unsigned int                nsectors;
+  unsigned int                sectorsize;
   uint32_t                    offset;
   size_t                      bytesleft;
   off_t                       sector;
@@ -395,6 +396,7 @@ static ssize_t romfs_read(FAR struct file *filep, FAR char *buffer,
       offset     = rf->rf_startoffset + filep->f_pos;
       sector     = SEC_NSECTORS(rm, offset);
       sectorndx  = offset & SEC_NDXMASK(rm);
+      sectorsize = rm->rm_hwsectorsize;
       bytesread  = 0;
 
       /* Check if the user has provided a buffer large enough to
@@ -403,6 +405,19 @@ static ssize_t romfs_read(FAR struct file *filep, FAR char *buffer,
        */
 
       nsectors = SEC_NSECTORS(rm, buflen);
+
+      /* Compressed files are always read through the decompressed block
+       * cache, one block of the file at a time.
+       */
+
+      if (ROMFS_ISCOMPRESSED(rf))
+        {
+          sector     = filep->f_pos / ROMFS_ZBLOCKSIZE;
+          sectorndx  = filep->f_pos & (ROMFS_ZBLOCKSIZE - 1);
+          sectorsize = ROMFS_ZBLOCKSIZE;
+          nsectors   = 0;
+        }
+
       if (nsectors > 0 && sectorndx == 0)
         {
           /* Read maximum contiguous sectors directly to the user's
@@ -439,7 +454,7 @@ static ssize_t romfs_read(FAR struct file *filep, FAR char *buffer,
 
           /* Copy the partial sector into the user buffer */
 
-          bytesread = rm->rm_hwsectorsize - sectorndx;
+          bytesread = sectorsize - sectorndx;
           if (bytesread > buflen)
             {
               /* We will not read to the end of the buffer */
@@ -577,9 +592,11 @@ static int romfs_ioctl(FAR struct file *filep, int cmd, unsigned long arg)
 
   DEBUGASSERT(rm != NULL);
 
-  /* Only one ioctl command is supported */
+  /* Only one ioctl command is supported.  The data of compressed files
+   * cannot be mapped.
+   */
 
-  if (cmd == FIOC_MMAP && rm->rm_xipbase && ppv)
+  if (cmd == FIOC_MMAP && rm->rm_xipbase && !ROMFS_ISCOMPRESSED(rf) && ppv)
     {
       /* Return the address on the media corresponding to the start of
        * the file.
@@ -1035,6 +1052,8 @@ static int romfs_unbind(FAR void *handle, FAR struct inode **blkdriver)
           kmm_free(rm->rm_buffer);
         }
 
+      romfs_zuninit(rm);
+
       sem_destroy(&rm->rm_sem);
       kmm_free(rm);
       return OK;
@@ -125,10 +125,46 @@
 
 #define ROMF_MAX_LINKS 64
 
+/* Compressed file data (multi-byte values are big-endian).  The data of a
+ * compressed file begins with this header, followed by nblocks+1 offsets
+ * (relative to the start of the file data) that delimit the compressed
+ * blocks.  Each block holds ROMFS_ZBLOCKSIZE bytes of the file (the last
+ * one may hold less) as an LZ4 block, or as plain data if the compressed
+ * length equals the uncompressed length.  The file header size is the
+ * uncompressed size of the file.
+ */
+
+#define ROMFS_ZHDR_MAGIC     0  /*  0-7:  "-romfsz-" */
+#define ROMFS_ZHDR_BLOCKSIZE 8  /*  8-11: Uncompressed block size */
+#define ROMFS_ZHDR_NBLOCKS  12  /* 12-15: Number of blocks */
+#define ROMFS_ZHDR_TABLE    16  /* 16-..: Block offset table */
+
+#define ROMFS_ZMAGIC        "-romfsz-"
+#define ROMFS_ZBLOCKSIZE    4096
+
+#ifdef CONFIG_FS_ROMFS_COMPRESSED
+#  define ROMFS_ISCOMPRESSED(rf) ((rf)->rf_zblocks > 0)
+#else
+#  define ROMFS_ISCOMPRESSED(rf) (false)
+#  define romfs_zuninit(rm)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+#ifdef CONFIG_FS_ROMFS_COMPRESSED
+/* One decompressed block in the mountpoint's block cache */
+
+struct romfs_zcache_s
+{
+  uint32_t zc_file;                 /* rf_startoffset of the file */
+  uint32_t zc_block;                /* Block number within the file */
+  uint32_t zc_stamp;                /* Time of last use, zero if unused */
+  uint8_t *zc_data;                 /* Decompressed data */
+};
+#endif
+
 /* This structure represents the overall mountpoint state.  An instance of this
  * structure is retained as inode private data on each mountpoint that is
  * mounted with a fat32 filesystem.
@@ -149,6 +185,11 @@ struct romfs_mountpt_s
   uint32_t rm_cachesector;          /* Current sector in the rm_buffer */
   uint8_t *rm_xipbase;              /* Base address of directly accessible media */
   uint8_t *rm_buffer;               /* Device sector buffer, allocated if rm_xipbase==0 */
+#ifdef CONFIG_FS_ROMFS_COMPRESSED
+  uint32_t rm_zclock;               /* Incremented on each block cache access */
+  uint8_t *rm_zbuffer;              /* Compressed block buffer, allocated if rm_xipbase==0 */
+  struct romfs_zcache_s rm_zcache[CONFIG_FS_ROMFS_ZCACHE_NBLOCKS];
+#endif
 };
 
 /* This structure represents on open file under the mountpoint.  An instance
@@ -163,6 +204,9 @@ struct romfs_file_s
   uint32_t rf_size;                 /* Size of the file in bytes */
   uint32_t rf_cachesector;          /* Current sector in the rf_buffer */
   uint8_t *rf_buffer;               /* File sector buffer, allocated if rm_xipbase==0 */
+#ifdef CONFIG_FS_ROMFS_COMPRESSED
+  uint32_t rf_zblocks;              /* Number of compressed blocks, zero if not compressed */
+#endif
 };
 
 /* This structure is used internally for describing the result of
@@ -221,6 +265,11 @@ EXTERN int  romfs_parsefilename(struct romfs_mountpt_s *rm, uint32_t offset,
                   char *pname);
 EXTERN int  romfs_datastart(struct romfs_mountpt_s *rm, uint32_t offset,
                   uint32_t *start);
+#ifdef CONFIG_FS_ROMFS_COMPRESSED
+EXTERN void romfs_zuninit(struct romfs_mountpt_s *rm);
+EXTERN int  romfs_lz4decode(const uint8_t *src, size_t srclen,
+                  uint8_t *dest, size_t destlen);
+#endif
 
 #undef EXTERN
 #if defined(__cplusplus)
@@ -0,0 +1,178 @@
+/****************************************************************************
+ * fs/romfs/fs_romfslz4.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include "fs_romfs.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: romfs_lz4length
+ *
+ * Desciption:
+ *   Add the extension bytes of an LZ4 literal or match length to len.
+ *
+ ****************************************************************************/
+
+static int romfs_lz4length(const uint8_t **pip, const uint8_t *iend,
+                           size_t *len)
+{
+  const uint8_t *ip = *pip;
+  uint8_t byte;
+
+  do
+    {
+      if (ip >= iend)
+        {
+          return -EIO;
+        }
+
+      byte  = *ip++;
+      *len += byte;
+    }
+  while (byte == 255);
+
+  *pip = ip;
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: romfs_lz4decode
+ *
+ * Desciption:
+ *   Decompress one LZ4 block (the raw block format, no frame header) of
+ *   srclen bytes into dest.  Every sequence is bounds checked, a corrupted
+ *   image produces -EIO rather than a write outside of dest.
+ *
+ * Returned Value:
+ *   The number of bytes decompressed or a negated errno value.
+ *
+ ****************************************************************************/
+
+int romfs_lz4decode(const uint8_t *src, size_t srclen, uint8_t *dest,
+                    size_t destlen)
+{
+  const uint8_t *ip   = src;
+  const uint8_t *iend = src + srclen;
+  const uint8_t *match;
+  uint8_t *op         = dest;
+  uint8_t *oend       = dest + destlen;
+  size_t offset;
+  size_t len;
+  uint8_t token;
+
+  for (;;)
+    {
+      if (ip >= iend)
+        {
+          return -EIO;
+        }
+
+      /* Copy the literals */
+
+      token = *ip++;
+      len   = token >> 4;
+      if (len == 15 && romfs_lz4length(&ip, iend, &len) < 0)
+        {
+          return -EIO;
+        }
+
+      if (len > (size_t)(iend - ip) || len > (size_t)(oend - op))
+        {
+          return -EIO;
+        }
+
+      memcpy(op, ip, len);
+      ip += len;
+      op += len;
+
+      /* The last sequence of a block has only literals */
+
+      if (ip == iend)
+        {
+          break;
+        }
+
+      /* Copy the match, which may overlap the output */
+
+      if (iend - ip < 2)
+        {
+          return -EIO;
+        }
+
+      offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+      ip    += 2;
+
+      if (offset == 0 || offset > (size_t)(op - dest))
+        {
+          return -EIO;
+        }
+
+      len = token & 15;
+      if (len == 15 && romfs_lz4length(&ip, iend, &len) < 0)
+        {
+          return -EIO;
+        }
+
+      len += 4;
+      if (len > (size_t)(oend - op))
+        {
+          return -EIO;
+        }
+
+      match = op - offset;
+      while (len-- > 0)
+        {
+          *op++ = *match++;
+        }
+    }
+
+  return op - dest;
+}
@@ -359,6 +359,210 @@ static inline int romfs_searchdir(struct romfs_mountpt_s *rm,
    return -ENOENT;
 }
 
+#ifdef CONFIG_FS_ROMFS_COMPRESSED
+/****************************************************************************
+ * Name: romfs_zconfigure
+ *
+ * Desciption:
+ *   Check if the data of the file begins with a compressed file header.  If
+ *   so, set up the file for block decompression.
+ *
+ ****************************************************************************/
+
+static int romfs_zconfigure(struct romfs_mountpt_s *rm,
+                            struct romfs_file_s *rf)
+{
+  uint32_t nblocks;
+  int16_t  ndx;
+
+  rf->rf_zblocks = 0;
+
+  /* The header is 16-byte aligned so it lies within one sector */
+
+  if (rf->rf_size < ROMFS_ZHDR_TABLE)
+    {
+      return OK;
+    }
+
+  ndx = romfs_devcacheread(rm, rf->rf_startoffset);
+  if (ndx < 0)
+    {
+      return ndx;
+    }
+
+  if (memcmp(&rm->rm_buffer[ndx + ROMFS_ZHDR_MAGIC], ROMFS_ZMAGIC, 8) != 0)
+    {
+      return OK;
+    }
+
+  nblocks = romfs_devread32(rm, ndx + ROMFS_ZHDR_NBLOCKS);
+  if (romfs_devread32(rm, ndx + ROMFS_ZHDR_BLOCKSIZE) != ROMFS_ZBLOCKSIZE ||
+      nblocks != (rf->rf_size + ROMFS_ZBLOCKSIZE - 1) / ROMFS_ZBLOCKSIZE)
+    {
+      fdbg("Bad compressed file header\n");
+      return -EINVAL;
+    }
+
+  /* In non-XIP mode, compressed blocks are read into a buffer first.  A
+   * block is never longer than ROMFS_ZBLOCKSIZE but may start anywhere in
+   * a sector.
+   */
+
+  if (!rm->rm_xipbase && !rm->rm_zbuffer)
+    {
+      rm->rm_zbuffer = (uint8_t*)kmm_malloc(ROMFS_ZBLOCKSIZE +
+                                            2 * rm->rm_hwsectorsize);
+      if (!rm->rm_zbuffer)
+        {
+          return -ENOMEM;
+        }
+    }
+
+  rf->rf_zblocks = nblocks;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: romfs_zcacheread
+ *
+ * Desciption:
+ *   Make rf->rf_buffer refer to the decompressed data of the specified
+ *   block, decompressing it into the least recently used cache entry if it
+ *   is not already cached.
+ *
+ ****************************************************************************/
+
+static int romfs_zcacheread(struct romfs_mountpt_s *rm,
+                            struct romfs_file_s *rf, uint32_t block)
+{
+  struct romfs_zcache_s *zc;
+  struct romfs_zcache_s *victim;
+  const uint8_t *src;
+  uint32_t start;
+  uint32_t end;
+  uint32_t ulen;
+  uint32_t sector;
+  int16_t  ndx;
+  int      ret;
+  int      i;
+
+  if (block >= rf->rf_zblocks)
+    {
+      return -EINVAL;
+    }
+
+  /* Look for the block in the cache.  Blocks of other files and of other
+   * open instances of this file may have evicted it since the last access,
+   * so rf_cachesector alone cannot be trusted.
+   */
+
+  victim = &rm->rm_zcache[0];
+  for (i = 0; i < CONFIG_FS_ROMFS_ZCACHE_NBLOCKS; i++)
+    {
+      zc = &rm->rm_zcache[i];
+      if (zc->zc_stamp != 0 && zc->zc_file == rf->rf_startoffset &&
+          zc->zc_block == block)
+        {
+          zc->zc_stamp       = ++rm->rm_zclock;
+          rf->rf_buffer      = zc->zc_data;
+          rf->rf_cachesector = block;
+          return OK;
+        }
+
+      if (zc->zc_stamp < victim->zc_stamp)
+        {
+          victim = zc;
+        }
+    }
+
+  /* Not cached.  Get the location of the compressed block. */
+
+  ndx = romfs_devcacheread(rm, rf->rf_startoffset + ROMFS_ZHDR_TABLE +
+                           4 * block);
+  if (ndx < 0)
+    {
+      return ndx;
+    }
+
+  start = romfs_devread32(rm, ndx);
+
+  ndx = romfs_devcacheread(rm, rf->rf_startoffset + ROMFS_ZHDR_TABLE +
+                           4 * (block + 1));
+  if (ndx < 0)
+    {
+      return ndx;
+    }
+
+  end  = romfs_devread32(rm, ndx);
+  ulen = rf->rf_size - block * ROMFS_ZBLOCKSIZE;
+  if (ulen > ROMFS_ZBLOCKSIZE)
+    {
+      ulen = ROMFS_ZBLOCKSIZE;
+    }
+
+  if (end <= start || end - start > ulen)
+    {
+      fdbg("Bad compressed block %d: %d-%d\n", block, start, end);
+      return -EIO;
+    }
+
+  start += rf->rf_startoffset;
+  end   += rf->rf_startoffset;
+
+  /* Get the compressed data */
+
+  if (rm->rm_xipbase)
+    {
+      src = rm->rm_xipbase + start;
+    }
+  else
+    {
+      sector = SEC_NSECTORS(rm, start);
+      ret    = romfs_hwread(rm, rm->rm_zbuffer, sector,
+                            SEC_NSECTORS(rm, end - 1) - sector + 1);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      src = rm->rm_zbuffer + (start & SEC_NDXMASK(rm));
+    }
+
+  /* Decompress it into the least recently used cache entry */
+
+  if (!victim->zc_data)
+    {
+      victim->zc_data = (uint8_t*)kmm_malloc(ROMFS_ZBLOCKSIZE);
+      if (!victim->zc_data)
+        {
+          return -ENOMEM;
+        }
+    }
+
+  victim->zc_stamp = 0;
+  if (end - start == ulen)
+    {
+      memcpy(victim->zc_data, src, ulen);
+    }
+  else
+    {
+      ret = romfs_lz4decode(src, end - start, victim->zc_data, ulen);
+      if (ret != (int)ulen)
+        {
+          fdbg("Failed to decompress block %d: %d\n", block, ret);
+          return -EIO;
+        }
+    }
+
+  victim->zc_file    = rf->rf_startoffset;
+  victim->zc_block   = block;
+  victim->zc_stamp   = ++rm->rm_zclock;
+  rf->rf_buffer      = victim->zc_data;
+  rf->rf_cachesector = block;
+  return OK;
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -457,6 +661,17 @@ int romfs_filecacheread(struct romfs_mountpt_s *rm, struct romfs_file_s *rf,
         sector, rf->rf_cachesector, rm->rm_hwsectorsize,
         rm->rm_xipbase, rf->rf_buffer);
 
+#ifdef CONFIG_FS_ROMFS_COMPRESSED
+  /* For compressed files, 'sector' is a ROMFS_ZBLOCKSIZE block of the
+   * file and the data comes from the decompressed block cache.
+   */
+
+  if (ROMFS_ISCOMPRESSED(rf))
+    {
+      return romfs_zcacheread(rm, rf, sector);
+    }
+#endif
+
   /* rf->rf_cachesector holds the current sector that is buffer in or referenced
    * by rf->rf_buffer. If the requested sector is the same as this sector,
    * then we do nothing.
@@ -629,6 +844,27 @@ int romfs_fsconfigure(struct romfs_mountpt_s *rm)
 
 int romfs_fileconfigure(struct romfs_mountpt_s *rm, struct romfs_file_s *rf)
 {
+#ifdef CONFIG_FS_ROMFS_COMPRESSED
+  int ret;
+
+  /* Compressed files are read through the mountpoint's block cache and
+   * need no buffer of their own.
+   */
+
+  ret = romfs_zconfigure(rm, rf);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  if (ROMFS_ISCOMPRESSED(rf))
+    {
+      rf->rf_cachesector = (uint32_t)-1;
+      rf->rf_buffer      = NULL;
+      return OK;
+    }
+#endif
+
   /* Check if XIP access mode is supported.  If so, then we do not need
    * to allocate anything.
    */
@@ -979,3 +1215,34 @@ int romfs_datastart(struct romfs_mountpt_s *rm, uint32_t offset,
 
   return -EINVAL; /* Won't get here */
 }
+
+/****************************************************************************
+ * Name: romfs_zuninit
+ *
+ * Desciption:
+ *   Free the decompressed block cache of the mountpoint
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_FS_ROMFS_COMPRESSED
+void romfs_zuninit(struct romfs_mountpt_s *rm)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_FS_ROMFS_ZCACHE_NBLOCKS; i++)
+    {
+      if (rm->rm_zcache[i].zc_data)
+        {
+          kmm_free(rm->rm_zcache[i].zc_data);
+          rm->rm_zcache[i].zc_data  = NULL;
+          rm->rm_zcache[i].zc_stamp = 0;
+        }
+    }
+
+  if (rm->rm_zbuffer)
+    {
+      kmm_free(rm->rm_zbuffer);
+      rm->rm_zbuffer = NULL;
+    }
+}
+#endif
@@ -49,6 +49,10 @@
 
 #include <nuttx/mtd/mtd.h>
 #include <nuttx/fs/smart.h>
+#ifdef CONFIG_SMARTFS_WRITEBUFFER
+#  include <nuttx/clock.h>
+#  include <nuttx/wqueue.h>
+#endif
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -208,6 +212,28 @@
 #define offsetof(type, member)   ( (size_t) &( ( (type *) 0)->member))
 #endif
 
+#ifdef CONFIG_SMARTFS_DCACHE
+#  ifndef CONFIG_SMARTFS_DCACHE_SIZE
+#    define CONFIG_SMARTFS_DCACHE_SIZE 32
+#  endif
+#endif
+
+/* Timed commit of buffered file writes */
+
+#ifdef CONFIG_SMARTFS_WRITEBUFFER
+#  ifndef CONFIG_SMARTFS_WRITEBUFFER_TIMEOUT
+#    define CONFIG_SMARTFS_WRITEBUFFER_TIMEOUT 0
+#  endif
+#  if defined(CONFIG_SCHED_WORKQUEUE) && CONFIG_SMARTFS_WRITEBUFFER_TIMEOUT > 0
+#    define SMARTFS_COMMIT_TIMER 1
+#    ifdef CONFIG_SCHED_LPWORK
+#      define SMARTFS_COMMIT_WORK LPWORK
+#    else
+#      define SMARTFS_COMMIT_WORK HPWORK
+#    endif
+#  endif
+#endif
+
 #define SMARTFS_NEXTSECTOR(h)    ( *((uint16_t *) h->nextsector))
 #define SMARTFS_USED(h)          ( *((uint16_t *) h->used))
 
@@ -259,6 +285,25 @@ struct smartfs_chain_header_s
   uint8_t           used[2];      /* Number of bytes used in this sector */
 };
 
+/* This structure describes one slot of the in-memory directory entry
+ * cache.  A slot is unused when its parent is zero (the format sector
+ * is never a directory).
+ */
+
+#ifdef CONFIG_SMARTFS_DCACHE
+struct smartfs_dcache_s
+{
+  uint16_t          parent;       /* 1st sector of the parent directory */
+  uint16_t          firstsector;  /* Sector number of the name */
+  uint16_t          dsector;      /* Sector number of the directory entry */
+  uint16_t          doffset;      /* Offset of the directory entry */
+  uint16_t          flags;        /* Flags, including mode */
+  uint32_t          utc;          /* Time stamp */
+  uint32_t          datlen;       /* Length of inode data */
+  char              name[CONFIG_SMARTFS_MAXNAMLEN]; /* inode name */
+};
+#endif
+
 /* This structure describes the state of one open file.  This structure
  * is protected by the volume semaphore.
  */
@@ -278,6 +323,11 @@ struct smartfs_ofile_s
                                           * used field until the file is closed,
                                           * a seek, or more data is written that
                                           * causes the sector to change. */
+#ifdef CONFIG_SMARTFS_WRITEBUFFER
+  FAR uint8_t              *buffer;     /* Image of bufsector with appended
+                                         * data that is not written yet */
+  uint16_t                  bufsector;  /* Sector held in buffer or 0xFFFF */
+#endif
 };
 
 /* This structure represents the overall mountpoint state.  An instance of this
@@ -298,6 +348,12 @@ struct smartfs_mountpt_s
   char                       *fs_rwbuffer;  /* Read/Write working buffer */
   char                       *fs_workbuffer;/* Working buffer */
   uint8_t                     fs_rootsector;/* Root directory sector num */
+#ifdef CONFIG_SMARTFS_DCACHE
+  FAR struct smartfs_dcache_s *fs_dcache;   /* Directory entry cache */
+#endif
+#ifdef SMARTFS_COMMIT_TIMER
+  struct work_s               fs_commitwork;/* Timed commit of file buffers */
+#endif
 };
 
 /****************************************************************************
@@ -342,6 +398,16 @@ int smartfs_countdirentries(struct smartfs_mountpt_s *fs,
 int smartfs_truncatefile(struct smartfs_mountpt_s *fs,
         struct smartfs_entry_s *entry);
 
+#ifdef CONFIG_SMARTFS_DCACHE
+void smartfs_dcache_invalidate(struct smartfs_mountpt_s *fs,
+        uint16_t parentdirsector, const char *filename);
+
+void smartfs_dcache_flush(struct smartfs_mountpt_s *fs);
+#else
+#  define smartfs_dcache_invalidate(fs, parentdirsector, filename)
+#  define smartfs_dcache_flush(fs)
+#endif
+
 #if defined(CONFIG_FS_PROCFS) && !defined(CONFIG_FS_PROCFS_EXCLUDE_SMARTFS)
 struct smartfs_mountpt_s* smartfs_get_first_mount(void);
 #endif
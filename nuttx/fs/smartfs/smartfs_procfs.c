@@ -758,6 +758,21 @@ static size_t smartfs_status_read(FAR struct file *filep, FAR char *buffer,
                   procfs_data.sectorsperblk);
                   //procfs_data.unusedsectors, procfs_data.blockerases,
                   //procfs_data.sectorsperblk, utilization);
+
+#ifdef CONFIG_MTD_STATS
+          /* Append the garbage collection counters */
+
+          if (len < buflen)
+            {
+              len += snprintf(&buffer[len], buflen - len,
+                              "Block Erases:      %lu\n"
+                              "GC Blocks:         %lu\n"
+                              "GC Relocations:    %lu\n",
+                              (unsigned long)procfs_data.blockerases,
+                              (unsigned long)procfs_data.gcblocks,
+                              (unsigned long)procfs_data.relocations);
+            }
+#endif
         }
 
       /* Indicate we have already provided all the data */
@@ -107,6 +107,14 @@ static int     smartfs_stat(struct inode *mountpt, const char *relpath, struct s
 static off_t smartfs_seek_internal(struct smartfs_mountpt_s *fs,
                         struct smartfs_ofile_s *sf,
                         off_t offset, int whence);
+#ifdef CONFIG_SMARTFS_WRITEBUFFER
+static ssize_t smartfs_append_buffered(struct smartfs_mountpt_s *fs,
+                                       struct smartfs_ofile_s *sf,
+                                       const char *buffer, size_t buflen);
+#endif
+#ifdef SMARTFS_COMMIT_TIMER
+static void    smartfs_commit_worker(FAR void *arg);
+#endif
 
 /****************************************************************************
  * Private Variables
@@ -296,6 +304,20 @@ static int smartfs_open(FAR struct file *filep, const char *relpath,
   sf->currsector = sf->entry.firstsector;
   sf->byteswritten = 0;
 
+#ifdef CONFIG_SMARTFS_WRITEBUFFER
+  /* Files opened for writing get a sector buffer unless every write must
+   * reach the device immediately.  Without one, writes go straight to the
+   * device.
+   */
+
+  sf->buffer = NULL;
+  sf->bufsector = 0xFFFF;
+  if ((oflags & O_WROK) != 0 && (oflags & O_SYNC) == 0)
+    {
+      sf->buffer = (FAR uint8_t *) kmm_malloc(fs->fs_llformat.availbytes);
+    }
+#endif
+
   /* Test if we opened for APPEND mode.  If we did, then seek to the
    * end of the file.
    */
@@ -426,6 +448,14 @@ static int smartfs_close(FAR struct file *filep)
       kmm_free(sf->entry.name);
       sf->entry.name = NULL;
     }
+
+#ifdef CONFIG_SMARTFS_WRITEBUFFER
+  if (sf->buffer != NULL)
+    {
+      kmm_free(sf->buffer);
+    }
+#endif
+
   kmm_free(sf);
 
 okout:
@@ -573,12 +603,50 @@ static int smartfs_sync_internal(struct smartfs_mountpt_s *fs,
   struct smartfs_chain_header_s *header;
   int ret = OK;
 
+#ifdef CONFIG_SMARTFS_WRITEBUFFER
+  /* Commit the buffered sector image, including its used bytes field,
+   * with a single sector write.
+   */
+
+  if (sf->bufsector != 0xFFFF)
+    {
+      fvdbg("Committing sector %d\n", sf->bufsector);
+      smartfs_dcache_invalidate(fs, sf->entry.dfirst, sf->entry.name);
+
+      header = (struct smartfs_chain_header_s *) sf->buffer;
+      if (*((uint16_t *) header->used) == SMARTFS_ERASEDSTATE_16BIT)
+        {
+          *((uint16_t *) header->used) = sf->byteswritten;
+        }
+      else
+        {
+          *((uint16_t *) header->used) += sf->byteswritten;
+        }
+
+      readwrite.logsector = sf->bufsector;
+      readwrite.offset = 0;
+      readwrite.count = fs->fs_llformat.availbytes;
+      readwrite.buffer = sf->buffer;
+      ret = FS_IOCTL(fs, BIOC_WRITESECT, (unsigned long) &readwrite);
+      if (ret < 0)
+        {
+          fdbg("Error %d committing sector %d\n", ret, sf->bufsector);
+          goto errout;
+        }
+
+      sf->byteswritten = 0;
+      sf->bufsector = 0xFFFF;
+      goto errout;
+    }
+#endif
+
   /* Test if we have written bytes to the current sector that
    * need to be recorded in the chain header's used bytes field. */
 
   if (sf->byteswritten > 0)
     {
       fvdbg("Syncing sector %d\n", sf->currsector);
+      smartfs_dcache_invalidate(fs, sf->entry.dfirst, sf->entry.name);
 
       /* Read the existing sector used bytes value */
 
@@ -675,6 +743,10 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer,
       goto errout_with_semaphore;
     }
 
+  /* The cached length of the file will change */
+
+  smartfs_dcache_invalidate(fs, sf->entry.dfirst, sf->entry.name);
+
   /* First test if we are overwriting an existing location or writing to
    * a new one. */
 
@@ -753,6 +825,35 @@ static ssize_t smartfs_write(FAR struct file *filep, const char *buffer,
         }
     }
 
+#ifdef CONFIG_SMARTFS_WRITEBUFFER
+  /* Collect appended data in the file's sector buffer */
+
+  if (sf->buffer != NULL && buflen > 0)
+    {
+      ret = smartfs_append_buffered(fs, sf, &buffer[byteswritten], buflen);
+      if (ret < 0)
+        {
+          goto errout_with_semaphore;
+        }
+
+      byteswritten += ret;
+      buflen = 0;
+
+#ifdef SMARTFS_COMMIT_TIMER
+      /* Make sure the data is committed in time, counting from the first
+       * write that was not committed.
+       */
+
+      if (sf->bufsector != 0xFFFF && work_available(&fs->fs_commitwork))
+        {
+          (void)work_queue(SMARTFS_COMMIT_WORK, &fs->fs_commitwork,
+                           smartfs_commit_worker, fs,
+                           MSEC2TICK(CONFIG_SMARTFS_WRITEBUFFER_TIMEOUT));
+        }
+#endif
+    }
+#endif
+
   /* Now append data to end of the file. */
 
   while (buflen > 0)
@@ -846,6 +947,143 @@ errout_with_semaphore:
   return ret;
 }
 
+/****************************************************************************
+ * Name: smartfs_append_buffered
+ *
+ * Description: Appends data to the end of the file through the file's
+ *              sector buffer.  A sector is only written to the device
+ *              when it is full; the rest stays in the buffer until the
+ *              next smartfs_sync_internal().
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMARTFS_WRITEBUFFER
+static ssize_t smartfs_append_buffered(struct smartfs_mountpt_s *fs,
+                                       struct smartfs_ofile_s *sf,
+                                       const char *buffer, size_t buflen)
+{
+  struct smart_read_write_s readwrite;
+  struct smartfs_chain_header_s *header;
+  size_t                    byteswritten;
+  uint16_t                  nextsector;
+  uint16_t                  count;
+  int                       ret;
+
+  header = (struct smartfs_chain_header_s *) sf->buffer;
+  byteswritten = 0;
+  while (buflen > 0)
+    {
+      /* Load the current sector into the buffer */
+
+      if (sf->bufsector != sf->currsector)
+        {
+          if (sf->bufsector != 0xFFFF)
+            {
+              ret = smartfs_sync_internal(fs, sf);
+              if (ret < 0)
+                {
+                  return ret;
+                }
+            }
+
+          readwrite.logsector = sf->currsector;
+          readwrite.offset = 0;
+          readwrite.count = fs->fs_llformat.availbytes;
+          readwrite.buffer = sf->buffer;
+          ret = FS_IOCTL(fs, BIOC_READSECT, (unsigned long) &readwrite);
+          if (ret < 0)
+            {
+              fdbg("Error %d reading sector %d data\n", ret, sf->currsector);
+              return ret;
+            }
+
+          sf->bufsector = sf->currsector;
+        }
+
+      /* Copy as much as fits in the current sector */
+
+      count = fs->fs_llformat.availbytes - sf->curroffset;
+      if (count > buflen)
+        {
+          count = buflen;
+        }
+
+      memcpy(&sf->buffer[sf->curroffset], &buffer[byteswritten], count);
+
+      sf->entry.datlen += count;
+      sf->byteswritten += count;
+      sf->filepos += count;
+      sf->curroffset += count;
+      buflen -= count;
+      byteswritten += count;
+
+      /* Commit the sector once it is full.  If there is more data, the
+       * next sector is allocated first so that the chain link goes out
+       * with the same sector write.
+       */
+
+      if (sf->curroffset == fs->fs_llformat.availbytes)
+        {
+          nextsector = SMARTFS_ERASEDSTATE_16BIT;
+          if (buflen > 0)
+            {
+              ret = FS_IOCTL(fs, BIOC_ALLOCSECT, 0xFFFF);
+              if (ret < 0)
+                {
+                  fdbg("Error %d allocating new sector\n", ret);
+                  return ret;
+                }
+
+              nextsector = (uint16_t) ret;
+              *((uint16_t *) header->nextsector) = nextsector;
+            }
+
+          ret = smartfs_sync_internal(fs, sf);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          if (buflen > 0)
+            {
+              sf->currsector = nextsector;
+              sf->curroffset = sizeof(struct smartfs_chain_header_s);
+            }
+        }
+    }
+
+  return byteswritten;
+}
+#endif
+
+/****************************************************************************
+ * Name: smartfs_commit_worker
+ *
+ * Description: Commits the buffered data of all files of the volume when
+ *              the commit timeout expires.
+ *
+ ****************************************************************************/
+
+#ifdef SMARTFS_COMMIT_TIMER
+static void smartfs_commit_worker(FAR void *arg)
+{
+  struct smartfs_mountpt_s *fs = (struct smartfs_mountpt_s *) arg;
+  struct smartfs_ofile_s   *sf;
+
+  smartfs_semtake(fs);
+
+  for (sf = fs->fs_head; sf != NULL; sf = sf->fnext)
+    {
+      if (sf->bufsector != 0xFFFF)
+        {
+          (void)smartfs_sync_internal(fs, sf);
+        }
+    }
+
+  smartfs_semgive(fs);
+}
+#endif
+
 /****************************************************************************
  * Name: smartfs_seek_internal
  *
@@ -1422,6 +1660,9 @@ static int smartfs_unbind(void *handle, FAR struct inode **blkdriver)
     {
        /* Unmount ... close the block driver */
 
+#ifdef SMARTFS_COMMIT_TIMER
+      (void)work_cancel(SMARTFS_COMMIT_WORK, &fs->fs_commitwork);
+#endif
       ret = smartfs_unmount(fs);
     }
 
@@ -1877,6 +2118,8 @@ int smartfs_rename(struct inode *mountpt, const char *oldrelpath,
           fdbg("Error %d writing flag bytes for sector %d\n", ret, readwrite.logsector);
           goto errout_with_semaphore;
         }
+
+      smartfs_dcache_invalidate(fs, oldentry.dfirst, oldentry.name);
     }
   else
     {
@@ -85,6 +85,97 @@ static struct smartfs_mountpt_s* g_mounthead = NULL;
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: smartfs_dcache_slot
+ *
+ * Description: Returns the cache slot for the given parent directory and
+ *              name.  Only the first namesize characters of the name are
+ *              significant, just like for the entries on the device.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMARTFS_DCACHE
+static FAR struct smartfs_dcache_s *
+smartfs_dcache_slot(struct smartfs_mountpt_s *fs, uint16_t parent,
+                    const char *name)
+{
+  uint32_t hash;
+  uint16_t x;
+
+  hash = 2166136261u ^ parent;
+  for (x = 0; x < fs->fs_llformat.namesize && name[x] != '\0'; x++)
+    {
+      hash = (hash ^ (uint8_t) name[x]) * 16777619u;
+    }
+
+  return &fs->fs_dcache[hash % CONFIG_SMARTFS_DCACHE_SIZE];
+}
+#endif
+
+/****************************************************************************
+ * Name: smartfs_dcache_lookup
+ *
+ * Description: Finds a cached directory entry, or returns NULL.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMARTFS_DCACHE
+static FAR struct smartfs_dcache_s *
+smartfs_dcache_lookup(struct smartfs_mountpt_s *fs, uint16_t parent,
+                      const char *name)
+{
+  FAR struct smartfs_dcache_s *slot;
+
+  if (fs->fs_dcache == NULL)
+    {
+      return NULL;
+    }
+
+  slot = smartfs_dcache_slot(fs, parent, name);
+  if (slot->parent == parent &&
+      strncmp(slot->name, name, fs->fs_llformat.namesize) == 0)
+    {
+      return slot;
+    }
+
+  return NULL;
+}
+#endif
+
+/****************************************************************************
+ * Name: smartfs_dcache_insert
+ *
+ * Description: Adds a directory entry to the cache, replacing whatever
+ *              entry occupied its slot.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMARTFS_DCACHE
+static void smartfs_dcache_insert(struct smartfs_mountpt_s *fs,
+                                  uint16_t parent, const char *name,
+                                  uint16_t firstsector, uint16_t flags,
+                                  uint32_t utc, uint16_t dsector,
+                                  uint16_t doffset, uint32_t datlen)
+{
+  FAR struct smartfs_dcache_s *slot;
+
+  if (fs->fs_dcache == NULL)
+    {
+      return;
+    }
+
+  slot = smartfs_dcache_slot(fs, parent, name);
+  slot->parent      = parent;
+  slot->firstsector = firstsector;
+  slot->flags       = flags;
+  slot->utc         = utc;
+  slot->dsector     = dsector;
+  slot->doffset     = doffset;
+  slot->datlen      = datlen;
+  strncpy(slot->name, name, fs->fs_llformat.namesize);
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -240,6 +331,20 @@ int smartfs_mount(struct smartfs_mountpt_s *fs, bool writeable)
   fs->fs_rootsector = SMARTFS_ROOT_DIR_SECTOR;
 #endif /* CONFIG_SMARTFS_MULTI_ROOT_DIRS */
 
+#ifdef CONFIG_SMARTFS_DCACHE
+  /* Allocate the directory entry cache.  Lookups simply go to the device
+   * if it can't be allocated or the names don't fit.
+   */
+
+  fs->fs_dcache = NULL;
+  if (fs->fs_llformat.namesize <= CONFIG_SMARTFS_MAXNAMLEN)
+    {
+      fs->fs_dcache = (FAR struct smartfs_dcache_s *)
+        kmm_zalloc(CONFIG_SMARTFS_DCACHE_SIZE *
+                   sizeof(struct smartfs_dcache_s));
+    }
+#endif
+
   /* We did it! */
 
   fs->fs_mounted = TRUE;
@@ -392,6 +497,14 @@ int smartfs_unmount(struct smartfs_mountpt_s *fs)
   kmm_free(fs->fs_workbuffer);
 #endif
 
+#ifdef CONFIG_SMARTFS_DCACHE
+  if (fs->fs_dcache != NULL)
+    {
+      kmm_free(fs->fs_dcache);
+      fs->fs_dcache = NULL;
+    }
+#endif
+
   return ret;
 }
 
@@ -427,6 +540,9 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs,
   struct      smartfs_chain_header_s *header;
   struct      smart_read_write_s readwrite;
   struct      smartfs_entry_header_s *entry;
+#ifdef CONFIG_SMARTFS_DCACHE
+  FAR struct  smartfs_dcache_s *cached;
+#endif
 
   /* Initialize directory level zero as the root sector */
 
@@ -506,6 +622,62 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs,
         }
       else
         {
+#ifdef CONFIG_SMARTFS_DCACHE
+          /* Try the directory entry cache before reading the directory */
+
+          cached = smartfs_dcache_lookup(fs, dirstack[depth],
+                                         fs->fs_workbuffer);
+          if (cached != NULL)
+            {
+              if (*ptr == '\0')
+                {
+                  /* We are at the last segment.  Report the entry */
+
+                  direntry->firstsector = cached->firstsector;
+                  direntry->flags = cached->flags;
+                  direntry->utc = cached->utc;
+                  direntry->dsector = cached->dsector;
+                  direntry->doffset = cached->doffset;
+                  direntry->dfirst = dirstack[depth];
+                  if (direntry->name == NULL)
+                    {
+                      direntry->name = (char *) kmm_malloc(fs->fs_llformat.namesize+1);
+                    }
+
+                  memset(direntry->name, 0, fs->fs_llformat.namesize + 1);
+                  strncpy(direntry->name, cached->name, fs->fs_llformat.namesize);
+                  direntry->datlen = cached->datlen;
+
+                  *parentdirsector = dirstack[depth];
+                  *filename = segment;
+                  ret = OK;
+                  goto errout;
+                }
+
+              /* Validate it's a directory */
+
+              if ((cached->flags & SMARTFS_DIRENT_TYPE) !=
+                  SMARTFS_DIRENT_TYPE_DIR)
+                {
+                  ret = -ENOTDIR;
+                  goto errout;
+                }
+
+              /* "Push" the directory and continue searching */
+
+              if (depth >= CONFIG_SMARTFS_DIRDEPTH - 1)
+                {
+                  ret = -ENAMETOOLONG;
+                  goto errout;
+                }
+
+              dirstack[++depth] = cached->firstsector;
+              segment = ptr + 1;
+              ret = OK;
+              continue;
+            }
+#endif
+
           /* Search for the entry in the current directory */
 
           dirsector = dirstack[depth];
@@ -625,6 +797,24 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs,
                                 }
                             }
 
+#ifdef CONFIG_SMARTFS_DCACHE
+                          /* Only a complete walk of the chain gives the
+                           * right file length.
+                           */
+
+                          if (ret >= 0)
+                            {
+                              smartfs_dcache_insert(fs, dirstack[depth],
+                                                    direntry->name,
+                                                    direntry->firstsector,
+                                                    direntry->flags,
+                                                    direntry->utc,
+                                                    direntry->dsector,
+                                                    direntry->doffset,
+                                                    direntry->datlen);
+                            }
+#endif
+
                           *parentdirsector = dirstack[depth];
                           *filename = segment;
                           ret = OK;
@@ -653,6 +843,15 @@ int smartfs_finddirentry(struct smartfs_mountpt_s *fs,
                               goto errout;
                             }
 
+#ifdef CONFIG_SMARTFS_DCACHE
+                          smartfs_dcache_insert(fs, dirstack[depth],
+                                                entry->name,
+                                                entry->firstsector,
+                                                entry->flags, entry->utc,
+                                                readwrite.logsector, offset,
+                                                0);
+#endif
+
                           dirstack[++depth] = entry->firstsector;
                           segment = ptr + 1;
                           break;
@@ -753,6 +952,8 @@ int smartfs_createentry(struct smartfs_mountpt_s *fs,
       return -ENAMETOOLONG;
     }
 
+  smartfs_dcache_invalidate(fs, parentdirsector, filename);
+
   /* Read the parent directory sector and find a place to insert
    * the new entry.
    */
@@ -919,6 +1120,7 @@ int smartfs_createentry(struct smartfs_mountpt_s *fs,
   direntry->firstsector = nextsector;
   direntry->dsector = psector;
   direntry->doffset = offset;
+  direntry->dfirst = parentdirsector;
   direntry->flags = entry->flags;
   direntry->utc = 0;
   direntry->datlen = 0;
@@ -960,6 +1162,19 @@ int smartfs_deleteentry(struct smartfs_mountpt_s *fs,
   struct smartfs_chain_header_s  *header;
   struct smart_read_write_s       readwrite;
 
+  /* Drop the entry from the directory entry cache.  A deleted directory
+   * sector may be reused for a new directory, so drop everything then.
+   */
+
+  if ((entry->flags & SMARTFS_DIRENT_TYPE) == SMARTFS_DIRENT_TYPE_DIR)
+    {
+      smartfs_dcache_flush(fs);
+    }
+  else
+    {
+      smartfs_dcache_invalidate(fs, entry->dfirst, entry->name);
+    }
+
   /* Okay, delete the file.  Loop through each sector and release them
 
    * TODO:  We really should walk the list backward to avoid lost
@@ -1231,6 +1446,10 @@ int smartfs_truncatefile(struct smartfs_mountpt_s *fs,
   struct smartfs_chain_header_s  *header;
   struct smart_read_write_s       readwrite;
 
+  /* The cached file length is about to become stale */
+
+  smartfs_dcache_invalidate(fs, entry->dfirst, entry->name);
+
   /* Walk through the directory's sectors and count entries */
 
   nextsector = entry->firstsector;
@@ -1305,6 +1524,51 @@ errout:
   return ret;
 }
 
+/****************************************************************************
+ * Name: smartfs_dcache_invalidate
+ *
+ * Description: Drops the cached directory entry for filename in the given
+ *              parent directory, if there is one.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMARTFS_DCACHE
+void smartfs_dcache_invalidate(struct smartfs_mountpt_s *fs,
+        uint16_t parentdirsector, const char *filename)
+{
+  FAR struct smartfs_dcache_s *slot;
+
+  if (filename == NULL)
+    {
+      return;
+    }
+
+  slot = smartfs_dcache_lookup(fs, parentdirsector, filename);
+  if (slot != NULL)
+    {
+      slot->parent = 0;
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: smartfs_dcache_flush
+ *
+ * Description: Drops all cached directory entries of the volume.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SMARTFS_DCACHE
+void smartfs_dcache_flush(struct smartfs_mountpt_s *fs)
+{
+  if (fs->fs_dcache != NULL)
+    {
+      memset(fs->fs_dcache, 0, CONFIG_SMARTFS_DCACHE_SIZE *
+             sizeof(struct smartfs_dcache_s));
+    }
+}
+#endif
+
 /****************************************************************************
  * Name: smartfs_get_first_mount
  *
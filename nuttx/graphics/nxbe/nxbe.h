@@ -61,6 +61,12 @@
 #define NX_CLIPORDER_BRLT    (3)   /* Bottom-right-left-top */
 #define NX_CLIPORDER_DEFAULT NX_CLIPORDER_TLRB
 
+/* Maximum number of distinct rectangles in a damage region */
+
+#ifndef CONFIG_NX_NDAMAGE
+#  define CONFIG_NX_NDAMAGE 8
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -100,6 +106,13 @@ struct nxbe_plane_s
   /* Framebuffer plane info describing destination video plane */
 
   NX_PLANEINFOTYPE pinfo;
+
+#ifdef CONFIG_NX_HWACCEL
+  /* Driver providing the optional fillrect()/copyrect() blitter methods */
+
+  FAR NX_DRIVERTYPE *dev;
+  uint8_t planeno;
+#endif
 };
 
 /* Clipping *****************************************************************/
@@ -119,6 +132,20 @@ struct nxbe_clipops_s
                    FAR const struct nxgl_rect_s *rect);
 };
 
+/* Damage regions ***********************************************************/
+
+/* Accumulates the regions of one window that need to be redrawn so that
+ * overlapping and adjacent rectangles are merged into a single redraw
+ * request.
+ */
+
+struct nxbe_damage_s
+{
+  FAR struct nxbe_window_s *wnd;    /* The window that was damaged */
+  uint8_t nrects;                   /* Number of valid entries in rect[] */
+  struct nxgl_rect_s rect[CONFIG_NX_NDAMAGE];
+};
+
 /* Back-end state ***********************************************************/
 
 /* This structure describes the overall back-end window state */
@@ -386,6 +413,40 @@ void nxbe_bitmap(FAR struct nxbe_window_s *wnd,
                  FAR const struct nxgl_point_s *origin,
                  unsigned int stride);
 
+/****************************************************************************
+ * Name: nxbe_damage_init
+ *
+ * Description:
+ *   Start a new, empty damage region for the window
+ *
+ ****************************************************************************/
+
+void nxbe_damage_init(FAR struct nxbe_damage_s *damage,
+                      FAR struct nxbe_window_s *wnd);
+
+/****************************************************************************
+ * Name: nxbe_damage_add
+ *
+ * Description:
+ *   Add a rectangle (in absolute display coordinates) to the damage region,
+ *   merging it with any rectangles that it overlaps or adjoins.
+ *
+ ****************************************************************************/
+
+void nxbe_damage_add(FAR struct nxbe_damage_s *damage,
+                     FAR const struct nxgl_rect_s *rect);
+
+/****************************************************************************
+ * Name: nxbe_damage_flush
+ *
+ * Description:
+ *   Send one redraw request for each rectangle in the damage region and
+ *   leave the region empty.
+ *
+ ****************************************************************************/
+
+void nxbe_damage_flush(FAR struct nxbe_damage_s *damage);
+
 /****************************************************************************
  * Name: nxbe_redraw
  *
@@ -87,6 +87,33 @@ static void nxs_clipcopy(FAR struct nxbe_clipops_s *cops,
                          FAR const struct nxgl_rect_s *rect)
 {
   struct nx_bitmap_s *bminfo = (struct nx_bitmap_s *)cops;
+
+#ifdef CONFIG_NX_HWACCEL
+  /* Hand large, byte-aligned areas to the blitter if the driver has one */
+
+  if (plane->dev->copyrect && plane->pinfo.bpp >= 8)
+    {
+      FAR const uint8_t *sline;
+      struct fb_area_s area;
+
+      area.x = rect->pt1.x;
+      area.y = rect->pt1.y;
+      area.w = rect->pt2.x - rect->pt1.x + 1;
+      area.h = rect->pt2.y - rect->pt1.y + 1;
+
+      sline  = (FAR const uint8_t *)bminfo->src +
+               (rect->pt1.y - bminfo->origin.y) * bminfo->stride +
+               (((rect->pt1.x - bminfo->origin.x) * plane->pinfo.bpp) >> 3);
+
+      if ((uint32_t)area.w * area.h >= CONFIG_NX_HWACCEL_MINPIXELS &&
+          plane->dev->copyrect(plane->dev, plane->planeno, &area, sline,
+                               bminfo->stride) >= 0)
+        {
+          return;
+        }
+    }
+#endif
+
   plane->copyrectangle(&plane->pinfo, rect, bminfo->src,
                        &bminfo->origin, bminfo->stride);
 }
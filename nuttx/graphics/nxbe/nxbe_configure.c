@@ -136,6 +136,11 @@ int nxbe_configure(FAR NX_DRIVERTYPE *dev, FAR struct nxbe_state_s *be)
           return ret;
         }
 
+#ifdef CONFIG_NX_HWACCEL
+      be->plane[i].dev     = dev;
+      be->plane[i].planeno = i;
+#endif
+
       /* Select rasterizers to match the BPP reported for this plane.
        * NOTE that there are configuration options to eliminate support
        * for unused BPP values.  If the unused BPP values are not suppressed
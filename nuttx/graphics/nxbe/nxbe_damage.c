@@ -0,0 +1,221 @@
+/****************************************************************************
+ * graphics/nxbe/nxbe_damage.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <debug.h>
+
+#include <nuttx/nx/nxglib.h>
+
+#include "nxbe.h"
+#include "nxfe.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbe_rectarea
+ ****************************************************************************/
+
+static inline uint32_t nxbe_rectarea(FAR const struct nxgl_rect_s *rect)
+{
+  return (uint32_t)(rect->pt2.x - rect->pt1.x + 1) *
+         (uint32_t)(rect->pt2.y - rect->pt1.y + 1);
+}
+
+/****************************************************************************
+ * Name: nxbe_rectmerge
+ *
+ * Description:
+ *   Return the bounding box of the two rectangles in 'merged' and true if
+ *   it covers no more area than the two rectangles do separately.  That is
+ *   the case when one contains the other, when they adjoin along a full
+ *   edge, or when they overlap at least as much as the box adds.
+ *
+ ****************************************************************************/
+
+static bool nxbe_rectmerge(FAR struct nxgl_rect_s *merged,
+                           FAR const struct nxgl_rect_s *rect1,
+                           FAR const struct nxgl_rect_s *rect2)
+{
+  nxgl_rectunion(merged, rect1, rect2);
+  return nxbe_rectarea(merged) <=
+         nxbe_rectarea(rect1) + nxbe_rectarea(rect2);
+}
+
+/****************************************************************************
+ * Name: nxbe_damage_remove
+ ****************************************************************************/
+
+static inline void nxbe_damage_remove(FAR struct nxbe_damage_s *damage,
+                                      int ndx)
+{
+  /* Order does not matter; move the last entry into the hole */
+
+  damage->nrects--;
+  if (ndx < damage->nrects)
+    {
+      nxgl_rectcopy(&damage->rect[ndx], &damage->rect[damage->nrects]);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxbe_damage_init
+ *
+ * Description:
+ *   Start a new, empty damage region for the window
+ *
+ ****************************************************************************/
+
+void nxbe_damage_init(FAR struct nxbe_damage_s *damage,
+                      FAR struct nxbe_window_s *wnd)
+{
+  damage->wnd    = wnd;
+  damage->nrects = 0;
+}
+
+/****************************************************************************
+ * Name: nxbe_damage_add
+ *
+ * Description:
+ *   Add a rectangle (in absolute display coordinates) to the damage region,
+ *   merging it with any rectangles that it overlaps or adjoins.
+ *
+ ****************************************************************************/
+
+void nxbe_damage_add(FAR struct nxbe_damage_s *damage,
+                     FAR const struct nxgl_rect_s *rect)
+{
+  struct nxgl_rect_s pending;
+  struct nxgl_rect_s merged;
+  uint32_t growth;
+  uint32_t mingrowth;
+  int best;
+  int i;
+
+  if (nxgl_nullrect(rect))
+    {
+      return;
+    }
+
+  nxgl_rectcopy(&pending, rect);
+
+  for (; ; )
+    {
+      /* Absorb every entry that merges cleanly with the pending rectangle.
+       * The grown rectangle may now merge with entries already checked, so
+       * start over after each merge.  Each merge removes an entry, so this
+       * terminates.
+       */
+
+      for (i = 0; i < damage->nrects; )
+        {
+          if (nxbe_rectmerge(&merged, &damage->rect[i], &pending))
+            {
+              nxgl_rectcopy(&pending, &merged);
+              nxbe_damage_remove(damage, i);
+              i = 0;
+            }
+          else
+            {
+              i++;
+            }
+        }
+
+      /* Keep it as a distinct rectangle if there is room */
+
+      if (damage->nrects < CONFIG_NX_NDAMAGE)
+        {
+          nxgl_rectcopy(&damage->rect[damage->nrects], &pending);
+          damage->nrects++;
+          return;
+        }
+
+      /* The region is full.  Merge with the entry that grows the least and
+       * try again with the result.
+       */
+
+      best      = 0;
+      mingrowth = UINT32_MAX;
+
+      for (i = 0; i < damage->nrects; i++)
+        {
+          nxgl_rectunion(&merged, &damage->rect[i], &pending);
+          growth = nxbe_rectarea(&merged) - nxbe_rectarea(&damage->rect[i]);
+          if (growth < mingrowth)
+            {
+              mingrowth = growth;
+              best      = i;
+            }
+        }
+
+      nxgl_rectunion(&pending, &damage->rect[best], &pending);
+      nxbe_damage_remove(damage, best);
+    }
+}
+
+/****************************************************************************
+ * Name: nxbe_damage_flush
+ *
+ * Description:
+ *   Send one redraw request for each rectangle in the damage region and
+ *   leave the region empty.
+ *
+ ****************************************************************************/
+
+void nxbe_damage_flush(FAR struct nxbe_damage_s *damage)
+{
+  int i;
+
+  if (damage->wnd)
+    {
+      for (i = 0; i < damage->nrects; i++)
+        {
+          nxfe_redrawreq(damage->wnd, &damage->rect[i]);
+        }
+    }
+
+  damage->nrects = 0;
+}
@@ -83,6 +83,28 @@ static void nxbe_clipfill(FAR struct nxbe_clipops_s *cops,
                         FAR const struct nxgl_rect_s *rect)
 {
   struct nxbe_fill_s *fillinfo = (struct nxbe_fill_s *)cops;
+
+#ifdef CONFIG_NX_HWACCEL
+  /* Hand large areas to the blitter if the driver has one */
+
+  if (plane->dev->fillrect)
+    {
+      struct fb_area_s area;
+
+      area.x = rect->pt1.x;
+      area.y = rect->pt1.y;
+      area.w = rect->pt2.x - rect->pt1.x + 1;
+      area.h = rect->pt2.y - rect->pt1.y + 1;
+
+      if ((uint32_t)area.w * area.h >= CONFIG_NX_HWACCEL_MINPIXELS &&
+          plane->dev->fillrect(plane->dev, plane->planeno, &area,
+                               (uint32_t)fillinfo->color) >= 0)
+        {
+          return;
+        }
+    }
+#endif
+
   plane->fillrectangle(&plane->pinfo, rect, fillinfo->color);
 }
 
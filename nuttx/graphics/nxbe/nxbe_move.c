@@ -60,6 +60,7 @@ struct nxbe_move_s
   struct nxgl_point_s       offset;
   FAR struct nxbe_window_s *wnd;
   struct nxgl_rect_s        srcrect;
+  FAR struct nxbe_damage_s *damage;
   uint8_t                   order;
 };
 
@@ -119,7 +120,7 @@ static void nxbe_clipmoveobscured(FAR struct nxbe_clipops_s *cops,
   struct nxgl_rect_s dst;
 
   nxgl_rectoffset(&dst, rect, info->offset.x, info->offset.y);
-  nxfe_redrawreq(info->wnd, &dst);
+  nxbe_damage_add(info->damage, &dst);
 }
 
 /****************************************************************************
@@ -156,7 +157,7 @@ static void nxbe_clipmovedest(FAR struct nxbe_clipops_s *cops,
     {
       if (!nxgl_nullrect(&nonintersecting[i]))
         {
-          nxfe_redrawreq(dstdata->wnd, &nonintersecting[i]);
+          nxbe_damage_add(dstdata->damage, &nonintersecting[i]);
         }
     }
 
@@ -172,6 +173,7 @@ static void nxbe_clipmovedest(FAR struct nxbe_clipops_s *cops,
       srcinfo.cops.obscured = nxbe_clipmoveobscured;
       srcinfo.offset        = offset;
       srcinfo.wnd           = wnd;
+      srcinfo.damage        = dstdata->damage;
 
       nxbe_clipper(dstdata->wnd->above, &src, dstdata->order,
                    &srcinfo.cops, plane);
@@ -202,6 +204,7 @@ void nxbe_move(FAR struct nxbe_window_s *wnd, FAR const struct nxgl_rect_s *rect
                FAR const struct nxgl_point_s *offset)
 {
   struct nxbe_move_s info;
+  struct nxbe_damage_s damage;
   int i;
 
 #ifdef CONFIG_DEBUG
@@ -230,6 +233,13 @@ void nxbe_move(FAR struct nxbe_window_s *wnd, FAR const struct nxgl_rect_s *rect
   info.offset.x      = offset->x;
   info.offset.y      = offset->y;
   info.wnd           = wnd;
+  info.damage        = &damage;
+
+  /* Exposed regions are accumulated during the move and sent as merged
+   * redraw requests when the move is complete.
+   */
+
+  nxbe_damage_init(&damage, wnd);
 
   /* The clip order depends up the direction that the rectangle is being
    * moved.
@@ -281,4 +291,8 @@ void nxbe_move(FAR struct nxbe_window_s *wnd, FAR const struct nxgl_rect_s *rect
       nxbe_clipper(wnd->above, &info.srcrect, info.order,
                    &info.cops, &wnd->be->plane[i]);
     }
+
+  /* Request the client to redraw the newly exposed regions */
+
+  nxbe_damage_flush(&damage);
 }
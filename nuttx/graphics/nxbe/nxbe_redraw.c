@@ -58,7 +58,7 @@
 struct nxbe_redraw_s
 {
   struct nxbe_clipops_s cops;
-  FAR struct nxbe_window_s *wnd;
+  struct nxbe_damage_s damage;
 };
 
 /****************************************************************************
@@ -81,11 +81,11 @@ static void nxbe_clipredraw(FAR struct nxbe_clipops_s *cops,
                            FAR struct nxbe_plane_s *plane,
                            FAR const struct nxgl_rect_s *rect)
 {
-  FAR struct nxbe_window_s *wnd = ((struct nxbe_redraw_s *)cops)->wnd;
-  if (wnd)
-    {
-      nxfe_redrawreq(wnd, rect);
-    }
+  /* Accumulate the visible rectangles; nxbe_redraw() sends the merged
+   * region once clipping is complete.
+   */
+
+  nxbe_damage_add(&((FAR struct nxbe_redraw_s *)cops)->damage, rect);
 }
 
 /****************************************************************************
@@ -123,7 +123,7 @@ void nxbe_redraw(FAR struct nxbe_state_s *be,
 
       info.cops.visible  = nxbe_clipredraw;
       info.cops.obscured = nxbe_clipnull;
-      info.wnd           = wnd;
+      nxbe_damage_init(&info.damage, wnd);
 
 #if CONFIG_NX_NPLANES > 1
       for (i = 0; i < be->vinfo.nplanes; i++)
@@ -135,5 +135,9 @@ void nxbe_redraw(FAR struct nxbe_state_s *be,
       nxbe_clipper(wnd->above, &remaining, NX_CLIPORDER_DEFAULT,
                    &info.cops, &be->plane[0]);
 #endif
+
+      /* Request the client to redraw the merged region */
+
+      nxbe_damage_flush(&info.damage);
     }
 }
@@ -45,6 +45,7 @@
 #include <nuttx/nx/nxglib.h>
 
 #include "nxglib_bitblit.h"
+#include "nxglib_copyrun.h"
 
 /****************************************************************************
  * Pre-Processor Definitions
@@ -169,9 +170,9 @@ void NXGL_FUNCNAME(nxgl_copyrectangle,NXGLIB_SUFFIX)
           NXGL_MEMCPY(dptr, sptr, lnlen);
         }
 #else
-      /* Copy the whole line */
+      /* Copy the whole line, a word at a time where alignment permits */
 
-      NXGL_MEMCPY((NXGL_PIXEL_T*)dline, (NXGL_PIXEL_T*)sline, width);
+      nxgl_copyrun_bytes(sline, dline, NXGL_SCALEX(width));
 #endif
       dline += deststride;
       sline += srcstride;
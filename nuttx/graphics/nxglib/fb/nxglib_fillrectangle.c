@@ -46,6 +46,12 @@
 
 #include "nxglib_bitblit.h"
 
+/* The run filler assumes unpacked 24-bit pixels; the framebuffer is packed */
+
+#if NXGLIB_BITSPERPIXEL >= 8 && NXGLIB_BITSPERPIXEL != 24
+#  include "nxglib_fillrun.h"
+#endif
+
 /****************************************************************************
  * Pre-Processor Definitions
  ****************************************************************************/
@@ -167,10 +173,15 @@ void NXGL_FUNCNAME(nxgl_fillrectangle,NXGLIB_SUFFIX)
         {
           NXGL_MEMSET(dest, (NXGL_PIXEL_T)color, lnlen);
         }
-#else
+#elif NXGLIB_BITSPERPIXEL == 24
       /* Draw the entire raster line */
 
       NXGL_MEMSET(line, (NXGL_PIXEL_T)color, width);
+#else
+      /* Draw the entire raster line, a word at a time */
+
+      NXGL_FUNCNAME(nxgl_fillrun,NXGLIB_SUFFIX)((FAR NXGLIB_RUNTYPE *)line,
+                                                color, width);
 #endif
       line += stride;
     }
@@ -56,6 +56,14 @@
 #  define NXGLIB_RUNTYPE uint32_t
 #endif
 
+/* The 16- and 32-bit fills store this many 32-bit words per pass through
+ * the inner loop.  The stores are to consecutive addresses from
+ * independent registers so that the compiler can combine them into burst
+ * (STM-class) writes.
+ */
+
+#define NXGLIB_BURSTWORDS 8
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -64,10 +72,6 @@
  * Private Data
  ****************************************************************************/
 
-#if NXGLIB_BITSPERPIXEL == 2
-static uint8_t g_wide_2bpp[4] = { 0x00, 0x55, 0xaa, 0xff };
-#endif
-
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -117,6 +121,7 @@ static inline void nxgl_fillrun_2bpp(FAR uint8_t *run, nxgl_mxpixel_t color,
 
   /* Get the value of the byte to fill */
 
+  static const uint8_t g_wide_2bpp[4] = { 0x00, 0x55, 0xaa, 0xff };
   uint8_t wide = g_wide_2bpp[color & 3];
 
   /* Fill the run with the color (it is okay to run a fractional byte over
@@ -159,11 +164,47 @@ static inline void nxgl_fillrun_8bpp(FAR uint8_t *run, nxgl_mxpixel_t color,
 static inline void nxgl_fillrun_16bpp(FAR uint16_t *run, nxgl_mxpixel_t color,
                                       size_t npixels)
 {
-  /* Fill the run with the color (it is okay to run a fractional byte overy the end */
+  FAR uint32_t *wrun;
+  uint32_t wide = ((uint32_t)(uint16_t)color << 16) | (uint16_t)color;
 
-  while (npixels-- > 0)
+  /* Align to a 32-bit boundary (the run is always aligned to at least a
+   * 16-bit boundary).
+   */
+
+  if (npixels > 0 && ((uintptr_t)run & 3) != 0)
     {
       *run++ = (uint16_t)color;
+      npixels--;
+    }
+
+  /* Then fill two pixels per 32-bit word, a burst at a time */
+
+  wrun = (FAR uint32_t *)run;
+  while (npixels >= 2 * NXGLIB_BURSTWORDS)
+    {
+      wrun[0] = wide;
+      wrun[1] = wide;
+      wrun[2] = wide;
+      wrun[3] = wide;
+      wrun[4] = wide;
+      wrun[5] = wide;
+      wrun[6] = wide;
+      wrun[7] = wide;
+      wrun    += NXGLIB_BURSTWORDS;
+      npixels -= 2 * NXGLIB_BURSTWORDS;
+    }
+
+  while (npixels >= 2)
+    {
+      *wrun++  = wide;
+      npixels -= 2;
+    }
+
+  /* And the odd pixel at the end, if any */
+
+  if (npixels > 0)
+    {
+      *(FAR uint16_t *)wrun = (uint16_t)color;
     }
 }
 
@@ -181,7 +222,23 @@ static inline void nxgl_fillrun_24bpp(FAR uint32_t *run, nxgl_mxpixel_t color, s
 #elif NXGLIB_BITSPERPIXEL == 32
 static inline void nxgl_fillrun_32bpp(FAR uint32_t *run, nxgl_mxpixel_t color, size_t npixels)
 {
-  /* Fill the run with the color (it is okay to run a fractional byte overy the end */
+  uint32_t wide = (uint32_t)color;
+
+  /* Fill the run with the color, a burst at a time */
+
+  while (npixels >= NXGLIB_BURSTWORDS)
+    {
+      run[0]   = wide;
+      run[1]   = wide;
+      run[2]   = wide;
+      run[3]   = wide;
+      run[4]   = wide;
+      run[5]   = wide;
+      run[6]   = wide;
+      run[7]   = wide;
+      run     += NXGLIB_BURSTWORDS;
+      npixels -= NXGLIB_BURSTWORDS;
+    }
 
   while (npixels-- > 0)
     {
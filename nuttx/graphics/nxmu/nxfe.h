@@ -254,7 +254,8 @@ int nxmu_mousereport(struct nxbe_window_s *wnd);
 
 #ifdef CONFIG_NX_XYINPUT
 int nxmu_mousein(FAR struct nxfe_state_s *fe,
-                 FAR const struct nxgl_point_s *pos, int button);
+                 FAR const struct nxgl_point_s *pos, int button,
+                 uint32_t time);
 #endif
 
 /****************************************************************************
@@ -271,6 +272,49 @@ int nxmu_mousein(FAR struct nxfe_state_s *fe,
 void nxmu_kbdin(FAR struct nxfe_state_s *fe, uint8_t nch, FAR uint8_t *ch);
 #endif
 
+/****************************************************************************
+ * Name: nxmu_registersurface and nxmu_unregistersurface
+ *
+ * Description:
+ *   Attach (or detach) the image planes of a client surface so that the
+ *   server can blit from it.  The registration result is left in
+ *   surf->result.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_SURFACES
+void nxmu_registersurface(FAR struct nxmu_surface_s *surf);
+void nxmu_unregistersurface(FAR struct nxmu_surface_s *surf);
+#endif
+
+/****************************************************************************
+ * Name: nxmu_surfaceblit
+ *
+ * Description:
+ *   Copy the damaged part of a registered surface into a window.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_SURFACES
+void nxmu_surfaceblit(FAR struct nxbe_window_s *wnd,
+                      FAR struct nxmu_surface_s *surf,
+                      FAR const struct nxgl_rect_s *dest,
+                      FAR const struct nxgl_point_s *origin);
+#endif
+
+/****************************************************************************
+ * Name: nxmu_batch
+ *
+ * Description:
+ *   Execute every drawing command in a client command buffer, in order,
+ *   then return ownership of the buffer to the client.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_BATCH
+void nxmu_batch(FAR struct nxmu_batchbuf_s *batch);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
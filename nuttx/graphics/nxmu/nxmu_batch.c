@@ -0,0 +1,135 @@
+/****************************************************************************
+ * graphics/nxmu/nxmu_batch.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <semaphore.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+#include "nxfe.h"
+
+#ifdef CONFIG_NX_BATCH
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxmu_batch
+ *
+ * Description:
+ *   Execute every drawing command in a client command buffer, in order,
+ *   then return ownership of the buffer to the client.
+ *
+ ****************************************************************************/
+
+void nxmu_batch(FAR struct nxmu_batchbuf_s *batch)
+{
+  FAR uint8_t *cmd = (FAR uint8_t *)batch->data;
+  FAR uint8_t *end = cmd + batch->nbytes;
+  FAR struct nxsvrmsg_s *msg;
+  size_t cmdlen;
+
+  while (cmd < end)
+    {
+      msg = (FAR struct nxsvrmsg_s *)cmd;
+      switch (msg->msgid)
+        {
+        case NX_SVRMSG_SETPIXEL:
+          {
+            FAR struct nxsvrmsg_setpixel_s *setmsg =
+              (FAR struct nxsvrmsg_setpixel_s *)cmd;
+
+            nxbe_setpixel(setmsg->wnd, &setmsg->pos, setmsg->color);
+            cmdlen = sizeof(struct nxsvrmsg_setpixel_s);
+          }
+          break;
+
+        case NX_SVRMSG_FILL:
+          {
+            FAR struct nxsvrmsg_fill_s *fillmsg =
+              (FAR struct nxsvrmsg_fill_s *)cmd;
+
+            nxbe_fill(fillmsg->wnd, &fillmsg->rect, fillmsg->color);
+            cmdlen = sizeof(struct nxsvrmsg_fill_s);
+          }
+          break;
+
+        case NX_SVRMSG_FILLTRAP:
+          {
+            FAR struct nxsvrmsg_filltrapezoid_s *trapmsg =
+              (FAR struct nxsvrmsg_filltrapezoid_s *)cmd;
+
+            nxbe_filltrapezoid(trapmsg->wnd, &trapmsg->clip, &trapmsg->trap,
+                               trapmsg->color);
+            cmdlen = sizeof(struct nxsvrmsg_filltrapezoid_s);
+          }
+          break;
+
+        case NX_SVRMSG_MOVE:
+          {
+            FAR struct nxsvrmsg_move_s *movemsg =
+              (FAR struct nxsvrmsg_move_s *)cmd;
+
+            nxbe_move(movemsg->wnd, &movemsg->rect, &movemsg->offset);
+            cmdlen = sizeof(struct nxsvrmsg_move_s);
+          }
+          break;
+
+        default:
+          {
+            /* The rest of the buffer cannot be parsed */
+
+            gdbg("ERROR: Unexpected batch command: %d\n", msg->msgid);
+            cmd = end;
+            cmdlen = 0;
+          }
+          break;
+        }
+
+      cmd += NX_BATCH_ALIGN(cmdlen);
+    }
+
+  /* The client may now reuse the buffer */
+
+  sem_post(&batch->done);
+}
+
+#endif /* CONFIG_NX_BATCH */
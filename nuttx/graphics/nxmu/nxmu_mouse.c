@@ -43,6 +43,7 @@
 #include <errno.h>
 #include <debug.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/nx/nxglib.h>
 #include <nuttx/nx/nx.h>
 #include "nxfe.h"
@@ -53,6 +54,10 @@
  * Pre-Processor Definitions
  ****************************************************************************/
 
+#ifndef CONFIG_NX_MOUSE_MININTERVAL
+#  define CONFIG_NX_MOUSE_MININTERVAL 0
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -65,6 +70,9 @@ static struct nxgl_point_s   g_mpos;
 static struct nxgl_point_s   g_mrange;
 static uint8_t               g_mbutton;
 static struct nxbe_window_s *g_mwnd;
+#if CONFIG_NX_MOUSE_MININTERVAL > 0
+static uint32_t              g_mtime;  /* Time of the last report routed */
+#endif
 
 /****************************************************************************
  * Public Data
@@ -147,10 +155,16 @@ int nxmu_mousereport(struct nxbe_window_s *wnd)
  *   handler that manages some kind of pointing hardware.  Route that
  *   positional data to the appropriate window client.
  *
+ *   If CONFIG_NX_MOUSE_MININTERVAL is set, position-only changes that
+ *   arrive less than that many milliseconds after the last routed report
+ *   are absorbed:  The position is recorded but not sent.  The next report
+ *   sent, including any button change, carries the latest position.
+ *
  ****************************************************************************/
 
 int nxmu_mousein(FAR struct nxfe_state_s *fe,
-                 FAR const struct nxgl_point_s *pos, int buttons)
+                 FAR const struct nxgl_point_s *pos, int buttons,
+                 uint32_t time)
 {
   struct nxbe_window_s *wnd;
   nxgl_coord_t x = pos->x;
@@ -189,6 +203,18 @@ int nxmu_mousein(FAR struct nxfe_state_s *fe,
       g_mpos.y   = y;
       g_mbutton  = buttons;
 
+#if CONFIG_NX_MOUSE_MININTERVAL > 0
+      /* Limit the rate of reports that only move the position */
+
+      if (buttons == oldbuttons &&
+          (uint32_t)(time - g_mtime) < MSEC2TICK(CONFIG_NX_MOUSE_MININTERVAL))
+        {
+          return OK;
+        }
+
+      g_mtime = time;
+#endif
+
       /* If a button is already down, regard this as part of a mouse drag
        * event. Pass all the following events to the window where the drag
        * started in.
@@ -505,7 +505,8 @@ int nx_runinstance(FAR const char *mqname, FAR NX_DRIVERTYPE *dev)
          case NX_SVRMSG_MOUSEIN: /* New mouse report from mouse client */
            {
              FAR struct nxsvrmsg_mousein_s *mousemsg = (FAR struct nxsvrmsg_mousein_s *)buffer;
-             nxmu_mousein(&fe, &mousemsg->pt, mousemsg->buttons);
+             nxmu_mousein(&fe, &mousemsg->pt, mousemsg->buttons,
+                          mousemsg->time);
            }
            break;
 #endif
@@ -525,6 +526,49 @@ int nx_runinstance(FAR const char *mqname, FAR NX_DRIVERTYPE *dev)
            }
            break;
 
+#ifdef CONFIG_NX_SURFACES
+         case NX_SVRMSG_REGSURFACE: /* Register a client image surface */
+           {
+             FAR struct nxsvrmsg_regsurface_s *surfmsg =
+               (FAR struct nxsvrmsg_regsurface_s *)buffer;
+
+             nxmu_registersurface(surfmsg->surf);
+             sem_post(surfmsg->sem_done);
+           }
+           break;
+
+         case NX_SVRMSG_UNREGSURFACE: /* Release a client image surface */
+           {
+             FAR struct nxsvrmsg_regsurface_s *surfmsg =
+               (FAR struct nxsvrmsg_regsurface_s *)buffer;
+
+             nxmu_unregistersurface(surfmsg->surf);
+             sem_post(surfmsg->sem_done);
+           }
+           break;
+
+         case NX_SVRMSG_SURFBLIT: /* Copy part of a surface into the window */
+           {
+             FAR struct nxsvrmsg_surfblit_s *blitmsg =
+               (FAR struct nxsvrmsg_surfblit_s *)buffer;
+
+             nxmu_surfaceblit(blitmsg->wnd, blitmsg->surf, &blitmsg->dest,
+                              &blitmsg->origin);
+           }
+           break;
+#endif
+
+#ifdef CONFIG_NX_BATCH
+         case NX_SVRMSG_BATCH: /* Execute a buffer of drawing commands */
+           {
+             FAR struct nxsvrmsg_batch_s *batchmsg =
+               (FAR struct nxsvrmsg_batch_s *)buffer;
+
+             nxmu_batch(batchmsg->batch);
+           }
+           break;
+#endif
+
          /* Messages sent to the background window **************************/
 
          case NX_CLIMSG_REDRAW: /* Re-draw the background window */
@@ -0,0 +1,215 @@
+/****************************************************************************
+ * graphics/nxmu/nxmu_surface.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <errno.h>
+#include <debug.h>
+
+#ifdef CONFIG_MM_SHM
+#  include <sys/ipc.h>
+#  include <sys/shm.h>
+#endif
+
+#include <nuttx/nx/nx.h>
+#include "nxfe.h"
+
+#ifdef CONFIG_NX_SURFACES
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxmu_detachsurface
+ *
+ * Description:
+ *   Drop the server's view of the first nplanes planes of the surface.
+ *
+ ****************************************************************************/
+
+static void nxmu_detachsurface(FAR struct nxmu_surface_s *surf, int nplanes)
+{
+  int i;
+
+  for (i = 0; i < nplanes; i++)
+    {
+#ifdef CONFIG_MM_SHM
+      if (surf->src[i])
+        {
+          (void)shmdt(surf->src[i]);
+        }
+#endif
+
+      surf->src[i] = NULL;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxmu_registersurface
+ *
+ * Description:
+ *   Make a client surface accessible to the server.  In the kernel build,
+ *   each plane's shared memory region is attached read-only and checked to
+ *   be large enough for the surface.  The outcome is left in surf->result.
+ *
+ * Input Parameters:
+ *   surf - The client-allocated surface structure
+ *
+ * Return:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxmu_registersurface(FAR struct nxmu_surface_s *surf)
+{
+  FAR const struct nx_surfaceinfo_s *info = &surf->info;
+#ifdef CONFIG_MM_SHM
+  struct shmid_ds shmds;
+  FAR void *addr;
+#endif
+  int i;
+
+  if (info->size.w <= 0 || info->size.h <= 0 || info->stride == 0)
+    {
+      surf->result = -EINVAL;
+      return;
+    }
+
+  for (i = 0; i < CONFIG_NX_NPLANES; i++)
+    {
+#ifdef CONFIG_MM_SHM
+      if (shmctl(info->shmid[i], IPC_STAT, &shmds) < 0 ||
+          shmds.shm_segsz < (size_t)info->stride * info->size.h)
+        {
+          gdbg("Bad surface region %d\n", info->shmid[i]);
+          surf->result = -EINVAL;
+          nxmu_detachsurface(surf, i);
+          return;
+        }
+
+      addr = shmat(info->shmid[i], NULL, SHM_RDONLY);
+      if (addr == (FAR void *)-1)
+        {
+          surf->result = -get_errno();
+          nxmu_detachsurface(surf, i);
+          return;
+        }
+
+      surf->src[i] = addr;
+#else
+      surf->src[i] = info->src[i];
+#endif
+    }
+
+  surf->result = OK;
+}
+
+/****************************************************************************
+ * Name: nxmu_unregistersurface
+ *
+ * Description:
+ *   Drop the server's view of a client surface.
+ *
+ * Input Parameters:
+ *   surf - The surface previously passed to nxmu_registersurface
+ *
+ * Return:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxmu_unregistersurface(FAR struct nxmu_surface_s *surf)
+{
+  if (surf->result == OK)
+    {
+      nxmu_detachsurface(surf, CONFIG_NX_NPLANES);
+      surf->result = -ENOENT;
+    }
+}
+
+/****************************************************************************
+ * Name: nxmu_surfaceblit
+ *
+ * Description:
+ *   Copy the damaged part of a registered surface into a window.
+ *
+ * Input Parameters:
+ *   wnd    - The window that will receive the image
+ *   surf   - The source surface
+ *   dest   - The damaged region in window coordinates
+ *   origin - The window position of the upper, left-most corner of the
+ *            surface
+ *
+ * Return:
+ *   None
+ *
+ ****************************************************************************/
+
+void nxmu_surfaceblit(FAR struct nxbe_window_s *wnd,
+                      FAR struct nxmu_surface_s *surf,
+                      FAR const struct nxgl_rect_s *dest,
+                      FAR const struct nxgl_point_s *origin)
+{
+  struct nxgl_rect_s extent;
+  struct nxgl_rect_s rect;
+
+  if (surf->result != OK)
+    {
+      return;
+    }
+
+  /* Never read outside of the surface:  Clip the damage to its extent */
+
+  extent.pt1.x = origin->x;
+  extent.pt1.y = origin->y;
+  extent.pt2.x = origin->x + surf->info.size.w - 1;
+  extent.pt2.y = origin->y + surf->info.size.h - 1;
+
+  nxgl_rectintersect(&rect, dest, &extent);
+  if (!nxgl_nullrect(&rect))
+    {
+      nxbe_bitmap(wnd, &rect, surf->src, origin, surf->info.stride);
+    }
+}
+
+#endif /* CONFIG_NX_SURFACES */
@@ -61,10 +61,6 @@
 #define BMFLAGS_NOGLYPH    (1 << 0) /* No glyph available, use space */
 #define BM_ISSPACE(bm)     (((bm)->flags & BMFLAGS_NOGLYPH) != 0)
 
-/* Sizes and maximums */
-
-#define MAX_USECNT         255  /* Limit to range of a uint8_t */
-
 /* Device path formats */
 
 #define NX_DEVNAME_FORMAT  "/dev/nxterm%d"
@@ -78,6 +74,15 @@
 
 #define VT100_MAX_SEQUENCE 3
 
+/* Deferred scrolling */
+
+#if CONFIG_NXTERM_SCROLLBATCH > 0
+#  define NXTERM_SCROLLPENDING(p) ((p)->scrollpend != 0)
+#else
+#  define NXTERM_SCROLLPENDING(p) (false)
+#  define nxterm_scrollflush(p)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -111,18 +116,6 @@ struct nxterm_operations_s
                 unsigned int stride);
 };
 
-/* Describes one cached glyph bitmap */
-
-struct nxterm_glyph_s
-{
-  uint8_t code;                        /* Character code */
-  uint8_t height;                      /* Height of this glyph (in rows) */
-  uint8_t width;                       /* Width of this glyph (in pixels) */
-  uint8_t stride;                      /* Width of the glyph row (in bytes) */
-  uint8_t usecnt;                      /* Use count */
-  FAR uint8_t *bitmap;                 /* Allocated bitmap memory */
-};
-
 /* Describes on character on the display */
 
 struct nxterm_bitmap_s
@@ -140,6 +133,7 @@ struct nxterm_state_s
   FAR void *handle;                         /* The window handle */
   FAR struct nxterm_window_s wndo;           /* Describes the window and font */
   NXHANDLE font;                            /* The current font handle */
+  FCACHE fcache;                            /* Shared glyph cache handle */
   sem_t exclsem;                            /* Forces mutually exclusive access */
 #ifdef CONFIG_DEBUG
   pid_t holder;                             /* Deadlock avoidance */
@@ -151,12 +145,14 @@ struct nxterm_state_s
   uint8_t fheight;                          /* Max height of a font in pixels */
   uint8_t fwidth;                           /* Max width of a font in pixels */
   uint8_t spwidth;                          /* The width of a space */
-  uint8_t maxglyphs;                        /* Size of the glyph[] array */
 
   uint16_t maxchars;                        /* Size of the bm[] array */
   uint16_t nchars;                          /* Number of chars in the bm[] array */
 
   struct nxgl_point_s fpos;                 /* Next display position */
+#if CONFIG_NXTERM_SCROLLBATCH > 0
+  nxgl_coord_t scrollpend;                  /* Scroll height not yet applied to the display */
+#endif
 
   /* VT100 escape sequence processing */
 
@@ -168,10 +164,6 @@ struct nxterm_state_s
   struct nxterm_bitmap_s cursor;
   struct nxterm_bitmap_s bm[CONFIG_NXTERM_MXCHARS];
 
-  /* Glyph cache data storage */
-
-  struct nxterm_glyph_s  glyph[CONFIG_NXTERM_CACHESIZE];
-
   /* Keyboard input support */
 
 #ifdef CONFIG_NXTERM_NXKBDIN
@@ -235,7 +227,7 @@ enum nxterm_vt100state_e nxterm_vt100(FAR struct nxterm_state_s *priv, char ch);
 
 void nxterm_home(FAR struct nxterm_state_s *priv);
 void nxterm_newline(FAR struct nxterm_state_s *priv);
-FAR const struct nxterm_bitmap_s *nxterm_addchar(NXHANDLE hfont,
+FAR const struct nxterm_bitmap_s *nxterm_addchar(
     FAR struct nxterm_state_s *priv, uint8_t ch);
 int nxterm_hidechar(FAR struct nxterm_state_s *priv,
     FAR const struct nxterm_bitmap_s *bm);
@@ -250,5 +242,8 @@ void nxterm_hidecursor(FAR struct nxterm_state_s *priv);
 /* Scrolling support */
 
 void nxterm_scroll(FAR struct nxterm_state_s *priv, int scrollheight);
+#if CONFIG_NXTERM_SCROLLBATCH > 0
+void nxterm_scrollflush(FAR struct nxterm_state_s *priv);
+#endif
 
 #endif /* __GRAPHICS_NXTERM_NXTERM_INTERNAL_H */
@@ -91,6 +91,7 @@ void nxterm_putc(FAR struct nxterm_state_s *priv, uint8_t ch)
 
   if (ch == ASCII_BS || ch == ASCII_DEL)
     {
+      nxterm_scrollflush(priv);
       nxterm_backspace(priv);
       return;
     }
@@ -139,11 +140,12 @@ void nxterm_putc(FAR struct nxterm_state_s *priv, uint8_t ch)
     }
 
   /* Find the glyph associated with the character and render it onto the
-   * display.
+   * display.  If a scroll is pending, the character is only cached; it is
+   * rendered when the display is scrolled.
    */
 
-  bm = nxterm_addchar(priv->font, priv, ch);
-  if (bm)
+  bm = nxterm_addchar(priv, ch);
+  if (bm && !NXTERM_SCROLLPENDING(priv))
     {
       nxterm_fillchar(priv, NULL, bm);
     }
@@ -182,6 +184,10 @@ void nxterm_showcursor(FAR struct nxterm_state_s *priv)
       nxterm_scroll(priv, lineheight);
     }
 
+  /* Bring the display up to date with any deferred scrolling */
+
+  nxterm_scrollflush(priv);
+
   /* Render the cursor glyph onto the display. */
 
   priv->cursor.pos.x = priv->fpos.x;
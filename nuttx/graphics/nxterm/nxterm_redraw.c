@@ -132,6 +132,12 @@ void nxterm_redraw(NXTERM handle, FAR const struct nxgl_rect_s *rect, bool more)
     }
   while (ret < 0);
 
+  /* Apply any deferred scrolling so that the rest of the display agrees
+   * with the character cache.
+   */
+
+  nxterm_scrollflush(priv);
+
   /* Fill the rectangular region with the window background color */
 
   ret = priv->ops->fill(priv, rect, priv->wndo.wcolor);
@@ -107,15 +107,24 @@ FAR struct nxterm_state_s *
   sem_init(&priv->waitsem, 0, 0);
 #endif
 
-  /* Select the font */
+  /* Connect to the shared font glyph bitmap cache.  Only the
+   * CONFIG_NXTERM_CACHESIZE most recently used glyphs are retained.
+   */
 
-  priv->font = nxf_getfonthandle(wndo->fontid);
-  if (!priv->font)
+  priv->fcache = nxf_cache_connect(wndo->fontid, wndo->fcolor[0],
+                                   wndo->wcolor[0], CONFIG_NXTERM_BPP,
+                                   CONFIG_NXTERM_CACHESIZE);
+  if (!priv->fcache)
     {
-      gdbg("Failed to get font ID %d: %d\n", wndo->fontid, errno);
+      gdbg("Failed to connect to font cache for ID %d: %d\n",
+           wndo->fontid, errno);
       goto errout;
     }
 
+  /* Select the font */
+
+  priv->font = nxf_cache_getfonthandle(priv->fcache);
+
   FAR const struct nx_font_s *fontset;
 
   /* Get information about the font set being used and save this in the
@@ -131,10 +140,6 @@ FAR struct nxterm_state_s *
 
   priv->maxchars  = CONFIG_NXTERM_MXCHARS;
 
-  /* Set up the font glyph bitmap cache */
-
-  priv->maxglyphs = CONFIG_NXTERM_CACHESIZE;
-
   /* Set the initial display position */
 
   nxterm_home(priv);
@@ -192,6 +192,74 @@ static inline void nxterm_movedisplay(FAR struct nxterm_state_s *priv,
 }
 #endif
 
+/****************************************************************************
+ * Name: nxterm_movebatch
+ *
+ * Description:
+ *   Apply several lines of deferred scrolling with a single move.  Then
+ *   clear the exposed bottom of the display and render the cached
+ *   characters that lie within it; those were not drawn while the scroll
+ *   was pending.
+ ****************************************************************************/
+
+#if CONFIG_NXTERM_SCROLLBATCH > 0 && !defined(CONFIG_NX_WRITEONLY)
+static inline void nxterm_movebatch(FAR struct nxterm_state_s *priv,
+                                    nxgl_coord_t scrollheight)
+{
+  FAR struct nxterm_bitmap_s *bm;
+  struct nxgl_rect_s rect;
+  struct nxgl_point_s offset;
+  int ret;
+  int i;
+
+  rect.pt1.x = 0;
+  rect.pt2.x = priv->wndo.wsize.w - 1;
+  rect.pt2.y = priv->wndo.wsize.h - 1;
+
+  /* Move whatever is still visible up by the total scroll height.  If
+   * everything scrolled off, there is nothing to move.
+   */
+
+  if (scrollheight < priv->wndo.wsize.h)
+    {
+      rect.pt1.y = scrollheight;
+      offset.x   = 0;
+      offset.y   = -scrollheight;
+
+      ret = priv->ops->move(priv, &rect, &offset);
+      if (ret < 0)
+        {
+          gdbg("Move failed: %d\n", errno);
+        }
+
+      rect.pt1.y = priv->wndo.wsize.h - scrollheight;
+    }
+  else
+    {
+      rect.pt1.y = 0;
+    }
+
+  /* Clear the exposed region */
+
+  ret = priv->ops->fill(priv, &rect, priv->wndo.wcolor);
+  if (ret < 0)
+    {
+      gdbg("Fill failed: %d\n", errno);
+    }
+
+  /* Render each character that might lie within in the exposed region */
+
+  for (i = 0; i < priv->nchars; i++)
+    {
+      bm = &priv->bm[i];
+      if (bm->pos.y <= rect.pt2.y && bm->pos.y + priv->fheight >= rect.pt1.y)
+        {
+          nxterm_fillchar(priv, &rect, bm);
+        }
+    }
+}
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -247,7 +315,50 @@ void nxterm_scroll(FAR struct nxterm_state_s *priv, int scrollheight)
 
   priv->fpos.y -= scrollheight;
 
+#if CONFIG_NXTERM_SCROLLBATCH > 0
+  /* Defer the display update.  It is applied by nxterm_scrollflush() when
+   * the write completes or when enough lines have accumulated.
+   */
+
+  priv->scrollpend += scrollheight;
+  if (priv->scrollpend >= CONFIG_NXTERM_SCROLLBATCH * scrollheight)
+    {
+      nxterm_scrollflush(priv);
+    }
+#else
   /* Move the display in the range of 0-height up one scrollheight. */
 
   nxterm_movedisplay(priv, priv->fpos.y, scrollheight);
+#endif
 }
+
+/****************************************************************************
+ * Name: nxterm_scrollflush
+ *
+ * Description:
+ *   Bring the display up to date with any scrolling that was deferred by
+ *   nxterm_scroll().
+ *
+ ****************************************************************************/
+
+#if CONFIG_NXTERM_SCROLLBATCH > 0
+void nxterm_scrollflush(FAR struct nxterm_state_s *priv)
+{
+  if (priv->scrollpend > 0)
+    {
+#ifdef CONFIG_NX_WRITEONLY
+      int lineheight = priv->fheight + CONFIG_NXTERM_LINESEPARATION;
+
+      /* The display cannot be read back, so every line is rendered again
+       * from the cache, including the current line.  This costs the same
+       * for any number of scrolled lines.
+       */
+
+      nxterm_movedisplay(priv, priv->fpos.y + lineheight, lineheight);
+#else
+      nxterm_movebatch(priv, priv->scrollpend);
+#endif
+      priv->scrollpend = 0;
+    }
+}
+#endif
@@ -40,6 +40,10 @@
  * Included Files
  ****************************************************************************/
 
+#include <nuttx/config.h>
+#include <nuttx/compiler.h>
+
+#include <stddef.h>
 #include <stdint.h>
 
 /**************************************************************************
@@ -194,6 +198,61 @@ typedef int64_t  b32_t;
 typedef uint64_t ub32_t;
 #endif
 
+/* Fractional types for the array kernels:  Q15 and Q31 hold values in
+ * [-1, 1) with 15 and 31 bits of precision.
+ */
+
+typedef int16_t  q15_t;
+typedef int32_t  q31_t;
+
+#ifdef CONFIG_HAVE_LONG_LONG
+/* FIR filter instance.  'state' must hold ntaps + blocksize - 1 samples and
+ * 'coeffs' are in time-reversed order:  coeffs[0] multiplies the oldest
+ * sample of the window and coeffs[ntaps - 1] the newest one.
+ */
+
+struct q15_fir_s
+{
+  FAR const q15_t *coeffs;
+  FAR q15_t *state;
+  uint16_t ntaps;
+  uint16_t blocksize;
+};
+
+struct q31_fir_s
+{
+  FAR const q31_t *coeffs;
+  FAR q31_t *state;
+  uint16_t ntaps;
+  uint16_t blocksize;
+};
+
+/* One direct form I biquad section:
+ *
+ *   y[n] = (b0 * x[n] + b1 * x[n-1] + b2 * x[n-2] +
+ *           a1 * y[n-1] + a2 * y[n-2]) << shift
+ *
+ * coeffs[] is { b0, b1, b2, a1, a2 }, with a1 and a2 already negated, and
+ * 'shift' is the post-shift that lets coefficients reach +/-2^shift.
+ * state[] is { x[n-1], x[n-2], y[n-1], y[n-2] } and is zeroed by the init
+ * function.
+ */
+
+struct q15_biquad_s
+{
+  q15_t coeffs[5];
+  q15_t state[4];
+  uint8_t shift;
+};
+
+struct q31_biquad_s
+{
+  q31_t coeffs[5];
+  q31_t state[4];
+  uint8_t shift;
+};
+#endif
+
 /**************************************************************************
  * Global Functions
  **************************************************************************/
@@ -219,6 +278,48 @@ EXTERN b16_t b16sin(b16_t rad);
 EXTERN b16_t b16cos(b16_t rad);
 EXTERN b16_t b16atan2(b16_t y, b16_t x);
 
+/* Array kernels.  On cores with the DSP extension (Cortex-M4) the Q15
+ * kernels work on two samples per instruction and the Q31 ones use the
+ * saturating and most-significant-word multiply instructions; plain C is
+ * used elsewhere (Cortex-M0, simulator).  Results saturate.
+ */
+
+#ifdef CONFIG_HAVE_LONG_LONG
+EXTERN int64_t q15_dot(FAR const q15_t *a, FAR const q15_t *b, size_t n);
+EXTERN void q15_scale(FAR const q15_t *src, q15_t scale, FAR q15_t *dst,
+                      size_t n);
+EXTERN void q15_add(FAR const q15_t *a, FAR const q15_t *b, FAR q15_t *dst,
+                    size_t n);
+EXTERN void q15_sqrt(FAR const q15_t *src, FAR q15_t *dst, size_t n);
+EXTERN void q15_atan2(FAR const q15_t *y, FAR const q15_t *x,
+                      FAR q15_t *dst, size_t n);
+EXTERN void q15_fir_init(FAR struct q15_fir_s *fir, FAR const q15_t *coeffs,
+                         uint16_t ntaps, FAR q15_t *state,
+                         uint16_t blocksize);
+EXTERN int q15_fir(FAR struct q15_fir_s *fir, FAR const q15_t *src,
+                   FAR q15_t *dst, size_t n);
+EXTERN void q15_biquad_init(FAR struct q15_biquad_s *bq,
+                            FAR const q15_t *coeffs, uint8_t shift);
+EXTERN void q15_biquad(FAR struct q15_biquad_s *stages, int nstages,
+                       FAR const q15_t *src, FAR q15_t *dst, size_t n);
+
+EXTERN int64_t q31_dot(FAR const q31_t *a, FAR const q31_t *b, size_t n);
+EXTERN void q31_scale(FAR const q31_t *src, q31_t scale, FAR q31_t *dst,
+                      size_t n);
+EXTERN void q31_add(FAR const q31_t *a, FAR const q31_t *b, FAR q31_t *dst,
+                    size_t n);
+EXTERN void q31_sqrt(FAR const q31_t *src, FAR q31_t *dst, size_t n);
+EXTERN void q31_fir_init(FAR struct q31_fir_s *fir, FAR const q31_t *coeffs,
+                         uint16_t ntaps, FAR q31_t *state,
+                         uint16_t blocksize);
+EXTERN int q31_fir(FAR struct q31_fir_s *fir, FAR const q31_t *src,
+                   FAR q31_t *dst, size_t n);
+EXTERN void q31_biquad_init(FAR struct q31_biquad_s *bq,
+                            FAR const q31_t *coeffs, uint8_t shift);
+EXTERN void q31_biquad(FAR struct q31_biquad_s *stages, int nstages,
+                       FAR const q31_t *src, FAR q31_t *dst, size_t n);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -63,14 +63,14 @@
  ************************************************************************************/
 
 /* Default configuration settings that may be overridden in the NuttX configuration
- * file.  The configured size is limited to 255 to fit into a uint8_t.
+ * file.  The configured size is limited to 65535 to fit into a uint16_t.
  */
 
 #if !defined(CONFIG_ADC_FIFOSIZE)
 #  define CONFIG_ADC_FIFOSIZE 8
-#elif CONFIG_ADC_FIFOSIZE > 255
+#elif CONFIG_ADC_FIFOSIZE > 65535
 #  undef  CONFIG_ADC_FIFOSIZE
-#  define CONFIG_ADC_FIFOSIZE 255
+#  define CONFIG_ADC_FIFOSIZE 65535
 #endif
 
 /************************************************************************************
@@ -86,8 +86,8 @@ struct adc_msg_s
 struct adc_fifo_s
 {
   sem_t        af_sem;                   /* Counting semaphore */
-  uint8_t      af_head;                  /* Index to the head [IN] index in the circular buffer */
-  uint8_t      af_tail;                  /* Index to the tail [OUT] index in the circular buffer */
+  uint16_t     af_head;                  /* Index to the head [IN] index in the circular buffer */
+  uint16_t     af_tail;                  /* Index to the tail [OUT] index in the circular buffer */
                                          /* Circular buffer of CAN messages */
   struct adc_msg_s af_buffer[CONFIG_ADC_FIFOSIZE];
 };
@@ -217,6 +217,32 @@ int adc_register(FAR const char *path, FAR struct adc_dev_s *dev);
 
 int adc_receive(FAR struct adc_dev_s *dev, uint8_t ch, int32_t data);
 
+/************************************************************************************
+ * Name: adc_receive_block
+ *
+ * Description:
+ *   This function is called from the lower half, platform-specific ADC logic when
+ *   a block of ADC samples is available, typically from a DMA transfer complete
+ *   interrupt.  The samples are queued in the same FIFO as adc_receive(), but
+ *   readers are only notified once for the whole block.
+ *
+ * Input Parameters:
+ *   dev - The ADC device structure that was previously registered by adc_register()
+ *   chanlist - The conversion sequence.  Sample i was converted on channel
+ *     chanlist[i % nchannels].
+ *   nchannels - The number of channels in the conversion sequence
+ *   data - The converted samples
+ *   nsamples - The number of samples in data
+ *
+ * Returned Value:
+ *   The number of samples queued.  This is less than nsamples if the FIFO
+ *   overflowed; the remaining samples are discarded.
+ *
+ ************************************************************************************/
+
+int adc_receive_block(FAR struct adc_dev_s *dev, FAR const uint8_t *chanlist,
+                      int nchannels, FAR const uint16_t *data, int nsamples);
+
 /************************************************************************************
  * Platform-Independent "Lower Half" ADC Driver Interfaces
  ************************************************************************************/
@@ -1932,6 +1932,46 @@ void irq_perf_foreach(irq_perf_foreach_t handler, FAR void *arg);
 typedef void (*sched_perf_foreach_t)(pid_t pid, FAR const char *name, uint32_t time, FAR void *arg);
 
 void sched_perf_foreach(sched_perf_foreach_t handler, FAR void *arg);
+
+/************************************************************************
+ * Name: perf_track_active
+ *
+ * Description:
+ *   Report whether performance tracking is running.
+ *
+ * Inputs:
+ *   none
+ *
+ * Return Value:
+ *   true between start_perf_track and stop_perf_track
+ *
+ ************************************************************************/
+bool perf_track_active(void);
+
+/************************************************************************
+ * Name: sched_perf_stats
+ *
+ * Description:
+ *   Get the accounting data of one task.
+ *
+ * Inputs:
+ *   pid - task to sample
+ *   stats - returned data
+ *
+ * Return Value:
+ *   OK (0) on success
+ *   -ESRCH if there is no such task
+ *
+ ************************************************************************/
+struct perf_stats_s
+{
+  uint32_t run_time;           /* uSec spent running */
+  uint32_t nvcsw;              /* Switches away while blocking */
+  uint32_t nivcsw;             /* Switches away while preempted */
+  uint32_t lock_time;          /* uSec spent with pre-emption disabled */
+};
+
+int sched_perf_stats(pid_t pid, FAR struct perf_stats_s *stats);
 #endif
 
 /****************************************************************************
@@ -103,6 +103,18 @@
  * AUDIOIOC_STOP - Stop Audio streaming
  *
  *   ioctl argument:  None
+ *
+ * AUDIOIOC_SETPREFETCH - Set the number of buffers the upper half collects
+ *   before passing them on to the lower half after an underrun.  Values of
+ *   0 or 1 pass every buffer straight through.
+ *
+ *   ioctl argument:  The prefetch depth
+ *
+ * AUDIOIOC_GETSTATS - Get the buffer pipeline statistics.  The counters
+ *   are cleared by AUDIOIOC_START.
+ *
+ *   ioctl argument:  Pointer to the audio_stats_s structure to receive the
+ *                    statistics.
  */
 
 #define AUDIOIOC_GETCAPS            _AUDIOIOC(1)
@@ -121,6 +133,8 @@
 #define AUDIOIOC_REGISTERMQ         _AUDIOIOC(14)
 #define AUDIOIOC_UNREGISTERMQ       _AUDIOIOC(15)
 #define AUDIOIOC_HWRESET            _AUDIOIOC(16)
+#define AUDIOIOC_SETPREFETCH        _AUDIOIOC(17)
+#define AUDIOIOC_GETSTATS           _AUDIOIOC(18)
 
 /* Audio Device Types *******************************************************/
 /* The NuttX audio interface support different types of audio devices for
@@ -430,6 +444,19 @@ struct audio_buf_desc_s
   } u;
 };
 
+/* Buffer pipeline statistics returned by the AUDIOIOC_GETSTATS ioctl */
+
+struct audio_stats_s
+{
+  uint32_t            enqueued;           /* Buffers passed to the lower half */
+  uint32_t            dequeued;           /* Buffers returned by the lower half */
+  uint32_t            underruns;          /* Times the lower half ran dry mid-stream */
+  uint16_t            depth;              /* Buffers now queued in the lower half */
+  uint16_t            lowwater;           /* Fewest buffers queued since start */
+  uint16_t            held;               /* Buffers held back while re-priming */
+  uint16_t            prefetch;           /* Re-prime depth after an underrun */
+};
+
 /* Typedef for lower-level to upper-level callback for buffer dequeuing */
 
 #ifdef CONFIG_AUDIO_MULTI_SESSION
@@ -161,6 +161,31 @@ extern "C"
 FAR struct audio_lowerhalf_s *
   pcm_decode_initialize(FAR struct audio_lowerhalf_s *dev);
 
+/****************************************************************************
+ * Name: pcm_mixer_initialize
+ *
+ * Description:
+ *   Initialize a PCM mixer.  The mixer contains a low-level audio DAC-type
+ *   device and returns nsources new audio lower halves that share it.
+ *   Each carries 16-bit mono or stereo PCM at its own sample rate.
+ *
+ * Input Parameters:
+ *   dev      - A reference to the low-level audio DAC-type device to
+ *              contain.
+ *   sources  - Receives the nsources mixer inputs.
+ *   nsources - Number of inputs to create.
+ *
+ * Returned Value:
+ *   Zero on success; a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_AUDIO_MIXER
+int pcm_mixer_initialize(FAR struct audio_lowerhalf_s *dev,
+                         FAR struct audio_lowerhalf_s **sources,
+                         int nsources);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
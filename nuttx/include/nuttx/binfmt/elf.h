@@ -82,6 +82,16 @@
 #  define LIBELF_NALLOC      1
 #endif
 
+/* Address where .text (and hence the entry point) lies: in the memory
+ * mapped file if the text is executed in place, else in textalloc.
+ */
+
+#ifdef CONFIG_ELF_XIP
+#  define ELF_TEXTBASE(l)    ((l)->xipbase != NULL ? (l)->xiptext : (l)->textalloc)
+#else
+#  define ELF_TEXTBASE(l)    ((l)->textalloc)
+#endif
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -113,6 +123,20 @@ struct elf_loadinfo_s
   FAR Elf32_Shdr    *shdr;       /* Buffered ELF section headers */
   uint8_t           *iobuffer;   /* File I/O buffer */
 
+  /* Execute in place.  If the file can be memory mapped (FIOC_MMAP) and
+   * its read-only sections need no relocation, those sections are used
+   * where they lie and only .data/.bss are allocated.
+   *
+   * xipbase - Address of the memory mapped file, or NULL if the module is
+   *   copied into RAM.
+   * xiptext - Address of the first read-only section (.text) in place.
+   */
+
+#ifdef CONFIG_ELF_XIP
+  FAR const uint8_t *xipbase;    /* Memory mapped ELF file */
+  uintptr_t          xiptext;    /* .text in the memory mapped file */
+#endif
+
   /* Constructors and destructors */
 
 #ifdef CONFIG_BINFMT_CONSTRUCTORS
@@ -42,6 +42,8 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -62,12 +64,18 @@
  *    adding or removing entries from the symbol table (realloc might be
  *    used for that purpose if needed).  The intention is to support only
  *    fixed size arrays completely defined at compilation or link time.
+ *
+ * With CONFIG_SYMTAB_HASHED, sym_hash holds symtab_hash(sym_name) and the
+ * table is ordered by sym_hash.  Both are produced by 'mksymtab -h'.
  */
 
 struct symtab_s
 {
   FAR const char *sym_name;          /* A pointer to the symbol name string */
   FAR const void *sym_value;         /* The value associated witht the string */
+#ifdef CONFIG_SYMTAB_HASHED
+  uint32_t sym_hash;                 /* symtab_hash(sym_name) */
+#endif
 };
 
 /****************************************************************************
@@ -152,6 +160,36 @@ FAR const struct symtab_s *
 symtab_findorderedbyname(FAR const struct symtab_s *symtab,
                          FAR const char *name, int nsyms);
 
+#ifdef CONFIG_SYMTAB_HASHED
+/****************************************************************************
+ * Name: symtab_hash
+ *
+ * Description:
+ *   Return the hash of a symbol name (32-bit FNV-1a).  This must match the
+ *   hash computed by tools/mksymtab.c.
+ *
+ ****************************************************************************/
+
+uint32_t symtab_hash(FAR const char *name);
+
+/****************************************************************************
+ * Name: symtab_findhashedbyname
+ *
+ * Description:
+ *   Find the symbol in the symbol table with the matching name.
+ *   This version assumes that table is ordered with respect to sym_hash.
+ *
+ * Returned Value:
+ *   A reference to the symbol table entry if an entry with the matching
+ *   name is found; NULL is returned if the entry is not found.
+ *
+ ****************************************************************************/
+
+FAR const struct symtab_s *
+symtab_findhashedbyname(FAR const struct symtab_s *symtab,
+                        FAR const char *name, int nsyms);
+#endif
+
 /****************************************************************************
  * Name: symtab_findbyvalue
  *
@@ -0,0 +1,199 @@
+/****************************************************************************
+ * include/nuttx/bootphase.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_BOOTPHASE_H
+#define __INCLUDE_NUTTX_BOOTPHASE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_BOOT_TRACE
+#  define boottrace_initialize()
+#  define boottrace_mark(n)
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One boot timeline event */
+
+struct boottrace_entry_s
+{
+  FAR const char *name;        /* Name of the milestone */
+  uint32_t usec;               /* Time since os_start() in microseconds */
+};
+
+/* Deferred initialization function */
+
+typedef void (*boot_defer_t)(FAR void *arg);
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+#ifdef CONFIG_BOOT_TRACE
+/****************************************************************************
+ * Name: boottrace_initialize
+ *
+ * Description:
+ *   Start the boot timeline.  Called first thing in os_start().
+ *
+ ****************************************************************************/
+
+void boottrace_initialize(void);
+
+/****************************************************************************
+ * Name: boottrace_mark
+ *
+ * Description:
+ *   Record that the milestone 'name' has been reached.  'name' must stay
+ *   valid forever, normally it is a string literal.  Milestones past
+ *   CONFIG_BOOT_TRACE_NENTRIES are counted but not kept.
+ *
+ ****************************************************************************/
+
+void boottrace_mark(FAR const char *name);
+
+/****************************************************************************
+ * Name: boottrace_get
+ *
+ * Description:
+ *   Copy up to 'max' milestones, oldest first, to 'entries'.  Return the
+ *   number copied and, if 'dropped' is not NULL, the number not kept.
+ *
+ ****************************************************************************/
+
+int boottrace_get(FAR struct boottrace_entry_s *entries, int max,
+                  FAR uint32_t *dropped);
+
+/****************************************************************************
+ * Name: up_boottrace_initialize
+ *
+ * Description:
+ *   Start the free-running cycle counter used for the timeline.
+ *
+ ****************************************************************************/
+
+void up_boottrace_initialize(void);
+
+/****************************************************************************
+ * Name: up_boottrace_cycles
+ *
+ * Description:
+ *   Return the current value of the free-running cycle counter.
+ *
+ ****************************************************************************/
+
+uint32_t up_boottrace_cycles(void);
+
+/****************************************************************************
+ * Name: up_boottrace_frequency
+ *
+ * Description:
+ *   Return the rate of the cycle counter in Hz.
+ *
+ ****************************************************************************/
+
+uint32_t up_boottrace_frequency(void);
+#endif /* CONFIG_BOOT_TRACE */
+
+#ifdef CONFIG_BOOT_DEFER
+/****************************************************************************
+ * Name: boot_defer
+ *
+ * Description:
+ *   Queue 'func' to be called with 'arg' once the essential part of the
+ *   boot is over, see boot_defer_start().  Functions run in the order they
+ *   were queued.  When the queue is full, or boot_defer_start() was
+ *   already called, 'func' is called immediately.
+ *
+ * Returned Value:
+ *   OK, or a negated errno value if 'func' is NULL.
+ *
+ ****************************************************************************/
+
+int boot_defer(FAR const char *name, boot_defer_t func, FAR void *arg);
+
+/****************************************************************************
+ * Name: boot_defer_start
+ *
+ * Description:
+ *   Start the low priority thread that runs the queued functions.  Called
+ *   by the application once the functions needed to answer the host are
+ *   up.
+ *
+ ****************************************************************************/
+
+int boot_defer_start(void);
+#else
+
+/* Without deferral everything is essential: run it right away */
+
+static inline int boot_defer(FAR const char *name, boot_defer_t func,
+                             FAR void *arg)
+{
+  func(arg);
+  return 0;
+}
+
+static inline int boot_defer_start(void)
+{
+  return 0;
+}
+#endif /* CONFIG_BOOT_DEFER */
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __INCLUDE_NUTTX_BOOTPHASE_H */
@@ -0,0 +1,216 @@
+/****************************************************************************
+ * include/nuttx/bufqueue.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_BUFQUEUE_H
+#define __INCLUDE_NUTTX_BUFQUEUE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+
+#include <nuttx/fs/ioctl.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* IOCTL Commands ***********************************************************/
+/* A driver that streams through a buffer queue hands out a pool of buffers
+ * in user memory and exchanges only buffer indices with the application,
+ * the way V4L2 does:
+ *
+ * BQIOC_REQBUFS   - Allocate (count > 0) or free (count == 0) the pool.
+ *                   Argument: FAR struct bq_request_s *; the driver may
+ *                   lower count and raise size.
+ * BQIOC_QUERYBUF  - Get the address and length of buffer 'index'.
+ *                   Argument: FAR struct bq_buffer_s *
+ * BQIOC_QBUF      - Give buffer 'index' to the driver:  To be filled
+ *                   (BQ_CAPTURE) or to send 'bytesused' bytes from
+ *                   (BQ_OUTPUT).  Argument: FAR struct bq_buffer_s *
+ * BQIOC_DQBUF     - Take back the oldest completed buffer.  Blocks unless
+ *                   the file is O_NONBLOCK (-EAGAIN then).
+ *                   Argument: FAR struct bq_buffer_s *
+ * BQIOC_STREAMON  - Start passing queued buffers to the hardware.
+ * BQIOC_STREAMOFF - Stop.  Buffers not yet passed to the hardware complete
+ *                   with status -ESHUTDOWN.  Argument: None
+ */
+
+#define BQIOC_REQBUFS    _BQIOC(0x0001)
+#define BQIOC_QUERYBUF   _BQIOC(0x0002)
+#define BQIOC_QBUF       _BQIOC(0x0003)
+#define BQIOC_DQBUF      _BQIOC(0x0004)
+#define BQIOC_STREAMON   _BQIOC(0x0005)
+#define BQIOC_STREAMOFF  _BQIOC(0x0006)
+
+/* Buffer queue directions */
+
+#define BQ_CAPTURE       0  /* The driver fills the buffers */
+#define BQ_OUTPUT        1  /* The application fills the buffers */
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* Argument of BQIOC_REQBUFS */
+
+struct bq_request_s
+{
+  uint8_t  type;           /* BQ_CAPTURE or BQ_OUTPUT */
+  uint8_t  count;          /* Number of buffers */
+  uint32_t size;           /* Size of one buffer in bytes */
+};
+
+/* Argument of BQIOC_QUERYBUF, BQIOC_QBUF and BQIOC_DQBUF */
+
+struct bq_buffer_s
+{
+  uint8_t  index;          /* Buffer index, 0 .. count - 1 */
+  uint32_t bytesused;      /* Valid data in the buffer */
+  int32_t  status;         /* Result of the transfer (DQBUF) */
+  FAR void *addr;          /* Address of the buffer (QUERYBUF) */
+  uint32_t length;         /* Size of the buffer (QUERYBUF) */
+};
+
+#ifdef CONFIG_DRVR_BUFQUEUE
+
+/* The driver side of a buffer queue.  The callbacks are made with the
+ * queue's exclusive access held, never from interrupt level.
+ *
+ * queue  - Pass buffer 'index' to the hardware.  'bytesused' is the
+ *          amount of data to send for BQ_OUTPUT.  When the transfer ends,
+ *          the driver calls bq_done().  A negated errno value completes
+ *          the buffer with that status instead.
+ * stream - Called on BQIOC_STREAMON and BQIOC_STREAMOFF.  May be NULL.
+ */
+
+struct bufqueue_s;
+struct bq_ops_s
+{
+  CODE int (*queue)(FAR struct bufqueue_s *bq, unsigned int index,
+                    size_t bytesused);
+  CODE int (*stream)(FAR struct bufqueue_s *bq, bool on);
+};
+
+/* This structure holds the state of a buffer queue.  It is normally
+ * embedded in the device structure of the driver:  Set 'ops', 'priv' and
+ * 'headroom', then call bq_initialize().
+ */
+
+struct bufqueue_s
+{
+  /* These values must be provided by the driver prior to calling
+   * bq_initialize()
+   */
+
+  FAR const struct bq_ops_s *ops; /* Driver callbacks */
+  FAR void     *priv;             /* Driver state for the callbacks */
+  size_t        headroom;         /* Driver header space before each buffer */
+
+  /* The driver should never modify any of the remaining fields */
+
+  sem_t         exclsem;          /* Exclusive access to the queue */
+  sem_t         donesem;          /* Counts the buffers in done[] */
+  FAR uint8_t  *pool;             /* The buffers, in user memory */
+  size_t        size;             /* Size of one buffer */
+  size_t        stride;           /* Distance between buffers in the pool */
+  uint8_t       type;             /* BQ_CAPTURE or BQ_OUTPUT */
+  uint8_t       count;            /* Number of buffers in the pool */
+  bool          streaming;        /* Between STREAMON and STREAMOFF */
+  uint8_t       npending;         /* Number of buffers in pending[] */
+  uint8_t       donehead;         /* Oldest entry in done[] */
+  uint8_t       ndone;            /* Number of buffers in done[] */
+  uint8_t       state[CONFIG_DRVR_BUFQUEUE_MAXBUFS];
+  uint8_t       pending[CONFIG_DRVR_BUFQUEUE_MAXBUFS];
+  uint8_t       done[CONFIG_DRVR_BUFQUEUE_MAXBUFS];
+  uint32_t      bytesused[CONFIG_DRVR_BUFQUEUE_MAXBUFS];
+  int32_t       status[CONFIG_DRVR_BUFQUEUE_MAXBUFS];
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+struct file;
+
+/* Queue initialization */
+
+void bq_initialize(FAR struct bufqueue_s *bq);
+void bq_uninitialize(FAR struct bufqueue_s *bq);
+
+/* Handle the BQIOC_* commands.  Returns -ENOTTY for any other command so
+ * that the driver can process it.
+ */
+
+int bq_ioctl(FAR struct bufqueue_s *bq, FAR struct file *filep, int cmd,
+             unsigned long arg);
+
+/* Called by the driver, possibly from interrupt level, when the transfer
+ * of a buffer given to it with the 'queue' callback has ended.
+ */
+
+void bq_done(FAR struct bufqueue_s *bq, unsigned int index,
+             size_t bytesused, int status);
+
+/* Map between buffer indices and memory.  bq_header() returns the start
+ * of the driver's headroom, bq_data() the start of the application data.
+ * bq_index() accepts any address inside a buffer or its headroom.
+ */
+
+FAR void *bq_header(FAR struct bufqueue_s *bq, unsigned int index);
+FAR void *bq_data(FAR struct bufqueue_s *bq, unsigned int index);
+int bq_index(FAR struct bufqueue_s *bq, FAR const void *addr);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CONFIG_DRVR_BUFQUEUE */
+#endif /* __INCLUDE_NUTTX_BUFQUEUE_H */
@@ -41,6 +41,9 @@
  *   send_metadata_oneshot. If send_metadata_oneshot is not called in
  *   METADATA_MAX_IDLE_TIME_MS, meta data task will send out a default/empty
  *   meta data.
+ * - send_metadata_oneshot queues the frame's metadata, the oldest queued
+ *   frame is dropped when the host falls behind. get_metadata_stats reports
+ *   the frames sent and dropped since streaming on.
  */
 typedef enum {
     CAM_METADATA_AUTOFOCUS_REQ_NOT_VALID = 0,
@@ -148,6 +151,7 @@ int start_metadata_task(void);
 void stop_metadata_task(void);
 
 void send_metadata_oneshot(void);
+void get_metadata_stats(uint32_t *sent, uint32_t *dropped);
 
 void set_autofocus_metadata(cam_metadata_autofocus_request_result_e result,
         cam_metadata_autofocus_status_e status);
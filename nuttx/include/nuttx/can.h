@@ -49,6 +49,7 @@
 #include <semaphore.h>
 
 #include <nuttx/fs/fs.h>
+#include <nuttx/wdog.h>
 
 #ifdef CONFIG_CAN
 
@@ -112,15 +113,30 @@
 /* Built-in ioctl commands
  *
  * CANIOCTL_RTR: Send the remote transmission request and wait for the response.
+ * CANIOCTL_RXWAKEUP: Coalesce reader wakeups.  A blocking read() returns once
+ *   cw_count messages are queued, or cw_msec milliseconds after the first
+ *   message was queued, whichever comes first.  cw_count = 1 (the default)
+ *   returns as soon as one message is available; cw_msec = 0 means no time
+ *   bound.
+ * CANIOCTL_ADD_FILTER: Program an acceptance filter in the CAN controller.  Once
+ *   at least one filter is installed, only matching messages are received.
+ *   On success, cf_index is set to the filter index.  Implemented by the lower
+ *   half; -ENOTTY if the controller has no filter support, -ENOSPC if all
+ *   filters are in use.
+ * CANIOCTL_DEL_FILTER: Remove the filter with index cf_index.  Removing the last
+ *   filter receives all messages again.
  */
 
 #define CANIOCTL_RTR              1 /* Argument is a reference to struct canioctl_rtr_s */
+#define CANIOCTL_RXWAKEUP         2 /* Argument is a reference to struct canioctl_rxwakeup_s */
+#define CANIOCTL_ADD_FILTER       3 /* Argument is a reference to struct canioctl_filter_s */
+#define CANIOCTL_DEL_FILTER       4 /* Argument is a reference to struct canioctl_filter_s */
 
 /* CANIOCTL_USER: Device specific ioctl calls can be supported with cmds greater
  * than this value
  */
 
-#define CANIOCTL_USER             2
+#define CANIOCTL_USER             5
 
 /************************************************************************************
  * Public Types
@@ -284,6 +300,12 @@ struct can_dev_s
   uint8_t              cd_ocount;        /* The number of times the device has been opened */
   uint8_t              cd_npendrtr;      /* Number of pending RTR messages */
   uint8_t              cd_ntxwaiters;    /* Number of threads waiting to enqueue a message */
+  uint8_t              cd_nrxwaiters;    /* Number of threads waiting for read data */
+  uint8_t              cd_rxcount;       /* Wake readers when this many messages are queued */
+  bool                 cd_rxexpired;     /* The wakeup delay elapsed */
+  bool                 cd_rxwdactive;    /* cd_rxwdog is running */
+  int                  cd_rxdelay;       /* Wake readers this many ticks after the first message */
+  WDOG_ID              cd_rxwdog;        /* Bounds the wakeup delay */
   sem_t                cd_closesem;      /* Locks out new opens while close is in progress */
   sem_t                cd_recvsem;       /* Used to wakeup user waiting for space in cd_recv.buffer */
   struct can_txfifo_s  cd_xmit;          /* Describes transmit FIFO */
@@ -302,6 +324,20 @@ struct canioctl_rtr_s
   FAR struct can_msg_s *ci_msg;          /* The location to return the RTR response */
 };
 
+struct canioctl_rxwakeup_s
+{
+  uint8_t               cw_count;        /* Wake up when this many messages are queued */
+  uint16_t              cw_msec;         /* ... or this long after the first one (0: never) */
+};
+
+struct canioctl_filter_s
+{
+  uint32_t              cf_id;           /* The 11- or 29-bit ID to match */
+  uint32_t              cf_mask;         /* ID bits that must match (1) or are ignored (0) */
+  bool                  cf_extid;        /* Match extended (true) or standard IDs */
+  int                   cf_index;        /* Filter index (out for ADD, in for DEL) */
+};
+
 /************************************************************************************
  * Public Data
  ************************************************************************************/
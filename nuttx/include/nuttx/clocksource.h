@@ -0,0 +1,134 @@
+/****************************************************************************
+ * include/nuttx/clocksource.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_CLOCKSOURCE_H
+#define __INCLUDE_NUTTX_CLOCKSOURCE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef CONFIG_CLOCKSOURCE
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* A free running hardware counter.  read() returns a 32-bit value that
+ * increments at 'freq' Hz and wraps around to 0, it must be callable from
+ * interrupt handlers.
+ */
+
+struct clocksource_s
+{
+  FAR const char *name;
+  CODE uint32_t (*read)(void);
+  uint32_t freq;
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: clocksource_register
+ *
+ * Description:
+ *   Make 'cs' the source of CLOCK_MONOTONIC and CLOCK_MONOTONIC_RAW.  The
+ *   time continues from the value of CLOCK_MONOTONIC at the time of the
+ *   call.  Called once, at boot, when the OS timers are initialized.
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno value on failure.
+ *
+ ****************************************************************************/
+
+int clocksource_register(FAR const struct clocksource_s *cs);
+
+/****************************************************************************
+ * Name: clocksource_gettime
+ *
+ * Description:
+ *   Read the time from the clock source, without a critical section.  May
+ *   be called from interrupt handlers.
+ *
+ * Returned Value:
+ *   Zero on success, -ENODEV if no clock source is registered.
+ *
+ ****************************************************************************/
+
+int clocksource_gettime(FAR struct timespec *ts);
+
+/****************************************************************************
+ * Name: clocksource_getns
+ *
+ * Description:
+ *   Same as clocksource_gettime(), in nanoseconds.  Returns 0 if no clock
+ *   source is registered.
+ *
+ ****************************************************************************/
+
+uint64_t clocksource_getns(void);
+
+/****************************************************************************
+ * Name: clocksource_resolution
+ *
+ * Description:
+ *   Return the resolution of the clock source in nanoseconds, 0 if no
+ *   clock source is registered.
+ *
+ ****************************************************************************/
+
+uint32_t clocksource_resolution(void);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_CLOCKSOURCE */
+#endif /* __INCLUDE_NUTTX_CLOCKSOURCE_H */
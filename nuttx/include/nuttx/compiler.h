@@ -115,6 +115,12 @@
 # define inline_function __attribute__ ((always_inline))
 # define noinline_function __attribute__ ((noinline))
 
+/* The locate_code attribute places a function in the named section, for
+ * example ".ramfunc" (see CONFIG_ARCH_RAMFUNCS).
+ */
+
+# define locate_code(n) __attribute__ ((section(n)))
+
 /* GCC has does not use storage classes to qualify addressing */
 
 # define FAR
@@ -261,6 +267,7 @@
 
 # define inline_function
 # define noinline_function
+# define locate_code(n)
 
 /* The reentrant attribute informs SDCC that the function
  * must be reentrant.  In this case, SDCC will store input
@@ -363,6 +370,7 @@
 # define naked_function
 # define inline_function
 # define noinline_function
+# define locate_code(n)
 
 /* REVISIT: */
 
@@ -453,6 +461,7 @@
 # define naked_function
 # define inline_function
 # define noinline_function
+# define locate_code(n)
 
 # define FAR
 # define NEAR
@@ -41,6 +41,9 @@
  ****************************************************************************/
 
 #include <nuttx/config.h>
+
+#include <stddef.h>
+#include <stdint.h>
 #include <debug.h>
 
 /****************************************************************************
@@ -60,6 +63,65 @@
 #define CYPHER_ENCRYPT 1
 #define CYPHER_DECRYPT 0
 
+#define SHA256_DIGEST_SIZE 32
+
+/* Algorithms that a backend may implement (see crypto_findbackend()) */
+
+#define CRYPTO_ALG_AES     1  /* aes_cypher(), all AES_MODE_* */
+#define CRYPTO_ALG_SHA256  2  /* crypto_sha256() */
+
+/* Backend flags (same values as in cryptodev.h) */
+
+#ifndef CRYPTO_FLAG_HARDWARE
+#  define CRYPTO_FLAG_HARDWARE 0x01000000
+#  define CRYPTO_FLAG_SOFTWARE 0x02000000
+#endif
+
+/************************************************************************************
+ * Public Types
+ ************************************************************************************/
+
+#ifndef __ASSEMBLY__
+
+/* A crypto backend: a hardware engine or a software implementation of one
+ * or more algorithms.  Operations that the backend does not implement are
+ * NULL.  For each algorithm, the API functions use the first registered
+ * backend with CRYPTO_FLAG_HARDWARE and fall back to a CRYPTO_FLAG_SOFTWARE
+ * one.
+ */
+
+struct crypto_backend_s
+{
+  FAR struct crypto_backend_s *flink; /* Used internally to link backends */
+  FAR const char *name;               /* For diagnostics and benchmarks */
+  uint32_t flags;                     /* CRYPTO_FLAG_HARDWARE or _SOFTWARE */
+
+  /* Same semantics as aes_cypher() */
+
+  CODE int (*aes)(FAR void *out, FAR const void *in, uint32_t size,
+                  FAR const void *iv, FAR const void *key, uint32_t keysize,
+                  int mode, int encrypt);
+
+  /* Same semantics as crypto_sha256() */
+
+  CODE int (*sha256)(FAR const void *in, uint32_t size, FAR uint8_t *digest);
+};
+
+/* Incremental SHA-256 (software).  Use crypto_sha256() for a buffer that
+ * is available all at once, so that a hardware backend can be used.
+ */
+
+#if defined(CONFIG_CRYPTO_SHA256)
+struct sha256_ctx_s
+{
+  uint32_t state[8];
+  uint64_t count;                     /* Bytes hashed so far */
+  uint8_t  buffer[64];                /* Partial block */
+};
+#endif
+
+#endif /* __ASSEMBLY__ */
+
 /************************************************************************************
  * Public Data
  ************************************************************************************/
@@ -79,12 +141,37 @@ extern "C"
  * Public Function Prototypes
  ************************************************************************************/
 
+int up_cryptoinitialize(void);
+int crypto_test(void);
+
+#if defined(CONFIG_CRYPTO_BENCHMARK)
+void crypto_benchmark(void);
+#endif
+
+/* Backend registry (crypto/crypto.c).  Backends register themselves during
+ * initialization, e.g. from up_aesinitialize().
+ */
+
+int crypto_register(FAR struct crypto_backend_s *backend);
+FAR const struct crypto_backend_s *
+crypto_nextbackend(FAR const struct crypto_backend_s *backend);
+FAR const struct crypto_backend_s *crypto_findbackend(int alg);
+
 #if defined(CONFIG_CRYPTO_AES)
 int up_aesinitialize(void);
 int aes_cypher(FAR void *out, FAR const void *in, uint32_t size, FAR const void *iv,
                FAR const void *key, uint32_t keysize, int mode, int encrypt);
 #endif
 
+#if defined(CONFIG_CRYPTO_SHA256)
+int crypto_sha256(FAR const void *in, uint32_t size, FAR uint8_t *digest);
+void sha256_init(FAR struct sha256_ctx_s *ctx);
+void sha256_update(FAR struct sha256_ctx_s *ctx, FAR const void *in,
+                   size_t size);
+void sha256_final(FAR struct sha256_ctx_s *ctx, FAR uint8_t *digest);
+int sha256_initialize(void);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
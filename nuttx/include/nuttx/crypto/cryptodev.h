@@ -53,10 +53,13 @@
 #define CRYPTO_AES_ECB          1
 #define CRYPTO_AES_CBC          2
 #define CRYPTO_AES_CTR          3
-#define CRYPTO_ALGORITHM_MAX    1
+#define CRYPTO_SHA2_256         4  /* MAC only: digest of src into mac */
+#define CRYPTO_ALGORITHM_MAX    4
 
-#define CRYPTO_FLAG_HARDWARE    0x01000000 /* hardware accelerated */
-#define CRYPTO_FLAG_SOFTWARE    0x02000000 /* software implementation */
+#ifndef CRYPTO_FLAG_HARDWARE
+#  define CRYPTO_FLAG_HARDWARE  0x01000000 /* hardware accelerated */
+#  define CRYPTO_FLAG_SOFTWARE  0x02000000 /* software implementation */
+#endif
 
 #define COP_ENCRYPT             1
 #define COP_DECRYPT             2
@@ -65,6 +68,7 @@
 #define CIOCGSESSION            101
 #define CIOCFSESSION            102
 #define CIOCCRYPT               103
+#define CIOCNCRYPTM             104  /* Batch of struct crypt_op */
 
 typedef char* caddr_t;
 
@@ -92,4 +96,16 @@ struct crypt_op
   caddr_t iv;
 };
 
+/* CIOCNCRYPTM: run 'count' requests in one call.  The buffers are used in
+ * place; nothing is copied.  Processing stops at the first failing request
+ * and 'done' returns the number of requests completed.
+ */
+
+struct crypt_n_op
+{
+  uint32_t count;
+  FAR struct crypt_op *reqs;
+  uint32_t done;      /* returns: requests completed */
+};
+
 #endif /* __INCLUDE_NUTTX_CRYPTO_CRYPTODEV_H */
@@ -32,9 +32,15 @@
 #define __INCLUDE_NUTTX_DEVICE_H
 
 #include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <assert.h>
 #include <nuttx/ring_buf.h>
 
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+#include <nuttx/wqueue.h>
+#endif
+
 enum device_resource_type {
     DEVICE_RESOURCE_TYPE_INVALID,
     DEVICE_RESOURCE_TYPE_REGS,
@@ -67,6 +73,13 @@ struct device_driver_ops {
     int     (*open)(struct device *dev);
     void    (*close)(struct device *dev);
     void    *type_ops;
+
+    /*
+     * Runtime PM, optional: gate and restore the clocks of an idle device.
+     * A runtime_suspend returning non-zero keeps the device active.
+     */
+    int     (*runtime_suspend)(struct device *dev);
+    int     (*runtime_resume)(struct device *dev);
 };
 
 struct device_driver {
@@ -88,6 +101,18 @@ struct device {
     enum device_state       state;
     struct device_driver    *driver;
     void                    *private;
+    struct device           *hash_next;
+#ifdef CONFIG_DEVICE_STATS
+    /* Successful opens, and the time they took (usec) */
+    unsigned int            open_count;
+    uint32_t                open_usec_max;
+    uint32_t                open_usec_total;
+#endif
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+    int                     pm_usage;
+    bool                    pm_suspended;
+    struct work_s           pm_work;
+#endif
 };
 
 /* Called by device driver clients */
@@ -96,8 +121,23 @@ void device_close(struct device *dev);
 
 /* Called by device drivers */
 int device_register_driver(struct device_driver *driver);
+int device_register_driver_deferred(struct device_driver *driver);
 void device_unregister_driver(struct device_driver *driver);
 
+#ifdef CONFIG_DEVICE_RUNTIME_PM
+int device_pm_get(struct device *dev);
+void device_pm_put(struct device *dev);
+#else
+static inline int device_pm_get(struct device *dev)
+{
+    return 0;
+}
+
+static inline void device_pm_put(struct device *dev)
+{
+}
+#endif
+
 struct device_resource *device_resource_get(struct device *dev,
                                             enum device_resource_type type,
                                             unsigned int num);
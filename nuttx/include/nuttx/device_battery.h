@@ -50,6 +50,12 @@
 #define BATTERY_STATUS_NOT_CHARGING      0x0003
 #define BATTERY_STATUS_FULL              0x0004
 
+/**
+ * Called by the battery driver when the gauge reports a change on its own,
+ * possibly from interrupt context.
+ */
+typedef void (*device_battery_callback)(struct device *dev, void *arg);
+
 /**
  * battery device driver operations
  */
@@ -80,6 +86,10 @@ struct device_battery_type_ops {
 
     /** battery get_shutdown_temperature() function pointer */
     int (*get_shutdown_temp)(struct device *dev, int *shutdown_temp);
+
+    /** battery register_callback() function pointer */
+    int (*register_callback)(struct device *dev,
+                             device_battery_callback callback, void *arg);
 };
 
 /**
@@ -259,4 +269,28 @@ static inline int device_battery_shutdown_temp(struct device *dev,
     return -ENOSYS;
 }
 
+/**
+ * @brief battery register change callback function.
+ * @param dev pointer to structure of device data.
+ * @param callback function called when the gauge reports a change, NULL to
+ *        unregister.
+ * @param arg argument passed to the callback.
+ * @return 0 on success, negative errno on error.
+ */
+static inline int device_battery_register_callback(struct device *dev,
+                                                   device_battery_callback callback,
+                                                   void *arg)
+{
+    DEVICE_DRIVER_ASSERT_OPS(dev);
+
+    if (!device_is_open(dev))
+        return -ENODEV;
+
+    if (DEVICE_DRIVER_GET_OPS(dev, battery)->register_callback)
+        return DEVICE_DRIVER_GET_OPS(dev, battery)->
+               register_callback(dev, callback, arg);
+
+    return -ENOSYS;
+}
+
 #endif /* __ARCH_ARM_DEVICE_BATTERY_H */
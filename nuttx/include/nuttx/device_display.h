@@ -175,6 +175,14 @@ enum display_notification_event {
     DISPLAY_NOTIFICATION_EVENT_DISCONNECT  = 0x05,
 };
 
+/* Damage rectangle, in pixels. A zero width or height selects the full frame. */
+struct display_rect {
+    uint16_t x;
+    uint16_t y;
+    uint16_t width;
+    uint16_t height;
+};
+
 typedef int (*display_notification_cb)(struct device *dev,
     enum display_notification_event event);
 
@@ -185,6 +193,7 @@ struct device_display_type_ops {
     int (*set_config)(struct device *dev, uint8_t index);
     int (*get_state)(struct device *dev, uint8_t *state);
     int (*set_state)(struct device *dev, uint8_t state);
+    int (*set_partial)(struct device *dev, const struct display_rect *rect);
     int (*register_callback)(struct device *dev, display_notification_cb cb);
     int (*unregister_callback)(struct device *dev);
 };
@@ -302,6 +311,32 @@ static inline int device_display_set_state(struct device *dev, uint8_t state)
     return DEVICE_DRIVER_GET_OPS(dev, display)->set_state(dev, state);
 }
 
+/**
+ * @brief Display set_partial() wrap function
+ *
+ * Restricts the following frames to the given damage rectangle. Only
+ * supported by command-mode panels.
+ *
+ * @param dev pointer to structure of device data
+ * @param rect damage rectangle, NULL or zero-sized for the full frame
+ * @return 0 on success, negative errno on error
+ */
+static inline int device_display_set_partial(struct device *dev,
+        const struct display_rect *rect)
+{
+    DEVICE_DRIVER_ASSERT_OPS(dev);
+
+    if (!device_is_open(dev)) {
+        return -ENODEV;
+    }
+
+    if (!DEVICE_DRIVER_GET_OPS(dev, display)->set_partial) {
+        return -ENOSYS;
+    }
+
+    return DEVICE_DRIVER_GET_OPS(dev, display)->set_partial(dev, rect);
+}
+
 
 /**
  * @brief Display register_callback() wrap function
@@ -33,6 +33,8 @@
 #include <stdbool.h>
 #include <assert.h>
 
+#include <nuttx/lights_pattern.h>
+
 #define DEVICE_TYPE_LIGHTS_HW                  "lights"
 
 #define NAME_LENGTH                             32
@@ -214,6 +216,11 @@ struct device_lights_type_ops {
     /** Get flash light fault */
     int (*get_flash_fault)(struct device *dev, uint8_t light_id,
                            uint8_t channel_id, uint32_t *fault);
+    /** Play a keyframe pattern */
+    int (*set_pattern)(struct device *dev, uint8_t light_id,
+                       uint8_t channel_id,
+                       const struct lights_keyframe *frames,
+                       uint8_t nframes, uint16_t repeat);
 };
 
 /**
@@ -438,6 +445,43 @@ static inline int device_lights_set_fade(struct device *dev,
     return -ENOSYS;
 }
 
+/**
+ * @brief Lights set_pattern() wrap function
+ *
+ * The pattern is played by the driver, or its hardware, until it is done or
+ * replaced, without any further request.  Setting the brightness, blink or
+ * color of the channel stops it.
+ *
+ * @param dev pointer to structure of device data
+ * @param light_id the ID of specific light
+ * @param channel_id the ID of specific channel
+ * @param frames keyframes, each one giving a brightness and a duration
+ * @param nframes the number of keyframes, 0 to stop the pattern
+ * @param repeat the number of times the pattern is played, 0 for ever
+ * @return 0 on success, negative errno on error
+ */
+static inline int device_lights_set_pattern(struct device *dev,
+                                            uint8_t light_id,
+                                            uint8_t channel_id,
+                                            const struct lights_keyframe *frames,
+                                            uint8_t nframes, uint16_t repeat)
+{
+    DEVICE_DRIVER_ASSERT_OPS(dev);
+
+    if (!device_is_open(dev)) {
+        return -ENODEV;
+    }
+    if (DEVICE_DRIVER_GET_OPS(dev, lights)->set_pattern) {
+        return DEVICE_DRIVER_GET_OPS(dev, lights)->set_pattern(dev,
+                                                               light_id,
+                                                               channel_id,
+                                                               frames,
+                                                               nframes,
+                                                               repeat);
+    }
+    return -ENOSYS;
+}
+
 /**
  * @brief Lights register_callback() wrap function
  *
@@ -37,6 +37,20 @@
 
 #define DEVICE_TYPE_PWM_HW                 "pwm"
 
+/**
+ * New duty cycle and period for one generator of a multi-channel update.
+ */
+struct pwm_config_entry {
+    /** Specific PWM generator device number. */
+    uint16_t which;
+
+    /** Active time (in nanoseconds). */
+    uint32_t duty;
+
+    /** Sum of active and deactive time (in nanoseconds). */
+    uint32_t period;
+};
+
 /**
  * PWM device driver operations.
  */
@@ -54,6 +68,15 @@ struct device_pwm_type_ops {
     int (*config)(struct device *dev, uint16_t which, uint32_t duty,
                   uint32_t period);
 
+    /** PWM config several generators at the same period boundary. */
+    int (*config_multi)(struct device *dev,
+                        const struct pwm_config_entry *entries,
+                        uint16_t count);
+
+    /** PWM stream duty cycles to a generator, one per period. */
+    int (*stream_duty)(struct device *dev, uint16_t which,
+                       const uint32_t *duty, uint16_t count, bool repeat);
+
     /** PWM enable generator function pointer. */
     int (*enable)(struct device *dev, uint16_t  which);
 
@@ -195,6 +218,67 @@ static inline int device_pwm_request_config(struct device *dev,
     return DEVICE_DRIVER_GET_OPS(dev, pwm)->config(dev, pwm_no, duty, period);
 }
 
+/**
+ * @brief Configure several generators at once.
+ *
+ * All entries are validated before any generator is touched. The new duty
+ * cycles and periods are double-buffered by the controller and take effect
+ * together at the next period boundary, so running generators do not glitch.
+ *
+ * @param dev Opened device driver handle.
+ * @param entries Array of new settings, one per generator.
+ * @param count Number of entries in the array.
+ */
+static inline int device_pwm_request_config_multi(struct device *dev,
+                                    const struct pwm_config_entry *entries,
+                                    uint16_t count)
+{
+    DEVICE_DRIVER_ASSERT_OPS(dev);
+
+    if (!device_is_open(dev)) {
+        return -ENODEV;
+    }
+
+    if (!DEVICE_DRIVER_GET_OPS(dev, pwm)->config_multi) {
+        return -ENOSYS;
+    }
+
+    return DEVICE_DRIVER_GET_OPS(dev, pwm)->config_multi(dev, entries, count);
+}
+
+/**
+ * @brief Stream a sequence of duty cycles to a specific generator.
+ *
+ * The generator must already be configured and enabled. Each period the
+ * controller loads the next duty cycle of the buffer, which must stay valid
+ * until the stream ends or is stopped. Passing a NULL buffer stops the
+ * stream and leaves the last duty cycle in place.
+ *
+ * @param dev Opened device driver handle.
+ * @param pwm_no The number of Specific generator for operating.
+ * @param duty Array of active times (in nanoseconds), or NULL to stop.
+ * @param count Number of entries in the array.
+ * @param repeat True to restart from the first entry after the last one.
+ */
+static inline int device_pwm_request_stream_duty(struct device *dev,
+                                                 uint16_t pwm_no,
+                                                 const uint32_t *duty,
+                                                 uint16_t count, bool repeat)
+{
+    DEVICE_DRIVER_ASSERT_OPS(dev);
+
+    if (!device_is_open(dev)) {
+        return -ENODEV;
+    }
+
+    if (!DEVICE_DRIVER_GET_OPS(dev, pwm)->stream_duty) {
+        return -ENOSYS;
+    }
+
+    return DEVICE_DRIVER_GET_OPS(dev, pwm)->stream_duty(dev, pwm_no, duty,
+                                                        count, repeat);
+}
+
 /**
  * @brief Configure specific generator for a particular polarity.
  *
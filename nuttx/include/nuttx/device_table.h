@@ -49,6 +49,7 @@ struct device_table_iter {
 
 int device_table_register(struct device_table *table);
 struct device *device_table_iter_next(struct device_table_iter *iter);
+struct device *device_table_lookup(const char *type, unsigned int id);
 
 #define device_table_for_each_dev(dev, iter)          \
     while ((dev = device_table_iter_next(iter)))
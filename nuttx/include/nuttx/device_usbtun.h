@@ -38,11 +38,22 @@
 
 typedef int (*usbtun_status_cb)(struct device *dev, uint8_t attached);
 
+struct usbtun_stats {
+    uint32_t starts;          /* Tunnel start requests sent */
+    uint32_t stops;           /* Tunnel stop requests sent */
+    uint32_t timeouts;        /* Control requests that got no response */
+    uint32_t failures;        /* Control/config responses reporting failure */
+    uint32_t attaches;        /* Attach notifications from the server */
+    uint32_t detaches;        /* Detach notifications from the server */
+    uint32_t attach_ms;       /* Start request to last attach, in ms */
+};
+
 struct device_usbtun_type_ops {
     int (*on)(struct device *dev);
     int (*off)(struct device *dev);
     int (*register_callback)(struct device *dev, usbtun_status_cb cb);
     int (*unregister_callback)(struct device *dev);
+    int (*get_stats)(struct device *dev, struct usbtun_stats *stats);
 };
 
 static inline int device_usbtun_on(struct device *dev)
@@ -97,4 +108,18 @@ static inline int device_usbtun_unregister_callback(struct device *dev)
     return -ENOSYS;
 }
 
+static inline int device_usbtun_get_stats(struct device *dev,
+                                          struct usbtun_stats *stats)
+{
+    DEVICE_DRIVER_ASSERT_OPS(dev);
+
+    if (!device_is_open(dev)) {
+        return -ENODEV;
+    }
+    if (DEVICE_DRIVER_GET_OPS(dev, usbtun)->get_stats) {
+        return DEVICE_DRIVER_GET_OPS(dev, usbtun)->get_stats(dev, stats);
+    }
+    return -ENOSYS;
+}
+
 #endif /* __DEBICE_USBTUN_H__ */
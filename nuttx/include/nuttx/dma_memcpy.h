@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_NUTTX_DMA_MEMCPY_H
+#define __INCLUDE_NUTTX_DMA_MEMCPY_H
+
+#include <stddef.h>
+
+/**
+ * Called when a copy started by dma_memcpy_async() is done
+ *
+ * @param status 0 on success, -errno if the DMA transfer failed
+ * @param arg Argument given to dma_memcpy_async()
+ */
+typedef void (*dma_memcpy_callback)(int status, void *arg);
+
+#ifdef CONFIG_DMA_MEMCPY
+int dma_memcpy_init(void);
+void dma_memcpy_deinit(void);
+size_t dma_memcpy_set_threshold(size_t threshold);
+int dma_memcpy_async(void *dst, const void *src, size_t len,
+                     dma_memcpy_callback callback, void *arg);
+int dma_memcpy(void *dst, const void *src, size_t len);
+#else
+#include <string.h>
+
+static inline int dma_memcpy_init(void)
+{
+    return 0;
+}
+
+static inline void dma_memcpy_deinit(void)
+{
+}
+
+static inline size_t dma_memcpy_set_threshold(size_t threshold)
+{
+    return 0;
+}
+
+static inline int dma_memcpy_async(void *dst, const void *src, size_t len,
+                                   dma_memcpy_callback callback, void *arg)
+{
+    memcpy(dst, src, len);
+    if (callback)
+        callback(0, arg);
+    return 0;
+}
+
+static inline int dma_memcpy(void *dst, const void *src, size_t len)
+{
+    memcpy(dst, src, len);
+    return 0;
+}
+#endif
+
+#endif /* __INCLUDE_NUTTX_DMA_MEMCPY_H */
@@ -102,6 +102,17 @@ struct geometry
   size_t geo_sectorsize;   /* Size of one sector */
 };
 
+/* Sector cache statistics of a block-to-character driver, as returned by
+ * the DIOC_GETSTATS ioctl.
+ */
+
+struct bch_stats_s
+{
+  uint32_t hits;           /* Sector accesses found in the cache */
+  uint32_t misses;         /* Sector accesses that read the device */
+  uint32_t writebacks;     /* Dirty sectors written to the device */
+};
+
 /* This structure is provided by block devices when they register with the
  * system.  It is used by file systems to perform filesystem transfers.  It
  * differs from the normal driver vtable in several ways -- most notably in
@@ -232,14 +243,21 @@ struct file
   off_t             f_pos;    /* File position */
   FAR struct inode *f_inode;  /* Driver interface */
   void             *f_priv;   /* Per file driver private data */
+#ifdef CONFIG_FS_FILE_REFS
+  uint8_t           f_refs;   /* Number of operations in progress */
+  bool              f_closing; /* close() deferred until f_refs is 0 */
+#endif
 };
 
 /* This defines a list of files indexed by the file descriptor */
 
 #if CONFIG_NFILE_DESCRIPTORS > 0
+#define FILELIST_MAPWORDS ((CONFIG_NFILE_DESCRIPTORS + 31) >> 5)
+
 struct filelist
 {
   sem_t   fl_sem;             /* Manage access to the file list */
+  uint32_t fl_map[FILELIST_MAPWORDS]; /* Allocated descriptors */
   struct file fl_files[CONFIG_NFILE_DESCRIPTORS];
 };
 #endif
@@ -71,6 +71,7 @@
 #define _WLIOCBASE      (0x1200) /* Wireless modules ioctl commands */
 #define _CFGDIOCBASE    (0x1300) /* Config Data device (app config) ioctl commands */
 #define _TCIOCBASE      (0x1400) /* Timer ioctl commands */
+#define _BQIOCBASE      (0x1500) /* Buffer queue ioctl commands */
 
 /* Macros used to manage ioctl commands */
 
@@ -146,6 +147,9 @@
 #define DIOC_SETKEY     _DIOC(0X0004)     /* IN:  Encryption key
                                            * OUT: None
                                            */
+#define DIOC_GETSTATS   _DIOC(0x0005)     /* IN:  Pointer to struct bch_stats_s
+                                           * OUT: Sector cache statistics
+                                           */
 
 /* NuttX block driver ioctl definitions *************************************/
 
@@ -203,6 +207,11 @@
                                            *      ProcFS data.
                                            * OUT: None (ioctl return value provides
                                            *      success/failure indication). */
+#define BIOC_FLUSH      _BIOC(0x000B)     /* Write any data cached by the block
+                                           * driver back to the media.
+                                           * IN:  None
+                                           * OUT: None (ioctl return value provides
+                                           *      success/failure indication). */
 
 /* NuttX MTD driver ioctl definitions ***************************************/
 
@@ -221,6 +230,11 @@
                                            *      of device memory */
 #define MTDIOC_BULKERASE  _MTDIOC(0x0003) /* IN:  None
                                            * OUT: None */
+#define MTDIOC_ERASEBUSY  _MTDIOC(0x0004) /* IN:  None
+                                           * OUT: ioctl return value is 1 while
+                                           *      an erase started by erase()
+                                           *      is still in progress, 0 when
+                                           *      the device is idle */
 
 /* NuttX ARP driver ioctl definitions (see netinet/arp.h) *******************/
 
@@ -299,6 +313,12 @@
 #define _CFGDIOCVALID(c)   (_IOC_TYPE(c)==_CFGDIOCBASE)
 #define _CFGDIOC(nr)         _IOC(_CFGDIOCBASE,nr)
 
+/* Buffer queue ioctl definitions *******************************************/
+/* (see nuttx/include/bufqueue.h */
+
+#define _BQIOCVALID(c)     (_IOC_TYPE(c)==_BQIOCBASE)
+#define _BQIOC(nr)         _IOC(_BQIOCBASE,nr)
+
 /****************************************************************************
  * Public Type Definitions
  ****************************************************************************/
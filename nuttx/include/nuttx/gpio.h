@@ -30,6 +30,8 @@
 #ifndef _GPIO_CHIP_H_
 #define _GPIO_CHIP_H_
 
+#include <stdbool.h>
+
 #include <nuttx/irq.h>
 #include <nuttx/list.h>
 
@@ -62,6 +64,9 @@ struct gpio_ops_s
     int (*clear_interrupt)(void *driver_data, uint8_t which);
     gpio_cfg_t (*cfg_save)(void *driver_data, uint8_t which);
     void (*cfg_restore)(void *driver_data, uint8_t which, gpio_cfg_t cfg);
+    /* Set when the chip is behind a bus (I2C, SPI...) and its accessors
+     * may sleep; such lines must not be touched from interrupt context */
+    bool can_sleep;
 };
 
 struct gpio_chip_s
@@ -82,6 +87,7 @@ void gpio_set_value(uint8_t which, uint8_t value);
 int gpio_set_debounce(uint8_t which, uint16_t delay);
 void gpio_deactivate(uint8_t which);
 uint8_t gpio_line_count(void);
+bool gpio_can_sleep(uint8_t which);
 int gpio_irqattach(uint8_t which, xcpt_t isr);
 int gpio_irqattach_old(uint8_t which, xcpt_t isr, xcpt_t *old);
 int set_gpio_triggering(uint8_t which, int trigger);
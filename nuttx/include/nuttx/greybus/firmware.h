@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __GREYBUS_FIRMWARE_H__
+#define __GREYBUS_FIRMWARE_H__
+
+#include <sys/types.h>
+#include <stdint.h>
+
+#define GB_FIRMWARE_DIGEST_SIZE                 32 /* SHA-256 */
+
+/* Payload of a TFTF signature section */
+#define TFTF_SIGNATURE_TYPE_RSA2048_SHA256      0x01
+#define TFTF_SIGNATURE_KEY_NAME_SIZE            96
+
+struct tftf_signature {
+    uint32_t length;    /* of this structure, including the signature */
+    uint32_t type;      /* TFTF_SIGNATURE_TYPE_* */
+    char key_name[TFTF_SIGNATURE_KEY_NAME_SIZE];
+    uint8_t signature[0];
+} __attribute__((packed));
+
+/*
+ * Verify the signature section of a downloaded image.
+ *
+ * digest is the SHA-256 of the TFTF header followed by the code section,
+ * computed while the image was being flashed. sig points to the payload of
+ * the signature section (a struct tftf_signature) of siglen bytes.
+ *
+ * The default implementation has no key and returns -ENOSYS, which marks
+ * the image as valid but insecure. Boards holding a public key override it
+ * and return 0 for a good signature or a negative errno for a bad one.
+ */
+int gb_firmware_verify_signature(const uint8_t *digest, const uint8_t *sig,
+                                 size_t siglen);
+
+#endif /* __GREYBUS_FIRMWARE_H__ */
@@ -65,6 +65,13 @@ typedef void (*gb_operation_fast_handler_t)(unsigned int cport, void *data);
         .type = t, \
         .fast_handler = h, \
     }
+
+#define _GB_RX_HANDLER(t, h) \
+    { \
+        .type = t, \
+        .handler = h, \
+        .in_rx = true, \
+    }
 #else
 #define GB_HANDLER(t, h) \
     { \
@@ -79,17 +86,60 @@ typedef void (*gb_operation_fast_handler_t)(unsigned int cport, void *data);
         .fast_handler = h, \
         .name = #h, \
     }
+
+#define _GB_RX_HANDLER(t, h) \
+    { \
+        .type = t, \
+        .handler = h, \
+        .in_rx = true, \
+        .name = #h, \
+    }
+#endif
+
+/*
+ * A request handler that may run straight from the RX context when its CPort
+ * has nothing queued. It must not block and must return GB_OP_RX_DEFER,
+ * before any side effect, when it can not complete in the current context
+ * (e.g. up_interrupt_context() and a device behind a bus).
+ */
+#ifdef CONFIG_GREYBUS_RX_HANDLERS
+#define GB_RX_HANDLER(t, h) _GB_RX_HANDLER(t, h)
+#else
+#define GB_RX_HANDLER(t, h) GB_HANDLER(t, h)
 #endif
 
 struct gb_operation_handler {
     uint8_t type;
     gb_operation_handler_t handler;
     gb_operation_fast_handler_t fast_handler;
+#ifdef CONFIG_GREYBUS_RX_HANDLERS
+    bool in_rx; /* cleared by the core when the handler overruns its budget */
+#endif
 #ifdef CONFIG_GREYBUS_DEBUG
     const char *name;
 #endif
 };
 
+enum gb_tx_class {
+    GB_TX_CLASS_INTERACTIVE,
+    GB_TX_CLASS_ISOCHRONOUS,
+    GB_TX_CLASS_BULK,
+};
+
+/*
+ * Init group of a driver when CONFIG_GREYBUS_PARALLEL_INIT is enabled.
+ * Drivers of the same non-zero group are initialized one at a time, in
+ * registration order, so that a driver may depend on a previous one.
+ */
+enum gb_init_group {
+    GB_INIT_GROUP_NONE = 0,         /* no dependency, fully parallel */
+    GB_INIT_GROUP_AUDIO,
+    GB_INIT_GROUP_SYNC = 0xff,      /* initialized by the registering task */
+};
+
+typedef int (*gb_transport_completion_t)(int status, const void *buf,
+                                         void *priv);
+
 struct gb_transport_backend {
     int headroom;
 
@@ -98,8 +148,25 @@ struct gb_transport_backend {
     int (*listen)(unsigned int cport);
     int (*stop_listening)(unsigned int cport);
     int (*send)(unsigned int cport, const void *buf, size_t len);
+    /* Optional: send count messages at once, each one being its own message */
+    int (*send_batch)(unsigned int cport, const void * const bufs[],
+                      const size_t lens[], size_t count);
     void *(*alloc_buf)(size_t size);
     void (*free_buf)(void *ptr);
+    /*
+     * Optional: queue a message without blocking, buf must stay valid until
+     * callback is called. Used to answer requests from the RX context.
+     */
+    int (*send_async)(unsigned int cport, const void *buf, size_t len,
+                      gb_transport_completion_t callback, void *priv);
+    /* Optional: hint the transport about the traffic carried by a CPort */
+    int (*set_tx_class)(unsigned int cport, enum gb_tx_class tx_class);
+    /*
+     * Optional: stop and restart the delivery of the messages of a CPort,
+     * used by the RX credits. Called from an atomic context.
+     */
+    int (*rx_pause)(unsigned int cport);
+    int (*rx_resume)(unsigned int cport);
 };
 
 struct gb_operation {
@@ -120,6 +187,7 @@ struct gb_operation {
 
     void *priv_data;
     struct list_head list;
+    struct list_head pending_list; /* response lookup, while awaiting one */
 
     struct gb_operation *response;
 
@@ -127,6 +195,18 @@ struct gb_operation {
     struct timespec send_ts;
     struct timespec recv_ts;
 #endif
+#ifdef CONFIG_GREYBUS_STATS
+    uint32_t rx_time; /* in microseconds, when queued for processing */
+#endif
+#ifdef CONFIG_GREYBUS_RX_HANDLERS
+    bool rx_handled; /* handled in RX context, only rx_result is left to send */
+    uint8_t rx_result;
+#endif
+};
+
+enum gb_rx_priority {
+    GB_RX_PRIORITY_NORMAL,
+    GB_RX_PRIORITY_HIGH,
 };
 
 struct gb_driver {
@@ -140,6 +220,20 @@ struct gb_driver {
     size_t stack_size;
     size_t op_handlers_count;
     const char *name;
+
+    /* RX lane used when CONFIG_GREYBUS_RX_WORKER_POOL is enabled */
+    enum gb_rx_priority rx_priority;
+
+    /* TX traffic class hint given to the transport */
+    enum gb_tx_class tx_class;
+
+    /* Dependency hint used when CONFIG_GREYBUS_PARALLEL_INIT is enabled */
+    enum gb_init_group init_group;
+
+#ifdef CONFIG_GREYBUS_HANDLER_TABLE
+    /* Index + 1 in op_handlers of each request type, built on registration */
+    uint8_t *handler_table;
+#endif
 };
 
 struct gb_operation_hdr {
@@ -164,6 +258,7 @@ enum gb_operation_result {
     GB_OP_INVALID               = 0x06,
     GB_OP_RETRY                 = 0x07,
     GB_OP_NONEXISTENT           = 0x08,
+    GB_OP_RX_DEFER              = 0xfd, /* internal, never sent */
     GB_OP_UNKNOWN_ERROR         = 0xfe,
     GB_OP_INTERNAL              = 0xff,
 };
@@ -217,6 +312,21 @@ int gb_unipro_init(void);
 int _gb_register_driver(unsigned int cport, struct gb_driver *driver);
 int gb_unregister_driver(unsigned int cport);
 
+#ifdef CONFIG_GREYBUS_PARALLEL_INIT
+int gb_bringup_begin(void);
+int gb_bringup_wait(void);
+#else
+static inline int gb_bringup_begin(void)
+{
+    return 0;
+}
+
+static inline int gb_bringup_wait(void)
+{
+    return 0;
+}
+#endif
+
 static inline int gb_register_named_driver(unsigned int cport,
                                            struct gb_driver *driver,
                                            const char *name)
@@ -227,6 +337,21 @@ static inline int gb_register_named_driver(unsigned int cport,
 
 #define gb_register_driver(cport, driver) \
     gb_register_named_driver(cport, driver, __FILE__)
+
+#ifdef CONFIG_GREYBUS_RX_CREDITS
+/* RX credit accounting of a CPort, see CONFIG_GREYBUS_RX_CREDITS */
+struct gb_rx_credit_stats {
+    unsigned int budget;        /* credits, 0 if unlimited */
+    unsigned int queued;        /* operations in the RX fifo */
+    unsigned int max_queued;    /* high watermark of queued */
+    uint32_t stalls;            /* times the credits ran out */
+    bool paused;                /* RX is currently paused */
+};
+
+int gb_rx_set_credits(unsigned int cport, unsigned int credits);
+int gb_rx_get_credit_stats(unsigned int cport,
+                           struct gb_rx_credit_stats *stats);
+#endif
 int gb_listen(unsigned int cport);
 int gb_stop_listening(unsigned int cport);
 int gb_notify(unsigned cport, enum gb_event event);
@@ -236,6 +361,8 @@ void gb_operation_destroy(struct gb_operation *operation);
 void *gb_operation_alloc_response(struct gb_operation *operation, size_t size);
 int gb_operation_send_response(struct gb_operation *operation, uint8_t result);
 int gb_operation_send_request_sync(struct gb_operation *operation);
+int gb_operation_send_request_batch(struct gb_operation **operations,
+                                    size_t count);
 int gb_operation_send_request(struct gb_operation *operation,
                               gb_operation_callback callback,
                               bool need_response);
@@ -246,6 +373,7 @@ void gb_operation_unref(struct gb_operation *operation);
 size_t gb_operation_get_request_payload_size(struct gb_operation *operation);
 uint8_t gb_operation_get_request_result(struct gb_operation *operation);
 int greybus_rx_handler(unsigned int, void*, size_t);
+int greybus_rx_handler_zero_copy(unsigned int, void*, size_t);
 
 void gb_control_register(int cport);
 void gb_gpio_register(int cport);
@@ -82,8 +82,20 @@ struct gb_loopback_statistics {
 
 typedef int (*gb_loopback_cport_cb)(int, void *);
 
+/*
+ * Completion of an asynchronous loopback request. The structure must stay
+ * valid until done() is called, from the greybus RX context, with 0 or a
+ * negative errno and the time elapsed since the request was sent.
+ */
+struct gb_loopback_async {
+    void (*done)(struct gb_loopback_async *async, int status,
+                 uint32_t latency_us);
+};
+
 int gb_loopback_get_cports(gb_loopback_cport_cb cb, void *data);
 int gb_loopback_send_req(int cport, size_t size, uint8_t type);
+int gb_loopback_send_req_async(int cport, size_t size, uint8_t type,
+                               struct gb_loopback_async *async);
 int gb_loopback_get_stats(int cport, struct gb_loopback_statistics *stats);
 void gb_loopback_reset(int cport);
 int gb_loopback_cport_valid(int cport);
@@ -44,5 +44,6 @@ extern int mods_cport_valid(int c);
 #define MB_CONTROL_SLAVE_MASK_APBE            (1 << 0)
 
 uint32_t mods_control_get_rtc_clock_counter(void);
+int mb_control_send_dl_reconfig(uint16_t pl_size);
 
 #endif /* _GREYBUS_MODS_CTRL_H_ */
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef __GREYBUS_SPI_H__
+#define __GREYBUS_SPI_H__
+
+#include <errno.h>
+#include <string.h>
+
+/* SPI transfer statistics, see CONFIG_GREYBUS_SPI_STATS */
+
+struct gb_spi_statistics {
+    unsigned reqs;
+    unsigned reqs_err;
+    unsigned transfers;         /* transfer descriptors received */
+    unsigned exchanges;         /* bus exchanges after chaining */
+
+    unsigned throughput_min;    /* bytes per second */
+    unsigned throughput_max;
+    unsigned throughput_avg;
+
+    unsigned latency_min;       /* microseconds per request */
+    unsigned latency_max;
+    unsigned latency_avg;
+};
+
+#ifdef CONFIG_GREYBUS_SPI_STATS
+int gb_spi_get_stats(struct gb_spi_statistics *stats);
+void gb_spi_reset_stats(void);
+#else
+static inline int gb_spi_get_stats(struct gb_spi_statistics *stats)
+{
+    memset(stats, 0, sizeof(*stats));
+    return -ENOSYS;
+}
+
+static inline void gb_spi_reset_stats(void)
+{
+}
+#endif
+
+#endif /* __GREYBUS_SPI_H__ */
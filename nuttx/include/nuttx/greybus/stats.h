@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __GREYBUS_STATS_H__
+#define __GREYBUS_STATS_H__
+
+#include <sys/types.h>
+#include <stdint.h>
+
+/* Latency histograms of the Greybus operations, see CONFIG_GREYBUS_STATS */
+
+enum gb_stats_kind {
+    GB_STATS_QUEUE,         /* time spent in the CPort RX fifo */
+    GB_STATS_HANDLER,       /* time spent in the operation handler */
+    GB_STATS_ROUND_TRIP,    /* time from a request to its response */
+    GB_STATS_KIND_COUNT,
+};
+
+/* Bucket i counts latencies in [2^i, 2^(i+1)) us, the last one the rest */
+#define GB_STATS_BUCKETS    16
+
+struct gb_stats_histogram {
+    uint32_t count;
+    uint32_t max_us;
+    uint32_t buckets[GB_STATS_BUCKETS];
+};
+
+struct gb_stats_entry {
+    uint16_t cport;
+    uint8_t type;
+    struct gb_stats_histogram hist[GB_STATS_KIND_COUNT];
+};
+
+int gb_stats_get(unsigned int index, struct gb_stats_entry *entry);
+ssize_t gb_stats_format(const struct gb_stats_entry *entry, char *buf,
+                        size_t len);
+void gb_stats_reset(void);
+uint32_t gb_stats_allocations(void);
+
+#endif /* __GREYBUS_STATS_H__ */
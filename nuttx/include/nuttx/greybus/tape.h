@@ -32,6 +32,13 @@
 #define __GREYBUS_TAPE_H__
 
 #include <sys/types.h>
+#include <stdint.h>
+
+/* Record header of the tape files, followed by size bytes of message */
+struct gb_tape_record_header {
+    uint16_t size;
+    uint16_t cport;
+};
 
 enum {
     GB_TAPE_RDONLY,
@@ -62,6 +62,19 @@
     #define TSB_MAIL_RESET         (0x00)
     #define TSB_MAIL_READY_AP      (0x01)
     #define TSB_MAIL_READY_OTHER   (0x02)
+    /*
+     * CPort enable batch: bit 31 set, bits 8-10 select a group of 8 CPorts
+     * and bits 0-7 hold the CPorts of the group. Acknowledged with the low
+     * 15 bits and bit 15 set, which no single CPort acknowledge can collide
+     * with.
+     */
+    #define TSB_MAIL_CPORT_BATCH   (1 << 31)
+    #define TSB_MAIL_CPORT_BATCH_GROUPS (8)
+    #define TSB_MAIL_CPORT_BATCH_VAL(group, map) \
+        (TSB_MAIL_CPORT_BATCH | ((group) << 8) | (map))
+    #define TSB_MAIL_CPORT_BATCH_GROUP(val) (((val) >> 8) & 0x7)
+    #define TSB_MAIL_CPORT_BATCH_MAP(val) ((val) & 0xff)
+    #define TSB_MAIL_CPORT_BATCH_ACK(val) (0x8000 | ((val) & 0x7ff))
 #define TSB_DME_LAYERENABLEREQ     0xd000
 #define TSB_DME_LAYERENABLECNF     0xd000
 #define TSB_DME_RESETREQ           0xd010
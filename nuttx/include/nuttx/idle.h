@@ -0,0 +1,145 @@
+/****************************************************************************
+ * include/nuttx/idle.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_IDLE_H
+#define __INCLUDE_NUTTX_IDLE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One low-power state that the IDLE loop can enter.  The architecture code
+ * provides a table of these ordered from the shallowest (index 0) to the
+ * deepest state.  exit_latency and residency are nominal values from the
+ * datasheet; avg_latency is learned at run time.  All times are in
+ * microseconds.
+ */
+
+struct idle_state_s
+{
+  FAR const char *name;      /* Name of the state (for debug output) */
+  uint32_t exit_latency;     /* Nominal time to resume after a wakeup */
+  uint32_t residency;        /* Minimum sleep to be worth entering */
+  uint32_t avg_latency;      /* Measured timer wakeup latency (average) */
+  uint32_t max_latency;      /* Measured timer wakeup latency (worst case) */
+  uint32_t count;            /* Number of times the state was entered */
+  uint32_t early;            /* Wakeups before the timer expired */
+};
+
+/* The governor state of one IDLE loop */
+
+struct idle_governor_s
+{
+  FAR struct idle_state_s *states; /* Table of states, shallowest first */
+  uint8_t nstates;           /* Number of entries in states[] */
+  uint8_t current;           /* State selected by the last idle_select() */
+  uint64_t wakeup;           /* Expected timer expiry (0: none) */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: idle_select
+ *
+ * Description:
+ *   Select the deepest state, not deeper than maxstate, that can be left
+ *   again before the next scheduled timer expiry.  A state qualifies if
+ *   the time until that expiry covers both its residency and its exit
+ *   latency (the larger of the nominal and the measured latency), and if
+ *   that latency is within the PM QoS constraint (see pm_qos_latency()).
+ *
+ * Input Parameters:
+ *   gov      - The governor of the calling IDLE loop
+ *   maxstate - The deepest state that other constraints (e.g. the PM
+ *              activity state) allow.
+ *
+ * Returned Value:
+ *   The index of the selected state.  State 0 is always allowed.
+ *
+ * Assumptions:
+ *   Called with interrupts disabled; they must stay disabled until the
+ *   matching idle_reflect().
+ *
+ ****************************************************************************/
+
+int idle_select(FAR struct idle_governor_s *gov, int maxstate);
+
+/****************************************************************************
+ * Name: idle_reflect
+ *
+ * Description:
+ *   Update the statistics of the state selected by the last idle_select()
+ *   after the CPU left it.  If the wakeup was caused by the timer, the
+ *   time since the expected expiry is the exit latency of the state.
+ *
+ * Input Parameters:
+ *   gov - The governor of the calling IDLE loop
+ *
+ * Returned Value:
+ *   None
+ *
+ * Assumptions:
+ *   Called with interrupts still disabled right after the wakeup.
+ *
+ ****************************************************************************/
+
+void idle_reflect(FAR struct idle_governor_s *gov);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_SCHED_IDLE_GOVERNOR */
+#endif /* __INCLUDE_NUTTX_IDLE_H */
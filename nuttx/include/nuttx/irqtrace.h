@@ -0,0 +1,131 @@
+/****************************************************************************
+ * include/nuttx/irqtrace.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_IRQTRACE_H
+#define __INCLUDE_NUTTX_IRQTRACE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_IRQSAVE_TRACE
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One interrupts-off window */
+
+struct irqtrace_window_s
+{
+  uint32_t cycles;             /* Length of the window in CPU cycles */
+  FAR void *save_pc;           /* Return address of the opening irqsave() */
+  FAR void *restore_pc;        /* Return address of the closing irqrestore() */
+};
+
+/* Snapshot of the tracer state */
+
+struct irqtrace_s
+{
+  uint32_t nwindows;           /* Number of windows measured */
+  struct irqtrace_window_s worst[CONFIG_IRQSAVE_TRACE_NWORST];
+                               /* Longest windows, longest first */
+  uint32_t lat_count;          /* Number of interrupt latency samples */
+  uint32_t lat_max;            /* Longest latency in CPU cycles */
+  uint64_t lat_total;          /* Sum of all latency samples */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/* Tracer interface (sched/irq/irq_trace.c) */
+
+void irqtrace_initialize(void);
+void irqtrace_dispatch(int irq);
+void irqtrace_get(FAR struct irqtrace_s *trace);
+void irqtrace_reset(void);
+
+/****************************************************************************
+ * Name: up_irqtrace_initialize
+ *
+ * Description:
+ *   Start the free-running cycle counter used by the tracer.
+ *
+ ****************************************************************************/
+
+void up_irqtrace_initialize(void);
+
+/****************************************************************************
+ * Name: up_irqtrace_cycles
+ *
+ * Description:
+ *   Return the current value of the free-running cycle counter.  Must not
+ *   use irqsave().
+ *
+ ****************************************************************************/
+
+uint32_t up_irqtrace_cycles(void);
+
+/****************************************************************************
+ * Name: up_irqtrace_latency
+ *
+ * Description:
+ *   Called when 'irq' is dispatched.  If the architecture knows when that
+ *   interrupt was raised, return true and the number of cycles it waited.
+ *
+ ****************************************************************************/
+
+bool up_irqtrace_latency(int irq, FAR uint32_t *cycles);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_IRQSAVE_TRACE */
+#endif /* __INCLUDE_NUTTX_IRQTRACE_H */
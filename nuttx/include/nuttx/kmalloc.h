@@ -132,6 +132,7 @@ extern "C"
 # define kmm_realloc(p,s)       realloc(p,s)
 # define kmm_memalign(a,s)      memalign(a,s)
 # define kmm_free(p)            free(p)
+# define kmm_malloc_size(p)     malloc_usable_size(p)
 
 #elif !defined(CONFIG_MM_KERNEL_HEAP)
 /* If this the kernel phase of a kernel build, and there are only user-space
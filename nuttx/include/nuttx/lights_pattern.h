@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_NUTTX_LIGHTS_PATTERN_H
+#define __INCLUDE_NUTTX_LIGHTS_PATTERN_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <nuttx/wdog.h>
+
+/* Keyframe flags */
+#define LIGHTS_KEYFRAME_RAMP    0x01    /* ramp linearly to the level */
+
+/**
+ * One step of a pattern
+ *
+ * The output is set to level at the start of the keyframe and held for
+ * duration_ms, or, with LIGHTS_KEYFRAME_RAMP, goes linearly from the
+ * previous level to level over duration_ms.
+ */
+struct lights_keyframe {
+    uint16_t duration_ms;
+    uint8_t level;
+    uint8_t flags;
+};
+
+/**
+ * Set the output level
+ *
+ * Called from the timer interrupt, so it must not sleep. Typically writes a
+ * PWM duty cycle or a GPIO.
+ *
+ * @param level level to output, 0 is off
+ * @param priv argument given to lights_pattern_init()
+ */
+typedef void (*lights_pattern_output)(uint8_t level, void *priv);
+
+#ifdef CONFIG_LIGHTS_PATTERN
+
+/**
+ * A pattern player
+ *
+ * Once started, the keyframes are played from a watchdog timer without any
+ * thread or host involvement.
+ */
+struct lights_pattern {
+    struct wdog_s wdog;
+    lights_pattern_output output;
+    void *priv;
+    struct lights_keyframe frames[CONFIG_LIGHTS_PATTERN_MAX_FRAMES];
+    uint8_t nframes;
+    uint8_t frame;
+    uint16_t repeat;
+    uint16_t step;
+    uint16_t nsteps;
+    uint8_t from;
+    uint8_t level;
+    bool active;
+    bool resync;
+};
+
+void lights_pattern_init(struct lights_pattern *pattern,
+                         lights_pattern_output output, void *priv);
+int lights_pattern_start(struct lights_pattern *pattern,
+                         const struct lights_keyframe *frames,
+                         unsigned int nframes, uint16_t repeat);
+void lights_pattern_stop(struct lights_pattern *pattern, bool off);
+bool lights_pattern_active(struct lights_pattern *pattern);
+#endif
+
+#endif /* __INCLUDE_NUTTX_LIGHTS_PATTERN_H */
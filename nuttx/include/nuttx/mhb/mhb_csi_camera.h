@@ -48,6 +48,12 @@ enum mhb_camera_notification_event{
     MHB_CAMERA_NOTIFY_FW_UPGRADE      = 0x04,
 };
 
+/* One byte register write, 16 bit register address */
+struct mhb_camera_i2c_reg_array {
+    const uint16_t reg_addr;
+    const uint8_t data;
+};
+
 typedef int (*mhb_camera_notification_cb)(
              enum mhb_camera_notification_event event);
 
@@ -63,6 +69,12 @@ int mhb_camera_i2c_read_reg(uint16_t i2c_addr, uint16_t regaddr,
                              void *value, uint8_t reg_size, uint8_t reg_width);
 int mhb_camera_i2c_write_reg(uint16_t i2c_addr, uint16_t regaddr,
                              uint32_t data, uint8_t reg_size, uint8_t reg_width);
+/* Write a register table. Runs of consecutive addresses are sent as one
+ * auto-increment I2C burst of up to CONFIG_MHB_CAMERA_I2C_BURST_MAX bytes.
+ */
+int mhb_camera_i2c_write_regs1_16(uint16_t i2c_addr,
+                                  const struct mhb_camera_i2c_reg_array *regs,
+                                  size_t num);
 
 static inline int mhb_camera_i2c_read_reg1(uint16_t i2c_addr,
                                            uint16_t regaddr, uint8_t *value)
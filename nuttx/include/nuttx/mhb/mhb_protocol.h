@@ -561,6 +561,13 @@ struct mhb_hsic_control_req {
 	uint8_t command;
 } __attribute__((packed));
 
+/* A value of zero in any field leaves the server default in place. */
+struct mhb_hsic_config_req {
+	uint8_t rx_bufs;     /* RX buffers per tunneled endpoint CPort */
+	uint8_t e2efc;       /* Enable E2E flow control on the CPorts */
+	uint16_t rx_bufsize; /* Size of each RX buffer in bytes */
+} __attribute__((packed));
+
 /* Diag */
 struct mhb_diag_mode_req {
 	uint32_t mode;
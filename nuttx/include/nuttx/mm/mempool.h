@@ -0,0 +1,203 @@
+/****************************************************************************
+ * include/nuttx/mm/mempool.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MM_MEMPOOL_H
+#define __INCLUDE_NUTTX_MM_MEMPOOL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <semaphore.h>
+
+#ifdef CONFIG_MM_MEMPOOL
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Special timeout values for mempool_alloc() */
+
+#define MEMPOOL_NOWAIT     0
+#define MEMPOOL_FOREVER    (-1)
+
+/* Blocks are rounded up to pointer alignment:  A free block holds the link
+ * to the next free block.
+ */
+
+#define MEMPOOL_BLOCKSIZE(s) \
+  (((s) + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1))
+
+/* Initializer for a pool over caller provided storage */
+
+#define MEMPOOL_INITIALIZER(name, storage, bsize, nblocks) \
+  { \
+    NULL, (name), (FAR uint8_t *)(storage), NULL, SEM_INITIALIZER(0), \
+    MEMPOOL_BLOCKSIZE(bsize), (nblocks), 0, 0, 0, 0, 0, false \
+  }
+
+/* Define a statically allocated pool of 'nblocks' blocks of 'bsize' bytes.
+ * No run-time initialization is needed.  For example:
+ *
+ *   MEMPOOL_DEFINE(g_opnodes, "uart-op", sizeof(struct op_node), 8);
+ *
+ *   node = mempool_alloc(&g_opnodes, MEMPOOL_NOWAIT);
+ */
+
+#define MEMPOOL_DEFINE(var, name, bsize, nblocks) \
+  static uintptr_t var##_storage[(MEMPOOL_BLOCKSIZE(bsize) / \
+                                  sizeof(uintptr_t)) * (nblocks)]; \
+  static struct mempool_s var = \
+    MEMPOOL_INITIALIZER(name, var##_storage, bsize, nblocks)
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* A pool of fixed size blocks.  The fields are private to the pool logic,
+ * except for the statistics which may be read (see mempool_foreach()).
+ */
+
+struct mempool_s
+{
+  FAR struct mempool_s *flink;  /* Next registered pool */
+  FAR const char *name;         /* Name shown in /proc/mempool */
+  FAR uint8_t *base;            /* Start of the block storage */
+  FAR void *freelist;           /* Blocks that have been freed */
+  sem_t waitsem;                /* Threads waiting for a free block */
+  uint16_t bsize;               /* Size of one block */
+  uint16_t nblocks;             /* Number of blocks in the pool */
+  uint16_t ninit;               /* Blocks ever taken from base */
+
+  /* Statistics */
+
+  uint16_t nused;               /* Blocks allocated now */
+  uint16_t peak;                /* Highest value of nused */
+  uint32_t nalloc;              /* Successful allocations */
+  uint32_t nfail;               /* Failed allocations */
+  bool registered;              /* In the list walked by mempool_foreach() */
+};
+
+/* This is the callback type used by mempool_foreach() */
+
+typedef CODE void (*mempool_handler_t)(FAR const struct mempool_s *pool,
+                                       FAR void *arg);
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: mempool_initialize
+ *
+ * Description:
+ *   Set up a pool over 'nblocks' blocks of 'bsize' bytes at 'storage',
+ *   which must be pointer aligned and hold
+ *   nblocks * MEMPOOL_BLOCKSIZE(bsize) bytes.  Pools known at compile time
+ *   should rather use MEMPOOL_DEFINE().
+ *
+ ****************************************************************************/
+
+void mempool_initialize(FAR struct mempool_s *pool, FAR const char *name,
+                        FAR void *storage, size_t bsize, size_t nblocks);
+
+/****************************************************************************
+ * Name: mempool_uninitialize
+ *
+ * Description:
+ *   Forget a pool whose blocks have all been freed, so that its storage
+ *   may be released.  Must not be called from an interrupt handler.
+ *
+ ****************************************************************************/
+
+void mempool_uninitialize(FAR struct mempool_s *pool);
+
+/****************************************************************************
+ * Name: mempool_alloc
+ *
+ * Description:
+ *   Allocate one block.  If the pool is empty, wait up to 'timeout'
+ *   milliseconds for a block to be freed:  MEMPOOL_NOWAIT does not wait
+ *   and may be used from an interrupt handler, MEMPOOL_FOREVER waits as
+ *   long as necessary.
+ *
+ * Returned Value:
+ *   The block, or NULL if none became available.
+ *
+ ****************************************************************************/
+
+FAR void *mempool_alloc(FAR struct mempool_s *pool, int timeout);
+
+/****************************************************************************
+ * Name: mempool_free
+ *
+ * Description:
+ *   Return a block to its pool, waking up a waiting thread if there is
+ *   one.  May be used from an interrupt handler.
+ *
+ ****************************************************************************/
+
+void mempool_free(FAR struct mempool_s *pool, FAR void *blk);
+
+/****************************************************************************
+ * Name: mempool_foreach
+ *
+ * Description:
+ *   Call 'handler' for each pool that has been used, with the scheduler
+ *   locked.
+ *
+ ****************************************************************************/
+
+void mempool_foreach(mempool_handler_t handler, FAR void *arg);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_MM_MEMPOOL */
+#endif /* __INCLUDE_NUTTX_MM_MEMPOOL_H */
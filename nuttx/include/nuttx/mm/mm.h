@@ -171,6 +171,21 @@
 #define MM_ALIGN_UP(a)   (((a) + MM_GRAN_MASK) & ~MM_GRAN_MASK)
 #define MM_ALIGN_DOWN(a) ((a) & ~MM_GRAN_MASK)
 
+/* Two-level segregated fit (TLSF) free lists.  The first level divides
+ * sizes by powers of two, the second level divides every power of two into
+ * MM_TLSF_SLCOUNT equal ranges.  Sizes below MM_TLSF_SMALL all use first
+ * level 0, divided into MM_MIN_CHUNK steps.  Chunks of MM_MAX_CHUNK*2 and
+ * more all end up in the very last list.
+ */
+
+#ifdef CONFIG_MM_TLSF
+#  define MM_TLSF_SLI     CONFIG_MM_TLSF_SLI
+#  define MM_TLSF_SLCOUNT (1 << MM_TLSF_SLI)
+#  define MM_TLSF_SMALL   (1 << (MM_MIN_SHIFT + MM_TLSF_SLI))
+#  define MM_TLSF_FLCOUNT (MM_MAX_SHIFT - (MM_MIN_SHIFT + MM_TLSF_SLI) + 2)
+#  define MM_TLSF_NLISTS  (MM_TLSF_FLCOUNT * MM_TLSF_SLCOUNT)
+#endif
+
 /* An allocated chunk is distinguished from a free chunk by bit 31 (or 15)
  * of the 'preceding' chunk size.  If set, then this is an allocated chunk.
  */
@@ -206,12 +221,19 @@ struct mm_allocnode_s
 {
   mmsize_t size;           /* Size of this chunk */
   mmsize_t preceding;      /* Size of the preceding chunk */
+#ifdef CONFIG_MM_PROFILE
+  FAR void *caller;        /* Return address of the allocation call */
+  pid_t pid;               /* Thread that allocated the chunk */
+  uint16_t reserved;       /* Pads the header to MM_MIN_CHUNK */
+#endif
 };
 
 /* What is the size of the allocnode? */
 
 #ifdef CONFIG_MM_SMALL
 # define SIZEOF_MM_ALLOCNODE   4
+#elif defined(CONFIG_MM_PROFILE)
+# define SIZEOF_MM_ALLOCNODE   16
 #else
 # define SIZEOF_MM_ALLOCNODE   8
 #endif
@@ -244,6 +266,29 @@ struct mm_freenode_s
 #define CHECK_FREENODE_SIZE \
   DEBUGASSERT(sizeof(struct mm_freenode_s) == SIZEOF_MM_FREENODE)
 
+/* Per-thread small allocation caches.  Chunks up to MM_TCACHE_MAXCHUNK
+ * bytes (including the allocation header) are cached in one magazine per
+ * MM_MIN_CHUNK sized class.
+ */
+
+#ifdef CONFIG_MM_TCACHE
+#  define MM_TCACHE_MAXCHUNK \
+     MM_ALIGN_UP(CONFIG_MM_TCACHE_MAXSIZE + SIZEOF_MM_ALLOCNODE)
+#  define MM_TCACHE_NCLASSES (MM_TCACHE_MAXCHUNK >> MM_MIN_SHIFT)
+#  define MM_TCACHE_DEPTH    CONFIG_MM_TCACHE_DEPTH
+#  define MM_TCACHE_BATCH    (CONFIG_MM_TCACHE_DEPTH / 2)
+#endif
+
+/* Record the caller of an allocation function in the chunk header.  This
+ * must be used directly in the function whose caller is of interest.
+ */
+
+#ifdef CONFIG_MM_PROFILE
+#  define MM_PROFILE_TAG(mem) mm_profile_tag(mem, __builtin_return_address(0))
+#else
+#  define MM_PROFILE_TAG(mem)
+#endif
+
 /* This describes one heap (possibly with multiple regions) */
 
 struct mm_heap_s
@@ -271,13 +316,83 @@ struct mm_heap_s
   int mm_nregions;
 #endif
 
+#ifdef CONFIG_MM_PROFILE
+  /* Allocation counters.  The rate is the difference between two reads */
+
+  uint32_t mm_nallocs;     /* Number of chunks allocated */
+  uint32_t mm_nfrees;      /* Number of chunks freed */
+  uint32_t mm_allocbytes;  /* Number of bytes allocated, with headers */
+#endif
+
+#ifdef CONFIG_MM_FRAGINFO
+  /* Fragmentation trend:  The smallest 'largest free chunk' seen by
+   * mm_mallinfo(), mm_fraginfo() or mm_coalesce().
+   */
+
+  size_t mm_mxordblk_min;
+#endif
+
+#ifdef CONFIG_MM_IDLE_COALESCE
+  size_t mm_reclaimed;     /* Bytes merged by mm_coalesce() */
+#endif
+
+#ifdef CONFIG_MM_TLSF
+  /* Free nodes are kept in one doubly linked list per size class.  A bit
+   * is set in mm_slbitmap[fl] for each non-empty list of first level fl,
+   * and a bit in mm_flbitmap for each non-zero mm_slbitmap[] entry.
+   */
+
+  uint32_t mm_flbitmap;
+  uint32_t mm_slbitmap[MM_TLSF_FLCOUNT];
+  FAR struct mm_freenode_s *mm_freelist[MM_TLSF_NLISTS];
+#else
   /* All free nodes are maintained in a doubly linked list.  This
    * array provides some hooks into the list at various points to
    * speed searches for free nodes.
    */
 
   struct mm_freenode_s mm_nodelist[MM_NNODES];
+#endif
+};
+
+#ifdef CONFIG_MM_TCACHE
+/* This is one thread's cache of small chunks from one heap.  The chunks
+ * in the magazines are still marked allocated in the heap.  A thread has
+ * one of these for each heap it allocates small chunks from, linked from
+ * its TCB.
+ */
+
+struct mm_tcache_s
+{
+  FAR struct mm_tcache_s *tc_flink;      /* Next cache of the same thread */
+  FAR struct mm_heap_s *tc_heap;         /* The heap the chunks belong to */
+  uint8_t tc_count[MM_TCACHE_NCLASSES];  /* Number of chunks per magazine */
+  FAR void *tc_mag[MM_TCACHE_NCLASSES][MM_TCACHE_DEPTH];
+};
+#endif
+
+#ifdef CONFIG_MM_FRAGINFO
+/* Free space fragmentation of a heap, as returned by mm_fraginfo().  nfree[]
+ * counts the free chunks by power of two size classes:  nfree[i] counts
+ * the chunks of at least MM_MIN_CHUNK << i bytes (headers included) and
+ * less than twice that.  The last class also holds all larger chunks.
+ */
+
+struct mm_fraginfo_s
+{
+  uint32_t nfree[MM_NNODES];  /* Free chunks per size class */
+  size_t   largest;           /* Largest free chunk now */
+  size_t   largest_min;       /* Smallest 'largest' seen so far */
+  size_t   reclaimed;         /* Bytes merged by mm_coalesce() */
 };
+#endif
+
+#ifdef CONFIG_MM_PROFILE
+/* This is the callback type used by mm_profile() */
+
+typedef void (*mm_profile_t)(FAR const struct mm_allocnode_s *node,
+                             FAR void *arg);
+#endif
 
 /****************************************************************************
  * Public Data
@@ -398,6 +513,16 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 FAR void *kmm_realloc(FAR void *oldmem, size_t newsize);
 #endif
 
+/* Functions contained in mm_malloc_size.c *********************************/
+
+size_t mm_malloc_size(FAR struct mm_heap_s *heap, FAR void *mem);
+
+/* Functions contained in kmm_malloc_size.c ********************************/
+
+#ifdef CONFIG_MM_KERNEL_HEAP
+size_t kmm_malloc_size(FAR void *mem);
+#endif
+
 /* Functions contained in mm_calloc.c ***************************************/
 
 FAR void *mm_calloc(FAR struct mm_heap_s *heap, size_t n, size_t elem_size);
@@ -508,6 +633,46 @@ void mm_shrinkchunk(FAR struct mm_heap_s *heap,
 void mm_addfreechunk(FAR struct mm_heap_s *heap,
                      FAR struct mm_freenode_s *node);
 
+/* Functions contained in mm_remfreechunk.c *********************************/
+
+void mm_remfreechunk(FAR struct mm_heap_s *heap,
+                     FAR struct mm_freenode_s *node);
+
+/* Functions contained in mm_findfreechunk.c ********************************/
+
+#ifdef CONFIG_MM_TLSF
+FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap,
+                                           size_t size);
+#endif
+
+/* Functions contained in mm_tcache.c ***************************************/
+
+#ifdef CONFIG_MM_TCACHE
+FAR void *mm_tcache_alloc(FAR struct mm_heap_s *heap, size_t size);
+bool mm_tcache_free(FAR struct mm_heap_s *heap, FAR void *mem);
+void mm_tcache_release(FAR struct mm_tcache_s *tcache);
+#endif
+
+/* Functions contained in mm_profile.c **************************************/
+
+#ifdef CONFIG_MM_PROFILE
+void mm_profile_tag(FAR void *mem, FAR void *caller);
+void mm_profile(FAR struct mm_heap_s *heap, mm_profile_t handler,
+                FAR void *arg);
+#endif
+
+/* Functions contained in mm_fraginfo.c ************************************/
+
+#ifdef CONFIG_MM_FRAGINFO
+void mm_fraginfo(FAR struct mm_heap_s *heap, FAR struct mm_fraginfo_s *info);
+#endif
+
+/* Functions contained in mm_coalesce.c *************************************/
+
+#ifdef CONFIG_MM_IDLE_COALESCE
+size_t mm_coalesce(FAR struct mm_heap_s *heap);
+#endif
+
 /* Functions contained in mm_size2ndx.c.c ***********************************/
 
 int mm_size2ndx(size_t size);
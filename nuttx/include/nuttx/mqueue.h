@@ -118,6 +118,22 @@ extern "C" {
 #define EXTERN extern
 #endif
 
+/* Zero-copy buffer messages.  A buffer from mq_bufalloc() is filled by the
+ * sender and queued with mq_sendbuf(); only its handle is stored in the
+ * message queue.  mq_receivebuf() hands the buffer itself to the receiver,
+ * which must release it with mq_buffree().  Buffer and ordinary messages
+ * may be mixed on one queue:  mq_receivebuf() returns ordinary messages
+ * in a newly allocated buffer, and mq_receive() copies buffer messages
+ * that fit into the caller's buffer.
+ */
+
+#ifdef CONFIG_MQ_BUFFERS
+FAR void *mq_bufalloc(size_t size);
+void mq_buffree(FAR void *buf);
+int mq_sendbuf(mqd_t mqdes, FAR void *buf, size_t buflen, int prio);
+ssize_t mq_receivebuf(mqd_t mqdes, FAR void **buf, FAR int *prio);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -71,10 +71,64 @@
 #define CONFIG_MTD_REGISTRATION   1
 #endif
 
+#ifndef CONFIG_MTD_REGISTRATION
+#  undef CONFIG_MTD_STATS
+#endif
+
+/* MTD performance counters.  Each operation keeps a histogram of its
+ * latency in system clock ticks:  0, 1, 2-3, 4-7, 8-15 and 16 or more.
+ */
+
+#define MTD_STATS_BREAD    0        /* Block reads (units: blocks) */
+#define MTD_STATS_BWRITE   1        /* Block writes (units: blocks) */
+#define MTD_STATS_READ     2        /* Byte reads (units: bytes) */
+#define MTD_STATS_WRITE    3        /* Byte writes (units: bytes) */
+#define MTD_STATS_ERASE    4        /* Erases (units: erase blocks) */
+#define MTD_STATS_NOPS     5
+
+#define MTD_STATS_NHIST    6
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+#ifdef CONFIG_MTD_STATS
+struct mtd_dev_s;
+
+/* Counters for one kind of MTD operation */
+
+struct mtd_opstats_s
+{
+  uint32_t count;                   /* Number of calls */
+  uint32_t errors;                  /* Number of failed calls */
+  uint32_t units;                   /* Blocks or bytes transferred */
+  uint32_t ticks;                   /* Total time spent (system ticks) */
+  uint32_t maxticks;                /* Longest call (system ticks) */
+  uint32_t hist[MTD_STATS_NHIST];   /* Latency histogram */
+};
+
+/* Performance counters of one registered MTD.  mtd_register() saves the
+ * driver methods here and replaces them with counting wrappers.
+ */
+
+struct mtd_stats_s
+{
+  int     (*erase)(FAR struct mtd_dev_s *dev, off_t startblock,
+                   size_t nblocks);
+  ssize_t (*bread)(FAR struct mtd_dev_s *dev, off_t startblock,
+                   size_t nblocks, FAR uint8_t *buffer);
+  ssize_t (*bwrite)(FAR struct mtd_dev_s *dev, off_t startblock,
+                    size_t nblocks, FAR const uint8_t *buffer);
+  ssize_t (*read)(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes,
+                  FAR uint8_t *buffer);
+#ifdef CONFIG_MTD_BYTE_WRITE
+  ssize_t (*write)(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes,
+                   FAR const uint8_t *buffer);
+#endif
+  struct mtd_opstats_s op[MTD_STATS_NOPS];
+};
+#endif
+
 /* The following defines the geometry for the device.  It treats the device
  * as though it where just an array of fixed size blocks.  That is most likely
  * not true, but the client will expect the device logic to do whatever is
@@ -114,6 +168,11 @@ struct mtd_dev_s
    * to the FLASH data sheet.  Rather, we are referring to the *smallest*
    * erasable part of the FLASH which may have a name like a page or sector
    * or subsector.
+   *
+   * Drivers that support the MTDIOC_ERASEBUSY ioctl may return as soon as
+   * the erase of the last block has been started.  The next access to the
+   * device then waits until the erase has completed, or the caller may poll
+   * MTDIOC_ERASEBUSY to do something else in the meantime.
    */
 
   int (*erase)(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks);
@@ -160,6 +219,12 @@ struct mtd_dev_s
 
   FAR const char *name;
 #endif
+
+#ifdef CONFIG_MTD_STATS
+  /* Performance counters */
+
+  struct mtd_stats_s stats;
+#endif
 };
 
 /****************************************************************************
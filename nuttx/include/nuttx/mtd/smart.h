@@ -82,6 +82,10 @@ struct mtd_smart_procfs_data_s
   uint8_t             formatversion;    /* Version of the volume format */
   uint32_t            unusedsectors;    /* Number of unused sectors (free when erased) */
   uint32_t            blockerases;      /* Number block erase operations */
+#ifdef CONFIG_MTD_STATS
+  uint32_t            gcblocks;         /* Erase blocks garbage collected */
+  uint32_t            relocations;      /* Sectors moved by garbage collection */
+#endif
 
 #ifdef CONFIG_MTD_SMART_SECTOR_ERASE_DEBUG
   FAR const uint8_t*  erasecounts;      /* Array of erase counts per erase block */
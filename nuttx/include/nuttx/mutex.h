@@ -0,0 +1,188 @@
+/****************************************************************************
+ * include/nuttx/mutex.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_MUTEX_H
+#define __INCLUDE_NUTTX_MUTEX_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <unistd.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <assert.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define MUTEX_NO_HOLDER   ((pid_t)-1)
+
+/* Initializer for statically allocated mutexes */
+
+#define MUTEX_INITIALIZER {SEM_INITIALIZER(1), MUTEX_NO_HOLDER}
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* A mutex is a binary semaphore with an owner.  Unlike a counting
+ * semaphore, it may only be released by the thread that locked it and it
+ * never holds more than one count.  That means the uncontended lock and
+ * unlock always take the priority inheritance fast path in sem_wait() and
+ * sem_post():  No holder container is allocated and the scheduler is not
+ * locked unless another thread actually blocks on the mutex.
+ *
+ * The mutex does not nest; locking it twice from the same thread is an
+ * error.
+ */
+
+struct mutex_s
+{
+  sem_t sem;      /* Underlying binary semaphore */
+  pid_t holder;   /* Owning thread or MUTEX_NO_HOLDER */
+};
+
+typedef struct mutex_s mutex_t;
+
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mutex_init
+ *
+ * Description:
+ *   Initialize a mutex in the unlocked state.
+ *
+ ****************************************************************************/
+
+static inline void mutex_init(FAR mutex_t *mutex)
+{
+  (void)sem_init(&mutex->sem, 0, 1);
+  mutex->holder = MUTEX_NO_HOLDER;
+}
+
+/****************************************************************************
+ * Name: mutex_destroy
+ *
+ * Description:
+ *   Release any resources associated with an unlocked mutex.
+ *
+ ****************************************************************************/
+
+static inline void mutex_destroy(FAR mutex_t *mutex)
+{
+  DEBUGASSERT(mutex->holder == MUTEX_NO_HOLDER);
+  (void)sem_destroy(&mutex->sem);
+}
+
+/****************************************************************************
+ * Name: mutex_lock
+ *
+ * Description:
+ *   Lock the mutex, waiting as long as necessary.  Signals received while
+ *   waiting do not abort the wait.
+ *
+ ****************************************************************************/
+
+static inline void mutex_lock(FAR mutex_t *mutex)
+{
+  DEBUGASSERT(mutex->holder != getpid());
+
+  while (sem_wait(&mutex->sem) != OK)
+    {
+      /* The only case that an error should occur here is if the wait was
+       * awakened by a signal.
+       */
+
+      ASSERT(get_errno() == EINTR);
+    }
+
+  mutex->holder = getpid();
+}
+
+/****************************************************************************
+ * Name: mutex_trylock
+ *
+ * Description:
+ *   Lock the mutex only if that can be done without waiting.
+ *
+ * Return Value:
+ *   OK on success; -EBUSY if the mutex is held by some thread.
+ *
+ ****************************************************************************/
+
+static inline int mutex_trylock(FAR mutex_t *mutex)
+{
+  if (sem_trywait(&mutex->sem) != OK)
+    {
+      return -EBUSY;
+    }
+
+  mutex->holder = getpid();
+  return OK;
+}
+
+/****************************************************************************
+ * Name: mutex_unlock
+ *
+ * Description:
+ *   Release a mutex previously locked by the calling thread.
+ *
+ ****************************************************************************/
+
+static inline void mutex_unlock(FAR mutex_t *mutex)
+{
+  DEBUGASSERT(mutex->holder == getpid());
+
+  mutex->holder = MUTEX_NO_HOLDER;
+  (void)sem_post(&mutex->sem);
+}
+
+/****************************************************************************
+ * Name: mutex_is_locked
+ ****************************************************************************/
+
+static inline bool mutex_is_locked(FAR mutex_t *mutex)
+{
+  return mutex->holder != MUTEX_NO_HOLDER;
+}
+
+#endif /* __INCLUDE_NUTTX_MUTEX_H */
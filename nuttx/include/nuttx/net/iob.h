@@ -184,6 +184,19 @@ void iob_initialize(void);
 
 FAR struct iob_s *iob_alloc(bool throttled);
 
+/****************************************************************************
+ * Name: iob_alloc_chain
+ *
+ * Description:
+ *   Allocate 'nbuffers' I/O buffers in one operation, returned linked
+ *   through io_flink, or none at all.  Never waits, so it may be used from
+ *   interrupt handlers.  The buffers are not a packet: each has a zero
+ *   io_pktlen.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc_chain(unsigned int nbuffers, bool throttled);
+
 /****************************************************************************
  * Name: iob_free
  *
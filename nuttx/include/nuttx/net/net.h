@@ -698,6 +698,31 @@ ssize_t psock_recvfrom(FAR struct socket *psock, FAR void *buf, size_t len,
 #define psock_recv(psock,buf,len,flags) \
   psock_recvfrom(psock,buf,len,flags,NULL,0)
 
+/****************************************************************************
+ * Function: psock_recviob
+ *
+ * Description:
+ *   Receive data from a TCP socket as the I/O buffer chain that holds it
+ *   in the read-ahead queue, without copying it into a caller buffer.  The
+ *   caller owns the returned chain and must free it with iob_free_chain().
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   iobp     Location to return the I/O buffer chain
+ *   flags    Receive flags (MSG_DONTWAIT)
+ *
+ * Returned Value:
+ *   The number of bytes in the returned chain, zero if the peer has
+ *   performed an orderly shutdown, otherwise -1 with errno set.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_TCP) && defined(CONFIG_NET_TCP_READAHEAD)
+struct iob_s; /* Forward reference. Defined in nuttx/net/iob.h */
+ssize_t psock_recviob(FAR struct socket *psock, FAR struct iob_s **iobp,
+                      int flags);
+#endif
+
 /****************************************************************************
  * Function: psock_getsockopt
  *
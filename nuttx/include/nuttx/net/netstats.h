@@ -63,6 +63,23 @@
 #  include <nuttx/net/igmp.h>
 #endif
 
+/****************************************************************************
+ * Public Type Definitions
+ ****************************************************************************/
+
+/* I/O buffer pool statistics */
+
+#if defined(CONFIG_NET_STATISTICS) && defined(CONFIG_NET_IOB)
+struct iob_stats_s
+{
+  net_stats_t alloc;      /* Number of I/O buffers allocated */
+  net_stats_t fail;       /* Number of allocations with no free buffer */
+  net_stats_t throttled;  /* Number of allocations denied by the throttle */
+  net_stats_t wait;       /* Number of times a thread waited for a buffer */
+  net_stats_t lowater;    /* Lowest number of free buffers seen */
+};
+#endif
+
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -114,6 +131,10 @@ struct net_stats_s
 #ifdef CONFIG_NET_UDP
   struct udp_stats_s  udp;  /* UDP statistics */
 #endif
+
+#ifdef CONFIG_NET_IOB
+  struct iob_stats_s  iob;  /* I/O buffer statistics */
+#endif
 };
 #endif /* CONFIG_NET_STATISTICS */
 
@@ -87,6 +87,14 @@ typedef FAR void *NXHANDLE;
 
 typedef FAR void *NXWINDOW;
 
+/* A client image surface registered with the NX server is managed using an
+ * opaque handle:
+ */
+
+#ifdef CONFIG_NX_SURFACES
+typedef FAR void *NXSURFACE;
+#endif
+
 /* NX server callbacks ******************************************************/
 
 /* These define callbacks that must be provided to nx_openwindow.  These
@@ -223,6 +231,25 @@ struct nx_callback_s
 #endif
 };
 
+/* Describes a client image surface to nx_registersurface().  In the kernel
+ * build each color plane is a shared memory region (see shmget()) that the
+ * server attaches for the lifetime of the registration; otherwise the
+ * planes are simply addressed in place.
+ */
+
+#ifdef CONFIG_NX_SURFACES
+struct nx_surfaceinfo_s
+{
+#ifdef CONFIG_MM_SHM
+  int shmid[CONFIG_NX_NPLANES];           /* Shared memory region of each plane */
+#else
+  FAR const void *src[CONFIG_NX_NPLANES]; /* Start of each image plane */
+#endif
+  struct nxgl_size_s size;                /* Size of the surface in pixels */
+  unsigned int stride;                    /* Width of a surface row in bytes */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -458,6 +485,56 @@ int nx_eventnotify(NXHANDLE handle, int signo);
 #  define nx_eventnotify(handle, signo) (OK)
 #endif
 
+/****************************************************************************
+ * Name: nx_batch
+ *
+ * Description:
+ *   Enable or disable batching of drawing commands on a connection.  While
+ *   batching is enabled, nx_setpixel(), nx_fill(), nx_filltrapezoid() (and
+ *   so nx_drawline() and the circle functions) and nx_move() are collected
+ *   in a client-side buffer and sent to the server as a single message.
+ *   The buffer is sent when it is full, when any other request is sent,
+ *   when nx_flush() is called, and when a redraw callback returns.
+ *
+ *   A client that draws outside of a redraw callback must call nx_flush()
+ *   when it has finished drawing.
+ *
+ * Input Parameters:
+ *   handle - the handle returned by nx_connect
+ *   enable - True: Buffer drawing commands; false: Send each one directly
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NX_MULTIUSER) && defined(CONFIG_NX_BATCH)
+int nx_batch(NXHANDLE handle, bool enable);
+#else
+#  define nx_batch(handle, enable) (OK)
+#endif
+
+/****************************************************************************
+ * Name: nx_flush
+ *
+ * Description:
+ *   Send any buffered drawing commands to the server.  This does not wait
+ *   for the server to execute them.
+ *
+ * Input Parameters:
+ *   handle - the handle returned by nx_connect
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NX_MULTIUSER) && defined(CONFIG_NX_BATCH)
+int nx_flush(NXHANDLE handle);
+#else
+#  define nx_flush(handle) (OK)
+#endif
+
 /****************************************************************************
  * Name: nx_openwindow
  *
@@ -892,6 +969,83 @@ int nx_bitmap(NXWINDOW hwnd, FAR const struct nxgl_rect_s *dest,
               FAR const void *src[CONFIG_NX_NPLANES],
               FAR const struct nxgl_point_s *origin, unsigned int stride);
 
+/****************************************************************************
+ * Name: nx_registersurface
+ *
+ * Description:
+ *   Register an image surface with the NX server so that later updates can
+ *   be sent with nx_surfaceblit() by handle and damage rectangle instead of
+ *   passing (and waiting on) the image with every nx_bitmap() call.
+ *
+ *   Multiple user mode only!
+ *
+ * Input Parameters:
+ *   handle - The handle returned by nx_connect
+ *   info   - Describes the surface image planes, size and stride
+ *
+ * Return:
+ *   Success: A non-NULL handle used with nx_surfaceblit()
+ *   Failure: NULL is returned and errno is set appropriately
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_SURFACES
+NXSURFACE nx_registersurface(NXHANDLE handle,
+                             FAR const struct nx_surfaceinfo_s *info);
+#endif
+
+/****************************************************************************
+ * Name: nx_unregistersurface
+ *
+ * Description:
+ *   Release a surface registered with nx_registersurface().  Blits already
+ *   queued for the surface are completed first, so on return the client
+ *   may reuse or free the image memory.
+ *
+ *   Multiple user mode only!
+ *
+ * Input Parameters:
+ *   hsurf - The handle returned by nx_registersurface
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_SURFACES
+int nx_unregistersurface(NXSURFACE hsurf);
+#endif
+
+/****************************************************************************
+ * Name: nx_surfaceblit
+ *
+ * Description:
+ *   Copy the damaged part of a registered surface into a window.  Unlike
+ *   nx_bitmap(), this does not wait for the server:  The server reads the
+ *   surface when it processes the request, so a client that keeps drawing
+ *   into the same surface should expect to see its latest contents.
+ *
+ *   Multiple user mode only!
+ *
+ * Input Parameters:
+ *   hwnd   - The window that will receive the image
+ *   hsurf  - The handle returned by nx_registersurface
+ *   dest   - The damaged region in window coordinates.  It is clipped to the
+ *            extent of the surface.
+ *   origin - The position of the upper, left-most corner of the surface in
+ *            window coordinates.
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_SURFACES
+int nx_surfaceblit(NXWINDOW hwnd, NXSURFACE hsurf,
+                   FAR const struct nxgl_rect_s *dest,
+                   FAR const struct nxgl_point_s *origin);
+#endif
+
 /****************************************************************************
  * Name: nx_kbdin
  *
@@ -267,6 +267,26 @@ struct nx_fontpackage_s
 #endif
 };
 
+/* An opaque handle to a shared glyph cache (see nxf_cache_connect()) */
+
+typedef FAR void *FCACHE;
+
+/* Describes one pre-rendered glyph held in a glyph cache.  The bitmap is
+ * rendered in the foreground color over the background color of the cache
+ * and may be blitted directly to the display.
+ */
+
+struct nxfonts_glyph_s
+{
+  FAR struct nxfonts_glyph_s *flink;     /* Next, less recently used glyph */
+  uint16_t code;                         /* Character code */
+  uint16_t stride;                       /* Width of the glyph row (in bytes) */
+  uint8_t height;                        /* Height of this glyph (in rows) */
+  uint8_t width;                         /* Width of this glyph (in pixels) */
+  uint8_t unused[2];                     /* Keeps bitmap[] 32-bit aligned */
+  FAR uint8_t bitmap[1];                 /* Start of the rendered bitmap */
+};
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -378,6 +398,83 @@ EXTERN int nxf_convert_32bpp(FAR uint32_t *dest, uint16_t height,
                              FAR const struct nx_fontbitmap_s *bm,
                              nxgl_mxpixel_t color);
 
+/****************************************************************************
+ * Name: nxf_cache_connect
+ *
+ * Description:
+ *   Return a handle to a glyph cache for the font, colors and pixel depth.
+ *   Caches are shared: if a cache with the same (fontid, fgcolor, bgcolor,
+ *   bpp) already exists, its reference count is incremented and the same
+ *   handle is returned.  Otherwise a new, empty cache is created.
+ *
+ * Input Parameters:
+ *   fontid    - Identifies the font set to use
+ *   fgcolor   - The color of '1' bits in the font bitmap
+ *   bgcolor   - The color of '0' bits in the font bitmap
+ *   bpp       - The pixel depth of the rendered glyphs
+ *   maxglyphs - The maximum number of glyphs to retain.  When the cache is
+ *               shared, the largest request applies.  Least recently used
+ *               glyphs are discarded beyond this limit.
+ *
+ * Returned Value:
+ *   A non-NULL handle on success; NULL on failure.
+ *
+ ****************************************************************************/
+
+EXTERN FCACHE nxf_cache_connect(enum nx_fontid_e fontid,
+                                nxgl_mxpixel_t fgcolor,
+                                nxgl_mxpixel_t bgcolor,
+                                int bpp, int maxglyphs);
+
+/****************************************************************************
+ * Name: nxf_cache_disconnect
+ *
+ * Description:
+ *   Release a reference to a glyph cache.  The cache and all of its glyphs
+ *   are freed when the last reference is released.
+ *
+ * Input Parameters:
+ *   fhandle - A handle previously returned by nxf_cache_connect()
+ *
+ ****************************************************************************/
+
+EXTERN void nxf_cache_disconnect(FCACHE fhandle);
+
+/****************************************************************************
+ * Name: nxf_cache_getfonthandle
+ *
+ * Description:
+ *   Return the font handle (see nxf_getfonthandle()) used by the cache.
+ *
+ * Input Parameters:
+ *   fhandle - A handle previously returned by nxf_cache_connect()
+ *
+ ****************************************************************************/
+
+EXTERN NXHANDLE nxf_cache_getfonthandle(FCACHE fhandle);
+
+/****************************************************************************
+ * Name: nxf_cache_getglyph
+ *
+ * Description:
+ *   Return the pre-rendered glyph for the character code, rendering and
+ *   caching it if it is not already cached.
+ *
+ * Input Parameters:
+ *   fhandle - A handle previously returned by nxf_cache_connect()
+ *   ch      - Character code whose glyph is requested
+ *
+ * Returned Value:
+ *   The cached glyph, or NULL if the font has no bitmap for the code or
+ *   if memory could not be allocated.  The glyph is the most recently used
+ *   one and so remains valid until maxglyphs other glyphs are rendered into
+ *   the cache or the last reference to the cache is released.
+ *
+ ****************************************************************************/
+
+EXTERN FAR const struct nxfonts_glyph_s *
+  nxf_cache_getglyph(FCACHE fhandle, uint16_t ch);
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
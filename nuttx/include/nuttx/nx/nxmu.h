@@ -67,6 +67,12 @@
 #  define CONFIG_NX_MXCLIENTMSGS 16 /* Number of pending messages in each client MQ */
 #endif
 
+#ifdef CONFIG_NX_BATCH
+#  ifndef CONFIG_NX_BATCHSIZE
+#    define CONFIG_NX_BATCHSIZE 256 /* Size of each client command buffer */
+#  endif
+#endif
+
 /* Used to create unique client MQ name */
 
 #define NX_CLIENT_MQNAMEFMT  "/dev/nxc%d"
@@ -87,6 +93,11 @@
 
 #define nxmu_semgive(sem)    sem_post(sem) /* To match nxmu_semtake() */
 
+/* Commands in a batch are padded so that each begins pointer-aligned */
+
+#define NX_BATCH_ALIGN(n) \
+  (((n) + sizeof(uintptr_t) - 1) & ~(sizeof(uintptr_t) - 1))
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
@@ -102,6 +113,32 @@ enum nx_clistate_e
   NX_CLISTATE_DISCONNECT_PENDING, /* Waiting for server to acknowledge disconnect */
 };
 
+/* A client-side buffer of drawing commands.  Each command has the same
+ * form as the corresponding client->server message.  The buffer is owned by
+ * the server from the time that it is sent in a NX_SVRMSG_BATCH message
+ * until the server posts 'done'.
+ */
+
+#ifdef CONFIG_NX_BATCH
+struct nxmu_batchbuf_s
+{
+  sem_t done;             /* Posted by the server when the batch is executed */
+  bool busy;              /* True while the server owns the buffer */
+  uint16_t nbytes;        /* Number of bytes of commands in data[] */
+  uintptr_t data[CONFIG_NX_BATCHSIZE / sizeof(uintptr_t)];
+};
+
+/* Commands are accumulated in one buffer while the server executes the
+ * other.
+ */
+
+struct nxmu_batch_s
+{
+  uint8_t current;        /* Index of the buffer being filled */
+  struct nxmu_batchbuf_s buf[2];
+};
+#endif
+
 /* This structure represents a connection between the client and the server */
 
 struct nxfe_conn_s
@@ -115,6 +152,9 @@ struct nxfe_conn_s
 
   mqd_t crdmq;            /* MQ to read from the server (may be non-blocking) */
   mqd_t cwrmq;            /* MQ to write to the server (blocking) */
+#ifdef CONFIG_NX_BATCH
+  FAR struct nxmu_batch_s *batch; /* Command buffers (NULL if not batching) */
+#endif
 
   /* These are only usable on the server side of the connection */
 
@@ -158,8 +198,27 @@ enum nxmsg_e
   NX_SVRMSG_SETBGCOLOR,       /* Set the color of the background */
   NX_SVRMSG_MOUSEIN,          /* New mouse report from mouse client */
   NX_SVRMSG_KBDIN,            /* New keyboard report from keyboard client */
-  NX_SVRMSG_REDRAWREQ         /* Request re-drawing of rectangular region */
+  NX_SVRMSG_REDRAWREQ,        /* Request re-drawing of rectangular region */
+  NX_SVRMSG_REGSURFACE,       /* Register a client image surface */
+  NX_SVRMSG_UNREGSURFACE,     /* Release a client image surface */
+  NX_SVRMSG_SURFBLIT,         /* Copy part of a surface into the window */
+  NX_SVRMSG_BATCH             /* Execute a buffer of drawing commands */
+};
+
+/* This structure represents a client image surface registered with the
+ * server.  It is allocated on the client side by nx_registersurface(); src[]
+ * and result are set by the server.
+ */
+
+#ifdef CONFIG_NX_SURFACES
+struct nxmu_surface_s
+{
+  FAR struct nxfe_conn_s *conn;           /* Connection of the owning client */
+  struct nx_surfaceinfo_s info;           /* Surface description from the client */
+  FAR const void *src[CONFIG_NX_NPLANES]; /* Image planes as seen by the server */
+  int result;                             /* Registration result (OK or -errno) */
 };
+#endif
 
 /* Server-to-Client Message Structures **************************************/
 
@@ -429,6 +488,7 @@ struct nxsvrmsg_mousein_s
   uint32_t msgid;                  /* NX_SVRMSG_MOUSEIN */
   struct nxgl_point_s pt;          /* Mouse X/Y position */
   uint8_t buttons;                 /* Mouse button set */
+  uint32_t time;                   /* System time of the report (ticks) */
 };
 #endif
 
@@ -455,6 +515,38 @@ struct nxsvrmsg_redrawreq_s
   struct nxgl_rect_s rect;         /* Describes the rectangular region to be redrawn */
 };
 
+#ifdef CONFIG_NX_SURFACES
+/* Register or release a client image surface */
+
+struct nxsvrmsg_regsurface_s
+{
+  uint32_t msgid;                  /* NX_SVRMSG_REGSURFACE or NX_SVRMSG_UNREGSURFACE */
+  FAR struct nxmu_surface_s *surf; /* The surface to be registered or released */
+  sem_t *sem_done;                 /* Semaphore to report when command is done. */
+};
+
+/* Copy the damaged part of a registered surface into the window */
+
+struct nxsvrmsg_surfblit_s
+{
+  uint32_t msgid;                  /* NX_SVRMSG_SURFBLIT */
+  FAR struct nxbe_window_s *wnd;   /* The window that will receive the image */
+  FAR struct nxmu_surface_s *surf; /* The source surface */
+  struct nxgl_rect_s dest;         /* Damaged region in window coordinates */
+  struct nxgl_point_s origin;      /* Window position of the surface origin */
+};
+#endif
+
+#ifdef CONFIG_NX_BATCH
+/* Execute a buffer of SETPIXEL, FILL, FILLTRAP and MOVE commands */
+
+struct nxsvrmsg_batch_s
+{
+  uint32_t msgid;                   /* NX_SVRMSG_BATCH */
+  FAR struct nxmu_batchbuf_s *batch; /* The buffer of commands */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -560,6 +652,53 @@ int nxmu_sendserver(FAR struct nxfe_conn_s *conn,
 int nxmu_sendwindow(FAR struct nxbe_window_s *wnd, FAR const void *msg,
                     size_t msglen);
 
+/****************************************************************************
+ * Name: nxmu_queuewindow
+ *
+ * Description:
+ *  Queue a drawing command destined for a specific window.  If batching is
+ *  enabled on the window's connection, the command is appended to the
+ *  current command buffer; otherwise it is sent with nxmu_sendwindow().
+ *
+ * Input Parameters:
+ *   wnd    - A pointer to the back-end window structure
+ *   msg    - A pointer to the message to send
+ *   msglen - The length of the message in bytes.
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_BATCH
+int nxmu_queuewindow(FAR struct nxbe_window_s *wnd, FAR const void *msg,
+                     size_t msglen);
+#else
+#  define nxmu_queuewindow(wnd, msg, msglen) nxmu_sendwindow(wnd, msg, msglen)
+#endif
+
+/****************************************************************************
+ * Name: nxmu_flush
+ *
+ * Description:
+ *  Send any drawing commands buffered on the connection to the server.
+ *  This must be called before any other message is sent so that commands
+ *  are executed in the order in which they were issued.
+ *
+ * Input Parameters:
+ *   conn - A pointer to the server connection structure
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_BATCH
+int nxmu_flush(FAR struct nxfe_conn_s *conn);
+#else
+#  define nxmu_flush(conn) (OK)
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
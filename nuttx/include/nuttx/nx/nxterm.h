@@ -159,6 +159,14 @@
 #  define CONFIG_NXTERM_LINESEPARATION 0
 #endif
 
+/* Maximum number of lines to scroll before the display is updated (zero
+ * scrolls the display once per line)
+ */
+
+#ifndef CONFIG_NXTERM_SCROLLBATCH
+#  define CONFIG_NXTERM_SCROLLBATCH 0
+#endif
+
 /* Input options */
 
 #ifndef CONFIG_NX_KBD
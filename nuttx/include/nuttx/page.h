@@ -44,6 +44,7 @@
 #include <nuttx/config.h>
 
 #ifndef __ASSEMBLY__
+#  include <stdint.h>
 #  include <stdbool.h>
 #  include <nuttx/sched.h>
 #endif
@@ -221,8 +222,35 @@
  *   the (asynchronous) page fill logic.  If the fill takes longer than this
  *   number if microseconds, then a fatal error will be declared.
  *   Default: No timeouts monitored.
+ * CONFIG_PAGING_PREFETCH - After a page fill, fill up to this many of the
+ *   following pages too.  Requires CONFIG_PAGING_BLOCKINGFILL and the
+ *   architecture functions up_checkvpage() and up_allocvpage().  Default: 0.
+ * CONFIG_PAGING_STATS - Keep page fault and fill counters for
+ *   pg_getstats().
  */
 
+#ifndef CONFIG_PAGING_PREFETCH
+#  define CONFIG_PAGING_PREFETCH 0
+#endif
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+#ifndef __ASSEMBLY__
+#ifdef CONFIG_PAGING_STATS
+/* Paging counters returned by pg_getstats() */
+
+struct pg_stats_s
+{
+  uint32_t nfaults;    /* Page faults reported through pg_miss() */
+  uint32_t nfills;     /* Pages filled for a waiting task */
+  uint32_t nrestarts;  /* Faults resolved without a fill */
+  uint32_t nprefetch;  /* Pages filled ahead of use */
+};
+#endif
+#endif /* __ASSEMBLY__ */
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -311,6 +339,21 @@ extern "C"
 
 void pg_miss(void);
 
+/****************************************************************************
+ * Name: pg_getstats
+ *
+ * Description:
+ *   Return a snapshot of the paging counters.
+ *
+ * Input Parameters:
+ *   stats - Location to return the counters.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PAGING_STATS
+void pg_getstats(FAR struct pg_stats_s *stats);
+#endif
+
 /****************************************************************************
  * Public Functions -- Provided by architecture-specific logic to common
  *                     paging logic.
@@ -399,6 +442,34 @@ bool up_checkmapping(FAR struct tcb_s *tcb);
 
 int up_allocpage(FAR struct tcb_s *tcb, FAR void **vpage);
 
+/****************************************************************************
+ * Name: up_checkvpage() and up_allocvpage()
+ *
+ * Description:
+ *  The same as up_checkmapping() and up_allocpage(), but for an explicit
+ *  virtual address instead of the fault address of a task.  They are used
+ *  to prefetch the pages that follow a page fill.  Since nobody is waiting
+ *  for a prefetched page, up_allocvpage() should treat it as not referenced
+ *  yet by its page replacement policy.
+ *
+ * Input Parameters:
+ *   vaddr - A virtual address in the paged region.
+ *   vpage - up_allocvpage() returns the virtual address of the page here.
+ *
+ * Returned Value:
+ *   up_checkvpage() returns true if the page is mapped.  up_allocvpage()
+ *   returns the same values as up_allocpage().
+ *
+ * Assumptions:
+ *   - Called from the page fill worker thread with interrupts disabled.
+ *
+ ****************************************************************************/
+
+bool up_checkvpage(uintptr_t vaddr);
+#if CONFIG_PAGING_PREFETCH > 0
+int up_allocvpage(uintptr_t vaddr, FAR void **vpage);
+#endif
+
 /****************************************************************************
  * Name: up_fillpage()
  *
@@ -427,9 +498,11 @@ int up_allocpage(FAR struct tcb_s *tcb, FAR void **vpage);
  *
  * Input Parameters:
  *   tcb - A reference to the task control block of the task that needs to
- *         have a page fill.  Architecture-specific logic can retrieve page
- *         fault information from the architecture-specific context
- *         information in this TCB to perform the fill.
+ *         have a page fill, or NULL for a prefetch.  The page to fill is
+ *         always the one at vpage, so the source offset must be derived
+ *         from vpage rather than from the fault address in the TCB.
+ *   vpage - The virtual address of the page returned by up_allocpage()
+ *         or up_allocvpage().
  *   pg_callbck - The function to be called when the page fill is complete.
  *
  * Returned Value:
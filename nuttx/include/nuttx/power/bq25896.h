@@ -29,6 +29,7 @@
 #ifndef __INCLUDE_NUTTX_POWER_BQ25896_H
 #define __INCLUDE_NUTTX_POWER_BQ25896_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -151,6 +152,16 @@ int bq25896_driver_init(int16_t int_n, int16_t pg_n);
  */
 int bq25896_reg_read(uint8_t reg);
 
+/**
+ * @brief Read consecutive device registers in a single transfer.
+ *
+ * @param reg Address of the first register.
+ * @param buf Buffer for register values.
+ * @param len Number of registers to read.
+ * @return 0 on success, negative errno on error.
+ */
+int bq25896_reg_read_block(uint8_t reg, uint8_t *buf, size_t len);
+
 /**
  * @brief Write new value to device register.
  *
@@ -70,6 +70,7 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <queue.h>
 
 #ifdef CONFIG_PM
@@ -315,6 +316,22 @@ struct pm_callback_s
   void (*notify)(FAR struct pm_callback_s *cb, enum pm_state_e pmstate);
 };
 
+#ifdef CONFIG_PM_QOS
+/* A wake-up latency constraint, see pm_qos_add().  The structure belongs
+ * to the driver and must stay valid until pm_qos_remove().
+ */
+
+struct pm_qos_s
+{
+  struct sq_entry_s entry;   /* Supports a singly linked list */
+  uint32_t latency;          /* Longest wake-up latency tolerated (us) */
+};
+
+/* No constraint */
+
+#  define PM_QOS_LATENCY_ANY UINT32_MAX
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -459,6 +476,38 @@ EXTERN enum pm_state_e pm_checkstate(void);
 
 EXTERN int pm_changestate(enum pm_state_e newstate);
 
+#ifdef CONFIG_PM_QOS
+/****************************************************************************
+ * Name: pm_qos_add, pm_qos_update, pm_qos_remove
+ *
+ * Description:
+ *   Add, change or remove a constraint on the wake-up latency of the
+ *   low-power states.  The IDLE loop only enters the states that can be
+ *   left, clocks restored, within the tightest constraint.  These may be
+ *   called from an interrupt handler.
+ *
+ * Input Parameters:
+ *   req     - The constraint, owned by the caller
+ *   latency - Longest wake-up latency tolerated in microseconds
+ *
+ ****************************************************************************/
+
+EXTERN void pm_qos_add(FAR struct pm_qos_s *req, uint32_t latency);
+EXTERN void pm_qos_update(FAR struct pm_qos_s *req, uint32_t latency);
+EXTERN void pm_qos_remove(FAR struct pm_qos_s *req);
+
+/****************************************************************************
+ * Name: pm_qos_latency
+ *
+ * Description:
+ *   Return the tightest wake-up latency constraint in microseconds, or
+ *   PM_QOS_LATENCY_ANY if there is none.
+ *
+ ****************************************************************************/
+
+EXTERN uint32_t pm_qos_latency(void);
+#endif
+
 #undef EXTERN
 #ifdef __cplusplus
 }
@@ -483,4 +532,12 @@ EXTERN int pm_changestate(enum pm_state_e newstate);
 #  define pm_changestate(state)
 
 #endif /* CONFIG_PM */
+
+#ifndef CONFIG_PM_QOS
+#  define pm_qos_add(req,lat)
+#  define pm_qos_update(req,lat)
+#  define pm_qos_remove(req)
+#  define pm_qos_latency()      (UINT32_MAX)
+#endif
+
 #endif /* __INCLUDE_NUTTX_POWER_PM_H */
@@ -0,0 +1,134 @@
+/****************************************************************************
+ * include/nuttx/profile.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_NUTTX_PROFILE_H
+#define __INCLUDE_NUTTX_PROFILE_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef CONFIG_SCHED_PROFILE
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One profiled code location: the interrupted PC and, with
+ * CONFIG_SCHED_PROFILE_CALLERS, the LR at the time of the sample.
+ */
+
+struct profile_entry_s
+{
+  FAR void *pc;                /* Interrupted program counter */
+  FAR void *lr;                /* Link register, NULL if not recorded */
+  uint32_t count;              /* Number of samples */
+};
+
+/* State of the profiler */
+
+struct profile_status_s
+{
+  bool running;                /* True while the sampling timer runs */
+  uint32_t rate;               /* Sampling rate in Hz */
+  uint32_t nsamples;           /* Samples taken since the last reset */
+  uint32_t ndropped;           /* Samples that did not find a free entry */
+  uint32_t nentries;           /* Entries in use */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/* Profiler interface (sched/sched/sched_profile.c) */
+
+int profile_start(void);
+void profile_stop(void);
+void profile_reset(void);
+void profile_status(FAR struct profile_status_s *status);
+int profile_next(FAR unsigned int *cursor, FAR struct profile_entry_s *entry);
+
+/****************************************************************************
+ * Name: profile_sample
+ *
+ * Description:
+ *   Account one sample.  Called by the architecture from the interrupt
+ *   handler of the sampling timer, with the PC and LR taken from the
+ *   exception frame of the interrupted context.
+ *
+ ****************************************************************************/
+
+void profile_sample(FAR void *pc, FAR void *lr);
+
+/****************************************************************************
+ * Name: up_profile_start
+ *
+ * Description:
+ *   Start a timer that interrupts 'rate' times per second and calls
+ *   profile_sample() from its handler.
+ *
+ ****************************************************************************/
+
+int up_profile_start(unsigned int rate);
+
+/****************************************************************************
+ * Name: up_profile_stop
+ *
+ * Description:
+ *   Stop the sampling timer.
+ *
+ ****************************************************************************/
+
+void up_profile_stop(void);
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_SCHED_PROFILE */
+#endif /* __INCLUDE_NUTTX_PROFILE_H */
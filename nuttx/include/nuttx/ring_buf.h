@@ -51,11 +51,25 @@
  * there can be only one accessor at a time, no locking is required to
  * access a ring buffer entry's data area (again, just like a network
  * controller's ring buffer interface).  ring_buf_pass() change ownership.
+ *
+ * ring_buf_alloc_ring_contig() builds a ring out of a single allocation
+ * with every entry's buffer aligned to a cache line (or a caller supplied
+ * DMA alignment).  Rings built this way can also be parked in a named pool
+ * with ring_buf_pool_put() and handed out again by ring_buf_pool_get()
+ * so that stream restarts don't go back to the allocator.
  */
 
 #ifndef __INCLUDE_NUTTX_RING_BUF_H
 #define __INCLUDE_NUTTX_RING_BUF_H
 
+#include <nuttx/config.h>
+
+#ifndef CONFIG_LIB_RING_BUF_ALIGN
+#define CONFIG_LIB_RING_BUF_ALIGN 32
+#endif
+
+struct ring_buf_block;
+
 enum ring_buf_owner {
     RING_BUF_OWNER_INVALID,
     RING_BUF_OWNER_PRODUCER,
@@ -71,6 +85,7 @@ struct ring_buf {
     void                *tailroom;
     void                *head;
     void                *tail;
+    struct ring_buf_block *block; /* NULL unless from ring_buf_alloc_ring_contig() */
 };
 
 /**
@@ -290,5 +305,27 @@ struct ring_buf *ring_buf_alloc_ring(unsigned int entries,
 void ring_buf_free_ring(struct ring_buf *first_rb,
                         void (*free_callback)(struct ring_buf *rb, void *arg),
                                               void *arg);
+struct ring_buf *ring_buf_alloc_ring_contig(unsigned int entries,
+                                            unsigned int headroom,
+                                            unsigned int data_len,
+                                            unsigned int tailroom,
+                                            unsigned int align,
+                                            int (*alloc_callback)(
+                                                struct ring_buf *rb,
+                                                void *arg),
+                                            void (*free_callback)(
+                                                struct ring_buf *rb,
+                                                void *arg),
+                                            void *arg);
+struct ring_buf *ring_buf_pool_get(const char *name, unsigned int entries,
+                                   unsigned int headroom,
+                                   unsigned int data_len,
+                                   unsigned int tailroom,
+                                   unsigned int align,
+                                   int (*init_callback)(struct ring_buf *rb,
+                                                        void *arg),
+                                   void *arg);
+void ring_buf_pool_put(struct ring_buf *rb);
+void ring_buf_pool_flush(const char *name);
 
 #endif /* __INCLUDE_NUTTX_RING_BUF_H */
@@ -144,6 +144,19 @@ struct rwbuffer_s
   off_t         wrexpectedblock; /* Next block expected */
 #endif
 
+  /* This is the state of the write-behind buffer:  A full write buffer is
+   * swapped with this one and flushed on the worker thread while new
+   * writes go to the (now empty) write buffer.
+   */
+
+#ifdef CONFIG_DRVR_WRITEBEHIND
+  sem_t         wbsem;           /* Held while the write-behind buffer is flushed */
+  struct work_s wbwork;          /* Work to flush the write-behind buffer */
+  uint8_t      *wbbuffer;        /* Allocated write-behind buffer */
+  uint16_t      wbnblocks;       /* Number of blocks in write-behind buffer */
+  off_t         wbblockstart;    /* First block in write-behind buffer */
+#endif
+
   /* This is the state of the read-ahead buffering */
 
 #ifdef CONFIG_DRVR_READAHEAD
@@ -152,8 +165,30 @@ struct rwbuffer_s
   uint16_t      rhnblocks;       /* Number of blocks in read-ahead buffer */
   off_t         rhblockstart;    /* First block in read-ahead buffer */
 #endif
+#ifdef CONFIG_DRVR_READAHEAD_ADAPTIVE
+  uint16_t      rhwindow;        /* Number of blocks to read ahead now */
+  off_t         rhnextblock;     /* Block after the last read-ahead */
+#endif
+
+  /* Statistics.  These may be read (see rwb_foreach()). */
+
+#ifdef CONFIG_DRVR_RWBSTATS
+  FAR struct rwbuffer_s *flink;  /* Next in the list walked by rwb_foreach() */
+  uint32_t      rhhits;          /* Blocks read from the read-ahead buffer */
+  uint32_t      rhloads;         /* Reloads of the read-ahead buffer */
+  uint32_t      wrblocks;        /* Blocks added to the write buffer */
+  uint32_t      wrflushes;       /* Flushes of the write buffer */
+  uint32_t      wrwaits;         /* Waits for a write-behind flush */
+#endif
 };
 
+/* This is the callback type used by rwb_foreach() */
+
+#ifdef CONFIG_DRVR_RWBSTATS
+typedef CODE void (*rwb_handler_t)(FAR const struct rwbuffer_s *rwb,
+                                   FAR void *arg);
+#endif
+
 /**********************************************************************
  * Global Variables
  **********************************************************************/
@@ -202,6 +237,14 @@ int rwb_invalidate(FAR struct rwbuffer_s *rwb,
                    off_t startblock, size_t blockcount);
 #endif
 
+/* Statistics:  Call 'handler' for each initialized buffer, with the
+ * scheduler locked.
+ */
+
+#ifdef CONFIG_DRVR_RWBSTATS
+void rwb_foreach(rwb_handler_t handler, FAR void *arg);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
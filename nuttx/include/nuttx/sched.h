@@ -441,6 +441,7 @@ struct task_group_s
  */
 
 FAR struct wdog_s;                       /* Forward reference                   */
+struct mm_tcache_s;                      /* Forward reference                   */
 
 struct tcb_s
 {
@@ -498,6 +499,9 @@ struct tcb_s
                                          /* Need to deallocate stack            */
   FAR void *adj_stack_ptr;               /* Adjusted stack_alloc_ptr for HW     */
                                          /* The initial stack pointer value     */
+#ifdef CONFIG_SCHED_TCBCACHE
+  size_t    req_stack_size;              /* Stack size requested at creation    */
+#endif
 
   /* External Module Support ****************************************************/
 
@@ -505,6 +509,12 @@ struct tcb_s
   FAR struct dspace_s *dspace;           /* Allocated area for .bss and .data   */
 #endif
 
+  /* Memory Management Fields ***************************************************/
+
+#ifdef CONFIG_MM_TCACHE
+  FAR struct mm_tcache_s *tcache;        /* Small allocation caches             */
+#endif
+
   /* POSIX Semaphore Control Fields *********************************************/
 
   sem_t *waitsem;                        /* Semaphore ID waiting on             */
@@ -603,6 +613,22 @@ struct pthread_tcb_s
 
 typedef void (*sched_foreach_t)(FAR struct tcb_s *tcb, FAR void *arg);
 
+#ifdef CONFIG_SCHED_STACK_USAGE
+/* The peak stack use recorded for all threads of one name */
+
+struct stackusage_s
+{
+  char   name[CONFIG_TASK_NAME_SIZE+1]; /* Thread name */
+  size_t size;                          /* Largest stack allocated */
+  size_t peak;                          /* Deepest stack use seen */
+};
+
+/* This is the callback type used by sched_stackusage() */
+
+typedef void (*sched_stackusage_t)(FAR const struct stackusage_s *usage,
+                                   FAR void *arg);
+#endif
+
 #endif /* __ASSEMBLY__ */
 
 /********************************************************************************
@@ -641,6 +667,17 @@ void sched_foreach(sched_foreach_t handler, FAR void *arg);
 
 FAR struct tcb_s *sched_gettcb(pid_t pid);
 
+#ifdef CONFIG_SCHED_STACK_USAGE
+/* sched_stackrecord() merges the current stack high-water mark of a thread
+ * into the record for its name.  It is called for each thread as it exits.
+ * sched_stackusage() records all running threads as well and then provides
+ * each record to a callback function.
+ */
+
+void sched_stackrecord(FAR struct tcb_s *tcb);
+void sched_stackusage(sched_stackusage_t handler, FAR void *arg);
+#endif
+
 /* File system helpers **********************************************************/
 /* These functions all extract lists from the group structure assocated with the
  * currently executing task.
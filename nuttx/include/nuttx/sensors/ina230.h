@@ -104,6 +104,9 @@ uint32_t ina230_get_sampling_time(ina230_conversion_time ct,
                                  ina230_avg_count avg_count,
                                  ina230_power_mode mode);
 int ina230_get_data(ina230_device *dev, ina230_sample *m);
+int ina230_get_fast_data(ina230_device *dev, ina230_sample *m);
+int ina230_enable_cnvr_alert(ina230_device *dev);
+int ina230_conversion_ready(ina230_device *dev);
 int ina230_deinit(ina230_device *dev);
 
 #endif
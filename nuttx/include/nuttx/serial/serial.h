@@ -77,6 +77,7 @@
 #define uart_txempty(dev)        dev->ops->txempty(dev)
 #define uart_send(dev,ch)        dev->ops->send(dev,ch)
 #define uart_receive(dev,s)      dev->ops->receive(dev,s)
+#define uart_dmasend(dev,b,n)    dev->ops->dmasend(dev,b,n)
 
 #ifdef CONFIG_SERIAL_IFLOWCONTROL
 #define uart_rxflowcontrol(dev) \
@@ -191,6 +192,18 @@ struct uart_ops_s
    */
 
   CODE bool (*txempty)(FAR struct uart_dev_s *dev);
+
+#ifdef CONFIG_SERIAL_DMA
+  /* Start a DMA transfer of 'buflen' bytes from the xmit buffer.  The buffer
+   * is one contiguous span returned by uart_xmitspan(); the lower half calls
+   * uart_xmitchars_done() when the transfer completes.  A lower half using
+   * TX DMA starts transfers with uart_xmitchars_dma() from its txint() method
+   * instead of feeding the TX FIFO from the TX interrupt.
+   */
+
+  CODE void (*dmasend)(FAR struct uart_dev_s *dev, FAR const char *buffer,
+                       size_t buflen);
+#endif
 };
 
 /* This is the device structure used by the driver.  The caller of
@@ -236,6 +249,9 @@ struct uart_dev_s
 
   struct uart_buffer_s xmit;         /* Describes transmit buffer */
   struct uart_buffer_s recv;         /* Describes receive buffer */
+#ifdef CONFIG_SERIAL_DMA
+  volatile size_t      dmatxlen;     /* Length of the TX DMA in progress */
+#endif
 
   /* Driver interface */
 
@@ -307,6 +323,75 @@ void uart_xmitchars(FAR uart_dev_t *dev);
 
 void uart_recvchars(FAR uart_dev_t *dev);
 
+/************************************************************************************
+ * Name: uart_xmitspan, uart_xmitcommit
+ *
+ * Description:
+ *   Bulk access to the transmit buffer for lower halves that move more than one
+ *   character at a time.  uart_xmitspan() returns the number of contiguous
+ *   characters at the tail of the xmit buffer (and their address in 'span');
+ *   uart_xmitcommit() releases 'nbytes' of them once they have been sent.
+ *
+ ************************************************************************************/
+
+size_t uart_xmitspan(FAR uart_dev_t *dev, FAR char **span);
+void uart_xmitcommit(FAR uart_dev_t *dev, size_t nbytes);
+
+/************************************************************************************
+ * Name: uart_recvspan, uart_recvcommit, uart_recvbuf
+ *
+ * Description:
+ *   Bulk access to the receive buffer.  uart_recvspan() returns the size of the
+ *   contiguous free space at the head of the receive buffer (and its address in
+ *   'span'); uart_recvcommit() publishes 'nbytes' characters written there.
+ *   uart_recvbuf() copies a whole block in, discarding what does not fit, and
+ *   returns the number of characters buffered.
+ *
+ ************************************************************************************/
+
+size_t uart_recvspan(FAR uart_dev_t *dev, FAR char **span);
+void uart_recvcommit(FAR uart_dev_t *dev, size_t nbytes);
+size_t uart_recvbuf(FAR uart_dev_t *dev, FAR const char *buffer, size_t buflen);
+
+/************************************************************************************
+ * Name: uart_xmitchars_dma
+ *
+ * Description:
+ *   Start a TX DMA transfer of the contiguous data at the tail of the xmit
+ *   buffer, if there is any and no transfer is already in progress.
+ *
+ ************************************************************************************/
+
+#ifdef CONFIG_SERIAL_DMA
+void uart_xmitchars_dma(FAR uart_dev_t *dev);
+
+/************************************************************************************
+ * Name: uart_xmitchars_done
+ *
+ * Description:
+ *   Called by the lower half when a TX DMA transfer completes.  Releases the
+ *   transmitted data, wakes up waiting writers and starts the next transfer.
+ *
+ ************************************************************************************/
+
+void uart_xmitchars_done(FAR uart_dev_t *dev);
+
+/************************************************************************************
+ * Name: uart_recvchars_dma
+ *
+ * Description:
+ *   Called by a lower half running its RX DMA in circular mode, from the
+ *   half-transfer, transfer-complete and idle-line interrupts.  'buffer' and
+ *   'size' describe the circular DMA buffer, '*lastpos' is where the previous
+ *   call stopped and 'pos' is the current DMA write position.  The new bytes are
+ *   copied into the receive buffer and '*lastpos' is updated.
+ *
+ ************************************************************************************/
+
+void uart_recvchars_dma(FAR uart_dev_t *dev, FAR const char *buffer, size_t size,
+                        FAR size_t *lastpos, size_t pos);
+#endif
+
 /************************************************************************************
  * Name: uart_datareceived
  *
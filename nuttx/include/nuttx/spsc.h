@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file spsc.h
+ * @brief Single-producer/single-consumer queue
+ *
+ * A fixed size ring of pointers with exactly one producer and exactly one
+ * consumer.  The producer may be an interrupt handler.  Neither side ever
+ * disables interrupts:  the producer only writes 'head', the consumer only
+ * writes 'tail', and memory barriers order the slot accesses against the
+ * index updates.
+ *
+ * The consumer sleeps on a semaphore in spsc_wait().  The producer posts that
+ * semaphore only when it finds the consumer waiting, so a burst of messages
+ * costs one wakeup rather than one per message.  The consumer is expected to
+ * drain the queue with spsc_pop() every time spsc_wait() returns:
+ *
+ *     while (running) {
+ *         spsc_wait(q);
+ *         while ((item = spsc_pop(q)) != NULL)
+ *             handle(item);
+ *     }
+ *
+ * spsc_wait() may return with the queue empty (a signal, a wakeup raced with
+ * the consumer noticing the data by itself, or spsc_kick()), so callers must
+ * not assume spsc_pop() succeeds.
+ */
+
+#ifndef __INCLUDE_NUTTX_SPSC_H
+#define __INCLUDE_NUTTX_SPSC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <semaphore.h>
+
+#if defined(__arm__)
+#  define spsc_barrier() __asm__ __volatile__ ("dmb" ::: "memory")
+#else
+#  define spsc_barrier() __sync_synchronize()
+#endif
+
+struct spsc_queue {
+    volatile unsigned int head;     /* Next slot to fill; producer only */
+    volatile unsigned int tail;     /* Next slot to drain; consumer only */
+    volatile bool         waiting;  /* Consumer is blocked in spsc_wait() */
+    unsigned int          mask;     /* Number of slots - 1 */
+    void                  **slots;
+    sem_t                 sem;
+};
+
+/**
+ * @brief Test if the queue holds no entries
+ * @param q Address of the queue
+ * @return true if there is nothing for the consumer
+ */
+static inline bool spsc_is_empty(struct spsc_queue *q)
+{
+    return q->head == q->tail;
+}
+
+/**
+ * @brief Return the number of entries waiting for the consumer
+ * @param q Address of the queue
+ * @return Number of queued entries
+ */
+static inline unsigned int spsc_len(struct spsc_queue *q)
+{
+    return q->head - q->tail;
+}
+
+/**
+ * Only the producer may call this function.  It is safe to call from an
+ * interrupt handler.
+ *
+ * @brief Add an entry at the end of the queue
+ * @param q Address of the queue
+ * @param item Entry to add; must not be NULL
+ * @return true on success, false if the queue is full
+ */
+static inline bool spsc_push(struct spsc_queue *q, void *item)
+{
+    unsigned int head = q->head;
+
+    if (head - q->tail > q->mask)
+        return false;
+
+    q->slots[head & q->mask] = item;
+
+    /* The slot must be visible before the consumer can see the new head */
+    spsc_barrier();
+    q->head = head + 1;
+
+    /* Pairs with the barrier in spsc_wait(): either we see the consumer
+     * waiting, or the consumer sees the new head and does not sleep.
+     */
+    spsc_barrier();
+    if (q->waiting) {
+        q->waiting = false;
+        sem_post(&q->sem);
+    }
+
+    return true;
+}
+
+/**
+ * Only the consumer may call this function.
+ *
+ * @brief Remove the entry at the front of the queue
+ * @param q Address of the queue
+ * @return The entry, or NULL if the queue is empty
+ */
+static inline void *spsc_pop(struct spsc_queue *q)
+{
+    unsigned int tail = q->tail;
+    void *item;
+
+    if (tail == q->head)
+        return NULL;
+
+    /* Do not read the slot before seeing the head that published it */
+    spsc_barrier();
+    item = q->slots[tail & q->mask];
+
+    /* And release the slot to the producer only once it has been read */
+    spsc_barrier();
+    q->tail = tail + 1;
+
+    return item;
+}
+
+int spsc_init(struct spsc_queue *q, void **slots, unsigned int nslots);
+void spsc_deinit(struct spsc_queue *q);
+struct spsc_queue *spsc_alloc(unsigned int nslots);
+void spsc_free(struct spsc_queue *q);
+int spsc_wait(struct spsc_queue *q);
+void spsc_kick(struct spsc_queue *q);
+
+#endif /* __INCLUDE_NUTTX_SPSC_H */
@@ -0,0 +1,167 @@
+/****************************************************************************
+ * include/nuttx/syslog/binlog.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/* The binary SYSLOG records a syslog()/lowsyslog() call as the address of
+ * its format string, a timestamp and the raw arguments instead of
+ * formatting it in the context of the caller.  The records are formatted
+ * later, either on the target from the low-priority work queue or on the
+ * host by tools/binlog_decode.py, which looks the format strings up in the
+ * ELF image.
+ *
+ * This logic is built when CONFIG_SYSLOG_BINARY is defined in the NuttX
+ * configuration.
+ */
+
+#ifndef __INCLUDE_NUTTX_SYSLOG_BINLOG_H
+#define __INCLUDE_NUTTX_SYSLOG_BINLOG_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdarg.h>
+
+#ifdef CONFIG_SYSLOG_BINARY
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_SYSLOG_BINARY_BUFSIZE
+#  define CONFIG_SYSLOG_BINARY_BUFSIZE 4096
+#endif
+
+#ifndef CONFIG_SYSLOG_BINARY_MAXSTR
+#  define CONFIG_SYSLOG_BINARY_MAXSTR 32
+#endif
+
+/* Header written by binlog_dump() in front of the raw records.  All fields
+ * are in target byte order; the magic lets the host decoder detect the
+ * byte order.
+ */
+
+#define BINLOG_DUMP_MAGIC    0x474c4e42 /* "BNLG" */
+#define BINLOG_DUMP_VERSION  1
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+/* One record in the log, followed by its arguments in 32-bit words:
+ *
+ *   - int, long, char and pointer arguments take one word,
+ *   - long long and double arguments take two words,
+ *   - %s arguments are copied (at most CONFIG_SYSLOG_BINARY_MAXSTR
+ *     characters), NUL terminated and padded to a whole word,
+ *   - '*' field widths and precisions take one word.
+ *
+ * The argument layout is implied by the format string.
+ */
+
+struct binlog_rec_s
+{
+  uint16_t nwords;      /* Size of the record in words, header included */
+  uint16_t reserved;
+  uint32_t time;        /* System timer ticks */
+  uint32_t fmt;         /* Address of the format string in the image */
+};
+
+struct binlog_dumphdr_s
+{
+  uint32_t magic;       /* BINLOG_DUMP_MAGIC */
+  uint8_t  version;     /* BINLOG_DUMP_VERSION */
+  uint8_t  reserved;
+  uint16_t maxstr;      /* CONFIG_SYSLOG_BINARY_MAXSTR */
+  uint32_t nwords;      /* Number of words of records following the header */
+  uint32_t lost;        /* Records dropped because the ring was full */
+  uint32_t tickhz;      /* Timestamp rate */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#ifdef __cplusplus
+#define EXTERN extern "C"
+extern "C"
+{
+#else
+#define EXTERN extern
+#endif
+
+/****************************************************************************
+ * Name: binlog_vrecord
+ *
+ * Description:
+ *   Record one log message.  The format string must stay valid for the
+ *   lifetime of the image (a string literal); the argument values are
+ *   copied.  Safe to call from interrupt handlers.
+ *
+ * Returned Value:
+ *   Zero on success; -ENOSPC if the ring was full and the record was
+ *   dropped.
+ *
+ ****************************************************************************/
+
+int binlog_vrecord(FAR const char *fmt, va_list ap);
+
+/****************************************************************************
+ * Name: binlog_dump
+ *
+ * Description:
+ *   Write all recorded messages to 'fd' in binary form and discard them.
+ *   The output is decoded on the host with tools/binlog_decode.py.  Not
+ *   available when the records are formatted on the target
+ *   (CONFIG_SYSLOG_BINARY_FORMAT).
+ *
+ * Returned Value:
+ *   The number of words written on success; a negated errno value on
+ *   failure.
+ *
+ ****************************************************************************/
+
+#ifndef CONFIG_SYSLOG_BINARY_FORMAT
+int binlog_dump(int fd);
+#endif
+
+#undef EXTERN
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CONFIG_SYSLOG_BINARY */
+#endif /* __INCLUDE_NUTTX_SYSLOG_BINLOG_H */
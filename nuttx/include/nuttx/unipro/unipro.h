@@ -49,6 +49,26 @@ enum unipro_event {
     UNIPRO_EVT_T_ERROR,
     UNIPRO_EVT_PAINIT_ERROR,
     UNIPRO_EVT_MAILBOX,
+    UNIPRO_EVT_LINK_DEGRADED,   /* error rate above threshold, see
+                                   CONFIG_UNIPRO_LINK_STATS */
+};
+
+/*
+ * TX traffic classes, used by the TX scheduler to pick a DMA channel and to
+ * share the link between CPorts. CPorts are interactive by default.
+ */
+enum unipro_tx_class {
+    UNIPRO_TX_CLASS_INTERACTIVE,
+    UNIPRO_TX_CLASS_ISOCHRONOUS,
+    UNIPRO_TX_CLASS_BULK,
+    UNIPRO_TX_CLASS_COUNT,
+};
+
+struct unipro_tx_class_stats {
+    uint64_t bytes;             /* payload bytes sent */
+    uint32_t messages;          /* messages sent */
+    uint32_t max_latency_us;    /* worst queue-to-completion time */
+    uint64_t total_latency_us;  /* sum of queue-to-completion times */
 };
 
 typedef int (*unipro_send_completion_t)(int status, const void *buf,
@@ -72,13 +92,22 @@ void unipro_info(void);
 int unipro_send(unsigned int cportid, const void *buf, size_t len);
 int unipro_send_async(unsigned int cportid, const void *buf, size_t len,
                       unipro_send_completion_t callback, void *priv);
+int unipro_send_batch(unsigned int cportid, const void * const bufs[],
+                      const size_t lens[], size_t count);
+int unipro_sendv(unsigned int cportid, const void * const bufs[],
+                 const size_t lens[], size_t count);
 int unipro_reset_cport(unsigned int cportid, cport_reset_completion_cb_t cb,
                        void *priv);
+int unipro_set_tx_class(unsigned int cportid, enum unipro_tx_class tx_class);
+int unipro_get_tx_class_stats(enum unipro_tx_class tx_class,
+                              struct unipro_tx_class_stats *stats);
 
 int unipro_set_max_inflight_rxbuf_count(unsigned int cportid,
                                         size_t max_inflight_buf);
 void *unipro_rxbuf_alloc(unsigned int cportid);
 void unipro_rxbuf_free(unsigned int cportid, void *ptr);
+int unipro_rx_pause(unsigned int cportid);
+int unipro_rx_resume(unsigned int cportid);
 
 /*
  * UniPro attributes
@@ -261,12 +261,16 @@
  *   Argument: int.  This includes the current state of the carrier detect,
  *   DSR, break, and ring signal.  See "Table 69: UART State Bitmap Values"
  *   and CDC_UART_definitions in include/nuttx/usb/cdc.h.
+ * CAIOC_GETSTATS
+ *   Get the transfer statistics (CONFIG_CDCACM_STATS only).  Argument:
+ *   struct cdcacm_stats_s*.  See the structure definition below.
  */
 
 #define CAIOC_REGISTERCB    _CAIOC(0x0001)
 #define CAIOC_GETLINECODING _CAIOC(0x0002)
 #define CAIOC_GETCTRLLINE   _CAIOC(0x0003)
 #define CAIOC_NOTIFY        _CAIOC(0x0004)
+#define CAIOC_GETSTATS      _CAIOC(0x0005)
 
 /****************************************************************************
  * Public Types
@@ -299,6 +303,18 @@ enum cdcacm_event_e
   CDCACM_EVENT_SENDBREAK       /* Send break request received */
 };
 
+/* Transfer statistics returned by CAIOC_GETSTATS */
+
+struct cdcacm_stats_s
+{
+  uint32_t txreqs;             /* Number of bulk IN requests submitted */
+  uint32_t txbytes;            /* Number of bytes sent to the host */
+  uint32_t txdeferred;         /* Number of short writes held for coalescing */
+  uint32_t rxreqs;             /* Number of bulk OUT requests received */
+  uint32_t rxbytes;            /* Number of bytes received from the host */
+  uint32_t rxoverruns;         /* Number of packets that overran the RX buffer */
+};
+
 typedef FAR void (*cdcacm_callback_t)(enum cdcacm_event_e event);
 
 /****************************************************************************
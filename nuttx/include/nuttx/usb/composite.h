@@ -42,6 +42,10 @@
 
 #include <nuttx/config.h>
 
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+
 #ifdef CONFIG_USBDEV_COMPOSITE
 
 /****************************************************************************
@@ -68,12 +72,37 @@
  *   Configuration string
  * CONFIG_COMPOSITE_VERSIONNO
  *   Interface version number.
+ * CONFIG_COMPOSITE_ARBITER and CONFIG_COMPOSITE_ARBITER_NREQS
+ *   Limit lower priority members to CONFIG_COMPOSITE_ARBITER_NREQS bulk IN
+ *   requests in flight while a higher priority member is busy
+ * CONFIG_COMPOSITE_STATS
+ *   Keep per-member transfer statistics
  */
 
+/* Members of the composite, in the order of their interfaces */
+
+#define COMPOSITE_FUNC_DEV1  0
+#define COMPOSITE_FUNC_DEV2  1
+#define COMPOSITE_NFUNCS     2
+
 /****************************************************************************
  * Public Types
  ****************************************************************************/
 
+/* Per-member statistics returned by composite_getstats() */
+
+#ifdef CONFIG_COMPOSITE_STATS
+struct composite_stats_s
+{
+  uint32_t txreqs;             /* Bulk IN requests completed */
+  uint32_t txbytes;            /* Bytes sent on bulk IN requests */
+  uint32_t rxreqs;             /* Bulk OUT requests completed */
+  uint32_t rxbytes;            /* Bytes received on bulk OUT requests */
+  uint32_t yields;             /* Times the arbiter made the member wait */
+  uint8_t  txmax;              /* Most bulk IN requests seen in flight */
+};
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -177,6 +206,71 @@ EXTERN int composite_ep0submit(FAR struct usbdevclass_driver_s *driver,
                                FAR struct usbdev_s *dev,
                                FAR struct usbdev_req_s *ctrlreq);
 
+/****************************************************************************
+ * Name: composite_txstart, composite_txdone
+ *
+ * Description:
+ *   Members of the composite call composite_txstart() just before they
+ *   submit a bulk IN request and composite_txdone() when the request
+ *   completes (or could not be submitted).  'func' is the position of the
+ *   member in the composite (COMPOSITE_FUNC_DEV1 or COMPOSITE_FUNC_DEV2).
+ *   May be called from an interrupt handler.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_COMPOSITE_ARBITER) || defined(CONFIG_COMPOSITE_STATS)
+EXTERN void composite_txstart(int func);
+EXTERN void composite_txdone(int func, size_t nbytes);
+#else
+#  define composite_txstart(func)
+#  define composite_txdone(func, nbytes)
+#endif
+
+/****************************************************************************
+ * Name: composite_rxdone
+ *
+ * Description:
+ *   Members of the composite call this when a bulk OUT request completes.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_COMPOSITE_STATS
+EXTERN void composite_rxdone(int func, size_t nbytes);
+#else
+#  define composite_rxdone(func, nbytes)
+#endif
+
+/****************************************************************************
+ * Name: composite_mayxfer
+ *
+ * Description:
+ *   Return true if the member 'func' may submit another bulk IN request
+ *   now.  This is false only if the member already has
+ *   CONFIG_COMPOSITE_ARBITER_NREQS requests in flight and a member with a
+ *   higher priority is busy.  The member then tries again when one of its
+ *   own requests completes, so it never waits forever.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_COMPOSITE_ARBITER
+EXTERN bool composite_mayxfer(int func);
+#else
+#  define composite_mayxfer(func) (true)
+#endif
+
+/****************************************************************************
+ * Name: composite_getstats
+ *
+ * Description:
+ *   Return the statistics of the member 'func'.  Returns -ENODEV if the
+ *   composite is not initialized and -EINVAL if 'func' is not valid.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_COMPOSITE_STATS
+EXTERN int composite_getstats(int func, FAR struct composite_stats_s *stats);
+#endif
+
 #undef EXTERN
 #if defined(__cplusplus)
 }
@@ -404,6 +404,31 @@ struct usbtrace_s
 {
   uint16_t event;
   uint16_t value;
+#ifdef CONFIG_USBDEV_TRACE_TIMESTAMP
+  uint32_t time;        /* CPU cycles or system ticks, see usbtrace_dump() */
+#endif
+};
+
+/* Header written by usbtrace_dump() in front of the raw trace records.  All
+ * fields are in target byte order; the magic lets the host decoder detect
+ * the byte order.  The records follow as an array of struct usbtrace_s.
+ */
+
+#define USBTRACE_DUMP_MAGIC       0x43525455 /* "UTRC" */
+#define USBTRACE_DUMP_VERSION     1
+
+#define USBTRACE_DUMP_FLAG_TIME   (1 << 0)   /* Records carry a timestamp */
+#define USBTRACE_DUMP_FLAG_CYCLES (1 << 1)   /* Timestamp is in CPU cycles */
+
+struct usbtrace_dumphdr_s
+{
+  uint32_t magic;       /* USBTRACE_DUMP_MAGIC */
+  uint8_t  version;     /* USBTRACE_DUMP_VERSION */
+  uint8_t  flags;       /* USBTRACE_DUMP_FLAG_* */
+  uint16_t recsize;     /* sizeof(struct usbtrace_s) */
+  uint32_t nrecords;    /* Number of records following the header */
+  uint32_t lost;        /* Records overwritten since the previous dump */
+  uint32_t tickhz;      /* Timestamp rate for ticks, 0 if in CPU cycles */
 };
 
 /* Describes on element of a string string for decoding of device-specific
@@ -520,6 +545,31 @@ int usbtrace_enumerate(trace_callback_t callback, void *arg);
 #  define usbtrace_enumerate(callback, arg)
 #endif
 
+/*******************************************************************************
+ * Name: usbtrace_dump
+ *
+ * Description:
+ *   Write all buffered trace data to 'fd' in binary form: one struct
+ *   usbtrace_dumphdr_s followed by the raw records, oldest first.  The data
+ *   is discarded once written.  Nothing is decoded on the target, so this is
+ *   cheap enough to run while the bus is busy; decode the output on the host
+ *   with tools/usbtrace_decode.py.  Tracing is temporarily disabled.
+ *
+ * Returned Value:
+ *   The number of records written on success; a negated errno value on
+ *   failure.
+ *
+ * Assumptions:
+ *   NEVER called from an interrupt handler
+ *
+ *******************************************************************************/
+
+#ifdef CONFIG_USBDEV_TRACE
+int usbtrace_dump(int fd);
+#else
+#  define usbtrace_dump(fd) (-ENOSYS)
+#endif
+
 /*******************************************************************************
  * Name: usbtrace_trprint
  *
@@ -497,6 +497,74 @@
 
 #define DRVR_TRANSFER(drvr,ed,buffer,buflen) ((drvr)->transfer(drvr,ed,buffer,buflen))
 
+/************************************************************************************
+ * Name: DRVR_ASYNCH
+ *
+ * Description:
+ *   Process a request to handle a transfer descriptor.  This method will
+ *   enqueue the transfer request and return immediately.  When the transfer
+ *   completes, the callback will be invoked with the provided argument.  Only
+ *   one transfer may be queued on an endpoint at a time.
+ *
+ *   If the device NAKs a transfer on an interrupt or isochronous endpoint, the
+ *   transfer is retried at the polling interval of the endpoint until it
+ *   completes or is cancelled.
+ *
+ *   This method is only available if CONFIG_USBHOST_ASYNCH is selected.
+ *
+ * Input Parameters:
+ *   drvr - The USB host driver instance obtained as a parameter from the call to
+ *      the class create() method.
+ *   ed - The IN or OUT endpoint descriptor for the device endpoint on which to
+ *      perform the transfer.
+ *   buffer - A buffer containing the data to be sent (OUT endpoint) or received
+ *     (IN endpoint).  buffer must have been allocated using DRVR_ALLOC
+ *   buflen - The length of the data to be sent or received.
+ *   callback - This function will be called when the transfer completes.  It
+ *     receives the number of bytes transferred or, on a failure, a negated
+ *     errno value as listed for DRVR_TRANSFER.
+ *   arg - The arbitrary parameter that will be passed to the callback function
+ *     when the transfer completes.
+ *
+ * Returned Values:
+ *   On success, zero (OK) is returned. On a failure, a negated errno value is
+ *   returned indicating the nature of the failure.  EBUSY is returned if a
+ *   transfer is already queued on the endpoint.
+ *
+ * Assumptions:
+ *   This function will *not* be called from an interrupt handler.  The callback
+ *   will probably be called from the USB interrupt handler.
+ *
+ ************************************************************************************/
+
+#ifdef CONFIG_USBHOST_ASYNCH
+#  define DRVR_ASYNCH(drvr,ed,buffer,buflen,callback,arg) \
+     ((drvr)->asynch(drvr,ed,buffer,buflen,callback,arg))
+#endif
+
+/************************************************************************************
+ * Name: DRVR_CANCEL
+ *
+ * Description:
+ *   Cancel a pending transfer on an endpoint.  The callback of a cancelled
+ *   asynchronous transfer is called with -ESHUTDOWN.
+ *
+ * Input Parameters:
+ *   drvr - The USB host driver instance obtained as a parameter from the call to
+ *      the class create() method.
+ *   ed - The IN or OUT endpoint descriptor for the device endpoint on which an
+ *      asynchronous transfer should be cancelled.
+ *
+ * Returned Values:
+ *   On success, zero (OK) is returned. On a failure, a negated errno value is
+ *   returned indicating the nature of the failure.
+ *
+ ************************************************************************************/
+
+#ifdef CONFIG_USBHOST_ASYNCH
+#  define DRVR_CANCEL(drvr,ed) ((drvr)->cancel(drvr,ed))
+#endif
+
 /************************************************************************************
  * Name: DRVR_DISCONNECT
  *
@@ -622,6 +690,14 @@ struct usbhost_devinfo_s
 
 typedef FAR void *usbhost_ep_t;
 
+/* The callback function invoked when an asynchronous transfer completes.
+ * nbytes is the number of bytes transferred or a negated errno value.
+ */
+
+#ifdef CONFIG_USBHOST_ASYNCH
+typedef CODE void (*usbhost_asynch_t)(FAR void *arg, ssize_t nbytes);
+#endif
+
 /* struct usbhost_connection_s provides as interface between platform-specific
  * connection monitoring and the USB host driver connectin and enumeration
  * logic.
@@ -728,6 +804,21 @@ struct usbhost_driver_s
   int (*transfer)(FAR struct usbhost_driver_s *drvr, usbhost_ep_t ep,
                   FAR uint8_t *buffer, size_t buflen);
 
+#ifdef CONFIG_USBHOST_ASYNCH
+  /* Process a request to handle a transfer asynchronously.  This method will
+   * enqueue the transfer request and return immediately.  The callback is
+   * invoked when the transfer completes.
+   */
+
+  int (*asynch)(FAR struct usbhost_driver_s *drvr, usbhost_ep_t ep,
+                FAR uint8_t *buffer, size_t buflen,
+                usbhost_asynch_t callback, FAR void *arg);
+
+  /* Cancel any pending asynchronous transfer on an endpoint */
+
+  int (*cancel)(FAR struct usbhost_driver_s *drvr, usbhost_ep_t ep);
+#endif
+
   /* Called by the class when an error occurs and driver has been disconnected.
    * The USB host driver should discard the handle to the class instance (it is
    * stale) and not attempt any further interaction with the class driver instance
@@ -289,6 +289,21 @@ struct fb_setcursor_s
 };
 #endif
 
+/* If the video controller has a 2D blitter (DMA2D-class or a memory-to-
+ * memory DMA engine), the following structure describes the destination
+ * area of an accelerated fill or copy.
+ */
+
+#ifdef CONFIG_FB_HWACCEL
+struct fb_area_s
+{
+  fb_coord_t x;             /* X position of the upper-left pixel */
+  fb_coord_t y;             /* Y position of the upper-left row */
+  fb_coord_t w;             /* Width in pixels */
+  fb_coord_t h;             /* Height in rows */
+};
+#endif
+
 /* The framebuffer "driver" under NuttX is not a driver at all, but simply
  * a driver "object" that is accessed through the following vtable:
  */
@@ -314,6 +329,20 @@ struct fb_vtable_s
   int (*getcursor)(FAR struct fb_vtable_s *vtable, FAR struct fb_cursorattrib_s *attrib);
   int (*setcursor)(FAR struct fb_vtable_s *vtable, FAR struct fb_setcursor_s *settings);
 #endif
+
+  /* The following are provided only if the video hardware has a 2D blitter.
+   * Either may be NULL.  The operation must be complete (or ordered before
+   * any later CPU access to the frame buffer) on return.  A negative errno
+   * value asks the caller to fall back to the software rasterizer.
+   */
+
+#ifdef CONFIG_FB_HWACCEL
+  int (*fillrect)(FAR struct fb_vtable_s *vtable, int planeno,
+                  FAR const struct fb_area_s *area, uint32_t color);
+  int (*copyrect)(FAR struct fb_vtable_s *vtable, int planeno,
+                  FAR const struct fb_area_s *area, FAR const void *src,
+                  fb_coord_t srcstride);
+#endif
 };
 
 /****************************************************************************
@@ -139,6 +139,10 @@ struct wdog_s
   uint8_t            flags;      /* See WDOGF_* definitions above */
   uint8_t            argc;       /* The number of parameters to pass */
   uint32_t           parm[CONFIG_MAX_WDOGPARMS];
+#ifdef CONFIG_WDOG_PAIRING_HEAP
+  FAR struct wdog_s *child;      /* First child in the timer heap */
+  FAR struct wdog_s *prev;       /* Parent or previous sibling in the heap */
+#endif
 };
 
 /* Watchdog 'handle' */
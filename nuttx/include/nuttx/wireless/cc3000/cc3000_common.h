@@ -44,6 +44,7 @@
 
 #include <sys/time.h>
 #include <stdlib.h>
+#include <semaphore.h>
 #include <errno.h>
 
 /*****************************************************************************
@@ -261,6 +262,10 @@ extern "C"
 
 extern volatile sSimplLinkInformation tSLInformation;
 
+/* Posted by the flow control event when the CC3000 returns free buffers */
+
+extern sem_t g_cc3000_freebufsem;
+
 /*****************************************************************************
  * Public Function Prototypes
  *****************************************************************************/
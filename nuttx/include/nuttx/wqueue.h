@@ -85,6 +85,14 @@
  *  checks for work in units of microseconds.  Default: 50*1000 (50 MS).
  * CONFIG_SCHED_LPWORKSTACKSIZE - The stack size allocated for the lower
  *   priority worker thread.  Default: CONFIG_IDLETHREAD_STACKSIZE.
+ * CONFIG_SCHED_NXWORK - The number of additional kernel work queues that
+ *   may be created at run time with work_qcreate(), each with its own
+ *   worker thread and priority.  Default: 0
+ * CONFIG_SCHED_WORKQUEUE_DEADLINE - Allow work queues created with
+ *   WQUEUE_FLAG_DEADLINE to run ready work earliest deadline first rather
+ *   than in FIFO order.  See work_queue_deadline().
+ * CONFIG_SCHED_WORKQUEUE_STATS - Keep per-queue depth and latency
+ *   statistics.  See work_getstats().
  */
 
 /* Is this a protected build (CONFIG_BUILD_PROTECTED=y) */
@@ -143,6 +151,18 @@
 #  undef CONFIG_SCHED_LPWORK
 #endif
 
+/* Additional kernel work queues are only available with the high priority
+ * work queue.
+ */
+
+#ifndef CONFIG_SCHED_HPWORK
+#  undef CONFIG_SCHED_NXWORK
+#endif
+
+#ifndef CONFIG_SCHED_NXWORK
+#  define CONFIG_SCHED_NXWORK 0
+#endif
+
 #ifdef CONFIG_SCHED_WORKQUEUE
 
 /* We are building work queues... Work queues need signal support */
@@ -253,9 +273,20 @@
 #  define HPWORK 0
 #  ifdef CONFIG_SCHED_LPWORK
 #    define LPWORK (HPWORK+1)
-#    define NWORKERS 2
+#    define NSWORKERS 2
 #  else
-#    define NWORKERS 1
+#    define NSWORKERS 1
+#  endif
+
+  /* XWORK:  The ID of the first of the CONFIG_SCHED_NXWORK queues that are
+   *   created at run time by work_qcreate().
+   */
+
+#  if CONFIG_SCHED_NXWORK > 0
+#    define XWORK NSWORKERS
+#    define NWORKERS (NSWORKERS + CONFIG_SCHED_NXWORK)
+#  else
+#    define NWORKERS NSWORKERS
 #  endif
 
 #  if !defined(CONFIG_BUILD_PROTECTED) && !defined(CONFIG_BUILD_KERNEL)
@@ -275,10 +306,33 @@
  * accessed by application logic.
  */
 
+/* Work queue flags (see work_qcreate()) */
+
+#define WQUEUE_FLAG_DEADLINE (1 << 0) /* Run ready work by earliest deadline */
+
+/* Statistics for one work queue.  All times are in clock ticks. */
+
+struct work_stats_s
+{
+  uint32_t nqueued;      /* Number of times work was queued */
+  uint32_t nrun;         /* Number of work items performed */
+  uint16_t depth;        /* Number of work items now in the queue */
+  uint16_t maxdepth;     /* Largest value of depth */
+  uint32_t maxlatency;   /* Longest wait beyond the requested delay */
+  uint32_t totlatency;   /* Sum of all waits beyond the requested delay */
+  uint32_t maxruntime;   /* Longest time spent in a worker callback */
+};
+
 struct wqueue_s
 {
-  pid_t             pid; /* The task ID of the worker thread */
-  struct dq_queue_s q;   /* The queue of pending work */
+  pid_t             pid;   /* The task ID of the worker thread */
+  struct dq_queue_s q;     /* The queue of pending work */
+#ifdef CONFIG_SCHED_WORKQUEUE_DEADLINE
+  uint8_t           flags; /* See WQUEUE_FLAG_* definitions */
+#endif
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+  struct work_stats_s stats;
+#endif
 };
 
 /* Defines the work callback */
@@ -297,6 +351,9 @@ struct work_s
   FAR void *arg;         /* Callback argument */
   uint32_t  qtime;       /* Time work queued */
   uint32_t  delay;       /* Delay until work performed */
+#ifdef CONFIG_SCHED_WORKQUEUE_DEADLINE
+  uint32_t  deadline;    /* Time by which the work should be performed */
+#endif
 };
 
 /****************************************************************************
@@ -342,7 +399,7 @@ EXTERN struct wqueue_s g_work[NWORKERS];
  ****************************************************************************/
 
 /****************************************************************************
- * Name: work_hpthread, work_lpthread, and work_usrthread
+ * Name: work_hpthread, work_lpthread, work_xthread, and work_usrthread
  *
  * Description:
  *   These are the worker threads that performs actions placed on the work
@@ -355,6 +412,9 @@ EXTERN struct wqueue_s g_work[NWORKERS];
  *
  *     These worker threads are started by the OS during normal bringup.
  *
+ *   work_xthread:  This is the worker thread of a kernel work queue created
+ *     at run time by work_qcreate().
+ *
  *   work_usrthread:  This is a user mode work queue.  It must be started
  *     by application code by calling work_usrstart().
  *
@@ -381,6 +441,10 @@ int work_lpthread(int argc, char *argv[]);
 int work_usrthread(int argc, char *argv[]);
 #endif
 
+#if CONFIG_SCHED_NXWORK > 0
+int work_xthread(int argc, char *argv[]);
+#endif
+
 /****************************************************************************
  * Name: work_usrstart
  *
@@ -400,6 +464,32 @@ int work_usrthread(int argc, char *argv[]);
 int work_usrstart(void);
 #endif
 
+/****************************************************************************
+ * Name: work_qcreate
+ *
+ * Description:
+ *   Create an additional kernel work queue with its own worker thread.
+ *   This lets a subsystem keep slow work (e.g., flash writes) from delaying
+ *   the time-critical work on HPWORK or LPWORK.
+ *
+ * Input parameters:
+ *   name      - Name of the worker thread
+ *   priority  - Priority of the worker thread
+ *   stacksize - Stack size of the worker thread
+ *   flags     - Zero or WQUEUE_FLAG_DEADLINE
+ *
+ * Returned Value:
+ *   The ID of the new work queue (XWORK or greater) on success, a negated
+ *   errno on failure.  -ENOSPC means that all CONFIG_SCHED_NXWORK queues
+ *   are in use.
+ *
+ ****************************************************************************/
+
+#if CONFIG_SCHED_NXWORK > 0
+int work_qcreate(FAR const char *name, int priority, int stacksize,
+                 uint8_t flags);
+#endif
+
 /****************************************************************************
  * Name: work_queue
  *
@@ -432,6 +522,39 @@ int work_usrstart(void);
 int work_queue(int qid, FAR struct work_s *work, worker_t worker,
                FAR void *arg, uint32_t delay);
 
+/****************************************************************************
+ * Name: work_queue_deadline
+ *
+ * Description:
+ *   Like work_queue() but also gives the time by which the work should be
+ *   performed.  On a work queue created with WQUEUE_FLAG_DEADLINE, the
+ *   ready work with the earliest deadline is performed first.  Work queued
+ *   with work_queue() has a deadline equal to its delay.  On other queues
+ *   the deadline is ignored and work is performed in FIFO order.
+ *
+ * Input parameters:
+ *   qid      - The work queue ID
+ *   work     - The work structure to queue
+ *   worker   - The worker callback to be invoked
+ *   arg      - The argument that will be passed to the worker callback
+ *   delay    - Delay (in clock ticks) from the time queued until the worker
+ *              may be invoked.
+ *   deadline - Time (in clock ticks) from the time queued by which the
+ *              worker should have been invoked.
+ *
+ * Returned Value:
+ *   Zero on success, a negated errno on failure
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKQUEUE_DEADLINE
+int work_queue_deadline(int qid, FAR struct work_s *work, worker_t worker,
+                        FAR void *arg, uint32_t delay, uint32_t deadline);
+#else
+#  define work_queue_deadline(qid, work, worker, arg, delay, deadline) \
+     work_queue(qid, work, worker, arg, delay)
+#endif
+
 /****************************************************************************
  * Name: work_cancel
  *
@@ -469,6 +592,25 @@ int work_cancel(int qid, FAR struct work_s *work);
 
 int work_signal(int qid);
 
+/****************************************************************************
+ * Name: work_getstats
+ *
+ * Description:
+ *   Return a snapshot of the statistics of one work queue.
+ *
+ * Input parameters:
+ *   qid    - The work queue ID
+ *   stats  - Location to return the statistics
+ *
+ * Returned Value:
+ *   Zero on success, -ENOENT if no such queue is running.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+int work_getstats(int qid, FAR struct work_stats_s *stats);
+#endif
+
 /****************************************************************************
  * Name: work_available
  *
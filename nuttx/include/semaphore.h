@@ -94,6 +94,7 @@ struct sem_s
 #ifdef CONFIG_PRIORITY_INHERITANCE
 # if CONFIG_SEM_PREALLOCHOLDERS > 0
   FAR struct semholder_s *hhead; /* List of holders of semaphore counts */
+  FAR struct tcb_s *fholder;     /* Uncontended holder of a single count */
 # else
   struct semholder_s holder;     /* Single holder */
 # endif
@@ -106,7 +107,7 @@ typedef struct sem_s sem_t;
 
 #ifdef CONFIG_PRIORITY_INHERITANCE
 # if CONFIG_SEM_PREALLOCHOLDERS > 0
-#  define SEM_INITIALIZER(c) {(c), NULL}  /* semcount, hhead */
+#  define SEM_INITIALIZER(c) {(c), NULL, NULL}  /* semcount, hhead, fholder */
 # else
 #  define SEM_INITIALIZER(c) {(c), SEMHOLDER_INITIALIZER} /* semcount, holder */
 # endif
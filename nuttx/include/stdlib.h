@@ -174,6 +174,7 @@ FAR void *realloc(FAR void*, size_t);
 FAR void *memalign(size_t, size_t);
 FAR void *zalloc(size_t);
 FAR void *calloc(size_t, size_t);
+size_t    malloc_usable_size(FAR void *);
 
 /* Misc */
 
@@ -0,0 +1,120 @@
+/****************************************************************************
+ * include/sys/epoll.h
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#ifndef __INCLUDE_SYS_EPOLL_H
+#define __INCLUDE_SYS_EPOLL_H
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <poll.h>
+
+#if CONFIG_NFILE_DESCRIPTORS > 0 && !defined(CONFIG_DISABLE_POLL)
+
+/****************************************************************************
+ * Pre-Processor Definitions
+ ****************************************************************************/
+
+/* epoll_ctl() operations */
+
+#define EPOLL_CTL_ADD 1  /* Add a descriptor to the interest set */
+#define EPOLL_CTL_DEL 2  /* Remove a descriptor from the interest set */
+#define EPOLL_CTL_MOD 3  /* Change the events of a descriptor in the set */
+
+/* Event flags.  These are the poll() events, NuttX does not make priority
+ * distinctions.
+ */
+
+#define EPOLLIN       POLLIN
+#define EPOLLPRI      POLLPRI
+#define EPOLLOUT      POLLOUT
+#define EPOLLRDNORM   POLLRDNORM
+#define EPOLLRDBAND   POLLRDBAND
+#define EPOLLWRNORM   POLLWRNORM
+#define EPOLLWRBAND   POLLWRBAND
+#define EPOLLERR      POLLERR
+#define EPOLLHUP      POLLHUP
+
+/****************************************************************************
+ * Public Types
+ ****************************************************************************/
+
+typedef union epoll_data
+{
+  FAR void *ptr;
+  int       fd;
+  uint32_t  u32;
+} epoll_data_t;
+
+struct epoll_event
+{
+  uint32_t     events;     /* Requested or returned events */
+  epoll_data_t data;       /* Returned unmodified with the events */
+};
+
+/****************************************************************************
+ * Public Function Prototypes
+ ****************************************************************************/
+
+#undef EXTERN
+#if defined(__cplusplus)
+#define EXTERN extern "C"
+extern "C" {
+#else
+#define EXTERN extern
+#endif
+
+/* epoll_create() returns a handle, not a file descriptor: it must be
+ * released with epoll_close() and cannot be passed to close(), poll() or
+ * select().  A descriptor must be removed with EPOLL_CTL_DEL before it is
+ * closed.
+ */
+
+EXTERN int epoll_create(int size);
+EXTERN int epoll_ctl(int epfd, int op, int fd, FAR struct epoll_event *ev);
+EXTERN int epoll_wait(int epfd, FAR struct epoll_event *evs, int maxevents,
+                      int timeout);
+EXTERN void epoll_close(int epfd);
+
+#undef EXTERN
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* CONFIG_NFILE_DESCRIPTORS > 0 && !CONFIG_DISABLE_POLL */
+#endif /* __INCLUDE_SYS_EPOLL_H */
@@ -90,6 +90,14 @@
 #  define CLOCK_MONOTONIC  1
 #endif
 
+/* Monotonic time read directly from the high resolution clock source, see
+ * include/nuttx/clocksource.h.
+ */
+
+#ifdef CONFIG_CLOCKSOURCE
+#  define CLOCK_MONOTONIC_RAW 4
+#endif
+
 /* This is a flag that may be passed to the timer_settime() function */
 
 #define TIMER_ABSTIME      1
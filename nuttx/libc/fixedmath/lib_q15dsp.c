@@ -0,0 +1,480 @@
+/****************************************************************************
+ * libc/fixedmath/lib_q15dsp.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <errno.h>
+#include <fixedmath.h>
+
+#ifdef CONFIG_HAVE_LONG_LONG
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define Q15_MAX        32767
+#define Q15_MIN        (-32768)
+#define B16_INVPI      0x0000517d  /* 1 / pi = 0.318313599 */
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: q15_read2 and q15_write2
+ *
+ * Description:
+ *   Load or store two adjacent samples as one word, the first one in the
+ *   low half.  ARMv7-M allows unaligned word accesses, so the compiler
+ *   turns the memcpy() into a single LDR or STR.
+ *
+ ****************************************************************************/
+
+static inline uint32_t q15_read2(FAR const q15_t *p)
+{
+  uint32_t v;
+
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline void q15_write2(FAR q15_t *p, uint32_t v)
+{
+  memcpy(p, &v, sizeof(v));
+}
+
+/****************************************************************************
+ * Name: q15_sat
+ *
+ * Description:
+ *   Saturate a 32-bit value to the Q15 range.
+ *
+ ****************************************************************************/
+
+static inline q15_t q15_sat(int32_t value)
+{
+#ifdef __ARM_FEATURE_DSP
+  int32_t result;
+
+  __asm__ ("ssat %0, #16, %1" : "=r" (result) : "r" (value));
+  return (q15_t)result;
+#else
+  if (value > Q15_MAX)
+    {
+      return Q15_MAX;
+    }
+  else if (value < Q15_MIN)
+    {
+      return Q15_MIN;
+    }
+
+  return (q15_t)value;
+#endif
+}
+
+/****************************************************************************
+ * Name: q15_sat64
+ *
+ * Description:
+ *   Saturate a 64-bit value to the Q15 range.
+ *
+ ****************************************************************************/
+
+static inline q15_t q15_sat64(int64_t value)
+{
+  if (value > Q15_MAX)
+    {
+      return Q15_MAX;
+    }
+  else if (value < Q15_MIN)
+    {
+      return Q15_MIN;
+    }
+
+  return (q15_t)value;
+}
+
+/****************************************************************************
+ * Name: q15_smlald
+ *
+ * Description:
+ *   Dual 16-bit signed multiply with a 64-bit accumulate:
+ *   acc + x.lo * y.lo + x.hi * y.hi.
+ *
+ ****************************************************************************/
+
+static inline int64_t q15_smlald(uint32_t x, uint32_t y, int64_t acc)
+{
+#ifdef __ARM_FEATURE_DSP
+  __asm__ ("smlald %Q0, %R0, %1, %2" : "+r" (acc) : "r" (x), "r" (y));
+  return acc;
+#else
+  return acc + (int32_t)(int16_t)x * (int16_t)y +
+         (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+#endif
+}
+
+/****************************************************************************
+ * Name: q15_qadd16
+ *
+ * Description:
+ *   Dual 16-bit saturating addition.
+ *
+ ****************************************************************************/
+
+static inline uint32_t q15_qadd16(uint32_t x, uint32_t y)
+{
+#ifdef __ARM_FEATURE_DSP
+  uint32_t result;
+
+  __asm__ ("qadd16 %0, %1, %2" : "=r" (result) : "r" (x), "r" (y));
+  return result;
+#else
+  uint16_t lo = q15_sat((int16_t)x + (int16_t)y);
+  uint16_t hi = q15_sat((int16_t)(x >> 16) + (int16_t)(y >> 16));
+
+  return (uint32_t)hi << 16 | lo;
+#endif
+}
+
+/****************************************************************************
+ * Name: q15_dotn
+ *
+ * Description:
+ *   Q30 sum of products of two arrays, two samples per step.
+ *
+ ****************************************************************************/
+
+static inline int64_t q15_dotn(FAR const q15_t *a, FAR const q15_t *b,
+                               size_t n)
+{
+  int64_t acc = 0;
+
+  for (; n >= 4; n -= 4, a += 4, b += 4)
+    {
+      acc = q15_smlald(q15_read2(a), q15_read2(b), acc);
+      acc = q15_smlald(q15_read2(a + 2), q15_read2(b + 2), acc);
+    }
+
+  for (; n >= 2; n -= 2, a += 2, b += 2)
+    {
+      acc = q15_smlald(q15_read2(a), q15_read2(b), acc);
+    }
+
+  if (n > 0)
+    {
+      acc += (int32_t)*a * *b;
+    }
+
+  return acc;
+}
+
+/****************************************************************************
+ * Name: q15_isqrt
+ *
+ * Description:
+ *   Integer square root, rounded down.
+ *
+ ****************************************************************************/
+
+static uint32_t q15_isqrt(uint32_t x)
+{
+  uint32_t result = 0;
+  uint32_t bit = (uint32_t)1 << 30;
+
+  while (bit > x)
+    {
+      bit >>= 2;
+    }
+
+  while (bit != 0)
+    {
+      if (x >= result + bit)
+        {
+          x      -= result + bit;
+          result  = (result >> 1) + bit;
+        }
+      else
+        {
+          result >>= 1;
+        }
+
+      bit >>= 2;
+    }
+
+  return result;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: q15_dot
+ *
+ * Description:
+ *   Dot product of two Q15 arrays.  The result is in Q30 with the 64-bit
+ *   dynamic range of the accumulator.
+ *
+ ****************************************************************************/
+
+int64_t q15_dot(FAR const q15_t *a, FAR const q15_t *b, size_t n)
+{
+  return q15_dotn(a, b, n);
+}
+
+/****************************************************************************
+ * Name: q15_scale
+ *
+ * Description:
+ *   Multiply every sample of 'src' by 'scale':  dst[i] = src[i] * scale.
+ *   'src' and 'dst' may be the same array.
+ *
+ ****************************************************************************/
+
+void q15_scale(FAR const q15_t *src, q15_t scale, FAR q15_t *dst, size_t n)
+{
+  while (n-- > 0)
+    {
+      *dst++ = q15_sat(((int32_t)*src++ * scale) >> 15);
+    }
+}
+
+/****************************************************************************
+ * Name: q15_add
+ *
+ * Description:
+ *   Saturating addition of two arrays:  dst[i] = a[i] + b[i].  'dst' may
+ *   be one of the sources.
+ *
+ ****************************************************************************/
+
+void q15_add(FAR const q15_t *a, FAR const q15_t *b, FAR q15_t *dst,
+             size_t n)
+{
+  for (; n >= 2; n -= 2, a += 2, b += 2, dst += 2)
+    {
+      q15_write2(dst, q15_qadd16(q15_read2(a), q15_read2(b)));
+    }
+
+  if (n > 0)
+    {
+      *dst = q15_sat((int32_t)*a + *b);
+    }
+}
+
+/****************************************************************************
+ * Name: q15_sqrt
+ *
+ * Description:
+ *   Square root of every sample.  Negative samples give 0.
+ *
+ ****************************************************************************/
+
+void q15_sqrt(FAR const q15_t *src, FAR q15_t *dst, size_t n)
+{
+  for (; n > 0; n--, src++, dst++)
+    {
+      *dst = *src > 0 ? (q15_t)q15_isqrt((uint32_t)*src << 15) : 0;
+    }
+}
+
+/****************************************************************************
+ * Name: q15_atan2
+ *
+ * Description:
+ *   Arctangent of y[i]/x[i] for every pair of samples.  The result is the
+ *   angle divided by pi, so [-pi, pi) maps to the full Q15 range.
+ *
+ ****************************************************************************/
+
+void q15_atan2(FAR const q15_t *y, FAR const q15_t *x, FAR q15_t *dst,
+               size_t n)
+{
+  int32_t ys;
+  int32_t xs;
+  int32_t m;
+  b16_t angle;
+
+  for (; n > 0; n--, y++, x++, dst++)
+    {
+      ys = *y;
+      xs = *x;
+      m  = (ys < 0 ? -ys : ys) | (xs < 0 ? -xs : xs);
+      if (m == 0)
+        {
+          *dst = 0;
+          continue;
+        }
+
+      /* The angle only depends on the ratio, so scale both up to the
+       * [1, 2) range of b16atan2() where its reciprocal is most precise.
+       */
+
+      while (m < b16ONE)
+        {
+          m  <<= 1;
+          ys <<= 1;
+          xs <<= 1;
+        }
+
+      angle = b16atan2(ys, xs);
+      *dst  = q15_sat64(((int64_t)angle * B16_INVPI) >> 17);
+    }
+}
+
+/****************************************************************************
+ * Name: q15_fir_init
+ *
+ * Description:
+ *   Initialize a FIR instance and clear its history.  'state' must hold
+ *   ntaps + blocksize - 1 samples.
+ *
+ ****************************************************************************/
+
+void q15_fir_init(FAR struct q15_fir_s *fir, FAR const q15_t *coeffs,
+                  uint16_t ntaps, FAR q15_t *state, uint16_t blocksize)
+{
+  fir->coeffs    = coeffs;
+  fir->state     = state;
+  fir->ntaps     = ntaps;
+  fir->blocksize = blocksize;
+
+  memset(state, 0, (ntaps + blocksize - 1) * sizeof(q15_t));
+}
+
+/****************************************************************************
+ * Name: q15_fir
+ *
+ * Description:
+ *   Filter 'n' samples, at most the block size of the instance.  The new
+ *   samples are appended to the history so that every output is one
+ *   contiguous dot product.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -EINVAL if 'n' is larger than the block size.
+ *
+ ****************************************************************************/
+
+int q15_fir(FAR struct q15_fir_s *fir, FAR const q15_t *src, FAR q15_t *dst,
+            size_t n)
+{
+  FAR q15_t *window = fir->state;
+  size_t i;
+
+  if (n > fir->blocksize)
+    {
+      return -EINVAL;
+    }
+
+  memcpy(&fir->state[fir->ntaps - 1], src, n * sizeof(q15_t));
+
+  for (i = 0; i < n; i++, window++)
+    {
+      dst[i] = q15_sat64(q15_dotn(window, fir->coeffs, fir->ntaps) >> 15);
+    }
+
+  memmove(fir->state, &fir->state[n], (fir->ntaps - 1) * sizeof(q15_t));
+  return OK;
+}
+
+/****************************************************************************
+ * Name: q15_biquad_init
+ *
+ * Description:
+ *   Initialize one biquad section and clear its history.
+ *
+ ****************************************************************************/
+
+void q15_biquad_init(FAR struct q15_biquad_s *bq, FAR const q15_t *coeffs,
+                     uint8_t shift)
+{
+  memcpy(bq->coeffs, coeffs, sizeof(bq->coeffs));
+  memset(bq->state, 0, sizeof(bq->state));
+  bq->shift = shift;
+}
+
+/****************************************************************************
+ * Name: q15_biquad
+ *
+ * Description:
+ *   Run 'n' samples through a cascade of 'nstages' biquad sections.  The
+ *   (b1, b2) and (a1, a2) coefficient pairs are each applied to their
+ *   history pair with one dual multiply-accumulate.  'src' and 'dst' may
+ *   be the same array.
+ *
+ ****************************************************************************/
+
+void q15_biquad(FAR struct q15_biquad_s *stages, int nstages,
+                FAR const q15_t *src, FAR q15_t *dst, size_t n)
+{
+  FAR struct q15_biquad_s *bq;
+  uint32_t bcoef;
+  uint32_t acoef;
+  int64_t acc;
+  q15_t in;
+  q15_t out;
+  size_t i;
+  int s;
+
+  for (s = 0; s < nstages; s++, src = dst)
+    {
+      bq    = &stages[s];
+      bcoef = q15_read2(&bq->coeffs[1]);
+      acoef = q15_read2(&bq->coeffs[3]);
+
+      for (i = 0; i < n; i++)
+        {
+          in  = src[i];
+          acc = (int32_t)bq->coeffs[0] * in;
+          acc = q15_smlald(bcoef, q15_read2(&bq->state[0]), acc);
+          acc = q15_smlald(acoef, q15_read2(&bq->state[2]), acc);
+          out = q15_sat64(acc >> (15 - bq->shift));
+
+          bq->state[1] = bq->state[0];
+          bq->state[0] = in;
+          bq->state[3] = bq->state[2];
+          bq->state[2] = out;
+
+          dst[i] = out;
+        }
+    }
+}
+
+#endif /* CONFIG_HAVE_LONG_LONG */
@@ -0,0 +1,374 @@
+/****************************************************************************
+ * libc/fixedmath/lib_q31dsp.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <errno.h>
+#include <fixedmath.h>
+
+#ifdef CONFIG_HAVE_LONG_LONG
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define Q31_MAX        INT32_MAX
+#define Q31_MIN        INT32_MIN
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: q31_sat64
+ *
+ * Description:
+ *   Saturate a 64-bit value to the Q31 range.
+ *
+ ****************************************************************************/
+
+static inline q31_t q31_sat64(int64_t value)
+{
+  if (value > Q31_MAX)
+    {
+      return Q31_MAX;
+    }
+  else if (value < Q31_MIN)
+    {
+      return Q31_MIN;
+    }
+
+  return (q31_t)value;
+}
+
+/****************************************************************************
+ * Name: q31_qadd
+ *
+ * Description:
+ *   Saturating 32-bit addition.
+ *
+ ****************************************************************************/
+
+static inline q31_t q31_qadd(q31_t x, q31_t y)
+{
+#ifdef __ARM_FEATURE_DSP
+  q31_t result;
+
+  __asm__ ("qadd %0, %1, %2" : "=r" (result) : "r" (x), "r" (y));
+  return result;
+#else
+  return q31_sat64((int64_t)x + y);
+#endif
+}
+
+/****************************************************************************
+ * Name: q31_mulhi
+ *
+ * Description:
+ *   Upper word of the 64-bit product, that is the Q30 product of two Q31
+ *   values.
+ *
+ ****************************************************************************/
+
+static inline int32_t q31_mulhi(q31_t x, q31_t y)
+{
+#ifdef __ARM_FEATURE_DSP
+  int32_t result;
+
+  __asm__ ("smmul %0, %1, %2" : "=r" (result) : "r" (x), "r" (y));
+  return result;
+#else
+  return (int32_t)(((int64_t)x * y) >> 32);
+#endif
+}
+
+/****************************************************************************
+ * Name: q31_dotn
+ *
+ * Description:
+ *   Q30 sum of products of two arrays.
+ *
+ ****************************************************************************/
+
+static inline int64_t q31_dotn(FAR const q31_t *a, FAR const q31_t *b,
+                               size_t n)
+{
+  int64_t acc = 0;
+
+  for (; n >= 2; n -= 2, a += 2, b += 2)
+    {
+      acc += q31_mulhi(a[0], b[0]);
+      acc += q31_mulhi(a[1], b[1]);
+    }
+
+  if (n > 0)
+    {
+      acc += q31_mulhi(*a, *b);
+    }
+
+  return acc;
+}
+
+/****************************************************************************
+ * Name: q31_isqrt
+ *
+ * Description:
+ *   64-bit integer square root, rounded down.
+ *
+ ****************************************************************************/
+
+static uint32_t q31_isqrt(uint64_t x)
+{
+  uint64_t result = 0;
+  uint64_t bit = (uint64_t)1 << 62;
+
+  while (bit > x)
+    {
+      bit >>= 2;
+    }
+
+  while (bit != 0)
+    {
+      if (x >= result + bit)
+        {
+          x      -= result + bit;
+          result  = (result >> 1) + bit;
+        }
+      else
+        {
+          result >>= 1;
+        }
+
+      bit >>= 2;
+    }
+
+  return (uint32_t)result;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: q31_dot
+ *
+ * Description:
+ *   Dot product of two Q31 arrays.  Each product keeps its upper word, so
+ *   the result is in Q30 with the 64-bit dynamic range of the accumulator,
+ *   like q15_dot().
+ *
+ ****************************************************************************/
+
+int64_t q31_dot(FAR const q31_t *a, FAR const q31_t *b, size_t n)
+{
+  return q31_dotn(a, b, n);
+}
+
+/****************************************************************************
+ * Name: q31_scale
+ *
+ * Description:
+ *   Multiply every sample of 'src' by 'scale':  dst[i] = src[i] * scale.
+ *   'src' and 'dst' may be the same array.
+ *
+ ****************************************************************************/
+
+void q31_scale(FAR const q31_t *src, q31_t scale, FAR q31_t *dst, size_t n)
+{
+  int32_t product;
+
+  while (n-- > 0)
+    {
+      /* Doubling the Q30 product with a saturating add only overflows for
+       * -1 * -1, which then gives the largest Q31 value.
+       */
+
+      product = q31_mulhi(*src++, scale);
+      *dst++  = q31_qadd(product, product);
+    }
+}
+
+/****************************************************************************
+ * Name: q31_add
+ *
+ * Description:
+ *   Saturating addition of two arrays:  dst[i] = a[i] + b[i].  'dst' may
+ *   be one of the sources.
+ *
+ ****************************************************************************/
+
+void q31_add(FAR const q31_t *a, FAR const q31_t *b, FAR q31_t *dst,
+             size_t n)
+{
+  while (n-- > 0)
+    {
+      *dst++ = q31_qadd(*a++, *b++);
+    }
+}
+
+/****************************************************************************
+ * Name: q31_sqrt
+ *
+ * Description:
+ *   Square root of every sample.  Negative samples give 0.
+ *
+ ****************************************************************************/
+
+void q31_sqrt(FAR const q31_t *src, FAR q31_t *dst, size_t n)
+{
+  for (; n > 0; n--, src++, dst++)
+    {
+      *dst = *src > 0 ? (q31_t)q31_isqrt((uint64_t)*src << 31) : 0;
+    }
+}
+
+/****************************************************************************
+ * Name: q31_fir_init
+ *
+ * Description:
+ *   Initialize a FIR instance and clear its history.  'state' must hold
+ *   ntaps + blocksize - 1 samples.
+ *
+ ****************************************************************************/
+
+void q31_fir_init(FAR struct q31_fir_s *fir, FAR const q31_t *coeffs,
+                  uint16_t ntaps, FAR q31_t *state, uint16_t blocksize)
+{
+  fir->coeffs    = coeffs;
+  fir->state     = state;
+  fir->ntaps     = ntaps;
+  fir->blocksize = blocksize;
+
+  memset(state, 0, (ntaps + blocksize - 1) * sizeof(q31_t));
+}
+
+/****************************************************************************
+ * Name: q31_fir
+ *
+ * Description:
+ *   Filter 'n' samples, at most the block size of the instance.
+ *
+ * Returned Value:
+ *   Zero (OK) on success; -EINVAL if 'n' is larger than the block size.
+ *
+ ****************************************************************************/
+
+int q31_fir(FAR struct q31_fir_s *fir, FAR const q31_t *src, FAR q31_t *dst,
+            size_t n)
+{
+  FAR q31_t *window = fir->state;
+  size_t i;
+
+  if (n > fir->blocksize)
+    {
+      return -EINVAL;
+    }
+
+  memcpy(&fir->state[fir->ntaps - 1], src, n * sizeof(q31_t));
+
+  for (i = 0; i < n; i++, window++)
+    {
+      dst[i] = q31_sat64(q31_dotn(window, fir->coeffs, fir->ntaps) << 1);
+    }
+
+  memmove(fir->state, &fir->state[n], (fir->ntaps - 1) * sizeof(q31_t));
+  return OK;
+}
+
+/****************************************************************************
+ * Name: q31_biquad_init
+ *
+ * Description:
+ *   Initialize one biquad section and clear its history.
+ *
+ ****************************************************************************/
+
+void q31_biquad_init(FAR struct q31_biquad_s *bq, FAR const q31_t *coeffs,
+                     uint8_t shift)
+{
+  memcpy(bq->coeffs, coeffs, sizeof(bq->coeffs));
+  memset(bq->state, 0, sizeof(bq->state));
+  bq->shift = shift;
+}
+
+/****************************************************************************
+ * Name: q31_biquad
+ *
+ * Description:
+ *   Run 'n' samples through a cascade of 'nstages' biquad sections.  The
+ *   products are accumulated in Q30, so the feedback loses the lowest bit
+ *   of each term.  'src' and 'dst' may be the same array.
+ *
+ ****************************************************************************/
+
+void q31_biquad(FAR struct q31_biquad_s *stages, int nstages,
+                FAR const q31_t *src, FAR q31_t *dst, size_t n)
+{
+  FAR struct q31_biquad_s *bq;
+  int64_t acc;
+  q31_t in;
+  q31_t out;
+  size_t i;
+  int s;
+
+  for (s = 0; s < nstages; s++, src = dst)
+    {
+      bq = &stages[s];
+
+      for (i = 0; i < n; i++)
+        {
+          in  = src[i];
+          acc = (int64_t)q31_mulhi(bq->coeffs[0], in) +
+                q31_mulhi(bq->coeffs[1], bq->state[0]) +
+                q31_mulhi(bq->coeffs[2], bq->state[1]) +
+                q31_mulhi(bq->coeffs[3], bq->state[2]) +
+                q31_mulhi(bq->coeffs[4], bq->state[3]);
+          out = q31_sat64(acc << (1 + bq->shift));
+
+          bq->state[1] = bq->state[0];
+          bq->state[0] = in;
+          bq->state[3] = bq->state[2];
+          bq->state[2] = out;
+
+          dst[i] = out;
+        }
+    }
+}
+
+#endif /* CONFIG_HAVE_LONG_LONG */
@@ -29,14 +29,63 @@
  * @brief Ring Buffer Package
  */
 
+#include <stdint.h>
+#include <string.h>
+#include <sched.h>
+#include <assert.h>
+
 #include <nuttx/kmalloc.h>
 #include <nuttx/ring_buf.h>
 
 #if defined(CONFIG_MHB) && defined(CONFIG_MM_BUFRAM_ALLOCATOR)
-#include <string.h>
 #include <nuttx/bufram.h>
 #endif
 
+#define RING_BUF_ALIGN_UP(x, a) (((x) + (a) - 1) & ~((a) - 1))
+
+/*
+ * Header of a ring allocated by ring_buf_alloc_ring_contig().  The ring
+ * buffer entries follow the header and the (aligned) buffers follow the
+ * entries, all in the same allocation.
+ */
+struct ring_buf_block {
+    struct ring_buf_block *next;    /* Link in the idle pool */
+    const char *name;               /* Pool name, NULL if not pooled */
+    unsigned int entries;
+    unsigned int headroom;
+    unsigned int data_len;
+    unsigned int tailroom;
+    unsigned int align;
+    struct ring_buf rb[];
+};
+
+/* Idle rings parked by ring_buf_pool_put() */
+static struct ring_buf_block *ring_buf_pool;
+
+static void *ring_buf_chunk_alloc(size_t size)
+{
+    void *chunk;
+
+#if defined(CONFIG_MHB) && defined(CONFIG_MM_BUFRAM_ALLOCATOR)
+    chunk = bufram_alloc(size);
+    if (chunk)
+        memset(chunk, 0, size);
+#else
+    chunk = zalloc(size);
+#endif
+
+    return chunk;
+}
+
+static void ring_buf_chunk_free(void *chunk)
+{
+#if defined(CONFIG_MHB) && defined(CONFIG_MM_BUFRAM_ALLOCATOR)
+    bufram_free(chunk);
+#else
+    free(chunk);
+#endif
+}
+
 /**
  * Initialize the data pointers of a ring buffer entry.
  * It is assumed that the 'rb' was allocated using ring_buf_alloc() or
@@ -75,18 +124,10 @@ struct ring_buf *ring_buf_alloc(unsigned int headroom, unsigned int data_len,
 
     buf_len = headroom + data_len + tailroom;
 
-#if defined(CONFIG_MHB) && defined(CONFIG_MM_BUFRAM_ALLOCATOR)
-    chunk = bufram_alloc(sizeof(*rb) + buf_len);
-#else
-    chunk = zalloc(sizeof(*rb) + buf_len);
-#endif
+    chunk = ring_buf_chunk_alloc(sizeof(*rb) + buf_len);
     if (!chunk)
         return NULL;
 
-#if defined(CONFIG_MHB) && defined(CONFIG_MM_BUFRAM_ALLOCATOR)
-    memset(chunk, 0, sizeof(*rb) + buf_len);
-#endif
-
     rb = chunk;
 
     ring_buf_set_owner(rb, RING_BUF_OWNER_PRODUCER);
@@ -103,11 +144,8 @@ struct ring_buf *ring_buf_alloc(unsigned int headroom, unsigned int data_len,
  */
 void ring_buf_free(struct ring_buf *rb)
 {
-#if defined(CONFIG_MHB) && defined(CONFIG_MM_BUFRAM_ALLOCATOR)
-    bufram_free(rb);
-#else
-    free(rb);
-#endif
+    DEBUGASSERT(!rb->block);
+    ring_buf_chunk_free(rb);
 }
 
 /**
@@ -187,7 +225,11 @@ struct ring_buf *ring_buf_alloc_ring(unsigned int entries,
 }
 
 /**
- * @brief Free a ring buffer ring allocated by ring_buf_alloc_ring()
+ * Entries added to a ring_buf_alloc_ring_contig() ring with ring_buf_alloc()
+ * are freed individually, the contiguous block itself is freed once.
+ *
+ * @brief Free a ring buffer ring allocated by ring_buf_alloc_ring() or
+ *        ring_buf_alloc_ring_contig()
  * @param rb Address of a ring buffer entry in the ring being freed
  * @param free_callback Callback routine called before each ring buffer entry
  *                      is freed
@@ -198,6 +240,7 @@ void ring_buf_free_ring(struct ring_buf *rb,
                         void *arg)
 {
     struct ring_buf *first_rb, *next_rb;
+    struct ring_buf_block *block = NULL;
 
     if (!rb)
         return;
@@ -210,7 +253,282 @@ void ring_buf_free_ring(struct ring_buf *rb,
         if (free_callback)
             free_callback(rb, arg);
 
-        ring_buf_free(rb);
+        if (rb->block)
+            block = rb->block;
+        else
+            ring_buf_free(rb);
         rb = next_rb;
     } while (rb != first_rb);
+
+    if (block)
+        ring_buf_chunk_free(block);
+}
+
+/*
+ * Put every entry of a contiguous ring back into its freshly allocated
+ * state: linked in order, owned by the producer, empty, no private data.
+ */
+static void ring_buf_block_reset(struct ring_buf_block *block)
+{
+    struct ring_buf *rb;
+    unsigned int i;
+
+    for (i = 0; i < block->entries; i++) {
+        rb = &block->rb[i];
+
+        rb->next = &block->rb[(i + 1) % block->entries];
+        rb->priv = NULL;
+        ring_buf_set_owner(rb, RING_BUF_OWNER_PRODUCER);
+        if (rb->headroom)
+            ring_buf_reset(rb);
+    }
+}
+
+/**
+ * Allocate a ring the same way ring_buf_alloc_ring() does but with the
+ * ring buffer entries and all of their buffers in one allocation.  Each
+ * buffer (headroom included) starts on an 'align' boundary and is padded
+ * to a multiple of 'align' so no two buffers share a cache line.
+ *
+ * The ring is freed with ring_buf_free_ring().  Its entries must not be
+ * freed with ring_buf_free().
+ *
+ * @brief Allocate a ring of ring buffer entries in a single block
+ * @param entries Number of ring buffer entries in the ring
+ * @param headroom Number of bytes to reserve before the data area in each
+ *                 ring buffer entry
+ * @param data_len Number of bytes of of data in each ring buffer entry
+ * @param tailroom Number of bytes to reserve after the data area in each
+ *                 ring buffer entry
+ * @param align Buffer alignment, a power of two, or 0 for
+ *              CONFIG_LIB_RING_BUF_ALIGN
+ * @param alloc_callback Callback routine called after each ring buffer entry
+ *                       is allocated
+ * @param free_callback Callback routine called before each ring buffer entry
+ *                      is freed (on error)
+ * @param arg Argument to pass to alloc_callback() and free_callback()
+ * @return Address of the first ring buffer entry in the ring or NULL on
+ *         failure
+ */
+struct ring_buf *ring_buf_alloc_ring_contig(unsigned int entries,
+                                            unsigned int headroom,
+                                            unsigned int data_len,
+                                            unsigned int tailroom,
+                                            unsigned int align,
+                                            int (*alloc_callback)(
+                                                struct ring_buf *rb,
+                                                void *arg),
+                                            void (*free_callback)(
+                                                struct ring_buf *rb,
+                                                void *arg),
+                                            void *arg)
+{
+    struct ring_buf_block *block;
+    unsigned int buf_len, stride, i;
+    size_t size;
+    uintptr_t buf;
+    int ret;
+
+    if (!align)
+        align = CONFIG_LIB_RING_BUF_ALIGN;
+
+    if (!entries || (align & (align - 1)))
+        return NULL;
+
+    buf_len = headroom + data_len + tailroom;
+    stride = RING_BUF_ALIGN_UP(buf_len, align);
+
+    size = sizeof(*block) + entries * sizeof(struct ring_buf);
+    if (buf_len)
+        size += (align - 1) + entries * stride;
+
+    block = ring_buf_chunk_alloc(size);
+    if (!block)
+        return NULL;
+
+    block->entries = entries;
+    block->headroom = headroom;
+    block->data_len = data_len;
+    block->tailroom = tailroom;
+    block->align = align;
+
+    buf = RING_BUF_ALIGN_UP((uintptr_t)&block->rb[entries], align);
+
+    for (i = 0; i < entries; i++) {
+        block->rb[i].block = block;
+        if (buf_len)
+            ring_buf_init(&block->rb[i], (void *)(buf + i * stride),
+                          headroom, data_len);
+    }
+
+    ring_buf_block_reset(block);
+
+    if (alloc_callback) {
+        for (i = 0; i < entries; i++) {
+            ret = alloc_callback(&block->rb[i], arg);
+            if (ret)
+                break;
+        }
+
+        if (i < entries) {
+            while (free_callback && i-- > 0)
+                free_callback(&block->rb[i], arg);
+
+            ring_buf_chunk_free(block);
+            return NULL;
+        }
+    }
+
+    return block->rb;
+}
+
+/**
+ * Hand out a contiguous ring from the pool of idle rings.  An idle ring
+ * parked under 'name' with the same geometry is reused as is; otherwise
+ * any idle ring of that name is freed and a new one is allocated.  Either
+ * way the entries come back empty, linked in order and owned by the
+ * producer; headroom and tailroom contents of a reused ring are preserved.
+ *
+ * Must not be called from interrupt context.
+ *
+ * @brief Get a ring from the named ring pool
+ * @param name Pool name; the string must stay valid while the ring exists
+ * @param entries Number of ring buffer entries in the ring
+ * @param headroom Number of bytes to reserve before the data area in each
+ *                 ring buffer entry
+ * @param data_len Number of bytes of of data in each ring buffer entry
+ * @param tailroom Number of bytes to reserve after the data area in each
+ *                 ring buffer entry
+ * @param align Buffer alignment, a power of two, or 0 for
+ *              CONFIG_LIB_RING_BUF_ALIGN
+ * @param init_callback Callback routine called for each ring buffer entry
+ *                      every time the ring is handed out
+ * @param arg Argument to pass to init_callback()
+ * @return Address of the first ring buffer entry in the ring or NULL on
+ *         failure
+ */
+struct ring_buf *ring_buf_pool_get(const char *name, unsigned int entries,
+                                   unsigned int headroom,
+                                   unsigned int data_len,
+                                   unsigned int tailroom,
+                                   unsigned int align,
+                                   int (*init_callback)(struct ring_buf *rb,
+                                                        void *arg),
+                                   void *arg)
+{
+    struct ring_buf_block *block, **pp;
+    struct ring_buf *rb;
+    unsigned int i;
+
+    DEBUGASSERT(name);
+
+    if (!align)
+        align = CONFIG_LIB_RING_BUF_ALIGN;
+
+    sched_lock();
+    for (pp = &ring_buf_pool; *pp; pp = &(*pp)->next) {
+        if (!strcmp((*pp)->name, name))
+            break;
+    }
+
+    block = *pp;
+    if (block)
+        *pp = block->next;
+    sched_unlock();
+
+    if (block && (block->entries != entries || block->headroom != headroom ||
+                  block->data_len != data_len ||
+                  block->tailroom != tailroom || block->align != align)) {
+        ring_buf_chunk_free(block);
+        block = NULL;
+    }
+
+    if (block) {
+        ring_buf_block_reset(block);
+    } else {
+        rb = ring_buf_alloc_ring_contig(entries, headroom, data_len, tailroom,
+                                        align, NULL, NULL, NULL);
+        if (!rb)
+            return NULL;
+
+        block = rb->block;
+        block->name = name;
+    }
+
+    if (init_callback) {
+        for (i = 0; i < entries; i++) {
+            if (init_callback(&block->rb[i], arg)) {
+                ring_buf_pool_put(block->rb);
+                return NULL;
+            }
+        }
+    }
+
+    return block->rb;
+}
+
+/**
+ * Park a ring obtained from ring_buf_pool_get() so a later get of the same
+ * name can reuse it.  Only one idle ring is kept per name, an older one is
+ * freed.  The caller must be done with every entry of the ring.
+ *
+ * Must not be called from interrupt context.
+ *
+ * @brief Return a ring to the named ring pool
+ * @param rb Address of any ring buffer entry of the ring
+ */
+void ring_buf_pool_put(struct ring_buf *rb)
+{
+    struct ring_buf_block *block, *old = NULL, **pp;
+
+    if (!rb)
+        return;
+
+    block = rb->block;
+    DEBUGASSERT(block && block->name);
+
+    sched_lock();
+    for (pp = &ring_buf_pool; *pp; pp = &(*pp)->next) {
+        if (!strcmp((*pp)->name, block->name)) {
+            old = *pp;
+            *pp = old->next;
+            break;
+        }
+    }
+
+    block->next = ring_buf_pool;
+    ring_buf_pool = block;
+    sched_unlock();
+
+    if (old)
+        ring_buf_chunk_free(old);
+}
+
+/**
+ * @brief Free idle rings held by the ring pool
+ * @param name Pool name of the rings to free or NULL to free all of them
+ */
+void ring_buf_pool_flush(const char *name)
+{
+    struct ring_buf_block *block, *freed = NULL, **pp;
+
+    sched_lock();
+    pp = &ring_buf_pool;
+    while (*pp) {
+        block = *pp;
+        if (!name || !strcmp(block->name, name)) {
+            *pp = block->next;
+            block->next = freed;
+            freed = block;
+        } else {
+            pp = &block->next;
+        }
+    }
+    sched_unlock();
+
+    while (freed) {
+        block = freed;
+        freed = block->next;
+        ring_buf_chunk_free(block);
+    }
 }
@@ -40,6 +40,8 @@
 #include <nuttx/config.h>
 
 #include <sys/sendfile.h>
+#include <sys/ioctl.h>
+#include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -65,6 +67,99 @@
  * Private Functions
  ************************************************************************/
 
+/************************************************************************
+ * Name: lib_sendmapped
+ *
+ * Description:
+ *   Write up to 'count' bytes from the current position of 'infd' to
+ *   'outfd' directly from the mapped file data, if 'infd' can be mapped.
+ *   On return, the file position of 'infd' follows the last byte that was
+ *   written, just as if the data had been read.
+ *
+ * Returned Value:
+ *   The number of bytes transferred or ERROR.  *mapped is set to false
+ *   (and nothing is transferred) if the file cannot be mapped.
+ *
+ ************************************************************************/
+
+#ifdef CONFIG_LIB_SENDFILE_MMAP
+static ssize_t lib_sendmapped(int outfd, int infd, size_t count,
+                              FAR bool *mapped)
+{
+  FAR uint8_t *base;
+  ssize_t nbyteswritten;
+  ssize_t ntransferred;
+  off_t curpos;
+  off_t endpos;
+
+  /* Get the address of the file data on the media */
+
+  *mapped = false;
+  if (ioctl(infd, FIOC_MMAP, (unsigned long)((uintptr_t)&base)) < 0)
+    {
+      return 0;
+    }
+
+  /* Get the current position and the size of the file */
+
+  curpos = lseek(infd, 0, SEEK_CUR);
+  if (curpos == (off_t)-1)
+    {
+      return 0;
+    }
+
+  endpos = lseek(infd, 0, SEEK_END);
+  if (endpos == (off_t)-1)
+    {
+      return 0;
+    }
+
+  *mapped = true;
+  if (curpos >= endpos)
+    {
+      count = 0;
+    }
+  else if (count > (size_t)(endpos - curpos))
+    {
+      count = endpos - curpos;
+    }
+
+  /* Write the data directly from the media */
+
+  for (ntransferred = 0; ntransferred < (ssize_t)count; )
+    {
+      nbyteswritten = write(outfd, &base[curpos + ntransferred],
+                            count - ntransferred);
+      if (nbyteswritten >= 0)
+        {
+          ntransferred += nbyteswritten;
+        }
+
+      /* EINTR is not an error once some data has been transferred */
+
+#ifndef CONFIG_DISABLE_SIGNALS
+      else if (errno != EINTR || ntransferred == 0)
+#else
+      else
+#endif
+        {
+          ntransferred = ERROR;
+          break;
+        }
+    }
+
+  /* Leave the file position after the last byte that was sent */
+
+  if (lseek(infd, curpos + (ntransferred > 0 ? ntransferred : 0),
+            SEEK_SET) == (off_t)-1)
+    {
+      return ERROR;
+    }
+
+  return ntransferred;
+}
+#endif
+
 /************************************************************************
  * Public Functions
  ************************************************************************/
@@ -126,6 +221,9 @@ ssize_t sendfile(int outfd, int infd, off_t *offset, size_t count)
   ssize_t nbyteswritten;
   size_t  ntransferred;
   bool endxfr;
+#ifdef CONFIG_LIB_SENDFILE_MMAP
+  bool mapped;
+#endif
 
   /* Get the current file position. */
 
@@ -147,6 +245,18 @@ ssize_t sendfile(int outfd, int infd, off_t *offset, size_t count)
         }
     }
 
+#ifdef CONFIG_LIB_SENDFILE_MMAP
+  /* If the input file can be mapped, then there is no need for an I/O
+   * buffer:  Write the data directly from the media.
+   */
+
+  ntransferred = (size_t)lib_sendmapped(outfd, infd, count, &mapped);
+  if (mapped)
+    {
+      goto return_offset;
+    }
+#endif
+
   /* Allocate an I/O buffer */
 
   iobuffer = (FAR void *)lib_malloc(CONFIG_LIB_SENDFILE_BUFSIZE);
@@ -271,6 +381,9 @@ ssize_t sendfile(int outfd, int infd, off_t *offset, size_t count)
 
   /* Return the current file position */
 
+#ifdef CONFIG_LIB_SENDFILE_MMAP
+return_offset:
+#endif
   if (offset)
     {
       /* Use lseek to get the current file position */
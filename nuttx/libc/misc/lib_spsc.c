@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2016 Motorola Mobility, LLC.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 1. Redistributions of source code must retain the above copyright notice,
+ * this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from this
+ * software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+ * THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+ * PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+ * CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @brief Single-producer/single-consumer queue
+ */
+
+#include <errno.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/spsc.h>
+
+/**
+ * @brief Initialize a queue over caller provided storage
+ * @param q Address of the queue to initialize
+ * @param slots Array of 'nslots' pointers used to hold the entries
+ * @param nslots Number of slots; must be a power of two
+ * @return 0 on success, -EINVAL if 'nslots' is not a power of two
+ */
+int spsc_init(struct spsc_queue *q, void **slots, unsigned int nslots)
+{
+    if (!nslots || (nslots & (nslots - 1)))
+        return -EINVAL;
+
+    q->head = 0;
+    q->tail = 0;
+    q->waiting = false;
+    q->mask = nslots - 1;
+    q->slots = slots;
+    sem_init(&q->sem, 0, 0);
+
+    return 0;
+}
+
+/**
+ * @brief Release the resources of a queue set up with spsc_init()
+ * @param q Address of the queue
+ */
+void spsc_deinit(struct spsc_queue *q)
+{
+    sem_destroy(&q->sem);
+}
+
+/**
+ * @brief Allocate and initialize a queue and its slots
+ * @param nslots Number of slots; must be a power of two
+ * @return Address of the queue or NULL on failure
+ */
+struct spsc_queue *spsc_alloc(unsigned int nslots)
+{
+    struct spsc_queue *q;
+
+    q = kmm_malloc(sizeof(*q) + nslots * sizeof(void *));
+    if (!q)
+        return NULL;
+
+    if (spsc_init(q, (void **)(q + 1), nslots)) {
+        kmm_free(q);
+        return NULL;
+    }
+
+    return q;
+}
+
+/**
+ * @brief Free a queue allocated with spsc_alloc()
+ * @param q Address of the queue
+ */
+void spsc_free(struct spsc_queue *q)
+{
+    if (!q)
+        return;
+
+    spsc_deinit(q);
+    kmm_free(q);
+}
+
+/**
+ * Only the consumer may call this function.  It returns immediately if the
+ * queue is not empty, otherwise it blocks until the producer adds an entry,
+ * spsc_kick() is called, or a signal is received.  The queue may still be
+ * empty on return.
+ *
+ * @brief Wait for the queue to become non-empty
+ * @param q Address of the queue
+ * @return 0 on success, -EINTR if the wait was interrupted by a signal
+ */
+int spsc_wait(struct spsc_queue *q)
+{
+    int ret;
+
+    q->waiting = true;
+
+    /* Pairs with the second barrier in spsc_push() */
+    spsc_barrier();
+    if (!spsc_is_empty(q)) {
+        q->waiting = false;
+        return 0;
+    }
+
+    ret = sem_wait(&q->sem);
+    q->waiting = false;
+
+    return ret ? -EINTR : 0;
+}
+
+/**
+ * May be called from any context, e.g. to make the consumer notice a
+ * shutdown request.
+ *
+ * @brief Wake up the consumer even though the queue may be empty
+ * @param q Address of the queue
+ */
+void spsc_kick(struct spsc_queue *q)
+{
+    sem_post(&q->sem);
+}
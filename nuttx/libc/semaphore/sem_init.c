@@ -110,6 +110,7 @@ int sem_init(FAR sem_t *sem, int pshared, unsigned int value)
 #ifdef CONFIG_PRIORITY_INHERITANCE
 #  if CONFIG_SEM_PREALLOCHOLDERS > 0
       sem->hhead         = NULL;
+      sem->fholder       = NULL;
 #  else
       sem->holder.htcb   = NULL;
       sem->holder.counts = 0;
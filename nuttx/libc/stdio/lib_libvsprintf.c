@@ -61,6 +61,12 @@
 #  define CONFIG_LIBC_FIXEDPRECISION 3
 #endif
 
+/* Size of the on-stack buffer that collects the output for streams that
+ * accept blocks of characters (see struct vsprintf_bufstream_s)
+ */
+
+#define VSPRINTF_BUFSIZE         64
+
 #define FLAG_SHOWPLUS            0x01
 #define FLAG_ALTFORM             0x02
 #define FLAG_HASDOT              0x04
@@ -138,6 +144,19 @@ enum
   FMT_CENTER
 };
 
+/* If the output stream provides a puts method, the characters produced by
+ * the formatting code are collected here and passed to the stream a block
+ * at a time instead of one put call per character.
+ */
+
+struct vsprintf_bufstream_s
+{
+  struct lib_outstream_s      public;
+  FAR struct lib_outstream_s *target;  /* The caller's output stream */
+  int                         nbuf;    /* Number of characters in buf[] */
+  char                        buf[VSPRINTF_BUFSIZE];
+};
+
 /****************************************************************************
  * Private Function Prototypes
  ****************************************************************************/
@@ -224,6 +243,106 @@ static const char g_nullstring[] = "(null)";
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: bufstream_flushbuf
+ ****************************************************************************/
+
+static void bufstream_flushbuf(FAR struct vsprintf_bufstream_s *bthis)
+{
+  if (bthis->nbuf > 0)
+    {
+      bthis->target->puts(bthis->target, bthis->buf, bthis->nbuf);
+      bthis->nbuf = 0;
+    }
+}
+
+/****************************************************************************
+ * Name: bufstream_putc
+ ****************************************************************************/
+
+static void bufstream_putc(FAR struct lib_outstream_s *this, int ch)
+{
+  FAR struct vsprintf_bufstream_s *bthis =
+    (FAR struct vsprintf_bufstream_s *)this;
+
+  if (bthis->nbuf >= VSPRINTF_BUFSIZE)
+    {
+      bufstream_flushbuf(bthis);
+    }
+
+  bthis->buf[bthis->nbuf++] = ch;
+  this->nput++;
+}
+
+/****************************************************************************
+ * Name: bufstream_puts
+ ****************************************************************************/
+
+static void bufstream_puts(FAR struct lib_outstream_s *this,
+                           FAR const char *buffer, int len)
+{
+  FAR struct vsprintf_bufstream_s *bthis =
+    (FAR struct vsprintf_bufstream_s *)this;
+
+  if (len > VSPRINTF_BUFSIZE - bthis->nbuf)
+    {
+      bufstream_flushbuf(bthis);
+
+      /* Blocks that would not fit go straight to the output stream */
+
+      if (len >= VSPRINTF_BUFSIZE)
+        {
+          bthis->target->puts(bthis->target, buffer, len);
+          this->nput += len;
+          return;
+        }
+    }
+
+  memcpy(&bthis->buf[bthis->nbuf], buffer, len);
+  bthis->nbuf += len;
+  this->nput  += len;
+}
+
+/****************************************************************************
+ * Name: bufstream_flush
+ ****************************************************************************/
+
+#ifdef CONFIG_STDIO_LINEBUFFER
+static int bufstream_flush(FAR struct lib_outstream_s *this)
+{
+  FAR struct vsprintf_bufstream_s *bthis =
+    (FAR struct vsprintf_bufstream_s *)this;
+
+  bufstream_flushbuf(bthis);
+  return bthis->target->flush(bthis->target);
+}
+#endif
+
+/****************************************************************************
+ * Name: vsprintf_puts
+ *
+ * Description:
+ *   Output a block of characters, with the stream's puts method if it has
+ *   one.
+ *
+ ****************************************************************************/
+
+static void vsprintf_puts(FAR struct lib_outstream_s *obj,
+                          FAR const char *buffer, int len)
+{
+  if (obj->puts)
+    {
+      obj->puts(obj, buffer, len);
+    }
+  else
+    {
+      while (len-- > 0)
+        {
+          obj->put(obj, *buffer++);
+        }
+    }
+}
+
 /* Include floating point functions */
 
 #ifdef CONFIG_LIBC_FLOATINGPOINT
@@ -1157,14 +1276,11 @@ static void postjustify(FAR struct lib_outstream_s *obj, uint8_t fmt,
 #endif
 
 /****************************************************************************
- * Public Functions
+ * Name: vsprintf_internal
  ****************************************************************************/
 
-/****************************************************************************
- * libc/stdio/lib_vsprintf
- ****************************************************************************/
-
-int lib_vsprintf(FAR struct lib_outstream_s *obj, FAR const char *src, va_list ap)
+static int vsprintf_internal(FAR struct lib_outstream_s *obj,
+                             FAR const char *src, va_list ap)
 {
   FAR char        *ptmp;
 #ifndef CONFIG_NOPRINTF_FIELDWIDTH
@@ -1185,9 +1301,24 @@ int lib_vsprintf(FAR struct lib_outstream_s *obj, FAR const char *src, va_list a
 
       if (FMT_CHAR != '%')
         {
+#ifndef CONFIG_ARCH_ROMGETC
+           /* Output the regular characters up to the next format specifier
+            * (or newline) as one block.
+            */
+
+           FAR const char *run = src;
+
+           while (*src != '\n' && src[1] != '\0' && src[1] != '%')
+             {
+               src++;
+             }
+
+           vsprintf_puts(obj, run, src - run + 1);
+#else
            /* Output the character */
 
            obj->put(obj, FMT_CHAR);
+#endif
 
            /* Flush the buffer if a newline is encountered */
 
@@ -1379,11 +1510,11 @@ int lib_vsprintf(FAR struct lib_outstream_s *obj, FAR const char *src, va_list a
 #endif
           /* Concatenate the string into the output */
 
-          while (*ptmp)
-            {
-              obj->put(obj, *ptmp);
-              ptmp++;
-            }
+#ifndef CONFIG_NOPRINTF_FIELDWIDTH
+          vsprintf_puts(obj, ptmp, swidth);
+#else
+          vsprintf_puts(obj, ptmp, strlen(ptmp));
+#endif
 
           /* Perform left-justification operations. */
 
@@ -1617,4 +1748,37 @@ int lib_vsprintf(FAR struct lib_outstream_s *obj, FAR const char *src, va_list a
   return obj->nput;
 }
 
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * libc/stdio/lib_vsprintf
+ ****************************************************************************/
 
+int lib_vsprintf(FAR struct lib_outstream_s *obj, FAR const char *src, va_list ap)
+{
+  struct vsprintf_bufstream_s bufstream;
+
+  /* Streams without a puts method get their characters one at a time */
+
+  if (obj->puts == NULL)
+    {
+      return vsprintf_internal(obj, src, ap);
+    }
+
+  /* Otherwise, collect the output and pass it on in blocks */
+
+  bufstream.public.put   = bufstream_putc;
+  bufstream.public.puts  = bufstream_puts;
+#ifdef CONFIG_STDIO_LINEBUFFER
+  bufstream.public.flush = bufstream_flush;
+#endif
+  bufstream.public.nput  = 0;
+  bufstream.target       = obj;
+  bufstream.nbuf         = 0;
+
+  (void)vsprintf_internal(&bufstream.public, src, ap);
+  bufstream_flushbuf(&bufstream);
+  return obj->nput;
+}
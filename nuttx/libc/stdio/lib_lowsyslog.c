@@ -42,6 +42,8 @@
 #include <stdio.h>
 #include <debug.h>
 
+#include <nuttx/syslog/binlog.h>
+
 #include "lib_internal.h"
 
 /* This interface can only be used from within the kernel */
@@ -92,6 +94,12 @@
 
 int lowvsyslog(FAR const char *fmt, va_list ap)
 {
+#ifdef CONFIG_SYSLOG_BINARY
+  /* Record the message, it is formatted later */
+
+  (void)binlog_vrecord(fmt, ap);
+  return 0;
+#else
   struct lib_outstream_s stream;
 
   /* Wrap the stdout in a stream object and let lib_vsprintf do the work. */
@@ -102,6 +110,7 @@ int lowvsyslog(FAR const char *fmt, va_list ap)
   lib_lowoutstream((FAR struct lib_outstream_s *)&stream);
 #endif
   return lib_vsprintf((FAR struct lib_outstream_s *)&stream, fmt, ap);
+#endif
 }
 
 /****************************************************************************
@@ -76,6 +76,7 @@ static void nulloutstream_putc(FAR struct lib_outstream_s *this, int ch)
 void lib_nulloutstream(FAR struct lib_outstream_s *nulloutstream)
 {
   nulloutstream->put   = nulloutstream_putc;
+  nulloutstream->puts  = NULL;
 #ifdef CONFIG_STDIO_LINEBUFFER
   nulloutstream->flush = lib_noflush;
 #endif
@@ -84,6 +84,43 @@ static void rawoutstream_putc(FAR struct lib_outstream_s *this, int ch)
   while (errcode == EINTR);
 }
 
+/****************************************************************************
+ * Name: rawoutstream_puts
+ ****************************************************************************/
+
+static void rawoutstream_puts(FAR struct lib_outstream_s *this,
+                              FAR const char *buffer, int len)
+{
+  FAR struct lib_rawoutstream_s *rthis = (FAR struct lib_rawoutstream_s *)this;
+  ssize_t nwritten;
+
+  DEBUGASSERT(this && rthis->fd >= 0);
+
+  /* Loop until all of the characters are transferred or until an
+   * irrecoverable error occurs.
+   */
+
+  while (len > 0)
+    {
+      nwritten = write(rthis->fd, buffer, len);
+      if (nwritten > 0)
+        {
+          this->nput += nwritten;
+          buffer     += nwritten;
+          len        -= nwritten;
+        }
+
+      /* The only expected error is EINTR, meaning that the write operation
+       * was awakened by a signal.
+       */
+
+      else if (nwritten == 0 || get_errno() != EINTR)
+        {
+          break;
+        }
+    }
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -108,6 +145,7 @@ static void rawoutstream_putc(FAR struct lib_outstream_s *this, int ch)
 void lib_rawoutstream(FAR struct lib_rawoutstream_s *outstream, int fd)
 {
   outstream->public.put   = rawoutstream_putc;
+  outstream->public.puts  = rawoutstream_puts;
 #ifdef CONFIG_STDIO_LINEBUFFER
   outstream->public.flush = lib_noflush;
 #endif
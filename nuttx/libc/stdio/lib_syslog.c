@@ -42,6 +42,8 @@
 #include <stdio.h>
 #include <syslog.h>
 
+#include <nuttx/syslog/binlog.h>
+
 #include "lib_internal.h"
 
 /****************************************************************************
@@ -53,6 +55,7 @@
 #if defined(CONFIG_BUILD_PROTECTED) && !defined(__KERNEL__)
 #  undef CONFIG_SYSLOG
 #  undef CONFIG_ARCH_LOWPUTC
+#  undef CONFIG_SYSLOG_BINARY
 #endif
 
 /****************************************************************************
@@ -93,7 +96,14 @@
 
 int vsyslog(FAR const char *fmt, va_list ap)
 {
-#if defined(CONFIG_SYSLOG)
+#if defined(CONFIG_SYSLOG_BINARY)
+
+  /* Record the message, it is formatted later */
+
+  (void)binlog_vrecord(fmt, ap);
+  return 0;
+
+#elif defined(CONFIG_SYSLOG)
 
   struct lib_outstream_s stream;
 
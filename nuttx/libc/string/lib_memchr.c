@@ -39,8 +39,17 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
 #include <string.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Non-zero if any byte of the 32-bit word 'w' is zero */
+
+#define HASZERO(w) (((w) - 0x01010101) & ~(w) & 0x80808080)
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -65,6 +74,40 @@ FAR void *memchr(FAR const void *s, int c, size_t n)
 
   if (s)
     {
+#ifdef CONFIG_MEMCHR_OPTSPEED
+      FAR const uint32_t *w;
+      uint32_t pattern;
+
+      /* Check bytes up to a word boundary */
+
+      while (((uintptr_t)p & 3) != 0 && n > 0)
+        {
+          if (*p == (unsigned char)c)
+            {
+              return (FAR void *)p;
+            }
+
+          p++;
+          n--;
+        }
+
+      /* Then skip the words that do not contain 'c'.  A word that does is
+       * searched byte by byte below.
+       */
+
+      pattern  = (unsigned char)c;
+      pattern |= pattern << 8;
+      pattern |= pattern << 16;
+
+      for (w = (FAR const uint32_t *)p; n >= 4 && !HASZERO(*w ^ pattern);
+           w++)
+        {
+          n -= 4;
+        }
+
+      p = (FAR const unsigned char *)w;
+#endif
+
       while (n--)
         {
           if (*p == (unsigned char)c)
@@ -43,6 +43,7 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <stdint.h>
 #include <string.h>
 
 /************************************************************
@@ -55,6 +56,43 @@ int memcmp(FAR const void *s1, FAR const void *s2, size_t n)
   unsigned char *p1 = (unsigned char *)s1;
   unsigned char *p2 = (unsigned char *)s2;
 
+#ifdef CONFIG_MEMCMP_OPTSPEED
+  /* When both buffers have the same alignment, skip over the equal words.
+   * The bytes of the first differing word are compared below.
+   */
+
+  if ((((uintptr_t)p1 ^ (uintptr_t)p2) & 3) == 0)
+    {
+      FAR const uint32_t *w1;
+      FAR const uint32_t *w2;
+
+      while (((uintptr_t)p1 & 3) != 0 && n > 0)
+        {
+          if (*p1 != *p2)
+            {
+              return *p1 < *p2 ? -1 : 1;
+            }
+
+          p1++;
+          p2++;
+          n--;
+        }
+
+      w1 = (FAR const uint32_t *)p1;
+      w2 = (FAR const uint32_t *)p2;
+
+      while (n >= 4 && *w1 == *w2)
+        {
+          w1++;
+          w2++;
+          n -= 4;
+        }
+
+      p1 = (unsigned char *)w1;
+      p2 = (unsigned char *)w2;
+    }
+#endif
+
   while (n-- > 0)
     {
       if (*p1 < *p2)
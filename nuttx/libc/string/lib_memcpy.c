@@ -42,9 +42,20 @@
  ****************************************************************************/
 
 #include <nuttx/config.h>
+#include <nuttx/compiler.h>
 #include <sys/types.h>
 #include <string.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_ARCH_RAMFUNC_MEMCPY
+#  define MEMCPY_LOCATION locate_code(".ramfunc")
+#else
+#  define MEMCPY_LOCATION
+#endif
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -54,7 +65,7 @@
  ****************************************************************************/
 
 #ifndef CONFIG_ARCH_MEMCPY
-FAR void *memcpy(FAR void *dest, FAR const void *src, size_t n)
+MEMCPY_LOCATION FAR void *memcpy(FAR void *dest, FAR const void *src, size_t n)
 {
   FAR unsigned char *pout = (FAR unsigned char*)dest;
   FAR unsigned char *pin  = (FAR unsigned char*)src;
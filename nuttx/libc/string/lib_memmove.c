@@ -43,6 +43,8 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 
 /************************************************************
@@ -52,6 +54,120 @@
 #ifndef CONFIG_ARCH_MEMMOVE
 FAR void *memmove(FAR void *dest, FAR const void *src, size_t count)
 {
+#ifdef CONFIG_MEMMOVE_OPTSPEED
+  /* This version moves words when the source and destination have the
+   * same alignment.  Four words are moved per iteration so that the
+   * compiler can use LDM/STM.
+   */
+
+  FAR uint8_t *d = (FAR uint8_t *)dest;
+  FAR const uint8_t *s = (FAR const uint8_t *)src;
+  FAR uint32_t *dw;
+  FAR const uint32_t *sw;
+  uint32_t w0, w1, w2, w3;
+  bool aligned = (((uintptr_t)d ^ (uintptr_t)s) & 3) == 0;
+
+  if (d == s || count == 0)
+    {
+      return dest;
+    }
+
+  if (d < s)
+    {
+      /* Copy forward */
+
+      if (aligned)
+        {
+          while (((uintptr_t)d & 3) != 0 && count > 0)
+            {
+              *d++ = *s++;
+              count--;
+            }
+
+          dw = (FAR uint32_t *)d;
+          sw = (FAR const uint32_t *)s;
+
+          while (count >= 16)
+            {
+              w0 = sw[0];
+              w1 = sw[1];
+              w2 = sw[2];
+              w3 = sw[3];
+              dw[0] = w0;
+              dw[1] = w1;
+              dw[2] = w2;
+              dw[3] = w3;
+              dw += 4;
+              sw += 4;
+              count -= 16;
+            }
+
+          while (count >= 4)
+            {
+              *dw++ = *sw++;
+              count -= 4;
+            }
+
+          d = (FAR uint8_t *)dw;
+          s = (FAR const uint8_t *)sw;
+        }
+
+      while (count-- > 0)
+        {
+          *d++ = *s++;
+        }
+    }
+  else
+    {
+      /* Copy backward, the destination overlaps the end of the source */
+
+      d += count;
+      s += count;
+
+      if (aligned)
+        {
+          while (((uintptr_t)d & 3) != 0 && count > 0)
+            {
+              *--d = *--s;
+              count--;
+            }
+
+          dw = (FAR uint32_t *)d;
+          sw = (FAR const uint32_t *)s;
+
+          while (count >= 16)
+            {
+              dw -= 4;
+              sw -= 4;
+              w0 = sw[0];
+              w1 = sw[1];
+              w2 = sw[2];
+              w3 = sw[3];
+              dw[3] = w3;
+              dw[2] = w2;
+              dw[1] = w1;
+              dw[0] = w0;
+              count -= 16;
+            }
+
+          while (count >= 4)
+            {
+              *--dw = *--sw;
+              count -= 4;
+            }
+
+          d = (FAR uint8_t *)dw;
+          s = (FAR const uint8_t *)sw;
+        }
+
+      while (count-- > 0)
+        {
+          *--d = *--s;
+        }
+    }
+
+  return dest;
+#else
   char *tmp, *s;
   if (dest <= src)
     {
@@ -73,5 +189,6 @@ FAR void *memmove(FAR void *dest, FAR const void *src, size_t count)
     }
 
   return dest;
+#endif
 }
 #endif
@@ -39,8 +39,17 @@
 
 #include <nuttx/config.h>
 #include <sys/types.h>
+#include <stdint.h>
 #include <string.h>
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Non-zero if any byte of the 32-bit word 'w' is zero */
+
+#define HASZERO(w) (((w) - 0x01010101) & ~(w) & 0x80808080)
+
 /****************************************************************************
  * Global Functions
  ****************************************************************************/
@@ -49,7 +58,32 @@
 size_t strlen(const char *s)
 {
   const char *sc;
-  for (sc = s; *sc != '\0'; ++sc);
+
+#ifdef CONFIG_STRLEN_OPTSPEED
+  FAR const uint32_t *w;
+
+  /* Check bytes up to a word boundary */
+
+  for (sc = s; ((uintptr_t)sc & 3) != 0; ++sc)
+    {
+      if (*sc == '\0')
+        {
+          return sc - s;
+        }
+    }
+
+  /* Then check a word at a time.  An aligned word never crosses the end
+   * of a memory region, so reading past the terminator is harmless.
+   */
+
+  for (w = (FAR const uint32_t *)sc; !HASZERO(*w); w++);
+
+  sc = (const char *)w;
+#else
+  sc = s;
+#endif
+
+  for (; *sc != '\0'; ++sc);
   return sc - s;
 }
 #endif
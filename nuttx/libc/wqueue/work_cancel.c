@@ -116,6 +116,9 @@ int work_cancel(int qid, FAR struct work_s *work)
 
       dq_rem((FAR dq_entry_t *)work, &wqueue->q);
       work->worker = NULL;
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+      wqueue->stats.depth--;
+#endif
     }
 
   irqrestore(flags);
@@ -71,6 +71,55 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: work_qadd
+ *
+ * Description:
+ *   Common logic of work_queue() and work_queue_deadline().
+ *
+ ****************************************************************************/
+
+static int work_qadd(int qid, FAR struct work_s *work, worker_t worker,
+                     FAR void *arg, uint32_t delay, uint32_t deadline)
+{
+  FAR struct wqueue_s *wqueue = &g_work[qid];
+  irqstate_t flags;
+
+  DEBUGASSERT(work != NULL && (unsigned)qid < NWORKERS);
+
+  /* First, initialize the work structure */
+
+  work->worker = worker;           /* Work callback */
+  work->arg    = arg;              /* Callback argument */
+  work->delay  = delay;            /* Delay until work performed */
+
+  /* Now, time-tag that entry and put it in the work queue.  This must be
+   * done with interrupts disabled.  This permits this function to be called
+   * from with task logic or interrupt handlers.
+   */
+
+  flags        = irqsave();
+  work->qtime  = clock_systimer(); /* Time work queued */
+#ifdef CONFIG_SCHED_WORKQUEUE_DEADLINE
+  work->deadline = work->qtime + deadline;
+#endif
+
+  dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
+
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+  wqueue->stats.nqueued++;
+  if (++wqueue->stats.depth > wqueue->stats.maxdepth)
+    {
+      wqueue->stats.maxdepth = wqueue->stats.depth;
+    }
+#endif
+
+  kill(wqueue->pid, SIGWORK);      /* Wake up the worker thread */
+
+  irqrestore(flags);
+  return OK;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -107,30 +156,24 @@
 int work_queue(int qid, FAR struct work_s *work, worker_t worker,
                FAR void *arg, uint32_t delay)
 {
-  FAR struct wqueue_s *wqueue = &g_work[qid];
-  irqstate_t flags;
-
-  DEBUGASSERT(work != NULL && (unsigned)qid < NWORKERS);
-
-  /* First, initialize the work structure */
-
-  work->worker = worker;           /* Work callback */
-  work->arg    = arg;              /* Callback argument */
-  work->delay  = delay;            /* Delay until work performed */
-
-  /* Now, time-tag that entry and put it in the work queue.  This must be
-   * done with interrupts disabled.  This permits this function to be called
-   * from with task logic or interrupt handlers.
-   */
-
-  flags        = irqsave();
-  work->qtime  = clock_systimer(); /* Time work queued */
+  return work_qadd(qid, work, worker, arg, delay, delay);
+}
 
-  dq_addlast((FAR dq_entry_t *)work, &wqueue->q);
-  kill(wqueue->pid, SIGWORK);      /* Wake up the worker thread */
+/****************************************************************************
+ * Name: work_queue_deadline
+ *
+ * Description:
+ *   Like work_queue() but also gives the time by which the work should be
+ *   performed.  Only queues created with WQUEUE_FLAG_DEADLINE use it.
+ *
+ ****************************************************************************/
 
-  irqrestore(flags);
-  return OK;
+#ifdef CONFIG_SCHED_WORKQUEUE_DEADLINE
+int work_queue_deadline(int qid, FAR struct work_s *work, worker_t worker,
+                        FAR void *arg, uint32_t delay, uint32_t deadline)
+{
+  return work_qadd(qid, work, worker, arg, delay, deadline);
 }
+#endif
 
 #endif /* CONFIG_SCHED_WORKQUEUE */
@@ -40,7 +40,10 @@
 #include <nuttx/config.h>
 
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <unistd.h>
+#include <sched.h>
 #include <queue.h>
 #include <assert.h>
 #include <errno.h>
@@ -50,6 +53,7 @@
 #include <nuttx/wqueue.h>
 #include <nuttx/clock.h>
 #include <nuttx/kmalloc.h>
+#include <nuttx/kthread.h>
 
 #ifdef CONFIG_SCHED_WORKQUEUE
 
@@ -97,6 +101,37 @@ struct wqueue_s g_work[NWORKERS];
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: work_earliest
+ *
+ * Description:
+ *   Starting with the ready work 'first', find the ready work with the
+ *   earliest deadline.  Interrupts must be disabled.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKQUEUE_DEADLINE
+static FAR struct work_s *work_earliest(FAR struct work_s *first,
+                                        uint32_t now)
+{
+  FAR struct work_s *best = first;
+  FAR struct work_s *work;
+
+  for (work = (FAR struct work_s *)first->dq.flink;
+       work;
+       work = (FAR struct work_s *)work->dq.flink)
+    {
+      if (now - work->qtime >= work->delay &&
+          (int32_t)(work->deadline - best->deadline) < 0)
+        {
+          best = work;
+        }
+    }
+
+  return best;
+}
+#endif
+
 /****************************************************************************
  * Name: work_process
  *
@@ -117,6 +152,7 @@ static void work_process(FAR struct wqueue_s *wqueue)
   worker_t  worker;
   irqstate_t flags;
   FAR void *arg;
+  uint32_t now;
   uint32_t elapsed;
   uint32_t remaining;
   uint32_t next;
@@ -136,13 +172,30 @@ static void work_process(FAR struct wqueue_s *wqueue)
        * zero.  Therefore a delay of zero will always execute immediately.
        */
 
-      elapsed = clock_systimer() - work->qtime;
+      now     = clock_systimer();
+      elapsed = now - work->qtime;
       if (elapsed >= work->delay)
         {
+#ifdef CONFIG_SCHED_WORKQUEUE_DEADLINE
+          /* On a deadline queue, the first ready work found is not
+           * necessarily the one to run.
+           */
+
+          if ((wqueue->flags & WQUEUE_FLAG_DEADLINE) != 0)
+            {
+              work    = work_earliest((FAR struct work_s *)work, now);
+              elapsed = now - work->qtime;
+            }
+#endif
+
           /* Remove the ready-to-execute work from the list */
 
           (void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
 
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+          wqueue->stats.depth--;
+#endif
+
           /* Extract the work description from the entry (in case the work
            * instance by the re-used after it has been de-queued).
            */
@@ -163,6 +216,17 @@ static void work_process(FAR struct wqueue_s *wqueue)
 
               work->worker = NULL;
 
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+              /* How much longer than requested did the work wait? */
+
+              remaining = elapsed - work->delay;
+              wqueue->stats.totlatency += remaining;
+              if (remaining > wqueue->stats.maxlatency)
+                {
+                  wqueue->stats.maxlatency = remaining;
+                }
+#endif
+
               /* Do the work.  Re-enable interrupts while the work is being
                * performed... we don't have any idea how long that will take!
                */
@@ -170,6 +234,15 @@ static void work_process(FAR struct wqueue_s *wqueue)
               irqrestore(flags);
               worker(arg);
 
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+              elapsed = clock_systimer() - now;
+              wqueue->stats.nrun++;
+              if (elapsed > wqueue->stats.maxruntime)
+                {
+                  wqueue->stats.maxruntime = elapsed;
+                }
+#endif
+
               /* Now, unfortunately, since we re-enabled interrupts we don't
                * know the state of the work list and we will have to start
                * back at the head of the list.
@@ -193,7 +266,7 @@ static void work_process(FAR struct wqueue_s *wqueue)
            * scheduled wakeup interval?
            */
 
-          remaining = elapsed - work->delay;
+          remaining = work->delay - elapsed;
           if (remaining < next)
             {
               /* Yes.. Then schedule to wake up when the work is ready */
@@ -219,7 +292,7 @@ static void work_process(FAR struct wqueue_s *wqueue)
  * Public Functions
  ****************************************************************************/
 /****************************************************************************
- * Name: work_hpthread, work_lpthread, and work_usrthread
+ * Name: work_hpthread, work_lpthread, work_xthread, and work_usrthread
  *
  * Description:
  *   These are the worker threads that performs actions placed on the work
@@ -232,6 +305,9 @@ static void work_process(FAR struct wqueue_s *wqueue)
  *
  *     These worker threads are started by the OS during normal bringup.
  *
+ *   work_xthread:  This is the worker thread of a kernel work queue created
+ *     at run time by work_qcreate().
+ *
  *   work_usrthread:  This is a user mode work queue.  It must be built into
  *     the application blob during the user phase of a kernel build.  The
  *     user work thread will then automatically be started when the system
@@ -328,4 +404,126 @@ int work_usrthread(int argc, char *argv[])
 
 #endif /* CONFIG_SCHED_USRWORK */
 
+#if CONFIG_SCHED_NXWORK > 0
+int work_xthread(int argc, char *argv[])
+{
+  FAR struct wqueue_s *wqueue;
+  int qid;
+
+  /* The work queue ID is passed as the only argument */
+
+  DEBUGASSERT(argc == 2);
+  qid = atoi(argv[1]);
+  DEBUGASSERT(qid >= XWORK && qid < NWORKERS);
+  wqueue = &g_work[qid];
+
+  /* Loop forever */
+
+  for (;;)
+    {
+      /* Process queued work.  Garbage collection is left to the HPWORK or
+       * LPWORK thread.
+       */
+
+      work_process(wqueue);
+    }
+
+  return OK; /* To keep some compilers happy */
+}
+
+/****************************************************************************
+ * Name: work_qcreate
+ *
+ * Description:
+ *   Create an additional kernel work queue with its own worker thread.
+ *
+ * Input parameters:
+ *   name      - Name of the worker thread
+ *   priority  - Priority of the worker thread
+ *   stacksize - Stack size of the worker thread
+ *   flags     - Zero or WQUEUE_FLAG_DEADLINE
+ *
+ * Returned Value:
+ *   The ID of the new work queue on success, a negated errno on failure.
+ *
+ ****************************************************************************/
+
+int work_qcreate(FAR const char *name, int priority, int stacksize,
+                 uint8_t flags)
+{
+  FAR char *argv[2];
+  char arg[8];
+  pid_t pid;
+  int qid;
+
+  /* Reserve an unused work queue */
+
+  sched_lock();
+  for (qid = XWORK; qid < NWORKERS && g_work[qid].pid != 0; qid++);
+  if (qid >= NWORKERS)
+    {
+      sched_unlock();
+      return -ENOSPC;
+    }
+
+  g_work[qid].pid = -1;
+  sched_unlock();
+
+  dq_init(&g_work[qid].q);
+#ifdef CONFIG_SCHED_WORKQUEUE_DEADLINE
+  g_work[qid].flags = flags;
+#endif
+
+  /* Start the worker thread, telling it which queue it serves */
+
+  snprintf(arg, sizeof(arg), "%d", qid);
+  argv[0] = arg;
+  argv[1] = NULL;
+
+  pid = kernel_thread(name, priority, stacksize, (main_t)work_xthread,
+                      (FAR char * const *)argv);
+  if (pid < 0)
+    {
+      g_work[qid].pid = 0;
+      return -get_errno();
+    }
+
+  g_work[qid].pid = pid;
+  return qid;
+}
+#endif /* CONFIG_SCHED_NXWORK > 0 */
+
+/****************************************************************************
+ * Name: work_getstats
+ *
+ * Description:
+ *   Return a snapshot of the statistics of one work queue.
+ *
+ * Input parameters:
+ *   qid    - The work queue ID
+ *   stats  - Location to return the statistics
+ *
+ * Returned Value:
+ *   Zero on success, -ENOENT if no such queue is running.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKQUEUE_STATS
+int work_getstats(int qid, FAR struct work_stats_s *stats)
+{
+  irqstate_t flags;
+
+  if ((unsigned)qid >= NWORKERS || g_work[qid].pid <= 0)
+    {
+      return -ENOENT;
+    }
+
+  flags  = irqsave();
+  *stats = g_work[qid].stats;
+  irqrestore(flags);
+
+  return OK;
+}
+#endif
+
 #endif /* CONFIG_SCHED_WORKQUEUE */
@@ -0,0 +1,503 @@
+/****************************************************************************
+ * libnx/nxfonts/nxfonts_cache.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/nx/nxglib.h>
+#include <nuttx/nx/nxfonts.h>
+
+#include "nxcontext.h"
+#include "nxfonts_internal.h"
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* Describes one glyph cache.  Glyphs are kept on a singly linked list in
+ * most-recently-used order so that lookups of the common characters are
+ * short and the victim is always the last entry.
+ */
+
+struct nxfonts_fcache_s
+{
+  FAR struct nxfonts_fcache_s *flink;  /* Next cache on g_fcaches */
+  FAR struct nxfonts_glyph_s *head;    /* Most recently used glyph */
+  NXHANDLE font;                       /* Font handle */
+  nxgl_mxpixel_t fgcolor;              /* Foreground color */
+  nxgl_mxpixel_t bgcolor;              /* Background color */
+  sem_t fsem;                          /* Serializes glyph list access */
+  int16_t fclients;                    /* Number of connected clients */
+  int16_t maxglyphs;                   /* Maximum number of cached glyphs */
+  int16_t nglyphs;                     /* Number of cached glyphs */
+  uint8_t fontid;                      /* Font ID */
+  uint8_t bpp;                         /* Bits per pixel */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* All glyph caches, protected by g_fcachesem */
+
+static FAR struct nxfonts_fcache_s *g_fcaches;
+static sem_t g_fcachesem = SEM_INITIALIZER(1);
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxf_takesem
+ ****************************************************************************/
+
+static void nxf_takesem(FAR sem_t *sem)
+{
+  while (sem_wait(sem) < 0)
+    {
+      DEBUGASSERT(get_errno() == EINTR);
+    }
+}
+
+/****************************************************************************
+ * Name: nxf_fillglyph
+ *
+ * Description:
+ *   Initialize the glyph memory to the background color of the cache.
+ *
+ ****************************************************************************/
+
+static void nxf_fillglyph(FAR struct nxfonts_fcache_s *priv,
+                          FAR struct nxfonts_glyph_s *glyph)
+{
+  int row;
+  int col;
+
+  if (priv->bpp < 8)
+    {
+      uint8_t pixel = (uint8_t)priv->bgcolor;
+
+      /* Replicate the pixel through the byte */
+
+      if (priv->bpp == 1)
+        {
+          pixel &= 0x01;
+          pixel  = pixel << 1 | pixel;
+        }
+
+      if (priv->bpp <= 2)
+        {
+          pixel &= 0x03;
+          pixel  = pixel << 2 | pixel;
+        }
+
+      pixel &= 0x0f;
+      pixel  = pixel << 4 | pixel;
+
+      memset(glyph->bitmap, pixel, glyph->stride * glyph->height);
+    }
+  else if (priv->bpp == 8)
+    {
+      memset(glyph->bitmap, (uint8_t)priv->bgcolor,
+             glyph->stride * glyph->height);
+    }
+  else
+    {
+      for (row = 0; row < glyph->height; row++)
+        {
+          FAR uint8_t *line = &glyph->bitmap[row * glyph->stride];
+
+          for (col = 0; col < glyph->width; col++)
+            {
+              switch (priv->bpp)
+                {
+                  case 16:
+                    ((FAR uint16_t *)line)[col] = (uint16_t)priv->bgcolor;
+                    break;
+
+                  case 24:
+                    line[3 * col]     = (uint8_t)priv->bgcolor;
+                    line[3 * col + 1] = (uint8_t)(priv->bgcolor >> 8);
+                    line[3 * col + 2] = (uint8_t)(priv->bgcolor >> 16);
+                    break;
+
+                  default:
+                    ((FAR uint32_t *)line)[col] = (uint32_t)priv->bgcolor;
+                    break;
+                }
+            }
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: nxf_renderglyph
+ *
+ * Description:
+ *   Render the foreground bits of the font bitmap into the glyph memory.
+ *
+ ****************************************************************************/
+
+static int nxf_renderglyph(FAR struct nxfonts_fcache_s *priv,
+                           FAR struct nxfonts_glyph_s *glyph,
+                           FAR const struct nx_fontbitmap_s *fbm)
+{
+  FAR uint8_t *dest = glyph->bitmap;
+
+  switch (priv->bpp)
+    {
+      case 1:
+        return nxf_convert_1bpp(dest, glyph->height, glyph->width,
+                                glyph->stride, fbm, priv->fgcolor);
+      case 2:
+        return nxf_convert_2bpp(dest, glyph->height, glyph->width,
+                                glyph->stride, fbm, priv->fgcolor);
+      case 4:
+        return nxf_convert_4bpp(dest, glyph->height, glyph->width,
+                                glyph->stride, fbm, priv->fgcolor);
+      case 8:
+        return nxf_convert_8bpp(dest, glyph->height, glyph->width,
+                                glyph->stride, fbm, priv->fgcolor);
+      case 16:
+        return nxf_convert_16bpp((FAR uint16_t *)dest, glyph->height,
+                                 glyph->width, glyph->stride, fbm,
+                                 priv->fgcolor);
+      case 24:
+        return nxf_convert_24bpp((FAR uint32_t *)dest, glyph->height,
+                                 glyph->width, glyph->stride, fbm,
+                                 priv->fgcolor);
+      case 32:
+        return nxf_convert_32bpp((FAR uint32_t *)dest, glyph->height,
+                                 glyph->width, glyph->stride, fbm,
+                                 priv->fgcolor);
+      default:
+        return -EINVAL;
+    }
+}
+
+/****************************************************************************
+ * Name: nxf_findglyph
+ *
+ * Description:
+ *   Look up a cached glyph and, if found, move it to the head of the list.
+ *   Must be called with fsem held.
+ *
+ ****************************************************************************/
+
+static FAR struct nxfonts_glyph_s *
+nxf_findglyph(FAR struct nxfonts_fcache_s *priv, uint16_t ch)
+{
+  FAR struct nxfonts_glyph_s *prev = NULL;
+  FAR struct nxfonts_glyph_s *glyph;
+
+  for (glyph = priv->head; glyph; prev = glyph, glyph = glyph->flink)
+    {
+      if (glyph->code == ch)
+        {
+          if (prev)
+            {
+              prev->flink  = glyph->flink;
+              glyph->flink = priv->head;
+              priv->head   = glyph;
+            }
+
+          return glyph;
+        }
+    }
+
+  return NULL;
+}
+
+/****************************************************************************
+ * Name: nxf_evictglyphs
+ *
+ * Description:
+ *   Discard least recently used glyphs so that there is room for 'room'
+ *   more.  Must be called with fsem held.
+ *
+ ****************************************************************************/
+
+static void nxf_evictglyphs(FAR struct nxfonts_fcache_s *priv, int room)
+{
+  FAR struct nxfonts_glyph_s *glyph;
+  FAR struct nxfonts_glyph_s **link;
+  int keep = priv->maxglyphs - room;
+  int i;
+
+  if (priv->nglyphs <= keep)
+    {
+      return;
+    }
+
+  /* Walk past the glyphs to keep, then free the rest of the list */
+
+  link = &priv->head;
+  for (i = 0; i < keep && *link; i++)
+    {
+      link = &(*link)->flink;
+    }
+
+  glyph = *link;
+  *link = NULL;
+
+  while (glyph)
+    {
+      FAR struct nxfonts_glyph_s *next = glyph->flink;
+      lib_free(glyph);
+      glyph = next;
+      priv->nglyphs--;
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxf_cache_connect
+ *
+ * Description:
+ *   Return a handle to a (possibly shared) glyph cache for the font, colors
+ *   and pixel depth.
+ *
+ ****************************************************************************/
+
+FCACHE nxf_cache_connect(enum nx_fontid_e fontid, nxgl_mxpixel_t fgcolor,
+                         nxgl_mxpixel_t bgcolor, int bpp, int maxglyphs)
+{
+  FAR struct nxfonts_fcache_s *priv;
+
+  if (maxglyphs < 1 || maxglyphs > INT16_MAX ||
+      (bpp != 1 && bpp != 2 && bpp != 4 && bpp != 8 &&
+       bpp != 16 && bpp != 24 && bpp != 32))
+    {
+      set_errno(EINVAL);
+      return NULL;
+    }
+
+  nxf_takesem(&g_fcachesem);
+
+  /* Share an existing cache with the same rendering parameters */
+
+  for (priv = g_fcaches; priv; priv = priv->flink)
+    {
+      if (priv->fontid == fontid && priv->fgcolor == fgcolor &&
+          priv->bgcolor == bgcolor && priv->bpp == bpp)
+        {
+          priv->fclients++;
+          if (maxglyphs > priv->maxglyphs)
+            {
+              priv->maxglyphs = maxglyphs;
+            }
+
+          sem_post(&g_fcachesem);
+          return (FCACHE)priv;
+        }
+    }
+
+  /* None found.. create a new one */
+
+  priv = (FAR struct nxfonts_fcache_s *)lib_zalloc(sizeof(*priv));
+  if (!priv)
+    {
+      sem_post(&g_fcachesem);
+      set_errno(ENOMEM);
+      return NULL;
+    }
+
+  priv->font = nxf_getfonthandle(fontid);
+  if (!priv->font)
+    {
+      sem_post(&g_fcachesem);
+      gdbg("No font ID %d\n", fontid);
+      lib_free(priv);
+      return NULL;
+    }
+
+  priv->fclients  = 1;
+  priv->maxglyphs = maxglyphs;
+  priv->fontid    = fontid;
+  priv->bpp       = bpp;
+  priv->fgcolor   = fgcolor;
+  priv->bgcolor   = bgcolor;
+  sem_init(&priv->fsem, 0, 1);
+
+  priv->flink     = g_fcaches;
+  g_fcaches       = priv;
+
+  sem_post(&g_fcachesem);
+  return (FCACHE)priv;
+}
+
+/****************************************************************************
+ * Name: nxf_cache_disconnect
+ *
+ * Description:
+ *   Release a reference to a glyph cache, freeing it with the last one.
+ *
+ ****************************************************************************/
+
+void nxf_cache_disconnect(FCACHE fhandle)
+{
+  FAR struct nxfonts_fcache_s *priv = (FAR struct nxfonts_fcache_s *)fhandle;
+  FAR struct nxfonts_fcache_s **link;
+
+  DEBUGASSERT(priv && priv->fclients > 0);
+
+  nxf_takesem(&g_fcachesem);
+
+  if (--priv->fclients > 0)
+    {
+      sem_post(&g_fcachesem);
+      return;
+    }
+
+  for (link = &g_fcaches; *link; link = &(*link)->flink)
+    {
+      if (*link == priv)
+        {
+          *link = priv->flink;
+          break;
+        }
+    }
+
+  sem_post(&g_fcachesem);
+
+  priv->maxglyphs = 0;
+  nxf_evictglyphs(priv, 0);
+  sem_destroy(&priv->fsem);
+  lib_free(priv);
+}
+
+/****************************************************************************
+ * Name: nxf_cache_getfonthandle
+ *
+ * Description:
+ *   Return the font handle used by the cache.
+ *
+ ****************************************************************************/
+
+NXHANDLE nxf_cache_getfonthandle(FCACHE fhandle)
+{
+  FAR struct nxfonts_fcache_s *priv = (FAR struct nxfonts_fcache_s *)fhandle;
+
+  DEBUGASSERT(priv);
+  return priv->font;
+}
+
+/****************************************************************************
+ * Name: nxf_cache_getglyph
+ *
+ * Description:
+ *   Return the cached glyph for the character code, rendering it on a miss.
+ *
+ ****************************************************************************/
+
+FAR const struct nxfonts_glyph_s *nxf_cache_getglyph(FCACHE fhandle,
+                                                     uint16_t ch)
+{
+  FAR struct nxfonts_fcache_s *priv = (FAR struct nxfonts_fcache_s *)fhandle;
+  FAR const struct nx_fontbitmap_s *fbm;
+  FAR struct nxfonts_glyph_s *glyph;
+  unsigned int width;
+  unsigned int height;
+  unsigned int stride;
+
+  DEBUGASSERT(priv);
+
+  nxf_takesem(&priv->fsem);
+
+  glyph = nxf_findglyph(priv, ch);
+  if (glyph)
+    {
+      sem_post(&priv->fsem);
+      return glyph;
+    }
+
+  /* Not cached.. does the code map to a font bitmap? */
+
+  fbm = nxf_getbitmap(priv->font, ch);
+  if (!fbm)
+    {
+      sem_post(&priv->fsem);
+      return NULL;
+    }
+
+  width  = fbm->metric.width + fbm->metric.xoffset;
+  height = fbm->metric.height + fbm->metric.yoffset;
+  stride = (width * priv->bpp + 7) >> 3;
+
+  /* Make room first so that the allocation can reuse the freed memory */
+
+  nxf_evictglyphs(priv, 1);
+
+  glyph = (FAR struct nxfonts_glyph_s *)
+    lib_malloc(offsetof(struct nxfonts_glyph_s, bitmap) + stride * height);
+  if (!glyph)
+    {
+      sem_post(&priv->fsem);
+      gdbg("Failed to allocate glyph %d\n", ch);
+      return NULL;
+    }
+
+  glyph->code   = ch;
+  glyph->width  = width;
+  glyph->height = height;
+  glyph->stride = stride;
+
+  nxf_fillglyph(priv, glyph);
+  if (nxf_renderglyph(priv, glyph, fbm) < 0)
+    {
+      sem_post(&priv->fsem);
+      lib_free(glyph);
+      return NULL;
+    }
+
+  glyph->flink = priv->head;
+  priv->head   = glyph;
+  priv->nglyphs++;
+
+  sem_post(&priv->fsem);
+  return glyph;
+}
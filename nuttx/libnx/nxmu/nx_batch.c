@@ -0,0 +1,165 @@
+/****************************************************************************
+ * libnx/nxmu/nx_batch.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxmu.h>
+
+#include "nxcontext.h"
+
+#ifdef CONFIG_NX_BATCH
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nx_batch
+ *
+ * Description:
+ *   Enable or disable batching of drawing commands on a connection.  While
+ *   batching is enabled, nx_setpixel(), nx_fill(), nx_filltrapezoid() and
+ *   nx_move() are collected in a client-side buffer and sent to the server
+ *   as a single message.
+ *
+ * Input Parameters:
+ *   handle - the handle returned by nx_connect
+ *   enable - True: Buffer drawing commands; false: Send each one directly
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nx_batch(NXHANDLE handle, bool enable)
+{
+  FAR struct nxfe_conn_s *conn = (FAR struct nxfe_conn_s *)handle;
+  FAR struct nxmu_batch_s *batch;
+  int ret = OK;
+  int i;
+
+#ifdef CONFIG_DEBUG
+  if (!conn)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+#endif
+
+  batch = conn->batch;
+  if (enable)
+    {
+      if (!batch)
+        {
+          batch = (FAR struct nxmu_batch_s *)lib_uzalloc(sizeof(struct nxmu_batch_s));
+          if (!batch)
+            {
+              set_errno(ENOMEM);
+              return ERROR;
+            }
+
+          for (i = 0; i < 2; i++)
+            {
+              sem_init(&batch->buf[i].done, 0, 0);
+            }
+
+          conn->batch = batch;
+        }
+    }
+  else if (batch)
+    {
+      /* Send whatever is pending, then wait until the server no longer
+       * references either buffer before freeing them.
+       */
+
+      ret = nxmu_flush(conn);
+
+      for (i = 0; i < 2; i++)
+        {
+          if (batch->buf[i].busy)
+            {
+              nxmu_semtake(&batch->buf[i].done);
+            }
+
+          sem_destroy(&batch->buf[i].done);
+        }
+
+      conn->batch = NULL;
+      lib_ufree(batch);
+    }
+
+  return ret;
+}
+
+/****************************************************************************
+ * Name: nx_flush
+ *
+ * Description:
+ *   Send any buffered drawing commands to the server.  This does not wait
+ *   for the server to execute them.
+ *
+ * Input Parameters:
+ *   handle - the handle returned by nx_connect
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nx_flush(NXHANDLE handle)
+{
+  FAR struct nxfe_conn_s *conn = (FAR struct nxfe_conn_s *)handle;
+
+#ifdef CONFIG_DEBUG
+  if (!conn)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+#endif
+
+  return nxmu_flush(conn);
+}
+
+#endif /* CONFIG_NX_BATCH */
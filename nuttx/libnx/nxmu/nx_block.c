@@ -125,6 +125,7 @@ int nx_block(NXWINDOW hwnd, FAR void *arg)
        * the message queue before we can set the blocked state.
        */
 
+      (void)nxmu_flush(wnd->conn);
       NXBE_SETBLOCKED(wnd);
 
       /* Send the message inicating that the window is blocked (and because of
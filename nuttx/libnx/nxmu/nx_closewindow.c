@@ -90,6 +90,10 @@ int nx_closewindow(NXWINDOW hwnd)
   FAR struct nxbe_window_s *wnd = (FAR struct nxbe_window_s *)hwnd;
   struct nxsvrmsg_closewindow_s outmsg;
 
+  /* Send any buffered drawing commands first so that they execute in order */
+
+  (void)nxmu_flush(wnd->conn);
+
   /* Request destruction of the window by the server */
 
   outmsg.msgid = NX_SVRMSG_CLOSEWINDOW;
@@ -92,6 +92,10 @@ void nx_disconnect(NXHANDLE handle)
   struct nxsvrmsg_s       outmsg;
   int                     ret;
 
+  /* Send any buffered drawing commands first so that they execute in order */
+
+  (void)nxmu_flush(conn);
+
   /* Inform the server that this client no longer exists */
 
   outmsg.msgid = NX_SVRMSG_DISCONNECT;
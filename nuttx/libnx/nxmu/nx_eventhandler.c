@@ -40,7 +40,9 @@
 #include <nuttx/config.h>
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
 #include <mqueue.h>
 #include <assert.h>
 #include <errno.h>
@@ -97,84 +99,37 @@ static inline void nx_disconnected(FAR struct nxfe_conn_s *conn)
   (void)mq_close(conn->cwrmq);
   (void)mq_close(conn->crdmq);
 
+#ifdef CONFIG_NX_BATCH
+  /* The server executed any outstanding batches before disconnecting */
+
+  if (conn->batch)
+    {
+      sem_destroy(&conn->batch->buf[0].done);
+      sem_destroy(&conn->batch->buf[1].done);
+      lib_ufree(conn->batch);
+    }
+#endif
+
   /* And free the client structure */
 
   lib_ufree(conn);
 }
 
 /****************************************************************************
- * Public Functions
- ****************************************************************************/
-
-/****************************************************************************
- * Name: nx_eventhandler
+ * Name: nx_dispatch
  *
  * Description:
- *   The client code must call this function periodically to process
- *   incoming messages from the server.  If CONFIG_NX_BLOCKING is defined,
- *   then this function not return until a server message is received.
- *
- *   When CONFIG_NX_BLOCKING is not defined, the client must exercise
- *   caution in the looping to assure that it does not eat up all of
- *   the CPU bandwidth calling nx_eventhandler repeatedly.  nx_eventnotify
- *   may be called to get a signal event whenever a new incoming server
- *   event is available.
- *
- * Input Parameters:
- *   handle - the handle returned by nx_connect
+ *   Dispatch one message received from the server to the window callbacks.
  *
  * Return:
- *     OK: No errors occurred.  If CONFIG_NX_BLOCKING is defined, then
- *         one or more server message was processed.
- *  ERROR: An error occurred and errno has been set appropriately.  Of
- *         particular interest, it will return errno == EHOSTDOWN when the
- *         server is disconnected.  After that event, the handle can no
- *         longer be used.
+ *   OK, or ERROR with errno == EHOSTDOWN if the server disconnected
  *
  ****************************************************************************/
 
-int nx_eventhandler(NXHANDLE handle)
+static int nx_dispatch(FAR struct nxfe_conn_s *conn, FAR uint8_t *buffer)
 {
-  FAR struct nxfe_conn_s *conn = (FAR struct nxfe_conn_s *)handle;
-  struct nxsvrmsg_s      *msg;
-  struct nxbe_window_s   *wnd;
-  uint8_t                 buffer[NX_MXCLIMSGLEN];
-  int                     nbytes;
-
-  /* Get the next message from our incoming message queue */
-
-  do
-    {
-      nbytes = mq_receive(conn->crdmq, buffer, NX_MXCLIMSGLEN, 0);
-      if (nbytes < 0)
-        {
-          /* EINTR is not an error.  The wait was interrupted by a signal and
-           * we just need to try reading again.
-           */
-
-          if (errno != EINTR)
-            {
-              if (errno == EAGAIN)
-                {
-                  /* EAGAIN is not an error.  It occurs because the MQ is opened with
-                   * O_NONBLOCK and there is no message available now.
-                   */
-
-                  return OK;
-                }
-              else
-                {
-                  gdbg("mq_receive failed: %d\n", errno);
-                  return ERROR;
-                }
-            }
-        }
-    }
-  while (nbytes < 0);
-
-  DEBUGASSERT(nbytes >= sizeof(struct nxclimsg_s));
-
-  /* Dispatch the message appropriately */
+  FAR struct nxsvrmsg_s *msg;
+  FAR struct nxbe_window_s *wnd;
 
   msg = (struct nxsvrmsg_s *)buffer;
   gvdbg("Received msgid=%d\n", msg->msgid);
@@ -260,3 +215,151 @@ int nx_eventhandler(NXHANDLE handle)
 
   return OK;
 }
+
+/****************************************************************************
+ * Name: nx_coalesce
+ *
+ * Description:
+ *   The mouse report in 'buffer' is about to be delivered.  Replace it with
+ *   any later reports for the same window and buttons that are already
+ *   queued, so that only the most recent position of a drag is delivered.
+ *
+ * Return:
+ *   True if a message that could not be merged was received into 'next'.
+ *   It must be dispatched after the report in 'buffer'.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NX_MOUSE_COALESCE
+static bool nx_coalesce(FAR struct nxfe_conn_s *conn, FAR uint8_t *buffer,
+                        FAR uint8_t *next)
+{
+  FAR struct nxclimsg_mousein_s *mouse = (FAR struct nxclimsg_mousein_s *)buffer;
+  FAR struct nxclimsg_mousein_s *later = (FAR struct nxclimsg_mousein_s *)next;
+  struct mq_attr attr;
+  int nbytes;
+
+  while (mq_getattr(conn->crdmq, &attr) == OK && attr.mq_curmsgs > 0)
+    {
+      nbytes = mq_receive(conn->crdmq, next, NX_MXCLIMSGLEN, 0);
+      if (nbytes < 0)
+        {
+          break;
+        }
+
+      if (later->msgid != NX_CLIMSG_MOUSEIN || later->wnd != mouse->wnd ||
+          later->buttons != mouse->buttons)
+        {
+          return true;
+        }
+
+      /* Same drag: Keep only the newer position */
+
+      mouse->pos = later->pos;
+    }
+
+  return false;
+}
+#endif
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nx_eventhandler
+ *
+ * Description:
+ *   The client code must call this function periodically to process
+ *   incoming messages from the server.  If CONFIG_NX_BLOCKING is defined,
+ *   then this function not return until a server message is received.
+ *
+ *   When CONFIG_NX_BLOCKING is not defined, the client must exercise
+ *   caution in the looping to assure that it does not eat up all of
+ *   the CPU bandwidth calling nx_eventhandler repeatedly.  nx_eventnotify
+ *   may be called to get a signal event whenever a new incoming server
+ *   event is available.
+ *
+ * Input Parameters:
+ *   handle - the handle returned by nx_connect
+ *
+ * Return:
+ *     OK: No errors occurred.  If CONFIG_NX_BLOCKING is defined, then
+ *         one or more server message was processed.
+ *  ERROR: An error occurred and errno has been set appropriately.  Of
+ *         particular interest, it will return errno == EHOSTDOWN when the
+ *         server is disconnected.  After that event, the handle can no
+ *         longer be used.
+ *
+ ****************************************************************************/
+
+int nx_eventhandler(NXHANDLE handle)
+{
+  FAR struct nxfe_conn_s *conn = (FAR struct nxfe_conn_s *)handle;
+  uint8_t                 buffer[NX_MXCLIMSGLEN];
+#ifdef CONFIG_NX_MOUSE_COALESCE
+  uint8_t                 next[NX_MXCLIMSGLEN];
+#endif
+  int                     nbytes;
+
+  /* Get the next message from our incoming message queue */
+
+  do
+    {
+      nbytes = mq_receive(conn->crdmq, buffer, NX_MXCLIMSGLEN, 0);
+      if (nbytes < 0)
+        {
+          /* EINTR is not an error.  The wait was interrupted by a signal and
+           * we just need to try reading again.
+           */
+
+          if (errno != EINTR)
+            {
+              if (errno == EAGAIN)
+                {
+                  /* EAGAIN is not an error.  It occurs because the MQ is opened with
+                   * O_NONBLOCK and there is no message available now.
+                   */
+
+                  return OK;
+                }
+              else
+                {
+                  gdbg("mq_receive failed: %d\n", errno);
+                  return ERROR;
+                }
+            }
+        }
+    }
+  while (nbytes < 0);
+
+  DEBUGASSERT(nbytes >= sizeof(struct nxclimsg_s));
+
+#ifdef CONFIG_NX_MOUSE_COALESCE
+  /* Merge queued moves into a mouse report before delivering it */
+
+  if (((FAR struct nxclimsg_s *)buffer)->msgid == NX_CLIMSG_MOUSEIN &&
+      nx_coalesce(conn, buffer, next))
+    {
+      if (nx_dispatch(conn, buffer) < 0)
+        {
+          return ERROR;
+        }
+
+      memcpy(buffer, next, NX_MXCLIMSGLEN);
+    }
+#endif
+
+  /* Dispatch the message appropriately */
+
+  if (nx_dispatch(conn, buffer) < 0)
+    {
+      return ERROR;
+    }
+
+  /* Send anything that the callback drew while batching */
+
+  (void)nxmu_flush(conn);
+
+  return OK;
+}
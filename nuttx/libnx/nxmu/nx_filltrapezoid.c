@@ -138,5 +138,5 @@ int nx_filltrapezoid(NXWINDOW hwnd, FAR const struct nxgl_rect_s *clip,
 
   /* Forward the trapezoid fill command to the server */
 
-  return nxmu_sendwindow(wnd, &outmsg, sizeof(struct nxsvrmsg_filltrapezoid_s));
+  return nxmu_queuewindow(wnd, &outmsg, sizeof(struct nxsvrmsg_filltrapezoid_s));
 }
@@ -43,6 +43,7 @@
 #include <errno.h>
 #include <debug.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/nx/nx.h>
 #include <nuttx/nx/nxmu.h>
 
@@ -93,6 +94,7 @@ int nx_mousein(NXHANDLE handle, nxgl_coord_t x, nxgl_coord_t y, uint8_t buttons)
   outmsg.pt.x    = x;
   outmsg.pt.y    = y;
   outmsg.buttons = buttons;
+  outmsg.time    = clock_systimer();
 
   return nxmu_sendserver(conn, &outmsg, sizeof(struct nxsvrmsg_mousein_s));
 }
@@ -111,5 +111,5 @@ int nx_move(NXWINDOW hwnd, FAR const struct nxgl_rect_s *rect,
 
   /* Forward the fill command to the server */
 
-  return nxmu_sendwindow(wnd, &outmsg, sizeof(struct nxsvrmsg_move_s));
+  return nxmu_queuewindow(wnd, &outmsg, sizeof(struct nxsvrmsg_move_s));
 }
@@ -0,0 +1,145 @@
+/****************************************************************************
+ * libnx/nxmu/nx_registersurface.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <semaphore.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxmu.h>
+
+#include "nxcontext.h"
+
+#ifdef CONFIG_NX_SURFACES
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nx_registersurface
+ *
+ * Description:
+ *   Register an image surface with the NX server so that later updates can
+ *   be sent with nx_surfaceblit() by handle and damage rectangle.
+ *
+ * Input Parameters:
+ *   handle - The handle returned by nx_connect
+ *   info   - Describes the surface image planes, size and stride
+ *
+ * Return:
+ *   Success: A non-NULL handle used with nx_surfaceblit()
+ *   Failure: NULL is returned and errno is set appropriately
+ *
+ ****************************************************************************/
+
+NXSURFACE nx_registersurface(NXHANDLE handle,
+                             FAR const struct nx_surfaceinfo_s *info)
+{
+  FAR struct nxfe_conn_s *conn = (FAR struct nxfe_conn_s *)handle;
+  FAR struct nxmu_surface_s *surf;
+  struct nxsvrmsg_regsurface_s outmsg;
+  sem_t sem_done;
+  int ret;
+
+#ifdef CONFIG_DEBUG
+  if (!conn || !info)
+    {
+      set_errno(EINVAL);
+      return NULL;
+    }
+#endif
+
+  /* Allocate the surface structure.  The server fills in the rest */
+
+  surf = (FAR struct nxmu_surface_s *)lib_uzalloc(sizeof(struct nxmu_surface_s));
+  if (!surf)
+    {
+      set_errno(ENOMEM);
+      return NULL;
+    }
+
+  surf->conn = conn;
+  surf->info = *info;
+
+  /* Format the registration command */
+
+  outmsg.msgid    = NX_SVRMSG_REGSURFACE;
+  outmsg.surf     = surf;
+  outmsg.sem_done = &sem_done;
+
+  ret = sem_init(&sem_done, 0, 0);
+  if (ret != OK)
+    {
+      gdbg("sem_init failed: %d\n", errno);
+      lib_ufree(surf);
+      return NULL;
+    }
+
+  /* Forward the command to the server and wait for it to attach the
+   * surface.  This is the only round trip for the lifetime of the surface.
+   */
+
+  ret = nxmu_sendserver(conn, &outmsg, sizeof(struct nxsvrmsg_regsurface_s));
+  if (ret == OK)
+    {
+      ret = sem_wait(&sem_done);
+    }
+
+  sem_destroy(&sem_done);
+
+  if (ret != OK)
+    {
+      lib_ufree(surf);
+      return NULL;
+    }
+
+  if (surf->result < 0)
+    {
+      gdbg("Surface registration failed: %d\n", surf->result);
+      set_errno(-surf->result);
+      lib_ufree(surf);
+      return NULL;
+    }
+
+  return (NXSURFACE)surf;
+}
+
+#endif /* CONFIG_NX_SURFACES */
@@ -98,6 +98,10 @@ int nx_releasebkgd(NXWINDOW hwnd)
     }
 #endif
 
+  /* Send any buffered drawing commands first so that they execute in order */
+
+  (void)nxmu_flush(wnd->conn);
+
   /* Request access to the background window from the server */
 
   outmsg.msgid = NX_SVRMSG_RELEASEBKGD;
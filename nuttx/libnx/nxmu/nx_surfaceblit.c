@@ -0,0 +1,103 @@
+/****************************************************************************
+ * libnx/nxmu/nx_surfaceblit.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxbe.h>
+#include <nuttx/nx/nxmu.h>
+
+#ifdef CONFIG_NX_SURFACES
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nx_surfaceblit
+ *
+ * Description:
+ *   Copy the damaged part of a registered surface into a window.  The
+ *   request is queued to the server and this function returns without
+ *   waiting for it to be processed.
+ *
+ * Input Parameters:
+ *   hwnd   - The window that will receive the image
+ *   hsurf  - The handle returned by nx_registersurface
+ *   dest   - The damaged region in window coordinates
+ *   origin - The position of the upper, left-most corner of the surface in
+ *            window coordinates.
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nx_surfaceblit(NXWINDOW hwnd, NXSURFACE hsurf,
+                   FAR const struct nxgl_rect_s *dest,
+                   FAR const struct nxgl_point_s *origin)
+{
+  FAR struct nxbe_window_s *wnd = (FAR struct nxbe_window_s *)hwnd;
+  struct nxsvrmsg_surfblit_s outmsg;
+
+#ifdef CONFIG_DEBUG
+  if (!wnd || !hsurf || !dest || !origin)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+#endif
+
+  /* Format the blit command */
+
+  outmsg.msgid    = NX_SVRMSG_SURFBLIT;
+  outmsg.wnd      = wnd;
+  outmsg.surf     = (FAR struct nxmu_surface_s *)hsurf;
+  outmsg.origin.x = origin->x;
+  outmsg.origin.y = origin->y;
+  nxgl_rectcopy(&outmsg.dest, dest);
+
+  /* Forward the blit command to the server */
+
+  return nxmu_sendwindow(wnd, &outmsg, sizeof(struct nxsvrmsg_surfblit_s));
+}
+
+#endif /* CONFIG_NX_SURFACES */
@@ -0,0 +1,117 @@
+/****************************************************************************
+ * libnx/nxmu/nx_unregistersurface.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <semaphore.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/nx/nx.h>
+#include <nuttx/nx/nxmu.h>
+
+#include "nxcontext.h"
+
+#ifdef CONFIG_NX_SURFACES
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nx_unregistersurface
+ *
+ * Description:
+ *   Release a surface registered with nx_registersurface().  The server
+ *   processes requests in order, so once it acknowledges the release all
+ *   earlier blits from the surface are complete.
+ *
+ * Input Parameters:
+ *   hsurf - The handle returned by nx_registersurface
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nx_unregistersurface(NXSURFACE hsurf)
+{
+  FAR struct nxmu_surface_s *surf = (FAR struct nxmu_surface_s *)hsurf;
+  struct nxsvrmsg_regsurface_s outmsg;
+  sem_t sem_done;
+  int ret;
+
+#ifdef CONFIG_DEBUG
+  if (!surf)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+#endif
+
+  outmsg.msgid    = NX_SVRMSG_UNREGSURFACE;
+  outmsg.surf     = surf;
+  outmsg.sem_done = &sem_done;
+
+  ret = sem_init(&sem_done, 0, 0);
+  if (ret != OK)
+    {
+      gdbg("sem_init failed: %d\n", errno);
+      return ret;
+    }
+
+  ret = nxmu_sendserver(surf->conn, &outmsg,
+                        sizeof(struct nxsvrmsg_regsurface_s));
+  if (ret == OK)
+    {
+      ret = sem_wait(&sem_done);
+    }
+
+  sem_destroy(&sem_done);
+
+  /* The server no longer references the surface structure */
+
+  if (ret == OK)
+    {
+      lib_ufree(surf);
+    }
+
+  return ret;
+}
+
+#endif /* CONFIG_NX_SURFACES */
@@ -0,0 +1,199 @@
+/****************************************************************************
+ * libnx/nxmu/nxmu_queuewindow.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <mqueue.h>
+#include <assert.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/nx/nxbe.h>
+#include <nuttx/nx/nxmu.h>
+
+#ifdef CONFIG_NX_BATCH
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: nxmu_flush
+ *
+ * Description:
+ *  Send any drawing commands buffered on the connection to the server.
+ *  This must be called before any other message is sent so that commands
+ *  are executed in the order in which they were issued.
+ *
+ * Input Parameters:
+ *   conn - A pointer to the server connection structure
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nxmu_flush(FAR struct nxfe_conn_s *conn)
+{
+  FAR struct nxmu_batch_s *batch = conn->batch;
+  FAR struct nxmu_batchbuf_s *buf;
+  struct nxsvrmsg_batch_s outmsg;
+  int ret;
+
+  if (!batch)
+    {
+      return OK;
+    }
+
+  buf = &batch->buf[batch->current];
+  if (buf->nbytes == 0)
+    {
+      return OK;
+    }
+
+  /* Hand the buffer to the server.  It stays busy until the server has
+   * executed every command in it.
+   */
+
+  outmsg.msgid = NX_SVRMSG_BATCH;
+  outmsg.batch = buf;
+  buf->busy    = true;
+
+  ret = nxmu_sendserver(conn, &outmsg, sizeof(struct nxsvrmsg_batch_s));
+  if (ret < 0)
+    {
+      /* The commands are lost, as they would have been if sent singly */
+
+      buf->busy   = false;
+      buf->nbytes = 0;
+      return ret;
+    }
+
+  /* Continue in the other buffer, waiting if the server has not yet
+   * finished the batch that was sent before this one.
+   */
+
+  batch->current ^= 1;
+  buf = &batch->buf[batch->current];
+
+  if (buf->busy)
+    {
+      nxmu_semtake(&buf->done);
+      buf->busy = false;
+    }
+
+  buf->nbytes = 0;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: nxmu_queuewindow
+ *
+ * Description:
+ *  Queue a drawing command destined for a specific window.  If batching is
+ *  enabled on the window's connection, the command is appended to the
+ *  current command buffer; otherwise it is sent with nxmu_sendwindow().
+ *
+ * Input Parameters:
+ *   wnd    - A pointer to the back-end window structure
+ *   msg    - A pointer to the message to send
+ *   msglen - The length of the message in bytes.
+ *
+ * Return:
+ *   OK on success; ERROR on failure with errno set appropriately
+ *
+ ****************************************************************************/
+
+int nxmu_queuewindow(FAR struct nxbe_window_s *wnd, FAR const void *msg,
+                     size_t msglen)
+{
+  FAR struct nxmu_batch_s *batch;
+  FAR struct nxmu_batchbuf_s *buf;
+  size_t cmdlen;
+  int ret;
+
+  /* Sanity checking */
+
+#ifdef CONFIG_DEBUG
+  if (!wnd || !wnd->conn)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+#endif
+
+  batch = wnd->conn->batch;
+  if (!batch)
+    {
+      return nxmu_sendwindow(wnd, msg, msglen);
+    }
+
+  /* Ignore commands destined to a blocked window (no errors reported) */
+
+  if (NXBE_ISBLOCKED(wnd))
+    {
+      return OK;
+    }
+
+  /* Send the current buffer if the command does not fit */
+
+  cmdlen = NX_BATCH_ALIGN(msglen);
+  DEBUGASSERT(cmdlen <= sizeof(batch->buf[0].data));
+
+  buf = &batch->buf[batch->current];
+  if (buf->nbytes + cmdlen > sizeof(buf->data))
+    {
+      ret = nxmu_flush(wnd->conn);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      buf = &batch->buf[batch->current];
+    }
+
+  /* Append the command */
+
+  memcpy((FAR uint8_t *)buf->data + buf->nbytes, msg, msglen);
+  buf->nbytes += cmdlen;
+  return OK;
+}
+
+#endif /* CONFIG_NX_BATCH */
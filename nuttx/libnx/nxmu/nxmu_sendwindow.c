@@ -106,9 +106,17 @@ int nxmu_sendwindow(FAR struct nxbe_window_s *wnd, FAR const void *msg,
 
   if (!NXBE_ISBLOCKED(wnd))
     {
-      /* Send the message to the server */
+      /* Send any buffered drawing commands first so that they execute in
+       * order with this message.
+       */
 
-      ret = nxmu_sendserver(wnd->conn, msg, msglen);
+      ret = nxmu_flush(wnd->conn);
+      if (ret == OK)
+        {
+          /* Send the message to the server */
+
+          ret = nxmu_sendserver(wnd->conn, msg, msglen);
+        }
     }
 
   return ret;
@@ -30,20 +30,44 @@
 
 #include <stdint.h>
 #include <stdlib.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
 #include <errno.h>
 #include <stddef.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 #include <nuttx/config.h>
 #include <nuttx/list.h>
 #include <nuttx/util.h>
 #include <nuttx/arch.h>
 #include <nuttx/bufram.h>
+#include <nuttx/kmalloc.h>
+#include <nuttx/fs/fs.h>
+#include <nuttx/fs/procfs.h>
 
 #include <arch/chip/chip.h>
 
 #define MM_BUCKET_MAX           31
 #define MM_CANARY               0xfab0fab0
 
+/*
+ * Smallest block handed out: the control header plus at least one byte of
+ * payload rounded up to a power of two.
+ */
+#define MM_MIN_ORDER            5
+
+/*
+ * One bit per block of each order telling whether that block is free, so
+ * that finding a buddy does not require walking the bucket. The per-order
+ * bitmaps are packed in mm_free_map, mm_free_map_offset giving the first
+ * word of each order.
+ */
+#define MM_BLOCK_COUNT(order)   (BUFRAM_SIZE >> (order))
+#define MM_MAP_WORDS \
+    ((BUFRAM_SIZE >> (MM_MIN_ORDER - 1)) / 32 + MM_BUCKET_MAX + 1)
+
 #ifdef CONFIG_MM_BUFRAM_DEBUG
 #define mm_warn(message...) lowsyslog(message)
 #else
@@ -51,6 +75,9 @@
 #endif
 
 static struct list_head mm_bucket[MM_BUCKET_MAX + 1];
+static size_t mm_free_count[MM_BUCKET_MAX + 1];
+static uint32_t mm_free_map[MM_MAP_WORDS];
+static uint16_t mm_free_map_offset[MM_BUCKET_MAX + 1];
 
 #ifdef CONFIG_MM_BUFRAM_DEBUG
 static size_t g_bufram_allocs;
@@ -89,26 +116,92 @@ static size_t order_to_size(int order)
     return 1 << order;
 }
 
+/**
+ * Locate the free bit of a block
+ * @return false if the block is out of the bufram range
+ */
+static bool mm_free_bit(struct mm_buffer *buffer, int order,
+                        uint32_t **word, uint32_t *mask)
+{
+    uintptr_t offset = (uintptr_t) buffer - BUFRAM_BASE;
+    size_t index;
+
+    if ((uintptr_t) buffer < BUFRAM_BASE || order < MM_MIN_ORDER ||
+        offset + order_to_size(order) > BUFRAM_SIZE)
+        return false;
+
+    index = offset >> order;
+    *word = &mm_free_map[mm_free_map_offset[order] + index / 32];
+    *mask = 1 << (index % 32);
+
+    return true;
+}
+
+static bool mm_is_free(struct mm_buffer *buffer, int order)
+{
+    uint32_t *word;
+    uint32_t mask;
+
+    if (!mm_free_bit(buffer, order, &word, &mask))
+        return false;
+
+    return *word & mask;
+}
+
+static void mm_bucket_add(struct mm_buffer *buffer, int order)
+{
+    uint32_t *word;
+    uint32_t mask;
+
+    buffer->bucket = order;
+    list_add(&mm_bucket[order], &buffer->list);
+    mm_free_count[order]++;
+
+    if (mm_free_bit(buffer, order, &word, &mask))
+        *word |= mask;
+}
+
+static void mm_bucket_del(struct mm_buffer *buffer)
+{
+    uint32_t *word;
+    uint32_t mask;
+
+    list_del(&buffer->list);
+    mm_free_count[buffer->bucket]--;
+
+    if (mm_free_bit(buffer, buffer->bucket, &word, &mask))
+        *word &= ~mask;
+}
+
 void bufram_register_region(uintptr_t base, unsigned order)
 {
     struct mm_buffer *buffer;
 
     buffer = (struct mm_buffer*) base;
-    buffer->bucket = order;
 #if defined(CONFIG_MM_BUFRAM_CANARY)
     buffer->canary = MM_CANARY;
 #endif
     list_init(&buffer->list);
 
-    list_add(&mm_bucket[buffer->bucket], &buffer->list);
+    mm_bucket_add(buffer, order);
 }
 
 void bufram_init(void)
 {
+    size_t offset = 0;
     int i;
 
-    for (i = 0; i < ARRAY_SIZE(mm_bucket); i++)
+    for (i = 0; i < ARRAY_SIZE(mm_bucket); i++) {
         list_init(&mm_bucket[i]);
+        mm_free_count[i] = 0;
+
+        mm_free_map_offset[i] = offset;
+        if (i >= MM_MIN_ORDER)
+            offset += (MM_BLOCK_COUNT(i) + 31) / 32;
+    }
+
+    DEBUGASSERT(offset <= ARRAY_SIZE(mm_free_map));
+    memset(mm_free_map, 0, sizeof(mm_free_map));
 }
 
 static inline void *get_buffer_payload(struct mm_buffer *buffer)
@@ -134,78 +227,54 @@ static struct mm_buffer *find_buffer_in_bucket(int order)
 
 static int fill_bucket(int order)
 {
-    struct mm_buffer *buffer1;
-    struct mm_buffer *buffer2;
-    int retval;
-
-    if (order > MM_BUCKET_MAX)
-        return -ENOMEM;
-
-    buffer1 = find_buffer_in_bucket(order + 1);
-    if (!buffer1) {
-        retval = fill_bucket(order + 1);
-        if (retval)
-            return retval;
+    struct mm_buffer *buffer;
+    struct mm_buffer *buddy;
+    int i;
 
-        buffer1 = find_buffer_in_bucket(order + 1);
-        DEBUGASSERT(buffer1);
+    for (i = order + 1; i <= MM_BUCKET_MAX; i++) {
+        if (!list_is_empty(&mm_bucket[i]))
+            break;
     }
 
-    list_del(&buffer1->list);
-
-    buffer2 = (struct mm_buffer*) ((char*) buffer1 + order_to_size(order));
-    list_init(&buffer2->list);
+    if (i > MM_BUCKET_MAX)
+        return -ENOMEM;
 
-    buffer1->bucket = order;
-    buffer2->bucket = order;
+    buffer = find_buffer_in_bucket(i);
+    mm_bucket_del(buffer);
 
+    /* Split down to the requested order, releasing the upper halves */
+    while (--i >= order) {
+        buddy = (struct mm_buffer*) ((char*) buffer + order_to_size(i));
+        list_init(&buddy->list);
 #if defined(CONFIG_MM_BUFRAM_CANARY)
-    buffer2->canary = buffer1->canary = MM_CANARY;
+        buddy->canary = MM_CANARY;
 #endif
+        mm_bucket_add(buddy, i);
+    }
 
-    list_add(&mm_bucket[order], &buffer1->list);
-    list_add(&mm_bucket[order], &buffer2->list);
+    mm_bucket_add(buffer, order);
 
     return 0;
 }
 
 static void defragment(struct mm_buffer *buffer)
 {
-    struct list_head *iter;
-    struct mm_buffer *buffer_low;
-    struct mm_buffer *buffer_high;
-    struct mm_buffer *buffer2;
-    struct mm_buffer *buffer3;
-
-    if (list_is_empty(&mm_bucket[buffer->bucket])) {
-        mm_warn("mm: trying to defragment empty bucket");
-        return;
-    }
-
-    if (((unsigned long) buffer) & (1 << buffer->bucket)) {
-        buffer_low = buffer2 = (struct mm_buffer*)
-            ((char*) buffer - order_to_size(buffer->bucket));
-        buffer_high = buffer;
-    } else {
-        buffer_low = buffer;
-        buffer_high = buffer2 = (struct mm_buffer*)
-            ((char*) buffer + order_to_size(buffer->bucket));
-    }
+    struct mm_buffer *buddy;
+    int order = buffer->bucket;
 
-    list_foreach(&mm_bucket[buffer->bucket], iter) {
-        buffer3 = list_entry(iter, struct mm_buffer, list);
-        if (buffer3 != buffer2)
-            continue;
+    while (order < MM_BUCKET_MAX) {
+        buddy = (struct mm_buffer*)
+            ((unsigned long) buffer ^ order_to_size(order));
+        if (!mm_is_free(buddy, order))
+            return;
 
-        list_del(&buffer_low->list);
-        list_del(&buffer_high->list);
+        mm_bucket_del(buddy);
+        mm_bucket_del(buffer);
 
-        buffer_low->bucket++;
-        list_add(&mm_bucket[buffer_low->bucket], &buffer_low->list);
+        if (buddy < buffer)
+            buffer = buddy;
 
-        defragment(buffer_low);
-
-        return;
+        mm_bucket_add(buffer, ++order);
     }
 }
 
@@ -255,7 +324,7 @@ void *bufram_alloc(size_t size)
     g_bufram_allocs++;
 #endif
 
-    list_del(&buffer->list);
+    mm_bucket_del(buffer);
     irqrestore(flags);
 
     return get_buffer_payload(buffer);
@@ -288,11 +357,17 @@ void bufram_free(void *ptr)
 
     flags = irqsave();
 
+    if (mm_is_free(buffer, buffer->bucket)) {
+        irqrestore(flags);
+        mm_warn("mm: double free of %p\n", ptr);
+        return;
+    }
+
 #ifdef CONFIG_MM_BUFRAM_DEBUG
     g_bufram_frees++;
 #endif
 
-    list_add(&mm_bucket[buffer->bucket], &buffer->list);
+    mm_bucket_add(buffer, buffer->bucket);
     defragment(buffer);
 
     irqrestore(flags);
@@ -369,4 +444,136 @@ void bufram_dump(void)
 
     irqrestore(flags);
 }
-#endif
\ No newline at end of file
+#endif
+
+#if !defined(CONFIG_DISABLE_MOUNTPOINT) && defined(CONFIG_FS_PROCFS) && \
+    !defined(CONFIG_FS_PROCFS_EXCLUDE_BUFRAM)
+
+#define BUFRAM_PROCFS_LINELEN   48
+#define BUFRAM_PROCFS_BUFLEN \
+    ((MM_BUCKET_MAX - MM_MIN_ORDER + 4) * BUFRAM_PROCFS_LINELEN)
+
+struct bufram_file_s {
+    struct procfs_file_s base;
+    size_t len;
+    char buf[BUFRAM_PROCFS_BUFLEN];
+};
+
+static size_t bufram_format(char *buf, size_t len)
+{
+    size_t count[MM_BUCKET_MAX + 1];
+    size_t total = 0;
+    size_t largest = 0;
+    size_t n;
+    irqstate_t flags;
+    int i;
+
+    flags = irqsave();
+    memcpy(count, mm_free_count, sizeof(count));
+    irqrestore(flags);
+
+    n = snprintf(buf, len, "%5s %7s %5s\n", "order", "size", "free");
+    for (i = MM_MIN_ORDER; i <= MM_BUCKET_MAX && n < len; i++) {
+        if (!MM_BLOCK_COUNT(i))
+            break;
+
+        n += snprintf(buf + n, len - n, "%5d %7u %5u\n", i,
+                      (unsigned int) order_to_size(i), (unsigned int) count[i]);
+
+        total += count[i] * order_to_size(i);
+        if (count[i])
+            largest = order_to_size(i);
+    }
+
+    /* Fragmentation: share of the free memory not in the largest block */
+    if (n < len) {
+        n += snprintf(buf + n, len - n,
+                      "free %u, largest %u, fragmentation %u%%\n",
+                      (unsigned int) total, (unsigned int) largest,
+                      total ? (unsigned int) (100 - largest * 100 / total) : 0);
+    }
+
+    return n < len ? n : len - 1;
+}
+
+static int bufram_open(FAR struct file *filep, FAR const char *relpath,
+                       int oflags, mode_t mode)
+{
+    FAR struct bufram_file_s *priv;
+
+    if ((oflags & O_WRONLY) != 0 || (oflags & O_RDONLY) == 0)
+        return -EACCES;
+
+    priv = kmm_zalloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    filep->f_priv = priv;
+    return OK;
+}
+
+static int bufram_close(FAR struct file *filep)
+{
+    kmm_free(filep->f_priv);
+    filep->f_priv = NULL;
+    return OK;
+}
+
+static ssize_t bufram_read(FAR struct file *filep, FAR char *buffer,
+                           size_t buflen)
+{
+    FAR struct bufram_file_s *priv = filep->f_priv;
+    off_t offset;
+    ssize_t ret;
+
+    /* Take a snapshot on the first read so that the content stays stable */
+    if (filep->f_pos == 0)
+        priv->len = bufram_format(priv->buf, BUFRAM_PROCFS_BUFLEN);
+
+    offset = filep->f_pos;
+    ret = procfs_memcpy(priv->buf, priv->len, buffer, buflen, &offset);
+    if (ret > 0)
+        filep->f_pos += ret;
+
+    return ret;
+}
+
+static int bufram_dup(FAR const struct file *oldp, FAR struct file *newp)
+{
+    FAR struct bufram_file_s *priv;
+
+    priv = kmm_malloc(sizeof(*priv));
+    if (!priv)
+        return -ENOMEM;
+
+    memcpy(priv, oldp->f_priv, sizeof(*priv));
+    newp->f_priv = priv;
+    return OK;
+}
+
+static int bufram_stat(FAR const char *relpath, FAR struct stat *buf)
+{
+    buf->st_mode    = S_IFREG | S_IROTH | S_IRGRP | S_IRUSR;
+    buf->st_size    = 0;
+    buf->st_blksize = 0;
+    buf->st_blocks  = 0;
+    return OK;
+}
+
+/* See fs_procfs.c -- this structure is explicitly externed there */
+const struct procfs_operations bufram_procfsoperations = {
+    bufram_open,        /* open */
+    bufram_close,       /* close */
+    bufram_read,        /* read */
+    NULL,               /* write */
+
+    bufram_dup,         /* dup */
+
+    NULL,               /* opendir */
+    NULL,               /* closedir */
+    NULL,               /* readdir */
+    NULL,               /* rewinddir */
+
+    bufram_stat         /* stat */
+};
+#endif
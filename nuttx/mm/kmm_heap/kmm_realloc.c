@@ -72,7 +72,9 @@
 
 FAR void *kmm_realloc(FAR void *oldmem, size_t newsize)
 {
-  return mm_realloc(&g_kmmheap, oldmem, newsize);
+  FAR void *mem = mm_realloc(&g_kmmheap, oldmem, newsize);
+  MM_PROFILE_TAG(mem);
+  return mem;
 }
 
 #endif /* CONFIG_MM_KERNEL_HEAP */
@@ -67,7 +67,9 @@
 
 FAR void *kmm_zalloc(size_t size)
 {
-  return mm_zalloc(&g_kmmheap, size);
+  FAR void *mem = mm_zalloc(&g_kmmheap, size);
+  MM_PROFILE_TAG(mem);
+  return mem;
 }
 
 #endif /* CONFIG_MM_KERNEL_HEAP */
@@ -0,0 +1,282 @@
+/****************************************************************************
+ * mm/mempool/mempool.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sched.h>
+#include <semaphore.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/mm/mempool.h>
+
+#ifdef CONFIG_MM_MEMPOOL
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* All pools that have been used, most recent first */
+
+static FAR struct mempool_s *g_mempools;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mempool_take
+ *
+ * Description:
+ *   Take a block from the free list, or else one that has never been used.
+ *   Called with interrupts disabled.
+ *
+ ****************************************************************************/
+
+static FAR void *mempool_take(FAR struct mempool_s *pool)
+{
+  FAR void *blk;
+
+  if (pool->freelist != NULL)
+    {
+      blk            = pool->freelist;
+      pool->freelist = *(FAR void **)blk;
+    }
+  else if (pool->ninit < pool->nblocks)
+    {
+      /* This avoids building the free list at initialization time, so that
+       * a pool defined with MEMPOOL_DEFINE() needs no initialization.
+       */
+
+      if (!pool->registered)
+        {
+          pool->flink      = g_mempools;
+          g_mempools       = pool;
+          pool->registered = true;
+        }
+
+      blk = pool->base + (size_t)pool->ninit * pool->bsize;
+      pool->ninit++;
+    }
+  else
+    {
+      return NULL;
+    }
+
+  pool->nalloc++;
+  if (++pool->nused > pool->peak)
+    {
+      pool->peak = pool->nused;
+    }
+
+  return blk;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mempool_initialize
+ ****************************************************************************/
+
+void mempool_initialize(FAR struct mempool_s *pool, FAR const char *name,
+                        FAR void *storage, size_t bsize, size_t nblocks)
+{
+  DEBUGASSERT(pool != NULL && storage != NULL && nblocks <= UINT16_MAX &&
+              MEMPOOL_BLOCKSIZE(bsize) <= UINT16_MAX &&
+              ((uintptr_t)storage & (sizeof(uintptr_t) - 1)) == 0);
+
+  memset(pool, 0, sizeof(struct mempool_s));
+  pool->name    = name;
+  pool->base    = (FAR uint8_t *)storage;
+  pool->bsize   = MEMPOOL_BLOCKSIZE(bsize);
+  pool->nblocks = nblocks;
+  (void)sem_init(&pool->waitsem, 0, 0);
+}
+
+/****************************************************************************
+ * Name: mempool_uninitialize
+ ****************************************************************************/
+
+void mempool_uninitialize(FAR struct mempool_s *pool)
+{
+  FAR struct mempool_s **prev;
+  irqstate_t flags;
+
+  DEBUGASSERT(pool->nused == 0 && !up_interrupt_context());
+
+  /* mempool_foreach() walks the list with the scheduler locked */
+
+  sched_lock();
+  flags = irqsave();
+
+  for (prev = &g_mempools; *prev != NULL; prev = &(*prev)->flink)
+    {
+      if (*prev == pool)
+        {
+          *prev = pool->flink;
+          break;
+        }
+    }
+
+  pool->registered = false;
+  irqrestore(flags);
+  sched_unlock();
+
+  (void)sem_destroy(&pool->waitsem);
+}
+
+/****************************************************************************
+ * Name: mempool_alloc
+ ****************************************************************************/
+
+FAR void *mempool_alloc(FAR struct mempool_s *pool, int timeout)
+{
+  struct timespec abstime;
+  irqstate_t flags;
+  FAR void *blk;
+  int ret;
+
+  if (timeout > 0)
+    {
+      (void)clock_gettime(CLOCK_REALTIME, &abstime);
+      abstime.tv_sec  += timeout / 1000;
+      abstime.tv_nsec += (long)(timeout % 1000) * 1000000;
+      if (abstime.tv_nsec >= 1000000000)
+        {
+          abstime.tv_sec++;
+          abstime.tv_nsec -= 1000000000;
+        }
+    }
+
+  flags = irqsave();
+  for (; ; )
+    {
+      blk = mempool_take(pool);
+      if (blk != NULL || timeout == MEMPOOL_NOWAIT)
+        {
+          break;
+        }
+
+      /* Wait for mempool_free().  Interrupts stay disabled until this
+       * thread is blocked, so a block freed in between is not missed.
+       */
+
+      DEBUGASSERT(!up_interrupt_context());
+
+      if (timeout < 0)
+        {
+          ret = sem_wait(&pool->waitsem);
+        }
+      else
+        {
+          ret = sem_timedwait(&pool->waitsem, &abstime);
+        }
+
+      if (ret < 0 && get_errno() != EINTR)
+        {
+          break;
+        }
+    }
+
+  if (blk == NULL)
+    {
+      pool->nfail++;
+    }
+
+  irqrestore(flags);
+  return blk;
+}
+
+/****************************************************************************
+ * Name: mempool_free
+ ****************************************************************************/
+
+void mempool_free(FAR struct mempool_s *pool, FAR void *blk)
+{
+  irqstate_t flags;
+  int sval;
+
+  DEBUGASSERT(blk != NULL && (FAR uint8_t *)blk >= pool->base &&
+              (FAR uint8_t *)blk < pool->base +
+                                   (size_t)pool->ninit * pool->bsize &&
+              ((FAR uint8_t *)blk - pool->base) % pool->bsize == 0);
+
+  flags = irqsave();
+
+  DEBUGASSERT(pool->nused > 0);
+  *(FAR void **)blk = pool->freelist;
+  pool->freelist    = blk;
+  pool->nused--;
+
+  /* A negative count is the number of threads blocked in mempool_alloc() */
+
+  if (sem_getvalue(&pool->waitsem, &sval) == OK && sval < 0)
+    {
+      (void)sem_post(&pool->waitsem);
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: mempool_foreach
+ ****************************************************************************/
+
+void mempool_foreach(mempool_handler_t handler, FAR void *arg)
+{
+  FAR struct mempool_s *pool;
+
+  /* Pools are only added to the head of the list, with interrupts
+   * disabled, and only removed with the scheduler locked.
+   */
+
+  sched_lock();
+  for (pool = g_mempools; pool != NULL; pool = pool->flink)
+    {
+      handler(pool, arg);
+    }
+
+  sched_unlock();
+}
+
+#endif /* CONFIG_MM_MEMPOOL */
@@ -43,6 +43,7 @@
 #include <nuttx/config.h>
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <semaphore.h>
 
 #include <arch/types.h>
@@ -95,9 +96,53 @@ struct gran_s
   sem_t      exclsem;   /* For exclusive access to the GAT */
 #endif
   uintptr_t  heapstart; /* The aligned start of the granule heap */
+#ifdef CONFIG_GRAN_LOCKFREE
+  uint16_t   hint[32];  /* Per size, GAT index to start searching from */
+#endif
   uint32_t   gat[1];    /* Start of the granule allocation table */
 };
 
+/****************************************************************************
+ * Inline Functions
+ ****************************************************************************/
+
+#ifdef CONFIG_GRAN_LOCKFREE
+/****************************************************************************
+ * Name: gran_claim and gran_unclaim
+ *
+ * Description:
+ *   Atomically set the 'mask' bits of a GAT entry if they are all clear,
+ *   or clear them.  This is what makes the GAT safe to update without a
+ *   critical section.
+ *
+ * Returned Value:
+ *   gran_claim() returns false if any of the bits was already set.
+ *
+ ****************************************************************************/
+
+static inline bool gran_claim(FAR uint32_t *gat, uint32_t mask)
+{
+  uint32_t curr;
+
+  do
+    {
+      curr = *(volatile uint32_t *)gat;
+      if ((curr & mask) != 0)
+        {
+          return false;
+        }
+    }
+  while (!__sync_bool_compare_and_swap(gat, curr, curr | mask));
+
+  return true;
+}
+
+static inline void gran_unclaim(FAR uint32_t *gat, uint32_t mask)
+{
+  (void)__sync_fetch_and_and(gat, ~mask);
+}
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -141,11 +186,13 @@ void gran_leave_critical(FAR struct gran_s *priv);
  *   ngranules - The number of granules allocated
  *
  * Returned Value:
- *   None
+ *   true if the granules were marked.  With CONFIG_GRAN_LOCKFREE, false if
+ *   some of them were taken by a concurrent allocation; nothing is marked
+ *   then.
  *
  ****************************************************************************/
 
-void gran_mark_allocated(FAR struct gran_s *priv, uintptr_t alloc,
+bool gran_mark_allocated(FAR struct gran_s *priv, uintptr_t alloc,
                          unsigned int ngranules);
 
 #endif /* __MM_MM_GRAN_MM_GRAN_H */
@@ -55,6 +55,92 @@
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_GRAN_LOCKFREE
+/****************************************************************************
+ * Name: gran_fast_alloc
+ *
+ * Description:
+ *   Allocate granules that fit within one GAT entry without entering a
+ *   critical section.  Each entry is checked for a long enough run of
+ *   free granules with a few word operations and claimed with a
+ *   compare-and-swap.  The search starts where the last allocation of the
+ *   same size succeeded.
+ *
+ * Input Parameters:
+ *   priv      - The granule heap state structure.
+ *   ngranules - The number of contiguous granules needed (1-32).
+ *
+ * Returned Value:
+ *   The address of the allocation or zero if no single GAT entry has room.
+ *
+ ****************************************************************************/
+
+static inline uintptr_t gran_fast_alloc(FAR struct gran_s *priv,
+                                        unsigned int ngranules)
+{
+  unsigned int ngat = SIZEOF_GAT(priv->ngranules);
+  unsigned int gatidx;
+  unsigned int count;
+  unsigned int len;
+  unsigned int shift;
+  uint32_t     mask;
+  uint32_t     curr;
+  uint32_t     avail;
+  int          bitidx;
+
+  mask   = 0xffffffff >> (32 - ngranules);
+  gatidx = priv->hint[ngranules - 1];
+  if (gatidx >= ngat)
+    {
+      gatidx = 0;
+    }
+
+  for (count = 0; count < ngat; count++)
+    {
+      curr = *(volatile uint32_t *)&priv->gat[gatidx];
+      while (curr != 0xffffffff)
+        {
+          /* Leave a bit set in 'avail' only where a run of ngranules free
+           * granules starts.  Zeros shifted in at the top keep runs from
+           * crossing into the next entry.
+           */
+
+          avail = ~curr;
+          for (len = 1; len < ngranules && avail != 0; len += shift)
+            {
+              shift  = len < ngranules - len ? len : ngranules - len;
+              avail &= avail >> shift;
+            }
+
+          if (avail == 0)
+            {
+              break;
+            }
+
+          bitidx = __builtin_ctz(avail);
+          if (__sync_bool_compare_and_swap(&priv->gat[gatidx], curr,
+                                           curr | (mask << bitidx)))
+            {
+              priv->hint[ngranules - 1] = gatidx;
+              return priv->heapstart +
+                     ((uintptr_t)((gatidx << 5) + bitidx) << priv->log2gran);
+            }
+
+          /* Lost a race with another allocation or free; look again */
+
+          curr = *(volatile uint32_t *)&priv->gat[gatidx];
+        }
+
+      if (++gatidx >= ngat)
+        {
+          gatidx = 0;
+        }
+    }
+
+  return 0;
+}
+#endif
+
 /****************************************************************************
  * Name: gran_common_alloc
  *
@@ -87,10 +173,6 @@ static inline FAR void *gran_common_alloc(FAR struct gran_s *priv, size_t size)
 
   if (priv && size > 0)
     {
-      /* Get exclusive access to the GAT */
-
-      gran_enter_critical(priv);
-
       /* How many contiguous granules we we need to find? */
 
       tmpmask   = (1 << priv->log2gran) - 1;
@@ -101,6 +183,24 @@ static inline FAR void *gran_common_alloc(FAR struct gran_s *priv, size_t size)
       DEBUGASSERT(ngranules <= 32);
       mask = 0xffffffff >> (32 - ngranules);
 
+#ifdef CONFIG_GRAN_LOCKFREE
+      /* Try the allocations that fit in one GAT entry first.  Only an
+       * allocation that must straddle two entries needs the full search
+       * below, which claims its granules atomically as well.  Neither
+       * needs exclusive access to the GAT.
+       */
+
+      alloc = gran_fast_alloc(priv, ngranules);
+      if (alloc != 0 || ngranules == 1)
+        {
+          return (FAR void *)alloc;
+        }
+#else
+      /* Get exclusive access to the GAT */
+
+      gran_enter_critical(priv);
+#endif
+
       /* Now search the granule allocation table for that number of contiguous */
 
       alloc = priv->heapstart;
@@ -215,19 +315,22 @@ static inline FAR void *gran_common_alloc(FAR struct gran_s *priv, size_t size)
                * of 'curr'.  Check if we have the allocation at this bit position.
                */
 
-              else if ((curr & mask) == 0)
+              else if ((curr & mask) == 0 &&
+                       gran_mark_allocated(priv, alloc, ngranules))
                 {
-                  /* Yes.. mark these granules allocated */
-
-                  gran_mark_allocated(priv, alloc, ngranules);
-
-                  /* And return the allocation address */
+                  /* Yes.. the granules are now marked allocated.  Return
+                   * the allocation address.
+                   */
 
+#ifndef CONFIG_GRAN_LOCKFREE
                   gran_leave_critical(priv);
+#endif
                   return (FAR void *)alloc;
                 }
 
-              /* The free allocation does not start at this position */
+              /* The free allocation does not start at this position (or,
+               * with CONFIG_GRAN_LOCKFREE, was just taken by someone else).
+               */
 
               else
                 {
@@ -245,9 +348,12 @@ static inline FAR void *gran_common_alloc(FAR struct gran_s *priv, size_t size)
               bitidx += shift;
             }
         }
+
+#ifndef CONFIG_GRAN_LOCKFREE
+      gran_leave_critical(priv);
+#endif
     }
 
-  gran_leave_critical(priv);
   return NULL;
 }
 
@@ -76,12 +76,19 @@ static inline void gran_common_free(FAR struct gran_s *priv,
   unsigned int ngranules;
   unsigned int avail;
   uint32_t     gatmask;
+#ifdef CONFIG_GRAN_LOCKFREE
+  unsigned int i;
+#endif
 
   DEBUGASSERT(priv && memory && size <= 32 * (1 << priv->log2gran));
 
-  /* Get exclusive access to the GAT */
+  /* Get exclusive access to the GAT.  With CONFIG_GRAN_LOCKFREE, the bits
+   * are cleared atomically instead.
+   */
 
+#ifndef CONFIG_GRAN_LOCKFREE
   gran_enter_critical(priv);
+#endif
 
   /* Determine the granule number of the first granule in the allocation */
 
@@ -99,6 +106,18 @@ static inline void gran_common_free(FAR struct gran_s *priv,
   granmask =  (1 << priv->log2gran) - 1;
   ngranules = (size + granmask) >> priv->log2gran;
 
+#ifdef CONFIG_GRAN_LOCKFREE
+  /* Let searches for this size or smaller start at the freed entry */
+
+  for (i = 0; i < ngranules; i++)
+    {
+      if (priv->hint[i] > gatidx)
+        {
+          priv->hint[i] = gatidx;
+        }
+    }
+#endif
+
   /* Clear bits in the GAT entry or entries */
 
   avail = 32 - gatbit;
@@ -109,7 +128,11 @@ static inline void gran_common_free(FAR struct gran_s *priv,
       gatmask = (0xffffffff << gatbit);
       DEBUGASSERT((priv->gat[gatidx] & gatmask) == gatmask);
 
+#ifdef CONFIG_GRAN_LOCKFREE
+      gran_unclaim(&priv->gat[gatidx], gatmask);
+#else
       priv->gat[gatidx] &= ~gatmask;
+#endif
       ngranules -= avail;
 
       /* Clear bits in the second GAT entry */
@@ -117,7 +140,11 @@ static inline void gran_common_free(FAR struct gran_s *priv,
       gatmask = 0xffffffff >> (32 - ngranules);
       DEBUGASSERT((priv->gat[gatidx+1] & gatmask) == gatmask);
 
+#ifdef CONFIG_GRAN_LOCKFREE
+      gran_unclaim(&priv->gat[gatidx+1], gatmask);
+#else
       priv->gat[gatidx+1] &= ~gatmask;
+#endif
     }
 
   /* Handle the case where where all of the granules came from one entry */
@@ -130,10 +157,16 @@ static inline void gran_common_free(FAR struct gran_s *priv,
       gatmask <<= gatbit;
       DEBUGASSERT((priv->gat[gatidx] & gatmask) == gatmask);
 
+#ifdef CONFIG_GRAN_LOCKFREE
+      gran_unclaim(&priv->gat[gatidx], gatmask);
+#else
       priv->gat[gatidx] &= ~gatmask;
+#endif
     }
 
+#ifndef CONFIG_GRAN_LOCKFREE
   gran_leave_critical(priv);
+#endif
 }
 
 /****************************************************************************
@@ -141,6 +141,17 @@ gran_common_initialize(FAR void *heapstart, size_t heapsize, uint8_t log2gran,
 #ifndef CONFIG_GRAN_INTR
       sem_init(&priv->exclsem, 0, 1);
 #endif
+
+#ifdef CONFIG_GRAN_LOCKFREE
+      /* Mark the unused bits of the last GAT entry allocated so that the
+       * single entry search never has to check the heap size.
+       */
+
+      if ((ngranules & 31) != 0)
+        {
+          priv->gat[ngranules >> 5] = 0xffffffff << (ngranules & 31);
+        }
+#endif
     }
 
   return priv;
@@ -71,11 +71,13 @@
  *   ngranules - The number of granules allocated
  *
  * Returned Value:
- *   None
+ *   true if the granules were marked.  With CONFIG_GRAN_LOCKFREE, false if
+ *   some of them were taken by a concurrent allocation; nothing is marked
+ *   then.
  *
  ****************************************************************************/
 
-void gran_mark_allocated(FAR struct gran_s *priv, uintptr_t alloc,
+bool gran_mark_allocated(FAR struct gran_s *priv, uintptr_t alloc,
                          unsigned int ngranules)
 {
   unsigned int granno;
@@ -98,20 +100,35 @@ void gran_mark_allocated(FAR struct gran_s *priv, uintptr_t alloc,
   avail = 32 - gatbit;
   if (ngranules > avail)
     {
-      /* Mark bits in the first GAT entry */
+      uint32_t firstmask;
 
-      gatmask =0xffffffff << gatbit;
-      DEBUGASSERT((priv->gat[gatidx] & gatmask) == 0);
+      /* Mark bits in the first GAT entry */
 
-      priv->gat[gatidx] |= gatmask;
+      firstmask = 0xffffffff << gatbit;
       ngranules -= avail;
 
       /* Mark bits in the second GAT entry */
 
       gatmask = 0xffffffff >> (32 - ngranules);
-      DEBUGASSERT((priv->gat[gatidx+1] & gatmask) == 0);
 
+#ifdef CONFIG_GRAN_LOCKFREE
+      if (!gran_claim(&priv->gat[gatidx], firstmask))
+        {
+          return false;
+        }
+
+      if (!gran_claim(&priv->gat[gatidx+1], gatmask))
+        {
+          gran_unclaim(&priv->gat[gatidx], firstmask);
+          return false;
+        }
+#else
+      DEBUGASSERT((priv->gat[gatidx] & firstmask) == 0);
+      priv->gat[gatidx] |= firstmask;
+
+      DEBUGASSERT((priv->gat[gatidx+1] & gatmask) == 0);
       priv->gat[gatidx+1] |= gatmask;
+#endif
     }
 
   /* Handle the case where where all of the granules come from one entry */
@@ -122,11 +139,16 @@ void gran_mark_allocated(FAR struct gran_s *priv, uintptr_t alloc,
 
       gatmask   = 0xffffffff >> (32 - ngranules);
       gatmask <<= gatbit;
-      DEBUGASSERT((priv->gat[gatidx] & gatmask) == 0);
 
+#ifdef CONFIG_GRAN_LOCKFREE
+      return gran_claim(&priv->gat[gatidx], gatmask);
+#else
+      DEBUGASSERT((priv->gat[gatidx] & gatmask) == 0);
       priv->gat[gatidx] |= gatmask;
-      return;
+#endif
     }
+
+  return true;
 }
 
 #endif /* CONFIG_GRAN */
@@ -99,7 +99,7 @@ static inline void gran_common_reserve(FAR struct gran_s *priv,
 
       /* And reserve the granules */
 
-      gran_mark_allocated(priv, start, ngranules);
+      (void)gran_mark_allocated(priv, start, ngranules);
     }
 }
 
@@ -62,6 +62,34 @@
  *
  ****************************************************************************/
 
+#ifdef CONFIG_MM_TLSF
+void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+  FAR struct mm_freenode_s *next;
+  int ndx = mm_size2ndx(node->size);
+
+  /* Push the node onto the head of the list for its size class.  All nodes
+   * of one class are interchangeable for mm_findfreechunk(), so the list
+   * does not need to be sorted.
+   */
+
+  next        = heap->mm_freelist[ndx];
+  node->blink = NULL;
+  node->flink = next;
+
+  if (next)
+    {
+      next->blink = node;
+    }
+
+  heap->mm_freelist[ndx] = node;
+
+  /* Mark the list and its first level as non-empty */
+
+  heap->mm_slbitmap[ndx / MM_TLSF_SLCOUNT] |= 1 << (ndx % MM_TLSF_SLCOUNT);
+  heap->mm_flbitmap |= 1 << (ndx / MM_TLSF_SLCOUNT);
+}
+#else
 void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
 {
   FAR struct mm_freenode_s *next;
@@ -90,3 +118,4 @@ void mm_addfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
       next->blink = node;
     }
 }
+#endif
@@ -0,0 +1,160 @@
+/****************************************************************************
+ * mm/mm_heap/mm_coalesce.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+#include <debug.h>
+
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_IDLE_COALESCE
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_coalesce
+ *
+ * Description:
+ *   Merge every run of adjacent free chunks in the heap into a single free
+ *   chunk.  This is intended to be called from the IDLE loop:  a region
+ *   is skipped if its heap lock is held.
+ *
+ * Returned Value:
+ *   The number of bytes merged into a preceding free chunk by this pass.
+ *
+ ****************************************************************************/
+
+size_t mm_coalesce(FAR struct mm_heap_s *heap)
+{
+  FAR struct mm_freenode_s *node;
+  FAR struct mm_freenode_s *next;
+  FAR struct mm_allocnode_s *andx;
+  size_t merged = 0;
+  size_t largest = 0;
+  bool removed;
+#if CONFIG_MM_REGIONS > 1
+  int region;
+#else
+# define region 0
+#endif
+
+#if CONFIG_MM_REGIONS > 1
+  for (region = 0; region < heap->mm_nregions; region++)
+#endif
+    {
+      if (mm_trysemaphore(heap) != OK)
+        {
+#if CONFIG_MM_REGIONS > 1
+          continue;
+#else
+          return 0;
+#endif
+        }
+
+      for (andx = heap->mm_heapstart[region];
+           andx < heap->mm_heapend[region];
+           andx = (FAR struct mm_allocnode_s *)((FAR char *)andx + andx->size))
+        {
+          if ((andx->preceding & MM_ALLOC_BIT) != 0)
+            {
+              continue;
+            }
+
+          /* Absorb all of the free chunks that follow this one */
+
+          node    = (FAR struct mm_freenode_s *)andx;
+          removed = false;
+
+          for (; ; )
+            {
+              next = (FAR struct mm_freenode_s *)((FAR char *)node + node->size);
+              if ((next->preceding & MM_ALLOC_BIT) != 0)
+                {
+                  break;
+                }
+
+              if (!removed)
+                {
+                  mm_remfreechunk(heap, node);
+                  removed = true;
+                }
+
+              mm_remfreechunk(heap, next);
+              merged     += next->size;
+              node->size += next->size;
+            }
+
+          if (removed)
+            {
+              /* Link the chunk after the merged run back to it */
+
+              next->preceding = (next->preceding & MM_ALLOC_BIT) |
+                                ((FAR char *)next - (FAR char *)node);
+              mm_addfreechunk(heap, node);
+            }
+
+          if (node->size > largest)
+            {
+              largest = node->size;
+            }
+        }
+
+      mm_givesemaphore(heap);
+    }
+#undef region
+
+  if (merged > 0)
+    {
+      mvdbg("Coalesced %u bytes\n", (unsigned int)merged);
+    }
+
+  mm_takesemaphore(heap);
+  heap->mm_reclaimed += merged;
+  if (largest < heap->mm_mxordblk_min)
+    {
+      heap->mm_mxordblk_min = largest;
+    }
+
+  mm_givesemaphore(heap);
+  return merged;
+}
+
+#endif /* CONFIG_MM_IDLE_COALESCE */
@@ -0,0 +1,135 @@
+/****************************************************************************
+ * mm/mm_heap/mm_findfreechunk.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_TLSF
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_findfreechunk
+ *
+ * Description:
+ *   Find a free chunk of at least 'size' bytes in constant time.  The
+ *   request is first rounded up to the next size class boundary so that
+ *   any chunk on the first non-empty list found is large enough; the
+ *   chunk is not removed from its list.  It is assumed that the caller
+ *   holds the mm semaphore.
+ *
+ * Returned Value:
+ *   The free node or NULL if no free chunk is large enough.
+ *
+ ****************************************************************************/
+
+FAR struct mm_freenode_s *mm_findfreechunk(FAR struct mm_heap_s *heap,
+                                           size_t size)
+{
+  FAR struct mm_freenode_s *node;
+  uint32_t bitmap;
+  size_t search = size;
+  int ndx;
+  int fl;
+  int sl;
+
+  /* Round the size up to the start of the next second level class */
+
+  if (size >= MM_TLSF_SMALL)
+    {
+      search += ((size_t)1 << (31 - __builtin_clz(size) - MM_TLSF_SLI)) - 1;
+    }
+
+  ndx = mm_size2ndx(search);
+  fl  = ndx / MM_TLSF_SLCOUNT;
+  sl  = ndx % MM_TLSF_SLCOUNT;
+
+  /* Look for a non-empty list at or above that class, first in the same
+   * first level and then in any larger one.
+   */
+
+  bitmap = heap->mm_slbitmap[fl] & (~(uint32_t)0 << sl);
+  if (bitmap == 0)
+    {
+      bitmap = (fl + 1 < MM_TLSF_FLCOUNT) ?
+               heap->mm_flbitmap & (~(uint32_t)0 << (fl + 1)) : 0;
+      if (bitmap != 0)
+        {
+          fl     = __builtin_ctz(bitmap);
+          bitmap = heap->mm_slbitmap[fl];
+        }
+    }
+
+  if (bitmap != 0)
+    {
+      ndx = fl * MM_TLSF_SLCOUNT + __builtin_ctz(bitmap);
+
+      /* Every chunk on the list fits unless this is the last list, which
+       * also collects everything larger than its nominal class.
+       */
+
+      for (node = heap->mm_freelist[ndx]; node; node = node->flink)
+        {
+          if (node->size >= size)
+            {
+              return node;
+            }
+        }
+    }
+
+  /* Rounding up can skip over a chunk in the request's own class that is
+   * still large enough.  Check that list before failing.
+   */
+
+  for (node = heap->mm_freelist[mm_size2ndx(size)]; node; node = node->flink)
+    {
+      if (node->size >= size)
+        {
+          return node;
+        }
+    }
+
+  return NULL;
+}
+
+#endif /* CONFIG_MM_TLSF */
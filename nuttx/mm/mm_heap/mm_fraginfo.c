@@ -0,0 +1,142 @@
+/****************************************************************************
+ * mm/mm_heap/mm_fraginfo.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+#include <assert.h>
+
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_FRAGINFO
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_fragclass
+ *
+ * Description:
+ *   Return the power of two size class of a free chunk.  This does not use
+ *   mm_size2ndx() because that follows the free list layout, which is not
+ *   a power of two ladder when TLSF is selected.
+ *
+ ****************************************************************************/
+
+static inline int mm_fragclass(size_t size)
+{
+  int ndx = 0;
+
+  size >>= MM_MIN_SHIFT;
+  while (size > 1 && ndx < MM_NNODES - 1)
+    {
+      size >>= 1;
+      ndx++;
+    }
+
+  return ndx;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_fraginfo
+ *
+ * Description:
+ *   Count the free chunks of the heap by size class and report the largest
+ *   free chunk together with its lowest value seen so far.
+ *
+ ****************************************************************************/
+
+void mm_fraginfo(FAR struct mm_heap_s *heap, FAR struct mm_fraginfo_s *info)
+{
+  FAR struct mm_allocnode_s *node;
+  size_t largest = 0;
+#if CONFIG_MM_REGIONS > 1
+  int region;
+#else
+# define region 0
+#endif
+
+  DEBUGASSERT(info);
+  memset(info, 0, sizeof(struct mm_fraginfo_s));
+
+#if CONFIG_MM_REGIONS > 1
+  for (region = 0; region < heap->mm_nregions; region++)
+#endif
+    {
+      /* Retake the semaphore for each region to reduce latencies */
+
+      mm_takesemaphore(heap);
+
+      for (node = heap->mm_heapstart[region];
+           node < heap->mm_heapend[region];
+           node = (FAR struct mm_allocnode_s *)((FAR char *)node + node->size))
+        {
+          if ((node->preceding & MM_ALLOC_BIT) == 0)
+            {
+              info->nfree[mm_fragclass(node->size)]++;
+              if (node->size > largest)
+                {
+                  largest = node->size;
+                }
+            }
+        }
+
+      mm_givesemaphore(heap);
+    }
+#undef region
+
+  mm_takesemaphore(heap);
+  if (largest < heap->mm_mxordblk_min)
+    {
+      heap->mm_mxordblk_min = largest;
+    }
+
+  info->largest     = largest;
+  info->largest_min = heap->mm_mxordblk_min;
+#ifdef CONFIG_MM_IDLE_COALESCE
+  info->reclaimed   = heap->mm_reclaimed;
+#endif
+  mm_givesemaphore(heap);
+}
+
+#endif /* CONFIG_MM_FRAGINFO */
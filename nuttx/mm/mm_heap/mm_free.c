@@ -107,6 +107,15 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
       return;
     }
 
+#ifdef CONFIG_MM_TCACHE
+  /* Small chunks go back to the calling thread's cache */
+
+  if (mm_tcache_free(heap, mem))
+    {
+      return;
+    }
+#endif
+
   /* We need to hold the MM semaphore while we muck with the
    * nodelist.
    */
@@ -118,6 +127,10 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
   node = (FAR struct mm_freenode_s *)((char*)mem - SIZEOF_MM_ALLOCNODE);
   node->preceding &= ~MM_ALLOC_BIT;
 
+#ifdef CONFIG_MM_PROFILE
+  heap->mm_nfrees++;
+#endif
+
   /* Check if the following node is free and, if so, merge it */
 
   next = (FAR struct mm_freenode_s *)((char*)node + node->size);
@@ -132,16 +145,9 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
 
       andbeyond = (FAR struct mm_allocnode_s*)((char*)next + next->size);
 
-      /* Remove the next node.  There must be a predecessor,
-       * but there may not be a successor node.
-       */
+      /* Remove the next node from its free list */
 
-      DEBUGASSERT(next->blink);
-      next->blink->flink = next->flink;
-      if (next->flink)
-        {
-          next->flink->blink = next->blink;
-        }
+      mm_remfreechunk(heap, next);
 
       /* Then merge the two chunks */
 
@@ -157,16 +163,9 @@ void mm_free(FAR struct mm_heap_s *heap, FAR void *mem)
   prev = (FAR struct mm_freenode_s *)((char*)node - node->preceding);
   if ((prev->preceding & MM_ALLOC_BIT) == 0)
     {
-      /* Remove the node.  There must be a predecessor, but there may
-       * not be a successor node.
-       */
+      /* Remove the node from its free list */
 
-      DEBUGASSERT(prev->blink);
-      prev->blink->flink = prev->flink;
-      if (prev->flink)
-        {
-          prev->flink->blink = prev->blink;
-        }
+      mm_remfreechunk(heap, prev);
 
       /* Then merge the two chunks */
 
@@ -167,7 +167,9 @@ void mm_addregion(FAR struct mm_heap_s *heap, FAR void *heapstart,
 void mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart,
                    size_t heapsize)
 {
+#ifndef CONFIG_MM_TLSF
   int i;
+#endif
 
   mlldbg("Heap: start=%p size=%u\n", heapstart, heapsize);
 
@@ -185,18 +187,38 @@ void mm_initialize(FAR struct mm_heap_s *heap, FAR void *heapstart,
 
   heap->mm_heapsize = 0;
 
+#ifdef CONFIG_MM_PROFILE
+  heap->mm_nallocs    = 0;
+  heap->mm_nfrees     = 0;
+  heap->mm_allocbytes = 0;
+#endif
+
+#ifdef CONFIG_MM_FRAGINFO
+  heap->mm_mxordblk_min = (size_t)-1;
+#endif
+
+#ifdef CONFIG_MM_IDLE_COALESCE
+  heap->mm_reclaimed = 0;
+#endif
+
 #if CONFIG_MM_REGIONS > 1
   heap->mm_nregions = 0;
 #endif
 
   /* Initialize the node array */
 
+#ifdef CONFIG_MM_TLSF
+  heap->mm_flbitmap = 0;
+  memset(heap->mm_slbitmap, 0, sizeof(heap->mm_slbitmap));
+  memset(heap->mm_freelist, 0, sizeof(heap->mm_freelist));
+#else
   memset(heap->mm_nodelist, 0, sizeof(struct mm_freenode_s) * MM_NNODES);
   for (i = 1; i < MM_NNODES; i++)
     {
       heap->mm_nodelist[i-1].flink = &heap->mm_nodelist[i];
       heap->mm_nodelist[i].blink   = &heap->mm_nodelist[i-1];
     }
+#endif
 
   /* Initialize the malloc semaphore to one (to support one-at-
    * a-time access to private data sets).
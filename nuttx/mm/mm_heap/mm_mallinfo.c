@@ -131,6 +131,16 @@ int mm_mallinfo(FAR struct mm_heap_s *heap, FAR struct mallinfo *info)
 
   DEBUGASSERT(uordblks + fordblks == heap->mm_heapsize);
 
+#ifdef CONFIG_MM_FRAGINFO
+  mm_takesemaphore(heap);
+  if (mxordblk < heap->mm_mxordblk_min)
+    {
+      heap->mm_mxordblk_min = mxordblk;
+    }
+
+  mm_givesemaphore(heap);
+#endif
+
   info->arena    = heap->mm_heapsize;
   info->ordblks  = ordblks;
   info->mxordblk = mxordblk;
@@ -87,7 +87,9 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 {
   FAR struct mm_freenode_s *node;
   void *ret = NULL;
+#ifndef CONFIG_MM_TLSF
   int ndx;
+#endif
 
   /* Handle bad sizes */
 
@@ -102,10 +104,26 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
   size = MM_ALIGN_UP(size + SIZEOF_MM_ALLOCNODE);
 
+#ifdef CONFIG_MM_TCACHE
+  /* Small requests are served from the calling thread's cache */
+
+  ret = mm_tcache_alloc(heap, size);
+  if (ret)
+    {
+      MM_PROFILE_TAG(ret);
+      return ret;
+    }
+#endif
+
   /* We need to hold the MM semaphore while we muck with the nodelist. */
 
   mm_takesemaphore(heap);
 
+#ifdef CONFIG_MM_TLSF
+  /* Find a free chunk whose size class guarantees a fit */
+
+  node = mm_findfreechunk(heap, size);
+#else
   /* Get the location in the node list to start the search. Special case
    * really big allocations
    */
@@ -129,6 +147,7 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
   for (node = heap->mm_nodelist[ndx].flink;
        node && node->size < size;
        node = node->flink);
+#endif
 
   /* If we found a node with non-zero size, then this is one to use. Since
    * the list is ordered, we know that is must be best fitting chunk
@@ -141,16 +160,9 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
       FAR struct mm_freenode_s *next;
       size_t remaining;
 
-      /* Remove the node.  There must be a predecessor, but there may not be
-       * a successor node.
-       */
+      /* Remove the node from its free list */
 
-      DEBUGASSERT(node->blink);
-      node->blink->flink = node->flink;
-      if (node->flink)
-        {
-          node->flink->blink = node->blink;
-        }
+      mm_remfreechunk(heap, node);
 
       /* Check if we have to split the free node into one of the allocated
        * size and another smaller freenode.  In some cases, the remaining
@@ -191,6 +203,12 @@ FAR void *mm_malloc(FAR struct mm_heap_s *heap, size_t size)
 
       node->preceding |= MM_ALLOC_BIT;
       ret = (void*)((char*)node + SIZEOF_MM_ALLOCNODE);
+
+#ifdef CONFIG_MM_PROFILE
+      heap->mm_nallocs++;
+      heap->mm_allocbytes += node->size;
+      MM_PROFILE_TAG(ret);
+#endif
     }
 
   mm_givesemaphore(heap);
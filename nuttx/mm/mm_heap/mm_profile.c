@@ -0,0 +1,118 @@
+/****************************************************************************
+ * mm/mm_heap/mm_profile.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <unistd.h>
+#include <assert.h>
+
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_PROFILE
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_profile_tag
+ *
+ * Description:
+ *   Record the calling thread and the caller's return address in the
+ *   header of an allocated chunk.  Normally used through MM_PROFILE_TAG()
+ *   so that the outermost allocation function wins.
+ *
+ ****************************************************************************/
+
+void mm_profile_tag(FAR void *mem, FAR void *caller)
+{
+  FAR struct mm_allocnode_s *node;
+
+  if (mem)
+    {
+      node = (FAR struct mm_allocnode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+      node->caller = caller;
+      node->pid    = getpid();
+    }
+}
+
+/****************************************************************************
+ * Name: mm_profile
+ *
+ * Description:
+ *   Call 'handler' for every allocated chunk of the heap, the guard nodes
+ *   excluded.  The heap is held while each region is visited, so the
+ *   handler must be short and must not allocate.
+ *
+ ****************************************************************************/
+
+void mm_profile(FAR struct mm_heap_s *heap, mm_profile_t handler,
+                FAR void *arg)
+{
+  FAR struct mm_allocnode_s *node;
+#if CONFIG_MM_REGIONS > 1
+  int region;
+#else
+# define region 0
+#endif
+
+  DEBUGASSERT(handler);
+
+#if CONFIG_MM_REGIONS > 1
+  for (region = 0; region < heap->mm_nregions; region++)
+#endif
+    {
+      mm_takesemaphore(heap);
+
+      for (node = (FAR struct mm_allocnode_s *)
+                  ((FAR char *)heap->mm_heapstart[region] + SIZEOF_MM_ALLOCNODE);
+           node < heap->mm_heapend[region];
+           node = (FAR struct mm_allocnode_s *)((FAR char *)node + node->size))
+        {
+          if ((node->preceding & MM_ALLOC_BIT) != 0)
+            {
+              handler(node, arg);
+            }
+        }
+
+      mm_givesemaphore(heap);
+    }
+#undef region
+}
+
+#endif /* CONFIG_MM_PROFILE */
@@ -79,6 +79,10 @@
  *  extended, then malloc a new buffer, copy the data into the new buffer,
  *  and free the old buffer.
  *
+ *  With CONFIG_MM_REALLOC_GROWTH, growing allocations also reserve half
+ *  again the requested size for later growth, and small reductions keep
+ *  the slack.
+ *
  ****************************************************************************/
 
 FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
@@ -90,6 +94,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
   size_t oldsize;
   size_t prevsize = 0;
   size_t nextsize = 0;
+#ifdef CONFIG_MM_REALLOC_GROWTH
+  size_t reserve;
+#endif
   FAR void *newmem;
 
   /* If oldmem is NULL, then realloc is equivalent to malloc */
@@ -127,10 +134,15 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
   if (size <= oldsize)
     {
       /* Handle the special case where we are not going to change the size
-       * of the allocation.
+       * of the allocation.  When growing geometrically, keep the slack
+       * unless at least half of the chunk would be unused.
        */
 
+#ifdef CONFIG_MM_REALLOC_GROWTH
+      if (oldsize - size >= (oldsize >> 1))
+#else
       if (size < oldsize)
+#endif
         {
           mm_shrinkchunk(heap, oldnode, size);
         }
@@ -146,6 +158,10 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
    * best decision
    */
 
+#ifdef CONFIG_MM_REALLOC_GROWTH
+  reserve = MM_ALIGN_UP(size + (size >> 1));
+#endif
+
   next = (FAR struct mm_freenode_s *)((FAR char*)oldnode + oldnode->size);
   if ((next->preceding & MM_ALLOC_BIT) == 0)
     {
@@ -220,6 +236,24 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
             }
         }
 
+#ifdef CONFIG_MM_REALLOC_GROWTH
+      /* Take the reserve for later growth from what is left of the next
+       * chunk.
+       */
+
+      if (nextsize > takenext)
+        {
+          if (nextsize - takenext > reserve - size)
+            {
+              takenext += reserve - size;
+            }
+          else
+            {
+              takenext = nextsize;
+            }
+        }
+#endif
+
       /* Extend into the previous free chunk */
 
       newmem = oldmem;
@@ -227,16 +261,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
         {
           FAR struct mm_allocnode_s *newnode;
 
-          /* Remove the previous node.  There must be a predecessor, but
-           * there may not be a successor node.
-           */
+          /* Remove the previous node from its free list */
 
-          DEBUGASSERT(prev->blink);
-          prev->blink->flink = prev->flink;
-          if (prev->flink)
-            {
-              prev->flink->blink = prev->blink;
-            }
+          mm_remfreechunk(heap, prev);
 
           /* Extend the node into the previous free chunk */
 
@@ -275,12 +302,12 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
           oldnode = newnode;
           oldsize = newnode->size;
 
-          /* Now we have to move the user contents 'down' in memory.  memcpy should
-           * should be save for this.
+          /* Now we have to move the user contents 'down' in memory.  The
+           * old and new locations may overlap.
            */
 
           newmem = (FAR void*)((FAR char*)newnode + SIZEOF_MM_ALLOCNODE);
-          memcpy(newmem, oldmem, oldsize - SIZEOF_MM_ALLOCNODE);
+          memmove(newmem, oldmem, oldsize - takeprev - SIZEOF_MM_ALLOCNODE);
         }
 
       /* Extend into the next free chunk */
@@ -296,16 +323,9 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
 
           andbeyond = (FAR struct mm_allocnode_s*)((char*)next + nextsize);
 
-          /* Remove the next node.  There must be a predecessor, but there
-           * may not be a successor node.
-           */
+          /* Remove the next node from its free list */
 
-          DEBUGASSERT(next->blink);
-          next->blink->flink = next->flink;
-          if (next->flink)
-            {
-              next->flink->blink = next->blink;
-            }
+          mm_remfreechunk(heap, next);
 
           /* Extend the node into the next chunk */
 
@@ -349,10 +369,18 @@ FAR void *mm_realloc(FAR struct mm_heap_s *heap, FAR void *oldmem,
        */
 
       mm_givesemaphore(heap);
-      newmem = (FAR void*)mm_malloc(heap, size);
+
+#ifdef CONFIG_MM_REALLOC_GROWTH
+      newmem = (FAR void*)mm_malloc(heap, reserve - SIZEOF_MM_ALLOCNODE);
+      if (!newmem)
+#endif
+        {
+          newmem = (FAR void*)mm_malloc(heap, size - SIZEOF_MM_ALLOCNODE);
+        }
+
       if (newmem)
         {
-          memcpy(newmem, oldmem, oldsize);
+          memcpy(newmem, oldmem, oldsize - SIZEOF_MM_ALLOCNODE);
           mm_free(heap, oldmem);
         }
 
@@ -0,0 +1,105 @@
+/****************************************************************************
+ * mm/mm_heap/mm_remfreechunk.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <assert.h>
+
+#include <nuttx/mm/mm.h>
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_remfreechunk
+ *
+ * Description:
+ *   Remove a free chunk from the free list that holds it.  It is assumed
+ *   that the caller holds the mm semaphore
+ *
+ ****************************************************************************/
+
+void mm_remfreechunk(FAR struct mm_heap_s *heap, FAR struct mm_freenode_s *node)
+{
+#ifdef CONFIG_MM_TLSF
+  int ndx;
+
+  if (node->blink)
+    {
+      node->blink->flink = node->flink;
+    }
+  else
+    {
+      /* The node is at the head of its list */
+
+      ndx = mm_size2ndx(node->size);
+      DEBUGASSERT(heap->mm_freelist[ndx] == node);
+
+      heap->mm_freelist[ndx] = node->flink;
+
+      /* Clear the bitmap bits if that list is now empty */
+
+      if (!node->flink)
+        {
+          heap->mm_slbitmap[ndx / MM_TLSF_SLCOUNT] &=
+            ~(1 << (ndx % MM_TLSF_SLCOUNT));
+
+          if (heap->mm_slbitmap[ndx / MM_TLSF_SLCOUNT] == 0)
+            {
+              heap->mm_flbitmap &= ~(1 << (ndx / MM_TLSF_SLCOUNT));
+            }
+        }
+    }
+
+  if (node->flink)
+    {
+      node->flink->blink = node->blink;
+    }
+#else
+  /* The node always has a predecessor:  The list head is a dummy node */
+
+  DEBUGASSERT(node->blink);
+
+  node->blink->flink = node->flink;
+  if (node->flink)
+    {
+      node->flink->blink = node->blink;
+    }
+#endif
+}
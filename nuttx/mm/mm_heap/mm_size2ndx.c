@@ -53,10 +53,39 @@
  * Name: mm_size2ndx
  *
  * Description:
- *    Convert the size to a nodelist index.
+ *    Convert the size to a nodelist index.  With CONFIG_MM_TLSF, this is
+ *    the index of the free list that holds chunks of this size:  first
+ *    level times MM_TLSF_SLCOUNT plus second level.
  *
  ****************************************************************************/
 
+#ifdef CONFIG_MM_TLSF
+int mm_size2ndx(size_t size)
+{
+  int fl;
+  int sl;
+
+  if (size < MM_TLSF_SMALL)
+    {
+      return size >> MM_MIN_SHIFT;
+    }
+
+  /* The index of the most significant bit selects the first level.  The
+   * MM_TLSF_SLI bits below it select the second level.
+   */
+
+  fl = 31 - __builtin_clz((uint32_t)size);
+  sl = (size >> (fl - MM_TLSF_SLI)) & (MM_TLSF_SLCOUNT - 1);
+  fl = fl - (MM_MIN_SHIFT + MM_TLSF_SLI) + 1;
+
+  if (fl >= MM_TLSF_FLCOUNT)
+    {
+      return MM_TLSF_NLISTS - 1;
+    }
+
+  return fl * MM_TLSF_SLCOUNT + sl;
+}
+#else
 int mm_size2ndx(size_t size)
 {
   int ndx = 0;
@@ -75,3 +104,4 @@ int mm_size2ndx(size_t size)
 
   return ndx;
 }
+#endif
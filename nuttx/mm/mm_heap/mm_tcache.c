@@ -0,0 +1,251 @@
+/****************************************************************************
+ * mm/mm_heap/mm_tcache.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <unistd.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/sched.h>
+#include <nuttx/mm/mm.h>
+
+#ifdef CONFIG_MM_TCACHE
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_tcache_find
+ *
+ * Description:
+ *   Return the calling thread's cache for 'heap', optionally creating it.
+ *   Returns NULL when the cache cannot be used:  From interrupt handlers
+ *   (which would race with the interrupted thread) and from within the
+ *   heap itself (which is how the refill and flush operations reach the
+ *   real allocator).
+ *
+ ****************************************************************************/
+
+static FAR struct mm_tcache_s *mm_tcache_find(FAR struct mm_heap_s *heap,
+                                              bool create)
+{
+  FAR struct mm_tcache_s *tc;
+  FAR struct tcb_s *tcb;
+
+  if (up_interrupt_context() || heap->mm_holder == getpid())
+    {
+      return NULL;
+    }
+
+  tcb = sched_self();
+  for (tc = tcb->tcache; tc; tc = tc->tc_flink)
+    {
+      if (tc->tc_heap == heap)
+        {
+          return tc;
+        }
+    }
+
+  if (create)
+    {
+      /* Hold the heap while allocating so that the allocation of the cache
+       * itself does not recurse back here.
+       */
+
+      mm_takesemaphore(heap);
+      tc = (FAR struct mm_tcache_s *)mm_zalloc(heap, sizeof(struct mm_tcache_s));
+      mm_givesemaphore(heap);
+
+      if (tc)
+        {
+          tc->tc_heap  = heap;
+          tc->tc_flink = tcb->tcache;
+          tcb->tcache  = tc;
+        }
+    }
+
+  return tc;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mm_tcache_alloc
+ *
+ * Description:
+ *   Take a chunk of 'size' bytes (already aligned and including the
+ *   allocation header) from the calling thread's cache.  An empty magazine
+ *   is refilled with MM_TCACHE_BATCH chunks while taking the heap lock
+ *   only once.
+ *
+ * Returned Value:
+ *   The allocated memory or NULL if the request must go to the heap.
+ *
+ ****************************************************************************/
+
+FAR void *mm_tcache_alloc(FAR struct mm_heap_s *heap, size_t size)
+{
+  FAR struct mm_tcache_s *tc;
+  FAR void *mem;
+  int ndx;
+
+  if (size > MM_TCACHE_MAXCHUNK)
+    {
+      return NULL;
+    }
+
+  tc = mm_tcache_find(heap, true);
+  if (!tc)
+    {
+      return NULL;
+    }
+
+  ndx = (size >> MM_MIN_SHIFT) - 1;
+  if (tc->tc_count[ndx] == 0)
+    {
+      mm_takesemaphore(heap);
+      while (tc->tc_count[ndx] < MM_TCACHE_BATCH)
+        {
+          mem = mm_malloc(heap, size - SIZEOF_MM_ALLOCNODE);
+          if (!mem)
+            {
+              break;
+            }
+
+          tc->tc_mag[ndx][tc->tc_count[ndx]++] = mem;
+        }
+
+      mm_givesemaphore(heap);
+
+      if (tc->tc_count[ndx] == 0)
+        {
+          return NULL;
+        }
+    }
+
+  return tc->tc_mag[ndx][--tc->tc_count[ndx]];
+}
+
+/****************************************************************************
+ * Name: mm_tcache_free
+ *
+ * Description:
+ *   Put a small chunk into the calling thread's cache instead of returning
+ *   it to the heap.  A full magazine first returns MM_TCACHE_BATCH chunks
+ *   to the heap while taking the heap lock only once.
+ *
+ * Returned Value:
+ *   true if the chunk was cached, false if it must be freed to the heap.
+ *
+ ****************************************************************************/
+
+bool mm_tcache_free(FAR struct mm_heap_s *heap, FAR void *mem)
+{
+  FAR struct mm_allocnode_s *node;
+  FAR struct mm_tcache_s *tc;
+  int ndx;
+
+  node = (FAR struct mm_allocnode_s *)((FAR char *)mem - SIZEOF_MM_ALLOCNODE);
+  if (node->size > MM_TCACHE_MAXCHUNK)
+    {
+      return false;
+    }
+
+  tc = mm_tcache_find(heap, false);
+  if (!tc)
+    {
+      return false;
+    }
+
+  ndx = (node->size >> MM_MIN_SHIFT) - 1;
+  if (tc->tc_count[ndx] >= MM_TCACHE_DEPTH)
+    {
+      mm_takesemaphore(heap);
+      while (tc->tc_count[ndx] > MM_TCACHE_DEPTH - MM_TCACHE_BATCH)
+        {
+          mm_free(heap, tc->tc_mag[ndx][--tc->tc_count[ndx]]);
+        }
+
+      mm_givesemaphore(heap);
+    }
+
+  tc->tc_mag[ndx][tc->tc_count[ndx]++] = mem;
+  return true;
+}
+
+/****************************************************************************
+ * Name: mm_tcache_release
+ *
+ * Description:
+ *   Return all chunks held by a list of thread caches, and the caches
+ *   themselves, to their heaps.  Called when the owning thread's TCB is
+ *   released.
+ *
+ ****************************************************************************/
+
+void mm_tcache_release(FAR struct mm_tcache_s *tcache)
+{
+  FAR struct mm_tcache_s *next;
+  FAR struct mm_heap_s *heap;
+  int ndx;
+
+  for (; tcache; tcache = next)
+    {
+      next = tcache->tc_flink;
+      heap = tcache->tc_heap;
+
+      mm_takesemaphore(heap);
+      for (ndx = 0; ndx < MM_TCACHE_NCLASSES; ndx++)
+        {
+          while (tcache->tc_count[ndx] > 0)
+            {
+              mm_free(heap, tcache->tc_mag[ndx][--tcache->tc_count[ndx]]);
+            }
+        }
+
+      mm_free(heap, tcache);
+      mm_givesemaphore(heap);
+    }
+}
+
+#endif /* CONFIG_MM_TCACHE */
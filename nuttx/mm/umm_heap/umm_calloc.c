@@ -80,7 +80,9 @@
 
 FAR void *calloc(size_t n, size_t elem_size)
 {
-  return mm_calloc(USR_HEAP, n, elem_size);
+  FAR void *mem = mm_calloc(USR_HEAP, n, elem_size);
+  MM_PROFILE_TAG(mem);
+  return mem;
 }
 
 #endif /* !CONFIG_BUILD_PROTECTED || !__KERNEL__ */
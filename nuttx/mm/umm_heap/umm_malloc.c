@@ -132,9 +132,12 @@ FAR void *malloc(size_t size)
     }
   while (mem == NULL);
 
+  MM_PROFILE_TAG(mem);
   return mem;
 #else
-  return mm_malloc(USR_HEAP, size);
+  FAR void *mem = mm_malloc(USR_HEAP, size);
+  MM_PROFILE_TAG(mem);
+  return mem;
 #endif
 }
 
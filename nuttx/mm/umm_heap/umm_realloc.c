@@ -91,7 +91,9 @@
 
 FAR void *realloc(FAR void *oldmem, size_t size)
 {
-  return mm_realloc(USR_HEAP, oldmem, size);
+  FAR void *mem = mm_realloc(USR_HEAP, oldmem, size);
+  MM_PROFILE_TAG(mem);
+  return mem;
 }
 
 #endif /* !CONFIG_BUILD_PROTECTED || !__KERNEL__ */
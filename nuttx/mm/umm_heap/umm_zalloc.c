@@ -96,12 +96,15 @@ FAR void *zalloc(size_t size)
        memset(alloc, 0, size);
     }
 
+  MM_PROFILE_TAG(alloc);
   return alloc;
 
 #else
   /* Use mm_zalloc() becuase it implements the clear */
 
-  return mm_zalloc(USR_HEAP, size);
+  FAR void *alloc = mm_zalloc(USR_HEAP, size);
+  MM_PROFILE_TAG(alloc);
+  return alloc;
 #endif
 }
 
@@ -53,6 +53,7 @@
 #include <nuttx/config.h>
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <semaphore.h>
 
 #include <netinet/in.h>
@@ -393,6 +394,29 @@ void arp_notify(in_addr_t ipaddr);
 
 FAR struct arp_entry *arp_find(in_addr_t ipaddr);
 
+/****************************************************************************
+ * Name: arp_unreachable and arp_setunreachable
+ *
+ * Description:
+ *   Check if an address that failed to resolve is still held off, and
+ *   remember (or extend the hold-off of) such an address.
+ *
+ * Input parameters:
+ *   ipaddr - Refers to an IP address in network order
+ *
+ * Assumptions
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_ARP_SEND) && CONFIG_ARP_SEND_NEGCACHE > 0
+bool arp_unreachable(in_addr_t ipaddr);
+void arp_setunreachable(in_addr_t ipaddr);
+#else
+#  define arp_unreachable(i) (false)
+#  define arp_setunreachable(i)
+#endif
+
 /****************************************************************************
  * Name: arp_delete
  *
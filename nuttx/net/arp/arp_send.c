@@ -262,6 +262,18 @@ int arp_send(in_addr_t ipaddr)
    */
 
   save = net_lock();
+
+  /* Don't flood the link with requests for an address that just failed to
+   * resolve.  Fail fast until its hold-off has passed.
+   */
+
+  if (arp_unreachable(ipaddr) && arp_find(ipaddr) == NULL)
+    {
+      nvdbg("Hold-off: %08lx\n", (unsigned long)ipaddr);
+      ret = -ETIMEDOUT;
+      goto errout_with_lock;
+    }
+
   state.snd_cb = arp_callback_alloc(&g_arp_conn);
   if (!state.snd_cb)
     {
@@ -360,6 +372,13 @@ int arp_send(in_addr_t ipaddr)
       state.snd_retries++;
     }
 
+  /* Remember addresses that did not answer */
+
+  if (ret == -ETIMEDOUT)
+    {
+      arp_setunreachable(ipaddr);
+    }
+
   sem_destroy(&state.snd_sem);
   arp_callback_free(&g_arp_conn, state.snd_cb);
 errout_with_lock:
@@ -47,12 +47,14 @@
 
 #include <sys/ioctl.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <debug.h>
 
 #include <netinet/in.h>
 #include <net/ethernet.h>
 
+#include <nuttx/clock.h>
 #include <nuttx/net/netconfig.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/arp.h>
@@ -66,10 +68,38 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+#ifdef CONFIG_NET_ARP_HASH
+#  if (CONFIG_NET_ARP_HASHSIZE & (CONFIG_NET_ARP_HASHSIZE - 1)) != 0
+#    error CONFIG_NET_ARP_HASHSIZE must be a power of two
+#  endif
+#  if CONFIG_NET_ARPTAB_SIZE > 255
+#    error CONFIG_NET_ARPTAB_SIZE is too large for the ARP hash
+#  endif
+
+/* Hash links are table indices plus one; zero ends a chain */
+
+#  define ARP_NOENTRY   0
+#  define ARP_HASH(a)   ((((a) >> 24) ^ ((a) >> 16) ^ ((a) >> 8) ^ (a)) & \
+                         (CONFIG_NET_ARP_HASHSIZE - 1))
+#endif
+
+/* The hold-off of an unreachable address doubles up to this many times */
+
+#define ARP_NEG_MAXSHIFT 6
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+#if defined(CONFIG_NET_ARP_SEND) && CONFIG_ARP_SEND_NEGCACHE > 0
+struct arp_negative_s
+{
+  in_addr_t ipaddr;       /* Address that failed to resolve, 0 if unused */
+  uint32_t  expiry;       /* System time when the hold-off ends */
+  uint8_t   shift;        /* Hold-off is CONFIG_ARP_SEND_NEGDELAY << shift */
+};
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -79,10 +109,97 @@
 static struct arp_entry g_arptable[CONFIG_NET_ARPTAB_SIZE];
 static uint8_t g_arptime;
 
+/* The g_arptime of the last lookup of each entry (for LRU replacement) */
+
+static uint8_t g_arpused[CONFIG_NET_ARPTAB_SIZE];
+
+#ifdef CONFIG_NET_ARP_HASH
+/* Hash chains over g_arptable.  g_arpbucket[] remembers the bucket an
+ * entry is linked into, since expired entries just have at_ipaddr cleared
+ * and stay linked until they are reused.
+ */
+
+static uint8_t g_arphead[CONFIG_NET_ARP_HASHSIZE];
+static uint8_t g_arpnext[CONFIG_NET_ARPTAB_SIZE];
+static uint8_t g_arpbucket[CONFIG_NET_ARPTAB_SIZE];
+#endif
+
+#if defined(CONFIG_NET_ARP_SEND) && CONFIG_ARP_SEND_NEGCACHE > 0
+/* Recently unreachable addresses */
+
+static struct arp_negative_s g_arpneg[CONFIG_ARP_SEND_NEGCACHE];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: arp_hashlink
+ *
+ * Description:
+ *   Move ARP table entry 'ndx' to the hash chain of 'ipaddr'
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ARP_HASH
+static void arp_hashlink(int ndx, in_addr_t ipaddr)
+{
+  FAR uint8_t *link;
+  int bucket;
+
+  /* Unlink the entry from the chain that it is in, if any */
+
+  if (g_arpbucket[ndx] != ARP_NOENTRY)
+    {
+      for (link = &g_arphead[g_arpbucket[ndx] - 1];
+           *link != ARP_NOENTRY;
+           link = &g_arpnext[*link - 1])
+        {
+          if (*link == ndx + 1)
+            {
+              *link = g_arpnext[ndx];
+              break;
+            }
+        }
+    }
+
+  /* And add it to the head of its new chain */
+
+  bucket            = ARP_HASH(ipaddr);
+  g_arpnext[ndx]    = g_arphead[bucket];
+  g_arphead[bucket] = ndx + 1;
+  g_arpbucket[ndx]  = bucket + 1;
+}
+#else
+#  define arp_hashlink(n,a)
+#endif
+
+/****************************************************************************
+ * Name: arp_negclear
+ *
+ * Description:
+ *   Forget an unreachable address once a mapping for it is learned
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_ARP_SEND) && CONFIG_ARP_SEND_NEGCACHE > 0
+static void arp_negclear(in_addr_t ipaddr)
+{
+  int i;
+
+  for (i = 0; i < CONFIG_ARP_SEND_NEGCACHE; i++)
+    {
+      if (g_arpneg[i].ipaddr == ipaddr)
+        {
+          g_arpneg[i].ipaddr = 0;
+        }
+    }
+}
+#else
+#  define arp_negclear(a)
+#endif
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -103,6 +220,14 @@ void arp_reset(void)
     {
       memset(&g_arptable[i].at_ipaddr, 0, sizeof(in_addr_t));
     }
+
+#ifdef CONFIG_NET_ARP_HASH
+  memset(g_arphead, ARP_NOENTRY, sizeof(g_arphead));
+  memset(g_arpbucket, ARP_NOENTRY, sizeof(g_arpbucket));
+#endif
+#if defined(CONFIG_NET_ARP_SEND) && CONFIG_ARP_SEND_NEGCACHE > 0
+  memset(g_arpneg, 0, sizeof(g_arpneg));
+#endif
 }
 
 /****************************************************************************
@@ -156,31 +281,24 @@ void arp_update(FAR uint16_t *pipaddr, FAR uint8_t *ethaddr)
   in_addr_t         ipaddr = net_ip4addr_conv32(pipaddr);
   int               i;
 
-  /* Walk through the ARP mapping table and try to find an entry to
-   * update. If none is found, the IP -> MAC address mapping is
-   * inserted in the ARP table.
-   */
+  /* The address is reachable after all */
 
-  for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
-    {
-      tabptr = &g_arptable[i];
+  arp_negclear(ipaddr);
 
-      /* Only check those entries that are actually in use. */
+  /* Find an entry to update. If none is found, the IP -> MAC address
+   * mapping is inserted in the ARP table.
+   */
 
-      if (tabptr->at_ipaddr != 0)
+  if (ipaddr != 0)
+    {
+      tabptr = arp_find(ipaddr);
+      if (tabptr)
         {
-          /* Check if the source IP address of the incoming packet matches
-           * the IP address in this ARP table entry.
-           */
+          /* An old entry found, update this and return. */
 
-          if (net_ipaddr_cmp(ipaddr, tabptr->at_ipaddr))
-            {
-              /* An old entry found, update this and return. */
-
-              memcpy(tabptr->at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
-              tabptr->at_time = g_arptime;
-              return;
-            }
+          memcpy(tabptr->at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
+          tabptr->at_time = g_arptime;
+          return;
         }
     }
 
@@ -197,8 +315,8 @@ void arp_update(FAR uint16_t *pipaddr, FAR uint8_t *ethaddr)
         }
     }
 
-  /* If no unused entry is found, we try to find the oldest entry and
-   * throw it away.
+  /* If no unused entry is found, we try to find the least recently used
+   * entry and throw it away.
    */
 
   if (i == CONFIG_NET_ARPTAB_SIZE)
@@ -208,10 +326,9 @@ void arp_update(FAR uint16_t *pipaddr, FAR uint8_t *ethaddr)
 
       for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
         {
-          tabptr = &g_arptable[i];
-          if (g_arptime - tabptr->at_time > tmpage)
+          if ((uint8_t)(g_arptime - g_arpused[i]) > tmpage)
             {
-              tmpage = g_arptime - tabptr->at_time;
+              tmpage = g_arptime - g_arpused[i];
               j = i;
             }
         }
@@ -227,6 +344,8 @@ void arp_update(FAR uint16_t *pipaddr, FAR uint8_t *ethaddr)
   tabptr->at_ipaddr = ipaddr;
   memcpy(tabptr->at_ethaddr.ether_addr_octet, ethaddr, ETHER_ADDR_LEN);
   tabptr->at_time = g_arptime;
+  g_arpused[i]    = g_arptime;
+  arp_hashlink(i, ipaddr);
 }
 
 /****************************************************************************
@@ -249,11 +368,21 @@ FAR struct arp_entry *arp_find(in_addr_t ipaddr)
   FAR struct arp_entry *tabptr;
   int i;
 
+#ifdef CONFIG_NET_ARP_HASH
+  uint8_t ndx;
+
+  for (ndx = g_arphead[ARP_HASH(ipaddr)]; ndx != ARP_NOENTRY;
+       ndx = g_arpnext[ndx - 1])
+    {
+      i      = ndx - 1;
+#else
   for (i = 0; i < CONFIG_NET_ARPTAB_SIZE; ++i)
     {
+#endif
       tabptr = &g_arptable[i];
       if (net_ipaddr_cmp(ipaddr, tabptr->at_ipaddr))
         {
+          g_arpused[i] = g_arptime;
           return tabptr;
         }
     }
@@ -261,5 +390,87 @@ FAR struct arp_entry *arp_find(in_addr_t ipaddr)
   return NULL;
 }
 
+/****************************************************************************
+ * Name: arp_unreachable
+ *
+ * Description:
+ *   Return true if 'ipaddr' recently failed to resolve and its hold-off
+ *   has not yet passed.
+ *
+ * Assumptions
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_ARP_SEND) && CONFIG_ARP_SEND_NEGCACHE > 0
+bool arp_unreachable(in_addr_t ipaddr)
+{
+  uint32_t now = clock_systimer();
+  int i;
+
+  for (i = 0; i < CONFIG_ARP_SEND_NEGCACHE; i++)
+    {
+      if (g_arpneg[i].ipaddr == ipaddr)
+        {
+          return (int32_t)(g_arpneg[i].expiry - now) > 0;
+        }
+    }
+
+  return false;
+}
+
+/****************************************************************************
+ * Name: arp_setunreachable
+ *
+ * Description:
+ *   Remember that 'ipaddr' failed to resolve.  The hold-off doubles each
+ *   time the same address fails again.
+ *
+ * Assumptions
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void arp_setunreachable(in_addr_t ipaddr)
+{
+  FAR struct arp_negative_s *neg = NULL;
+  uint32_t now = clock_systimer();
+  int i;
+
+  for (i = 0; i < CONFIG_ARP_SEND_NEGCACHE; i++)
+    {
+      if (g_arpneg[i].ipaddr == ipaddr)
+        {
+          /* Failed again: double the hold-off */
+
+          neg = &g_arpneg[i];
+          if (neg->shift < ARP_NEG_MAXSHIFT)
+            {
+              neg->shift++;
+            }
+
+          break;
+        }
+
+      /* Otherwise prefer an unused entry, then the one expiring first */
+
+      if (neg == NULL || (neg->ipaddr != 0 &&
+          (g_arpneg[i].ipaddr == 0 ||
+           (int32_t)(g_arpneg[i].expiry - neg->expiry) < 0)))
+        {
+          neg = &g_arpneg[i];
+        }
+    }
+
+  if (i >= CONFIG_ARP_SEND_NEGCACHE)
+    {
+      neg->ipaddr = ipaddr;
+      neg->shift  = 0;
+    }
+
+  neg->expiry = now + MSEC2TICK((uint32_t)CONFIG_ARP_SEND_NEGDELAY << neg->shift);
+}
+#endif
+
 #endif /* CONFIG_NET_ARP */
 #endif /* CONFIG_NET */
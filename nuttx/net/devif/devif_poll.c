@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 #ifdef CONFIG_NET
 
+#include <stdbool.h>
 #include <debug.h>
 
 #include <nuttx/net/netconfig.h>
@@ -53,6 +54,14 @@
 #include "icmp/icmp.h"
 #include "igmp/igmp.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifndef CONFIG_NET_TCP_TXBATCH
+#  define CONFIG_NET_TCP_TXBATCH 1
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -183,8 +192,96 @@ static int devif_poll_udp_connections(FAR struct net_driver_s *dev,
 
   return bstop;
 }
+
+/****************************************************************************
+ * Function: devif_poll_udp_ready
+ *
+ * Description:
+ *   Poll the UDP connections that have pending output.  A connection
+ *   leaves the ready list when polling it produces nothing to send.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver and may be called
+ *   from the timer interrupt/watchdog handle level.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_POLL_TXREADY
+static int devif_poll_udp_ready(FAR struct net_driver_s *dev,
+                                devif_poll_callback_t callback)
+{
+  FAR struct udp_conn_s *conn = udp_nextready(NULL);
+  FAR struct udp_conn_s *next;
+  int bstop = 0;
+
+  while (!bstop && conn)
+    {
+      next = udp_nextready(conn);
+
+      /* Perform the UDP TX poll */
+
+      udp_poll(dev, conn);
+      if (dev->d_len == 0)
+        {
+          udp_txdone(conn);
+        }
+
+      /* Call back into the driver */
+
+      bstop = callback(dev);
+      conn  = next;
+    }
+
+  return bstop;
+}
+#endif
 #endif /* CONFIG_NET_UDP */
 
+/****************************************************************************
+ * Function: devif_poll_tcp_conn
+ *
+ * Description:
+ *   Poll one TCP connection, again and again for up to
+ *   CONFIG_NET_TCP_TXBATCH segments as long as it produces output and the
+ *   driver accepts more.  Returns the number of segments produced; *bstop
+ *   is set to the last driver callback return value.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver and may be called
+ *   from the timer interrupt/watchdog handle level.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP
+static inline int devif_poll_tcp_conn(FAR struct net_driver_s *dev,
+                                      FAR struct tcp_conn_s *conn,
+                                      devif_poll_callback_t callback,
+                                      FAR int *bstop)
+{
+  int nsegs = 0;
+  bool sent;
+
+  do
+    {
+      /* Perform the TCP TX poll */
+
+      tcp_poll(dev, conn);
+      sent = (dev->d_len > 0);
+      if (sent)
+        {
+          nsegs++;
+        }
+
+      /* Call back into the driver */
+
+      *bstop = callback(dev);
+    }
+  while (!*bstop && sent && nsegs < CONFIG_NET_TCP_TXBATCH);
+
+  return nsegs;
+}
+#endif
+
 /****************************************************************************
  * Function: devif_poll_tcp_connections
  *
@@ -208,13 +305,9 @@ static inline int devif_poll_tcp_connections(FAR struct net_driver_s *dev,
 
   while (!bstop && (conn = tcp_nextconn(conn)))
     {
-      /* Perform the TCP TX poll */
+      /* Perform the TCP TX poll and call back into the driver */
 
-      tcp_poll(dev, conn);
-
-      /* Call back into the driver */
-
-      bstop = callback(dev);
+      (void)devif_poll_tcp_conn(dev, conn, callback, &bstop);
     }
 
   return bstop;
@@ -223,6 +316,45 @@ static inline int devif_poll_tcp_connections(FAR struct net_driver_s *dev,
 # define devif_poll_tcp_connections(dev, callback) (0)
 #endif
 
+/****************************************************************************
+ * Function: devif_poll_tcp_ready
+ *
+ * Description:
+ *   Poll the TCP connections that have pending output.  A connection
+ *   leaves the ready list when polling it produces nothing to send.
+ *
+ * Assumptions:
+ *   This function is called from the MAC device driver and may be called
+ *   from the timer interrupt/watchdog handle level.
+ *
+ ****************************************************************************/
+
+#if defined(CONFIG_NET_TCP) && defined(CONFIG_NET_POLL_TXREADY)
+static int devif_poll_tcp_ready(FAR struct net_driver_s *dev,
+                                devif_poll_callback_t callback)
+{
+  FAR struct tcp_conn_s *conn = tcp_nextready(NULL);
+  FAR struct tcp_conn_s *next;
+  int bstop = 0;
+
+  while (!bstop && conn)
+    {
+      next = tcp_nextready(conn);
+
+      /* Perform the TCP TX poll and call back into the driver */
+
+      if (devif_poll_tcp_conn(dev, conn, callback, &bstop) == 0)
+        {
+          tcp_txdone(conn);
+        }
+
+      conn = next;
+    }
+
+  return bstop;
+}
+#endif
+
 /****************************************************************************
  * Function: devif_poll_tcp_timer
  *
@@ -325,22 +457,34 @@ int devif_poll(FAR struct net_driver_s *dev, devif_poll_callback_t callback)
 #endif
 #ifdef CONFIG_NET_TCP
     {
+#ifdef CONFIG_NET_POLL_TXREADY
+      /* Poll the TCP connections with pending output */
+
+      bstop = devif_poll_tcp_ready(dev, callback);
+#else
       /* Traverse all of the active TCP connections and perform the poll
        * action.
        */
 
       bstop = devif_poll_tcp_connections(dev, callback);
+#endif
     }
 
   if (!bstop)
 #endif
 #ifdef CONFIG_NET_UDP
     {
+#ifdef CONFIG_NET_POLL_TXREADY
+      /* Poll the UDP connections with pending output */
+
+      bstop = devif_poll_udp_ready(dev, callback);
+#else
       /* Traverse all of the allocated UDP connections and perform
        * the poll action
        */
 
       bstop = devif_poll_udp_connections(dev, callback);
+#endif
     }
 
   if (!bstop)
@@ -45,11 +45,32 @@
 #include <semaphore.h>
 
 #include <nuttx/net/iob.h>
+#include <nuttx/net/netstats.h>
 
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* Pool statistics.  These are updated inside the free list critical
+ * section.
+ */
+
+#ifdef CONFIG_NET_STATISTICS
+#  define IOB_STAT(f)         (g_netstats.iob.f++)
+#  define IOB_LOWATER(n) \
+     do \
+       { \
+         if ((n) < g_netstats.iob.lowater) \
+           { \
+             g_netstats.iob.lowater = (n); \
+           } \
+       } \
+     while (0)
+#else
+#  define IOB_STAT(f)
+#  define IOB_LOWATER(n)
+#endif
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
@@ -106,7 +106,20 @@ static FAR struct iob_s *iob_tryalloc(bool throttled)
 #if CONFIG_IOB_THROTTLE > 0
   /* If there are free I/O buffers for this allocation */
 
-  if (sem->semcount > 0)
+  if (sem->semcount <= 0)
+    {
+      /* Free buffers may remain that are held back for unthrottled users */
+
+      if (g_iob_freelist)
+        {
+          IOB_STAT(throttled);
+        }
+      else
+        {
+          IOB_STAT(fail);
+        }
+    }
+  else
 #endif
     {
       /* Take the I/O buffer from the head of the free list */
@@ -139,6 +152,8 @@ static FAR struct iob_s *iob_tryalloc(bool throttled)
           g_throttle_sem.semcount--;
           DEBUGASSERT(g_throttle_sem.semcount >= -CONFIG_IOB_THROTTLE);
 #endif
+          IOB_STAT(alloc);
+          IOB_LOWATER(g_iob_sem.semcount);
           irqrestore(flags);
 
           /* Put the I/O buffer in a known state */
@@ -149,6 +164,10 @@ static FAR struct iob_s *iob_tryalloc(bool throttled)
           iob->io_pktlen = 0;    /* Total length of the packet */
           return iob;
         }
+
+#if CONFIG_IOB_THROTTLE == 0
+      IOB_STAT(fail);
+#endif
     }
 
   irqrestore(flags);
@@ -201,6 +220,7 @@ static FAR struct iob_s *iob_allocwait(bool throttled)
            * count will be incremented.
            */
 
+          IOB_STAT(wait);
           ret = sem_wait(sem);
 
           /* When we wake up from wait, an I/O buffer was returned to
@@ -246,3 +266,77 @@ FAR struct iob_s *iob_alloc(bool throttled)
       return iob_allocwait(throttled);
     }
 }
+
+/****************************************************************************
+ * Name: iob_alloc_chain
+ *
+ * Description:
+ *   Allocate 'nbuffers' I/O buffers in one operation, returned linked
+ *   through io_flink, or none at all.  Never waits.
+ *
+ ****************************************************************************/
+
+FAR struct iob_s *iob_alloc_chain(unsigned int nbuffers, bool throttled)
+{
+  FAR struct iob_s *head;
+  FAR struct iob_s *iob;
+  irqstate_t flags;
+  unsigned int i;
+#if CONFIG_IOB_THROTTLE > 0
+  FAR sem_t *sem = (throttled ? &g_throttle_sem : &g_iob_sem);
+#else
+  FAR sem_t *sem = &g_iob_sem;
+#endif
+
+  if (nbuffers == 0)
+    {
+      return NULL;
+    }
+
+  /* One critical section for the whole chain.  As in iob_tryalloc(), the
+   * semaphore counts are simply decremented since we know that there are
+   * enough free buffers.
+   */
+
+  flags = irqsave();
+  if (sem->semcount < (int)nbuffers)
+    {
+      IOB_STAT(fail);
+      irqrestore(flags);
+      return NULL;
+    }
+
+  head = g_iob_freelist;
+  for (i = 1, iob = head; ; i++, iob = iob->io_flink)
+    {
+      DEBUGASSERT(iob != NULL);
+
+      /* Put the I/O buffer in a known state */
+
+      iob->io_len    = 0;
+      iob->io_offset = 0;
+      iob->io_pktlen = 0;
+
+      if (i >= nbuffers)
+        {
+          break;
+        }
+    }
+
+  g_iob_freelist = iob->io_flink;
+  iob->io_flink  = NULL;
+
+  g_iob_sem.semcount -= nbuffers;
+  DEBUGASSERT(g_iob_sem.semcount >= 0);
+#if CONFIG_IOB_THROTTLE > 0
+  g_throttle_sem.semcount -= nbuffers;
+  DEBUGASSERT(g_throttle_sem.semcount >= -CONFIG_IOB_THROTTLE);
+#endif
+
+#ifdef CONFIG_NET_STATISTICS
+  g_netstats.iob.alloc += nbuffers;
+#endif
+  IOB_LOWATER(g_iob_sem.semcount);
+  irqrestore(flags);
+  return head;
+}
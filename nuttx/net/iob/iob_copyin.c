@@ -93,6 +93,7 @@ int iob_copyin(FAR struct iob_s *iob, FAR const uint8_t *src,
                unsigned int len, unsigned int offset, bool throttled)
 {
   FAR struct iob_s *head = iob;
+  FAR struct iob_s *spare = NULL;
   FAR struct iob_s *next;
   FAR uint8_t *dest;
   unsigned int ncopy;
@@ -204,13 +205,30 @@ int iob_copyin(FAR struct iob_s *iob, FAR const uint8_t *src,
 
       if (len > 0 && !next)
         {
-          /* Yes.. allocate a new buffer */
+          /* Yes.. allocate a new buffer.  When more than one is needed,
+           * try to get all of them in one operation.
+           */
 
-          next = iob_alloc(throttled);
-          if (next == NULL)
+          if (spare == NULL && len > CONFIG_IOB_BUFSIZE)
             {
-              ndbg("ERROR: Failed to allocate I/O buffer\n");
-              return -ENOMEM;
+              spare = iob_alloc_chain((len + CONFIG_IOB_BUFSIZE - 1) /
+                                      CONFIG_IOB_BUFSIZE, throttled);
+            }
+
+          if (spare != NULL)
+            {
+              next           = spare;
+              spare          = next->io_flink;
+              next->io_flink = NULL;
+            }
+          else
+            {
+              next = iob_alloc(throttled);
+              if (next == NULL)
+                {
+                  ndbg("ERROR: Failed to allocate I/O buffer\n");
+                  return -ENOMEM;
+                }
             }
 
           /* Add the new, empty I/O buffer to the end of the buffer chain. */
@@ -223,5 +241,6 @@ int iob_copyin(FAR struct iob_s *iob, FAR const uint8_t *src,
       offset = 0;
     }
 
+  DEBUGASSERT(spare == NULL);
   return OK;
 }
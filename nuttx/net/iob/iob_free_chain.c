@@ -46,6 +46,8 @@
 #  define CONFIG_DEBUG_NET 1
 #endif
 
+#include <semaphore.h>
+
 #include <nuttx/arch.h>
 #include <nuttx/net/iob.h>
 
@@ -82,12 +84,56 @@
 
 void iob_free_chain(FAR struct iob_s *iob)
 {
-  FAR struct iob_s *next;
+  FAR struct iob_s *tail;
+  irqstate_t flags;
+  int nbuffers;
+
+  if (iob == NULL)
+    {
+      return;
+    }
+
+  /* Find the end of the chain.  The packet length bookkeeping done by
+   * iob_free() is not needed since the whole chain goes away.
+   */
+
+  for (tail = iob, nbuffers = 1; tail->io_flink; tail = tail->io_flink)
+    {
+      nbuffers++;
+    }
+
+  /* Return the whole chain to the free list in one critical section */
+
+  flags = irqsave();
+  tail->io_flink = g_iob_freelist;
+  g_iob_freelist = iob;
 
-  /* Free each IOB in the chain -- one at a time to keep the count straight */
+  /* Signal that the IOBs are available.  With no waiters, the free buffer
+   * count can simply be bumped.
+   */
 
-  for (; iob; iob = next)
+  if (g_iob_sem.semcount >= 0)
     {
-      next = iob_free(iob);
+      g_iob_sem.semcount += nbuffers;
     }
+  else
+    {
+      int i;
+
+      for (i = 0; i < nbuffers; i++)
+        {
+          sem_post(&g_iob_sem);
+        }
+    }
+
+#if CONFIG_IOB_THROTTLE > 0
+  /* The throttle count may be negative without waiters, so always post */
+
+  for (; nbuffers > 0; nbuffers--)
+    {
+      sem_post(&g_throttle_sem);
+    }
+#endif
+
+  irqrestore(flags);
 }
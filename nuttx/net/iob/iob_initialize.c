@@ -130,6 +130,9 @@ void iob_initialize(void)
         }
 
       sem_init(&g_iob_sem, 0, CONFIG_IOB_NBUFFERS);
+#ifdef CONFIG_NET_STATISTICS
+      g_netstats.iob.lowater = CONFIG_IOB_NBUFFERS;
+#endif
 
 #if CONFIG_IOB_THROTTLE > 0
       sem_init(&g_throttle_sem, 0, CONFIG_IOB_NBUFFERS - CONFIG_IOB_THROTTLE);
@@ -61,6 +61,32 @@
  * Private Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Function: net_prefixlen
+ *
+ * Description:
+ *   Return the number of bits set in a network mask
+ *
+ ****************************************************************************/
+
+static int net_prefixlen(FAR const void *netmask)
+{
+  FAR const uint8_t *ptr = (FAR const uint8_t *)netmask;
+  uint8_t byte;
+  int nbits = 0;
+  int i;
+
+  for (i = 0; i < sizeof(net_ipaddr_t); i++)
+    {
+      for (byte = ptr[i]; byte; byte &= byte - 1)
+        {
+          nbits++;
+        }
+    }
+
+  return nbits;
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -82,7 +108,10 @@ int net_addroute(net_ipaddr_t target, net_ipaddr_t netmask,
                  net_ipaddr_t router)
 {
   FAR struct net_route_s *route;
+  FAR struct net_route_s *prev;
+  FAR struct net_route_s *curr;
   net_lock_t save;
+  int prefixlen;
 
   /* Allocate a route entry */
 
@@ -103,9 +132,34 @@ int net_addroute(net_ipaddr_t target, net_ipaddr_t netmask,
 
   save = net_lock();
 
-  /* Then add the new entry to the table */
+  /* Then add the new entry to the table ahead of any route with a shorter
+   * netmask, keeping the table in longest-prefix-first order.
+   */
+
+  prefixlen = net_prefixlen(&route->netmask);
+  prev = NULL;
+  curr = (FAR struct net_route_s *)g_routes.head;
+
+  while (curr && net_prefixlen(&curr->netmask) >= prefixlen)
+    {
+      prev = curr;
+      curr = curr->flink;
+    }
+
+  if (prev)
+    {
+      sq_addafter((FAR sq_entry_t *)prev, (FAR sq_entry_t *)route,
+                  (FAR sq_queue_t *)&g_routes);
+    }
+  else
+    {
+      sq_addfirst((FAR sq_entry_t *)route, (FAR sq_queue_t *)&g_routes);
+    }
+
+#ifdef CONFIG_NET_ROUTE_CACHE
+  g_routegen++;
+#endif
 
-  sq_addlast((FAR sq_entry_t *)route, (FAR sq_queue_t *)&g_routes);
   net_unlock(save);
   return OK;
 }
@@ -58,6 +58,12 @@
 
 sq_queue_t g_routes;
 
+#ifdef CONFIG_NET_ROUTE_CACHE
+/* The generation number of the routing table */
+
+uint16_t g_routegen;
+#endif
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -106,6 +106,12 @@ static int net_match(FAR struct net_route_s *route, FAR void *arg)
 
       net_freeroute(route);
 
+#ifdef CONFIG_NET_ROUTE_CACHE
+      /* Any cached route may have used this entry */
+
+      g_routegen++;
+#endif
+
       /* Return a non-zero value to terminate the traversal */
 
       return 1;
@@ -82,9 +82,13 @@ int net_foreachroute(route_handler_t handler, FAR void *arg)
 
   save = net_lock();
 
-  /* Visit each entry in the routing table */
+  /* Visit each entry in the routing table, stopping when the handler
+   * returns a non-zero value.
+   */
 
-  for (route = (FAR struct net_route_s *)g_routes.head; route; route = next)
+  for (route = (FAR struct net_route_s *)g_routes.head;
+       route && ret == 0;
+       route = next)
     {
       /* Get the next entry in the to visit.  We do this BEFORE calling the
        * handler because the hanlder may delete this entry.
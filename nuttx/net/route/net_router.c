@@ -43,6 +43,7 @@
 #include <string.h>
 #include <errno.h>
 
+#include <nuttx/net/net.h>
 #include <nuttx/net/ip.h>
 
 #include "route/route.h"
@@ -59,6 +60,16 @@ struct route_match_s
   net_ipaddr_t router;   /* The IP address of the router on one of our networks*/
 };
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ROUTE_CACHE
+/* The last net_router() lookup */
+
+static struct net_routecache_s g_routecache;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -82,9 +93,9 @@ static int net_match(FAR struct net_route_s *route, FAR void *arg)
 {
   FAR struct route_match_s *match = (FAR struct route_match_s *)arg;
 
-  /* To match, the masked target addresses must be the same.  In the event
-   * of multiple matches, only the first is returned.  There not (yet) any
-   * concept for the precedence of networks.
+  /* To match, the masked target addresses must be the same.  The routing
+   * table is ordered by decreasing netmask length, so the first match is
+   * the longest prefix match.
    */
 
   if (net_ipaddr_maskcmp(route->target, match->target, route->netmask))
@@ -129,26 +140,58 @@ int net_router(net_ipaddr_t target, FAR net_ipaddr_t *router)
 #endif
 {
   struct route_match_s match;
+#ifdef CONFIG_NET_ROUTE_CACHE
+  net_lock_t save;
+#endif
   int ret;
 
-  /* Set up the comparison structure */
+#ifdef CONFIG_NET_ROUTE_CACHE
+  /* Re-use the last lookup if it was for the same target and the routing
+   * table has not changed since.
+   */
 
-  memset(&match, 0, sizeof(struct route_match_s));
-  net_ipaddr_copy(match.target, target);
+  save = net_lock();
+  if (g_routecache.valid && g_routecache.gen == g_routegen &&
+      net_ipaddr_cmp(g_routecache.target, target))
+    {
+      net_ipaddr_copy(match.router, g_routecache.router);
+      ret = g_routecache.found ? 1 : 0;
+    }
+  else
+#endif
+    {
+      /* Set up the comparison structure */
 
-  /* Find an router entry with the routing table that can forward to this
-   * address
-   */
+      memset(&match, 0, sizeof(struct route_match_s));
+      net_ipaddr_copy(match.target, target);
+
+      /* Find an router entry with the routing table that can forward to
+       * this address
+       */
+
+      ret = net_foreachroute(net_match, &match);
+
+#ifdef CONFIG_NET_ROUTE_CACHE
+      g_routecache.gen   = g_routegen;
+      g_routecache.valid = true;
+      g_routecache.found = (ret > 0);
+      net_ipaddr_copy(g_routecache.target, target);
+      net_ipaddr_copy(g_routecache.router, match.router);
+#endif
+    }
+
+#ifdef CONFIG_NET_ROUTE_CACHE
+  net_unlock(save);
+#endif
 
-  ret = net_foreachroute(net_match, &match);
   if (ret > 0)
     {
       /* We found a route.  Return the router address. */
 
 #ifdef CONFIG_NET_IPv6
-      net_ipaddr_copy(router, match.target);
+      net_ipaddr_copy(router, match.router);
 #else
-      net_ipaddr_copy(*router, match.target);
+      net_ipaddr_copy(*router, match.router);
 #endif
       ret = OK;
     }
@@ -43,6 +43,7 @@
 #include <string.h>
 #include <errno.h>
 
+#include <nuttx/net/net.h>
 #include <nuttx/net/netdev.h>
 #include <nuttx/net/ip.h>
 
@@ -62,6 +63,16 @@ struct route_devmatch_s
   net_ipaddr_t router;   /* The IP address of the router on one of our networks*/
 };
 
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_ROUTE_CACHE
+/* The last netdev_router() lookup */
+
+static struct net_routecache_s g_devroutecache;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -89,8 +100,8 @@ static int net_devmatch(FAR struct net_route_s *route, FAR void *arg)
   /* To match, (1) the masked target addresses must be the same, and (2) the
    * router address must like on the network provided by the device.
    *
-   * In the event of multiple matches, only the first is returned.  There
-   * not (yet) any concept for the precedence of networks.
+   * The routing table is ordered by decreasing netmask length, so the
+   * first match is the longest prefix match.
    */
 
   if (net_ipaddr_maskcmp(route->target, match->target, route->netmask) &&
@@ -141,27 +152,65 @@ void netdev_router(FAR struct net_driver_s *dev, net_ipaddr_t target,
 #endif
 {
   struct route_devmatch_s match;
+#ifdef CONFIG_NET_ROUTE_CACHE
+  FAR struct net_routecache_s *cache = &g_devroutecache;
+  net_lock_t save;
+#endif
   int ret;
 
-  /* Set up the comparison structure */
+#ifdef CONFIG_NET_ROUTE_CACHE
+  /* Re-use the last lookup if it was for the same target and device, and
+   * neither the routing table nor the device address has changed since.
+   */
 
-  memset(&match, 0, sizeof(struct route_devmatch_s));
-  match.dev = dev;
-  net_ipaddr_copy(match.target, target);
+  save = net_lock();
+  if (cache->valid && cache->gen == g_routegen && cache->dev == dev &&
+      net_ipaddr_cmp(cache->target, target) &&
+      net_ipaddr_cmp(cache->ipaddr, dev->d_ipaddr) &&
+      net_ipaddr_cmp(cache->netmask, dev->d_netmask))
+    {
+      net_ipaddr_copy(match.router, cache->router);
+      ret = cache->found ? 1 : 0;
+    }
+  else
+#endif
+    {
+      /* Set up the comparison structure */
 
-  /* Find an router entry with the routing table that can forward to this
-   * address using this device.
-   */
+      memset(&match, 0, sizeof(struct route_devmatch_s));
+      match.dev = dev;
+      net_ipaddr_copy(match.target, target);
+
+      /* Find an router entry with the routing table that can forward to
+       * this address using this device.
+       */
+
+      ret = net_foreachroute(net_devmatch, &match);
+
+#ifdef CONFIG_NET_ROUTE_CACHE
+      cache->dev   = dev;
+      cache->gen   = g_routegen;
+      cache->valid = true;
+      cache->found = (ret > 0);
+      net_ipaddr_copy(cache->target, target);
+      net_ipaddr_copy(cache->router, match.router);
+      net_ipaddr_copy(cache->ipaddr, dev->d_ipaddr);
+      net_ipaddr_copy(cache->netmask, dev->d_netmask);
+#endif
+    }
+
+#ifdef CONFIG_NET_ROUTE_CACHE
+  net_unlock(save);
+#endif
 
-  ret = net_foreachroute(net_devmatch, &match);
   if (ret > 0)
     {
       /* We found a route.  Return the router address. */
 
 #ifdef CONFIG_NET_IPv6
-      net_ipaddr_copy(router, match.target);
+      net_ipaddr_copy(router, match.router);
 #else
-      net_ipaddr_copy(*router, match.target);
+      net_ipaddr_copy(*router, match.router);
 #endif
       ret = OK;
     }
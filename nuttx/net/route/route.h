@@ -42,6 +42,8 @@
 
 #include <nuttx/config.h>
 
+#include <stdint.h>
+#include <stdbool.h>
 #include <queue.h>
 
 #include <net/if.h>
@@ -72,6 +74,22 @@ struct net_route_s
   net_ipaddr_t router;           /* Route packets via this router */
 };
 
+#ifdef CONFIG_NET_ROUTE_CACHE
+/* The remembered result of the last route lookup */
+
+struct net_routecache_s
+{
+  FAR struct net_driver_s *dev;  /* Device constraint (netdev_router only) */
+  uint16_t     gen;              /* g_routegen at the time of the lookup */
+  bool         valid;            /* True: The cached lookup may be used */
+  bool         found;            /* True: A route was found */
+  net_ipaddr_t target;           /* The destination that was looked up */
+  net_ipaddr_t router;           /* The router found for the destination */
+  net_ipaddr_t ipaddr;           /* dev->d_ipaddr at the time of the lookup */
+  net_ipaddr_t netmask;          /* dev->d_netmask at the time of the lookup */
+};
+#endif
+
 /* Type of the call out function pointer provided to net_foreachroute() */
 
 typedef int (*route_handler_t)(FAR struct net_route_s *route, FAR void *arg);
@@ -88,10 +106,20 @@ extern "C"
 #define EXTERN extern
 #endif
 
-/* This is the routing table */
+/* This is the routing table.  Routes are kept in order of decreasing
+ * netmask length so that the first match is the longest prefix match.
+ */
 
 EXTERN sq_queue_t g_routes;
 
+#ifdef CONFIG_NET_ROUTE_CACHE
+/* Incremented each time that the routing table changes.  Cached lookups
+ * made under a different generation are stale.
+ */
+
+EXTERN uint16_t g_routegen;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
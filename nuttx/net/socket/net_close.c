@@ -357,6 +357,7 @@ static inline int netclose_disconnect(FAR struct socket *psock)
 
       /* Notify the device driver of the availability of TX data */
 
+      tcp_txready(conn);
       netdev_txnotify(conn->ripaddr);
 
 #ifdef CONFIG_NET_SOLINGER
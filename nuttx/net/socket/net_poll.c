@@ -241,6 +241,17 @@ static inline int net_pollsetup(FAR struct socket *psock,
 
   fds->priv    = (FAR void *)info;
 
+#ifdef CONFIG_NET_POLL_TXREADY
+  /* POLLOUT is reported on TCP_POLL, so have the next devif_poll() visit
+   * this connection.
+   */
+
+  if ((fds->events & POLLOUT) != 0)
+    {
+      tcp_txready(conn);
+    }
+#endif
+
 #ifdef CONFIG_NET_TCPBACKLOG
   /* Check for read data or backlogged connection availability now */
 
@@ -0,0 +1,204 @@
+/****************************************************************************
+ * fs/procfs/fs_procfsrwbuffer.c
+ * net/socket/net_recviob.c
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+#if defined(CONFIG_NET) && defined(CONFIG_NET_TCP) && \
+    defined(CONFIG_NET_TCP_READAHEAD)
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <stdint.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/net/iob.h>
+#include <nuttx/net/net.h>
+
+#include "devif/devif.h"
+#include "tcp/tcp.h"
+#include "socket/socket.h"
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: recviob_interrupt
+ *
+ * Description:
+ *   Wake up psock_recviob() on new data or loss of connection.  The new
+ *   data is not consumed here, so tcp_callback() puts it in the read-ahead
+ *   queue where psock_recviob() will find it.
+ *
+ * Assumptions:
+ *   Running at the interrupt level
+ *
+ ****************************************************************************/
+
+static uint16_t recviob_interrupt(FAR struct net_driver_s *dev,
+                                  FAR void *pvconn, FAR void *pvpriv,
+                                  uint16_t flags)
+{
+  FAR sem_t *sem = (FAR sem_t *)pvpriv;
+
+  if ((flags & (TCP_NEWDATA | TCP_CLOSE | TCP_ABORT | TCP_TIMEDOUT)) != 0)
+    {
+      sem_post(sem);
+    }
+
+  return flags;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Function: psock_recviob
+ *
+ * Description:
+ *   Receive data from a TCP socket as the I/O buffer chain that holds it
+ *   in the read-ahead queue, without copying it into a caller buffer.  The
+ *   caller owns the returned chain and must free it with iob_free_chain().
+ *   Waits until data is available unless the socket is non-blocking or
+ *   MSG_DONTWAIT is given.
+ *
+ * Parameters:
+ *   psock    A pointer to a NuttX-specific, internal socket structure
+ *   iobp     Location to return the I/O buffer chain
+ *   flags    Receive flags
+ *
+ * Returned Value:
+ *   The number of bytes in the returned chain.  Zero if the peer has
+ *   performed an orderly shutdown.  Otherwise -1 with errno set to
+ *   EINVAL, EOPNOTSUPP, ENOTCONN, EAGAIN, ENOMEM or EINTR.
+ *
+ ****************************************************************************/
+
+ssize_t psock_recviob(FAR struct socket *psock, FAR struct iob_s **iobp,
+                      int flags)
+{
+  FAR struct tcp_conn_s *conn;
+  FAR struct devif_callback_s *cb;
+  FAR struct iob_s *iob;
+  net_lock_t save;
+  sem_t sem;
+  ssize_t ret;
+
+  if (psock == NULL || psock->s_crefs <= 0 || iobp == NULL)
+    {
+      ret = -EINVAL;
+      goto errout;
+    }
+
+  if (psock->s_type != SOCK_STREAM)
+    {
+      ret = -EOPNOTSUPP;
+      goto errout;
+    }
+
+  conn = (FAR struct tcp_conn_s *)psock->s_conn;
+  (void)sem_init(&sem, 0, 0);
+
+  save = net_lock();
+  for (; ; )
+    {
+      /* Hand out the whole chain at the head of the read-ahead queue.  Data
+       * may be left there even after the socket has been disconnected.
+       */
+
+      iob = iob_remove_queue(&conn->readahead);
+      if (iob != NULL)
+        {
+          *iobp = iob;
+          ret   = iob->io_pktlen;
+          break;
+        }
+
+      if (!_SS_ISCONNECTED(psock->s_flags))
+        {
+          ret = _SS_ISCLOSED(psock->s_flags) ? 0 : -ENOTCONN;
+          break;
+        }
+
+      if (_SS_ISNONBLOCK(psock->s_flags) || (flags & MSG_DONTWAIT) != 0)
+        {
+          ret = -EAGAIN;
+          break;
+        }
+
+      /* Wait for new data to be queued or for the connection to go away */
+
+      cb = tcp_callback_alloc(conn);
+      if (cb == NULL)
+        {
+          ret = -ENOMEM;
+          break;
+        }
+
+      cb->flags = (TCP_NEWDATA | TCP_CLOSE | TCP_ABORT | TCP_TIMEDOUT);
+      cb->priv  = (FAR void *)&sem;
+      cb->event = recviob_interrupt;
+
+      ret = net_lockedwait(&sem);
+      tcp_callback_free(conn, cb);
+
+      if (ret < 0)
+        {
+          ret = -get_errno();
+          break;
+        }
+    }
+
+  net_unlock(save);
+  sem_destroy(&sem);
+
+  if (ret < 0)
+    {
+      goto errout;
+    }
+
+  return ret;
+
+errout:
+  set_errno(-ret);
+  return ERROR;
+}
+
+#endif /* CONFIG_NET && CONFIG_NET_TCP && CONFIG_NET_TCP_READAHEAD */
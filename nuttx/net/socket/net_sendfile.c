@@ -564,6 +564,7 @@ ssize_t net_sendfile(int outfd, struct file *infile, off_t *offset,
 
       /* Notify the device driver of the availaibilty of TX data */
 
+      tcp_txready(conn);
       netdev_txnotify(conn->ripaddr);
 
       net_lockedwait(&state.snd_sem);
@@ -419,6 +419,7 @@ ssize_t psock_sendto(FAR struct socket *psock, FAR const void *buf,
 
       /* Notify the device driver of the availabilty of TX data */
 
+      udp_txready(conn);
       netdev_txnotify(conn->ripaddr);
 
       /* Wait for either the receive to complete or for an error/timeout to occur.
@@ -107,6 +107,14 @@ struct tcp_backlog_s;     /* Forward reference */
 struct tcp_conn_s
 {
   dq_entry_t node;        /* Implements a doubly linked list */
+#ifdef CONFIG_NET_TCP_HASH
+  FAR struct tcp_conn_s *hnext; /* Next in the active connection hash chain */
+  FAR struct tcp_conn_s *pnext; /* Next in the local port hash chain */
+#endif
+#ifdef CONFIG_NET_POLL_TXREADY
+  dq_entry_t rnode;       /* Entry in the list of connections with output */
+  uint8_t  txready;       /* True: Connection is in the ready list */
+#endif
   net_ipaddr_t ripaddr;   /* The IP address of the remote host */
   uint8_t  rcvseq[4];     /* The sequence number that we expect to
                            * receive next */
@@ -331,6 +339,26 @@ FAR struct tcp_conn_s *tcp_active(struct tcp_iphdr_s *buf);
 
 FAR struct tcp_conn_s *tcp_nextconn(FAR struct tcp_conn_s *conn);
 
+/****************************************************************************
+ * Name: tcp_txready(), tcp_txdone() and tcp_nextready()
+ *
+ * Description:
+ *   Add a connection with pending output to the ready list, remove it from
+ *   the ready list, and traverse the ready list.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_POLL_TXREADY
+void tcp_txready(FAR struct tcp_conn_s *conn);
+void tcp_txdone(FAR struct tcp_conn_s *conn);
+FAR struct tcp_conn_s *tcp_nextready(FAR struct tcp_conn_s *conn);
+#else
+#  define tcp_txready(conn)
+#endif
+
 /****************************************************************************
  * Name: tcp_listener()
  *
@@ -44,6 +44,8 @@
 #if defined(CONFIG_NET) && defined(CONFIG_NET_TCP)
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 #include <assert.h>
 #include <errno.h>
@@ -60,6 +62,26 @@
 #include "devif/devif.h"
 #include "tcp/tcp.h"
 
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_TCP_HASH
+#  if (CONFIG_NET_TCP_HASHSIZE & (CONFIG_NET_TCP_HASHSIZE - 1)) != 0
+#    error CONFIG_NET_TCP_HASHSIZE must be a power of two
+#  endif
+
+#  define TCP_HASHMASK (CONFIG_NET_TCP_HASHSIZE - 1)
+
+/* Only the ports are hashed with IPv6 addresses */
+
+#  ifdef CONFIG_NET_IPv6
+#    define TCP_IPHASH(a) 0
+#  else
+#    define TCP_IPHASH(a) ((uint32_t)(a))
+#  endif
+#endif
+
 /****************************************************************************
  * Public Data
  ****************************************************************************/
@@ -80,14 +102,139 @@ static dq_queue_t g_free_tcp_connections;
 
 static dq_queue_t g_active_tcp_connections;
 
+#ifdef CONFIG_NET_POLL_TXREADY
+/* A list of active connections with pending output */
+
+static dq_queue_t g_ready_tcp_connections;
+#endif
+
 /* Last port used by a TCP connection connection. */
 
 static uint16_t g_last_tcp_port;
 
+#ifdef CONFIG_NET_TCP_HASH
+/* Active connections hashed by remote address, remote and local port */
+
+static FAR struct tcp_conn_s *g_tcp_connhash[CONFIG_NET_TCP_HASHSIZE];
+
+/* Connections with a local port, hashed by that port */
+
+static FAR struct tcp_conn_s *g_tcp_porthash[CONFIG_NET_TCP_HASHSIZE];
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
+#ifdef CONFIG_NET_TCP_HASH
+/****************************************************************************
+ * Name: tcp_connhash() and tcp_porthash()
+ *
+ * Description:
+ *   Return the hash bucket of a connection 4-tuple or of a local port.
+ *   All values are in network order.
+ *
+ ****************************************************************************/
+
+static inline unsigned int tcp_connhash(uint32_t ripaddr, uint16_t lport,
+                                        uint16_t rport)
+{
+  uint32_t hash = ripaddr ^ ((uint32_t)lport << 16) ^ rport;
+
+  hash ^= hash >> 16;
+  hash ^= hash >> 8;
+  return hash & TCP_HASHMASK;
+}
+
+static inline unsigned int tcp_porthash(uint16_t lport)
+{
+  return (lport ^ (lport >> 8)) & TCP_HASHMASK;
+}
+
+/****************************************************************************
+ * Name: tcp_hashremove
+ *
+ * Description:
+ *   Remove a connection from a hash chain
+ *
+ ****************************************************************************/
+
+static void tcp_hashremove(FAR struct tcp_conn_s **head,
+                           FAR struct tcp_conn_s *conn, bool port)
+{
+  FAR struct tcp_conn_s **link;
+
+  for (link = head; *link != NULL;
+       link = port ? &(*link)->pnext : &(*link)->hnext)
+    {
+      if (*link == conn)
+        {
+          *link = port ? conn->pnext : conn->hnext;
+          return;
+        }
+    }
+}
+#endif
+
+/****************************************************************************
+ * Name: tcp_setlport
+ *
+ * Description:
+ *   Set the local port of a connection (network order), keeping the local
+ *   port hash up to date.
+ *
+ * Assumptions:
+ *   The network is locked
+ *
+ ****************************************************************************/
+
+static void tcp_setlport(FAR struct tcp_conn_s *conn, uint16_t lport)
+{
+#ifdef CONFIG_NET_TCP_HASH
+  FAR struct tcp_conn_s **head;
+
+  if (conn->lport != 0)
+    {
+      tcp_hashremove(&g_tcp_porthash[tcp_porthash(conn->lport)], conn, true);
+    }
+
+  if (lport != 0)
+    {
+      head        = &g_tcp_porthash[tcp_porthash(lport)];
+      conn->pnext = *head;
+      *head       = conn;
+    }
+#endif
+
+  conn->lport = lport;
+}
+
+/****************************************************************************
+ * Name: tcp_addactive
+ *
+ * Description:
+ *   Add a connection to the active list (and hash).  The remote address and
+ *   both ports must already be set.
+ *
+ * Assumptions:
+ *   The network is locked
+ *
+ ****************************************************************************/
+
+static void tcp_addactive(FAR struct tcp_conn_s *conn)
+{
+#ifdef CONFIG_NET_TCP_HASH
+  FAR struct tcp_conn_s **head;
+
+  head        = &g_tcp_connhash[tcp_connhash(TCP_IPHASH(conn->ripaddr),
+                                             conn->lport, conn->rport)];
+  conn->hnext = *head;
+  *head       = conn;
+#endif
+
+  dq_addlast(&conn->node, &g_active_tcp_connections);
+}
+
 /****************************************************************************
  * Name: tcp_selectport()
  *
@@ -179,6 +326,9 @@ void tcp_initialize(void)
 
   dq_init(&g_free_tcp_connections);
   dq_init(&g_active_tcp_connections);
+#ifdef CONFIG_NET_POLL_TXREADY
+  dq_init(&g_ready_tcp_connections);
+#endif
 
   /* Now initialize each connection structure */
 
@@ -351,8 +501,23 @@ void tcp_free(FAR struct tcp_conn_s *conn)
       /* Remove the connection from the active list */
 
       dq_rem(&conn->node, &g_active_tcp_connections);
+#ifdef CONFIG_NET_TCP_HASH
+      tcp_hashremove(&g_tcp_connhash[tcp_connhash(TCP_IPHASH(conn->ripaddr),
+                                                  conn->lport, conn->rport)],
+                     conn, false);
+#endif
     }
 
+  /* Release the local port */
+
+  tcp_setlport(conn, 0);
+
+#ifdef CONFIG_NET_POLL_TXREADY
+  /* And drop any pending poll */
+
+  tcp_txdone(conn);
+#endif
+
 #ifdef CONFIG_NET_TCP_READAHEAD
   /* Release any read-ahead buffers attached to the connection */
 
@@ -412,8 +577,14 @@ void tcp_free(FAR struct tcp_conn_s *conn)
 
 FAR struct tcp_conn_s *tcp_active(struct tcp_iphdr_s *buf)
 {
-  FAR struct tcp_conn_s *conn = (struct tcp_conn_s *)g_active_tcp_connections.head;
   in_addr_t srcipaddr = net_ip4addr_conv32(buf->srcipaddr);
+#ifdef CONFIG_NET_TCP_HASH
+  FAR struct tcp_conn_s *conn =
+    g_tcp_connhash[tcp_connhash(TCP_IPHASH(srcipaddr), buf->destport,
+                                buf->srcport)];
+#else
+  FAR struct tcp_conn_s *conn = (struct tcp_conn_s *)g_active_tcp_connections.head;
+#endif
 
   while (conn)
     {
@@ -432,7 +603,11 @@ FAR struct tcp_conn_s *tcp_active(struct tcp_iphdr_s *buf)
 
       /* Look at the next active connection */
 
+#ifdef CONFIG_NET_TCP_HASH
+      conn = conn->hnext;
+#else
       conn = (FAR struct tcp_conn_s *)conn->node.flink;
+#endif
     }
 
   return conn;
@@ -462,6 +637,74 @@ FAR struct tcp_conn_s *tcp_nextconn(FAR struct tcp_conn_s *conn)
     }
 }
 
+/****************************************************************************
+ * Name: tcp_txready()
+ *
+ * Description:
+ *   Add a connection with pending output to the ready list serviced by
+ *   devif_poll().  Does nothing if it is already there.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_POLL_TXREADY
+void tcp_txready(FAR struct tcp_conn_s *conn)
+{
+  if (!conn->txready)
+    {
+      conn->txready = true;
+      dq_addlast(&conn->rnode, &g_ready_tcp_connections);
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_txdone()
+ *
+ * Description:
+ *   Remove a connection from the ready list
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void tcp_txdone(FAR struct tcp_conn_s *conn)
+{
+  if (conn->txready)
+    {
+      conn->txready = false;
+      dq_rem(&conn->rnode, &g_ready_tcp_connections);
+    }
+}
+
+/****************************************************************************
+ * Name: tcp_nextready()
+ *
+ * Description:
+ *   Traverse the list of TCP connections with pending output
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+FAR struct tcp_conn_s *tcp_nextready(FAR struct tcp_conn_s *conn)
+{
+  FAR dq_entry_t *node;
+
+  node = conn ? conn->rnode.flink : g_ready_tcp_connections.head;
+  if (!node)
+    {
+      return NULL;
+    }
+
+  return (FAR struct tcp_conn_s *)
+    ((FAR uint8_t *)node - offsetof(struct tcp_conn_s, rnode));
+}
+#endif
+
 /****************************************************************************
  * Name: tcp_listener()
  *
@@ -477,13 +720,20 @@ FAR struct tcp_conn_s *tcp_nextconn(FAR struct tcp_conn_s *conn)
 FAR struct tcp_conn_s *tcp_listener(uint16_t portno)
 {
   FAR struct tcp_conn_s *conn;
+#ifndef CONFIG_NET_TCP_HASH
   int i;
+#endif
 
   /* Check if this port number is in use by any active UIP TCP connection */
 
+#ifdef CONFIG_NET_TCP_HASH
+  for (conn = g_tcp_porthash[tcp_porthash(portno)]; conn; conn = conn->pnext)
+    {
+#else
   for (i = 0; i < CONFIG_NET_TCP_CONNS; i++)
     {
       conn = &g_tcp_connections[i];
+#endif
       if (conn->tcpstateflags != TCP_CLOSED && conn->lport == portno)
         {
           /* The port number is in use, return the connection */
@@ -520,11 +770,11 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct tcp_iphdr_s *buf)
       conn->sa            = 0;
       conn->sv            = 4;
       conn->nrtx          = 0;
-      conn->lport         = buf->destport;
       conn->rport         = buf->srcport;
       conn->mss           = TCP_INITIAL_MSS;
       net_ipaddr_copy(conn->ripaddr, net_ip4addr_conv32(buf->srcipaddr));
       conn->tcpstateflags = TCP_SYN_RCVD;
+      tcp_setlport(conn, buf->destport);
 
       tcp_initsequence(conn->sndseq);
       conn->unacked       = 1;
@@ -555,7 +805,7 @@ FAR struct tcp_conn_s *tcp_alloc_accept(FAR struct tcp_iphdr_s *buf)
        * Interrupts should already be disabled in this context.
        */
 
-      dq_addlast(&conn->node, &g_active_tcp_connections);
+      tcp_addactive(conn);
     }
 
   return conn;
@@ -591,10 +841,9 @@ int tcp_bind(FAR struct tcp_conn_s *conn,
 
   flags = net_lock();
   port = tcp_selectport(ntohs(addr->sin_port));
-  net_unlock(flags);
-
   if (port < 0)
     {
+      net_unlock(flags);
       return port;
     }
 
@@ -603,7 +852,8 @@ int tcp_bind(FAR struct tcp_conn_s *conn,
    * interface is supported, the IP address is not of importance.
    */
 
-  conn->lport = addr->sin_port;
+  tcp_setlport(conn, addr->sin_port);
+  net_unlock(flags);
 
 #if 0 /* Not used */
 #ifdef CONFIG_NET_IPv6
@@ -663,13 +913,15 @@ int tcp_connect(FAR struct tcp_conn_s *conn,
 
   flags = net_lock();
   port = tcp_selectport(ntohs(conn->lport));
-  net_unlock(flags);
-
   if (port < 0)
     {
+      net_unlock(flags);
       return port;
     }
 
+  tcp_setlport(conn, htons((uint16_t)port));
+  net_unlock(flags);
+
   /* Initialize and return the connection structure, bind it to the port number */
 
   conn->tcpstateflags = TCP_SYN_SENT;
@@ -682,7 +934,6 @@ int tcp_connect(FAR struct tcp_conn_s *conn,
   conn->rto        = TCP_RTO;
   conn->sa         = 0;
   conn->sv         = 16;   /* Initial value of the RTT variance. */
-  conn->lport      = htons((uint16_t)port);
 #ifdef CONFIG_NET_TCP_WRITE_BUFFERS
   conn->expired    = 0;
   conn->isn        = 0;
@@ -717,7 +968,7 @@ int tcp_connect(FAR struct tcp_conn_s *conn,
    */
 
   flags = net_lock();
-  dq_addlast(&conn->node, &g_active_tcp_connections);
+  tcp_addactive(conn);
   net_unlock(flags);
 
   return OK;
@@ -437,6 +437,10 @@ found:
 
        flags |= TCP_ACKDATA;
 
+       /* The ACK may have opened the window for more queued output */
+
+       tcp_txready(conn);
+
        /* Reset the retransmission timer. */
 
        conn->timer = conn->rto;
@@ -79,6 +79,17 @@
  * Pre-processor Definitions
  ****************************************************************************/
 
+/* With several segments sent per poll, only send into the part of the
+ * peer's window that is not already in flight.
+ */
+
+#if CONFIG_NET_TCP_TXBATCH > 1
+#  define TCP_SNDWND(c) \
+     ((c)->unacked < (c)->winsize ? (c)->winsize - (c)->unacked : 0)
+#else
+#  define TCP_SNDWND(c) ((c)->winsize)
+#endif
+
 #define TCPBUF ((struct tcp_iphdr_s *)&dev->d_buf[NET_LL_HDRLEN])
 
 /* Debug */
@@ -529,6 +540,9 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
 
   if ((conn->tcpstateflags & TCP_ESTABLISHED) &&
       (flags & (TCP_POLL | TCP_REXMIT)) &&
+#if CONFIG_NET_TCP_TXBATCH > 1
+      TCP_SNDWND(conn) > 0 &&
+#endif
       !(sq_empty(&conn->write_q)))
     {
       /* Check if the destination IP address is in the ARP table.  If not,
@@ -574,9 +588,9 @@ static uint16_t psock_send_interrupt(FAR struct net_driver_s *dev,
               sndlen = tcp_mss(conn);
             }
 
-          if (sndlen > conn->winsize)
+          if (sndlen > TCP_SNDWND(conn))
             {
-              sndlen = conn->winsize;
+              sndlen = TCP_SNDWND(conn);
             }
 
           nllvdbg("SEND: wrb=%p pktlen=%u sent=%u sndlen=%u\n",
@@ -727,6 +741,7 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
                        size_t len)
 {
   FAR struct tcp_conn_s *conn;
+  FAR struct tcp_wrbuffer_s *wrb = NULL;
   net_lock_t save;
   ssize_t    result = 0;
   int        err;
@@ -767,6 +782,28 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
 
   psock->s_flags = _SS_SETSTATE(psock->s_flags, _SF_SEND);
 
+  /* Get a write buffer and fill it before taking the network lock:  Both
+   * may wait for free buffers, which are only returned when ACKs are
+   * processed, and the copy need not hold up the rest of the stack.
+   */
+
+  if (len > 0)
+    {
+      wrb = tcp_wrbuffer_alloc();
+      if (wrb)
+        {
+          /* Initialize the write buffer */
+
+          WRB_SEQNO(wrb) = (unsigned)-1;
+          WRB_NRTX(wrb)  = 0;
+          WRB_COPYIN(wrb, (FAR uint8_t *)buf, len);
+
+          /* Dump I/O buffer chain */
+
+          WRB_DUMP("I/O buffer chain", wrb, WRB_PKTLEN(wrb), 0);
+        }
+    }
+
   save = net_lock();
 
   if (len > 0)
@@ -786,11 +823,14 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
 
           ndbg("ERROR: Failed to allocate callback\n");
           result = -ENOMEM;
+
+          if (wrb)
+            {
+              tcp_wrbuffer_release(wrb);
+            }
         }
       else
         {
-          FAR struct tcp_wrbuffer_s *wrb;
-
           /* Set up the callback in the connection */
 
           psock->s_sndcb->flags = (TCP_ACKDATA | TCP_REXMIT | TCP_POLL |
@@ -798,21 +838,8 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
           psock->s_sndcb->priv  = (void*)psock;
           psock->s_sndcb->event = psock_send_interrupt;
 
-          /* Allocate an write buffer */
-
-          wrb = tcp_wrbuffer_alloc();
           if (wrb)
             {
-              /* Initialize the write buffer */
-
-              WRB_SEQNO(wrb) = (unsigned)-1;
-              WRB_NRTX(wrb)  = 0;
-              WRB_COPYIN(wrb, (FAR uint8_t *)buf, len);
-
-              /* Dump I/O buffer chain */
-
-              WRB_DUMP("I/O buffer chain", wrb, WRB_PKTLEN(wrb), 0);
-
               /* psock_send_interrupt() will send data in FIFO order from the
                * conn->write_q
                */
@@ -824,6 +851,7 @@ ssize_t psock_tcp_send(FAR struct socket *psock, FAR const void *buf,
 
               /* Notify the device driver of the availability of TX data */
 
+              tcp_txready(conn);
               netdev_txnotify(conn->ripaddr);
               result = len;
             }
@@ -596,6 +596,7 @@ ssize_t psock_tcp_send(FAR struct socket *psock,
 
           /* Notify the device driver of the availability of TX data */
 
+          tcp_txready(conn);
           netdev_txnotify(conn->ripaddr);
 
           /* Wait for the send to complete or an error to occur:  NOTES: (1)
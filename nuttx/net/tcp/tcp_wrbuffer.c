@@ -54,6 +54,7 @@
 #include <assert.h>
 #include <debug.h>
 
+#include <nuttx/net/net.h>
 #include <nuttx/net/iob.h>
 
 #include "tcp/tcp.h"
@@ -132,13 +133,15 @@ void tcp_wrbuffer_initialize(void)
  *   None
  *
  * Assumptions:
- *   Called from user logic with interrupts enabled.
+ *   Called from user logic with interrupts enabled.  The caller need not
+ *   hold the network lock (and should not, since this may wait).
  *
  ****************************************************************************/
 
 FAR struct tcp_wrbuffer_s *tcp_wrbuffer_alloc(void)
 {
   FAR struct tcp_wrbuffer_s *wrb;
+  net_lock_t save;
 
   /* We need to allocate two things:  (1) A write buffer structure and (2)
    * at least one I/O buffer to start the chain.
@@ -151,10 +154,13 @@ FAR struct tcp_wrbuffer_s *tcp_wrbuffer_alloc(void)
   DEBUGVERIFY(sem_wait(&g_wrbuffer.sem));
 
   /* Now, we are guaranteed to have a write buffer structure reserved
-   * for us in the free list.
+   * for us in the free list.  The free list is also appended to from the
+   * interrupt level, so only its removal is locked.
    */
 
-  wrb = (FAR struct tcp_wrbuffer_s *)sq_remfirst(&g_wrbuffer.freebuffers);
+  save = net_lock();
+  wrb  = (FAR struct tcp_wrbuffer_s *)sq_remfirst(&g_wrbuffer.freebuffers);
+  net_unlock(save);
   DEBUGASSERT(wrb);
   memset(wrb, 0, sizeof(struct tcp_wrbuffer_s));
 
@@ -164,7 +170,11 @@ FAR struct tcp_wrbuffer_s *tcp_wrbuffer_alloc(void)
   if (!wrb->wb_iob)
     {
       ndbg("ERROR: Failed to allocate I/O buffer\n");
-      tcp_wrbuffer_release(wrb);
+
+      save = net_lock();
+      sq_addlast(&wrb->wb_node, &g_wrbuffer.freebuffers);
+      net_unlock(save);
+      sem_post(&g_wrbuffer.sem);
       return NULL;
     }
 
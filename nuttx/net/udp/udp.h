@@ -71,6 +71,10 @@ struct udp_conn_s
   uint16_t rport;         /* The remote port number in network byte order */
   uint8_t  ttl;           /* Default time-to-live */
   uint8_t  crefs;         /* Reference counts on this instance */
+#ifdef CONFIG_NET_POLL_TXREADY
+  uint8_t  txready;       /* True: Connection is in the ready list */
+  dq_entry_t rnode;       /* Entry in the list of connections with output */
+#endif
 
   /* Defines the list of UDP callbacks */
 
@@ -158,6 +162,26 @@ FAR struct udp_conn_s *udp_active(FAR struct udp_iphdr_s *buf);
 
 FAR struct udp_conn_s *udp_nextconn(FAR struct udp_conn_s *conn);
 
+/****************************************************************************
+ * Name: udp_txready(), udp_txdone() and udp_nextready()
+ *
+ * Description:
+ *   Add a connection with pending output to the ready list, remove it from
+ *   the ready list, and traverse the ready list.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_POLL_TXREADY
+void udp_txready(FAR struct udp_conn_s *conn);
+void udp_txdone(FAR struct udp_conn_s *conn);
+FAR struct udp_conn_s *udp_nextready(FAR struct udp_conn_s *conn);
+#else
+#  define udp_txready(conn)
+#endif
+
 /****************************************************************************
  * Name: udp_bind()
  *
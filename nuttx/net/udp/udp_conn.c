@@ -44,6 +44,8 @@
 #if defined(CONFIG_NET) && defined(CONFIG_NET_UDP)
 
 #include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <string.h>
 #include <semaphore.h>
 #include <assert.h>
@@ -78,6 +80,12 @@ static sem_t g_free_sem;
 
 static dq_queue_t g_active_udp_connections;
 
+#ifdef CONFIG_NET_POLL_TXREADY
+/* A list of active connections with pending output */
+
+static dq_queue_t g_ready_udp_connections;
+#endif
+
 /* Last port used by a UDP connection connection. */
 
 static uint16_t g_last_udp_port;
@@ -213,6 +221,9 @@ void udp_initialize(void)
 
   dq_init(&g_free_udp_connections);
   dq_init(&g_active_udp_connections);
+#ifdef CONFIG_NET_POLL_TXREADY
+  dq_init(&g_ready_udp_connections);
+#endif
   sem_init(&g_free_sem, 0, 1);
 
   for (i = 0; i < CONFIG_NET_UDP_CONNS; i++)
@@ -250,6 +261,9 @@ FAR struct udp_conn_s *udp_alloc(void)
       /* Make sure that the connection is marked as uninitialized */
 
       conn->lport = 0;
+#ifdef CONFIG_NET_POLL_TXREADY
+      conn->txready = false;
+#endif
 
       /* Enqueue the connection into the active list */
 
@@ -271,6 +285,10 @@ FAR struct udp_conn_s *udp_alloc(void)
 
 void udp_free(FAR struct udp_conn_s *conn)
 {
+#ifdef CONFIG_NET_POLL_TXREADY
+  net_lock_t flags;
+#endif
+
   /* The free list is only accessed from user, non-interrupt level and
    * is protected by a semaphore (that behaves like a mutex).
    */
@@ -280,6 +298,14 @@ void udp_free(FAR struct udp_conn_s *conn)
   _udp_semtake(&g_free_sem);
   conn->lport = 0;
 
+#ifdef CONFIG_NET_POLL_TXREADY
+  /* Drop any pending poll.  The ready list is used by devif_poll() */
+
+  flags = net_lock();
+  udp_txdone(conn);
+  net_unlock(flags);
+#endif
+
   /* Remove the connection from the active list */
 
   dq_rem(&conn->node, &g_active_udp_connections);
@@ -361,6 +387,74 @@ FAR struct udp_conn_s *udp_nextconn(FAR struct udp_conn_s *conn)
     }
 }
 
+/****************************************************************************
+ * Name: udp_txready()
+ *
+ * Description:
+ *   Add a connection with pending output to the ready list serviced by
+ *   devif_poll().  Does nothing if it is already there.
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_NET_POLL_TXREADY
+void udp_txready(FAR struct udp_conn_s *conn)
+{
+  if (!conn->txready)
+    {
+      conn->txready = true;
+      dq_addlast(&conn->rnode, &g_ready_udp_connections);
+    }
+}
+
+/****************************************************************************
+ * Name: udp_txdone()
+ *
+ * Description:
+ *   Remove a connection from the ready list
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+void udp_txdone(FAR struct udp_conn_s *conn)
+{
+  if (conn->txready)
+    {
+      conn->txready = false;
+      dq_rem(&conn->rnode, &g_ready_udp_connections);
+    }
+}
+
+/****************************************************************************
+ * Name: udp_nextready()
+ *
+ * Description:
+ *   Traverse the list of UDP connections with pending output
+ *
+ * Assumptions:
+ *   The network is locked.
+ *
+ ****************************************************************************/
+
+FAR struct udp_conn_s *udp_nextready(FAR struct udp_conn_s *conn)
+{
+  FAR dq_entry_t *node;
+
+  node = conn ? conn->rnode.flink : g_ready_udp_connections.head;
+  if (!node)
+    {
+      return NULL;
+    }
+
+  return (FAR struct udp_conn_s *)
+    ((FAR uint8_t *)node - offsetof(struct udp_conn_s, rnode));
+}
+#endif
+
 /****************************************************************************
  * Name: udp_bind()
  *
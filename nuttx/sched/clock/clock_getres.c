@@ -44,6 +44,8 @@
 #include <errno.h>
 #include <debug.h>
 
+#include <nuttx/clocksource.h>
+
 #include "clock/clock.h"
 
 /************************************************************************
@@ -92,6 +94,15 @@ int clock_getres(clockid_t clock_id, struct timespec *res)
 
   sdbg("clock_id=%d\n", clock_id);
 
+#ifdef CONFIG_CLOCKSOURCE
+  if (clock_id == CLOCK_MONOTONIC_RAW && clocksource_resolution() > 0)
+    {
+      res->tv_sec  = 0;
+      res->tv_nsec = clocksource_resolution();
+      return OK;
+    }
+#endif
+
   /* Only CLOCK_REALTIME is supported */
 
   if (clock_id != CLOCK_REALTIME)
@@ -39,6 +39,7 @@
 
 #include <nuttx/config.h>
 #include <nuttx/rtc.h>
+#include <nuttx/clocksource.h>
 
 #include <stdint.h>
 #include <time.h>
@@ -123,6 +124,23 @@ int clock_gettime(clockid_t clock_id, struct timespec *tp)
   else
 #endif
 
+#ifdef CONFIG_CLOCKSOURCE
+  /* CLOCK_MONOTONIC_RAW is the high resolution clock source without the
+   * fall back to the system timer.
+   */
+
+  if (clock_id == CLOCK_MONOTONIC_RAW)
+    {
+      ret = clocksource_gettime(tp);
+      if (ret < 0)
+        {
+          set_errno(-ret);
+          ret = ERROR;
+        }
+    }
+  else
+#endif
+
   /* CLOCK_REALTIME - POSIX demands this to be present.  CLOCK_REALTIME
    * represents the machine's best-guess as to the current wall-clock,
    * time-of-day time. This means that CLOCK_REALTIME can jump forward and
@@ -0,0 +1,281 @@
+/****************************************************************************
+ * sched/clock/clock_source.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <time.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <arch/irq.h>
+#include <nuttx/clock.h>
+#include <nuttx/wdog.h>
+#include <nuttx/clocksource.h>
+
+#include "clock/clock.h"
+
+#ifdef CONFIG_CLOCKSOURCE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define NSEC_PER_SEC64  1000000000ull
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* The time is base_ns plus the counter cycles elapsed since base_cycles,
+ * converted with ns = (cycles * mult) >> shift.  The base moves forward
+ * four times per counter wrap period, so the cycles elapsed always fit in
+ * 32 bits and the product in 64 bits.
+ *
+ * The base is only written with interrupts disabled.  seq is odd while it
+ * is being written: the readers, which take no lock, retry if it was odd
+ * or changed while they read.
+ */
+
+struct clocksource_state_s
+{
+  FAR const struct clocksource_s *cs;
+  volatile uint32_t seq;
+  volatile uint32_t base_cycles;
+  volatile uint64_t base_ns;
+  uint32_t mult;
+  uint32_t shift;
+  WDOG_ID wdog;
+  uint32_t delay;                       /* Base update period in ticks */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static struct clocksource_state_s g_clocksource;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: clocksource_read
+ *
+ * Description:
+ *   Read the base and the counter consistently.
+ *
+ ****************************************************************************/
+
+static void clocksource_read(FAR const struct clocksource_s *cs,
+                             FAR uint64_t *base_ns, FAR uint32_t *cycles)
+{
+  uint32_t seq;
+
+  do
+    {
+      seq      = g_clocksource.seq;
+      *base_ns = g_clocksource.base_ns;
+      *cycles  = cs->read() - g_clocksource.base_cycles;
+    }
+  while ((seq & 1) != 0 || seq != g_clocksource.seq);
+}
+
+/****************************************************************************
+ * Name: clocksource_update
+ *
+ * Description:
+ *   Move the base to now.  Runs from the watchdog timer, in interrupt
+ *   context.
+ *
+ ****************************************************************************/
+
+static void clocksource_update(int argc, uint32_t arg)
+{
+  FAR const struct clocksource_s *cs = g_clocksource.cs;
+  irqstate_t flags;
+  uint32_t now;
+
+  flags = irqsave();
+
+  g_clocksource.seq++;
+  now = cs->read();
+  g_clocksource.base_ns += ((uint64_t)(now - g_clocksource.base_cycles) *
+                            g_clocksource.mult) >> g_clocksource.shift;
+  g_clocksource.base_cycles = now;
+  g_clocksource.seq++;
+
+  irqrestore(flags);
+
+  (void)wd_start(g_clocksource.wdog, g_clocksource.delay,
+                 (wdentry_t)clocksource_update, 1, 0);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: clocksource_register
+ ****************************************************************************/
+
+int clocksource_register(FAR const struct clocksource_s *cs)
+{
+  struct timespec ts;
+  irqstate_t flags;
+  uint64_t mult;
+  uint32_t shift;
+  uint32_t msec;
+
+  if (cs == NULL || cs->read == NULL || cs->freq == 0 || g_clocksource.cs)
+    {
+      return -EINVAL;
+    }
+
+  /* The largest shift keeping mult, the nanoseconds per cycle scaled by
+   * 2^shift, in 32 bits gives the most precise conversion.
+   */
+
+  for (shift = 32; shift > 0; shift--)
+    {
+      mult = ((NSEC_PER_SEC64 << shift) + cs->freq / 2) / cs->freq;
+      if (mult <= UINT32_MAX)
+        {
+          break;
+        }
+    }
+
+  if (shift == 0 || mult == 0)
+    {
+      return -EINVAL;
+    }
+
+  /* Update the base four times per wrap period of the counter */
+
+  msec = (uint32_t)((((uint64_t)1 << 32) * MSEC_PER_SEC) / cs->freq / 4);
+  g_clocksource.delay = MSEC2TICK(msec);
+  if (g_clocksource.delay == 0)
+    {
+      return -EINVAL;
+    }
+
+  g_clocksource.wdog = wd_create();
+  if (g_clocksource.wdog == NULL)
+    {
+      return -ENOMEM;
+    }
+
+  /* Continue from the current CLOCK_MONOTONIC */
+
+  (void)clock_systimespec(&ts);
+
+  flags = irqsave();
+  g_clocksource.mult        = (uint32_t)mult;
+  g_clocksource.shift       = shift;
+  g_clocksource.base_ns     = (uint64_t)ts.tv_sec * NSEC_PER_SEC64 +
+                              ts.tv_nsec;
+  g_clocksource.base_cycles = cs->read();
+  g_clocksource.cs          = cs;
+  irqrestore(flags);
+
+  (void)wd_start(g_clocksource.wdog, g_clocksource.delay,
+                 (wdentry_t)clocksource_update, 1, 0);
+
+  slldbg("%s: %lu Hz\n", cs->name, (unsigned long)cs->freq);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: clocksource_getns
+ ****************************************************************************/
+
+uint64_t clocksource_getns(void)
+{
+  FAR const struct clocksource_s *cs = g_clocksource.cs;
+  uint64_t base_ns;
+  uint32_t cycles;
+
+  if (cs == NULL)
+    {
+      return 0;
+    }
+
+  clocksource_read(cs, &base_ns, &cycles);
+  return base_ns + (((uint64_t)cycles * g_clocksource.mult) >>
+                    g_clocksource.shift);
+}
+
+/****************************************************************************
+ * Name: clocksource_gettime
+ ****************************************************************************/
+
+int clocksource_gettime(FAR struct timespec *ts)
+{
+  uint64_t ns;
+  uint32_t secs;
+
+  if (g_clocksource.cs == NULL)
+    {
+      return -ENODEV;
+    }
+
+  ns   = clocksource_getns();
+  secs = (uint32_t)(ns / NSEC_PER_SEC64);
+
+  ts->tv_sec  = (time_t)secs;
+  ts->tv_nsec = (long)(ns - (uint64_t)secs * NSEC_PER_SEC64);
+  return OK;
+}
+
+/****************************************************************************
+ * Name: clocksource_resolution
+ ****************************************************************************/
+
+uint32_t clocksource_resolution(void)
+{
+  FAR const struct clocksource_s *cs = g_clocksource.cs;
+
+  if (cs == NULL)
+    {
+      return 0;
+    }
+
+  return (uint32_t)((NSEC_PER_SEC64 + cs->freq - 1) / cs->freq);
+}
+
+#endif /* CONFIG_CLOCKSOURCE */
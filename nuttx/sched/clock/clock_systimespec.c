@@ -46,6 +46,7 @@
 #include <nuttx/clock.h>
 #include <nuttx/rtc.h>
 #include <nuttx/hires_tmr.h>
+#include <nuttx/clocksource.h>
 
 #include "clock/clock.h"
 
@@ -90,6 +91,15 @@ int clock_systimespec(FAR struct timespec *ts)
       return up_rtc_gettime(ts);
     }
   else
+#endif
+#ifdef CONFIG_CLOCKSOURCE
+  /* Or a high resolution clock source? */
+
+  if (clocksource_gettime(ts) == OK)
+    {
+      return OK;
+    }
+  else
 #endif
     {
 #if defined(CONFIG_SCHED_TICKLESS)
@@ -0,0 +1,182 @@
+/****************************************************************************
+ * sched/init/boot_defer.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdbool.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/bootphase.h>
+#include <nuttx/kthread.h>
+#include <arch/irq.h>
+
+#ifdef CONFIG_BOOT_DEFER
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+/* One deferred initialization */
+
+struct boot_defer_s
+{
+  FAR const char *name;        /* Name, also used as the boot trace mark */
+  boot_defer_t func;           /* Function to call */
+  FAR void *arg;               /* Its argument */
+};
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+static struct boot_defer_s g_boot_defer[CONFIG_BOOT_DEFER_NENTRIES];
+static int g_boot_defer_count;
+static bool g_boot_defer_started;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: boot_defer_thread
+ *
+ * Description:
+ *   Run the queued functions in order, then exit.  The queue is frozen
+ *   once boot_defer_start() is called so it can be walked without locks.
+ *
+ ****************************************************************************/
+
+static int boot_defer_thread(int argc, FAR char *argv[])
+{
+  int i;
+
+  for (i = 0; i < g_boot_defer_count; i++)
+    {
+      g_boot_defer[i].func(g_boot_defer[i].arg);
+      boottrace_mark(g_boot_defer[i].name);
+    }
+
+  boottrace_mark("boot_defer done");
+  return OK;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: boot_defer
+ ****************************************************************************/
+
+int boot_defer(FAR const char *name, boot_defer_t func, FAR void *arg)
+{
+  irqstate_t flags;
+  bool queued = false;
+
+  if (!func)
+    {
+      return -EINVAL;
+    }
+
+  flags = irqsave();
+  if (!g_boot_defer_started &&
+      g_boot_defer_count < CONFIG_BOOT_DEFER_NENTRIES)
+    {
+      g_boot_defer[g_boot_defer_count].name = name;
+      g_boot_defer[g_boot_defer_count].func = func;
+      g_boot_defer[g_boot_defer_count].arg  = arg;
+      g_boot_defer_count++;
+      queued = true;
+    }
+
+  irqrestore(flags);
+
+  if (!queued)
+    {
+      func(arg);
+    }
+
+  return OK;
+}
+
+/****************************************************************************
+ * Name: boot_defer_start
+ ****************************************************************************/
+
+int boot_defer_start(void)
+{
+  irqstate_t flags;
+  bool started;
+  int pid;
+  int i;
+
+  flags = irqsave();
+  started = g_boot_defer_started;
+  g_boot_defer_started = true;
+  irqrestore(flags);
+
+  if (started)
+    {
+      return -EALREADY;
+    }
+
+  boottrace_mark("boot_defer start");
+
+  if (g_boot_defer_count == 0)
+    {
+      return OK;
+    }
+
+  pid = kernel_thread("boot_defer", CONFIG_BOOT_DEFER_PRIORITY,
+                      CONFIG_BOOT_DEFER_STACKSIZE, boot_defer_thread, NULL);
+  if (pid < 0)
+    {
+      /* Do not lose the initializations, run them here */
+
+      sdbg("Failed to start the deferred init thread: %d\n", errno);
+      for (i = 0; i < g_boot_defer_count; i++)
+        {
+          g_boot_defer[i].func(g_boot_defer[i].arg);
+        }
+    }
+
+  return OK;
+}
+
+#endif /* CONFIG_BOOT_DEFER */
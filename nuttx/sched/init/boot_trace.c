@@ -0,0 +1,142 @@
+/****************************************************************************
+ * sched/init/boot_trace.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+/* Marks are taken before the interrupts-off tracer is initialized, use the
+ * raw irqsave()/irqrestore().
+ */
+
+#define __IRQTRACE_IMPL 1
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#include <nuttx/bootphase.h>
+#include <arch/irq.h>
+
+#ifdef CONFIG_BOOT_TRACE
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* The cycle counter is only 32 bits wide, it is extended to 64 bits from
+ * one mark to the next.  Marks must thus be less than one counter period
+ * apart (about 53 seconds at 80 MHz), which is always true during boot.
+ */
+
+static uint32_t g_boottrace_last;
+static uint64_t g_boottrace_cycles;
+
+static struct boottrace_entry_s g_boottrace[CONFIG_BOOT_TRACE_NENTRIES];
+static int g_boottrace_count;
+static uint32_t g_boottrace_dropped;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: boottrace_initialize
+ ****************************************************************************/
+
+void boottrace_initialize(void)
+{
+  up_boottrace_initialize();
+
+  g_boottrace_last   = up_boottrace_cycles();
+  g_boottrace_cycles = 0;
+}
+
+/****************************************************************************
+ * Name: boottrace_mark
+ ****************************************************************************/
+
+void boottrace_mark(FAR const char *name)
+{
+  irqstate_t flags;
+  uint32_t now;
+
+  flags = irqsave();
+
+  now                 = up_boottrace_cycles();
+  g_boottrace_cycles += (uint32_t)(now - g_boottrace_last);
+  g_boottrace_last    = now;
+
+  if (g_boottrace_count < CONFIG_BOOT_TRACE_NENTRIES)
+    {
+      g_boottrace[g_boottrace_count].name = name;
+      g_boottrace[g_boottrace_count].usec =
+        (uint32_t)(g_boottrace_cycles * 1000000 / up_boottrace_frequency());
+      g_boottrace_count++;
+    }
+  else
+    {
+      g_boottrace_dropped++;
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: boottrace_get
+ ****************************************************************************/
+
+int boottrace_get(FAR struct boottrace_entry_s *entries, int max,
+                  FAR uint32_t *dropped)
+{
+  irqstate_t flags;
+  int i;
+
+  flags = irqsave();
+
+  for (i = 0; i < max && i < g_boottrace_count; i++)
+    {
+      entries[i] = g_boottrace[i];
+    }
+
+  if (dropped)
+    {
+      *dropped = g_boottrace_dropped;
+    }
+
+  irqrestore(flags);
+  return i;
+}
+
+#endif /* CONFIG_BOOT_TRACE */
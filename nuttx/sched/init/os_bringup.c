@@ -51,6 +51,7 @@
 #include <nuttx/init.h>
 #include <nuttx/wqueue.h>
 #include <nuttx/kthread.h>
+#include <nuttx/bootphase.h>
 #include <nuttx/userspace.h>
 #include <nuttx/binfmt/binfmt.h>
 
@@ -284,7 +285,9 @@ static inline void os_do_appstart(void)
    * configured.
    */
 
+  boottrace_mark("board_initialize");
   board_initialize();
+  boottrace_mark("board_initialize done");
 #endif
 
   /* Start the application initialization task.  In a flat build, this is
@@ -294,6 +297,7 @@ static inline void os_do_appstart(void)
    */
 
   svdbg("Starting init thread\n");
+  boottrace_mark("init task");
 
 #ifdef CONFIG_BUILD_PROTECTED
   DEBUGASSERT(USERSPACE->us_entrypoint != NULL);
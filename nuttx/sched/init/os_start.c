@@ -80,6 +80,7 @@
 #include  <nuttx/mm/shm.h>
 #include  <nuttx/kmalloc.h>
 #include  <nuttx/init.h>
+#include  <nuttx/bootphase.h>
 
 #include  "sched/sched.h"
 #include  "signal/signal.h"
@@ -277,8 +278,16 @@ static FAR char *g_idleargv[2];
 
 void os_start(void)
 {
+#ifdef CONFIG_MM_IDLE_COALESCE
+  uint32_t lastcoalesce = 0;
+#endif
   int i;
 
+  /* Start the boot timeline first so that it covers the whole boot */
+
+  boottrace_initialize();
+  boottrace_mark("os_start");
+
   slldbg("Entry\n");
 
   /* Initialize RTOS Data ***************************************************/
@@ -355,7 +364,11 @@ void os_start(void)
 
   /* Then add the idle task's TCB to the head of the ready to run list */
 
+#ifdef CONFIG_SCHED_RTR_BITMAP
+  (void)sched_rtr_add(&g_idletcb.cmn);
+#else
   dq_addfirst((FAR dq_entry_t*)&g_idletcb, (FAR dq_queue_t*)&g_readytorun);
+#endif
 
   /* Initialize the processor-specific portion of the TCB */
 
@@ -512,7 +525,9 @@ void os_start(void)
    * that are different for each  processor and hardware platform.
    */
 
+  boottrace_mark("up_initialize");
   up_initialize();
+  boottrace_mark("up_initialize done");
 
 #ifdef CONFIG_MM_SHM
   /* Initialize shared memory support */
@@ -559,6 +574,7 @@ void os_start(void)
   /* Bring Up the System ****************************************************/
   /* Create initial tasks and bring-up the system */
 
+  boottrace_mark("os_bringup");
   DEBUGVERIFY(os_bringup());
 
   /* The IDLE Loop **********************************************************/
@@ -587,6 +603,20 @@ void os_start(void)
         }
 #endif
 
+#ifdef CONFIG_MM_IDLE_COALESCE
+      /* Periodically merge any adjacent free chunks left in the user heap.
+       * This is done here rather than in the idle governor, which runs
+       * with interrupts disabled.
+       */
+
+      if (clock_systimer() - lastcoalesce >=
+          SEC2TICK(CONFIG_MM_IDLE_COALESCE_INTERVAL))
+        {
+          lastcoalesce = clock_systimer();
+          (void)mm_coalesce(&g_mmheap);
+        }
+#endif
+
       /* Perform any processor-specific idle state operations */
 
       up_idle();
@@ -70,6 +70,7 @@
 #include <debug.h>
 #include <nuttx/arch.h>
 #include <nuttx/irq.h>
+#include <nuttx/irqtrace.h>
 
 #include "irq/irq.h"
 
@@ -115,6 +116,12 @@ void irq_dispatch(int irq, FAR void *context)
 {
   xcpt_t vector;
 
+#ifdef CONFIG_IRQSAVE_TRACE
+  /* Sample the interrupt entry latency */
+
+  irqtrace_dispatch(irq);
+#endif
+
 #if defined(CONFIG_USEC_MEASURE_PERF)
   /* stop tracking current tcb and track interrupt timing  */
   sched_track_irq_start(irq);
@@ -40,6 +40,7 @@
 #include <nuttx/config.h>
 #include <nuttx/arch.h>
 #include <nuttx/irq.h>
+#include <nuttx/irqtrace.h>
 
 #include "irq/irq.h"
 
@@ -87,5 +88,11 @@ void irq_initialize(void)
     {
       g_irqvector[i] = irq_unexpected_isr;
     }
+
+#ifdef CONFIG_IRQSAVE_TRACE
+  /* Start measuring interrupts-off windows */
+
+  irqtrace_initialize();
+#endif
 }
 
@@ -0,0 +1,232 @@
+/****************************************************************************
+ * sched/irq/irq_trace.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+/* Use the raw irqsave()/irqrestore() rather than the traced versions */
+
+#define __IRQTRACE_IMPL 1
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/irqtrace.h>
+#include <arch/irq.h>
+
+#ifdef CONFIG_IRQSAVE_TRACE
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* The window currently open, if any.  Only touched with interrupts
+ * disabled.
+ */
+
+static bool g_irqoff_active;
+static uint32_t g_irqoff_start;
+static FAR void *g_irqoff_pc;
+
+/* Accumulated results */
+
+static struct irqtrace_s g_irqtrace;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: irqtrace_record
+ *
+ * Description:
+ *   Insert a closed window in the list of worst windows if it is long
+ *   enough.  The list is kept sorted, longest first.
+ *
+ ****************************************************************************/
+
+static void irqtrace_record(uint32_t cycles, FAR void *save_pc,
+                            FAR void *restore_pc)
+{
+  FAR struct irqtrace_window_s *worst = g_irqtrace.worst;
+  int i;
+
+  g_irqtrace.nwindows++;
+
+  if (cycles <= worst[CONFIG_IRQSAVE_TRACE_NWORST - 1].cycles)
+    {
+      return;
+    }
+
+  for (i = CONFIG_IRQSAVE_TRACE_NWORST - 1;
+       i > 0 && worst[i - 1].cycles < cycles;
+       i--)
+    {
+      worst[i] = worst[i - 1];
+    }
+
+  worst[i].cycles     = cycles;
+  worst[i].save_pc    = save_pc;
+  worst[i].restore_pc = restore_pc;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: irqsave_trace
+ *
+ * Description:
+ *   Traced irqsave().  Opens a window if interrupts were enabled.
+ *
+ ****************************************************************************/
+
+irqstate_t noinline_function irqsave_trace(void)
+{
+  irqstate_t flags = irqsave();
+
+  if (IRQSTATE_ENABLED(flags))
+    {
+      /* A window still open here was closed by switching to a task that
+       * had been preempted, without an irqrestore().  Its length is
+       * unknown, so drop it.
+       */
+
+      g_irqoff_active = true;
+      g_irqoff_start  = up_irqtrace_cycles();
+      g_irqoff_pc     = __builtin_return_address(0);
+    }
+
+  return flags;
+}
+
+/****************************************************************************
+ * Name: irqrestore_trace
+ *
+ * Description:
+ *   Traced irqrestore().  Closes the window if interrupts are re-enabled.
+ *
+ ****************************************************************************/
+
+void noinline_function irqrestore_trace(irqstate_t flags)
+{
+  if (IRQSTATE_ENABLED(flags) && g_irqoff_active)
+    {
+      irqtrace_record(up_irqtrace_cycles() - g_irqoff_start, g_irqoff_pc,
+                      __builtin_return_address(0));
+      g_irqoff_active = false;
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: irqtrace_dispatch
+ *
+ * Description:
+ *   Called from irq_dispatch() before the handler runs, to sample the
+ *   interrupt entry latency.
+ *
+ ****************************************************************************/
+
+void irqtrace_dispatch(int irq)
+{
+  uint32_t cycles;
+
+  if (up_irqtrace_latency(irq, &cycles))
+    {
+      g_irqtrace.lat_count++;
+      g_irqtrace.lat_total += cycles;
+      if (cycles > g_irqtrace.lat_max)
+        {
+          g_irqtrace.lat_max = cycles;
+        }
+    }
+}
+
+/****************************************************************************
+ * Name: irqtrace_get
+ *
+ * Description:
+ *   Take a consistent snapshot of the tracer results.
+ *
+ ****************************************************************************/
+
+void irqtrace_get(FAR struct irqtrace_s *trace)
+{
+  irqstate_t flags = irqsave();
+
+  memcpy(trace, &g_irqtrace, sizeof(struct irqtrace_s));
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: irqtrace_reset
+ *
+ * Description:
+ *   Clear the tracer results.
+ *
+ ****************************************************************************/
+
+void irqtrace_reset(void)
+{
+  irqstate_t flags = irqsave();
+
+  memset(&g_irqtrace, 0, sizeof(struct irqtrace_s));
+  g_irqoff_active = false;
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: irqtrace_initialize
+ *
+ * Description:
+ *   Start the cycle counter and clear the results.  Windows measured
+ *   before this point all read as zero cycles and are not recorded.
+ *
+ ****************************************************************************/
+
+void irqtrace_initialize(void)
+{
+  up_irqtrace_initialize();
+  irqtrace_reset();
+}
+
+#endif /* CONFIG_IRQSAVE_TRACE */
@@ -0,0 +1,184 @@
+/****************************************************************************
+ * sched/mqueue/mq_bufalloc.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <string.h>
+#include <queue.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+
+#include "mqueue/mqueue.h"
+
+#ifdef CONFIG_MQ_BUFFERS
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* Buffers released by mq_buffree() and kept for reuse */
+
+static sq_queue_t g_mqbufcache;
+static int        g_mqbufncached;
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_bufalloc
+ *
+ * Description:
+ *   Allocate a buffer that can be sent with mq_sendbuf().  A cached buffer
+ *   is reused if one of a suitable size is available; otherwise, a new one
+ *   is allocated from the heap.  From an interrupt handler, only cached
+ *   buffers are available.
+ *
+ * Parameters:
+ *   size - Number of data bytes needed
+ *
+ * Return Value:
+ *   A pointer to the buffer data or NULL if no buffer is available.
+ *
+ ****************************************************************************/
+
+FAR void *mq_bufalloc(size_t size)
+{
+  FAR struct mqbuf_s *mqbuf;
+  FAR struct mqbuf_s *prev;
+  irqstate_t saved_state;
+
+  /* Look for a cached buffer that is big enough but not wastefully big */
+
+  saved_state = irqsave();
+  for (prev = NULL, mqbuf = (FAR struct mqbuf_s *)g_mqbufcache.head;
+       mqbuf && (mqbuf->size < size || mqbuf->size / 2 > size);
+       prev = mqbuf, mqbuf = mqbuf->flink);
+
+  if (mqbuf)
+    {
+      if (prev)
+        {
+          (void)sq_remafter((FAR sq_entry_t *)prev, &g_mqbufcache);
+        }
+      else
+        {
+          (void)sq_remfirst(&g_mqbufcache);
+        }
+
+      g_mqbufncached--;
+    }
+
+  irqrestore(saved_state);
+
+  if (!mqbuf && !up_interrupt_context())
+    {
+      mqbuf = (FAR struct mqbuf_s *)kmm_malloc(SIZEOF_MQBUF_HEADER + size);
+      if (mqbuf)
+        {
+          mqbuf->size = size;
+        }
+    }
+
+  if (!mqbuf)
+    {
+      return NULL;
+    }
+
+  mqbuf->len = 0;
+  return mqbuf->data;
+}
+
+/****************************************************************************
+ * Name: mq_buffree
+ *
+ * Description:
+ *   Release a buffer obtained from mq_bufalloc() or mq_receivebuf().  This
+ *   may be called from an interrupt handler.
+ *
+ ****************************************************************************/
+
+void mq_buffree(FAR void *buf)
+{
+  FAR struct mqbuf_s *mqbuf;
+  irqstate_t saved_state;
+
+  if (!buf)
+    {
+      return;
+    }
+
+  mqbuf = MQBUF_HEADER(buf);
+
+  saved_state = irqsave();
+  if (g_mqbufncached < CONFIG_MQ_BUFCACHE)
+    {
+      sq_addfirst((FAR sq_entry_t *)mqbuf, &g_mqbufcache);
+      g_mqbufncached++;
+      mqbuf = NULL;
+    }
+
+  irqrestore(saved_state);
+
+  if (mqbuf)
+    {
+      sched_kfree(mqbuf);
+    }
+}
+
+/****************************************************************************
+ * Name: mq_msgbuf
+ *
+ * Description:
+ *   Return the buffer data pointer carried by a buffer message.
+ *
+ ****************************************************************************/
+
+FAR void *mq_msgbuf(FAR mqmsg_t *mqmsg)
+{
+  FAR void *buf;
+
+  DEBUGASSERT((mqmsg->flags & MQ_MSG_BUF) != 0);
+  memcpy(&buf, (FAR const void *)mqmsg->mail, sizeof(buf));
+  return buf;
+}
+
+#endif /* CONFIG_MQ_BUFFERS */
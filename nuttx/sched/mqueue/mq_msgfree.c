@@ -90,6 +90,18 @@ void mq_msgfree(FAR mqmsg_t *mqmsg)
 {
   irqstate_t saved_state;
 
+#ifdef CONFIG_MQ_BUFFERS
+  /* If the message still owns a buffer (nobody took it with
+   * mq_receivebuf()), then release the buffer too.
+   */
+
+  if ((mqmsg->flags & MQ_MSG_BUF) != 0)
+    {
+      mq_buffree(mq_msgbuf(mqmsg));
+      mqmsg->flags = 0;
+    }
+#endif
+
   /* If this is a generally available pre-allocated message,
    * then just put it back in the free list.
    */
@@ -252,13 +252,38 @@ ssize_t mq_doreceive(mqd_t mqdes, mqmsg_t *mqmsg, void *ubuffer, int *prio)
   FAR msgq_t *msgq;
   ssize_t rcvmsglen;
 
-  /* Get the length of the message (also the return value) */
+#ifdef CONFIG_MQ_BUFFERS
+  if ((mqmsg->flags & MQ_MSG_BUF) != 0)
+    {
+      /* A buffer message received by mq_receive().  The caller's buffer
+       * is at least maxmsgsize bytes long.  Copy the buffer contents if
+       * they fit; the buffer itself is released with the message.
+       */
+
+      FAR struct mqbuf_s *mqbuf = MQBUF_HEADER(mq_msgbuf(mqmsg));
+
+      if (mqbuf->len > (size_t)mqdes->msgq->maxmsgsize)
+        {
+          rcvmsglen = ERROR;
+          set_errno(EMSGSIZE);
+        }
+      else
+        {
+          rcvmsglen = mqbuf->len;
+          memcpy(ubuffer, mqbuf->data, rcvmsglen);
+        }
+    }
+  else
+#endif
+    {
+      /* Get the length of the message (also the return value) */
 
-  rcvmsglen = mqmsg->msglen;
+      rcvmsglen = mqmsg->msglen;
 
-  /* Copy the message into the caller's buffer */
+      /* Copy the message into the caller's buffer */
 
-  memcpy(ubuffer, (const void*)mqmsg->mail, rcvmsglen);
+      memcpy(ubuffer, (const void*)mqmsg->mail, rcvmsglen);
+    }
 
   /* Copy the message priority as well (if a buffer is provided) */
 
@@ -0,0 +1,152 @@
+/****************************************************************************
+ * sched/mqueue/mq_receivebuf.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <mqueue.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+
+#include "sched/sched.h"
+#include "mqueue/mqueue.h"
+
+#ifdef CONFIG_MQ_BUFFERS
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_receivebuf
+ *
+ * Description:
+ *   Receive the oldest of the highest priority messages from the message
+ *   queue without copying it.  If the message was sent with mq_sendbuf(),
+ *   the sender's buffer itself is returned.  An ordinary message is
+ *   returned in a buffer from mq_bufalloc().  Either way, the caller owns
+ *   the buffer and must release it with mq_buffree().
+ *
+ *   Otherwise this behaves just like mq_receive().
+ *
+ * Parameters:
+ *   mqdes - Message Queue Descriptor
+ *   buf   - Location to return the buffer
+ *   prio  - If not NULL, a location to return the message priority.
+ *
+ * Return Value:
+ *   The length of the message on success; -1 (ERROR) on failure with errno
+ *   set as by mq_receive().  ENOMEM means that no buffer was available to
+ *   hold an ordinary message; no message is removed from the queue then.
+ *
+ ****************************************************************************/
+
+ssize_t mq_receivebuf(mqd_t mqdes, FAR void **buf, FAR int *prio)
+{
+  FAR mqmsg_t *mqmsg;
+  FAR void    *spare;
+  FAR void    *data;
+  irqstate_t   saved_state;
+  ssize_t      ret = ERROR;
+
+  DEBUGASSERT(up_interrupt_context() == false);
+
+  if (!buf || !mqdes)
+    {
+      set_errno(EINVAL);
+      return ERROR;
+    }
+
+  if ((mqdes->oflags & O_RDOK) == 0)
+    {
+      set_errno(EPERM);
+      return ERROR;
+    }
+
+  /* Get a buffer for the case that the message turns out to be an ordinary
+   * one before anything is removed from the queue.  If the message is a
+   * buffer message, this spare goes to the buffer cache and is reused by
+   * the next call.
+   */
+
+  spare = mq_bufalloc(mqdes->msgq->maxmsgsize);
+  if (!spare)
+    {
+      set_errno(ENOMEM);
+      return ERROR;
+    }
+
+  /* Get the next message just as mq_receive() does */
+
+  sched_lock();
+  saved_state = irqsave();
+  mqmsg = mq_waitreceive(mqdes);
+  irqrestore(saved_state);
+
+  if (mqmsg)
+    {
+      if ((mqmsg->flags & MQ_MSG_BUF) != 0)
+        {
+          /* Take the buffer away from the message before releasing the
+           * message.
+           */
+
+          data          = mq_msgbuf(mqmsg);
+          mqmsg->flags &= ~MQ_MSG_BUF;
+          (void)mq_doreceive(mqdes, mqmsg, &data, prio);
+          ret           = MQBUF_HEADER(data)->len;
+          *buf          = data;
+        }
+      else
+        {
+          ret   = mq_doreceive(mqdes, mqmsg, spare, prio);
+          MQBUF_HEADER(spare)->len = ret;
+          *buf  = spare;
+          spare = NULL;
+        }
+    }
+
+  sched_unlock();
+  mq_buffree(spare);
+  return ret;
+}
+
+#endif /* CONFIG_MQ_BUFFERS */
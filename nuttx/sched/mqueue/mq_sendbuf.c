@@ -0,0 +1,138 @@
+/****************************************************************************
+ * sched/mqueue/mq_sendbuf.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <mqueue.h>
+#include <errno.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+
+#include "sched/sched.h"
+#include "mqueue/mqueue.h"
+
+#ifdef CONFIG_MQ_BUFFERS
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: mq_sendbuf
+ *
+ * Description:
+ *   Queue a buffer obtained from mq_bufalloc() without copying its
+ *   contents.  Only a reference to the buffer is placed in the message
+ *   queue and ownership of the buffer passes to the message queue:  The
+ *   caller must not access or free the buffer after a successful return.
+ *   The buffer length is limited only by the size given to mq_bufalloc(),
+ *   not by the maxmsgsize attribute of the message queue.
+ *
+ *   Otherwise this behaves just like mq_send(), including blocking while
+ *   the queue is full and being usable from interrupt handlers.
+ *
+ * Parameters:
+ *   mqdes  - Message queue descriptor
+ *   buf    - Buffer from mq_bufalloc()
+ *   buflen - The number of valid bytes in the buffer
+ *   prio   - The priority of the message
+ *
+ * Return Value:
+ *   On success, mq_sendbuf() returns 0 (OK); on error, -1 (ERROR) is
+ *   returned, with errno set as by mq_send().  EMSGSIZE means that buflen
+ *   is larger than the buffer.  On failure the caller still owns the
+ *   buffer.
+ *
+ ****************************************************************************/
+
+int mq_sendbuf(mqd_t mqdes, FAR void *buf, size_t buflen, int prio)
+{
+  FAR msgq_t  *msgq;
+  FAR mqmsg_t *mqmsg = NULL;
+  irqstate_t   saved_state;
+  int          ret = ERROR;
+
+  /* Verify the input parameters.  The buffer size, not the message queue
+   * attributes, limits the length.
+   */
+
+  if (mq_verifysend(mqdes, buf, 0, prio) != OK)
+    {
+      return ERROR;
+    }
+
+  if (buflen > MQBUF_HEADER(buf)->size)
+    {
+      set_errno(EMSGSIZE);
+      return ERROR;
+    }
+
+  /* Get a message structure just as mq_send() does */
+
+  sched_lock();
+  msgq = mqdes->msgq;
+
+  saved_state = irqsave();
+  if (up_interrupt_context()      || /* In an interrupt handler */
+      msgq->nmsgs < msgq->maxmsgs || /* OR Message queue not full */
+      mq_waitsend(mqdes) == OK)      /* OR Successfully waited for mq not full */
+    {
+      irqrestore(saved_state);
+      mqmsg = mq_msgalloc();
+    }
+  else
+    {
+      irqrestore(saved_state);
+    }
+
+  if (mqmsg)
+    {
+      /* The message carries only the buffer pointer */
+
+      MQBUF_HEADER(buf)->len = buflen;
+      mqmsg->flags = MQ_MSG_BUF;
+      ret = mq_dosend(mqdes, mqmsg, &buf, sizeof(buf), prio);
+    }
+
+  sched_unlock();
+  return ret;
+}
+
+#endif /* CONFIG_MQ_BUFFERS */
@@ -208,6 +208,13 @@ FAR mqmsg_t *mq_msgalloc(void)
         }
     }
 
+#ifdef CONFIG_MQ_BUFFERS
+  if (mqmsg)
+    {
+      mqmsg->flags = 0;
+    }
+#endif
+
   return mqmsg;
 }
 
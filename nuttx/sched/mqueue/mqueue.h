@@ -88,12 +88,19 @@ enum mqalloc_e
 
 typedef enum mqalloc_e mqalloc_t;
 
+/* Values of the flags field of struct mqmsg */
+
+#define MQ_MSG_BUF     (1 << 0)  /* mail holds a struct mqbuf_s data pointer */
+
 /* This structure describes one buffered POSIX message. */
 
 struct mqmsg
 {
   FAR struct mqmsg  *next;    /* Forward link to next message */
   uint8_t      type;          /* (Used to manage allocations) */
+#ifdef CONFIG_MQ_BUFFERS
+  uint8_t      flags;         /* See MQ_MSG_* definitions     */
+#endif
   uint8_t      priority;      /* priority of message          */
 #if MQ_MAX_BYTES < 256
   uint8_t      msglen;        /* Message data length          */
@@ -105,6 +112,24 @@ struct mqmsg
 
 typedef struct mqmsg mqmsg_t;
 
+/* This structure precedes the data of each buffer returned by
+ * mq_bufalloc().
+ */
+
+#ifdef CONFIG_MQ_BUFFERS
+struct mqbuf_s
+{
+  FAR struct mqbuf_s *flink;  /* Link in the buffer cache     */
+  size_t       size;          /* Capacity of data[]           */
+  size_t       len;           /* Number of bytes sent         */
+  uint8_t      data[1];       /* Start of the buffer data     */
+};
+
+#define SIZEOF_MQBUF_HEADER ((size_t)(((FAR struct mqbuf_s *)NULL)->data))
+#define MQBUF_HEADER(buf) \
+  ((FAR struct mqbuf_s *)((FAR uint8_t *)(buf) - SIZEOF_MQBUF_HEADER))
+#endif
+
 /****************************************************************************
  * Global Variables
  ****************************************************************************/
@@ -152,6 +177,9 @@ void mq_desblockalloc(void);
 mqd_t mq_descreate(FAR struct tcb_s* mtcb, FAR msgq_t* msgq, int oflags);
 FAR msgq_t  *mq_findnamed(const char *mq_name);
 void mq_msgfree(FAR mqmsg_t *mqmsg);
+#ifdef CONFIG_MQ_BUFFERS
+FAR void *mq_msgbuf(FAR mqmsg_t *mqmsg);
+#endif
 void mq_msgqfree(FAR msgq_t *msgq);
 
 /* mq_waitirq.c ************************************************************/
@@ -41,8 +41,12 @@
  ****************************************************************************/
 
 #include <nuttx/config.h>
+
+#include <stdbool.h>
 #include <queue.h>
 
+#include <nuttx/page.h>
+
 #ifdef CONFIG_PAGING
 
 /****************************************************************************
@@ -100,6 +104,18 @@ extern pid_t g_pgworker;
 
 extern FAR struct tcb_s *g_pftcb;
 
+#if CONFIG_PAGING_PREFETCH > 0
+/* True while the page fill worker thread is prefetching */
+
+extern volatile bool g_pgprefetch;
+#endif
+
+#ifdef CONFIG_PAGING_STATS
+/* Paging counters returned by pg_getstats() */
+
+extern struct pg_stats_s g_pgstats;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -145,6 +145,10 @@ void pg_miss(void)
 
   up_block_task(ftcb, TSTATE_WAIT_PAGEFILL);
 
+#ifdef CONFIG_PAGING_STATS
+  g_pgstats.nfaults++;
+#endif
+
   /* Boost the page fill worker thread priority.
    * - Check the priority of the task at the head of the g_waitingforfill
    *   list.  If the priority of that task is higher than the current
@@ -166,10 +170,15 @@ void pg_miss(void)
 
   /* Signal the page fill worker thread.
    * - Is there a page fill pending?  If not then signal the worker
-   *   thread to start working on the queued page fill requests.
+   *   thread to start working on the queued page fill requests.  A
+   *   prefetch in progress will notice the queued request by itself.
    */
 
+#if CONFIG_PAGING_PREFETCH > 0
+  if (!g_pftcb && !g_pgprefetch)
+#else
   if (!g_pftcb)
+#endif
     {
       pglldbg("Signaling worker. PID: %d\n", g_pgworker);
       kill(g_pgworker, SIGWORK);
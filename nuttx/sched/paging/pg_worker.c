@@ -67,6 +67,15 @@
 #  warning "Signals needed by this function (CONFIG_DISABLE_SIGNALS=n)"
 #endif
 
+#if CONFIG_PAGING_PREFETCH > 0
+#  ifndef CONFIG_PAGING_BLOCKINGFILL
+#    error "CONFIG_PAGING_PREFETCH requires CONFIG_PAGING_BLOCKINGFILL"
+#  endif
+#  if CONFIG_PAGING_PREFETCH >= CONFIG_PAGING_NPPAGED
+#    error "CONFIG_PAGING_PREFETCH must be less than CONFIG_PAGING_NPPAGED"
+#  endif
+#endif
+
 /****************************************************************************
  * Private Type Declarations
  ****************************************************************************/
@@ -93,6 +102,20 @@ pid_t g_pgworker;
 
 FAR struct tcb_s *g_pftcb;
 
+#if CONFIG_PAGING_PREFETCH > 0
+/* True while the page fill worker thread is prefetching.  pg_miss() must
+ * not signal the worker then because the signal would interrupt the fill.
+ */
+
+volatile bool g_pgprefetch;
+#endif
+
+#ifdef CONFIG_PAGING_STATS
+/* Paging counters returned by pg_getstats() */
+
+struct pg_stats_s g_pgstats;
+#endif
+
 /****************************************************************************
  * Private Variables
  ****************************************************************************/
@@ -114,6 +137,14 @@ status uint32_t g_starttime;
 #endif
 #endif
 
+#if CONFIG_PAGING_PREFETCH > 0
+/* The virtual address of the page most recently filled on demand.  The
+ * pages that follow it are the prefetch candidates.
+ */
+
+static FAR void *g_pfvpage;
+#endif
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -313,6 +344,9 @@ static inline bool pg_dequeue(void)
            */
 
           pglldbg("Restarting TCB: %p\n", g_pftcb);
+#ifdef CONFIG_PAGING_STATS
+          g_pgstats.nrestarts++;
+#endif
           up_unblock_task(g_pftcb);
         }
     }
@@ -373,6 +407,10 @@ static inline bool pg_startfill(void)
       result = up_allocpage(g_pftcb, &vpage);
       DEBUGASSERT(result == OK);
 
+#ifdef CONFIG_PAGING_STATS
+      g_pgstats.nfills++;
+#endif
+
       /* Start the fill.  The exact way that the fill is started depends upon
        * the nature of the architecture-specific up_fillpage() function -- Is it
        * a blocking or a non-blocking call?
@@ -389,6 +427,12 @@ static inline bool pg_startfill(void)
       pgllvdbg("Call up_fillpage(%p)\n", g_pftcb);
       result = up_fillpage(g_pftcb, vpage);
       DEBUGASSERT(result == OK);
+
+#if CONFIG_PAGING_PREFETCH > 0
+      /* Remember where to start prefetching */
+
+      g_pfvpage = vpage;
+#endif
 #else
       /* If CONFIG_PAGING_BLOCKINGFILL is defined, then up_fillpage is non-blocking
        * call. In this case up_fillpage() will accept an additional argument: The page
@@ -463,6 +507,76 @@ static inline void pg_alldone(void)
   sched_setpriority(wtcb, CONFIG_PAGING_DEFPRIO);
 }
 
+/****************************************************************************
+ * Name: pg_prefetch
+ *
+ * Description:
+ *   Called by the page fill worker thread after all queued fills have been
+ *   completed.  Fill up to CONFIG_PAGING_PREFETCH of the pages that follow
+ *   the last page filled on demand so that a task running sequentially
+ *   through its code does not fault on each of them.  Pages that are
+ *   already mapped are skipped.  Prefetching stops early when a new page
+ *   fault is queued so that the faulting task does not wait behind a
+ *   speculative fill.
+ *
+ * Input parameters:
+ *   None.
+ *
+ * Returned Value:
+ *   True if new page fills are waiting in g_waitingforfill.
+ *
+ * Assumptions:
+ *   Executing in the context of the page fill worker thread with interrupts
+ *   disabled.
+ *
+ ****************************************************************************/
+
+#if CONFIG_PAGING_PREFETCH > 0
+static inline bool pg_prefetch(void)
+{
+  uintptr_t vaddr = (uintptr_t)g_pfvpage;
+  FAR void *vpage;
+  int result;
+  int i;
+
+  if (vaddr == 0)
+    {
+      return false;
+    }
+
+  g_pfvpage    = NULL;
+  g_pgprefetch = true;
+
+  for (i = 0; i < CONFIG_PAGING_PREFETCH && !g_waitingforfill.head; i++)
+    {
+      vaddr += PAGESIZE;
+      if (vaddr >= PG_PAGED_VEND)
+        {
+          break;
+        }
+
+      if (up_checkvpage(vaddr))
+        {
+          continue;
+        }
+
+      pgllvdbg("Prefetch %08x\n", vaddr);
+      result = up_allocvpage(vaddr, &vpage);
+      DEBUGASSERT(result == OK);
+
+      result = up_fillpage(NULL, vpage);
+      DEBUGASSERT(result == OK);
+
+#ifdef CONFIG_PAGING_STATS
+      g_pgstats.nprefetch++;
+#endif
+    }
+
+  g_pgprefetch = false;
+  return g_waitingforfill.head != NULL;
+}
+#endif
+
 /****************************************************************************
  * Name: pg_fillcomplete
  *
@@ -501,6 +615,31 @@ static inline void pg_fillcomplete(void)
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
+/****************************************************************************
+ * Name: pg_getstats
+ *
+ * Description:
+ *   Return a snapshot of the paging counters.
+ *
+ * Input parameters:
+ *   stats - Location to return the counters.
+ *
+ * Returned Value:
+ *   None
+ *
+ ****************************************************************************/
+
+#ifdef CONFIG_PAGING_STATS
+void pg_getstats(FAR struct pg_stats_s *stats)
+{
+  irqstate_t flags;
+
+  flags = irqsave();
+  *stats = g_pgstats;
+  irqrestore(flags);
+}
+#endif
+
 /****************************************************************************
  * Name: pg_worker
  *
@@ -636,40 +775,52 @@ int pg_worker(int argc, char *argv[])
            (void)pg_startfill();
         }
 #else
-      /* Are there tasks blocked and waiting for a fill?  Loop until all
-       * pending fills have been processed.
-       */
-
-      for (;;)
+      do
         {
-          /* Yes .. Start the fill and block until the fill completes.
-           * Check the return value to see a fill was actually performed.
-           * (false means that no fill was perforemd).
+          /* Are there tasks blocked and waiting for a fill?  Loop until all
+           * pending fills have been processed.
            */
 
-          pgllvdbg("Calling pg_startfill\n");
-          if (!pg_startfill())
+          for (;;)
             {
-               /* Break out of the loop -- there is nothing more to do */
+              /* Yes .. Start the fill and block until the fill completes.
+               * Check the return value to see a fill was actually performed.
+               * (false means that no fill was perforemd).
+               */
 
-               break;
-            }
+              pgllvdbg("Calling pg_startfill\n");
+              if (!pg_startfill())
+                {
+                   /* Break out of the loop -- there is nothing more to do */
 
-          /* Handle the page fill complete event by restarting the
-           * task that was blocked waiting for this page fill. In the
-           * non-blocking fill case, the page fill worker thread will
-           * know that the page fill is  complete when pg_startfill()
-           * returns true.
-           */
+                   break;
+                }
 
-          pgllvdbg("Restarting TCB: %p\n", g_pftcb);
-          up_unblock_task(g_pftcb);;
-        }
+              /* Handle the page fill complete event by restarting the
+               * task that was blocked waiting for this page fill. In the
+               * non-blocking fill case, the page fill worker thread will
+               * know that the page fill is  complete when pg_startfill()
+               * returns true.
+               */
+
+              pgllvdbg("Restarting TCB: %p\n", g_pftcb);
+              up_unblock_task(g_pftcb);;
+            }
+
+          /* All queued fills have been processed */
 
-      /* All queued fills have been processed */
+          pgllvdbg("Call pg_alldone()\n");
+          pg_alldone();
 
-      pgllvdbg("Call pg_alldone()\n");
-      pg_alldone();
+          /* Then fill ahead at the default priority.  Go back to the
+           * queued fills if a new page fault occurs meanwhile.
+           */
+        }
+#if CONFIG_PAGING_PREFETCH > 0
+      while (pg_prefetch());
+#else
+      while (0);
+#endif
 #endif
     }
 
@@ -122,6 +122,10 @@ struct pidhash_s
 #endif
 #ifdef CONFIG_USEC_MEASURE_PERF
   uint32_t thread_time;         /* current uSec of thread use */
+  uint32_t nvcsw;               /* Switches away while blocking */
+  uint32_t nivcsw;              /* Switches away while still ready (preempted) */
+  uint32_t lock_time;           /* uSec spent with pre-emption disabled */
+  uint32_t lock_start;          /* Perf time of the outermost sched_lock() */
 #endif
 };
 
@@ -248,6 +252,14 @@ extern const struct tasklist_s g_tasklisttable[NUM_TASK_STATES];
 extern volatile uint32_t g_cpuload_total;
 #endif
 
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+/* The up_timer_gettime() time, in microseconds, at which the running
+ * interval timer will expire.  Zero if no interval timer is running.
+ */
+
+extern volatile uint64_t g_timer_deadline;
+#endif
+
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
@@ -256,6 +268,17 @@ bool sched_addreadytorun(FAR struct tcb_s *rtrtcb);
 bool sched_removereadytorun(FAR struct tcb_s *rtrtcb);
 bool sched_addprioritized(FAR struct tcb_s *newTcb, DSEG dq_queue_t *list);
 bool sched_mergepending(void);
+
+#ifdef CONFIG_SCHED_RTR_BITMAP
+bool sched_rtr_add(FAR struct tcb_s *tcb);
+void sched_rtr_remove(FAR struct tcb_s *tcb);
+#else
+#  define sched_rtr_add(tcb) \
+     sched_addprioritized(tcb, (FAR dq_queue_t *)&g_readytorun)
+#  define sched_rtr_remove(tcb) \
+     dq_rem((FAR dq_entry_t *)(tcb), (FAR dq_queue_t *)&g_readytorun)
+#endif
+
 void sched_addblocked(FAR struct tcb_s *btcb, tstate_t task_state);
 void sched_removeblocked(FAR struct tcb_s *btcb);
 int  sched_setpriority(FAR struct tcb_s *tcb, int sched_priority);
@@ -293,9 +316,15 @@ inline void sched_track_irq_stop(void);
 inline void sched_track_irq_start (int irq);
 void sched_track_pre_exit(struct tcb_s* dead_tcb);
 void sched_track_post_exit(struct tcb_s* new_tcb);
+void sched_track_lock(FAR struct tcb_s *tcb);
+void sched_track_unlock(FAR struct tcb_s *tcb);
 #endif
 
 bool sched_verifytcb(FAR struct tcb_s *tcb);
 int  sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype);
+#ifdef CONFIG_SCHED_TCBCACHE
+FAR struct tcb_s *sched_tcballoc(uint8_t ttype, size_t stack_size);
+bool sched_tcbcache(FAR struct tcb_s *tcb, uint8_t ttype);
+#endif
 
 #endif /* __SCHED_SCHED_SCHED_H */
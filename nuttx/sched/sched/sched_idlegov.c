@@ -0,0 +1,213 @@
+/****************************************************************************
+ * sched/sched/sched_idlegov.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <time.h>
+#include <assert.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/clock.h>
+#include <nuttx/idle.h>
+#include <nuttx/power/pm.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* Weight of a new sample in the running latency average:  1/2^SHIFT */
+
+#define IDLE_AVG_SHIFT  CONFIG_SCHED_IDLE_GOVERNOR_SHIFT
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: idle_now
+ *
+ * Description:
+ *   Return the current up_timer_gettime() time in microseconds.
+ *
+ ****************************************************************************/
+
+static uint64_t idle_now(void)
+{
+  struct timespec ts;
+
+  (void)up_timer_gettime(&ts);
+  return (uint64_t)ts.tv_sec * USEC_PER_SEC + ts.tv_nsec / NSEC_PER_USEC;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: idle_select
+ *
+ * Description:
+ *   Select the deepest state, not deeper than maxstate, that can be left
+ *   again before the next scheduled timer expiry.
+ *
+ ****************************************************************************/
+
+int idle_select(FAR struct idle_governor_s *gov, int maxstate)
+{
+  FAR struct idle_state_s *state;
+  uint64_t deadline;
+  uint64_t now;
+  uint32_t remaining;
+  uint32_t latency;
+  uint32_t qos;
+  int ndx;
+
+  DEBUGASSERT(gov != NULL && gov->nstates > 0);
+
+  if (maxstate >= gov->nstates)
+    {
+      maxstate = gov->nstates - 1;
+    }
+
+  /* How long until the interval timer wakes us up?  With no timer running,
+   * only another interrupt can end the sleep.
+   */
+
+  now      = idle_now();
+  deadline = g_timer_deadline;
+
+  if (deadline == 0)
+    {
+      remaining = UINT32_MAX;
+    }
+  else if (deadline <= now)
+    {
+      remaining = 0;
+    }
+  else if (deadline - now > UINT32_MAX)
+    {
+      remaining = UINT32_MAX;
+    }
+  else
+    {
+      remaining = (uint32_t)(deadline - now);
+    }
+
+  /* Pick the deepest state whose residency plus exit latency still fits,
+   * and whose exit latency is within what the drivers tolerate.
+   */
+
+  qos = pm_qos_latency();
+
+  for (ndx = maxstate; ndx > 0; ndx--)
+    {
+      state   = &gov->states[ndx];
+      latency = state->avg_latency > state->exit_latency ?
+                state->avg_latency : state->exit_latency;
+
+      if (latency <= qos &&
+          (uint64_t)state->residency + latency <= remaining)
+        {
+          break;
+        }
+    }
+
+  gov->current = ndx;
+  gov->wakeup  = deadline;
+  gov->states[ndx].count++;
+  return ndx;
+}
+
+/****************************************************************************
+ * Name: idle_reflect
+ *
+ * Description:
+ *   Update the statistics of the state selected by the last idle_select()
+ *   after the CPU left it.
+ *
+ ****************************************************************************/
+
+void idle_reflect(FAR struct idle_governor_s *gov)
+{
+  FAR struct idle_state_s *state;
+  uint64_t now;
+  uint32_t latency;
+
+  DEBUGASSERT(gov != NULL && gov->current < gov->nstates);
+
+  state = &gov->states[gov->current];
+  now   = idle_now();
+
+  /* Some other interrupt ended the sleep before the timer expired.  That
+   * says nothing about the exit latency of the state.
+   */
+
+  if (gov->wakeup == 0 || now < gov->wakeup)
+    {
+      state->early++;
+      return;
+    }
+
+  /* Woken by the timer:  the time since the expiry is the exit latency */
+
+  latency = now - gov->wakeup > UINT32_MAX ?
+            UINT32_MAX : (uint32_t)(now - gov->wakeup);
+
+  if (latency > state->max_latency)
+    {
+      state->max_latency = latency;
+    }
+
+  if (state->avg_latency == 0)
+    {
+      state->avg_latency = latency;
+    }
+  else
+    {
+      state->avg_latency = state->avg_latency -
+                           (state->avg_latency >> IDLE_AVG_SHIFT) +
+                           (latency >> IDLE_AVG_SHIFT);
+    }
+}
+
+#endif /* CONFIG_SCHED_IDLE_GOVERNOR */
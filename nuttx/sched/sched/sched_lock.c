@@ -104,6 +104,13 @@ int sched_lock(void)
     {
      ASSERT(rtcb->lockcount < MAX_LOCK_COUNT);
      rtcb->lockcount++;
+
+#ifdef CONFIG_USEC_MEASURE_PERF
+     if (rtcb->lockcount == 1)
+       {
+         sched_track_lock(rtcb);
+       }
+#endif
     }
 
   return OK;
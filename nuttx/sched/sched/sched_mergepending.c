@@ -94,6 +94,39 @@
 
 bool sched_mergepending(void)
 {
+#ifdef CONFIG_SCHED_RTR_BITMAP
+  FAR struct tcb_s *pndtcb;
+  FAR struct tcb_s *pndnext;
+  FAR struct tcb_s *rtrtcb;
+  bool ret = false;
+
+  /* Process every TCB in the g_pendingtasks list.  The priority index of
+   * the g_readytorun list lets each one be placed without a list walk.
+   */
+
+  for (pndtcb = (FAR struct tcb_s*)g_pendingtasks.head; pndtcb; pndtcb = pndnext)
+    {
+      pndnext = pndtcb->flink;
+      rtrtcb  = (FAR struct tcb_s*)g_readytorun.head;
+
+      if (sched_rtr_add(pndtcb))
+        {
+          /* pndtcb was inserted at the head of the list.  Inform the
+           * instrumentation layer that we are switching tasks.
+           */
+
+          sched_note_switch(rtrtcb, pndtcb);
+
+          rtrtcb->task_state = TSTATE_TASK_READYTORUN;
+          pndtcb->task_state = TSTATE_TASK_RUNNING;
+          ret                = true;
+        }
+      else
+        {
+          pndtcb->task_state = TSTATE_TASK_READYTORUN;
+        }
+    }
+#else
   FAR struct tcb_s *pndtcb;
   FAR struct tcb_s *pndnext;
   FAR struct tcb_s *rtrtcb;
@@ -162,6 +195,7 @@ bool sched_mergepending(void)
 
       rtrtcb = pndtcb;
     }
+#endif
 
   /* Mark the input list empty */
 
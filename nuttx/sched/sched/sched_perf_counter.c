@@ -80,11 +80,18 @@ static int curr_hash_index;
 static uint32_t irq_times[NR_IRQS];
 
 /* Keep track of the current irq in interrupt context */
-static bool curr_irq;
+static int curr_irq;
 
 /* No interrupt to track */
 #define NO_IRQ (NR_IRQS +1)
 
+/* Only the Toshiba bridge has a name table for its vectors */
+#ifdef CONFIG_ARCH_CHIP_TSB
+#define PERF_IRQ_NAME(irq) tsb_irq_name(irq)
+#else
+#define PERF_IRQ_NAME(irq) ""
+#endif
+
 
 /************************************************************************
  * Private Variables
@@ -94,6 +101,27 @@ static bool curr_irq;
  * Private Functions
  ************************************************************************/
 
+/************************************************************************
+ * Name: count_switch
+ *
+ * Description:
+ *   Account for a context switch away from the task tracked at
+ *   hash_index.  A task that is still ready to run was preempted; any
+ *   other task gave up the CPU by blocking.
+ *
+ ************************************************************************/
+static void count_switch(int hash_index)
+{
+    struct tcb_s *tcb = g_pidhash[hash_index].tcb;
+
+    if (tcb && tcb->task_state == TSTATE_TASK_READYTORUN) {
+        g_pidhash[hash_index].nivcsw++;
+    }
+    else {
+        g_pidhash[hash_index].nvcsw++;
+    }
+}
+
 /************************************************************************
  * Public Functions
  ************************************************************************/
@@ -224,6 +252,10 @@ void start_perf_track(void)
     /* clear all timers */
     for (i = 0; i < CONFIG_MAX_TASKS; i++) {
       g_pidhash[i].thread_time = 0;
+      g_pidhash[i].nvcsw = 0;
+      g_pidhash[i].nivcsw = 0;
+      g_pidhash[i].lock_time = 0;
+      g_pidhash[i].lock_start = 0;
     }
     for (i = 0; i < NR_IRQS; i++) {
         irq_times[i] = 0;
@@ -337,7 +369,7 @@ void irq_perf_foreach(irq_perf_foreach_t handler, FAR void *arg)
 
     if(handler) {
         for ( irq = 0; irq < NR_IRQS; irq++) {
-            handler(irq, tsb_irq_name(irq), irq_times[irq], arg);
+            handler(irq, PERF_IRQ_NAME(irq), irq_times[irq], arg);
         }
     }
 }
@@ -415,6 +447,10 @@ void sched_track_switch (struct tcb_s* new_tcb)
         /* add the time diff to the old sample */
         g_pidhash[curr_hash_index].thread_time += usec;
 
+        if (hash_index != curr_hash_index) {
+            count_switch(curr_hash_index);
+        }
+
         /* keep track of who we are tracking now */
         curr_hash_index = hash_index;
 
@@ -437,6 +473,8 @@ void sched_track_switch (struct tcb_s* new_tcb)
  ************************************************************************/
 inline void sched_track_irq_stop(void)
 {
+    int hash_index;
+
     if (perf_active) {
         /* guard against more more one call per irq */
         if ( curr_irq != NO_IRQ) {
@@ -448,7 +486,11 @@ inline void sched_track_irq_stop(void)
             /* update to the tcb now being tracked
              * after possible context switch in IRQ
              */
-            curr_hash_index = PIDHASH(((struct tcb_s*)g_readytorun.head)->pid);
+            hash_index = PIDHASH(((struct tcb_s*)g_readytorun.head)->pid);
+            if (hash_index != curr_hash_index) {
+                count_switch(curr_hash_index);
+                curr_hash_index = hash_index;
+            }
         }
     }
 }
@@ -495,8 +537,9 @@ inline void sched_track_irq_start (int irq)
 void sched_track_pre_exit(struct tcb_s* dead_tcb)
 {
     if (perf_active) {
-        //ToDo
-        lldbg("Hit sched_track_pre_exit\n");
+        /* charge the dead task for the time up to its exit */
+        g_pidhash[curr_hash_index].thread_time +=
+            get_perf_diff_from_last(get_perf_time());
     }
 }
 
@@ -516,8 +559,116 @@ void sched_track_pre_exit(struct tcb_s* dead_tcb)
 void sched_track_post_exit(struct tcb_s* new_tcb)
 {
     if (perf_active) {
-        lldbg("Hit sched_track_post_exit\n");
+        curr_hash_index = PIDHASH(new_tcb->pid);
     }
 }
 
+/************************************************************************
+ * Name: sched_track_lock
+ *
+ * Description:
+ *   The task took its outermost sched_lock(); start timing the interval
+ *   with pre-emption disabled.
+ *
+ * Inputs:
+ *   tcb - task that disabled pre-emption.
+ *
+ * Return Value:
+ *   void
+ *
+ ************************************************************************/
+void sched_track_lock(FAR struct tcb_s *tcb)
+{
+    if (perf_active) {
+        g_pidhash[PIDHASH(tcb->pid)].lock_start = get_perf_time();
+    }
+}
+
+/************************************************************************
+ * Name: sched_track_unlock
+ *
+ * Description:
+ *   The task re-enabled pre-emption; account for the time it was locked.
+ *
+ * Inputs:
+ *   tcb - task that re-enabled pre-emption.
+ *
+ * Return Value:
+ *   void
+ *
+ ************************************************************************/
+void sched_track_unlock(FAR struct tcb_s *tcb)
+{
+    struct pidhash_s *entry;
+
+    if (perf_active) {
+        entry = &g_pidhash[PIDHASH(tcb->pid)];
+
+        /* ignore a lock taken before tracking was (re)started */
+        if (entry->lock_start) {
+            entry->lock_time += get_perf_time() - entry->lock_start;
+            entry->lock_start = 0;
+        }
+    }
+}
+
+/************************************************************************
+ * Name: perf_track_active
+ *
+ * Description:
+ *   Report whether performance tracking is running.
+ *
+ * Inputs:
+ *   none
+ *
+ * Return Value:
+ *   true between start_perf_track and stop_perf_track
+ *
+ ************************************************************************/
+bool perf_track_active(void)
+{
+    return perf_active;
+}
+
+/************************************************************************
+ * Name: sched_perf_stats
+ *
+ * Description:
+ *   Get the accounting data of one task.  The run time of the running
+ *   task includes its current, not yet accounted, time slice.
+ *
+ * Inputs:
+ *   pid - task to sample
+ *   stats - returned data
+ *
+ * Return Value:
+ *   OK (0) on success
+ *   -ESRCH if there is no such task
+ *
+ ************************************************************************/
+int sched_perf_stats(pid_t pid, FAR struct perf_stats_s *stats)
+{
+    irqstate_t flags = irqsave();
+    int hash_index = PIDHASH(pid);
+    int ret = -ESRCH;
+
+    if (g_pidhash[hash_index].tcb && g_pidhash[hash_index].pid == pid) {
+        stats->run_time = g_pidhash[hash_index].thread_time;
+        stats->nvcsw = g_pidhash[hash_index].nvcsw;
+        stats->nivcsw = g_pidhash[hash_index].nivcsw;
+        stats->lock_time = g_pidhash[hash_index].lock_time;
+
+        if (perf_active && hash_index == curr_hash_index &&
+            curr_irq == NO_IRQ && last_perf_time != 0) {
+            stats->run_time += get_perf_time() - last_perf_time;
+        }
+
+        ret = OK;
+    }
+
+    irqrestore(flags);
+
+    return ret;
+}
+
 #endif
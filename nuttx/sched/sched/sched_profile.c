@@ -0,0 +1,249 @@
+/****************************************************************************
+ * sched/sched/sched_profile.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+
+#include <nuttx/irq.h>
+#include <nuttx/profile.h>
+#include <arch/irq.h>
+
+#ifdef CONFIG_SCHED_PROFILE
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+#define PROFILE_NENTRIES  CONFIG_SCHED_PROFILE_NENTRIES
+#define PROFILE_MASK      (PROFILE_NENTRIES - 1)
+
+#if (PROFILE_NENTRIES & PROFILE_MASK) != 0
+#  error "CONFIG_SCHED_PROFILE_NENTRIES must be a power of two"
+#endif
+
+/* Number of entries probed before a sample is dropped.  The table is
+ * filled with interrupts disabled, so this bounds the time spent per
+ * sample.
+ */
+
+#define PROFILE_NPROBES   8
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* Open addressed hash table of the sampled locations.  Entries are only
+ * added, until the next reset, so that the readers can walk the table
+ * while samples are still being taken.
+ */
+
+static struct profile_entry_s g_profile_table[PROFILE_NENTRIES];
+static struct profile_status_s g_profile;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: profile_hash
+ ****************************************************************************/
+
+static inline unsigned int profile_hash(FAR void *pc, FAR void *lr)
+{
+  /* Thumb code addresses are halfword aligned */
+
+  uint32_t key = ((uintptr_t)pc >> 1) ^ ((uintptr_t)lr << 7);
+
+  return (key * 2654435761u) >> 16;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: profile_sample
+ ****************************************************************************/
+
+void profile_sample(FAR void *pc, FAR void *lr)
+{
+  FAR struct profile_entry_s *entry;
+  unsigned int ndx;
+  int i;
+
+#ifndef CONFIG_SCHED_PROFILE_CALLERS
+  lr = NULL;
+#endif
+
+  g_profile.nsamples++;
+
+  ndx = profile_hash(pc, lr);
+  for (i = 0; i < PROFILE_NPROBES; i++, ndx++)
+    {
+      entry = &g_profile_table[ndx & PROFILE_MASK];
+      if (entry->count == 0)
+        {
+          entry->pc    = pc;
+          entry->lr    = lr;
+          entry->count = 1;
+          g_profile.nentries++;
+          return;
+        }
+
+      if (entry->pc == pc && entry->lr == lr)
+        {
+          entry->count++;
+          return;
+        }
+    }
+
+  g_profile.ndropped++;
+}
+
+/****************************************************************************
+ * Name: profile_start
+ *
+ * Description:
+ *   Start, or resume, sampling.  The results accumulate until
+ *   profile_reset().
+ *
+ ****************************************************************************/
+
+int profile_start(void)
+{
+  int ret;
+
+  if (g_profile.running)
+    {
+      return OK;
+    }
+
+  ret = up_profile_start(CONFIG_SCHED_PROFILE_RATE);
+  if (ret < 0)
+    {
+      return ret;
+    }
+
+  g_profile.rate    = CONFIG_SCHED_PROFILE_RATE;
+  g_profile.running = true;
+  return OK;
+}
+
+/****************************************************************************
+ * Name: profile_stop
+ ****************************************************************************/
+
+void profile_stop(void)
+{
+  if (g_profile.running)
+    {
+      up_profile_stop();
+      g_profile.running = false;
+    }
+}
+
+/****************************************************************************
+ * Name: profile_reset
+ ****************************************************************************/
+
+void profile_reset(void)
+{
+  irqstate_t flags;
+
+  flags = irqsave();
+  memset(g_profile_table, 0, sizeof(g_profile_table));
+  g_profile.nsamples = 0;
+  g_profile.ndropped = 0;
+  g_profile.nentries = 0;
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: profile_status
+ ****************************************************************************/
+
+void profile_status(FAR struct profile_status_s *status)
+{
+  irqstate_t flags;
+
+  flags = irqsave();
+  *status = g_profile;
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: profile_next
+ *
+ * Description:
+ *   Walk the sampled locations.  '*cursor' must be 0 for the first call,
+ *   it is advanced past the returned entry.
+ *
+ * Returned Value:
+ *   OK on success, -ENOENT past the last entry.
+ *
+ ****************************************************************************/
+
+int profile_next(FAR unsigned int *cursor, FAR struct profile_entry_s *entry)
+{
+  irqstate_t flags;
+  unsigned int i;
+
+  for (i = *cursor; i < PROFILE_NENTRIES; i++)
+    {
+      if (g_profile_table[i].count == 0)
+        {
+          continue;
+        }
+
+      flags = irqsave();
+      *entry = g_profile_table[i];
+      irqrestore(flags);
+
+      *cursor = i + 1;
+      return OK;
+    }
+
+  *cursor = PROFILE_NENTRIES;
+  return -ENOENT;
+}
+
+#endif /* CONFIG_SCHED_PROFILE */
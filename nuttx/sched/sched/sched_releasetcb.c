@@ -43,6 +43,7 @@
 #include <sched.h>
 #include <errno.h>
 #include <nuttx/arch.h>
+#include <nuttx/mm/mm.h>
 
 #include "sched/sched.h"
 #include "group/group.h"
@@ -140,6 +141,7 @@ int sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype)
           sched_releasepid(tcb->pid);
         }
 
+#ifndef CONFIG_SCHED_TCBCACHE
       /* Delete the thread's stack if one has been allocated */
 
       if (tcb->stack_alloc_ptr)
@@ -161,6 +163,7 @@ int sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype)
               up_release_stack(tcb, ttype);
             }
         }
+#endif
 
 #ifdef CONFIG_PIC
       /* Delete the task's allocated DSpace region (external modules only) */
@@ -190,6 +193,13 @@ int sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype)
       ret = up_addrenv_detach(tcb->group, tcb);
 #endif
 
+#ifdef CONFIG_MM_TCACHE
+      /* Return any small chunks cached by the thread to their heaps */
+
+      mm_tcache_release(tcb->tcache);
+      tcb->tcache = NULL;
+#endif
+
 #ifdef HAVE_TASK_GROUP
       /* Leave the group (if we did not already leave in task_exithook.c) */
 
@@ -198,7 +208,21 @@ int sched_releasetcb(FAR struct tcb_s *tcb, uint8_t ttype)
 
       /* And, finally, release the TCB itself */
 
+#ifdef CONFIG_SCHED_TCBCACHE
+      /* Unless it is kept for reuse, together with its stack */
+
+      if (!sched_tcbcache(tcb, ttype))
+        {
+          if (tcb->stack_alloc_ptr)
+            {
+              up_release_stack(tcb, ttype);
+            }
+
+          sched_kfree(tcb);
+        }
+#else
       sched_kfree(tcb);
+#endif
     }
 
   return ret;
@@ -0,0 +1,203 @@
+/****************************************************************************
+ * sched/sched/sched_rtrindex.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <queue.h>
+
+#include <nuttx/sched.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_RTR_BITMAP
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* The priority bitmap is split into 32-bit words with one bit per
+ * priority.  Bits are numbered from the MSB so that a count of leading
+ * zeros on a masked word directly yields the lowest priority present at
+ * or above the requested one.  A second word holds one bit per non-empty
+ * map word, so any lookup is at most two CLZ operations.
+ */
+
+#define RTR_NPRIO        (SCHED_PRIORITY_MAX + 1)
+#define RTR_NWORDS       ((RTR_NPRIO + 31) >> 5)
+#define RTR_BIT(n)       (0x80000000u >> (n))
+
+/****************************************************************************
+ * Private Variables
+ ****************************************************************************/
+
+/* Last (most recently queued) task at each priority in g_readytorun */
+
+static FAR struct tcb_s *g_rtrtail[RTR_NPRIO];
+
+/* Priorities that currently have at least one ready-to-run task */
+
+static uint32_t g_rtrmap[RTR_NWORDS];
+static uint32_t g_rtrgroup;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_rtr_after
+ *
+ * Description:
+ *   Return the ready-to-run task that a new task of priority 'prio' must
+ *   follow: the last task of the lowest priority that is still greater
+ *   than or equal to 'prio'.  NULL means the new task goes at the head.
+ *
+ ****************************************************************************/
+
+static inline FAR struct tcb_s *sched_rtr_after(uint8_t prio)
+{
+  uint32_t word = prio >> 5;
+  uint32_t bits = g_rtrmap[word] & (0xffffffff >> (prio & 31));
+  uint32_t groups;
+
+  if (bits == 0)
+    {
+      groups = g_rtrgroup & (0x7fffffff >> word);
+      if (groups == 0)
+        {
+          return NULL;
+        }
+
+      word = __builtin_clz(groups);
+      bits = g_rtrmap[word];
+    }
+
+  return g_rtrtail[(word << 5) + __builtin_clz(bits)];
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_rtr_add
+ *
+ * Description:
+ *   Add a TCB to the g_readytorun list in constant time.  The task is
+ *   queued behind every other ready-to-run task of the same priority, as
+ *   sched_addprioritized() would do.
+ *
+ * Inputs:
+ *   tcb - Points to the TCB to add
+ *
+ * Return Value:
+ *   true if the head of the list has changed.
+ *
+ * Assumptions:
+ *   Same as sched_addprioritized().  Unlike that function, this one is
+ *   also used to queue the idle task at start-up.
+ *
+ ****************************************************************************/
+
+bool sched_rtr_add(FAR struct tcb_s *tcb)
+{
+  uint8_t prio = tcb->sched_priority;
+  FAR struct tcb_s *prev;
+  bool ret = false;
+
+  prev = sched_rtr_after(prio);
+  if (prev)
+    {
+      dq_addafter((FAR dq_entry_t *)prev, (FAR dq_entry_t *)tcb,
+                  (FAR dq_queue_t *)&g_readytorun);
+    }
+  else
+    {
+      dq_addfirst((FAR dq_entry_t *)tcb, (FAR dq_queue_t *)&g_readytorun);
+      ret = true;
+    }
+
+  g_rtrtail[prio]     = tcb;
+  g_rtrmap[prio >> 5] |= RTR_BIT(prio & 31);
+  g_rtrgroup         |= RTR_BIT(prio >> 5);
+  return ret;
+}
+
+/****************************************************************************
+ * Name: sched_rtr_remove
+ *
+ * Description:
+ *   Remove a TCB from the g_readytorun list and update the priority index.
+ *
+ * Inputs:
+ *   tcb - Points to the TCB to remove
+ *
+ * Assumptions:
+ *   The caller has established a critical section and the TCB is in the
+ *   g_readytorun list with the priority it was added with.
+ *
+ ****************************************************************************/
+
+void sched_rtr_remove(FAR struct tcb_s *tcb)
+{
+  uint8_t prio = tcb->sched_priority;
+  FAR struct tcb_s *prev;
+
+  if (g_rtrtail[prio] == tcb)
+    {
+      prev = (FAR struct tcb_s *)tcb->blink;
+      if (prev && prev->sched_priority == prio)
+        {
+          g_rtrtail[prio] = prev;
+        }
+      else
+        {
+          g_rtrtail[prio] = NULL;
+          g_rtrmap[prio >> 5] &= ~RTR_BIT(prio & 31);
+          if (g_rtrmap[prio >> 5] == 0)
+            {
+              g_rtrgroup &= ~RTR_BIT(prio >> 5);
+            }
+        }
+    }
+
+  dq_rem((FAR dq_entry_t *)tcb, (FAR dq_queue_t *)&g_readytorun);
+}
+
+#endif /* CONFIG_SCHED_RTR_BITMAP */
@@ -0,0 +1,184 @@
+/****************************************************************************
+ * sched/sched/sched_stackusage.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <string.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/sched.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_STACK_USAGE
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* One record per thread name, filled in order of first appearance */
+
+static struct stackusage_s g_stackusage[CONFIG_SCHED_STACK_USAGE_NRECORDS];
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_stackrecord_handler
+ *
+ * Description:
+ *   sched_foreach() callback that records one running thread.
+ *
+ ****************************************************************************/
+
+static void sched_stackrecord_handler(FAR struct tcb_s *tcb, FAR void *arg)
+{
+  sched_stackrecord(tcb);
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_stackrecord
+ *
+ * Description:
+ *   Merge the stack high-water mark of a thread into the record for its
+ *   name.  If all records are in use by other names, the thread is not
+ *   recorded.
+ *
+ * Inputs:
+ *   tcb - The thread to record.  Its stack must still be allocated.
+ *
+ * Return:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_stackrecord(FAR struct tcb_s *tcb)
+{
+  FAR struct stackusage_s *usage;
+  irqstate_t flags;
+  size_t peak;
+  int ndx;
+
+  if (tcb->stack_alloc_ptr == NULL)
+    {
+      return;
+    }
+
+  peak  = up_check_tcbstack(tcb);
+  flags = irqsave();
+
+  for (ndx = 0; ndx < CONFIG_SCHED_STACK_USAGE_NRECORDS; ndx++)
+    {
+      usage = &g_stackusage[ndx];
+
+      /* An empty record ends the list:  claim it for this name */
+
+      if (usage->name[0] == '\0')
+        {
+          strncpy(usage->name, tcb->name, CONFIG_TASK_NAME_SIZE);
+          usage->name[CONFIG_TASK_NAME_SIZE] = '\0';
+          usage->size = tcb->adj_stack_size;
+          usage->peak = peak;
+          break;
+        }
+
+      if (strncmp(usage->name, tcb->name, CONFIG_TASK_NAME_SIZE) == 0)
+        {
+          if (tcb->adj_stack_size > usage->size)
+            {
+              usage->size = tcb->adj_stack_size;
+            }
+
+          if (peak > usage->peak)
+            {
+              usage->peak = peak;
+            }
+
+          break;
+        }
+    }
+
+  irqrestore(flags);
+}
+
+/****************************************************************************
+ * Name: sched_stackusage
+ *
+ * Description:
+ *   Record all running threads and then provide a copy of each record to
+ *   the callback function.  The callback runs with interrupts enabled and
+ *   may block.
+ *
+ * Inputs:
+ *   handler - The function to be called with each record
+ *   arg     - An argument that will be passed along with each record
+ *
+ * Return:
+ *   None
+ *
+ ****************************************************************************/
+
+void sched_stackusage(sched_stackusage_t handler, FAR void *arg)
+{
+  struct stackusage_s usage;
+  irqstate_t flags;
+  int ndx;
+
+  sched_foreach(sched_stackrecord_handler, NULL);
+
+  for (ndx = 0; ndx < CONFIG_SCHED_STACK_USAGE_NRECORDS; ndx++)
+    {
+      flags = irqsave();
+      usage = g_stackusage[ndx];
+      irqrestore(flags);
+
+      if (usage.name[0] == '\0')
+        {
+          break;
+        }
+
+      handler(&usage, arg);
+    }
+}
+
+#endif /* CONFIG_SCHED_STACK_USAGE */
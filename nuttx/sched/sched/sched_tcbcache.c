@@ -0,0 +1,238 @@
+/****************************************************************************
+ * sched/sched/sched_tcbcache.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sched.h>
+#include <debug.h>
+
+#include <nuttx/arch.h>
+#include <nuttx/kmalloc.h>
+
+#include "sched/sched.h"
+
+#ifdef CONFIG_SCHED_TCBCACHE
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+/* Cached TCBs, linked through their flink, most recently released first.
+ * Each still owns the stack that it had when it was released.
+ */
+
+static FAR struct tcb_s *g_tcbcache;
+static uint8_t g_ntcbcache;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_tcbsize
+ ****************************************************************************/
+
+static inline size_t sched_tcbsize(uint8_t ttype)
+{
+#ifndef CONFIG_DISABLE_PTHREAD
+  if ((ttype & TCB_FLAG_TTYPE_MASK) == TCB_FLAG_TTYPE_PTHREAD)
+    {
+      return sizeof(struct pthread_tcb_s);
+    }
+#endif
+
+  return sizeof(struct task_tcb_s);
+}
+
+/****************************************************************************
+ * Name: sched_tcbflush
+ *
+ * Description:
+ *   Return all cached TCBs and their stacks to the heap.
+ *
+ ****************************************************************************/
+
+static void sched_tcbflush(void)
+{
+  FAR struct tcb_s *tcb;
+  irqstate_t flags;
+
+  for (; ; )
+    {
+      flags = irqsave();
+      tcb   = g_tcbcache;
+      if (tcb != NULL)
+        {
+          g_tcbcache = tcb->flink;
+          g_ntcbcache--;
+        }
+
+      irqrestore(flags);
+
+      if (tcb == NULL)
+        {
+          break;
+        }
+
+      up_release_stack(tcb, tcb->flags & TCB_FLAG_TTYPE_MASK);
+      sched_kfree(tcb);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: sched_tcballoc
+ *
+ * Description:
+ *   Allocate a zeroed TCB for a new thread of type 'ttype'.  If a cached
+ *   TCB of the same type was created with the same stack size, it is
+ *   reused together with its stack:  The stack fields are preserved so that
+ *   up_create_stack() keeps that stack.
+ *
+ * Input Parameters:
+ *   ttype      - The thread type (TCB_FLAG_TTYPE_*)
+ *   stack_size - The stack size that will be passed to up_create_stack()
+ *
+ * Returned Value:
+ *   The TCB, or NULL if there is not enough memory.
+ *
+ ****************************************************************************/
+
+FAR struct tcb_s *sched_tcballoc(uint8_t ttype, size_t stack_size)
+{
+  FAR struct tcb_s **prev;
+  FAR struct tcb_s *tcb;
+  FAR void *alloc_ptr;
+  FAR void *adj_ptr;
+  size_t adj_size;
+  size_t tcbsize = sched_tcbsize(ttype);
+  irqstate_t flags;
+
+  flags = irqsave();
+  for (prev = &g_tcbcache; (tcb = *prev) != NULL; prev = &tcb->flink)
+    {
+      if ((tcb->flags & TCB_FLAG_TTYPE_MASK) == ttype &&
+          tcb->req_stack_size == stack_size)
+        {
+          *prev = tcb->flink;
+          g_ntcbcache--;
+          break;
+        }
+    }
+
+  irqrestore(flags);
+
+  if (tcb != NULL)
+    {
+      alloc_ptr = tcb->stack_alloc_ptr;
+      adj_ptr   = tcb->adj_stack_ptr;
+      adj_size  = tcb->adj_stack_size;
+
+      memset(tcb, 0, tcbsize);
+
+      tcb->stack_alloc_ptr = alloc_ptr;
+      tcb->adj_stack_ptr   = adj_ptr;
+      tcb->adj_stack_size  = adj_size;
+    }
+  else
+    {
+      tcb = (FAR struct tcb_s *)kmm_zalloc(tcbsize);
+      if (tcb == NULL)
+        {
+          /* Give the memory held by the cache back and try again */
+
+          sched_tcbflush();
+          tcb = (FAR struct tcb_s *)kmm_zalloc(tcbsize);
+          if (tcb == NULL)
+            {
+              return NULL;
+            }
+        }
+    }
+
+  tcb->req_stack_size = stack_size;
+  return tcb;
+}
+
+/****************************************************************************
+ * Name: sched_tcbcache
+ *
+ * Description:
+ *   Keep a TCB that is being released, with its stack, for reuse by
+ *   sched_tcballoc().  This is called from sched_releasetcb() after
+ *   everything else held by the TCB has been released and may be called
+ *   from any context.
+ *
+ * Returned Value:
+ *   true if the TCB was cached; false if the caller must free it.
+ *
+ ****************************************************************************/
+
+bool sched_tcbcache(FAR struct tcb_s *tcb, uint8_t ttype)
+{
+  irqstate_t flags;
+  bool cached = false;
+
+  /* Only TCBs from sched_tcballoc() with a stack of their own */
+
+  if (tcb->stack_alloc_ptr == NULL || tcb->req_stack_size == 0)
+    {
+      return false;
+    }
+
+  flags = irqsave();
+  if (g_ntcbcache < CONFIG_SCHED_TCBCACHE_NENTRIES)
+    {
+      tcb->flags  = ttype & TCB_FLAG_TTYPE_MASK;
+      tcb->flink  = g_tcbcache;
+      g_tcbcache  = tcb;
+      g_ntcbcache++;
+      cached      = true;
+    }
+
+  irqrestore(flags);
+  return cached;
+}
+
+#endif /* CONFIG_SCHED_TCBCACHE */
@@ -91,6 +91,14 @@
  * Public Variables
  ************************************************************************/
 
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+/* The absolute time at which the running interval timer expires.  This is
+ * what the IDLE loop governor uses to select a sleep state.
+ */
+
+volatile uint64_t g_timer_deadline;
+#endif
+
 /************************************************************************
  * Private Variables
  ************************************************************************/
@@ -427,6 +435,10 @@ static void sched_timer_start(unsigned int ticks)
   /* Set up the next timer interval (or not) */
 
   g_timer_interval = 0;
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+  g_timer_deadline = 0;
+#endif
+
   if (ticks > 0)
     {
       struct timespec ts;
@@ -453,6 +465,23 @@ static void sched_timer_start(unsigned int ticks)
       ts.tv_sec  = (time_t)secs;
       ts.tv_nsec = (long)nsecs;
 
+#ifdef CONFIG_SCHED_IDLE_GOVERNOR
+      /* Remember when the interval will expire */
+
+#ifdef CONFIG_SCHED_TICKLESS_ALARM
+      g_timer_deadline = (uint64_t)g_stop_time.tv_sec * USEC_PER_SEC +
+                         g_stop_time.tv_nsec / NSEC_PER_USEC + usecs;
+#else
+        {
+          struct timespec now;
+
+          (void)up_timer_gettime(&now);
+          g_timer_deadline = (uint64_t)now.tv_sec * USEC_PER_SEC +
+                             now.tv_nsec / NSEC_PER_USEC + usecs;
+        }
+#endif
+#endif
+
 #ifdef CONFIG_SCHED_TICKLESS_ALARM
       /* Convert the delay to a time in the future (with respect
        * to the time when last stopped the timer).
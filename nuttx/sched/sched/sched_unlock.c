@@ -115,6 +115,10 @@ int sched_unlock(void)
         {
           rtcb->lockcount = 0;
 
+#ifdef CONFIG_USEC_MEASURE_PERF
+          sched_track_unlock(rtcb);
+#endif
+
           /* Release any ready-to-run tasks that have collected in
            * g_pendingtasks.
            */
@@ -129,6 +129,39 @@ static inline FAR struct semholder_s *sem_allocholder(sem_t *sem)
   return pholder;
 }
 
+/****************************************************************************
+ * Name: sem_promoteholder
+ *
+ * Description:
+ *   An uncontended count is recorded only in sem->fholder so that taking
+ *   it does not have to touch the pool of pre-allocated holders.  Before
+ *   the list of holders is examined, move that lightweight owner into a
+ *   real holder container so that the priority inheritance logic sees one
+ *   consistent list.
+ *
+ ****************************************************************************/
+
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
+static void sem_promoteholder(FAR sem_t *sem)
+{
+  FAR struct semholder_s *pholder;
+
+  if (sem->fholder)
+    {
+      pholder = sem_allocholder(sem);
+      if (pholder)
+        {
+          pholder->htcb   = sem->fholder;
+          pholder->counts = 1;
+        }
+
+      sem->fholder = NULL;
+    }
+}
+#else
+#  define sem_promoteholder(sem)
+#endif
+
 /****************************************************************************
  * Name: sem_findholder
  ****************************************************************************/
@@ -140,6 +173,8 @@ static FAR struct semholder_s *sem_findholder(sem_t *sem,
 
   /* Try to find the holder in the list of holders associated with this semaphore */
 
+  sem_promoteholder(sem);
+
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
   for (pholder = sem->hhead; pholder; pholder = pholder->flink)
 #else
@@ -231,6 +266,8 @@ static int sem_foreachholder(FAR sem_t *sem, holderhandler_t handler, FAR void *
 #endif
   int ret = 0;
 
+  sem_promoteholder(sem);
+
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
   for (pholder = sem->hhead; pholder && ret == 0; pholder = next)
 #else
@@ -810,6 +847,7 @@ void sem_destroyholder(FAR sem_t *sem)
    */
 
 #if CONFIG_SEM_PREALLOCHOLDERS > 0
+  sem->fholder = NULL;
   if (sem->hhead)
     {
       sdbg("Semaphore destroyed with holders\n");
@@ -846,6 +884,19 @@ void sem_addholder(FAR sem_t *sem)
   FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
   FAR struct semholder_s *pholder;
 
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
+  /* Fast path:  If nobody else holds a count, just remember the new holder.
+   * It is moved into a real holder container only if some other thread
+   * later has to examine the holders, i.e., on contention.
+   */
+
+  if (sem->hhead == NULL && sem->fholder == NULL)
+    {
+      sem->fholder = rtcb;
+      return;
+    }
+#endif
+
   /* Find or allocate a container for this new holder */
 
   pholder = sem_findorallocateholder(sem, rtcb);
@@ -921,6 +972,56 @@ void sem_releaseholder(FAR sem_t *sem)
     }
 }
 
+/****************************************************************************
+ * Name: sem_fastrelease
+ *
+ * Description:
+ *   Called from sem_post() before any other holder logic.  If the running
+ *   thread holds exactly one count, nobody is waiting, and no other thread
+ *   holds a count, then there is no priority to restore:  Just forget the
+ *   holder.  This is the same end state that sem_releaseholder() followed by
+ *   sem_restorebaseprio() would reach but without locking the scheduler or
+ *   walking the holder list.
+ *
+ * Parameters:
+ *   sem - A reference to the semaphore being posted
+ *
+ * Return Value:
+ *   true if the holder was released; the caller must still increment the
+ *   semaphore count.  false if the normal path must be taken.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+bool sem_fastrelease(FAR sem_t *sem)
+{
+  FAR struct tcb_s *rtcb = (FAR struct tcb_s*)g_readytorun.head;
+
+  if (sem->semcount < 0 || up_interrupt_context())
+    {
+      return false;
+    }
+
+#if CONFIG_SEM_PREALLOCHOLDERS > 0
+  if (sem->fholder == rtcb)
+    {
+      sem->fholder = NULL;
+      return true;
+    }
+#else
+  if (sem->holder.htcb == rtcb && sem->holder.counts == 1)
+    {
+      sem->holder.htcb   = NULL;
+      sem->holder.counts = 0;
+      return true;
+    }
+#endif
+
+  return false;
+}
+
 /****************************************************************************
  * Name: sem_restorebaseprio
  *
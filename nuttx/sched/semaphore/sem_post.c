@@ -120,6 +120,20 @@ int sem_post(FAR sem_t *sem)
       /* Perform the semaphore unlock operation. */
 
       ASSERT(sem->semcount < SEM_VALUE_MAX);
+
+#ifdef CONFIG_PRIORITY_INHERITANCE
+      /* If the count is being returned by its only holder and nobody is
+       * waiting for it, then there is no priority inheritance work to do.
+       */
+
+      if (sem_fastrelease(sem))
+        {
+          sem->semcount++;
+          irqrestore(saved_state);
+          return OK;
+        }
+#endif
+
       sem_releaseholder(sem);
       sem->semcount++;
 
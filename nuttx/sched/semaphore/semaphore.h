@@ -107,6 +107,7 @@ void sem_destroyholder(FAR sem_t *sem);
 void sem_addholder(FAR sem_t *sem);
 void sem_boostpriority(FAR sem_t *sem);
 void sem_releaseholder(FAR sem_t *sem);
+bool sem_fastrelease(FAR sem_t *sem);
 void sem_restorebaseprio(FAR struct tcb_s *stcb, FAR sem_t *sem);
 #  ifndef CONFIG_DISABLE_SIGNALS
 void sem_canceled(FAR struct tcb_s *stcb, FAR sem_t *sem);
@@ -110,7 +110,11 @@ static int thread_create(FAR const char *name, uint8_t ttype, int priority,
 
   /* Allocate a TCB for the new task. */
 
+#ifdef CONFIG_SCHED_TCBCACHE
+  tcb = (FAR struct task_tcb_s *)sched_tcballoc(ttype, stack_size);
+#else
   tcb = (FAR struct task_tcb_s *)kmm_zalloc(sizeof(struct task_tcb_s));
+#endif
   if (!tcb)
     {
       sdbg("ERROR: Failed to allocate TCB\n");
@@ -639,6 +639,12 @@ void task_exithook(FAR struct tcb_s *tcb, int status, bool nonblocking)
     }
 #endif
 
+#ifdef CONFIG_SCHED_STACK_USAGE
+  /* Keep the stack high-water mark for the stack usage report */
+
+  sched_stackrecord(tcb);
+#endif
+
   /* If the task was terminated by another task, it may be in an unknown
    * state.  Make some feeble effort to recover the state.
    */
@@ -91,8 +91,10 @@
 
 int wd_cancel(WDOG_ID wdog)
 {
+#ifndef CONFIG_WDOG_PAIRING_HEAP
   FAR struct wdog_s *curr;
   FAR struct wdog_s *prev;
+#endif
   irqstate_t state;
   int ret = ERROR;
 
@@ -106,6 +108,27 @@ int wd_cancel(WDOG_ID wdog)
    * active.
    */
 
+#ifdef CONFIG_WDOG_PAIRING_HEAP
+  if (wdog && WDOG_ISACTIVE(wdog))
+    {
+      /* Remove the watchdog from the timer heap.  If it was the next one
+       * to expire, reassess the interval timer.
+       */
+
+      if (wdog == g_wdheap)
+        {
+          wd_heap_remove(wdog);
+          sched_timer_reassess();
+        }
+      else
+        {
+          wd_heap_remove(wdog);
+        }
+
+      WDOG_CLRACTIVE(wdog);
+      ret = OK;
+    }
+#else
   if (wdog && WDOG_ISACTIVE(wdog))
     {
       /* Search the g_wdactivelist for the target FCB.  We can't use sq_rem
@@ -167,6 +190,7 @@ int wd_cancel(WDOG_ID wdog)
 
       ret = OK;
     }
+#endif
 
   irqrestore(state);
   return ret;
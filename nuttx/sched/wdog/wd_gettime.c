@@ -92,6 +92,15 @@ int wd_gettime(WDOG_ID wdog)
   /* Verify the wdog */
 
   flags = irqsave();
+#ifdef CONFIG_WDOG_PAIRING_HEAP
+  if (wdog && WDOG_ISACTIVE(wdog))
+    {
+      int delay = WDOG_REMAINING(wdog);
+
+      irqrestore(flags);
+      return delay > 0 ? delay : 0;
+    }
+#else
   if (wdog && WDOG_ISACTIVE(wdog))
     {
       /* Traverse the watchdog list accumulating lag times until we find the wdog
@@ -111,6 +120,7 @@ int wd_gettime(WDOG_ID wdog)
             }
         }
     }
+#endif
 
   irqrestore(flags);
   return 0;
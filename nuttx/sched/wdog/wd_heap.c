@@ -0,0 +1,234 @@
+/****************************************************************************
+ * sched/wdog/wd_heap.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <nuttx/config.h>
+
+#include <stdint.h>
+
+#include <nuttx/wdog.h>
+
+#include "wdog/wdog.h"
+
+#ifdef CONFIG_WDOG_PAIRING_HEAP
+
+/****************************************************************************
+ * Public Variables
+ ****************************************************************************/
+
+/* Root of the pairing heap of active watchdogs, ordered by expiration */
+
+FAR struct wdog_s *g_wdheap;
+
+/* Number of ticks elapsed since the watchdogs were initialized.  The
+ * expiration time of an active watchdog is kept in its lag field, relative
+ * to this clock.
+ */
+
+uint32_t g_wdclock;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_heap_meld
+ *
+ * Description:
+ *   Meld two heaps: the root expiring last becomes the first child of the
+ *   other one.  Both roots must have no sibling.
+ *
+ ****************************************************************************/
+
+static FAR struct wdog_s *wd_heap_meld(FAR struct wdog_s *a,
+                                       FAR struct wdog_s *b)
+{
+  FAR struct wdog_s *tmp;
+
+  if (!a)
+    {
+      return b;
+    }
+
+  if (!b)
+    {
+      return a;
+    }
+
+  if (WDOG_BEFORE(b, a))
+    {
+      tmp = a;
+      a   = b;
+      b   = tmp;
+    }
+
+  b->prev = a;
+  b->next = a->child;
+  if (a->child)
+    {
+      a->child->prev = b;
+    }
+
+  a->child = b;
+  return a;
+}
+
+/****************************************************************************
+ * Name: wd_heap_merge_pairs
+ *
+ * Description:
+ *   Meld a list of sibling heaps into a single heap: siblings are first
+ *   melded by pairs from left to right, then the pairs are melded from
+ *   right to left.  This is what gives the pairing heap its O(log n)
+ *   amortized removal.
+ *
+ ****************************************************************************/
+
+static FAR struct wdog_s *wd_heap_merge_pairs(FAR struct wdog_s *first)
+{
+  FAR struct wdog_s *pairs = NULL;
+  FAR struct wdog_s *root = NULL;
+  FAR struct wdog_s *a;
+  FAR struct wdog_s *b;
+
+  while (first)
+    {
+      a     = first;
+      b     = a->next;
+      first = b ? b->next : NULL;
+
+      a->next = NULL;
+      a->prev = NULL;
+      if (b)
+        {
+          b->next = NULL;
+          b->prev = NULL;
+          a = wd_heap_meld(a, b);
+        }
+
+      /* Stack the pairs, so that the last one comes out first */
+
+      a->next = pairs;
+      pairs   = a;
+    }
+
+  while (pairs)
+    {
+      a       = pairs;
+      pairs   = a->next;
+      a->next = NULL;
+      root    = wd_heap_meld(root, a);
+    }
+
+  return root;
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+/****************************************************************************
+ * Name: wd_heap_insert
+ *
+ * Description:
+ *   Add a watchdog, whose lag already holds its expiration time, to the
+ *   heap of active watchdogs.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void wd_heap_insert(FAR struct wdog_s *wdog)
+{
+  wdog->next  = NULL;
+  wdog->prev  = NULL;
+  wdog->child = NULL;
+
+  g_wdheap = wd_heap_meld(g_wdheap, wdog);
+}
+
+/****************************************************************************
+ * Name: wd_heap_remove
+ *
+ * Description:
+ *   Remove an active watchdog from the heap.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ****************************************************************************/
+
+void wd_heap_remove(FAR struct wdog_s *wdog)
+{
+  FAR struct wdog_s *sub;
+
+  if (wdog == g_wdheap)
+    {
+      g_wdheap = wd_heap_merge_pairs(wdog->child);
+    }
+  else
+    {
+      /* Unlink the watchdog from its parent (if it is the first child) or
+       * from its previous sibling.
+       */
+
+      if (wdog->prev->child == wdog)
+        {
+          wdog->prev->child = wdog->next;
+        }
+      else
+        {
+          wdog->prev->next = wdog->next;
+        }
+
+      if (wdog->next)
+        {
+          wdog->next->prev = wdog->prev;
+        }
+
+      wdog->next = NULL;
+      sub = wd_heap_merge_pairs(wdog->child);
+      g_wdheap = wd_heap_meld(g_wdheap, sub);
+    }
+
+  wdog->next  = NULL;
+  wdog->prev  = NULL;
+  wdog->child = NULL;
+}
+
+#endif /* CONFIG_WDOG_PAIRING_HEAP */
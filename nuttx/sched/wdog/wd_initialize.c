@@ -122,6 +122,11 @@ void wd_initialize(void)
   sq_init(&g_wdfreelist);
   sq_init(&g_wdactivelist);
 
+#ifdef CONFIG_WDOG_PAIRING_HEAP
+  g_wdheap  = NULL;
+  g_wdclock = 0;
+#endif
+
   /* The g_wdfreelist must be loaded at initialization time to hold the
    * configured number of watchdogs.
    */
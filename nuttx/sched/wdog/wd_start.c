@@ -96,6 +96,69 @@ typedef void (*wdentry4_t)(int argc, uint32_t arg1, uint32_t arg2,
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
+/****************************************************************************
+ * Name: wd_dispatch
+ *
+ * Description:
+ *   Execute the function of a watchdog that has expired.
+ *
+ * Parameters:
+ *   wdog - The expired watchdog, already removed from the timer queue
+ *
+ * Return Value:
+ *   None
+ *
+ * Assumptions:
+ *
+ ****************************************************************************/
+
+static inline void wd_dispatch(FAR struct wdog_s *wdog)
+{
+  /* Indicate that the watchdog is no longer active. */
+
+  WDOG_CLRACTIVE(wdog);
+
+  /* Execute the watchdog function */
+
+  up_setpicbase(wdog->picbase);
+  switch (wdog->argc)
+    {
+      default:
+        DEBUGPANIC();
+        break;
+
+      case 0:
+        (*((wdentry0_t)(wdog->func)))(0);
+        break;
+
+#if CONFIG_MAX_WDOGPARMS > 0
+      case 1:
+        (*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 1
+      case 2:
+        (*((wdentry2_t)(wdog->func)))(2,
+                        wdog->parm[0], wdog->parm[1]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 2
+      case 3:
+        (*((wdentry3_t)(wdog->func)))(3,
+                        wdog->parm[0], wdog->parm[1],
+                        wdog->parm[2]);
+        break;
+#endif
+#if CONFIG_MAX_WDOGPARMS > 3
+      case 4:
+        (*((wdentry4_t)(wdog->func)))(4,
+                        wdog->parm[0], wdog->parm[1],
+                        wdog->parm[2] ,wdog->parm[3]);
+        break;
+#endif
+    }
+}
+
 /****************************************************************************
  * Name: wd_expiration
  *
@@ -113,6 +176,24 @@ typedef void (*wdentry4_t)(int argc, uint32_t arg1, uint32_t arg2,
  *
  ****************************************************************************/
 
+#ifdef CONFIG_WDOG_PAIRING_HEAP
+static inline void wd_expiration(void)
+{
+  FAR struct wdog_s *wdog;
+
+  /* Process the watchdog at the root of the heap as well as any other
+   * watchdogs that became ready to run at this time.  A watchdog function
+   * may restart its own watchdog, which is then inserted on the current
+   * time base and cannot be expired yet.
+   */
+
+  while ((wdog = g_wdheap) != NULL && WDOG_REMAINING(wdog) <= 0)
+    {
+      wd_heap_remove(wdog);
+      wd_dispatch(wdog);
+    }
+}
+#else
 static inline void wd_expiration(void)
 {
   FAR struct wdog_s *wdog;
@@ -141,52 +222,13 @@ static inline void wd_expiration(void)
               ((FAR struct wdog_s *)g_wdactivelist.head)->lag += wdog->lag;
             }
 
-          /* Indicate that the watchdog is no longer active. */
-
-          WDOG_CLRACTIVE(wdog);
-
           /* Execute the watchdog function */
 
-          up_setpicbase(wdog->picbase);
-          switch (wdog->argc)
-            {
-              default:
-                DEBUGPANIC();
-                break;
-
-              case 0:
-                (*((wdentry0_t)(wdog->func)))(0);
-                break;
-
-#if CONFIG_MAX_WDOGPARMS > 0
-              case 1:
-                (*((wdentry1_t)(wdog->func)))(1, wdog->parm[0]);
-                break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 1
-              case 2:
-                (*((wdentry2_t)(wdog->func)))(2,
-                                wdog->parm[0], wdog->parm[1]);
-                break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 2
-              case 3:
-                (*((wdentry3_t)(wdog->func)))(3,
-                                wdog->parm[0], wdog->parm[1],
-                                wdog->parm[2]);
-                break;
-#endif
-#if CONFIG_MAX_WDOGPARMS > 3
-              case 4:
-                (*((wdentry4_t)(wdog->func)))(4,
-                                wdog->parm[0], wdog->parm[1],
-                                wdog->parm[2] ,wdog->parm[3]);
-                break;
-#endif
-            }
+          wd_dispatch(wdog);
         }
     }
 }
+#endif
 
 /****************************************************************************
  * Public Functions
@@ -228,10 +270,12 @@ static inline void wd_expiration(void)
 int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
 {
   va_list ap;
+#ifndef CONFIG_WDOG_PAIRING_HEAP
   FAR struct wdog_s *curr;
   FAR struct wdog_s *prev;
   FAR struct wdog_s *next;
   int32_t now;
+#endif
   irqstate_t state;
   int i;
 
@@ -295,6 +339,12 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
   (void)sched_timer_cancel();
 #endif
 
+#ifdef CONFIG_WDOG_PAIRING_HEAP
+  /* Insert the watchdog in the heap, keyed by its expiration time */
+
+  wdog->lag = (int)(g_wdclock + (uint32_t)delay);
+  wd_heap_insert(wdog);
+#else
   /* Do the easy case first -- when the watchdog timer queue is empty. */
 
   if (g_wdactivelist.head == NULL)
@@ -380,9 +430,13 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
         }
     }
 
-  /* Put the lag into the watchdog structure and mark it as active. */
+  /* Put the lag into the watchdog structure. */
 
   wdog->lag = delay;
+#endif
+
+  /* Mark the watchdog as active. */
+
   WDOG_SETACTIVE(wdog);
 
 #ifdef CONFIG_SCHED_TICKLESS
@@ -423,7 +477,37 @@ int wd_start(WDOG_ID wdog, int delay, wdentry_t wdentry,  int argc, ...)
  *
  ****************************************************************************/
 
-#ifdef CONFIG_SCHED_TICKLESS
+#if defined(CONFIG_WDOG_PAIRING_HEAP) && defined(CONFIG_SCHED_TICKLESS)
+unsigned int wd_timer(int ticks)
+{
+  /* Advance the time base and run the watchdogs that expired meanwhile */
+
+  if (ticks > 0)
+    {
+      g_wdclock += ticks;
+    }
+
+  wd_expiration();
+
+  /* Return the delay for the next watchdog to expire */
+
+  return g_wdheap ? WDOG_REMAINING(g_wdheap) : 0;
+}
+
+#elif defined(CONFIG_WDOG_PAIRING_HEAP)
+void wd_timer(void)
+{
+  g_wdclock++;
+
+  /* Check if there are any active watchdogs to process */
+
+  if (g_wdheap)
+    {
+      wd_expiration();
+    }
+}
+
+#elif defined(CONFIG_SCHED_TICKLESS)
 unsigned int wd_timer(int ticks)
 {
   FAR struct wdog_s *wdog;
@@ -52,6 +52,17 @@
  * Pre-processor Definitions
  ************************************************************************/
 
+#ifdef CONFIG_WDOG_PAIRING_HEAP
+/* With the pairing heap, the lag of an active watchdog holds its
+ * expiration time on the g_wdclock time base.
+ */
+
+#  define WDOG_BEFORE(a,b) \
+     ((int32_t)((uint32_t)(a)->lag - (uint32_t)(b)->lag) < 0)
+#  define WDOG_REMAINING(w) \
+     ((int32_t)((uint32_t)(w)->lag - g_wdclock))
+#endif
+
 /************************************************************************
  * Public Type Declarations
  ************************************************************************/
@@ -81,6 +92,18 @@ extern sq_queue_t g_wdfreelist;
 
 extern sq_queue_t g_wdactivelist;
 
+#ifdef CONFIG_WDOG_PAIRING_HEAP
+/* When the pairing heap is selected, active watchdogs are kept in a heap
+ * ordered by expiration time instead, and g_wdactivelist is unused.
+ */
+
+extern FAR struct wdog_s *g_wdheap;
+
+/* Ticks elapsed since initialization, the time base of the heap */
+
+extern uint32_t g_wdclock;
+#endif
+
 /* This is the number of free, pre-allocated watchdog structures in the
  * g_wdfreelist.  This value is used to enforce a reserve for interrupt
  * handlers.
@@ -113,6 +136,23 @@ extern uint16_t g_wdnfree;
 
 void weak_function wd_initialize(void);
 
+/************************************************************************
+ * Name: wd_heap_insert and wd_heap_remove
+ *
+ * Description:
+ *   Add an active watchdog to the timer heap, or remove it.  The lag of
+ *   the watchdog must hold its expiration time.
+ *
+ * Assumptions:
+ *   Interrupts are disabled.
+ *
+ ************************************************************************/
+
+#ifdef CONFIG_WDOG_PAIRING_HEAP
+void wd_heap_insert(FAR struct wdog_s *wdog);
+void wd_heap_remove(FAR struct wdog_s *wdog);
+#endif
+
 /****************************************************************************
  * Name: wd_timer
  *
@@ -0,0 +1,242 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2016 Motorola Mobility, LLC
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 1. Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+# 3. Neither the name of the copyright holder nor the names of its
+# contributors may be used to endorse or promote products derived from this
+# software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+# Decode the binary SYSLOG written by binlog_dump() (see
+# include/nuttx/syslog/binlog.h).
+#
+# Usage:
+#   binlog_decode.py [--ticks-only] nuttx.elf binlog.bin
+#
+# The records only hold the address of their format string; the strings
+# are read from the allocated sections of the ELF image that produced the
+# log, so it must be the exact image running on the target.
+#
+from __future__ import print_function
+
+import argparse
+import re
+import struct
+import sys
+
+MAGIC = 0x474c4e42
+HDR_FMT = 'IBBHIII'
+REC_FMT = 'HHII'
+
+SHT_PROGBITS = 1
+SHF_ALLOC = 0x2
+
+SPEC = re.compile(r'%([-+ #0~]*)(\d+|\*)?(?:\.(\d+|\*))?'
+                  r'(hh|h|ll|l|L|q|j|z|t)?([diouxXbeEfgGcsp%])')
+
+
+class Image(object):
+    """Read-only view of the allocated sections of an ELF file"""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError('%s: not an ELF file' % path)
+
+        elfclass = bytearray(self.data)[4]
+        endian = '<' if bytearray(self.data)[5] == 1 else '>'
+        if elfclass == 1:
+            shoff, = struct.unpack_from(endian + 'I', self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + 'HH', self.data,
+                                                  0x2e)
+            shfmt = endian + 'IIIIII'
+        else:
+            shoff, = struct.unpack_from(endian + 'Q', self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + 'HH', self.data,
+                                                  0x3a)
+            shfmt = endian + 'IIQQQQ'
+
+        self.sections = []
+        for i in range(shnum):
+            _, shtype, flags, addr, offset, size = \
+                struct.unpack_from(shfmt, self.data, shoff + i * shentsize)
+            if shtype == SHT_PROGBITS and flags & SHF_ALLOC and size:
+                self.sections.append((addr, offset, size))
+
+    def string(self, addr):
+        for base, offset, size in self.sections:
+            if base <= addr < base + size:
+                start = offset + addr - base
+                end = self.data.find(b'\0', start, offset + size)
+                if end < 0:
+                    end = offset + size
+                return self.data[start:end].decode('latin-1')
+        return None
+
+
+def specs(fmt):
+    """Yield the conversion specifications of 'fmt' (as match objects)"""
+    for m in SPEC.finditer(fmt):
+        if m.group(5) != '%':
+            yield m
+
+
+def arg_kind(m):
+    """Match the classification done by binlog_nextspec() on the target"""
+    conv, length = m.group(5), m.group(4) or ''
+    if conv == 's':
+        return 'string'
+    if conv in 'eEfgG':
+        return 'double'
+    if length in ('ll', 'q', 'L') and conv != 'c':
+        return 'longlong'
+    return 'int'
+
+
+def convert(m, value, star):
+    """Format one argument with the Python equivalent of the C spec"""
+    flags, width, prec, _, conv = m.groups()
+    flags = flags.replace('~', '')
+    if width == '*':
+        width = str(star.pop(0))
+    if prec == '*':
+        prec = str(star.pop(0))
+    spec = '%' + flags + (width or '') + ('.' + prec if prec else '')
+
+    if conv == 'p':
+        return (spec + '#x') % value
+    if conv == 'b':
+        text = format(value, 'b')
+        return ('%' + flags.replace('0', '') + (width or '') + 's') % text
+    if conv == 'u':
+        conv = 'd'
+    return (spec + conv) % value
+
+
+def decode(image, rec, args, endian, maxstr):
+    """Return the formatted text of one record"""
+    fmt = image.string(rec[3])
+    if fmt is None:
+        return '<no format string at 0x%08x>' % rec[3]
+
+    out = []
+    pos = 0
+    off = 0
+    for m in specs(fmt):
+        out.append(fmt[pos:m.start()].replace('%%', '%'))
+        pos = m.end()
+
+        star = []
+        for _ in range((m.group(2) == '*') + (m.group(3) == '*')):
+            star.append(struct.unpack_from(endian + 'i', args, off)[0])
+            off += 4
+
+        kind = arg_kind(m)
+        if kind == 'string':
+            end = args.index(b'\0', off)
+            value = args[off:end].decode('latin-1')
+            off += ((end - off) // 4 + 1) * 4
+        elif kind == 'double':
+            value, = struct.unpack_from(endian + 'd', args, off)
+            off += 8
+        elif kind == 'longlong':
+            signed = m.group(5) in 'di'
+            value, = struct.unpack_from(endian + ('q' if signed else 'Q'),
+                                        args, off)
+            off += 8
+        else:
+            signed = m.group(5) in 'dic'
+            value, = struct.unpack_from(endian + ('i' if signed else 'I'),
+                                        args, off)
+            off += 4
+
+        if m.group(5) == 'c':
+            value = chr(value & 0xff)
+        out.append(convert(m, value, star))
+
+    out.append(fmt[pos:].replace('%%', '%'))
+    return ''.join(out)
+
+
+def read_dumps(data):
+    """Yield (header dict, endian, [(record, args)]) for every dump"""
+    off = 0
+    while off < len(data):
+        for endian in '<>':
+            if len(data) - off < struct.calcsize(endian + HDR_FMT):
+                raise ValueError('truncated header at offset %d' % off)
+            fields = struct.unpack_from(endian + HDR_FMT, data, off)
+            if fields[0] == MAGIC:
+                break
+        else:
+            raise ValueError('bad magic at offset %d' % off)
+
+        hdr = dict(zip(('magic', 'version', 'reserved', 'maxstr', 'nwords',
+                        'lost', 'tickhz'), fields))
+        off += struct.calcsize(endian + HDR_FMT)
+        end = off + hdr['nwords'] * 4
+        if end > len(data):
+            raise ValueError('truncated dump at offset %d' % off)
+
+        records = []
+        while off < end:
+            rec = struct.unpack_from(endian + REC_FMT, data, off)
+            if rec[0] < 3 or off + rec[0] * 4 > end:
+                raise ValueError('bad record at offset %d' % off)
+            records.append((rec, data[off + 12:off + rec[0] * 4]))
+            off += rec[0] * 4
+        yield hdr, endian, records
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode a NuttX binary '
+                                     'SYSLOG dump')
+    parser.add_argument('elf', help='ELF image that produced the log')
+    parser.add_argument('file', help='binary log file')
+    parser.add_argument('--ticks-only', action='store_true',
+                        help='print timestamps in ticks, not seconds')
+    args = parser.parse_args()
+
+    image = Image(args.elf)
+    with open(args.file, 'rb') as f:
+        data = f.read()
+
+    for hdr, endian, records in read_dumps(data):
+        if hdr['lost']:
+            print('--- %d records lost ---' % hdr['lost'])
+        for rec, recargs in records:
+            if args.ticks_only or not hdr['tickhz']:
+                stamp = '[%10u]' % rec[2]
+            else:
+                stamp = '[%12.3f]' % (float(rec[2]) / hdr['tickhz'])
+            text = decode(image, rec, recargs, endian, hdr['maxstr'])
+            sys.stdout.write('%s %s' % (stamp, text))
+            if not text.endswith('\n'):
+                sys.stdout.write('\n')
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except (IOError, ValueError) as e:
+        sys.stderr.write('%s\n' % e)
+        sys.exit(1)
@@ -71,6 +71,7 @@ disablescript=`grep CONFIG_NSH_DISABLESCRIPT= $topdir/.config | cut -d'=' -f2`
 ndescriptors=`grep CONFIG_NFILE_DESCRIPTORS= $topdir/.config | cut -d'=' -f2`
 devconsole=`grep CONFIG_DEV_CONSOLE= $topdir/.config | cut -d'=' -f2`
 romfs=`grep CONFIG_FS_ROMFS= $topdir/.config | cut -d'=' -f2`
+romfsz=`grep CONFIG_FS_ROMFS_COMPRESSED= $topdir/.config | cut -d'=' -f2`
 romfsmpt=`grep CONFIG_NSH_ROMFSMOUNTPT= $topdir/.config | cut -d'=' -f2`
 initscript=`grep CONFIG_NSH_INITSCRIPT= $topdir/.config | cut -d'=' -f2`
 romfsdevno=`grep CONFIG_NSH_ROMFSDEVNO= $topdir/.config | cut -d'=' -f2`
@@ -255,6 +256,16 @@ rm -f $rcsfile
 genromfs -f $romfsimg -d $workingdir -V "NSHInitVol" || { echo "genromfs failed" ; exit 1 ; }
 rm -rf $workingdir || { echo "Failed to remove the old $workingdir"; exit 1; }
 
+# Compress the file data if the ROMFS file system supports it
+
+if [ "X$romfsz" = "Xy" ]; then
+    make -C $topdir/tools -f Makefile.host mkromfsz 1>/dev/null || \
+        { echo "Failed to build mkromfsz"; rm -f $romfsimg; exit 1; }
+    $topdir/tools/mkromfsz $romfsimg $romfsimg.z || \
+        { echo "mkromfsz failed"; rm -f $romfsimg $romfsimg.z; exit 1; }
+    mv $romfsimg.z $romfsimg
+fi
+
 # And, finally, create the header file
 
 xxd -i $romfsimg >$headerfile || { echo "xxd of $< failed" ; rm -f $romfsimg; exit 1 ; }
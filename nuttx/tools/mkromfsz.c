@@ -0,0 +1,655 @@
+/****************************************************************************
+ * tools/mkromfsz.c
+ *
+ *   Copyright (C) 2016 Motorola Mobility, LLC. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/****************************************************************************
+ * Included Files
+ ****************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/****************************************************************************
+ * Pre-processor Definitions
+ ****************************************************************************/
+
+/* These must agree with fs/romfs/fs_romfs.h */
+
+#define ROMFS_VHDR_SIZE     8
+#define ROMFS_VHDR_CHKSUM  12
+#define ROMFS_VHDR_VOLNAME 16
+#define ROMFS_VHDR_MAGIC   "-rom1fs-"
+
+#define ROMFS_FHDR_NEXT     0
+#define ROMFS_FHDR_INFO     4
+#define ROMFS_FHDR_SIZE     8
+#define ROMFS_FHDR_CHKSUM  12
+#define ROMFS_FHDR_NAME    16
+
+#define RFNEXT_MODEMASK     7
+#define RFNEXT_OFFSETMASK  (~15u)
+#define RFNEXT_HARDLINK     0
+#define RFNEXT_DIRECTORY    1
+#define RFNEXT_FILE         2
+#define RFNEXT_SOFTLINK     3
+
+#define ROMFS_ALIGNUP(a)   (((a) + 15) & ~15u)
+
+#define ROMFS_ZMAGIC       "-romfsz-"
+#define ROMFS_ZBLOCKSIZE   4096
+#define ROMFS_ZHDR_TABLE   16
+
+/* LZ4 block format limits */
+
+#define LZ4_MINMATCH       4
+#define LZ4_LASTLITERALS   5
+#define LZ4_MFLIMIT        12
+#define LZ4_MAXOFFSET      65535
+#define LZ4_HASHLOG        12
+
+/* genromfs pads the image to a multiple of 1KB */
+
+#define IMAGE_ALIGNMENT    1024
+
+/****************************************************************************
+ * Private Types
+ ****************************************************************************/
+
+struct entry_s
+{
+  uint32_t offset;      /* Offset of the header in the input image */
+  uint32_t newoffset;   /* Offset of the header in the output image */
+};
+
+/****************************************************************************
+ * Private Data
+ ****************************************************************************/
+
+static uint8_t *g_in;
+static uint32_t g_insize;
+static uint8_t *g_out;
+static uint32_t g_outsize;
+static uint32_t g_outalloc;
+
+static struct entry_s *g_entries;
+static unsigned int g_nentries;
+static unsigned int g_nalloc;
+
+static bool g_verbose;
+
+/****************************************************************************
+ * Private Functions
+ ****************************************************************************/
+
+static void show_usage(const char *progname)
+{
+  fprintf(stderr, "USAGE: %s [-v] <in-image> <out-image>\n", progname);
+  fprintf(stderr, "\nCompress the regular files of the genromfs image\n");
+  fprintf(stderr, "<in-image> in %d byte LZ4 blocks.  Files that do not\n",
+          ROMFS_ZBLOCKSIZE);
+  fprintf(stderr, "get smaller are stored unchanged.\n");
+  exit(EXIT_FAILURE);
+}
+
+static uint32_t get32(const uint8_t *ptr)
+{
+  return ((uint32_t)ptr[0] << 24) | ((uint32_t)ptr[1] << 16) |
+         ((uint32_t)ptr[2] << 8) | (uint32_t)ptr[3];
+}
+
+static void put32(uint8_t *ptr, uint32_t value)
+{
+  ptr[0] = value >> 24;
+  ptr[1] = value >> 16;
+  ptr[2] = value >> 8;
+  ptr[3] = value;
+}
+
+static void *xrealloc(void *ptr, size_t size)
+{
+  ptr = realloc(ptr, size);
+  if (!ptr)
+    {
+      fprintf(stderr, "ERROR: Out of memory\n");
+      exit(EXIT_FAILURE);
+    }
+
+  return ptr;
+}
+
+static void check_range(uint32_t offset, uint32_t len)
+{
+  if (offset > g_insize || len > g_insize - offset)
+    {
+      fprintf(stderr, "ERROR: Offset %u+%u is outside of the image\n",
+              offset, len);
+      exit(EXIT_FAILURE);
+    }
+}
+
+/* Reserve len bytes at the end of the output image and return the offset */
+
+static uint32_t out_reserve(uint32_t len)
+{
+  uint32_t offset = g_outsize;
+
+  if (g_outsize + len > g_outalloc)
+    {
+      g_outalloc = 2 * (g_outsize + len);
+      g_out      = xrealloc(g_out, g_outalloc);
+    }
+
+  memset(&g_out[g_outsize], 0, len);
+  g_outsize += len;
+  return offset;
+}
+
+/* Return the length of the header plus the padded name */
+
+static uint32_t header_len(uint32_t offset)
+{
+  uint32_t namelen;
+
+  check_range(offset, ROMFS_FHDR_NAME);
+  for (namelen = 0; ; namelen++)
+    {
+      check_range(offset + ROMFS_FHDR_NAME + namelen, 1);
+      if (g_in[offset + ROMFS_FHDR_NAME + namelen] == '\0')
+        {
+          break;
+        }
+    }
+
+  return ROMFS_FHDR_NAME + ROMFS_ALIGNUP(namelen + 1);
+}
+
+/* Return the big-endian word sum of len bytes, i.e. the value that the
+ * ROMFS checksum must cancel.
+ */
+
+static uint32_t word_sum(const uint8_t *ptr, uint32_t len)
+{
+  uint32_t sum = 0;
+  uint32_t i;
+
+  for (i = 0; i + 4 <= len; i += 4)
+    {
+      sum += get32(&ptr[i]);
+    }
+
+  return sum;
+}
+
+/****************************************************************************
+ * Image walk
+ ****************************************************************************/
+
+static bool is_known(uint32_t offset)
+{
+  unsigned int i;
+
+  for (i = 0; i < g_nentries; i++)
+    {
+      if (g_entries[i].offset == offset)
+        {
+          return true;
+        }
+    }
+
+  return false;
+}
+
+/* Record every header of the directory beginning at offset, recursing
+ * into sub-directories.  "." and ".." are hard links and are not followed.
+ */
+
+static void walk_dir(uint32_t offset)
+{
+  uint32_t next;
+
+  while (offset != 0 && !is_known(offset))
+    {
+      check_range(offset, ROMFS_FHDR_NAME);
+
+      if (g_nentries >= g_nalloc)
+        {
+          g_nalloc  = g_nalloc ? 2 * g_nalloc : 64;
+          g_entries = xrealloc(g_entries, g_nalloc * sizeof(struct entry_s));
+        }
+
+      g_entries[g_nentries].offset    = offset;
+      g_entries[g_nentries].newoffset = 0;
+      g_nentries++;
+
+      next = get32(&g_in[offset + ROMFS_FHDR_NEXT]);
+      if ((next & RFNEXT_MODEMASK) == RFNEXT_DIRECTORY)
+        {
+          walk_dir(get32(&g_in[offset + ROMFS_FHDR_INFO]));
+        }
+
+      offset = next & RFNEXT_OFFSETMASK;
+    }
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+  const struct entry_s *ea = a;
+  const struct entry_s *eb = b;
+
+  return ea->offset < eb->offset ? -1 : ea->offset > eb->offset;
+}
+
+static uint32_t map_offset(uint32_t offset)
+{
+  unsigned int lo = 0;
+  unsigned int hi = g_nentries;
+  unsigned int mid;
+
+  if (offset == 0)
+    {
+      return 0;
+    }
+
+  while (lo < hi)
+    {
+      mid = (lo + hi) / 2;
+      if (g_entries[mid].offset == offset)
+        {
+          return g_entries[mid].newoffset;
+        }
+      else if (g_entries[mid].offset < offset)
+        {
+          lo = mid + 1;
+        }
+      else
+        {
+          hi = mid;
+        }
+    }
+
+  fprintf(stderr, "ERROR: No file header at offset %u\n", offset);
+  exit(EXIT_FAILURE);
+}
+
+/****************************************************************************
+ * LZ4 compression
+ ****************************************************************************/
+
+static uint32_t read32le(const uint8_t *ptr)
+{
+  return (uint32_t)ptr[0] | ((uint32_t)ptr[1] << 8) |
+         ((uint32_t)ptr[2] << 16) | ((uint32_t)ptr[3] << 24);
+}
+
+static uint8_t *lz4_putlength(uint8_t *op, uint32_t len)
+{
+  while (len >= 255)
+    {
+      *op++ = 255;
+      len  -= 255;
+    }
+
+  *op++ = len;
+  return op;
+}
+
+/* Emit one sequence: litlen literals, then a match of matchlen bytes at
+ * the given distance back (matchlen == 0 for the final sequence).
+ */
+
+static uint8_t *lz4_sequence(uint8_t *op, const uint8_t *literals,
+                             uint32_t litlen, uint32_t distance,
+                             uint32_t matchlen)
+{
+  uint8_t *token = op++;
+  uint32_t mlen  = matchlen - LZ4_MINMATCH;
+
+  *token = (litlen >= 15 ? 15 : litlen) << 4;
+  if (litlen >= 15)
+    {
+      op = lz4_putlength(op, litlen - 15);
+    }
+
+  memcpy(op, literals, litlen);
+  op += litlen;
+
+  if (matchlen > 0)
+    {
+      *op++   = distance;
+      *op++   = distance >> 8;
+      *token |= mlen >= 15 ? 15 : mlen;
+      if (mlen >= 15)
+        {
+          op = lz4_putlength(op, mlen - 15);
+        }
+    }
+
+  return op;
+}
+
+/* Greedy single-pass LZ4 block compression of at most ROMFS_ZBLOCKSIZE
+ * bytes.  dest must hold the worst case of srclen + srclen / 255 + 16.
+ * Returns the compressed length.
+ */
+
+static uint32_t lz4_compress(const uint8_t *src, uint32_t srclen,
+                             uint8_t *dest)
+{
+  int32_t table[1 << LZ4_HASHLOG];
+  uint8_t *op     = dest;
+  uint32_t anchor = 0;
+  uint32_t ip     = 0;
+  uint32_t matchlen;
+  uint32_t hash;
+  int32_t ref;
+
+  memset(table, 0xff, sizeof(table));
+
+  if (srclen >= LZ4_MFLIMIT + 1)
+    {
+      while (ip < srclen - LZ4_MFLIMIT)
+        {
+          hash        = (read32le(&src[ip]) * 2654435761u) >>
+                        (32 - LZ4_HASHLOG);
+          ref         = table[hash];
+          table[hash] = ip;
+
+          if (ref < 0 || ip - ref > LZ4_MAXOFFSET ||
+              read32le(&src[ref]) != read32le(&src[ip]))
+            {
+              ip++;
+              continue;
+            }
+
+          matchlen = LZ4_MINMATCH;
+          while (ip + matchlen < srclen - LZ4_LASTLITERALS &&
+                 src[ref + matchlen] == src[ip + matchlen])
+            {
+              matchlen++;
+            }
+
+          op     = lz4_sequence(op, &src[anchor], ip - anchor, ip - ref,
+                                matchlen);
+          ip    += matchlen;
+          anchor = ip;
+        }
+    }
+
+  op = lz4_sequence(op, &src[anchor], srclen - anchor, 0, 0);
+  return op - dest;
+}
+
+/****************************************************************************
+ * Output
+ ****************************************************************************/
+
+/* Append the data of a regular file, compressed if that makes it smaller */
+
+static void emit_file(const uint8_t *data, uint32_t size)
+{
+  uint8_t block[ROMFS_ZBLOCKSIZE + ROMFS_ZBLOCKSIZE / 255 + 16];
+  uint32_t nblocks = (size + ROMFS_ZBLOCKSIZE - 1) / ROMFS_ZBLOCKSIZE;
+  uint32_t tablelen = ROMFS_ZHDR_TABLE + 4 * (nblocks + 1);
+  uint32_t start = g_outsize;
+  uint32_t ulen;
+  uint32_t clen;
+  uint32_t pos;
+  uint32_t i;
+
+  if (nblocks == 0)
+    {
+      return;
+    }
+
+  /* Write the header and the compressed blocks, then see if it paid off */
+
+  (void)out_reserve(tablelen);
+  memcpy(&g_out[start], ROMFS_ZMAGIC, 8);
+  put32(&g_out[start + 8], ROMFS_ZBLOCKSIZE);
+  put32(&g_out[start + 12], nblocks);
+
+  for (i = 0; i < nblocks; i++)
+    {
+      ulen = size - i * ROMFS_ZBLOCKSIZE;
+      if (ulen > ROMFS_ZBLOCKSIZE)
+        {
+          ulen = ROMFS_ZBLOCKSIZE;
+        }
+
+      clen = lz4_compress(&data[i * ROMFS_ZBLOCKSIZE], ulen, block);
+      put32(&g_out[start + ROMFS_ZHDR_TABLE + 4 * i], g_outsize - start);
+
+      /* Blocks that do not compress are stored as they are */
+
+      if (clen >= ulen)
+        {
+          pos = out_reserve(ulen);
+          memcpy(&g_out[pos], &data[i * ROMFS_ZBLOCKSIZE], ulen);
+        }
+      else
+        {
+          pos = out_reserve(clen);
+          memcpy(&g_out[pos], block, clen);
+        }
+    }
+
+  put32(&g_out[start + ROMFS_ZHDR_TABLE + 4 * nblocks], g_outsize - start);
+
+  if (ROMFS_ALIGNUP(g_outsize - start) >= ROMFS_ALIGNUP(size))
+    {
+      /* No gain, store the file as it is */
+
+      g_outsize = start;
+      pos       = out_reserve(size);
+      memcpy(&g_out[pos], data, size);
+    }
+  else if (g_verbose)
+    {
+      printf("  %u -> %u bytes\n", size, g_outsize - start);
+    }
+}
+
+/****************************************************************************
+ * Public Functions
+ ****************************************************************************/
+
+int main(int argc, char **argv, char **envp)
+{
+  const char *progname = argv[0];
+  uint32_t rootoffset;
+  uint32_t offset;
+  uint32_t next;
+  uint32_t info;
+  uint32_t size;
+  uint32_t hlen;
+  uint32_t pos;
+  unsigned int i;
+  FILE *stream;
+  long insize;
+
+  if (argc > 1 && strcmp(argv[1], "-v") == 0)
+    {
+      g_verbose = true;
+      argc--;
+      argv++;
+    }
+
+  if (argc != 3)
+    {
+      show_usage(progname);
+    }
+
+  /* Read the input image */
+
+  stream = fopen(argv[1], "rb");
+  if (!stream)
+    {
+      fprintf(stderr, "ERROR: Failed to open %s\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+
+  fseek(stream, 0, SEEK_END);
+  insize = ftell(stream);
+  fseek(stream, 0, SEEK_SET);
+
+  if (insize < ROMFS_VHDR_VOLNAME + 16)
+    {
+      fprintf(stderr, "ERROR: %s is too small\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+
+  g_insize = insize;
+  g_in     = xrealloc(NULL, g_insize);
+  if (fread(g_in, 1, g_insize, stream) != g_insize)
+    {
+      fprintf(stderr, "ERROR: Failed to read %s\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+
+  fclose(stream);
+
+  if (memcmp(g_in, ROMFS_VHDR_MAGIC, 8) != 0)
+    {
+      fprintf(stderr, "ERROR: %s is not a ROMFS image\n", argv[1]);
+      return EXIT_FAILURE;
+    }
+
+  if (get32(&g_in[ROMFS_VHDR_SIZE]) < g_insize)
+    {
+      g_insize = get32(&g_in[ROMFS_VHDR_SIZE]);
+    }
+
+  /* Find all file headers */
+
+  rootoffset = header_len(0);
+  walk_dir(rootoffset);
+  qsort(g_entries, g_nentries, sizeof(struct entry_s), compare_entries);
+
+  /* Copy the volume header, then each file header and its data */
+
+  pos = out_reserve(rootoffset);
+  memcpy(&g_out[pos], g_in, rootoffset);
+
+  for (i = 0; i < g_nentries; i++)
+    {
+      offset = g_entries[i].offset;
+      hlen   = header_len(offset);
+      next   = get32(&g_in[offset + ROMFS_FHDR_NEXT]);
+      size   = get32(&g_in[offset + ROMFS_FHDR_SIZE]);
+
+      g_entries[i].newoffset = g_outsize;
+      pos = out_reserve(hlen);
+      memcpy(&g_out[pos], &g_in[offset], hlen);
+
+      switch (next & RFNEXT_MODEMASK)
+        {
+          case RFNEXT_FILE:
+            check_range(offset + hlen, size);
+            if (g_verbose)
+              {
+                printf("%s\n", &g_in[offset + ROMFS_FHDR_NAME]);
+              }
+
+            emit_file(&g_in[offset + hlen], size);
+            break;
+
+          case RFNEXT_SOFTLINK:
+            check_range(offset + hlen, size);
+            pos = out_reserve(size);
+            memcpy(&g_out[pos], &g_in[offset + hlen], size);
+            break;
+
+          default:
+            break;
+        }
+
+      (void)out_reserve(ROMFS_ALIGNUP(g_outsize) - g_outsize);
+    }
+
+  /* Relocate the links between the headers and update the checksums */
+
+  for (i = 0; i < g_nentries; i++)
+    {
+      pos  = g_entries[i].newoffset;
+      next = get32(&g_out[pos + ROMFS_FHDR_NEXT]);
+      info = get32(&g_out[pos + ROMFS_FHDR_INFO]);
+
+      put32(&g_out[pos + ROMFS_FHDR_NEXT],
+            map_offset(next & RFNEXT_OFFSETMASK) | (next & ~RFNEXT_OFFSETMASK));
+
+      if ((next & RFNEXT_MODEMASK) == RFNEXT_DIRECTORY ||
+          (next & RFNEXT_MODEMASK) == RFNEXT_HARDLINK)
+        {
+          put32(&g_out[pos + ROMFS_FHDR_INFO], map_offset(info));
+        }
+
+      hlen = header_len(g_entries[i].offset);
+      put32(&g_out[pos + ROMFS_FHDR_CHKSUM], 0);
+      put32(&g_out[pos + ROMFS_FHDR_CHKSUM], -word_sum(&g_out[pos], hlen));
+    }
+
+  (void)out_reserve((g_outsize + IMAGE_ALIGNMENT - 1) / IMAGE_ALIGNMENT *
+                    IMAGE_ALIGNMENT - g_outsize);
+
+  put32(&g_out[ROMFS_VHDR_SIZE], g_outsize);
+  put32(&g_out[ROMFS_VHDR_CHKSUM], 0);
+  put32(&g_out[ROMFS_VHDR_CHKSUM],
+        -word_sum(g_out, g_outsize < 512 ? g_outsize : 512));
+
+  /* Write the output image */
+
+  stream = fopen(argv[2], "wb");
+  if (!stream)
+    {
+      fprintf(stderr, "ERROR: Failed to open %s\n", argv[2]);
+      return EXIT_FAILURE;
+    }
+
+  if (fwrite(g_out, 1, g_outsize, stream) != g_outsize)
+    {
+      fprintf(stderr, "ERROR: Failed to write %s\n", argv[2]);
+      return EXIT_FAILURE;
+    }
+
+  fclose(stream);
+
+  if (g_verbose)
+    {
+      printf("%u -> %u bytes\n", g_insize, g_outsize);
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -53,10 +53,24 @@
 #define MAX_HEADER_FILES 500
 #define SYMTAB_NAME      "g_symtab"
 
+/* 32-bit FNV-1a.  This must match symtab_hash() in
+ * binfmt/symtab_findhashedbyname.c
+ */
+
+#define FNV32_OFFSET     2166136261u
+#define FNV32_PRIME      16777619u
+
 /****************************************************************************
  * Private Types
  ****************************************************************************/
 
+struct symbol_s
+{
+  char *name;
+  char *cond;
+  unsigned int hash;
+};
+
 /****************************************************************************
  * Private Data
  ****************************************************************************/
@@ -64,17 +78,22 @@
 static const char *g_hdrfiles[MAX_HEADER_FILES];
 static int nhdrfiles;
 
+static struct symbol_s *g_symbols;
+static int nsymbols;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 
 static void show_usage(const char *progname)
 {
-  fprintf(stderr, "USAGE: %s <cvs-file> <symtab-file>\n\n", progname);
+  fprintf(stderr, "USAGE: %s [-d] [-h] <cvs-file> <symtab-file>\n\n", progname);
   fprintf(stderr, "Where:\n\n");
   fprintf(stderr, "  <cvs-file>   : The path to the input CSV file\n");
   fprintf(stderr, "  <symtab-file>: The path to the output symbol table file\n");
   fprintf(stderr, "  -d           : Enable debug output\n");
+  fprintf(stderr, "  -h           : Add name hashes and order the table by hash\n");
+  fprintf(stderr, "                 (for CONFIG_SYMTAB_HASHED)\n");
   exit(EXIT_FAILURE);
 }
 
@@ -111,6 +130,49 @@ static void add_hdrfile(const char *hdrfile)
     }
 }
 
+static unsigned int symbol_hash(const char *name)
+{
+  unsigned int hash = FNV32_OFFSET;
+
+  while (*name != '\0')
+    {
+      hash ^= (unsigned char)*name++;
+      hash = (hash * FNV32_PRIME) & 0xffffffff;
+    }
+
+  return hash;
+}
+
+static void add_symbol(const char *name, const char *cond)
+{
+  struct symbol_s *sym;
+
+  g_symbols = realloc(g_symbols, (nsymbols + 1) * sizeof(struct symbol_s));
+  if (!g_symbols)
+    {
+      fprintf(stderr, "ERROR:  Out of memory\n");
+      exit(EXIT_FAILURE);
+    }
+
+  sym       = &g_symbols[nsymbols++];
+  sym->name = strdup(name);
+  sym->cond = (cond && strlen(cond) > 0) ? strdup(cond) : NULL;
+  sym->hash = symbol_hash(name);
+}
+
+static int compare_hash(const void *a, const void *b)
+{
+  const struct symbol_s *syma = a;
+  const struct symbol_s *symb = b;
+
+  if (syma->hash != symb->hash)
+    {
+      return syma->hash < symb->hash ? -1 : 1;
+    }
+
+  return strcmp(syma->name, symb->name);
+}
+
 /****************************************************************************
  * Public Functions
  ****************************************************************************/
@@ -122,6 +184,7 @@ int main(int argc, char **argv, char **envp)
   char *nextterm;
   char *finalterm;
   char *ptr;
+  bool hashed;
   bool cond;
   FILE *instream;
   FILE *outstream;
@@ -131,8 +194,9 @@ int main(int argc, char **argv, char **envp)
   /* Parse command line options */
 
   g_debug = false;
+  hashed  = false;
 
-  while ((ch = getopt(argc, argv, ":d")) > 0)
+  while ((ch = getopt(argc, argv, ":dh")) > 0)
     {
       switch (ch)
         {
@@ -140,6 +204,10 @@ int main(int argc, char **argv, char **envp)
             g_debug = true;
             break;
 
+          case 'h' :
+            hashed = true;
+            break;
+
           case '?' :
             fprintf(stderr, "Unrecognized option: %c\n", optopt);
             show_usage(argv[0]);
@@ -212,11 +280,20 @@ int main(int argc, char **argv, char **envp)
       /* Add the header file to the list of header files we need to include */
 
       add_hdrfile(g_parm[HEADER_INDEX]);
+
+      /* And remember the symbol */
+
+      add_symbol(g_parm[NAME_INDEX], g_parm[COND_INDEX]);
     }
 
-  /* Back to the beginning */
+  /* A hashed symbol table is searched by hash, so it must be ordered by
+   * hash.  Otherwise keep the order of the CSV file.
+   */
 
-  rewind(instream);
+  if (hashed)
+    {
+      qsort(g_symbols, nsymbols, sizeof(struct symbol_s), compare_hash);
+    }
 
   /* Output up-front file boilerplate */
 
@@ -232,40 +309,47 @@ int main(int argc, char **argv, char **envp)
       fprintf(outstream, "#include <%s>\n", g_hdrfiles[i]);
     }
 
+  if (hashed)
+    {
+      fprintf(outstream, "\n#ifndef CONFIG_SYMTAB_HASHED\n");
+      fprintf(outstream, "#  error \"Hashed symbol table requires CONFIG_SYMTAB_HASHED\"\n");
+      fprintf(outstream, "#endif\n");
+    }
+
   /* Now the symbol table itself */
 
   fprintf(outstream, "\nstruct symtab_s %s[] =\n", SYMTAB_NAME);
   fprintf(outstream, "{\n");
 
-  /* Parse each line in the CVS file */
+  /* Output each symbol from the CVS file */
 
   nextterm  = "";
   finalterm = "";
 
-  while ((ptr = read_line(instream)) != NULL)
+  for (i = 0; i < nsymbols; i++)
     {
-      /* Parse the line from the CVS file */
-
-      int nargs = parse_csvline(ptr);
-      if (nargs < PARM1_INDEX)
-        {
-          fprintf(stderr, "Only %d arguments found: %s\n", nargs, g_line);
-          exit(EXIT_FAILURE);
-        }
-
       /* Output any conditional compilation */
 
-      cond = (g_parm[COND_INDEX] && strlen(g_parm[COND_INDEX]) > 0);
+      cond = (g_symbols[i].cond != NULL);
       if (cond)
         {
-          fprintf(outstream, "%s#if %s\n", nextterm, g_parm[COND_INDEX]);
+          fprintf(outstream, "%s#if %s\n", nextterm, g_symbols[i].cond);
           nextterm  = "";
         }
 
       /* Output the symbol table entry */
 
-      fprintf(outstream, "%s  { \"%s\", (FAR const void *)%s }",
-              nextterm, g_parm[NAME_INDEX], g_parm[NAME_INDEX]);
+      if (hashed)
+        {
+          fprintf(outstream, "%s  { \"%s\", (FAR const void *)%s, 0x%08xu }",
+                  nextterm, g_symbols[i].name, g_symbols[i].name,
+                  g_symbols[i].hash);
+        }
+      else
+        {
+          fprintf(outstream, "%s  { \"%s\", (FAR const void *)%s }",
+                  nextterm, g_symbols[i].name, g_symbols[i].name);
+        }
 
       if (cond)
         {
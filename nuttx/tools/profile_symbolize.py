@@ -0,0 +1,132 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2016 Motorola Mobility, LLC
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 1. Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+# 3. Neither the name of the copyright holder nor the names of its
+# contributors may be used to endorse or promote products derived from this
+# software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+# Symbolize the PC-sampling profile read from /proc/profile (see
+# include/nuttx/profile.h).
+#
+# Usage:
+#   profile_symbolize.py [--nm NM] [--folded] [--top N] nuttx.elf profile.txt
+#
+# Without --folded, prints the functions that were sampled most, with
+# their share of the samples. With --folded, prints one "caller;function
+# count" line per sampled location, the input expected by flamegraph.pl.
+# The caller comes from the LR saved in the exception frame and is only
+# right while the sampled function has not called anything yet, so the
+# graph is one level deep and approximate.
+#
+from __future__ import print_function
+
+import argparse
+import bisect
+import collections
+import subprocess
+import sys
+
+
+class Symbols(object):
+    """Address to function name lookup built from 'nm -n'"""
+
+    def __init__(self, nm, path):
+        out = subprocess.check_output([nm, '-n', path])
+        self.addrs = []
+        self.names = []
+        for line in out.decode('ascii', 'replace').splitlines():
+            fields = line.split()
+            if len(fields) != 3 or fields[1] not in 'TtWw':
+                continue
+            self.addrs.append(int(fields[0], 16) & ~1)
+            self.names.append(fields[2])
+
+    def lookup(self, addr):
+        i = bisect.bisect_right(self.addrs, addr) - 1
+        if i < 0:
+            return '0x%08x' % addr
+        return self.names[i]
+
+
+def read_profile(path):
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            pc, lr, count = line.split()
+            yield int(pc, 16), int(lr, 16), int(count)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Symbolize the /proc/profile PC-sampling profile')
+    parser.add_argument('--nm', default='arm-none-eabi-nm',
+                        help='nm of the toolchain (default: %(default)s)')
+    parser.add_argument('--folded', action='store_true',
+                        help='print folded stacks for flamegraph.pl')
+    parser.add_argument('--top', type=int, default=30,
+                        help='number of functions listed (default: '
+                        '%(default)s)')
+    parser.add_argument('elf', help='image running on the target')
+    parser.add_argument('profile', help='copy of /proc/profile')
+    args = parser.parse_args()
+
+    syms = Symbols(args.nm, args.elf)
+
+    funcs = collections.Counter()
+    stacks = collections.Counter()
+    for pc, lr, count in read_profile(args.profile):
+        func = syms.lookup(pc & ~1)
+        funcs[func] += count
+
+        # LR is the return address, step back into the calling instruction
+        # so that a call at the very end of a function is not attributed
+        # to the next one.
+
+        if lr:
+            stacks['%s;%s' % (syms.lookup((lr & ~1) - 1), func)] += count
+        else:
+            stacks[func] += count
+
+    if args.folded:
+        for stack, count in sorted(stacks.items()):
+            print('%s %d' % (stack, count))
+        return
+
+    total = sum(funcs.values())
+    if not total:
+        print('no samples')
+        return
+
+    for func, count in funcs.most_common(args.top):
+        print('%6.2f%% %8d  %s' % (100.0 * count / total, count, func))
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except (IOError, OSError, ValueError,
+            subprocess.CalledProcessError) as e:
+        sys.stderr.write('%s\n' % e)
+        sys.exit(1)
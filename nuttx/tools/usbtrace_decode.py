@@ -0,0 +1,163 @@
+#!/usr/bin/env python
+#
+# Copyright (c) 2016 Motorola Mobility, LLC
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are met:
+# 1. Redistributions of source code must retain the above copyright notice,
+# this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright notice,
+# this list of conditions and the following disclaimer in the documentation
+# and/or other materials provided with the distribution.
+# 3. Neither the name of the copyright holder nor the names of its
+# contributors may be used to endorse or promote products derived from this
+# software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+# AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+# THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+# PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+# CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+# EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+# PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+# OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+# WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+# OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+# ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#
+# Decode the binary USB device trace written by usbtrace_dump() (see
+# include/nuttx/usb/usbdev_trace.h and apps/system/usbmonitor).
+#
+# Usage:
+#   usbtrace_decode.py [--cpu-hz HZ] [--stall-us US] trace.bin
+#
+# The file may hold any number of concatenated dumps.  Event names are
+# taken from include/nuttx/usb/usbdev_trace.h so that the decoder stays in
+# sync with the target.  With --stall-us, gaps between two consecutive
+# records longer than the given time are flagged; this is the quickest way
+# to find where a transfer stalled.
+#
+from __future__ import print_function
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+MAGIC = 0x43525455
+FLAG_TIME = 1 << 0
+FLAG_CYCLES = 1 << 1
+HDR_FMT = 'IBBHIII'
+
+HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                      '..', 'include', 'nuttx', 'usb', 'usbdev_trace.h')
+
+
+def parse_header(path):
+    """Return ({id: class name}, {event: event name}) from usbdev_trace.h"""
+    ids = {}
+    events = {}
+    re_id = re.compile(r'#define\s+TRACE_(\w+)_ID\s+\((0x[0-9a-fA-F]+)\)')
+    re_ev = re.compile(r'#define\s+(TRACE_\w+)\s+'
+                       r'TRACE_EVENT\(TRACE_(\w+)_ID,\s*(0x[0-9a-fA-F]+)\)')
+    with open(path) as f:
+        text = f.read()
+    for name, value in re_id.findall(text):
+        ids[int(value, 16)] = name
+    for name, cls, value in re_ev.findall(text):
+        for idval, idname in ids.items():
+            if idname == cls:
+                events.setdefault(idval | int(value, 16), name)
+    return ids, events
+
+
+def read_dumps(data):
+    """Yield (header dict, [records]) for every dump in 'data'"""
+    off = 0
+    while off < len(data):
+        for endian in '<>':
+            if len(data) - off < struct.calcsize(endian + HDR_FMT):
+                raise ValueError('truncated header at offset %d' % off)
+            fields = struct.unpack_from(endian + HDR_FMT, data, off)
+            if fields[0] == MAGIC:
+                break
+        else:
+            raise ValueError('bad magic at offset %d' % off)
+
+        hdr = dict(zip(('magic', 'version', 'flags', 'recsize', 'nrecords',
+                        'lost', 'tickhz'), fields))
+        off += struct.calcsize(endian + HDR_FMT)
+
+        recfmt = endian + ('HHI' if hdr['flags'] & FLAG_TIME else 'HH')
+        if struct.calcsize(recfmt) != hdr['recsize']:
+            raise ValueError('unexpected record size %d' % hdr['recsize'])
+
+        records = []
+        for i in range(hdr['nrecords']):
+            if off + hdr['recsize'] > len(data):
+                raise ValueError('truncated dump at offset %d' % off)
+            rec = struct.unpack_from(recfmt, data, off)
+            records.append(rec if len(rec) == 3 else rec + (None,))
+            off += hdr['recsize']
+        yield hdr, records
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode a NuttX USB '
+                                     'device trace dump')
+    parser.add_argument('file', help='binary trace file')
+    parser.add_argument('--header', default=HEADER,
+                        help='path to include/nuttx/usb/usbdev_trace.h')
+    parser.add_argument('--cpu-hz', type=float, default=0,
+                        help='CPU clock, to convert cycle timestamps to us')
+    parser.add_argument('--stall-us', type=float, default=0,
+                        help='flag gaps between records longer than this')
+    args = parser.parse_args()
+
+    ids, events = parse_header(args.header)
+    with open(args.file, 'rb') as f:
+        data = f.read()
+
+    last = None
+    for hdr, records in read_dumps(data):
+        if hdr['lost']:
+            print('--- %d records lost ---' % hdr['lost'])
+
+        # Timestamps wrap at 32 bits; convert deltas to microseconds when
+        # the rate is known.
+
+        if hdr['flags'] & FLAG_CYCLES:
+            hz = args.cpu_hz
+        else:
+            hz = hdr['tickhz']
+
+        for event, value, time in records:
+            cls = ids.get(event & 0xff00, '0x%04x' % (event & 0xff00))
+            name = events.get(event, '%s(0x%02x)' % (cls, event & 0x00ff))
+            if time is None:
+                print('%-28s %-12s 0x%04x' % (name, cls, value))
+                continue
+
+            delta = 0 if last is None else (time - last) & 0xffffffff
+            last = time
+            if hz:
+                us = delta * 1e6 / hz
+                stamp = '%10u +%10.1fus' % (time, us)
+            else:
+                us = None
+                stamp = '%10u +%10u' % (time, delta)
+
+            mark = ''
+            if args.stall_us and us is not None and us > args.stall_us:
+                mark = '  <-- stall'
+            print('%s %-28s %-12s 0x%04x%s' % (stamp, name, cls, value, mark))
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except (IOError, ValueError) as e:
+        sys.stderr.write('%s\n' % e)
+        sys.exit(1)